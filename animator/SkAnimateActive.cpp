@@ -288,6 +288,7 @@ void SkActive::initState(SkApply* apply, int offset) {
         state.fSteps = apply->steps;
         state.fTicks = 0;
         state.fUnpostedEndEvent = (SkBool8) animate->fHasEndEvent;
+        state.fHeld = false;
         calcDurations(index);
         setInterpolator(index, from);
     }
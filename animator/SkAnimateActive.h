@@ -55,6 +55,7 @@ private:
         SkBool8 fRestore;
         SkBool8 fStarted;
         SkBool8 fUnpostedEndEvent;
+        SkBool8 fHeld;  // the last value applied was the one the animation ended on
         int32_t fSteps;
         SkMSec fBegin;
         SkMSec fStartTime;
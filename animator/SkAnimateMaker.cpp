@@ -243,6 +243,8 @@ void SkAnimateMaker::loadMovies() {
 #endif
 
 void SkAnimateMaker::notifyInval() {
+    // whatever the host is told to redraw for may have changed anything
+    fDisplayList.invalAll();
     if (fHostEventSinkID)
         fAnimator->onEventPost(new SkEvent(SK_EventType_Inval), fHostEventSinkID);
 }
@@ -500,6 +500,7 @@ void SkAnimator::onEventPostTime(SkEvent* evt, SkEventSinkID sinkID, SkMSec time
 
 void SkAnimator::reset() {
     fMaker->fDisplayList.reset();
+    fMaker->fDisplayList.invalAll();
 }
 
 SkEventSinkID SkAnimator::getHostEventSinkID() const {
@@ -549,6 +550,7 @@ bool SkAnimator::setArray(SkDisplayable* element, const SkMemberInfo* info, SkTy
     if (type == SkType_Array) {
         SkDisplayArray* dispArray = (SkDisplayArray*) element;
         dispArray->values = array;
+        fMaker->fDisplayList.invalAll();
         return true;
     }
     else
@@ -578,6 +580,7 @@ bool SkAnimator::setInt(SkDisplayable* element, const SkMemberInfo* info, int32_
         scriptValue.fOperand.fS32 = s32;
         element->setProperty(info->propertyIndex(), scriptValue);
     }
+    fMaker->fDisplayList.invalAll();
     return true;
 }
 
@@ -603,6 +606,7 @@ bool SkAnimator::setScalar(SkDisplayable* element, const SkMemberInfo* info, SkS
         scriptValue.fOperand.fScalar = scalar;
         element->setProperty(info->propertyIndex(), scriptValue);
     }
+    fMaker->fDisplayList.invalAll();
     return true;
 }
 
@@ -620,6 +624,7 @@ bool SkAnimator::setString(SkDisplayable* element,
         const SkMemberInfo* info, const char* str) {
     // !!! until this is fixed, can't call script with global references from here
     info->setValue(*fMaker, NULL, 0, info->fCount, element, info->getType(), str, strlen(str));
+    fMaker->fDisplayList.invalAll();
     return true;
 }
 
@@ -40,8 +40,10 @@ void SkBoundable::enableBounder() {
 
 
 SkBoundableAuto::SkBoundableAuto(SkBoundable* boundable,
-        SkAnimateMaker& maker) : fBoundable(boundable), fMaker(maker) {
+        SkAnimateMaker& maker) : fBoundable(boundable), fMaker(maker), fSavedBounder(NULL) {
     if (fBoundable->hasBounds()) {
+        // the display list may already be the bounder, finding the frame's dirty bounds
+        fSavedBounder = SkSafeRef(fMaker.fCanvas->getBounder());
         fMaker.fCanvas->setBounder(&maker.fDisplayList);
         fMaker.fDisplayList.fBounds.setEmpty();
     }
@@ -50,6 +52,7 @@ SkBoundableAuto::SkBoundableAuto(SkBoundable* boundable,
 SkBoundableAuto::~SkBoundableAuto() {
     if (fBoundable->hasBounds() == false)
         return;
-    fMaker.fCanvas->setBounder(NULL);
+    fMaker.fCanvas->setBounder(fSavedBounder);
+    SkSafeUnref(fSavedBounder);
     fBoundable->setBounds(fMaker.fDisplayList.fBounds);
 }
@@ -192,8 +192,10 @@ bool SkApply::draw(SkAnimateMaker& maker) {
         enable(maker);
     SkASSERT(scope);
     activate(maker);
-    if (mode == kMode_immediate)
+    if (mode == kMode_immediate) {
+        maker.fDisplayList.noteChanged();
         return fActive->draw();
+    }
     bool result = interpolate(maker, maker.getInTime());
     if (dontDraw == false) {
 //      if (scope->isDrawable())
@@ -617,6 +619,11 @@ bool SkApply::interpolate(SkAnimateMaker& maker, SkMSec rawTime) {
         SkInterpolatorBase::Result interpResult = fActive->fInterpolators[inner]->timeToValues(
             innerTime, values.get());
         result |= (interpResult != SkInterpolatorBase::kFreezeEnd_Result);
+        // holding the end value only changes what's drawn the first time
+        bool held = interpResult == SkInterpolatorBase::kFreezeEnd_Result;
+        if (held == false || state.fHeld == false)
+            maker.fDisplayList.noteChanged();
+        state.fHeld = held;
         if (((transition != SkApply::kTransition_reverse && interpResult == SkInterpolatorBase::kFreezeEnd_Result) ||
                 (transition == SkApply::kTransition_reverse && fLastTime == 0)) && state.fUnpostedEndEvent) {
 //          SkDEBUGF(("interpolate: post on end\n"));
@@ -11,14 +11,19 @@
 #include "SkAnimateActive.h"
 #include "SkAnimateBase.h"
 #include "SkAnimateMaker.h"
+#include "SkCanvas.h"
 #include "SkDisplayApply.h"
 #include "SkDrawable.h"
 #include "SkDrawGroup.h"
 #include "SkDrawMatrix.h"
 #include "SkInterpolator.h"
+#include "SkRegion.h"
 #include "SkTime.h"
 
-SkDisplayList::SkDisplayList() : fDrawBounds(true), fUnionBounds(false), fInTime(0) {
+SkDisplayList::SkDisplayList() : fDrawBounds(true), fUnionBounds(false), fInTime(0),
+    fLastCanvas(NULL), fBoundsOnly(false), fChanged(false), fInvalAll(true) {
+    fLastMatrix.reset();
+    fLastSize.setEmpty();
 }
 
 SkDisplayList::~SkDisplayList() {
@@ -34,22 +39,93 @@ bool SkDisplayList::draw(SkAnimateMaker& maker, SkMSec inTime) {
     bool result = false;
     fInvalBounds.setEmpty();
     if (fDrawList.count()) {
-        for (SkActive** activePtr = fActiveList.begin(); activePtr < fActiveList.end(); activePtr++) {
-            SkActive* active = *activePtr;
-            active->reset();
-        }
-        for (int index = 0; index < fDrawList.count(); index++) {
-            SkDrawable* draw = fDrawList[index];
-            draw->initialize(); // allow matrices to reset themselves
-            SkASSERT(draw->isDrawable());
+#ifdef SK_ANIMATOR_DRAW_DIRTY_BOUNDS
+        SkIRect dirty;
+        // Movies are drawn by their parent, which tracks them as a whole.
+        if (NULL == maker.fParentMaker && findDirtyBounds(maker, &result, &dirty)) {
+            if (dirty.isEmpty() == false) {
+                SkCanvas* canvas = maker.fCanvas;
+                canvas->save();
+                canvas->clipRegion(SkRegion(dirty));
+                result |= drawEntries(maker);
+                canvas->restore();
+            }
+            fInvalBounds = dirty;
+            fHasUnion = true;
             validate();
-            result |= draw->draw(maker);
+            return result;
         }
+#endif
+        result = drawEntries(maker);
     }
     validate();
     return result;
 }
 
+bool SkDisplayList::drawEntries(SkAnimateMaker& maker) {
+    bool result = false;
+    for (SkActive** activePtr = fActiveList.begin(); activePtr < fActiveList.end(); activePtr++) {
+        SkActive* active = *activePtr;
+        active->reset();
+    }
+    for (int index = 0; index < fDrawList.count(); index++) {
+        SkDrawable* draw = fDrawList[index];
+        draw->initialize(); // allow matrices to reset themselves
+        SkASSERT(draw->isDrawable());
+        validate();
+        result |= draw->draw(maker);
+    }
+    return result;
+}
+
+// Runs the frame with every draw rejected by onIRect(), noting the device
+// bounds of each entry and whether any value it draws changed. Returns false
+// if the whole frame has to be drawn; otherwise sets dirty to the union of the
+// last and current bounds of the entries that changed or moved. Running a
+// frame twice for the same time is what a repaint does, so is safe.
+bool SkDisplayList::findDirtyBounds(SkAnimateMaker& maker, bool* result, SkIRect* dirty) {
+    SkCanvas* canvas = maker.fCanvas;
+    int count = fDrawList.count();
+    bool drawAll = fInvalAll || canvas != fLastCanvas ||
+        canvas->getDeviceSize() != fLastSize || canvas->getTotalMatrix() != fLastMatrix ||
+        fLastBounds.count() != count;
+    fInvalAll = false;
+    fLastCanvas = canvas;
+    fLastSize = canvas->getDeviceSize();
+    fLastMatrix = canvas->getTotalMatrix();
+
+    SkTDArray<SkIRect> bounds;
+    bounds.setCount(count);
+    dirty->setEmpty();
+    SkBounder* savedBounder = canvas->getBounder();
+    SkSafeRef(savedBounder);
+    canvas->setBounder(this);
+    canvas->save();
+    fBoundsOnly = true;
+    for (SkActive** activePtr = fActiveList.begin(); activePtr < fActiveList.end(); activePtr++) {
+        SkActive* active = *activePtr;
+        active->reset();
+    }
+    for (int index = 0; index < count; index++) {
+        SkDrawable* draw = fDrawList[index];
+        fEntryBounds.setEmpty();
+        fChanged = false;
+        draw->initialize();
+        *result |= draw->draw(maker);
+        bounds[index] = fEntryBounds;
+        if (drawAll == false && (fChanged || fEntryBounds != fLastBounds[index])) {
+            dirty->join(fLastBounds[index]);
+            dirty->join(fEntryBounds);
+        }
+    }
+    fBoundsOnly = false;
+    canvas->restore();
+    canvas->setBounder(savedBounder);
+    SkSafeUnref(savedBounder);
+    fLastBounds.swap(bounds);
+    return drawAll == false;
+}
+
 int SkDisplayList::findGroup(SkDrawable* match, SkTDDrawableArray** list,
         SkGroup** parent, SkGroup** found, SkTDDrawableArray**grandList) {
     *parent = NULL;
@@ -61,10 +137,15 @@ int SkDisplayList::findGroup(SkDrawable* match, SkTDDrawableArray** list,
 void SkDisplayList::hardReset() {
     fDrawList.reset();
     fActiveList.reset();
+    fInvalAll = true;
 }
 
 bool SkDisplayList::onIRect(const SkIRect& r) {
     fBounds = r;
+    if (fBoundsOnly) {
+        fEntryBounds.join(r);
+        return false;
+    }
     return fDrawBounds;
 }
 
@@ -13,14 +13,25 @@
 #include "SkOperand.h"
 #include "SkIntArray.h"
 #include "SkBounder.h"
+#include "SkMatrix.h"
 #include "SkRect.h"
+#include "SkSize.h"
 
 class SkAnimateMaker;
 class SkActive;
 class SkApply;
+class SkCanvas;
 class SkDrawable;
 class SkGroup;
 
+/*  Define SK_ANIMATOR_DRAW_DIRTY_BOUNDS to have the root animator redraw only
+    what changed since the last frame it drew: each frame is first run with
+    every draw rejected, to find the device bounds of each entry and whether
+    anything it animates changed, and then drawn clipped to the union of the
+    old and new bounds of the entries that changed. That union is reported by
+    SkAnimator::getInvalBounds(). The canvas must still hold the last frame;
+    a different canvas, device size or matrix, or any event, redraws it all.
+*/
 class SkDisplayList : public SkBounder {
 public:
     SkDisplayList();
@@ -41,6 +52,10 @@ public:
     SkMSec getTime() { return fInTime; }
     SkTDDrawableArray* getDrawList() { return &fDrawList; }
     void hardReset();
+    // Has the next frame drawn in full.
+    void invalAll() { fInvalAll = true; }
+    // Called when a value that is drawn changes while drawing the frame.
+    void noteChanged() { fChanged = true; }
     virtual bool onIRect(const SkIRect& r);
     void reset();
     void remove(SkActive* );
@@ -61,9 +76,21 @@ public:
     bool fHasUnion;
     bool fUnionBounds;
 private:
+    bool drawEntries(SkAnimateMaker& );
+    bool findDirtyBounds(SkAnimateMaker& , bool* result, SkIRect* dirty);
+
     SkTDDrawableArray fDrawList;
     SkTDActiveArray fActiveList;
     SkMSec fInTime;
+    // What the last frame was drawn with and where each entry drew.
+    SkTDArray<SkIRect> fLastBounds;
+    SkMatrix fLastMatrix;
+    SkISize fLastSize;
+    SkCanvas* fLastCanvas;
+    SkIRect fEntryBounds;
+    bool fBoundsOnly;
+    bool fChanged;
+    bool fInvalAll;
     friend class SkEvents;
 };
 
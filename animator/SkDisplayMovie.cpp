@@ -77,6 +77,8 @@ bool SkDisplayMovie::draw(SkAnimateMaker& maker) {
     if (fLoaded == false)
         enable(maker);
     maker.fCanvas->save();
+    // the movie tracks nothing itself when drawn by a parent, so is always redrawn
+    maker.fDisplayList.noteChanged();
     SkPaint local = SkPaint(*maker.fPaint);
     bool result = fMovie.draw(maker.fCanvas, &local,
         maker.fDisplayList.getTime()) != SkAnimator::kNotDifferent;
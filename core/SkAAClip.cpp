@@ -7,10 +7,12 @@
  */
 
 #include "SkAAClip.h"
+#include "SkAAClipCache.h"
 #include "SkBlitter.h"
 #include "SkColorPriv.h"
 #include "SkPath.h"
 #include "SkScan.h"
+#include "SkTLazy.h"
 #include "SkThread.h"
 #include "SkUtils.h"
 
@@ -598,6 +600,13 @@ SkAAClip::~SkAAClip() {
     this->freeRuns();
 }
 
+size_t SkAAClip::getMemorySize() const {
+    if (NULL == fRunHead) {
+        return 0;
+    }
+    return sizeof(RunHead) + fRunHead->fRowCount * sizeof(YOffset) + fRunHead->fDataSize;
+}
+
 SkAAClip& SkAAClip::operator=(const SkAAClip& src) {
     AUTO_AACLIP_VALIDATE(*this);
     src.validate();
@@ -1326,6 +1335,16 @@ bool SkAAClip::setPath(const SkPath& path, const SkRegion* clip, bool doAA) {
         }
     }
 
+    // Only small paths limited by a rect are cached, as those (round rects
+    // especially) are what tends to be clipped to over and over.
+    SkTLazy<SkAAClipCache::Key> key;
+    if (clip->isRect() && path.countPoints() <= SkAAClipCache::kMaxPointCount) {
+        key.set(SkAAClipCache::Key(path, clip->getBounds(), doAA));
+        if (SkAAClipCache::Find(*key.get(), this)) {
+            return true;
+        }
+    }
+
     Builder        builder(ibounds);
     BuilderBlitter blitter(&builder);
 
@@ -1336,7 +1355,13 @@ bool SkAAClip::setPath(const SkPath& path, const SkRegion* clip, bool doAA) {
     }
 
     blitter.finish();
-    return builder.finish(this);
+    if (!builder.finish(this)) {
+        return false;
+    }
+    if (key.isValid()) {
+        SkAAClipCache::Add(*key.get(), *this);
+    }
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
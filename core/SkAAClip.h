@@ -29,6 +29,9 @@ public:
     bool isEmpty() const { return NULL == fRunHead; }
     const SkIRect& getBounds() const { return fBounds; }
 
+    /** Returns the size of the (possibly shared) runs, 0 if empty. */
+    size_t getMemorySize() const;
+
     bool setEmpty();
     bool setRect(const SkIRect&);
     bool setRect(const SkRect&, bool doAA = true);
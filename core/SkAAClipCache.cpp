@@ -0,0 +1,186 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkAAClipCache.h"
+
+#include "SkAAClip.h"
+#include "SkChecksum.h"
+#include "SkPath.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkThread.h"
+
+#ifndef SK_DEFAULT_AACLIP_CACHE_LIMIT
+    #define SK_DEFAULT_AACLIP_CACHE_LIMIT   (512 * 1024)
+#endif
+
+static void append_scalar(SkTDArray<uint32_t>* data, SkScalar value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    *data->append() = bits;
+}
+
+SkAAClipCache::Key::Key(const SkPath& devPath, const SkIRect& clip, bool doAA) {
+    SkASSERT(devPath.countPoints() <= kMaxPointCount);
+
+    // [doAA + fillType + clip + {verb + points + {weight}}]
+    *fData.append() = doAA;
+    *fData.append() = devPath.getFillType();
+    fData.append(4, (const uint32_t*)&clip);
+
+    SkPath::RawIter iter(devPath);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        *fData.append() = verb;
+        int first = 1;
+        int count = 0;
+        switch (verb) {
+            case SkPath::kMove_Verb:  first = 0; count = 1; break;
+            case SkPath::kLine_Verb:  count = 2; break;
+            case SkPath::kQuad_Verb:  count = 3; break;
+            case SkPath::kConic_Verb: count = 3; break;
+            case SkPath::kCubic_Verb: count = 4; break;
+            default:                  count = 0; break;
+        }
+        for (int i = first; i < count; ++i) {
+            append_scalar(&fData, pts[i].fX);
+            append_scalar(&fData, pts[i].fY);
+        }
+        if (SkPath::kConic_Verb == verb) {
+            append_scalar(&fData, iter.conicWeight());
+        }
+    }
+    fHash = SkChecksum::Compute(fData.begin(), fData.count() * sizeof(uint32_t));
+}
+
+bool SkAAClipCache::Key::operator==(const Key& other) const {
+    return fHash == other.fHash &&
+           fData.count() == other.fData.count() &&
+           0 == memcmp(fData.begin(), other.fData.begin(), fData.count() * sizeof(uint32_t));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Rec {
+    Rec(const SkAAClipCache::Key& key, const SkAAClip& clip)
+        : fKey(key)
+        , fClip(clip)
+        , fSize(clip.getMemorySize()) {}
+
+    static const SkAAClipCache::Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const SkAAClipCache::Key& key) { return key.hash(); }
+
+    const SkAAClipCache::Key fKey;
+    const SkAAClip fClip;
+    const size_t fSize;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+/**
+ *  The cache itself, which is only ever touched with gMutex held. fList is
+ *  in most recently used order.
+ */
+class Cache {
+public:
+    Cache() : fBytesUsed(0), fByteLimit(SK_DEFAULT_AACLIP_CACHE_LIMIT) {}
+
+    bool find(const SkAAClipCache::Key& key, SkAAClip* clip) {
+        Rec* rec = fHash.find(key);
+        if (NULL == rec) {
+            return false;
+        }
+        fList.remove(rec);
+        fList.addToHead(rec);
+        *clip = rec->fClip;
+        return true;
+    }
+
+    void add(const SkAAClipCache::Key& key, const SkAAClip& clip) {
+        SkASSERT(!clip.isEmpty());
+        const size_t size = clip.getMemorySize();
+        if (size > fByteLimit || NULL != fHash.find(key)) {
+            return;
+        }
+        Rec* rec = SkNEW_ARGS(Rec, (key, clip));
+        fHash.add(rec);
+        fList.addToHead(rec);
+        fBytesUsed += size;
+        this->purgeAsNeeded();
+    }
+
+    size_t bytesUsed() const { return fBytesUsed; }
+    size_t byteLimit() const { return fByteLimit; }
+
+    size_t setByteLimit(size_t newLimit) {
+        size_t prevLimit = fByteLimit;
+        fByteLimit = newLimit;
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
+
+private:
+    void purgeAsNeeded() {
+        while (fBytesUsed > fByteLimit) {
+            Rec* rec = fList.tail();
+            SkASSERT(NULL != rec);
+            fList.remove(rec);
+            fHash.remove(rec->fKey);
+            fBytesUsed -= rec->fSize;
+            SkDELETE(rec);
+        }
+    }
+
+    SkTDynamicHash<Rec, SkAAClipCache::Key> fHash;
+    SkTInternalLList<Rec> fList;
+    size_t fBytesUsed;
+    size_t fByteLimit;
+};
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+
+// Must be called with gMutex held. Like SkBlurMaskCache, the cache lives for
+// the life of the process.
+Cache* get_cache() {
+    static Cache* gCache;
+    if (NULL == gCache) {
+        gCache = SkNEW(Cache);
+    }
+    return gCache;
+}
+
+}  // namespace
+
+bool SkAAClipCache::Find(const Key& key, SkAAClip* clip) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->find(key, clip);
+}
+
+void SkAAClipCache::Add(const Key& key, const SkAAClip& clip) {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->add(key, clip);
+}
+
+size_t SkAAClipCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkAAClipCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkAAClipCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAAClipCache_DEFINED
+#define SkAAClipCache_DEFINED
+
+#include "SkRect.h"
+#include "SkTDArray.h"
+
+class SkAAClip;
+class SkPath;
+
+/**
+ *  A global, thread-safe, byte-limited LRU cache of the SkAAClips built by
+ *  SkAAClip::setPath(). Canvases transform each clip path into a new device
+ *  path, so a round rect clipped every frame (say, around a scrolling view)
+ *  would otherwise be scan converted again every frame. SkAAClip shares its
+ *  runs, so handing out a cached clip is just a ref.
+ */
+class SkAAClipCache {
+public:
+    enum {
+        // Larger paths are not worth keying (or storing).
+        kMaxPointCount = 64,
+    };
+
+    /**
+     *  Everything the clip depends on: the device path's geometry and fill
+     *  type, the bounds of the rectangular clip it is limited to and whether
+     *  it is anti-aliased. The path must have at most kMaxPointCount points.
+     */
+    class Key {
+    public:
+        Key(const SkPath& devPath, const SkIRect& clip, bool doAA);
+
+        bool operator==(const Key& other) const;
+        uint32_t hash() const { return fHash; }
+
+    private:
+        SkTDArray<uint32_t> fData;
+        uint32_t            fHash;
+    };
+
+    /** If key is in the cache, sets clip to share the cached runs and returns true. */
+    static bool Find(const Key& key, SkAAClip* clip);
+
+    /** Adds clip, which must not be empty, to the cache. */
+    static void Add(const Key& key, const SkAAClip& clip);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+};
+
+#endif
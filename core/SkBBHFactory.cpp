@@ -33,6 +33,11 @@ SkBBoxHierarchy* SkRTreeFactory::operator()(int width, int height) const {
 SkBBoxHierarchy* SkTileGridFactory::operator()(int width, int height) const {
     SkASSERT(fInfo.fMargin.width() >= 0);
     SkASSERT(fInfo.fMargin.height() >= 0);
+    // An empty tile interval asks the grid to pick its own from what's recorded.
+    if (fInfo.fTileInterval.isEmpty()) {
+        return SkTileGrid::CreateAdaptive(width, height, fInfo,
+                                          SkTileGridNextDatum<SkPictureStateTree::Draw>);
+    }
     // Note: SkIRects are non-inclusive of the right() column and bottom() row.
     // For example, an SkIRect at 0,0 with a size of (1,1) will only have
     // content at pixel (0,0) and will report left=0 and right=1, hence the
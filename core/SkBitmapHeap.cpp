@@ -66,6 +66,12 @@ bool SkBitmapHeap::LookupEntry::Less(const SkBitmapHeap::LookupEntry& a,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static SkBitmapHeap::DigestProc gDefaultDigestProc;
+
+void SkBitmapHeap::SetDefaultDigestProc(DigestProc proc) {
+    gDefaultDigestProc = proc;
+}
+
 SkBitmapHeap::SkBitmapHeap(int32_t preferredSize, int32_t ownerCount)
     : INHERITED()
     , fExternalStorage(NULL)
@@ -74,7 +80,8 @@ SkBitmapHeap::SkBitmapHeap(int32_t preferredSize, int32_t ownerCount)
     , fPreferredCount(preferredSize)
     , fOwnerCount(ownerCount)
     , fBytesAllocated(0)
-    , fDeferAddingOwners(false) {
+    , fDeferAddingOwners(false)
+    , fDigestProc(gDefaultDigestProc) {
 }
 
 SkBitmapHeap::SkBitmapHeap(ExternalStorage* storage, int32_t preferredSize)
@@ -85,7 +92,8 @@ SkBitmapHeap::SkBitmapHeap(ExternalStorage* storage, int32_t preferredSize)
     , fPreferredCount(preferredSize)
     , fOwnerCount(IGNORE_OWNERS)
     , fBytesAllocated(0)
-    , fDeferAddingOwners(false) {
+    , fDeferAddingOwners(false)
+    , fDigestProc(gDefaultDigestProc) {
     SkSafeRef(storage);
 }
 
@@ -223,6 +231,7 @@ size_t SkBitmapHeap::freeMemoryIfPossible(size_t bytesToFree) {
             // Everything was evicted
             fMostRecentlyUsed = NULL;
             fBytesAllocated -= (fStorage.count() * sizeof(SkBitmapHeapEntry));
+            SkAutoMutexAcquire lock(fStorageMutex);
             fStorage.deleteAll();
             fUnusedSlots.reset();
             SkASSERT(0 == fBytesAllocated);
@@ -234,6 +243,43 @@ size_t SkBitmapHeap::freeMemoryIfPossible(size_t bytesToFree) {
     return origBytesAllocated - fBytesAllocated;
 }
 
+int SkBitmapHeap::findDigest(uint64_t digest) const {
+    int lo = 0;
+    int hi = fDigests.count();
+    while (lo < hi) {
+        int mid = lo + ((hi - lo) >> 1);
+        if (fDigests[mid].fDigest < digest) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+SkBitmapHeap::LookupEntry* SkBitmapHeap::findByDigest(uint64_t digest,
+                                                      const SkBitmap& bitmap) const {
+    for (int i = this->findDigest(digest);
+         i < fDigests.count() && fDigests[i].fDigest == digest; ++i) {
+        LookupEntry* lookupEntry = fDigests[i].fLookupEntry;
+        if (fDigests[i].fConfig == bitmap.config() &&
+            lookupEntry->fWidth == SkToU32(bitmap.width()) &&
+            lookupEntry->fHeight == SkToU32(bitmap.height())) {
+            return lookupEntry;
+        }
+    }
+    return NULL;
+}
+
+void SkBitmapHeap::removeDigest(const LookupEntry* lookupEntry) {
+    for (int i = 0; i < fDigests.count(); ++i) {
+        if (fDigests[i].fLookupEntry == lookupEntry) {
+            fDigests.remove(i);
+            return;
+        }
+    }
+}
+
 int SkBitmapHeap::findInLookupTable(const LookupEntry& indexEntry, SkBitmapHeapEntry** entry) {
     int index = SkTSearch<const LookupEntry, LookupEntry::Less>(
                                              (const LookupEntry**)fLookupTable.begin(),
@@ -280,32 +326,52 @@ int SkBitmapHeap::removeEntryFromLookupTable(LookupEntry* entry) {
     // a new entry to the lookup table.
     SkASSERT(count == fLookupTable.count());
     fBytesAllocated -= fStorage[entry->fStorageSlot]->fBytesAllocated;
+    if (fDigests.count() > 0) {
+        this->removeDigest(fLookupTable[index]);
+    }
     SkDELETE(fLookupTable[index]);
     fLookupTable.remove(index);
     return index;
 }
 
+int32_t SkBitmapHeap::reuseEntry(SkBitmapHeapEntry* entry, LookupEntry* lookupEntry) {
+    if (fOwnerCount != IGNORE_OWNERS) {
+        if (fDeferAddingOwners) {
+            *fDeferredEntries.append() = entry->fSlot;
+        } else {
+            entry->addReferences(fOwnerCount);
+        }
+    }
+    if (fPreferredCount != UNLIMITED_SIZE) {
+        if (lookupEntry != fMostRecentlyUsed) {
+            this->removeFromLRU(lookupEntry);
+            this->appendToLRU(lookupEntry);
+        }
+    }
+    return entry->fSlot;
+}
+
 int32_t SkBitmapHeap::insert(const SkBitmap& originalBitmap) {
     SkBitmapHeapEntry* entry = NULL;
     int searchIndex = this->findInLookupTable(LookupEntry(originalBitmap), &entry);
 
     if (entry) {
         // Already had a copy of the bitmap in the heap.
-        if (fOwnerCount != IGNORE_OWNERS) {
-            if (fDeferAddingOwners) {
-                *fDeferredEntries.append() = entry->fSlot;
-            } else {
-                entry->addReferences(fOwnerCount);
-            }
-        }
-        if (fPreferredCount != UNLIMITED_SIZE) {
-            LookupEntry* lookupEntry = fLookupTable[searchIndex];
-            if (lookupEntry != fMostRecentlyUsed) {
-                this->removeFromLRU(lookupEntry);
-                this->appendToLRU(lookupEntry);
-            }
+        return this->reuseEntry(entry, fLookupTable[searchIndex]);
+    }
+
+    // A different pixel ref may still hold the same pixels.
+    uint64_t digest;
+    const bool hasDigest = NULL != fDigestProc && fDigestProc(originalBitmap, &digest);
+    if (hasDigest) {
+        LookupEntry* match = this->findByDigest(digest, originalBitmap);
+        if (NULL != match) {
+            // Forget the lookup entry findInLookupTable just added for this pixel ref; the
+            // next insert of it will find the match again by digest.
+            SkDELETE(fLookupTable[searchIndex]);
+            fLookupTable.remove(searchIndex);
+            return this->reuseEntry(fStorage[match->fStorageSlot], match);
         }
-        return entry->fSlot;
     }
 
     // decide if we need to evict an existing heap entry or create a new one
@@ -334,6 +400,7 @@ int32_t SkBitmapHeap::insert(const SkBitmap& originalBitmap) {
             entry = fStorage[slot];
         } else {
             entry = SkNEW(SkBitmapHeapEntry);
+            SkAutoMutexAcquire lock(fStorageMutex);
             fStorage.append(1, &entry);
             entry->fSlot = fStorage.count() - 1;
             fBytesAllocated += sizeof(SkBitmapHeapEntry);
@@ -356,6 +423,7 @@ int32_t SkBitmapHeap::insert(const SkBitmap& originalBitmap) {
         // If entry is the last slot in storage, it is safe to delete it.
         if (fStorage.count() - 1 == entry->fSlot) {
             // free the slot
+            SkAutoMutexAcquire lock(fStorageMutex);
             fStorage.remove(entry->fSlot);
             fBytesAllocated -= sizeof(SkBitmapHeapEntry);
             SkDELETE(entry);
@@ -387,6 +455,12 @@ int32_t SkBitmapHeap::insert(const SkBitmap& originalBitmap) {
     if (fPreferredCount != UNLIMITED_SIZE) {
         this->appendToLRU(fLookupTable[searchIndex]);
     }
+    if (hasDigest) {
+        DigestEntry* digestEntry = fDigests.insert(this->findDigest(digest));
+        digestEntry->fDigest = digest;
+        digestEntry->fConfig = originalBitmap.config();
+        digestEntry->fLookupEntry = fLookupTable[searchIndex];
+    }
     return entry->fSlot;
 }
 
@@ -82,6 +82,12 @@ public:
     static const int32_t IGNORE_OWNERS  = -1;
     static const int32_t INVALID_SLOT   = -1;
 
+    /**
+     *  Computes a digest of a bitmap's pixels, e.g. SkBitmapHasher::ComputeFastDigest. Returns false
+     *  if it could not.
+     */
+    typedef bool (*DigestProc)(const SkBitmap& bitmap, uint64_t* digest);
+
     /**
      * Constructs a heap that is responsible for allocating and managing its own storage.  In the
      * case where we choose to allow the heap to grow indefinitely (i.e. UNLIMITED_SIZE) we
@@ -169,10 +175,11 @@ public:
      * @return  a SkBitmapHeapEntry that wraps the bitmap or NULL if external storage is used.
      */
     SkBitmapHeapEntry* getEntry(int32_t slot) const {
-        SkASSERT(slot <= fStorage.count());
         if (fExternalStorage != NULL) {
             return NULL;
         }
+        SkAutoMutexAcquire lock(fStorageMutex);
+        SkASSERT(slot <= fStorage.count());
         return fStorage[slot];
     }
 
@@ -200,6 +207,21 @@ public:
      */
     size_t freeMemoryIfPossible(size_t bytesToFree);
 
+    /**
+     * By default bitmaps are only recognized as already being in the heap if they share an
+     * SkPixelRef (or at least its generation ID). With a DigestProc, a bitmap that is new by that
+     * measure but whose digest, size and config match a bitmap already in the heap is given that
+     * bitmap's slot instead of being copied (and, for pictures and pipes, serialized) again.
+     * Matching costs a digest of each new bitmap. Pass NULL to turn this off again.
+     */
+    void setDigestProc(DigestProc proc) { fDigestProc = proc; }
+
+    /**
+     * The DigestProc that heaps are constructed with, NULL unless set. This is how pictures and
+     * pipes, which make their own heaps, are opted in; set it before recording any.
+     */
+    static void SetDefaultDigestProc(DigestProc proc);
+
     /**
      * Defer any increments of owner counts until endAddingOwnersDeferral is called. So if an
      * existing SkBitmap is inserted into the SkBitmapHeap, its corresponding SkBitmapHeapEntry will
@@ -263,6 +285,20 @@ private:
     int findInLookupTable(const LookupEntry& key, SkBitmapHeapEntry** entry);
 
     LookupEntry* findEntryToReplace(const SkBitmap& replacement);
+
+    // Gives a bitmap found in the heap another owner and marks it most recently used.
+    int32_t reuseEntry(SkBitmapHeapEntry*, LookupEntry*);
+
+    struct DigestEntry {
+        uint64_t         fDigest;
+        SkBitmap::Config fConfig;
+        LookupEntry*     fLookupEntry;
+    };
+
+    // Index of the first entry in fDigests with a digest not less than digest.
+    int findDigest(uint64_t digest) const;
+    LookupEntry* findByDigest(uint64_t digest, const SkBitmap& bitmap) const;
+    void removeDigest(const LookupEntry*);
     bool copyBitmap(const SkBitmap& originalBitmap, SkBitmap& copiedBitmap);
 
     /**
@@ -286,6 +322,11 @@ private:
 
     // heap storage
     SkTDArray<SkBitmapHeapEntry*> fStorage;
+    // A reader on another thread may look up entries it owns while the heap
+    // inserts others, so changes to the size of fStorage are made, and slots
+    // are looked up by getEntry(), with this held. Entries themselves stay
+    // put while they have owners.
+    mutable SkMutex fStorageMutex;
     // Used to mark slots in fStorage as deleted without actually deleting
     // the slot so as not to mess up the numbering.
     SkTDArray<int> fUnusedSlots;
@@ -301,6 +342,10 @@ private:
     bool fDeferAddingOwners;
     SkTDArray<int> fDeferredEntries;
 
+    DigestProc fDigestProc;
+    // Digests of the bitmaps inserted while fDigestProc was set, sorted by digest.
+    SkTDArray<DigestEntry> fDigests;
+
     typedef SkBitmapHeapReader INHERITED;
 };
 
@@ -26,6 +26,12 @@ extern void  Repeat_S16_D16_filter_DX_shaderproc_neon(const SkBitmapProcState&,
 extern void  SI8_opaque_D32_filter_DX_neon(const SkBitmapProcState&, const uint32_t*, int, SkPMColor*);
 extern void  SI8_opaque_D32_filter_DX_shaderproc_neon(const SkBitmapProcState&, int, int, uint32_t*, int);
 extern void  Clamp_SI8_opaque_D32_filter_DX_shaderproc_neon(const SkBitmapProcState&, int, int, uint32_t*, int);
+extern void  S32_opaque_D32_filter_DX_neon(const SkBitmapProcState&, const uint32_t*, int, SkPMColor*);
+extern void  S32_alpha_D32_filter_DX_neon(const SkBitmapProcState&, const uint32_t*, int, SkPMColor*);
+extern void  Clamp_S32_opaque_D32_filter_DX_shaderproc_neon(const SkBitmapProcState&, int, int, uint32_t*, int);
+extern void  Repeat_S32_opaque_D32_filter_DX_shaderproc_neon(const SkBitmapProcState&, int, int, uint32_t*, int);
+extern void  Clamp_S32_alpha_D32_filter_DX_shaderproc_neon(const SkBitmapProcState&, int, int, uint32_t*, int);
+extern void  Repeat_S32_alpha_D32_filter_DX_shaderproc_neon(const SkBitmapProcState&, int, int, uint32_t*, int);
 #endif
 
 #define   NAME_WRAP(x)  x
@@ -293,6 +299,77 @@ bool SkBitmapProcState::possiblyScaleImage() {
     return false;
 }
 
+// libjpeg's DCT scaling stops at 1/8; past that codecs point sample, which
+// would alias more than decoding at 1/8 and letting the filter scale down.
+static const int kMaxReducePow2 = 3;
+
+/*
+ *  A lazily decoded image (e.g. SkDiscardablePixelRef over an
+ *  SkDecodingImageGenerator) can decode straight to a power-of-two fraction of
+ *  its size, which is far cheaper than decoding at full size only to scale it
+ *  down again. If we are drawing the image at half its size or smaller, decode
+ *  it at the largest such reduction that is still no smaller than we draw it,
+ *  and use that as fOrigBitmap. Each reduction is cached under its own size.
+ */
+bool SkBitmapProcState::possiblyReduceImage() {
+    SkASSERT(NULL == fReducedCacheID);
+
+    SkPixelRef* pr = fOrigBitmap.pixelRef();
+    if (NULL == pr || pr->isLocked() ||
+        fInvMatrix.getType() > (SkMatrix::kScale_Mask | SkMatrix::kTranslate_Mask)) {
+        return false;
+    }
+    // A subset would need its bounds mapped into the reduced image.
+    const SkImageInfo& info = pr->info();
+    if (fOrigBitmap.pixelRefOrigin() != SkIPoint::Make(0, 0) ||
+        fOrigBitmap.width() != info.fWidth || fOrigBitmap.height() != info.fHeight) {
+        return false;
+    }
+
+    const SkScalar invScale = SkMinScalar(SkScalarAbs(fInvMatrix.getScaleX()),
+                                          SkScalarAbs(fInvMatrix.getScaleY()));
+    int pow2 = 0;
+    while (pow2 < kMaxReducePow2 && SkIntToScalar(2 << pow2) <= invScale) {
+        pow2 += 1;
+    }
+    if (0 == pow2) {
+        return false;
+    }
+
+    const uint32_t genID = fOrigBitmap.getGenerationID();
+    const int width = SkMax32(info.fWidth >> pow2, 1);
+    const int height = SkMax32(info.fHeight >> pow2, 1);
+    SkBitmap reduced;
+    fReducedCacheID = SkScaledImageCache::FindAndLock(genID, width, height, &reduced);
+    if (fReducedCacheID) {
+        reduced.lockPixels();
+        if (!reduced.getPixels()) {
+            // found a purged entry (discardablememory?), release it
+            reduced.unlockPixels();
+            SkScaledImageCache::Unlock(fReducedCacheID);
+            fReducedCacheID = NULL;
+            // fall through to rebuild
+        }
+    }
+
+    if (NULL == fReducedCacheID) {
+        if (!pr->decodeInto(pow2, &reduced)) {
+            return false;
+        }
+        SkASSERT(reduced.width() == width && reduced.height() == height);
+        fReducedCacheID = SkScaledImageCache::AddAndLock(genID, width, height, reduced);
+        if (!fReducedCacheID) {
+            return false;
+        }
+    }
+
+    fInvMatrix.postScale(SkIntToScalar(width) / info.fWidth,
+                         SkIntToScalar(height) / info.fHeight);
+    fOrigBitmap = reduced;
+    fOrigBitmap.lockPixels();
+    return true;
+}
+
 static bool get_locked_pixels(const SkBitmap& src, int pow2, SkBitmap* dst) {
     SkPixelRef* pr = src.pixelRef();
     if (pr && pr->decodeInto(pow2, dst)) {
@@ -364,6 +441,9 @@ SkBitmapProcState::~SkBitmapProcState() {
     if (fScaledCacheID) {
         SkScaledImageCache::Unlock(fScaledCacheID);
     }
+    if (fReducedCacheID) {
+        SkScaledImageCache::Unlock(fReducedCacheID);
+    }
     SkDELETE(fBitmapFilter);
 }
 
@@ -376,6 +456,8 @@ bool SkBitmapProcState::chooseProcs(const SkMatrix& inv, const SkPaint& paint) {
 
     SkASSERT(NULL == fScaledCacheID);
 
+    this->possiblyReduceImage();
+
     // possiblyScaleImage will look to see if it can rescale the image as a
     // preprocess; either by scaling up to the target size, or by selecting
     // a nearby mipmap level.  If it does, it will adjust the working
@@ -619,6 +701,12 @@ bool SkBitmapProcState::chooseProcs(const SkMatrix& inv, const SkPaint& paint) {
     // see if our platform has any accelerated overrides
     this->platformProcs();
 
+    // If the platform kept the portable 8888 bilerp sampler, fuse it with its
+    // matrix proc so we skip the intermediate xy buffer.
+    if (NULL == fShaderProc32) {
+        fShaderProc32 = this->chooseFilterShaderProc32();
+    }
+
     return true;
 }
 
@@ -922,6 +1010,30 @@ SkBitmapProcState::ShaderProc32 SkBitmapProcState::chooseShaderProc32() {
     return NULL;
 }
 
+SkBitmapProcState::ShaderProc32 SkBitmapProcState::chooseFilterShaderProc32() {
+    SkShader::TileMode tx = (SkShader::TileMode)fTileModeX;
+    SkShader::TileMode ty = (SkShader::TileMode)fTileModeY;
+    bool clamp = SkShader::kClamp_TileMode == tx && SkShader::kClamp_TileMode == ty;
+    bool repeat = SkShader::kRepeat_TileMode == tx && SkShader::kRepeat_TileMode == ty;
+
+    if (SK_ARM_NEON_WRAP(S32_opaque_D32_filter_DX) == fSampleProc32) {
+        if (clamp) {
+            return SK_ARM_NEON_WRAP(Clamp_S32_opaque_D32_filter_DX_shaderproc);
+        }
+        if (repeat) {
+            return SK_ARM_NEON_WRAP(Repeat_S32_opaque_D32_filter_DX_shaderproc);
+        }
+    } else if (SK_ARM_NEON_WRAP(S32_alpha_D32_filter_DX) == fSampleProc32) {
+        if (clamp) {
+            return SK_ARM_NEON_WRAP(Clamp_S32_alpha_D32_filter_DX_shaderproc);
+        }
+        if (repeat) {
+            return SK_ARM_NEON_WRAP(Repeat_S32_alpha_D32_filter_DX_shaderproc);
+        }
+    }
+    return NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef SK_DEBUG
@@ -37,7 +37,7 @@ struct SkConvolutionProcs;
 
 struct SkBitmapProcState {
 
-    SkBitmapProcState(): fScaledCacheID(NULL), fBitmapFilter(NULL) {}
+    SkBitmapProcState() : fScaledCacheID(NULL), fReducedCacheID(NULL), fBitmapFilter(NULL) {}
     ~SkBitmapProcState();
 
     typedef void (*ShaderProc32)(const SkBitmapProcState&, int x, int y,
@@ -150,10 +150,16 @@ private:
     SkBitmap            fScaledBitmap;      // chooseProcs
 
     SkScaledImageCache::ID* fScaledCacheID;
+    SkScaledImageCache::ID* fReducedCacheID;
 
     MatrixProc chooseMatrixProc(bool trivial_matrix);
     bool chooseProcs(const SkMatrix& inv, const SkPaint&);
     ShaderProc32 chooseShaderProc32();
+    ShaderProc32 chooseFilterShaderProc32();
+
+    // returns false if we did not replace fOrigBitmap with a reduced decode
+    // of it. Either way, possiblyScaleImage() and lockBaseBitmap() follow.
+    bool possiblyReduceImage();
 
     // returns false if we did not try to scale the image. In that case, we
     // will need to "lock" its pixels some other way.
@@ -220,6 +226,10 @@ void ClampX_ClampY_filter_affine(const SkBitmapProcState& s,
                                  uint32_t xy[], int count, int x, int y);
 void ClampX_ClampY_nofilter_affine(const SkBitmapProcState& s,
                                    uint32_t xy[], int count, int x, int y);
+void ClampX_ClampY_filter_persp(const SkBitmapProcState& s,
+                                uint32_t xy[], int count, int x, int y);
+void ClampX_ClampY_nofilter_persp(const SkBitmapProcState& s,
+                                  uint32_t xy[], int count, int x, int y);
 void S32_D16_filter_DX(const SkBitmapProcState& s,
                        const uint32_t* xy, int count, uint16_t* colors);
 
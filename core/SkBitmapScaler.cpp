@@ -286,15 +286,6 @@ bool SkBitmapScaler::Resize(SkBitmap* resultPtr,
         return false;
     }
 
-    SkResizeFilter filter(method, source.width(), source.height(),
-                          destWidth, destHeight, destSubset, convolveProcs);
-
-    // Get a source bitmap encompassing this touched area. We construct the
-    // offsets and row strides such that it looks like a new bitmap, while
-    // referring to the old data.
-    const unsigned char* sourceSubset =
-        reinterpret_cast<const unsigned char*>(source.getPixels());
-
     // Convolve into the result.
     SkBitmap result;
     result.setConfig(SkImageInfo::MakeN32(destSubset.width(),
@@ -305,11 +296,10 @@ bool SkBitmapScaler::Resize(SkBitmap* resultPtr,
         return false;
     }
 
-    BGRAConvolve2D(sourceSubset, static_cast<int>(source.rowBytes()),
-        !source.isOpaque(), filter.xFilter(), filter.yFilter(),
-        static_cast<int>(result.rowBytes()),
-        static_cast<unsigned char*>(result.getPixels()),
-        convolveProcs, true);
+    if (!ResizeInto(result.getPixels(), result.rowBytes(), source, method,
+                    destWidth, destHeight, destSubset, convolveProcs)) {
+        return false;
+    }
 
     *resultPtr = result;
     resultPtr->lockPixels();
@@ -317,6 +307,34 @@ bool SkBitmapScaler::Resize(SkBitmap* resultPtr,
     return true;
 }
 
+// static
+bool SkBitmapScaler::ResizeInto(void* pixels, size_t rowBytes,
+                                const SkBitmap& source,
+                                ResizeMethod method,
+                                int destWidth, int destHeight,
+                                const SkIRect& destSubset,
+                                const SkConvolutionProcs& convolveProcs) {
+    SkASSERT(NULL != source.getPixels() && kN32_SkColorType == source.colorType());
+    SkASSERT(rowBytes >= destSubset.width() * sizeof(SkPMColor));
+
+    method = ResizeMethodToAlgorithmMethod(method);
+    SkResizeFilter filter(method, source.width(), source.height(),
+                          destWidth, destHeight, destSubset, convolveProcs);
+
+    // Get a source bitmap encompassing this touched area. We construct the
+    // offsets and row strides such that it looks like a new bitmap, while
+    // referring to the old data.
+    const unsigned char* sourceSubset =
+        reinterpret_cast<const unsigned char*>(source.getPixels());
+
+    BGRAConvolve2D(sourceSubset, static_cast<int>(source.rowBytes()),
+        !source.isOpaque(), filter.xFilter(), filter.yFilter(),
+        static_cast<int>(rowBytes),
+        static_cast<unsigned char*>(pixels),
+        convolveProcs, true);
+    return true;
+}
+
 // static
 bool SkBitmapScaler::Resize(SkBitmap* resultPtr,
                             const SkBitmap& source,
@@ -95,6 +95,18 @@ public:
                        const SkConvolutionProcs&,
                        SkBitmap::Allocator* allocator = NULL);
 
+    // As above, but writes the dest_subset into pixels the caller owns, each
+    // row row_bytes apart, rather than allocating a bitmap for it. The source
+    // must be locked and N32. Subsets of the same destination are resampled
+    // independently, so callers can split a destination into bands of rows
+    // and resample those in parallel.
+    static bool ResizeInto(void* pixels, size_t row_bytes,
+                           const SkBitmap& source,
+                           ResizeMethod method,
+                           int dest_width, int dest_height,
+                           const SkIRect& dest_subset,
+                           const SkConvolutionProcs&);
+
     // Alternate version for resizing and returning the entire bitmap rather than
     // a subset.
     static bool Resize(SkBitmap* result,
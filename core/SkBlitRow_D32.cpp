@@ -196,6 +196,12 @@ void SkBlitRow::ColorRect32(SkPMColor* dst, int width, int height,
         return;
     }
 
+    // Rows that abut are one long span.
+    if (rowBytes == width * sizeof(SkPMColor)) {
+        width *= height;
+        height = 1;
+    }
+
     // Just made up this value, since I saw it once in a SSE2 file.
     // We should consider writing some tests to find the optimimal break-point
     // (or query the Platform proc?)
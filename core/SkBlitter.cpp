@@ -545,6 +545,104 @@ const SkBitmap* SkRgnClipBlitter::justAnOpaqueColor(uint32_t* value) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+SkCoalescingBlitter::~SkCoalescingBlitter() {
+    this->flush();
+}
+
+void SkCoalescingBlitter::flush() {
+    if (fHeight > 0) {
+        if (1 == fHeight) {
+            fBlitter->blitH(fX, fY, fWidth);
+        } else {
+            fBlitter->blitRect(fX, fY, fWidth, fHeight);
+        }
+        fHeight = 0;
+    }
+}
+
+void SkCoalescingBlitter::blitH(int x, int y, int width) {
+    if (fHeight > 0) {
+        if (1 == fHeight && y == fY && x == fX + fWidth) {
+            fWidth += width;
+            return;
+        }
+        if (y == fY + fHeight && x == fX && width == fWidth) {
+            fHeight += 1;
+            return;
+        }
+        this->flush();
+    }
+    fX = x;
+    fY = y;
+    fWidth = width;
+    fHeight = 1;
+}
+
+void SkCoalescingBlitter::blitAntiH(int x, int y, const SkAlpha antialias[],
+                                    const int16_t runs[]) {
+    // The interior rows of antialiased shapes are often opaque from end to
+    // end; those are just spans.
+    int width = 0;
+    for (;;) {
+        int count = runs[0];
+        SkASSERT(count >= 0);
+        if (0 == count) {
+            break;
+        }
+        if (0xFF != antialias[0]) {
+            width = 0;
+            break;
+        }
+        width += count;
+        runs += count;
+        antialias += count;
+    }
+    if (width > 0) {
+        this->blitH(x, y, width);
+        return;
+    }
+    this->flush();
+    fBlitter->blitAntiH(x, y, antialias, runs);
+}
+
+void SkCoalescingBlitter::blitV(int x, int y, int height, SkAlpha alpha) {
+    this->flush();
+    fBlitter->blitV(x, y, height, alpha);
+}
+
+void SkCoalescingBlitter::blitRect(int x, int y, int width, int height) {
+    this->flush();
+    fBlitter->blitRect(x, y, width, height);
+}
+
+void SkCoalescingBlitter::blitAntiRect(int x, int y, int width, int height,
+                                       SkAlpha leftAlpha, SkAlpha rightAlpha) {
+    this->flush();
+    fBlitter->blitAntiRect(x, y, width, height, leftAlpha, rightAlpha);
+}
+
+void SkCoalescingBlitter::blitMask(const SkMask& mask, const SkIRect& clip) {
+    this->flush();
+    fBlitter->blitMask(mask, clip);
+}
+
+const SkBitmap* SkCoalescingBlitter::justAnOpaqueColor(uint32_t* value) {
+    // The caller may write the pixels itself, so they must be up to date.
+    this->flush();
+    return fBlitter->justAnOpaqueColor(value);
+}
+
+bool SkCoalescingBlitter::resetShaderContext(const SkShader::ContextRec& rec) {
+    this->flush();
+    return fBlitter->resetShaderContext(rec);
+}
+
+SkShader::Context* SkCoalescingBlitter::getShaderContext() const {
+    return fBlitter->getShaderContext();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SkBlitter* SkBlitterClipper::apply(SkBlitter* blitter, const SkRegion* clip,
                                    const SkIRect* ir) {
     if (clip) {
@@ -966,6 +1064,14 @@ SkBlitter* SkBlitter::Choose(const SkBitmap& device,
             if (shader) {
                 blitter = allocator->createT<SkARGB32_Shader_Blitter>(
                         device, *paint, shaderContext);
+                // Merged spans let rect-like shapes shade many rows in one
+                // blitRect(). Sk3DBlitter wants to see every span itself.
+                if (NULL == shader3D) {
+                    SkBlitter* coalescer = allocator->createT<SkCoalescingBlitter>(blitter);
+                    if (NULL != coalescer) {
+                        blitter = coalescer;
+                    }
+                }
             } else if (paint->getColor() == SK_ColorBLACK) {
                 blitter = allocator->createT<SkARGB32_Black_Blitter>(device, *paint);
             } else if (paint->getAlpha() == 0xFF) {
@@ -160,6 +160,40 @@ private:
     const SkRegion* fRgn;
 };
 
+/** Wraps another (real) blitter, and merges the opaque spans it is given
+    before passing them on: spans that continue the previous one on the same
+    row grow it, and spans that repeat the previous row one row down grow it
+    into a rect, which a shader blitter can shade once for all of its rows.
+    Antialiased rows that are opaque throughout count as spans. Everything
+    else first flushes the pending span, so the real blitter sees the same
+    pixels in the same order.
+*/
+class SkCoalescingBlitter : public SkBlitter {
+public:
+    SkCoalescingBlitter(SkBlitter* blitter) : fBlitter(blitter), fHeight(0) {}
+    virtual ~SkCoalescingBlitter();
+
+    virtual void blitH(int x, int y, int width) SK_OVERRIDE;
+    virtual void blitAntiH(int x, int y, const SkAlpha[],
+                           const int16_t runs[]) SK_OVERRIDE;
+    virtual void blitV(int x, int y, int height, SkAlpha alpha) SK_OVERRIDE;
+    virtual void blitRect(int x, int y, int width, int height) SK_OVERRIDE;
+    virtual void blitAntiRect(int x, int y, int width, int height,
+                     SkAlpha leftAlpha, SkAlpha rightAlpha) SK_OVERRIDE;
+    virtual void blitMask(const SkMask&, const SkIRect& clip) SK_OVERRIDE;
+    virtual const SkBitmap* justAnOpaqueColor(uint32_t* value) SK_OVERRIDE;
+    virtual bool resetShaderContext(const SkShader::ContextRec&) SK_OVERRIDE;
+    virtual SkShader::Context* getShaderContext() const SK_OVERRIDE;
+
+    /** Pass the pending span, if any, on to the real blitter. */
+    void flush();
+
+private:
+    SkBlitter*  fBlitter;
+    // The pending span; none if fHeight is 0.
+    int         fX, fY, fWidth, fHeight;
+};
+
 /** Factory to set up the appropriate most-efficient wrapper blitter
     to apply a clip. Returns a pointer to a member, so lifetime must
     be managed carefully.
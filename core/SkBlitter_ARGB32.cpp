@@ -214,6 +214,13 @@ void SkARGB32_Blitter::blitRect(int x, int y, int width, int height) {
     uint32_t    color = fPMColor;
     size_t      rowBytes = fDevice.rowBytes();
 
+    // Full-width rects of a tightly packed bitmap are one contiguous span, so
+    // fill them in one go rather than paying the per-row overhead.
+    if (rowBytes == (size_t)width << 2) {
+        width *= height;
+        height = 1;
+    }
+
     if (255 == SkGetPackedA32(color)) {
         fColorRect32Proc(device, width, height, rowBytes, color);
     } else {
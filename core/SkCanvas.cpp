@@ -15,11 +15,13 @@
 #include "SkDrawFilter.h"
 #include "SkDrawLooper.h"
 #include "SkMetaData.h"
+#include "SkPaintPriv.h"
 #include "SkPathOps.h"
 #include "SkPicture.h"
 #include "SkRasterClip.h"
 #include "SkRRect.h"
 #include "SkSmallAllocator.h"
+#include "SkStats.h"
 #include "SkSurface_Base.h"
 #include "SkTemplates.h"
 #include "SkTextFormatParams.h"
@@ -105,6 +107,22 @@ void SkCanvas::predrawNotify() {
     }
 }
 
+// Returns true if a draw with this paint leaves nothing of what it covers behind.
+static bool paint_replaces_dst(const SkPaint& paint) {
+    return NULL == paint.getLooper() && NULL == paint.getImageFilter() &&
+           NULL == paint.getMaskFilter() && isPaintOpaque(&paint);
+}
+
+// Returns true if a draw of devRect (in device space) reaches every pixel of the base layer.
+static bool covers_base_layer(const SkRasterClip& clip, const SkISize& layerSize,
+                              const SkRect& devRect) {
+    const SkIRect layerBounds = SkIRect::MakeWH(layerSize.width(), layerSize.height());
+    SkRect layerRect;
+    layerRect.set(layerBounds);
+    return clip.isRect() && clip.getBounds().contains(layerBounds) &&
+           devRect.contains(layerRect);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /*  This is the record we keep for each SkBaseDevice that the user installs.
@@ -188,6 +206,11 @@ private:
     stored in the ...Storage field, and the pointer points to that. If the
     value is not copied for this level, we ignore ...Storage, and just point
     at the corresponding value in the previous level in the stack.
+
+    A plain save() doesn't push a record at all: it just bumps the top
+    record's fDeferredSaveCount. Only when the matrix, clip or filter is about
+    to change (see CheckForDeferredSave()) do we push a record and copy the
+    matrix and clip, so save/restore pairs that don't touch them are free.
 */
 class SkCanvas::MCRec {
 public:
@@ -195,6 +218,8 @@ public:
     SkMatrix*       fMatrix;        // points to either fMatrixStorage or prev MCRec
     SkRasterClip*   fRasterClip;    // points to either fRegionStorage or prev MCRec
     SkDrawFilter*   fFilter;        // the current filter (or null)
+    int             fSaveCount;     // the canvas' save count at this level
+    int             fDeferredSaveCount; // plain saves on top of this level not yet pushed
 
     DeviceCM*   fLayer;
     /*  If there are any layers in the stack, this points to the top-most
@@ -225,6 +250,7 @@ public:
             SkSafeRef(fFilter);
 
             fTopLayer = prev->fTopLayer;
+            fSaveCount = prev->fSaveCount + prev->fDeferredSaveCount + 1;
         } else {   // no prev
             fMatrixStorage.reset();
 
@@ -232,7 +258,9 @@ public:
             fRasterClip = &fRasterClipStorage;
             fFilter     = NULL;
             fTopLayer   = NULL;
+            fSaveCount  = 1;
         }
+        fDeferredSaveCount = 0;
         fLayer = NULL;
 
         // don't bother initializing fNext
@@ -244,6 +272,19 @@ public:
         dec_rec();
     }
 
+    /*  Called before the canvas' matrix, clip or filter is modified. If the
+        top level has saves deferred on it, the topmost of them becomes a real
+        level so the change can be undone by its restore(). (This lives here,
+        rather than in SkCanvas, so it can be kept out of the public header.)
+    */
+    static void CheckForDeferredSave(SkCanvas* canvas) {
+        MCRec* rec = canvas->fMCRec;
+        if (rec->fDeferredSaveCount > 0) {
+            rec->fDeferredSaveCount -= 1;
+            canvas->internalSave(SkCanvas::kMatrixClip_SaveFlag);
+        }
+    }
+
 private:
     SkMatrix        fMatrixStorage;
     SkRasterClip    fRasterClipStorage;
@@ -542,6 +583,7 @@ SkDrawFilter* SkCanvas::getDrawFilter() const {
 }
 
 SkDrawFilter* SkCanvas::setDrawFilter(SkDrawFilter* filter) {
+    MCRec::CheckForDeferredSave(this);
     SkRefCnt_SafeAssign(fMCRec->fFilter, filter);
     return filter;
 }
@@ -836,7 +878,9 @@ void SkCanvas::willSave(SaveFlags) {
 
 int SkCanvas::save() {
     this->willSave(kMatrixClip_SaveFlag);
-    return this->internalSave(kMatrixClip_SaveFlag);
+    int saveCount = this->getSaveCount();
+    fMCRec->fDeferredSaveCount += 1;
+    return saveCount;
 }
 
 int SkCanvas::save(SaveFlags flags) {
@@ -1005,9 +1049,14 @@ void SkCanvas::willRestore() {
 
 void SkCanvas::restore() {
     // check for underflow
-    if (fMCStack.count() > 1) {
+    if (this->getSaveCount() > 1) {
         this->willRestore();
-        this->internalRestore();
+        if (fMCRec->fDeferredSaveCount > 0) {
+            // nothing changed since the save, so there's nothing to undo
+            fMCRec->fDeferredSaveCount -= 1;
+        } else {
+            this->internalRestore();
+        }
     }
 }
 
@@ -1051,7 +1100,7 @@ void SkCanvas::internalRestore() {
 }
 
 int SkCanvas::getSaveCount() const {
-    return fMCStack.count();
+    return fMCRec->fSaveCount + fMCRec->fDeferredSaveCount;
 }
 
 void SkCanvas::restoreToCount(int count) {
@@ -1275,6 +1324,7 @@ void SkCanvas::internalDrawDevice(SkBaseDevice* srcDev, int x, int y,
 
 void SkCanvas::drawSprite(const SkBitmap& bitmap, int x, int y,
                           const SkPaint* paint) {
+    SK_STATS_INC(kCanvasDrawSprite_Counter);
     if (bitmap.drawsNothing()) {
         return;
     }
@@ -1353,6 +1403,7 @@ void SkCanvas::concat(const SkMatrix& matrix) {
         return;
     }
 
+    MCRec::CheckForDeferredSave(this);
     fDeviceCMDirty = true;
     fCachedLocalClipBoundsDirty = true;
     fMCRec->fMatrix->preConcat(matrix);
@@ -1365,6 +1416,7 @@ void SkCanvas::didSetMatrix(const SkMatrix&) {
 }
 
 void SkCanvas::setMatrix(const SkMatrix& matrix) {
+    MCRec::CheckForDeferredSave(this);
     fDeviceCMDirty = true;
     fCachedLocalClipBoundsDirty = true;
     *fMCRec->fMatrix = matrix;
@@ -1386,6 +1438,7 @@ void SkCanvas::clipRect(const SkRect& rect, SkRegion::Op op, bool doAA) {
 }
 
 void SkCanvas::onClipRect(const SkRect& rect, SkRegion::Op op, ClipEdgeStyle edgeStyle) {
+    MCRec::CheckForDeferredSave(this);
 #ifdef SK_ENABLE_CLIP_QUICKREJECT
     if (SkRegion::kIntersect_Op == op) {
         if (fMCRec->fRasterClip->isEmpty()) {
@@ -1482,6 +1535,7 @@ void SkCanvas::clipRRect(const SkRRect& rrect, SkRegion::Op op, bool doAA) {
 }
 
 void SkCanvas::onClipRRect(const SkRRect& rrect, SkRegion::Op op, ClipEdgeStyle edgeStyle) {
+    MCRec::CheckForDeferredSave(this);
     SkRRect transformedRRect;
     if (rrect.transform(*fMCRec->fMatrix, &transformedRRect)) {
         AutoValidateClip avc(this);
@@ -1518,6 +1572,7 @@ void SkCanvas::clipPath(const SkPath& path, SkRegion::Op op, bool doAA) {
 }
 
 void SkCanvas::onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edgeStyle) {
+    MCRec::CheckForDeferredSave(this);
 #ifdef SK_ENABLE_CLIP_QUICKREJECT
     if (SkRegion::kIntersect_Op == op && !path.isInverseFillType()) {
         if (fMCRec->fRasterClip->isEmpty()) {
@@ -1671,6 +1726,7 @@ void SkCanvas::clipRegion(const SkRegion& rgn, SkRegion::Op op) {
 }
 
 void SkCanvas::onClipRegion(const SkRegion& rgn, SkRegion::Op op) {
+    MCRec::CheckForDeferredSave(this);
     AutoValidateClip avc(this);
 
     fDeviceCMDirty = true;
@@ -1914,6 +1970,11 @@ void SkCanvas::drawDRRect(const SkRRect& outer, const SkRRect& inner,
 
 void SkCanvas::clear(SkColor color) {
     SkDrawIter  iter(this);
+    if (NULL != fSurfaceBase && 0 == fSaveLayerCount) {
+        // Clearing the base layer replaces all of it, so a snapshot's pixels needn't be copied
+        // first; the surface can move to fresh ones as it would for a discard.
+        fSurfaceBase->aboutToDraw(SkSurface::kDiscard_ContentChangeMode);
+    }
     this->predrawNotify();
     while (iter.next()) {
         iter.fDevice->clear(color);
@@ -1927,10 +1988,21 @@ void SkCanvas::onDiscard() {
 }
 
 void SkCanvas::drawPaint(const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawPaint_Counter);
     this->internalDrawPaint(paint);
 }
 
 void SkCanvas::internalDrawPaint(const SkPaint& paint) {
+    if (NULL != fSurfaceBase && 0 == fSaveLayerCount && NULL == fMCRec->fFilter &&
+        paint_replaces_dst(paint)) {
+        const SkISize size = this->getBaseLayerSize();
+        SkRect devRect = SkRect::MakeWH(SkIntToScalar(size.width()),
+                                        SkIntToScalar(size.height()));
+        if (covers_base_layer(*fMCRec->fRasterClip, size, devRect)) {
+            fSurfaceBase->aboutToDraw(SkSurface::kDiscard_ContentChangeMode);
+        }
+    }
+
     LOOPER_BEGIN(paint, SkDrawFilter::kPaint_Type, NULL)
 
     while (iter.next()) {
@@ -1942,6 +2014,7 @@ void SkCanvas::internalDrawPaint(const SkPaint& paint) {
 
 void SkCanvas::drawPoints(PointMode mode, size_t count, const SkPoint pts[],
                           const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawPoints_Counter);
     if ((long)count <= 0) {
         return;
     }
@@ -1973,6 +2046,7 @@ void SkCanvas::drawPoints(PointMode mode, size_t count, const SkPoint pts[],
 }
 
 void SkCanvas::drawRect(const SkRect& r, const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawRect_Counter);
     SkRect storage;
     const SkRect* bounds = NULL;
     if (paint.canComputeFastBounds()) {
@@ -1982,6 +2056,18 @@ void SkCanvas::drawRect(const SkRect& r, const SkPaint& paint) {
         }
     }
 
+    // A rect over the whole surface, drawn the same way as drawPaint() above, lets the surface
+    // skip copying a snapshot's pixels.
+    if (NULL != fSurfaceBase && 0 == fSaveLayerCount && NULL == fMCRec->fFilter &&
+        SkPaint::kFill_Style == paint.getStyle() && NULL == paint.getPathEffect() &&
+        paint_replaces_dst(paint) && fMCRec->fMatrix->rectStaysRect()) {
+        SkRect devRect;
+        fMCRec->fMatrix->mapRect(&devRect, r);
+        if (covers_base_layer(*fMCRec->fRasterClip, this->getBaseLayerSize(), devRect)) {
+            fSurfaceBase->aboutToDraw(SkSurface::kDiscard_ContentChangeMode);
+        }
+    }
+
     LOOPER_BEGIN(paint, SkDrawFilter::kRect_Type, bounds)
 
     while (iter.next()) {
@@ -1992,6 +2078,7 @@ void SkCanvas::drawRect(const SkRect& r, const SkPaint& paint) {
 }
 
 void SkCanvas::drawOval(const SkRect& oval, const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawOval_Counter);
     SkRect storage;
     const SkRect* bounds = NULL;
     if (paint.canComputeFastBounds()) {
@@ -2011,6 +2098,7 @@ void SkCanvas::drawOval(const SkRect& oval, const SkPaint& paint) {
 }
 
 void SkCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawRRect_Counter);
     SkRect storage;
     const SkRect* bounds = NULL;
     if (paint.canComputeFastBounds()) {
@@ -2041,6 +2129,7 @@ void SkCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
 
 void SkCanvas::onDrawDRRect(const SkRRect& outer, const SkRRect& inner,
                             const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawRRect_Counter);
     SkRect storage;
     const SkRect* bounds = NULL;
     if (paint.canComputeFastBounds()) {
@@ -2060,6 +2149,7 @@ void SkCanvas::onDrawDRRect(const SkRRect& outer, const SkRRect& inner,
 }
 
 void SkCanvas::drawPath(const SkPath& path, const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawPath_Counter);
     if (!path.isFinite()) {
         return;
     }
@@ -2093,6 +2183,7 @@ void SkCanvas::drawPath(const SkPath& path, const SkPaint& paint) {
 
 void SkCanvas::drawBitmap(const SkBitmap& bitmap, SkScalar x, SkScalar y,
                           const SkPaint* paint) {
+    SK_STATS_INC(kCanvasDrawBitmap_Counter);
     SkDEBUGCODE(bitmap.validate();)
 
     if (NULL == paint || paint->canComputeFastBounds()) {
@@ -2152,12 +2243,14 @@ void SkCanvas::internalDrawBitmapRect(const SkBitmap& bitmap, const SkRect* src,
 void SkCanvas::drawBitmapRectToRect(const SkBitmap& bitmap, const SkRect* src,
                                     const SkRect& dst, const SkPaint* paint,
                                     DrawBitmapRectFlags flags) {
+    SK_STATS_INC(kCanvasDrawBitmap_Counter);
     SkDEBUGCODE(bitmap.validate();)
     this->internalDrawBitmapRect(bitmap, src, dst, paint, flags);
 }
 
 void SkCanvas::drawBitmapMatrix(const SkBitmap& bitmap, const SkMatrix& matrix,
                                 const SkPaint* paint) {
+    SK_STATS_INC(kCanvasDrawBitmap_Counter);
     SkDEBUGCODE(bitmap.validate();)
     this->internalDrawBitmap(bitmap, matrix, paint);
 }
@@ -2165,12 +2258,15 @@ void SkCanvas::drawBitmapMatrix(const SkBitmap& bitmap, const SkMatrix& matrix,
 void SkCanvas::internalDrawBitmapNine(const SkBitmap& bitmap,
                                       const SkIRect& center, const SkRect& dst,
                                       const SkPaint* paint) {
-    if (bitmap.drawsNothing()) {
+    if (bitmap.drawsNothing() || dst.isEmpty()) {
         return;
     }
+
+    CHECK_LOCKCOUNT_BALANCE(bitmap);
+
+    SkRect storage;
+    const SkRect* bounds = &dst;
     if (NULL == paint || paint->canComputeFastBounds()) {
-        SkRect storage;
-        const SkRect* bounds = &dst;
         if (paint) {
             bounds = &paint->computeFastBounds(dst, &storage);
         }
@@ -2214,26 +2310,45 @@ void SkCanvas::internalDrawBitmapNine(const SkBitmap& bitmap,
         dstY[2] = dstY[1];
     }
 
+    // Pair up the cells that draw something.
+    SkRect srcRects[9], dstRects[9];
+    int cellCount = 0;
     for (int y = 0; y < 3; y++) {
-        SkRect s, d;
-
-        s.fTop = srcY[y];
-        s.fBottom = srcY[y+1];
-        d.fTop = dstY[y];
-        d.fBottom = dstY[y+1];
         for (int x = 0; x < 3; x++) {
-            s.fLeft = srcX[x];
-            s.fRight = srcX[x+1];
-            d.fLeft = dstX[x];
-            d.fRight = dstX[x+1];
-            this->internalDrawBitmapRect(bitmap, &s, d, paint,
-                                         kNone_DrawBitmapRectFlag);
+            SkRect d = SkRect::MakeLTRB(dstX[x], dstY[y], dstX[x+1], dstY[y+1]);
+            SkRect s = SkRect::MakeLTRB(srcX[x], srcY[y], srcX[x+1], srcY[y+1]);
+            if (!d.isEmpty() && !s.isEmpty()) {
+                srcRects[cellCount] = s;
+                dstRects[cellCount] = d;
+                cellCount += 1;
+            }
         }
     }
+
+    SkLazyPaint lazy;
+    if (NULL == paint) {
+        paint = lazy.init();
+    }
+
+    // The cells share one looper pass and one pixel lock, rather than each running the
+    // quick-reject, draw filter and (for lazily decoded bitmaps) the lock on its own.
+    SkAutoLockPixels alp(bitmap);
+
+    LOOPER_BEGIN(*paint, SkDrawFilter::kBitmap_Type, bounds)
+
+    while (iter.next()) {
+        for (int i = 0; i < cellCount; ++i) {
+            iter.fDevice->drawBitmapRect(iter, bitmap, &srcRects[i], dstRects[i],
+                                         looper.paint(), kNone_DrawBitmapRectFlag);
+        }
+    }
+
+    LOOPER_END
 }
 
 void SkCanvas::drawBitmapNine(const SkBitmap& bitmap, const SkIRect& center,
                               const SkRect& dst, const SkPaint* paint) {
+    SK_STATS_INC(kCanvasDrawBitmap_Counter);
     SkDEBUGCODE(bitmap.validate();)
 
     // Need a device entry-point, so gpu can use a mesh
@@ -2335,6 +2450,7 @@ void SkCanvas::DrawTextDecorations(const SkDraw& draw, const SkPaint& paint,
 
 void SkCanvas::onDrawText(const void* text, size_t byteLength, SkScalar x, SkScalar y,
                           const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawText_Counter);
     LOOPER_BEGIN(paint, SkDrawFilter::kText_Type, NULL)
 
     while (iter.next()) {
@@ -2349,6 +2465,7 @@ void SkCanvas::onDrawText(const void* text, size_t byteLength, SkScalar x, SkSca
 
 void SkCanvas::onDrawPosText(const void* text, size_t byteLength, const SkPoint pos[],
                              const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawText_Counter);
     LOOPER_BEGIN(paint, SkDrawFilter::kText_Type, NULL)
 
     while (iter.next()) {
@@ -2362,6 +2479,7 @@ void SkCanvas::onDrawPosText(const void* text, size_t byteLength, const SkPoint
 
 void SkCanvas::onDrawPosTextH(const void* text, size_t byteLength, const SkScalar xpos[],
                               SkScalar constY, const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawText_Counter);
     LOOPER_BEGIN(paint, SkDrawFilter::kText_Type, NULL)
 
     while (iter.next()) {
@@ -2375,6 +2493,7 @@ void SkCanvas::onDrawPosTextH(const void* text, size_t byteLength, const SkScala
 
 void SkCanvas::onDrawTextOnPath(const void* text, size_t byteLength, const SkPath& path,
                                 const SkMatrix* matrix, const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawText_Counter);
     LOOPER_BEGIN(paint, SkDrawFilter::kText_Type, NULL)
 
     while (iter.next()) {
@@ -2408,6 +2527,7 @@ void SkCanvas::drawVertices(VertexMode vmode, int vertexCount,
                             const SkColor colors[], SkXfermode* xmode,
                             const uint16_t indices[], int indexCount,
                             const SkPaint& paint) {
+    SK_STATS_INC(kCanvasDrawVertices_Counter);
     LOOPER_BEGIN(paint, SkDrawFilter::kPath_Type, NULL)
 
     while (iter.next()) {
@@ -2550,6 +2670,7 @@ void SkCanvas::EXPERIMENTAL_purge(SkPicture* picture) {
 }
 
 void SkCanvas::drawPicture(SkPicture& picture) {
+    SK_STATS_INC(kCanvasDrawPicture_Counter);
     SkBaseDevice* device = this->getTopDevice();
     if (NULL != device) {
         // Canvas has to first give the device the opportunity to render
@@ -1,5 +1,6 @@
 #include "SkConfig8888.h"
 #include "SkColorPriv.h"
+#include "SkConfig8888_opts.h"
 #include "SkMathPriv.h"
 #include "SkUnPreMultiply.h"
 
@@ -104,6 +105,22 @@ bool SkSrcPixelInfo::convertPixelsTo(SkDstPixelInfo* dst, int width, int height)
             break;
     }
 
+    // The SIMD versions give the same results, they just get there faster.
+    SkConfig8888Procs platformProcs;
+    if (proc != memcpy32_row && SkConfig8888GetPlatformProcs(&platformProcs)) {
+        SkConvert32RowProc platformProc;
+        if (kNothing_AlphaVerb == doAlpha) {
+            platformProc = platformProcs.fSwapRB;
+        } else if (kPremul_AlphaVerb == doAlpha) {
+            platformProc = doSwapRB ? platformProcs.fPremulSwapRB : platformProcs.fPremul;
+        } else {
+            platformProc = doSwapRB ? platformProcs.fUnpremulSwapRB : platformProcs.fUnpremul;
+        }
+        if (NULL != platformProc) {
+            proc = platformProc;
+        }
+    }
+
     uint32_t* dstP = static_cast<uint32_t*>(dst->fPixels);
     const uint32_t* srcP = static_cast<const uint32_t*>(fPixels);
     size_t srcInc = fRowBytes >> 2;
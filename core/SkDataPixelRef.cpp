@@ -0,0 +1,63 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDataPixelRef.h"
+#include "SkBitmap.h"
+
+SkDataPixelRef::SkDataPixelRef(const SkImageInfo& info, SkData* data,
+                               const void* pixels, size_t rowBytes)
+    : INHERITED(info)
+    , fData(SkRef(data))
+    , fPixels(pixels)
+    , fRowBytes(rowBytes)
+{
+    SkASSERT(fPixels >= fData->data());
+    this->setImmutable();
+    // We rely on the immutability of the pixels to make the const_cast okay.
+    this->setPreLocked(const_cast<void*>(fPixels), fRowBytes, NULL);
+}
+
+SkDataPixelRef::~SkDataPixelRef() {
+    fData->unref();
+}
+
+bool SkDataPixelRef::onNewLockPixels(LockRec* rec) {
+    rec->fPixels = const_cast<void*>(fPixels);
+    rec->fColorTable = NULL;
+    rec->fRowBytes = fRowBytes;
+    return true;
+}
+
+static bool reset_return_false(SkBitmap* bm) {
+    bm->reset();
+    return false;
+}
+
+bool SkInstallDataPixelRef(SkData* data, size_t offset, const SkImageInfo& info,
+                           size_t rowBytes, SkBitmap* dst) {
+    SkASSERT(data != NULL);
+    SkASSERT(dst != NULL);
+    if (kIndex_8_SkColorType == info.fColorType || !dst->setConfig(info, rowBytes)) {
+        return reset_return_false(dst);
+    }
+    rowBytes = dst->rowBytes();
+
+    const size_t size = dst->getSafeSize();
+    if (0 == size || offset > data->size() || data->size() - offset < size) {
+        return reset_return_false(dst);
+    }
+
+    const uint8_t* pixels = data->bytes() + offset;
+    const size_t alignMask = info.bytesPerPixel() - 1;
+    if (((reinterpret_cast<uintptr_t>(pixels) | rowBytes) & alignMask) != 0) {
+        return reset_return_false(dst);
+    }
+
+    dst->setPixelRef(SkNEW_ARGS(SkDataPixelRef, (dst->info(), data, pixels, rowBytes)))->unref();
+    dst->lockPixels();
+    return true;
+}
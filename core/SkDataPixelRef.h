@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDataPixelRef_DEFINED
+#define SkDataPixelRef_DEFINED
+
+#include "SkData.h"
+#include "SkImageInfo.h"
+#include "SkPixelRef.h"
+
+class SkBitmap;
+
+/**
+ *  A PixelRef that points straight at uncompressed pixels held in an SkData,
+ *  usually a memory mapped file (SkData::NewFromFileName or NewFromFD). The
+ *  pixels are never copied: the OS faults pages in as they are drawn, and
+ *  they stay clean pages that can be dropped and shared between processes.
+ *
+ *  The pixels are immutable. Index8 is not supported, since there is no
+ *  color table to go with them.
+ */
+class SkDataPixelRef : public SkPixelRef {
+public:
+    SK_DECLARE_INST_COUNT(SkDataPixelRef)
+    SK_DECLARE_UNFLATTENABLE_OBJECT()
+
+protected:
+    virtual ~SkDataPixelRef();
+
+    virtual bool onNewLockPixels(LockRec*) SK_OVERRIDE;
+    virtual void onUnlockPixels() SK_OVERRIDE {}
+    virtual bool onLockPixelsAreWritable() const SK_OVERRIDE { return false; }
+
+    // getAllocatedSizeInBytes() keeps the default of zero, since none of the
+    // pixels were allocated on the heap.
+
+private:
+    SkData* const   fData;
+    const void*     fPixels;    // points into fData
+    const size_t    fRowBytes;
+
+    SkDataPixelRef(const SkImageInfo&, SkData*, const void* pixels, size_t rowBytes);
+
+    friend bool SkInstallDataPixelRef(SkData*, size_t, const SkImageInfo&, size_t, SkBitmap*);
+
+    typedef SkPixelRef INHERITED;
+};
+
+/**
+ *  Points dst at the info sized pixels found offset bytes into data, with the
+ *  given rowBytes (0 means info.minRowBytes()), without copying them. The
+ *  alpha type is taken from info, so opaque assets should say so there.
+ *
+ *  Returns false and resets dst if info is not supported, if the pixels do not
+ *  fit within data, or if they are not aligned to their bytes per pixel.
+ */
+bool SkInstallDataPixelRef(SkData* data, size_t offset, const SkImageInfo& info,
+                           size_t rowBytes, SkBitmap* dst);
+
+#endif  // SkDataPixelRef_DEFINED
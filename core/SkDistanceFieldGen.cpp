@@ -6,6 +6,7 @@
  */
 
 #include "SkDistanceFieldGen.h"
+#include "SkDistanceField_opts.h"
 #include "SkPoint.h"
 
 struct DFData {
@@ -13,6 +14,8 @@ struct DFData {
     float   fDistSq;     // distance squared to nearest (so far) edge texel
     SkPoint fDistVector; // distance vector to nearest (so far) edge texel
 };
+// SkDistanceFieldRowProc sees each texel as four floats.
+SK_COMPILE_ASSERT(sizeof(DFData) == 4*sizeof(float), DFData_must_be_four_floats);
 
 enum NeighborFlags {
     kLeft_NeighborFlag        = 0x01,
@@ -191,71 +194,9 @@ static void init_distances(DFData* data, unsigned char* edges, int width, int he
 
 // Danielsson's 8SSEDT
 
-// first stage forward pass
-// (forward in Y, forward in X)
-static void F1(DFData* curr, int width) {
-    // upper left
-    DFData* check = curr - width-1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*(distVec.fX + distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // up
-    check = curr - width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // upper right
-    check = curr - width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX - distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-
-    // left
-    check = curr - 1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-}
-
-// second stage forward pass
-// (forward in Y, backward in X)
-static void F2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    float distSq = check->fDistSq;
-    SkPoint distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
-}
-
-// first stage backward pass
-// (backward in Y, forward in X)
-static void B1(DFData* curr, int width) {
-    // left
+// The texels above or below come from SkDistanceFieldRowProc, a row at a time. These take the
+// texels to the left and right, which depend on the texel just done.
+static void check_left(DFData* curr) {
     DFData* check = curr - 1;
     SkPoint distVec = check->fDistVector;
     float distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
@@ -266,10 +207,7 @@ static void B1(DFData* curr, int width) {
     }
 }
 
-// second stage backward pass
-// (backward in Y, backwards in X)
-static void B2(DFData* curr, int width) {
-    // right
+static void check_right(DFData* curr) {
     DFData* check = curr + 1;
     SkPoint distVec = check->fDistVector;
     float distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
@@ -278,37 +216,24 @@ static void B2(DFData* curr, int width) {
         curr->fDistSq = distSq;
         curr->fDistVector = distVec;
     }
+}
 
-    // bottom left
-    check = curr + width-1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*(distVec.fX - distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+// Propagates distances into one row (but its outer buffer) from the row above (dy = -1) or
+// below (dy = 1), then forwards and backwards in x. Edge texels keep their initial distances.
+static void propagate_row(DFData* row, const unsigned char* edges, int width, float dy,
+                          SkDistanceFieldRowProc rowProc) {
+    const DFData* other = row + (dy < 0 ? -width : width);
+    rowProc(&row[1].fAlpha, &other[1].fAlpha, edges + 1, width - 2, dy);
 
-    // bottom
-    check = curr + width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    for (int i = 1; i < width-1; ++i) {
+        if (!edges[i]) {
+            check_left(&row[i]);
+        }
     }
-
-    // bottom right
-    check = curr + width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX + distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    for (int i = width-2; i > 0; --i) {
+        if (!edges[i]) {
+            check_right(&row[i]);
+        }
     }
 }
 
@@ -362,70 +287,24 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
     init_distances(dataPtr, edgePtr, dataWidth, dataHeight);
 
     // now perform Euclidean distance transform to propagate distances
+    SkDistanceFieldRowProc rowProc = SkDistanceFieldGetPlatformRowProc();
+    if (NULL == rowProc) {
+        rowProc = SkDistanceFieldRow;
+    }
 
-    // forwards in y
-    DFData* currData = dataPtr+dataWidth+1; // skip outer buffer
-    unsigned char* currEdge = edgePtr+dataWidth+1;
+    // forwards in y, skipping the outer buffer
     for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData += dataWidth+1;
-        currEdge += dataWidth+1;
+        propagate_row(dataPtr + j*dataWidth, edgePtr + j*dataWidth, dataWidth, -1.0f, rowProc);
     }
 
     // backwards in y
-    currData = dataPtr+dataWidth*(dataHeight-2) - 1; // skip outer buffer
-    currEdge = edgePtr+dataWidth*(dataHeight-2) - 1;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData -= dataWidth-1;
-        currEdge -= dataWidth-1;
+    for (int j = dataHeight-2; j > 0; --j) {
+        propagate_row(dataPtr + j*dataWidth, edgePtr + j*dataWidth, dataWidth, 1.0f, rowProc);
     }
 
     // copy results to final distance field data
-    currData = dataPtr + dataWidth+1;
-    currEdge = edgePtr + dataWidth+1;
+    DFData* currData = dataPtr + dataWidth+1;
+    unsigned char* currEdge = edgePtr + dataWidth+1;
     unsigned char *dfPtr = distanceField;
     for (int j = 1; j < dataHeight-1; ++j) {
         for (int i = 1; i < dataWidth-1; ++i) {
@@ -30,6 +30,7 @@
 #include "SkAutoKern.h"
 #include "SkBitmapProcShader.h"
 #include "SkDrawProcs.h"
+#include "SkGlyphBatcher.h"
 #include "SkMatrixUtils.h"
 
 
@@ -381,32 +382,24 @@ static void bw_pt_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
 
 static void bw_line_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count; i += 2) {
-        SkScan::HairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::HairLines(devPts, count, SkScan::kLines_LineMode, *rec.fRC, blitter);
 }
 
 static void bw_poly_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count - 1; i++) {
-        SkScan::HairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::HairLines(devPts, count, SkScan::kPolyline_LineMode, *rec.fRC, blitter);
 }
 
 // aa versions
 
 static void aa_line_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count; i += 2) {
-        SkScan::AntiHairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::AntiHairLines(devPts, count, SkScan::kLines_LineMode, *rec.fRC, blitter);
 }
 
 static void aa_poly_hair_proc(const PtProcRec& rec, const SkPoint devPts[],
                               int count, SkBlitter* blitter) {
-    for (int i = 0; i < count - 1; i++) {
-        SkScan::AntiHairLine(devPts[i], devPts[i+1], *rec.fRC, blitter);
-    }
+    SkScan::AntiHairLines(devPts, count, SkScan::kPolyline_LineMode, *rec.fRC, blitter);
 }
 
 // square procs (strokeWidth > 0 but matrix is square-scale (sx == sy)
@@ -553,6 +546,127 @@ static bool bounder_points(SkBounder* bounder, SkCanvas::PointMode mode,
 // must be even for lines/polygon to work
 #define MAX_DEV_PTS     32
 
+#ifndef SK_DISABLE_DASHING_OPTIMIZATION
+/**
+ *  Blits the dashes of an axis-aligned line with a two interval dash straight
+ *  from their rects, instead of expanding them into a path that is then
+ *  stroked and scan converted. Returns false, having drawn nothing, if the
+ *  line isn't such a case.
+ */
+static bool draw_dash_spans(const SkDraw& draw, const SkPoint pts[2],
+                            const SkPaint& paint) {
+    const SkPathEffect* pe = paint.getPathEffect();
+    SkPathEffect::DashInfo info;
+    if (SkPathEffect::kDash_DashType != pe->asADash(&info) || 2 != info.fCount) {
+        return false;
+    }
+    SkScalar intervals[2];
+    info.fIntervals = intervals;
+    pe->asADash(&info);
+
+    const SkScalar width = paint.getStrokeWidth();
+    if (SkPaint::kStroke_Style != paint.getStyle() || width <= 0 ||
+        SkPaint::kRound_Cap == paint.getStrokeCap() ||
+        NULL != paint.getMaskFilter() || NULL != paint.getRasterizer()) {
+        return false;
+    }
+
+    const SkMatrix& matrix = *draw.fMatrix;
+    const bool horizontal = pts[0].fY == pts[1].fY;
+    if (horizontal == (pts[0].fX == pts[1].fX) || !matrix.rectStaysRect()) {
+        // diagonal, or just a point
+        return false;
+    }
+
+    const SkScalar on = intervals[0];
+    const SkScalar period = intervals[0] + intervals[1];
+    const SkScalar phase = info.fPhase;
+    const SkScalar halfWidth = SkScalarHalf(width);
+    const SkScalar cap = SkPaint::kSquare_Cap == paint.getStrokeCap() ? halfWidth : 0;
+    SkScalar length = horizontal ? pts[1].fX - pts[0].fX : pts[1].fY - pts[0].fY;
+    const SkScalar dir = length < 0 ? -SK_Scalar1 : SK_Scalar1;
+    length = SkScalarAbs(length);
+    if (!SkScalarIsFinite(period) || period <= 0 || phase < 0 || phase >= period) {
+        return false;
+    }
+
+    static const SkScalar kMaxDashCount = 1000000;
+    const SkScalar dashCountScalar = SkScalarDiv(length + phase, period);
+    if (!(dashCountScalar <= kMaxDashCount)) {
+        return false;
+    }
+    const int dashCount = SkScalarCeilToInt(dashCountScalar);
+
+    if (paint.isAntiAlias()) {
+        // Antialiased dashes closer than a pixel would share pixels, and blend
+        // them twice.
+        SkVector gap = { horizontal ? intervals[1] - 2 * cap : 0,
+                         horizontal ? 0 : intervals[1] - 2 * cap };
+        matrix.mapVectors(&gap, 1);
+        if (gap.length() < SK_Scalar1) {
+            return false;
+        }
+    }
+
+    // The local rect of the whole line, for the quick reject.
+    SkRect bounds;
+    bounds.set(pts, 2);
+    if (horizontal) {
+        bounds.outset(cap, halfWidth);
+    } else {
+        bounds.outset(halfWidth, cap);
+    }
+    matrix.mapRect(&bounds);
+    SkIRect ir;
+    bounds.roundOut(&ir);
+    if (draw.fRC->quickReject(ir)) {
+        return true;
+    }
+
+    SkDeviceLooper looper(*draw.fBitmap, *draw.fRC, ir, paint.isAntiAlias());
+    while (looper.next()) {
+        SkMatrix localMatrix;
+        looper.mapMatrix(&localMatrix, matrix);
+
+        SkAutoBlitterChoose blitterStorage(looper.getBitmap(), localMatrix,
+                                           paint);
+        const SkRasterClip& clip = looper.getRC();
+        SkBlitter*          blitter = blitterStorage.get();
+
+        for (int i = 0; i < dashCount; ++i) {
+            // As SkDashPathEffect does, trim each dash to the line and then cap it.
+            SkScalar start = i * period - phase;
+            SkScalar end = SkMinScalar(start + on, length);
+            start = SkMaxScalar(start, 0);
+            if (end < start || (end == start && on > 0)) {
+                continue;
+            }
+            SkScalar s0 = SkScalarMul(start - cap, dir);
+            SkScalar s1 = SkScalarMul(end + cap, dir);
+
+            SkRect r;
+            if (horizontal) {
+                r.set(pts[0].fX + s0, pts[0].fY - halfWidth,
+                      pts[0].fX + s1, pts[0].fY + halfWidth);
+            } else {
+                r.set(pts[0].fX - halfWidth, pts[0].fY + s0,
+                      pts[0].fX + halfWidth, pts[0].fY + s1);
+            }
+            r.sort();
+            matrix.mapRect(&r);
+            looper.mapRect(&r, r);
+
+            if (paint.isAntiAlias()) {
+                SkScan::AntiFillRect(r, clip, blitter);
+            } else {
+                SkScan::FillRect(r, clip, blitter);
+            }
+        }
+    }
+    return true;
+}
+#endif // SK_DISABLE_DASHING_OPTIMIZATION
+
 void SkDraw::drawPoints(SkCanvas::PointMode mode, size_t count,
                         const SkPoint pts[], const SkPaint& paint,
                         bool forceUseDevice) const {
@@ -657,6 +771,10 @@ void SkDraw::drawPoints(SkCanvas::PointMode mode, size_t count,
             }
             case SkCanvas::kLines_PointMode:
 #ifndef SK_DISABLE_DASHING_OPTIMIZATION
+                if (2 == count && NULL != paint.getPathEffect() && !forceUseDevice &&
+                    draw_dash_spans(*this, pts, paint)) {
+                    break;
+                }
                 if (2 == count && NULL != paint.getPathEffect()) {
                     // most likely a dashed line - see if it is one of the ones
                     // we can accelerate
@@ -1756,8 +1874,9 @@ void SkDraw::drawText(const char text[], size_t byteLength,
     SkFixed fx = SkScalarToFixed(x) + d1g.fHalfSampleX;
     SkFixed fy = SkScalarToFixed(y) + d1g.fHalfSampleY;
 
+    SkGlyphBatcher batcher(cache, paint, stop);
     while (text < stop) {
-        const SkGlyph& glyph = glyphCacheProc(cache, &text, fx & fxMask, fy & fyMask);
+        const SkGlyph& glyph = batcher.next(&text, fx & fxMask, fy & fyMask);
 
         fx += autokern.adjust(glyph);
 
@@ -2031,10 +2150,11 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
             }
         }
     } else {    // not subpixel
+        SkGlyphBatcher batcher(cache, paint, stop);
         if (SkPaint::kLeft_Align == paint.getTextAlign()) {
             while (text < stop) {
                 // the last 2 parameters are ignored
-                const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+                const SkGlyph& glyph = batcher.next(&text, 0, 0);
 
                 if (glyph.fWidth) {
                     tmsProc(tms, pos);
@@ -2049,7 +2169,7 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
         } else {
             while (text < stop) {
                 // the last 2 parameters are ignored
-                const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+                const SkGlyph& glyph = batcher.next(&text, 0, 0);
 
                 if (glyph.fWidth) {
                     tmsProc(tms, pos);
@@ -2329,13 +2449,16 @@ VertState::Proc VertState::chooseProc(SkCanvas::VertexMode mode) {
     }
 }
 
-typedef void (*HairProc)(const SkPoint&, const SkPoint&, const SkRasterClip&,
-                         SkBlitter*);
+typedef void (*HairLinesProc)(const SkPoint[], int count, SkScan::LineMode,
+                              const SkRasterClip&, SkBlitter*);
 
-static HairProc ChooseHairProc(bool doAntiAlias) {
-    return doAntiAlias ? SkScan::AntiHairLine : SkScan::HairLine;
+static HairLinesProc ChooseHairLinesProc(bool doAntiAlias) {
+    return doAntiAlias ? SkScan::AntiHairLines : SkScan::HairLines;
 }
 
+// How many wireframe triangles are drawn with one hairline call.
+static const int kWireframeBatchTriangles = 32;
+
 static bool texture_to_matrix(const VertState& state, const SkPoint verts[],
                               const SkPoint texs[], SkMatrix* matrix) {
     SkPoint src[3], dst[3];
@@ -2360,13 +2483,16 @@ public:
         TriColorShaderContext(const SkTriColorShader& shader, const ContextRec&);
         virtual ~TriColorShaderContext();
 
-        bool setup(const SkPoint pts[], const SkColor colors[], int, int, int);
+        bool setup(const SkPoint pts[], const SkPMColor colors[], int, int, int);
 
         virtual void shadeSpan(int x, int y, SkPMColor dstC[], int count) SK_OVERRIDE;
 
     private:
         SkMatrix    fDstToUnit;
         SkPMColor   fColors[3];
+        // Inverted once, rather than for each triangle of the mesh.
+        SkMatrix    fCTMInverse;
+        bool        fCTMInvertible;
 
         typedef SkShader::Context INHERITED;
     };
@@ -2385,12 +2511,15 @@ private:
     typedef SkShader INHERITED;
 };
 
-bool SkTriColorShader::TriColorShaderContext::setup(const SkPoint pts[], const SkColor colors[],
+bool SkTriColorShader::TriColorShaderContext::setup(const SkPoint pts[], const SkPMColor colors[],
                                                     int index0, int index1, int index2) {
+    if (!fCTMInvertible) {
+        return false;
+    }
 
-    fColors[0] = SkPreMultiplyColor(colors[index0]);
-    fColors[1] = SkPreMultiplyColor(colors[index1]);
-    fColors[2] = SkPreMultiplyColor(colors[index2]);
+    fColors[0] = colors[index0];
+    fColors[1] = colors[index1];
+    fColors[2] = colors[index2];
 
     SkMatrix m, im;
     m.reset();
@@ -2403,13 +2532,7 @@ bool SkTriColorShader::TriColorShaderContext::setup(const SkPoint pts[], const S
     if (!m.invert(&im)) {
         return false;
     }
-    // We can't call getTotalInverse(), because we explicitly don't want to look at the localmatrix
-    // as our interators are intrinsically tied to the vertices, and nothing else.
-    SkMatrix ctmInv;
-    if (!this->getCTM().invert(&ctmInv)) {
-        return false;
-    }
-    fDstToUnit.setConcat(im, ctmInv);
+    fDstToUnit.setConcat(im, fCTMInverse);
     return true;
 }
 
@@ -2430,7 +2553,11 @@ static int ScalarTo256(SkScalar v) {
 
 SkTriColorShader::TriColorShaderContext::TriColorShaderContext(const SkTriColorShader& shader,
                                                                const ContextRec& rec)
-    : INHERITED(shader, rec) {}
+    : INHERITED(shader, rec) {
+    // We can't call getTotalInverse(), because we explicitly don't want to look at the localmatrix
+    // as our interators are intrinsically tied to the vertices, and nothing else.
+    fCTMInvertible = this->getCTM().invert(&fCTMInverse);
+}
 
 SkTriColorShader::TriColorShaderContext::~TriColorShaderContext() {}
 
@@ -2440,11 +2567,23 @@ size_t SkTriColorShader::contextSize() const {
 void SkTriColorShader::TriColorShaderContext::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
     const int alphaScale = Sk255To256(this->getPaintAlpha());
 
+    // Without perspective the barycentric coordinates are linear along the span, so they are
+    // mapped once and stepped from there. Each pixel is offset from the start of the span
+    // rather than accumulated, so long spans don't drift.
+    const bool linear = !fDstToUnit.hasPerspective();
+    SkPoint start;
+    fDstToUnit.mapXY(SkIntToScalar(x), SkIntToScalar(y), &start);
+    const SkScalar dx = fDstToUnit.getScaleX();
+    const SkScalar dy = fDstToUnit.getSkewY();
+
     SkPoint src;
 
     for (int i = 0; i < count; i++) {
-        fDstToUnit.mapXY(SkIntToScalar(x), SkIntToScalar(y), &src);
-        x += 1;
+        if (linear) {
+            src.set(start.fX + SkIntToScalar(i) * dx, start.fY + SkIntToScalar(i) * dy);
+        } else {
+            fDstToUnit.mapXY(SkIntToScalar(x + i), SkIntToScalar(y), &src);
+        }
 
         int scale1 = ScalarTo256(src.fX);
         int scale2 = ScalarTo256(src.fY);
@@ -2561,16 +2700,36 @@ void SkDraw::drawVertices(SkCanvas::VertexMode vmode, int count,
     VertState       state(count, indices, indexCount);
     VertState::Proc vertProc = state.chooseProc(vmode);
 
+    // Strips, fans and indexed meshes share each vertex between several triangles, so the
+    // colors are premultiplied once per vertex rather than once per triangle corner.
+    SkAutoSTMalloc<16, SkPMColor> pmColorStorage;
+    const SkPMColor* pmColors = NULL;
+    if (NULL != colors) {
+        SkPMColor* dst = pmColorStorage.reset(count);
+        for (int i = 0; i < count; ++i) {
+            dst[i] = SkPreMultiplyColor(colors[i]);
+        }
+        pmColors = dst;
+    }
+
     if (NULL != textures || NULL != colors) {
+        // Quads (and sprites sharing a transform) map their triangles with the same matrix, so
+        // the shader context, with its bitmap proc state, only needs resetting when it changes.
+        SkMatrix prevM;
+        bool prevMValid = false;
         while (vertProc(&state)) {
             if (NULL != textures) {
                 SkMatrix tempM;
-                if (texture_to_matrix(state, vertices, textures, &tempM)) {
+                if (texture_to_matrix(state, vertices, textures, &tempM) &&
+                    !(prevMValid && tempM == prevM)) {
                     SkShader::ContextRec rec(*fBitmap, p, *fMatrix);
                     rec.fLocalMatrix = &tempM;
                     if (!blitter->resetShaderContext(rec)) {
+                        prevMValid = false;
                         continue;
                     }
+                    prevM = tempM;
+                    prevMValid = true;
                 }
             }
             if (NULL != colors) {
@@ -2593,7 +2752,7 @@ void SkDraw::drawVertices(SkCanvas::VertexMode vmode, int count,
                             static_cast<SkTriColorShader::TriColorShaderContext*>(shaderContextA);
                 }
 
-                if (!triColorShaderContext->setup(vertices, colors,
+                if (!triColorShaderContext->setup(vertices, pmColors,
                                                   state.f0, state.f1, state.f2)) {
                     continue;
                 }
@@ -2605,13 +2764,29 @@ void SkDraw::drawVertices(SkCanvas::VertexMode vmode, int count,
             SkScan::FillTriangle(tmp, *fRC, blitter.get());
         }
     } else {
-        // no colors[] and no texture
-        HairProc hairProc = ChooseHairProc(paint.isAntiAlias());
+        // no colors[] and no texture: the edges are batched, in the order they were always
+        // drawn, so the clip is set up once per batch rather than once per edge.
+        HairLinesProc hairLinesProc = ChooseHairLinesProc(paint.isAntiAlias());
         const SkRasterClip& clip = *fRC;
+        SkPoint edges[kWireframeBatchTriangles * 6];
+        SkPoint* edge = edges;
         while (vertProc(&state)) {
-            hairProc(devVerts[state.f0], devVerts[state.f1], clip, blitter.get());
-            hairProc(devVerts[state.f1], devVerts[state.f2], clip, blitter.get());
-            hairProc(devVerts[state.f2], devVerts[state.f0], clip, blitter.get());
+            edge[0] = devVerts[state.f0];
+            edge[1] = devVerts[state.f1];
+            edge[2] = devVerts[state.f1];
+            edge[3] = devVerts[state.f2];
+            edge[4] = devVerts[state.f2];
+            edge[5] = devVerts[state.f0];
+            edge += 6;
+            if (edge == edges + SK_ARRAY_COUNT(edges)) {
+                hairLinesProc(edges, SK_ARRAY_COUNT(edges), SkScan::kLines_LineMode, clip,
+                              blitter.get());
+                edge = edges;
+            }
+        }
+        if (edge > edges) {
+            hairLinesProc(edges, SkToInt(edge - edges), SkScan::kLines_LineMode, clip,
+                          blitter.get());
         }
     }
 }
@@ -12,13 +12,59 @@
 #include "SkLineClipper.h"
 #include "SkGeometry.h"
 
-template <typename T> static T* typedAllocThrow(SkChunkAlloc& alloc) {
+SkEdgeBuilder::EdgeStorage::~EdgeStorage() {
+    this->rewind();
+    sk_free(fBlock);
+}
+
+void* SkEdgeBuilder::EdgeStorage::allocThrow(size_t bytes) {
+    bytes = SkAlign4(bytes);
+    fNeeded += bytes;
+    if (bytes <= fCapacity - fUsed) {
+        char* ptr = fBlock + fUsed;
+        fUsed += bytes;
+        return ptr;
+    }
+    if (bytes > fChunkLeft) {
+        size_t chunkSize = SkTMax<size_t>(bytes, SkTMax<size_t>(fCapacity, kMinChunkSize));
+        fChunkPtr = (char*)sk_malloc_throw(chunkSize);
+        fChunkLeft = chunkSize;
+        *fChunks.append() = fChunkPtr;
+    }
+    char* ptr = fChunkPtr;
+    fChunkPtr += bytes;
+    fChunkLeft -= bytes;
+    return ptr;
+}
+
+void SkEdgeBuilder::EdgeStorage::rewind() {
+    if (!fChunks.isEmpty()) {
+        for (int i = 0; i < fChunks.count(); ++i) {
+            sk_free(fChunks[i]);
+        }
+        fChunks.rewind();
+        fChunkPtr = NULL;
+        fChunkLeft = 0;
+
+        // Make room for a path like this one next time, with some to spare.
+        size_t capacity = SkTMin<size_t>(fNeeded + (fNeeded >> 1), kMaxRetainedSize);
+        if (capacity > fCapacity) {
+            sk_free(fBlock);
+            fBlock = (char*)sk_malloc_flags(capacity, 0);
+            fCapacity = fBlock ? capacity : 0;
+        }
+    }
+    fUsed = 0;
+    fNeeded = 0;
+}
+
+template <typename T, typename Alloc> static T* typedAllocThrow(Alloc& alloc) {
     return static_cast<T*>(alloc.allocThrow(sizeof(T)));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SkEdgeBuilder::SkEdgeBuilder() : fAlloc(16*1024) {
+SkEdgeBuilder::SkEdgeBuilder() {
     fEdgeList = NULL;
 }
 
@@ -163,8 +209,8 @@ static void handle_quad(SkEdgeBuilder* builder, const SkPoint pts[3]) {
 
 int SkEdgeBuilder::build(const SkPath& path, const SkIRect* iclip,
                          int shiftUp) {
-    fAlloc.reset();
-    fList.reset();
+    fAlloc.rewind();
+    fList.rewind();
     fShiftUp = shiftUp;
 
     SkScalar conicTol = SK_ScalarHalf * (1 << shiftUp);
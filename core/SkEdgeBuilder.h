@@ -8,7 +8,6 @@
 #ifndef SkEdgeBuilder_DEFINED
 #define SkEdgeBuilder_DEFINED
 
-#include "SkChunkAlloc.h"
 #include "SkRect.h"
 #include "SkTDArray.h"
 
@@ -21,13 +20,44 @@ public:
     SkEdgeBuilder();
 
     // returns the number of built edges. The array of those edge pointers
-    // is returned from edgeList().
+    // is returned from edgeList(). The edges of the previous build() are
+    // freed, but their memory is kept for this one, so a builder that is
+    // reused for many paths soon stops allocating.
     int build(const SkPath& path, const SkIRect* clip, int shiftUp);
 
     SkEdge** edgeList() { return fEdgeList; }
 
 private:
-    SkChunkAlloc        fAlloc;
+    /*
+     *  Edge memory that lives from one build() to the next. What doesn't fit
+     *  in the block goes into overflow chunks, and rewind() swaps those for
+     *  one block big enough for all of it, up to kMaxRetainedSize.
+     */
+    class EdgeStorage {
+    public:
+        EdgeStorage() : fBlock(NULL), fCapacity(0), fUsed(0), fNeeded(0),
+                        fChunkPtr(NULL), fChunkLeft(0) {}
+        ~EdgeStorage();
+
+        void* allocThrow(size_t bytes);
+        void rewind();
+
+    private:
+        enum {
+            kMinChunkSize = 16 * 1024,
+            kMaxRetainedSize = 256 * 1024
+        };
+
+        char*           fBlock;
+        size_t          fCapacity;
+        size_t          fUsed;
+        size_t          fNeeded;     // bytes asked for since the last rewind()
+        SkTDArray<char*> fChunks;
+        char*           fChunkPtr;
+        size_t          fChunkLeft;
+    };
+
+    EdgeStorage         fAlloc;
     SkTDArray<SkEdge*>  fList;
 
     /*
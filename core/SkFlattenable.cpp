@@ -6,7 +6,9 @@
  * found in the LICENSE file.
  */
 #include "SkFlattenable.h"
+#include "SkOnce.h"
 #include "SkPtrRecorder.h"
+#include "SkTSort.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -100,46 +102,119 @@ static void report_no_entries(const char* functionName) {
 }
 #endif
 
+/*  Once the flattenables are initialized the entries registered so far are frozen into two
+    sorted indices, one by name and one by factory, so lookups are binary searches instead of
+    walks over every entry. Anything registered later is searched linearly, newest first, as
+    before. Equal keys are sorted newest first, so the latest registration still wins.
+*/
+static int gIndexedCount;
+static uint16_t gByName[MAX_ENTRY_COUNT];
+static uint16_t gByFactory[MAX_ENTRY_COUNT];
+
+static bool name_less_than(const uint16_t& a, const uint16_t& b) {
+    int cmp = strcmp(gEntries[a].fName, gEntries[b].fName);
+    return cmp < 0 || (0 == cmp && a > b);
+}
+
+static bool factory_less_than(const uint16_t& a, const uint16_t& b) {
+    uintptr_t fa = (uintptr_t)gEntries[a].fFactory;
+    uintptr_t fb = (uintptr_t)gEntries[b].fFactory;
+    return fa < fb || (fa == fb && a > b);
+}
+
+static void build_indices(int) {
+    const int count = gCount;
+    for (int i = 0; i < count; ++i) {
+        gByName[i] = gByFactory[i] = SkToU16(i);
+    }
+    if (count > 1) {
+        SkTQSort(gByName, gByName + count - 1, name_less_than);
+        SkTQSort(gByFactory, gByFactory + count - 1, factory_less_than);
+    }
+    gIndexedCount = count;
+}
+
+static void init_entries_if_needed() {
+    SkFlattenable::InitializeFlattenablesIfNeeded();
+    SK_DECLARE_STATIC_ONCE(once);
+    SkOnce(&once, build_indices, 0);
+}
+
+// Returns the newest entry with the name, or NULL.
+static const Entry* find_name(const char name[]) {
+    for (int i = gCount - 1; i >= gIndexedCount; --i) {
+        if (strcmp(gEntries[i].fName, name) == 0) {
+            return &gEntries[i];
+        }
+    }
+    int lo = 0;
+    int hi = gIndexedCount;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (strcmp(gEntries[gByName[mid]].fName, name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < gIndexedCount && strcmp(gEntries[gByName[lo]].fName, name) == 0) {
+        return &gEntries[gByName[lo]];
+    }
+    return NULL;
+}
+
+// Returns the newest entry with the factory, or NULL.
+static const Entry* find_factory(SkFlattenable::Factory fact) {
+    for (int i = gCount - 1; i >= gIndexedCount; --i) {
+        if (gEntries[i].fFactory == fact) {
+            return &gEntries[i];
+        }
+    }
+    const uintptr_t key = (uintptr_t)fact;
+    int lo = 0;
+    int hi = gIndexedCount;
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if ((uintptr_t)gEntries[gByFactory[mid]].fFactory < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < gIndexedCount && gEntries[gByFactory[lo]].fFactory == fact) {
+        return &gEntries[gByFactory[lo]];
+    }
+    return NULL;
+}
+
 SkFlattenable::Factory SkFlattenable::NameToFactory(const char name[]) {
-    InitializeFlattenablesIfNeeded();
+    init_entries_if_needed();
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (strcmp(entries[i].fName, name) == 0) {
-            return entries[i].fFactory;
-        }
-    }
-    return NULL;
+    const Entry* entry = find_name(name);
+    return entry ? entry->fFactory : NULL;
 }
 
 bool SkFlattenable::NameToType(const char name[], SkFlattenable::Type* type) {
     SkASSERT(NULL != type);
-    InitializeFlattenablesIfNeeded();
+    init_entries_if_needed();
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (strcmp(entries[i].fName, name) == 0) {
-            *type = entries[i].fType;
-            return true;
-        }
+    const Entry* entry = find_name(name);
+    if (NULL == entry) {
+        return false;
     }
-    return false;
+    *type = entry->fType;
+    return true;
 }
 
 const char* SkFlattenable::FactoryToName(Factory fact) {
-    InitializeFlattenablesIfNeeded();
+    init_entries_if_needed();
 #ifdef SK_DEBUG
     report_no_entries(__FUNCTION__);
 #endif
-    const Entry* entries = gEntries;
-    for (int i = gCount - 1; i >= 0; --i) {
-        if (entries[i].fFactory == fact) {
-            return entries[i].fName;
-        }
-    }
-    return NULL;
+    const Entry* entry = find_factory(fact);
+    return entry ? entry->fName : NULL;
 }
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGlyphBatcher_DEFINED
+#define SkGlyphBatcher_DEFINED
+
+#include "SkGlyphCache.h"
+#include "SkPaint.h"
+
+/**
+ *  Steps through a run of text as the paint's SkDrawCacheProc does. Glyph ID
+ *  text drawn without subpixel positioning is looked up kBatchCount glyphs at
+ *  a time with SkGlyphCache::getGlyphIDMetrics(), so that the glyphs missing
+ *  from the strike are measured and added together; anything else just calls
+ *  the proc.
+ */
+class SkGlyphBatcher {
+public:
+    SkGlyphBatcher(SkGlyphCache* cache, const SkPaint& paint, const char* stop)
+        : fCache(cache)
+        , fProc(paint.getDrawCacheProc())
+        , fStop(stop)
+        , fBatched(SkPaint::kGlyphID_TextEncoding == paint.getTextEncoding() &&
+                   !paint.isSubpixelText())
+        , fIndex(0)
+        , fCount(0) {}
+
+    /** Returns the glyph at *text and advances *text past it. x and y are
+        only used by subpixel procs, as with SkDrawCacheProc.
+    */
+    const SkGlyph& next(const char** text, SkFixed x, SkFixed y) {
+        if (!fBatched) {
+            return fProc(fCache, text, x, y);
+        }
+        if (fIndex == fCount) {
+            const uint16_t* glyphIDs = reinterpret_cast<const uint16_t*>(*text);
+            fCount = SkToInt(SkTMin<size_t>(kBatchCount, (fStop - *text) >> 1));
+            fCache->getGlyphIDMetrics(glyphIDs, fCount, fGlyphs);
+            fIndex = 0;
+        }
+        *text += sizeof(uint16_t);
+        return *fGlyphs[fIndex++];
+    }
+
+private:
+    enum {
+        kBatchCount = 64
+    };
+
+    SkGlyphCache*   fCache;
+    SkDrawCacheProc fProc;
+    const char*     fStop;
+    const bool      fBatched;
+    int             fIndex;
+    int             fCount;
+    const SkGlyph*  fGlyphs[kBatchCount];
+};
+
+#endif
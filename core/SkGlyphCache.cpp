@@ -9,13 +9,19 @@
 
 #include "SkGlyphCache.h"
 #include "SkGlyphCache_Globals.h"
+#include "SkData.h"
 #include "SkDistanceFieldGen.h"
 #include "SkGraphics.h"
+#include "SkMemoryBudget.h"
 #include "SkOnce.h"
 #include "SkPaint.h"
 #include "SkPath.h"
+#include "SkStats.h"
+#include "SkStream.h"
 #include "SkTemplates.h"
+#include "SkThread.h"
 #include "SkTLS.h"
+#include "SkTSort.h"
 #include "SkTypeface.h"
 
 //#define SPEW_PURGE_STATUS
@@ -23,24 +29,65 @@
 
 bool gSkSuppressFontCachePurgeSpew;
 
-static void create_globals(SkGlyphCache_Globals** globals) {
-    *globals = SkNEW_ARGS(SkGlyphCache_Globals, (SkGlyphCache_Globals::kYes_UseMutex));
+static const int kShardCount = SK_DEFAULT_FONT_CACHE_SHARD_COUNT;
+
+static size_t shards_memory_used(void* ctx) {
+    SkGlyphCache_Globals** shards = static_cast<SkGlyphCache_Globals**>(ctx);
+    size_t used = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        used += shards[i]->getTotalMemoryUsed();
+    }
+    return used;
+}
+
+static void purge_shards_down_to(void* ctx, size_t targetBytes) {
+    SkGlyphCache_Globals** shards = static_cast<SkGlyphCache_Globals**>(ctx);
+    for (int i = 0; i < kShardCount; ++i) {
+        shards[i]->purgeDownTo(targetBytes / kShardCount);
+    }
+}
+
+static void create_shards(SkGlyphCache_Globals** shards) {
+    for (int i = 0; i < kShardCount; ++i) {
+        shards[i] = SkNEW_ARGS(SkGlyphCache_Globals, (SkGlyphCache_Globals::kYes_UseMutex));
+        shards[i]->setShardCacheSizeLimit(SK_DEFAULT_FONT_CACHE_LIMIT / kShardCount);
+        shards[i]->setCacheCountLimit(SK_DEFAULT_FONT_CACHE_COUNT_LIMIT / kShardCount);
+    }
+    // The font cache doesn't report its growth: strikes grow while they are checked out, and
+    // its own limit keeps it small. It is only counted and purged when another cache grows.
+    SkMemoryBudget::Register(shards_memory_used, purge_shards_down_to, shards);
 }
 
-// Returns the shared globals
-static SkGlyphCache_Globals& getSharedGlobals() {
-    // we leak this, so we don't incur any shutdown cost of the destructor
-    static SkGlyphCache_Globals* gGlobals = NULL;
+// Returns the array of shared shards
+static SkGlyphCache_Globals** getSharedShards() {
+    // we leak these, so we don't incur any shutdown cost of the destructor
+    static SkGlyphCache_Globals* gShards[kShardCount];
     SK_DECLARE_STATIC_ONCE(once);
-    SkOnce(&once, create_globals, &gGlobals);
-    SkASSERT(NULL != gGlobals);
-    return *gGlobals;
+    SkOnce(&once, create_shards, gShards);
+    SkASSERT(NULL != gShards[0]);
+    return gShards;
 }
 
-// Returns the TLS globals (if set), or the shared globals
-static SkGlyphCache_Globals& getGlobals() {
+// Returns the shared shard responsible for strikes matching desc
+static SkGlyphCache_Globals& getSharedGlobals(const SkDescriptor& desc) {
+    // The checksum is already well mixed, but fold the high bits in anyway so
+    // that a power-of-two shard count doesn't only look at the low bits.
+    uint32_t hash = desc.getChecksum();
+    hash ^= hash >> 16;
+    return *getSharedShards()[hash % kShardCount];
+}
+
+// Returns the TLS globals (if set), or the shared shard for desc
+static SkGlyphCache_Globals& getGlobals(const SkDescriptor& desc) {
     SkGlyphCache_Globals* tls = SkGlyphCache_Globals::FindTLS();
-    return tls ? *tls : getSharedGlobals();
+    return tls ? *tls : getSharedGlobals(desc);
+}
+
+static void purgeAllShards() {
+    SkGlyphCache_Globals** shards = getSharedShards();
+    for (int i = 0; i < kShardCount; ++i) {
+        shards[i]->purgeAll();
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -283,6 +330,103 @@ const SkGlyph& SkGlyphCache::getGlyphIDMetrics(uint16_t glyphID,
     return *glyph;
 }
 
+void SkGlyphCache::getGlyphIDMetrics(const uint16_t glyphIDs[], int count,
+                                     const SkGlyph* glyphs[]) {
+    VALIDATE();
+    SkAutoSTMalloc<64, uint32_t> misses(count);
+    int missCount = 0;
+    for (int i = 0; i < count; ++i) {
+        uint32_t id = SkGlyph::MakeID(glyphIDs[i]);
+        SkGlyph* glyph = fGlyphHash[ID2HashIndex(id)];
+
+        if (NULL == glyph || glyph->fID != id) {
+            glyphs[i] = NULL;
+            misses[missCount++] = id;
+        } else {
+            RecordHashSuccess();
+            if (glyph->isJustAdvance()) {
+                fScalerContext->getMetrics(glyph);
+            }
+            glyphs[i] = glyph;
+        }
+    }
+    if (0 == missCount) {
+        return;
+    }
+
+    SkTQSort(misses.get(), misses.get() + missCount - 1);
+    this->addGlyphs(misses.get(), missCount);
+
+    // Every glyph is in the strike now, and most of the misses are in the hash too.
+    for (int i = 0; i < count; ++i) {
+        if (NULL == glyphs[i]) {
+            uint32_t id = SkGlyph::MakeID(glyphIDs[i]);
+            unsigned index = ID2HashIndex(id);
+            SkGlyph* glyph = fGlyphHash[index];
+
+            if (NULL == glyph || glyph->fID != id) {
+                RecordHashCollisionIf(glyph != NULL);
+                glyph = this->lookupMetrics(id, kFull_MetricsType);
+                fGlyphHash[index] = glyph;
+            }
+            SkASSERT(glyph->isFullMetrics());
+            glyphs[i] = glyph;
+        }
+    }
+}
+
+void SkGlyphCache::addGlyphs(const uint32_t ids[], int count) {
+    SkAutoSTMalloc<64, SkGlyph*> newGlyphs(count);
+    int newCount = 0;
+
+    // Walk the (sorted) ids and glyph array together, measuring the glyphs we
+    // already have and making the ones we don't.
+    const int oldCount = fGlyphArray.count();
+    SkGlyph** array = fGlyphArray.begin();
+    int j = 0;
+    for (int i = 0; i < count; ++i) {
+        const uint32_t id = ids[i];
+        if (i > 0 && ids[i - 1] == id) {
+            continue;
+        }
+        while (j < oldCount && array[j]->fID < id) {
+            j += 1;
+        }
+
+        SkGlyph* glyph;
+        if (j < oldCount && array[j]->fID == id) {
+            glyph = array[j];
+            if (glyph->isJustAdvance()) {
+                fScalerContext->getMetrics(glyph);
+            }
+        } else {
+            glyph = (SkGlyph*)fGlyphAlloc.alloc(sizeof(SkGlyph),
+                                                SkChunkAlloc::kThrow_AllocFailType);
+            glyph->init(id);
+            fScalerContext->getMetrics(glyph);
+            newGlyphs[newCount++] = glyph;
+        }
+        fGlyphHash[ID2HashIndex(id)] = glyph;
+    }
+    if (0 == newCount) {
+        return;
+    }
+    fMemoryUsed += newCount * sizeof(SkGlyph);
+
+    // Merge the new glyphs in from the back, so each old glyph moves at most once.
+    fGlyphArray.append(newCount);
+    array = fGlyphArray.begin();
+    int dst = oldCount + newCount - 1;
+    int src = oldCount - 1;
+    for (int k = newCount - 1; k >= 0; --dst) {
+        if (src >= 0 && array[src]->fID > newGlyphs[k]->fID) {
+            array[dst] = array[src--];
+        } else {
+            array[dst] = newGlyphs[k--];
+        }
+    }
+}
+
 SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
     SkGlyph* glyph;
 
@@ -317,6 +461,7 @@ SkGlyph* SkGlyphCache::lookupMetrics(uint32_t id, MetricsType mtype) {
     }
 
     // not found, but hi tells us where to inser the new glyph
+    SK_STATS_INC(kGlyphMiss_Counter);
     fMemoryUsed += sizeof(SkGlyph);
 
     glyph = (SkGlyph*)fGlyphAlloc.alloc(sizeof(SkGlyph),
@@ -452,17 +597,278 @@ void SkGlyphCache::invokeAndRemoveAuxProcs() {
     }
 }
 
-///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
-#include "SkThread.h"
+/*  A snapshot is a header followed by strikes. Each strike is its descriptor's
+    length and bytes, a glyph count, and that many SnapshotGlyphs, each
+    followed by its image (if it has one) padded to a multiple of 4 bytes.
+    Everything stays 4 byte aligned, so the images can be used in place.
+*/
+namespace {
+
+static const uint32_t kSnapshotMagic = SkSetFourByteTag('s', 'k', 'g', 'c');
+static const uint32_t kSnapshotVersion = 1;
+
+struct SnapshotGlyph {
+    uint32_t    fID;
+    int32_t     fAdvanceX, fAdvanceY;
+    uint16_t    fWidth, fHeight;
+    int16_t     fTop, fLeft;
+    uint8_t     fMaskFormat;
+    int8_t      fRsbDelta, fLsbDelta;
+    uint8_t     fHasImage;
+};
+SK_COMPILE_ASSERT(sizeof(SnapshotGlyph) == 24, snapshot_glyph_must_be_packed);
+
+// A loaded strike. Its glyph records and images live in the snapshot's data.
+struct SnapshotStrike {
+    SkDescriptor*   fDesc;
+    const char*     fGlyphs;
+    int             fGlyphCount;
+};
+
+SK_DECLARE_STATIC_MUTEX(gSnapshotMutex);
+// Only ever grows; the snapshots' data are never unref'ed.
+static SkTDArray<SnapshotStrike> gSnapshotStrikes;
+
+size_t snapshot_image_size(const SkGlyph& glyph) {
+    return SkAlign4(glyph.computeImageSize());
+}
+
+// Reads from (possibly malformed) snapshot data, failing rather than running off its end.
+class SnapshotReader {
+public:
+    SnapshotReader(const void* data, size_t length)
+        : fCurr(static_cast<const char*>(data))
+        , fStop(static_cast<const char*>(data) + length) {}
+
+    const char* curr() const { return fCurr; }
+    bool atEnd() const { return fCurr == fStop; }
+
+    // Returns the next size bytes (size must be a multiple of 4), or NULL.
+    const char* skip(size_t size) {
+        SkASSERT(SkAlign4(size) == size);
+        if (size > static_cast<size_t>(fStop - fCurr)) {
+            return NULL;
+        }
+        const char* data = fCurr;
+        fCurr += size;
+        return data;
+    }
+
+    bool read(void* dst, size_t size) {
+        const char* data = this->skip(size);
+        if (NULL == data) {
+            return false;
+        }
+        memcpy(dst, data, size);
+        return true;
+    }
+
+    bool readU32(uint32_t* value) { return this->read(value, sizeof(*value)); }
+
+private:
+    const char* fCurr;
+    const char* fStop;
+};
+
+// Reads one strike, returning false if its data can't have come from CreateSnapshot().
+bool read_snapshot_strike(SnapshotReader* reader, SnapshotStrike* strike) {
+    uint32_t descLength;
+    if (!reader->readU32(&descLength) || descLength < SkDescriptor::ComputeOverhead(0) ||
+        SkAlign4(descLength) != descLength) {
+        return false;
+    }
+    const char* descData = reader->skip(descLength);
+    if (NULL == descData) {
+        return false;
+    }
+    SkAutoTMalloc<char> storage(descLength);
+    memcpy(storage.get(), descData, descLength);
+    SkDescriptor* desc = reinterpret_cast<SkDescriptor*>(storage.get());
+    const uint32_t checksum = desc->getChecksum();
+    if (desc->getLength() != descLength) {
+        return false;
+    }
+    desc->computeChecksum();
+    if (desc->getChecksum() != checksum) {
+        return false;
+    }
+
+    uint32_t glyphCount;
+    if (!reader->readU32(&glyphCount) || glyphCount > SK_MaxS32 / sizeof(SnapshotGlyph)) {
+        return false;
+    }
+    const char* glyphs = reader->curr();
+    uint32_t prevID = 0;
+    for (uint32_t i = 0; i < glyphCount; ++i) {
+        SnapshotGlyph rec;
+        // Strikes keep their glyphs sorted by ID, and only measured glyphs are written.
+        if (!reader->read(&rec, sizeof(rec)) || (i > 0 && rec.fID <= prevID) ||
+            rec.fMaskFormat > SkMask::kLCD32_Format) {
+            return false;
+        }
+        prevID = rec.fID;
+        if (rec.fHasImage) {
+            SkGlyph glyph;
+            glyph.init(rec.fID);
+            glyph.fWidth = rec.fWidth;
+            glyph.fHeight = rec.fHeight;
+            glyph.fMaskFormat = rec.fMaskFormat;
+            if (0 == rec.fWidth || rec.fWidth >= kMaxGlyphWidth ||
+                NULL == reader->skip(snapshot_image_size(glyph))) {
+                return false;
+            }
+        }
+    }
+
+    strike->fDesc = desc->copy();
+    strike->fGlyphs = glyphs;
+    strike->fGlyphCount = glyphCount;
+    return true;
+}
+
+}  // namespace
+
+bool SkGlyphCache::WriteSnapshotProc(SkGlyphCache* cache, void* context) {
+    SkWStream* stream = static_cast<SkWStream*>(context);
+
+    int glyphCount = 0;
+    for (int i = 0; i < cache->fGlyphArray.count(); ++i) {
+        if (cache->fGlyphArray[i]->isFullMetrics()) {
+            glyphCount += 1;
+        }
+    }
+    if (0 == glyphCount) {
+        return false;
+    }
+
+    const SkDescriptor& desc = *cache->fDesc;
+    stream->write32(desc.getLength());
+    stream->write(&desc, desc.getLength());
+    stream->write32(glyphCount);
+    for (int i = 0; i < cache->fGlyphArray.count(); ++i) {
+        const SkGlyph& glyph = *cache->fGlyphArray[i];
+        if (!glyph.isFullMetrics()) {
+            continue;
+        }
+        SnapshotGlyph rec;
+        sk_bzero(&rec, sizeof(rec));
+        rec.fID = glyph.fID;
+        rec.fAdvanceX = glyph.fAdvanceX;
+        rec.fAdvanceY = glyph.fAdvanceY;
+        rec.fWidth = glyph.fWidth;
+        rec.fHeight = glyph.fHeight;
+        rec.fTop = glyph.fTop;
+        rec.fLeft = glyph.fLeft;
+        rec.fMaskFormat = glyph.fMaskFormat;
+        rec.fRsbDelta = glyph.fRsbDelta;
+        rec.fLsbDelta = glyph.fLsbDelta;
+        rec.fHasImage = (NULL != glyph.fImage);
+        stream->write(&rec, sizeof(rec));
+        if (rec.fHasImage) {
+            const size_t size = glyph.computeImageSize();
+            stream->write(glyph.fImage, size);
+            stream->write("\0\0\0", snapshot_image_size(glyph) - size);
+        }
+    }
+    return false;   // keep visiting
+}
+
+SkData* SkGlyphCache::CreateSnapshot() {
+    // Strikes simply run to the end of the data, so no count is needed up front.
+    SkDynamicMemoryWStream stream;
+    stream.write32(kSnapshotMagic);
+    stream.write32(kSnapshotVersion);
+    VisitAllCaches(WriteSnapshotProc, &stream);
+    return stream.copyToData();
+}
+
+bool SkGlyphCache::LoadSnapshot(SkData* data) {
+    if (NULL == data || !SkIsAlign4(reinterpret_cast<intptr_t>(data->data()))) {
+        return false;
+    }
+    SnapshotReader reader(data->data(), SkAlign4(data->size()) == data->size() ? data->size() : 0);
+    uint32_t magic, version;
+    if (!reader.readU32(&magic) || kSnapshotMagic != magic ||
+        !reader.readU32(&version) || kSnapshotVersion != version) {
+        return false;
+    }
+
+    SkTDArray<SnapshotStrike> strikes;
+    while (!reader.atEnd()) {
+        if (!read_snapshot_strike(&reader, strikes.append())) {
+            strikes.pop();
+            for (int i = 0; i < strikes.count(); ++i) {
+                SkDescriptor::Free(strikes[i].fDesc);
+            }
+            return false;
+        }
+    }
+
+    SkAutoMutexAcquire ac(gSnapshotMutex);
+    data->ref();
+    gSnapshotStrikes.append(strikes.count(), strikes.begin());
+    return true;
+}
+
+void SkGlyphCache::prepopulateFromSnapshot() {
+    SkASSERT(0 == fGlyphArray.count());
+
+    SkAutoMutexAcquire ac(gSnapshotMutex);
+    const SnapshotStrike* strike = NULL;
+    for (int i = 0; i < gSnapshotStrikes.count(); ++i) {
+        if (gSnapshotStrikes[i].fDesc->equals(*fDesc)) {
+            strike = &gSnapshotStrikes[i];
+            break;
+        }
+    }
+    if (NULL == strike) {
+        return;
+    }
+
+    const char* data = strike->fGlyphs;
+    fGlyphArray.setReserve(strike->fGlyphCount);
+    for (int i = 0; i < strike->fGlyphCount; ++i) {
+        SnapshotGlyph rec;
+        memcpy(&rec, data, sizeof(rec));
+        data += sizeof(rec);
+
+        SkGlyph* glyph = (SkGlyph*)fGlyphAlloc.alloc(sizeof(SkGlyph),
+                                                     SkChunkAlloc::kThrow_AllocFailType);
+        glyph->init(rec.fID);
+        glyph->fAdvanceX = rec.fAdvanceX;
+        glyph->fAdvanceY = rec.fAdvanceY;
+        glyph->fWidth = rec.fWidth;
+        glyph->fHeight = rec.fHeight;
+        glyph->fTop = rec.fTop;
+        glyph->fLeft = rec.fLeft;
+        glyph->fMaskFormat = rec.fMaskFormat;
+        glyph->fRsbDelta = rec.fRsbDelta;
+        glyph->fLsbDelta = rec.fLsbDelta;
+        if (rec.fHasImage) {
+            // The snapshot's data outlives every strike, and images are never written again.
+            glyph->fImage = const_cast<char*>(data);
+            data += snapshot_image_size(*glyph);
+        }
+        *fGlyphArray.append() = glyph;
+        // The images belong to the snapshot, so only the glyphs count against the budget.
+        fMemoryUsed += sizeof(SkGlyph);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
 
 size_t SkGlyphCache_Globals::setCacheSizeLimit(size_t newLimit) {
     static const size_t minLimit = 256 * 1024;
     if (newLimit < minLimit) {
         newLimit = minLimit;
     }
+    return this->setShardCacheSizeLimit(newLimit);
+}
 
+size_t SkGlyphCache_Globals::setShardCacheSizeLimit(size_t newLimit) {
     SkAutoMutexAcquire    ac(fMutex);
 
     size_t prevLimit = fCacheSizeLimit;
@@ -489,21 +895,46 @@ void SkGlyphCache_Globals::purgeAll() {
     this->internalPurge(fTotalMemoryUsed);
 }
 
-void SkGlyphCache::VisitAllCaches(bool (*proc)(SkGlyphCache*, void*),
-                                  void* context) {
-    SkGlyphCache_Globals& globals = getGlobals();
+void SkGlyphCache_Globals::purgeDownTo(size_t targetBytes) {
+    SkAutoMutexAcquire    ac(fMutex);
+    if (fTotalMemoryUsed > targetBytes) {
+        this->internalPurge(fTotalMemoryUsed - targetBytes);
+    }
+}
+
+static bool visitGlobals(SkGlyphCache_Globals& globals,
+                         bool (*proc)(SkGlyphCache*, void*), void* context) {
     SkAutoMutexAcquire    ac(globals.fMutex);
     SkGlyphCache*         cache;
+    bool                  stopped = false;
 
     globals.validate();
 
     for (cache = globals.internalGetHead(); cache != NULL; cache = cache->fNext) {
         if (proc(cache, context)) {
+            stopped = true;
             break;
         }
     }
 
     globals.validate();
+    return stopped;
+}
+
+void SkGlyphCache::VisitAllCaches(bool (*proc)(SkGlyphCache*, void*),
+                                  void* context) {
+    SkGlyphCache_Globals* tls = SkGlyphCache_Globals::FindTLS();
+    if (tls) {
+        visitGlobals(*tls, proc, context);
+        return;
+    }
+
+    SkGlyphCache_Globals** shards = getSharedShards();
+    for (int i = 0; i < kShardCount; ++i) {
+        if (visitGlobals(*shards[i], proc, context)) {
+            break;
+        }
+    }
 }
 
 /*  This guy calls the visitor from within the mutext lock, so the visitor
@@ -521,7 +952,7 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     }
     SkASSERT(desc);
 
-    SkGlyphCache_Globals& globals = getGlobals();
+    SkGlyphCache_Globals& globals = getGlobals(*desc);
     SkAutoMutexAcquire    ac(globals.fMutex);
     SkGlyphCache*         cache;
     bool                  insideMutex = true;
@@ -531,6 +962,7 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     for (cache = globals.internalGetHead(); cache != NULL; cache = cache->fNext) {
         if (cache->fDesc->equals(*desc)) {
             globals.internalDetachCache(cache);
+            SK_STATS_INC(kGlyphCacheHit_Counter);
             goto FOUND_IT;
         }
     }
@@ -540,6 +972,7 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     */
     ac.release();           // release the mutex now
     insideMutex = false;    // can't use globals anymore
+    SK_STATS_INC(kGlyphCacheMiss_Counter);
 
     // Check if we can create a scaler-context before creating the glyphcache.
     // If not, we may have exhausted OS/font resources, so try purging the
@@ -549,11 +982,12 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
         // so we can try the purge.
         SkScalerContext* ctx = typeface->createScalerContext(desc, true);
         if (!ctx) {
-            getSharedGlobals().purgeAll();
+            purgeAllShards();
             ctx = typeface->createScalerContext(desc, false);
             SkASSERT(ctx);
         }
         cache = SkNEW_ARGS(SkGlyphCache, (typeface, desc, ctx));
+        cache->prepopulateFromSnapshot();
     }
 
 FOUND_IT:
@@ -575,7 +1009,7 @@ void SkGlyphCache::AttachCache(SkGlyphCache* cache) {
     SkASSERT(cache);
     SkASSERT(cache->fNext == NULL);
 
-    getGlobals().attachCacheToHead(cache);
+    getGlobals(cache->getDescriptor()).attachCacheToHead(cache);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -726,31 +1160,72 @@ void SkGlyphCache_Globals::validate() const {
 #include "SkTypefaceCache.h"
 
 size_t SkGraphics::GetFontCacheLimit() {
-    return getSharedGlobals().getCacheSizeLimit();
+    SkGlyphCache_Globals** shards = getSharedShards();
+    size_t limit = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        limit += shards[i]->getCacheSizeLimit();
+    }
+    return limit;
 }
 
 size_t SkGraphics::SetFontCacheLimit(size_t bytes) {
-    return getSharedGlobals().setCacheSizeLimit(bytes);
+    static const size_t minLimit = 256 * 1024;
+    if (bytes < minLimit) {
+        bytes = minLimit;
+    }
+
+    SkGlyphCache_Globals** shards = getSharedShards();
+    size_t prevLimit = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        prevLimit += shards[i]->setShardCacheSizeLimit(bytes / kShardCount);
+    }
+    return prevLimit;
 }
 
 size_t SkGraphics::GetFontCacheUsed() {
-    return getSharedGlobals().getTotalMemoryUsed();
+    SkGlyphCache_Globals** shards = getSharedShards();
+    size_t used = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        used += shards[i]->getTotalMemoryUsed();
+    }
+    return used;
 }
 
 int SkGraphics::GetFontCacheCountLimit() {
-    return getSharedGlobals().getCacheCountLimit();
+    SkGlyphCache_Globals** shards = getSharedShards();
+    int limit = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        limit += shards[i]->getCacheCountLimit();
+    }
+    return limit;
 }
 
 int SkGraphics::SetFontCacheCountLimit(int count) {
-    return getSharedGlobals().setCacheCountLimit(count);
+    if (count < 0) {
+        count = 0;
+    }
+
+    SkGlyphCache_Globals** shards = getSharedShards();
+    int prevCount = 0;
+    // Spread the remainder so that the shard limits add up to count.
+    for (int i = 0; i < kShardCount; ++i) {
+        int shardCount = count / kShardCount + (i < count % kShardCount ? 1 : 0);
+        prevCount += shards[i]->setCacheCountLimit(shardCount);
+    }
+    return prevCount;
 }
 
 int SkGraphics::GetFontCacheCountUsed() {
-    return getSharedGlobals().getCacheCountUsed();
+    SkGlyphCache_Globals** shards = getSharedShards();
+    int used = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        used += shards[i]->getCacheCountUsed();
+    }
+    return used;
 }
 
 void SkGraphics::PurgeFontCache() {
-    getSharedGlobals().purgeAll();
+    purgeAllShards();
     SkTypefaceCache::PurgeAll();
 }
 
@@ -19,6 +19,7 @@
 #include "SkTDArray.h"
 
 struct SkDeviceProperties;
+class SkData;
 class SkPaint;
 
 class SkGlyphCache_Globals;
@@ -61,6 +62,13 @@ public:
     const SkGlyph& getUnicharMetrics(SkUnichar, SkFixed x, SkFixed y);
     const SkGlyph& getGlyphIDMetrics(uint16_t, SkFixed x, SkFixed y);
 
+    /** As getGlyphIDMetrics(uint16_t) for each of count glyphIDs, storing the
+        results in the parallel glyphs array. The glyphs missing from the
+        strike are measured together and added to it in one pass, which is
+        much cheaper than adding them one at a time for long runs of text.
+    */
+    void getGlyphIDMetrics(const uint16_t glyphIDs[], int count, const SkGlyph* glyphs[]);
+
     /** Return the glyphID for the specified Unichar. If the char has already
         been seen, use the existing cache entry. If not, ask the scalercontext
         to compute it for us.
@@ -163,6 +171,27 @@ public:
         return VisitCache(typeface, desc, DetachProc, NULL);
     }
 
+    /** Returns a blob describing the strikes in the cache that are not in use:
+        each strike's descriptor, and the metrics and images of the glyphs it
+        has fully measured. Strikes created later with the same descriptor, in
+        this process or one that loads the blob with LoadSnapshot(), start out
+        with those glyphs and never ask their scaler for them again.
+
+        The blob is in native byte order and its version changes whenever the
+        descriptor or glyph layout does. Since descriptors name typefaces by
+        unique ID, a snapshot only helps processes that create their typefaces
+        in the same order, as identical worker processes do.
+    */
+    static SkData* CreateSnapshot();
+
+    /** Makes the strikes in a blob returned by CreateSnapshot() (e.g. read
+        from a memory mapped file) available to strikes created from now on.
+        The glyph images are used in place, so the data is kept (ref'ed) for
+        the life of the process. Returns false and loads nothing if the data
+        is malformed, misaligned or from another version.
+    */
+    static bool LoadSnapshot(SkData*);
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
@@ -199,8 +228,15 @@ private:
     };
 
     SkGlyph* lookupMetrics(uint32_t id, MetricsType);
+    // Makes sure each of the sorted ids has a fully measured glyph.
+    void addGlyphs(const uint32_t ids[], int count);
     static bool DetachProc(const SkGlyphCache*, void*) { return true; }
 
+    // Adds the glyphs of a loaded snapshot strike matching fDesc, if any. Only
+    // called on a new, empty strike.
+    void prepopulateFromSnapshot();
+    static bool WriteSnapshotProc(SkGlyphCache*, void* stream);
+
     SkGlyphCache*       fNext, *fPrev;
     SkDescriptor*       fDesc;
     SkScalerContext*    fScalerContext;
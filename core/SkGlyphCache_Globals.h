@@ -19,6 +19,13 @@
     #define SK_DEFAULT_FONT_CACHE_LIMIT     (2 * 1024 * 1024)
 #endif
 
+// The shared (non-TLS) cache is split into this many independent shards, each
+// with its own mutex, LRU list and 1/Nth of the global budget. Strikes are
+// assigned to a shard by their descriptor checksum.
+#ifndef SK_DEFAULT_FONT_CACHE_SHARD_COUNT
+    #define SK_DEFAULT_FONT_CACHE_SHARD_COUNT   8
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class SkMutex;
@@ -70,6 +77,9 @@ public:
 
     size_t  getCacheSizeLimit() const { return fCacheSizeLimit; }
     size_t  setCacheSizeLimit(size_t limit);
+    // Same as setCacheSizeLimit, but without enforcing the minimum limit.
+    // Used to hand each shard its slice of the global budget.
+    size_t  setShardCacheSizeLimit(size_t limit);
 
     // returns true if this cache is over-budget either due to size limit
     // or count limit.
@@ -79,6 +89,8 @@ public:
     }
 
     void purgeAll(); // does not change budget
+    // Purges down to at most targetBytes, without changing the budget.
+    void purgeDownTo(size_t targetBytes);
 
     // call when a glyphcache is available for caching (i.e. not in use)
     void attachCacheToHead(SkGlyphCache*);
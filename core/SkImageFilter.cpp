@@ -9,10 +9,12 @@
 
 #include "SkBitmap.h"
 #include "SkDevice.h"
+#include "SkImageFilterResultCache.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
 #include "SkRect.h"
 #include "SkTDynamicHash.h"
+#include "SkTLazy.h"
 #include "SkValidationUtils.h"
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -50,6 +52,7 @@ SkImageFilter::SkImageFilter(SkImageFilter* input1, SkImageFilter* input2, const
 }
 
 SkImageFilter::~SkImageFilter() {
+    SkImageFilterResultCache::Purge(this);
     for (int i = 0; i < fInputCount; i++) {
         SkSafeUnref(fInputs[i]);
     }
@@ -106,6 +109,16 @@ bool SkImageFilter::filterImage(Proxy* proxy, const SkBitmap& src,
     if (cache->get(this, result, offset)) {
         return true;
     }
+    // Filters are immutable, so a raster result for the same source pixels,
+    // matrix and clip can be reused across draws.
+    SkTLazy<SkImageFilterResultCache::Key> key;
+    if (SkImageFilterResultCache::CanCache(src)) {
+        key.set(SkImageFilterResultCache::Key(this, src, context));
+        if (SkImageFilterResultCache::Find(*key.get(), result, offset)) {
+            cache->set(this, *result, *offset);
+            return true;
+        }
+    }
     /*
      *  Give the proxy first shot at the filter. If it returns false, ask
      *  the filter to do it.
@@ -113,6 +126,9 @@ bool SkImageFilter::filterImage(Proxy* proxy, const SkBitmap& src,
     if ((proxy && proxy->filterImage(this, src, context, result, offset)) ||
         this->onFilterImage(proxy, src, context, result, offset)) {
         cache->set(this, *result, *offset);
+        if (key.isValid()) {
+            SkImageFilterResultCache::Add(*key.get(), *result, *offset);
+        }
         return true;
     }
     return false;
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkImageFilterResultCache.h"
+
+#include "SkChecksum.h"
+#include "SkPixelRef.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkThread.h"
+
+#ifndef SK_DEFAULT_IMAGE_FILTER_RESULT_CACHE_LIMIT
+    #define SK_DEFAULT_IMAGE_FILTER_RESULT_CACHE_LIMIT  (4 * 1024 * 1024)
+#endif
+
+SkImageFilterResultCache::Key::Key(const SkImageFilter* filter, const SkBitmap& src,
+                                   const SkImageFilter::Context& ctx)
+    : fFilter(filter) {
+    SkASSERT(CanCache(src));
+    sk_bzero(fData, sizeof(fData));
+    memcpy(&fData[0], &filter, sizeof(filter));
+    fData[2] = src.getGenerationID();
+    const SkIPoint& origin = src.pixelRefOrigin();
+    fData[3] = origin.fX;
+    fData[4] = origin.fY;
+    fData[5] = src.width();
+    fData[6] = src.height();
+    SkScalar matrix[9];
+    ctx.ctm().get9(matrix);
+    memcpy(&fData[7], matrix, sizeof(matrix));
+    SK_COMPILE_ASSERT(sizeof(SkIRect) == 4 * sizeof(uint32_t), irect_is_four_ints);
+    memcpy(&fData[16], &ctx.clipBounds(), sizeof(SkIRect));
+}
+
+bool SkImageFilterResultCache::Key::operator==(const Key& other) const {
+    return 0 == memcmp(fData, other.fData, sizeof(fData));
+}
+
+uint32_t SkImageFilterResultCache::Key::hash() const {
+    return SkChecksum::Compute(fData, sizeof(fData));
+}
+
+bool SkImageFilterResultCache::CanCache(const SkBitmap& src) {
+    return NULL != src.pixelRef() && NULL == src.getTexture();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Rec {
+    Rec(const SkImageFilterResultCache::Key& key, const SkBitmap& result, const SkIPoint& offset)
+        : fKey(key)
+        , fResult(result)
+        , fOffset(offset)
+        , fSize(result.getSize()) {}
+
+    static const SkImageFilterResultCache::Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const SkImageFilterResultCache::Key& key) { return key.hash(); }
+
+    const SkImageFilterResultCache::Key fKey;
+    const SkBitmap fResult;
+    const SkIPoint fOffset;
+    const size_t fSize;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+/**
+ *  The cache itself, which is only ever touched with gMutex held. fList is
+ *  in most recently used order.
+ */
+class Cache {
+public:
+    Cache() : fBytesUsed(0), fByteLimit(SK_DEFAULT_IMAGE_FILTER_RESULT_CACHE_LIMIT) {}
+
+    bool find(const SkImageFilterResultCache::Key& key, SkBitmap* result, SkIPoint* offset) {
+        Rec* rec = fHash.find(key);
+        if (NULL == rec) {
+            return false;
+        }
+        fList.remove(rec);
+        fList.addToHead(rec);
+        *result = rec->fResult;
+        *offset = rec->fOffset;
+        return true;
+    }
+
+    void add(const SkImageFilterResultCache::Key& key, const SkBitmap& result,
+             const SkIPoint& offset) {
+        const size_t size = result.getSize();
+        if (0 == size || size > fByteLimit || NULL != fHash.find(key)) {
+            return;
+        }
+        Rec* rec = SkNEW_ARGS(Rec, (key, result, offset));
+        fHash.add(rec);
+        fList.addToHead(rec);
+        fBytesUsed += size;
+        this->purgeAsNeeded();
+    }
+
+    void purge(const SkImageFilter* filter) {
+        SkTInternalLList<Rec>::Iter iter;
+        Rec* rec = iter.init(fList, SkTInternalLList<Rec>::Iter::kHead_IterStart);
+        while (NULL != rec) {
+            Rec* next = iter.next();
+            if (rec->fKey.filter() == filter) {
+                this->remove(rec);
+            }
+            rec = next;
+        }
+    }
+
+    size_t bytesUsed() const { return fBytesUsed; }
+    size_t byteLimit() const { return fByteLimit; }
+
+    size_t setByteLimit(size_t newLimit) {
+        size_t prevLimit = fByteLimit;
+        fByteLimit = newLimit;
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
+
+private:
+    void remove(Rec* rec) {
+        fList.remove(rec);
+        fHash.remove(rec->fKey);
+        fBytesUsed -= rec->fSize;
+        SkDELETE(rec);
+    }
+
+    void purgeAsNeeded() {
+        while (fBytesUsed > fByteLimit) {
+            SkASSERT(NULL != fList.tail());
+            this->remove(fList.tail());
+        }
+    }
+
+    SkTDynamicHash<Rec, SkImageFilterResultCache::Key> fHash;
+    SkTInternalLList<Rec> fList;
+    size_t fBytesUsed;
+    size_t fByteLimit;
+};
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+
+// Must be called with gMutex held. Like SkBlurMaskCache, the cache lives for
+// the life of the process.
+Cache* get_cache() {
+    static Cache* gCache;
+    if (NULL == gCache) {
+        gCache = SkNEW(Cache);
+    }
+    return gCache;
+}
+
+}  // namespace
+
+bool SkImageFilterResultCache::Find(const Key& key, SkBitmap* result, SkIPoint* offset) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->find(key, result, offset);
+}
+
+void SkImageFilterResultCache::Add(const Key& key, const SkBitmap& result,
+                                   const SkIPoint& offset) {
+    if (!CanCache(result)) {
+        return;
+    }
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->add(key, result, offset);
+}
+
+void SkImageFilterResultCache::Purge(const SkImageFilter* filter) {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->purge(filter);
+}
+
+size_t SkImageFilterResultCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkImageFilterResultCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkImageFilterResultCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkImageFilterResultCache_DEFINED
+#define SkImageFilterResultCache_DEFINED
+
+#include "SkBitmap.h"
+#include "SkImageFilter.h"
+
+/**
+ *  A global, thread-safe, byte-limited LRU cache of raster SkImageFilter
+ *  results. Unlike SkImageFilter::Cache, which only shares a node's result
+ *  within a single filterImage() call, this keeps the results of every node
+ *  across draws, so drawing the same bitmap through the same (immutable)
+ *  filter graph again skips all of the unchanged intermediates.
+ */
+class SkImageFilterResultCache {
+public:
+    /**
+     *  Everything a filter's result depends on: the filter itself, the source
+     *  pixels (by generation ID and subset) and the context's matrix and clip.
+     */
+    class Key {
+    public:
+        Key(const SkImageFilter*, const SkBitmap& src, const SkImageFilter::Context&);
+
+        bool operator==(const Key& other) const;
+        uint32_t hash() const;
+
+        const SkImageFilter* filter() const { return fFilter; }
+
+    private:
+        enum {
+            // filter (room for a 64 bit pointer), src gen ID and subset, matrix, clip bounds
+            kCount = 2 + 1 + 4 + 9 + 4,
+        };
+        const SkImageFilter* fFilter;
+        uint32_t             fData[kCount];
+    };
+
+    /**
+     *  Returns true if src can be used in a key: it must be raster backed and
+     *  have a pixel ref (and so a stable generation ID).
+     */
+    static bool CanCache(const SkBitmap& src);
+
+    static bool Find(const Key& key, SkBitmap* result, SkIPoint* offset);
+
+    /** Adds a raster result to the cache. Results too large for it are ignored. */
+    static void Add(const Key& key, const SkBitmap& result, const SkIPoint& offset);
+
+    /** Drops every result computed by filter. Called as filters are destroyed. */
+    static void Purge(const SkImageFilter* filter);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+};
+
+#endif
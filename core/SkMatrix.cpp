@@ -7,6 +7,8 @@
 
 #include "SkMatrix.h"
 #include "SkFloatBits.h"
+#include "SkMatrix_opts.h"
+#include "SkMatrixUtils.h"
 #include "SkOnce.h"
 #include "SkString.h"
 
@@ -858,6 +860,35 @@ bool SkMatrix::invertNonIdentity(SkMatrix* inv) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static SkMatrixMapPtsProcs gPlatformMapPtsProcs;
+
+static void init_platform_map_pts_procs(int) {
+    if (!SkMatrixGetPlatformMapPtsProcs(&gPlatformMapPtsProcs)) {
+        sk_bzero(&gPlatformMapPtsProcs, sizeof(gPlatformMapPtsProcs));
+    }
+}
+
+static const SkMatrixMapPtsProcs& platform_map_pts_procs() {
+    SK_DECLARE_STATIC_ONCE(once);
+    SkOnce(&once, init_platform_map_pts_procs, 0);
+    return gPlatformMapPtsProcs;
+}
+
+// Below this many points the SIMD procs aren't worth the call.
+static const int kMinPlatformMapPtsCount = 8;
+
+// Maps the leading points with the platform proc, if there is one, and
+// advances the arguments past them.
+static inline void platform_map_pts(SkMatrixMapPtsPlatformProc proc, const SkMatrix& m,
+                                    SkPoint** dst, const SkPoint** src, int* count) {
+    if (NULL != proc && *count >= kMinPlatformMapPtsCount) {
+        int done = proc(m, *dst, *src, *count);
+        *dst += done;
+        *src += done;
+        *count -= done;
+    }
+}
+
 void SkMatrix::Identity_pts(const SkMatrix& m, SkPoint dst[],
                             const SkPoint src[], int count) {
     SkASSERT(m.getType() == 0);
@@ -870,6 +901,7 @@ void SkMatrix::Trans_pts(const SkMatrix& m, SkPoint dst[],
                          const SkPoint src[], int count) {
     SkASSERT(m.getType() == kTranslate_Mask);
 
+    platform_map_pts(platform_map_pts_procs().fScaleTrans, m, &dst, &src, &count);
     if (count > 0) {
         SkScalar tx = m.fMat[kMTransX];
         SkScalar ty = m.fMat[kMTransY];
@@ -886,6 +918,7 @@ void SkMatrix::Scale_pts(const SkMatrix& m, SkPoint dst[],
                          const SkPoint src[], int count) {
     SkASSERT(m.getType() == kScale_Mask);
 
+    platform_map_pts(platform_map_pts_procs().fScaleTrans, m, &dst, &src, &count);
     if (count > 0) {
         SkScalar mx = m.fMat[kMScaleX];
         SkScalar my = m.fMat[kMScaleY];
@@ -902,6 +935,7 @@ void SkMatrix::ScaleTrans_pts(const SkMatrix& m, SkPoint dst[],
                               const SkPoint src[], int count) {
     SkASSERT(m.getType() == (kScale_Mask | kTranslate_Mask));
 
+    platform_map_pts(platform_map_pts_procs().fScaleTrans, m, &dst, &src, &count);
     if (count > 0) {
         SkScalar mx = m.fMat[kMScaleX];
         SkScalar my = m.fMat[kMScaleY];
@@ -920,6 +954,10 @@ void SkMatrix::Rot_pts(const SkMatrix& m, SkPoint dst[],
                        const SkPoint src[], int count) {
     SkASSERT((m.getType() & (kPerspective_Mask | kTranslate_Mask)) == 0);
 
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+    // The platform proc adds the (zero) translate, which can only flip the sign of a zero.
+    platform_map_pts(platform_map_pts_procs().fAffine, m, &dst, &src, &count);
+#endif
     if (count > 0) {
         SkScalar mx = m.fMat[kMScaleX];
         SkScalar my = m.fMat[kMScaleY];
@@ -940,6 +978,10 @@ void SkMatrix::RotTrans_pts(const SkMatrix& m, SkPoint dst[],
                             const SkPoint src[], int count) {
     SkASSERT(!m.hasPerspective());
 
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+    // The platform procs only do the legacy order.
+    platform_map_pts(platform_map_pts_procs().fAffine, m, &dst, &src, &count);
+#endif
     if (count > 0) {
         SkScalar mx = m.fMat[kMScaleX];
         SkScalar my = m.fMat[kMScaleY];
@@ -967,6 +1009,9 @@ void SkMatrix::Persp_pts(const SkMatrix& m, SkPoint dst[],
                          const SkPoint src[], int count) {
     SkASSERT(m.hasPerspective());
 
+#ifdef SK_LEGACY_MATRIX_MATH_ORDER
+    platform_map_pts(platform_map_pts_procs().fPersp, m, &dst, &src, &count);
+#endif
     if (count > 0) {
         do {
             SkScalar sy = src->fY;
@@ -1011,6 +1056,51 @@ void SkMatrix::mapPoints(SkPoint dst[], const SkPoint src[], int count) const {
     this->getMapPtsProc()(*this, dst, src, count);
 }
 
+bool SkMatrixMapPointsAndBounds(const SkMatrix& matrix, SkPoint dst[], const SkPoint src[],
+                                int count, SkRect* bounds) {
+    SkASSERT((dst && src && count > 0) || 0 == count);
+    if (count <= 0) {
+        bounds->setEmpty();
+        return true;
+    }
+
+    SkMatrix::MapPtsProc proc = matrix.getMapPtsProc();
+    // Bound each chunk while it's still in the cache. The first chunk is
+    // bounded by setBoundsCheck, which sets the initial l, t, r, b.
+    static const int kChunk = 64;
+    int n = SkMin32(count, kChunk);
+    proc(matrix, dst, src, n);
+    if (!bounds->setBoundsCheck(dst, n)) {
+        // the rest still have to be mapped
+        if (count > n) {
+            proc(matrix, dst + n, src + n, count - n);
+        }
+        return false;
+    }
+    SkScalar l = bounds->fLeft, t = bounds->fTop, r = bounds->fRight, b = bounds->fBottom;
+    float accum = 0;
+    for (int i = n; i < count; i += kChunk) {
+        n = SkMin32(count - i, kChunk);
+        proc(matrix, dst + i, src + i, n);
+        for (int j = i; j < i + n; ++j) {
+            SkScalar x = dst[j].fX;
+            SkScalar y = dst[j].fY;
+            // As in setBoundsCheck, accum stays 0 unless a NaN or infinity turns up.
+            accum *= x; accum *= y;
+            if (x < l) l = x;
+            if (x > r) r = x;
+            if (y < t) t = y;
+            if (y > b) b = y;
+        }
+    }
+    if (accum) {
+        bounds->setEmpty();
+        return false;
+    }
+    bounds->set(l, t, r, b);
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkMatrix::mapHomogeneousPoints(SkScalar dst[], const SkScalar src[], int count) const {
@@ -357,7 +357,7 @@ bool SkMatrixClipStateMgr::call(CallType callType) {
 }
 
 // Fill in the skip offsets for all the clips written in the current block
-void SkMatrixClipStateMgr::fillInSkips(SkWriter32* writer, int32_t restoreOffset) {
+void SkMatrixClipStateMgr::fillInSkips(SkSegmentedWriter32* writer, int32_t restoreOffset) {
     for (int i = 0; i < fSkipOffsets->count(); ++i) {
         SkDEBUGCODE(int32_t peek = writer->readTAt<int32_t>((*fSkipOffsets)[i]);)
         SkASSERT(-1 == peek);
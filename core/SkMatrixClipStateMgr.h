@@ -15,7 +15,7 @@
 #include "SkTDArray.h"
 
 class SkPictureRecord;
-class SkWriter32;
+class SkSegmentedWriter32;
 
 // The SkMatrixClipStateMgr collapses the matrix/clip state of an SkPicture into
 // a series of save/restore blocks of consistent matrix clip state, e.g.:
@@ -342,7 +342,7 @@ public:
 
     bool call(CallType callType);
 
-    void fillInSkips(SkWriter32* writer, int32_t restoreOffset);
+    void fillInSkips(SkSegmentedWriter32* writer, int32_t restoreOffset);
 
     void finish();
 
@@ -51,4 +51,12 @@ bool SkDecomposeUpper2x2(const SkMatrix& matrix,
                          SkPoint* scale,
                          SkPoint* rotation2);
 
+/** Maps count points as matrix.mapPoints(dst, src, count) does and returns
+    their bounds as bounds->setBoundsCheck(dst, count) would, bounding each
+    run of points as soon as it is mapped rather than in a second pass over
+    dst.
+    */
+bool SkMatrixMapPointsAndBounds(const SkMatrix& matrix, SkPoint dst[], const SkPoint src[],
+                                int count, SkRect* bounds);
+
 #endif
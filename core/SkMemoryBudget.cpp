@@ -0,0 +1,161 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMemoryBudget.h"
+
+#include "SkTArray.h"
+#include "SkTemplates.h"
+#include "SkThread.h"
+
+namespace {
+
+struct Client {
+    SkMemoryBudget::UsageProc fUsage;
+    SkMemoryBudget::PurgeProc fPurge;
+    void*                     fContext;
+};
+
+}  // namespace
+
+// Two locks, so that registering never waits on a purge: gClientsMutex only guards the list
+// and is never held while calling a client, and gEnforceMutex is held while calling out so
+// that Unregister() can wait for the client to be left alone. Clients can register from under
+// their own lock (a lazily made global, say) without inverting the order with a purge.
+SK_DECLARE_STATIC_MUTEX(gClientsMutex);
+SK_DECLARE_STATIC_MUTEX(gEnforceMutex);
+// Plain storage rather than an SkTDArray, to stay clear of static initializers.
+static Client* gClients;
+static int gClientCount;
+static int gClientReserve;
+static size_t gTotalByteLimit;
+static int32_t gGrowthSinceEnforce;
+
+typedef SkSTArray<16, Client, true> ClientSnapshot;
+
+static void snapshot_clients(ClientSnapshot* snapshot) {
+    SkAutoMutexAcquire ac(gClientsMutex);
+    snapshot->push_back_n(gClientCount, gClients);
+}
+
+void SkMemoryBudget::Register(UsageProc usage, PurgeProc purge, void* context) {
+    SkASSERT(NULL != usage && NULL != purge);
+    SkAutoMutexAcquire ac(gClientsMutex);
+    if (gClientCount == gClientReserve) {
+        gClientReserve = SkTMax(8, gClientReserve * 2);
+        gClients = (Client*)sk_realloc_throw(gClients, gClientReserve * sizeof(Client));
+    }
+    Client* client = &gClients[gClientCount++];
+    client->fUsage = usage;
+    client->fPurge = purge;
+    client->fContext = context;
+}
+
+void SkMemoryBudget::Unregister(void* context) {
+    SkAutoMutexAcquire enforce(gEnforceMutex);
+    SkAutoMutexAcquire ac(gClientsMutex);
+    for (int i = 0; i < gClientCount; ++i) {
+        if (gClients[i].fContext == context) {
+            gClients[i] = gClients[--gClientCount];
+            return;
+        }
+    }
+    SkDEBUGFAIL("unregistering an unknown client");
+}
+
+size_t SkMemoryBudget::GetTotalByteLimit() {
+    SkAutoMutexAcquire ac(gClientsMutex);
+    return gTotalByteLimit;
+}
+
+size_t SkMemoryBudget::SetTotalByteLimit(size_t newLimit) {
+    size_t prevLimit;
+    {
+        SkAutoMutexAcquire ac(gClientsMutex);
+        prevLimit = gTotalByteLimit;
+        gTotalByteLimit = newLimit;
+    }
+    if (0 != newLimit && (0 == prevLimit || newLimit < prevLimit)) {
+        Enforce();
+    }
+    return prevLimit;
+}
+
+size_t SkMemoryBudget::GetTotalBytesUsed() {
+    SkAutoMutexAcquire enforce(gEnforceMutex);
+    ClientSnapshot clients;
+    snapshot_clients(&clients);
+
+    size_t used = 0;
+    for (int i = 0; i < clients.count(); ++i) {
+        used += clients[i].fUsage(clients[i].fContext);
+    }
+    return used;
+}
+
+void SkMemoryBudget::NoteGrowth(size_t bytes) {
+    // Racy, but a stale limit only delays or hastens one Enforce().
+    if (0 == gTotalByteLimit || 0 == bytes) {
+        return;
+    }
+    int32_t delta = (int32_t)SkTMin<size_t>(bytes, kEnforceIntervalBytes);
+    int32_t prev = sk_atomic_add(&gGrowthSinceEnforce, delta);
+    // Only the thread that crosses the interval enforces, and starts the next one.
+    if (prev < kEnforceIntervalBytes && prev + delta >= kEnforceIntervalBytes) {
+        sk_atomic_add(&gGrowthSinceEnforce, -(prev + delta));
+        Enforce();
+    }
+}
+
+// Asks each client to keep numerator/denominator of its usage.
+static void purge_proportionally(const ClientSnapshot& clients, const size_t usage[],
+                                 uint64_t numerator, uint64_t denominator) {
+    SkASSERT(numerator < denominator);
+    for (int i = 0; i < clients.count(); ++i) {
+        if (0 == usage[i]) {
+            continue;
+        }
+        size_t target = (size_t)(usage[i] * numerator / denominator);
+        clients[i].fPurge(clients[i].fContext, target);
+    }
+}
+
+void SkMemoryBudget::Enforce() {
+    SkAutoMutexAcquire enforce(gEnforceMutex);
+    size_t limit = GetTotalByteLimit();
+    if (0 == limit) {
+        return;
+    }
+    ClientSnapshot clients;
+    snapshot_clients(&clients);
+
+    SkAutoSTMalloc<16, size_t> usage(clients.count());
+    uint64_t total = 0;
+    for (int i = 0; i < clients.count(); ++i) {
+        usage[i] = clients[i].fUsage(clients[i].fContext);
+        total += usage[i];
+    }
+    if (total <= limit) {
+        return;
+    }
+    purge_proportionally(clients, usage.get(), limit, total);
+}
+
+void SkMemoryBudget::OnMemoryPressure(Pressure pressure) {
+    SkAutoMutexAcquire enforce(gEnforceMutex);
+    ClientSnapshot clients;
+    snapshot_clients(&clients);
+
+    SkAutoSTMalloc<16, size_t> usage(clients.count());
+    for (int i = 0; i < clients.count(); ++i) {
+        usage[i] = clients[i].fUsage(clients[i].fContext);
+    }
+    if (kCritical_Pressure == pressure) {
+        purge_proportionally(clients, usage.get(), 0, 1);
+    } else {
+        purge_proportionally(clients, usage.get(), 1, 2);
+    }
+}
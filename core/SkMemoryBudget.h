@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMemoryBudget_DEFINED
+#define SkMemoryBudget_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  A process-wide memory budget shared by the caches that each have their own
+ *  limit: the font cache, SkScaledImageCache, the global
+ *  SkDiscardableMemoryPool and every GrContext's resource cache. Each cache
+ *  registers a proc reporting how many bytes it holds and a proc asking it to
+ *  shrink. When the sum goes over the total limit, every cache is asked to
+ *  shrink by the same fraction of its usage, so the biggest caches give back
+ *  the most, whatever their own limits say.
+ *
+ *  The total limit defaults to 0, meaning no limit: the caches only answer to
+ *  their own limits, as before. OnMemoryPressure() is for the embedder to
+ *  forward the OS's low-memory signals, and works with or without a limit.
+ */
+class SkMemoryBudget {
+public:
+    /** Returns the bytes the client holds. May be called from any thread. */
+    typedef size_t (*UsageProc)(void* context);
+
+    /**
+     *  Asks the client to free what it can to get down to targetBytes. May be
+     *  called from any thread; a client that can only purge on its own thread
+     *  may defer the purge (see GrResourceCache).
+     */
+    typedef void (*PurgeProc)(void* context, size_t targetBytes);
+
+    /** context identifies the client to Unregister(). */
+    static void Register(UsageProc, PurgeProc, void* context);
+
+    /** After this returns none of the client's procs will be called. */
+    static void Unregister(void* context);
+
+    static size_t GetTotalByteLimit();
+    static size_t SetTotalByteLimit(size_t newLimit);
+
+    /** Sums the usage reported by every client. */
+    static size_t GetTotalBytesUsed();
+
+    /**
+     *  Clients call this when they allocate, and the budget is enforced every
+     *  kEnforceIntervalBytes of growth. It calls into every client, so it must
+     *  not be called while holding any cache's lock.
+     */
+    static void NoteGrowth(size_t bytes);
+
+    /** Purges the clients proportionally if they are over the total limit. */
+    static void Enforce();
+
+    enum Pressure {
+        kModerate_Pressure,     // every client is asked to halve its usage
+        kCritical_Pressure      // every client is asked to free all it can
+    };
+    static void OnMemoryPressure(Pressure);
+
+    enum {
+        kEnforceIntervalBytes = 1 << 20
+    };
+};
+
+#endif
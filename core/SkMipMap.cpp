@@ -9,32 +9,36 @@
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
 
-static void downsampleby2_proc32(SkBitmap* dst, int x, int y,
-                                 const SkBitmap& src) {
-    x <<= 1;
-    y <<= 1;
-    const SkPMColor* p = src.getAddr32(x, y);
-    const SkPMColor* baseP = p;
+// Each proc averages 2x2 blocks of the two source rows into count destination
+// pixels. Destination levels are exactly half the (rounded down) source size,
+// so both rows always hold 2 * count pixels.
+
+static void downsampleby2_proc32(const void* row0, const void* row1,
+                                 void* dstRow, int count) {
+    const SkPMColor* p0 = static_cast<const SkPMColor*>(row0);
+    const SkPMColor* p1 = static_cast<const SkPMColor*>(row1);
+    SkPMColor* dst = static_cast<SkPMColor*>(dstRow);
     SkPMColor c, ag, rb;
 
-    c = *p; ag = (c >> 8) & 0xFF00FF; rb = c & 0xFF00FF;
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+    for (int i = 0; i < count; ++i) {
+        c = p0[0]; ag  = (c >> 8) & 0xFF00FF; rb  = c & 0xFF00FF;
+        c = p0[1]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+        c = p1[0]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+        c = p1[1]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
 
-    p = baseP;
-    if (y < src.height() - 1) {
-        p += src.rowBytes() >> 2;
-    }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
-    if (x < src.width() - 1) {
-        p += 1;
+        dst[i] = ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
+        p0 += 2;
+        p1 += 2;
     }
-    c = *p; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+}
+
+static SkMipMap::Downsample32Proc gPlatformDownsample32Proc;
 
-    *dst->getAddr32(x >> 1, y >> 1) =
-    ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
+static void downsampleby2_proc32_platform(const void* row0, const void* row1,
+                                          void* dstRow, int count) {
+    gPlatformDownsample32Proc(static_cast<const SkPMColor*>(row0),
+                              static_cast<const SkPMColor*>(row1),
+                              static_cast<SkPMColor*>(dstRow), count);
 }
 
 static inline uint32_t expand16(U16CPU c) {
@@ -47,31 +51,19 @@ static inline U16CPU pack16(uint32_t c) {
     return (c & ~SK_G16_MASK_IN_PLACE) | ((c >> 16) & SK_G16_MASK_IN_PLACE);
 }
 
-static void downsampleby2_proc16(SkBitmap* dst, int x, int y,
-                                 const SkBitmap& src) {
-    x <<= 1;
-    y <<= 1;
-    const uint16_t* p = src.getAddr16(x, y);
-    const uint16_t* baseP = p;
-    SkPMColor       c;
-
-    c = expand16(*p);
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c += expand16(*p);
+static void downsampleby2_proc16(const void* row0, const void* row1,
+                                 void* dstRow, int count) {
+    const uint16_t* p0 = static_cast<const uint16_t*>(row0);
+    const uint16_t* p1 = static_cast<const uint16_t*>(row1);
+    uint16_t* dst = static_cast<uint16_t*>(dstRow);
 
-    p = baseP;
-    if (y < src.height() - 1) {
-        p += src.rowBytes() >> 1;
-    }
-    c += expand16(*p);
-    if (x < src.width() - 1) {
-        p += 1;
+    for (int i = 0; i < count; ++i) {
+        uint32_t c = expand16(p0[0]) + expand16(p0[1]) +
+                     expand16(p1[0]) + expand16(p1[1]);
+        dst[i] = (uint16_t)pack16(c >> 2);
+        p0 += 2;
+        p1 += 2;
     }
-    c += expand16(*p);
-
-    *dst->getAddr16(x >> 1, y >> 1) = (uint16_t)pack16(c >> 2);
 }
 
 static uint32_t expand4444(U16CPU c) {
@@ -82,31 +74,19 @@ static U16CPU collaps4444(uint32_t c) {
     return (c & 0xF0F) | ((c >> 12) & ~0xF0F);
 }
 
-static void downsampleby2_proc4444(SkBitmap* dst, int x, int y,
-                                   const SkBitmap& src) {
-    x <<= 1;
-    y <<= 1;
-    const uint16_t* p = src.getAddr16(x, y);
-    const uint16_t* baseP = p;
-    uint32_t        c;
-
-    c = expand4444(*p);
-    if (x < src.width() - 1) {
-        p += 1;
-    }
-    c += expand4444(*p);
+static void downsampleby2_proc4444(const void* row0, const void* row1,
+                                   void* dstRow, int count) {
+    const uint16_t* p0 = static_cast<const uint16_t*>(row0);
+    const uint16_t* p1 = static_cast<const uint16_t*>(row1);
+    uint16_t* dst = static_cast<uint16_t*>(dstRow);
 
-    p = baseP;
-    if (y < src.height() - 1) {
-        p += src.rowBytes() >> 1;
-    }
-    c += expand4444(*p);
-    if (x < src.width() - 1) {
-        p += 1;
+    for (int i = 0; i < count; ++i) {
+        uint32_t c = expand4444(p0[0]) + expand4444(p0[1]) +
+                     expand4444(p1[0]) + expand4444(p1[1]);
+        dst[i] = (uint16_t)collaps4444(c >> 2);
+        p0 += 2;
+        p1 += 2;
     }
-    c += expand4444(*p);
-
-    *dst->getAddr16(x >> 1, y >> 1) = (uint16_t)collaps4444(c >> 2);
 }
 
 SkMipMap::Level* SkMipMap::AllocLevels(int levelCount, size_t pixelSize) {
@@ -121,12 +101,17 @@ SkMipMap::Level* SkMipMap::AllocLevels(int levelCount, size_t pixelSize) {
 }
 
 SkMipMap* SkMipMap::Build(const SkBitmap& src) {
-    void (*proc)(SkBitmap* dst, int x, int y, const SkBitmap& src);
+    void (*proc)(const void* row0, const void* row1, void* dst, int count);
 
     const SkBitmap::Config config = src.config();
     switch (config) {
         case SkBitmap::kARGB_8888_Config:
-            proc = downsampleby2_proc32;
+            // Racy but harmless: every thread computes the same proc.
+            if (NULL == gPlatformDownsample32Proc) {
+                gPlatformDownsample32Proc = SkMipMap::PlatformDownsample32Proc();
+            }
+            proc = NULL != gPlatformDownsample32Proc ? downsampleby2_proc32_platform
+                                                     : downsampleby2_proc32;
             break;
         case SkBitmap::kRGB_565_Config:
             proc = downsampleby2_proc16;
@@ -175,7 +160,8 @@ SkMipMap* SkMipMap::Build(const SkBitmap& src) {
     int         width = src.width();
     int         height = src.height();
     uint32_t    rowBytes;
-    SkBitmap    srcBM(src);
+    const uint8_t* srcAddr = static_cast<const uint8_t*>(src.getPixels());
+    size_t      srcRowBytes = src.rowBytes();
 
     for (int i = 0; i < countLevels; ++i) {
         width >>= 1;
@@ -188,19 +174,16 @@ SkMipMap* SkMipMap::Build(const SkBitmap& src) {
         levels[i].fRowBytes = rowBytes;
         levels[i].fScale    = (float)width / src.width();
 
-        SkBitmap dstBM;
-        dstBM.setConfig(config, width, height, rowBytes);
-        dstBM.setPixels(addr);
-
-        srcBM.lockPixels();
+        const uint8_t* srcRow = srcAddr;
+        uint8_t* dstRow = addr;
         for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                proc(&dstBM, x, y, srcBM);
-            }
+            proc(srcRow, srcRow + srcRowBytes, dstRow, width);
+            srcRow += 2 * srcRowBytes;
+            dstRow += rowBytes;
         }
-        srcBM.unlockPixels();
 
-        srcBM = dstBM;
+        srcAddr = addr;
+        srcRowBytes = rowBytes;
         addr += height * rowBytes;
     }
     SkASSERT(addr == baseAddr + size);
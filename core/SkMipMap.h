@@ -8,6 +8,7 @@
 #ifndef SkMipMap_DEFINED
 #define SkMipMap_DEFINED
 
+#include "SkColor.h"
 #include "SkRefCnt.h"
 #include "SkScalar.h"
 
@@ -28,6 +29,17 @@ public:
 
     size_t getSize() const { return fSize; }
 
+    /**
+     *  Averages each 2x2 block of 8888 pixels taken from the two source rows
+     *  into one of the count destination pixels. row0 and row1 hold 2 * count
+     *  pixels. Each channel is the truncated mean of its four samples.
+     */
+    typedef void (*Downsample32Proc)(const SkPMColor* row0, const SkPMColor* row1,
+                                     SkPMColor* dst, int count);
+
+    // Defined in src/opts. Returns NULL if there is no faster version than ours.
+    static Downsample32Proc PlatformDownsample32Proc();
+
 private:
     size_t  fSize;
     Level*  fLevels;
@@ -1727,48 +1727,77 @@ void SkScalerContext::MakeRec(const SkPaint& paint,
 }
 
 /**
- * In order to call cachedDeviceLuminance, cachedPaintLuminance, or
- * cachedMaskGamma the caller must hold the gMaskGammaCacheMutex and continue
- * to hold it until the returned pointer is refed or forgotten.
+ * Mask gammas are immutable once built, so each one is kept for good in a
+ * small table that threads search without taking a lock. An entry is built
+ * completely before sk_atomic_inc (a full barrier on every port) claims its
+ * slot, and only then is it stored, so a reader that finds an entry also sees
+ * its contents. Two threads missing on the same parameters may both add an
+ * entry; that only costs a slot. Once the table is full, gammas for new
+ * parameters are built for each scaler context and released with it.
  */
-SK_DECLARE_STATIC_MUTEX(gMaskGammaCacheMutex);
+struct MaskGammaEntry {
+    SkScalar fContrast;
+    SkScalar fPaintGamma;
+    SkScalar fDeviceGamma;
+    SkMaskGamma* fMaskGamma;
+};
+
+static const int kMaxCachedMaskGammas = 16;
+static MaskGammaEntry* volatile gMaskGammaEntries[kMaxCachedMaskGammas];
+static int32_t gMaskGammaEntryCount = 0;
+
+static SkMaskGamma* findMaskGamma(SkScalar contrast, SkScalar paintGamma,
+                                  SkScalar deviceGamma) {
+    const int count = SkTMin<int>(*(volatile int32_t*)&gMaskGammaEntryCount,
+                                  kMaxCachedMaskGammas);
+    for (int i = 0; i < count; ++i) {
+        const MaskGammaEntry* entry = gMaskGammaEntries[i];
+        if (NULL != entry && entry->fContrast == contrast && entry->fPaintGamma == paintGamma &&
+            entry->fDeviceGamma == deviceGamma) {
+            return entry->fMaskGamma;
+        }
+    }
+    return NULL;
+}
 
-static SkMaskGamma* gLinearMaskGamma = NULL;
-static SkMaskGamma* gMaskGamma = NULL;
-static SkScalar gContrast = SK_ScalarMin;
-static SkScalar gPaintGamma = SK_ScalarMin;
-static SkScalar gDeviceGamma = SK_ScalarMin;
 /**
- * The caller must hold the gMaskGammaCacheMutex and continue to hold it until
- * the returned SkMaskGamma pointer is refed or forgotten.
+ * Returns the mask gamma for the parameters with a ref the caller owns.
  */
-static const SkMaskGamma& cachedMaskGamma(SkScalar contrast, SkScalar paintGamma, SkScalar deviceGamma) {
-    if (0 == contrast && SK_Scalar1 == paintGamma && SK_Scalar1 == deviceGamma) {
-        if (NULL == gLinearMaskGamma) {
-            gLinearMaskGamma = SkNEW(SkMaskGamma);
-        }
-        return *gLinearMaskGamma;
+static SkMaskGamma* refMaskGamma(SkScalar contrast, SkScalar paintGamma,
+                                 SkScalar deviceGamma) {
+    SkMaskGamma* found = findMaskGamma(contrast, paintGamma, deviceGamma);
+    if (NULL != found) {
+        return SkRef(found);
     }
-    if (gContrast != contrast || gPaintGamma != paintGamma || gDeviceGamma != deviceGamma) {
-        SkSafeUnref(gMaskGamma);
-        gMaskGamma = SkNEW_ARGS(SkMaskGamma, (contrast, paintGamma, deviceGamma));
-        gContrast = contrast;
-        gPaintGamma = paintGamma;
-        gDeviceGamma = deviceGamma;
+
+    MaskGammaEntry* entry = SkNEW(MaskGammaEntry);
+    entry->fContrast = contrast;
+    entry->fPaintGamma = paintGamma;
+    entry->fDeviceGamma = deviceGamma;
+    entry->fMaskGamma = SkNEW_ARGS(SkMaskGamma, (contrast, paintGamma, deviceGamma));
+    const int32_t index = sk_atomic_inc(&gMaskGammaEntryCount);
+    if (index >= kMaxCachedMaskGammas) {
+        SkMaskGamma* maskGamma = entry->fMaskGamma;
+        SkDELETE(entry);
+        return maskGamma;
     }
-    return *gMaskGamma;
+    gMaskGammaEntries[index] = entry;
+    // One ref belongs to the table.
+    return SkRef(entry->fMaskGamma);
 }
 
 /*static*/ void SkPaint::Term() {
-    SkAutoMutexAcquire ama(gMaskGammaCacheMutex);
-
-    SkSafeUnref(gLinearMaskGamma);
-    gLinearMaskGamma = NULL;
-    SkSafeUnref(gMaskGamma);
-    gMaskGamma = NULL;
-    SkDEBUGCODE(gContrast = SK_ScalarMin;)
-    SkDEBUGCODE(gPaintGamma = SK_ScalarMin;)
-    SkDEBUGCODE(gDeviceGamma = SK_ScalarMin;)
+    // No other thread may be making scaler contexts by now.
+    const int count = SkTMin<int>(gMaskGammaEntryCount, kMaxCachedMaskGammas);
+    for (int i = 0; i < count; ++i) {
+        MaskGammaEntry* entry = gMaskGammaEntries[i];
+        if (NULL != entry) {
+            entry->fMaskGamma->unref();
+            SkDELETE(entry);
+            gMaskGammaEntries[i] = NULL;
+        }
+    }
+    gMaskGammaEntryCount = 0;
 }
 
 /**
@@ -1968,11 +1997,16 @@ SkGlyphCache* SkPaint::detachCache(const SkDeviceProperties* deviceProperties,
  */
 //static
 SkMaskGamma::PreBlend SkScalerContext::GetMaskPreBlend(const SkScalerContext::Rec& rec) {
-    SkAutoMutexAcquire ama(gMaskGammaCacheMutex);
-    const SkMaskGamma& maskGamma = cachedMaskGamma(rec.getContrast(),
-                                                   rec.getPaintGamma(),
-                                                   rec.getDeviceGamma());
-    return maskGamma.preBlend(rec.getLuminanceColor());
+    const SkScalar contrast = rec.getContrast();
+    const SkScalar paintGamma = rec.getPaintGamma();
+    const SkScalar deviceGamma = rec.getDeviceGamma();
+    if (0 == contrast && SK_Scalar1 == paintGamma && SK_Scalar1 == deviceGamma) {
+        // A linear mask gamma has nothing to pre-blend.
+        return SkMaskGamma::PreBlend();
+    }
+    // The pre-blend holds its own ref on the mask gamma.
+    SkAutoTUnref<SkMaskGamma> maskGamma(refMaskGamma(contrast, paintGamma, deviceGamma));
+    return maskGamma->preBlend(rec.getLuminanceColor());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -6,20 +6,26 @@
  * found in the LICENSE file.
  */
 #include "SkPathHeap.h"
+#include "SkData.h"
+#include "SkOnce.h"
 #include "SkPath.h"
 #include "SkStream.h"
 #include "SkReadBuffer.h"
-#include "SkTSearch.h"
 #include "SkWriteBuffer.h"
 #include <new>
 
 #define kPathCount  64
 
-SkPathHeap::SkPathHeap() : fHeap(kPathCount * sizeof(SkPath)) {
+SkPathHeap::SkPathHeap()
+    : fHeap(kPathCount * sizeof(SkPath))
+    , fData(NULL)
+    , fLazyPaths(NULL) {
 }
 
 SkPathHeap::SkPathHeap(SkReadBuffer& buffer)
-            : fHeap(kPathCount * sizeof(SkPath)) {
+    : fHeap(kPathCount * sizeof(SkPath))
+    , fData(NULL)
+    , fLazyPaths(NULL) {
     const int count = buffer.readInt();
 
     fPaths.setCount(count);
@@ -34,6 +40,72 @@ SkPathHeap::SkPathHeap(SkReadBuffer& buffer)
     }
 }
 
+// The size of one path as flattened by SkPath::writeToMemory(): the path's
+// packed fields, then SkPathRef::writeToBuffer()'s five words, verbs, points,
+// conic weights and bounds. Returns 0 if the path does not fit in length.
+static size_t flattened_path_size(const void* storage, size_t length) {
+    static const size_t kHeaderSize = 6 * sizeof(int32_t);
+    if (length < kHeaderSize) {
+        return 0;
+    }
+    const int32_t* header = static_cast<const int32_t*>(storage);
+    const int32_t verbCount = header[3];
+    const int32_t pointCount = header[4];
+    const int32_t conicCount = header[5];
+    if (verbCount < 0 || pointCount < 0 || conicCount < 0) {
+        return 0;
+    }
+    const uint64_t size = kHeaderSize
+                        + (uint64_t)verbCount * sizeof(uint8_t)
+                        + (uint64_t)pointCount * sizeof(SkPoint)
+                        + (uint64_t)conicCount * sizeof(SkScalar)
+                        + sizeof(SkRect);
+    if (SkAlign4(size) > length) {
+        return 0;
+    }
+    return static_cast<size_t>(SkAlign4(size));
+}
+
+SkPathHeap::SkPathHeap(SkReadBuffer& buffer, SkData* data)
+    : fHeap(kPathCount * sizeof(SkPath))
+    , fData(NULL)
+    , fLazyPaths(NULL) {
+    const int count = buffer.readInt();
+    if (count <= 0) {
+        return;
+    }
+
+    fPaths.setCount(count);
+    SkPath* p = (SkPath*)fHeap.allocThrow(count * sizeof(SkPath));
+    fLazyPaths = (LazyPath*)fHeap.allocThrow(count * sizeof(LazyPath));
+
+    bool valid = true;
+    for (int i = 0; i < count; i++) {
+        new (p) SkPath;
+        fPaths[i] = p;
+
+        LazyPath* lazy = &fLazyPaths[i];
+        lazy->fPath = p;
+        lazy->fFlattened = NULL;
+        lazy->fSize = 0;
+        if (valid) {
+            // skip(0) just returns where the next path starts.
+            const size_t available = buffer.size() - buffer.offset();
+            lazy->fSize = flattened_path_size(buffer.skip(0), available);
+            valid = lazy->fSize > 0;
+        }
+        if (valid) {
+            lazy->fFlattened = buffer.skip(lazy->fSize);
+            SkASSERT(lazy->fFlattened >= data->data() &&
+                     lazy->fFlattened < data->bytes() + data->size());
+        }
+        // Paths after a bad one are left empty.
+        lazy->fDone = !valid;
+        p++;
+    }
+    fData = SkRef(data);
+}
+
 SkPathHeap::~SkPathHeap() {
     SkPath** iter = fPaths.begin();
     SkPath** stop = fPaths.end();
@@ -41,6 +113,18 @@ SkPathHeap::~SkPathHeap() {
         (*iter)->~SkPath();
         iter++;
     }
+    SkSafeUnref(fData);
+}
+
+void SkPathHeap::UnflattenPath(LazyPath* lazy) {
+    SkDEBUGCODE(size_t size =) lazy->fPath->readFromMemory(lazy->fFlattened, lazy->fSize);
+    SkASSERT(size == lazy->fSize);
+}
+
+void SkPathHeap::unflatten(int index) const {
+    SkASSERT(NULL != fLazyPaths);
+    LazyPath* lazy = &fLazyPaths[index];
+    SkOnce(&lazy->fDone, &fLazyMutex, UnflattenPath, lazy);
 }
 
 int SkPathHeap::append(const SkPath& path) {
@@ -50,35 +134,19 @@ int SkPathHeap::append(const SkPath& path) {
     return fPaths.count();
 }
 
-SkPathHeap::LookupEntry::LookupEntry(const SkPath& path)
-    : fGenerationID(path.getGenerationID()), fStorageSlot(0) {
-}
-
-SkPathHeap::LookupEntry* SkPathHeap::addIfNotPresent(const SkPath& path) {
-    LookupEntry searchKey(path);
-    int index = SkTSearch<const LookupEntry, LookupEntry::Less>(
-                                    fLookupTable.begin(),
-                                    fLookupTable.count(),
-                                    searchKey,
-                                    sizeof(LookupEntry));
-    if (index < 0) {
-        index = ~index;
-        *fLookupTable.insert(index) = LookupEntry(path);
-    }
-
-    return &fLookupTable[index];;
-}
-
 int SkPathHeap::insert(const SkPath& path) {
-    SkPathHeap::LookupEntry* entry = this->addIfNotPresent(path);
-
-    if (entry->storageSlot() > 0) {
-        return entry->storageSlot();
+    const uint32_t genID = path.getGenerationID();
+    LookupEntry* entry = fLookupTable.find(genID);
+    if (NULL != entry) {
+        return entry->fStorageSlot;
     }
 
     int newSlot = this->append(path);
     SkASSERT(newSlot > 0);
-    entry->setStorageSlot(newSlot);
+    entry = (LookupEntry*)fHeap.allocThrow(sizeof(LookupEntry));
+    entry->fGenerationID = genID;
+    entry->fStorageSlot = newSlot;
+    fLookupTable.add(entry);
     return newSlot;
 }
 
@@ -86,10 +154,7 @@ void SkPathHeap::flatten(SkWriteBuffer& buffer) const {
     int count = fPaths.count();
 
     buffer.writeInt(count);
-    SkPath* const* iter = fPaths.begin();
-    SkPath* const* stop = fPaths.end();
-    while (iter < stop) {
-        buffer.writePath(**iter);
-        iter++;
+    for (int i = 0; i < count; i++) {
+        buffer.writePath((*this)[i]);
     }
 }
@@ -9,9 +9,13 @@
 #define SkPathHeap_DEFINED
 
 #include "SkRefCnt.h"
+#include "SkChecksum.h"
 #include "SkChunkAlloc.h"
 #include "SkTDArray.h"
+#include "SkTDynamicHash.h"
+#include "SkThread.h"
 
+class SkData;
 class SkPath;
 class SkReadBuffer;
 class SkWriteBuffer;
@@ -22,6 +26,13 @@ public:
 
     SkPathHeap();
     SkPathHeap(SkReadBuffer&);
+
+    /** Like SkPathHeap(SkReadBuffer&), but the flattened paths are left where
+        they are in the buffer, whose memory must belong to data, and are
+        only unflattened the first time they are looked up. The heap refs
+        data for as long as it needs the flattened paths.
+     */
+    SkPathHeap(SkReadBuffer&, SkData* data);
     virtual ~SkPathHeap();
 
     /** Copy the path into the heap, and return the new total number of paths.
@@ -38,6 +49,9 @@ public:
     // called during picture-playback
     int count() const { return fPaths.count(); }
     const SkPath& operator[](int index) const {
+        if (NULL != fData) {
+            this->unflatten(index);
+        }
         return *fPaths[index];
     }
 
@@ -49,26 +63,36 @@ private:
     // we just store ptrs into fHeap here
     SkTDArray<SkPath*>  fPaths;
 
-    class LookupEntry {
-    public:
-        LookupEntry(const SkPath& path);
-
-        int storageSlot() const { return fStorageSlot; }
-        void setStorageSlot(int storageSlot) { fStorageSlot = storageSlot; }
+    // Only used by lazily unflattened heaps, to find each path's flattened
+    // data and to read it into fPaths just once, even across threads.
+    struct LazyPath {
+        const void* fFlattened;
+        size_t      fSize;
+        SkPath*     fPath;
+        bool        fDone;
+    };
+    SkData*             fData;
+    LazyPath*           fLazyPaths;
+    mutable SkMutex     fLazyMutex;
 
-        static bool Less(const LookupEntry& a, const LookupEntry& b) {
-            return a.fGenerationID < b.fGenerationID;
-        }
+    void unflatten(int index) const;
+    static void UnflattenPath(LazyPath*);
 
-    private:
-        uint32_t fGenerationID;     // the SkPath's generation ID
-        // the path's index in the heap + 1. It is 0 if the path is not yet in the heap.
+    // Maps a path's gen ID to its index in the heap + 1. The entries live in fHeap. A hash,
+    // rather than a sorted array, so inserting each of many distinct paths stays O(1).
+    struct LookupEntry {
+        uint32_t fGenerationID;
         int      fStorageSlot;
-    };
 
-    SkTDArray<LookupEntry> fLookupTable;
+        static const uint32_t& GetKey(const LookupEntry& entry) {
+            return entry.fGenerationID;
+        }
+        static uint32_t Hash(const uint32_t& genID) {
+            return SkChecksum::Murmur3(&genID, sizeof(genID));
+        }
+    };
 
-    SkPathHeap::LookupEntry* addIfNotPresent(const SkPath& path);
+    SkTDynamicHash<LookupEntry, uint32_t> fLookupTable;
 
     typedef SkRefCnt INHERITED;
 };
@@ -8,8 +8,11 @@
 
 
 #include "SkPathMeasure.h"
+#include "SkData.h"
 #include "SkGeometry.h"
 #include "SkPath.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
 #include "SkTSearch.h"
 
 // these must be 0,1,2 since they are in our 2-bit field
@@ -128,7 +131,129 @@ SkScalar SkPathMeasure::compute_cubic_segs(const SkPoint pts[4],
     return distance;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+/*  Dashing and text on a path measure the same paths draw after draw, and
+ *  flattening their curves into segments is most of the cost. So contours
+ *  with enough segments are cached by path generation ID, along with the
+ *  state the measure starts the contour with (which only depends on the
+ *  contours before it). A hit copies the segments and points back and
+ *  replays the iterator past the contour instead of subdividing again.
+ */
+namespace {
+
+struct MeasureRec {
+    uint32_t    fGenID;
+    bool        fForceClosed;
+    int         fStartPtIndex;
+    int         fStartPtCount;
+
+    SkData*     fSegments;      // SkPathMeasure::Segment[]
+    SkData*     fPts;           // the SkPoints the contour appended
+    SkScalar    fLength;
+    bool        fIsClosed;
+    int         fEndPtIndex;
+    int         fIterSteps;     // calls to SkPath::Iter::next() the contour took
+
+    bool matches(uint32_t genID, bool forceClosed, int startPtIndex, int startPtCount) const {
+        return fGenID == genID && fForceClosed == forceClosed &&
+               fStartPtIndex == startPtIndex && fStartPtCount == startPtCount;
+    }
+
+    size_t bytes() const { return fSegments->size() + fPts->size(); }
+};
+
+}  // namespace
+
+// Contours with fewer segments (mostly lines) are as cheap to measure as to copy.
+static const int kMinCachedSegments = 16;
+static const int kMaxCachedContours = 64;
+static const size_t kMaxCachedBytes = 512 * 1024;
+
+SK_DECLARE_STATIC_MUTEX(gMeasureCacheMutex);
+// Most recently used last, and allocated on first use. Guarded by gMeasureCacheMutex.
+static SkTDArray<MeasureRec>* gMeasureCache;
+static size_t gMeasureCacheBytes;
+
+static void unref_rec(const MeasureRec& rec) {
+    rec.fSegments->unref();
+    rec.fPts->unref();
+}
+
+// Returns the matching rec with its data reffed, or false.
+static bool find_measure_rec(uint32_t genID, bool forceClosed, int startPtIndex,
+                             int startPtCount, MeasureRec* result) {
+    SkAutoMutexAcquire am(gMeasureCacheMutex);
+    if (NULL == gMeasureCache) {
+        return false;
+    }
+    SkTDArray<MeasureRec>& cache = *gMeasureCache;
+    for (int i = cache.count() - 1; i >= 0; --i) {
+        if (cache[i].matches(genID, forceClosed, startPtIndex, startPtCount)) {
+            *result = cache[i];
+            cache.remove(i);
+            *cache.append() = *result;
+            result->fSegments->ref();
+            result->fPts->ref();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Takes ownership of rec's data.
+static void add_measure_rec(const MeasureRec& rec) {
+    SkAutoMutexAcquire am(gMeasureCacheMutex);
+    if (NULL == gMeasureCache) {
+        gMeasureCache = SkNEW(SkTDArray<MeasureRec>);
+    }
+    SkTDArray<MeasureRec>& cache = *gMeasureCache;
+    for (int i = 0; i < cache.count(); ++i) {
+        if (cache[i].matches(rec.fGenID, rec.fForceClosed, rec.fStartPtIndex,
+                                     rec.fStartPtCount)) {
+            // Another thread measured it too.
+            unref_rec(rec);
+            return;
+        }
+    }
+    *cache.append() = rec;
+    gMeasureCacheBytes += rec.bytes();
+
+    int purge = 0;
+    while (cache.count() - purge > kMaxCachedContours ||
+           (gMeasureCacheBytes > kMaxCachedBytes && purge < cache.count() - 1)) {
+        gMeasureCacheBytes -= cache[purge].bytes();
+        unref_rec(cache[purge]);
+        purge += 1;
+    }
+    cache.remove(0, purge);
+}
+
 void SkPathMeasure::buildSegments() {
+    const uint32_t genID = fPath->getGenerationID();
+    const int startPtIndex = fFirstPtIndex;
+    const int startPtCount = fPts.count();
+    int iterSteps = 0;
+
+    MeasureRec rec;
+    if (find_measure_rec(genID, fForceClosed, startPtIndex, startPtCount, &rec)) {
+        int segCount = SkToInt(rec.fSegments->size() / sizeof(Segment));
+        fSegments.setCount(segCount);
+        memcpy(fSegments.begin(), rec.fSegments->data(), rec.fSegments->size());
+        fPts.append(SkToInt(rec.fPts->size() / sizeof(SkPoint)),
+                    static_cast<const SkPoint*>(rec.fPts->data()));
+
+        SkPoint pts[4];
+        for (int i = 0; i < rec.fIterSteps; ++i) {
+            fIter.next(pts);
+        }
+        fLength = rec.fLength;
+        fIsClosed = rec.fIsClosed;
+        fFirstPtIndex = rec.fEndPtIndex;
+        unref_rec(rec);
+        return;
+    }
+
     SkPoint         pts[4];
     int             ptIndex = fFirstPtIndex;
     SkScalar        distance = 0;
@@ -146,6 +271,7 @@ void SkPathMeasure::buildSegments() {
     fSegments.reset();
     bool done = false;
     do {
+        iterSteps += 1;
         switch (fIter.next(pts)) {
             case SkPath::kConic_Verb:
                 SkASSERT(0);
@@ -210,6 +336,22 @@ void SkPathMeasure::buildSegments() {
     fIsClosed = isClosed;
     fFirstPtIndex = ptIndex;
 
+    if (fSegments.count() >= kMinCachedSegments) {
+        rec.fGenID = genID;
+        rec.fForceClosed = fForceClosed;
+        rec.fStartPtIndex = startPtIndex;
+        rec.fStartPtCount = startPtCount;
+        rec.fSegments = SkData::NewWithCopy(fSegments.begin(),
+                                            fSegments.count() * sizeof(Segment));
+        rec.fPts = SkData::NewWithCopy(fPts.begin() + startPtCount,
+                                       (fPts.count() - startPtCount) * sizeof(SkPoint));
+        rec.fLength = fLength;
+        rec.fIsClosed = fIsClosed;
+        rec.fEndPtIndex = fFirstPtIndex;
+        rec.fIterSteps = iterSteps;
+        add_measure_rec(rec);
+    }
+
 #ifdef SK_DEBUG
     {
         const Segment* seg = fSegments.begin();
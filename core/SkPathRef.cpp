@@ -6,6 +6,7 @@
  */
 
 #include "SkBuffer.h"
+#include "SkMatrixUtils.h"
 #include "SkOnce.h"
 #include "SkPath.h"
 #include "SkPathRef.h"
@@ -72,7 +73,16 @@ void SkPathRef::CreateTransformedCopy(SkAutoTUnref<SkPathRef>* dst,
     // Need to check this here in case (&src == dst)
     bool canXformBounds = !src.fBoundsIsDirty && matrix.rectStaysRect() && src.countPoints() > 1;
 
-    matrix.mapPoints((*dst)->fPoints, src.points(), src.fPointCnt);
+    // Otherwise the bounds are found as the points are mapped. ComputePtBounds()
+    // has its own rules for paths of fewer than two points, so leave those dirty.
+    bool computeBounds = !canXformBounds && src.countPoints() > 1;
+
+    if (computeBounds) {
+        (*dst)->fIsFinite = SkMatrixMapPointsAndBounds(matrix, (*dst)->fPoints, src.points(),
+                                                       src.fPointCnt, &(*dst)->fBounds);
+    } else {
+        matrix.mapPoints((*dst)->fPoints, src.points(), src.fPointCnt);
+    }
 
     /*
         *  Here we optimize the bounds computation, by noting if the bounds are
@@ -96,7 +106,7 @@ void SkPathRef::CreateTransformedCopy(SkAutoTUnref<SkPathRef>* dst,
             (*dst)->fBounds.setEmpty();
         }
     } else {
-        (*dst)->fBoundsIsDirty = true;
+        (*dst)->fBoundsIsDirty = !computeBounds;
     }
 
     (*dst)->fSegmentMask = src.fSegmentMask;
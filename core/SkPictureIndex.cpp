@@ -0,0 +1,194 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPictureIndex.h"
+
+#include "SkStream.h"
+
+static const char kIndexMagic[] = { 's', 'k', 'i', 'a', 'p', 'i', 'd', 'x' };
+
+namespace {
+
+struct Header {
+    char        fMagic[8];
+    uint32_t    fVersion;
+    uint32_t    fSectionCount;
+    SkPictInfo  fInfo;
+};
+
+}  // namespace
+
+static size_t align_section(size_t offset) {
+    return (offset + SkPictureIndex::kSectionAlignment - 1) &
+           ~(size_t)(SkPictureIndex::kSectionAlignment - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkPictureIndexWriter::~SkPictureIndexWriter() {
+    for (int i = 0; i < fPending.count(); ++i) {
+        fPending[i].fData->unref();
+    }
+}
+
+void SkPictureIndexWriter::add(uint32_t tag, uint32_t count, SkData* data) {
+    SkASSERT(NULL != data);
+    Pending& pending = fPending.push_back();
+    pending.fTag = tag;
+    pending.fCount = count;
+    pending.fData = SkRef(data);
+}
+
+bool SkPictureIndexWriter::addTagged(SkData* data) {
+    if (data->size() < 2 * sizeof(uint32_t)) {
+        return false;
+    }
+    const uint32_t* tagSize = static_cast<const uint32_t*>(data->data());
+    SkAutoTUnref<SkData> payload(SkData::NewSubset(data, 2 * sizeof(uint32_t),
+                                                   data->size() - 2 * sizeof(uint32_t)));
+    this->add(tagSize[0], tagSize[1], payload);
+    return true;
+}
+
+bool SkPictureIndexWriter::writeToStream(SkWStream* stream) const {
+    const int count = fPending.count();
+
+    Header header;
+    memcpy(header.fMagic, kIndexMagic, sizeof(kIndexMagic));
+    header.fVersion = SkPictureIndex::kCurrentVersion;
+    header.fSectionCount = count;
+    header.fInfo = fInfo;
+
+    SkAutoSTMalloc<8, SkPictureIndex::Section> sections(count);
+    size_t offset = sizeof(Header) + count * sizeof(SkPictureIndex::Section);
+    for (int i = 0; i < count; ++i) {
+        offset = align_section(offset);
+        if (offset > SK_MaxU32 || fPending[i].fData->size() > SK_MaxU32 - offset) {
+            return false;
+        }
+        sections[i].fTag = fPending[i].fTag;
+        sections[i].fCount = fPending[i].fCount;
+        sections[i].fOffset = SkToU32(offset);
+        sections[i].fLength = SkToU32(fPending[i].fData->size());
+        offset += fPending[i].fData->size();
+    }
+
+    static const char kZeros[SkPictureIndex::kSectionAlignment] = { 0 };
+    if (!stream->write(&header, sizeof(header)) ||
+        !stream->write(sections.get(), count * sizeof(SkPictureIndex::Section))) {
+        return false;
+    }
+    size_t written = sizeof(header) + count * sizeof(SkPictureIndex::Section);
+    for (int i = 0; i < count; ++i) {
+        const size_t pad = sections[i].fOffset - written;
+        if (!stream->write(kZeros, pad) ||
+            !stream->write(fPending[i].fData->data(), sections[i].fLength)) {
+            return false;
+        }
+        written = sections[i].fOffset + sections[i].fLength;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkPictureIndex::SkPictureIndex(SkData* data, const SkPictInfo& info)
+    : fData(SkRef(data))
+    , fInfo(info) {
+}
+
+bool SkPictureIndex::Write(const SkPicture& picture, SkWStream* stream,
+                           SkPicture::EncodeBitmap encoder) {
+    SkPictureIndexWriter writer;
+    SkPicturePlayback::SerializeSections(picture, &writer, encoder);
+    return writer.writeToStream(stream);
+}
+
+static void unref_stream_proc(const void*, size_t, void* context) {
+    static_cast<SkStream*>(context)->unref();
+}
+
+SkPictureIndex* SkPictureIndex::Open(SkStream* stream) {
+    if (NULL == stream) {
+        return NULL;
+    }
+
+    // Reference memory backed streams in place, as long as the sections stay aligned for
+    // SkReader32 and SkReadBuffer.
+    const uint8_t* base = static_cast<const uint8_t*>(stream->getMemoryBase());
+    if (NULL != base && stream->hasPosition() && stream->hasLength() &&
+        stream->getPosition() <= stream->getLength() &&
+        SkIsAlign4(reinterpret_cast<uintptr_t>(base + stream->getPosition()))) {
+        const size_t position = stream->getPosition();
+        const size_t size = stream->getLength() - position;
+        SkStream* owner = stream->duplicate();
+        if (NULL != owner) {
+            if (owner->getMemoryBase() == base && stream->skip(size) == size) {
+                SkAutoTUnref<SkData> data(SkData::NewWithProc(base + position, size,
+                                                              unref_stream_proc, owner));
+                return Open(data);
+            }
+            owner->unref();
+        }
+    }
+
+    SkDynamicMemoryWStream copy;
+    char buffer[4096];
+    size_t bytes;
+    while ((bytes = stream->read(buffer, sizeof(buffer))) > 0) {
+        copy.write(buffer, bytes);
+    }
+    SkAutoTUnref<SkData> data(copy.copyToData());
+    return Open(data);
+}
+
+SkPictureIndex* SkPictureIndex::Open(SkData* data) {
+    if (NULL == data || data->size() < sizeof(Header)) {
+        return NULL;
+    }
+
+    Header header;
+    memcpy(&header, data->data(), sizeof(header));
+    if (0 != memcmp(header.fMagic, kIndexMagic, sizeof(kIndexMagic)) ||
+        header.fVersion > kCurrentVersion) {
+        return NULL;
+    }
+    const size_t maxSections = (data->size() - sizeof(Header)) / sizeof(Section);
+    if (header.fSectionCount > maxSections) {
+        return NULL;
+    }
+
+    SkAutoTUnref<SkPictureIndex> index(SkNEW_ARGS(SkPictureIndex, (data, header.fInfo)));
+    const int count = header.fSectionCount;
+    index->fSections.push_back_n(count);
+    memcpy(index->fSections.begin(), data->bytes() + sizeof(Header), count * sizeof(Section));
+    for (int i = 0; i < count; ++i) {
+        const Section& section = index->fSections[i];
+        if (section.fOffset > data->size() || section.fLength > data->size() - section.fOffset ||
+            !SkIsAlign4(section.fOffset)) {
+            return NULL;
+        }
+    }
+    return index.detach();
+}
+
+const SkPictureIndex::Section* SkPictureIndex::find(uint32_t tag) const {
+    for (int i = 0; i < fSections.count(); ++i) {
+        if (fSections[i].fTag == tag) {
+            return &fSections[i];
+        }
+    }
+    return NULL;
+}
+
+SkData* SkPictureIndex::refSection(const Section& section) const {
+    return SkData::NewSubset(fData, section.fOffset, section.fLength);
+}
+
+SkPicture* SkPictureIndex::createPicture(SkPicture::InstallPixelRefProc proc) const {
+    return SkPicturePlayback::CreateFromIndex(*this, proc);
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureIndex_DEFINED
+#define SkPictureIndex_DEFINED
+
+#include "SkData.h"
+#include "SkPicture.h"
+#include "SkPicturePlayback.h"
+#include "SkTArray.h"
+
+class SkStream;
+class SkWStream;
+
+/**
+ *  An indexed container for a serialized SkPicture. Where SkPicture::serialize() writes its
+ *  tagged sections one after another, so that reading any of them means parsing all that come
+ *  before, the container starts with a table of contents giving each section's tag, offset and
+ *  length, and starts each section on a kSectionAlignment boundary.
+ *
+ *  Opening a container only reads the header and the table, and references a memory mapped
+ *  stream in place, so a reader can look at the picture's info (its bounds) or pull out single
+ *  sections without decoding anything else. The sections are the ones of the sequential format
+ *  (ops, factories, typefaces, nested pictures and the flattened objects) with the same
+ *  payloads, and apart from the flattened objects, which need the factories and typefaces,
+ *  they can be decoded independently of each other.
+ *
+ *  The container has its own magic and version, separate from the picture version carried in
+ *  its SkPictInfo, so its layout can change without touching the sequential format. Readers
+ *  skip sections whose tags they don't know.
+ */
+class SkPictureIndex : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkPictureIndex)
+
+    enum {
+        kCurrentVersion     = 1,
+        kSectionAlignment   = 16,
+    };
+
+    struct Section {
+        uint32_t    fTag;       // an SK_PICT_*_TAG from SkPicturePlayback.h
+        uint32_t    fCount;     // the size field the sequential format writes after the tag
+        uint32_t    fOffset;    // from the start of the container
+        uint32_t    fLength;    // in bytes
+    };
+
+    /**
+     *  Writes the picture to the stream as an indexed container. Nested pictures are written
+     *  in the sequential format inside their section.
+     */
+    static bool Write(const SkPicture&, SkWStream*, SkPicture::EncodeBitmap = NULL);
+
+    /**
+     *  Reads the header and table of contents of a container. If the stream is memory backed
+     *  (SkMemoryStream, or the memory mapped files from SkStream::NewFromFile) the container
+     *  is referenced in place, otherwise the rest of the stream is copied into memory. Returns
+     *  NULL if the stream isn't a valid container.
+     */
+    static SkPictureIndex* Open(SkStream*);
+    static SkPictureIndex* Open(SkData*);
+
+    const SkPictInfo& info() const { return fInfo; }
+    int width() const { return fInfo.fWidth; }
+    int height() const { return fInfo.fHeight; }
+
+    int count() const { return fSections.count(); }
+    const Section& section(int index) const { return fSections[index]; }
+
+    /** Returns the section with the tag, or NULL if the container has none. */
+    const Section* find(uint32_t tag) const;
+
+    /** Returns the bytes of the section, referenced in place. The caller owns the ref. */
+    SkData* refSection(const Section&) const;
+
+    /**
+     *  Decodes the picture. Returns NULL if the sections don't make a valid picture. The
+     *  caller owns the ref.
+     */
+    SkPicture* createPicture(SkPicture::InstallPixelRefProc = NULL) const;
+
+private:
+    SkPictureIndex(SkData*, const SkPictInfo&);
+
+    SkAutoTUnref<SkData>    fData;
+    SkPictInfo              fInfo;
+    SkTArray<Section, true> fSections;
+
+    typedef SkRefCnt INHERITED;
+};
+
+/**
+ *  Collects the sections SkPicturePlayback writes for SkPictureIndex::Write().
+ */
+class SkPictureIndexWriter {
+public:
+    ~SkPictureIndexWriter();
+
+    void setInfo(const SkPictInfo& info) { fInfo = info; }
+
+    /** Adds a section whose payload is the data. */
+    void add(uint32_t tag, uint32_t count, SkData*);
+
+    /**
+     *  Adds a section written in the sequential format, starting with its tag and size, as
+     *  SkPicturePlayback's helpers write them.
+     */
+    bool addTagged(SkData*);
+
+    bool writeToStream(SkWStream*) const;
+
+private:
+    struct Pending {
+        uint32_t    fTag;
+        uint32_t    fCount;
+        SkData*     fData;  // reffed
+    };
+
+    SkPictInfo              fInfo;
+    SkTArray<Pending, true> fPending;
+};
+
+#endif
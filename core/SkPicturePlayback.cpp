@@ -6,10 +6,14 @@
  */
 #include <new>
 #include "SkBBoxHierarchy.h"
+#include "SkPictureIndex.h"
 #include "SkPicturePlayback.h"
 #include "SkPictureRecord.h"
 #include "SkPictureStateTree.h"
+#include "SkPixelRefLockCache.h"
 #include "SkReadBuffer.h"
+#include "SkStream.h"
+#include "SkTLS.h"
 #include "SkTypeface.h"
 #include "SkTSort.h"
 #include "SkWriteBuffer.h"
@@ -73,7 +77,7 @@ SkPicturePlayback::SkPicturePlayback(const SkPicture* picture,
 #endif
 
     record.validate(record.writeStream().bytesWritten(), 0);
-    const SkWriter32& writer = record.writeStream();
+    const SkSegmentedWriter32& writer = record.writeStream();
     this->init();
     SkASSERT(!fOpData);
     if (writer.bytesWritten() == 0) {
@@ -200,11 +204,11 @@ void SkPicturePlayback::init() {
     fPictureRefs = NULL;
     fPictureCount = 0;
     fOpData = NULL;
+    fInPlaceBufferData = NULL;
     fFactoryPlayback = NULL;
     fBoundingHierarchy = NULL;
     fStateTree = NULL;
     fCachedActiveOps = NULL;
-    fCurOffset = 0;
 }
 
 SkPicturePlayback::~SkPicturePlayback() {
@@ -368,6 +372,64 @@ void SkPicturePlayback::serialize(SkWStream* stream,
     stream->write32(SK_PICT_EOF_TAG);
 }
 
+// Like serialize(), with each section going into the writer instead of after the last.
+void SkPicturePlayback::serializeSections(SkPictureIndexWriter* writer,
+                                          SkPicture::EncodeBitmap encoder) const {
+    writer->add(SK_PICT_READER_TAG, SkToU32(fOpData->size()), fOpData);
+
+    if (fPictureCount > 0) {
+        SkDynamicMemoryWStream pictures;
+        for (int i = 0; i < fPictureCount; i++) {
+            fPictureRefs[i]->serialize(&pictures, encoder);
+        }
+        SkAutoTUnref<SkData> data(pictures.copyToData());
+        writer->add(SK_PICT_PICTURE_TAG, fPictureCount, data);
+    }
+
+    SkRefCntSet  typefaceSet;
+    SkFactorySet factSet;
+
+    SkWriteBuffer buffer(SkWriteBuffer::kCrossProcess_Flag);
+    buffer.setTypefaceRecorder(&typefaceSet);
+    buffer.setFactoryRecorder(&factSet);
+    buffer.setBitmapEncoder(encoder);
+
+    this->flattenToBuffer(buffer);
+
+    SkDynamicMemoryWStream factories;
+    WriteFactories(&factories, factSet);
+    SkAutoTUnref<SkData> factoryData(factories.copyToData());
+    SkAssertResult(writer->addTagged(factoryData));
+
+    SkDynamicMemoryWStream typefaces;
+    WriteTypefaces(&typefaces, typefaceSet);
+    SkAutoTUnref<SkData> typefaceData(typefaces.copyToData());
+    SkAssertResult(writer->addTagged(typefaceData));
+
+    SkDynamicMemoryWStream flattened;
+    buffer.writeToStream(&flattened);
+    SkAutoTUnref<SkData> flattenedData(flattened.copyToData());
+    writer->add(SK_PICT_BUFFER_SIZE_TAG, SkToU32(flattenedData->size()), flattenedData);
+}
+
+void SkPicturePlayback::SerializeSections(const SkPicture& picture, SkPictureIndexWriter* writer,
+                                          SkPicture::EncodeBitmap encoder) {
+    SkPicturePlayback* playback = picture.fPlayback;
+
+    SkPictInfo info;
+    picture.createHeader(&info);
+    writer->setInfo(info);
+    if (NULL == playback && picture.fRecord) {
+        playback = SkNEW_ARGS(SkPicturePlayback, (&picture, *picture.fRecord, info));
+    }
+    if (playback) {
+        playback->serializeSections(writer, encoder);
+        if (playback != picture.fPlayback) {
+            SkDELETE(playback);
+        }
+    }
+}
+
 void SkPicturePlayback::flatten(SkWriteBuffer& buffer) const {
     SkPicture::WriteTagSize(buffer, SK_PICT_READER_TAG, fOpData->size());
     buffer.writeByteArray(fOpData->bytes(), fOpData->size());
@@ -409,6 +471,41 @@ static uint32_t pictInfoFlagsToReadBufferFlags(uint32_t pictInfoFlags) {
     return rbMask;
 }
 
+static void unref_stream_proc(const void*, size_t, void* context) {
+    static_cast<SkStream*>(context)->unref();
+}
+
+/**
+ *  If stream's next size bytes live in memory that a duplicate of the stream
+ *  keeps alive (as with an SkMemoryStream, including the memory mapped files
+ *  from SkStream::NewFromFile), returns an SkData that references them in
+ *  place and skips over them. Otherwise returns NULL and leaves the stream
+ *  where it was, so the caller can copy the bytes out as usual.
+ */
+static SkData* ref_in_place(SkStream* stream, size_t size) {
+    const uint8_t* base = static_cast<const uint8_t*>(stream->getMemoryBase());
+    if (NULL == base || !stream->hasPosition() || !stream->hasLength()) {
+        return NULL;
+    }
+    const size_t position = stream->getPosition();
+    if (position > stream->getLength() || stream->getLength() - position < size) {
+        return NULL;
+    }
+    // SkReader32 and SkReadBuffer want 4 byte aligned data.
+    if (!SkIsAlign4(reinterpret_cast<uintptr_t>(base + position))) {
+        return NULL;
+    }
+    SkStream* owner = stream->duplicate();
+    if (NULL == owner) {
+        return NULL;
+    }
+    if (owner->getMemoryBase() != base || stream->skip(size) != size) {
+        owner->unref();
+        return NULL;
+    }
+    return SkData::NewWithProc(base + position, size, unref_stream_proc, owner);
+}
+
 bool SkPicturePlayback::parseStreamTag(SkPicture* picture,
                                        SkStream* stream,
                                        uint32_t tag,
@@ -427,12 +524,15 @@ bool SkPicturePlayback::parseStreamTag(SkPicture* picture,
 
     switch (tag) {
         case SK_PICT_READER_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
-                return false;
-            }
             SkASSERT(NULL == fOpData);
-            fOpData = SkData::NewFromMalloc(storage.detach(), size);
+            fOpData = ref_in_place(stream, size);
+            if (NULL == fOpData) {
+                SkAutoMalloc storage(size);
+                if (stream->read(storage.get(), size) != size) {
+                    return false;
+                }
+                fOpData = SkData::NewFromMalloc(storage.detach(), size);
+            }
         } break;
         case SK_PICT_FACTORY_TAG: {
             SkASSERT(!haveBuffer);
@@ -496,12 +596,22 @@ bool SkPicturePlayback::parseStreamTag(SkPicture* picture,
             }
         } break;
         case SK_PICT_BUFFER_SIZE_TAG: {
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
-                return false;
+            // Read the flattened objects straight out of memory mapped
+            // streams. The paths can then stay there until they are drawn.
+            SkAutoTUnref<SkData> inPlace(ref_in_place(stream, size));
+            SkAutoMalloc storage;
+            const void* bufferData;
+            if (NULL != inPlace.get()) {
+                bufferData = inPlace->data();
+            } else {
+                storage.reset(size);
+                if (stream->read(storage.get(), size) != size) {
+                    return false;
+                }
+                bufferData = storage.get();
             }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(bufferData, size);
             buffer.setFlags(pictInfoFlagsToReadBufferFlags(fInfo.fFlags));
             buffer.setPictureVersion(fInfo.fVersion);
 
@@ -509,13 +619,16 @@ bool SkPicturePlayback::parseStreamTag(SkPicture* picture,
             fTFPlayback.setupBuffer(buffer);
             buffer.setBitmapDecoder(proc);
 
+            fInPlaceBufferData = inPlace.get();
             while (!buffer.eof()) {
                 tag = buffer.readUInt();
                 size = buffer.readUInt();
                 if (!this->parseBufferTag(picture, buffer, tag, size)) {
+                    fInPlaceBufferData = NULL;
                     return false;
                 }
             }
+            fInPlaceBufferData = NULL;
             SkDEBUGCODE(haveBuffer = true;)
         } break;
     }
@@ -543,7 +656,11 @@ bool SkPicturePlayback::parseBufferTag(SkPicture* picture,
             }
         } break;
         case SK_PICT_PATH_BUFFER_TAG:
-            picture->parseBufferTag(buffer, tag, size);
+            if (NULL != fInPlaceBufferData && size > 0) {
+                picture->fPathHeap.reset(SkNEW_ARGS(SkPathHeap, (buffer, fInPlaceBufferData)));
+            } else {
+                picture->parseBufferTag(buffer, tag, size);
+            }
             break;
         case SK_PICT_READER_TAG: {
             SkAutoMalloc storage(size);
@@ -628,6 +745,54 @@ bool SkPicturePlayback::parseStream(SkPicture* picture,
     return true;
 }
 
+SkPicture* SkPicturePlayback::CreateFromIndex(const SkPictureIndex& index,
+                                              SkPicture::InstallPixelRefProc proc) {
+    const SkPictInfo& info = index.info();
+    if (!SkPicture::IsValidPictInfo(info)) {
+        return NULL;
+    }
+
+    SkAutoTUnref<SkPicture> newPict(SkNEW_ARGS(SkPicture, (NULL, info.fWidth, info.fHeight)));
+
+    // Pictures without a playback are written without any sections.
+    if (NULL != index.find(SK_PICT_READER_TAG)) {
+        SkAutoTDelete<SkPicturePlayback> playback(SkNEW_ARGS(SkPicturePlayback,
+                                                             (newPict.get(), info)));
+        if (!playback->parseIndex(newPict.get(), index, proc)) {
+            return NULL;
+        }
+        newPict->fPlayback = playback.detach();
+    }
+    return newPict.detach();
+}
+
+bool SkPicturePlayback::parseIndex(SkPicture* picture, const SkPictureIndex& index,
+                                   SkPicture::InstallPixelRefProc proc) {
+    // The flattened objects have to come after the factories and typefaces they refer to;
+    // anything else in the index is from a newer writer and is skipped.
+    static const uint32_t kTagOrder[] = {
+        SK_PICT_READER_TAG,
+        SK_PICT_FACTORY_TAG,
+        SK_PICT_TYPEFACE_TAG,
+        SK_PICT_PICTURE_TAG,
+        SK_PICT_BUFFER_SIZE_TAG,
+    };
+
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kTagOrder); ++i) {
+        const SkPictureIndex::Section* section = index.find(kTagOrder[i]);
+        if (NULL == section) {
+            continue;
+        }
+        // A memory stream over the section lets the ops and flattened objects stay in place.
+        SkAutoTUnref<SkData> data(index.refSection(*section));
+        SkMemoryStream stream(data);
+        if (!this->parseStreamTag(picture, &stream, section->fTag, section->fCount, proc)) {
+            return false;
+        }
+    }
+    return NULL != fOpData && NULL != fFactoryPlayback;
+}
+
 bool SkPicturePlayback::parseBuffer(SkPicture* picture, SkReadBuffer& buffer) {
     for (;;) {
         uint32_t tag = buffer.readUInt();
@@ -731,22 +896,141 @@ const SkPicture::OperationList& SkPicturePlayback::getActiveOps(const SkIRect& q
     return *fCachedActiveOps;
 }
 
-class SkAutoResetOpID {
+/**
+ *  Pushes a DrawState onto the calling thread's list for the length of one
+ *  SkPicturePlayback::draw().
+ */
+class SkAutoDrawState : SkNoncopyable {
 public:
-    SkAutoResetOpID(SkPicturePlayback* playback) : fPlayback(playback) { }
-    ~SkAutoResetOpID() {
-        if (NULL != fPlayback) {
-            fPlayback->resetOpID();
-        }
+    SkAutoDrawState(const SkPicturePlayback* playback)
+        : fList(static_cast<SkPicturePlayback::DrawState**>(
+                SkTLS::Get(NewList, DeleteList))) {
+        fState.fPlayback = playback;
+        fState.fCurOffset = 0;
+        fState.fPrev = *fList;
+        *fList = &fState;
+    }
+
+    ~SkAutoDrawState() {
+        SkASSERT(*fList == &fState);
+        *fList = fState.fPrev;
+    }
+
+    void setCurOffset(size_t offset) { fState.fCurOffset = offset; }
+
+    // Also the key for the thread's list in SkTLS.
+    static void* NewList() {
+        return SkNEW_ARGS(SkPicturePlayback::DrawState*, (NULL));
+    }
+
+    static void DeleteList(void* list) {
+        SkDELETE(static_cast<SkPicturePlayback::DrawState**>(list));
     }
 
 private:
-    SkPicturePlayback* fPlayback;
+    SkPicturePlayback::DrawState** fList;
+    SkPicturePlayback::DrawState fState;
 };
 
+size_t SkPicturePlayback::curOpID() const {
+    DrawState** list = static_cast<DrawState**>(SkTLS::Find(SkAutoDrawState::NewList));
+    if (NULL == list) {
+        return 0;
+    }
+    for (const DrawState* state = *list; NULL != state; state = state->fPrev) {
+        if (state->fPlayback == this) {
+            return state->fCurOffset;
+        }
+    }
+    return 0;
+}
+
+SkPicturePlayback::PlaybackReplacements::~PlaybackReplacements() {
+    for (int i = 0; i < fReplacements.count(); ++i) {
+        SkDELETE(fReplacements[i].fBM);
+    }
+}
+
+SkPicturePlayback::PlaybackReplacements::ReplacementInfo*
+SkPicturePlayback::PlaybackReplacements::push() {
+    ReplacementInfo* info = fReplacements.append();
+    info->fBM = NULL;
+    info->fPaint = NULL;
+    return info;
+}
+
+const SkPicturePlayback::PlaybackReplacements::ReplacementInfo*
+SkPicturePlayback::PlaybackReplacements::lookupByStart(size_t start) const {
+    int lo = 0, hi = fReplacements.count() - 1;
+    while (lo <= hi) {
+        SkASSERT(0 == lo || fReplacements[lo - 1].fStart < fReplacements[lo].fStart);
+        int mid = (lo + hi) >> 1;
+        if (fReplacements[mid].fStart == start) {
+            return &fReplacements[mid];
+        } else if (fReplacements[mid].fStart < start) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return NULL;
+}
+
+SkAutoPlaybackOverride::SkAutoPlaybackOverride(const SkPicture* picture, size_t start,
+                                               size_t stop, const SkMatrix& initialMatrix) {
+    SkASSERT(start < stop);
+    fOverride.fPicture = picture;
+    fOverride.fStart = start;
+    fOverride.fStop = stop;
+    fOverride.fInitialMatrix = initialMatrix;
+    fOverride.fReplacements = NULL;
+    this->push();
+}
+
+SkAutoPlaybackOverride::SkAutoPlaybackOverride(
+        const SkPicture* picture,
+        const SkPicturePlayback::PlaybackReplacements* replacements) {
+    fOverride.fPicture = picture;
+    fOverride.fStart = 0;
+    fOverride.fStop = 0;
+    fOverride.fReplacements = replacements;
+    this->push();
+}
+
+void SkAutoPlaybackOverride::push() {
+    fList = static_cast<SkPicturePlayback::Override**>(SkTLS::Get(NewList, DeleteList));
+    fOverride.fPrev = *fList;
+    *fList = &fOverride;
+}
+
+SkAutoPlaybackOverride::~SkAutoPlaybackOverride() {
+    SkASSERT(*fList == &fOverride);
+    *fList = fOverride.fPrev;
+}
+
+void* SkAutoPlaybackOverride::NewList() {
+    return SkNEW_ARGS(SkPicturePlayback::Override*, (NULL));
+}
+
+void SkAutoPlaybackOverride::DeleteList(void* list) {
+    SkDELETE(static_cast<SkPicturePlayback::Override**>(list));
+}
+
+const SkPicturePlayback::Override* SkPicturePlayback::FindOverride(const SkPicture* picture) {
+    Override** list = static_cast<Override**>(SkTLS::Find(SkAutoPlaybackOverride::NewList));
+    if (NULL == list) {
+        return NULL;
+    }
+    for (const Override* o = *list; NULL != o; o = o->fPrev) {
+        if (o->fPicture == picture) {
+            return o;
+        }
+    }
+    return NULL;
+}
+
 void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback) {
-    SkAutoResetOpID aroi(this);
-    SkASSERT(0 == fCurOffset);
+    SkAutoDrawState drawState(this);
 
 #ifdef ENABLE_TIME_DRAW
     SkAutoTime  at("SkPicture::draw", 50);
@@ -767,23 +1051,31 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
 
     SkReader32 reader(fOpData->bytes(), fOpData->size());
     TextContainer text;
+    // Keeps the bitmaps' pixels locked from their first draw to the end of playback.
+    SkPixelRefLockCache lockedPixelRefs;
+    SkTDArray<void*> activeOpsStorage;
     const SkTDArray<void*>* activeOps = NULL;
 
-    if (NULL != fStateTree && NULL != fBoundingHierarchy) {
+    // Overridden draws skip around on their own, so always go sequentially.
+    const Override* override = FindOverride(fPicture);
+    const PlaybackReplacements* replacements =
+        NULL != override ? override->fReplacements : NULL;
+
+    if (NULL != fStateTree && NULL != fBoundingHierarchy && NULL == override) {
         SkRect clipBounds;
         if (canvas.getClipBounds(&clipBounds)) {
             SkIRect query;
             clipBounds.roundOut(&query);
 
-            const SkPicture::OperationList& activeOpsList = this->getActiveOps(query);
-            if (activeOpsList.valid()) {
-                if (0 == activeOpsList.numOps()) {
-                    return;     // nothing to draw
-                }
-
-                // Since the opList is valid we know it is our derived class
-                activeOps = &((const CachedOperationList&)activeOpsList).fOps;
+            // Same as getActiveOps(), but into storage owned by this draw.
+            fBoundingHierarchy->search(query, &activeOpsStorage);
+            if (0 == activeOpsStorage.count()) {
+                return;     // nothing to draw
             }
+            SkTQSort<SkPictureStateTree::Draw>(
+                reinterpret_cast<SkPictureStateTree::Draw**>(activeOpsStorage.begin()),
+                reinterpret_cast<SkPictureStateTree::Draw**>(activeOpsStorage.end()-1));
+            activeOps = &activeOpsStorage;
         }
     }
 
@@ -803,6 +1095,17 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
     SkMatrix initialMatrix = canvas.getTotalMatrix();
     int originalSaveCount = canvas.getSaveCount();
 
+    size_t stop = 0;
+    if (NULL != override && 0 != override->fStop) {
+        initialMatrix = override->fInitialMatrix;
+        stop = override->fStop;
+        // Step over the op at fStart, which is not part of the range.
+        reader.setOffset(override->fStart);
+        uint32_t size;
+        (void)read_op_and_size(&reader, &size);
+        reader.setOffset(override->fStart + size);
+    }
+
 #ifdef SK_BUILD_FOR_ANDROID
     fAbortCurrentPlayback = false;
 #endif
@@ -826,18 +1129,44 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
         opCount++;
 #endif
 
-        fCurOffset = reader.offset();
+        size_t curOffset = reader.offset();
+        if (0 != stop && curOffset >= stop) {
+            break;
+        }
+        drawState.setCurOffset(curOffset);
         uint32_t size;
         DrawType op = read_op_and_size(&reader, &size);
         size_t skipTo = 0;
         if (NOOP == op) {
             // NOOPs are to be ignored - do not propagate them any further
-            skipTo = fCurOffset + size;
+            skipTo = curOffset + size;
+        } else if (SAVE_LAYER == op && NULL != replacements) {
+            const PlaybackReplacements::ReplacementInfo* ri =
+                replacements->lookupByStart(curOffset);
+            if (NULL != ri) {
+                // The layer's content was rendered in device space, so it is
+                // drawn under just the matrix the picture started with.
+                canvas.save();
+                canvas.setMatrix(initialMatrix);
+                SkRect src = SkRect::Make(ri->fSrcRect);
+                SkRect dst = SkRect::MakeXYWH(SkIntToScalar(ri->fPos.fX),
+                                              SkIntToScalar(ri->fPos.fY),
+                                              src.width(), src.height());
+                canvas.drawBitmapRectToRect(*ri->fBM, &src, dst, ri->fPaint);
+                canvas.restore();
+
+                // Resume after the layer's restore.
+                reader.setOffset(ri->fStop);
+                uint32_t restoreSize;
+                SkDEBUGCODE(DrawType restoreOp =) read_op_and_size(&reader, &restoreSize);
+                SkASSERT(RESTORE == restoreOp);
+                skipTo = ri->fStop + restoreSize;
+            }
 #ifdef SK_DEVELOPER
         } else {
             opIndex++;
             if (this->preDraw(opIndex, op)) {
-                skipTo = fCurOffset + size;
+                skipTo = curOffset + size;
             }
 #endif
         }
@@ -949,12 +1278,14 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
             case DRAW_BITMAP: {
                 const SkPaint* paint = this->getPaint(reader);
                 const SkBitmap& bitmap = this->getBitmap(reader);
+                lockedPixelRefs.lock(bitmap);
                 const SkPoint& loc = reader.skipT<SkPoint>();
                 canvas.drawBitmap(bitmap, loc.fX, loc.fY, paint);
             } break;
             case DRAW_BITMAP_RECT_TO_RECT: {
                 const SkPaint* paint = this->getPaint(reader);
                 const SkBitmap& bitmap = this->getBitmap(reader);
+                lockedPixelRefs.lock(bitmap);
                 const SkRect* src = this->getRectPtr(reader);   // may be null
                 const SkRect& dst = reader.skipT<SkRect>();     // required
                 SkCanvas::DrawBitmapRectFlags flags;
@@ -964,6 +1295,7 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
             case DRAW_BITMAP_MATRIX: {
                 const SkPaint* paint = this->getPaint(reader);
                 const SkBitmap& bitmap = this->getBitmap(reader);
+                lockedPixelRefs.lock(bitmap);
                 SkMatrix matrix;
                 this->getMatrix(reader, &matrix);
                 canvas.drawBitmapMatrix(bitmap, matrix, paint);
@@ -971,6 +1303,7 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
             case DRAW_BITMAP_NINE: {
                 const SkPaint* paint = this->getPaint(reader);
                 const SkBitmap& bitmap = this->getBitmap(reader);
+                lockedPixelRefs.lock(bitmap);
                 const SkIRect& src = reader.skipT<SkIRect>();
                 const SkRect& dst = reader.skipT<SkRect>();
                 canvas.drawBitmapNine(bitmap, src, dst, paint);
@@ -1006,11 +1339,14 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
                 const SkPaint& paint = *this->getPaint(reader);
                 canvas.drawOval(reader.skipT<SkRect>(), paint);
             } break;
-            case DRAW_PAINT:
-                canvas.drawPaint(*this->getPaint(reader));
-                break;
+            case DRAW_PAINT: {
+                const SkPaint& paint = *this->getPaint(reader);
+                lockedPixelRefs.lock(&paint);
+                canvas.drawPaint(paint);
+            } break;
             case DRAW_PATH: {
                 const SkPaint& paint = *this->getPaint(reader);
+                lockedPixelRefs.lock(&paint);
                 canvas.drawPath(getPath(reader), paint);
             } break;
             case DRAW_PICTURE:
@@ -1065,10 +1401,12 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
             } break;
             case DRAW_RECT: {
                 const SkPaint& paint = *this->getPaint(reader);
+                lockedPixelRefs.lock(&paint);
                 canvas.drawRect(reader.skipT<SkRect>(), paint);
             } break;
             case DRAW_RRECT: {
                 const SkPaint& paint = *this->getPaint(reader);
+                lockedPixelRefs.lock(&paint);
                 SkRRect rrect;
                 reader.readRRect(&rrect);
                 canvas.drawRRect(rrect, paint);
@@ -1076,6 +1414,7 @@ void SkPicturePlayback::draw(SkCanvas& canvas, SkDrawPictureCallback* callback)
             case DRAW_SPRITE: {
                 const SkPaint* paint = this->getPaint(reader);
                 const SkBitmap& bitmap = this->getBitmap(reader);
+                lockedPixelRefs.lock(bitmap);
                 int left = reader.readInt();
                 int top = reader.readInt();
                 canvas.drawSprite(bitmap, left, top, paint);
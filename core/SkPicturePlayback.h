@@ -26,6 +26,8 @@
 #include "SkThread.h"
 #endif
 
+class SkPictureIndex;
+class SkPictureIndexWriter;
 class SkPictureRecord;
 class SkStream;
 class SkWStream;
@@ -96,6 +98,11 @@ public:
     void serialize(SkWStream*, SkPicture::EncodeBitmap) const;
     void flatten(SkWriteBuffer&) const;
 
+    // The SkPicture side of SkPictureIndex::Write() and SkPictureIndex::createPicture().
+    static void SerializeSections(const SkPicture&, SkPictureIndexWriter*,
+                                  SkPicture::EncodeBitmap);
+    static SkPicture* CreateFromIndex(const SkPictureIndex&, SkPicture::InstallPixelRefProc);
+
     void dumpSize() const;
 
     bool containsBitmaps() const;
@@ -106,8 +113,35 @@ public:
     void abort() { fAbortCurrentPlayback = true; }
 #endif
 
-    size_t curOpID() const { return fCurOffset; }
-    void resetOpID() { fCurOffset = 0; }
+    // Returns the offset of the op this playback is drawing on the calling
+    // thread, or 0 if the calling thread isn't inside draw().
+    size_t curOpID() const;
+
+    // A set of saveLayer/restore blocks, each to be drawn as an already
+    // rendered bitmap instead (see SkAutoPlaybackOverride).
+    class PlaybackReplacements {
+    public:
+        ~PlaybackReplacements();
+
+        struct ReplacementInfo {
+            size_t          fStart;     // offset of the saveLayer
+            size_t          fStop;      // offset of its matching restore
+            SkIPoint        fPos;       // where fBM goes, relative to the initial matrix
+            SkBitmap*       fBM;        // owned by the PlaybackReplacements
+            SkIRect         fSrcRect;   // the part of fBM that holds the layer
+            const SkPaint*  fPaint;     // the layer's restore paint; not owned
+        };
+
+        // Replacements must be pushed in increasing fStart order.
+        ReplacementInfo* push();
+        int count() const { return fReplacements.count(); }
+
+        // Returns the replacement for the saveLayer at 'start', or NULL.
+        const ReplacementInfo* lookupByStart(size_t start) const;
+
+    private:
+        SkTDArray<ReplacementInfo> fReplacements;
+    };
 
 protected:
     explicit SkPicturePlayback(const SkPicture* picture, const SkPictInfo& info);
@@ -224,6 +258,8 @@ private:    // these help us with reading/writing
                         SkPicture::InstallPixelRefProc);
     bool parseBufferTag(SkPicture* picture, SkReadBuffer&, uint32_t tag, uint32_t size);
     void flattenToBuffer(SkWriteBuffer&) const;
+    void serializeSections(SkPictureIndexWriter*, SkPicture::EncodeBitmap) const;
+    bool parseIndex(SkPicture* picture, const SkPictureIndex&, SkPicture::InstallPixelRefProc);
 
 private:
     friend class SkPicture;
@@ -242,6 +278,10 @@ private:
 
     SkData* fOpData;    // opcodes and parameters
 
+    // While the flattened objects are parsed from a memory backed stream,
+    // the SkData that references them in place. Otherwise NULL.
+    SkData* fInPlaceBufferData;
+
     SkPicture** fPictureRefs;
     int fPictureCount;
 
@@ -269,13 +309,37 @@ private:
         typedef SkPicture::OperationList INHERITED;
     };
 
+    // Only used by getActiveOps(). draw() does its own search on the stack so
+    // that it doesn't touch any shared state.
     CachedOperationList* fCachedActiveOps;
 
     SkTypefacePlayback fTFPlayback;
     SkFactoryPlayback* fFactoryPlayback;
 
-    // The offset of the current operation when within the draw method
-    size_t fCurOffset;
+    // Everything above is immutable once the playback is built, so one
+    // playback may be drawn from any number of threads at once. The little
+    // state a draw needs lives in a DrawState on the drawing thread's stack;
+    // each thread keeps a list of its active DrawStates for curOpID().
+    struct DrawState {
+        const SkPicturePlayback* fPlayback;
+        size_t fCurOffset;  // The offset of the current operation
+        DrawState* fPrev;   // The draw this one is nested in, if any
+    };
+    friend class SkAutoDrawState;
+
+
+    // How an SkAutoPlaybackOverride changes the calling thread's draws of
+    // fPicture. Kept in a per-thread list, like the DrawStates.
+    struct Override {
+        const SkPicture* fPicture;
+        size_t fStart;              // Both 0 unless only part of the picture is drawn
+        size_t fStop;
+        SkMatrix fInitialMatrix;    // Only used if fStop != 0
+        const PlaybackReplacements* fReplacements;
+        Override* fPrev;
+    };
+    static const Override* FindOverride(const SkPicture*);
+    friend class SkAutoPlaybackOverride;
 
     const SkPictInfo fInfo;
 
@@ -288,4 +352,37 @@ private:
 #endif
 };
 
+/**
+ *  Changes how the calling thread draws 'picture' for as long as this lives,
+ *  so that a device can draw pieces of a picture itself (e.g. SkGpuDevice's
+ *  hoisting of saveLayers into cached textures). Draws with an override always
+ *  play back sequentially, ignoring any bounding box hierarchy.
+ */
+class SkAutoPlaybackOverride : SkNoncopyable {
+public:
+    /**
+     *  Only the ops strictly between the ones at offsets 'start' and 'stop' are
+     *  drawn, with setMatrix() ops relative to 'initialMatrix' rather than the
+     *  canvas' matrix at the start of the draw.
+     */
+    SkAutoPlaybackOverride(const SkPicture* picture, size_t start, size_t stop,
+                           const SkMatrix& initialMatrix);
+
+    /** Each of 'replacements' is drawn in place of its saveLayer/restore block. */
+    SkAutoPlaybackOverride(const SkPicture* picture,
+                           const SkPicturePlayback::PlaybackReplacements* replacements);
+
+    ~SkAutoPlaybackOverride();
+
+    // Also the key for the thread's list in SkTLS.
+    static void* NewList();
+    static void DeleteList(void* list);
+
+private:
+    void push();
+
+    SkPicturePlayback::Override** fList;
+    SkPicturePlayback::Override fOverride;
+};
+
 #endif
@@ -232,7 +232,7 @@ bool SkPictureRecord::isDrawingToLayer() const {
  * Read the op code from 'offset' in 'writer'.
  */
 #ifdef SK_DEBUG
-static DrawType peek_op(SkWriter32* writer, size_t offset) {
+static DrawType peek_op(SkSegmentedWriter32* writer, size_t offset) {
     return (DrawType)(writer->readTAt<uint32_t>(offset) >> 24);
 }
 #endif
@@ -240,7 +240,7 @@ static DrawType peek_op(SkWriter32* writer, size_t offset) {
 /*
  * Read the op code from 'offset' in 'writer' and extract the size too.
  */
-static DrawType peek_op_and_size(SkWriter32* writer, size_t offset, uint32_t* size) {
+static DrawType peek_op_and_size(SkSegmentedWriter32* writer, size_t offset, uint32_t* size) {
     uint32_t peek = writer->readTAt<uint32_t>(offset);
 
     uint32_t op;
@@ -284,7 +284,7 @@ struct CommandInfo {
  * array (i.e., actual ops, offsets and sizes).
  * Note this method skips any NOOPs seen in the stream
  */
-static bool match(SkWriter32* writer, uint32_t offset,
+static bool match(SkSegmentedWriter32* writer, uint32_t offset,
                   int* pattern, CommandInfo* result, int numCommands) {
     SkASSERT(offset < writer->bytesWritten());
 
@@ -332,7 +332,7 @@ static bool match(SkWriter32* writer, uint32_t offset,
 }
 
 // temporarily here to make code review easier
-static bool merge_savelayer_paint_into_drawbitmp(SkWriter32* writer,
+static bool merge_savelayer_paint_into_drawbitmp(SkSegmentedWriter32* writer,
                                                  SkPaintDictionary* paintDict,
                                                  const CommandInfo& saveLayerInfo,
                                                  const CommandInfo& dbmInfo);
@@ -345,7 +345,7 @@ static bool merge_savelayer_paint_into_drawbitmp(SkWriter32* writer,
  *   RESTORE
  * where the saveLayer's color can be moved into the drawBitmap*'s paint
  */
-static bool remove_save_layer1(SkWriter32* writer, int32_t offset,
+static bool remove_save_layer1(SkSegmentedWriter32* writer, int32_t offset,
                                SkPaintDictionary* paintDict) {
     // back up to the save block
     // TODO: add a stack to track save*/restore offsets rather than searching backwards
@@ -373,7 +373,7 @@ static bool remove_save_layer1(SkWriter32* writer, int32_t offset,
  * Convert the command code located at 'offset' to a NOOP. Leave the size
  * field alone so the NOOP can be skipped later.
  */
-static void convert_command_to_noop(SkWriter32* writer, uint32_t offset) {
+static void convert_command_to_noop(SkSegmentedWriter32* writer, uint32_t offset) {
     uint32_t command = writer->readTAt<uint32_t>(offset);
     writer->overwriteTAt(offset, (command & MASK_24) | (NOOP << 24));
 }
@@ -382,7 +382,7 @@ static void convert_command_to_noop(SkWriter32* writer, uint32_t offset) {
  * Attempt to merge the saveLayer's paint into the drawBitmap*'s paint.
  * Return true on success; false otherwise.
  */
-static bool merge_savelayer_paint_into_drawbitmp(SkWriter32* writer,
+static bool merge_savelayer_paint_into_drawbitmp(SkSegmentedWriter32* writer,
                                                  SkPaintDictionary* paintDict,
                                                  const CommandInfo& saveLayerInfo,
                                                  const CommandInfo& dbmInfo) {
@@ -458,7 +458,7 @@ static bool merge_savelayer_paint_into_drawbitmp(SkWriter32* writer,
  *   RESTORE
  * where the saveLayer's color can be moved into the drawBitmap*'s paint
  */
-static bool remove_save_layer2(SkWriter32* writer, int32_t offset,
+static bool remove_save_layer2(SkSegmentedWriter32* writer, int32_t offset,
                                SkPaintDictionary* paintDict) {
 
     // back up to the save block
@@ -495,7 +495,7 @@ static bool is_drawing_op(DrawType op) {
  *  If so, update the writer and return true, in which case we won't even record
  *  the restore() call. If we still need the restore(), return false.
  */
-static bool collapse_save_clip_restore(SkWriter32* writer, int32_t offset,
+static bool collapse_save_clip_restore(SkSegmentedWriter32* writer, int32_t offset,
                                        SkPaintDictionary* paintDict) {
 #ifdef TRACK_COLLAPSE_STATS
     gCollapseCalls += 1;
@@ -552,7 +552,7 @@ static bool collapse_save_clip_restore(SkWriter32* writer, int32_t offset,
     return true;
 }
 
-typedef bool (*PictureRecordOptProc)(SkWriter32* writer, int32_t offset,
+typedef bool (*PictureRecordOptProc)(SkSegmentedWriter32* writer, int32_t offset,
                                      SkPaintDictionary* paintDict);
 enum PictureRecordOptType {
     kRewind_OptType,  // Optimization rewinds the command stream
@@ -16,8 +16,8 @@
 #include "SkPathHeap.h"
 #include "SkPicture.h"
 #include "SkPictureFlat.h"
+#include "SkSegmentedWriter32.h"
 #include "SkTemplates.h"
-#include "SkWriter32.h"
 
 class SkBBoxHierarchy;
 class SkPictureStateTree;
@@ -78,7 +78,7 @@ public:
         fRecordFlags = recordFlags;
     }
 
-    const SkWriter32& writeStream() const {
+    const SkSegmentedWriter32& writeStream() const {
         return fWriter;
     }
 
@@ -289,7 +289,7 @@ private:
 
     SkPaintDictionary fPaints;
 
-    SkWriter32 fWriter;
+    SkSegmentedWriter32 fWriter;
 
     // we ref each item in these arrays
     SkTDArray<SkPicture*> fPictureRefs;
@@ -13,6 +13,7 @@
 #include "SkMatrixUtils.h"
 #include "SkPicture.h"
 #include "SkReadBuffer.h"
+#include "SkScaledImageCache.h"
 
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -88,15 +89,33 @@ SkShader* SkPictureShader::refBitmapShader(const SkMatrix& matrix, const SkMatri
     // TODO(fmalita): remove fCachedLocalMatrix from this key after getLocalMatrix is removed.
     if (!fCachedBitmapShader || tileScale != fCachedTileScale ||
         this->getLocalMatrix() != fCachedLocalMatrix) {
+        // The tile only depends on the picture and the scale, so shaders drawing the same picture
+        // share it through the scaled image cache rather than each rasterizing their own. Sharing
+        // the pixel ref also gives them one GPU texture, as those are cached by generation ID.
+        const SkIRect tileBounds = SkIRect::MakeWH(tileSize.width(), tileSize.height());
         SkBitmap bm;
-        if (!bm.allocN32Pixels(tileSize.width(), tileSize.height())) {
-            return NULL;
+        SkScaledImageCache::ID* id = SkScaledImageCache::FindAndLockPicture(fPicture->uniqueID(),
+                                                                            tileScale, tileBounds,
+                                                                            &bm);
+        if (NULL == id) {
+            // Heap pixels, so the tile stays valid for as long as a shader refs it even if the
+            // cache is backed by discardable memory and purges its copy.
+            if (!bm.allocN32Pixels(tileSize.width(), tileSize.height())) {
+                return NULL;
+            }
+            bm.eraseColor(SK_ColorTRANSPARENT);
+
+            SkCanvas canvas(bm);
+            canvas.scale(tileScale.width(), tileScale.height());
+            canvas.drawPicture(*fPicture);
+            bm.setImmutable();
+
+            id = SkScaledImageCache::AddAndLockPicture(fPicture->uniqueID(), tileScale,
+                                                       tileBounds, bm);
+        }
+        if (NULL != id) {
+            SkScaledImageCache::Unlock(id);
         }
-        bm.eraseColor(SK_ColorTRANSPARENT);
-
-        SkCanvas canvas(bm);
-        canvas.scale(tileScale.width(), tileScale.height());
-        canvas.drawPicture(*fPicture);
 
         fCachedTileScale = tileScale;
         fCachedLocalMatrix = this->getLocalMatrix();
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPixelRefLockCache.h"
+
+#include "SkBitmap.h"
+#include "SkPaint.h"
+#include "SkPixelRef.h"
+#include "SkShader.h"
+
+SkPixelRefLockCache::~SkPixelRefLockCache() {
+    for (int i = 0; i < fLocked.count(); ++i) {
+        fLocked[i]->unlockPixels();
+        fLocked[i]->unref();
+    }
+}
+
+void SkPixelRefLockCache::lock(const SkBitmap& bitmap) {
+    SkPixelRef* pr = bitmap.pixelRef();
+    if (NULL == pr || pr == fLast) {
+        return;
+    }
+    if (fLocked.find(pr) >= 0) {
+        fLast = pr;
+        return;
+    }
+    if (fLocked.count() >= kMaxLockedPixelRefs) {
+        return;
+    }
+    // A failed lock still counts, and has to be balanced.
+    if (!pr->lockPixels()) {
+        pr->unlockPixels();
+        return;
+    }
+    pr->ref();
+    *fLocked.append() = pr;
+    fLast = pr;
+}
+
+void SkPixelRefLockCache::lock(const SkPaint* paint) {
+    if (NULL == paint || NULL == paint->getShader()) {
+        return;
+    }
+    SkBitmap bitmap;
+    if (SkShader::kDefault_BitmapType == paint->getShader()->asABitmap(&bitmap, NULL, NULL)) {
+        this->lock(bitmap);
+    }
+}
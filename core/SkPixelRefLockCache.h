@@ -0,0 +1,48 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPixelRefLockCache_DEFINED
+#define SkPixelRefLockCache_DEFINED
+
+#include "SkTDArray.h"
+
+class SkBitmap;
+class SkPaint;
+class SkPixelRef;
+
+/**
+ *  Holds a lock on the pixel refs of the bitmaps drawn during a playback, and
+ *  unlocks them together when it goes away. While the cache holds a lock, the
+ *  lockPixels()/unlockPixels() calls the draws themselves make only bump the
+ *  pixel ref's lock count, rather than relocking its discardable memory or
+ *  going through SkImageRef's pool each time the same bitmap is drawn.
+ *
+ *  The pixels stay resident until the cache is destroyed, so it holds at most
+ *  kMaxLockedPixelRefs locks; bitmaps drawn after that are locked by their
+ *  draws as usual.
+ */
+class SkPixelRefLockCache : SkNoncopyable {
+public:
+    SkPixelRefLockCache() : fLast(NULL) {}
+    ~SkPixelRefLockCache();
+
+    /** Keeps the bitmap's pixel ref locked until the cache goes away. */
+    void lock(const SkBitmap&);
+
+    /** Same for the bitmap behind the paint's shader, if it has one. */
+    void lock(const SkPaint*);
+
+    enum {
+        kMaxLockedPixelRefs = 32
+    };
+
+private:
+    SkTDArray<SkPixelRef*>  fLocked;    // each is reffed and locked
+    SkPixelRef*             fLast;      // sprite sheets draw the same bitmap over and over
+};
+
+#endif
@@ -6,16 +6,20 @@
  */
 
 #include "SkQuadTree.h"
-#include "SkTSort.h"
-#include <stdio.h>
 
 static const int kSplitThreshold = 8;
+// Entries that all fall into the same quadrant however small it gets (e.g. many copies of one
+// rect) would otherwise split forever.
+static const int kMaxDepth = 24;
+// A search pops one node and pushes at most four children, so this never overflows.
+static const int kMaxSearchStack = 3 * kMaxDepth + 1;
 
 enum {
     kTopLeft,
     kTopRight,
     kBottomLeft,
     kBottomRight,
+    kStraddle,  // Stays in the node itself.
 };
 enum {
     kTopLeft_Bit = 1 << kTopLeft,
@@ -46,8 +50,25 @@ static U8CPU child_intersect(const SkIRect& query, const SkIPoint& split) {
     return intersect;
 }
 
+static int child_index(const SkIRect& bounds, const SkIPoint& split) {
+    switch(child_intersect(bounds, split)) {
+        case kTopLeft_Bit:
+            return kTopLeft;
+        case kTopRight_Bit:
+            return kTopRight;
+        case kBottomLeft_Bit:
+            return kBottomLeft;
+        case kBottomRight_Bit:
+            return kBottomRight;
+        default:
+            return kStraddle;
+    }
+}
+
 SkQuadTree::SkQuadTree(const SkIRect& bounds)
-    : fRoot(NULL) {
+    : fDepth(1)
+    , fFlushed(false)
+    , fNeedsBuild(false) {
     SkASSERT((bounds.width() * bounds.height()) > 0);
     fRootBounds = bounds;
 }
@@ -55,103 +76,97 @@ SkQuadTree::SkQuadTree(const SkIRect& bounds)
 SkQuadTree::~SkQuadTree() {
 }
 
-void SkQuadTree::insert(Node* node, Entry* entry) {
-    // does it belong in a child?
-    if (NULL != node->fChildren[0]) {
-        switch(child_intersect(entry->fBounds, node->fSplitPoint)) {
-            case kTopLeft_Bit:
-                this->insert(node->fChildren[kTopLeft], entry);
-                return;
-            case kTopRight_Bit:
-                this->insert(node->fChildren[kTopRight], entry);
-                return;
-            case kBottomLeft_Bit:
-                this->insert(node->fChildren[kBottomLeft], entry);
-                return;
-            case kBottomRight_Bit:
-                this->insert(node->fChildren[kBottomRight], entry);
-                return;
-            default:
-                node->fEntries.push(entry);
-                return;
-        }
-    }
-    // No children yet, add to this node
-    node->fEntries.push(entry);
-    // should I split?
-    if (node->fEntries.getCount() > kSplitThreshold) {
-        this->split(node);
-    }
-}
-
-void SkQuadTree::split(Node* node) {
-    // Build all the children
-    node->fSplitPoint = SkIPoint::Make(node->fBounds.centerX(),
-                                       node->fBounds.centerY());
-    for(int index=0; index<kChildCount; ++index) {
-        node->fChildren[index] = fNodePool.acquire();
-    }
-    node->fChildren[0]->fBounds = SkIRect::MakeLTRB(
-        node->fBounds.fLeft,    node->fBounds.fTop,
-        node->fSplitPoint.fX,   node->fSplitPoint.fY);
-    node->fChildren[1]->fBounds = SkIRect::MakeLTRB(
-        node->fSplitPoint.fX,   node->fBounds.fTop,
-        node->fBounds.fRight,   node->fSplitPoint.fY);
-    node->fChildren[2]->fBounds = SkIRect::MakeLTRB(
-        node->fBounds.fLeft,    node->fSplitPoint.fY,
-        node->fSplitPoint.fX,   node->fBounds.fBottom);
-    node->fChildren[3]->fBounds = SkIRect::MakeLTRB(
-        node->fSplitPoint.fX,   node->fSplitPoint.fY,
-        node->fBounds.fRight,   node->fBounds.fBottom);
-    // reinsert all the entries of this node to allow child trickle
-    SkTInternalSList<Entry> entries;
-    entries.pushAll(&node->fEntries);
-    while(!entries.isEmpty()) {
-        this->insert(node, entries.pop());
-    }
-}
-
-void SkQuadTree::search(Node* node, const SkIRect& query,
-                        SkTDArray<void*>* results) const {
-    for (Entry* entry = node->fEntries.head(); NULL != entry;
-        entry = entry->getSListNext()) {
-        if (SkIRect::IntersectsNoEmptyCheck(entry->fBounds, query)) {
-            results->push(entry->fData);
-        }
-    }
-    if (NULL == node->fChildren[0]) {
-        return;
-    }
-    U8CPU intersect = child_intersect(query, node->fSplitPoint);
-    for(int index=0; index<kChildCount; ++index) {
-        if (intersect & (1 << index)) {
-            this->search(node->fChildren[index], query, results);
-        }
-    }
-}
-
-void SkQuadTree::clear(Node* node) {
-    // first clear the entries of this node
-    fEntryPool.releaseAll(&node->fEntries);
-    // recurse into and clear all child nodes
-    for(int index=0; index<kChildCount; ++index) {
-        Node* child = node->fChildren[index];
-        node->fChildren[index] = NULL;
-        if (NULL != child) {
-            this->clear(child);
-            fNodePool.release(child);
+void SkQuadTree::build() {
+    fNodes.rewind();
+    fNeedsBuild = false;
+
+    Node* root = fNodes.append();
+    root->fBounds = fRootBounds;
+    root->fFirstChild = -1;
+    root->fEntryStart = 0;
+    root->fEntryCount = fEntries.count();
+
+    // The nodes are built a level at a time, so the summed entry counts of a level never exceed
+    // the number of entries, and the children of each node are appended next to each other.
+    // Splitting a node sorts its range of fEntries by child: its own entries first, then those
+    // of each child in turn.
+    SkTDArray<Entry> scratch;
+    SkTDArray<uint8_t> childOf;
+    scratch.setCount(fEntries.count());
+    childOf.setCount(fEntries.count());
+
+    int levelStart = 0;
+    int depth = 1;
+    for (;;) {
+        const int levelEnd = fNodes.count();
+        if (depth < kMaxDepth) {
+            for (int nodeIndex = levelStart; nodeIndex < levelEnd; ++nodeIndex) {
+                // fNodes may move as children are appended, so don't hold on to a Node&.
+                Node node = fNodes[nodeIndex];
+                if (node.fEntryCount <= kSplitThreshold) {
+                    continue;
+                }
+                const SkIPoint split = SkIPoint::Make(node.fBounds.centerX(),
+                                                      node.fBounds.centerY());
+                const int start = node.fEntryStart;
+                const int end = start + node.fEntryCount;
+
+                int counts[kStraddle + 1] = { 0, 0, 0, 0, 0 };
+                for (int i = start; i < end; ++i) {
+                    int child = child_index(fEntries[i].fBounds, split);
+                    childOf[i] = SkToU8(child);
+                    counts[child]++;
+                }
+                if (counts[kStraddle] == node.fEntryCount) {
+                    continue;  // Splitting wouldn't move anything down.
+                }
+
+                int offsets[kStraddle + 1];
+                offsets[kStraddle] = start;
+                offsets[kTopLeft] = start + counts[kStraddle];
+                for (int child = kTopLeft + 1; child < kChildCount; ++child) {
+                    offsets[child] = offsets[child - 1] + counts[child - 1];
+                }
+
+                const int firstChild = fNodes.count();
+                Node* children = fNodes.append(kChildCount);
+                children[kTopLeft].fBounds = SkIRect::MakeLTRB(
+                    node.fBounds.fLeft,     node.fBounds.fTop,
+                    split.fX,               split.fY);
+                children[kTopRight].fBounds = SkIRect::MakeLTRB(
+                    split.fX,               node.fBounds.fTop,
+                    node.fBounds.fRight,    split.fY);
+                children[kBottomLeft].fBounds = SkIRect::MakeLTRB(
+                    node.fBounds.fLeft,     split.fY,
+                    split.fX,               node.fBounds.fBottom);
+                children[kBottomRight].fBounds = SkIRect::MakeLTRB(
+                    split.fX,               split.fY,
+                    node.fBounds.fRight,    node.fBounds.fBottom);
+                for (int child = 0; child < kChildCount; ++child) {
+                    children[child].fFirstChild = -1;
+                    children[child].fEntryStart = offsets[child];
+                    children[child].fEntryCount = counts[child];
+                }
+
+                for (int i = start; i < end; ++i) {
+                    scratch[offsets[childOf[i]]++] = fEntries[i];
+                }
+                memcpy(fEntries.begin() + start, scratch.begin() + start,
+                       node.fEntryCount * sizeof(Entry));
+
+                Node& parent = fNodes[nodeIndex];
+                parent.fSplitPoint = split;
+                parent.fFirstChild = firstChild;
+                parent.fEntryCount = counts[kStraddle];
+            }
         }
-    }
-}
-
-int SkQuadTree::getDepth(Node* node) const {
-    int maxDepth = 0;
-    if (NULL != node) {
-        for(int index=0; index<kChildCount; ++index) {
-            maxDepth = SkMax32(maxDepth, getDepth(node->fChildren[index]));
+        if (fNodes.count() == levelEnd) {
+            break;
         }
+        levelStart = levelEnd;
+        ++depth;
     }
-    return maxDepth + 1;
+    fDepth = depth;
 }
 
 void SkQuadTree::insert(void* data, const SkIRect& bounds, bool) {
@@ -159,59 +174,79 @@ void SkQuadTree::insert(void* data, const SkIRect& bounds, bool) {
         SkASSERT(false);
         return;
     }
-    Entry* entry = fEntryPool.acquire();
+    Entry* entry = fEntries.append();
     entry->fData = data;
     entry->fBounds = bounds;
-    if (NULL == fRoot) {
-        fDeferred.push(entry);
-    } else {
-        this->insert(fRoot, entry);
-    }
+    // Inserts are all deferred: the tree is built from every entry at once when it's next needed.
+    fNeedsBuild = true;
 }
 
 void SkQuadTree::search(const SkIRect& query, SkTDArray<void*>* results) {
-    SkASSERT(NULL != fRoot);
+    SkASSERT(fFlushed);
     SkASSERT(NULL != results);
-    if (SkIRect::Intersects(fRootBounds, query)) {
-        this->search(fRoot, query, results);
+    if (fNeedsBuild) {
+        this->build();
+    }
+    if (fNodes.isEmpty() || !SkIRect::Intersects(fRootBounds, query)) {
+        return;
+    }
+
+    const Node* nodes = fNodes.begin();
+    const Entry* entries = fEntries.begin();
+    int stack[kMaxSearchStack];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        const Entry* entry = entries + node.fEntryStart;
+        const Entry* stop = entry + node.fEntryCount;
+        for (; entry < stop; ++entry) {
+            if (SkIRect::IntersectsNoEmptyCheck(entry->fBounds, query)) {
+                *results->append() = entry->fData;
+            }
+        }
+        if (node.fFirstChild < 0) {
+            continue;
+        }
+        U8CPU intersect = child_intersect(query, node.fSplitPoint);
+        for (int index = kChildCount - 1; index >= 0; --index) {
+            if (intersect & (1 << index)) {
+                SkASSERT(top < kMaxSearchStack);
+                stack[top++] = node.fFirstChild + index;
+            }
+        }
     }
 }
 
 void SkQuadTree::clear() {
-    if (NULL != fRoot) {
-        this->clear(fRoot);
-        fNodePool.release(fRoot);
-        fRoot = NULL;
-    }
+    fEntries.rewind();
+    fNodes.rewind();
+    fDepth = 1;
+    fFlushed = false;
+    fNeedsBuild = false;
 }
 
 int SkQuadTree::getDepth() const {
-    return this->getDepth(fRoot);
+    return fDepth;
 }
 
 void SkQuadTree::rewindInserts() {
     SkASSERT(fClient);
-     // Currently only supports deferred inserts
-    SkASSERT(NULL == fRoot);
-    SkTInternalSList<Entry> entries;
-    entries.pushAll(&fDeferred);
-    while(!entries.isEmpty()) {
-        Entry* entry = entries.pop();
-        if (fClient->shouldRewind(entry->fData)) {
-            entry->fData = NULL;
-            fEntryPool.release(entry);
-        } else {
-            fDeferred.push(entry);
+    int count = 0;
+    for (int i = 0; i < fEntries.count(); ++i) {
+        if (!fClient->shouldRewind(fEntries[i].fData)) {
+            fEntries[count++] = fEntries[i];
         }
     }
+    if (count != fEntries.count()) {
+        fEntries.setCount(count);
+        fNeedsBuild = true;
+    }
 }
 
 void SkQuadTree::flushDeferredInserts() {
-    if (NULL == fRoot) {
-        fRoot = fNodePool.acquire();
-        fRoot->fBounds = fRootBounds;
-    }
-    while(!fDeferred.isEmpty()) {
-        this->insert(fRoot, fDeferred.pop());
+    fFlushed = true;
+    if (fNeedsBuild || fNodes.isEmpty()) {
+        this->build();
     }
 }
@@ -11,13 +11,17 @@
 #include "SkRect.h"
 #include "SkTDArray.h"
 #include "SkBBoxHierarchy.h"
-#include "SkTInternalSList.h"
-#include "SkTObjectPool.h"
 
 /**
  * A QuadTree implementation. In short, it is a tree containing a hierarchy of bounding rectangles
  * in which each internal node has exactly four children.
  *
+ * The tree is built in one pass over all the entries when it is first needed, rather than one
+ * insert at a time, and is stored flat: its nodes in one array, with the children of a node next
+ * to each other, and the entries in another, ordered by node. Searches walk it with a fixed
+ * stack instead of recursing. Entries inserted after the tree is built just mark it to be built
+ * again before the next search.
+ *
  * For more details see:
  *
  * http://en.wikipedia.org/wiki/Quadtree
@@ -52,7 +56,8 @@ public:
     virtual void flushDeferredInserts() SK_OVERRIDE;
 
     /**
-     * Given a query rectangle, populates the passed-in array with the elements it intersects
+     * Given a query rectangle, appends the elements it intersects to the passed-in array, which
+     * the caller can reuse from query to query to avoid reallocating it.
      */
     virtual void search(const SkIRect& query, SkTDArray<void*>* results) SK_OVERRIDE;
 
@@ -67,45 +72,35 @@ public:
      * This gets the insertion count (rather than the node count)
      */
     virtual int getCount() const SK_OVERRIDE {
-        return fEntryPool.allocated() - fEntryPool.available();
+        return fEntries.count();
     }
 
     virtual void rewindInserts() SK_OVERRIDE;
 
 private:
     struct Entry {
-        Entry() : fData(NULL) {}
         SkIRect fBounds;
         void* fData;
-        SK_DECLARE_INTERNAL_SLIST_INTERFACE(Entry);
     };
 
     static const int kChildCount = 4;
 
     struct Node {
-        Node() {
-            for (int index=0; index<kChildCount; ++index) {
-                fChildren[index] = NULL;
-            }
-        }
-        SkTInternalSList<Entry> fEntries;
         SkIRect fBounds;
         SkIPoint fSplitPoint; // Only valid if the node has children.
-        Node* fChildren[kChildCount];
-        SK_DECLARE_INTERNAL_SLIST_ADAPTER(Node, fChildren[0]);
+        int fFirstChild;      // The four children are fNodes[fFirstChild..+4), or -1 for a leaf.
+        int fEntryStart;      // The entries held by this node itself, not those of its children.
+        int fEntryCount;
     };
 
-    SkTObjectPool<Entry> fEntryPool;
-    SkTObjectPool<Node> fNodePool;
-    Node* fRoot;
+    SkTDArray<Entry> fEntries;
+    SkTDArray<Node> fNodes;
     SkIRect fRootBounds;
-    SkTInternalSList<Entry> fDeferred;
+    int fDepth;
+    bool fFlushed;    // flushDeferredInserts() has been called since the last clear().
+    bool fNeedsBuild; // fEntries has changed since fNodes was built.
 
-    void insert(Node* node, Entry* entry);
-    void split(Node* node);
-    void search(Node* node, const SkIRect& query, SkTDArray<void*>* results) const;
-    void clear(Node* node);
-    int getDepth(Node* node) const;
+    void build();
 
     typedef SkBBoxHierarchy INHERITED;
 };
@@ -33,7 +33,9 @@ SkRTree::SkRTree(int minChildren, int maxChildren, SkScalar aspectRatio,
     , fCount(0)
     , fNodes(fNodeSize * 256)
     , fAspectRatio(aspectRatio)
-    , fSortWhenBulkLoading(sortWhenBulkLoading) {
+    , fSortWhenBulkLoading(sortWhenBulkLoading)
+    , fBulkNodes(NULL)
+    , fBulkNodesLeft(0) {
     SkASSERT(minChildren < maxChildren && minChildren > 0 && maxChildren <
              static_cast<int>(SK_MaxU16));
     SkASSERT((maxChildren + 1) / 2 >= minChildren);
@@ -92,7 +94,9 @@ void SkRTree::flushDeferredInserts() {
             this->insert(fRoot.fChild.subtree, &fDeferredInserts[0]);
             fRoot.fBounds = fDeferredInserts[0].fBounds;
         } else {
+            this->reserveBulkNodes(fCount);
             fRoot = this->bulkLoad(&fDeferredInserts);
+            fBulkNodesLeft = 0;
         }
     } else {
         // TODO: some algorithm for bulk loading into an already populated tree
@@ -116,13 +120,33 @@ void SkRTree::search(const SkIRect& query, SkTDArray<void*>* results) {
 void SkRTree::clear() {
     this->validate();
     fNodes.reset();
+    fBulkNodes = NULL;
+    fBulkNodesLeft = 0;
     fDeferredInserts.rewind();
     fCount = 0;
     this->validate();
 }
 
+void SkRTree::reserveBulkNodes(int count) {
+    // Each level of bulkLoad() packs its branches into as few nodes as fMaxChildren allows.
+    int nodes = 0;
+    while (count > 1) {
+        count = (count + fMaxChildren - 1) / fMaxChildren;
+        nodes += count;
+    }
+    fBulkNodes = static_cast<char*>(fNodes.allocThrow(SkAlignPtr(fNodeSize) * nodes));
+    fBulkNodesLeft = nodes;
+}
+
 SkRTree::Node* SkRTree::allocateNode(uint16_t level) {
-    Node* out = static_cast<Node*>(fNodes.allocThrow(fNodeSize));
+    Node* out;
+    if (fBulkNodesLeft > 0) {
+        out = reinterpret_cast<Node*>(fBulkNodes);
+        fBulkNodes += SkAlignPtr(fNodeSize);
+        --fBulkNodesLeft;
+    } else {
+        out = static_cast<Node*>(fNodes.allocThrow(fNodeSize));
+    }
     out->fNumChildren = 0;
     out->fLevel = level;
     return out;
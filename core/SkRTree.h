@@ -137,17 +137,19 @@ private:
         const SkRTree::SortSide fSide;
     };
 
+    // STR packing sorts by the centers of the rects. Comparing left + right (or top + bottom) gives
+    // the same order as the centers, without rounding.
     struct RectLessX {
         bool operator()(const SkRTree::Branch lhs, const SkRTree::Branch rhs) {
-            return ((lhs.fBounds.fRight - lhs.fBounds.fLeft) >> 1) <
-                   ((rhs.fBounds.fRight - lhs.fBounds.fLeft) >> 1);
+            return (int64_t)lhs.fBounds.fLeft + lhs.fBounds.fRight <
+                   (int64_t)rhs.fBounds.fLeft + rhs.fBounds.fRight;
         }
     };
 
     struct RectLessY {
         bool operator()(const SkRTree::Branch lhs, const SkRTree::Branch rhs) {
-            return ((lhs.fBounds.fBottom - lhs.fBounds.fTop) >> 1) <
-                   ((rhs.fBounds.fBottom - lhs.fBounds.fTop) >> 1);
+            return (int64_t)lhs.fBounds.fTop + lhs.fBounds.fBottom <
+                   (int64_t)rhs.fBounds.fTop + rhs.fBounds.fBottom;
         }
     };
 
@@ -171,6 +173,10 @@ private:
      *
      * This consumes the input array.
      *
+     * All the nodes it creates are carved in order out of one contiguous block (see
+     * reserveBulkNodes()), so each level of the tree is a flat array, with every node's children
+     * adjacent to each other in memory.
+     *
      * TODO: Experiment with other bulk-load algorithms (in particular the Hilbert pack variant,
      * which groups rects by position on the Hilbert curve, is probably worth a look). There also
      * exist top-down bulk load variants (VAMSplit, TopDownGreedy, etc).
@@ -195,6 +201,15 @@ private:
 
     Node* allocateNode(uint16_t level);
 
+    /**
+     * Allocates one block big enough for all the nodes bulkLoad() will create from 'count'
+     * branches, for allocateNode() to hand out before it falls back to fNodes' usual chunks.
+     */
+    void reserveBulkNodes(int count);
+
+    char* fBulkNodes;
+    int fBulkNodesLeft;
+
     typedef SkBBoxHierarchy INHERITED;
 };
 
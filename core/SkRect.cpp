@@ -9,6 +9,10 @@
 
 #include "SkRect.h"
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#endif
+
 void SkIRect::join(int32_t left, int32_t top, int32_t right, int32_t bottom) {
     // do nothing if the params are empty
     if (left >= right || top >= bottom) {
@@ -55,6 +59,48 @@ void SkRect::toQuad(SkPoint quad[4]) const {
     quad[3].set(fLeft, fBottom);
 }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// Paths with many points spend most of their bounds time here, so look at two points (one
+// register) at a time. The lanes hold x, y, x, y: min and max run over both pairs and are folded
+// together at the end. As below, accum stays 0 unless a point is NaN or infinite.
+static bool sse2_bounds_check(const SkPoint pts[], int count, SkRect* bounds) {
+    SkASSERT(count > 0);
+
+    __m128 first = _mm_castpd_ps(_mm_load1_pd(reinterpret_cast<const double*>(pts)));
+    __m128 min = first;
+    __m128 max = first;
+    __m128 accum = _mm_mul_ps(_mm_setzero_ps(), first);
+
+    const float* src = &pts[0].fX;
+    int pairs = count >> 1;
+    for (int i = 0; i < pairs; ++i) {
+        __m128 xy = _mm_loadu_ps(src);
+        accum = _mm_mul_ps(accum, xy);
+        min = _mm_min_ps(xy, min);
+        max = _mm_max_ps(xy, max);
+        src += 4;
+    }
+    if (count & 1) {
+        __m128 xy = _mm_castpd_ps(_mm_load1_pd(reinterpret_cast<const double*>(src)));
+        accum = _mm_mul_ps(accum, xy);
+        min = _mm_min_ps(xy, min);
+        max = _mm_max_ps(xy, max);
+    }
+
+    if (_mm_movemask_ps(_mm_cmpneq_ps(accum, _mm_setzero_ps()))) {
+        bounds->setEmpty();
+        return false;
+    }
+
+    min = _mm_min_ps(min, _mm_movehl_ps(min, min));
+    max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+    float ltrb[4];
+    _mm_storeu_ps(ltrb, _mm_movelh_ps(min, max));
+    bounds->set(ltrb[0], ltrb[1], ltrb[2], ltrb[3]);
+    return true;
+}
+#endif
+
 bool SkRect::setBoundsCheck(const SkPoint pts[], int count) {
     SkASSERT((pts && count > 0) || count == 0);
 
@@ -63,6 +109,9 @@ bool SkRect::setBoundsCheck(const SkPoint pts[], int count) {
     if (count <= 0) {
         sk_bzero(this, sizeof(SkRect));
     } else {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        isFinite = sse2_bounds_check(pts, count, this);
+#else
         SkScalar    l, t, r, b;
 
         l = r = pts[0].fX;
@@ -94,6 +143,7 @@ bool SkRect::setBoundsCheck(const SkPoint pts[], int count) {
             isFinite = false;
         }
         this->set(l, t, r, b);
+#endif
     }
 
     return isFinite;
@@ -8,6 +8,8 @@
 
 
 #include "SkRegionPriv.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
 #include "SkTemplates.h"
 #include "SkThread.h"
 #include "SkUtils.h"
@@ -591,16 +593,136 @@ void SkRegion::translate(int dx, int dy, SkRegion* dst) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+struct RectTopLessThan {
+    bool operator()(const SkIRect& a, const SkIRect& b) const {
+        return a.fTop < b.fTop;
+    }
+};
+
+struct Interval {
+    SkRegion::RunType fLeft;
+    SkRegion::RunType fRite;
+};
+
+struct IntervalLeftLessThan {
+    bool operator()(const Interval& a, const Interval& b) const {
+        return a.fLeft < b.fLeft;
+    }
+};
+
+}  // namespace
+
+// Merges the sorted intervals in place, joining the ones that overlap or touch, and returns
+// how many are left.
+static int merge_intervals(Interval intervals[], int count) {
+    int merged = 0;
+    for (int i = 0; i < count; ++i) {
+        if (merged > 0 && intervals[i].fLeft <= intervals[merged - 1].fRite) {
+            intervals[merged - 1].fRite = SkMax32(intervals[merged - 1].fRite,
+                                                  intervals[i].fRite);
+        } else {
+            intervals[merged++] = intervals[i];
+        }
+    }
+    return merged;
+}
+
+static bool span_matches(const SkRegion::RunType span[], const Interval intervals[], int count) {
+    if (span[1] != count) {
+        return false;
+    }
+    const SkRegion::RunType* runs = span + 2;
+    for (int i = 0; i < count; ++i) {
+        if (runs[0] != intervals[i].fLeft || runs[1] != intervals[i].fRite) {
+            return false;
+        }
+        runs += 2;
+    }
+    return true;
+}
+
+/*  Rather than one op() per rect, which rebuilds the whole region each time and so is
+    quadratic in the number of rects, sweep down the rects' y edges once. Between two edges the
+    rects crossing the band make up its intervals, and a band with the same intervals as the
+    one above just extends that one's bottom, so the runs come out in canonical form.
+ */
 bool SkRegion::setRects(const SkIRect rects[], int count) {
-    if (0 == count) {
-        this->setEmpty();
-    } else {
-        this->setRect(rects[0]);
-        for (int i = 1; i < count; i++) {
-            this->op(rects[i], kUnion_Op);
+    SkTDArray<SkIRect> sorted;
+    SkTDArray<RunType> ys;
+    sorted.setReserve(count);
+    ys.setReserve(2 * count);
+    for (int i = 0; i < count; ++i) {
+        if (!rects[i].isEmpty()) {
+            *sorted.append() = rects[i];
+            *ys.append() = rects[i].fTop;
+            *ys.append() = rects[i].fBottom;
+        }
+    }
+    if (sorted.isEmpty()) {
+        return this->setEmpty();
+    }
+    if (1 == sorted.count()) {
+        return this->setRect(sorted[0]);
+    }
+
+    SkTQSort(sorted.begin(), sorted.end() - 1, RectTopLessThan());
+    SkTQSort(ys.begin(), ys.end() - 1);
+    int yCount = 1;
+    for (int i = 1; i < ys.count(); ++i) {
+        if (ys[i] != ys[yCount - 1]) {
+            ys[yCount++] = ys[i];
         }
     }
-    return !this->isEmpty();
+
+    SkTDArray<const SkIRect*> active;
+    SkTDArray<Interval> intervals;
+    SkTDArray<RunType> runs;
+    *runs.append() = ys[0];     // top
+    int prevSpan = -1;          // index of the previous span's bottom in runs
+    int nextRect = 0;
+
+    for (int i = 0; i + 1 < yCount; ++i) {
+        const RunType top = ys[i];
+        const RunType bot = ys[i + 1];
+
+        for (int j = active.count() - 1; j >= 0; --j) {
+            if (active[j]->fBottom <= top) {
+                active.removeShuffle(j);
+            }
+        }
+        while (nextRect < sorted.count() && sorted[nextRect].fTop == top) {
+            *active.append() = &sorted[nextRect++];
+        }
+
+        intervals.setCount(active.count());
+        for (int j = 0; j < active.count(); ++j) {
+            intervals[j].fLeft = active[j]->fLeft;
+            intervals[j].fRite = active[j]->fRight;
+        }
+        if (intervals.count() > 1) {
+            SkTQSort(intervals.begin(), intervals.end() - 1, IntervalLeftLessThan());
+        }
+        const int merged = merge_intervals(intervals.begin(), intervals.count());
+
+        if (prevSpan >= 0 && span_matches(&runs[prevSpan], intervals.begin(), merged)) {
+            runs[prevSpan] = bot;
+            continue;
+        }
+        prevSpan = runs.count();
+        RunType* span = runs.append(3 + 2 * merged);
+        *span++ = bot;
+        *span++ = merged;
+        for (int j = 0; j < merged; ++j) {
+            *span++ = intervals[j].fLeft;
+            *span++ = intervals[j].fRite;
+        }
+        *span = kRunTypeSentinel;
+    }
+    *runs.append() = kRunTypeSentinel;
+
+    return this->setRuns(runs.begin(), runs.count());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,7 @@
 #include "SkOnce.h"
 #include "SkPixelRef.h"
 #include "SkRect.h"
+#include "SkStats.h"
 
 // This can be defined by the caller's build system
 //#define SK_USE_DISCARDABLE_SCALEDIMAGECACHE
@@ -57,21 +58,30 @@ static uint32_t compute_hash(const uint32_t data[], int count) {
 }
 
 struct SkScaledImageCache::Key {
+    // Pictures and pixel refs count their IDs separately, so the same ID can
+    // name one of each.
+    enum Domain {
+        kPixelRef_Domain,
+        kPicture_Domain
+    };
+
     Key(uint32_t genID,
         SkScalar scaleX,
         SkScalar scaleY,
-        SkIRect  bounds)
+        SkIRect  bounds,
+        Domain   domain = kPixelRef_Domain)
         : fGenID(genID)
+        , fDomain(domain)
         , fScaleX(scaleX)
         , fScaleY(scaleY)
         , fBounds(bounds) {
-        fHash = compute_hash(&fGenID, 7);
+        fHash = compute_hash(&fGenID, 8);
     }
 
     bool operator<(const Key& other) const {
         const uint32_t* a = &fGenID;
         const uint32_t* b = &other.fGenID;
-        for (int i = 0; i < 7; ++i) {
+        for (int i = 0; i < 8; ++i) {
             if (a[i] < b[i]) {
                 return true;
             }
@@ -85,7 +95,7 @@ struct SkScaledImageCache::Key {
     bool operator==(const Key& other) const {
         const uint32_t* a = &fHash;
         const uint32_t* b = &other.fHash;
-        for (int i = 0; i < 8; ++i) {
+        for (int i = 0; i < 9; ++i) {
             if (a[i] != b[i]) {
                 return false;
             }
@@ -95,6 +105,7 @@ struct SkScaledImageCache::Key {
 
     uint32_t    fHash;
     uint32_t    fGenID;
+    uint32_t    fDomain;
     float       fScaleX;
     float       fScaleY;
     SkIRect     fBounds;
@@ -168,6 +179,7 @@ void SkScaledImageCache::init() {
 #endif
     fBytesUsed = 0;
     fCount = 0;
+    fCountLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
     fAllocator = NULL;
 
     // One of these should be explicit set by the caller after we return.
@@ -336,8 +348,11 @@ SkScaledImageCache::Rec* SkScaledImageCache::findAndLock(const SkScaledImageCach
     Rec* rec = find_rec_in_list(fHead, key);
 #endif
     if (rec) {
+        SK_STATS_INC(kScaledImageCacheHit_Counter);
         this->moveToHead(rec);  // for our LRU
         rec->fLockCount += 1;
+    } else {
+        SK_STATS_INC(kScaledImageCacheMiss_Counter);
     }
     return rec;
 }
@@ -388,6 +403,20 @@ SkScaledImageCache::ID* SkScaledImageCache::findAndLock(const SkBitmap& orig,
     return rec_to_id(rec);
 }
 
+SkScaledImageCache::ID* SkScaledImageCache::findAndLockPicture(uint32_t pictureID,
+                                                               const SkSize& scale,
+                                                               const SkIRect& tile,
+                                                               SkBitmap* bitmap) {
+    const Key key(pictureID, scale.width(), scale.height(), tile, Key::kPicture_Domain);
+    Rec* rec = this->findAndLock(key);
+    if (rec) {
+        SkASSERT(NULL == rec->fMip);
+        SkASSERT(rec->fBitmap.pixelRef());
+        *bitmap = rec->fBitmap;
+    }
+    return rec_to_id(rec);
+}
+
 SkScaledImageCache::ID* SkScaledImageCache::findAndLockMip(const SkBitmap& orig,
                                                            SkMipMap const ** mip) {
     Rec* rec = this->findAndLock(orig.getGenerationID(), 0, 0,
@@ -454,6 +483,18 @@ SkScaledImageCache::ID* SkScaledImageCache::addAndLock(const SkBitmap& orig,
     return this->addAndLock(rec);
 }
 
+SkScaledImageCache::ID* SkScaledImageCache::addAndLockPicture(uint32_t pictureID,
+                                                              const SkSize& scale,
+                                                              const SkIRect& tile,
+                                                              const SkBitmap& bitmap) {
+    if (tile.isEmpty()) {
+        return NULL;
+    }
+    Key key(pictureID, scale.width(), scale.height(), tile, Key::kPicture_Domain);
+    Rec* rec = SkNEW_ARGS(Rec, (key, bitmap));
+    return this->addAndLock(rec);
+}
+
 SkScaledImageCache::ID* SkScaledImageCache::addAndLockMip(const SkBitmap& orig,
                                                           const SkMipMap* mip) {
     SkIRect bounds = get_bounds_from_bitmap(orig);
@@ -498,7 +539,7 @@ void SkScaledImageCache::purgeAsNeeded() {
     int    countLimit;
 
     if (fDiscardableFactory) {
-        countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+        countLimit = fCountLimit;
         byteLimit = SK_MaxU32;  // no limit based on bytes
     } else {
         countLimit = SK_MaxS32; // no limit based on count
@@ -544,6 +585,15 @@ size_t SkScaledImageCache::setByteLimit(size_t newLimit) {
     return prevLimit;
 }
 
+int SkScaledImageCache::setCountLimit(int newLimit) {
+    int prevLimit = fCountLimit;
+    fCountLimit = newLimit;
+    if (fDiscardableFactory && newLimit < prevLimit) {
+        this->purgeAsNeeded();
+    }
+    return prevLimit;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkScaledImageCache::detach(Rec* rec) {
@@ -667,35 +717,93 @@ void SkScaledImageCache::dump() const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#include "SkMemoryBudget.h"
 #include "SkThread.h"
 
-SK_DECLARE_STATIC_MUTEX(gMutex);
-static SkScaledImageCache* gScaledImageCache = NULL;
-static void cleanup_gScaledImageCache() { SkDELETE(gScaledImageCache); }
+#ifndef SK_SCALEDIMAGECACHE_SHARD_COUNT
+#   define SK_SCALEDIMAGECACHE_SHARD_COUNT  8
+#endif
+
+static const int kShardCount = SK_SCALEDIMAGECACHE_SHARD_COUNT;
+
+// Each shard is an independent cache behind its own mutex. All the entries for
+// one pixel generation ID (scaled copies, mipmaps) live in the same shard.
+struct ScaledImageCacheShard {
+    SkMutex*            fMutex;
+    SkScaledImageCache* fCache;
+};
+
+static ScaledImageCacheShard gShards[kShardCount];
+
+static void cleanup_gScaledImageCache() {
+#ifndef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
+    SkMemoryBudget::Unregister(gShards);
+#endif
+    for (int i = 0; i < kShardCount; ++i) {
+        SkDELETE(gShards[i].fCache);
+        SkDELETE(gShards[i].fMutex);
+    }
+}
+
+#ifndef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
+static size_t shards_bytes_used(void*) {
+    return SkScaledImageCache::GetBytesUsed();
+}
+
+static void purge_shards_down_to(void*, size_t targetBytes) {
+    for (int i = 0; i < kShardCount; ++i) {
+        // Lowering the limit purges; putting it back leaves the cache as it is.
+        SkAutoMutexAcquire am(gShards[i].fMutex);
+        size_t limit = gShards[i].fCache->setByteLimit(targetBytes / kShardCount);
+        gShards[i].fCache->setByteLimit(limit);
+    }
+}
+#endif
 
 static void create_cache(int) {
+    for (int i = 0; i < kShardCount; ++i) {
+        gShards[i].fMutex = SkNEW(SkMutex);
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-    gScaledImageCache = SkNEW_ARGS(SkScaledImageCache, (SkDiscardableMemory::Create));
+        gShards[i].fCache = SkNEW_ARGS(SkScaledImageCache, (SkDiscardableMemory::Create));
+        gShards[i].fCache->setCountLimit(
+                SkTMax(1, SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT / kShardCount));
 #else
-    gScaledImageCache = SkNEW_ARGS(SkScaledImageCache, (SK_DEFAULT_IMAGE_CACHE_LIMIT));
+        gShards[i].fCache = SkNEW_ARGS(SkScaledImageCache,
+                                       (SK_DEFAULT_IMAGE_CACHE_LIMIT / kShardCount));
+#endif
+    }
+#ifndef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
+    // When backed by discardable memory the bytes are the discardable allocator's to count.
+    SkMemoryBudget::Register(shards_bytes_used, purge_shards_down_to, gShards);
 #endif
 }
 
-static SkScaledImageCache* get_cache() {
+static ScaledImageCacheShard& get_shard_at(int index) {
     SK_DECLARE_STATIC_ONCE(once);
     SkOnce(&once, create_cache, 0, cleanup_gScaledImageCache);
-    SkASSERT(NULL != gScaledImageCache);
-    return gScaledImageCache;
+    SkASSERT(index >= 0 && index < kShardCount);
+    SkASSERT(NULL != gShards[index].fCache);
+    return gShards[index];
+}
+
+static ScaledImageCacheShard& get_shard(uint32_t genID) {
+    // Generation IDs are sequential, so spread neighbours around.
+    uint32_t hash = compute_hash(&genID, 1);
+    return get_shard_at(hash % kShardCount);
 }
 
+static ScaledImageCacheShard& get_shard(SkScaledImageCache::ID* id) {
+    return get_shard(id_to_rec(id)->fKey.fGenID);
+}
 
 SkScaledImageCache::ID* SkScaledImageCache::FindAndLock(
                                 uint32_t pixelGenerationID,
                                 int32_t width,
                                 int32_t height,
                                 SkBitmap* scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->findAndLock(pixelGenerationID, width, height, scaled);
+    ScaledImageCacheShard& shard = get_shard(pixelGenerationID);
+    SkAutoMutexAcquire am(shard.fMutex);
+    return shard.fCache->findAndLock(pixelGenerationID, width, height, scaled);
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::AddAndLock(
@@ -703,8 +811,14 @@ SkScaledImageCache::ID* SkScaledImageCache::AddAndLock(
                                int32_t width,
                                int32_t height,
                                const SkBitmap& scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->addAndLock(pixelGenerationID, width, height, scaled);
+    ID* id;
+    {
+        ScaledImageCacheShard& shard = get_shard(pixelGenerationID);
+        SkAutoMutexAcquire am(shard.fMutex);
+        id = shard.fCache->addAndLock(pixelGenerationID, width, height, scaled);
+    }
+    SkMemoryBudget::NoteGrowth(scaled.getSize());
+    return id;
 }
 
 
@@ -712,60 +826,117 @@ SkScaledImageCache::ID* SkScaledImageCache::FindAndLock(const SkBitmap& orig,
                                                         SkScalar scaleX,
                                                         SkScalar scaleY,
                                                         SkBitmap* scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->findAndLock(orig, scaleX, scaleY, scaled);
+    ScaledImageCacheShard& shard = get_shard(orig.getGenerationID());
+    SkAutoMutexAcquire am(shard.fMutex);
+    return shard.fCache->findAndLock(orig, scaleX, scaleY, scaled);
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::FindAndLockMip(const SkBitmap& orig,
                                                        SkMipMap const ** mip) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->findAndLockMip(orig, mip);
+    ScaledImageCacheShard& shard = get_shard(orig.getGenerationID());
+    SkAutoMutexAcquire am(shard.fMutex);
+    return shard.fCache->findAndLockMip(orig, mip);
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::AddAndLock(const SkBitmap& orig,
                                                        SkScalar scaleX,
                                                        SkScalar scaleY,
                                                        const SkBitmap& scaled) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->addAndLock(orig, scaleX, scaleY, scaled);
+    ID* id;
+    {
+        ScaledImageCacheShard& shard = get_shard(orig.getGenerationID());
+        SkAutoMutexAcquire am(shard.fMutex);
+        id = shard.fCache->addAndLock(orig, scaleX, scaleY, scaled);
+    }
+    SkMemoryBudget::NoteGrowth(scaled.getSize());
+    return id;
 }
 
 SkScaledImageCache::ID* SkScaledImageCache::AddAndLockMip(const SkBitmap& orig,
                                                           const SkMipMap* mip) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->addAndLockMip(orig, mip);
+    ID* id;
+    {
+        ScaledImageCacheShard& shard = get_shard(orig.getGenerationID());
+        SkAutoMutexAcquire am(shard.fMutex);
+        id = shard.fCache->addAndLockMip(orig, mip);
+    }
+    SkMemoryBudget::NoteGrowth(mip->getSize());
+    return id;
 }
 
-void SkScaledImageCache::Unlock(SkScaledImageCache::ID* id) {
-    SkAutoMutexAcquire am(gMutex);
-    get_cache()->unlock(id);
+SkScaledImageCache::ID* SkScaledImageCache::FindAndLockPicture(uint32_t pictureID,
+                                                               const SkSize& scale,
+                                                               const SkIRect& tile,
+                                                               SkBitmap* bitmap) {
+    ScaledImageCacheShard& shard = get_shard(pictureID);
+    SkAutoMutexAcquire am(shard.fMutex);
+    return shard.fCache->findAndLockPicture(pictureID, scale, tile, bitmap);
+}
 
-//    get_cache()->dump();
+SkScaledImageCache::ID* SkScaledImageCache::AddAndLockPicture(uint32_t pictureID,
+                                                              const SkSize& scale,
+                                                              const SkIRect& tile,
+                                                              const SkBitmap& bitmap) {
+    ID* id;
+    {
+        ScaledImageCacheShard& shard = get_shard(pictureID);
+        SkAutoMutexAcquire am(shard.fMutex);
+        id = shard.fCache->addAndLockPicture(pictureID, scale, tile, bitmap);
+    }
+    SkMemoryBudget::NoteGrowth(bitmap.getSize());
+    return id;
+}
+
+void SkScaledImageCache::Unlock(SkScaledImageCache::ID* id) {
+    // The key of a locked rec can't change, so it is safe to read outside the mutex.
+    ScaledImageCacheShard& shard = get_shard(id);
+    SkAutoMutexAcquire am(shard.fMutex);
+    shard.fCache->unlock(id);
 }
 
 size_t SkScaledImageCache::GetBytesUsed() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->getBytesUsed();
+    size_t used = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        ScaledImageCacheShard& shard = get_shard_at(i);
+        SkAutoMutexAcquire am(shard.fMutex);
+        used += shard.fCache->getBytesUsed();
+    }
+    return used;
 }
 
 size_t SkScaledImageCache::GetByteLimit() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->getByteLimit();
+    size_t limit = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        ScaledImageCacheShard& shard = get_shard_at(i);
+        SkAutoMutexAcquire am(shard.fMutex);
+        limit += shard.fCache->getByteLimit();
+    }
+    return limit;
 }
 
 size_t SkScaledImageCache::SetByteLimit(size_t newLimit) {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->setByteLimit(newLimit);
+    size_t prevLimit = 0;
+    for (int i = 0; i < kShardCount; ++i) {
+        ScaledImageCacheShard& shard = get_shard_at(i);
+        SkAutoMutexAcquire am(shard.fMutex);
+        prevLimit += shard.fCache->setByteLimit(newLimit / kShardCount);
+    }
+    return prevLimit;
 }
 
 SkBitmap::Allocator* SkScaledImageCache::GetAllocator() {
-    SkAutoMutexAcquire am(gMutex);
-    return get_cache()->allocator();
+    // Every shard was created with the same factory, so any of their allocators will do.
+    ScaledImageCacheShard& shard = get_shard_at(0);
+    SkAutoMutexAcquire am(shard.fMutex);
+    return shard.fCache->allocator();
 }
 
 void SkScaledImageCache::Dump() {
-    SkAutoMutexAcquire am(gMutex);
-    get_cache()->dump();
+    for (int i = 0; i < kShardCount; ++i) {
+        ScaledImageCacheShard& shard = get_shard_at(i);
+        SkAutoMutexAcquire am(shard.fMutex);
+        shard.fCache->dump();
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
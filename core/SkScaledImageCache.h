@@ -22,6 +22,9 @@ class SkMipMap;
  *
  *  As a convenience, a global instance is also defined, which can be safely
  *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  The global instance is split into shards by pixel generation ID, each with
+ *  its own mutex and a slice of the budget, so that lookups of different
+ *  images from different threads don't serialize on one lock.
  */
 class SkScaledImageCache {
 public:
@@ -58,6 +61,11 @@ public:
                           SkScalar scaleY, const SkBitmap& bitmap);
     static ID* AddAndLockMip(const SkBitmap& original, const SkMipMap* mipMap);
 
+    static ID* FindAndLockPicture(uint32_t pictureID, const SkSize& scale,
+                                  const SkIRect& tile, SkBitmap* returnedBitmap);
+    static ID* AddAndLockPicture(uint32_t pictureID, const SkSize& scale,
+                                 const SkIRect& tile, const SkBitmap& bitmap);
+
     static void Unlock(ID*);
 
     static size_t GetBytesUsed();
@@ -136,6 +144,16 @@ public:
                    SkScalar scaleY, const SkBitmap& bitmap);
     ID* addAndLockMip(const SkBitmap& original, const SkMipMap* mipMap);
 
+    /**
+     *  A picture rasterized into a tile bitmap, keyed by the picture's
+     *  uniqueID, the scale it was drawn at and the tile's bounds. The tile
+     *  is shared by every shader drawing the picture the same way.
+     */
+    ID* findAndLockPicture(uint32_t pictureID, const SkSize& scale, const SkIRect& tile,
+                           SkBitmap* returnedBitmap);
+    ID* addAndLockPicture(uint32_t pictureID, const SkSize& scale, const SkIRect& tile,
+                          const SkBitmap& bitmap);
+
     /**
      *  Given a non-null ID ptr returned by either findAndLock or addAndLock,
      *  this releases the associated resources to be available to be purged
@@ -154,6 +172,13 @@ public:
      */
     size_t setByteLimit(size_t newLimit);
 
+    /**
+     *  When constructed with a DiscardableFactory the cache is budgeted by
+     *  entry count instead of bytes. This sets that count, returning the
+     *  previous one.
+     */
+    int setCountLimit(int newLimit);
+
     SkBitmap::Allocator* allocator() const { return fAllocator; };
 
     /**
@@ -178,6 +203,7 @@ private:
     size_t  fBytesUsed;
     size_t  fByteLimit;
     int     fCount;
+    int     fCountLimit;
 
     Rec* findAndLock(uint32_t generationID, SkScalar sx, SkScalar sy,
                      const SkIRect& bounds);
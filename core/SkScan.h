@@ -16,14 +16,26 @@ class SkRasterClip;
 class SkRegion;
 class SkBlitter;
 class SkPath;
+struct SkMask;
 
 /** Defines a fixed-point rectangle, identical to the integer SkIRect, but its
     coordinates are treated as SkFixed rather than int32_t.
 */
 typedef SkIRect SkXRect;
 
+/** Whether SkScan::AntiFillPath() uses the analytic coverage scan converter.
+    Defaults to true when SK_USE_ANALYTIC_AA is defined.
+*/
+extern bool gSkUseAnalyticAA;
+
 class SkScan {
 public:
+    /** How HairLines() and AntiHairLines() pair up their points. */
+    enum LineMode {
+        kLines_LineMode,    //!< pts[0]-pts[1], pts[2]-pts[3], ...
+        kPolyline_LineMode  //!< pts[0]-pts[1], pts[1]-pts[2], ...
+    };
+
     static void FillPath(const SkPath&, const SkIRect&, SkBlitter*);
 
     ///////////////////////////////////////////////////////////////////////////
@@ -36,6 +48,14 @@ public:
     static void AntiFillXRect(const SkXRect&, const SkRasterClip&, SkBlitter*);
     static void FillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
     static void AntiFillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
+    /**
+     *  Antialiases path by exact area coverage rather than by supersampling.
+     *  Each edge is walked once per pixel row and coverage has 256 levels.
+     *  AntiFillPath() calls this for every path when gSkUseAnalyticAA is set.
+     *  Inverse fills and paths too large for float precision are handed back
+     *  to the supersampler.
+     */
+    static void AnalyticAntiFillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
     static void FrameRect(const SkRect&, const SkPoint& strokeSize,
                           const SkRasterClip&, SkBlitter*);
     static void AntiFrameRect(const SkRect&, const SkPoint& strokeSize,
@@ -45,11 +65,30 @@ public:
                          SkBlitter*);
     static void AntiHairLine(const SkPoint&, const SkPoint&, const SkRasterClip&,
                              SkBlitter*);
+    /**
+     *  Draw the hairlines between count points at once. The clip is resolved
+     *  once for the whole batch, and when every point is inside it the lines
+     *  skip clipping altogether, so thousands of short segments cost little
+     *  more than the pixels they touch.
+     */
+    static void HairLines(const SkPoint pts[], int count, LineMode,
+                          const SkRasterClip&, SkBlitter*);
+    static void AntiHairLines(const SkPoint pts[], int count, LineMode,
+                              const SkRasterClip&, SkBlitter*);
     static void HairRect(const SkRect&, const SkRasterClip&, SkBlitter*);
     static void AntiHairRect(const SkRect&, const SkRasterClip&, SkBlitter*);
     static void HairPath(const SkPath&, const SkRasterClip&, SkBlitter*);
     static void AntiHairPath(const SkPath&, const SkRasterClip&, SkBlitter*);
 
+    /**
+     *  Antialiases the rows of path that fall inside band into mask, which
+     *  must be A8 and contain band. The band is cleared first. Only the edges
+     *  that cross the band are built and walked, and nothing outside the band
+     *  is written, so disjoint bands of one path may be filled into the same
+     *  mask from different threads. path must not be inverse filled.
+     */
+    static void AntiFillPathBand(const SkPath&, const SkIRect& band, const SkMask&);
+
 private:
     friend class SkAAClip;
     friend class SkRegion;
@@ -62,6 +101,8 @@ private:
     static void FillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
     static void AntiFillPath(const SkPath&, const SkRegion& clip, SkBlitter*,
                              bool forceRLE = false);
+    static void AnalyticAntiFillPath(const SkPath&, const SkRegion& clip, SkBlitter*,
+                                     bool forceRLE = false);
     static void FillTriangle(const SkPoint pts[], const SkRegion*, SkBlitter*);
 
     static void AntiFrameRect(const SkRect&, const SkPoint& strokeSize,
@@ -70,6 +111,10 @@ private:
                          SkBlitter*);
     static void AntiHairLineRgn(const SkPoint&, const SkPoint&, const SkRegion*,
                              SkBlitter*);
+    static void HairLinesRgn(const SkPoint pts[], int count, LineMode,
+                             const SkRegion*, SkBlitter*);
+    static void AntiHairLinesRgn(const SkPoint pts[], int count, LineMode,
+                                 const SkRegion*, SkBlitter*);
 };
 
 /** Assign an SkXRect from a SkIRect, by promoting the src rect's coordinates
@@ -33,6 +33,11 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect,
                   SkBlitter* blitter, int start_y, int stop_y, int shiftEdgesUp,
                   const SkRegion& clipRgn);
 
+// The bounds of the hairlines between pts, outset by a pixel to cover what
+// rounding and antialiasing may touch. Returns false if a point is not finite
+// or too far out for the lines to be drawn without chopping.
+bool sk_hairline_bounds(const SkPoint pts[], int count, SkIRect* bounds);
+
 // blit the rects above and below avoid, clipped to clip
 void sk_blit_above(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
 void sk_blit_below(SkBlitter*, const SkIRect& avoid, const SkRegion& clip);
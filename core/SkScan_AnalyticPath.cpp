@@ -0,0 +1,421 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScanPriv.h"
+
+#include "SkAAClip.h"
+#include "SkGeometry.h"
+#include "SkPath.h"
+#include "SkRasterClip.h"
+#include "SkRegion.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
+#include "SkTemplates.h"
+
+/*  Antialiasing by exact area coverage, instead of the supersampling in
+    SkScan_AntiPath.cpp.
+
+    Curves are flattened to lines. Each line adds, to every pixel it crosses,
+    the signed area of the trapezoid between the line and the pixel's right
+    side. Whatever is left of a row's height goes to the next pixel over. A
+    running sum along the row then gives each pixel the winding-weighted area
+    of the path inside it. A line is walked once per pixel row, rather than
+    once per supersampled row, and coverage has the full 8 bits.
+
+    The coverage is exact where the winding number is constant within each
+    pixel. Where edges of opposite winding, or overlapping contours, meet
+    inside one pixel, the fill rule is applied to the summed area rather than
+    to each piece of the pixel.
+ */
+
+#ifdef SK_USE_ANALYTIC_AA
+bool gSkUseAnalyticAA = true;
+#else
+bool gSkUseAnalyticAA = false;
+#endif
+
+namespace {
+
+// Curves are flattened until no point is further than this from the curve.
+const SkScalar kFlattenTolerance = SK_Scalar1 / 8;
+const int kMaxCurveLines = 256;
+const int kMaxConicPow2 = 4;
+
+// The accumulation buffer holds this many cells at most; taller paths are
+// covered a strip of rows at a time.
+const int kMaxStripCells = 16 * 1024;
+
+// Floats lose too much of a pixel past this; such paths are supersampled.
+const SkScalar kMaxCoord = SkIntToScalar(1 << 22);
+
+// Runs are int16_t, so rows can't be wider than this.
+const int kMaxWidth = 32767;
+
+struct Line {
+    SkScalar fX0, fY0;  // Always the top end: fY0 < fY1.
+    SkScalar fX1, fY1;
+    SkScalar fWinding;  // +1 or -1.
+};
+
+struct LineTopLess {
+    bool operator()(const Line& a, const Line& b) const {
+        return a.fY0 < b.fY0;
+    }
+};
+
+/// Flattens a path into Lines, in coordinates relative to the covered rect.
+class LineBuilder {
+public:
+    LineBuilder(const SkIRect& bounds)
+        : fLeft(SkIntToScalar(bounds.fLeft))
+        , fTop(SkIntToScalar(bounds.fTop))
+        , fWidth(SkIntToScalar(bounds.width()))
+        , fHeight(SkIntToScalar(bounds.height())) {}
+
+    void build(const SkPath& path) {
+        // Fills close their contours, so have the iterator add the lines.
+        SkPath::Iter iter(path, true);
+        SkPoint pts[4];
+        SkPath::Verb verb;
+        while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+            switch (verb) {
+                case SkPath::kLine_Verb:
+                    this->addLine(pts[0], pts[1]);
+                    break;
+                case SkPath::kQuad_Verb:
+                    this->addQuad(pts);
+                    break;
+                case SkPath::kConic_Verb: {
+                    SkPoint storage[1 + 2 * (1 << kMaxConicPow2)];
+                    SkConic conic;
+                    conic.set(pts, iter.conicWeight());
+                    int pow2 = SkMin32(conic.computeQuadPOW2(kFlattenTolerance),
+                                       kMaxConicPow2);
+                    int quadCount = conic.chopIntoQuadsPOW2(storage, pow2);
+                    for (int i = 0; i < quadCount; ++i) {
+                        this->addQuad(&storage[i * 2]);
+                    }
+                    break;
+                }
+                case SkPath::kCubic_Verb:
+                    this->addCubic(pts);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    SkTDArray<Line>& lines() { return fLines; }
+
+private:
+    static int curve_line_count(SkScalar error) {
+        int count = SkScalarCeilToInt(SkScalarSqrt(error / kFlattenTolerance));
+        return SkTPin(count, 1, kMaxCurveLines);
+    }
+
+    void addQuad(const SkPoint pts[3]) {
+        // With n lines, a quad is at most |p0 - 2p1 + p2| / (8n^2) away.
+        SkVector dd = pts[0] - pts[1] - pts[1] + pts[2];
+        const int count = curve_line_count(dd.length() / 8);
+        const SkScalar dt = SkScalarInvert(SkIntToScalar(count));
+        SkPoint prev = pts[0];
+        for (int i = 1; i < count; ++i) {
+            SkScalar t = i * dt;
+            SkScalar mt = 1 - t;
+            SkPoint pt;
+            pt.set(mt * mt * pts[0].fX + 2 * t * mt * pts[1].fX + t * t * pts[2].fX,
+                   mt * mt * pts[0].fY + 2 * t * mt * pts[1].fY + t * t * pts[2].fY);
+            this->addLine(prev, pt);
+            prev = pt;
+        }
+        this->addLine(prev, pts[2]);
+    }
+
+    void addCubic(const SkPoint pts[4]) {
+        // With n lines, a cubic is at most 3 max|p[i] - 2p[i+1] + p[i+2]| /
+        // (4n^2) away.
+        SkVector dd0 = pts[0] - pts[1] - pts[1] + pts[2];
+        SkVector dd1 = pts[1] - pts[2] - pts[2] + pts[3];
+        const SkScalar dd = SkTMax(dd0.length(), dd1.length());
+        const int count = curve_line_count(3 * dd / 4);
+        const SkScalar dt = SkScalarInvert(SkIntToScalar(count));
+        SkPoint prev = pts[0];
+        for (int i = 1; i < count; ++i) {
+            SkScalar t = i * dt;
+            SkScalar mt = 1 - t;
+            SkScalar a = mt * mt * mt;
+            SkScalar b = 3 * t * mt * mt;
+            SkScalar c = 3 * t * t * mt;
+            SkScalar d = t * t * t;
+            SkPoint pt;
+            pt.set(a * pts[0].fX + b * pts[1].fX + c * pts[2].fX + d * pts[3].fX,
+                   a * pts[0].fY + b * pts[1].fY + c * pts[2].fY + d * pts[3].fY);
+            this->addLine(prev, pt);
+            prev = pt;
+        }
+        this->addLine(prev, pts[3]);
+    }
+
+    void addLine(const SkPoint& devP0, const SkPoint& devP1) {
+        SkPoint p0 = { devP0.fX - fLeft, devP0.fY - fTop };
+        SkPoint p1 = { devP1.fX - fLeft, devP1.fY - fTop };
+        // Lines entirely above or below the rect add nothing to its rows.
+        if ((p0.fY <= 0 && p1.fY <= 0) || (p0.fY >= fHeight && p1.fY >= fHeight) ||
+            p0.fY == p1.fY) {
+            return;
+        }
+
+        // Split the line where it crosses the left and right sides. The parts
+        // outside are moved onto the side they are past: still covering the
+        // rows they did, everything to their right is covered as before.
+        SkScalar ts[2];
+        int tCount = 0;
+        const SkScalar sides[2] = { 0, fWidth };
+        for (int i = 0; i < 2; ++i) {
+            if ((p0.fX < sides[i]) != (p1.fX < sides[i])) {
+                ts[tCount++] = (sides[i] - p0.fX) / (p1.fX - p0.fX);
+            }
+        }
+        if (2 == tCount && ts[0] > ts[1]) {
+            SkTSwap(ts[0], ts[1]);
+        }
+        SkPoint prev = p0;
+        for (int i = 0; i < tCount; ++i) {
+            SkPoint pt;
+            pt.set(p0.fX + ts[i] * (p1.fX - p0.fX), p0.fY + ts[i] * (p1.fY - p0.fY));
+            this->addClampedLine(prev, pt);
+            prev = pt;
+        }
+        this->addClampedLine(prev, p1);
+    }
+
+    void addClampedLine(SkPoint p0, SkPoint p1) {
+        if (p0.fY == p1.fY) {
+            return;
+        }
+        p0.fX = SkScalarPin(p0.fX, 0, fWidth);
+        p1.fX = SkScalarPin(p1.fX, 0, fWidth);
+        Line* line = fLines.append();
+        if (p0.fY < p1.fY) {
+            line->fX0 = p0.fX; line->fY0 = p0.fY;
+            line->fX1 = p1.fX; line->fY1 = p1.fY;
+            line->fWinding = SK_Scalar1;
+        } else {
+            line->fX0 = p1.fX; line->fY0 = p1.fY;
+            line->fX1 = p0.fX; line->fY1 = p0.fY;
+            line->fWinding = -SK_Scalar1;
+        }
+    }
+
+    const SkScalar  fLeft, fTop, fWidth, fHeight;
+    SkTDArray<Line> fLines;
+};
+
+/**
+ *  Adds the line from (x0, y0) down to (x1, y1), with y in rows of acc, to the
+ *  cells it crosses. Each row of acc has stride cells and must have room for
+ *  two cells past the rightmost x.
+ */
+void accumulate_line(SkScalar* acc, int stride, SkScalar x0, SkScalar y0,
+                     SkScalar x1, SkScalar y1, SkScalar winding) {
+    SkASSERT(y0 < y1);
+    const SkScalar dxdy = (x1 - x0) / (y1 - y0);
+    const int yStart = SkScalarFloorToInt(y0);
+    const int yEnd = SkScalarCeilToInt(y1);
+    SkScalar x = x0;
+    for (int y = yStart; y < yEnd; ++y) {
+        SkScalar* row = acc + y * stride;
+        const SkScalar dy = SkTMin(SkIntToScalar(y + 1), y1) - SkTMax(SkIntToScalar(y), y0);
+        const SkScalar xNext = x + dxdy * dy;
+        const SkScalar d = dy * winding;
+
+        const SkScalar left = SkTMin(x, xNext);
+        const SkScalar right = SkTMax(x, xNext);
+        const SkScalar leftFloor = SkScalarFloorToScalar(left);
+        const int leftIndex = SkScalarFloorToInt(left);
+        const int rightIndex = SkScalarCeilToInt(right);
+        if (rightIndex <= leftIndex + 1) {
+            // Within one pixel: the area right of the line is a trapezoid.
+            const SkScalar mid = SkScalarHalf(x + xNext) - leftFloor;
+            row[leftIndex] += d - d * mid;
+            row[leftIndex + 1] += d * mid;
+        } else {
+            // Across several pixels: the area right of the line grows
+            // quadratically in the first and last pixel and linearly between.
+            const SkScalar s = SkScalarInvert(right - left);
+            const SkScalar leftFrac = left - leftFloor;
+            const SkScalar rightFrac = right - SkIntToScalar(rightIndex - 1);
+            const SkScalar a0 = SkScalarHalf(s * (1 - leftFrac) * (1 - leftFrac));
+            const SkScalar am = SkScalarHalf(s * rightFrac * rightFrac);
+            row[leftIndex] += d * a0;
+            if (rightIndex == leftIndex + 2) {
+                row[leftIndex + 1] += d * (1 - a0 - am);
+            } else {
+                const SkScalar a1 = s * (SK_Scalar1 * 3 / 2 - leftFrac);
+                row[leftIndex + 1] += d * (a1 - a0);
+                for (int i = leftIndex + 2; i < rightIndex - 1; ++i) {
+                    row[i] += d * s;
+                }
+                const SkScalar a2 = a1 + (rightIndex - leftIndex - 3) * s;
+                row[rightIndex - 1] += d * (1 - a2 - am);
+            }
+            row[rightIndex] += d * am;
+        }
+        x = xNext;
+    }
+}
+
+inline SkAlpha coverage_to_alpha(SkScalar area, bool evenOdd) {
+    SkScalar coverage = SkScalarAbs(area);
+    if (evenOdd) {
+        coverage -= 2 * SkScalarFloorToScalar(SkScalarHalf(coverage));
+        if (coverage > SK_Scalar1) {
+            coverage = 2 - coverage;
+        }
+    } else if (coverage > SK_Scalar1) {
+        coverage = SK_Scalar1;
+    }
+    return SkToU8(SkScalarRoundToInt(coverage * 255));
+}
+
+/// Turns a row of accumulated areas into runs of alpha and blits them.
+void blit_row(SkBlitter* blitter, int x, int y, const SkScalar* acc, int width,
+              bool evenOdd, SkAlpha* alpha, SkAlpha* runAlpha, int16_t* runs) {
+    SkScalar area = 0;
+    int first = -1;
+    int last = -1;
+    for (int i = 0; i < width; ++i) {
+        area += acc[i];
+        alpha[i] = coverage_to_alpha(area, evenOdd);
+        if (alpha[i]) {
+            if (first < 0) {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    if (first < 0) {
+        return;
+    }
+
+    int i = first;
+    while (i <= last) {
+        int j = i + 1;
+        while (j <= last && alpha[j] == alpha[i]) {
+            ++j;
+        }
+        runs[i - first] = SkToS16(j - i);
+        runAlpha[i - first] = alpha[i];
+        i = j;
+    }
+    runs[last + 1 - first] = 0;
+    blitter->blitAntiH(x + first, y, runAlpha, runs);
+}
+
+}  // namespace
+
+void SkScan::AnalyticAntiFillPath(const SkPath& path, const SkRegion& clip,
+                                  SkBlitter* blitter, bool forceRLE) {
+    if (clip.isEmpty()) {
+        return;
+    }
+
+    const SkRect& pathBounds = path.getBounds();
+    if (path.isInverseFillType() || !pathBounds.isFinite() ||
+        SkScalarAbs(pathBounds.fLeft) > kMaxCoord || SkScalarAbs(pathBounds.fRight) > kMaxCoord ||
+        SkScalarAbs(pathBounds.fTop) > kMaxCoord || SkScalarAbs(pathBounds.fBottom) > kMaxCoord) {
+        AntiFillPath(path, clip, blitter, forceRLE);
+        return;
+    }
+
+    SkIRect bounds;
+    pathBounds.roundOut(&bounds);
+    if (!bounds.intersect(clip.getBounds())) {
+        return;
+    }
+    if (bounds.width() > kMaxWidth) {
+        AntiFillPath(path, clip, blitter, forceRLE);
+        return;
+    }
+
+    SkScanClipper clipper(blitter, &clip, bounds);
+    blitter = clipper.getBlitter();
+    if (NULL == blitter) {
+        return;
+    }
+
+    LineBuilder builder(bounds);
+    builder.build(path);
+    SkTDArray<Line>& lines = builder.lines();
+    if (lines.isEmpty()) {
+        return;
+    }
+    SkTQSort(lines.begin(), lines.end() - 1, LineTopLess());
+
+    const int width = bounds.width();
+    const int height = bounds.height();
+    const int stride = width + 2;
+    const int stripRows = SkTPin(kMaxStripCells / stride, 1, height);
+    const bool evenOdd = SkPath::kEvenOdd_FillType == path.getFillType();
+
+    SkAutoTMalloc<SkScalar> acc(stripRows * stride);
+    sk_bzero(acc.get(), stripRows * stride * sizeof(SkScalar));
+    SkAutoTMalloc<SkAlpha> alpha(2 * (width + 1));
+    SkAutoTMalloc<int16_t> runs(width + 1);
+
+    SkTDArray<const Line*> active;
+    int next = 0;
+    for (int stripTop = 0; stripTop < height; stripTop += stripRows) {
+        const int stripBottom = SkMin32(stripTop + stripRows, height);
+        const SkScalar top = SkIntToScalar(stripTop);
+        const SkScalar bottom = SkIntToScalar(stripBottom);
+
+        while (next < lines.count() && lines[next].fY0 < bottom) {
+            *active.append() = &lines[next++];
+        }
+        for (int i = active.count() - 1; i >= 0; --i) {
+            const Line& line = *active[i];
+            const SkScalar y0 = SkTMax(line.fY0, top);
+            const SkScalar y1 = SkTMin(line.fY1, bottom);
+            if (y0 < y1) {
+                const SkScalar dxdy = (line.fX1 - line.fX0) / (line.fY1 - line.fY0);
+                const SkScalar x0 = line.fX0 + (y0 - line.fY0) * dxdy;
+                const SkScalar x1 = y1 == line.fY1 ? line.fX1 : line.fX0 + (y1 - line.fY0) * dxdy;
+                accumulate_line(acc.get(), stride, x0, y0 - top, x1, y1 - top, line.fWinding);
+            }
+            if (line.fY1 <= bottom) {
+                active.removeShuffle(i);
+            }
+        }
+
+        for (int y = stripTop; y < stripBottom; ++y) {
+            SkScalar* row = acc.get() + (y - stripTop) * stride;
+            blit_row(blitter, bounds.fLeft, bounds.fTop + y, row, width, evenOdd,
+                     alpha.get(), alpha.get() + width + 1, runs.get());
+        }
+        sk_bzero(acc.get(), (stripBottom - stripTop) * stride * sizeof(SkScalar));
+    }
+}
+
+void SkScan::AnalyticAntiFillPath(const SkPath& path, const SkRasterClip& clip,
+                                  SkBlitter* blitter) {
+    if (clip.isEmpty()) {
+        return;
+    }
+
+    if (clip.isBW()) {
+        AnalyticAntiFillPath(path, clip.bwRgn(), blitter);
+    } else {
+        SkRegion        tmp;
+        SkAAClipBlitter aaBlitter;
+
+        tmp.setRect(clip.getBounds());
+        aaBlitter.init(blitter, &clip.aaRgn());
+        AnalyticAntiFillPath(path, tmp, &aaBlitter, true);
+    }
+}
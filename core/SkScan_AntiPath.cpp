@@ -13,6 +13,7 @@
 #include "SkBlitter.h"
 #include "SkRegion.h"
 #include "SkAntiRun.h"
+#include "SkMask.h"
 
 #define SHIFT   2
 #define SCALE   (1 << SHIFT)
@@ -702,6 +703,90 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& origClip,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/// Writes coverage straight into an A8 mask. Rows outside the mask's bounds
+/// are never touched, so several of these may share one mask across threads.
+class A8MaskBlitter : public SkBlitter {
+public:
+    A8MaskBlitter(const SkMask& mask) : fMask(mask) {
+        SkASSERT(SkMask::kA8_Format == mask.fFormat);
+    }
+
+    virtual void blitH(int x, int y, int width) SK_OVERRIDE {
+        memset(fMask.getAddr8(x, y), 0xFF, width);
+    }
+
+    virtual void blitAntiH(int x, int y, const SkAlpha antialias[],
+                           const int16_t runs[]) SK_OVERRIDE {
+        uint8_t* dst = fMask.getAddr8(x, y);
+        for (;;) {
+            int count = runs[0];
+            SkASSERT(count >= 0);
+            if (count == 0) {
+                return;
+            }
+            if (antialias[0]) {
+                memset(dst, antialias[0], count);
+            }
+            runs += count;
+            antialias += count;
+            dst += count;
+        }
+    }
+
+    virtual void blitV(int x, int y, int height, SkAlpha alpha) SK_OVERRIDE {
+        uint8_t* dst = fMask.getAddr8(x, y);
+        while (--height >= 0) {
+            *dst = alpha;
+            dst += fMask.fRowBytes;
+        }
+    }
+
+    virtual void blitRect(int x, int y, int width, int height) SK_OVERRIDE {
+        uint8_t* dst = fMask.getAddr8(x, y);
+        while (--height >= 0) {
+            memset(dst, 0xFF, width);
+            dst += fMask.fRowBytes;
+        }
+    }
+
+    virtual void blitMask(const SkMask& mask, const SkIRect& clip) SK_OVERRIDE {
+        SkASSERT(SkMask::kA8_Format == mask.fFormat);
+        uint8_t* dst = fMask.getAddr8(clip.fLeft, clip.fTop);
+        const uint8_t* src = mask.getAddr8(clip.fLeft, clip.fTop);
+        for (int y = 0; y < clip.height(); ++y) {
+            memcpy(dst, src, clip.width());
+            dst += fMask.fRowBytes;
+            src += mask.fRowBytes;
+        }
+    }
+
+private:
+    const SkMask& fMask;
+};
+
+}  // namespace
+
+void SkScan::AntiFillPathBand(const SkPath& path, const SkIRect& band, const SkMask& mask) {
+    SkASSERT(!path.isInverseFillType());
+    SkASSERT(mask.fBounds.contains(band));
+
+    uint8_t* row = mask.getAddr8(band.fLeft, band.fTop);
+    for (int y = band.fTop; y < band.fBottom; ++y) {
+        memset(row, 0, band.width());
+        row += mask.fRowBytes;
+    }
+
+    // Clipping to the band is all it takes: the edge builder culls and chops
+    // every edge against the band, so only this band's edges are ever walked.
+    SkRegion clip(band);
+    A8MaskBlitter blitter(mask);
+    AntiFillPath(path, clip, &blitter);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 #include "SkRasterClip.h"
 
 void SkScan::FillPath(const SkPath& path, const SkRasterClip& clip,
@@ -727,6 +812,10 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRasterClip& clip,
     if (clip.isEmpty()) {
         return;
     }
+    if (gSkUseAnalyticAA && !path.isInverseFillType()) {
+        AnalyticAntiFillPath(path, clip, blitter);
+        return;
+    }
 
     if (clip.isBW()) {
         AntiFillPath(path, clip.bwRgn(), blitter);
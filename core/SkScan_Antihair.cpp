@@ -8,6 +8,7 @@
 
 
 #include "SkScan.h"
+#include "SkScanPriv.h"
 #include "SkBlitter.h"
 #include "SkColorPriv.h"
 #include "SkLineClipper.h"
@@ -667,6 +668,39 @@ void SkScan::AntiHairLineRgn(const SkPoint& pt0, const SkPoint& pt1,
     do_anti_hairline(x0, y0, x1, y1, NULL, blitter);
 }
 
+void SkScan::AntiHairLinesRgn(const SkPoint pts[], int count, LineMode mode,
+                              const SkRegion* clip, SkBlitter* blitter) {
+    if (count < 2 || (clip && clip->isEmpty())) {
+        return;
+    }
+    const int step = (kLines_LineMode == mode) ? 2 : 1;
+    const int stop = count - 1;
+
+    SkIRect bounds;
+    if (sk_hairline_bounds(pts, count, &bounds)) {
+        if (clip && clip->quickReject(bounds)) {
+            return;
+        }
+        if (NULL == clip || clip->quickContains(bounds)) {
+#ifdef TEST_GAMMA
+            build_gamma_table();
+#endif
+            // Every line is inside the clip and fits in SkFixed, so none of
+            // them needs clipping at all.
+            for (int i = 0; i < stop; i += step) {
+                do_anti_hairline(SkScalarToFDot6(pts[i].fX), SkScalarToFDot6(pts[i].fY),
+                                 SkScalarToFDot6(pts[i + 1].fX),
+                                 SkScalarToFDot6(pts[i + 1].fY), NULL, blitter);
+            }
+            return;
+        }
+    }
+
+    for (int i = 0; i < stop; i += step) {
+        AntiHairLineRgn(pts[i], pts[i + 1], clip, blitter);
+    }
+}
+
 void SkScan::AntiHairRect(const SkRect& rect, const SkRasterClip& clip,
                           SkBlitter* blitter) {
     SkPoint p0, p1;
@@ -8,6 +8,7 @@
 
 
 #include "SkScan.h"
+#include "SkScanPriv.h"
 #include "SkBlitter.h"
 #include "SkRasterClip.h"
 #include "SkFDot6.h"
@@ -40,9 +41,56 @@ static bool canConvertFDot6ToFixed(SkFDot6 x) {
 }
 #endif
 
-void SkScan::HairLineRgn(const SkPoint& pt0, const SkPoint& pt1,
-                         const SkRegion* clip, SkBlitter* blitter) {
-    SkBlitterClipper    clipper;
+// Draws a hairline whose ends have already been clipped.
+static void hairline_dot6(SkFDot6 x0, SkFDot6 y0, SkFDot6 x1, SkFDot6 y1,
+                          SkBlitter* blitter) {
+    SkASSERT(canConvertFDot6ToFixed(x0));
+    SkASSERT(canConvertFDot6ToFixed(y0));
+    SkASSERT(canConvertFDot6ToFixed(x1));
+    SkASSERT(canConvertFDot6ToFixed(y1));
+
+    SkFDot6 dx = x1 - x0;
+    SkFDot6 dy = y1 - y0;
+
+    if (SkAbs32(dx) > SkAbs32(dy)) { // mostly horizontal
+        if (x0 > x1) {   // we want to go left-to-right
+            SkTSwap<SkFDot6>(x0, x1);
+            SkTSwap<SkFDot6>(y0, y1);
+        }
+        int ix0 = SkFDot6Round(x0);
+        int ix1 = SkFDot6Round(x1);
+        if (ix0 == ix1) {// too short to draw
+            return;
+        }
+
+        SkFixed slope = SkFixedDiv(dy, dx);
+        SkFixed startY = SkFDot6ToFixed(y0) + (slope * ((32 - x0) & 63) >> 6);
+
+        horiline(ix0, ix1, startY, slope, blitter);
+    } else {              // mostly vertical
+        if (y0 > y1) {   // we want to go top-to-bottom
+            SkTSwap<SkFDot6>(x0, x1);
+            SkTSwap<SkFDot6>(y0, y1);
+        }
+        int iy0 = SkFDot6Round(y0);
+        int iy1 = SkFDot6Round(y1);
+        if (iy0 == iy1) { // too short to draw
+            return;
+        }
+
+        SkFixed slope = SkFixedDiv(dx, dy);
+        SkFixed startX = SkFDot6ToFixed(x0) + (slope * ((32 - y0) & 63) >> 6);
+
+        vertline(iy0, iy1, startX, slope, blitter);
+    }
+}
+
+// Clips one hairline and draws it: into blitter if it turns out to be inside
+// a rectangular clip, otherwise into clipBlitter, which is blitter restricted
+// to clip.
+static void clip_hairline(const SkPoint& pt0, const SkPoint& pt1,
+                          const SkRegion* clip, SkBlitter* blitter,
+                          SkBlitter* clipBlitter) {
     SkRect  r;
     SkIRect clipR, ptsR;
     SkPoint pts[2] = { pt0, pt1 };
@@ -72,11 +120,6 @@ void SkScan::HairLineRgn(const SkPoint& pt0, const SkPoint& pt1,
     SkFDot6 x1 = SkScalarToFDot6(pts[1].fX);
     SkFDot6 y1 = SkScalarToFDot6(pts[1].fY);
 
-    SkASSERT(canConvertFDot6ToFixed(x0));
-    SkASSERT(canConvertFDot6ToFixed(y0));
-    SkASSERT(canConvertFDot6ToFixed(x1));
-    SkASSERT(canConvertFDot6ToFixed(y1));
-
     if (clip) {
         // now perform clipping again, as the rounding to dot6 can wiggle us
         // our rects are really dot6 rects, but since we've already used
@@ -97,46 +140,70 @@ void SkScan::HairLineRgn(const SkPoint& pt0, const SkPoint& pt1,
         if (!SkIRect::Intersects(ptsR, clipR)) {
             return;
         }
-        if (clip->isRect() && clipR.contains(ptsR)) {
-            clip = NULL;
-        } else {
-            blitter = clipper.apply(blitter, clip);
+        if (!clip->isRect() || !clipR.contains(ptsR)) {
+            blitter = clipBlitter;
         }
     }
 
-    SkFDot6 dx = x1 - x0;
-    SkFDot6 dy = y1 - y0;
+    hairline_dot6(x0, y0, x1, y1, blitter);
+}
 
-    if (SkAbs32(dx) > SkAbs32(dy)) { // mostly horizontal
-        if (x0 > x1) {   // we want to go left-to-right
-            SkTSwap<SkFDot6>(x0, x1);
-            SkTSwap<SkFDot6>(y0, y1);
-        }
-        int ix0 = SkFDot6Round(x0);
-        int ix1 = SkFDot6Round(x1);
-        if (ix0 == ix1) {// too short to draw
-            return;
-        }
+void SkScan::HairLineRgn(const SkPoint& pt0, const SkPoint& pt1,
+                         const SkRegion* clip, SkBlitter* blitter) {
+    SkBlitterClipper    clipper;
+    SkBlitter* clipBlitter = clipper.apply(blitter, clip);
+    clip_hairline(pt0, pt1, clip, blitter, clipBlitter);
+}
 
-        SkFixed slope = SkFixedDiv(dy, dx);
-        SkFixed startY = SkFDot6ToFixed(y0) + (slope * ((32 - x0) & 63) >> 6);
+bool sk_hairline_bounds(const SkPoint pts[], int count, SkIRect* bounds) {
+    SkRect r;
+    if (!r.setBoundsCheck(pts, count)) {
+        return false;
+    }
+    // Past this the lines have to be chopped to fit in SkFixed.
+    const SkScalar max = SkIntToScalar(32767);
+    if (r.fLeft < -max || r.fTop < -max || r.fRight > max || r.fBottom > max) {
+        return false;
+    }
+    r.roundOut(bounds);
+    bounds->inset(-1, -1);
+    return true;
+}
 
-        horiline(ix0, ix1, startY, slope, blitter);
-    } else {              // mostly vertical
-        if (y0 > y1) {   // we want to go top-to-bottom
-            SkTSwap<SkFDot6>(x0, x1);
-            SkTSwap<SkFDot6>(y0, y1);
-        }
-        int iy0 = SkFDot6Round(y0);
-        int iy1 = SkFDot6Round(y1);
-        if (iy0 == iy1) { // too short to draw
+void SkScan::HairLinesRgn(const SkPoint pts[], int count, LineMode mode,
+                          const SkRegion* clip, SkBlitter* blitter) {
+    if (count < 2 || (clip && clip->isEmpty())) {
+        return;
+    }
+    const int step = (kLines_LineMode == mode) ? 2 : 1;
+    const int stop = count - 1;
+
+    SkIRect bounds;
+    bool inRange = sk_hairline_bounds(pts, count, &bounds);
+    if (inRange && clip) {
+        if (clip->quickReject(bounds)) {
             return;
         }
+        if (clip->isRect() && clip->getBounds().contains(bounds)) {
+            clip = NULL;
+        }
+    }
 
-        SkFixed slope = SkFixedDiv(dx, dy);
-        SkFixed startX = SkFDot6ToFixed(x0) + (slope * ((32 - y0) & 63) >> 6);
+    if (inRange && NULL == clip) {
+        // Every line is inside the clip and fits in SkFixed, so none of them
+        // needs clipping at all.
+        for (int i = 0; i < stop; i += step) {
+            hairline_dot6(SkScalarToFDot6(pts[i].fX), SkScalarToFDot6(pts[i].fY),
+                          SkScalarToFDot6(pts[i + 1].fX), SkScalarToFDot6(pts[i + 1].fY),
+                          blitter);
+        }
+        return;
+    }
 
-        vertline(iy0, iy1, startX, slope, blitter);
+    SkBlitterClipper    clipper;
+    SkBlitter* clipBlitter = clipper.apply(blitter, clip);
+    for (int i = 0; i < stop; i += step) {
+        clip_hairline(pts[i], pts[i + 1], clip, blitter, clipBlitter);
     }
 }
 
@@ -393,6 +460,40 @@ void SkScan::HairLine(const SkPoint& p0, const SkPoint& p1,
     }
 }
 
+void SkScan::HairLines(const SkPoint pts[], int count, LineMode mode,
+                       const SkRasterClip& clip, SkBlitter* blitter) {
+    if (clip.isBW()) {
+        HairLinesRgn(pts, count, mode, &clip.bwRgn(), blitter);
+    } else {
+        const SkRegion* clipRgn = NULL;
+        SkIRect ir;
+        SkAAClipBlitterWrapper wrap;
+        if (!sk_hairline_bounds(pts, count, &ir) || !clip.quickContains(ir)) {
+            wrap.init(clip, blitter);
+            blitter = wrap.getBlitter();
+            clipRgn = &wrap.getRgn();
+        }
+        HairLinesRgn(pts, count, mode, clipRgn, blitter);
+    }
+}
+
+void SkScan::AntiHairLines(const SkPoint pts[], int count, LineMode mode,
+                           const SkRasterClip& clip, SkBlitter* blitter) {
+    if (clip.isBW()) {
+        AntiHairLinesRgn(pts, count, mode, &clip.bwRgn(), blitter);
+    } else {
+        const SkRegion* clipRgn = NULL;
+        SkIRect ir;
+        SkAAClipBlitterWrapper wrap;
+        if (!sk_hairline_bounds(pts, count, &ir) || !clip.quickContains(ir)) {
+            wrap.init(clip, blitter);
+            blitter = wrap.getBlitter();
+            clipRgn = &wrap.getRgn();
+        }
+        AntiHairLinesRgn(pts, count, mode, clipRgn, blitter);
+    }
+}
+
 void SkScan::AntiHairLine(const SkPoint& p0, const SkPoint& p1,
                           const SkRasterClip& clip, SkBlitter* blitter) {
     if (clip.isBW()) {
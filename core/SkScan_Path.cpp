@@ -15,6 +15,7 @@
 #include "SkRasterClip.h"
 #include "SkRegion.h"
 #include "SkTemplates.h"
+#include "SkTLS.h"
 #include "SkTSort.h"
 
 #ifdef SK_USE_LEGACY_AA_COVERAGE
@@ -424,6 +425,49 @@ static SkEdge* sort_edges(SkEdge* list[], int count, SkEdge** last) {
     return list[0];
 }
 
+// Each thread keeps an edge builder, so the edge memory of one path is reused by the next
+// instead of being allocated and freed for every draw.
+struct CachedEdgeBuilder {
+    CachedEdgeBuilder() : fInUse(false) {}
+
+    SkEdgeBuilder   fBuilder;
+    bool            fInUse;
+};
+
+static void* create_edge_builder() {
+    return SkNEW(CachedEdgeBuilder);
+}
+
+static void delete_edge_builder(void* cached) {
+    SkDELETE(static_cast<CachedEdgeBuilder*>(cached));
+}
+
+class SkAutoEdgeBuilder : SkNoncopyable {
+public:
+    SkAutoEdgeBuilder() {
+        fCached = static_cast<CachedEdgeBuilder*>(SkTLS::Get(create_edge_builder,
+                                                             delete_edge_builder));
+        // A blitter that fills another path while we walk ours gets a builder of its own.
+        if (fCached->fInUse) {
+            fCached = NULL;
+        } else {
+            fCached->fInUse = true;
+        }
+    }
+
+    ~SkAutoEdgeBuilder() {
+        if (fCached) {
+            fCached->fInUse = false;
+        }
+    }
+
+    SkEdgeBuilder* get() { return fCached ? &fCached->fBuilder : &fLocal; }
+
+private:
+    CachedEdgeBuilder*  fCached;
+    SkEdgeBuilder       fLocal;
+};
+
 // clipRect may be null, even though we always have a clip. This indicates that
 // the path is contained in the clip, and so we can ignore it during the blit
 //
@@ -434,7 +478,8 @@ void sk_fill_path(const SkPath& path, const SkIRect* clipRect, SkBlitter* blitte
                   const SkRegion& clipRgn) {
     SkASSERT(&path && blitter);
 
-    SkEdgeBuilder   builder;
+    SkAutoEdgeBuilder   autoBuilder;
+    SkEdgeBuilder&      builder = *autoBuilder.get();
 
     int count = builder.build(path, clipRect, shiftEdgesUp);
     SkEdge**    list = builder.edgeList();
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScratchArena.h"
+
+#include "SkTLS.h"
+
+static void* create_scratch_arena() {
+    return SkNEW(SkScratchArena);
+}
+
+static void delete_scratch_arena(void* arena) {
+    SkDELETE(static_cast<SkScratchArena*>(arena));
+}
+
+SkScratchArena* SkScratchArena::ThreadArena() {
+    return static_cast<SkScratchArena*>(SkTLS::Get(create_scratch_arena, delete_scratch_arena));
+}
+
+SkScratchArena::SkScratchArena()
+    : fCurrent(0)
+    , fUsed(0)
+    , fTotalSize(0)
+    , fUsers(0) {}
+
+SkScratchArena::~SkScratchArena() {
+    SkASSERT(0 == fUsers);
+    for (int i = 0; i < fBlocks.count(); ++i) {
+        sk_free(fBlocks[i].fStorage);
+    }
+}
+
+void* SkScratchArena::allocInNextBlock(size_t bytes) {
+    // The blocks after fCurrent are free; use the next one if it's large enough, else replace
+    // it with one that is.
+    int next = fCurrent < fBlocks.count() && fUsed > 0 ? fCurrent + 1 : fCurrent;
+    if (next < fBlocks.count() && bytes > fBlocks[next].fSize) {
+        fTotalSize -= fBlocks[next].fSize;
+        sk_free(fBlocks[next].fStorage);
+        fBlocks.remove(next);
+    }
+    if (next == fBlocks.count() || bytes > fBlocks[next].fSize) {
+        const size_t size = SkTMax<size_t>(bytes, kMinBlockSize);
+        Block* block = fBlocks.insert(next);
+        block->fStorage = sk_malloc_throw(size + 15);
+        block->fData = (char*) (((intptr_t) block->fStorage + 15) & ~(intptr_t) 15);
+        block->fSize = size;
+        fTotalSize += size;
+    }
+    fCurrent = next;
+    fUsed = bytes;
+    return fBlocks[next].fData;
+}
+
+void SkScratchArena::reset() {
+    while (fTotalSize > kMaxRetainedBytes && fBlocks.count() > 1) {
+        const int last = fBlocks.count() - 1;
+        fTotalSize -= fBlocks[last].fSize;
+        sk_free(fBlocks[last].fStorage);
+        fBlocks.remove(last);
+    }
+    fCurrent = 0;
+    fUsed = 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkScratchArena_DEFINED
+#define SkScratchArena_DEFINED
+
+#include "SkTDArray.h"
+#include "SkTypes.h"
+
+/**
+ *  A per-thread bump allocator for the objects a draw makes and throws away, such as blitters
+ *  and shader contexts that don't fit in the stack storage of their SkSmallAllocator. Its blocks
+ *  are kept from one draw to the next, so in the steady state those objects cost no malloc.
+ *
+ *  Users bracket their allocations with acquire() and release(). When the last user releases
+ *  it, at the end of the outermost draw, everything is freed at once; allocations made by
+ *  nested draws (e.g. a picture shader rasterizing its picture) are freed with the outer one.
+ */
+class SkScratchArena : SkNoncopyable {
+public:
+    /** Returns the arena of the calling thread, making it on first use. */
+    static SkScratchArena* ThreadArena();
+
+    void acquire() { ++fUsers; }
+
+    void release() {
+        SkASSERT(fUsers > 0);
+        if (0 == --fUsers) {
+            this->reset();
+        }
+    }
+
+    /** Returns bytes of storage aligned to 16 bytes. Only valid between acquire and release. */
+    void* alloc(size_t bytes) {
+        SkASSERT(fUsers > 0);
+        bytes = (bytes + 15) & ~(size_t) 15;
+        if (fCurrent < fBlocks.count() && bytes <= fBlocks[fCurrent].fSize - fUsed) {
+            void* ptr = fBlocks[fCurrent].fData + fUsed;
+            fUsed += bytes;
+            return ptr;
+        }
+        return this->allocInNextBlock(bytes);
+    }
+
+    SkScratchArena();
+    ~SkScratchArena();
+
+private:
+    enum {
+        kMinBlockSize = 4 * 1024,
+        // Past this, blocks left over from an unusually large draw are freed when it ends.
+        kMaxRetainedBytes = 256 * 1024
+    };
+
+    struct Block {
+        char*   fData;      // aligned to 16
+        size_t  fSize;
+        void*   fStorage;   // as returned by sk_malloc
+    };
+
+    void* allocInNextBlock(size_t bytes);
+    void reset();
+
+    SkTDArray<Block> fBlocks;
+    int              fCurrent;   // the block being allocated from
+    size_t           fUsed;      // bytes used of fBlocks[fCurrent]
+    size_t           fTotalSize;
+    int              fUsers;
+};
+
+#endif
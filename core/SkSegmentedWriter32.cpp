@@ -0,0 +1,114 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSegmentedWriter32.h"
+
+SkSegmentedWriter32::SkSegmentedWriter32(size_t minBlockSize)
+    : fUsed(0)
+    , fMinBlockSize(SkAlign4(SkTMax<size_t>(minBlockSize, 4))) {
+}
+
+SkSegmentedWriter32::~SkSegmentedWriter32() {
+    this->reset();
+}
+
+void SkSegmentedWriter32::reset() {
+    for (int i = 0; i < fBlocks.count(); ++i) {
+        sk_free(fBlocks[i].fData);
+    }
+    fBlocks.reset();
+    fUsed = 0;
+}
+
+uint32_t* SkSegmentedWriter32::growAndReserve(size_t size) {
+    // Grow the blocks with what has been written so far, keeping their number logarithmic and
+    // the space left unused at the end of each block small next to the total.
+    Block* block = fBlocks.append();
+    block->fCapacity = SkAlign4(SkTMax(size, SkTMax(fMinBlockSize, fUsed >> 1)));
+    block->fData = (char*)sk_malloc_throw(block->fCapacity);
+    block->fStart = fUsed;
+    block->fUsed = size;
+    fUsed += size;
+    return (uint32_t*)block->fData;
+}
+
+const SkSegmentedWriter32::Block& SkSegmentedWriter32::findBlock(size_t offset) const {
+    SkASSERT(!fBlocks.isEmpty());
+    // Most reads and overwrites patch something recent, so try the last block first.
+    int lo = fBlocks.count() - 1;
+    if (offset >= fBlocks[lo].fStart) {
+        return fBlocks[lo];
+    }
+    lo = 0;
+    int hi = fBlocks.count() - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) >> 1;
+        if (fBlocks[mid].fStart <= offset) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return fBlocks[lo];
+}
+
+void SkSegmentedWriter32::rewindToOffset(size_t offset) {
+    SkASSERT(SkAlign4(offset) == offset);
+    SkASSERT(offset <= fUsed);
+    while (!fBlocks.isEmpty() && fBlocks.top().fStart >= offset && fBlocks.top().fStart > 0) {
+        sk_free(fBlocks.top().fData);
+        fBlocks.pop();
+    }
+    if (!fBlocks.isEmpty()) {
+        Block& tail = fBlocks.top();
+        SkASSERT(offset >= tail.fStart && offset - tail.fStart <= tail.fUsed);
+        tail.fUsed = offset - tail.fStart;
+    }
+    fUsed = offset;
+}
+
+void SkSegmentedWriter32::writePad(const void* src, size_t size) {
+    if (0 == size) {
+        return;
+    }
+    size_t alignedSize = SkAlign4(size);
+    char* dst = (char*)this->reserve(alignedSize);
+    // Pad the last four bytes with zeroes in one step.
+    uint32_t* padding = (uint32_t*)(dst + (alignedSize - 4));
+    *padding = 0;
+    memcpy(dst, src, size);
+}
+
+void SkSegmentedWriter32::writeString(const char str[], size_t len) {
+    if (NULL == str) {
+        str = "";
+        len = 0;
+    }
+    if ((long)len < 0) {
+        len = strlen(str);
+    }
+
+    // [ 4 byte len ] [ str ... ] [1 - 4 \0s]
+    size_t alignedSize = SkAlign4(sizeof(uint32_t) + len + 1);
+    uint32_t* ptr = this->reserve(alignedSize);
+    ptr[alignedSize / 4 - 1] = 0;
+    *ptr = SkToU32(len);
+    char* chars = (char*)(ptr + 1);
+    memcpy(chars, str, len);
+    chars[len] = '\0';
+}
+
+SkData* SkSegmentedWriter32::snapshotAsData() const {
+    if (0 == fUsed) {
+        return SkData::NewEmpty();
+    }
+    char* buffer = (char*)sk_malloc_throw(fUsed);
+    for (int i = 0; i < fBlocks.count(); ++i) {
+        memcpy(buffer + fBlocks[i].fStart, fBlocks[i].fData, fBlocks[i].fUsed);
+    }
+    return SkData::NewFromMalloc(buffer, fUsed);
+}
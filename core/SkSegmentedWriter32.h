@@ -0,0 +1,184 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSegmentedWriter32_DEFINED
+#define SkSegmentedWriter32_DEFINED
+
+#include "SkData.h"
+#include "SkMatrix.h"
+#include "SkPoint.h"
+#include "SkRRect.h"
+#include "SkRect.h"
+#include "SkRegion.h"
+#include "SkTDArray.h"
+
+/**
+ *  A writer with the same interface as SkWriter32, that keeps what it writes in a list of
+ *  blocks instead of one buffer it reallocates as it grows. Growing never copies what was
+ *  already written, so recording tens of megabytes costs one copy at the end, in
+ *  snapshotAsData(), rather than one per reallocation, and never holds the old and the new
+ *  buffer at once while growing.
+ *
+ *  Blocks grow with the amount written, so there are only a few of them, and a single
+ *  reserve() is always contiguous. Reads and overwrites at earlier offsets (for patching
+ *  restore offsets and the like) work across blocks, as long as the value read doesn't
+ *  straddle two reserve() calls.
+ */
+class SkSegmentedWriter32 : SkNoncopyable {
+public:
+    enum {
+        kDefaultMinBlockSize = 16 * 1024,
+    };
+
+    explicit SkSegmentedWriter32(size_t minBlockSize = kDefaultMinBlockSize);
+    ~SkSegmentedWriter32();
+
+    // return the current offset (will always be a multiple of 4)
+    size_t bytesWritten() const { return fUsed; }
+
+    // DEPRECATED: use bytesWritten instead
+    size_t size() const { return this->bytesWritten(); }
+
+    /** Frees all the blocks. */
+    void reset();
+
+    /** Returns a contiguous space for size bytes, which must be a multiple of 4. */
+    uint32_t* reserve(size_t size) {
+        SkASSERT(SkAlign4(size) == size);
+        Block* tail = fBlocks.isEmpty() ? NULL : &fBlocks.top();
+        if (NULL != tail && tail->fUsed + size <= tail->fCapacity) {
+            uint32_t* p = (uint32_t*)(tail->fData + tail->fUsed);
+            tail->fUsed += size;
+            fUsed += size;
+            return p;
+        }
+        return this->growAndReserve(size);
+    }
+
+    /** Reads a T previously written at offset. The T must not straddle two reserve()s. */
+    template<typename T>
+    const T& readTAt(size_t offset) const {
+        SkASSERT(SkAlign4(offset) == offset);
+        SkASSERT(offset < fUsed);
+        const Block& block = this->findBlock(offset);
+        SkASSERT(offset - block.fStart + sizeof(T) <= block.fUsed);
+        return *(const T*)(block.fData + (offset - block.fStart));
+    }
+
+    /** Overwrites a T previously written at offset. The T must not straddle two reserve()s. */
+    template<typename T>
+    void overwriteTAt(size_t offset, const T& value) {
+        SkASSERT(SkAlign4(offset) == offset);
+        SkASSERT(offset < fUsed);
+        const Block& block = this->findBlock(offset);
+        SkASSERT(offset - block.fStart + sizeof(T) <= block.fUsed);
+        *(T*)(block.fData + (offset - block.fStart)) = value;
+    }
+
+    /** Throws away everything written after offset, freeing any blocks that leaves empty. */
+    void rewindToOffset(size_t offset);
+
+    bool writeBool(bool value) {
+        this->write32(value);
+        return value;
+    }
+
+    void writeInt(int32_t value) {
+        this->write32(value);
+    }
+
+    void write8(int32_t value) {
+        *(int32_t*)this->reserve(sizeof(value)) = value & 0xFF;
+    }
+
+    void write16(int32_t value) {
+        *(int32_t*)this->reserve(sizeof(value)) = value & 0xFFFF;
+    }
+
+    void write32(int32_t value) {
+        *(int32_t*)this->reserve(sizeof(value)) = value;
+    }
+
+    void writePtr(void* value) {
+        *(void**)this->reserve(sizeof(value)) = value;
+    }
+
+    void writeScalar(SkScalar value) {
+        *(SkScalar*)this->reserve(sizeof(value)) = value;
+    }
+
+    void writePoint(const SkPoint& pt) {
+        *(SkPoint*)this->reserve(sizeof(pt)) = pt;
+    }
+
+    void writeRect(const SkRect& rect) {
+        *(SkRect*)this->reserve(sizeof(rect)) = rect;
+    }
+
+    void writeIRect(const SkIRect& rect) {
+        *(SkIRect*)this->reserve(sizeof(rect)) = rect;
+    }
+
+    void writeRRect(const SkRRect& rrect) {
+        rrect.writeToMemory(this->reserve(SkRRect::kSizeInMemory));
+    }
+
+    void writeMatrix(const SkMatrix& matrix) {
+        size_t size = matrix.writeToMemory(NULL);
+        SkASSERT(SkAlign4(size) == size);
+        matrix.writeToMemory(this->reserve(size));
+    }
+
+    void writeRegion(const SkRegion& rgn) {
+        size_t size = rgn.writeToMemory(NULL);
+        SkASSERT(SkAlign4(size) == size);
+        rgn.writeToMemory(this->reserve(size));
+    }
+
+    /** Writes size bytes, which must be a multiple of 4. */
+    void write(const void* values, size_t size) {
+        SkASSERT(SkAlign4(size) == size);
+        memcpy(this->reserve(size), values, size);
+    }
+
+    /** Same as write(). */
+    void writeMul4(const void* values, size_t size) {
+        this->write(values, size);
+    }
+
+    /** Writes size bytes, padded with zeros to a multiple of 4. */
+    void writePad(const void* src, size_t size);
+
+    /**
+     *  Writes a string the way SkWriter32::writeString() does, so that SkReader32::readString()
+     *  can read it back. If len is (size_t)-1, strlen() is used.
+     */
+    void writeString(const char* str, size_t len = (size_t)-1);
+
+    /**
+     *  Returns a copy of everything written as one contiguous SkData, reffed for the caller.
+     *  The writer is left as it was.
+     */
+    SkData* snapshotAsData() const;
+
+private:
+    struct Block {
+        char*   fData;
+        size_t  fStart;     // the offset of fData[0]
+        size_t  fUsed;
+        size_t  fCapacity;
+    };
+
+    uint32_t* growAndReserve(size_t size);
+    const Block& findBlock(size_t offset) const;
+
+    SkTDArray<Block>    fBlocks;
+    size_t              fUsed;
+    size_t              fMinBlockSize;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #ifndef SkSmallAllocator_DEFINED
 #define SkSmallAllocator_DEFINED
 
+#include "SkScratchArena.h"
 #include "SkTDArray.h"
 #include "SkTypes.h"
 
@@ -24,9 +25,11 @@ template<typename T> void destroyT(void* ptr) {
  *  with this class will assert and return NULL.
  *  kTotalBytes is the total number of bytes provided for storage for all
  *  objects created by this allocator. If an object to be created is larger
- *  than the storage (minus storage already used), it will be allocated on the
- *  heap. This class's destructor will handle calling the destructor for each
- *  object it allocated and freeing its memory.
+ *  than the storage (minus storage already used), it will be allocated from
+ *  the thread's SkScratchArena, which is reset when the outermost allocator
+ *  using it goes away, so allocators must be destroyed on the thread that
+ *  used them. This class's destructor will handle calling the destructor for
+ *  each object it allocated and freeing its memory.
  */
 template<uint32_t kMaxObjects, size_t kTotalBytes>
 class SkSmallAllocator : SkNoncopyable {
@@ -34,6 +37,7 @@ public:
     SkSmallAllocator()
     : fStorageUsed(0)
     , fNumObjects(0)
+    , fArena(NULL)
     {}
 
     ~SkSmallAllocator() {
@@ -43,9 +47,9 @@ public:
             fNumObjects--;
             Rec* rec = &fRecs[fNumObjects];
             rec->fKillProc(rec->fObj);
-            // Safe to do if fObj is in fStorage, since fHeapStorage will
-            // point to NULL.
-            sk_free(rec->fHeapStorage);
+        }
+        if (NULL != fArena) {
+            fArena->release();
         }
     }
 
@@ -108,9 +112,8 @@ public:
 
     /*
      *  Reserve a specified amount of space (must be enough space for one T).
-     *  The space will be in fStorage if there is room, or on the heap otherwise.
-     *  Either way, this class will call ~T() in its destructor and free the heap
-     *  allocation if necessary.
+     *  The space will be in fStorage if there is room, or in the scratch arena
+     *  otherwise. Either way, this class will call ~T() in its destructor.
      *  Unlike createT(), this method will not call the constructor of T.
      */
     template<typename T> void* reserveT(size_t storageRequired = sizeof(T)) {
@@ -123,17 +126,17 @@ public:
         storageRequired = SkAlign4(storageRequired);
         Rec* rec = &fRecs[fNumObjects];
         if (storageRequired > storageRemaining) {
-            // Allocate on the heap. Ideally we want to avoid this situation,
-            // but we're not sure we can catch all callers, so handle it but
-            // assert false in debug mode.
-            SkASSERT(false);
+            // Large states, e.g. of compose and picture shaders, go to the
+            // thread's arena, which keeps its memory from draw to draw.
+            if (NULL == fArena) {
+                fArena = SkScratchArena::ThreadArena();
+                fArena->acquire();
+            }
             rec->fStorageSize = 0;
-            rec->fHeapStorage = sk_malloc_throw(storageRequired);
-            rec->fObj = static_cast<void*>(rec->fHeapStorage);
+            rec->fObj = fArena->alloc(storageRequired);
         } else {
             // There is space in fStorage.
             rec->fStorageSize = storageRequired;
-            rec->fHeapStorage = NULL;
             SkASSERT(SkIsAlign4(fStorageUsed));
             rec->fObj = static_cast<void*>(fStorage + (fStorageUsed / 4));
             fStorageUsed += storageRequired;
@@ -146,12 +149,12 @@ public:
     /*
      *  Free the memory reserved last without calling the destructor.
      *  Can be used in a nested way, i.e. after reserving A and B, calling
-     *  freeLast once will free B and calling it again will free A.
+     *  freeLast once will free B and calling it again will free A. Memory in
+     *  the scratch arena is only reclaimed when the arena is reset.
      */
     void freeLast() {
         SkASSERT(fNumObjects > 0);
         Rec* rec = &fRecs[fNumObjects - 1];
-        sk_free(rec->fHeapStorage);
         fStorageUsed -= rec->fStorageSize;
 
         fNumObjects--;
@@ -159,9 +162,8 @@ public:
 
 private:
     struct Rec {
-        size_t fStorageSize;  // 0 if allocated on heap
+        size_t fStorageSize;  // 0 if allocated in the scratch arena
         void*  fObj;
-        void*  fHeapStorage;
         void   (*fKillProc)(void*);
     };
 
@@ -171,6 +173,8 @@ private:
     uint32_t            fStorage[SkAlign4(kTotalBytes) >> 2];
     uint32_t            fNumObjects;
     Rec                 fRecs[kMaxObjects];
+    // Set once an object doesn't fit in fStorage.
+    SkScratchArena*     fArena;
 };
 
 #endif // SkSmallAllocator_DEFINED
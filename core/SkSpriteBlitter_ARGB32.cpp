@@ -11,6 +11,7 @@
 #include "SkBlitRow.h"
 #include "SkColorFilter.h"
 #include "SkColorPriv.h"
+#include "SkSpriteBlitter_opts.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 #include "SkXfermode.h"
@@ -19,19 +20,24 @@
 
 class Sprite_D32_S32 : public SkSpriteBlitter {
 public:
-    Sprite_D32_S32(const SkBitmap& src, U8CPU alpha)  : INHERITED(src) {
+    // With copy set the source replaces the destination (an opaque source with
+    // SrcOver, or any source with Src), whatever its alpha.
+    Sprite_D32_S32(const SkBitmap& src, U8CPU alpha, bool copy = false)  : INHERITED(src) {
         SkASSERT(src.colorType() == kN32_SkColorType);
 
         unsigned flags32 = 0;
         if (255 != alpha) {
             flags32 |= SkBlitRow::kGlobalAlpha_Flag32;
         }
-        if (!src.isOpaque()) {
+        if (!src.isOpaque() && !copy) {
             flags32 |= SkBlitRow::kSrcPixelAlpha_Flag32;
         }
+        SkASSERT(!copy || 255 == alpha);
 
         fProc32 = SkBlitRow::Factory32(flags32);
         fAlpha = alpha;
+        fCopy = 0 == flags32;
+        fStreamingCopy = fCopy ? SkSpriteBlitterGetPlatformStreamingCopy32Proc() : NULL;
     }
 
     virtual void blitRect(int x, int y, int width, int height) {
@@ -41,6 +47,12 @@ public:
                                                              y - fTop);
         size_t dstRB = fDevice->rowBytes();
         size_t srcRB = fSource->rowBytes();
+
+        if (fCopy) {
+            this->copyRect(dst, dstRB, src, srcRB, width, height);
+            return;
+        }
+
         SkBlitRow::Proc32 proc = fProc32;
         U8CPU             alpha = fAlpha;
 
@@ -52,8 +64,39 @@ public:
     }
 
 private:
-    SkBlitRow::Proc32   fProc32;
-    U8CPU               fAlpha;
+    void copyRect(uint32_t* SK_RESTRICT dst, size_t dstRB,
+                  const uint32_t* SK_RESTRICT src, size_t srcRB,
+                  int width, int height) const {
+        const size_t rowBytes = width * sizeof(uint32_t);
+        const size_t totalBytes = rowBytes * height;
+        // Full-width blits between tightly packed bitmaps are one contiguous run.
+        if (dstRB == rowBytes && srcRB == rowBytes) {
+            width *= height;
+            height = 1;
+        }
+
+        // Blits too big to stay in the cache (full-screen backgrounds) write around it.
+        SkStreamingCopy32Proc stream = fStreamingCopy;
+        if (NULL != stream && totalBytes >= SK_SPRITE_STREAMING_COPY_BYTES) {
+            do {
+                stream(dst, src, width);
+                dst = (uint32_t* SK_RESTRICT)((char*)dst + dstRB);
+                src = (const uint32_t* SK_RESTRICT)((const char*)src + srcRB);
+            } while (--height != 0);
+            return;
+        }
+
+        do {
+            memcpy(dst, src, width * sizeof(uint32_t));
+            dst = (uint32_t* SK_RESTRICT)((char*)dst + dstRB);
+            src = (const uint32_t* SK_RESTRICT)((const char*)src + srcRB);
+        } while (--height != 0);
+    }
+
+    SkBlitRow::Proc32       fProc32;
+    U8CPU                   fAlpha;
+    bool                    fCopy;
+    SkStreamingCopy32Proc   fStreamingCopy;
 
     typedef SkSpriteBlitter INHERITED;
 };
@@ -290,7 +333,15 @@ SkSpriteBlitter* SkSpriteBlitter::ChooseD32(const SkBitmap& source, const SkPain
             }
             break;
         case kN32_SkColorType:
-            if (xfermode || filter) {
+            // An explicit SrcOver is the same as none.
+            if (SkXfermode::IsMode(xfermode, SkXfermode::kSrcOver_Mode)) {
+                xfermode = NULL;
+            }
+            if (NULL == filter && 255 == alpha &&
+                SkXfermode::IsMode(xfermode, SkXfermode::kSrc_Mode)) {
+                // Src replaces the destination with the source, alpha and all.
+                blitter = allocator->createT<Sprite_D32_S32>(source, alpha, true);
+            } else if (xfermode || filter) {
                 if (255 == alpha) {
                     // this can handle xfermode or filter, but not alpha
                     blitter = allocator->createT<Sprite_D32_S32A_XferFilter>(source, paint);
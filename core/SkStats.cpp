@@ -0,0 +1,107 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkStats.h"
+
+#include "SkThread.h"
+#include "SkTLS.h"
+
+namespace {
+
+struct ThreadCounters {
+    int64_t fValues[SkStats::kCounterCount];
+    int     fAddsSinceFlush;
+};
+
+}  // namespace
+
+SK_DECLARE_STATIC_MUTEX(gStatsMutex);
+static int64_t gTotals[SkStats::kCounterCount];
+
+static void flush_counters(ThreadCounters* counters) {
+    SkAutoMutexAcquire ac(gStatsMutex);
+    for (int i = 0; i < SkStats::kCounterCount; ++i) {
+        gTotals[i] += counters->fValues[i];
+    }
+    sk_bzero(counters, sizeof(ThreadCounters));
+}
+
+static void* create_counters() {
+    ThreadCounters* counters = SkNEW(ThreadCounters);
+    sk_bzero(counters, sizeof(ThreadCounters));
+    return counters;
+}
+
+static void delete_counters(void* ptr) {
+    ThreadCounters* counters = static_cast<ThreadCounters*>(ptr);
+    flush_counters(counters);
+    SkDELETE(counters);
+}
+
+static ThreadCounters* get_counters() {
+    return static_cast<ThreadCounters*>(SkTLS::Get(create_counters, delete_counters));
+}
+
+void SkStats::Add(Counter counter, int64_t n) {
+    SkASSERT((unsigned)counter < (unsigned)kCounterCount);
+    ThreadCounters* counters = get_counters();
+    counters->fValues[counter] += n;
+    if (++counters->fAddsSinceFlush >= kFlushInterval) {
+        flush_counters(counters);
+    }
+}
+
+void SkStats::FlushThread() {
+    // Don't create counters for a thread that never added any.
+    void* counters = SkTLS::Find(create_counters);
+    if (NULL != counters) {
+        flush_counters(static_cast<ThreadCounters*>(counters));
+    }
+}
+
+void SkStats::Snapshot(int64_t values[kCounterCount]) {
+    FlushThread();
+    SkAutoMutexAcquire ac(gStatsMutex);
+    memcpy(values, gTotals, sizeof(gTotals));
+}
+
+void SkStats::Reset() {
+    void* counters = SkTLS::Find(create_counters);
+    if (NULL != counters) {
+        sk_bzero(counters, sizeof(ThreadCounters));
+    }
+    SkAutoMutexAcquire ac(gStatsMutex);
+    sk_bzero(gTotals, sizeof(gTotals));
+}
+
+const char* SkStats::Name(Counter counter) {
+    static const char* gNames[] = {
+        "canvas.drawPaint",
+        "canvas.drawPoints",
+        "canvas.drawRect",
+        "canvas.drawOval",
+        "canvas.drawRRect",
+        "canvas.drawPath",
+        "canvas.drawBitmap",
+        "canvas.drawSprite",
+        "canvas.drawText",
+        "canvas.drawVertices",
+        "canvas.drawPicture",
+        "glyphcache.hit",
+        "glyphcache.miss",
+        "glyphcache.glyphMiss",
+        "scaledimagecache.hit",
+        "scaledimagecache.miss",
+        "gpu.resourcecache.purge",
+        "gpu.programSwitch",
+        "gpu.textureUpload",
+        "gpu.textureUploadBytes",
+    };
+    SK_COMPILE_ASSERT(SK_ARRAY_COUNT(gNames) == SkStats::kCounterCount, names_mismatch);
+    SkASSERT((unsigned)counter < (unsigned)kCounterCount);
+    return gNames[counter];
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStats_DEFINED
+#define SkStats_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  A registry of process-wide counters for hot paths: how many draws of each
+ *  kind a canvas issued, how often the glyph and image caches missed, how many
+ *  bytes were uploaded to the GPU. Unlike SkTraceEvent spans these are just
+ *  running totals, cheap enough to leave on and read out periodically.
+ *
+ *  Each thread adds into its own counters (see SkTLS), which are folded into
+ *  the global totals every kFlushInterval adds, when the thread exits, or when
+ *  it calls FlushThread(). So a snapshot always includes the calling thread's
+ *  counts, but may miss fewer than kFlushInterval recent adds on each other
+ *  thread.
+ *
+ *  The instrumentation compiles away unless SK_ENABLE_STATS is defined; use
+ *  SK_STATS_INC/SK_STATS_ADD at the call sites rather than calling Add().
+ */
+class SkStats {
+public:
+    enum Counter {
+        kCanvasDrawPaint_Counter,
+        kCanvasDrawPoints_Counter,
+        kCanvasDrawRect_Counter,
+        kCanvasDrawOval_Counter,
+        kCanvasDrawRRect_Counter,
+        kCanvasDrawPath_Counter,
+        kCanvasDrawBitmap_Counter,      // all of the drawBitmap variants
+        kCanvasDrawSprite_Counter,
+        kCanvasDrawText_Counter,        // all of the drawText variants
+        kCanvasDrawVertices_Counter,
+        kCanvasDrawPicture_Counter,
+
+        kGlyphCacheHit_Counter,         // found a strike for the descriptor
+        kGlyphCacheMiss_Counter,        // had to create a strike
+        kGlyphMiss_Counter,             // had to measure a glyph not yet in its strike
+        kScaledImageCacheHit_Counter,
+        kScaledImageCacheMiss_Counter,
+
+        kGrResourceCachePurge_Counter,  // resources deleted to stay within budget
+        kGrProgramSwitch_Counter,       // glUseProgram calls
+        kGrTextureUpload_Counter,
+        kGrTextureUploadBytes_Counter,
+
+        kLast_Counter = kGrTextureUploadBytes_Counter
+    };
+    static const int kCounterCount = kLast_Counter + 1;
+
+    enum {
+        kFlushInterval = 1024
+    };
+
+    /** Adds n to the calling thread's copy of the counter. */
+    static void Add(Counter, int64_t n);
+
+    /** Folds the calling thread's counts into the global totals. */
+    static void FlushThread();
+
+    /** Fills values[] with the current totals, indexed by Counter. */
+    static void Snapshot(int64_t values[kCounterCount]);
+
+    /** Zeroes the global totals and the calling thread's counts. */
+    static void Reset();
+
+    /** A stable name for the counter, e.g. "canvas.drawRect", for exporting. */
+    static const char* Name(Counter);
+};
+
+#ifdef SK_ENABLE_STATS
+    #define SK_STATS_ADD(counter, n)    SkStats::Add(SkStats::counter, n)
+#else
+    #define SK_STATS_ADD(counter, n)    do {} while (false)
+#endif
+
+#define SK_STATS_INC(counter)           SK_STATS_ADD(counter, 1)
+
+#endif
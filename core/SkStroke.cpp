@@ -70,7 +70,7 @@ static bool set_normal_unitnormal(const SkVector& vec,
 
 class SkPathStroker {
 public:
-    SkPathStroker(const SkPath& src,
+    SkPathStroker(int srcPointCount,
                   SkScalar radius, SkScalar miterLimit, SkPaint::Cap cap,
                   SkPaint::Join join);
 
@@ -80,6 +80,17 @@ public:
     void cubicTo(const SkPoint&, const SkPoint&, const SkPoint&);
     void close(bool isLine) { this->finishContour(true, isLine); }
 
+    // Replace the start and/or end caps of the open contours with butt caps.
+    void setButtEnds(bool buttStart, bool buttEnd) {
+        SkStrokerPriv::CapProc butt = SkStrokerPriv::CapFactory(SkPaint::kButt_Cap);
+        if (buttStart) {
+            fStartCapper = butt;
+        }
+        if (buttEnd) {
+            fEndCapper = butt;
+        }
+    }
+
     void done(SkPath* dst, bool isLine) {
         this->finishContour(false, isLine);
         fOuter.addPath(fExtra);
@@ -96,7 +107,7 @@ private:
     int         fSegmentCount;
     bool        fPrevIsLine;
 
-    SkStrokerPriv::CapProc  fCapper;
+    SkStrokerPriv::CapProc  fStartCapper, fEndCapper;
     SkStrokerPriv::JoinProc fJoiner;
 
     SkPath  fInner, fOuter; // outer is our working answer, inner is temp
@@ -170,11 +181,11 @@ void SkPathStroker::finishContour(bool close, bool currIsLine) {
         } else {    // add caps to start and end
             // cap the end
             fInner.getLastPt(&pt);
-            fCapper(&fOuter, fPrevPt, fPrevNormal, pt,
+            fEndCapper(&fOuter, fPrevPt, fPrevNormal, pt,
                     currIsLine ? &fInner : NULL);
             fOuter.reversePathTo(fInner);
             // cap the start
-            fCapper(&fOuter, fFirstPt, -fFirstNormal, fFirstOuterPt,
+            fStartCapper(&fOuter, fFirstPt, -fFirstNormal, fFirstOuterPt,
                     fPrevIsLine ? &fInner : NULL);
             fOuter.close();
         }
@@ -187,7 +198,7 @@ void SkPathStroker::finishContour(bool close, bool currIsLine) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SkPathStroker::SkPathStroker(const SkPath& src,
+SkPathStroker::SkPathStroker(int srcPointCount,
                              SkScalar radius, SkScalar miterLimit,
                              SkPaint::Cap cap, SkPaint::Join join)
         : fRadius(radius) {
@@ -204,7 +215,7 @@ SkPathStroker::SkPathStroker(const SkPath& src,
             fInvMiterLimit = SkScalarInvert(miterLimit);
         }
     }
-    fCapper = SkStrokerPriv::CapFactory(cap);
+    fStartCapper = fEndCapper = SkStrokerPriv::CapFactory(cap);
     fJoiner = SkStrokerPriv::JoinFactory(join);
     fSegmentCount = -1;
     fPrevIsLine = false;
@@ -215,8 +226,8 @@ SkPathStroker::SkPathStroker(const SkPath& src,
     //
     // 3x for result == inner + outer + join (swag)
     // 1x for inner == 'wag' (worst contour length would be better guess)
-    fOuter.incReserve(src.countPoints() * 3);
-    fInner.incReserve(src.countPoints());
+    fOuter.incReserve(srcPointCount * 3);
+    fInner.incReserve(srcPointCount);
 }
 
 void SkPathStroker::moveTo(const SkPoint& pt) {
@@ -574,7 +585,7 @@ void SkStroke::strokePath(const SkPath& src, SkPath* dst) const {
     SkAutoConicToQuads converter;
     const SkScalar conicTol = SK_Scalar1 / 4;
 
-    SkPathStroker   stroker(src, radius, fMiterLimit, this->getCap(),
+    SkPathStroker   stroker(src.countPoints(), radius, fMiterLimit, this->getCap(),
                             this->getJoin());
     SkPath::Iter    iter(src, false);
     SkPath::Verb    lastSegment = SkPath::kMove_Verb;
@@ -653,6 +664,26 @@ DONE:
     }
 }
 
+void SkStroke::strokePolyline(const SkPoint pts[], int count, bool capStart,
+                              bool capEnd, SkPath* dst) const {
+    SkASSERT(dst != NULL);
+    dst->reset();
+
+    SkScalar radius = SkScalarHalf(fWidth);
+    if (radius <= 0 || count < 2) {
+        return;
+    }
+
+    SkPathStroker stroker(count, radius, fMiterLimit, this->getCap(),
+                          this->getJoin());
+    stroker.setButtEnds(!capStart, !capEnd);
+    stroker.moveTo(pts[0]);
+    for (int i = 1; i < count; ++i) {
+        stroker.lineTo(pts[i]);
+    }
+    stroker.done(dst, true);
+}
+
 static SkPath::Direction reverse_direction(SkPath::Direction dir) {
     SkASSERT(SkPath::kUnknown_Direction != dir);
     return SkPath::kCW_Direction == dir ? SkPath::kCCW_Direction : SkPath::kCW_Direction;
@@ -43,6 +43,16 @@ public:
                        SkPath::Direction = SkPath::kCW_Direction) const;
     void    strokePath(const SkPath& path, SkPath*) const;
 
+    /**
+     *  Stroke the open polyline pts[0..count) into dst, as strokePath() would
+     *  stroke it as a single contour, except that an end whose cap flag is
+     *  false gets a butt cap whatever getCap() says. This lets a long polyline
+     *  be stroked in overlapping pieces (see SkParallelStroke) whose inner
+     *  ends are hidden by their neighbours.
+     */
+    void    strokePolyline(const SkPoint pts[], int count, bool capStart,
+                           bool capEnd, SkPath* dst) const;
+
     ////////////////////////////////////////////////////////////////
 
 private:
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTextRun.h"
+
+#include "SkCanvas.h"
+#include "SkThread.h"
+
+static uint32_t next_text_run_id() {
+    static int32_t gNextID = 0;
+    // Never hand out 0, so clients can use it to mean "no run".
+    return sk_atomic_inc(&gNextID) + 1;
+}
+
+SkTextRun::SkTextRun(int count, const SkPaint& paint)
+    : fCount(count)
+    , fGlyphs(count)
+    , fPos(count)
+    , fPaint(paint)
+    , fUniqueID(next_text_run_id()) {
+    fPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+}
+
+SkTextRun* SkTextRun::Create(const void* text, size_t byteLength, const SkPoint pos[],
+                             const SkPaint& paint) {
+    const int count = paint.countText(text, byteLength);
+    if (count <= 0) {
+        return NULL;
+    }
+
+    SkTextRun* run = SkNEW_ARGS(SkTextRun, (count, paint));
+    SkAssertResult(paint.textToGlyphs(text, byteLength, run->fGlyphs.get()) == count);
+    memcpy(run->fPos.get(), pos, count * sizeof(SkPoint));
+
+    // Vertical text is positioned differently than getTextWidths() measures it.
+    if (paint.isVerticalText()) {
+        run->fBounds = SkRect::MakeLargest();
+        return run;
+    }
+
+    SkAutoSTMalloc<64, SkScalar> widths(count);
+    SkAutoSTMalloc<64, SkRect> glyphBounds(count);
+    run->fPaint.getTextWidths(run->fGlyphs.get(), count * sizeof(uint16_t),
+                              widths.get(), glyphBounds.get());
+
+    // drawPosText() aligns each glyph to its own position.
+    SkScalar alignScale = 0;
+    if (SkPaint::kCenter_Align == paint.getTextAlign()) {
+        alignScale = -SK_ScalarHalf;
+    } else if (SkPaint::kRight_Align == paint.getTextAlign()) {
+        alignScale = -SK_Scalar1;
+    }
+
+    run->fBounds.setEmpty();
+    for (int i = 0; i < count; ++i) {
+        SkRect r = glyphBounds[i];
+        if (r.isEmpty()) {
+            continue;
+        }
+        r.offset(pos[i].fX + widths[i] * alignScale, pos[i].fY);
+        run->fBounds.join(r);
+    }
+    return run;
+}
+
+void SkTextRun::draw(SkCanvas* canvas) const {
+    canvas->drawPosText(fGlyphs.get(), fCount * sizeof(uint16_t), fPos.get(), fPaint);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextRun_DEFINED
+#define SkTextRun_DEFINED
+
+#include "SkPaint.h"
+#include "SkPoint.h"
+#include "SkRect.h"
+#include "SkRefCnt.h"
+#include "SkTemplates.h"
+
+class SkCanvas;
+
+/**
+ *  An immutable, positioned run of glyphs together with the paint it's drawn
+ *  with. Text that doesn't change from frame to frame can be built into a run
+ *  once and then recorded by reference (see SkRecorder::drawTextRun()) instead
+ *  of having its glyphs, positions and paint copied into every recording.
+ *
+ *  The run's bounds are computed once, from the glyphs' own bounds, so they're
+ *  much tighter than the guesses made for plain positioned text.
+ */
+class SkTextRun : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(SkTextRun)
+
+    /**
+     *  Returns a new run for drawPosText(text, byteLength, pos, paint). The
+     *  text is converted to glyph IDs, so the run's paint always uses
+     *  kGlyphID_TextEncoding. Returns NULL if the text has no glyphs.
+     */
+    static SkTextRun* Create(const void* text, size_t byteLength, const SkPoint pos[],
+                             const SkPaint& paint);
+
+    int count() const { return fCount; }
+    const uint16_t* glyphs() const { return fGlyphs.get(); }
+    const SkPoint* pos() const { return fPos.get(); }
+    const SkPaint& paint() const { return fPaint; }
+
+    /** Where the glyphs' ink lands, before any stroke, path effect or mask
+        filter in the paint. SkRect::MakeLargest() if that can't be known.
+    */
+    const SkRect& bounds() const { return fBounds; }
+
+    /** Unique among all runs, for clients that cache data derived from one. */
+    uint32_t uniqueID() const { return fUniqueID; }
+
+    /** Draws the run, exactly as drawPosText() with the original arguments. */
+    void draw(SkCanvas*) const;
+
+private:
+    SkTextRun(int count, const SkPaint& paint);
+
+    const int                fCount;
+    SkAutoTMalloc<uint16_t>  fGlyphs;
+    SkAutoTMalloc<SkPoint>   fPos;
+    SkPaint                  fPaint;
+    SkRect                   fBounds;
+    const uint32_t           fUniqueID;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
@@ -8,23 +8,98 @@
 
 #include "SkTileGrid.h"
 
+#include <math.h>
+
 SkTileGrid::SkTileGrid(int xTileCount, int yTileCount, const SkTileGridFactory::TileGridInfo& info,
                        SkTileGridNextDatumFunctionPtr nextDatumFunction) {
-    fXTileCount = xTileCount;
-    fYTileCount = yTileCount;
     fInfo = info;
     // Margin is offset by 1 as a provision for AA and
     // to cancel-out the outset applied by getClipDeviceBounds.
     fInfo.fMargin.fHeight++;
     fInfo.fMargin.fWidth++;
-    fTileCount = fXTileCount * fYTileCount;
     fInsertionCount = 0;
+    fNextDatumFunction = nextDatumFunction;
+    fAdaptiveTarget = 0;
+    fAdaptiveSize.setEmpty();
+    fTileData = NULL;
+    this->allocateTiles(xTileCount, yTileCount);
+}
+
+SkTileGrid* SkTileGrid::CreateAdaptive(int width, int height,
+                                       const SkTileGridFactory::TileGridInfo& info,
+                                       SkTileGridNextDatumFunctionPtr nextDatumFunction,
+                                       int targetPerTile) {
+    SkASSERT(width > 0 && height > 0 && targetPerTile > 0);
+    // Start with one big tile, in case anything needs the grid before its tiles are chosen.
+    SkTileGridFactory::TileGridInfo adaptiveInfo = info;
+    adaptiveInfo.fTileInterval.set(width, height);
+    SkTileGrid* grid = SkNEW_ARGS(SkTileGrid, (1, 1, adaptiveInfo, nextDatumFunction));
+    grid->fAdaptiveTarget = targetPerTile;
+    grid->fAdaptiveSize.set(width, height);
+    return grid;
+}
+
+void SkTileGrid::allocateTiles(int xTileCount, int yTileCount) {
+    SkDELETE_ARRAY(fTileData);
+    fXTileCount = xTileCount;
+    fYTileCount = yTileCount;
+    fTileCount = fXTileCount * fYTileCount;
     fGridBounds = SkIRect::MakeXYWH(0, 0, fInfo.fTileInterval.width() * fXTileCount,
         fInfo.fTileInterval.height() * fYTileCount);
-    fNextDatumFunction = nextDatumFunction;
     fTileData = SkNEW_ARRAY(SkTDArray<void *>, fTileCount);
 }
 
+// Each element lands in every tile its dilated bounds touch.  An element w x h lands in about
+// (w + s)(h + s) / s^2 tiles of size s x s, and there are about W * H / s^2 tiles.  So on average a
+// tile holds sum((w + s)(h + s)) / (W * H) elements, a quadratic in s we can solve for the target.
+// We estimate the sums from a sample of the deferred inserts.
+void SkTileGrid::chooseAdaptiveTiles() {
+    SkASSERT(fAdaptiveTarget > 0);
+    const int width = fAdaptiveSize.width();
+    const int height = fAdaptiveSize.height();
+    const SkIRect clip = SkIRect::MakeWH(width, height);
+
+    static const int kMaxSamples = 1024;
+    const int stride = SkMax32(1, fDeferred.count() / kMaxSamples);
+    int visited = 0;
+    double samples = 0, sumWidthHeight = 0, sumArea = 0;
+    for (int i = 0; i < fDeferred.count(); i += stride) {
+        visited++;
+        SkIRect bounds = fDeferred[i].fBounds;
+        bounds.outset(fInfo.fMargin.width(), fInfo.fMargin.height());
+        bounds.offset(fInfo.fOffset);
+        if (!bounds.intersect(clip)) {
+            continue;
+        }
+        samples += 1;
+        sumWidthHeight += (double)bounds.width() + bounds.height();
+        sumArea += (double)bounds.width() * bounds.height();
+    }
+
+    // With nothing inside the grid, one tile will do.
+    double size = SkMax32(width, height);
+    if (samples > 0) {
+        // Over the sample, solve samples*s^2 + sumWidthHeight*s + sumArea = wanted for s.
+        const double wanted =
+                (double)fAdaptiveTarget * width * height * visited / fDeferred.count();
+        size = 0;
+        const double c = sumArea - wanted;
+        if (c < 0) {
+            const double b = sumWidthHeight;
+            size = (-b + sqrt(b * b - 4 * samples * c)) / (2 * samples);
+        }
+    }
+
+    // Don't let the grid get too fine, and there's no point in tiles bigger than the grid.
+    const double minForCount = sqrt((double)width * height / kMaxAdaptiveTileCount);
+    size = SkTMax<double>(size, SkTMax<double>(kMinAdaptiveTileSize, minForCount));
+    const int tileSize = SkTMin<int>(SkTMax(width, height), (int)ceil(size));
+
+    fInfo.fTileInterval.set(tileSize, tileSize);
+    this->allocateTiles((width + tileSize - 1) / tileSize, (height + tileSize - 1) / tileSize);
+    fAdaptiveTarget = 0;
+}
+
 SkTileGrid::~SkTileGrid() {
     SkDELETE_ARRAY(fTileData);
 }
@@ -37,8 +112,18 @@ SkTDArray<void *>& SkTileGrid::tile(int x, int y) {
     return fTileData[y * fXTileCount + x];
 }
 
-void SkTileGrid::insert(void* data, const SkIRect& bounds, bool) {
+void SkTileGrid::insert(void* data, const SkIRect& bounds, bool defer) {
     SkASSERT(!bounds.isEmpty());
+    if (fAdaptiveTarget > 0) {
+        if (defer) {
+            DeferredInsert* deferred = fDeferred.append();
+            deferred->fData = data;
+            deferred->fBounds = bounds;
+            return;
+        }
+        this->flushDeferredInserts();
+    }
+
     SkIRect dilatedBounds = bounds;
     dilatedBounds.outset(fInfo.fMargin.width(), fInfo.fMargin.height());
     dilatedBounds.offset(fInfo.fOffset);
@@ -65,7 +150,19 @@ void SkTileGrid::insert(void* data, const SkIRect& bounds, bool) {
     fInsertionCount++;
 }
 
+void SkTileGrid::flushDeferredInserts() {
+    if (fAdaptiveTarget <= 0) {
+        return;
+    }
+    this->chooseAdaptiveTiles();
+    for (int i = 0; i < fDeferred.count(); i++) {
+        this->insert(fDeferred[i].fData, fDeferred[i].fBounds, false);
+    }
+    fDeferred.reset();
+}
+
 void SkTileGrid::search(const SkIRect& query, SkTDArray<void*>* results) {
+    this->flushDeferredInserts();
     SkIRect adjustedQuery = query;
     // The inset is to counteract the outset that was applied in 'insert'
     // The outset/inset is to optimize for lookups of size
@@ -116,6 +213,7 @@ void SkTileGrid::clear() {
     for (int i = 0; i < fTileCount; i++) {
         fTileData[i].reset();
     }
+    fDeferred.reset();
 }
 
 int SkTileGrid::getCount() const {
@@ -124,6 +222,9 @@ int SkTileGrid::getCount() const {
 
 void SkTileGrid::rewindInserts() {
     SkASSERT(fClient);
+    while (!fDeferred.isEmpty() && fClient->shouldRewind(fDeferred.top().fData)) {
+        fDeferred.pop();
+    }
     for (int i = 0; i < fTileCount; ++i) {
         while (!fTileData[i].isEmpty() && fClient->shouldRewind(fTileData[i].top())) {
             fTileData[i].pop();
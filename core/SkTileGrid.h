@@ -22,6 +22,11 @@
  * Note: Current implementation of search() only supports looking-up regions
  * that are an exact match to a single tile.  Implementation could be augmented
  * to support arbitrary rectangles, but performance would be sub-optimal.
+ *
+ * A grid made with CreateAdaptive() instead picks its own tile size: it holds
+ * deferred inserts until flushDeferredInserts() (or the first search), then
+ * sizes square tiles from their bounds so that each tile holds roughly a target
+ * number of elements.
  */
 class SkTileGrid : public SkBBoxHierarchy {
 public:
@@ -33,22 +38,41 @@ public:
         kStackAllocationTileCount = 1024
     };
 
+    enum {
+        // Defaults for CreateAdaptive().
+        kDefaultAdaptiveTargetPerTile = 32,
+        // Adaptive tiles are never smaller than this, nor so small that the grid would need
+        // more than kMaxAdaptiveTileCount tiles.
+        kMinAdaptiveTileSize = 32,
+        kMaxAdaptiveTileCount = 256 * 256,
+    };
+
     typedef void* (*SkTileGridNextDatumFunctionPtr)(SkTDArray<void*>** tileData, SkAutoSTArray<kStackAllocationTileCount, int>& tileIndices);
 
     SkTileGrid(int xTileCount, int yTileCount, const SkTileGridFactory::TileGridInfo& info,
         SkTileGridNextDatumFunctionPtr nextDatumFunction);
 
+    /**
+     * Creates a grid covering width x height that chooses its tile interval when
+     * its deferred inserts are flushed, aiming for targetPerTile elements per tile.
+     * info's fTileInterval is ignored; its margin and offset are used as usual.
+     */
+    static SkTileGrid* CreateAdaptive(int width, int height,
+                                      const SkTileGridFactory::TileGridInfo& info,
+                                      SkTileGridNextDatumFunctionPtr nextDatumFunction,
+                                      int targetPerTile = kDefaultAdaptiveTargetPerTile);
+
     virtual ~SkTileGrid();
 
     /**
      * Insert a data pointer and corresponding bounding box
      * @param data The data pointer, may be NULL
      * @param bounds The bounding box, should not be empty
-     * @param defer Ignored, TileArray does not defer insertions
+     * @param defer Ignored unless the grid is adaptive and hasn't chosen its tiles yet
      */
-    virtual void insert(void* data, const SkIRect& bounds, bool) SK_OVERRIDE;
+    virtual void insert(void* data, const SkIRect& bounds, bool defer) SK_OVERRIDE;
 
-    virtual void flushDeferredInserts() SK_OVERRIDE {};
+    virtual void flushDeferredInserts() SK_OVERRIDE;
 
     /**
      * Populate 'results' with data pointers corresponding to bounding boxes that intersect 'query'
@@ -75,7 +99,19 @@ public:
     int tileCount(int x, int y);  // For testing only.
 
 private:
+    struct DeferredInsert {
+        void* fData;
+        SkIRect fBounds;
+    };
+
     SkTDArray<void*>& tile(int x, int y);
+    void allocateTiles(int xTileCount, int yTileCount);
+    void chooseAdaptiveTiles();
+
+    // Until an adaptive grid picks its tiles, fAdaptiveTarget > 0 and inserts go in fDeferred.
+    int fAdaptiveTarget;
+    SkISize fAdaptiveSize;
+    SkTDArray<DeferredInsert> fDeferred;
 
     int fXTileCount, fYTileCount, fTileCount;
     SkTileGridFactory::TileGridInfo fInfo;
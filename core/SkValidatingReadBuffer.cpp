@@ -41,9 +41,11 @@ void SkValidatingReadBuffer::setMemory(const void* data, size_t size) {
 }
 
 const void* SkValidatingReadBuffer::skip(size_t size) {
-    size_t inc = SkAlign4(size);
     const void* addr = fReader.peek();
-    this->validate(IsPtrAlign4(addr) && fReader.isAvailable(inc));
+    // setMemory() checked that the data starts and ends on a 4 byte boundary, and the reader
+    // only ever moves in multiples of 4, so the cursor can't be misaligned here.
+    SkASSERT(IsPtrAlign4(addr));
+    this->validate(size <= SK_MaxU32 - 3 && fReader.isAvailable(SkAlign4(size)));
     if (!fError) {
         fReader.skip(size);
     }
@@ -54,6 +56,8 @@ const void* SkValidatingReadBuffer::skip(size_t size) {
 // followed by a memcpy. So we've got all our validation in readInt(), readScalar() and skip();
 // if they fail they'll return a zero value or skip nothing, respectively, and set fError to
 // true, which the caller should check to see if an error occurred during the read operation.
+// Fixed layout records (points, bitmap headers, array counts with their elements) are checked
+// with a single skip() over the whole record rather than one check per field.
 
 bool SkValidatingReadBuffer::readBool() {
     uint32_t value = this->readInt();
@@ -71,14 +75,14 @@ SkFixed SkValidatingReadBuffer::readFixed() {
 }
 
 int32_t SkValidatingReadBuffer::readInt() {
-    const size_t inc = sizeof(int32_t);
-    this->validate(IsPtrAlign4(fReader.peek()) && fReader.isAvailable(inc));
+    SkASSERT(IsPtrAlign4(fReader.peek()));
+    this->validate(fReader.isAvailable(sizeof(int32_t)));
     return fError ? 0 : fReader.readInt();
 }
 
 SkScalar SkValidatingReadBuffer::readScalar() {
-    const size_t inc = sizeof(SkScalar);
-    this->validate(IsPtrAlign4(fReader.peek()) && fReader.isAvailable(inc));
+    SkASSERT(IsPtrAlign4(fReader.peek()));
+    this->validate(fReader.isAvailable(sizeof(SkScalar)));
     return fError ? 0 : fReader.readScalar();
 }
 
@@ -107,10 +111,13 @@ void SkValidatingReadBuffer::readString(SkString* string) {
 }
 
 void* SkValidatingReadBuffer::readEncodedString(size_t* length, SkPaint::TextEncoding encoding) {
-    const int32_t encodingType = this->readInt();
-    this->validate(encodingType == encoding);
-    *length = this->readInt();
-    const void* ptr = this->skip(SkAlign4(*length));
+    const int32_t* header = static_cast<const int32_t*>(this->skip(2 * sizeof(int32_t)));
+    *length = 0;
+    if (!this->validate(!fError && header[0] == encoding)) {
+        return NULL;
+    }
+    *length = header[1];
+    const void* ptr = this->skip(*length);
     void* data = NULL;
     if (!fError) {
         data = sk_malloc_throw(*length);
@@ -120,8 +127,12 @@ void* SkValidatingReadBuffer::readEncodedString(size_t* length, SkPaint::TextEnc
 }
 
 void SkValidatingReadBuffer::readPoint(SkPoint* point) {
-    point->fX = this->readScalar();
-    point->fY = this->readScalar();
+    const void* ptr = this->skip(sizeof(SkPoint));
+    if (!fError) {
+        memcpy(point, ptr, sizeof(SkPoint));
+    } else {
+        point->set(0, 0);
+    }
 }
 
 void SkValidatingReadBuffer::readMatrix(SkMatrix* matrix) {
@@ -172,13 +183,15 @@ void SkValidatingReadBuffer::readPath(SkPath* path) {
 }
 
 bool SkValidatingReadBuffer::readArray(void* value, size_t size, size_t elementSize) {
+    // One check covers the count and the elements: the count must match, and both must fit.
     const uint32_t count = this->getArrayCount();
-    this->validate(size == count);
-    (void)this->skip(sizeof(uint32_t)); // Skip array count
+    if (!this->validate(size == count && count <= (SK_MaxU32 - 7) / elementSize)) {
+        return false;
+    }
     const size_t byteLength = count * elementSize;
-    const void* ptr = this->skip(SkAlign4(byteLength));
+    const uint8_t* ptr = static_cast<const uint8_t*>(this->skip(sizeof(uint32_t) + byteLength));
     if (!fError) {
-        memcpy(value, ptr, byteLength);
+        memcpy(value, ptr + sizeof(uint32_t), byteLength);
         return true;
     }
     return false;
@@ -205,18 +218,21 @@ bool SkValidatingReadBuffer::readScalarArray(SkScalar* values, size_t size) {
 }
 
 uint32_t SkValidatingReadBuffer::getArrayCount() {
-    const size_t inc = sizeof(uint32_t);
-    fError = fError || !IsPtrAlign4(fReader.peek()) || !fReader.isAvailable(inc);
+    SkASSERT(IsPtrAlign4(fReader.peek()));
+    fError = fError || !fReader.isAvailable(sizeof(uint32_t));
     return fError ? 0 : *(uint32_t*)fReader.peek();
 }
 
 void SkValidatingReadBuffer::readBitmap(SkBitmap* bitmap) {
-    const int width = this->readInt();
-    const int height = this->readInt();
-    const bool useBitmapHeap = this->readBool();
-    const size_t length = this->readUInt();
-    // A size of zero means the SkBitmap was simply flattened.
-    if (!this->validate(!useBitmapHeap && (0 == length))) {
+    // The width, height, bitmap heap bool and length, checked as one record.
+    const int32_t* header = static_cast<const int32_t*>(this->skip(4 * sizeof(int32_t)));
+    if (fError) {
+        return;
+    }
+    const int width = header[0];
+    const int height = header[1];
+    // A heap bool of false and a size of zero mean the SkBitmap was simply flattened.
+    if (!this->validate((0 == header[2]) && (0 == header[3]))) {
         return;
     }
     bitmap->unflatten(*this);
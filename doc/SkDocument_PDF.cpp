@@ -6,8 +6,8 @@
  */
 
 #include "SkDocument.h"
-#include "SkPDFDocument.h"
 #include "SkPDFDeviceFlattener.h"
+#include "SkPDFStreamingDocument.h"
 
 class SkDocument_PDF : public SkDocument {
 public:
@@ -17,7 +17,9 @@ public:
             : SkDocument(stream, doneProc)
             , fEncoder(encoder)
             , fRasterDpi(rasterDpi) {
-        fDoc = SkNEW(SkPDFDocument);
+        // Pages are written out as they end, so only the shared resources
+        // stay in memory for the life of the document.
+        fDoc = SkNEW_ARGS(SkPDFStreamingDocument, (stream, (SkPDFDocument::Flags)0));
         fCanvas = NULL;
         fDevice = NULL;
     }
@@ -65,7 +67,7 @@ protected:
         SkASSERT(NULL == fCanvas);
         SkASSERT(NULL == fDevice);
 
-        bool success = fDoc->emitPDF(stream);
+        bool success = fDoc->close();
         SkDELETE(fDoc);
         fDoc = NULL;
         return success;
@@ -77,7 +79,7 @@ protected:
     }
 
 private:
-    SkPDFDocument*  fDoc;
+    SkPDFStreamingDocument* fDoc;
     SkPDFDeviceFlattener* fDevice;
     SkCanvas*       fCanvas;
     SkPicture::EncodeBitmap fEncoder;
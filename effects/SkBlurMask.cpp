@@ -8,6 +8,7 @@
 
 
 #include "SkBlurMask.h"
+#include "SkBlurMask_opts.h"
 #include "SkMath.h"
 #include "SkTemplates.h"
 #include "SkEndian.h"
@@ -406,6 +407,21 @@ static int boxBlurInterp(const uint8_t* src, int src_y_stride, uint8_t* dst,
     return new_width;
 }
 
+// The platform procs blur down columns rather than along rows, so the X
+// passes run over the transposed image. These return the new height of the
+// blurred columns, to match boxBlur() and boxBlurInterp().
+static int boxBlurColumns(const SkBlurMaskProcs& procs, const uint8_t* src, uint8_t* dst,
+                          int leftRadius, int rightRadius, int width, int height) {
+    procs.fBoxBlur(src, width, dst, width, leftRadius, rightRadius, width, height);
+    return height + SkMax32(leftRadius, rightRadius) * 2;
+}
+
+static int boxBlurInterpColumns(const SkBlurMaskProcs& procs, const uint8_t* src, uint8_t* dst,
+                                int radius, int width, int height, uint8_t outer_weight) {
+    procs.fBoxBlurInterp(src, width, dst, width, radius, outer_weight, width, height);
+    return height + radius * 2;
+}
+
 static void get_adjusted_radii(SkScalar passRadius, int *loRadius, int *hiRadius)
 {
     *loRadius = *hiRadius = SkScalarCeilToInt(passRadius);
@@ -549,7 +565,44 @@ bool SkBlurMask::BoxBlur(SkMask* dst, const SkMask& src,
         uint8_t*                tp = tmpBuffer.get();
         int w = sw, h = sh;
 
-        if (outerWeight == 255) {
+        SkBlurMaskProcs procs;
+        if (SkBlurMaskGetPlatformProcs(&procs)) {
+            // Same passes as below. The source is transposed into tp, the X
+            // passes leave the image (still transposed) in dp, and it is
+            // transposed back into tp for the Y passes, which end in dp.
+            procs.fTranspose(sp, src.fRowBytes, tp, h, w, h);
+            if (outerWeight == 255) {
+                int loRadius, hiRadius;
+                get_adjusted_radii(passRadius, &loRadius, &hiRadius);
+                if (kHigh_SkBlurQuality == quality) {
+                    w = boxBlurColumns(procs, tp, dp, loRadius, hiRadius, h, w);
+                    w = boxBlurColumns(procs, dp, tp, hiRadius, loRadius, h, w);
+                    w = boxBlurColumns(procs, tp, dp, hiRadius, hiRadius, h, w);
+                    procs.fTranspose(dp, h, tp, w, h, w);
+                    h = boxBlurColumns(procs, tp, dp, loRadius, hiRadius, w, h);
+                    h = boxBlurColumns(procs, dp, tp, hiRadius, loRadius, w, h);
+                    h = boxBlurColumns(procs, tp, dp, hiRadius, hiRadius, w, h);
+                } else {
+                    w = boxBlurColumns(procs, tp, dp, rx, rx, h, w);
+                    procs.fTranspose(dp, h, tp, w, h, w);
+                    h = boxBlurColumns(procs, tp, dp, ry, ry, w, h);
+                }
+            } else {
+                if (kHigh_SkBlurQuality == quality) {
+                    w = boxBlurInterpColumns(procs, tp, dp, rx, h, w, outerWeight);
+                    w = boxBlurInterpColumns(procs, dp, tp, rx, h, w, outerWeight);
+                    w = boxBlurInterpColumns(procs, tp, dp, rx, h, w, outerWeight);
+                    procs.fTranspose(dp, h, tp, w, h, w);
+                    h = boxBlurInterpColumns(procs, tp, dp, ry, w, h, outerWeight);
+                    h = boxBlurInterpColumns(procs, dp, tp, ry, w, h, outerWeight);
+                    h = boxBlurInterpColumns(procs, tp, dp, ry, w, h, outerWeight);
+                } else {
+                    w = boxBlurInterpColumns(procs, tp, dp, rx, h, w, outerWeight);
+                    procs.fTranspose(dp, h, tp, w, h, w);
+                    h = boxBlurInterpColumns(procs, tp, dp, ry, w, h, outerWeight);
+                }
+            }
+        } else if (outerWeight == 255) {
             int loRadius, hiRadius;
             get_adjusted_radii(passRadius, &loRadius, &hiRadius);
             if (kHigh_SkBlurQuality == quality) {
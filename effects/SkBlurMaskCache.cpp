@@ -0,0 +1,216 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBlurMaskCache.h"
+
+#include "SkChecksum.h"
+#include "SkRRect.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkThread.h"
+
+#ifndef SK_DEFAULT_BLUR_MASK_CACHE_LIMIT
+    #define SK_DEFAULT_BLUR_MASK_CACHE_LIMIT     (1024 * 1024)
+#endif
+
+void SkBlurMaskCache::Key::init(SkScalar sigma, SkBlurStyle style, SkBlurQuality quality,
+                                bool analytic, int shape) {
+    sk_bzero(fData, sizeof(fData));
+    memcpy(&fData[0], &sigma, sizeof(sigma));
+    fData[1] = style;
+    fData[2] = quality;
+    fData[3] = analytic;
+    fData[4] = shape;
+}
+
+SkBlurMaskCache::Key::Key(SkScalar sigma, SkBlurStyle style, SkBlurQuality quality,
+                          bool analytic, const SkRRect& rrect) {
+    SkASSERT(0 == rrect.rect().fLeft && 0 == rrect.rect().fTop);
+    this->init(sigma, style, quality, analytic, 0);
+
+    SkScalar shape[kShapeCount];
+    shape[0] = rrect.rect().width();
+    shape[1] = rrect.rect().height();
+    for (int i = 0; i < 4; ++i) {
+        const SkVector& radii = rrect.radii((SkRRect::Corner)i);
+        shape[2 + 2 * i] = radii.fX;
+        shape[3 + 2 * i] = radii.fY;
+    }
+    shape[10] = shape[11] = 0;
+    SK_COMPILE_ASSERT(sizeof(shape) == kShapeCount * sizeof(uint32_t), shape_must_fill_key);
+    memcpy(&fData[kHeaderCount], shape, sizeof(shape));
+}
+
+SkBlurMaskCache::Key::Key(SkScalar sigma, SkBlurStyle style, SkBlurQuality quality,
+                          bool analytic, const SkRect rects[], int count) {
+    SkASSERT(count >= 1 && count <= 2);
+    this->init(sigma, style, quality, analytic, count);
+
+    const SkScalar dx = SkScalarFloorToScalar(rects[0].fLeft);
+    const SkScalar dy = SkScalarFloorToScalar(rects[0].fTop);
+    SkScalar shape[kShapeCount];
+    for (int i = 0; i < kShapeCount; ++i) {
+        shape[i] = 0;
+    }
+    for (int i = 0; i < count; ++i) {
+        SkRect r = rects[i];
+        r.offset(-dx, -dy);
+        shape[4 * i + 0] = r.fLeft;
+        shape[4 * i + 1] = r.fTop;
+        shape[4 * i + 2] = r.fRight;
+        shape[4 * i + 3] = r.fBottom;
+    }
+    memcpy(&fData[kHeaderCount], shape, sizeof(shape));
+}
+
+bool SkBlurMaskCache::Key::operator==(const Key& other) const {
+    return 0 == memcmp(fData, other.fData, sizeof(fData));
+}
+
+uint32_t SkBlurMaskCache::Key::hash() const {
+    return SkChecksum::Compute(fData, sizeof(fData));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Rec {
+    // Takes ownership of image, which holds a copy of mask's pixels.
+    Rec(const SkBlurMaskCache::Key& key, const SkMask& mask, uint8_t* image, size_t imageSize)
+        : fKey(key)
+        , fMask(mask)
+        , fImageSize(imageSize) {
+        fMask.fImage = image;
+    }
+
+    ~Rec() {
+        SkMask::FreeImage(fMask.fImage);
+    }
+
+    static const SkBlurMaskCache::Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const SkBlurMaskCache::Key& key) { return key.hash(); }
+
+    const SkBlurMaskCache::Key fKey;
+    SkMask fMask;
+    const size_t fImageSize;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+/**
+ *  The cache itself, which is only ever touched with gMutex held. fList is
+ *  in most recently used order.
+ */
+class Cache {
+public:
+    Cache() : fBytesUsed(0), fByteLimit(SK_DEFAULT_BLUR_MASK_CACHE_LIMIT) {}
+
+    bool findAndCopy(const SkBlurMaskCache::Key& key, SkMask* mask) {
+        Rec* rec = fHash.find(key);
+        if (NULL == rec) {
+            return false;
+        }
+        fList.remove(rec);
+        fList.addToHead(rec);
+
+        uint8_t* image = SkMask::AllocImage(rec->fImageSize);
+        if (NULL == image) {
+            return false;
+        }
+        memcpy(image, rec->fMask.fImage, rec->fImageSize);
+        *mask = rec->fMask;
+        mask->fImage = image;
+        return true;
+    }
+
+    void add(const SkBlurMaskCache::Key& key, const SkMask& mask) {
+        SkASSERT(SkMask::kA8_Format == mask.fFormat);
+        const size_t imageSize = mask.computeImageSize();
+        if (0 == imageSize || imageSize > fByteLimit || NULL != fHash.find(key)) {
+            return;
+        }
+        uint8_t* image = SkMask::AllocImage(imageSize);
+        if (NULL == image) {
+            return;
+        }
+        memcpy(image, mask.fImage, imageSize);
+        Rec* rec = SkNEW_ARGS(Rec, (key, mask, image, imageSize));
+        fHash.add(rec);
+        fList.addToHead(rec);
+        fBytesUsed += imageSize;
+        this->purgeAsNeeded();
+    }
+
+    size_t bytesUsed() const { return fBytesUsed; }
+    size_t byteLimit() const { return fByteLimit; }
+
+    size_t setByteLimit(size_t newLimit) {
+        size_t prevLimit = fByteLimit;
+        fByteLimit = newLimit;
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
+
+private:
+    void purgeAsNeeded() {
+        while (fBytesUsed > fByteLimit) {
+            Rec* rec = fList.tail();
+            SkASSERT(NULL != rec);
+            fList.remove(rec);
+            fHash.remove(rec->fKey);
+            fBytesUsed -= rec->fImageSize;
+            SkDELETE(rec);
+        }
+    }
+
+    SkTDynamicHash<Rec, SkBlurMaskCache::Key> fHash;
+    SkTInternalLList<Rec> fList;
+    size_t fBytesUsed;
+    size_t fByteLimit;
+};
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+
+// Must be called with gMutex held. Like the global SkScaledImageCache, the
+// cache lives for the life of the process.
+Cache* get_cache() {
+    static Cache* gCache;
+    if (NULL == gCache) {
+        gCache = SkNEW(Cache);
+    }
+    return gCache;
+}
+
+}  // namespace
+
+bool SkBlurMaskCache::FindAndCopy(const Key& key, SkMask* mask) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->findAndCopy(key, mask);
+}
+
+void SkBlurMaskCache::Add(const Key& key, const SkMask& mask) {
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->add(key, mask);
+}
+
+size_t SkBlurMaskCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkBlurMaskCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkBlurMaskCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlurMaskCache_DEFINED
+#define SkBlurMaskCache_DEFINED
+
+#include "SkBlurTypes.h"
+#include "SkMask.h"
+
+class SkRRect;
+struct SkRect;
+
+/**
+ *  A global, thread-safe, byte-limited LRU cache of the small blurred masks
+ *  SkBlurMaskFilter stretches into nine-patches. The same rect or round rect
+ *  shadow drawn again (at any position) skips blurring and just copies the
+ *  cached mask.
+ */
+class SkBlurMaskCache {
+public:
+    /**
+     *  Everything the blurred mask depends on. Two keys compare equal only if
+     *  they were built from the same arguments.
+     */
+    class Key {
+    public:
+        /** A round rect, which must sit at the origin. */
+        Key(SkScalar sigma, SkBlurStyle, SkBlurQuality, bool analytic, const SkRRect&);
+
+        /**
+         *  One rect, or two nested rects. Only the fractional part of the
+         *  first rect's origin matters, so the rects are keyed relative to
+         *  its integer part.
+         */
+        Key(SkScalar sigma, SkBlurStyle, SkBlurQuality, bool analytic,
+            const SkRect rects[], int count);
+
+        bool operator==(const Key& other) const;
+        uint32_t hash() const;
+
+    private:
+        void init(SkScalar sigma, SkBlurStyle, SkBlurQuality, bool analytic, int shape);
+
+        enum {
+            kHeaderCount = 5,   // sigma, style, quality, analytic, shape
+            kShapeCount = 12,   // enough for a rect and four radii
+            kCount = kHeaderCount + kShapeCount,
+        };
+        uint32_t fData[kCount];
+    };
+
+    /**
+     *  If key is in the cache, allocates mask->fImage with SkMask::AllocImage,
+     *  copies the cached mask into it and returns true. The caller owns the
+     *  image and frees it with SkMask::FreeImage as usual.
+     */
+    static bool FindAndCopy(const Key& key, SkMask* mask);
+
+    /**
+     *  Adds a copy of mask, which must be A8, to the cache. Masks too large
+     *  for the cache are ignored.
+     */
+    static void Add(const Key& key, const SkMask& mask);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+};
+
+#endif
@@ -7,6 +7,7 @@
  */
 #include "SkColorMatrixFilter.h"
 #include "SkColorMatrix.h"
+#include "SkColorMatrixFilter_opts.h"
 #include "SkColorPriv.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
@@ -233,11 +234,25 @@ void SkColorMatrixFilter::filterSpan(const SkPMColor src[], int count,
         return;
     }
 
+    SkColorMatrixSpanProc spanProc = SkColorMatrixGetPlatformSpanProc();
+    if (NULL != spanProc) {
+        spanProc(state.fArray, state.fShift, src, count, dst);
+        return;
+    }
+
     const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
 
+    SkPMColor prev = 0;
     for (int i = 0; i < count; i++) {
         SkPMColor c = src[i];
 
+        // runs of one color are common, so reuse the previous result
+        if (i > 0 && c == prev) {
+            dst[i] = dst[i - 1];
+            continue;
+        }
+        prev = c;
+
         unsigned r = SkGetPackedR32(c);
         unsigned g = SkGetPackedG32(c);
         unsigned b = SkGetPackedB32(c);
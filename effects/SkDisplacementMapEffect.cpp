@@ -47,6 +47,11 @@ template<> uint32_t getValue<SkDisplacementMapEffect::kA_ChannelSelectorType>(
     return SkGetPackedA32(l);
 }
 
+// Truncate the displacement values
+inline int displacement(SkScalar scaleForColor, SkScalar scaleAdj, uint32_t value) {
+    return SkScalarTruncToInt(SkScalarMul(scaleForColor, SkIntToScalar(value)) + scaleAdj);
+}
+
 template<SkDisplacementMapEffect::ChannelSelectorType typeX,
          SkDisplacementMapEffect::ChannelSelectorType typeY>
 void computeDisplacement(const SkVector& scale, SkBitmap* dst,
@@ -62,18 +67,25 @@ void computeDisplacement(const SkVector& scale, SkBitmap* dst,
     const SkVector scaleAdj = SkVector::Make(SK_ScalarHalf - SkScalarMul(scale.fX, SK_ScalarHalf),
                                              SK_ScalarHalf - SkScalarMul(scale.fY, SK_ScalarHalf));
     const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    // The (truncated) displacement only depends on the channel value, so look it up rather
+    // than computing it per pixel. Channels of invalid premultiplied colors can exceed 255;
+    // those are computed as before.
+    int displXTable[256], displYTable[256];
+    for (int i = 0; i < 256; ++i) {
+        displXTable[i] = displacement(scaleForColor.fX, scaleAdj.fX, i);
+        displYTable[i] = displacement(scaleForColor.fY, scaleAdj.fY, i);
+    }
     SkPMColor* dstPtr = dst->getAddr32(0, 0);
     for (int y = bounds.top(); y < bounds.bottom(); ++y) {
         const SkPMColor* displPtr = displ->getAddr32(bounds.left() + offset.fX,
                                                      y + offset.fY);
         for (int x = bounds.left(); x < bounds.right(); ++x, ++displPtr) {
-            const SkScalar displX = SkScalarMul(scaleForColor.fX,
-                SkIntToScalar(getValue<typeX>(*displPtr, table))) + scaleAdj.fX;
-            const SkScalar displY = SkScalarMul(scaleForColor.fY,
-                SkIntToScalar(getValue<typeY>(*displPtr, table))) + scaleAdj.fY;
-            // Truncate the displacement values
-            const int srcX = x + SkScalarTruncToInt(displX);
-            const int srcY = y + SkScalarTruncToInt(displY);
+            const uint32_t valueX = getValue<typeX>(*displPtr, table);
+            const uint32_t valueY = getValue<typeY>(*displPtr, table);
+            const int srcX = x + (valueX < 256 ? displXTable[valueX] :
+                                  displacement(scaleForColor.fX, scaleAdj.fX, valueX));
+            const int srcY = y + (valueY < 256 ? displYTable[valueY] :
+                                  displacement(scaleForColor.fY, scaleAdj.fY, valueY));
             *dstPtr++ = ((srcX < 0) || (srcX >= srcW) || (srcY < 0) || (srcY >= srcH)) ?
                       0 : *(src->getAddr32(srcX, srcY));
         }
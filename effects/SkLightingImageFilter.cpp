@@ -8,6 +8,7 @@
 #include "SkLightingImageFilter.h"
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
+#include "SkLighting_opts.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
 #include "SkReadBuffer.h"
@@ -32,7 +33,6 @@ namespace {
 const SkScalar gOneThird = SkScalarInvert(SkIntToScalar(3));
 const SkScalar gTwoThirds = SkScalarDiv(SkIntToScalar(2), SkIntToScalar(3));
 const SkScalar gOneHalf = 0.5f;
-const SkScalar gOneQuarter = 0.25f;
 
 #if SK_SUPPORT_GPU
 void setUniformPoint3(const GrGLUniformManager& uman, UniformHandle uni, const SkPoint3& point) {
@@ -130,13 +130,6 @@ inline SkPoint3 leftNormal(int m[9], SkScalar surfaceScale) {
                          surfaceScale);
 }
 
-
-inline SkPoint3 interiorNormal(int m[9], SkScalar surfaceScale) {
-    return pointToNormal(sobel(m[0], m[2], m[3], m[5], m[6], m[8], gOneQuarter),
-                         sobel(m[0], m[6], m[1], m[7], m[2], m[8], gOneQuarter),
-                         surfaceScale);
-}
-
 inline SkPoint3 rightNormal(int m[9], SkScalar surfaceScale) {
     return pointToNormal(sobel(m[0], m[1], m[3], m[4], m[6], m[7], gOneHalf),
                          sobel(m[0], m[6], m[1], m[7],    0,    0, gOneThird),
@@ -168,6 +161,18 @@ template <class LightingType, class LightType> void lightBitmap(const LightingTy
     int bottom = bounds.bottom();
     int y = bounds.top();
     SkPMColor* dptr = dst->getAddr32(0, 0);
+
+    // The interior normals of each row are computed up front, several at a time when the
+    // platform allows.
+    SkLightingInteriorNormalsProc normalsProc = SkLightingGetPlatformInteriorNormalsProc();
+    if (NULL == normalsProc) {
+        normalsProc = SkLightingInteriorNormals;
+    }
+    const int interiorCount = SkMax32(bounds.width() - 2, 0);
+    SkAutoTMalloc<SkScalar> normals(3 * interiorCount);
+    SkScalar* nx = normals.get();
+    SkScalar* ny = nx + interiorCount;
+    SkScalar* nz = ny + interiorCount;
     {
         int x = left;
         const SkPMColor* row1 = src.getAddr32(x, y);
@@ -198,23 +203,28 @@ template <class LightingType, class LightType> void lightBitmap(const LightingTy
         const SkPMColor* row1 = src.getAddr32(x, y);
         const SkPMColor* row2 = src.getAddr32(x, y + 1);
         int m[9];
-        m[1] = SkGetPackedA32(*row0++);
-        m[2] = SkGetPackedA32(*row0++);
-        m[4] = SkGetPackedA32(*row1++);
-        m[5] = SkGetPackedA32(*row1++);
-        m[7] = SkGetPackedA32(*row2++);
-        m[8] = SkGetPackedA32(*row2++);
+        m[1] = SkGetPackedA32(row0[0]);
+        m[2] = SkGetPackedA32(row0[1]);
+        m[4] = SkGetPackedA32(row1[0]);
+        m[5] = SkGetPackedA32(row1[1]);
+        m[7] = SkGetPackedA32(row2[0]);
+        m[8] = SkGetPackedA32(row2[1]);
         SkPoint3 surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
         *dptr++ = lightingType.light(leftNormal(m, surfaceScale), surfaceToLight, l->lightColor(surfaceToLight));
-        for (++x; x < right - 1; ++x) {
-            shiftMatrixLeft(m);
-            m[2] = SkGetPackedA32(*row0++);
-            m[5] = SkGetPackedA32(*row1++);
-            m[8] = SkGetPackedA32(*row2++);
-            surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
-            *dptr++ = lightingType.light(interiorNormal(m, surfaceScale), surfaceToLight, l->lightColor(surfaceToLight));
+        normalsProc(row0, row1, row2, surfaceScale, nx, ny, nz, interiorCount);
+        for (int i = 0; i < interiorCount; ++i) {
+            ++x;
+            surfaceToLight = l->surfaceToLight(x, y, SkGetPackedA32(row1[i + 1]), surfaceScale);
+            *dptr++ = lightingType.light(SkPoint3(nx[i], ny[i], nz[i]), surfaceToLight, l->lightColor(surfaceToLight));
         }
-        shiftMatrixLeft(m);
+        ++x;
+        const int last = x - left;
+        m[0] = SkGetPackedA32(row0[last - 1]);
+        m[1] = SkGetPackedA32(row0[last]);
+        m[3] = SkGetPackedA32(row1[last - 1]);
+        m[4] = SkGetPackedA32(row1[last]);
+        m[6] = SkGetPackedA32(row2[last - 1]);
+        m[7] = SkGetPackedA32(row2[last]);
         surfaceToLight = l->surfaceToLight(x, y, m[4], surfaceScale);
         *dptr++ = lightingType.light(rightNormal(m, surfaceScale), surfaceToLight, l->lightColor(surfaceToLight));
     }
@@ -8,10 +8,10 @@
 #include "SkMatrixConvolutionImageFilter.h"
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
+#include "SkConfig8888.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
 #include "SkRect.h"
-#include "SkUnPreMultiply.h"
 
 #if SK_SUPPORT_GPU
 #include "gl/GrGLEffect.h"
@@ -243,13 +243,20 @@ static SkBitmap unpremultiplyBitmap(const SkBitmap& src)
     if (!result.getPixels()) {
         return SkBitmap();
     }
-    for (int y = 0; y < src.height(); ++y) {
-        const uint32_t* srcRow = src.getAddr32(0, y);
-        uint32_t* dstRow = result.getAddr32(0, y);
-        for (int x = 0; x < src.width(); ++x) {
-            dstRow[x] = SkUnPreMultiply::PMColorToColor(srcRow[x]);
-        }
-    }
+    // Unpremultiplied pixels are stored as SkColors, which are BGRA.
+    SkDstPixelInfo dstPI;
+    dstPI.fColorType = kBGRA_8888_SkColorType;
+    dstPI.fAlphaType = kUnpremul_SkAlphaType;
+    dstPI.fPixels = result.getPixels();
+    dstPI.fRowBytes = result.rowBytes();
+
+    SkSrcPixelInfo srcPI;
+    srcPI.fColorType = kN32_SkColorType;
+    srcPI.fAlphaType = kPremul_SkAlphaType;
+    srcPI.fPixels = src.getPixels();
+    srcPI.fRowBytes = src.rowBytes();
+
+    srcPI.convertPixelsTo(&dstPI, src.width(), src.height());
     return result;
 }
 
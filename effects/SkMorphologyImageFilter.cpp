@@ -46,11 +46,37 @@ enum MorphDirection {
     kX, kY
 };
 
+// For SkMorphLargeRadius().
+struct ErodeOp {
+    static SkPMColor Apply(SkPMColor a, SkPMColor b) {
+        return SkPackARGB32(SkMin32(SkGetPackedA32(a), SkGetPackedA32(b)),
+                            SkMin32(SkGetPackedR32(a), SkGetPackedR32(b)),
+                            SkMin32(SkGetPackedG32(a), SkGetPackedG32(b)),
+                            SkMin32(SkGetPackedB32(a), SkGetPackedB32(b)));
+    }
+    static SkPMColor Identity() { return SkPackARGB32(255, 255, 255, 255); }
+};
+
+struct DilateOp {
+    static SkPMColor Apply(SkPMColor a, SkPMColor b) {
+        return SkPackARGB32(SkMax32(SkGetPackedA32(a), SkGetPackedA32(b)),
+                            SkMax32(SkGetPackedR32(a), SkGetPackedR32(b)),
+                            SkMax32(SkGetPackedG32(a), SkGetPackedG32(b)),
+                            SkMax32(SkGetPackedB32(a), SkGetPackedB32(b)));
+    }
+    static SkPMColor Identity() { return 0; }
+};
+
 template<MorphDirection direction>
 static void erode(const SkPMColor* src, SkPMColor* dst,
                   int radius, int width, int height,
                   int srcStride, int dstStride)
 {
+    if (radius >= kSkMorphologyLargeRadius) {
+        SkMorphLargeRadius<ErodeOp, direction == kX>(src, dst, radius, width, height,
+                                                     srcStride, dstStride);
+        return;
+    }
     const int srcStrideX = direction == kX ? 1 : srcStride;
     const int dstStrideX = direction == kX ? 1 : dstStride;
     const int srcStrideY = direction == kX ? srcStride : 1;
@@ -89,6 +115,11 @@ static void dilate(const SkPMColor* src, SkPMColor* dst,
                    int radius, int width, int height,
                    int srcStride, int dstStride)
 {
+    if (radius >= kSkMorphologyLargeRadius) {
+        SkMorphLargeRadius<DilateOp, direction == kX>(src, dst, radius, width, height,
+                                                      srcStride, dstStride);
+        return;
+    }
     const int srcStrideX = direction == kX ? 1 : srcStride;
     const int dstStrideX = direction == kX ? 1 : dstStride;
     const int srcStrideY = direction == kX ? srcStride : 1;
@@ -482,6 +513,49 @@ void apply_morphology_pass(GrContext* context,
     context->drawRectToRect(paint, SkRect::Make(dstRect), SkRect::Make(srcRect));
 }
 
+// Larger radii are split into passes of at most this radius. Dilating (or eroding) by r1 and
+// then by r2 is the same as doing so by r1 + r2, so this bounds the taps per pass, and the number
+// of distinct programs, however large the radius gets.
+static const int kMaxMorphologyPassRadius = 16;
+
+// Applies radius along direction in as many passes as it takes, leaving the result in src at
+// dstRect (which srcRect is updated to). Each pass reads up to its radius past the far edge of
+// what the pass before it wrote, so that strip is filled with the operation's identity; clearBelow
+// does the same below the last pass, for the passes in the other direction that follow.
+void apply_morphology_passes(GrContext* context,
+                             SkAutoTUnref<GrTexture>* src,
+                             SkIRect* srcRect,
+                             const SkIRect& dstRect,
+                             const GrTextureDesc& desc,
+                             int radius,
+                             int clearBelow,
+                             GrMorphologyEffect::MorphologyType morphType,
+                             Gr1DKernelEffect::Direction direction) {
+    const GrColor identity = GrMorphologyEffect::kErode_MorphologyType == morphType ?
+                             SK_ColorWHITE : SK_ColorTRANSPARENT;
+    while (radius > 0) {
+        const int passRadius = SkMin32(radius, kMaxMorphologyPassRadius);
+        radius -= passRadius;
+        GrAutoScratchTexture ast(context, desc);
+        GrContext::AutoRenderTarget art(context, ast.texture()->asRenderTarget());
+        apply_morphology_pass(context, src->get(), *srcRect, dstRect, passRadius,
+                              morphType, direction);
+        const int nextRadius = SkMin32(radius, kMaxMorphologyPassRadius);
+        if (nextRadius > 0) {
+            SkIRect clearRect = Gr1DKernelEffect::kX_Direction == direction ?
+                    SkIRect::MakeXYWH(dstRect.fRight, dstRect.fTop, nextRadius, dstRect.height()) :
+                    SkIRect::MakeXYWH(dstRect.fLeft, dstRect.fBottom, dstRect.width(), nextRadius);
+            context->clear(&clearRect, identity, false);
+        } else if (clearBelow > 0) {
+            SkIRect clearRect = SkIRect::MakeXYWH(dstRect.fLeft, dstRect.fBottom,
+                                                  dstRect.width(), clearBelow);
+            context->clear(&clearRect, identity, false);
+        }
+        src->reset(ast.detach());
+        *srcRect = dstRect;
+    }
+}
+
 bool apply_morphology(const SkBitmap& input,
                       const SkIRect& rect,
                       GrMorphologyEffect::MorphologyType morphType,
@@ -507,26 +581,11 @@ bool apply_morphology(const SkBitmap& input,
     desc.fConfig = kSkia8888_GrPixelConfig;
     SkIRect srcRect = rect;
 
-    if (radius.fWidth > 0) {
-        GrAutoScratchTexture ast(context, desc);
-        GrContext::AutoRenderTarget art(context, ast.texture()->asRenderTarget());
-        apply_morphology_pass(context, src, srcRect, dstRect, radius.fWidth,
-                              morphType, Gr1DKernelEffect::kX_Direction);
-        SkIRect clearRect = SkIRect::MakeXYWH(dstRect.fLeft, dstRect.fBottom,
-                                              dstRect.width(), radius.fHeight);
-        context->clear(&clearRect, GrMorphologyEffect::kErode_MorphologyType == morphType ?
-                                   SK_ColorWHITE :
-                                   SK_ColorTRANSPARENT, false);
-        src.reset(ast.detach());
-        srcRect = dstRect;
-    }
-    if (radius.fHeight > 0) {
-        GrAutoScratchTexture ast(context, desc);
-        GrContext::AutoRenderTarget art(context, ast.texture()->asRenderTarget());
-        apply_morphology_pass(context, src, srcRect, dstRect, radius.fHeight,
-                              morphType, Gr1DKernelEffect::kY_Direction);
-        src.reset(ast.detach());
-    }
+    apply_morphology_passes(context, &src, &srcRect, dstRect, desc, radius.fWidth,
+                            SkMin32(radius.fHeight, kMaxMorphologyPassRadius),
+                            morphType, Gr1DKernelEffect::kX_Direction);
+    apply_morphology_passes(context, &src, &srcRect, dstRect, desc, radius.fHeight, 0,
+                            morphType, Gr1DKernelEffect::kY_Direction);
     SkImageFilter::WrapTexture(src, rect.width(), rect.height(), dst);
     return true;
 }
@@ -8,11 +8,13 @@
 #include "SkDither.h"
 #include "SkPerlinNoiseShader.h"
 #include "SkColorFilter.h"
+#include "SkData.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
 #include "SkShader.h"
 #include "SkUnPreMultiply.h"
 #include "SkString.h"
+#include "SkThread.h"
 
 #if SK_SUPPORT_GPU
 #include "GrContext.h"
@@ -26,6 +28,8 @@ static const int kBlockSize = 256;
 static const int kBlockMask = kBlockSize - 1;
 static const int kPerlinNoise = 4096;
 static const int kRandMaximum = SK_MaxS32; // 2**31 - 1
+// The largest stitch tile whose noise is cached, in pixels.
+static const int kMaxCachedTilePixels = 512 * 512;
 
 namespace {
 
@@ -85,6 +89,9 @@ struct SkPerlinNoiseShader::PaintingData {
                  SkScalar baseFrequencyX, SkScalar baseFrequencyY)
       : fTileSize(tileSize)
       , fBaseFrequency(SkPoint::Make(baseFrequencyX, baseFrequencyY))
+      , fTile(NULL)
+      , fTileAlpha(0)
+      , fTilePixelsShaded(0)
     {
         this->init(seed);
         if (!fTileSize.isEmpty()) {
@@ -100,6 +107,10 @@ struct SkPerlinNoiseShader::PaintingData {
 #endif
     }
 
+    ~PaintingData() {
+        SkSafeUnref(fTile);
+    }
+
     int         fSeed;
     uint8_t     fLatticeSelector[kBlockSize];
     uint16_t    fNoise[4][kBlockSize][2];
@@ -115,6 +126,16 @@ private:
     SkBitmap   fNoiseBitmap;
 #endif
 
+    // The noise of the stitch tile, [0, width) x [0, height) in noise space,
+    // as rows of SkPMColors. Drawing the same tile again and again (as grain
+    // and paper textures do) then costs a copy rather than the noise.
+    SkMutex     fTileMutex;
+    SkData*     fTile;
+    U8CPU       fTileAlpha;
+    // Pixels shaded so far by spans that could have used the cache. It is
+    // only made once they add up to the tile, so small draws don't pay for it.
+    int64_t     fTilePixelsShaded;
+
     inline int random()  {
         static const int gRandAmplitude = 16807; // 7**5; primitive root of m
         static const int gRandQ = 127773; // m / a
@@ -241,6 +262,132 @@ private:
     }
 
 public:
+    // noise2D() for all four channels: the lattice lookups and smoothing
+    // don't depend on the channel, so they are done once for the four.
+    void noise2D4(bool stitchTiles, const StitchData& stitchData, const SkPoint& noiseVector,
+                  SkScalar noise[4]) const {
+        SkScalar positionX = noiseVector.x() + kPerlinNoise;
+        SkScalar positionY = noiseVector.y() + kPerlinNoise;
+        int integerX = SkScalarFloorToInt(positionX);
+        int integerY = SkScalarFloorToInt(positionY);
+        SkScalar fractionX = positionX - SkIntToScalar(integerX);
+        SkScalar fractionY = positionY - SkIntToScalar(integerY);
+        // If stitching, adjust lattice points accordingly.
+        if (stitchTiles) {
+            integerX = checkNoise(integerX, stitchData.fWrapX, stitchData.fWidth);
+            integerY = checkNoise(integerY, stitchData.fWrapY, stitchData.fHeight);
+        }
+        integerX &= kBlockMask;
+        integerY &= kBlockMask;
+        int latticeIndex = fLatticeSelector[integerX] + integerY;
+        int nextLatticeIndex = fLatticeSelector[(integerX + 1) & kBlockMask] + integerY;
+        int index00 = latticeIndex & kBlockMask;
+        int index10 = nextLatticeIndex & kBlockMask;
+        int index11 = (nextLatticeIndex + 1) & kBlockMask;
+        int index01 = (latticeIndex + 1) & kBlockMask;
+        SkScalar sx = smoothCurve(fractionX);
+        SkScalar sy = smoothCurve(fractionY);
+
+        // The same steps as noise2D(), one channel per lane.
+        const SkPoint offset00 = SkPoint::Make(fractionX, fractionY);
+        const SkPoint offset10 = SkPoint::Make(fractionX - SK_Scalar1, fractionY);
+        const SkPoint offset11 = SkPoint::Make(fractionX - SK_Scalar1, fractionY - SK_Scalar1);
+        const SkPoint offset01 = SkPoint::Make(fractionX, fractionY - SK_Scalar1);
+        for (int channel = 0; channel < 4; ++channel) {
+            const SkPoint* gradient = fGradient[channel];
+            SkScalar u = gradient[index00].dot(offset00);
+            SkScalar v = gradient[index10].dot(offset10);
+            SkScalar a = SkScalarInterp(u, v, sx);
+            v = gradient[index11].dot(offset11);
+            u = gradient[index01].dot(offset01);
+            SkScalar b = SkScalarInterp(u, v, sx);
+            noise[channel] = SkScalarInterp(a, b, sy);
+        }
+    }
+
+    // The color at point, which is already in noise space and rounded: each
+    // channel is calculateTurbulenceValueForPoint(), computed side by side.
+    SkPMColor shade(SkPerlinNoiseShader::Type type, int numOctaves, bool stitchTiles,
+                    U8CPU paintAlpha, const SkPoint& point) const {
+        StitchData stitchData;
+        if (stitchTiles) {
+            // Set up TurbulenceInitial stitch values.
+            stitchData = fStitchDataInit;
+        }
+        SkScalar turbulence[4] = { 0, 0, 0, 0 };
+        SkPoint noiseVector(SkPoint::Make(SkScalarMul(point.x(), fBaseFrequency.fX),
+                                          SkScalarMul(point.y(), fBaseFrequency.fY)));
+        SkScalar ratio = SK_Scalar1;
+        for (int octave = 0; octave < numOctaves; ++octave) {
+            SkScalar noise[4];
+            this->noise2D4(stitchTiles, stitchData, noiseVector, noise);
+            for (int channel = 0; channel < 4; ++channel) {
+                turbulence[channel] += SkScalarDiv((kFractalNoise_Type == type) ?
+                                                   noise[channel] : SkScalarAbs(noise[channel]),
+                                                   ratio);
+            }
+            noiseVector.fX *= 2;
+            noiseVector.fY *= 2;
+            ratio *= 2;
+            if (stitchTiles) {
+                // Update stitch values
+                stitchData.fWidth  *= 2;
+                stitchData.fWrapX   = stitchData.fWidth + kPerlinNoise;
+                stitchData.fHeight *= 2;
+                stitchData.fWrapY   = stitchData.fHeight + kPerlinNoise;
+            }
+        }
+
+        U8CPU rgba[4];
+        for (int channel = 0; channel < 4; ++channel) {
+            SkScalar result = turbulence[channel];
+            if (kFractalNoise_Type == type) {
+                result = SkScalarMul(result, SK_ScalarHalf) + SK_ScalarHalf;
+            }
+            if (3 == channel) { // Scale alpha by paint value
+                result = SkScalarMul(result, SkScalarDiv(SkIntToScalar(paintAlpha),
+                                                         SkIntToScalar(255)));
+            }
+            rgba[channel] = SkScalarFloorToInt(255 * SkScalarPin(result, 0, SK_Scalar1));
+        }
+        return SkPreMultiplyARGB(rgba[3], rgba[0], rgba[1], rgba[2]);
+    }
+
+    // Returns a ref on the tile's noise for paintAlpha, or NULL if there is
+    // none yet. pixels is how many pixels of the tile the caller is about to
+    // shade, which counts towards making the cache.
+    SkData* refTile(SkPerlinNoiseShader::Type type, int numOctaves, U8CPU paintAlpha,
+                    int pixels) {
+        SkASSERT(!fTileSize.isEmpty());
+        const int width = fTileSize.width();
+        const int height = fTileSize.height();
+        if (sk_64_mul(width, height) > kMaxCachedTilePixels) {
+            return NULL;
+        }
+
+        SkAutoMutexAcquire am(fTileMutex);
+        if (NULL != fTile && paintAlpha == fTileAlpha) {
+            return SkRef(fTile);
+        }
+        fTilePixelsShaded += pixels;
+        if (fTilePixelsShaded < width * height) {
+            return NULL;
+        }
+
+        SkAutoTMalloc<SkPMColor> colors(width * height);
+        SkPMColor* color = colors.get();
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                *color++ = this->shade(type, numOctaves, true, paintAlpha,
+                                       SkPoint::Make(SkIntToScalar(x), SkIntToScalar(y)));
+            }
+        }
+        SkSafeUnref(fTile);
+        fTile = SkData::NewFromMalloc(colors.detach(), width * height * sizeof(SkPMColor));
+        fTileAlpha = paintAlpha;
+        fTilePixelsShaded = 0;
+        return SkRef(fTile);
+    }
 
 #if SK_SUPPORT_GPU && !defined(SK_USE_SIMPLEX_NOISE)
     const SkBitmap& getPermutationsBitmap() const { return fPermutationsBitmap; }
@@ -416,13 +563,10 @@ SkPMColor SkPerlinNoiseShader::PerlinNoiseShaderContext::shade(
     newPoint.fX = SkScalarRoundToScalar(newPoint.fX);
     newPoint.fY = SkScalarRoundToScalar(newPoint.fY);
 
-    U8CPU rgba[4];
-    for (int channel = 3; channel >= 0; --channel) {
-        rgba[channel] = SkScalarFloorToInt(255 *
-            calculateTurbulenceValueForPoint(channel, *perlinNoiseShader.fPaintingData,
-                                             stitchData, newPoint));
-    }
-    return SkPreMultiplyARGB(rgba[3], rgba[0], rgba[1], rgba[2]);
+    return perlinNoiseShader.fPaintingData->shade(perlinNoiseShader.fType,
+                                                  perlinNoiseShader.fNumOctaves,
+                                                  perlinNoiseShader.fStitchTiles,
+                                                  getPaintAlpha(), newPoint);
 }
 
 SkShader::Context* SkPerlinNoiseShader::onCreateContext(const ContextRec& rec,
@@ -456,8 +600,41 @@ void SkPerlinNoiseShader::PerlinNoiseShaderContext::shadeSpan(
         int x, int y, SkPMColor result[], int count) {
     SkPoint point = SkPoint::Make(SkIntToScalar(x), SkIntToScalar(y));
     StitchData stitchData;
+    const SkPerlinNoiseShader& perlinNoiseShader = static_cast<const SkPerlinNoiseShader&>(fShader);
+    // Under a translate, a pixel's noise point is the same whichever way the tile is drawn, so
+    // the pixels that land in the stitch tile can come from its cached noise. Stitched noise
+    // only repeats for the first tile or two, so the rest are still shaded one by one.
+    SkAutoTUnref<SkData> tile;
+    if (perlinNoiseShader.fStitchTiles && !perlinNoiseShader.fTileSize.isEmpty() &&
+        fMatrix.getType() <= SkMatrix::kTranslate_Mask) {
+        tile.reset(perlinNoiseShader.fPaintingData->refTile(perlinNoiseShader.fType,
+                                                            perlinNoiseShader.fNumOctaves,
+                                                            getPaintAlpha(), count));
+    }
+    if (NULL == tile.get()) {
+        for (int i = 0; i < count; ++i) {
+            result[i] = shade(point, stitchData);
+            point.fX += SK_Scalar1;
+        }
+        return;
+    }
+
+    const SkPMColor* tilePixels = static_cast<const SkPMColor*>(tile->data());
+    const int tileWidth = perlinNoiseShader.fTileSize.width();
+    const int tileHeight = perlinNoiseShader.fTileSize.height();
+    const SkScalar tx = fMatrix.getTranslateX();
+    const SkScalar ty = fMatrix.getTranslateY();
+    const SkScalar noiseY = SkScalarRoundToScalar(point.fY + ty);
+    const bool inTileRow = noiseY >= 0 && noiseY < SkIntToScalar(tileHeight);
+    const SkPMColor* tileRow = inTileRow ? tilePixels + SkScalarFloorToInt(noiseY) * tileWidth
+                                         : NULL;
     for (int i = 0; i < count; ++i) {
-        result[i] = shade(point, stitchData);
+        SkScalar noiseX = SkScalarRoundToScalar(point.fX + tx);
+        if (inTileRow && noiseX >= 0 && noiseX < SkIntToScalar(tileWidth)) {
+            result[i] = tileRow[SkScalarFloorToInt(noiseX)];
+        } else {
+            result[i] = shade(point, stitchData);
+        }
         point.fX += SK_Scalar1;
     }
 }
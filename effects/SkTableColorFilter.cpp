@@ -42,6 +42,14 @@ public:
 
     virtual bool asComponentTable(SkBitmap* table) const SK_OVERRIDE;
 
+    virtual uint32_t getFlags() const SK_OVERRIDE {
+        uint32_t flags = this->INHERITED::getFlags();
+        if (!(fFlags & kA_Flag)) {
+            flags |= SkColorFilter::kAlphaUnchanged_Flag;
+        }
+        return flags;
+    }
+
 #if SK_SUPPORT_GPU
     virtual GrEffectRef* asNewEffect(GrContext* context) const SK_OVERRIDE;
 #endif
@@ -128,9 +136,20 @@ void SkTable_ColorFilter::filterSpan(const SkPMColor src[], int count,
         tableB = table;
     }
 
+    // Opaque pixels that stay opaque need neither unpremultiplying nor premultiplying.
+    const bool opaqueStaysOpaque = (255 == tableA[255]);
+
     const SkUnPreMultiply::Scale* scaleTable = SkUnPreMultiply::GetScaleTable();
+    SkPMColor prev = 0;
     for (int i = 0; i < count; ++i) {
         SkPMColor c = src[i];
+        // runs of one color are common, so reuse the previous result
+        if (i > 0 && c == prev) {
+            dst[i] = dst[i - 1];
+            continue;
+        }
+        prev = c;
+
         unsigned a, r, g, b;
         if (0 == c) {
             a = r = g = b = 0;
@@ -140,6 +159,10 @@ void SkTable_ColorFilter::filterSpan(const SkPMColor src[], int count,
             g = SkGetPackedG32(c);
             b = SkGetPackedB32(c);
 
+            if (255 == a && opaqueStaysOpaque) {
+                dst[i] = SkPackARGB32(255, tableR[r], tableG[g], tableB[b]);
+                continue;
+            }
             if (a < 255) {
                 SkUnPreMultiply::Scale scale = scaleTable[a];
                 r = SkUnPreMultiply::ApplyScale(scale, r);
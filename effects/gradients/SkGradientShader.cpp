@@ -6,6 +6,7 @@
  */
 
 #include "SkGradientShaderPriv.h"
+#include "SkGradientTableCache.h"
 #include "SkLinearGradient.h"
 #include "SkRadialGradient.h"
 #include "SkTwoPointRadialGradient.h"
@@ -276,6 +277,49 @@ SkGradientShaderBase::GradientShaderBaseContext::GradientShaderBaseContext(
     if (shader.fColorsAreOpaque) {
         fFlags |= kHasSpan16_Flag;
     }
+
+    SK_COMPILE_ASSERT(kGradientSpanCacheShift == kCache32Shift, span_shift_mismatch);
+    SK_COMPILE_ASSERT(kGradientSpanDitherStride == kDitherStride32, span_stride_mismatch);
+    if (!SkGradientGetPlatformSpanProcs(&fSpanProcs)) {
+        sk_bzero(&fSpanProcs, sizeof(fSpanProcs));
+    }
+
+    fTwoStop = 2 == shader.fColorCount && NULL == shader.fMapper;
+    if (fTwoStop) {
+        this->initTwoStop(shader);
+    }
+}
+
+void SkGradientShaderBase::GradientShaderBaseContext::initTwoStop(
+        const SkGradientShaderBase& shader) {
+    const unsigned paintAlpha = this->getPaintAlpha();
+    SkColor colors[2] = { shader.fOrigColors[0], shader.fOrigColors[1] };
+    unsigned argb[2][4];
+    for (int i = 0; i < 2; ++i) {
+        argb[i][0] = SkMulDiv255Round(SkColorGetA(colors[i]), paintAlpha);
+        argb[i][1] = SkColorGetR(colors[i]);
+        argb[i][2] = SkColorGetG(colors[i]);
+        argb[i][3] = SkColorGetB(colors[i]);
+    }
+
+    // Opaque colors need no premultiplying, whichever space we interpolate in.
+    const bool opaque = 0xFF == argb[0][0] && 0xFF == argb[1][0];
+    fTwoStopIsPremul = opaque ||
+            SkToBool(shader.fGradFlags & SkGradientShader::kInterpolateColorsInPremul_Flag);
+    if (fTwoStopIsPremul && !opaque) {
+        for (int i = 0; i < 2; ++i) {
+            for (int c = 1; c < 4; ++c) {
+                argb[i][c] = SkMulDiv255Round(argb[i][c], argb[i][0]);
+            }
+        }
+    }
+
+    // Like Build32bitCache(), pre-add 1/8 so that each dither row's bias
+    // lands the value in the middle of its quarter.
+    for (int c = 0; c < 4; ++c) {
+        fTwoStopColor0[c] = argb[0][c] + 0.125f;
+        fTwoStopDelta[c] = (float)argb[1][c] - (float)argb[0][c];
+    }
 }
 
 SkGradientShaderBase::GradientShaderCache::GradientShaderCache(
@@ -288,15 +332,35 @@ SkGradientShaderBase::GradientShaderCache::GradientShaderCache(
     // Only initialize the cache in getCache16/32.
     fCache16 = NULL;
     fCache32 = NULL;
-    fCache16Storage = NULL;
+    fCache16PixelRef = NULL;
     fCache32PixelRef = NULL;
 }
 
 SkGradientShaderBase::GradientShaderCache::~GradientShaderCache() {
-    sk_free(fCache16Storage);
+    SkSafeUnref(fCache16PixelRef);
     SkSafeUnref(fCache32PixelRef);
 }
 
+bool SkGradientShaderBase::GradientShaderCache::appendTableKey(int bits,
+                                                               SkTDArray<int32_t>* key) const {
+    if (fShader.fMapper) {
+        return false;
+    }
+    // [bits + alpha + flags + numColors + colors[] + {positions[]}]
+    // The 16 bit table ignores alpha, so that doesn't split it.
+    *key->append() = bits;
+    *key->append() = 32 == bits ? fCacheAlpha : 0;
+    *key->append() = fShader.fGradFlags;
+    *key->append() = fShader.fColorCount;
+    key->append(fShader.fColorCount, (const int32_t*)fShader.fOrigColors);
+    if (fShader.fColorCount > 2) {
+        for (int i = 1; i < fShader.fColorCount; i++) {
+            *key->append() = fShader.fRecs[i].fPos;
+        }
+    }
+    return true;
+}
+
 #define Fixed_To_Dot8(x)        (((x) + 0x80) >> 8)
 
 /** We take the original colors, not our premultiplied PMColors, since we can
@@ -505,13 +569,27 @@ const uint16_t* SkGradientShaderBase::GradientShaderCache::getCache16() {
 }
 
 void SkGradientShaderBase::GradientShaderCache::initCache16(GradientShaderCache* cache) {
-    // double the count for dither entries
-    const int entryCount = kCache16Count * 2;
-    const size_t allocSize = sizeof(uint16_t) * entryCount;
+    SkASSERT(NULL == cache->fCache16PixelRef);
+
+    SkTDArray<int32_t> key;
+    const bool shared = cache->appendTableKey(16, &key);
+    if (shared) {
+        cache->fCache16PixelRef = SkGradientTableCache::FindAndRef(
+                SkGradientTableCache::Key(key.begin(), key.count()));
+        if (cache->fCache16PixelRef) {
+            cache->fCache16 = (uint16_t*)cache->fCache16PixelRef->getAddr();
+            return;
+        }
+    }
+
+    SkImageInfo info;
+    info.fWidth = kCache16Count;
+    info.fHeight = 2;   // double the count for dither entries
+    info.fAlphaType = kOpaque_SkAlphaType;
+    info.fColorType = kRGB_565_SkColorType;
 
-    SkASSERT(NULL == cache->fCache16Storage);
-    cache->fCache16Storage = (uint16_t*)sk_malloc_throw(allocSize);
-    cache->fCache16 = cache->fCache16Storage;
+    cache->fCache16PixelRef = SkMallocPixelRef::NewAllocate(info, 0, NULL);
+    cache->fCache16 = (uint16_t*)cache->fCache16PixelRef->getAddr();
     if (cache->fShader.fColorCount == 2) {
         Build16bitCache(cache->fCache16, cache->fShader.fOrigColors[0],
                         cache->fShader.fOrigColors[1], kCache16Count);
@@ -530,17 +608,23 @@ void SkGradientShaderBase::GradientShaderCache::initCache16(GradientShaderCache*
     }
 
     if (cache->fShader.fMapper) {
-        cache->fCache16Storage = (uint16_t*)sk_malloc_throw(allocSize);
-        uint16_t* linear = cache->fCache16;         // just computed linear data
-        uint16_t* mapped = cache->fCache16Storage;  // storage for mapped data
+        SkMallocPixelRef* newPR = SkMallocPixelRef::NewAllocate(info, 0, NULL);
+        uint16_t* linear = cache->fCache16;             // just computed linear data
+        uint16_t* mapped = (uint16_t*)newPR->getAddr(); // storage for mapped data
         SkUnitMapper* map = cache->fShader.fMapper;
         for (int i = 0; i < kCache16Count; i++) {
             int index = map->mapUnit16(bitsTo16(i, kCache16Bits)) >> kCache16Shift;
             mapped[i] = linear[index];
             mapped[i + kCache16Count] = linear[index + kCache16Count];
         }
-        sk_free(cache->fCache16);
-        cache->fCache16 = cache->fCache16Storage;
+        cache->fCache16PixelRef->unref();
+        cache->fCache16PixelRef = newPR;
+        cache->fCache16 = (uint16_t*)newPR->getAddr();
+    }
+
+    if (shared) {
+        SkGradientTableCache::Add(SkGradientTableCache::Key(key.begin(), key.count()),
+                                  cache->fCache16PixelRef);
     }
 }
 
@@ -552,13 +636,25 @@ const SkPMColor* SkGradientShaderBase::GradientShaderCache::getCache32() {
 }
 
 void SkGradientShaderBase::GradientShaderCache::initCache32(GradientShaderCache* cache) {
+    SkASSERT(NULL == cache->fCache32PixelRef);
+
+    SkTDArray<int32_t> key;
+    const bool shared = cache->appendTableKey(32, &key);
+    if (shared) {
+        cache->fCache32PixelRef = SkGradientTableCache::FindAndRef(
+                SkGradientTableCache::Key(key.begin(), key.count()));
+        if (cache->fCache32PixelRef) {
+            cache->fCache32 = (SkPMColor*)cache->fCache32PixelRef->getAddr();
+            return;
+        }
+    }
+
     SkImageInfo info;
     info.fWidth = kCache32Count;
     info.fHeight = 4;   // for our 4 dither rows
     info.fAlphaType = kPremul_SkAlphaType;
     info.fColorType = kN32_SkColorType;
 
-    SkASSERT(NULL == cache->fCache32PixelRef);
     cache->fCache32PixelRef = SkMallocPixelRef::NewAllocate(info, 0, NULL);
     cache->fCache32 = (SkPMColor*)cache->fCache32PixelRef->getAddr();
     if (cache->fShader.fColorCount == 2) {
@@ -596,6 +692,11 @@ void SkGradientShaderBase::GradientShaderCache::initCache32(GradientShaderCache*
         cache->fCache32PixelRef = newPR;
         cache->fCache32 = (SkPMColor*)newPR->getAddr();
     }
+
+    if (shared) {
+        SkGradientTableCache::Add(SkGradientTableCache::Key(key.begin(), key.count()),
+                                  cache->fCache32PixelRef);
+    }
 }
 
 /*
@@ -618,65 +719,18 @@ SkGradientShaderBase::GradientShaderCache* SkGradientShaderBase::refCache(U8CPU
  *  Because our caller might rebuild the same (logically the same) gradient
  *  over and over, we'd like to return exactly the same "bitmap" if possible,
  *  allowing the client to utilize a cache of our bitmap (e.g. with a GPU).
- *  To do that, we maintain a private cache of built-bitmaps, based on our
- *  colors and positions. Note: we don't try to flatten the fMapper, so if one
- *  is present, we skip the cache for now.
+ *  Without a mapper our 32 bit table comes from SkGradientTableCache, so every
+ *  such gradient already wraps the same pixel ref (and generation ID).
  */
 void SkGradientShaderBase::getGradientTableBitmap(SkBitmap* bitmap) const {
     // our caller assumes no external alpha, so we ensure that our cache is
     // built with 0xFF
     SkAutoTUnref<GradientShaderCache> cache(this->refCache(0xFF));
 
-    // don't have a way to put the mapper into our cache-key yet
-    if (fMapper) {
-        // force our cache32pixelref to be built
-        (void)cache->getCache32();
-        bitmap->setConfig(SkImageInfo::MakeN32Premul(kCache32Count, 1));
-        bitmap->setPixelRef(cache->getCache32PixelRef());
-        return;
-    }
-
-    // build our key: [numColors + colors[] + {positions[]} + flags ]
-    int count = 1 + fColorCount + 1;
-    if (fColorCount > 2) {
-        count += fColorCount - 1;    // fRecs[].fPos
-    }
-
-    SkAutoSTMalloc<16, int32_t> storage(count);
-    int32_t* buffer = storage.get();
-
-    *buffer++ = fColorCount;
-    memcpy(buffer, fOrigColors, fColorCount * sizeof(SkColor));
-    buffer += fColorCount;
-    if (fColorCount > 2) {
-        for (int i = 1; i < fColorCount; i++) {
-            *buffer++ = fRecs[i].fPos;
-        }
-    }
-    *buffer++ = fGradFlags;
-    SkASSERT(buffer - storage.get() == count);
-
-    ///////////////////////////////////
-
-    SK_DECLARE_STATIC_MUTEX(gMutex);
-    static SkBitmapCache* gCache;
-    // each cache cost 1K of RAM, since each bitmap will be 1x256 at 32bpp
-    static const int MAX_NUM_CACHED_GRADIENT_BITMAPS = 32;
-    SkAutoMutexAcquire ama(gMutex);
-
-    if (NULL == gCache) {
-        gCache = SkNEW_ARGS(SkBitmapCache, (MAX_NUM_CACHED_GRADIENT_BITMAPS));
-    }
-    size_t size = count * sizeof(int32_t);
-
-    if (!gCache->find(storage.get(), size, bitmap)) {
-        // force our cahce32pixelref to be built
-        (void)cache->getCache32();
-        bitmap->setConfig(SkImageInfo::MakeN32Premul(kCache32Count, 1));
-        bitmap->setPixelRef(cache->getCache32PixelRef());
-
-        gCache->add(storage.get(), size, *bitmap);
-    }
+    // force our cache32pixelref to be built
+    (void)cache->getCache32();
+    bitmap->setConfig(SkImageInfo::MakeN32Premul(kCache32Count, 1));
+    bitmap->setPixelRef(cache->getCache32PixelRef());
 }
 
 void SkGradientShaderBase::commonAsAGradient(GradientInfo* info, bool flipGrad) const {
@@ -9,6 +9,7 @@
 #define SkGradientShaderPriv_DEFINED
 
 #include "SkGradientShader.h"
+#include "SkGradientShader_opts.h"
 #include "SkClampRange.h"
 #include "SkColorPriv.h"
 #include "SkReadBuffer.h"
@@ -17,7 +18,6 @@
 #include "SkUnitMapper.h"
 #include "SkUtils.h"
 #include "SkTemplates.h"
-#include "SkBitmapCache.h"
 #include "SkShader.h"
 #include "SkOnce.h"
 
@@ -120,7 +120,10 @@ public:
         uint16_t*   fCache16;
         SkPMColor*  fCache32;
 
-        uint16_t*         fCache16Storage;    // Storage for fCache16, allocated on demand.
+        // Storage for fCache16 and fCache32, allocated on demand. Unless the
+        // shader has a mapper these are shared through SkGradientTableCache,
+        // so their pixels must not be written once built.
+        SkMallocPixelRef* fCache16PixelRef;
         SkMallocPixelRef* fCache32PixelRef;
         const unsigned    fCacheAlpha;        // The alpha value we used when we computed the cache.
                                               // Larger than 8bits so we can store uninitialized
@@ -135,6 +138,11 @@ public:
         static void initCache16(GradientShaderCache* cache);
         static void initCache32(GradientShaderCache* cache);
 
+        // Appends everything the table with the given bits (16 or 32) depends
+        // on to key. Returns false if it can't be shared (the shader has a
+        // mapper, which we can't flatten into a key).
+        bool appendTableKey(int bits, SkTDArray<int32_t>* key) const;
+
         static void Build16bitCache(uint16_t[], SkColor c0, SkColor c1, int count);
         static void Build32bitCache(SkPMColor[], SkColor c0, SkColor c1, int count,
                                     U8CPU alpha, uint32_t gradFlags);
@@ -154,7 +162,41 @@ public:
 
         SkAutoTUnref<GradientShaderCache> fCache;
 
+        // The platform's SIMD span procs, all NULL if it has none.
+        SkGradientSpanProcs fSpanProcs;
+
+        // A two-color gradient (without a mapper) can skip the cache, and so
+        // never build it, by interpolating each pixel with twoStopColor().
+        bool        fTwoStop;
+
+        // Returns the same color the cache would hold for the 16-bit index
+        // fi in toggle's dither row, though without rounding fi to 8 bits.
+        SkPMColor twoStopColor(unsigned fi, int toggle) const {
+            SkASSERT(fTwoStop && fi <= 0xFFFF);
+            // The bias each dither row adds on top of the cache's 1/8 (which
+            // is already in fTwoStopColor0), see Build32bitCache().
+            static const float gDitherBias[4] = { 0, 0.5f, 0.75f, 0.25f };
+            const float t = fi * (1.0f / 0xFFFF);
+            const float bias = gDitherBias[toggle >> kCache32Bits];
+            unsigned argb[4];
+            for (int i = 0; i < 4; ++i) {
+                argb[i] = (unsigned)(fTwoStopColor0[i] + t * fTwoStopDelta[i] + bias);
+            }
+            if (fTwoStopIsPremul) {
+                return SkPackARGB32(argb[0], argb[1], argb[2], argb[3]);
+            }
+            return SkPremultiplyARGBInline(argb[0], argb[1], argb[2], argb[3]);
+        }
+
     private:
+        // a, r, g, b at either end, scaled by the paint alpha and, if the
+        // gradient interpolates in premul (or is opaque), premultiplied.
+        float       fTwoStopColor0[4];
+        float       fTwoStopDelta[4];
+        bool        fTwoStopIsPremul;
+
+        void initTwoStop(const SkGradientShaderBase& shader);
+
         typedef SkShader::Context INHERITED;
     };
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGradientTableCache.h"
+
+#include "SkChecksum.h"
+#include "SkMallocPixelRef.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkThread.h"
+
+// A 32 bit table is 4K (256 entries x 4 dither rows), a 16 bit one 1K.
+#ifndef SK_DEFAULT_GRADIENT_TABLE_CACHE_LIMIT
+    #define SK_DEFAULT_GRADIENT_TABLE_CACHE_LIMIT   (256 * 1024)
+#endif
+
+SkGradientTableCache::Key::Key(const int32_t data[], int count) {
+    fData.append(count, data);
+    fHash = SkChecksum::Compute((const uint32_t*)fData.begin(), count * sizeof(int32_t));
+}
+
+bool SkGradientTableCache::Key::operator==(const Key& other) const {
+    return fHash == other.fHash &&
+           fData.count() == other.fData.count() &&
+           0 == memcmp(fData.begin(), other.fData.begin(), fData.count() * sizeof(int32_t));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct Rec {
+    Rec(const SkGradientTableCache::Key& key, SkMallocPixelRef* table)
+        : fKey(key)
+        , fTable(SkRef(table))
+        , fSize(table->getAllocatedSizeInBytes()) {}
+
+    ~Rec() {
+        fTable->unref();
+    }
+
+    static const SkGradientTableCache::Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const SkGradientTableCache::Key& key) { return key.hash(); }
+
+    const SkGradientTableCache::Key fKey;
+    SkMallocPixelRef* const fTable;
+    const size_t fSize;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+/**
+ *  The cache itself, which is only ever touched with gMutex held. fList is
+ *  in most recently used order.
+ */
+class Cache {
+public:
+    Cache() : fBytesUsed(0), fByteLimit(SK_DEFAULT_GRADIENT_TABLE_CACHE_LIMIT) {}
+
+    SkMallocPixelRef* findAndRef(const SkGradientTableCache::Key& key) {
+        Rec* rec = fHash.find(key);
+        if (NULL == rec) {
+            return NULL;
+        }
+        fList.remove(rec);
+        fList.addToHead(rec);
+        return SkRef(rec->fTable);
+    }
+
+    void add(const SkGradientTableCache::Key& key, SkMallocPixelRef* table) {
+        const size_t size = table->getAllocatedSizeInBytes();
+        if (size > fByteLimit || NULL != fHash.find(key)) {
+            return;
+        }
+        Rec* rec = SkNEW_ARGS(Rec, (key, table));
+        fHash.add(rec);
+        fList.addToHead(rec);
+        fBytesUsed += size;
+        this->purgeAsNeeded();
+    }
+
+    size_t bytesUsed() const { return fBytesUsed; }
+    size_t byteLimit() const { return fByteLimit; }
+
+    size_t setByteLimit(size_t newLimit) {
+        size_t prevLimit = fByteLimit;
+        fByteLimit = newLimit;
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
+
+private:
+    // Tables still ref'd by a shader outlive their Rec, they just stop being
+    // shared with gradients created later.
+    void purgeAsNeeded() {
+        while (fBytesUsed > fByteLimit) {
+            Rec* rec = fList.tail();
+            SkASSERT(NULL != rec);
+            fList.remove(rec);
+            fHash.remove(rec->fKey);
+            fBytesUsed -= rec->fSize;
+            SkDELETE(rec);
+        }
+    }
+
+    SkTDynamicHash<Rec, SkGradientTableCache::Key> fHash;
+    SkTInternalLList<Rec> fList;
+    size_t fBytesUsed;
+    size_t fByteLimit;
+};
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+
+// Must be called with gMutex held. Like SkBlurMaskCache, the cache lives for
+// the life of the process.
+Cache* get_cache() {
+    static Cache* gCache;
+    if (NULL == gCache) {
+        gCache = SkNEW(Cache);
+    }
+    return gCache;
+}
+
+}  // namespace
+
+SkMallocPixelRef* SkGradientTableCache::FindAndRef(const Key& key) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->findAndRef(key);
+}
+
+void SkGradientTableCache::Add(const Key& key, SkMallocPixelRef* table) {
+    SkASSERT(NULL != table);
+    SkAutoMutexAcquire am(gMutex);
+    get_cache()->add(key, table);
+}
+
+size_t SkGradientTableCache::GetBytesUsed() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->bytesUsed();
+}
+
+size_t SkGradientTableCache::GetByteLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->byteLimit();
+}
+
+size_t SkGradientTableCache::SetByteLimit(size_t newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setByteLimit(newLimit);
+}
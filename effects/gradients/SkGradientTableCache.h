@@ -0,0 +1,58 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGradientTableCache_DEFINED
+#define SkGradientTableCache_DEFINED
+
+#include "SkTDArray.h"
+
+class SkMallocPixelRef;
+
+/**
+ *  A global, thread-safe, byte-limited LRU cache of the color tables built by
+ *  SkGradientShaderBase. Gradients with the same colors, positions and flags
+ *  (typically the same gradient recreated every frame) share one table, so
+ *  only the first of them pays for building it. Since the shared table is the
+ *  same pixel ref, its generation ID also lets GrTextureStripAtlas share a row.
+ */
+class SkGradientTableCache {
+public:
+    /**
+     *  Everything a table depends on, flattened into ints by the caller. Two
+     *  keys compare equal only if their data does.
+     */
+    class Key {
+    public:
+        Key(const int32_t data[], int count);
+
+        bool operator==(const Key& other) const;
+        uint32_t hash() const { return fHash; }
+
+    private:
+        SkTDArray<int32_t> fData;
+        uint32_t           fHash;
+    };
+
+    /**
+     *  Returns the table cached for key, ref'd for the caller, or NULL. The
+     *  caller must treat its pixels as read-only.
+     */
+    static SkMallocPixelRef* FindAndRef(const Key& key);
+
+    /**
+     *  Adds table to the cache, which takes its own ref. The table's pixels
+     *  must not change afterwards. Tables too large for the cache, or keys
+     *  already present, are ignored.
+     */
+    static void Add(const Key& key, SkMallocPixelRef* table);
+
+    static size_t GetBytesUsed();
+    static size_t GetByteLimit();
+    static size_t SetByteLimit(size_t newLimit);
+};
+
+#endif
@@ -109,7 +109,7 @@ namespace {
 
 typedef void (*LinearShadeProc)(TileProc proc, SkFixed dx, SkFixed fx,
                                 SkPMColor* dstC, const SkPMColor* cache,
-                                int toggle, int count);
+                                int toggle, int count, const SkGradientSpanProcs& procs);
 
 // Linear interpolation (lerp) is unnecessary if there are no sharp
 // discontinuities in the gradient - which must be true if there are
@@ -117,7 +117,8 @@ typedef void (*LinearShadeProc)(TileProc proc, SkFixed dx, SkFixed fx,
 void shadeSpan_linear_vertical_lerp(TileProc proc, SkFixed dx, SkFixed fx,
                                     SkPMColor* SK_RESTRICT dstC,
                                     const SkPMColor* SK_RESTRICT cache,
-                                    int toggle, int count) {
+                                    int toggle, int count,
+                                    const SkGradientSpanProcs& procs) {
     // We're a vertical gradient, so no change in a span.
     // If colors change sharply across the gradient, dithering is
     // insufficient (it subsamples the color space) and we need to lerp.
@@ -140,7 +141,8 @@ void shadeSpan_linear_vertical_lerp(TileProc proc, SkFixed dx, SkFixed fx,
 void shadeSpan_linear_clamp(TileProc proc, SkFixed dx, SkFixed fx,
                             SkPMColor* SK_RESTRICT dstC,
                             const SkPMColor* SK_RESTRICT cache,
-                            int toggle, int count) {
+                            int toggle, int count,
+                            const SkGradientSpanProcs& procs) {
     SkClampRange range;
     range.init(fx, dx, count, 0, SkGradientShaderBase::kCache32Count - 1);
 
@@ -151,7 +153,13 @@ void shadeSpan_linear_clamp(TileProc proc, SkFixed dx, SkFixed fx,
             count);
         dstC += count;
     }
-    if ((count = range.fCount1) > 0) {
+    if ((count = range.fCount1) > 0 && NULL != procs.fLinear) {
+        procs.fLinear(range.fFx1, dx, dstC, cache, toggle, count);
+        dstC += count;
+        if (count & 1) {
+            toggle = next_dither_toggle(toggle);
+        }
+    } else if (count > 0) {
         int unroll = count >> 3;
         fx = range.fFx1;
         for (int i = 0; i < unroll; i++) {
@@ -177,7 +185,12 @@ void shadeSpan_linear_clamp(TileProc proc, SkFixed dx, SkFixed fx,
 void shadeSpan_linear_mirror(TileProc proc, SkFixed dx, SkFixed fx,
                              SkPMColor* SK_RESTRICT dstC,
                              const SkPMColor* SK_RESTRICT cache,
-                             int toggle, int count) {
+                             int toggle, int count,
+                             const SkGradientSpanProcs& procs) {
+    if (NULL != procs.fLinearMirror) {
+        procs.fLinearMirror(fx, dx, dstC, cache, toggle, count);
+        return;
+    }
     do {
         unsigned fi = mirror_8bits(fx >> 8);
         SkASSERT(fi <= 0xFF);
@@ -190,7 +203,11 @@ void shadeSpan_linear_mirror(TileProc proc, SkFixed dx, SkFixed fx,
 void shadeSpan_linear_repeat(TileProc proc, SkFixed dx, SkFixed fx,
         SkPMColor* SK_RESTRICT dstC,
         const SkPMColor* SK_RESTRICT cache,
-        int toggle, int count) {
+        int toggle, int count, const SkGradientSpanProcs& procs) {
+    if (NULL != procs.fLinearRepeat) {
+        procs.fLinearRepeat(fx, dx, dstC, cache, toggle, count);
+        return;
+    }
     do {
         unsigned fi = repeat_8bits(fx >> 8);
         SkASSERT(fi <= 0xFF);
@@ -211,7 +228,6 @@ void SkLinearGradient::LinearGradientContext::shadeSpan(int x, int y, SkPMColor*
     SkPoint             srcPt;
     SkMatrix::MapXYProc dstProc = fDstToIndexProc;
     TileProc            proc = linearGradient.fTileProc;
-    const SkPMColor* SK_RESTRICT cache = fCache->getCache32();
     int                 toggle = init_dither_toggle(x, y);
 
     if (fDstToIndexClass != kPerspective_MatrixClass) {
@@ -228,6 +244,25 @@ void SkLinearGradient::LinearGradientContext::shadeSpan(int x, int y, SkPMColor*
             dx = SkScalarToFixed(fDstToIndex.getScaleX());
         }
 
+        if (fTwoStop) {
+            // Two-color gradients are interpolated directly, without the cache.
+            if (0 == dx) {
+                unsigned fi = proc(fx);
+                sk_memset32_dither(dstC, this->twoStopColor(fi, toggle),
+                                   this->twoStopColor(fi, next_dither_toggle(toggle)),
+                                   count);
+                return;
+            }
+            do {
+                *dstC++ = this->twoStopColor(proc(fx), toggle);
+                toggle = next_dither_toggle(toggle);
+                fx += dx;
+            } while (--count != 0);
+            return;
+        }
+
+        const SkPMColor* SK_RESTRICT cache = fCache->getCache32();
+
         LinearShadeProc shadeProc = shadeSpan_linear_repeat;
         if (0 == dx) {
             shadeProc = shadeSpan_linear_vertical_lerp;
@@ -238,8 +273,9 @@ void SkLinearGradient::LinearGradientContext::shadeSpan(int x, int y, SkPMColor*
         } else {
             SkASSERT(SkShader::kRepeat_TileMode == linearGradient.fTileMode);
         }
-        (*shadeProc)(proc, dx, fx, dstC, cache, toggle, count);
+        (*shadeProc)(proc, dx, fx, dstC, cache, toggle, count, fSpanProcs);
     } else {
+        const SkPMColor* SK_RESTRICT cache = fCache->getCache32();
         SkScalar    dstX = SkIntToScalar(x);
         SkScalar    dstY = SkIntToScalar(y);
         do {
@@ -425,7 +461,7 @@ void SkLinearGradient::LinearGradientContext::shadeSpan16(int x, int y,
         } else {
             SkASSERT(SkShader::kRepeat_TileMode == linearGradient.fTileMode);
         }
-        (*shadeProc)(proc, dx, fx, dstC, cache, toggle, count);
+        (*shadeProc)(proc, dx, fx, dstC, cache, toggle, count, fSpanProcs);
     } else {
         SkScalar    dstX = SkIntToScalar(x);
         SkScalar    dstY = SkIntToScalar(y);
@@ -309,13 +309,13 @@ inline bool no_need_for_radial_pin(int fx, int dx,
 typedef void (* RadialShadeProc)(SkScalar sfx, SkScalar sdx,
         SkScalar sfy, SkScalar sdy,
         SkPMColor* dstC, const SkPMColor* cache,
-        int count, int toggle);
+        int count, int toggle, const SkGradientSpanProcs& procs);
 
 // On Linux, this is faster with SkPMColor[] params than SkPMColor* SK_RESTRICT
 void shadeSpan_radial_clamp(SkScalar sfx, SkScalar sdx,
         SkScalar sfy, SkScalar sdy,
         SkPMColor* SK_RESTRICT dstC, const SkPMColor* SK_RESTRICT cache,
-        int count, int toggle) {
+        int count, int toggle, const SkGradientSpanProcs& procs) {
     // Floating point seems to be slower than fixed point,
     // even when we have float hardware.
     const uint8_t* SK_RESTRICT sqrt_table = gSqrt8Table;
@@ -341,6 +341,10 @@ void shadeSpan_radial_clamp(SkScalar sfx, SkScalar sdx,
         if (count) {
             UNPINNED_RADIAL_STEP;
         }
+    } else if (NULL != procs.fRadialClamp) {
+        SK_COMPILE_ASSERT(kGradientSpanSqrtTableBits == kSQRT_TABLE_BITS, sqrt_bits_mismatch);
+        SK_COMPILE_ASSERT(0 == SkGradientShaderBase::kSqrt32Shift, sqrt_shift_not_zero);
+        procs.fRadialClamp(fx, dx, fy, dy, dstC, cache, sqrt_table, toggle, count);
     } else  {
         // Specializing for dy == 0 gains us 25% on Skia benchmarks
         if (dy == 0) {
@@ -391,13 +395,13 @@ void shadeSpan_radial(SkScalar fx, SkScalar dx, SkScalar fy, SkScalar dy,
 
 void shadeSpan_radial_mirror(SkScalar fx, SkScalar dx, SkScalar fy, SkScalar dy,
                              SkPMColor* SK_RESTRICT dstC, const SkPMColor* SK_RESTRICT cache,
-                             int count, int toggle) {
+                             int count, int toggle, const SkGradientSpanProcs&) {
     shadeSpan_radial<mirror_tileproc_nonstatic>(fx, dx, fy, dy, dstC, cache, count, toggle);
 }
 
 void shadeSpan_radial_repeat(SkScalar fx, SkScalar dx, SkScalar fy, SkScalar dy,
                              SkPMColor* SK_RESTRICT dstC, const SkPMColor* SK_RESTRICT cache,
-                             int count, int toggle) {
+                             int count, int toggle, const SkGradientSpanProcs&) {
     shadeSpan_radial<repeat_tileproc_nonstatic>(fx, dx, fy, dy, dstC, cache, count, toggle);
 }
 
@@ -439,7 +443,7 @@ void SkRadialGradient::RadialGradientContext::shadeSpan(int x, int y,
         } else {
             SkASSERT(SkShader::kRepeat_TileMode == radialGradient.fTileMode);
         }
-        (*shadeProc)(srcPt.fX, sdx, srcPt.fY, sdy, dstC, cache, count, toggle);
+        (*shadeProc)(srcPt.fX, sdx, srcPt.fY, sdy, dstC, cache, count, toggle, fSpanProcs);
     } else {    // perspective case
         SkScalar dstX = SkIntToScalar(x);
         SkScalar dstY = SkIntToScalar(y);
@@ -19,6 +19,8 @@ struct TwoPtRadialContext {
     TwoPtRadialContext(const TwoPtRadial& rec, SkScalar fx, SkScalar fy,
                        SkScalar dfx, SkScalar dfy);
     SkFixed nextT();
+    SkFixed nextConcentricT();
+    SkFixed nextFocalOnCircleT();
 };
 
 static int valid_divide(float numer, float denom, float* ratio) {
@@ -91,6 +93,17 @@ void TwoPtRadial::init(const SkPoint& center0, SkScalar rad0,
     fA = sqr(fDCenterX) + sqr(fDCenterY) - sqr(fDRadius);
     fRadius2 = sqr(fRadius);
     fRDR = fRadius * fDRadius;
+    fInvDRadius = 0 == fDRadius ? 0 : 1 / fDRadius;
+
+    if (0 == fDCenterX && 0 == fDCenterY) {
+        // The radii differ, or the gradient would be degenerate.
+        SkASSERT(0 != fDRadius);
+        fType = kConcentric_Type;
+    } else if (0 == fA) {
+        fType = kFocalOnCircle_Type;
+    } else {
+        fType = kGeneral_Type;
+    }
 
     fFlipped = flipped;
 }
@@ -133,52 +146,69 @@ SkFixed TwoPtRadialContext::nextT() {
     return SkFloatToFixed(t);
 }
 
-typedef void (*TwoPointConicalProc)(TwoPtRadialContext* rec, SkPMColor* dstC,
-                                    const SkPMColor* cache, int toggle, int count);
+// With the same centers the quadratic is (r0 + dr*t)^2 = |p - c|^2, so the root with a
+// positive radius is t = (|p - c| - r0) / dr.
+SkFixed TwoPtRadialContext::nextConcentricT() {
+    float dist = sk_float_sqrt(sqr(fRelX) + sqr(fRelY));
 
-static void twopoint_clamp(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC,
-                           const SkPMColor* SK_RESTRICT cache, int toggle,
-                           int count) {
-    for (; count > 0; --count) {
-        SkFixed t = rec->nextT();
-        if (TwoPtRadial::DontDrawT(t)) {
-            *dstC++ = 0;
-        } else {
-            SkFixed index = SkClampMax(t, 0xFFFF);
-            SkASSERT(index <= 0xFFFF);
-            *dstC++ = cache[toggle +
-                            (index >> SkGradientShaderBase::kCache32Shift)];
-        }
-        toggle = next_dither_toggle(toggle);
+    fRelX += fIncX;
+    fRelY += fIncY;
+
+    if (0 == dist) {
+        // Both roots have a zero radius.
+        return TwoPtRadial::kDontDrawT;
     }
+    return SkFloatToFixed((dist - fRec.fRadius) * fRec.fInvDRadius);
 }
 
-static void twopoint_repeat(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC,
-                            const SkPMColor* SK_RESTRICT cache, int toggle,
-                            int count) {
-    for (; count > 0; --count) {
-        SkFixed t = rec->nextT();
-        if (TwoPtRadial::DontDrawT(t)) {
-            *dstC++ = 0;
-        } else {
-            SkFixed index = repeat_tileproc(t);
-            SkASSERT(index <= 0xFFFF);
-            *dstC++ = cache[toggle +
-                            (index >> SkGradientShaderBase::kCache32Shift)];
-        }
-        toggle = next_dither_toggle(toggle);
+// With fA == 0 there is a single root, t = -C / B.
+SkFixed TwoPtRadialContext::nextFocalOnCircleT() {
+    float C = sqr(fRelX) + sqr(fRelY) - fRec.fRadius2;
+    float B = fB;
+
+    fRelX += fIncX;
+    fRelY += fIncY;
+    fB += fDB;
+
+    if (0 == B) {
+        return TwoPtRadial::kDontDrawT;
+    }
+    float t = -C / B;
+    if (lerp(fRec.fRadius, fRec.fDRadius, t) <= 0) {
+        return TwoPtRadial::kDontDrawT;
     }
+    return SkFloatToFixed(t);
 }
 
-static void twopoint_mirror(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC,
-                            const SkPMColor* SK_RESTRICT cache, int toggle,
-                            int count) {
+typedef void (*TwoPointConicalProc)(TwoPtRadialContext* rec, SkPMColor* dstC,
+                                    const SkPMColor* cache, int toggle, int count);
+
+// One proc per shape and tile mode, so the span loop neither dispatches on the shape nor
+// branches through the general quadratic's cases for every pixel.
+template <TwoPtRadial::Type kType, SkShader::TileMode kTileMode>
+static void twopoint_proc(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC,
+                          const SkPMColor* SK_RESTRICT cache, int toggle,
+                          int count) {
     for (; count > 0; --count) {
-        SkFixed t = rec->nextT();
+        SkFixed t;
+        if (TwoPtRadial::kConcentric_Type == kType) {
+            t = rec->nextConcentricT();
+        } else if (TwoPtRadial::kFocalOnCircle_Type == kType) {
+            t = rec->nextFocalOnCircleT();
+        } else {
+            t = rec->nextT();
+        }
         if (TwoPtRadial::DontDrawT(t)) {
             *dstC++ = 0;
         } else {
-            SkFixed index = mirror_tileproc(t);
+            SkFixed index;
+            if (SkShader::kClamp_TileMode == kTileMode) {
+                index = SkClampMax(t, 0xFFFF);
+            } else if (SkShader::kMirror_TileMode == kTileMode) {
+                index = mirror_tileproc(t);
+            } else {
+                index = repeat_tileproc(t);
+            }
             SkASSERT(index <= 0xFFFF);
             *dstC++ = cache[toggle +
                             (index >> SkGradientShaderBase::kCache32Shift)];
@@ -187,6 +217,25 @@ static void twopoint_mirror(TwoPtRadialContext* rec, SkPMColor* SK_RESTRICT dstC
     }
 }
 
+// Indexed by TwoPtRadial::Type, then SkShader::TileMode.
+static const TwoPointConicalProc gTwoPointConicalProcs[][SkShader::kTileModeCount] = {
+    {
+        twopoint_proc<TwoPtRadial::kConcentric_Type, SkShader::kClamp_TileMode>,
+        twopoint_proc<TwoPtRadial::kConcentric_Type, SkShader::kRepeat_TileMode>,
+        twopoint_proc<TwoPtRadial::kConcentric_Type, SkShader::kMirror_TileMode>,
+    },
+    {
+        twopoint_proc<TwoPtRadial::kFocalOnCircle_Type, SkShader::kClamp_TileMode>,
+        twopoint_proc<TwoPtRadial::kFocalOnCircle_Type, SkShader::kRepeat_TileMode>,
+        twopoint_proc<TwoPtRadial::kFocalOnCircle_Type, SkShader::kMirror_TileMode>,
+    },
+    {
+        twopoint_proc<TwoPtRadial::kGeneral_Type, SkShader::kClamp_TileMode>,
+        twopoint_proc<TwoPtRadial::kGeneral_Type, SkShader::kRepeat_TileMode>,
+        twopoint_proc<TwoPtRadial::kGeneral_Type, SkShader::kMirror_TileMode>,
+    },
+};
+
 void SkTwoPointConicalGradient::init() {
     fRec.init(fCenter1, fRadius1, fCenter2, fRadius2, fFlippedGrad);
     fPtsToUnit.reset();
@@ -253,14 +302,10 @@ void SkTwoPointConicalGradient::TwoPointConicalGradientContext::shadeSpan(
 
     const SkPMColor* SK_RESTRICT cache = fCache->getCache32();
 
-    TwoPointConicalProc shadeProc = twopoint_repeat;
-    if (SkShader::kClamp_TileMode == twoPointConicalGradient.fTileMode) {
-        shadeProc = twopoint_clamp;
-    } else if (SkShader::kMirror_TileMode == twoPointConicalGradient.fTileMode) {
-        shadeProc = twopoint_mirror;
-    } else {
-        SkASSERT(SkShader::kRepeat_TileMode == twoPointConicalGradient.fTileMode);
-    }
+    SkASSERT(twoPointConicalGradient.fTileMode < SkShader::kTileModeCount);
+    TwoPointConicalProc shadeProc =
+            gTwoPointConicalProcs[twoPointConicalGradient.fRec.fType]
+                                 [twoPointConicalGradient.fTileMode];
 
     if (fDstToIndexClass != kPerspective_MatrixClass) {
         SkPoint srcPt;
@@ -18,6 +18,13 @@ struct TwoPtRadial {
         kDontDrawT  = 0x80000000
     };
 
+    // The shapes whose t can be found without the general quadratic.
+    enum Type {
+        kConcentric_Type,       // same centers: t comes from the distance to the center
+        kFocalOnCircle_Type,    // fA == 0: the quadratic is linear
+        kGeneral_Type
+    };
+
     float   fCenterX, fCenterY;
     float   fDCenterX, fDCenterY;
     float   fRadius;
@@ -25,6 +32,8 @@ struct TwoPtRadial {
     float   fA;
     float   fRadius2;
     float   fRDR;
+    float   fInvDRadius;
+    Type    fType;
     bool    fFlipped;
 
     void init(const SkPoint& center0, SkScalar rad0,
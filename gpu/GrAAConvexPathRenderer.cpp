@@ -13,7 +13,9 @@
 #include "GrDrawTargetCaps.h"
 #include "GrEffect.h"
 #include "GrPathUtils.h"
+#include "GrResourceCache.h"
 #include "GrTBackendEffectFactory.h"
+#include "SkChecksum.h"
 #include "SkString.h"
 #include "SkStrokeRec.h"
 #include "SkTraceEvent.h"
@@ -623,6 +625,122 @@ extern const GrVertexAttrib gPathAttribs[] = {
 
 };
 
+// Key for the vertices of a path drawn under a matrix without perspective or translation.
+static GrResourceKey compute_tessellation_key(const SkPath& path, const SkMatrix& linear) {
+    static const GrResourceKey::ResourceType gTessellationType =
+        GrResourceKey::GenerateResourceType();
+    static const GrCacheID::Domain gAAConvexTessellationDomain = GrCacheID::GenerateDomain();
+
+    // The AA edges are computed in device space, so the vertices depend on the exact scale and
+    // skew. The generation ID goes into the key as is; those are hashed three ways into the
+    // remaining 96 bits.
+    const SkScalar data[] = {
+        linear.getScaleX(),
+        linear.getSkewX(),
+        linear.getSkewY(),
+        linear.getScaleY(),
+    };
+    GrCacheID::Key key;
+    key.fData32[0] = path.getGenerationID();
+    for (int i = 1; i < 4; ++i) {
+        key.fData32[i] = SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(data),
+                                             sizeof(data), i);
+    }
+    return GrResourceKey(GrCacheID(gAAConvexTessellationDomain, key), gTessellationType, 0);
+}
+
+// Tessellates the path as onDrawPath() does, but in the space of linear, into static buffers.
+static GrTessellatedPath* create_tessellation(const SkPath& path, const SkMatrix& linear,
+                                              GrGpu* gpu) {
+    enum {
+        kPreallocSegmentCnt = 512 / sizeof(Segment),
+        kPreallocDrawCnt = 4,
+    };
+    SkSTArray<kPreallocSegmentCnt, Segment, true> segments;
+    SkPoint fanPt;
+    int vCount;
+    int iCount;
+    SkRect bounds;
+    if (!get_segments(path, linear, &segments, &fanPt, &vCount, &iCount, &bounds)) {
+        return NULL;
+    }
+    bounds.outset(SK_Scalar1, SK_Scalar1);
+
+    SkAutoTMalloc<QuadVertex> verts(vCount);
+    SkAutoTMalloc<uint16_t> idxs(iCount);
+    SkSTArray<kPreallocDrawCnt, Draw, true> draws;
+    create_vertices(segments, fanPt, &draws, verts.get(), idxs.get());
+
+    SkSTArray<kPreallocDrawCnt, GrTessellatedPath::Draw, true> tessDraws(draws.count());
+    for (int i = 0; i < draws.count(); ++i) {
+        GrTessellatedPath::Draw& draw = tessDraws.push_back();
+        draw.fVertexCnt = draws[i].fVertexCnt;
+        draw.fIndexCnt = draws[i].fIndexCnt;
+    }
+    return GrTessellatedPath::Create(gpu, kTriangles_GrPrimitiveType, verts.get(),
+                                     sizeof(QuadVertex), vCount, idxs.get(), iCount,
+                                     tessDraws.begin(), tessDraws.count(), bounds);
+}
+
+bool GrAAConvexPathRenderer::drawCachedPath(const SkPath& path, GrDrawTarget* target) {
+    const SkMatrix& viewMatrix = target->getDrawState().getViewMatrix();
+    SkMatrix linear = viewMatrix;
+    linear.setTranslateX(0);
+    linear.setTranslateY(0);
+    SkMatrix invLinear;
+    if (!linear.invert(&invLinear)) {
+        return false;
+    }
+
+    GrResourceKey key = compute_tessellation_key(path, linear);
+    GrContext* context = target->getContext();
+    SkAutoTUnref<GrTessellatedPath> tess(
+        static_cast<GrTessellatedPath*>(context->findAndRefCachedResource(key)));
+    if (NULL == tess.get()) {
+        if (!fRecentKeys.checkAndAdd(key)) {
+            return false;
+        }
+        tess.reset(create_tessellation(path, linear, context->getGpu()));
+        if (NULL == tess.get()) {
+            return false;
+        }
+        context->addResourceToCache(key, tess.get());
+    }
+
+    // Preconcatenating the inverse of the linear part leaves just the translation, which
+    // moves the cached vertices to where the path is now drawn.
+    GrDrawTarget::AutoStateRestore asr(target, GrDrawTarget::kPreserve_ASRInit, &invLinear);
+    GrDrawState* drawState = target->drawState();
+    drawState->setVertexAttribs<gPathAttribs>(SK_ARRAY_COUNT(gPathAttribs));
+    SkASSERT(sizeof(QuadVertex) == drawState->getVertexSize());
+
+    static const int kEdgeAttrIndex = 1;
+    GrEffectRef* quadEffect = QuadEdgeEffect::Create();
+    drawState->addCoverageEffect(quadEffect, kEdgeAttrIndex)->unref();
+
+    SkRect devBounds = tess->bounds();
+    devBounds.offset(viewMatrix.getTranslateX(), viewMatrix.getTranslateY());
+
+    target->setVertexSourceToBuffer(tess->vertexBuffer());
+    target->setIndexSourceToBuffer(tess->indexBuffer());
+    int vOffset = 0;
+    int iOffset = 0;
+    for (int i = 0; i < tess->draws().count(); ++i) {
+        const GrTessellatedPath::Draw& draw = tess->draws()[i];
+        target->drawIndexed(kTriangles_GrPrimitiveType,
+                            vOffset,  // start vertex
+                            iOffset,  // start index
+                            draw.fVertexCnt,
+                            draw.fIndexCnt,
+                            &devBounds);
+        vOffset += draw.fVertexCnt;
+        iOffset += draw.fIndexCnt;
+    }
+    target->resetVertexSource();
+    target->resetIndexSource();
+    return true;
+}
+
 bool GrAAConvexPathRenderer::onDrawPath(const SkPath& origPath,
                                         const SkStrokeRec&,
                                         GrDrawTarget* target,
@@ -634,6 +752,13 @@ bool GrAAConvexPathRenderer::onDrawPath(const SkPath& origPath,
     }
 
     SkMatrix viewMatrix = target->getDrawState().getViewMatrix();
+
+    // Without perspective the vertices don't depend on the translation, so those of a path
+    // drawn before are reused.
+    if (!viewMatrix.hasPerspective() && this->drawCachedPath(origPath, target)) {
+        return true;
+    }
+
     GrDrawTarget::AutoStateRestore asr;
     if (!asr.setIdentity(target, GrDrawTarget::kPreserve_ASRInit)) {
         return false;
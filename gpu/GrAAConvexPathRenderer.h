@@ -7,6 +7,7 @@
  */
 
 #include "GrPathRenderer.h"
+#include "GrTessellatedPath.h"
 
 
 class GrAAConvexPathRenderer : public GrPathRenderer {
@@ -23,4 +24,10 @@ protected:
                             const SkStrokeRec& stroke,
                             GrDrawTarget* target,
                             bool antiAlias) SK_OVERRIDE;
+
+private:
+    // Draws the path from, or into, the GrResourceCache. Returns false if it didn't draw it.
+    bool drawCachedPath(const SkPath& path, GrDrawTarget* target);
+
+    GrTessellatedPath::RecentKeys fRecentKeys;
 };
@@ -0,0 +1,327 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrAADistanceFieldPathRenderer.h"
+
+#include "GrContext.h"
+#include "GrDrawState.h"
+#include "GrDrawTargetCaps.h"
+#include "GrTexture.h"
+#include "effects/GrDistanceFieldTextureEffect.h"
+
+#include "SkDistanceFieldGen.h"
+#include "SkDraw.h"
+#include "SkRasterClip.h"
+
+#define ATLAS_TEXTURE_WIDTH  1024
+#define ATLAS_TEXTURE_HEIGHT 1024
+
+#define PLOT_WIDTH  256
+#define PLOT_HEIGHT 256
+
+#define NUM_PLOTS_X (ATLAS_TEXTURE_WIDTH / PLOT_WIDTH)
+#define NUM_PLOTS_Y (ATLAS_TEXTURE_HEIGHT / PLOT_HEIGHT)
+
+// Distance fields are only built at these sizes, so that a path drawn at many scales costs at
+// most three of them. Each is drawn at up to twice its size before the next one up is used.
+static const int kSmallMIP = 32;
+static const int kMediumMIP = 64;
+static const int kLargeMIP = 128;
+
+// A largest field with its padding must fit in a plot.
+SK_COMPILE_ASSERT(kLargeMIP + 2 * (SK_DistanceFieldPad + 1) <= PLOT_WIDTH, large_mip_too_big);
+
+////////////////////////////////////////////////////////////////////////////////
+GrAADistanceFieldPathRenderer::GrAADistanceFieldPathRenderer(GrContext* context)
+    : fContext(context)
+    , fAtlasMgr(NULL) {
+}
+
+GrAADistanceFieldPathRenderer::~GrAADistanceFieldPathRenderer() {
+    PathDataList::Iter iter;
+    iter.init(fPathList, PathDataList::Iter::kHead_IterStart);
+    PathData* pathData;
+    while ((pathData = iter.get()) != NULL) {
+        iter.next();
+        fPathList.remove(pathData);
+        SkDELETE(pathData);
+    }
+
+    SkDELETE(fAtlasMgr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool GrAADistanceFieldPathRenderer::canDrawPath(const SkPath& path,
+                                                const SkStrokeRec& stroke,
+                                                const GrDrawTarget* target,
+                                                bool antiAlias) const {
+    // TODO: Support inverse fill
+    // TODO: Support strokes
+    if (!target->caps()->shaderDerivativeSupport() || !antiAlias || path.isInverseFillType() ||
+        !stroke.isFillStyle()) {
+        return false;
+    }
+
+    // currently don't support perspective
+    const SkMatrix& vm = target->getDrawState().getViewMatrix();
+    if (vm.hasPerspective()) {
+        return false;
+    }
+
+    // only support paths smaller than 2*kLargeMIP in device space
+    const SkRect& bounds = path.getBounds();
+    if (bounds.isEmpty()) {
+        return false;
+    }
+    SkScalar maxDim = SkMaxScalar(bounds.width(), bounds.height());
+    return maxDim * vm.getMaxStretch() <= 2 * kLargeMIP;
+}
+
+GrPathRenderer::StencilSupport GrAADistanceFieldPathRenderer::onGetStencilSupport(
+                                                                    const SkPath&,
+                                                                    const SkStrokeRec&,
+                                                                    const GrDrawTarget*) const {
+    return GrPathRenderer::kNoSupport_StencilSupport;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// position + texture coord
+extern const GrVertexAttrib gSDFPathVertexAttribs[] = {
+    {kVec2f_GrVertexAttribType, 0,               kPosition_GrVertexAttribBinding},
+    {kVec2f_GrVertexAttribType, sizeof(SkPoint), kEffect_GrVertexAttribBinding}
+};
+static const size_t kSDFPathVASize = 2 * sizeof(SkPoint);
+
+}
+
+bool GrAADistanceFieldPathRenderer::onDrawPath(const SkPath& path,
+                                               const SkStrokeRec& stroke,
+                                               GrDrawTarget* target,
+                                               bool antiAlias) {
+    // we've already bailed on inverse filled paths, so this is safe
+    if (path.isEmpty()) {
+        return true;
+    }
+
+    SkASSERT(NULL != fContext);
+
+    GrDrawState* drawState = target->drawState();
+    const SkMatrix& vm = drawState->getViewMatrix();
+
+    // pick the distance field size from the path's size on the device
+    const SkRect& bounds = path.getBounds();
+    SkScalar maxDim = SkMaxScalar(bounds.width(), bounds.height());
+    SkScalar size = maxDim * vm.getMaxStretch();
+    uint32_t desiredDimension;
+    if (size <= 2 * kSmallMIP) {
+        desiredDimension = kSmallMIP;
+    } else if (size <= 2 * kMediumMIP) {
+        desiredDimension = kMediumMIP;
+    } else {
+        desiredDimension = kLargeMIP;
+    }
+
+    // check to see if path is cached
+    PathData::Key key;
+    key.fGenID = path.getGenerationID();
+    key.fDimension = desiredDimension;
+    PathData* pathData = fPathCache.find(key);
+    if (NULL == pathData || NULL == pathData->fPlot) {
+        if (NULL != pathData) {
+            // its plot was given to another path, so just build it again
+            fPathList.remove(pathData);
+            fPathCache.remove(pathData->fKey);
+            SkDELETE(pathData);
+        }
+        SkScalar scale = desiredDimension / maxDim;
+        pathData = this->addPathToAtlas(path, stroke, antiAlias, desiredDimension, scale);
+        if (NULL == pathData) {
+            return false;
+        }
+    } else {
+        fPathList.remove(pathData);
+    }
+    fPathList.addToHead(pathData);
+
+    // set up the draw state
+    GrPlot* plot = pathData->fPlot;
+    GrTexture* texture = plot->texture();
+    SkASSERT(NULL != texture);
+
+    drawState->setVertexAttribs<gSDFPathVertexAttribs>(SK_ARRAY_COUNT(gSDFPathVertexAttribs));
+    SkASSERT(kSDFPathVASize == drawState->getVertexSize());
+
+    GrDrawTarget::AutoReleaseGeometry geo(target, 4, 0);
+    if (!geo.succeeded()) {
+        GrPrintf("Failed to get space for vertices!\n");
+        return false;
+    }
+
+    // the quad is in the path's own space, so the view matrix scales or rotates the field
+    SkPoint* positions = reinterpret_cast<SkPoint*>(geo.vertices());
+    const SkRect& quad = pathData->fBounds;
+    positions->setRectFan(quad.fLeft, quad.fTop, quad.fRight, quad.fBottom, kSDFPathVASize);
+
+    SkFixed tx = SkIntToFixed(pathData->fAtlasLocation.fX + SK_DistanceFieldInset);
+    SkFixed ty = SkIntToFixed(pathData->fAtlasLocation.fY + SK_DistanceFieldInset);
+    SkFixed tw = SkIntToFixed(pathData->fWidth - 2 * SK_DistanceFieldInset);
+    SkFixed th = SkIntToFixed(pathData->fHeight - 2 * SK_DistanceFieldInset);
+    SkPoint* textureCoords = positions + 1;
+    textureCoords->setRectFan(SkFixedToFloat(texture->normalizeFixedX(tx)),
+                              SkFixedToFloat(texture->normalizeFixedY(ty)),
+                              SkFixedToFloat(texture->normalizeFixedX(tx + tw)),
+                              SkFixedToFloat(texture->normalizeFixedY(ty + th)),
+                              kSDFPathVASize);
+
+    GrDrawState::AutoRestoreEffects are(drawState);
+    GrTextureParams params(SkShader::kRepeat_TileMode, GrTextureParams::kBilerp_FilterMode);
+    static const int kTexCoordAttrIndex = 1;
+    drawState->addCoverageEffect(GrDistanceFieldTextureEffect::Create(texture, params,
+                                                                      vm.isSimilarity()),
+                                 kTexCoordAttrIndex)->unref();
+
+    target->setIndexSourceToBuffer(fContext->getQuadIndexBuffer());
+    target->drawIndexedInstances(kTriangles_GrPrimitiveType, 1, 4, 6);
+    target->resetIndexSource();
+
+    // keep the plot from being reused until this draw has happened
+    plot->setDrawToken(target->getCurrentDrawToken());
+
+    return true;
+}
+
+// Rasterizes the path at "scale" (with one texel of room for its antialiasing), builds its
+// distance field and adds that to the atlas. Returns NULL if the atlas has no room left.
+GrAADistanceFieldPathRenderer::PathData* GrAADistanceFieldPathRenderer::addPathToAtlas(
+                                                                        const SkPath& path,
+                                                                        const SkStrokeRec& stroke,
+                                                                        bool antiAlias,
+                                                                        uint32_t dimension,
+                                                                        SkScalar scale) {
+    // generate distance field and add to atlas
+    if (NULL == fAtlasMgr) {
+        SkISize textureSize = SkISize::Make(ATLAS_TEXTURE_WIDTH, ATLAS_TEXTURE_HEIGHT);
+        fAtlasMgr = SkNEW_ARGS(GrAtlasMgr, (fContext->getGpu(), kAlpha_8_GrPixelConfig,
+                                            textureSize, NUM_PLOTS_X, NUM_PLOTS_Y));
+    }
+
+    const SkRect& bounds = path.getBounds();
+
+    // the field's texels are 1/scale apart in the path's space
+    SkRect scaledBounds = bounds;
+    scaledBounds.fLeft *= scale;
+    scaledBounds.fTop *= scale;
+    scaledBounds.fRight *= scale;
+    scaledBounds.fBottom *= scale;
+    SkIRect devPathBounds;
+    scaledBounds.roundOut(&devPathBounds);
+    // pad to allow room for antialiasing
+    devPathBounds.outset(1, 1);
+    // move origin to upper left corner
+    SkScalar originX = SkIntToScalar(devPathBounds.fLeft);
+    SkScalar originY = SkIntToScalar(devPathBounds.fTop);
+    devPathBounds.offsetTo(0, 0);
+
+    // draw path to bitmap
+    SkMatrix drawMatrix;
+    drawMatrix.setScale(scale, scale);
+    drawMatrix.postTranslate(-originX, -originY);
+
+    SkBitmap bmp;
+    if (!bmp.allocPixels(SkImageInfo::MakeA8(devPathBounds.fRight, devPathBounds.fBottom))) {
+        return NULL;
+    }
+    sk_bzero(bmp.getPixels(), bmp.getSafeSize());
+
+    SkRasterClip rasterClip;
+    rasterClip.setRect(devPathBounds);
+
+    SkDraw draw;
+    sk_bzero(&draw, sizeof(draw));
+    draw.fRC = &rasterClip;
+    draw.fClip = &rasterClip.bwRgn();
+    draw.fMatrix = &drawMatrix;
+    draw.fBitmap = &bmp;
+
+    SkPaint paint;
+    paint.setStyle(SkPaint::kFill_Style);
+    paint.setAntiAlias(antiAlias);
+    draw.drawPathCoverage(path, paint);
+
+    // generate signed distance field
+    int width = devPathBounds.width() + 2 * SK_DistanceFieldPad;
+    int height = devPathBounds.height() + 2 * SK_DistanceFieldPad;
+    SkAutoSMalloc<1024> dfStorage(SkComputeDistanceFieldSize(devPathBounds.width(),
+                                                             devPathBounds.height()));
+    {
+        SkAutoLockPixels alp(bmp);
+        SkGenerateDistanceFieldFromA8Image(reinterpret_cast<unsigned char*>(dfStorage.get()),
+                                           reinterpret_cast<const unsigned char*>(bmp.getPixels()),
+                                           bmp.width(), bmp.height(), bmp.rowBytes());
+    }
+
+    // add to atlas, freeing the coldest plot if there's no room
+    GrIPoint16 atlasLocation;
+    GrPlot* plot = fAtlasMgr->addToAtlas(&fAtlas, width, height, dfStorage.get(),
+                                         &atlasLocation);
+    if (NULL == plot) {
+        if (!this->freeUnusedPlot()) {
+            return NULL;
+        }
+        plot = fAtlasMgr->addToAtlas(&fAtlas, width, height, dfStorage.get(),
+                                     &atlasLocation);
+        if (NULL == plot) {
+            return NULL;
+        }
+    }
+
+    // the drawn quad leaves out SK_DistanceFieldInset texels on each side of the field
+    SkScalar invScale = SkScalarInvert(scale);
+    SkScalar border = SkIntToScalar(SK_DistanceFieldPad - SK_DistanceFieldInset);
+    PathData* pathData = SkNEW(PathData);
+    pathData->fKey.fGenID = path.getGenerationID();
+    pathData->fKey.fDimension = dimension;
+    pathData->fPlot = plot;
+    pathData->fBounds.setLTRB((originX - border) * invScale,
+                              (originY - border) * invScale,
+                              (originX + devPathBounds.width() + border) * invScale,
+                              (originY + devPathBounds.height() + border) * invScale);
+    pathData->fWidth = width;
+    pathData->fHeight = height;
+    pathData->fAtlasLocation = atlasLocation;
+
+    fPathCache.add(pathData);
+    return pathData;
+}
+
+// As GrFontCache::freeUnusedPlot(): takes the coldest plot that no pending draw uses and
+// forgets the paths that were in it. Those entries stay in the cache with a NULL plot until
+// they're next drawn, when they're rebuilt.
+bool GrAADistanceFieldPathRenderer::freeUnusedPlot() {
+    GrPlot* plot = fAtlasMgr->getUnusedPlot();
+    if (NULL == plot) {
+        return false;
+    }
+    plot->resetRects();
+
+    PathDataList::Iter iter;
+    iter.init(fPathList, PathDataList::Iter::kHead_IterStart);
+    PathData* pathData;
+    while ((pathData = iter.get()) != NULL) {
+        iter.next();
+        if (plot == pathData->fPlot) {
+            pathData->fPlot = NULL;
+        }
+    }
+
+    fAtlasMgr->removePlot(&fAtlas, plot);
+
+    return true;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrAADistanceFieldPathRenderer_DEFINED
+#define GrAADistanceFieldPathRenderer_DEFINED
+
+#include "GrAtlas.h"
+#include "GrPathRenderer.h"
+
+#include "SkChecksum.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+
+class GrContext;
+
+/**
+ * Draws small antialiased filled paths from distance fields that are generated on the CPU
+ * (see SkDistanceFieldGen.h) and cached in an A8 atlas, as GrDistanceFieldTextContext does for
+ * glyphs. A path's distance field is built at one of a few fixed sizes and drawn with
+ * GrDistanceFieldTextureEffect under the current view matrix, so redrawing the same path at a
+ * new scale or rotation needn't rasterize it again.
+ */
+class GrAADistanceFieldPathRenderer : public GrPathRenderer {
+public:
+    GrAADistanceFieldPathRenderer(GrContext* context);
+    virtual ~GrAADistanceFieldPathRenderer();
+
+    virtual bool canDrawPath(const SkPath& path,
+                             const SkStrokeRec& stroke,
+                             const GrDrawTarget* target,
+                             bool antiAlias) const SK_OVERRIDE;
+
+protected:
+    virtual StencilSupport onGetStencilSupport(const SkPath&,
+                                               const SkStrokeRec&,
+                                               const GrDrawTarget*) const SK_OVERRIDE;
+
+    virtual bool onDrawPath(const SkPath& path,
+                            const SkStrokeRec& stroke,
+                            GrDrawTarget* target,
+                            bool antiAlias) SK_OVERRIDE;
+
+private:
+    struct PathData {
+        struct Key {
+            uint32_t   fGenID;
+            // rendered size for stored path (32x32 max, 64x64 max, 128x128 max)
+            uint32_t   fDimension;
+            bool operator==(const Key& other) const {
+                return other.fGenID == fGenID && other.fDimension == fDimension;
+            }
+        };
+        Key        fKey;
+        GrPlot*    fPlot;
+        // the space the distance field covers, in the path's own coordinates
+        SkRect     fBounds;
+        // the distance field's size in texels, including its padding
+        int        fWidth;
+        int        fHeight;
+        GrIPoint16 fAtlasLocation;
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(PathData);
+
+        static inline const Key& GetKey(const PathData& data) {
+            return data.fKey;
+        }
+
+        static inline uint32_t Hash(const Key& key) {
+            return SkChecksum::Compute(reinterpret_cast<const uint32_t*>(&key), sizeof(key));
+        }
+    };
+    typedef SkTInternalLList<PathData> PathDataList;
+
+    PathData* addPathToAtlas(const SkPath& path, const SkStrokeRec& stroke, bool antiAlias,
+                             uint32_t dimension, SkScalar scale);
+    bool freeUnusedPlot();
+
+    GrContext*                         fContext;
+    GrAtlasMgr*                        fAtlasMgr;
+    GrAtlas                            fAtlas;
+    SkTDynamicHash<PathData, PathData::Key> fPathCache;
+    // most recently drawn at the head
+    PathDataList                       fPathList;
+
+    typedef GrPathRenderer INHERITED;
+};
+
+#endif
@@ -65,8 +65,11 @@ public:
         // we always have at least one block
         if (0 == indexInBlock) {
             if (0 != fCount) {
-                fBlocks.push_back() = sk_malloc_throw(fBlockSize);
-            } else if (fOwnFirstBlock) {
+                // after a rewind() the block may already be there
+                if (fCount / fItemsPerBlock == fBlocks.count()) {
+                    fBlocks.push_back() = sk_malloc_throw(fBlockSize);
+                }
+            } else if (fOwnFirstBlock && NULL == fBlocks[0]) {
                 fBlocks[0] = sk_malloc_throw(fBlockSize);
             }
         }
@@ -80,8 +83,8 @@ public:
      * removes all added items
      */
     void reset() {
-        int blockCount = SkTMax((unsigned)1,
-                               GrUIDivRoundUp(fCount, fItemsPerBlock));
+        // rewind() may have left more blocks than fCount needs
+        int blockCount = fBlocks.count();
         for (int i = 1; i < blockCount; ++i) {
             sk_free(fBlocks[i]);
         }
@@ -93,6 +96,14 @@ public:
         fCount = 0;
     }
 
+    /**
+     * removes all added items, but keeps the blocks they were in for the
+     * next items. Memory is only freed by reset() or the destructor.
+     */
+    void rewind() {
+        fCount = 0;
+    }
+
     /**
      * count of items
      */
@@ -195,6 +206,18 @@ public:
         fAllocator.reset();
     }
 
+    /**
+     * removes all added items, but keeps their memory for reuse (see
+     * GrAllocator::rewind()).
+     */
+    void rewind() {
+        int c = fAllocator.count();
+        for (int i = 0; i < c; ++i) {
+            ((T*)fAllocator[i])->~T();
+        }
+        fAllocator.rewind();
+    }
+
     /**
      * count of items
      */
@@ -52,6 +52,9 @@ bool GrPlot::addSubImage(int width, int height, const void* image,
 
     SkAutoSMalloc<1024> storage;
     adjust_for_offset(loc, fOffset);
+    if (NULL == image) {
+        return true;
+    }
     GrContext* context = fTexture->getContext();
     // We pass the flag that does not force a flush. We assume our caller is
     // smart and hasn't referenced the part of the texture we're about to update
@@ -68,6 +71,11 @@ bool GrPlot::addSubImage(int width, int height, const void* image,
     return true;
 }
 
+void GrPlot::setDrawToken(GrDrawTarget::DrawToken draw) {
+    fDrawToken = draw;
+    fAtlasMgr->moveToHead(this);
+}
+
 void GrPlot::resetRects() {
     SkASSERT(NULL != fRects);
     fRects->reset();
@@ -77,44 +85,72 @@ void GrPlot::resetRects() {
 
 GrAtlasMgr::GrAtlasMgr(GrGpu* gpu, GrPixelConfig config,
                        const SkISize& backingTextureSize,
-                       int numPlotsX, int numPlotsY) {
+                       int numPlotsX, int numPlotsY, int maxPages,
+                       GrTextureFlags textureFlags) {
     fGpu = SkRef(gpu);
     fPixelConfig = config;
+    fTextureFlags = textureFlags;
     fBackingTextureSize = backingTextureSize;
     fNumPlotsX = numPlotsX;
     fNumPlotsY = numPlotsY;
-    fTexture = NULL;
+    fMaxPages = maxPages;
+
+    SkASSERT(fMaxPages >= 1);
+    SkASSERT(fBackingTextureSize.width() / fNumPlotsX * fNumPlotsX ==
+             fBackingTextureSize.width());
+    SkASSERT(fBackingTextureSize.height() / fNumPlotsY * fNumPlotsY ==
+             fBackingTextureSize.height());
+}
+
+GrAtlasMgr::~GrAtlasMgr() {
+    for (int i = 0; i < fPages.count(); ++i) {
+        fPages[i].fTexture->unref();
+        SkDELETE_ARRAY(fPages[i].fPlotArray);
+    }
+
+    fGpu->unref();
+#if FONT_CACHE_STATS
+      GrPrintf("Num uploads: %d\n", g_UploadCount);
+#endif
+}
+
+bool GrAtlasMgr::addPage() {
+    SkASSERT(fPages.count() < fMaxPages);
+
+    // TODO: Update this to use the cache rather than directly creating a texture.
+    GrTextureDesc desc;
+    desc.fFlags = fTextureFlags;
+    desc.fWidth = fBackingTextureSize.width();
+    desc.fHeight = fBackingTextureSize.height();
+    desc.fConfig = fPixelConfig;
+
+    GrTexture* texture = fGpu->createTexture(desc, NULL, 0);
+    if (NULL == texture) {
+        return false;
+    }
 
     int plotWidth = fBackingTextureSize.width() / fNumPlotsX;
     int plotHeight = fBackingTextureSize.height() / fNumPlotsY;
 
-    SkASSERT(plotWidth * fNumPlotsX == fBackingTextureSize.width());
-    SkASSERT(plotHeight * fNumPlotsY == fBackingTextureSize.height());
-
     // set up allocated plots
     size_t bpp = GrBytesPerPixel(fPixelConfig);
-    fPlotArray = SkNEW_ARRAY(GrPlot, (fNumPlotsX*fNumPlotsY));
-
-    GrPlot* currPlot = fPlotArray;
-    for (int y = numPlotsY-1; y >= 0; --y) {
-        for (int x = numPlotsX-1; x >= 0; --x) {
+    Page* page = fPages.append();
+    page->fTexture = texture;
+    page->fPlotArray = SkNEW_ARRAY(GrPlot, (fNumPlotsX*fNumPlotsY));
+
+    // The new plots are empty, so they go on the tail of the LRU list. The first one
+    // to be handed out is the one with offset (0, 0), as before.
+    GrPlot* currPlot = page->fPlotArray;
+    for (int y = fNumPlotsY-1; y >= 0; --y) {
+        for (int x = fNumPlotsX-1; x >= 0; --x) {
             currPlot->init(this, x, y, plotWidth, plotHeight, bpp);
+            currPlot->fTexture = texture;
 
-            // build LRU list
-            fPlotList.addToHead(currPlot);
+            fPlotList.addToTail(currPlot);
             ++currPlot;
         }
     }
-}
-
-GrAtlasMgr::~GrAtlasMgr() {
-    SkSafeUnref(fTexture);
-    SkDELETE_ARRAY(fPlotArray);
-
-    fGpu->unref();
-#if FONT_CACHE_STATS
-      GrPrintf("Num uploads: %d\n", g_UploadCount);
-#endif
+    return true;
 }
 
 void GrAtlasMgr::moveToHead(GrPlot* plot) {
@@ -139,28 +175,11 @@ GrPlot* GrAtlasMgr::addToAtlas(GrAtlas* atlas,
         }
     }
 
-    // before we get a new plot, make sure we have a backing texture
-    if (NULL == fTexture) {
-        // TODO: Update this to use the cache rather than directly creating a texture.
-        GrTextureDesc desc;
-        desc.fFlags = kDynamicUpdate_GrTextureFlagBit;
-        desc.fWidth = fBackingTextureSize.width();
-        desc.fHeight = fBackingTextureSize.height();
-        desc.fConfig = fPixelConfig;
-
-        fTexture = fGpu->createTexture(desc, NULL, 0);
-        if (NULL == fTexture) {
-            return NULL;
-        }
-    }
-
     // now look through all allocated plots for one we can share, in MRU order
     GrPlotList::Iter plotIter;
     plotIter.init(fPlotList, GrPlotList::Iter::kHead_IterStart);
     GrPlot* plot;
     while (NULL != (plot = plotIter.get())) {
-        // make sure texture is set for quick lookup
-        plot->fTexture = fTexture;
         if (plot->addSubImage(width, height, image, loc)) {
             this->moveToHead(plot);
             // new plot for atlas, put at end of array
@@ -170,6 +189,19 @@ GrPlot* GrAtlasMgr::addToAtlas(GrAtlas* atlas,
         plotIter.next();
     }
 
+    // Every existing page is full. Rather than make the client evict a plot, open
+    // another page if we're allowed one (and the image could fit on it at all).
+    if (width <= fBackingTextureSize.width() / fNumPlotsX &&
+        height <= fBackingTextureSize.height() / fNumPlotsY &&
+        fPages.count() < fMaxPages && this->addPage()) {
+        plot = fPlotList.tail();
+        if (plot->addSubImage(width, height, image, loc)) {
+            this->moveToHead(plot);
+            *(atlas->fPlots.append()) = plot;
+            return plot;
+        }
+    }
+
     // If the above fails, then the current plot list has no room
     return NULL;
 }
@@ -25,9 +25,14 @@ class GrAtlas;
 // GrPlot is "full" (i.e. there is no room for the new subimage according to the GrRectanizer), the
 // GrAtlas can request a new GrPlot via GrAtlasMgr::addToAtlas().
 //
+// A GrAtlasMgr may be allowed more than one backing texture ("page"). Pages are created on demand:
+// a new page is only added once every GrPlot on the existing pages is full.
+//
 // If all GrPlots are allocated, the replacement strategy is up to the client. The drawToken is
 // available to ensure that all draw calls are finished for that particular GrPlot.
 // GrAtlasMgr::removeUnusedPlots() will free up any finished plots for a given GrAtlas.
+// Plots are kept in least recently used order, where both uploads and draws count as uses, so
+// GrAtlasMgr::getUnusedPlot() offers up the coldest plot first.
 
 class GrPlot {
 public:
@@ -35,10 +40,12 @@ public:
 
     GrTexture* texture() const { return fTexture; }
 
+    // A NULL image only reserves the space, for clients that render into the atlas.
     bool addSubImage(int width, int height, const void*, GrIPoint16*);
 
     GrDrawTarget::DrawToken drawToken() const { return fDrawToken; }
-    void setDrawToken(GrDrawTarget::DrawToken draw) { fDrawToken = draw; }
+    // also marks the plot as the most recently used one
+    void setDrawToken(GrDrawTarget::DrawToken draw);
 
     void resetRects();
 
@@ -63,8 +70,12 @@ typedef SkTInternalLList<GrPlot> GrPlotList;
 
 class GrAtlasMgr {
 public:
+    // Each of the up to maxPages backing textures is split into numPlotsX x numPlotsY plots.
+    // The backing textures are created with textureFlags, so an atlas that is drawn into
+    // rather than uploaded to can ask for kRenderTarget_GrTextureFlagBit.
     GrAtlasMgr(GrGpu*, GrPixelConfig, const SkISize& backingTextureSize,
-               int numPlotsX, int numPlotsY);
+               int numPlotsX, int numPlotsY, int maxPages = 1,
+               GrTextureFlags textureFlags = kDynamicUpdate_GrTextureFlagBit);
     ~GrAtlasMgr();
 
     // add subimage of width, height dimensions to atlas
@@ -78,24 +89,36 @@ public:
     // this allows us to overwrite this plot without flushing
     GrPlot* getUnusedPlot();
 
-    GrTexture* getTexture() const {
-        return fTexture;
+    int pageCount() const { return fPages.count(); }
+    int maxPages() const { return fMaxPages; }
+
+    GrTexture* getTexture(int page) const {
+        return fPages[page].fTexture;
     }
 
 private:
+    struct Page {
+        GrTexture* fTexture;
+        // allocated array of GrPlots
+        GrPlot*    fPlotArray;
+    };
+
+    bool addPage();
     void moveToHead(GrPlot* plot);
 
     GrGpu*        fGpu;
     GrPixelConfig fPixelConfig;
-    GrTexture*    fTexture;
+    GrTextureFlags fTextureFlags;
     SkISize       fBackingTextureSize;
     int           fNumPlotsX;
     int           fNumPlotsY;
+    int           fMaxPages;
 
-    // allocated array of GrPlots
-    GrPlot*       fPlotArray;
-    // LRU list of GrPlots
+    SkTDArray<Page> fPages;
+    // LRU list of GrPlots, across all pages
     GrPlotList    fPlotList;
+
+    friend class GrPlot;
 };
 
 class GrAtlas {
@@ -104,6 +127,7 @@ public:
     ~GrAtlas() { }
 
     bool isEmpty() { return 0 == fPlots.count(); }
+    int plotCount() const { return fPlots.count(); }
 
 private:
     SkTDArray<GrPlot*> fPlots;
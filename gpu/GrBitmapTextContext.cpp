@@ -20,6 +20,7 @@
 
 #include "SkAutoKern.h"
 #include "SkDraw.h"
+#include "SkGlyphBatcher.h"
 #include "SkGlyphCache.h"
 #include "SkGpuDevice.h"
 #include "SkGr.h"
@@ -51,6 +52,26 @@ bool GrBitmapTextContext::canDraw(const SkPaint& paint) {
     return !SkDraw::ShouldDrawTextAsPaths(paint, fContext->getMatrix());
 }
 
+int GrBitmapTextContext::PrewarmGlyphs(GrContext* context,
+                                       const SkDeviceProperties& properties,
+                                       const SkPaint& paint,
+                                       const uint16_t glyphIDs[], int count,
+                                       int maxNewPlots) {
+    if (SkDraw::ShouldDrawTextAsPaths(paint, context->getMatrix())) {
+        return 0;
+    }
+
+    // This must find the same glyph cache, and so the same strike, as drawText().
+    SkAutoGlyphCache    autoCache(paint, &properties, &context->getMatrix());
+    GrFontScaler*       fontScaler = GetGrFontScaler(autoCache.getCache());
+
+    SkAutoSTMalloc<64, GrGlyph::PackedID> packed(count);
+    for (int i = 0; i < count; ++i) {
+        packed[i] = GrGlyph::Pack(glyphIDs[i], 0, 0);
+    }
+    return context->getFontCache()->prewarmGlyphs(fontScaler, packed.get(), count, maxNewPlots);
+}
+
 static inline GrColor skcolor_to_grcolor_nopremultiply(SkColor c) {
     unsigned r = SkColorGetR(c);
     unsigned g = SkColorGetG(c);
@@ -206,8 +227,9 @@ void GrBitmapTextContext::drawText(const GrPaint& paint, const SkPaint& skPaint,
     GrContext::AutoMatrix  autoMatrix;
     autoMatrix.setIdentity(fContext, &fPaint);
 
+    SkGlyphBatcher batcher(cache, fSkPaint, stop);
     while (text < stop) {
-        const SkGlyph& glyph = glyphCacheProc(cache, &text, fx & fxMask, fy & fyMask);
+        const SkGlyph& glyph = batcher.next(&text, fx & fxMask, fy & fyMask);
 
         fx += autokern.adjust(glyph);
 
@@ -422,11 +444,11 @@ void GrBitmapTextContext::drawPosText(const GrPaint& paint, const SkPaint& skPai
             }
         }
     } else {    // not subpixel
-
+        SkGlyphBatcher batcher(cache, fSkPaint, stop);
         if (SkPaint::kLeft_Align == fSkPaint.getTextAlign()) {
             while (text < stop) {
                 // the last 2 parameters are ignored
-                const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+                const SkGlyph& glyph = batcher.next(&text, 0, 0);
 
                 if (glyph.fWidth) {
                     tmsProc(tms, pos);
@@ -445,7 +467,7 @@ void GrBitmapTextContext::drawPosText(const GrPaint& paint, const SkPaint& skPai
         } else {
             while (text < stop) {
                 // the last 2 parameters are ignored
-                const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+                const SkGlyph& glyph = batcher.next(&text, 0, 0);
 
                 if (glyph.fWidth) {
                     tmsProc(tms, pos);
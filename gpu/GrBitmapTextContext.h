@@ -29,6 +29,16 @@ public:
 
     virtual bool canDraw(const SkPaint& paint) SK_OVERRIDE;
 
+    /**
+     *  Puts glyphIDs of paint's typeface and size, as a GrBitmapTextContext with
+     *  these device properties would draw them under the context's current
+     *  matrix, into the glyph atlas ahead of time. Only the unshifted position
+     *  of subpixel glyphs is prepared. See GrFontCache::prewarmGlyphs() for how
+     *  maxNewPlots budgets the atlas. Returns the number of glyphs now in the atlas.
+     */
+    static int PrewarmGlyphs(GrContext*, const SkDeviceProperties&, const SkPaint&,
+                             const uint16_t glyphIDs[], int count, int maxNewPlots);
+
 private:
     GrTextStrike*          fStrike;
 
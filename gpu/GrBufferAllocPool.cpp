@@ -38,6 +38,9 @@ GrBufferAllocPool::GrBufferAllocPool(GrGpu* gpu,
     fBufferType = bufferType;
     fFrequentResetHint = frequentResetHint;
     fBufferPtr = NULL;
+    fBufferPtrOffset = 0;
+    fRetainedBuffer = NULL;
+    fRetainedBytes = 0;
     fMinBlockSize = SkTMax(GrBufferAllocPool_MIN_BLOCK_SIZE, blockSize);
 
     fBytesInUse = 0;
@@ -63,6 +66,7 @@ GrBufferAllocPool::~GrBufferAllocPool() {
     while (!fBlocks.empty()) {
         destroyBlock();
     }
+    SkSafeUnref(fRetainedBuffer);
     fPreallocBuffers.unrefAll();
     releaseGpuRef();
 }
@@ -77,11 +81,19 @@ void GrBufferAllocPool::releaseGpuRef() {
 void GrBufferAllocPool::reset() {
     VALIDATE();
     fBytesInUse = 0;
+    SkSafeSetNull(fRetainedBuffer);
     if (fBlocks.count()) {
-        GrGeometryBuffer* buffer = fBlocks.back().fBuffer;
+        const BufferBlock& back = fBlocks.back();
+        GrGeometryBuffer* buffer = back.fBuffer;
         if (buffer->isLocked()) {
             buffer->unlock();
         }
+        // Everything drawn from the pool has been issued, so the unused tail of the last buffer
+        // can be filled next time without waiting on (or discarding) the data before it.
+        if (back.fBytesFree > 0 && this->canAppend(back.fBytesFree)) {
+            fRetainedBuffer = SkRef(buffer);
+            fRetainedBytes = buffer->gpuMemorySize() - back.fBytesFree;
+        }
     }
     // fPreallocBuffersInUse will be decremented down to zero in the while loop
     int preallocBuffersInUse = fPreallocBuffersInUse;
@@ -93,6 +105,15 @@ void GrBufferAllocPool::reset() {
         fPreallocBufferStartIdx = (fPreallocBufferStartIdx +
                                    preallocBuffersInUse) %
                                   fPreallocBuffers.count();
+        // A retained preallocated buffer must be the next one handed out, so that it can't also
+        // be locked whole while the first block is appending to it.
+        if (NULL != fRetainedBuffer) {
+            int lastIdx = (fPreallocBufferStartIdx + fPreallocBuffers.count() - 1) %
+                          fPreallocBuffers.count();
+            if (fPreallocBuffers[lastIdx] == fRetainedBuffer) {
+                fPreallocBufferStartIdx = lastIdx;
+            }
+        }
     }
     // we may have created a large cpu mirror of a large VB. Reset the size
     // to match our pre-allocated VBs.
@@ -135,7 +156,8 @@ void GrBufferAllocPool::validate(bool unusedBlockAllowed) const {
         SkASSERT(!fBlocks[i].fBuffer->isLocked());
     }
     for (int i = 0; i < fBlocks.count(); ++i) {
-        size_t bytes = fBlocks[i].fBuffer->gpuMemorySize() - fBlocks[i].fBytesFree;
+        size_t bytes = fBlocks[i].fBuffer->gpuMemorySize() - fBlocks[i].fBytesFree -
+                       fBlocks[i].fBytesSkipped;
         bytesInUse += bytes;
         SkASSERT(bytes || unusedBlockAllowed);
     }
@@ -150,6 +172,29 @@ void GrBufferAllocPool::validate(bool unusedBlockAllowed) const {
 }
 #endif
 
+void* GrBufferAllocPool::allocFromLastBlock(size_t size,
+                                           size_t alignment,
+                                           const GrGeometryBuffer** buffer,
+                                           size_t* offset) {
+    if (NULL == fBufferPtr) {
+        return NULL;
+    }
+    BufferBlock& back = fBlocks.back();
+    size_t usedBytes = back.fBuffer->gpuMemorySize() - back.fBytesFree;
+    size_t pad = GrSizeAlignUpPad(usedBytes,
+                                  alignment);
+    if ((size + pad) > back.fBytesFree) {
+        return NULL;
+    }
+    usedBytes += pad;
+    *offset = usedBytes;
+    *buffer = back.fBuffer;
+    back.fBytesFree -= size + pad;
+    fBytesInUse += size + pad;
+    SkASSERT(usedBytes >= fBufferPtrOffset);
+    return (void*)(reinterpret_cast<intptr_t>(fBufferPtr) + usedBytes - fBufferPtrOffset);
+}
+
 void* GrBufferAllocPool::makeSpace(size_t size,
                                    size_t alignment,
                                    const GrGeometryBuffer** buffer,
@@ -159,42 +204,29 @@ void* GrBufferAllocPool::makeSpace(size_t size,
     SkASSERT(NULL != buffer);
     SkASSERT(NULL != offset);
 
-    if (NULL != fBufferPtr) {
-        BufferBlock& back = fBlocks.back();
-        size_t usedBytes = back.fBuffer->gpuMemorySize() - back.fBytesFree;
-        size_t pad = GrSizeAlignUpPad(usedBytes,
-                                      alignment);
-        if ((size + pad) <= back.fBytesFree) {
-            usedBytes += pad;
-            *offset = usedBytes;
-            *buffer = back.fBuffer;
-            back.fBytesFree -= size + pad;
-            fBytesInUse += size + pad;
-            VALIDATE();
-            return (void*)(reinterpret_cast<intptr_t>(fBufferPtr) + usedBytes);
-        }
+    void* ptr = this->allocFromLastBlock(size, alignment, buffer, offset);
+    if (NULL != ptr) {
+        VALIDATE();
+        return ptr;
     }
 
-    // We could honor the space request using by a partial update of the current
-    // VB (if there is room). But we don't currently use draw calls to GL that
-    // allow the driver to know that previously issued draws won't read from
-    // the part of the buffer we update. Also, the GL buffer implementation
-    // may be cheating on the actual buffer size by shrinking the buffer on
+    // If the last block was unlocked to draw from it, previously issued draws may
+    // still read the part of the buffer we've filled. When the GrGpu supports it
+    // we lock just the rest of the buffer, unsynchronized, and keep appending.
+    // Otherwise we start a new block: the GL buffer implementation may be
+    // cheating on the actual buffer size by shrinking the buffer on
     // updateData() if the amount of data passed is less than the full buffer
     // size.
-
-    if (!createBlock(size)) {
+    if (!this->lockLastBlockRemainder(size, alignment) &&
+        !this->createBlock(size, alignment)) {
         return NULL;
     }
     SkASSERT(NULL != fBufferPtr);
 
-    *offset = 0;
-    BufferBlock& back = fBlocks.back();
-    *buffer = back.fBuffer;
-    back.fBytesFree -= size;
-    fBytesInUse += size;
+    ptr = this->allocFromLastBlock(size, alignment, buffer, offset);
+    SkASSERT(NULL != ptr);
     VALIDATE();
-    return fBufferPtr;
+    return ptr;
 }
 
 int GrBufferAllocPool::currentBufferItems(size_t itemSize) const {
@@ -231,7 +263,8 @@ void GrBufferAllocPool::putBack(size_t bytes) {
         // caller shouldnt try to put back more than they've taken
         SkASSERT(!fBlocks.empty());
         BufferBlock& block = fBlocks.back();
-        size_t bytesUsed = block.fBuffer->gpuMemorySize() - block.fBytesFree;
+        size_t bytesUsed = block.fBuffer->gpuMemorySize() - block.fBytesFree -
+                           block.fBytesSkipped;
         if (bytes >= bytesUsed) {
             bytes -= bytesUsed;
             fBytesInUse -= bytesUsed;
@@ -256,16 +289,74 @@ void GrBufferAllocPool::putBack(size_t bytes) {
     VALIDATE();
 }
 
-bool GrBufferAllocPool::createBlock(size_t requestSize) {
+bool GrBufferAllocPool::canAppend(size_t requestSize) const {
+    if (!(GrDrawTargetCaps::kUnsynchronized_MapFlag & fGpu->caps()->mapBufferFlags())) {
+        return false;
+    }
+    // Like createBlock(), don't lock a buffer for small amounts of data when we expect frequent
+    // resets; staging it on the CPU is cheaper.
+    return !fFrequentResetHint || requestSize > GR_GEOM_BUFFER_LOCK_THRESHOLD;
+}
+
+bool GrBufferAllocPool::lockLastBlockRemainder(size_t requestSize, size_t alignment) {
+    if (NULL != fBufferPtr || fBlocks.empty() || !this->canAppend(requestSize)) {
+        return false;
+    }
+    BufferBlock& back = fBlocks.back();
+    size_t usedBytes = back.fBuffer->gpuMemorySize() - back.fBytesFree;
+    size_t pad = GrSizeAlignUpPad(usedBytes, alignment);
+    if ((requestSize + pad) > back.fBytesFree) {
+        return false;
+    }
+    fBufferPtr = back.fBuffer->lockRange(usedBytes, back.fBytesFree);
+    if (NULL == fBufferPtr) {
+        return false;
+    }
+    fBufferPtrOffset = usedBytes;
+    return true;
+}
+
+bool GrBufferAllocPool::createBlock(size_t requestSize, size_t alignment) {
 
     size_t size = SkTMax(requestSize, fMinBlockSize);
     SkASSERT(size >= GrBufferAllocPool_MIN_BLOCK_SIZE);
 
     VALIDATE();
 
-    BufferBlock& block = fBlocks.push_back();
+    // Only the first block after a reset may append to the retained buffer. We own its ref.
+    GrGeometryBuffer* retained = fRetainedBuffer;
+    size_t retainedOffset = 0;
+    fRetainedBuffer = NULL;
+    if (NULL != retained) {
+        SkASSERT(fBlocks.empty());
+        retainedOffset = fRetainedBytes + GrSizeAlignUpPad(fRetainedBytes, alignment);
+        if (retainedOffset + requestSize > retained->gpuMemorySize() ||
+            !this->canAppend(requestSize)) {
+            SkSafeSetNull(retained);
+        }
+    }
 
-    if (size == fMinBlockSize &&
+    BufferBlock& block = fBlocks.push_back();
+    block.fBytesSkipped = 0;
+    bool appending = false;
+
+    if (NULL != retained) {
+        block.fBuffer = retained;
+        // reset() made a retained preallocated buffer the next one in line.
+        if (fPreallocBuffers.count() &&
+            fPreallocBuffers[fPreallocBufferStartIdx] == retained) {
+            SkASSERT(0 == fPreallocBuffersInUse);
+            ++fPreallocBuffersInUse;
+        }
+        fBufferPtr = retained->lockRange(retainedOffset,
+                                         retained->gpuMemorySize() - retainedOffset);
+        if (NULL != fBufferPtr) {
+            block.fBytesSkipped = retainedOffset;
+            fBufferPtrOffset = retainedOffset;
+            appending = true;
+        }
+        size = retained->gpuMemorySize();
+    } else if (size == fMinBlockSize &&
         fPreallocBuffersInUse < fPreallocBuffers.count()) {
 
         uint32_t nextBuffer = (fPreallocBuffersInUse +
@@ -282,7 +373,13 @@ bool GrBufferAllocPool::createBlock(size_t requestSize) {
         }
     }
 
-    block.fBytesFree = size;
+    block.fBytesFree = size - block.fBytesSkipped;
+    if (appending) {
+        // there can't be a previous block to flush
+        VALIDATE(true);
+        return true;
+    }
+
     if (NULL != fBufferPtr) {
         SkASSERT(fBlocks.count() > 1);
         BufferBlock& prev = fBlocks.fromBack(1);
@@ -311,6 +408,7 @@ bool GrBufferAllocPool::createBlock(size_t requestSize) {
         }
     }
 
+    fBufferPtrOffset = 0;
     if (attemptLock) {
         fBufferPtr = block.fBuffer->lock();
     }
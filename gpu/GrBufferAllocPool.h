@@ -26,6 +26,11 @@ class GrGpu;
  * At creation time a minimum per-buffer size can be specified. Additionally,
  * a number of buffers to preallocate can be specified. These will
  * be allocated at the min size and kept around until the pool is destroyed.
+ *
+ * When the GrGpu supports unsynchronized partial buffer locks the pool uses
+ * its buffers as rings: after an unlock or reset it keeps appending to the
+ * unused tail of the last buffer, rather than locking (and so discarding) a
+ * whole buffer each time.
  */
 class GrBufferAllocPool : SkNoncopyable {
 public:
@@ -151,9 +156,15 @@ private:
     struct BufferBlock {
         size_t              fBytesFree;
         GrGeometryBuffer*   fBuffer;
+        // bytes at the start of fBuffer that were written before the last reset
+        size_t              fBytesSkipped;
     };
 
-    bool createBlock(size_t requestSize);
+    void* allocFromLastBlock(size_t size, size_t alignment,
+                             const GrGeometryBuffer** buffer, size_t* offset);
+    bool canAppend(size_t requestSize) const;
+    bool lockLastBlockRemainder(size_t requestSize, size_t alignment);
+    bool createBlock(size_t requestSize, size_t alignment);
     void destroyBlock();
     void flushCpuData(GrGeometryBuffer* buffer, size_t flushSize);
 #ifdef SK_DEBUG
@@ -176,6 +187,13 @@ private:
     int                             fPreallocBufferStartIdx;
     SkAutoMalloc                    fCpuData;
     void*                           fBufferPtr;
+    // The offset in the last block's buffer that fBufferPtr points at. Non-zero
+    // only when the block was locked with GrGeometryBuffer::lockRange().
+    size_t                          fBufferPtrOffset;
+    // The last block's buffer at the time of the last reset, and how many bytes
+    // of it were written. The first block after the reset appends to it if it can.
+    GrGeometryBuffer*               fRetainedBuffer;
+    size_t                          fRetainedBytes;
 };
 
 class GrVertexBuffer;
@@ -10,13 +10,17 @@
 
 #include "GrContext.h"
 #include "SkClipStack.h"
+#include "SkTDArray.h"
 #include "SkTypes.h"
 
 class GrTexture;
 
 /**
  * The stencil buffer stores the last clip path - providing a single entry
- * "cache". This class provides similar functionality for AA clip paths
+ * "cache". This class provides similar functionality for AA clip paths, except
+ * that each stack frame keeps the last few masks in least recently used order.
+ * UIs that alternate between a handful of clips every frame can then reuse
+ * each of their masks rather than re-rendering them.
  */
 class GrClipMaskCache : SkNoncopyable {
 public:
@@ -31,6 +35,10 @@ public:
         }
     }
 
+    /**
+     * Returns true if a mask for this clip and bounds is cached. That mask then becomes the most
+     * recently used one, which getLastMask() returns.
+     */
     bool canReuse(int32_t clipGenID, const SkIRect& bounds) {
 
         SkASSERT(clipGenID != SkClipStack::kWideOpenGenID);
@@ -40,15 +48,22 @@ public:
 
         // We could reuse the mask if bounds is a subset of last bounds. We'd have to communicate
         // an offset to the caller.
-        if (back->fLastMask.texture() &&
-            back->fLastBound == bounds &&
-            back->fLastClipGenID == clipGenID) {
-            return true;
+        for (int i = 0; i < back->fEntries.count(); ++i) {
+            const GrClipStackFrame::Entry* entry = back->fEntries[i];
+            if (entry->fMask.texture() &&
+                entry->fBound == bounds &&
+                entry->fClipGenID == clipGenID) {
+                back->moveToFront(i);
+                return true;
+            }
         }
 
         return false;
     }
 
+    /**
+     * Drops the most recently used mask, e.g. because it was acquired but couldn't be drawn.
+     */
     void reset() {
         if (fStack.empty()) {
 //            SkASSERT(false);
@@ -57,7 +72,7 @@ public:
 
         GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
 
-        back->reset();
+        back->removeFront();
     }
 
     /**
@@ -85,7 +100,9 @@ public:
             return SkClipStack::kInvalidGenID;
         }
 
-        return ((GrClipStackFrame*) fStack.back())->fLastClipGenID;
+        const GrClipStackFrame::Entry* front = ((GrClipStackFrame*) fStack.back())->front();
+
+        return front ? front->fClipGenID : SkClipStack::kInvalidGenID;
     }
 
     GrTexture* getLastMask() {
@@ -95,9 +112,9 @@ public:
             return NULL;
         }
 
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
+        GrClipStackFrame::Entry* front = ((GrClipStackFrame*) fStack.back())->front();
 
-        return back->fLastMask.texture();
+        return front ? front->fMask.texture() : NULL;
     }
 
     const GrTexture* getLastMask() const {
@@ -107,11 +124,15 @@ public:
             return NULL;
         }
 
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
+        const GrClipStackFrame::Entry* front = ((GrClipStackFrame*) fStack.back())->front();
 
-        return back->fLastMask.texture();
+        return front ? front->fMask.texture() : NULL;
     }
 
+    /**
+     * Acquires a new mask texture, which becomes the most recently used mask. If the frame is
+     * full, the least recently used mask is released first.
+     */
     void acquireMask(int32_t clipGenID,
                      const GrTextureDesc& desc,
                      const SkIRect& bound) {
@@ -128,34 +149,24 @@ public:
 
     int getLastMaskWidth() const {
 
-        if (fStack.empty()) {
-            SkASSERT(false);
-            return -1;
-        }
+        const GrTexture* mask = this->getLastMask();
 
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
-
-        if (NULL == back->fLastMask.texture()) {
+        if (NULL == mask) {
             return -1;
         }
 
-        return back->fLastMask.texture()->width();
+        return mask->width();
     }
 
     int getLastMaskHeight() const {
 
-        if (fStack.empty()) {
-            SkASSERT(false);
-            return -1;
-        }
-
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
+        const GrTexture* mask = this->getLastMask();
 
-        if (NULL == back->fLastMask.texture()) {
+        if (NULL == mask) {
             return -1;
         }
 
-        return back->fLastMask.texture()->height();
+        return mask->height();
     }
 
     void getLastBound(SkIRect* bound) const {
@@ -166,9 +177,14 @@ public:
             return;
         }
 
-        GrClipStackFrame* back = (GrClipStackFrame*) fStack.back();
+        const GrClipStackFrame::Entry* front = ((GrClipStackFrame*) fStack.back())->front();
 
-        *bound = back->fLastBound;
+        if (NULL == front) {
+            bound->setEmpty();
+            return;
+        }
+
+        *bound = front->fBound;
     }
 
     void setContext(GrContext* context) {
@@ -191,39 +207,71 @@ public:
 
 private:
     struct GrClipStackFrame {
-
-        GrClipStackFrame() {
+        // The number of masks each frame holds on to. Each one pins a scratch texture.
+        static const int kMaxEntries = 8;
+
+        struct Entry {
+            int32_t                 fClipGenID;
+            // The mask's width & height values are used by GrClipMaskManager to correctly scale
+            // the texture coords for the geometry drawn with this mask.
+            GrAutoScratchTexture    fMask;
+            // fBound stores the bounding box of the clip mask in clip-stack space. This rect is
+            // used by GrClipMaskManager to position a rect and compute texture coords for the
+            // mask.
+            SkIRect                 fBound;
+        };
+
+        GrClipStackFrame() {}
+
+        ~GrClipStackFrame() {
             this->reset();
         }
 
+        Entry* front() const {
+            return fEntries.isEmpty() ? NULL : fEntries[0];
+        }
+
+        void moveToFront(int index) {
+            Entry* entry = fEntries[index];
+            fEntries.remove(index);
+            *fEntries.insert(0) = entry;
+        }
+
+        void removeFront() {
+            if (!fEntries.isEmpty()) {
+                SkDELETE(fEntries[0]);
+                fEntries.remove(0);
+            }
+        }
+
         void acquireMask(GrContext* context,
                          int32_t clipGenID,
                          const GrTextureDesc& desc,
                          const SkIRect& bound) {
 
-            fLastClipGenID = clipGenID;
+            // Release the least recently used mask before asking for a new texture, so its
+            // scratch texture can be reused.
+            if (fEntries.count() >= kMaxEntries) {
+                SkDELETE(fEntries.back());
+                fEntries.pop();
+            }
 
-            fLastMask.set(context, desc);
+            Entry* entry = SkNEW(Entry);
+            entry->fClipGenID = clipGenID;
 
-            fLastBound = bound;
-        }
+            entry->fMask.set(context, desc);
 
-        void reset () {
-            fLastClipGenID = SkClipStack::kInvalidGenID;
+            entry->fBound = bound;
 
-            GrTextureDesc desc;
+            *fEntries.insert(0) = entry;
+        }
 
-            fLastMask.set(NULL, desc);
-            fLastBound.setEmpty();
+        void reset() {
+            fEntries.deleteAll();
         }
 
-        int32_t                 fLastClipGenID;
-        // The mask's width & height values are used by GrClipMaskManager to correctly scale the
-        // texture coords for the geometry drawn with this mask.
-        GrAutoScratchTexture    fLastMask;
-        // fLastBound stores the bounding box of the clip mask in clip-stack space. This rect is
-        // used by GrClipMaskManager to position a rect and compute texture coords for the mask.
-        SkIRect                 fLastBound;
+        // Most recently used first.
+        SkTDArray<Entry*>       fEntries;
     };
 
     GrContext*   fContext;
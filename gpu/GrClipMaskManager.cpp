@@ -32,6 +32,17 @@ using namespace GrReducedClip;
 
 ////////////////////////////////////////////////////////////////////////////////
 namespace {
+
+// The most reduced clip elements that are applied with coverage effects. 4 was chosen because of
+// the common pattern in Blink of:
+//   isect RR
+//   diff  RR
+//   isect convex_poly
+//   isect convex_poly
+// when drawing rounded div borders. This could probably be tuned based on a configuration's
+// relative costs of switching RTs to generate a mask vs longer shaders.
+static const int kMaxAnalyticClipElements = 4;
+
 // set up the draw state to enable the aa clipping mask. Besides setting up the
 // stage matrix this also alters the vertex layout
 void setup_drawstate_aaclip(GrGpu* gpu,
@@ -254,19 +265,15 @@ bool GrClipMaskManager::setupClipping(const GrClipData* clipDataIn,
         return true;
     }
 
-    // An element count of 4 was chosen because of the common pattern in Blink of:
-    //   isect RR
-    //   diff  RR
-    //   isect convex_poly
-    //   isect convex_poly
-    // when drawing rounded div borders. This could probably be tuned based on a
-    // configuration's relative costs of switching RTs to generate a mask vs
-    // longer shaders.
-    if (elements.count() <= 4) {
+    // Small clips are applied analytically, with one coverage effect per element, rather than
+    // through a mask or the stencil buffer. That holds for non-AA clips too (the effects have
+    // BW edge types), except on multisampled targets where the stencil resolves per sample.
+    if (elements.count() <= kMaxAnalyticClipElements) {
         SkVector clipToRTOffset = { SkIntToScalar(-clipDataIn->fOrigin.fX),
                                     SkIntToScalar(-clipDataIn->fOrigin.fY) };
         if (elements.isEmpty() ||
-            (requiresAA && this->installClipEffects(elements, are, clipToRTOffset, devBounds))) {
+            ((requiresAA || !rt->isMultisampled()) &&
+             this->installClipEffects(elements, are, clipToRTOffset, devBounds))) {
             SkIRect scissorSpaceIBounds(clipSpaceIBounds);
             scissorSpaceIBounds.offset(-clipDataIn->fOrigin);
             if (NULL == devBounds ||
@@ -315,11 +322,9 @@ bool GrClipMaskManager::setupClipping(const GrClipData* clipDataIn,
 #endif // GR_AA_CLIP
 
     // Either a hard (stencil buffer) clip was explicitly requested or an anti-aliased clip couldn't
-    // be created. In either case, free up the texture in the anti-aliased mask cache.
-    // TODO: this may require more investigation. Ganesh performs a lot of utility draws (e.g.,
-    // clears, InOrderDrawBuffer playbacks) that hit the stencil buffer path. These may be
-    // "incorrectly" clearing the AA cache.
-    fAACache.reset();
+    // be created. The anti-aliased mask cache is left alone: Ganesh performs a lot of utility draws
+    // (e.g., clears, InOrderDrawBuffer playbacks) that hit the stencil buffer path, and those
+    // shouldn't throw away masks the next AA clip may reuse. The cache's size is bounded anyway.
 
     // use the stencil clip if we can't represent the clip as a rectangle.
     SkIPoint clipSpaceToStencilSpaceOffset = -clipDataIn->fOrigin;
@@ -513,10 +518,8 @@ bool GrClipMaskManager::getMaskTexture(int32_t elementsGenID,
     if (!cached) {
 
         // There isn't a suitable entry in the cache so we create a new texture to store the mask.
-        // Since we are setting up the cache we know the last lookup was a miss. Free up the
-        // currently cached mask so it can be reused.
-        fAACache.reset();
-
+        // The cache keeps the other recently used masks around (releasing the oldest if it is
+        // full) in case the clip flips back to one of them.
         GrTextureDesc desc;
         desc.fFlags = willUpload ? kNone_GrTextureFlags : kRenderTarget_GrTextureFlagBit;
         desc.fWidth = clipSpaceIBounds.width();
@@ -154,6 +154,10 @@ GrContext::~GrContext() {
     // of them before freeing the texture cache
     fGpu->purgeResources();
 
+    // Cached layers hold locked scratch textures, which must go back to the
+    // texture cache while it is still around.
+    fLayerCache->freeAll();
+
     delete fTextureCache;
     fTextureCache = NULL;
     delete fFontCache;
@@ -423,6 +427,47 @@ static GrTexture* create_scratch_texture(GrGpu* gpu,
     return texture;
 }
 
+// Approximately matched scratch textures are binned by size class: the powers of two and
+// 1.5x each of them, i.e. 16, 24, 32, 48, 64, 96, ... Each class is a list of free textures
+// under one key in the resource cache, and the half steps waste at most a third of each
+// dimension (against half of it for powers of two).
+static int scratch_size_class(int size) {
+    static const int kMinSize = 16;
+    if (size <= kMinSize) {
+        return kMinSize;
+    }
+    int pow2 = GrNextPow2(size);
+    int threeHalvesOfLower = (pow2 >> 1) + (pow2 >> 2);
+    return size <= threeHalvesOfLower ? threeHalvesOfLower : pow2;
+}
+
+static GrCacheable* find_scratch_texture(GrResourceCache* textureCache,
+                                         GrTextureDesc desc,
+                                         GrContext::ScratchTexMatch match) {
+    do {
+        GrResourceKey key = GrTexture::ComputeScratchKey(desc);
+        // Ensure we have exclusive access to the texture so future 'find' calls don't return it
+        GrCacheable* resource = textureCache->find(key, GrResourceCache::kHide_OwnershipFlag);
+        if (NULL != resource) {
+            resource->ref();
+            return resource;
+        }
+        if (GrContext::kExact_ScratchTexMatch == match) {
+            return NULL;
+        }
+        // We had a cache miss and we are in approx mode, relax the fit of the flags.
+
+        // We no longer try to reuse textures that were previously used as render targets in
+        // situations where no RT is needed; doing otherwise can confuse the video driver and
+        // cause significant performance problems in some cases.
+        if (desc.fFlags & kNoStencil_GrTextureFlagBit) {
+            desc.fFlags = desc.fFlags & ~kNoStencil_GrTextureFlagBit;
+        } else {
+            return NULL;
+        }
+    } while (true);
+}
+
 GrTexture* GrContext::lockAndRefScratchTexture(const GrTextureDesc& inDesc, ScratchTexMatch match) {
 
     SkASSERT((inDesc.fFlags & kRenderTarget_GrTextureFlagBit) ||
@@ -442,44 +487,36 @@ GrTexture* GrContext::lockAndRefScratchTexture(const GrTextureDesc& inDesc, Scra
     GrTextureDesc desc = inDesc;
 
     if (kApprox_ScratchTexMatch == match) {
-        // bin by pow2 with a reasonable min
-        static const int MIN_SIZE = 16;
-        desc.fWidth  = SkTMax(MIN_SIZE, GrNextPow2(desc.fWidth));
-        desc.fHeight = SkTMax(MIN_SIZE, GrNextPow2(desc.fHeight));
-    }
-
-    GrCacheable* resource = NULL;
-    int origWidth = desc.fWidth;
-    int origHeight = desc.fHeight;
-
-    do {
-        GrResourceKey key = GrTexture::ComputeScratchKey(desc);
-        // Ensure we have exclusive access to the texture so future 'find' calls don't return it
-        resource = fTextureCache->find(key, GrResourceCache::kHide_OwnershipFlag);
-        if (NULL != resource) {
-            resource->ref();
-            break;
-        }
-        if (kExact_ScratchTexMatch == match) {
-            break;
-        }
-        // We had a cache miss and we are in approx mode, relax the fit of the flags.
-
-        // We no longer try to reuse textures that were previously used as render targets in
-        // situations where no RT is needed; doing otherwise can confuse the video driver and
-        // cause significant performance problems in some cases.
-        if (desc.fFlags & kNoStencil_GrTextureFlagBit) {
-            desc.fFlags = desc.fFlags & ~kNoStencil_GrTextureFlagBit;
-        } else {
-            break;
+        desc.fWidth  = scratch_size_class(desc.fWidth);
+        desc.fHeight = scratch_size_class(desc.fHeight);
+    }
+
+    GrCacheable* resource = find_scratch_texture(fTextureCache, desc, match);
+
+    if (NULL == resource && kApprox_ScratchTexMatch == match) {
+        // Rather than allocate, settle for a texture one size class up in either dimension.
+        // These are at most 1.5x too big, which is no worse than the power of two a request
+        // could be rounded up to.
+        const int maxSize = fGpu->caps()->maxTextureSize();
+        const int nextWidth = scratch_size_class(desc.fWidth + 1);
+        const int nextHeight = scratch_size_class(desc.fHeight + 1);
+        const SkISize candidates[] = {
+            { nextWidth, desc.fHeight },
+            { desc.fWidth, nextHeight },
+            { nextWidth, nextHeight },
+        };
+        for (size_t i = 0; NULL == resource && i < SK_ARRAY_COUNT(candidates); ++i) {
+            if (candidates[i].fWidth > maxSize || candidates[i].fHeight > maxSize) {
+                continue;
+            }
+            GrTextureDesc candidateDesc = desc;
+            candidateDesc.fWidth = candidates[i].fWidth;
+            candidateDesc.fHeight = candidates[i].fHeight;
+            resource = find_scratch_texture(fTextureCache, candidateDesc, match);
         }
-
-    } while (true);
+    }
 
     if (NULL == resource) {
-        desc.fFlags = inDesc.fFlags;
-        desc.fWidth = origWidth;
-        desc.fHeight = origHeight;
         resource = create_scratch_texture(fGpu, fTextureCache, desc);
     }
 
@@ -1242,6 +1279,11 @@ void GrContext::flush(int flagsBitfield) {
         fDrawBuffer->flush();
     }
     fFlushToReduceCacheSize = false;
+    // A flush is about as close to a frame boundary as we get. Scratch textures that have
+    // sat unused for a while are from effects that stopped animating.
+    if (NULL != fTextureCache) {
+        fTextureCache->didFlush();
+    }
 }
 
 bool GrContext::writeTexturePixels(GrTexture* texture,
@@ -10,6 +10,7 @@
 #include "GrContext.h"
 #include "GrDrawState.h"
 #include "GrPathUtils.h"
+#include "GrResourceCache.h"
 #include "SkString.h"
 #include "SkStrokeRec.h"
 #include "SkTLazy.h"
@@ -173,6 +174,37 @@ GrPathRenderer::StencilSupport GrDefaultPathRenderer::onGetStencilSupport(
     }
 }
 
+// Snaps the tolerance down to the nearest half octave, so that the paths tessellated for
+// scales that differ by less than that can share vertices.
+static SkScalar bucket_tolerance(SkScalar tol, int* bucket) {
+    int exp;
+    SkScalar mant = SkDoubleToScalar(frexp(tol, &exp));
+    if (mant >= SK_ScalarRoot2Over2) {
+        *bucket = 2 * exp + 1;
+        return SkDoubleToScalar(ldexp(SK_ScalarRoot2Over2, exp));
+    } else {
+        *bucket = 2 * exp;
+        return SkDoubleToScalar(ldexp(SK_ScalarHalf, exp));
+    }
+}
+
+static GrResourceKey compute_tessellation_key(const SkPath& path,
+                                              const SkStrokeRec& stroke,
+                                              int toleranceBucket) {
+    static const GrResourceKey::ResourceType gTessellationType =
+        GrResourceKey::GenerateResourceType();
+    static const GrCacheID::Domain gDefaultTessellationDomain = GrCacheID::GenerateDomain();
+
+    // The vertices don't depend on the fill type, only on whether the path is filled or is
+    // drawn as hairlines.
+    GrCacheID::Key key;
+    key.fData32[0] = path.getGenerationID();
+    key.fData32[1] = stroke.isHairlineStyle();
+    key.fData32[2] = static_cast<uint32_t>(toleranceBucket);
+    key.fData32[3] = 0;
+    return GrResourceKey(GrCacheID(gDefaultTessellationDomain, key), gTessellationType, 0);
+}
+
 static inline void append_countour_edge_indices(bool hairLine,
                                                 uint16_t fanCenterIdx,
                                                 uint16_t edgeV0Idx,
@@ -187,60 +219,59 @@ static inline void append_countour_edge_indices(bool hairLine,
     *((*indices)++) = edgeV0Idx + 1;
 }
 
-bool GrDefaultPathRenderer::createGeom(const SkPath& path,
-                                       const SkStrokeRec& stroke,
-                                       SkScalar srcSpaceTol,
-                                       GrDrawTarget* target,
-                                       GrPrimitiveType* primType,
-                                       int* vertexCnt,
-                                       int* indexCnt,
-                                       GrDrawTarget::AutoReleaseGeometry* arg) {
-    {
-    SkScalar srcSpaceTolSqd = SkScalarMul(srcSpaceTol, srcSpaceTol);
+// Finds the primitive type and how many vertices (and if indexed, indices) the path may need.
+static bool size_geom(const SkPath& path,
+                      SkScalar srcSpaceTol,
+                      bool isHairline,
+                      GrPrimitiveType* primType,
+                      int* maxPts,
+                      int* maxIdxs) {
     int contourCnt;
-    int maxPts = GrPathUtils::worstCasePointCount(path, &contourCnt,
-                                                  srcSpaceTol);
+    *maxPts = GrPathUtils::worstCasePointCount(path, &contourCnt,
+                                               srcSpaceTol);
 
-    if (maxPts <= 0) {
+    if (*maxPts <= 0) {
         return false;
     }
-    if (maxPts > ((int)SK_MaxU16 + 1)) {
-        GrPrintf("Path not rendered, too many verts (%d)\n", maxPts);
+    if (*maxPts > ((int)SK_MaxU16 + 1)) {
+        GrPrintf("Path not rendered, too many verts (%d)\n", *maxPts);
         return false;
     }
 
     bool indexed = contourCnt > 1;
 
-    const bool isHairline = stroke.isHairlineStyle();
-
-    int maxIdxs = 0;
+    *maxIdxs = 0;
     if (isHairline) {
         if (indexed) {
-            maxIdxs = 2 * maxPts;
+            *maxIdxs = 2 * *maxPts;
             *primType = kLines_GrPrimitiveType;
         } else {
             *primType = kLineStrip_GrPrimitiveType;
         }
     } else {
         if (indexed) {
-            maxIdxs = 3 * maxPts;
+            *maxIdxs = 3 * *maxPts;
             *primType = kTriangles_GrPrimitiveType;
         } else {
             *primType = kTriangleFan_GrPrimitiveType;
         }
     }
+    return true;
+}
 
-    target->drawState()->setDefaultVertexAttribs();
-    if (!arg->set(target, maxPts, maxIdxs)) {
-        return false;
-    }
-
-    uint16_t* idxBase = reinterpret_cast<uint16_t*>(arg->indices());
+// Writes the vertices (and indices, if idxBase isn't NULL) sized by size_geom().
+static void fill_geom(const SkPath& path,
+                      SkScalar srcSpaceTol,
+                      bool isHairline,
+                      SkPoint* base,
+                      uint16_t* idxBase,
+                      int* vertexCnt,
+                      int* indexCnt) {
+    SkScalar srcSpaceTolSqd = SkScalarMul(srcSpaceTol, srcSpaceTol);
+    bool indexed = NULL != idxBase;
     uint16_t* idx = idxBase;
     uint16_t subpathIdxStart = 0;
 
-    SkPoint* base = reinterpret_cast<SkPoint*>(arg->vertices());
-    SkASSERT(NULL != base);
     SkPoint* vert = base;
 
     SkPoint pts[4];
@@ -313,16 +344,65 @@ bool GrDefaultPathRenderer::createGeom(const SkPath& path,
         first = false;
     }
 FINISHED:
-    SkASSERT((vert - base) <= maxPts);
-    SkASSERT((idx - idxBase) <= maxIdxs);
-
     *vertexCnt = static_cast<int>(vert - base);
     *indexCnt = static_cast<int>(idx - idxBase);
+}
+
+bool GrDefaultPathRenderer::createGeom(const SkPath& path,
+                                       const SkStrokeRec& stroke,
+                                       SkScalar srcSpaceTol,
+                                       GrDrawTarget* target,
+                                       GrPrimitiveType* primType,
+                                       int* vertexCnt,
+                                       int* indexCnt,
+                                       GrDrawTarget::AutoReleaseGeometry* arg) {
+    const bool isHairline = stroke.isHairlineStyle();
+    int maxPts, maxIdxs;
+    if (!size_geom(path, srcSpaceTol, isHairline, primType, &maxPts, &maxIdxs)) {
+        return false;
+    }
 
+    target->drawState()->setDefaultVertexAttribs();
+    if (!arg->set(target, maxPts, maxIdxs)) {
+        return false;
     }
+
+    uint16_t* idxBase = maxIdxs > 0 ? reinterpret_cast<uint16_t*>(arg->indices()) : NULL;
+    SkPoint* base = reinterpret_cast<SkPoint*>(arg->vertices());
+    SkASSERT(NULL != base);
+    fill_geom(path, srcSpaceTol, isHairline, base, idxBase, vertexCnt, indexCnt);
+
+    SkASSERT(*vertexCnt <= maxPts);
+    SkASSERT(*indexCnt <= maxIdxs);
     return true;
 }
 
+// As createGeom(), but into static buffers to be cached.
+static GrTessellatedPath* create_tessellation(const SkPath& path,
+                                              const SkStrokeRec& stroke,
+                                              SkScalar srcSpaceTol,
+                                              GrGpu* gpu) {
+    const bool isHairline = stroke.isHairlineStyle();
+    GrPrimitiveType primType;
+    int maxPts, maxIdxs;
+    if (!size_geom(path, srcSpaceTol, isHairline, &primType, &maxPts, &maxIdxs)) {
+        return NULL;
+    }
+
+    SkAutoTMalloc<SkPoint> verts(maxPts);
+    SkAutoTMalloc<uint16_t> idxs(maxIdxs);
+    GrTessellatedPath::Draw draw;
+    fill_geom(path, srcSpaceTol, isHairline, verts.get(), maxIdxs > 0 ? idxs.get() : NULL,
+              &draw.fVertexCnt, &draw.fIndexCnt);
+    if (0 == draw.fVertexCnt) {
+        return NULL;
+    }
+
+    return GrTessellatedPath::Create(gpu, primType, verts.get(), sizeof(SkPoint),
+                                     draw.fVertexCnt, draw.fIndexCnt > 0 ? idxs.get() : NULL,
+                                     draw.fIndexCnt, &draw, 1, path.getBounds());
+}
+
 bool GrDefaultPathRenderer::internalDrawPath(const SkPath& path,
                                              const SkStrokeRec& origStroke,
                                              GrDrawTarget* target,
@@ -346,18 +426,45 @@ bool GrDefaultPathRenderer::internalDrawPath(const SkPath& path,
     SkScalar tol = SK_Scalar1;
     tol = GrPathUtils::scaleToleranceToSrc(tol, viewM, path.getBounds());
 
+    // Only curves are worth caching, since lines are just copied into the vertices. Their
+    // vertices only depend on the tolerance, which snaps to a bucket so that they can be
+    // reused under nearby scales (and any translation).
+    SkAutoTUnref<GrTessellatedPath> tess;
+    if (path.getSegmentMasks() & ~SkPath::kLine_SegmentMask) {
+        int bucket;
+        tol = bucket_tolerance(tol, &bucket);
+        GrResourceKey key = compute_tessellation_key(path, *stroke, bucket);
+        GrContext* context = target->getContext();
+        tess.reset(static_cast<GrTessellatedPath*>(context->findAndRefCachedResource(key)));
+        if (NULL == tess.get() && fRecentKeys.checkAndAdd(key)) {
+            tess.reset(create_tessellation(path, *stroke, tol, context->getGpu()));
+            if (NULL != tess.get()) {
+                context->addResourceToCache(key, tess.get());
+            }
+        }
+    }
+
     int vertexCnt;
     int indexCnt;
     GrPrimitiveType primType;
     GrDrawTarget::AutoReleaseGeometry arg;
-    if (!this->createGeom(path,
-                          *stroke,
-                          tol,
-                          target,
-                          &primType,
-                          &vertexCnt,
-                          &indexCnt,
-                          &arg)) {
+    if (NULL != tess.get()) {
+        primType = tess->primitiveType();
+        vertexCnt = tess->draws()[0].fVertexCnt;
+        indexCnt = tess->draws()[0].fIndexCnt;
+        target->drawState()->setDefaultVertexAttribs();
+        target->setVertexSourceToBuffer(tess->vertexBuffer());
+        if (NULL != tess->indexBuffer()) {
+            target->setIndexSourceToBuffer(tess->indexBuffer());
+        }
+    } else if (!this->createGeom(path,
+                                 *stroke,
+                                 tol,
+                                 target,
+                                 &primType,
+                                 &vertexCnt,
+                                 &indexCnt,
+                                 &arg)) {
         return false;
     }
 
@@ -504,6 +611,13 @@ bool GrDefaultPathRenderer::internalDrawPath(const SkPath& path,
             }
         }
     }
+
+    if (NULL != tess.get()) {
+        target->resetVertexSource();
+        if (NULL != tess->indexBuffer()) {
+            target->resetIndexSource();
+        }
+    }
     return true;
 }
 
@@ -9,6 +9,7 @@
 #define GrDefaultPathRenderer_DEFINED
 
 #include "GrPathRenderer.h"
+#include "GrTessellatedPath.h"
 #include "SkTemplates.h"
 
 /**
@@ -53,8 +54,9 @@ private:
                     int* indexCnt,
                     GrDrawTarget::AutoReleaseGeometry*);
 
-    bool    fSeparateStencil;
-    bool    fStencilWrapOps;
+    bool                            fSeparateStencil;
+    bool                            fStencilWrapOps;
+    GrTessellatedPath::RecentKeys   fRecentKeys;
 
     typedef GrPathRenderer INHERITED;
 };
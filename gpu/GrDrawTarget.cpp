@@ -81,6 +81,40 @@ void GrDrawTarget::DrawInfo::adjustStartIndex(int indexOffset) {
     SkASSERT(fStartIndex >= 0);
 }
 
+bool GrDrawTarget::DrawInfo::mergeWith(const DrawInfo& next) {
+    // Strips and fans join their primitives, so only lists can be concatenated.
+    if (fPrimitiveType != next.fPrimitiveType ||
+        (kTriangles_GrPrimitiveType != fPrimitiveType &&
+         kLines_GrPrimitiveType != fPrimitiveType &&
+         kPoints_GrPrimitiveType != fPrimitiveType)) {
+        return false;
+    }
+    if (this->isInstanced() || next.isInstanced() ||
+        NULL != this->getDstCopy() || NULL != next.getDstCopy() ||
+        this->isIndexed() != next.isIndexed()) {
+        return false;
+    }
+    if (this->isIndexed()) {
+        // The indices are relative to the start vertex, so it has to be shared.
+        if (fStartVertex != next.fStartVertex || fStartIndex + fIndexCount != next.fStartIndex) {
+            return false;
+        }
+        fIndexCount += next.fIndexCount;
+        fVertexCount = SkTMax(fVertexCount, next.fVertexCount);
+    } else {
+        if (fStartVertex + fVertexCount != next.fStartVertex) {
+            return false;
+        }
+        fVertexCount += next.fVertexCount;
+    }
+    if (NULL != fDevBounds && NULL != next.fDevBounds) {
+        fDevBoundsStorage.join(*next.fDevBounds);
+    } else {
+        fDevBounds = NULL;
+    }
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #define DEBUG_INVAL_BUFFER 0xdeadcafe
@@ -560,6 +594,7 @@ void GrDrawTarget::drawPaths(int pathCount, const GrPath** paths,
     const GrDrawState* drawState = &getDrawState();
 
     SkRect devBounds;
+    devBounds.setEmpty();
     for (int i = 0; i < pathCount; ++i) {
         SkRect mappedPathBounds;
         transforms[i].mapRect(&mappedPathBounds, paths[i]->getBounds());
@@ -1073,6 +1108,11 @@ static SkString map_flags_to_string(uint32_t flags) {
             str.append(" full");
         }
         SkDEBUGCODE(flags &= ~GrDrawTargetCaps::kSubset_MapFlag);
+
+        if (GrDrawTargetCaps::kUnsynchronized_MapFlag & flags) {
+            str.append(" unsynchronized");
+        }
+        SkDEBUGCODE(flags &= ~GrDrawTargetCaps::kUnsynchronized_MapFlag);
     }
     SkASSERT(0 == flags); // Make sure we handled all the flags.
     return str;
@@ -824,6 +824,12 @@ protected:
         void adjustStartVertex(int vertexOffset);
         // shifts the start index
         void adjustStartIndex(int indexOffset);
+        // Extends this draw to also draw next, when drawing both as one is the same as drawing
+        // them in turn: neither is instanced or reads a dst copy, they draw lists of separate
+        // primitives of the same type, and next's vertices (or, when indexed, its indices) follow
+        // this draw's in the same buffers. The caller checks the buffers. Returns false and
+        // leaves this draw unchanged otherwise.
+        bool mergeWith(const DrawInfo& next);
 
         void setDevBounds(const SkRect& bounds) {
             fDevBoundsStorage = bounds;
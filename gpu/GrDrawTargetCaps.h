@@ -52,6 +52,8 @@ public:
         kCanMap_MapFlag  = 0x1,       //<! The resource can be mapped. Must be set for any of
                                       //   the other flags to have meaning.k
         kSubset_MapFlag  = 0x2,       //<! The resource can be partially mapped.
+        kUnsynchronized_MapFlag = 0x4,  //<! A subset of the resource can be mapped without
+                                        //   waiting for pending draws or discarding the rest.
     };
 
     uint32_t mapBufferFlags() const { return fMapBufferFlags; }
@@ -49,6 +49,19 @@ public:
      */
     virtual void* lock() = 0;
 
+    /**
+     * Locks size bytes of the buffer, starting at offset, to be written by the
+     * CPU. Unlike lock(), the rest of the buffer's content is preserved and the
+     * backend does not wait for draws already issued against the buffer. The
+     * caller must guarantee that no issued or pending draw reads from the
+     * locked range. lockPtr() will return the pointer to offset. Must be
+     * matched by an unlock() call.
+     *
+     * @return a pointer to the data at offset or NULL if the backend doesn't
+     *         support unsynchronized partial locks.
+     */
+    virtual void* lockRange(size_t offset, size_t size) { return NULL; }
+
     /**
      * Returns the same ptr that lock() returned at time of lock or NULL if the
      * is not locked.
@@ -35,7 +35,8 @@ GrGpu::GrGpu(GrContext* context)
     , fIndexPool(NULL)
     , fVertexPoolUseCnt(0)
     , fIndexPoolUseCnt(0)
-    , fQuadIndexBuffer(NULL) {
+    , fQuadIndexBuffer(NULL)
+    , fShareGroupID(0) {
 
     fClipMaskManager.setGpu(this);
 
@@ -11,6 +11,8 @@
 #include "GrDrawTarget.h"
 #include "GrClipMaskManager.h"
 #include "SkPath.h"
+#include "SkString.h"
+#include "SkTArray.h"
 
 class GrContext;
 class GrGpuObject;
@@ -18,6 +20,7 @@ class GrIndexBufferAllocPool;
 class GrPath;
 class GrPathRenderer;
 class GrPathRendererChain;
+struct GrSharedTextureEntry;
 class GrStencilBuffer;
 class GrVertexBufferAllocPool;
 
@@ -266,6 +269,56 @@ public:
         fClipMaskManager.releaseResources();
     }
 
+    /**
+     * Optional GPU timing. While enabled, each trace marker scope and each flush of a draw buffer
+     * is bracketed by GPU timestamps. Their results are read back without stalling, typically a
+     * few frames later, and returned by popGpuTimings(). setGpuTimingEnabled() returns false if
+     * the backend can't measure GPU time.
+     */
+    struct GpuTiming {
+        SkString fName;     // the trace markers active around the scope, or "flush"
+        uint64_t fNanos;
+    };
+    virtual bool setGpuTimingEnabled(bool) { return false; }
+    virtual void popGpuTimings(SkTArray<GpuTiming>*) {}
+
+    /**
+     * The backend's cache of compiled programs. Its capacity can be sized for a workload that
+     * mixes many effect combinations, so programs aren't rebuilt after being evicted; the stats
+     * show whether that is happening. Both return false if the backend has no program cache.
+     */
+    struct ProgramCacheStats {
+        int         fCapacity;
+        int         fCount;
+        uint64_t    fHits;
+        uint64_t    fMisses;
+        uint64_t    fEvictions;
+    };
+    virtual bool getProgramCacheStats(ProgramCacheStats*) const { return false; }
+    virtual bool setProgramCacheCapacity(int) { return false; }
+
+    // Called by GrInOrderDrawBuffer around the playback of its commands.
+    virtual void willFlushDrawBuffer() {}
+    virtual void didFlushDrawBuffer() {}
+
+    /**
+     * The share group set by GrSharedTextures::JoinShareGroup(), or 0 if the GrGpu shares no
+     * textures with other GrGpus.
+     */
+    uint32_t shareGroupID() const { return fShareGroupID; }
+    void setShareGroupID(uint32_t groupID) { fShareGroupID = groupID; }
+
+    /**
+     * Called by GrSharedTextures with the texture that is published to, or wrapped from, a
+     * shared entry. From then on the backend object is only deleted through
+     * GrSharedTextures::Release(), whether or not the texture was wrapped. Returns false if
+     * the backend can't share the texture.
+     */
+    virtual bool attachSharedTexture(GrTexture*, GrSharedTextureEntry*) { return false; }
+
+    // Submits the commands issued so far, so that other contexts in the share group see them.
+    virtual void flushForSharing() {}
+
     // After the client interacts directly with the 3D context state the GrGpu
     // must resync its internal state and assumptions about 3D context state.
     // Each time this occurs the GrGpu bumps a timestamp.
@@ -513,6 +566,7 @@ private:
     int                                                                 fIndexPoolUseCnt;
     // these are mutable so they can be created on-demand
     mutable GrIndexBuffer*                                              fQuadIndexBuffer;
+    uint32_t                                                            fShareGroupID;
     // Used to abandon/release all resources created by this GrGpu. TODO: Move this
     // functionality to GrResourceCache.
     ObjectList                                                          fObjectList;
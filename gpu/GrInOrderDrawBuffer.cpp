@@ -308,6 +308,11 @@ int GrInOrderDrawBuffer::concatInstancedDraw(const DrawInfo& info) {
     poolState.fUsedPoolVertexBytes = SkTMax(poolState.fUsedPoolVertexBytes, vertexBytes);
 
     draw->adjustInstanceCount(instancesToConcat);
+    if (draw->fHasBounds && NULL != info.getDevBounds()) {
+        draw->fBounds.join(*info.getDevBounds());
+    } else {
+        draw->fHasBounds = false;
+    }
 
     // update last fGpuCmdMarkers to include any additional trace markers that have been added
     if (this->getActiveTraceMarkers().count() > 0) {
@@ -371,6 +376,13 @@ void GrInOrderDrawBuffer::onDraw(const DrawInfo& info) {
     } else {
         draw = this->recordDraw(info);
     }
+    draw->fRenderTarget = drawState.getRenderTarget();
+    if (NULL != info.getDevBounds()) {
+        draw->fHasBounds = true;
+        draw->fBounds = *info.getDevBounds();
+    } else {
+        draw->fHasBounds = false;
+    }
 
     switch (this->getGeomSrc().fVertexSrc) {
         case kBuffer_GeometrySrcType:
@@ -538,17 +550,20 @@ void GrInOrderDrawBuffer::reset() {
         SkSafeUnref(fDraws[d].fIndexBuffer);
     }
     fCmds.reset();
-    fDraws.reset();
-    fStencilPaths.reset();
-    fDrawPath.reset();
-    fDrawPaths.reset();
-    fStates.reset();
-    fClears.reset();
+    // The records' blocks are kept for the next batch of commands, so that a
+    // steady stream of frames doesn't malloc and free them at every flush.
+    fDraws.rewind();
+    fStencilPaths.rewind();
+    fDrawPath.rewind();
+    fDrawPaths.rewind();
+    fStates.rewind();
+    fStateAliases.reset();
+    fClears.rewind();
     fVertexPool.reset();
     fIndexPool.reset();
-    fClips.reset();
-    fClipOrigins.reset();
-    fCopySurfaces.reset();
+    fClips.rewind();
+    fClipOrigins.rewind();
+    fCopySurfaces.rewind();
     fGpuCmdMarkers.reset();
     fClipSet = true;
 }
@@ -582,99 +597,115 @@ void GrInOrderDrawBuffer::flush() {
 
     GrClipData clipData;
 
-    int currState       = 0;
-    int currClip        = 0;
-    int currClear       = 0;
-    int currDraw        = 0;
-    int currStencilPath = 0;
-    int currDrawPath    = 0;
-    int currDrawPaths   = 0;
-    int currCopySurface = 0;
-    int currCmdMarker   = 0;
-
-    for (int c = 0; c < numCmds; ++c) {
+    // Resolve every command to the index of its record up front, so that the draws can be
+    // reordered before they are issued.
+    SkTArray<CmdRef, true> plan(numCmds);
+    {
+        int counts[kDrawPaths_Cmd + 1] = { 0 };
+        int currCmdMarker = 0;
+        for (int c = 0; c < numCmds; ++c) {
+            CmdRef& ref = plan.push_back();
+            ref.fCmd = strip_trace_bit(fCmds[c]);
+            ref.fIndex = counts[ref.fCmd]++;
+            ref.fMarker = cmd_has_trace_marker(fCmds[c]) ? currCmdMarker++ : -1;
+        }
+        // we should have consumed all the states, clips, etc.
+        SkASSERT(fStates.count() == counts[kSetState_Cmd]);
+        SkASSERT(fClips.count() == counts[kSetClip_Cmd]);
+        SkASSERT(fClipOrigins.count() == counts[kSetClip_Cmd]);
+        SkASSERT(fClears.count() == counts[kClear_Cmd]);
+        SkASSERT(fDraws.count()  == counts[kDraw_Cmd]);
+        SkASSERT(fCopySurfaces.count() == counts[kCopySurface_Cmd]);
+        SkASSERT(fGpuCmdMarkers.count() == currCmdMarker);
+    }
+
+    this->reorderDraws(&plan);
+
+    fDstGpu->willFlushDrawBuffer();
+    for (int c = 0; c < plan.count(); ++c) {
+        const CmdRef& ref = plan[c];
         GrGpuTraceMarker newMarker("", -1);
-        if (cmd_has_trace_marker(fCmds[c])) {
-            SkString traceString = fGpuCmdMarkers[currCmdMarker].toString();
+        if (ref.fMarker >= 0) {
+            SkString traceString = fGpuCmdMarkers[ref.fMarker].toString();
             newMarker.fMarker = traceString.c_str();
             fDstGpu->addGpuTraceMarker(&newMarker);
-            ++currCmdMarker;
         }
-        switch (strip_trace_bit(fCmds[c])) {
+        switch (ref.fCmd) {
             case kDraw_Cmd: {
-                const DrawRecord& draw = fDraws[currDraw];
+                const DrawRecord& draw = fDraws[ref.fIndex];
                 fDstGpu->setVertexSourceToBuffer(draw.fVertexBuffer);
                 if (draw.isIndexed()) {
                     fDstGpu->setIndexSourceToBuffer(draw.fIndexBuffer);
                 }
-                fDstGpu->executeDraw(draw);
-                ++currDraw;
+                // Runs of draws under one state whose geometry follows on in the same buffers,
+                // such as the glyph batches of consecutive text runs, go to the GPU as one draw.
+                DrawInfo merged(draw);
+                while (c + 1 < plan.count() &&
+                       kDraw_Cmd == plan[c + 1].fCmd &&
+                       plan[c + 1].fMarker < 0) {
+                    const DrawRecord& next = fDraws[plan[c + 1].fIndex];
+                    if (next.fVertexBuffer != draw.fVertexBuffer ||
+                        (draw.isIndexed() && next.fIndexBuffer != draw.fIndexBuffer) ||
+                        !merged.mergeWith(next)) {
+                        break;
+                    }
+                    ++c;
+                }
+                fDstGpu->executeDraw(merged);
                 break;
             }
             case kStencilPath_Cmd: {
-                const StencilPath& sp = fStencilPaths[currStencilPath];
+                const StencilPath& sp = fStencilPaths[ref.fIndex];
                 fDstGpu->stencilPath(sp.fPath.get(), sp.fFill);
-                ++currStencilPath;
                 break;
             }
             case kDrawPath_Cmd: {
-                const DrawPath& cp = fDrawPath[currDrawPath];
+                const DrawPath& cp = fDrawPath[ref.fIndex];
                 fDstGpu->executeDrawPath(cp.fPath.get(), cp.fFill,
                                          NULL != cp.fDstCopy.texture() ? &cp.fDstCopy : NULL);
-                ++currDrawPath;
                 break;
             }
             case kDrawPaths_Cmd: {
-                DrawPaths& dp = fDrawPaths[currDrawPaths];
+                DrawPaths& dp = fDrawPaths[ref.fIndex];
                 const GrDeviceCoordTexture* dstCopy =
                     NULL != dp.fDstCopy.texture() ? &dp.fDstCopy : NULL;
                 fDstGpu->executeDrawPaths(dp.fPathCount, dp.fPaths,
                                           dp.fTransforms, dp.fFill, dp.fStroke,
                                           dstCopy);
-                ++currDrawPaths;
                 break;
             }
             case kSetState_Cmd:
-                fStates[currState].restoreTo(&playbackState);
-                ++currState;
+                fStates[ref.fIndex].restoreTo(&playbackState);
                 break;
             case kSetClip_Cmd:
-                clipData.fClipStack = &fClips[currClip];
-                clipData.fOrigin = fClipOrigins[currClip];
+                clipData.fClipStack = &fClips[ref.fIndex];
+                clipData.fOrigin = fClipOrigins[ref.fIndex];
                 fDstGpu->setClip(&clipData);
-                ++currClip;
                 break;
-            case kClear_Cmd:
-                if (GrColor_ILLEGAL == fClears[currClear].fColor) {
-                    fDstGpu->discard(fClears[currClear].fRenderTarget);
+            case kClear_Cmd: {
+                const Clear& clear = fClears[ref.fIndex];
+                if (GrColor_ILLEGAL == clear.fColor) {
+                    fDstGpu->discard(clear.fRenderTarget);
                 } else {
-                    fDstGpu->clear(&fClears[currClear].fRect,
-                                   fClears[currClear].fColor,
-                                   fClears[currClear].fCanIgnoreRect,
-                                   fClears[currClear].fRenderTarget);
+                    fDstGpu->clear(&clear.fRect,
+                                   clear.fColor,
+                                   clear.fCanIgnoreRect,
+                                   clear.fRenderTarget);
                 }
-                ++currClear;
                 break;
+            }
             case kCopySurface_Cmd:
-                fDstGpu->copySurface(fCopySurfaces[currCopySurface].fDst.get(),
-                                     fCopySurfaces[currCopySurface].fSrc.get(),
-                                     fCopySurfaces[currCopySurface].fSrcRect,
-                                     fCopySurfaces[currCopySurface].fDstPoint);
-                ++currCopySurface;
+                fDstGpu->copySurface(fCopySurfaces[ref.fIndex].fDst.get(),
+                                     fCopySurfaces[ref.fIndex].fSrc.get(),
+                                     fCopySurfaces[ref.fIndex].fSrcRect,
+                                     fCopySurfaces[ref.fIndex].fDstPoint);
                 break;
         }
-        if (cmd_has_trace_marker(fCmds[c])) {
+        if (ref.fMarker >= 0) {
             fDstGpu->removeGpuTraceMarker(&newMarker);
         }
     }
-    // we should have consumed all the states, clips, etc.
-    SkASSERT(fStates.count() == currState);
-    SkASSERT(fClips.count() == currClip);
-    SkASSERT(fClipOrigins.count() == currClip);
-    SkASSERT(fClears.count() == currClear);
-    SkASSERT(fDraws.count()  == currDraw);
-    SkASSERT(fCopySurfaces.count() == currCopySurface);
-    SkASSERT(fGpuCmdMarkers.count() == currCmdMarker);
+    fDstGpu->didFlushDrawBuffer();
 
     fDstGpu->setDrawState(prevDrawState);
     prevDrawState->unref();
@@ -682,6 +713,137 @@ void GrInOrderDrawBuffer::flush() {
     ++fDrawID;
 }
 
+namespace {
+// A group of draws that will be issued back to back under one recorded state.
+struct DrawBatch {
+    int     fState;     // index into fStates
+    int     fAlias;     // canonical index of fState
+    bool    fHasBounds;
+    SkRect  fBounds;    // union of the device bounds of the draws in the batch
+};
+}
+
+// How many batches back a draw may jump to find one with an identical state.
+static const int kMaxBatchLookback = 8;
+
+void GrInOrderDrawBuffer::reorderDraws(SkTArray<CmdRef, true>* plan) const {
+    const int count = plan->count();
+    int drawCount = 0;
+    for (int c = 0; c < count; ++c) {
+        drawCount += kDraw_Cmd == (*plan)[c].fCmd;
+    }
+    if (drawCount < 2 || fStates.count() < 2) {
+        return;
+    }
+
+    SkTArray<CmdRef, true> out(count);
+    SkTArray<DrawBatch, true> batches;
+    SkTArray<SkTArray<CmdRef, true> > batchDraws;
+
+    // The index of the state that would be current on the gpu when playing plan in order, and the
+    // one actually current in out.
+    int origState = -1;
+    int outState = -1;
+    const GrRenderTarget* windowTarget = NULL;
+
+    int c = 0;
+    while (c <= count) {
+        const CmdRef* ref = c < count ? &(*plan)[c] : NULL;
+        bool inWindow = NULL != ref && ref->fMarker < 0 &&
+                        (kSetState_Cmd == ref->fCmd || kDraw_Cmd == ref->fCmd);
+        if (inWindow && kDraw_Cmd == ref->fCmd) {
+            const GrRenderTarget* target = fDraws[ref->fIndex].fRenderTarget;
+            // Never move draws across a change of render target, since one target may be a
+            // texture that the other reads from.
+            if (!batches.empty() && target != windowTarget) {
+                inWindow = false;
+            }
+            windowTarget = target;
+        }
+
+        if (inWindow) {
+            if (kSetState_Cmd == ref->fCmd) {
+                origState = ref->fIndex;
+            } else {
+                SkASSERT(origState >= 0);
+                const DrawRecord& draw = fDraws[ref->fIndex];
+                int alias = fStateAliases[origState];
+                int target = -1;
+                for (int b = batches.count() - 1;
+                     b >= 0 && b >= batches.count() - kMaxBatchLookback; --b) {
+                    const DrawBatch& batch = batches[b];
+                    if (batch.fAlias == alias) {
+                        target = b;
+                        break;
+                    }
+                    if (!draw.fHasBounds || !batch.fHasBounds ||
+                        SkRect::Intersects(draw.fBounds, batch.fBounds)) {
+                        break;
+                    }
+                }
+                if (target < 0) {
+                    target = batches.count();
+                    DrawBatch& batch = batches.push_back();
+                    batch.fState = origState;
+                    batch.fAlias = alias;
+                    batch.fHasBounds = draw.fHasBounds;
+                    batch.fBounds = draw.fBounds;
+                    batchDraws.push_back();
+                } else {
+                    DrawBatch& batch = batches[target];
+                    if (batch.fHasBounds && draw.fHasBounds) {
+                        batch.fBounds.join(draw.fBounds);
+                    } else {
+                        batch.fHasBounds = false;
+                    }
+                }
+                batchDraws[target].push_back(*ref);
+            }
+            ++c;
+            continue;
+        }
+
+        // End of a window: emit its batches, then make sure the gpu is left in the state that
+        // in-order playback would have left it in.
+        for (int b = 0; b < batches.count(); ++b) {
+            if (outState < 0 || fStateAliases[outState] != batches[b].fAlias) {
+                CmdRef& setState = out.push_back();
+                setState.fCmd = kSetState_Cmd;
+                setState.fIndex = batches[b].fState;
+                setState.fMarker = -1;
+                outState = batches[b].fState;
+            }
+            out.push_back_n(batchDraws[b].count(), batchDraws[b].begin());
+        }
+        if (origState >= 0 &&
+            (outState < 0 || fStateAliases[outState] != fStateAliases[origState])) {
+            CmdRef& setState = out.push_back();
+            setState.fCmd = kSetState_Cmd;
+            setState.fIndex = origState;
+            setState.fMarker = -1;
+            outState = origState;
+        }
+        batches.reset();
+        batchDraws.reset();
+        windowTarget = NULL;
+
+        if (NULL == ref) {
+            break;
+        }
+        if (kDraw_Cmd == ref->fCmd && ref->fMarker < 0) {
+            // Only the render target changed; this draw starts the next window.
+            continue;
+        }
+        if (kSetState_Cmd == ref->fCmd) {
+            origState = outState = ref->fIndex;
+        }
+        out.push_back(*ref);
+        ++c;
+    }
+
+    *plan = out;
+}
+
 bool GrInOrderDrawBuffer::onCopySurface(GrSurface* dst,
                                         GrSurface* src,
                                         const SkIRect& srcRect,
@@ -948,8 +1110,21 @@ void GrInOrderDrawBuffer::recordClip() {
     this->addToCmdBuffer(kSetClip_Cmd);
 }
 
+// How many recorded states to compare against when looking for a duplicate of a new state.
+static const int kStateAliasLookback = 4;
+
 void GrInOrderDrawBuffer::recordState() {
-    fStates.push_back().saveFrom(this->getDrawState());
+    const GrDrawState& drawState = this->getDrawState();
+    int count = fStates.count();
+    int alias = count;
+    for (int i = 1; i <= kStateAliasLookback && i <= count; ++i) {
+        if (fStates[count - i].isEqual(drawState)) {
+            alias = fStateAliases[count - i];
+            break;
+        }
+    }
+    fStateAliases.push_back(alias);
+    fStates.push_back().saveFrom(drawState);
     this->addToCmdBuffer(kSetState_Cmd);
 }
 
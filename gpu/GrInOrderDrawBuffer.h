@@ -98,6 +98,19 @@ private:
         DrawRecord(const DrawInfo& info) : DrawInfo(info) {}
         const GrVertexBuffer*   fVertexBuffer;
         const GrIndexBuffer*    fIndexBuffer;
+        // Used only to decide whether the draw may be reordered at flush time. The target is not
+        // reffed; the recorded state that precedes the draw holds the ref.
+        const GrRenderTarget*   fRenderTarget;
+        bool                    fHasBounds;
+        SkRect                  fBounds;
+    };
+
+    // A reference to one recorded command, with the index of its record in the per-type arrays
+    // and of its trace markers (or -1).
+    struct CmdRef {
+        uint8_t fCmd;
+        int     fIndex;
+        int     fMarker;
     };
 
     struct StencilPath : public ::SkNoncopyable {
@@ -199,6 +212,10 @@ private:
     bool needsNewState() const;
     bool needsNewClip() const;
 
+    // Reorders runs of draws and state changes in plan so that draws that share a state and don't
+    // overlap any of the draws they jump over are issued together.
+    void reorderDraws(SkTArray<CmdRef, true>* plan) const;
+
     // these functions record a command
     void            recordState();
     void            recordClip();
@@ -229,6 +246,8 @@ private:
     GrSTAllocator<kDrawPathPreallocCnt, DrawPath>                      fDrawPath;
     GrSTAllocator<kDrawPathsPreallocCnt, DrawPaths>                    fDrawPaths;
     GrSTAllocator<kStatePreallocCnt, GrDrawState::DeferredState>       fStates;
+    // For each entry in fStates, the index of the first recorded state that is identical to it.
+    SkSTArray<kStatePreallocCnt, int, true>                            fStateAliases;
     GrSTAllocator<kClearPreallocCnt, Clear>                            fClears;
     GrSTAllocator<kCopySurfacePreallocCnt, CopySurface>                fCopySurfaces;
     GrSTAllocator<kClipPreallocCnt, SkClipStack>                       fClips;
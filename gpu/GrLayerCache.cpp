@@ -6,6 +6,7 @@
  */
 
 #include "GrAtlas.h"
+#include "GrContext.h"
 #include "GrGpu.h"
 #include "GrLayerCache.h"
 
@@ -43,10 +44,11 @@ private:
 
 GrLayerCache::GrLayerCache(GrGpu* gpu)
     : fGpu(SkRef(gpu))
-    , fLayerPool(16) {      // TODO: may need to increase this later
+    , fAtlasedLayerCount(0) {
 }
 
 GrLayerCache::~GrLayerCache() {
+    this->freeAll();
 }
 
 void GrLayerCache::init() {
@@ -55,19 +57,27 @@ void GrLayerCache::init() {
 
     SkASSERT(NULL == fAtlasMgr.get());
 
-    // The layer cache only gets 1 plot
+    // The layer cache only gets 1 plot. Layers are drawn straight into it, so
+    // unlike the font atlases it must be a render target.
     SkISize textureSize = SkISize::Make(kAtlasTextureWidth, kAtlasTextureHeight);
     fAtlasMgr.reset(SkNEW_ARGS(GrAtlasMgr, (fGpu, kSkia8888_GrPixelConfig,
-                                            textureSize, 1, 1)));
+                                            textureSize, 1, 1, 1,
+                                            kRenderTarget_GrTextureFlagBit)));
 }
 
 void GrLayerCache::freeAll() {
+    SkTDArray<GrCachedLayer*>& layers = fLayerHash.getArray();
+    for (int i = 0; i < layers.count(); ++i) {
+        this->unlock(layers[i]);
+    }
     fLayerHash.deleteAll();
     fAtlasMgr.free();
 }
 
 GrCachedLayer* GrLayerCache::createLayer(SkPicture* picture, int layerID) {
-    GrCachedLayer* layer = fLayerPool.alloc();
+    // Layers come and go with their pictures (see purge()), so they are
+    // allocated individually rather than from a pool that is never returned to.
+    GrCachedLayer* layer = SkNEW(GrCachedLayer);
 
     SkASSERT(picture->uniqueID() != SK_InvalidGenID);
     layer->init(picture->uniqueID(), layerID);
@@ -84,3 +94,65 @@ GrCachedLayer* GrLayerCache::findLayerOrCreate(SkPicture* picture, int layerID)
     }
     return layer;
 }
+
+bool GrLayerCache::lock(GrCachedLayer* layer, const GrTextureDesc& desc) {
+    if (NULL != layer->getTexture()) {
+        // This layer was rendered by an earlier draw of its picture
+        return true;
+    }
+
+    if (NULL == fAtlasMgr.get()) {
+        this->init();
+    }
+
+    GrIPoint16 loc;
+    GrPlot* plot = fAtlasMgr->addToAtlas(&fPlotUsage, desc.fWidth, desc.fHeight, NULL, &loc);
+    if (NULL != plot) {
+        GrIRect16 bounds;
+        bounds.fLeft   = loc.fX;
+        bounds.fTop    = loc.fY;
+        bounds.fRight  = loc.fX + desc.fWidth;
+        bounds.fBottom = loc.fY + desc.fHeight;
+        layer->setTexture(SkRef(plot->texture()), plot, bounds);
+        ++fAtlasedLayerCount;
+        return false;
+    }
+
+    // The atlas is full (or the layer too big for it), so the layer gets a
+    // texture of its own.
+    layer->setTexture(fGpu->getContext()->lockAndRefScratchTexture(
+                                                desc, GrContext::kApprox_ScratchTexMatch));
+    return false;
+}
+
+void GrLayerCache::unlock(GrCachedLayer* layer) {
+    if (NULL == layer->getTexture()) {
+        return;
+    }
+
+    if (layer->isAtlased()) {
+        GrPlot* plot = layer->location().plot();
+        layer->setTexture(NULL);
+        SkASSERT(fAtlasedLayerCount > 0);
+        if (0 == --fAtlasedLayerCount) {
+            // With only one plot, nothing else can be using it now.
+            plot->resetRects();
+            fAtlasMgr->removePlot(&fPlotUsage, plot);
+        }
+    } else {
+        fGpu->getContext()->unlockScratchTexture(layer->getTexture());
+        layer->setTexture(NULL);
+    }
+}
+
+void GrLayerCache::purge(const SkPicture* picture) {
+    SkTDArray<GrCachedLayer*>& layers = fLayerHash.getArray();
+    for (int i = layers.count() - 1; i >= 0; --i) {
+        GrCachedLayer* layer = layers[i];
+        if (layer->pictureID() == picture->uniqueID()) {
+            this->unlock(layer);
+            fLayerHash.remove(PictureLayerKey(layer->pictureID(), layer->layerID()), layer);
+            SkDELETE(layer);
+        }
+    }
+}
@@ -8,14 +8,12 @@
 #ifndef GrLayerCache_DEFINED
 #define GrLayerCache_DEFINED
 
-#include "GrAllocPool.h"
+#include "GrAtlas.h"
 #include "GrTHashTable.h"
 #include "GrPictureUtils.h"
 #include "GrRect.h"
 
-class GrAtlasMgr;
 class GrGpu;
-class GrPlot;
 class SkPicture;
 
 // GrAtlasLocation captures an atlased item's position in the atlas. This
@@ -30,7 +28,7 @@ public:
         fBounds = bounds;
     }
 
-    const GrPlot* plot() const {
+    GrPlot* plot() const {
         return fPlot;
     }
 
@@ -71,9 +69,20 @@ public:
         }
 
         fTexture = texture; // just take over caller's ref
+        fLocation.set(NULL, GrIRect16::MakeEmpty());
+    }
+    // As above, but the layer only occupies 'bounds' of 'plot's texture.
+    void setTexture(GrTexture* texture, GrPlot* plot, const GrIRect16& bounds) {
+        this->setTexture(texture);
+        fLocation.set(plot, bounds);
     }
     GrTexture* getTexture() { return fTexture; }
 
+    bool isAtlased() const { return NULL != fLocation.plot(); }
+    // Only valid if the layer is atlased. Non-atlased layers sit at the origin of
+    // an approximately sized scratch texture, so may not fill it.
+    const GrAtlasLocation& location() const { return fLocation; }
+
 private:
     uint32_t        fPictureID;
     // fLayerID is only valid when fPicture != kInvalidGenID in which case it
@@ -104,16 +113,31 @@ public:
 
     GrCachedLayer* findLayerOrCreate(SkPicture* picture, int id);
 
+    // Makes sure 'layer' has a texture to hold a 'desc'-sized rendering, first
+    // by finding it room in the atlas and failing that, by locking a scratch
+    // texture. Returns true if the layer's texture already holds its content,
+    // and false if the caller must render it (or, if layer->getTexture() is
+    // still NULL, couldn't get a texture at all).
+    bool lock(GrCachedLayer* layer, const GrTextureDesc& desc);
+
+    // Releases all of 'picture's layers, e.g. once it is deleted or won't be
+    // drawn again.
+    void purge(const SkPicture* picture);
+
 private:
     SkAutoTUnref<GrGpu>       fGpu;
     SkAutoTDelete<GrAtlasMgr> fAtlasMgr; // TODO: could lazily allocate
+    GrAtlas                   fPlotUsage;
+    // Atlas space can only be reclaimed a whole plot at a time, so the plots
+    // are only reset once the last atlased layer is unlocked.
+    int                       fAtlasedLayerCount;
 
     class PictureLayerKey;
     GrTHashTable<GrCachedLayer, PictureLayerKey, 7> fLayerHash;
-    GrTAllocPool<GrCachedLayer> fLayerPool;
 
     void init();
     GrCachedLayer* createLayer(SkPicture* picture, int id);
+    void unlock(GrCachedLayer* layer);
 
 };
 
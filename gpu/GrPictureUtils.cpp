@@ -139,6 +139,7 @@ protected:
         // We need the x & y values that will yield 'getOrigin' when transformed
         // by 'draw.fMatrix'.
         device->fInfo.fOffset.iset(device->getOrigin());
+        device->fInfo.fOrigin = device->getOrigin();
 
         SkMatrix invMatrix;
         if (draw.fMatrix->invert(&invMatrix)) {
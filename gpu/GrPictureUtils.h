@@ -29,6 +29,9 @@ public:
         // The offset that needs to be passed to drawBitmap to correctly
         // position the pre-rendered layer.
         SkPoint fOffset;
+        // The layer's top-left corner in the picture's device space, i.e. where
+        // a pre-rendered layer lands when the picture is drawn untransformed.
+        SkIPoint fOrigin;
         // The paint to use on restore. NULL if the paint was not copyable (and
         // thus that this layer should not be pulled forward).
         const SkPaint* fPaint;
@@ -11,6 +11,10 @@
 #include "GrResourceCache.h"
 #include "GrCacheable.h"
 
+#include "SkMemoryBudget.h"
+#include "SkStats.h"
+#include "SkTime.h"
+
 DECLARE_SKMESSAGEBUS_MESSAGE(GrResourceInvalidatedMessage);
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -43,7 +47,8 @@ GrResourceCacheEntry::GrResourceCacheEntry(GrResourceCache* resourceCache,
           fKey(key),
           fResource(resource),
           fCachedSize(resource->gpuMemorySize()),
-          fIsExclusive(false) {
+          fIsExclusive(false),
+          fLastUseFlush(0) {
     // we assume ownership of the resource, and will unref it when we die
     SkASSERT(resource);
     resource->ref();
@@ -95,11 +100,24 @@ GrResourceCache::GrResourceCache(int maxCount, size_t maxBytes) :
 
     fOverbudgetCB                 = NULL;
     fOverbudgetData               = NULL;
+
+    fFlushCount                   = 0;
+
+    fPurgeStepBytes               = GR_RESOURCE_CACHE_PURGE_STEP_BYTES;
+    fPurgeStepMSecs               = GR_RESOURCE_CACHE_PURGE_STEP_MSECS;
+    fPurgeDeferred                = false;
+    fForceFullPurge               = false;
+
+    fHasBudgetPurgeTarget         = false;
+    fBudgetPurgeTarget            = 0;
+    SkMemoryBudget::Register(BudgetUsageProc, BudgetPurgeProc, this);
 }
 
 GrResourceCache::~GrResourceCache() {
     GrAutoResourceCacheValidate atcv(this);
 
+    SkMemoryBudget::Unregister(this);
+
     EntryList::Iter iter;
 
     // Unlike the removeAll, here we really remove everything, including locked resources.
@@ -165,6 +183,8 @@ void GrResourceCache::internalDetach(GrResourceCacheEntry* entry,
 void GrResourceCache::attachToHead(GrResourceCacheEntry* entry,
                                    BudgetBehaviors behavior) {
     fList.addToHead(entry);
+    // This keeps fList sorted by fLastUseFlush.
+    entry->fLastUseFlush = fFlushCount;
 
     // update our stats
     if (kIgnore_BudgetBehavior == behavior) {
@@ -246,6 +266,7 @@ void GrResourceCache::addResource(const GrResourceKey& key,
         this->makeExclusive(entry);
     }
 
+    SkMemoryBudget::NoteGrowth(entry->fCachedSize);
 }
 
 void GrResourceCache::makeExclusive(GrResourceCacheEntry* entry) {
@@ -340,8 +361,12 @@ void GrResourceCache::purgeAsNeeded(int extraCount, size_t extraBytes) {
 
     this->purgeInvalidated();
 
-    this->internalPurge(extraCount, extraBytes);
-    if (((fEntryCount+extraCount) > fMaxCount ||
+    fPurgeDeferred = false;
+    bool finished = this->internalPurge(extraCount, extraBytes);
+    // If the purge stopped early the rest is left for the next flush; don't make the context
+    // flush to free more in the meantime.
+    if (finished &&
+        ((fEntryCount+extraCount) > fMaxCount ||
         (fEntryBytes+extraBytes) > fMaxBytes) &&
         NULL != fOverbudgetCB) {
         // Despite the purge we're still over budget. See if Ganesh can
@@ -383,9 +408,19 @@ void GrResourceCache::deleteResource(GrResourceCacheEntry* entry) {
     delete entry;
 }
 
-void GrResourceCache::internalPurge(int extraCount, size_t extraBytes) {
+bool GrResourceCache::internalPurge(int extraCount, size_t extraBytes) {
     SkASSERT(fPurging);
 
+    // An incremental purge frees at most a step's worth and defers the rest, unless the cache
+    // has grown to twice its budget, at which point everything goes at once again.
+    bool incremental = !fForceFullPurge &&
+                       (fPurgeStepBytes > 0 || fPurgeStepMSecs > 0) &&
+                       (fEntryCount+extraCount) / 2 <= fMaxCount &&
+                       (fEntryBytes+extraBytes) / 2 <= fMaxBytes;
+    size_t bytesFreed = 0;
+    int deleteCount = 0;
+    SkMSec startMSecs = (incremental && fPurgeStepMSecs > 0) ? SkTime::GetMSecs() : 0;
+
     bool withinBudget = false;
     bool changed = false;
 
@@ -413,12 +448,110 @@ void GrResourceCache::internalPurge(int extraCount, size_t extraBytes) {
 
             GrResourceCacheEntry* prev = iter.prev();
             if (entry->fResource->unique()) {
+                if (incremental && this->purgeStepDone(bytesFreed, deleteCount, startMSecs)) {
+                    fPurgeDeferred = true;
+                    return false;
+                }
                 changed = true;
+                bytesFreed += entry->fCachedSize;
+                ++deleteCount;
+                SK_STATS_INC(kGrResourceCachePurge_Counter);
                 this->deleteResource(entry);
             }
             entry = prev;
         }
     } while (!withinBudget && changed);
+    return true;
+}
+
+bool GrResourceCache::purgeStepDone(size_t bytesFreed, int deleteCount,
+                                    SkMSec startMSecs) const {
+    if (fPurgeStepBytes > 0 && bytesFreed >= fPurgeStepBytes) {
+        return true;
+    }
+    // Reading the clock isn't free, so only look every few deletes.
+    static const int kDeletesPerTimeCheck = 8;
+    return fPurgeStepMSecs > 0 && deleteCount > 0 &&
+           0 == deleteCount % kDeletesPerTimeCheck &&
+           SkTime::GetMSecs() - startMSecs >= fPurgeStepMSecs;
+}
+
+void GrResourceCache::setIncrementalPurge(size_t maxBytesPerStep, SkMSec maxMSecsPerStep) {
+    fPurgeStepBytes = maxBytesPerStep;
+    fPurgeStepMSecs = maxMSecsPerStep;
+    if (0 == maxBytesPerStep && 0 == maxMSecsPerStep && fPurgeDeferred) {
+        this->purgeAsNeeded();
+    }
+}
+
+void GrResourceCache::didFlush() {
+    ++fFlushCount;
+
+    if (fPurging) {
+        return;
+    }
+    fPurging = true;
+    this->purgeStaleScratch();
+    fPurging = false;
+
+    if (fPurgeDeferred) {
+        this->purgeAsNeeded();
+    }
+    this->applyBudgetPurge();
+}
+
+size_t GrResourceCache::BudgetUsageProc(void* cache) {
+    // Read without synchronization from other threads, so only approximate there.
+    return static_cast<GrResourceCache*>(cache)->fEntryBytes;
+}
+
+void GrResourceCache::BudgetPurgeProc(void* ctx, size_t targetBytes) {
+    GrResourceCache* cache = static_cast<GrResourceCache*>(ctx);
+    SkAutoMutexAcquire ac(cache->fBudgetPurgeMutex);
+    if (!cache->fHasBudgetPurgeTarget || targetBytes < cache->fBudgetPurgeTarget) {
+        cache->fBudgetPurgeTarget = targetBytes;
+    }
+    cache->fHasBudgetPurgeTarget = true;
+}
+
+void GrResourceCache::applyBudgetPurge() {
+    size_t target;
+    {
+        SkAutoMutexAcquire ac(fBudgetPurgeMutex);
+        if (!fHasBudgetPurgeTarget) {
+            return;
+        }
+        target = fBudgetPurgeTarget;
+        fHasBudgetPurgeTarget = false;
+    }
+
+    // As purgeAllUnlocked(): purge to a temporarily lowered budget.
+    size_t savedMaxBytes = fMaxBytes;
+    fMaxBytes = SkTMin(fMaxBytes, target);
+    fForceFullPurge = true;
+    this->purgeAsNeeded();
+    fForceFullPurge = false;
+    fMaxBytes = savedMaxBytes;
+}
+
+void GrResourceCache::purgeStaleScratch() {
+    SkASSERT(fPurging);
+
+    EntryList::Iter iter;
+    GrResourceCacheEntry* entry = iter.init(fList, EntryList::Iter::kTail_IterStart);
+
+    // The list is in order of last use, so stop at the first entry that is recent enough.
+    // Unsigned arithmetic keeps the ages right when fFlushCount wraps.
+    while (NULL != entry && fFlushCount - entry->fLastUseFlush > kMaxScratchFlushAge) {
+        GrAutoResourceCacheValidate atcv(this);
+
+        GrResourceCacheEntry* prev = iter.prev();
+        if (entry->key().isScratch() && entry->fResource->unique()) {
+            SK_STATS_INC(kGrResourceCachePurge_Counter);
+            this->deleteResource(entry);
+        }
+        entry = prev;
+    }
 }
 
 void GrResourceCache::purgeAllUnlocked() {
@@ -432,7 +565,9 @@ void GrResourceCache::purgeAllUnlocked() {
     int savedMaxCount = fMaxCount;
     fMaxBytes = (size_t) -1;
     fMaxCount = 0;
+    fForceFullPurge = true;
     this->purgeAsNeeded();
+    fForceFullPurge = false;
 
 #ifdef SK_DEBUG
     SkASSERT(fExclusiveList.countEntries() == fClientDetachedCount);
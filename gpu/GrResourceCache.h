@@ -16,8 +16,19 @@
 #include "GrTMultiMap.h"
 #include "GrBinHashKey.h"
 #include "SkMessageBus.h"
+#include "SkThread.h"
 #include "SkTInternalLList.h"
 
+// By default the cache purges synchronously: as soon as it is over budget it deletes what it
+// must to get back under. A nonzero step limit makes the purge incremental (see
+// GrResourceCache::setIncrementalPurge()).
+#ifndef GR_RESOURCE_CACHE_PURGE_STEP_BYTES
+    #define GR_RESOURCE_CACHE_PURGE_STEP_BYTES  0
+#endif
+#ifndef GR_RESOURCE_CACHE_PURGE_STEP_MSECS
+    #define GR_RESOURCE_CACHE_PURGE_STEP_MSECS  0
+#endif
+
 class GrCacheable;
 class GrResourceCache;
 class GrResourceCacheEntry;
@@ -147,6 +158,8 @@ private:
     GrCacheable*     fResource;
     size_t           fCachedSize;
     bool             fIsExclusive;
+    // The cache's flush count when the entry was last made MRU
+    uint32_t         fLastUseFlush;
 
     // Linked list for the LRU ordering.
     SK_DECLARE_INTERNAL_LLIST_INTERFACE(GrResourceCacheEntry);
@@ -313,6 +326,23 @@ public:
      */
     void purgeAsNeeded(int extraCount = 0, size_t extraBytes = 0);
 
+    /**
+     * Limits each purge to roughly maxBytesPerStep bytes or maxMSecsPerStep milliseconds of
+     * deleting (0 means no limit of that kind; both 0 purges synchronously, the default).
+     * Whatever a step leaves over budget is purged by the following flushes, so dropping a big
+     * page doesn't delete every texture it used in one frame. A cache that reaches twice its
+     * budget, and purgeAllUnlocked(), still purge everything at once.
+     */
+    void setIncrementalPurge(size_t maxBytesPerStep, SkMSec maxMSecsPerStep);
+
+    /**
+     * Called when the owning context flushes. Unused scratch resources that have gone
+     * kMaxScratchFlushAge flushes without being reused are deleted, even if the cache is
+     * within its budget, so the scratch pool tracks what recent frames need. Also carries out
+     * any purge SkMemoryBudget asked for since the last flush.
+     */
+    void didFlush();
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
@@ -368,7 +398,29 @@ private:
     PFOverbudgetCB fOverbudgetCB;
     void*          fOverbudgetData;
 
-    void internalPurge(int extraCount, size_t extraBytes);
+    // Returns false if an incremental step stopped before getting within budget.
+    bool internalPurge(int extraCount, size_t extraBytes);
+    bool purgeStepDone(size_t bytesFreed, int deleteCount, SkMSec startMSecs) const;
+
+    size_t         fPurgeStepBytes;
+    SkMSec         fPurgeStepMSecs;
+    bool           fPurgeDeferred;      // an incremental purge left work for the next flush
+    bool           fForceFullPurge;
+    void purgeStaleScratch();
+
+    // The cache is a client of SkMemoryBudget. Purge requests can come from any thread, so
+    // they are only recorded here and carried out by the next didFlush().
+    static size_t BudgetUsageProc(void* cache);
+    static void BudgetPurgeProc(void* cache, size_t targetBytes);
+    SkMutex        fBudgetPurgeMutex;
+    bool           fHasBudgetPurgeTarget;
+    size_t         fBudgetPurgeTarget;
+    void applyBudgetPurge();
+
+    enum {
+        kMaxScratchFlushAge = 32
+    };
+    uint32_t       fFlushCount;
 
     // Listen for messages that a resource has been invalidated and purge cached junk proactively.
     SkMessageBus<GrResourceInvalidatedMessage>::Inbox fInvalidationInbox;
@@ -177,6 +177,41 @@ GrTexture* GrSWMaskHelper::DrawPathMaskToTexture(GrContext* context,
     return ast.detach();
 }
 
+/**
+ * Returns the mask texture cached under cacheID, or software rasterizes path
+ * and uploads it to a new texture that is cached under cacheID. Returns NULL
+ * on failure.
+ */
+GrTexture* GrSWMaskHelper::DrawPathMaskToCachedTexture(GrContext* context,
+                                                       const SkPath& path,
+                                                       const SkStrokeRec& stroke,
+                                                       const SkIRect& resultBounds,
+                                                       bool antiAlias,
+                                                       SkMatrix* matrix,
+                                                       const GrCacheID& cacheID) {
+    GrTextureDesc desc;
+    desc.fWidth = resultBounds.width();
+    desc.fHeight = resultBounds.height();
+    desc.fConfig = kAlpha_8_GrPixelConfig;
+
+    GrTexture* texture = context->findAndRefTexture(desc, cacheID, NULL);
+    if (NULL != texture) {
+        return texture;
+    }
+
+    GrSWMaskHelper helper(context);
+
+    if (!helper.init(resultBounds, matrix)) {
+        return NULL;
+    }
+
+    helper.draw(path, stroke, SkRegion::kReplace_Op, antiAlias, 0xFF);
+
+    SkAutoLockPixels alp(helper.fBM);
+    return context->createTexture(NULL, desc, cacheID,
+                                  helper.fBM.getPixels(), helper.fBM.rowBytes());
+}
+
 void GrSWMaskHelper::DrawToTargetWithPathMask(GrTexture* texture,
                                               GrDrawTarget* target,
                                               const SkIRect& rect) {
@@ -18,6 +18,7 @@
 #include "SkTypes.h"
 
 class GrAutoScratchTexture;
+class GrCacheID;
 class GrContext;
 class GrTexture;
 class SkPath;
@@ -79,6 +80,20 @@ public:
                                             bool antiAlias,
                                             SkMatrix* matrix);
 
+    // As DrawPathMaskToTexture, but first looks for a mask texture already
+    // cached under "cacheID" and, failing that, uploads the new mask to a
+    // texture that is added to the context's texture cache under "cacheID".
+    // The caller must ensure that "cacheID" identifies everything the mask
+    // depends on: the path, stroke, antialiasing, the matrix relative to
+    // "resultBounds"' top-left corner, and the size of "resultBounds".
+    static GrTexture* DrawPathMaskToCachedTexture(GrContext* context,
+                                                  const SkPath& path,
+                                                  const SkStrokeRec& stroke,
+                                                  const SkIRect& resultBounds,
+                                                  bool antiAlias,
+                                                  SkMatrix* matrix,
+                                                  const GrCacheID& cacheID);
+
     // This utility routine is used to add a path's mask to some other draw.
     // The ClipMaskManager uses it to accumulate clip masks while the
     // GrSoftwarePathRenderer uses it to fulfill a drawPath call.
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrSharedTextures.h"
+
+#include "GrContext.h"
+#include "GrGpu.h"
+#include "GrResourceCache.h"
+#include "GrTexture.h"
+
+#include "SkTDynamicHash.h"
+#include "SkThread.h"
+
+struct GrSharedTextureEntry {
+    struct Key {
+        Key(uint32_t groupID, const GrResourceKey& resourceKey)
+            : fGroupID(groupID)
+            , fResourceKey(resourceKey) {
+        }
+        bool operator==(const Key& other) const {
+            return fGroupID == other.fGroupID && fResourceKey == other.fResourceKey;
+        }
+
+        uint32_t        fGroupID;
+        GrResourceKey   fResourceKey;
+    };
+
+    explicit GrSharedTextureEntry(const Key& key) : fKey(key), fRefCnt(0) {}
+
+    static const Key& GetKey(const GrSharedTextureEntry& entry) { return entry.fKey; }
+    static uint32_t Hash(const Key& key) {
+        return key.fResourceKey.getHash() ^ (key.fGroupID * 0x9E3779B9);
+    }
+
+    Key             fKey;
+    GrBackendObject fHandle;
+    int             fWidth;
+    int             fHeight;
+    GrPixelConfig   fConfig;
+    int             fRefCnt;    // the number of contexts holding the texture, guarded by gMutex
+};
+
+typedef SkTDynamicHash<GrSharedTextureEntry, GrSharedTextureEntry::Key> EntryHash;
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+// Made on first use, to stay clear of static initializers.
+static EntryHash* gEntries;
+
+static EntryHash* entries() {
+    if (NULL == gEntries) {
+        gEntries = SkNEW(EntryHash);
+    }
+    return gEntries;
+}
+
+void GrSharedTextures::JoinShareGroup(GrContext* context, uint32_t groupID) {
+    context->getGpu()->setShareGroupID(groupID);
+}
+
+GrTexture* GrSharedTextures::FindAndRef(GrContext* context, const GrResourceKey& resourceKey) {
+    GrGpu* gpu = context->getGpu();
+    if (0 == gpu->shareGroupID()) {
+        return NULL;
+    }
+
+    GrTexture* texture;
+    {
+        SkAutoMutexAcquire ac(gMutex);
+        GrSharedTextureEntry::Key key(gpu->shareGroupID(), resourceKey);
+        GrSharedTextureEntry* entry = entries()->find(key);
+        if (NULL == entry) {
+            return NULL;
+        }
+
+        // Wrapping only makes the CPU side objects, so it's fine to do under the lock, which
+        // keeps the last holder from deleting the texture before it's reffed here.
+        GrBackendTextureDesc desc;
+        desc.fFlags = kNone_GrBackendTextureFlag;
+        desc.fOrigin = kTopLeft_GrSurfaceOrigin;
+        desc.fWidth = entry->fWidth;
+        desc.fHeight = entry->fHeight;
+        desc.fConfig = entry->fConfig;
+        desc.fSampleCnt = 0;
+        desc.fTextureHandle = entry->fHandle;
+        texture = context->wrapBackendTexture(desc);
+        if (NULL == texture) {
+            return NULL;
+        }
+        if (!gpu->attachSharedTexture(texture, entry)) {
+            texture->unref();
+            return NULL;
+        }
+        ++entry->fRefCnt;
+    }
+
+    context->addResourceToCache(resourceKey, texture);
+    return texture;
+}
+
+void GrSharedTextures::Publish(GrContext* context, const GrResourceKey& resourceKey,
+                               GrTexture* texture) {
+    GrGpu* gpu = context->getGpu();
+    if (0 == gpu->shareGroupID() || NULL != texture->asRenderTarget()) {
+        return;
+    }
+
+    SkAutoMutexAcquire ac(gMutex);
+    GrSharedTextureEntry::Key key(gpu->shareGroupID(), resourceKey);
+    if (NULL != entries()->find(key)) {
+        // Another context got there first; this one keeps its own copy.
+        return;
+    }
+
+    GrSharedTextureEntry* entry = SkNEW_ARGS(GrSharedTextureEntry, (key));
+    entry->fHandle = texture->getTextureHandle();
+    entry->fWidth = texture->width();
+    entry->fHeight = texture->height();
+    entry->fConfig = texture->config();
+    if (0 == entry->fHandle || !gpu->attachSharedTexture(texture, entry)) {
+        SkDELETE(entry);
+        return;
+    }
+    entry->fRefCnt = 1;
+    // Submit the upload before anyone else can find the texture.
+    gpu->flushForSharing();
+    entries()->add(entry);
+}
+
+bool GrSharedTextures::Release(GrSharedTextureEntry* entry) {
+    SkAutoMutexAcquire ac(gMutex);
+    SkASSERT(entry->fRefCnt > 0);
+    if (--entry->fRefCnt > 0) {
+        return false;
+    }
+    entries()->remove(entry->fKey);
+    SkDELETE(entry);
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrSharedTextures_DEFINED
+#define GrSharedTextures_DEFINED
+
+#include "GrTypes.h"
+
+class GrContext;
+class GrResourceKey;
+class GrTexture;
+struct GrSharedTextureEntry;
+
+/**
+ * A process-wide registry of the cached textures that GrContexts in the same share group can
+ * use without each uploading its own copy. It lets several threads rasterize with their own
+ * GrContext while the bitmaps they all draw are uploaded once.
+ *
+ * The client puts contexts whose 3D API contexts really do share objects (for GL, contexts
+ * created in the same share group) in the same group with JoinShareGroup(). When one of them
+ * creates a cached texture it publishes it under its resource key; when another misses its own
+ * cache on that key it wraps the published texture and caches the wrapper as if it had made the
+ * texture itself. The backend object is deleted once no context in the group holds it.
+ *
+ * Only immutable textures are shared: the publisher is done writing to a texture before it is
+ * published and nobody writes to it afterwards. Publishing flushes the publisher's commands so
+ * the upload is submitted before another context can bind the texture. That is enough for
+ * drivers that order uploads across a share group once they are flushed; GrGLInterface has no
+ * fences, so there is no stronger wait to issue.
+ */
+class GrSharedTextures {
+public:
+    /**
+     * Puts the context in a share group. Groups are identified by the caller; 0 (the default)
+     * leaves the context out of any group. Must be called before the context creates or looks
+     * up any texture it means to share.
+     */
+    static void JoinShareGroup(GrContext*, uint32_t groupID);
+
+    /**
+     * Looks for a texture published under the key by another context in this context's group.
+     * On success the texture is wrapped, added to this context's cache under the key and
+     * returned reffed. Returns NULL if the context isn't in a group or nothing was published.
+     */
+    static GrTexture* FindAndRef(GrContext*, const GrResourceKey&);
+
+    /**
+     * Makes a texture that the context just created and cached under the key available to
+     * the rest of its group. Does nothing if the context isn't in a group, if another context
+     * already published a texture under the key, or if the backend can't share the texture.
+     */
+    static void Publish(GrContext*, const GrResourceKey&, GrTexture*);
+
+    /**
+     * Called by the backend when a context lets go of a shared texture. Returns true if it was
+     * the last one holding it, in which case the caller deletes the backend object.
+     */
+    static bool Release(GrSharedTextureEntry*);
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include "GrSoftwarePathRenderer.h"
 #include "GrContext.h"
 #include "GrSWMaskHelper.h"
+#include "SkChecksum.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 bool GrSoftwarePathRenderer::canDrawPath(const SkPath&,
@@ -78,6 +79,67 @@ bool get_path_and_clip_bounds(const GrDrawTarget* target,
     return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Masks larger than this are not worth keeping around in the texture cache.
+static const int kMaxCachedMaskArea = 256 * 256;
+
+// Builds the cache ID of the mask for drawing path with matrix and stroke into
+// devPathBounds. Integer translations only move devPathBounds, so they are
+// left out of the ID and the mask is shared by every integer offset of the
+// same draw. Returns false if the mask should not be cached.
+bool get_mask_cache_id(const SkPath& path,
+                       const SkStrokeRec& stroke,
+                       const SkMatrix& matrix,
+                       bool antiAlias,
+                       const SkIRect& devPathBounds,
+                       GrCacheID* cacheID) {
+    if (matrix.hasPerspective() ||
+        devPathBounds.width() * devPathBounds.height() > kMaxCachedMaskArea) {
+        return false;
+    }
+
+    // The mask only covers devPathBounds, so if the clip cut into the path the
+    // mask is not the whole path and cannot be reused elsewhere.
+    SkRect devBounds;
+    matrix.mapRect(&devBounds, path.getBounds());
+    SkIRect unclippedBounds;
+    devBounds.roundOut(&unclippedBounds);
+    if (unclippedBounds != devPathBounds) {
+        return false;
+    }
+
+    const SkScalar tx = matrix.getTranslateX();
+    const SkScalar ty = matrix.getTranslateY();
+    SkScalar data[] = {
+        matrix.getScaleX(),
+        matrix.getSkewX(),
+        matrix.getSkewY(),
+        matrix.getScaleY(),
+        tx - SkScalarFloorToScalar(tx),
+        ty - SkScalarFloorToScalar(ty),
+        stroke.getWidth(),
+    };
+    // These are all GrSWMaskHelper::draw() looks at.
+    const uint32_t flags = stroke.getStyle() |
+                           (stroke.getJoin() << 2) |
+                           (stroke.getCap() << 4) |
+                           (path.getFillType() << 6) |
+                           (antiAlias << 8);
+
+    // The generation ID goes into the key as is; everything else is hashed
+    // three ways into the remaining 96 bits.
+    GrCacheID::Key key;
+    key.fData32[0] = path.getGenerationID();
+    for (int i = 1; i < 4; ++i) {
+        key.fData32[i] = SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(data),
+                                               sizeof(data), flags + i);
+    }
+
+    static const GrCacheID::Domain gSWMaskDomain = GrCacheID::GenerateDomain();
+    cacheID->reset(gSWMaskDomain, key);
+    return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void draw_around_inv_path(GrDrawTarget* target,
                           const SkIRect& devClipBounds,
@@ -135,10 +197,18 @@ bool GrSoftwarePathRenderer::onDrawPath(const SkPath& path,
         return true;
     }
 
-    SkAutoTUnref<GrTexture> texture(
-            GrSWMaskHelper::DrawPathMaskToTexture(fContext, path, stroke,
-                                                  devPathBounds,
-                                                  antiAlias, &vm));
+    SkAutoTUnref<GrTexture> texture;
+    GrCacheID cacheID;
+    if (get_mask_cache_id(path, stroke, vm, antiAlias, devPathBounds, &cacheID)) {
+        texture.reset(GrSWMaskHelper::DrawPathMaskToCachedTexture(fContext, path, stroke,
+                                                                  devPathBounds,
+                                                                  antiAlias, &vm,
+                                                                  cacheID));
+    } else {
+        texture.reset(GrSWMaskHelper::DrawPathMaskToTexture(fContext, path, stroke,
+                                                            devPathBounds,
+                                                            antiAlias, &vm));
+    }
     if (NULL == texture) {
         return false;
     }
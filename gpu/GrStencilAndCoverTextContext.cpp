@@ -0,0 +1,258 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrStencilAndCoverTextContext.h"
+#include "GrContext.h"
+#include "GrDrawTarget.h"
+#include "GrGpu.h"
+#include "GrPath.h"
+#include "GrRenderTarget.h"
+
+#include "SkAutoKern.h"
+#include "SkGlyphCache.h"
+#include "SkStrokeRec.h"
+
+GrStencilAndCoverTextContext::GrStencilAndCoverTextContext(GrContext* context,
+                                                           const SkDeviceProperties& properties)
+                                                         : GrTextContext(context, properties)
+                                                         , fFillType(SkPath::kWinding_FillType) {
+}
+
+GrStencilAndCoverTextContext::~GrStencilAndCoverTextContext() {
+    this->flushGlyphs();
+}
+
+bool GrStencilAndCoverTextContext::canDraw(const SkPaint& paint) {
+    if (!fContext->getGpu()->caps()->pathRenderingSupport()) {
+        return false;
+    }
+
+    // The outlines are filled as is, so anything that modifies their shape or their alpha
+    // has to go down the regular path drawing.
+    if (NULL != paint.getRasterizer() || NULL != paint.getMaskFilter() ||
+        NULL != paint.getPathEffect() || paint.getStyle() != SkPaint::kFill_Style) {
+        return false;
+    }
+
+    // NV_path_rendering only takes affine per-path transforms.
+    if (fContext->getMatrix().hasPerspective()) {
+        return false;
+    }
+
+    const GrRenderTarget* rt = fContext->getRenderTarget();
+    if (NULL == rt || NULL == rt->getStencilBuffer()) {
+        return false;
+    }
+    // There's no per-path AA; only take AA text if the target has MSAA.
+    if (paint.isAntiAlias() && !rt->isMultisampled()) {
+        return false;
+    }
+
+    // color glyphs have no outlines
+    SkScalerContext::Rec    rec;
+    SkScalerContext::MakeRec(paint, &fDeviceProperties, NULL, &rec);
+    return rec.getFormat() != SkMask::kARGB32_Format;
+}
+
+inline void GrStencilAndCoverTextContext::init(const GrPaint& paint, const SkPaint& skPaint) {
+    GrTextContext::init(paint, skPaint);
+
+    SkASSERT(fPaths.isEmpty());
+    fFillType = SkPath::kWinding_FillType;
+}
+
+inline void GrStencilAndCoverTextContext::finish() {
+    this->flushGlyphs();
+
+    GrTextContext::finish();
+}
+
+void GrStencilAndCoverTextContext::appendGlyph(SkGlyphCache* cache, const SkGlyph& glyph,
+                                               SkScalar x, SkScalar y) {
+    if (0 == glyph.fWidth) {
+        return;
+    }
+    const SkPath* glyphPath = cache->findPath(glyph);
+    if (NULL == glyphPath || glyphPath->isEmpty()) {
+        return;
+    }
+
+    // All the paths of a drawPaths call share the fill type.
+    if (fPaths.count() >= kMaxBatchGlyphs ||
+        (!fPaths.isEmpty() && glyphPath->getFillType() != fFillType)) {
+        this->flushGlyphs();
+    }
+    fFillType = glyphPath->getFillType();
+
+    // The strike's paths are stable, so their gen IDs key the GrPaths in the resource cache
+    // across draws.
+    SkStrokeRec fill(SkStrokeRec::kFill_InitStyle);
+    *fPaths.append() = fContext->createPath(*glyphPath, fill);
+
+    // The outlines are at the canonical size; scale them up to the paint's.
+    SkScalar scale = fSkPaint.getTextSize() / SkPaint::kCanonicalTextSizeForPaths;
+    SkMatrix* transform = fTransforms.append();
+    transform->setScale(scale, scale);
+    transform->postTranslate(x, y);
+}
+
+void GrStencilAndCoverTextContext::flushGlyphs() {
+    if (NULL == fDrawTarget || fPaths.isEmpty()) {
+        return;
+    }
+
+    GrDrawState* drawState = fDrawTarget->drawState();
+    GrDrawState::AutoRestoreEffects are(drawState);
+    drawState->setFromPaint(fPaint, fContext->getMatrix(), fContext->getRenderTarget());
+
+    // As GrStencilAndCoverPathRenderer: cover wherever the paths were stenciled, zeroing the
+    // stencil as we go.
+    GR_STATIC_CONST_SAME_STENCIL(kStencilPass,
+        kZero_StencilOp,
+        kZero_StencilOp,
+        kNotEqual_StencilFunc,
+        0xffff,
+        0x0000,
+        0xffff);
+
+    *drawState->stencil() = kStencilPass;
+
+    fDrawTarget->drawPaths(fPaths.count(), fPaths.begin(), fTransforms.begin(), fFillType,
+                           SkStrokeRec::kFill_Style);
+
+    drawState->stencil()->setDisabled();
+
+    for (int i = 0; i < fPaths.count(); ++i) {
+        fPaths[i]->unref();
+    }
+    fPaths.rewind();
+    fTransforms.rewind();
+}
+
+// All the glyphs are measured and drawn in the paint's text space, at the canonical size for
+// paths, and then mapped through the context's matrix when they are covered.
+static void setup_glyph_paint(const SkPaint& skPaint, SkPaint* glyphPaint) {
+    *glyphPaint = skPaint;
+    glyphPaint->setLinearText(true);
+    glyphPaint->setTextSize(SkIntToScalar(SkPaint::kCanonicalTextSizeForPaths));
+}
+
+void GrStencilAndCoverTextContext::drawText(const GrPaint& paint, const SkPaint& skPaint,
+                                            const char text[], size_t byteLength,
+                                            SkScalar x, SkScalar y) {
+    SkASSERT(byteLength == 0 || text != NULL);
+
+    // nothing to draw
+    if (text == NULL || byteLength == 0) {
+        return;
+    }
+
+    this->init(paint, skPaint);
+
+    SkPaint glyphPaint;
+    setup_glyph_paint(fSkPaint, &glyphPaint);
+    SkScalar scale = fSkPaint.getTextSize() / SkPaint::kCanonicalTextSizeForPaths;
+
+    SkDrawCacheProc glyphCacheProc = glyphPaint.getDrawCacheProc();
+
+    SkAutoGlyphCache    autoCache(glyphPaint, &fDeviceProperties, NULL);
+    SkGlyphCache*       cache = autoCache.getCache();
+
+    // need to measure first
+    if (fSkPaint.getTextAlign() != SkPaint::kLeft_Align) {
+        SkVector    stop;
+
+        MeasureText(cache, glyphCacheProc, text, byteLength, &stop);
+
+        SkScalar    stopX = SkScalarMul(stop.fX, scale);
+        SkScalar    stopY = SkScalarMul(stop.fY, scale);
+
+        if (fSkPaint.getTextAlign() == SkPaint::kCenter_Align) {
+            stopX = SkScalarHalf(stopX);
+            stopY = SkScalarHalf(stopY);
+        }
+        x -= stopX;
+        y -= stopY;
+    }
+
+    const char* stop = text + byteLength;
+
+    SkAutoKern autokern;
+
+    // advances are in canonical-size units
+    SkFixed fx = 0;
+    SkFixed fy = 0;
+    while (text < stop) {
+        const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+
+        fx += autokern.adjust(glyph);
+
+        this->appendGlyph(cache, glyph,
+                          x + SkScalarMul(SkFixedToScalar(fx), scale),
+                          y + SkScalarMul(SkFixedToScalar(fy), scale));
+
+        fx += glyph.fAdvanceX;
+        fy += glyph.fAdvanceY;
+    }
+
+    this->finish();
+}
+
+void GrStencilAndCoverTextContext::drawPosText(const GrPaint& paint, const SkPaint& skPaint,
+                                               const char text[], size_t byteLength,
+                                               const SkScalar pos[], SkScalar constY,
+                                               int scalarsPerPosition) {
+    SkASSERT(byteLength == 0 || text != NULL);
+    SkASSERT(1 == scalarsPerPosition || 2 == scalarsPerPosition);
+
+    // nothing to draw
+    if (text == NULL || byteLength == 0) {
+        return;
+    }
+
+    this->init(paint, skPaint);
+
+    SkPaint glyphPaint;
+    setup_glyph_paint(fSkPaint, &glyphPaint);
+    SkScalar scale = fSkPaint.getTextSize() / SkPaint::kCanonicalTextSizeForPaths;
+
+    SkDrawCacheProc glyphCacheProc = glyphPaint.getDrawCacheProc();
+
+    SkAutoGlyphCache    autoCache(glyphPaint, &fDeviceProperties, NULL);
+    SkGlyphCache*       cache = autoCache.getCache();
+
+    // the fraction of the advance each glyph is pulled back by for its alignment
+    SkScalar alignFactor;
+    switch (fSkPaint.getTextAlign()) {
+        case SkPaint::kCenter_Align:
+            alignFactor = SK_ScalarHalf;
+            break;
+        case SkPaint::kRight_Align:
+            alignFactor = SK_Scalar1;
+            break;
+        default:
+            alignFactor = 0;
+            break;
+    }
+    alignFactor = SkScalarMul(alignFactor, scale);
+
+    const char* stop = text + byteLength;
+    while (text < stop) {
+        const SkGlyph& glyph = glyphCacheProc(cache, &text, 0, 0);
+
+        SkScalar x = pos[0];
+        SkScalar y = 1 == scalarsPerPosition ? constY : pos[1];
+        x -= SkScalarMul(SkFixedToScalar(glyph.fAdvanceX), alignFactor);
+        y -= SkScalarMul(SkFixedToScalar(glyph.fAdvanceY), alignFactor);
+
+        this->appendGlyph(cache, glyph, x, y);
+
+        pos += scalarsPerPosition;
+    }
+
+    this->finish();
+}
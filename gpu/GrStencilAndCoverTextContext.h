@@ -0,0 +1,58 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrStencilAndCoverTextContext_DEFINED
+#define GrStencilAndCoverTextContext_DEFINED
+
+#include "GrTextContext.h"
+
+#include "SkMatrix.h"
+#include "SkPath.h"
+#include "SkTDArray.h"
+
+class GrPath;
+class SkGlyph;
+
+/*
+ * This class implements GrTextContext by drawing each glyph's outline with NV_path_rendering.
+ * The outlines are taken from an unscaled strike, so a glyph's GrPath (cached in the context's
+ * resource cache, see GrContext::createPath) is shared by every size and transform it is drawn
+ * at. The glyphs of a run are batched and stenciled and covered with one GrDrawTarget::drawPaths
+ * call, each with its own transform. Like GrStencilAndCoverPathRenderer it relies on MSAA for
+ * antialiasing, so it is meant for the large glyphs that would otherwise be drawn as paths.
+ */
+class GrStencilAndCoverTextContext : public GrTextContext {
+public:
+    GrStencilAndCoverTextContext(GrContext*, const SkDeviceProperties&);
+    virtual ~GrStencilAndCoverTextContext();
+
+    virtual void drawText(const GrPaint&, const SkPaint&, const char text[], size_t byteLength,
+                          SkScalar x, SkScalar y) SK_OVERRIDE;
+    virtual void drawPosText(const GrPaint&, const SkPaint&,
+                             const char text[], size_t byteLength,
+                             const SkScalar pos[], SkScalar constY,
+                             int scalarsPerPosition) SK_OVERRIDE;
+
+    virtual bool canDraw(const SkPaint& paint) SK_OVERRIDE;
+
+private:
+    enum {
+        kMaxBatchGlyphs = 256,
+    };
+
+    void init(const GrPaint&, const SkPaint&);
+    // x and y are the glyph's origin in text space
+    void appendGlyph(SkGlyphCache*, const SkGlyph&, SkScalar x, SkScalar y);
+    void flushGlyphs();                 // automatically called by destructor
+    void finish();
+
+    SkTDArray<const GrPath*>    fPaths;         // each is reffed until the batch is flushed
+    SkTDArray<SkMatrix>         fTransforms;
+    SkPath::FillType            fFillType;
+};
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrTessellatedPath.h"
+
+#include "GrGpu.h"
+#include "GrIndexBuffer.h"
+#include "GrResourceCache.h"
+#include "GrVertexBuffer.h"
+
+GrTessellatedPath* GrTessellatedPath::Create(GrGpu* gpu,
+                                             GrPrimitiveType primType,
+                                             const void* vertices,
+                                             size_t vertexSize,
+                                             int vertexCnt,
+                                             const uint16_t* indices,
+                                             int indexCnt,
+                                             const Draw draws[],
+                                             int drawCnt,
+                                             const SkRect& bounds) {
+    SkASSERT(vertexCnt > 0 && drawCnt > 0);
+    SkASSERT((NULL == indices) == (0 == indexCnt));
+
+    size_t vertexBytes = vertexSize * vertexCnt;
+    SkAutoTUnref<GrVertexBuffer> vb(gpu->createVertexBuffer(vertexBytes, false));
+    if (NULL == vb.get() || !vb->updateData(vertices, vertexBytes)) {
+        return NULL;
+    }
+
+    SkAutoTUnref<GrIndexBuffer> ib;
+    if (indexCnt > 0) {
+        size_t indexBytes = sizeof(uint16_t) * indexCnt;
+        ib.reset(gpu->createIndexBuffer(indexBytes, false));
+        if (NULL == ib.get() || !ib->updateData(indices, indexBytes)) {
+            return NULL;
+        }
+    }
+
+    return SkNEW_ARGS(GrTessellatedPath, (primType, vb.detach(), ib.detach(),
+                                          draws, drawCnt, bounds));
+}
+
+GrTessellatedPath::GrTessellatedPath(GrPrimitiveType primType,
+                                     GrVertexBuffer* vertexBuffer,
+                                     GrIndexBuffer* indexBuffer,
+                                     const Draw draws[],
+                                     int drawCnt,
+                                     const SkRect& bounds)
+    : fPrimitiveType(primType)
+    , fVertexBuffer(vertexBuffer)
+    , fIndexBuffer(indexBuffer)
+    , fDraws(draws, drawCnt)
+    , fBounds(bounds) {
+}
+
+GrTessellatedPath::~GrTessellatedPath() {
+    fVertexBuffer->unref();
+    SkSafeUnref(fIndexBuffer);
+}
+
+size_t GrTessellatedPath::gpuMemorySize() const {
+    size_t size = fVertexBuffer->gpuMemorySize();
+    if (NULL != fIndexBuffer) {
+        size += fIndexBuffer->gpuMemorySize();
+    }
+    return size;
+}
+
+bool GrTessellatedPath::isValidOnGpu() const {
+    return fVertexBuffer->isValidOnGpu() &&
+           (NULL == fIndexBuffer || fIndexBuffer->isValidOnGpu());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+GrTessellatedPath::RecentKeys::RecentKeys() {
+    sk_bzero(fHashes, sizeof(fHashes));
+}
+
+bool GrTessellatedPath::RecentKeys::checkAndAdd(const GrResourceKey& key) {
+    // Zero marks an empty slot.
+    uint32_t hash = key.getHash() | 1;
+    uint32_t* slot = &fHashes[(hash >> 1) % kSlotCount];
+    if (*slot == hash) {
+        return true;
+    }
+    *slot = hash;
+    return false;
+}
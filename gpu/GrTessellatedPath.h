@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrTessellatedPath_DEFINED
+#define GrTessellatedPath_DEFINED
+
+#include "GrCacheable.h"
+#include "GrTypesPriv.h"
+
+#include "SkRect.h"
+#include "SkTArray.h"
+
+class GrGpu;
+class GrIndexBuffer;
+class GrResourceKey;
+class GrVertexBuffer;
+
+/**
+ * A path's vertices and indices as a path renderer tessellated them on the CPU, uploaded to static
+ * buffers and kept in the GrResourceCache so that drawing the path again skips the tessellation.
+ * It is up to the renderer to put in the key everything its vertices depend on: at least the
+ * path's generation ID, and e.g. the stroke, the tolerance or the view matrix.
+ */
+class GrTessellatedPath : public GrCacheable {
+public:
+    /** A run of vertices drawn with the indices that follow the previous run's. */
+    struct Draw {
+        int fVertexCnt;
+        int fIndexCnt;
+    };
+
+    /**
+     * Uploads the geometry, which is drawn as draws[0..drawCnt). indices may be NULL, with
+     * indexCnt zero, for non-indexed geometry. bounds are those of the vertices. Returns NULL if
+     * the buffers couldn't be created.
+     */
+    static GrTessellatedPath* Create(GrGpu* gpu,
+                                     GrPrimitiveType primType,
+                                     const void* vertices,
+                                     size_t vertexSize,
+                                     int vertexCnt,
+                                     const uint16_t* indices,
+                                     int indexCnt,
+                                     const Draw draws[],
+                                     int drawCnt,
+                                     const SkRect& bounds);
+
+    virtual ~GrTessellatedPath();
+
+    GrPrimitiveType primitiveType() const { return fPrimitiveType; }
+    const GrVertexBuffer* vertexBuffer() const { return fVertexBuffer; }
+    /** NULL if the geometry isn't indexed. */
+    const GrIndexBuffer* indexBuffer() const { return fIndexBuffer; }
+    const SkTArray<Draw, true>& draws() const { return fDraws; }
+    const SkRect& bounds() const { return fBounds; }
+
+    virtual size_t gpuMemorySize() const SK_OVERRIDE;
+    virtual bool isValidOnGpu() const SK_OVERRIDE;
+
+    /**
+     * Remembers the hashes of the last few keys drawn, so that a renderer only creates buffers
+     * for a path the second time it draws it. Paths that change every frame are never cached.
+     */
+    class RecentKeys {
+    public:
+        RecentKeys();
+
+        /** Returns true if key was seen recently. Otherwise remembers it and returns false. */
+        bool checkAndAdd(const GrResourceKey& key);
+
+    private:
+        enum {
+            kSlotCount = 64
+        };
+
+        uint32_t fHashes[kSlotCount];
+    };
+
+private:
+    GrTessellatedPath(GrPrimitiveType, GrVertexBuffer*, GrIndexBuffer*,
+                      const Draw draws[], int drawCnt, const SkRect& bounds);
+
+    GrPrimitiveType         fPrimitiveType;
+    GrVertexBuffer*         fVertexBuffer;
+    GrIndexBuffer*          fIndexBuffer;
+    SkTArray<Draw, true>    fDraws;
+    SkRect                  fBounds;
+
+    typedef GrCacheable INHERITED;
+};
+
+#endif
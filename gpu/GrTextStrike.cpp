@@ -25,6 +25,16 @@
 #define GR_NUM_PLOTS_X   (GR_ATLAS_TEXTURE_WIDTH / GR_PLOT_WIDTH)
 #define GR_NUM_PLOTS_Y   (GR_ATLAS_TEXTURE_HEIGHT / GR_PLOT_HEIGHT)
 
+// Scripts with large character sets (e.g. CJK) can touch more glyphs in a frame than fit on
+// one texture, and would otherwise thrash the atlas. A8 pages are cheap (2MB), so allow a few;
+// 565 and 8888 pages are much larger and rarely needed.
+#ifndef GR_A8_ATLAS_MAX_PAGES
+    #define GR_A8_ATLAS_MAX_PAGES    4
+#endif
+#ifndef GR_COLOR_ATLAS_MAX_PAGES
+    #define GR_COLOR_ATLAS_MAX_PAGES 1
+#endif
+
 #define FONT_CACHE_STATS 0
 #if FONT_CACHE_STATS
 static int g_PurgeCount = 0;
@@ -83,10 +93,13 @@ GrTextStrike* GrFontCache::generateStrike(GrFontScaler* scaler,
     if (NULL == fAtlasMgr[atlasIndex]) {
         SkISize textureSize = SkISize::Make(GR_ATLAS_TEXTURE_WIDTH,
                                             GR_ATLAS_TEXTURE_HEIGHT);
+        int maxPages = kA8_AtlasType == atlasIndex ? GR_A8_ATLAS_MAX_PAGES
+                                                   : GR_COLOR_ATLAS_MAX_PAGES;
         fAtlasMgr[atlasIndex] = SkNEW_ARGS(GrAtlasMgr, (fGpu, config,
                                                         textureSize,
                                                         GR_NUM_PLOTS_X,
-                                                        GR_NUM_PLOTS_Y));
+                                                        GR_NUM_PLOTS_Y,
+                                                        maxPages));
     }
     GrTextStrike* strike = SkNEW_ARGS(GrTextStrike,
                                       (this, scaler->getKey(), format, fAtlasMgr[atlasIndex]));
@@ -157,6 +170,32 @@ bool GrFontCache::freeUnusedPlot(GrTextStrike* preserveStrike) {
     return true;
 }
 
+int GrFontCache::prewarmGlyphs(GrFontScaler* scaler, const GrGlyph::PackedID glyphs[],
+                               int count, int maxNewPlots) {
+    GrTextStrike* strike = this->getStrike(scaler, false);
+    const int startPlotCount = strike->fAtlas.plotCount();
+
+    int resident = 0;
+    for (int i = 0; i < count; ++i) {
+        GrGlyph* glyph = strike->getGlyph(glyphs[i], scaler);
+        if (NULL == glyph || glyph->fBounds.isEmpty()) {
+            continue;
+        }
+        if (NULL == glyph->fPlot) {
+            if (strike->fAtlas.plotCount() - startPlotCount >= maxNewPlots) {
+                break;
+            }
+            // Unlike a draw, we never free a plot to make room, so a full atlas
+            // leaves the rest of the glyphs to be added lazily when drawn.
+            if (!strike->addGlyphToAtlas(glyph, scaler)) {
+                break;
+            }
+        }
+        ++resident;
+    }
+    return resident;
+}
+
 #ifdef SK_DEBUG
 void GrFontCache::validate() const {
     int count = fCache.count();
@@ -192,13 +231,13 @@ void GrFontCache::dump() const {
     static int gDumpCount = 0;
     for (int i = 0; i < kAtlasCount; ++i) {
         if (NULL != fAtlasMgr[i]) {
-            GrTexture* texture = fAtlasMgr[i]->getTexture();
-            if (NULL != texture) {
+            for (int page = 0; page < fAtlasMgr[i]->pageCount(); ++page) {
+                GrTexture* texture = fAtlasMgr[i]->getTexture(page);
                 SkString filename;
 #ifdef SK_BUILD_FOR_ANDROID
-                filename.printf("/sdcard/fontcache_%d%d.png", gDumpCount, i);
+                filename.printf("/sdcard/fontcache_%d%d_%d.png", gDumpCount, i, page);
 #else
-                filename.printf("fontcache_%d%d.png", gDumpCount, i);
+                filename.printf("fontcache_%d%d_%d.png", gDumpCount, i, page);
 #endif
                 texture->savePixels(filename.c_str());
             }
@@ -83,6 +83,16 @@ public:
     // make an unused plot available
     bool freeUnusedPlot(GrTextStrike* preserveStrike);
 
+    /**
+     *  Rasterizes the given glyphs of scaler's strike and uploads them to the
+     *  atlas ahead of their first draw, e.g. during idle time. Only room that
+     *  is free now is used: no plot is ever purged, and no glyphs are added
+     *  once maxNewPlots plots have been added to the strike's atlas. Returns
+     *  the number of glyphs that are in the atlas afterwards.
+     */
+    int prewarmGlyphs(GrFontScaler*, const GrGlyph::PackedID glyphs[], int count,
+                      int maxNewPlots);
+
     // testing
     int countStrikes() const { return fCache.getArray().count(); }
     const GrTextStrike* strikeAt(int index) const {
@@ -8,12 +8,14 @@
 #include "SkGpuDevice.h"
 
 #include "effects/GrBicubicEffect.h"
+#include "effects/GrDashingEffect.h"
 #include "effects/GrTextureDomain.h"
 #include "effects/GrSimpleTextureEffect.h"
 
 #include "GrContext.h"
 #include "GrBitmapTextContext.h"
 #include "GrDistanceFieldTextContext.h"
+#include "GrStencilAndCoverTextContext.h"
 #include "GrLayerCache.h"
 #include "GrPictureUtils.h"
 
@@ -28,6 +30,7 @@
 #include "SkMaskFilter.h"
 #include "SkPathEffect.h"
 #include "SkPicture.h"
+#include "SkPicturePlayback.h"
 #include "SkRRect.h"
 #include "SkStroke.h"
 #include "SkSurface.h"
@@ -534,6 +537,18 @@ void SkGpuDevice::drawPoints(const SkDraw& draw, SkCanvas::PointMode mode,
         return;
     }
 
+    // a single dashed line may be drawn with analytic dashes rather than as a path
+    if (SkCanvas::kLines_PointMode == mode && 2 == count && width > 0 &&
+        NULL != paint.getPathEffect() && NULL == paint.getMaskFilter()) {
+        GrPaint grPaint;
+        if (!skPaint2GrPaintShader(this, paint, true, &grPaint)) {
+            return;
+        }
+        if (GrDashingEffect::DrawDashLine(pts, paint, grPaint, fContext)) {
+            return;
+        }
+    }
+
     // we only handle hairlines and paints without path effects or mask filters,
     // else we let the SkDraw call our drawPath()
     if (width > 0 || paint.getPathEffect() || paint.getMaskFilter()) {
@@ -1796,8 +1811,22 @@ void SkGpuDevice::drawText(const SkDraw& draw, const void* text,
 
         fFallbackTextContext->drawText(grPaint, paint, (const char *)text, byteLength, x, y);
     } else {
-        // this guy will just call our drawPath()
-        draw.drawText_asPaths((const char*)text, byteLength, x, y, paint);
+        // Glyphs too big for the atlases can still skip the per-glyph path drawing if the
+        // outlines can be batched through NV_path_rendering. The context is cheap to make.
+        GrStencilAndCoverTextContext pathTextContext(fContext, fLeakyProperties);
+        if (pathTextContext.canDraw(paint)) {
+            GrPaint grPaint;
+            if (!skPaint2GrPaintShader(this, paint, true, &grPaint)) {
+                return;
+            }
+
+            SkDEBUGCODE(this->validate();)
+
+            pathTextContext.drawText(grPaint, paint, (const char *)text, byteLength, x, y);
+        } else {
+            // this guy will just call our drawPath()
+            draw.drawText_asPaths((const char*)text, byteLength, x, y, paint);
+        }
     }
 }
 
@@ -1828,8 +1857,21 @@ void SkGpuDevice::drawPosText(const SkDraw& draw, const void* text,
         fFallbackTextContext->drawPosText(grPaint, paint, (const char *)text, byteLength, pos,
                                           constY, scalarsPerPos);
     } else {
-        draw.drawPosText_asPaths((const char*)text, byteLength, pos, constY,
-                                 scalarsPerPos, paint);
+        GrStencilAndCoverTextContext pathTextContext(fContext, fLeakyProperties);
+        if (pathTextContext.canDraw(paint)) {
+            GrPaint grPaint;
+            if (!skPaint2GrPaintShader(this, paint, true, &grPaint)) {
+                return;
+            }
+
+            SkDEBUGCODE(this->validate();)
+
+            pathTextContext.drawPosText(grPaint, paint, (const char *)text, byteLength, pos,
+                                        constY, scalarsPerPos);
+        } else {
+            draw.drawPosText_asPaths((const char*)text, byteLength, pos, constY,
+                                     scalarsPerPos, paint);
+        }
     }
 }
 
@@ -1921,7 +1963,7 @@ void SkGpuDevice::EXPERIMENTAL_optimize(SkPicture* picture) {
 }
 
 void SkGpuDevice::EXPERIMENTAL_purge(SkPicture* picture) {
-
+    fContext->getLayerCache()->purge(picture);
 }
 
 bool SkGpuDevice::EXPERIMENTAL_drawPicture(SkCanvas* canvas, SkPicture* picture) {
@@ -1965,5 +2007,91 @@ bool SkGpuDevice::EXPERIMENTAL_drawPicture(SkCanvas* canvas, SkPicture* picture)
         }
     }
 
-    return false;
+    // The layers are rendered in the picture's own device space, so they can
+    // be reused for any integer translation of the picture but nothing else.
+    const SkMatrix& initialMatrix = canvas->getTotalMatrix();
+    if (initialMatrix.getType() > SkMatrix::kTranslate_Mask ||
+        !SkScalarIsInt(initialMatrix.getTranslateX()) ||
+        !SkScalarIsInt(initialMatrix.getTranslateY())) {
+        return false;
+    }
+
+    GrLayerCache* layerCache = fContext->getLayerCache();
+    SkPicturePlayback::PlaybackReplacements replacements;
+
+    for (int i = 0; i < gpuData->numSaveLayers(); ++i) {
+        const GPUAccelData::SaveLayerInfo& info = gpuData->saveLayerInfo(i);
+
+        // Nested layers are drawn as part of the layer they are nested in.
+        // That leaves the hoisted layers disjoint, so (being recorded in
+        // restore order) they are also in saveLayer order, as replacements
+        // must be.
+        if (!pullForward[i] || !info.fValid || info.fIsNested) {
+            continue;
+        }
+
+        GrCachedLayer* layer = layerCache->findLayerOrCreate(picture, i);
+
+        GrTextureDesc desc;
+        desc.fFlags = kRenderTarget_GrTextureFlagBit;
+        desc.fWidth = info.fSize.fWidth;
+        desc.fHeight = info.fSize.fHeight;
+        desc.fConfig = kSkia8888_GrPixelConfig;
+        // TODO: need to deal with sample count
+
+        bool needsRendering = !layerCache->lock(layer, desc);
+        if (NULL == layer->getTexture()) {
+            continue;   // this layer will just be drawn normally
+        }
+
+        SkIRect srcRect;
+        if (layer->isAtlased()) {
+            const GrIRect16& bounds = layer->location().bounds();
+            srcRect.setLTRB(bounds.fLeft, bounds.fTop, bounds.fRight, bounds.fBottom);
+        } else {
+            srcRect.setWH(info.fSize.fWidth, info.fSize.fHeight);
+        }
+
+        if (needsRendering) {
+            SkAutoTUnref<SkGpuDevice> device(SkGpuDevice::Create(layer->getTexture(), 0));
+            if (NULL == device.get()) {
+                continue;
+            }
+            SkCanvas layerCanvas(device);
+
+            // An atlased layer must stay inside (and only clear) its own rect.
+            layerCanvas.clipRect(SkRect::Make(srcRect));
+            SkPaint clearPaint;
+            clearPaint.setXfermodeMode(SkXfermode::kClear_Mode);
+            layerCanvas.drawRect(SkRect::Make(srcRect), clearPaint);
+
+            // fCTM already maps the layer's origin to (0, 0).
+            layerCanvas.translate(SkIntToScalar(srcRect.fLeft), SkIntToScalar(srcRect.fTop));
+            layerCanvas.concat(info.fCTM);
+
+            SkMatrix layerInitialMatrix;
+            layerInitialMatrix.setTranslate(SkIntToScalar(srcRect.fLeft - info.fOrigin.fX),
+                                            SkIntToScalar(srcRect.fTop - info.fOrigin.fY));
+            SkAutoPlaybackOverride range(picture, info.fSaveLayerOpID, info.fRestoreOpID,
+                                         layerInitialMatrix);
+            picture->draw(&layerCanvas);
+            layerCanvas.flush();
+        }
+
+        SkPicturePlayback::PlaybackReplacements::ReplacementInfo* ri = replacements.push();
+        ri->fStart = info.fSaveLayerOpID;
+        ri->fStop = info.fRestoreOpID;
+        ri->fPos = info.fOrigin;
+        ri->fBM = SkNEW_ARGS(SkBitmap, (wrap_texture(layer->getTexture())));
+        ri->fSrcRect = srcRect;
+        ri->fPaint = info.fPaint;
+    }
+
+    if (0 == replacements.count()) {
+        return false;
+    }
+
+    SkAutoPlaybackOverride override(picture, &replacements);
+    picture->draw(canvas);
+    return true;
 }
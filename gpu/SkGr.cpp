@@ -10,6 +10,20 @@
 #include "SkMessageBus.h"
 #include "SkPixelRef.h"
 #include "GrResourceCache.h"
+#include "GrSharedTextures.h"
+
+/*  By default bitmaps are uploaded in their own config. Defining this to 1 uploads large, opaque,
+    immutable 32 bit bitmaps (decoded photos, mostly) as 565 textures instead, halving the part of
+    the texture cache budget they take at the cost of some precision.
+ */
+#ifndef GR_PACK_OPAQUE_BITMAPS_TO_565
+    #define GR_PACK_OPAQUE_BITMAPS_TO_565   0
+#endif
+
+// Smaller bitmaps don't use enough of the budget to be worth the loss of precision.
+#ifndef GR_PACK_OPAQUE_BITMAPS_MIN_AREA
+    #define GR_PACK_OPAQUE_BITMAPS_MIN_AREA (256 * 256)
+#endif
 
 /*  Fill out buffer with the compressed format Ganesh expects from a colortable
  based bitmap. [palette (colortable) + indices].
@@ -93,11 +107,25 @@ static void generate_bitmap_cache_id(const SkBitmap& bitmap, GrCacheID* id) {
     id->reset(gBitmapTextureDomain, key);
 }
 
+static bool should_pack_to_565(const SkBitmap& bitmap) {
+#if GR_PACK_OPAQUE_BITMAPS_TO_565
+    // Only bitmaps whose pixels can't change, so the 565 copy never has to be redone.
+    return kN32_SkColorType == bitmap.colorType() &&
+           bitmap.isOpaque() &&
+           bitmap.isImmutable() &&
+           bitmap.width() * bitmap.height() >= GR_PACK_OPAQUE_BITMAPS_MIN_AREA;
+#else
+    return false;
+#endif
+}
+
 static void generate_bitmap_texture_desc(const SkBitmap& bitmap, GrTextureDesc* desc) {
     desc->fFlags = kNone_GrTextureFlags;
     desc->fWidth = bitmap.width();
     desc->fHeight = bitmap.height();
-    desc->fConfig = SkImageInfo2GrPixelConfig(bitmap.info());
+    // The config is part of the cache key, so lookups and uploads agree on packing.
+    desc->fConfig = should_pack_to_565(bitmap) ? kRGB_565_GrPixelConfig
+                                               : SkImageInfo2GrPixelConfig(bitmap.info());
     desc->fSampleCnt = 0;
 }
 
@@ -171,6 +199,12 @@ static GrTexture* sk_gr_create_bitmap_texture(GrContext* ctx,
             bitmap = &tmpBitmap;
             desc.fConfig = SkImageInfo2GrPixelConfig(bitmap->info());
         }
+    } else if (kRGB_565_GrPixelConfig == desc.fConfig &&
+               kRGB_565_SkColorType != bitmap->colorType()) {
+        if (!origBitmap.copyTo(&tmpBitmap, kRGB_565_SkColorType)) {
+            return NULL;
+        }
+        bitmap = &tmpBitmap;
     }
 
     SkAutoLockPixels alp(*bitmap);
@@ -233,8 +267,18 @@ GrTexture* GrLockAndRefCachedBitmapTexture(GrContext* ctx,
         generate_bitmap_texture_desc(bitmap, &desc);
 
         result = ctx->findAndRefTexture(desc, cacheID, params);
-    }
-    if (NULL == result) {
+        if (NULL == result) {
+            // Another context in this one's share group may have uploaded it already.
+            GrResourceKey key = GrTexture::ComputeKey(ctx->getGpu(), params, desc, cacheID);
+            result = GrSharedTextures::FindAndRef(ctx, key);
+            if (NULL == result) {
+                result = sk_gr_create_bitmap_texture(ctx, cache, params, bitmap);
+                if (NULL != result) {
+                    GrSharedTextures::Publish(ctx, key, result);
+                }
+            }
+        }
+    } else {
         result = sk_gr_create_bitmap_texture(ctx, cache, params, bitmap);
     }
     if (NULL == result) {
@@ -32,13 +32,16 @@ public:
 
 private:
     int width() const { return Gr1DKernelEffect::WidthFromRadius(fRadius); }
+    int tapCount() const { return fLinear ? fRadius + 1 : this->width(); }
     bool useBounds() const { return fUseBounds; }
     Gr1DKernelEffect::Direction direction() const { return fDirection; }
 
     int                 fRadius;
     bool                fUseBounds;
+    bool                fLinear;
     Gr1DKernelEffect::Direction    fDirection;
     UniformHandle       fKernelUni;
+    UniformHandle       fOffsetsUni;
     UniformHandle       fImageIncrementUni;
     UniformHandle       fBoundsUni;
 
@@ -51,6 +54,7 @@ GrGLConvolutionEffect::GrGLConvolutionEffect(const GrBackendEffectFactory& facto
     const GrConvolutionEffect& c = drawEffect.castEffect<GrConvolutionEffect>();
     fRadius = c.radius();
     fUseBounds = c.useBounds();
+    fLinear = c.isLinear();
     fDirection = c.direction();
 }
 
@@ -69,7 +73,7 @@ void GrGLConvolutionEffect::emitCode(GrGLShaderBuilder* builder,
                                          kVec2f_GrSLType, "Bounds");
     }
     fKernelUni = builder->addUniformArray(GrGLShaderBuilder::kFragment_Visibility,
-                                          kFloat_GrSLType, "Kernel", this->width());
+                                          kFloat_GrSLType, "Kernel", this->tapCount());
 
     builder->fsCodeAppendf("\t\t%s = vec4(0, 0, 0, 0);\n", outputColor);
 
@@ -77,6 +81,32 @@ void GrGLConvolutionEffect::emitCode(GrGLShaderBuilder* builder,
     const GrGLShaderVar& kernel = builder->getUniformVariable(fKernelUni);
     const char* imgInc = builder->getUniformCStr(fImageIncrementUni);
 
+    if (fLinear) {
+        SkASSERT(!this->useBounds());
+        fOffsetsUni = builder->addUniformArray(GrGLShaderBuilder::kFragment_Visibility,
+                                               kFloat_GrSLType, "Offsets", this->tapCount());
+        const GrGLShaderVar& offsets = builder->getUniformVariable(fOffsetsUni);
+        // Manually unrolled as below; each tap is a bilinear read of two texels.
+        for (int i = 0; i < this->tapCount(); i++) {
+            SkString index;
+            SkString kernelIndex;
+            SkString offsetIndex;
+            index.appendS32(i);
+            kernel.appendArrayAccess(index.c_str(), &kernelIndex);
+            offsets.appendArrayAccess(index.c_str(), &offsetIndex);
+            SkString coord;
+            coord.printf("(%s + %s * %s)", coords2D.c_str(), offsetIndex.c_str(), imgInc);
+            builder->fsCodeAppendf("\t\t%s += ", outputColor);
+            builder->fsAppendTextureLookup(samplers[0], coord.c_str());
+            builder->fsCodeAppendf(" * %s;\n", kernelIndex.c_str());
+        }
+
+        SkString modulate;
+        GrGLSLMulVarBy4f(&modulate, 2, outputColor, inputColor);
+        builder->fsCodeAppend(modulate.c_str());
+        return;
+    }
+
     builder->fsCodeAppendf("\t\tvec2 coord = %s - %d.0 * %s;\n", coords2D.c_str(), fRadius, imgInc);
 
     // Manually unroll loop because some drivers don't; yields 20-30% speedup.
@@ -130,13 +160,18 @@ void GrGLConvolutionEffect::setData(const GrGLUniformManager& uman,
             uman.set2f(fBoundsUni, bounds[0], bounds[1]);
         }
     }
-    uman.set1fv(fKernelUni, this->width(), conv.kernel());
+    uman.set1fv(fKernelUni, this->tapCount(), conv.kernel());
+    if (conv.isLinear()) {
+        uman.set1fv(fOffsetsUni, this->tapCount(), conv.offsets());
+    }
 }
 
 GrGLEffect::EffectKey GrGLConvolutionEffect::GenKey(const GrDrawEffect& drawEffect,
                                                     const GrGLCaps&) {
     const GrConvolutionEffect& conv = drawEffect.castEffect<GrConvolutionEffect>();
     EffectKey key = conv.radius();
+    key <<= 1;
+    key |= conv.isLinear() ? 0x1 : 0x0;
     key <<= 2;
     if (conv.useBounds()) {
         key |= 0x2;
@@ -153,7 +188,7 @@ GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
                                          const float* kernel,
                                          bool useBounds,
                                          float bounds[2])
-    : Gr1DKernelEffect(texture, direction, radius), fUseBounds(useBounds) {
+    : Gr1DKernelEffect(texture, direction, radius), fUseBounds(useBounds), fLinear(false) {
     SkASSERT(radius <= kMaxKernelRadius);
     SkASSERT(NULL != kernel);
     int width = this->width();
@@ -169,7 +204,7 @@ GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
                                          float gaussianSigma,
                                          bool useBounds,
                                          float bounds[2])
-    : Gr1DKernelEffect(texture, direction, radius), fUseBounds(useBounds) {
+    : Gr1DKernelEffect(texture, direction, radius), fUseBounds(useBounds), fLinear(false) {
     SkASSERT(radius <= kMaxKernelRadius);
     int width = this->width();
 
@@ -190,6 +225,44 @@ GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
     memcpy(fBounds, bounds, sizeof(fBounds));
 }
 
+GrConvolutionEffect::GrConvolutionEffect(GrTexture* texture,
+                                         Direction direction,
+                                         int radius,
+                                         float gaussianSigma)
+    : Gr1DKernelEffect(texture, direction, radius, GrTextureParams::kBilerp_FilterMode)
+    , fUseBounds(false)
+    , fLinear(true) {
+    SkASSERT(radius <= kMaxKernelRadius);
+    int width = this->width();
+
+    float weights[kMaxKernelWidth];
+    float sum = 0.0f;
+    float denom = 1.0f / (2.0f * gaussianSigma * gaussianSigma);
+    for (int i = 0; i < width; ++i) {
+        float x = static_cast<float>(i - this->radius());
+        weights[i] = sk_float_exp(- x * x * denom);
+        sum += weights[i];
+    }
+    float scale = 1.0f / sum;
+
+    // Pair up neighboring weights from the left; the last (odd) one gets a tap of its own.
+    int tap = 0;
+    for (int i = 0; i < width; i += 2, ++tap) {
+        float x = static_cast<float>(i - this->radius());
+        if (i + 1 < width) {
+            float pair = weights[i] + weights[i + 1];
+            fKernel[tap] = pair * scale;
+            fOffsets[tap] = x + weights[i + 1] / pair;
+        } else {
+            fKernel[tap] = weights[i] * scale;
+            fOffsets[tap] = x;
+        }
+    }
+    SkASSERT(tap == this->tapCount());
+    fBounds[0] = 0.0f;
+    fBounds[1] = 1.0f;
+}
+
 GrConvolutionEffect::~GrConvolutionEffect() {
 }
 
@@ -203,8 +276,11 @@ bool GrConvolutionEffect::onIsEqual(const GrEffect& sBase) const {
             this->radius() == s.radius() &&
             this->direction() == s.direction() &&
             this->useBounds() == s.useBounds() &&
+            this->isLinear() == s.isLinear() &&
             0 == memcmp(fBounds, s.fBounds, sizeof(fBounds)) &&
-            0 == memcmp(fKernel, s.fKernel, this->width() * sizeof(float)));
+            0 == memcmp(fKernel, s.fKernel, this->tapCount() * sizeof(float)) &&
+            (!this->isLinear() ||
+             0 == memcmp(fOffsets, s.fOffsets, this->tapCount() * sizeof(float))));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -53,10 +53,35 @@ public:
         return CreateEffectRef(effect);
     }
 
+    /**
+     * Convolve with a Gaussian kernel using bilinear filtering to read two texels per tap. A
+     * sample between two texel centers is their weighted sum, so each pair of kernel weights
+     * becomes one tap, at the pair's weighted center, and the kernel's 2 * halfWidth + 1 taps
+     * shrink to halfWidth + 1. The coords must land on texel centers across the kernel's direction
+     * (i.e. the draw maps texels 1:1 at integer offsets), and there are no bounds, since a sample
+     * straddling them would blend in the texel outside.
+     */
+    static GrEffectRef* CreateLinearGaussian(GrTexture* tex,
+                                             Direction dir,
+                                             int halfWidth,
+                                             float gaussianSigma) {
+        AutoEffectUnref effect(SkNEW_ARGS(GrConvolutionEffect, (tex,
+                                                                dir,
+                                                                halfWidth,
+                                                                gaussianSigma)));
+        return CreateEffectRef(effect);
+    }
+
     virtual ~GrConvolutionEffect();
 
     const float* kernel() const { return fKernel; }
 
+    bool isLinear() const { return fLinear; }
+    // The offset of each tap from the center texel, only used by linear kernels.
+    const float* offsets() const { return fOffsets; }
+    // The number of taps (and of kernel weights), which is width() unless the kernel is linear.
+    int tapCount() const { return fLinear ? this->radius() + 1 : this->width(); }
+
     const float* bounds() const { return fBounds; }
     bool useBounds() const { return fUseBounds; }
 
@@ -88,6 +113,8 @@ protected:
     float fKernel[kMaxKernelWidth];
     bool fUseBounds;
     float fBounds[2];
+    bool fLinear;
+    float fOffsets[kMaxKernelWidth];
 
 private:
     GrConvolutionEffect(GrTexture*, Direction,
@@ -103,6 +130,11 @@ private:
                         bool useBounds,
                         float bounds[2]);
 
+    /// Convolve with a Gaussian kernel, reading two texels per tap
+    GrConvolutionEffect(GrTexture*, Direction,
+                        int halfWidth,
+                        float gaussianSigma);
+
     virtual bool onIsEqual(const GrEffect&) const SK_OVERRIDE;
 
     GR_DECLARE_EFFECT_TEST;
@@ -0,0 +1,339 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrDashingEffect.h"
+
+#include "gl/GrGLEffect.h"
+#include "gl/GrGLSL.h"
+#include "gl/GrGLVertexEffect.h"
+#include "GrContext.h"
+#include "GrDrawState.h"
+#include "GrDrawTarget.h"
+#include "GrEffect.h"
+#include "GrRenderTarget.h"
+#include "GrTBackendEffectFactory.h"
+#include "effects/GrVertexEffect.h"
+
+#include "SkMatrix.h"
+#include "SkPaint.h"
+#include "SkPathEffect.h"
+
+namespace {
+
+// The shader finds the dash under a pixel from its distance along the line, so past this the
+// float varyings can no longer place the dash edges to a fraction of a pixel.
+static const SkScalar kMaxLineLength = 1 << 16;
+
+struct DashLineVertex {
+    SkPoint fPos;
+    SkPoint fDashPos;   // distance along the line from pts[0], distance across it
+};
+
+}
+
+extern const GrVertexAttrib gDashLineVertexAttribs[] = {
+    {kVec2f_GrVertexAttribType, 0,               kPosition_GrVertexAttribBinding},
+    {kVec2f_GrVertexAttribType, sizeof(SkPoint), kEffect_GrVertexAttribBinding}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Coverage for a dashed line, given the position in the line's own space (x along the line from
+ * its start, y across it) in device pixels. The dash that starts each period covers
+ * [dashStart, dashEnd) of it, which reaches outside [0, period) when square caps outset the
+ * dashes. Only x in [lineStart, lineEnd] is drawn, which trims the dashes to the line.
+ */
+class DashingLineEffect : public GrVertexEffect {
+public:
+    static GrEffectRef* Create(GrEffectEdgeType edgeType, SkScalar dashStart, SkScalar dashEnd,
+                               SkScalar period, SkScalar phase, SkScalar lineStart,
+                               SkScalar lineEnd, SkScalar halfWidth) {
+        return CreateEffectRef(AutoEffectUnref(SkNEW_ARGS(DashingLineEffect,
+                (edgeType, dashStart, dashEnd, period, phase, lineStart, lineEnd, halfWidth))));
+    }
+
+    virtual ~DashingLineEffect() {}
+
+    static const char* Name() { return "DashingLine"; }
+
+    GrEffectEdgeType getEdgeType() const { return fEdgeType; }
+
+    virtual void getConstantColorComponents(GrColor* color,
+                                            uint32_t* validFlags) const SK_OVERRIDE {
+        *validFlags = 0;
+    }
+
+    virtual const GrBackendEffectFactory& getFactory() const SK_OVERRIDE {
+        return GrTBackendEffectFactory<DashingLineEffect>::getInstance();
+    }
+
+    class GLEffect : public GrGLVertexEffect {
+    public:
+        GLEffect(const GrBackendEffectFactory& factory, const GrDrawEffect&)
+            : INHERITED (factory) {
+            fPrevPeriod = -1;
+        }
+
+        virtual void emitCode(GrGLFullShaderBuilder* builder,
+                              const GrDrawEffect& drawEffect,
+                              EffectKey key,
+                              const char* outputColor,
+                              const char* inputColor,
+                              const TransformedCoordsArray&,
+                              const TextureSamplerArray& samplers) SK_OVERRIDE {
+            const DashingLineEffect& de = drawEffect.castEffect<DashingLineEffect>();
+            const char *dashName, *lineName;
+            // (dashStart, dashEnd, period, phase)
+            fDashUniform = builder->addUniform(GrGLShaderBuilder::kFragment_Visibility,
+                                               kVec4f_GrSLType, "dash", &dashName);
+            // (lineStart, lineEnd, halfWidth)
+            fLineUniform = builder->addUniform(GrGLShaderBuilder::kFragment_Visibility,
+                                               kVec3f_GrSLType, "line", &lineName);
+
+            const char *vsName, *fsName;
+            builder->addVarying(kVec2f_GrSLType, "DashCoord", &vsName, &fsName);
+            const SkString* attrName =
+                builder->getEffectAttributeName(drawEffect.getVertexAttribIndices()[0]);
+            builder->vsCodeAppendf("\t%s = %s;\n", vsName, attrName->c_str());
+
+            builder->fsCodeAppendf("\t\tfloat xMod = mod(%s.x + %s.w, %s.z);\n",
+                                   fsName, dashName, dashName);
+            if (GrEffectEdgeTypeIsAA(de.getEdgeType())) {
+                // The length of each interval under the pixel's one pixel wide footprint. The
+                // dashes either side of this period's may reach into it.
+                builder->fsCodeAppendf("\t\tvec2 xSpan = vec2(xMod - 0.5, xMod + 0.5);\n");
+                builder->fsCodeAppendf("\t\tfloat alpha = "
+                    "clamp(min(xSpan.y, %s.y) - max(xSpan.x, %s.x), 0.0, 1.0) + "
+                    "clamp(min(xSpan.y, %s.y - %s.z) - max(xSpan.x, %s.x - %s.z), 0.0, 1.0) + "
+                    "clamp(min(xSpan.y, %s.y + %s.z) - max(xSpan.x, %s.x + %s.z), 0.0, 1.0);\n",
+                    dashName, dashName,
+                    dashName, dashName, dashName, dashName,
+                    dashName, dashName, dashName, dashName);
+                builder->fsCodeAppendf("\t\talpha = min(alpha, 1.0);\n");
+                builder->fsCodeAppendf("\t\talpha *= clamp(min(%s.x + 0.5, %s.y) - "
+                                       "max(%s.x - 0.5, %s.x), 0.0, 1.0);\n",
+                                       fsName, lineName, fsName, lineName);
+                builder->fsCodeAppendf("\t\talpha *= clamp(min(%s.y + 0.5, %s.z) - "
+                                       "max(%s.y - 0.5, -%s.z), 0.0, 1.0);\n",
+                                       fsName, lineName, fsName, lineName);
+            } else {
+                builder->fsCodeAppendf("\t\tfloat alpha = max(step(%s.x, xMod) * step(xMod, %s.y), "
+                                       "max(step(xMod, %s.y - %s.z), step(%s.x + %s.z, xMod)));\n",
+                                       dashName, dashName, dashName, dashName, dashName, dashName);
+                builder->fsCodeAppendf("\t\talpha *= step(%s.x, %s.x) * step(%s.x, %s.y);\n",
+                                       lineName, fsName, fsName, lineName);
+                builder->fsCodeAppendf("\t\talpha *= step(abs(%s.y), %s.z);\n",
+                                       fsName, lineName);
+            }
+            builder->fsCodeAppendf("\t\t%s = %s;\n", outputColor,
+                                   (GrGLSLExpr4(inputColor) * GrGLSLExpr1("alpha")).c_str());
+        }
+
+        static inline EffectKey GenKey(const GrDrawEffect& drawEffect, const GrGLCaps&) {
+            const DashingLineEffect& de = drawEffect.castEffect<DashingLineEffect>();
+            return de.getEdgeType();
+        }
+
+        virtual void setData(const GrGLUniformManager& uman,
+                             const GrDrawEffect& drawEffect) SK_OVERRIDE {
+            const DashingLineEffect& de = drawEffect.castEffect<DashingLineEffect>();
+            if (de.fDashStart != fPrevDashStart || de.fDashEnd != fPrevDashEnd ||
+                de.fPeriod != fPrevPeriod || de.fPhase != fPrevPhase) {
+                uman.set4f(fDashUniform, de.fDashStart, de.fDashEnd, de.fPeriod, de.fPhase);
+                fPrevDashStart = de.fDashStart;
+                fPrevDashEnd = de.fDashEnd;
+                fPrevPeriod = de.fPeriod;
+                fPrevPhase = de.fPhase;
+            }
+            uman.set3f(fLineUniform, de.fLineStart, de.fLineEnd, de.fHalfWidth);
+        }
+
+    private:
+        GrGLUniformManager::UniformHandle   fDashUniform;
+        GrGLUniformManager::UniformHandle   fLineUniform;
+        SkScalar                            fPrevDashStart;
+        SkScalar                            fPrevDashEnd;
+        SkScalar                            fPrevPeriod;
+        SkScalar                            fPrevPhase;
+
+        typedef GrGLVertexEffect INHERITED;
+    };
+
+private:
+    DashingLineEffect(GrEffectEdgeType edgeType, SkScalar dashStart, SkScalar dashEnd,
+                      SkScalar period, SkScalar phase, SkScalar lineStart, SkScalar lineEnd,
+                      SkScalar halfWidth)
+        : fEdgeType(edgeType)
+        , fDashStart(dashStart)
+        , fDashEnd(dashEnd)
+        , fPeriod(period)
+        , fPhase(phase)
+        , fLineStart(lineStart)
+        , fLineEnd(lineEnd)
+        , fHalfWidth(halfWidth) {
+        this->addVertexAttrib(kVec2f_GrSLType);
+    }
+
+    virtual bool onIsEqual(const GrEffect& other) const SK_OVERRIDE {
+        const DashingLineEffect& de = CastEffect<DashingLineEffect>(other);
+        return fEdgeType == de.fEdgeType &&
+               fDashStart == de.fDashStart &&
+               fDashEnd == de.fDashEnd &&
+               fPeriod == de.fPeriod &&
+               fPhase == de.fPhase &&
+               fLineStart == de.fLineStart &&
+               fLineEnd == de.fLineEnd &&
+               fHalfWidth == de.fHalfWidth;
+    }
+
+    GrEffectEdgeType    fEdgeType;
+    SkScalar            fDashStart;
+    SkScalar            fDashEnd;
+    SkScalar            fPeriod;
+    SkScalar            fPhase;
+    SkScalar            fLineStart;
+    SkScalar            fLineEnd;
+    SkScalar            fHalfWidth;
+
+    GR_DECLARE_EFFECT_TEST;
+
+    typedef GrVertexEffect INHERITED;
+};
+
+GR_DEFINE_EFFECT_TEST(DashingLineEffect);
+
+GrEffectRef* DashingLineEffect::TestCreate(SkRandom* random,
+                                           GrContext*,
+                                           const GrDrawTargetCaps& caps,
+                                           GrTexture*[]) {
+    GrEffectEdgeType edgeType = random->nextBool() ? kFillAA_GrEffectEdgeType :
+                                                     kFillBW_GrEffectEdgeType;
+    SkScalar halfWidth = random->nextRangeScalar(0.5f, 20.f);
+    SkScalar cap = random->nextBool() ? halfWidth : 0;
+    SkScalar on = random->nextRangeScalar(0.f, 50.f);
+    SkScalar period = on + 2 * cap + random->nextRangeScalar(1.f, 50.f);
+    SkScalar length = random->nextRangeScalar(1.f, 1000.f);
+    return DashingLineEffect::Create(edgeType, -cap, on + cap, period,
+                                     random->nextRangeScalar(0.f, period),
+                                     -cap, length + cap, halfWidth);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool GrDashingEffect::DrawDashLine(const SkPoint pts[2], const SkPaint& paint,
+                                   const GrPaint& grPaint, GrContext* context) {
+    const SkPathEffect* pe = paint.getPathEffect();
+    SkPathEffect::DashInfo info;
+    if (NULL == pe || SkPathEffect::kDash_DashType != pe->asADash(&info) || 2 != info.fCount) {
+        return false;
+    }
+    SkScalar intervals[2];
+    info.fIntervals = intervals;
+    pe->asADash(&info);
+
+    if (SkPaint::kStroke_Style != paint.getStyle() || paint.getStrokeWidth() <= 0 ||
+        SkPaint::kRound_Cap == paint.getStrokeCap()) {
+        return false;
+    }
+
+    // The dashes are computed in device space, so they must keep their shape there.
+    const SkMatrix& vm = context->getMatrix();
+    if (!vm.isSimilarity()) {
+        return false;
+    }
+    const SkScalar scale = vm.mapRadius(SK_Scalar1);
+    const SkScalar on = SkScalarMul(intervals[0], scale);
+    const SkScalar period = SkScalarMul(intervals[0] + intervals[1], scale);
+    const SkScalar phase = SkScalarMul(info.fPhase, scale);
+    const SkScalar halfWidth = SkScalarMul(SkScalarHalf(paint.getStrokeWidth()), scale);
+    const SkScalar cap = SkPaint::kSquare_Cap == paint.getStrokeCap() ? halfWidth : 0;
+    // The coverage only accounts for the dashes either side of a pixel's own, so a pixel may
+    // not span a whole period.
+    if (!SkScalarIsFinite(period) || period < SK_Scalar1 || phase < 0 || phase >= period) {
+        return false;
+    }
+
+    SkPoint devPts[2];
+    vm.mapPoints(devPts, pts, 2);
+    SkVector tangent = devPts[1] - devPts[0];
+    const SkScalar length = tangent.length();
+    if (!tangent.normalize()) {
+        return false;
+    }
+    if (length + phase > kMaxLineLength) {
+        return false;
+    }
+
+    // Like SkDashPathEffect, trim the dashes to the line before capping them: a cap is drawn
+    // past either end only if a dash reaches that end.
+    SkScalar lineStart = 0;
+    if (phase >= on) {
+        lineStart = period - phase;
+    }
+    SkScalar lineEnd = length;
+    SkScalar endPhase = SkScalarMod(length + phase, period);
+    if (endPhase > on) {
+        lineEnd = length - (endPhase - on);
+    }
+    if (lineStart > lineEnd) {
+        // the line starts and ends in the same gap
+        return true;
+    }
+    lineStart -= cap;
+    lineEnd += cap;
+
+    GrDrawTarget* target = context->getTextTarget();
+    GrDrawState* drawState = target->drawState();
+    GrDrawState::AutoRestoreEffects are(drawState);
+    drawState->setFromPaint(grPaint, vm, context->getRenderTarget());
+    GrDrawState::AutoViewMatrixRestore avmr;
+    if (!avmr.setIdentity(drawState)) {
+        return false;
+    }
+
+    bool useAA = grPaint.isAntiAlias() && !drawState->getRenderTarget()->isMultisampled();
+    // Outset the quad so that it covers every pixel any antialiased edge touches.
+    const SkScalar outset = useAA ? SK_ScalarHalf : 0;
+
+    drawState->setVertexAttribs<gDashLineVertexAttribs>(SK_ARRAY_COUNT(gDashLineVertexAttribs));
+    SkASSERT(sizeof(DashLineVertex) == drawState->getVertexSize());
+
+    GrDrawTarget::AutoReleaseGeometry geo(target, 4, 0);
+    if (!geo.succeeded()) {
+        GrPrintf("Failed to get space for vertices!\n");
+        return false;
+    }
+    DashLineVertex* verts = reinterpret_cast<DashLineVertex*>(geo.vertices());
+
+    const SkScalar x[2] = { lineStart - outset, lineEnd + outset };
+    const SkScalar y[2] = { -halfWidth - outset, halfWidth + outset };
+    SkPoint corners[4];
+    for (int i = 0; i < 4; ++i) {
+        SkScalar along = x[i & 1];
+        SkScalar across = y[i >> 1];
+        // the normal is the tangent rotated clockwise
+        corners[i].set(devPts[0].fX + SkScalarMul(along, tangent.fX) -
+                           SkScalarMul(across, tangent.fY),
+                       devPts[0].fY + SkScalarMul(along, tangent.fY) +
+                           SkScalarMul(across, tangent.fX));
+        verts[i].fPos = corners[i];
+        verts[i].fDashPos.set(along, across);
+    }
+    SkRect bounds;
+    bounds.set(corners, 4);
+
+    GrEffectEdgeType edgeType = useAA ? kFillAA_GrEffectEdgeType : kFillBW_GrEffectEdgeType;
+    static const int kDashCoordAttrIndex = 1;
+    drawState->addCoverageEffect(DashingLineEffect::Create(edgeType, -cap, on + cap, period,
+                                                           phase, lineStart, lineEnd,
+                                                           halfWidth),
+                                 kDashCoordAttrIndex)->unref();
+
+    target->drawNonIndexed(kTriangleStrip_GrPrimitiveType, 0, 4, &bounds);
+    return true;
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrDashingEffect_DEFINED
+#define GrDashingEffect_DEFINED
+
+#include "GrTypes.h"
+#include "GrTypesPriv.h"
+
+class GrContext;
+class GrPaint;
+class SkPaint;
+struct SkPoint;
+
+namespace GrDashingEffect {
+    /**
+     * Draws the dashed line pts[0], pts[1] as a single quad whose coverage effect computes the
+     * dashes, rather than expanding the dashes into a path. This only handles a paint whose path
+     * effect is a two interval SkDashPathEffect with butt or square caps, drawn with a similarity
+     * view matrix. Returns false, having drawn nothing, if the line isn't such a case.
+     */
+    bool DrawDashLine(const SkPoint pts[2], const SkPaint& paint, const GrPaint& grPaint,
+                      GrContext* context);
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLAsyncReadPixels.h"
+
+#include "GrContext.h"
+#include "GrGLGpuTimer.h"
+#include "GrGLUtil.h"
+#include "GrGpuGL.h"
+#include "GrRenderTarget.h"
+#include "SkCanvas.h"
+#include "SkDevice.h"
+#include "SkGr.h"
+#include "SkSurface.h"
+
+#define GL_CALL(X) GR_GL_CALL(fGpu->glInterface(), X)
+
+// GL is the only backend GrGpu::Create() makes.
+static GrGpuGL* get_gpu(GrContext* context) {
+    return static_cast<GrGpuGL*>(context->getGpu());
+}
+
+bool GrGLAsyncReadPixels::IsSupported(GrContext* context) {
+    return get_gpu(context)->glCaps().packPixelBufferSupport();
+}
+
+GrGLAsyncReadPixels::GrGLAsyncReadPixels(GrContext* context, int maxPending)
+    : fContext(context)
+    , fGpu(get_gpu(context))
+    , fMaxPending(SkMax32(maxPending, 1))
+    , fUseQueries(GrGLGpuTimer::IsSupported(fGpu->glContext())) {
+}
+
+GrGLAsyncReadPixels::~GrGLAsyncReadPixels() {
+    this->finish();
+    if (fFreeBufferIDs.count() > 0) {
+        GL_CALL(DeleteBuffers(fFreeBufferIDs.count(), fFreeBufferIDs.begin()));
+    }
+    if (fFreeQueryIDs.count() > 0) {
+        GL_CALL(DeleteQueries(fFreeQueryIDs.count(), fFreeQueryIDs.begin()));
+    }
+}
+
+bool GrGLAsyncReadPixels::readPixels(GrRenderTarget* target,
+                                     int left, int top, int width, int height,
+                                     ReadyProc proc, void* context) {
+    SkASSERT(NULL != target && NULL != proc);
+    if (!fGpu->glCaps().packPixelBufferSupport()) {
+        return false;
+    }
+    GrPixelConfig config = target->config();
+    SkColorType colorType;
+    if ((kRGBA_8888_GrPixelConfig != config && kBGRA_8888_GrPixelConfig != config) ||
+        !GrPixelConfig2ColorType(config, &colorType)) {
+        return false;
+    }
+
+    GrGLuint bufferID = 0;
+    if (fFreeBufferIDs.count() > 0) {
+        fFreeBufferIDs.pop(&bufferID);
+    } else {
+        GL_CALL(GenBuffers(1, &bufferID));
+        if (0 == bufferID) {
+            return false;
+        }
+    }
+
+    // Draws still queued in the context have to land in the target first.
+    fContext->flush();
+    Read read;
+    if (!fGpu->readPixelsToPackBuffer(target, left, top, width, height, config, bufferID,
+                                      &read.fFlipY)) {
+        *fFreeBufferIDs.append() = bufferID;
+        return false;
+    }
+
+    read.fBufferID = bufferID;
+    read.fQueryID = 0;
+    if (fUseQueries) {
+        if (fFreeQueryIDs.count() > 0) {
+            fFreeQueryIDs.pop(&read.fQueryID);
+        } else {
+            GL_CALL(GenQueries(1, &read.fQueryID));
+        }
+        // The timestamp is only written once the commands before it, the read included, are done.
+        if (0 != read.fQueryID) {
+            GL_CALL(QueryCounter(read.fQueryID, GR_GL_TIMESTAMP));
+        }
+    }
+    read.fInfo = SkImageInfo::Make(width, height, colorType, kPremul_SkAlphaType);
+    read.fProc = proc;
+    read.fContext = context;
+    *fPending.append() = read;
+
+    while (fPending.count() > fMaxPending) {
+        this->completeOldest();
+    }
+    this->poll();
+    return true;
+}
+
+bool GrGLAsyncReadPixels::readPixels(SkSurface* surface, ReadyProc proc, void* context) {
+    GrRenderTarget* target = surface->getCanvas()->getDevice()->accessRenderTarget();
+    if (NULL == target) {
+        return false;
+    }
+    return this->readPixels(target, 0, 0, target->width(), target->height(), proc, context);
+}
+
+bool GrGLAsyncReadPixels::hasLanded(const Read& read) const {
+    if (0 == read.fQueryID) {
+        return false;
+    }
+    GrGLint available = 0;
+    GL_CALL(GetQueryObjectiv(read.fQueryID, GR_GL_QUERY_RESULT_AVAILABLE, &available));
+    return 0 != available;
+}
+
+void GrGLAsyncReadPixels::poll() {
+    // Reads land in order, so the first one that hasn't landed ends the search.
+    while (fPending.count() > 0 && this->hasLanded(fPending[0])) {
+        this->completeOldest();
+    }
+}
+
+void GrGLAsyncReadPixels::finish() {
+    while (fPending.count() > 0) {
+        this->completeOldest();
+    }
+}
+
+void GrGLAsyncReadPixels::completeOldest() {
+    Read read = fPending[0];
+    fPending.remove(0);
+
+    const SkImageInfo& info = read.fInfo;
+    size_t rowBytes = info.minRowBytes();
+    size_t size = rowBytes * info.height();
+    const void* pixels = fGpu->mapPackBuffer(read.fBufferID, size);
+    if (NULL == pixels) {
+        read.fProc(NULL, 0, info, read.fContext);
+    } else {
+        if (read.fFlipY) {
+            // GL couldn't reverse the rows as it read them.
+            fFlipStorage.reset(size);
+            const char* src = static_cast<const char*>(pixels) + (info.height() - 1) * rowBytes;
+            char* dst = static_cast<char*>(fFlipStorage.get());
+            for (int y = 0; y < info.height(); ++y) {
+                memcpy(dst, src, rowBytes);
+                src -= rowBytes;
+                dst += rowBytes;
+            }
+            pixels = fFlipStorage.get();
+        }
+        read.fProc(pixels, rowBytes, info, read.fContext);
+        // GL only loses a mapping to events like mode switches, and by the time it says so the
+        // proc has already run, so there is nothing useful to do about it.
+        fGpu->unmapPackBuffer();
+    }
+
+    *fFreeBufferIDs.append() = read.fBufferID;
+    if (0 != read.fQueryID) {
+        *fFreeQueryIDs.append() = read.fQueryID;
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLAsyncReadPixels_DEFINED
+#define GrGLAsyncReadPixels_DEFINED
+
+#include "gl/GrGLFunctions.h"
+#include "SkImageInfo.h"
+#include "SkTDArray.h"
+#include "SkTypes.h"
+
+class GrContext;
+class GrGpuGL;
+class GrRenderTarget;
+class SkSurface;
+
+/**
+ * Reads back render targets without stalling on glReadPixels, for clients such as a renderer that
+ * encodes every frame it draws. Each read goes into a GL_PIXEL_PACK_BUFFER, so glReadPixels only
+ * queues the copy and the next frame can be drawn while the GPU makes it. The pixels are handed to
+ * a ReadyProc once they have landed.
+ *
+ * GL fences aren't part of GrGLInterface, so a timestamp query issued after each read stands in
+ * for one where timer queries are supported: poll() runs the procs of the reads whose query has
+ * landed, and never blocks. Without timer queries a read only completes when it has to: when a
+ * new read would leave more than maxPending reads in flight, or in finish().
+ *
+ * All calls must be made on the thread that owns the GrContext, with its GL context current, and
+ * the object must be destroyed before the GrContext.
+ */
+class GrGLAsyncReadPixels : SkNoncopyable {
+public:
+    /**
+     * Called with the pixels of a read, top row first, in the config of the render target they
+     * were read from. pixels are only valid during the call, and are NULL if the read failed.
+     */
+    typedef void (*ReadyProc)(const void* pixels, size_t rowBytes, const SkImageInfo& info,
+                              void* context);
+
+    /** Returns true if the context's GL can read into pixel buffers. */
+    static bool IsSupported(GrContext*);
+
+    GrGLAsyncReadPixels(GrContext*, int maxPending = 2);
+
+    /** Calls finish(). */
+    ~GrGLAsyncReadPixels();
+
+    /**
+     * Flushes the context and starts reading the rect of the target. Only RGBA and BGRA 8888
+     * targets can be read. Returns false, without calling proc, if the read couldn't be started.
+     */
+    bool readPixels(GrRenderTarget* target, int left, int top, int width, int height,
+                    ReadyProc proc, void* context);
+
+    /** Reads all of a surface made by SkSurface::NewRenderTarget() or NewRenderTargetDirect(). */
+    bool readPixels(SkSurface* surface, ReadyProc proc, void* context);
+
+    /** Completes the reads that have landed, oldest first. Never blocks. */
+    void poll();
+
+    /** Completes every read in flight, waiting on the GPU for those that haven't landed. */
+    void finish();
+
+private:
+    struct Read {
+        GrGLuint    fBufferID;
+        GrGLuint    fQueryID;   // 0 without timer queries
+        SkImageInfo fInfo;
+        bool        fFlipY;
+        ReadyProc   fProc;
+        void*       fContext;
+    };
+
+    bool hasLanded(const Read&) const;
+    void completeOldest();
+
+    GrContext*              fContext;
+    GrGpuGL*                fGpu;
+    int                     fMaxPending;
+    bool                    fUseQueries;
+    SkTDArray<Read>         fPending;       // oldest first
+    SkTDArray<GrGLuint>     fFreeBufferIDs;
+    SkTDArray<GrGLuint>     fFreeQueryIDs;
+    SkAutoMalloc            fFlipStorage;
+};
+
+#endif
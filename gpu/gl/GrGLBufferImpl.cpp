@@ -133,6 +133,31 @@ void* GrGLBufferImpl::lock(GrGpuGL* gpu) {
     return fLockPtr;
 }
 
+void* GrGLBufferImpl::lockRange(GrGpuGL* gpu, size_t offset, size_t size) {
+    VALIDATE();
+    SkASSERT(!this->isLocked());
+    SkASSERT(offset + size <= fDesc.fSizeInBytes);
+    if (0 == fDesc.fID) {
+        fLockPtr = reinterpret_cast<char*>(fCPUData) + offset;
+    } else {
+        // The GL buffer must already be allocated at full size, we can't preserve its contents
+        // otherwise.
+        if (GrGLCaps::kMapBufferRange_MapBufferType != gpu->glCaps().mapBufferType() ||
+            fDesc.fSizeInBytes != fGLSizeInBytes) {
+            return NULL;
+        }
+        this->bind(gpu);
+        static const GrGLbitfield kAccess = GR_GL_MAP_INVALIDATE_RANGE_BIT |
+                                            GR_GL_MAP_UNSYNCHRONIZED_BIT |
+                                            GR_GL_MAP_WRITE_BIT;
+        GR_GL_CALL_RET(gpu->glInterface(),
+                       fLockPtr,
+                       MapBufferRange(fBufferType, offset, size, kAccess));
+    }
+    VALIDATE();
+    return fLockPtr;
+}
+
 void GrGLBufferImpl::unlock(GrGpuGL* gpu) {
     VALIDATE();
     SkASSERT(this->isLocked());
@@ -222,5 +247,7 @@ void GrGLBufferImpl::validate() const {
     SkASSERT(0 != fDesc.fID || !fDesc.fIsWrapped);
     SkASSERT(NULL == fCPUData || 0 == fGLSizeInBytes);
     SkASSERT(NULL == fLockPtr || NULL != fCPUData || fGLSizeInBytes == fDesc.fSizeInBytes);
-    SkASSERT(NULL == fCPUData || NULL == fLockPtr || fCPUData == fLockPtr);
+    SkASSERT(NULL == fCPUData || NULL == fLockPtr ||
+             (fLockPtr >= fCPUData &&
+              fLockPtr <= reinterpret_cast<char*>(fCPUData) + fDesc.fSizeInBytes));
 }
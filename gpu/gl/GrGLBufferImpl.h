@@ -41,6 +41,7 @@ public:
     void bind(GrGpuGL* gpu) const;
 
     void* lock(GrGpuGL* gpu);
+    void* lockRange(GrGpuGL* gpu, size_t offset, size_t size);
     void* lockPtr() const { return fLockPtr; }
     void unlock(GrGpuGL* gpu);
     bool isLocked() const;
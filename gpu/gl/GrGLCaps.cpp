@@ -35,6 +35,8 @@ void GrGLCaps::reset() {
     fTextureSwizzleSupport = false;
     fUnpackRowLengthSupport = false;
     fUnpackFlipYSupport = false;
+    fUnpackPixelBufferSupport = false;
+    fPackPixelBufferSupport = false;
     fPackRowLengthSupport = false;
     fPackFlipYSupport = false;
     fTextureUsageSupport = false;
@@ -44,6 +46,7 @@ void GrGLCaps::reset() {
     fTwoFormatLimit = false;
     fFragCoordsConventionSupport = false;
     fVertexArrayObjectSupport = false;
+    fInstancedArraysSupport = false;
     fUseNonVBOVertexAndIndexDynamicData = false;
     fIsCoreProfile = false;
     fFullClearIsFree = false;
@@ -73,6 +76,8 @@ GrGLCaps& GrGLCaps::operator= (const GrGLCaps& caps) {
     fTextureSwizzleSupport = caps.fTextureSwizzleSupport;
     fUnpackRowLengthSupport = caps.fUnpackRowLengthSupport;
     fUnpackFlipYSupport = caps.fUnpackFlipYSupport;
+    fUnpackPixelBufferSupport = caps.fUnpackPixelBufferSupport;
+    fPackPixelBufferSupport = caps.fPackPixelBufferSupport;
     fPackRowLengthSupport = caps.fPackRowLengthSupport;
     fPackFlipYSupport = caps.fPackFlipYSupport;
     fTextureUsageSupport = caps.fTextureUsageSupport;
@@ -82,6 +87,7 @@ GrGLCaps& GrGLCaps::operator= (const GrGLCaps& caps) {
     fTwoFormatLimit = caps.fTwoFormatLimit;
     fFragCoordsConventionSupport = caps.fFragCoordsConventionSupport;
     fVertexArrayObjectSupport = caps.fVertexArrayObjectSupport;
+    fInstancedArraysSupport = caps.fInstancedArraysSupport;
     fUseNonVBOVertexAndIndexDynamicData = caps.fUseNonVBOVertexAndIndexDynamicData;
     fIsCoreProfile = caps.fIsCoreProfile;
     fFullClearIsFree = caps.fFullClearIsFree;
@@ -170,6 +176,14 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
             ctxInfo.hasExtension("GL_ANGLE_pack_reverse_row_order");
     }
 
+    if (kGL_GrGLStandard == standard) {
+        fUnpackPixelBufferSupport = version >= GR_GL_VER(2,1) ||
+                                    ctxInfo.hasExtension("GL_ARB_pixel_buffer_object");
+    } else {
+        fUnpackPixelBufferSupport = version >= GR_GL_VER(3,0) ||
+                                    ctxInfo.hasExtension("GL_NV_pixel_buffer_object");
+    }
+
     fTextureUsageSupport = (kGLES_GrGLStandard == standard) &&
                             ctxInfo.hasExtension("GL_ANGLE_texture_usage");
 
@@ -245,6 +259,16 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
                                     ctxInfo.hasExtension("GL_OES_vertex_array_object");
     }
 
+    if (kGL_GrGLStandard == standard) {
+        fInstancedArraysSupport = version >= GR_GL_VER(3, 3) ||
+                                  ctxInfo.hasExtension("GL_ARB_instanced_arrays");
+    } else {
+        fInstancedArraysSupport = version >= GR_GL_VER(3, 0) ||
+                                  ctxInfo.hasExtension("GL_ANGLE_instanced_arrays") ||
+                                  ctxInfo.hasExtension("GL_EXT_instanced_arrays") ||
+                                  ctxInfo.hasExtension("GL_NV_instanced_arrays");
+    }
+
     if (kGLES_GrGLStandard == standard) {
         if (ctxInfo.hasExtension("GL_EXT_shader_framebuffer_fetch")) {
             fFBFetchType = kEXT_FBFetchType;
@@ -293,7 +317,7 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
         fMapBufferFlags = kCanMap_MapFlag; // we require VBO support and the desktop VBO
                                             // extension includes glMapBuffer.
         if (version >= GR_GL_VER(3, 0) || ctxInfo.hasExtension("GL_ARB_map_buffer_range")) {
-            fMapBufferFlags |= kSubset_MapFlag;
+            fMapBufferFlags |= kSubset_MapFlag | kUnsynchronized_MapFlag;
             fMapBufferType = kMapBufferRange_MapBufferType;
         } else {
             fMapBufferType = kMapBuffer_MapBufferType;
@@ -305,7 +329,7 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
             fMapBufferFlags = kCanMap_MapFlag | kSubset_MapFlag;
             fMapBufferType = kChromium_MapBufferType;
         } else if (version >= GR_GL_VER(3, 0) || ctxInfo.hasExtension("GL_EXT_map_buffer_range")) {
-            fMapBufferFlags = kCanMap_MapFlag | kSubset_MapFlag;
+            fMapBufferFlags = kCanMap_MapFlag | kSubset_MapFlag | kUnsynchronized_MapFlag;
             fMapBufferType = kMapBufferRange_MapBufferType;
         } else if (ctxInfo.hasExtension("GL_OES_mapbuffer")) {
             fMapBufferFlags = kCanMap_MapFlag;
@@ -313,6 +337,16 @@ bool GrGLCaps::init(const GrGLContextInfo& ctxInfo, const GrGLInterface* gli) {
         }
     }
 
+    // The pixel buffer object extensions cover both directions, but reading back also takes a
+    // mapping that can read. GL_OES_mapbuffer only maps for writing and GL_CHROMIUM_map_sub only
+    // maps a copy for writing.
+    if (kGL_GrGLStandard == standard) {
+        fPackPixelBufferSupport = fUnpackPixelBufferSupport;
+    } else {
+        fPackPixelBufferSupport = fUnpackPixelBufferSupport &&
+                                  kMapBufferRange_MapBufferType == fMapBufferType;
+    }
+
     if (kGL_GrGLStandard == standard) {
         SkASSERT(ctxInfo.version() >= GR_GL_VER(2,0) ||
                  ctxInfo.hasExtension("GL_ARB_texture_non_power_of_two"));
@@ -699,6 +733,8 @@ SkString GrGLCaps::dump() const {
     r.appendf("Support texture swizzle: %s\n", (fTextureSwizzleSupport ? "YES": "NO"));
     r.appendf("Unpack Row length support: %s\n", (fUnpackRowLengthSupport ? "YES": "NO"));
     r.appendf("Unpack Flip Y support: %s\n", (fUnpackFlipYSupport ? "YES": "NO"));
+    r.appendf("Unpack pixel buffer support: %s\n", (fUnpackPixelBufferSupport ? "YES": "NO"));
+    r.appendf("Pack pixel buffer support: %s\n", (fPackPixelBufferSupport ? "YES": "NO"));
     r.appendf("Pack Row length support: %s\n", (fPackRowLengthSupport ? "YES": "NO"));
     r.appendf("Pack Flip Y support: %s\n", (fPackFlipYSupport ? "YES": "NO"));
 
@@ -710,6 +746,7 @@ SkString GrGLCaps::dump() const {
     r.appendf("Fragment coord conventions support: %s\n",
              (fFragCoordsConventionSupport ? "YES": "NO"));
     r.appendf("Vertex array object support: %s\n", (fVertexArrayObjectSupport ? "YES": "NO"));
+    r.appendf("Instanced arrays support: %s\n", (fInstancedArraysSupport ? "YES": "NO"));
     r.appendf("Use non-VBO for dynamic data: %s\n",
              (fUseNonVBOVertexAndIndexDynamicData ? "YES" : "NO"));
     r.appendf("Full screen clear is free: %s\n", (fFullClearIsFree ? "YES" : "NO"));
@@ -224,6 +224,12 @@ public:
     /// Is there support for GL_UNPACK_FLIP_Y
     bool unpackFlipYSupport() const { return fUnpackFlipYSupport; }
 
+    /// Is there support for GL_PIXEL_UNPACK_BUFFER
+    bool unpackPixelBufferSupport() const { return fUnpackPixelBufferSupport; }
+
+    /// Is there support for reading pixels into a GL_PIXEL_PACK_BUFFER and mapping it to read
+    bool packPixelBufferSupport() const { return fPackPixelBufferSupport; }
+
     /// Is there support for GL_PACK_ROW_LENGTH
     bool packRowLengthSupport() const { return fPackRowLengthSupport; }
 
@@ -248,6 +254,9 @@ public:
     /// Is there support for Vertex Array Objects?
     bool vertexArrayObjectSupport() const { return fVertexArrayObjectSupport; }
 
+    /// Is there support for instanced arrays (glVertexAttribDivisor and instanced draws)?
+    bool instancedArraysSupport() const { return fInstancedArraysSupport; }
+
     /// Use indices or vertices in CPU arrays rather than VBOs for dynamic content.
     bool useNonVBOVertexAndIndexDynamicData() const {
         return fUseNonVBOVertexAndIndexDynamicData;
@@ -339,6 +348,8 @@ private:
     bool fTextureSwizzleSupport : 1;
     bool fUnpackRowLengthSupport : 1;
     bool fUnpackFlipYSupport : 1;
+    bool fUnpackPixelBufferSupport : 1;
+    bool fPackPixelBufferSupport : 1;
     bool fPackRowLengthSupport : 1;
     bool fPackFlipYSupport : 1;
     bool fTextureUsageSupport : 1;
@@ -348,6 +359,7 @@ private:
     bool fTwoFormatLimit : 1;
     bool fFragCoordsConventionSupport : 1;
     bool fVertexArrayObjectSupport : 1;
+    bool fInstancedArraysSupport : 1;
     bool fUseNonVBOVertexAndIndexDynamicData : 1;
     bool fIsCoreProfile : 1;
     bool fFullClearIsFree : 1;
@@ -7,6 +7,75 @@
 
 #include "GrGLContext.h"
 
+#include "SkTDArray.h"
+#include "SkThread.h"
+
+namespace {
+struct SharedCaps {
+    GrGLStandard            fStandard;
+    SkString                fDriverID;
+    SkAutoTUnref<GrGLCaps>  fCaps;
+};
+}
+
+SK_DECLARE_STATIC_MUTEX(gSharedCapsMutex);
+static bool gShareCapsAcrossContexts;
+static SkTDArray<SharedCaps*>* gSharedCaps;
+
+void GrGLContextInfo::SetShareCapsAcrossContexts(bool share) {
+    SkAutoMutexAcquire am(gSharedCapsMutex);
+    gShareCapsAcrossContexts = share;
+    if (!share && NULL != gSharedCaps) {
+        gSharedCaps->deleteAll();
+        SkDELETE(gSharedCaps);
+        gSharedCaps = NULL;
+    }
+}
+
+static void get_driver_id(const GrGLInterface* interface, SkString* driverID) {
+    static const GrGLenum kNames[] = { GR_GL_VENDOR, GR_GL_RENDERER, GR_GL_VERSION };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kNames); ++i) {
+        const GrGLubyte* str;
+        GR_GL_CALL_RET(interface, str, GetString(kNames[i]));
+        if (NULL != str) {
+            driverID->append(reinterpret_cast<const char*>(str));
+        }
+        driverID->append("\n");
+    }
+}
+
+// Copies the kept caps for the driver into caps, if there are any.
+static bool find_shared_caps(GrGLStandard standard, const SkString& driverID, GrGLCaps* caps) {
+    SkAutoMutexAcquire am(gSharedCapsMutex);
+    if (NULL == gSharedCaps) {
+        return false;
+    }
+    for (int i = 0; i < gSharedCaps->count(); ++i) {
+        const SharedCaps& shared = *(*gSharedCaps)[i];
+        if (shared.fStandard == standard && shared.fDriverID == driverID) {
+            *caps = *shared.fCaps.get();
+            return true;
+        }
+    }
+    return false;
+}
+
+static void add_shared_caps(GrGLStandard standard, const SkString& driverID,
+                            const GrGLCaps& caps) {
+    SkAutoMutexAcquire am(gSharedCapsMutex);
+    if (!gShareCapsAcrossContexts) {
+        return;
+    }
+    if (NULL == gSharedCaps) {
+        gSharedCaps = SkNEW(SkTDArray<SharedCaps*>);
+    }
+    SharedCaps* shared = SkNEW(SharedCaps);
+    shared->fStandard = standard;
+    shared->fDriverID = driverID;
+    shared->fCaps.reset(SkNEW_ARGS(GrGLCaps, (caps)));
+    *gSharedCaps->append() = shared;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 GrGLContextInfo& GrGLContextInfo::operator= (const GrGLContextInfo& that) {
@@ -56,7 +125,25 @@ bool GrGLContextInfo::initialize(const GrGLInterface* interface) {
             // This must occur before caps init.
             fInterface.reset(SkRef(interface));
 
-            return fGLCaps->init(*this, interface);
+            bool share;
+            {
+                SkAutoMutexAcquire am(gSharedCapsMutex);
+                share = gShareCapsAcrossContexts;
+            }
+            if (!share) {
+                return fGLCaps->init(*this, interface);
+            }
+
+            SkString driverID;
+            get_driver_id(interface, &driverID);
+            if (find_shared_caps(interface->fStandard, driverID, fGLCaps)) {
+                return true;
+            }
+            if (!fGLCaps->init(*this, interface)) {
+                return false;
+            }
+            add_shared_caps(interface->fStandard, driverID, *fGLCaps);
+            return true;
         }
     }
     return false;
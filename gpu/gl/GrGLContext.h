@@ -43,6 +43,15 @@ public:
      * bound OpenGL context accessible by the GrGLInterface.
      */
     bool initialize(const GrGLInterface* interface);
+
+    /**
+     * When enabled, the GrGLCaps of the first context initialized for a driver are kept, and
+     * later contexts on the same driver (the same GL standard and vendor, renderer and version
+     * strings) copy them instead of querying and probing the driver again. This suits processes
+     * that create many short lived contexts. It assumes all the GrGLInterfaces made for a driver
+     * expose the same extensions. Disabling it drops the kept caps.
+     */
+    static void SetShareCapsAcrossContexts(bool);
     bool isInitialized() const;
 
     GrGLStandard standard() const { return fInterface->fStandard; }
@@ -88,8 +88,11 @@
 #define GR_GL_ELEMENT_ARRAY_BUFFER           0x8893
 #define GR_GL_ARRAY_BUFFER_BINDING           0x8894
 #define GR_GL_ELEMENT_ARRAY_BUFFER_BINDING   0x8895
+#define GR_GL_PIXEL_PACK_BUFFER              0x88EB
+#define GR_GL_PIXEL_UNPACK_BUFFER            0x88EC
 
 #define GR_GL_STREAM_DRAW                    0x88E0
+#define GR_GL_STREAM_READ                    0x88E1
 #define GR_GL_STATIC_DRAW                    0x88E4
 #define GR_GL_DYNAMIC_DRAW                   0x88E8
 
@@ -556,6 +559,7 @@
 #define GR_GL_VERTEX_ATTRIB_ARRAY_NORMALIZED     0x886A
 #define GR_GL_VERTEX_ATTRIB_ARRAY_POINTER        0x8645
 #define GR_GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING 0x889F
+#define GR_GL_VERTEX_ATTRIB_ARRAY_DIVISOR        0x88FE
 #define GR_GL_VERTEX_ARRAY                       0x8074
 #define GR_GL_NORMAL_ARRAY                       0x8075
 #define GR_GL_COLOR_ARRAY                        0x8076
@@ -599,6 +603,7 @@
 #define GR_GL_T4F_C4F_N3F_V4F                    0x2A2D
 
 /* Vertex Buffer Object */
+#define GR_GL_READ_ONLY                          0x88B8
 #define GR_GL_WRITE_ONLY                         0x88B9
 #define GR_GL_BUFFER_MAPPED                      0x88BC
 
@@ -623,6 +628,12 @@
 #define GR_GL_SHADER_BINARY_FORMATS          0x8DF8
 #define GR_GL_NUM_SHADER_BINARY_FORMATS      0x8DF9
 
+/* Program Binary */
+#define GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GR_GL_PROGRAM_BINARY_LENGTH          0x8741
+#define GR_GL_NUM_PROGRAM_BINARY_FORMATS     0x87FE
+#define GR_GL_PROGRAM_BINARY_FORMATS         0x87FF
+
 /* Shader Precision-Specified Types */
 #define GR_GL_LOW_FLOAT                      0x8DF0
 #define GR_GL_MEDIUM_FLOAT                   0x8DF1
@@ -640,6 +651,7 @@
 #define GR_GL_ANY_SAMPLES_PASSED             0x8C2F
 #define GR_GL_TIME_ELAPSED                   0x88BF
 #define GR_GL_TIMESTAMP                      0x8E28
+#define GR_GL_GPU_DISJOINT                   0x8FBB
 #define GR_GL_PRIMITIVES_GENERATED           0x8C87
 #define GR_GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN 0x8C88
 
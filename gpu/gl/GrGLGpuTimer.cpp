@@ -0,0 +1,152 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLGpuTimer.h"
+
+#include "GrGLContext.h"
+#include "GrGLUtil.h"
+
+#define GL_CALL(X) GR_GL_CALL(fInterface, X)
+
+bool GrGLGpuTimer::IsSupported(const GrGLContext& ctxInfo) {
+    const GrGLInterface* gl = ctxInfo.interface();
+    return NULL != gl &&
+           NULL != gl->fFunctions.fGenQueries &&
+           NULL != gl->fFunctions.fDeleteQueries &&
+           NULL != gl->fFunctions.fQueryCounter &&
+           NULL != gl->fFunctions.fGetQueryObjectiv &&
+           NULL != gl->fFunctions.fGetQueryObjectui64v;
+}
+
+GrGLGpuTimer::GrGLGpuTimer(const GrGLContext& ctxInfo)
+    : fInterface(ctxInfo.interface())
+    , fCheckDisjoint(ctxInfo.hasExtension("GL_EXT_disjoint_timer_query")) {
+    SkASSERT(IsSupported(ctxInfo));
+}
+
+GrGLGpuTimer::~GrGLGpuTimer() {
+    for (int i = 0; i < fOpenScopes.count(); ++i) {
+        this->releaseQuery(fOpenScopes[i].fBeginQuery);
+    }
+    this->discardPending();
+    if (fFreeQueries.count() > 0) {
+        GL_CALL(DeleteQueries(fFreeQueries.count(), fFreeQueries.begin()));
+    }
+}
+
+GrGLuint GrGLGpuTimer::issueTimestamp() {
+    GrGLuint query = 0;
+    if (fFreeQueries.count() > 0) {
+        fFreeQueries.pop(&query);
+    } else {
+        GL_CALL(GenQueries(1, &query));
+    }
+    if (0 != query) {
+        GL_CALL(QueryCounter(query, GR_GL_TIMESTAMP));
+    }
+    return query;
+}
+
+void GrGLGpuTimer::releaseQuery(GrGLuint query) {
+    if (0 != query) {
+        *fFreeQueries.append() = query;
+    }
+}
+
+void GrGLGpuTimer::discardPending() {
+    for (int i = 0; i < fPendingScopes.count(); ++i) {
+        this->releaseQuery(fPendingScopes[i].fBeginQuery);
+        this->releaseQuery(fPendingScopes[i].fEndQuery);
+    }
+    fPendingScopes.reset();
+}
+
+void GrGLGpuTimer::beginScope(const SkString& name) {
+    Scope& scope = fOpenScopes.push_back();
+    scope.fName = name;
+    scope.fEndQuery = 0;
+    if (fPendingScopes.count() + fOpenScopes.count() <= kMaxPendingScopes) {
+        scope.fBeginQuery = this->issueTimestamp();
+    } else {
+        scope.fBeginQuery = 0;
+    }
+}
+
+void GrGLGpuTimer::endScope() {
+    // The timer may have been created inside a scope, whose end we then ignore.
+    if (fOpenScopes.empty()) {
+        return;
+    }
+    Scope& scope = fOpenScopes.back();
+    if (0 != scope.fBeginQuery) {
+        scope.fEndQuery = this->issueTimestamp();
+        if (0 != scope.fEndQuery) {
+            fPendingScopes.push_back(scope);
+        } else {
+            this->releaseQuery(scope.fBeginQuery);
+        }
+    }
+    fOpenScopes.pop_back();
+}
+
+void GrGLGpuTimer::collectResults() {
+    if (fPendingScopes.empty()) {
+        return;
+    }
+    if (fCheckDisjoint) {
+        // The timestamps of any query in flight are meaningless if, for instance, the GPU
+        // changed clock speed. Reading GPU_DISJOINT also resets it.
+        GrGLint disjoint = 0;
+        GL_CALL(GetIntegerv(GR_GL_GPU_DISJOINT, &disjoint));
+        if (disjoint) {
+            this->discardPending();
+            return;
+        }
+    }
+
+    // Timestamps land in the order they were issued, so stop at the first scope that isn't
+    // done yet.
+    int done = 0;
+    for (; done < fPendingScopes.count(); ++done) {
+        const Scope& scope = fPendingScopes[done];
+        GrGLint available = 0;
+        GL_CALL(GetQueryObjectiv(scope.fEndQuery, GR_GL_QUERY_RESULT_AVAILABLE, &available));
+        if (!available) {
+            break;
+        }
+        GrGLuint64 begin = 0, end = 0;
+        GL_CALL(GetQueryObjectui64v(scope.fBeginQuery, GR_GL_QUERY_RESULT, &begin));
+        GL_CALL(GetQueryObjectui64v(scope.fEndQuery, GR_GL_QUERY_RESULT, &end));
+        this->releaseQuery(scope.fBeginQuery);
+        this->releaseQuery(scope.fEndQuery);
+
+        if (fResults.count() < kMaxResults) {
+            GrGpu::GpuTiming& timing = fResults.push_back();
+            timing.fName = scope.fName;
+            timing.fNanos = end > begin ? end - begin : 0;
+        }
+    }
+    if (done > 0) {
+        const int remaining = fPendingScopes.count() - done;
+        for (int i = 0; i < remaining; ++i) {
+            fPendingScopes[i] = fPendingScopes[done + i];
+        }
+        fPendingScopes.pop_back_n(done);
+    }
+}
+
+void GrGLGpuTimer::popResults(SkTArray<GrGpu::GpuTiming>* timings) {
+    timings->push_back_n(fResults.count(), fResults.begin());
+    fResults.reset();
+}
+
+void GrGLGpuTimer::abandon() {
+    fOpenScopes.reset();
+    fPendingScopes.reset();
+    fFreeQueries.reset();
+    fResults.reset();
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLGpuTimer_DEFINED
+#define GrGLGpuTimer_DEFINED
+
+#include "GrGpu.h"
+#include "gl/GrGLFunctions.h"
+
+#include "SkString.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
+
+class GrGLContext;
+struct GrGLInterface;
+
+/**
+ * Measures GPU time for named scopes with GL timestamp queries (ARB_timer_query, or
+ * EXT_disjoint_timer_query on ES). Timestamps rather than GL_TIME_ELAPSED queries are used so
+ * that scopes may nest. Nothing ever waits on the GPU: completed scopes are polled by
+ * collectResults(), usually a few frames after they were issued, and queued for
+ * popResults().
+ */
+class GrGLGpuTimer : SkNoncopyable {
+public:
+    static bool IsSupported(const GrGLContext&);
+
+    GrGLGpuTimer(const GrGLContext&);
+    ~GrGLGpuTimer();
+
+    void beginScope(const SkString& name);
+    void endScope();
+
+    /** Moves the scopes whose timestamps have landed into the results. Never blocks. */
+    void collectResults();
+
+    /** Appends the results collected so far to timings and forgets them. */
+    void popResults(SkTArray<GrGpu::GpuTiming>* timings);
+
+    /** All the queries were lost with the context; drop them without deleting them. */
+    void abandon();
+
+private:
+    struct Scope {
+        SkString fName;
+        GrGLuint fBeginQuery;   // 0 if the scope isn't being timed
+        GrGLuint fEndQuery;
+    };
+
+    enum {
+        // Scopes waiting on the GPU. Past this new scopes aren't timed, so a client that never
+        // flushes doesn't pile up queries.
+        kMaxPendingScopes = 256,
+        // Results not yet popped. Past this new results are dropped.
+        kMaxResults = 1024,
+    };
+
+    GrGLuint issueTimestamp();
+    void releaseQuery(GrGLuint query);
+    void discardPending();
+
+    const GrGLInterface*            fInterface;
+    bool                            fCheckDisjoint;
+    SkTArray<Scope>                 fOpenScopes;      // a stack
+    SkTArray<Scope>                 fPendingScopes;   // in the order they ended
+    SkTDArray<GrGLuint>             fFreeQueries;
+    SkTArray<GrGpu::GpuTiming>      fResults;
+};
+
+#endif
@@ -34,6 +34,14 @@ void* GrGLIndexBuffer::lock() {
     }
 }
 
+void* GrGLIndexBuffer::lockRange(size_t offset, size_t size) {
+    if (!this->wasDestroyed()) {
+        return fImpl.lockRange(this->getGpuGL(), offset, size);
+    } else {
+        return NULL;
+    }
+}
+
 void* GrGLIndexBuffer::lockPtr() const {
     return fImpl.lockPtr();
 }
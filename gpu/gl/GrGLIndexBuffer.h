@@ -33,6 +33,7 @@ public:
 
     // overrides of GrIndexBuffer
     virtual void* lock();
+    virtual void* lockRange(size_t offset, size_t size) SK_OVERRIDE;
     virtual void* lockPtr() const;
     virtual void unlock();
     virtual bool isLocked() const;
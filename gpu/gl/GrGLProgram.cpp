@@ -151,7 +151,7 @@ bool GrGLProgram::genProgram(GrGLShaderBuilder* builder,
     }
     builder->fsCodeAppendf("\t%s = %s;\n", builder->getColorOutputName(), fragColor.c_str());
 
-    if (!builder->finish(&fProgramID)) {
+    if (!builder->finish(fDesc, &fProgramID)) {
         return false;
     }
 
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLProgramBinaryCache.h"
+
+#include "GrGLDefines.h"
+#include "GrGLProgramDesc.h"
+#include "GrGLUtil.h"
+#include "SkThread.h"
+
+SK_DECLARE_STATIC_MUTEX(gDefaultCacheMutex);
+static GrGLProgramBinaryCache* gDefaultCache;
+
+GrGLProgramBinaryCache::GrGLProgramBinaryCache(const Procs& procs) : fProcs(procs) {
+    SkASSERT(NULL != fProcs.fGetProgramBinary);
+    SkASSERT(NULL != fProcs.fProgramBinary);
+}
+
+void GrGLProgramBinaryCache::SetDefault(GrGLProgramBinaryCache* cache) {
+    SkAutoMutexAcquire am(gDefaultCacheMutex);
+    SkRefCnt_SafeAssign(gDefaultCache, cache);
+}
+
+GrGLProgramBinaryCache* GrGLProgramBinaryCache::RefDefault() {
+    SkAutoMutexAcquire am(gDefaultCacheMutex);
+    return SkSafeRef(gDefaultCache);
+}
+
+void GrGLProgramBinaryCache::GetDriverID(const GrGLInterface* gl, SkString* driverID) {
+    static const GrGLenum kNames[] = { GR_GL_VENDOR, GR_GL_RENDERER, GR_GL_VERSION };
+    driverID->reset();
+    for (size_t i = 0; i < SK_ARRAY_COUNT(kNames); ++i) {
+        const GrGLubyte* str;
+        GR_GL_CALL_RET(gl, str, GetString(kNames[i]));
+        if (NULL != str) {
+            driverID->append(reinterpret_cast<const char*>(str));
+        }
+        driverID->append("\n");
+    }
+}
+
+SkData* GrGLProgramBinaryCache::CreateKey(const SkString& driverID, const GrGLProgramDesc& desc) {
+    // The driver ID is newline terminated, so it can't run into the desc key.
+    size_t size = driverID.size() + desc.keyLength();
+    char* key = static_cast<char*>(sk_malloc_throw(size));
+    memcpy(key, driverID.c_str(), driverID.size());
+    memcpy(key + driverID.size(), desc.asKey(), desc.keyLength());
+    return SkData::NewFromMalloc(key, size);
+}
+
+// Blobs are the binary format enum followed by the binary itself.
+static const size_t kBlobHeaderSize = sizeof(uint32_t);
+
+bool GrGLProgramBinaryCache::loadProgram(const GrGLInterface* gl,
+                                         const SkString& driverID,
+                                         const GrGLProgramDesc& desc,
+                                         GrGLuint programID) {
+    SkAutoTUnref<SkData> key(CreateKey(driverID, desc));
+    SkAutoTUnref<SkData> blob(this->onLoad(*key));
+    if (NULL == blob.get() || blob->size() <= kBlobHeaderSize) {
+        return false;
+    }
+
+    uint32_t format;
+    memcpy(&format, blob->data(), sizeof(format));
+    fProcs.fProgramBinary(programID, format, blob->bytes() + kBlobHeaderSize,
+                          static_cast<GrGLsizei>(blob->size() - kBlobHeaderSize));
+
+    // Unlike after glLinkProgram we always have to check; drivers reject binaries routinely.
+    GrGLint linked = GR_GL_INIT_ZERO;
+    GR_GL_CALL(gl, GetProgramiv(programID, GR_GL_LINK_STATUS, &linked));
+    return SkToBool(linked);
+}
+
+void GrGLProgramBinaryCache::willLinkProgram(const GrGLInterface*, GrGLuint programID) {
+    if (NULL != fProcs.fProgramParameteri) {
+        fProcs.fProgramParameteri(programID, GR_GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GR_GL_TRUE);
+    }
+}
+
+void GrGLProgramBinaryCache::storeProgram(const GrGLInterface* gl,
+                                          const SkString& driverID,
+                                          const GrGLProgramDesc& desc,
+                                          GrGLuint programID) {
+    GrGLint length = GR_GL_INIT_ZERO;
+    GR_GL_CALL(gl, GetProgramiv(programID, GR_GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0) {
+        return;
+    }
+
+    size_t size = kBlobHeaderSize + length;
+    uint8_t* blob = static_cast<uint8_t*>(sk_malloc_throw(size));
+    GrGLsizei written = 0;
+    GrGLenum format = 0;
+    fProcs.fGetProgramBinary(programID, length, &written, &format, blob + kBlobHeaderSize);
+    if (written <= 0 || written > length) {
+        sk_free(blob);
+        return;
+    }
+    uint32_t format32 = format;
+    memcpy(blob, &format32, sizeof(format32));
+
+    SkAutoTUnref<SkData> key(CreateKey(driverID, desc));
+    SkAutoTUnref<SkData> data(SkData::NewFromMalloc(blob, kBlobHeaderSize + written));
+    this->onStore(*key, *data);
+}
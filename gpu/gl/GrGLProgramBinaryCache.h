@@ -0,0 +1,105 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLProgramBinaryCache_DEFINED
+#define GrGLProgramBinaryCache_DEFINED
+
+#include "gl/GrGLInterface.h"
+#include "SkData.h"
+#include "SkRefCnt.h"
+#include "SkString.h"
+
+class GrGLProgramDesc;
+
+/**
+ * Persists linked GL programs across runs using glGetProgramBinary/glProgramBinary (GL 4.1,
+ * ARB_get_program_binary, ES 3.0 or OES_get_program_binary). The storage itself is supplied by
+ * the client by overriding onLoad() and onStore(); Ganesh only produces and consumes the blobs.
+ *
+ * Entries are keyed by the GrGLProgramDesc key plus a driver ID built from the GL vendor,
+ * renderer and version strings, so a driver update never feeds a stale binary to the new driver.
+ * Even so, the driver may reject any binary, and a rejected binary just falls back to compiling.
+ *
+ * GrGLInterface does not carry the program binary entry points, so the client passes them in
+ * when creating the cache.
+ */
+class GrGLProgramBinaryCache : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(GrGLProgramBinaryCache)
+
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE* GetProgramBinaryProc)(GrGLuint program,
+                                                                 GrGLsizei bufSize,
+                                                                 GrGLsizei* length,
+                                                                 GrGLenum* binaryFormat,
+                                                                 GrGLvoid* binary);
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE* ProgramBinaryProc)(GrGLuint program,
+                                                              GrGLenum binaryFormat,
+                                                              const GrGLvoid* binary,
+                                                              GrGLsizei length);
+    // Optional. When present the retrievable hint is set before linking, which some drivers
+    // require before they will hand back a binary.
+    typedef GrGLvoid (GR_GL_FUNCTION_TYPE* ProgramParameteriProc)(GrGLuint program,
+                                                                  GrGLenum pname,
+                                                                  GrGLint value);
+
+    struct Procs {
+        GetProgramBinaryProc    fGetProgramBinary;
+        ProgramBinaryProc       fProgramBinary;
+        ProgramParameteriProc   fProgramParameteri;
+    };
+
+    explicit GrGLProgramBinaryCache(const Procs& procs);
+
+    /**
+     * Installs the cache used by GrGpuGL objects created after this call (existing ones keep the
+     * cache they started with). The cache is reffed; passing NULL disables binary caching.
+     */
+    static void SetDefault(GrGLProgramBinaryCache* cache);
+
+    /** Returns a ref on the installed cache, or NULL if there is none. */
+    static GrGLProgramBinaryCache* RefDefault();
+
+    /** Fills out the string that identifies the driver for the context behind gl. */
+    static void GetDriverID(const GrGLInterface* gl, SkString* driverID);
+
+    /**
+     * Looks for a binary for desc and loads it into programID. Returns true if programID is now
+     * successfully linked, in which case no shaders need to be compiled or attached.
+     */
+    bool loadProgram(const GrGLInterface* gl,
+                     const SkString& driverID,
+                     const GrGLProgramDesc& desc,
+                     GrGLuint programID);
+
+    /** Must be called on a program that is about to be linked if storeProgram will follow. */
+    void willLinkProgram(const GrGLInterface* gl, GrGLuint programID);
+
+    /** Retrieves the binary of the successfully linked programID and hands it to onStore(). */
+    void storeProgram(const GrGLInterface* gl,
+                      const SkString& driverID,
+                      const GrGLProgramDesc& desc,
+                      GrGLuint programID);
+
+protected:
+    /**
+     * Returns the blob previously passed to onStore() for key, or NULL. The caller takes
+     * ownership of the returned ref. May be called on whichever thread drives the GL context.
+     */
+    virtual SkData* onLoad(const SkData& key) = 0;
+
+    /** Persists blob under key. Storing may happen asynchronously; blob is immutable. */
+    virtual void onStore(const SkData& key, const SkData& blob) = 0;
+
+private:
+    static SkData* CreateKey(const SkString& driverID, const GrGLProgramDesc& desc);
+
+    Procs   fProcs;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
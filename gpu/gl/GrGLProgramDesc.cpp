@@ -274,6 +274,28 @@ void GrGLProgramDesc::Build(const GrDrawState& drawState,
     desc->fInitialized = true;
 }
 
+bool GrGLProgramDesc::initFromKey(const void* key, size_t length) {
+    fInitialized = false;
+    if (length < kEffectKeyOffset || !SkIsAlign4(length) ||
+        *static_cast<const uint32_t*>(key) != length) {
+        return false;
+    }
+    fKey.reset(length);
+    memcpy(fKey.get(), key, length);
+    const KeyHeader& header = this->getHeader();
+    if (KeyLength(header.fColorEffectCnt + header.fCoverageEffectCnt) != length) {
+        return false;
+    }
+    uint32_t checksum = *this->checksum();
+    *this->checksum() = 0;
+    if (SkChecksum::Compute(reinterpret_cast<uint32_t*>(fKey.get()), length) != checksum) {
+        return false;
+    }
+    *this->checksum() = checksum;
+    fInitialized = true;
+    return true;
+}
+
 GrGLProgramDesc& GrGLProgramDesc::operator= (const GrGLProgramDesc& other) {
     fInitialized = other.fInitialized;
     if (fInitialized) {
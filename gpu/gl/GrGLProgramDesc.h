@@ -75,6 +75,13 @@ public:
                       SkTArray<const GrEffectStage*, true>* outCoverageStages,
                       GrGLProgramDesc* outDesc);
 
+    /**
+     * Initializes the descriptor from a copy of another descriptor's asKey(), e.g. one read back
+     * from a GrGLProgramManifest. Returns false, leaving the descriptor uninitialized, if the
+     * bytes aren't a well formed key.
+     */
+    bool initFromKey(const void* key, size_t length);
+
     int numColorEffects() const {
         SkASSERT(fInitialized);
         return this->getHeader().fColorEffectCnt;
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "GrGLProgramManifest.h"
+
+#include "GrContext.h"
+#include "GrGLProgramBinaryCache.h"
+#include "GrGLUtil.h"
+#include "GrGpuGL.h"
+#include "SkStream.h"
+
+SK_DECLARE_STATIC_MUTEX(gDefaultManifestMutex);
+static GrGLProgramManifest* gDefaultManifest;
+
+// A manifest is the magic, the version and the key count, followed by each key as its length
+// and bytes. Keys start with their own length anyway, but reading it up front lets a reader
+// skip keys without trusting their contents.
+static const uint32_t kManifestMagic = SkSetFourByteTag('g', 'r', 'p', 'm');
+static const uint32_t kManifestVersion = 1;
+// Keys are a few hundred bytes at most; anything longer is a corrupt manifest.
+static const uint32_t kMaxKeyLength = 64 * 1024;
+
+void GrGLProgramManifest::SetDefault(GrGLProgramManifest* manifest) {
+    SkAutoMutexAcquire am(gDefaultManifestMutex);
+    SkRefCnt_SafeAssign(gDefaultManifest, manifest);
+}
+
+GrGLProgramManifest* GrGLProgramManifest::RefDefault() {
+    SkAutoMutexAcquire am(gDefaultManifestMutex);
+    return SkSafeRef(gDefaultManifest);
+}
+
+void GrGLProgramManifest::add(const GrGLProgramDesc& desc) {
+    SkAutoMutexAcquire am(fMutex);
+    // Programs are only added on cache misses, so a linear search is cheap enough.
+    for (int i = 0; i < fDescs.count(); ++i) {
+        if (fDescs[i].getChecksum() == desc.getChecksum() && fDescs[i] == desc) {
+            return;
+        }
+    }
+    fDescs.push_back(desc);
+}
+
+int GrGLProgramManifest::count() const {
+    SkAutoMutexAcquire am(fMutex);
+    return fDescs.count();
+}
+
+bool GrGLProgramManifest::writeToStream(SkWStream* stream) const {
+    SkAutoMutexAcquire am(fMutex);
+    if (!stream->write32(kManifestMagic) ||
+        !stream->write32(kManifestVersion) ||
+        !stream->write32(fDescs.count())) {
+        return false;
+    }
+    for (int i = 0; i < fDescs.count(); ++i) {
+        const GrGLProgramDesc& desc = fDescs[i];
+        if (!stream->write32(desc.keyLength()) ||
+            !stream->write(desc.asKey(), desc.keyLength())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+GrGLProgramManifest* GrGLProgramManifest::CreateFromStream(SkStream* stream) {
+    if (stream->readU32() != kManifestMagic || stream->readU32() > kManifestVersion) {
+        return NULL;
+    }
+    uint32_t count = stream->readU32();
+
+    SkAutoTUnref<GrGLProgramManifest> manifest(SkNEW(GrGLProgramManifest));
+    SkAutoMalloc storage;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t length = stream->readU32();
+        if (0 == length || length > kMaxKeyLength) {
+            break;
+        }
+        storage.reset(length);
+        if (stream->read(storage.get(), length) != length) {
+            break;
+        }
+        GrGLProgramDesc desc;
+        if (desc.initFromKey(storage.get(), length)) {
+            manifest->add(desc);
+        }
+    }
+    return manifest.detach();
+}
+
+int GrGLProgramManifest::prelink(const GrGLInterface* gl,
+                                 GrGLProgramBinaryCache* binaryCache,
+                                 const SkString& driverID,
+                                 SkTArray<PrelinkedProgram>* programs) const {
+    if (NULL == binaryCache) {
+        return 0;
+    }
+
+    SkAutoMutexAcquire am(fMutex);
+    int prelinked = 0;
+    for (int i = 0; i < fDescs.count(); ++i) {
+        GrGLuint programID;
+        GR_GL_CALL_RET(gl, programID, CreateProgram());
+        if (0 == programID) {
+            break;
+        }
+        if (!binaryCache->loadProgram(gl, driverID, fDescs[i], programID)) {
+            GR_GL_CALL(gl, DeleteProgram(programID));
+            continue;
+        }
+        PrelinkedProgram& program = programs->push_back();
+        program.fDesc = fDescs[i];
+        program.fProgramID = programID;
+        ++prelinked;
+    }
+    return prelinked;
+}
+
+int GrGLProgramManifest::prelink(GrContext* context) const {
+    // GL is the only backend GrGpu::Create() makes.
+    GrGpuGL* gpu = static_cast<GrGpuGL*>(context->getGpu());
+    SkTArray<PrelinkedProgram> programs;
+    int prelinked = this->prelink(gpu->glInterface(), gpu->programBinaryCache(),
+                                  gpu->programBinaryDriverID(), &programs);
+    gpu->adoptPrelinkedPrograms(&programs);
+    return prelinked;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef GrGLProgramManifest_DEFINED
+#define GrGLProgramManifest_DEFINED
+
+#include "gl/GrGLInterface.h"
+#include "GrGLProgramDesc.h"
+#include "SkRefCnt.h"
+#include "SkTArray.h"
+#include "SkThread.h"
+
+class GrContext;
+class GrGLProgramBinaryCache;
+class SkStream;
+class SkWStream;
+
+/**
+ * The set of GrGLProgramDesc keys a workload compiled programs for. A manifest installed with
+ * SetDefault() collects the key of every program the GrGpuGL objects created afterwards build on a
+ * program cache miss. Written out at the end of a session and read back at the next startup, it
+ * lets the client link those programs before the first frame needs them.
+ *
+ * Generating a program's shaders takes the effects themselves, not just their keys, so programs
+ * are prelinked from their binaries in a GrGLProgramBinaryCache. The cache miss for a prelinked
+ * program then still generates the shader code on the CPU, but skips loading the binary and the
+ * driver work of glProgramBinary. Without a binary cache a manifest can be recorded but prelinks
+ * nothing.
+ */
+class GrGLProgramManifest : public SkRefCnt {
+public:
+    SK_DECLARE_INST_COUNT(GrGLProgramManifest)
+
+    GrGLProgramManifest() {}
+
+    /**
+     * Installs the manifest that GrGpuGL objects created after this call (existing ones keep the
+     * manifest they started with) add their programs to. The manifest is reffed; passing NULL
+     * stops recording.
+     */
+    static void SetDefault(GrGLProgramManifest*);
+
+    /** Returns a ref on the installed manifest, or NULL if there is none. */
+    static GrGLProgramManifest* RefDefault();
+
+    /** Adds the key if it isn't in the manifest yet. May be called from any thread. */
+    void add(const GrGLProgramDesc&);
+
+    int count() const;
+
+    /** Writes the keys to the stream. Returns false if the stream fails. */
+    bool writeToStream(SkWStream*) const;
+
+    /**
+     * Reads back a manifest written by writeToStream(), dropping any keys that aren't well formed.
+     * Returns NULL if the stream doesn't hold a manifest. The caller owns the returned ref.
+     */
+    static GrGLProgramManifest* CreateFromStream(SkStream*);
+
+    struct PrelinkedProgram {
+        GrGLProgramDesc fDesc;
+        GrGLuint        fProgramID;
+    };
+
+    /**
+     * Creates a program for each key whose binary the cache has, on the GL context behind gl, and
+     * appends those that link to programs. The context can be one that shares objects with the
+     * context of the GrGpuGL that will use the programs, current on a background thread; the
+     * programs are adopted afterwards with GrGpuGL::adoptPrelinkedPrograms() on the GrGpuGL's own
+     * thread. driverID comes from GrGLProgramBinaryCache::GetDriverID(). Returns the number of
+     * programs appended.
+     */
+    int prelink(const GrGLInterface* gl,
+                GrGLProgramBinaryCache*,
+                const SkString& driverID,
+                SkTArray<PrelinkedProgram>* programs) const;
+
+    /**
+     * Prelinks the programs on the GL context of the GrContext, with the binary cache its GrGpuGL
+     * was created with, and hands them to the GrGpuGL. Returns the number of programs prelinked.
+     */
+    int prelink(GrContext*) const;
+
+private:
+    mutable SkMutex                 fMutex;
+    SkTArray<GrGLProgramDesc>       fDescs;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
@@ -569,13 +569,31 @@ const char* GrGLShaderBuilder::enableSecondaryOutput() {
     return dual_source_output_name();
 }
 
-bool GrGLShaderBuilder::finish(GrGLuint* outProgramId) {
-    GrGLuint programId = 0;
+bool GrGLShaderBuilder::finish(const GrGLProgramDesc& desc, GrGLuint* outProgramId) {
+    // A program prelinked from the manifest was loaded from a binary, as below, ahead of time.
+    GrGLuint programId = fGpu->takePrelinkedProgram(desc);
+    if (0 != programId) {
+        fUniformManager.getUniformLocations(programId, fUniforms);
+        *outProgramId = programId;
+        return true;
+    }
+
     GL_CALL_RET(programId, CreateProgram());
     if (!programId) {
         return false;
     }
 
+    GrGLProgramBinaryCache* binaryCache = fGpu->programBinaryCache();
+    if (NULL != binaryCache &&
+        binaryCache->loadProgram(fGpu->glInterface(), fGpu->programBinaryDriverID(), desc,
+                                 programId)) {
+        // The attribute, output and (if used) uniform bindings are part of the binary. The
+        // uniform manager still has to learn the locations.
+        fUniformManager.getUniformLocations(programId, fUniforms);
+        *outProgramId = programId;
+        return true;
+    }
+
     SkTDArray<GrGLuint> shadersToDelete;
 
     if (!this->compileAndAttachShaders(programId, &shadersToDelete)) {
@@ -588,6 +606,9 @@ bool GrGLShaderBuilder::finish(GrGLuint* outProgramId) {
       fUniformManager.getUniformLocations(programId, fUniforms);
     }
 
+    if (NULL != binaryCache) {
+        binaryCache->willLinkProgram(fGpu->glInterface(), programId);
+    }
     GL_CALL(LinkProgram(programId));
 
     // Calling GetProgramiv is expensive in Chromium. Assume success in release builds.
@@ -626,6 +647,11 @@ bool GrGLShaderBuilder::finish(GrGLuint* outProgramId) {
       GL_CALL(DeleteShader(shadersToDelete[i]));
     }
 
+    if (NULL != binaryCache) {
+        binaryCache->storeProgram(fGpu->glInterface(), fGpu->programBinaryDriverID(), desc,
+                                  programId);
+    }
+
     *outProgramId = programId;
     return true;
 }
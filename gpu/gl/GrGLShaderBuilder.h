@@ -204,7 +204,11 @@ public:
         return fDstCopySamplerUniform;
     }
 
-    bool finish(GrGLuint* outProgramId);
+    /**
+     * Compiles and links the program. If the GrGpuGL has a program binary cache, the linked
+     * program is loaded from it when possible and stored into it otherwise.
+     */
+    bool finish(const GrGLProgramDesc& desc, GrGLuint* outProgramId);
 
     const GrGLContextInfo& ctxInfo() const;
 
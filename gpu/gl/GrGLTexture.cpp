@@ -7,11 +7,35 @@
 
 #include "GrGLTexture.h"
 #include "GrGpuGL.h"
+#include "GrSharedTextures.h"
 
 #define GPUGL static_cast<GrGpuGL*>(getGpu())
 
 #define GL_CALL(X) GR_GL_CALL(GPUGL->glInterface(), X)
 
+GrGLTexID::~GrGLTexID() {
+    if (0 == fTexID) {
+        return;
+    }
+    if (NULL != fSharedEntry) {
+        // Other contexts may still draw with it, wrapped or not.
+        if (GrSharedTextures::Release(fSharedEntry)) {
+            fGpu->deleteTextureID(fTexID);
+        }
+    } else if (!fIsWrapped) {
+        fGpu->deleteTextureID(fTexID);
+    }
+}
+
+void GrGLTexID::abandon() {
+    // Nothing can be deleted in a lost context, but the rest of the group still counts holders.
+    if (NULL != fSharedEntry) {
+        GrSharedTextures::Release(fSharedEntry);
+        fSharedEntry = NULL;
+    }
+    fTexID = 0;
+}
+
 void GrGLTexture::init(GrGpuGL* gpu,
                        const Desc& textureDesc,
                        const GrGLRenderTarget::Desc* rtDesc) {
@@ -20,7 +44,7 @@ void GrGLTexture::init(GrGpuGL* gpu,
 
     fTexParams.invalidate();
     fTexParamsTimestamp = GrGpu::kExpiredTimestamp;
-    fTexIDObj.reset(SkNEW_ARGS(GrGLTexID, (GPUGL->glInterface(),
+    fTexIDObj.reset(SkNEW_ARGS(GrGLTexID, (gpu,
                                            textureDesc.fTextureID,
                                            textureDesc.fIsWrapped)));
 
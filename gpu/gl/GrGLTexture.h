@@ -13,31 +13,36 @@
 #include "GrGLRenderTarget.h"
 
 /**
- * A ref counted tex id that deletes the texture in its destructor.
+ * A ref counted tex id that deletes the texture (through its GrGpuGL) in its destructor. A tex
+ * id with a GrSharedTextures entry only deletes the texture if it is its last holder.
  */
 class GrGLTexID : public SkRefCnt {
 public:
     SK_DECLARE_INST_COUNT(GrGLTexID)
 
-    GrGLTexID(const GrGLInterface* gl, GrGLuint texID, bool isWrapped)
-        : fGL(gl)
+    GrGLTexID(GrGpuGL* gpu, GrGLuint texID, bool isWrapped)
+        : fGpu(gpu)
         , fTexID(texID)
-        , fIsWrapped(isWrapped) {
+        , fIsWrapped(isWrapped)
+        , fSharedEntry(NULL) {
     }
 
-    virtual ~GrGLTexID() {
-        if (0 != fTexID && !fIsWrapped) {
-            GR_GL_CALL(fGL, DeleteTextures(1, &fTexID));
-        }
-    }
+    // Hands the ID to the GrGpuGL to be deleted with the next batch.
+    virtual ~GrGLTexID();
 
-    void abandon() { fTexID = 0; }
+    void abandon();
     GrGLuint id() const { return fTexID; }
 
+    void setSharedEntry(GrSharedTextureEntry* entry) {
+        SkASSERT(NULL == fSharedEntry);
+        fSharedEntry = entry;
+    }
+
 private:
-    const GrGLInterface* fGL;
-    GrGLuint             fTexID;
-    bool                 fIsWrapped;
+    GrGpuGL*                fGpu;
+    GrGLuint                fTexID;
+    bool                    fIsWrapped;
+    GrSharedTextureEntry*   fSharedEntry;
 
     typedef SkRefCnt INHERITED;
 };
@@ -91,6 +96,9 @@ public:
 
     GrGLuint textureID() const { return (NULL != fTexIDObj.get()) ? fTexIDObj->id() : 0; }
 
+    // See GrGpu::attachSharedTexture().
+    void setSharedEntry(GrSharedTextureEntry* entry) { fTexIDObj->setSharedEntry(entry); }
+
 protected:
     // overrides of GrTexture
     virtual void onAbandon() SK_OVERRIDE;
@@ -20,6 +20,28 @@ GrGLUniformManager::GrGLUniformManager(GrGpuGL* gpu) : fGpu(gpu) {
     fUsingBindUniform = fGpu->glInterface()->fFunctions.fBindUniformLocation != NULL;
 }
 
+// The number of 32 bit words in an element of a uniform of the type.
+static int uniform_word_count(GrSLType type) {
+    switch (type) {
+        case kFloat_GrSLType:
+        case kSampler2D_GrSLType:
+            return 1;
+        case kVec2f_GrSLType:
+            return 2;
+        case kVec3f_GrSLType:
+            return 3;
+        case kVec4f_GrSLType:
+            return 4;
+        case kMat33f_GrSLType:
+            return 9;
+        case kMat44f_GrSLType:
+            return 16;
+        default:
+            SkFAIL("Unexpected uniform type.");
+            return 0;
+    }
+}
+
 GrGLUniformManager::UniformHandle GrGLUniformManager::appendUniform(GrSLType type, int arrayCount) {
     int idx = fUniforms.count();
     Uniform& uni = fUniforms.push_back();
@@ -28,9 +50,25 @@ GrGLUniformManager::UniformHandle GrGLUniformManager::appendUniform(GrSLType typ
     uni.fType = type;
     uni.fVSLocation = kUnusedUniform;
     uni.fFSLocation = kUnusedUniform;
+    uni.fShadowOffset = fShadow.count();
+    uni.fShadowCount = 0;
+    fShadow.append(uniform_word_count(type) * SkTMax(arrayCount, 1));
     return GrGLUniformManager::UniformHandle::CreateFromUniformIndex(idx);
 }
 
+bool GrGLUniformManager::updateShadow(const Uniform& uni, int arrayCount,
+                                      const void* values) const {
+    size_t size = uniform_word_count(uni.fType) * arrayCount * sizeof(uint32_t);
+    uint32_t* shadow = fShadow.begin() + uni.fShadowOffset;
+    if (arrayCount <= uni.fShadowCount && 0 == memcmp(shadow, values, size)) {
+        return false;
+    }
+    memcpy(shadow, values, size);
+    // Only the uploaded elements are known; a longer upload later has to go through.
+    uni.fShadowCount = SkTMax(uni.fShadowCount, arrayCount);
+    return true;
+}
+
 void GrGLUniformManager::setSampler(UniformHandle u, GrGLint texUnit) const {
     const Uniform& uni = fUniforms[u.toUniformIndex()];
     SkASSERT(uni.fType == kSampler2D_GrSLType);
@@ -39,6 +77,9 @@ void GrGLUniformManager::setSampler(UniformHandle u, GrGLint texUnit) const {
     // reference the sampler then the compiler may have optimized it out. Uncomment this assert
     // once stages insert their own samplers.
     // SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, 1, &texUnit)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform1i(uni.fFSLocation, texUnit));
     }
@@ -52,6 +93,10 @@ void GrGLUniformManager::set1f(UniformHandle u, GrGLfloat v0) const {
     SkASSERT(uni.fType == kFloat_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    const GrGLfloat v[] = { v0 };
+    if (!this->updateShadow(uni, 1, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform1f(uni.fFSLocation, v0));
     }
@@ -71,6 +116,9 @@ void GrGLUniformManager::set1fv(UniformHandle u,
     // Once the uniform manager is responsible for inserting the duplicate uniform
     // arrays in VS and FS driver bug workaround, this can be enabled.
     //SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, arrayCount, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform1fv(uni.fFSLocation, arrayCount, v));
     }
@@ -84,6 +132,10 @@ void GrGLUniformManager::set2f(UniformHandle u, GrGLfloat v0, GrGLfloat v1) cons
     SkASSERT(uni.fType == kVec2f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    const GrGLfloat v[] = { v0, v1 };
+    if (!this->updateShadow(uni, 1, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform2f(uni.fFSLocation, v0, v1));
     }
@@ -100,6 +152,9 @@ void GrGLUniformManager::set2fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, arrayCount, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform2fv(uni.fFSLocation, arrayCount, v));
     }
@@ -113,6 +168,10 @@ void GrGLUniformManager::set3f(UniformHandle u, GrGLfloat v0, GrGLfloat v1, GrGL
     SkASSERT(uni.fType == kVec3f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    const GrGLfloat v[] = { v0, v1, v2 };
+    if (!this->updateShadow(uni, 1, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform3f(uni.fFSLocation, v0, v1, v2));
     }
@@ -129,6 +188,9 @@ void GrGLUniformManager::set3fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, arrayCount, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform3fv(uni.fFSLocation, arrayCount, v));
     }
@@ -146,6 +208,10 @@ void GrGLUniformManager::set4f(UniformHandle u,
     SkASSERT(uni.fType == kVec4f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    const GrGLfloat v[] = { v0, v1, v2, v3 };
+    if (!this->updateShadow(uni, 1, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform4f(uni.fFSLocation, v0, v1, v2, v3));
     }
@@ -162,6 +228,9 @@ void GrGLUniformManager::set4fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, arrayCount, v)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), Uniform4fv(uni.fFSLocation, arrayCount, v));
     }
@@ -176,6 +245,9 @@ void GrGLUniformManager::setMatrix3f(UniformHandle u, const GrGLfloat matrix[])
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     // TODO: Re-enable this assert once texture matrices aren't forced on all effects
     // SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, 1, matrix)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), UniformMatrix3fv(uni.fFSLocation, 1, false, matrix));
     }
@@ -189,6 +261,9 @@ void GrGLUniformManager::setMatrix4f(UniformHandle u, const GrGLfloat matrix[])
     SkASSERT(uni.fType == kMat44f_GrSLType);
     SkASSERT(GrGLShaderVar::kNonArray == uni.fArrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, 1, matrix)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(), UniformMatrix4fv(uni.fFSLocation, 1, false, matrix));
     }
@@ -205,6 +280,9 @@ void GrGLUniformManager::setMatrix3fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, arrayCount, matrices)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(),
                    UniformMatrix3fv(uni.fFSLocation, arrayCount, false, matrices));
@@ -223,6 +301,9 @@ void GrGLUniformManager::setMatrix4fv(UniformHandle u,
     SkASSERT(arrayCount > 0);
     ASSERT_ARRAY_UPLOAD_IN_BOUNDS(uni, arrayCount);
     SkASSERT(kUnusedUniform != uni.fFSLocation || kUnusedUniform != uni.fVSLocation);
+    if (!this->updateShadow(uni, arrayCount, matrices)) {
+        return;
+    }
     if (kUnusedUniform != uni.fFSLocation) {
         GR_GL_CALL(fGpu->glInterface(),
                    UniformMatrix4fv(uni.fFSLocation, arrayCount, false, matrices));
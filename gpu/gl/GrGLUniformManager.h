@@ -13,11 +13,16 @@
 #include "GrAllocator.h"
 
 #include "SkTArray.h"
+#include "SkTDArray.h"
 
 class GrGpuGL;
 class SkMatrix;
 
 /** Manages a program's uniforms.
+
+    The manager keeps a copy of the last value uploaded to each uniform and skips uploads that
+    wouldn't change it. Uniform values belong to the GL program object, which only this manager
+    sets them on, so the copies stay in step with GL for the life of the program.
 */
 class GrGLUniformManager {
 public:
@@ -108,10 +113,22 @@ private:
         GrGLint     fFSLocation;
         GrSLType    fType;
         int         fArrayCount;
+        int         fShadowOffset;  // index of the uniform's values in fShadow
+        mutable int fShadowCount;   // number of array elements uploaded so far
     };
 
+    /**
+     * Compares the first arrayCount elements of the uniform with its shadow copy. Returns false
+     * if they are unchanged and the upload can be skipped, otherwise updates the copy and
+     * returns true.
+     */
+    bool updateShadow(const Uniform&, int arrayCount, const void* values) const;
+
     bool fUsingBindUniform;
     SkTArray<Uniform, true> fUniforms;
+    // 32 bit words holding the last values uploaded to the uniforms, GrGLfloats for all but the
+    // samplers, which hold GrGLints.
+    mutable SkTDArray<uint32_t> fShadow;
     GrGpuGL* fGpu;
 };
 
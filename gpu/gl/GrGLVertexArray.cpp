@@ -7,6 +7,7 @@
 
 #include "GrGLVertexArray.h"
 #include "GrGpuGL.h"
+#include "SkChecksum.h"
 
 #define GPUGL static_cast<GrGpuGL*>(this->getGpu())
 #define GL_CALL(X) GR_GL_CALL(GPUGL->glInterface(), X);
@@ -120,3 +121,92 @@ void GrGLVertexArray::invalidateCachedState() {
     fAttribArrays.invalidate();
     fIndexBufferIDIsValid = false;
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct GrGLVertexArrayCache::Entry {
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
+
+    Entry(const Key& key, GrGLVertexArray* array) : fKey(key), fArray(array) {}
+
+    static const Key& GetKey(const Entry& entry) { return entry.fKey; }
+    static uint32_t Hash(const Key& key) {
+        return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(&key), sizeof(key));
+    }
+
+    Key                             fKey;
+    SkAutoTUnref<GrGLVertexArray>   fArray;
+};
+
+GrGLVertexArrayCache::GrGLVertexArrayCache() {}
+
+GrGLVertexArrayCache::~GrGLVertexArrayCache() {
+    // The arrays are GrGpuObjects, so the GrGpu releases or abandons any that are still alive.
+    while (Entry* entry = fLRU.head()) {
+        fLRU.remove(entry);
+        fHash.remove(Entry::GetKey(*entry));
+        SkDELETE(entry);
+    }
+}
+
+void GrGLVertexArrayCache::remove(Entry* entry) {
+    fLRU.remove(entry);
+    fHash.remove(Entry::GetKey(*entry));
+    // Deleting the array calls back into GrGpuGL, so take it out of the cache first.
+    entry->fArray->release();
+    SkDELETE(entry);
+}
+
+GrGLVertexArray* GrGLVertexArrayCache::find(GrGpuGL* gpu,
+                                            GrGLuint vertexBufferID,
+                                            GrGLuint indexBufferID) {
+    Key key;
+    key.fVertexBufferID = vertexBufferID;
+    key.fIndexBufferID = indexBufferID;
+
+    Entry* entry = fHash.find(key);
+    if (NULL != entry && entry->fArray->wasDestroyed()) {
+        // The context was abandoned since the array was made.
+        this->remove(entry);
+        entry = NULL;
+    }
+    if (NULL != entry) {
+        if (fLRU.head() != entry) {
+            fLRU.remove(entry);
+            fLRU.addToHead(entry);
+        }
+        return entry->fArray;
+    }
+
+    GrGLuint arrayID = 0;
+    GR_GL_CALL(gpu->glInterface(), GenVertexArrays(1, &arrayID));
+    if (0 == arrayID) {
+        return NULL;
+    }
+    int attrCount = gpu->glCaps().maxVertexAttributes();
+    entry = SkNEW_ARGS(Entry, (key, SkNEW_ARGS(GrGLVertexArray, (gpu, arrayID, attrCount))));
+    fHash.add(entry);
+    fLRU.addToHead(entry);
+    if (fHash.count() > kMaxCount) {
+        this->remove(fLRU.tail());
+    }
+    return entry->fArray;
+}
+
+void GrGLVertexArrayCache::invalidateCachedState() {
+    for (SkTDynamicHash<Entry, Key>::Iter iter(&fHash); !iter.done(); ++iter) {
+        (*iter).fArray->invalidateCachedState();
+    }
+}
+
+void GrGLVertexArrayCache::notifyBufferDelete(GrGLuint id) {
+    SkTDArray<Entry*> stale;
+    for (SkTDynamicHash<Entry, Key>::Iter iter(&fHash); !iter.done(); ++iter) {
+        if ((*iter).fKey.fVertexBufferID == id || (*iter).fKey.fIndexBufferID == id) {
+            *stale.append() = &(*iter);
+        }
+    }
+    for (int i = 0; i < stale.count(); ++i) {
+        this->remove(stale[i]);
+    }
+}
@@ -14,6 +14,8 @@
 #include "gl/GrGLFunctions.h"
 
 #include "SkTArray.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
 
 class GrGLVertexBuffer;
 class GrGLIndexBuffer;
@@ -173,4 +175,52 @@ private:
     typedef GrGpuObject INHERITED;
 };
 
+/**
+ * The vertex arrays GrGpuGL draws from VBOs with, one for each pair of vertex and index buffer.
+ * Each array keeps its index buffer binding and the attrib pointers last set on it, so drawing
+ * again from buffers that were drawn from before, with the same layout, takes only a
+ * glBindVertexArray. Past a fixed number of arrays the least recently used one is deleted.
+ */
+class GrGLVertexArrayCache : public SkNoncopyable {
+public:
+    enum {
+        kMaxCount = 64,
+    };
+
+    GrGLVertexArrayCache();
+    ~GrGLVertexArrayCache();
+
+    /**
+     * Returns the vertex array for the buffers, creating it if there is none. indexBufferID is 0
+     * for non-indexed draws. Returns NULL if the array can't be created.
+     */
+    GrGLVertexArray* find(GrGpuGL*, GrGLuint vertexBufferID, GrGLuint indexBufferID);
+
+    void invalidateCachedState();
+
+    /**
+     * Deletes the arrays the buffer is bound to. Vertex and index buffers share a namespace, so
+     * this serves for both.
+     */
+    void notifyBufferDelete(GrGLuint id);
+
+private:
+    struct Key {
+        GrGLuint    fVertexBufferID;
+        GrGLuint    fIndexBufferID;
+
+        bool operator==(const Key& that) const {
+            return fVertexBufferID == that.fVertexBufferID &&
+                   fIndexBufferID == that.fIndexBufferID;
+        }
+    };
+    struct Entry;
+
+    void remove(Entry*);
+
+    SkTDynamicHash<Entry, Key>  fHash;
+    // Most recently used at the head.
+    SkTInternalLList<Entry>     fLRU;
+};
+
 #endif
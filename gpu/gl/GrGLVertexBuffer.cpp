@@ -35,6 +35,14 @@ void* GrGLVertexBuffer::lock() {
     }
 }
 
+void* GrGLVertexBuffer::lockRange(size_t offset, size_t size) {
+    if (!this->wasDestroyed()) {
+        return fImpl.lockRange(this->getGpuGL(), offset, size);
+    } else {
+        return NULL;
+    }
+}
+
 void* GrGLVertexBuffer::lockPtr() const {
     return fImpl.lockPtr();
 }
@@ -12,6 +12,7 @@
 #include "GrGLShaderBuilder.h"
 #include "GrTemplates.h"
 #include "GrTypes.h"
+#include "SkStats.h"
 #include "SkStrokeRec.h"
 #include "SkTemplates.h"
 
@@ -114,7 +115,8 @@ static bool gPrintStartupSpew;
 
 GrGpuGL::GrGpuGL(const GrGLContext& ctx, GrContext* context)
     : GrGpu(context)
-    , fGLContext(ctx) {
+    , fGLContext(ctx)
+    , fTexParamsTimestamp(kExpiredTimestamp) {
 
     SkASSERT(ctx.isInitialized());
     fCaps.reset(SkRef(ctx.caps()));
@@ -144,11 +146,17 @@ GrGpuGL::GrGpuGL(const GrGLContext& ctx, GrContext* context)
     }
 
     fProgramCache = SkNEW_ARGS(ProgramCache, (this));
+    fProgramBinaryCache.reset(GrGLProgramBinaryCache::RefDefault());
+    if (NULL != fProgramBinaryCache.get()) {
+        GrGLProgramBinaryCache::GetDriverID(this->glInterface(), &fProgramBinaryDriverID);
+    }
+    fProgramManifest.reset(GrGLProgramManifest::RefDefault());
 
     SkASSERT(this->glCaps().maxVertexAttributes() >= GrDrawState::kMaxVertexAttribCnt);
 
     fLastSuccessfulStencilFmtIdx = 0;
     fHWProgramID = 0;
+    fUnpackBufferID = 0;
 }
 
 GrGpuGL::~GrGpuGL() {
@@ -161,11 +169,24 @@ GrGpuGL::~GrGpuGL() {
 
     delete fProgramCache;
 
+    for (int i = 0; i < fPrelinkedPrograms.count(); ++i) {
+        GL_CALL(DeleteProgram(fPrelinkedPrograms[i].fProgramID));
+    }
+
+    if (0 != fUnpackBufferID) {
+        GL_CALL(DeleteBuffers(1, &fUnpackBufferID));
+    }
+
+    // The timer deletes its queries, so it must go while the interface is still around.
+    fGpuTimer.free();
+
     // This must be called by before the GrDrawTarget destructor
     this->releaseGeometry();
     // This subclass must do this before the base class destructor runs
     // since we will unref the GrGLInterface.
     this->releaseResources();
+    // Releasing the textures queued their IDs.
+    this->flushPendingTextureDeletes();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -275,6 +296,8 @@ void GrGpuGL::onResetContext(uint32_t resetBits) {
         for (int s = 0; s < fHWBoundTextures.count(); ++s) {
             fHWBoundTextures[s] = NULL;
         }
+        // The client can only have changed the parameters of our textures by binding them.
+        ++fTexParamsTimestamp;
     }
 
     if (resetBits & kBlend_GrGLBackendState) {
@@ -330,6 +353,12 @@ void GrGpuGL::onResetContext(uint32_t resetBits) {
         if (this->glCaps().packFlipYSupport()) {
             GL_CALL(PixelStorei(GR_GL_PACK_REVERSE_ROW_ORDER, GR_GL_FALSE));
         }
+        if (this->glCaps().unpackPixelBufferSupport()) {
+            GL_CALL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, 0));
+        }
+        if (this->glCaps().packPixelBufferSupport()) {
+            GL_CALL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, 0));
+        }
     }
 
     if (resetBits & kProgram_GrGLBackendState) {
@@ -513,6 +542,29 @@ bool adjust_pixel_ops_params(int surfaceWidth,
     return true;
 }
 
+// Staging an upload in a pixel buffer costs a map and a copy, which only pays
+// off once the transfer itself is big enough to stall on.
+static const size_t kMinUnpackBufferUploadSize = 16 * 1024;
+
+// Copies height rows of trimRowBytes each from src, flipping the rows if asked.
+void copy_pixel_rows(void* dst, const void* src, size_t rowBytes, size_t trimRowBytes,
+                     int height, bool flipY) {
+    const char* srcRow = (const char*)src;
+    if (flipY) {
+        srcRow += (height - 1) * rowBytes;
+    }
+    char* dstRow = (char*)dst;
+    for (int y = 0; y < height; y++) {
+        memcpy(dstRow, srcRow, trimRowBytes);
+        if (flipY) {
+            srcRow -= rowBytes;
+        } else {
+            srcRow += rowBytes;
+        }
+        dstRow += trimRowBytes;
+    }
+}
+
 GrGLenum check_alloc_error(const GrTextureDesc& desc, const GrGLInterface* interface) {
     if (SkToBool(desc.fFlags & kCheckAllocation_GrTextureFlagBit)) {
         return GR_GL_GET_ERROR(interface);
@@ -537,6 +589,7 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
         return false;
     }
     size_t trimRowBytes = width * bpp;
+    const bool hasPixels = NULL != data;
 
     // in case we need a temporary, trimmed copy of the src pixels
     SkAutoSMalloc<128 * 128> tempStorage;
@@ -585,6 +638,7 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
     bool restoreGLRowLength = false;
     bool swFlipY = false;
     bool glFlipY = false;
+    bool useUnpackBuffer = false;
     if (NULL != data) {
         if (kBottomLeft_GrSurfaceOrigin == desc.fOrigin) {
             if (this->glCaps().unpackFlipYSupport()) {
@@ -593,7 +647,24 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
                 swFlipY = true;
             }
         }
-        if (this->glCaps().unpackRowLengthSupport() && !swFlipY) {
+        size_t trimSize = height * trimRowBytes;
+        // Stage large uploads in the unpack buffer. Paletted data is left alone
+        // since glCompressedTexImage2D needs the color table in front of it.
+        void* unpackBufferData = NULL;
+        if (trimSize >= kMinUnpackBufferUploadSize && GR_GL_PALETTE8_RGBA8 != internalFormat) {
+            unpackBufferData = this->mapUnpackBuffer(trimSize);
+        }
+        if (NULL != unpackBufferData) {
+            // Copy the trimmed (and if need be flipped) rows into the buffer. GL
+            // then sources the pixels from the buffer, so the glTex[Sub]Image2D
+            // call below returns without waiting for the transfer.
+            copy_pixel_rows(unpackBufferData, data, rowBytes, trimRowBytes, height, swFlipY);
+            useUnpackBuffer = this->unmapUnpackBuffer();
+        }
+        if (useUnpackBuffer) {
+            // With a buffer bound, the data pointer is an offset into it.
+            data = NULL;
+        } else if (this->glCaps().unpackRowLengthSupport() && !swFlipY) {
             // can't use this for flipping, only non-neg values allowed. :(
             if (rowBytes != trimRowBytes) {
                 GrGLint rowLength = static_cast<GrGLint>(rowBytes / bpp);
@@ -603,21 +674,8 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
         } else {
             if (trimRowBytes != rowBytes || swFlipY) {
                 // copy data into our new storage, skipping the trailing bytes
-                size_t trimSize = height * trimRowBytes;
-                const char* src = (const char*)data;
-                if (swFlipY) {
-                    src += (height - 1) * rowBytes;
-                }
-                char* dst = (char*)tempStorage.reset(trimSize);
-                for (int y = 0; y < height; y++) {
-                    memcpy(dst, src, trimRowBytes);
-                    if (swFlipY) {
-                        src -= rowBytes;
-                    } else {
-                        src += rowBytes;
-                    }
-                    dst += trimRowBytes;
-                }
+                void* dst = tempStorage.reset(trimSize);
+                copy_pixel_rows(dst, data, rowBytes, trimRowBytes, height, swFlipY);
                 // now point data to our copied version
                 data = tempStorage.get();
             }
@@ -668,7 +726,7 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
         } else {
             // if we have data and we used TexStorage to create the texture, we
             // now upload with TexSubImage.
-            if (NULL != data && useTexStorage) {
+            if ((NULL != data || useUnpackBuffer) && useTexStorage) {
                 GL_CALL(TexSubImage2D(GR_GL_TEXTURE_2D,
                                       0, // level
                                       left, top,
@@ -692,12 +750,65 @@ bool GrGpuGL::uploadTexData(const GrGLTexture::Desc& desc,
         SkASSERT(this->glCaps().unpackRowLengthSupport());
         GL_CALL(PixelStorei(GR_GL_UNPACK_ROW_LENGTH, 0));
     }
+    if (useUnpackBuffer) {
+        GL_CALL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, 0));
+    }
     if (glFlipY) {
         GL_CALL(PixelStorei(GR_GL_UNPACK_FLIP_Y, GR_GL_FALSE));
     }
+    if (succeeded && hasPixels) {
+        SK_STATS_INC(kGrTextureUpload_Counter);
+        SK_STATS_ADD(kGrTextureUploadBytes_Counter, trimRowBytes * height);
+    }
     return succeeded;
 }
 
+void* GrGpuGL::mapUnpackBuffer(size_t size) {
+    if (!this->glCaps().unpackPixelBufferSupport()) {
+        return NULL;
+    }
+    // GL_CHROMIUM_map_sub maps a copy that is only sent on unmap, which gains nothing.
+    GrGLCaps::MapBufferType mapType = this->glCaps().mapBufferType();
+    if (GrGLCaps::kMapBuffer_MapBufferType != mapType &&
+        GrGLCaps::kMapBufferRange_MapBufferType != mapType) {
+        return NULL;
+    }
+    if (0 == fUnpackBufferID) {
+        GL_CALL(GenBuffers(1, &fUnpackBufferID));
+        if (0 == fUnpackBufferID) {
+            return NULL;
+        }
+    }
+
+    GL_CALL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, fUnpackBufferID));
+    // Respecifying the storage orphans whatever a previous upload may still be
+    // reading, so mapping never waits on it.
+    GL_CALL(BufferData(GR_GL_PIXEL_UNPACK_BUFFER, size, NULL, GR_GL_STREAM_DRAW));
+    void* ptr;
+    if (GrGLCaps::kMapBufferRange_MapBufferType == mapType) {
+        static const GrGLbitfield kAccess = GR_GL_MAP_INVALIDATE_BUFFER_BIT |
+                                            GR_GL_MAP_WRITE_BIT;
+        GL_CALL_RET(ptr, MapBufferRange(GR_GL_PIXEL_UNPACK_BUFFER, 0, size, kAccess));
+    } else {
+        GL_CALL_RET(ptr, MapBuffer(GR_GL_PIXEL_UNPACK_BUFFER, GR_GL_WRITE_ONLY));
+    }
+    if (NULL == ptr) {
+        GL_CALL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, 0));
+    }
+    return ptr;
+}
+
+bool GrGpuGL::unmapUnpackBuffer() {
+    GrGLboolean unmapped;
+    GL_CALL_RET(unmapped, UnmapBuffer(GR_GL_PIXEL_UNPACK_BUFFER));
+    if (GR_GL_TRUE != unmapped) {
+        // The contents were lost (e.g. to a mode switch). Fall back to client memory.
+        GL_CALL(BindBuffer(GR_GL_PIXEL_UNPACK_BUFFER, 0));
+        return false;
+    }
+    return true;
+}
+
 static bool renderbuffer_storage_msaa(GrGLContext& ctx,
                                       int sampleCount,
                                       GrGLenum format,
@@ -969,7 +1080,7 @@ GrTexture* GrGpuGL::onCreateTexture(const GrTextureDesc& desc,
     } else {
         tex = SkNEW_ARGS(GrGLTexture, (this, glTexDesc));
     }
-    tex->setCachedTexParams(initialTexParams, this->getResetTimestamp());
+    tex->setCachedTexParams(initialTexParams, fTexParamsTimestamp);
 #ifdef TRACE_TEXTURE_CREATION
     GrPrintf("--- new texture [%d] size=(%d %d) config=%d\n",
              glTexDesc.fTextureID, desc.fWidth, desc.fHeight, desc.fConfig);
@@ -1426,6 +1537,27 @@ bool GrGpuGL::readPixelsWillPayForYFlip(GrRenderTarget* renderTarget,
     }
 }
 
+bool GrGpuGL::bindRenderTargetForRead(GrGLRenderTarget* tgt) {
+    switch (tgt->getResolveType()) {
+        case GrGLRenderTarget::kCantResolve_ResolveType:
+            return false;
+        case GrGLRenderTarget::kAutoResolves_ResolveType: {
+            GrDrawState::AutoRenderTargetRestore artr(this->drawState(), tgt);
+            this->flushRenderTarget(&SkIRect::EmptyIRect());
+            break;
+        }
+        case GrGLRenderTarget::kCanResolve_ResolveType:
+            this->onResolveRenderTarget(tgt);
+            // we don't track the state of the READ FBO ID.
+            GL_CALL(BindFramebuffer(GR_GL_READ_FRAMEBUFFER,
+                                    tgt->textureFBOID()));
+            break;
+        default:
+            SkFAIL("Unknown resolve type");
+    }
+    return true;
+}
+
 bool GrGpuGL::onReadPixels(GrRenderTarget* target,
                            int left, int top,
                            int width, int height,
@@ -1448,22 +1580,8 @@ bool GrGpuGL::onReadPixels(GrRenderTarget* target,
 
     // resolve the render target if necessary
     GrGLRenderTarget* tgt = static_cast<GrGLRenderTarget*>(target);
-    GrDrawState::AutoRenderTargetRestore artr;
-    switch (tgt->getResolveType()) {
-        case GrGLRenderTarget::kCantResolve_ResolveType:
-            return false;
-        case GrGLRenderTarget::kAutoResolves_ResolveType:
-            artr.set(this->drawState(), target);
-            this->flushRenderTarget(&SkIRect::EmptyIRect());
-            break;
-        case GrGLRenderTarget::kCanResolve_ResolveType:
-            this->onResolveRenderTarget(tgt);
-            // we don't track the state of the READ FBO ID.
-            GL_CALL(BindFramebuffer(GR_GL_READ_FRAMEBUFFER,
-                                    tgt->textureFBOID()));
-            break;
-        default:
-            SkFAIL("Unknown resolve type");
+    if (!this->bindRenderTargetForRead(tgt)) {
+        return false;
     }
 
     const GrGLIRect& glvp = tgt->getViewport();
@@ -1550,6 +1668,72 @@ bool GrGpuGL::onReadPixels(GrRenderTarget* target,
     return true;
 }
 
+bool GrGpuGL::readPixelsToPackBuffer(GrRenderTarget* target,
+                                     int left, int top, int width, int height,
+                                     GrPixelConfig config,
+                                     GrGLuint bufferID,
+                                     bool* flipY) {
+    SkASSERT(this->glCaps().packPixelBufferSupport());
+    GrGLenum format;
+    GrGLenum type;
+    if (!this->configToGLFormats(config, false, NULL, &format, &type)) {
+        return false;
+    }
+    if (width <= 0 || height <= 0 || left < 0 || top < 0 ||
+        left + width > target->width() || top + height > target->height()) {
+        return false;
+    }
+
+    GrGLRenderTarget* tgt = static_cast<GrGLRenderTarget*>(target);
+    if (!this->bindRenderTargetForRead(tgt)) {
+        return false;
+    }
+
+    GrGLIRect readRect;
+    readRect.setRelativeTo(tgt->getViewport(), left, top, width, height, target->origin());
+
+    *flipY = kBottomLeft_GrSurfaceOrigin == target->origin();
+    bool glFlipY = *flipY && this->glCaps().packFlipYSupport();
+    if (glFlipY) {
+        GL_CALL(PixelStorei(GR_GL_PACK_REVERSE_ROW_ORDER, 1));
+        *flipY = false;
+    }
+    size_t size = GrBytesPerPixel(config) * width * height;
+    GL_CALL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, bufferID));
+    // Fresh storage, so a map of what the buffer held before doesn't hold up the read.
+    GL_CALL(BufferData(GR_GL_PIXEL_PACK_BUFFER, size, NULL, GR_GL_STREAM_READ));
+    GL_CALL(ReadPixels(readRect.fLeft, readRect.fBottom,
+                       readRect.fWidth, readRect.fHeight,
+                       format, type, NULL));
+    GL_CALL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, 0));
+    if (glFlipY) {
+        GL_CALL(PixelStorei(GR_GL_PACK_REVERSE_ROW_ORDER, 0));
+    }
+    return true;
+}
+
+const void* GrGpuGL::mapPackBuffer(GrGLuint bufferID, size_t size) {
+    SkASSERT(this->glCaps().packPixelBufferSupport());
+    GL_CALL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, bufferID));
+    void* ptr;
+    if (GrGLCaps::kMapBufferRange_MapBufferType == this->glCaps().mapBufferType()) {
+        GL_CALL_RET(ptr, MapBufferRange(GR_GL_PIXEL_PACK_BUFFER, 0, size, GR_GL_MAP_READ_BIT));
+    } else {
+        GL_CALL_RET(ptr, MapBuffer(GR_GL_PIXEL_PACK_BUFFER, GR_GL_READ_ONLY));
+    }
+    if (NULL == ptr) {
+        GL_CALL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, 0));
+    }
+    return ptr;
+}
+
+bool GrGpuGL::unmapPackBuffer() {
+    GrGLboolean unmapped;
+    GL_CALL_RET(unmapped, UnmapBuffer(GR_GL_PIXEL_PACK_BUFFER));
+    GL_CALL(BindBuffer(GR_GL_PIXEL_PACK_BUFFER, 0));
+    return GR_GL_TRUE == unmapped;
+}
+
 void GrGpuGL::flushRenderTarget(const SkIRect* bound) {
 
     GrGLRenderTarget* rt =
@@ -2140,7 +2324,7 @@ void GrGpuGL::bindTexture(int unitIdx, const GrTextureParams& params, GrGLTextur
 
     ResetTimestamp timestamp;
     const GrGLTexture::TexParams& oldTexParams = texture->getCachedTexParams(&timestamp);
-    bool setAll = timestamp < this->getResetTimestamp();
+    bool setAll = timestamp < fTexParamsTimestamp;
     GrGLTexture::TexParams newTexParams;
 
     static GrGLenum glMinFilterModes[] = {
@@ -2162,6 +2346,8 @@ void GrGpuGL::bindTexture(int unitIdx, const GrTextureParams& params, GrGLTextur
 
     if (GrTextureParams::kMipMap_FilterMode == filterMode && texture->mipMapsAreDirty()) {
 //        GL_CALL(Hint(GR_GL_GENERATE_MIPMAP_HINT,GR_GL_NICEST));
+        // The texture is bound to unitIdx, but another unit may be the active one.
+        this->setTextureUnit(unitIdx);
         GL_CALL(GenerateMipmap(GR_GL_TEXTURE_2D));
         texture->dirtyMipMaps(false);
     }
@@ -2201,19 +2387,27 @@ void GrGpuGL::bindTexture(int unitIdx, const GrTextureParams& params, GrGLTextur
                           sizeof(newTexParams.fSwizzleRGBA)))) {
         this->setTextureUnit(unitIdx);
         if (this->glStandard() == kGLES_GrGLStandard) {
-            // ES3 added swizzle support but not GL_TEXTURE_SWIZZLE_RGBA.
+            // ES3 added swizzle support but not GL_TEXTURE_SWIZZLE_RGBA, so each component
+            // takes a call of its own. Only make the ones that change.
+            static const GrGLenum gSwizzleParams[] = {
+                GR_GL_TEXTURE_SWIZZLE_R,
+                GR_GL_TEXTURE_SWIZZLE_G,
+                GR_GL_TEXTURE_SWIZZLE_B,
+                GR_GL_TEXTURE_SWIZZLE_A,
+            };
             const GrGLenum* swizzle = newTexParams.fSwizzleRGBA;
-            GL_CALL(TexParameteri(GR_GL_TEXTURE_2D, GR_GL_TEXTURE_SWIZZLE_R, swizzle[0]));
-            GL_CALL(TexParameteri(GR_GL_TEXTURE_2D, GR_GL_TEXTURE_SWIZZLE_G, swizzle[1]));
-            GL_CALL(TexParameteri(GR_GL_TEXTURE_2D, GR_GL_TEXTURE_SWIZZLE_B, swizzle[2]));
-            GL_CALL(TexParameteri(GR_GL_TEXTURE_2D, GR_GL_TEXTURE_SWIZZLE_A, swizzle[3]));
+            for (int i = 0; i < 4; ++i) {
+                if (setAll || swizzle[i] != oldTexParams.fSwizzleRGBA[i]) {
+                    GL_CALL(TexParameteri(GR_GL_TEXTURE_2D, gSwizzleParams[i], swizzle[i]));
+                }
+            }
         } else {
             GR_STATIC_ASSERT(sizeof(newTexParams.fSwizzleRGBA[0]) == sizeof(GrGLint));
             const GrGLint* swizzle = reinterpret_cast<const GrGLint*>(newTexParams.fSwizzleRGBA);
             GL_CALL(TexParameteriv(GR_GL_TEXTURE_2D, GR_GL_TEXTURE_SWIZZLE_RGBA, swizzle));
         }
     }
-    texture->setCachedTexParams(newTexParams, this->getResetTimestamp());
+    texture->setCachedTexParams(newTexParams, fTexParamsTimestamp);
 }
 
 void GrGpuGL::setProjectionMatrix(const SkMatrix& matrix,
@@ -2373,12 +2567,28 @@ void GrGpuGL::notifyRenderTargetDelete(GrRenderTarget* renderTarget) {
 void GrGpuGL::notifyTextureDelete(GrGLTexture* texture) {
     for (int s = 0; s < fHWBoundTextures.count(); ++s) {
         if (fHWBoundTextures[s] == texture) {
-            // deleting bound texture does implied bind to 0
+            // deleting bound texture does implied bind to 0. Until the ID is really deleted
+            // it stays bound, but we'll bind over it before the unit is used again.
             fHWBoundTextures[s] = NULL;
        }
     }
 }
 
+void GrGpuGL::deleteTextureID(GrGLuint id) {
+    SkASSERT(0 != id);
+    *fPendingTextureDeletes.append() = id;
+    if (fPendingTextureDeletes.count() >= kMaxPendingTextureDeletes) {
+        this->flushPendingTextureDeletes();
+    }
+}
+
+void GrGpuGL::flushPendingTextureDeletes() {
+    if (!fPendingTextureDeletes.isEmpty()) {
+        GL_CALL(DeleteTextures(fPendingTextureDeletes.count(), fPendingTextureDeletes.begin()));
+        fPendingTextureDeletes.rewind();
+    }
+}
+
 bool GrGpuGL::configToGLFormats(GrPixelConfig config,
                                 bool getSizedInternalFormat,
                                 GrGLenum* internalFormat,
@@ -2765,10 +2975,15 @@ bool GrGpuGL::onCanCopySurface(GrSurface* dst,
 }
 
 void GrGpuGL::didAddGpuTraceMarker() {
-    if (this->caps()->gpuTracingSupport()) {
+    if (this->caps()->gpuTracingSupport() || NULL != fGpuTimer.get()) {
         const GrTraceMarkerSet& markerArray = this->getActiveTraceMarkers();
         SkString markerString = markerArray.toString();
-        GL_CALL(PushGroupMarker(0, markerString.c_str()));
+        if (this->caps()->gpuTracingSupport()) {
+            GL_CALL(PushGroupMarker(0, markerString.c_str()));
+        }
+        if (NULL != fGpuTimer.get()) {
+            fGpuTimer->beginScope(markerString);
+        }
     }
 }
 
@@ -2776,7 +2991,57 @@ void GrGpuGL::didRemoveGpuTraceMarker() {
     if (this->caps()->gpuTracingSupport()) {
         GL_CALL(PopGroupMarker());
     }
+    if (NULL != fGpuTimer.get()) {
+        fGpuTimer->endScope();
+    }
 }
+
+bool GrGpuGL::setGpuTimingEnabled(bool enable) {
+    if (!enable) {
+        fGpuTimer.free();
+        return true;
+    }
+    if (NULL == fGpuTimer.get() && GrGLGpuTimer::IsSupported(fGLContext)) {
+        fGpuTimer.reset(SkNEW_ARGS(GrGLGpuTimer, (fGLContext)));
+    }
+    return NULL != fGpuTimer.get();
+}
+
+void GrGpuGL::popGpuTimings(SkTArray<GpuTiming>* timings) {
+    if (NULL != fGpuTimer.get()) {
+        fGpuTimer->collectResults();
+        fGpuTimer->popResults(timings);
+    }
+}
+
+void GrGpuGL::willFlushDrawBuffer() {
+    if (NULL != fGpuTimer.get()) {
+        fGpuTimer->beginScope(SkString("flush"));
+    }
+}
+
+void GrGpuGL::didFlushDrawBuffer() {
+    this->flushPendingTextureDeletes();
+    if (NULL != fGpuTimer.get()) {
+        fGpuTimer->endScope();
+        // Pick up whatever earlier frames have finished, so results don't wait on the client.
+        fGpuTimer->collectResults();
+    }
+}
+
+bool GrGpuGL::attachSharedTexture(GrTexture* texture, GrSharedTextureEntry* entry) {
+    // Render targets keep FBOs, which aren't shared across contexts.
+    if (NULL != texture->asRenderTarget()) {
+        return false;
+    }
+    static_cast<GrGLTexture*>(texture)->setSharedEntry(entry);
+    return true;
+}
+
+void GrGpuGL::flushForSharing() {
+    GL_CALL(Flush());
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 GrGLAttribArrayState* GrGpuGL::HWGeometryState::bindArrayAndBuffersToDraw(
@@ -2784,19 +3049,20 @@ GrGLAttribArrayState* GrGpuGL::HWGeometryState::bindArrayAndBuffersToDraw(
                                                 const GrGLVertexBuffer* vbuffer,
                                                 const GrGLIndexBuffer* ibuffer) {
     SkASSERT(NULL != vbuffer);
-    GrGLAttribArrayState* attribState;
-
-    // We use a vertex array if we're on a core profile and the verts are in a VBO.
-    if (gpu->glCaps().isCoreProfile() && !vbuffer->isCPUBacked()) {
-        if (NULL == fVBOVertexArray || fVBOVertexArray->wasDestroyed()) {
-            SkSafeUnref(fVBOVertexArray);
-            GrGLuint arrayID;
-            GR_GL_CALL(gpu->glInterface(), GenVertexArrays(1, &arrayID));
-            int attrCount = gpu->glCaps().maxVertexAttributes();
-            fVBOVertexArray = SkNEW_ARGS(GrGLVertexArray, (gpu, arrayID, attrCount));
-        }
-        attribState = fVBOVertexArray->bindWithIndexBuffer(ibuffer);
-    } else {
+    GrGLAttribArrayState* attribState = NULL;
+
+    // We use a vertex array, one per pair of buffers, whenever the geometry is in VBOs. Drawing
+    // from the same buffers with the same layout again is then a single glBindVertexArray. Core
+    // profiles require a vertex array to draw at all.
+    if (gpu->glCaps().vertexArrayObjectSupport() && !vbuffer->isCPUBacked() &&
+        (NULL == ibuffer || !ibuffer->isCPUBacked() || gpu->glCaps().isCoreProfile())) {
+        GrGLVertexArray* array = fVBOVertexArrays.find(gpu, vbuffer->bufferID(),
+                                                       NULL != ibuffer ? ibuffer->bufferID() : 0);
+        if (NULL != array) {
+            attribState = array->bindWithIndexBuffer(ibuffer);
+        }
+    }
+    if (NULL == attribState) {
         if (NULL != ibuffer) {
             this->setIndexBufferIDOnDefaultVertexArray(gpu, ibuffer->bufferID());
         } else {
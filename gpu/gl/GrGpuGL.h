@@ -11,15 +11,20 @@
 #include "GrBinHashKey.h"
 #include "GrDrawState.h"
 #include "GrGLContext.h"
+#include "GrGLGpuTimer.h"
 #include "GrGLIRect.h"
 #include "GrGLIndexBuffer.h"
 #include "GrGLProgram.h"
+#include "GrGLProgramBinaryCache.h"
+#include "GrGLProgramManifest.h"
 #include "GrGLStencilBuffer.h"
 #include "GrGLTexture.h"
 #include "GrGLVertexArray.h"
 #include "GrGLVertexBuffer.h"
 #include "GrGpu.h"
 #include "GrTHashTable.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
 #include "SkTypes.h"
 
 #ifdef SK_DEVELOPER
@@ -40,8 +45,42 @@ public:
     GrGLSLGeneration glslGeneration() const { return fGLContext.glslGeneration(); }
     const GrGLCaps& glCaps() const { return *fGLContext.caps(); }
 
+    // The persistent program binary cache, or NULL if none was installed when this was created.
+    GrGLProgramBinaryCache* programBinaryCache() const { return fProgramBinaryCache.get(); }
+    const SkString& programBinaryDriverID() const { return fProgramBinaryDriverID; }
+
+    // The manifest programs are recorded in, or NULL if none was installed when this was created.
+    GrGLProgramManifest* programManifest() const { return fProgramManifest.get(); }
+
+    // Takes over programs prelinked from a GrGLProgramManifest, on this context or one sharing
+    // objects with it. The array is emptied. Programs that are never used are deleted with this.
+    void adoptPrelinkedPrograms(SkTArray<GrGLProgramManifest::PrelinkedProgram>*);
+
+    // Returns the ID of a prelinked program for desc, whose ownership passes to the caller, or 0.
+    GrGLuint takePrelinkedProgram(const GrGLProgramDesc& desc);
+
+    // Starts reading a rect of the target into the GL_PIXEL_PACK_BUFFER bufferID, tightly packed,
+    // without waiting for it: glReadPixels returns as soon as the copy is queued. The rect must lie
+    // within the target and config must be one it can be read in without conversion. Sets flipY if
+    // the rows land bottom to top. Requires GrGLCaps::packPixelBufferSupport().
+    bool readPixelsToPackBuffer(GrRenderTarget* target,
+                                int left, int top, int width, int height,
+                                GrPixelConfig config,
+                                GrGLuint bufferID,
+                                bool* flipY);
+
+    // Maps a buffer filled by readPixelsToPackBuffer() for reading, waiting for the read if it
+    // hasn't landed yet. Returns NULL, with nothing bound, on failure.
+    const void* mapPackBuffer(GrGLuint bufferID, size_t size);
+    // Unmaps and unbinds the buffer. Returns false if GL lost the contents while they were mapped
+    // (e.g. to a mode switch), in which case what was read from them is garbage.
+    bool unmapPackBuffer();
+
     virtual void discard(GrRenderTarget*) SK_OVERRIDE;
 
+    virtual bool getProgramCacheStats(ProgramCacheStats*) const SK_OVERRIDE;
+    virtual bool setProgramCacheCapacity(int capacity) SK_OVERRIDE;
+
     // Used by GrGLProgram and GrGLPathTexGenProgramEffects to configure OpenGL
     // state.
     void bindTexture(int unitIdx, const GrTextureParams& params, GrGLTexture* texture);
@@ -80,6 +119,13 @@ public:
 
     virtual void abandonResources() SK_OVERRIDE;
 
+    virtual bool setGpuTimingEnabled(bool enable) SK_OVERRIDE;
+    virtual void popGpuTimings(SkTArray<GpuTiming>* timings) SK_OVERRIDE;
+    virtual void willFlushDrawBuffer() SK_OVERRIDE;
+    virtual void didFlushDrawBuffer() SK_OVERRIDE;
+    virtual bool attachSharedTexture(GrTexture*, GrSharedTextureEntry*) SK_OVERRIDE;
+    virtual void flushForSharing() SK_OVERRIDE;
+
     // These functions should be used to bind GL objects. They track the GL state and skip redundant
     // bindings. Making the equivalent glBind calls directly will confuse the state tracking.
     void bindVertexArray(GrGLuint id) {
@@ -106,6 +152,11 @@ public:
     void notifyTextureDelete(GrGLTexture* texture);
     void notifyRenderTargetDelete(GrRenderTarget* renderTarget);
 
+    // Texture IDs are deleted in batches, with one glDeleteTextures per batch, when the draw
+    // buffer is flushed or enough of them have piled up. A purge that frees hundreds of
+    // textures then costs a few GL calls.
+    void deleteTextureID(GrGLuint id);
+
 protected:
     virtual bool onCopySurface(GrSurface* dst,
                                GrSurface* src,
@@ -187,8 +238,14 @@ private:
 
     static bool BlendCoeffReferencesConstant(GrBlendCoeff coeff);
 
+    // A hash map of compiled programs keyed by their GrGLProgramDesc. Once the cache holds
+    // capacity programs, adding one evicts the least recently used.
     class ProgramCache : public ::SkNoncopyable {
     public:
+        enum {
+            kDefaultCapacity = 256,
+        };
+
         ProgramCache(GrGpuGL* gpu);
         ~ProgramCache();
 
@@ -197,36 +254,25 @@ private:
                                 const GrEffectStage* colorStages[],
                                 const GrEffectStage* coverageStages[]);
 
-    private:
-        enum {
-            // We may actually have kMaxEntries+1 shaders in the GL context because we create a new
-            // shader before evicting from the cache.
-            kMaxEntries = 128,
-            kHashBits = 6,
-        };
+        // Evicts the least recently used programs until no more than capacity are left.
+        void setCapacity(int capacity);
+        void getStats(GrGpu::ProgramCacheStats*) const;
 
+    private:
         struct Entry;
 
-        struct ProgDescLess;
-
-        // binary search for entry matching desc. returns index into fEntries that matches desc or ~
-        // of the index of where it should be inserted.
-        int search(const GrGLProgramDesc& desc) const;
+        void purgeToCapacity();
+        void removeAll();
 
-        // sorted array of all the entries
-        Entry*                      fEntries[kMaxEntries];
-        // hash table based on lowest kHashBits bits of the program key. Used to avoid binary
-        // searching fEntries.
-        Entry*                      fHashTable[1 << kHashBits];
+        SkTDynamicHash<Entry, GrGLProgramDesc> fHash;
+        // Most recently used at the head.
+        SkTInternalLList<Entry>     fLRU;
 
-        int                         fCount;
-        unsigned int                fCurrLRUStamp;
+        int                         fCapacity;
+        uint64_t                    fHits;
+        uint64_t                    fMisses;
+        uint64_t                    fEvictions;
         GrGpuGL*                    fGpu;
-#ifdef PROGRAM_CACHE_STATS
-        int                         fTotalRequests;
-        int                         fCacheMisses;
-        int                         fHashMisses; // cache hit but hash table missed
-#endif
     };
 
     // flushes dithering, color-mask, and face culling stat
@@ -265,6 +311,17 @@ private:
                        const void* data,
                        size_t rowBytes);
 
+    // Binds the target's FBO, resolved if need be, for glReadPixels.
+    bool bindRenderTargetForRead(GrGLRenderTarget* target);
+
+    // Binds fUnpackBufferID to GL_PIXEL_UNPACK_BUFFER, gives it fresh storage of
+    // the given size and maps it for writing. Returns NULL, with nothing bound,
+    // if the buffer can't be used.
+    void* mapUnpackBuffer(size_t size);
+    // Unmaps the buffer, leaving it bound for the upload. Returns false, with
+    // nothing bound, if GL lost the contents.
+    bool unmapUnpackBuffer();
+
     bool createRenderTargetObjects(int width, int height,
                                    GrGLuint texID,
                                    GrGLRenderTarget::Desc* desc);
@@ -274,6 +331,23 @@ private:
     // GL program-related state
     ProgramCache*               fProgramCache;
     SkAutoTUnref<GrGLProgram>   fCurrentProgram;
+    SkAutoTUnref<GrGLProgramBinaryCache> fProgramBinaryCache;
+    SkString                    fProgramBinaryDriverID;
+    SkAutoTUnref<GrGLProgramManifest> fProgramManifest;
+    SkTArray<GrGLProgramManifest::PrelinkedProgram> fPrelinkedPrograms;
+
+    // Texture uploads are staged in this GL_PIXEL_UNPACK_BUFFER so that
+    // glTexSubImage2D returns without waiting for the transfer.
+    GrGLuint                    fUnpackBufferID;
+
+    // NULL unless GPU timing is enabled.
+    SkAutoTDelete<GrGLGpuTimer> fGpuTimer;
+
+    enum {
+        kMaxPendingTextureDeletes = 64
+    };
+    void flushPendingTextureDeletes();
+    SkTDArray<GrGLuint>         fPendingTextureDeletes;
 
     ///////////////////////////////////////////////////////////////////////////
     ///@name Caching of GL State
@@ -281,6 +355,11 @@ private:
     int                         fHWActiveTextureUnitIdx;
     GrGLuint                    fHWProgramID;
 
+    // Texture parameters are state of the texture objects rather than of the context, so a
+    // GrGLTexture's cached TexParams only go stale when a reset says the client touched texture
+    // bindings. This timestamp is bumped by those resets alone and stamps the cached TexParams.
+    ResetTimestamp              fTexParamsTimestamp;
+
     GrGLProgram::SharedGLState  fSharedGLProgramState;
 
     enum TriState {
@@ -306,9 +385,7 @@ private:
      */
     class HWGeometryState {
     public:
-        HWGeometryState() { fVBOVertexArray = NULL; this->invalidate(); }
-
-        ~HWGeometryState() { SkSafeUnref(fVBOVertexArray); }
+        HWGeometryState() { this->invalidate(); }
 
         void invalidate() {
             fBoundVertexArrayIDIsValid = false;
@@ -316,9 +393,7 @@ private:
             fDefaultVertexArrayBoundIndexBufferID = false;
             fDefaultVertexArrayBoundIndexBufferIDIsValid = false;
             fDefaultVertexArrayAttribState.invalidate();
-            if (NULL != fVBOVertexArray) {
-                fVBOVertexArray->invalidateCachedState();
-            }
+            fVBOVertexArrays.invalidateCachedState();
         }
 
         void notifyVertexArrayDelete(GrGLuint id) {
@@ -344,9 +419,7 @@ private:
             if (fBoundVertexBufferIDIsValid && id == fBoundVertexBufferID) {
                 fBoundVertexBufferID = 0;
             }
-            if (NULL != fVBOVertexArray) {
-                fVBOVertexArray->notifyVertexBufferDelete(id);
-            }
+            fVBOVertexArrays.notifyBufferDelete(id);
             fDefaultVertexArrayAttribState.notifyVertexBufferDelete(id);
         }
 
@@ -355,9 +428,7 @@ private:
                 id == fDefaultVertexArrayBoundIndexBufferID) {
                 fDefaultVertexArrayBoundIndexBufferID = 0;
             }
-            if (NULL != fVBOVertexArray) {
-                fVBOVertexArray->notifyIndexBufferDelete(id);
-            }
+            fVBOVertexArrays.notifyBufferDelete(id);
         }
 
         void setVertexBufferID(GrGpuGL* gpu, GrGLuint id) {
@@ -405,8 +476,8 @@ private:
         // GrGpuGL.
         GrGLAttribArrayState    fDefaultVertexArrayAttribState;
 
-        // This is used when we're using a core profile and the vertices are in a VBO.
-        GrGLVertexArray*        fVBOVertexArray;
+        // These are used when vertex arrays are supported and the geometry is in VBOs.
+        GrGLVertexArrayCache    fVBOVertexArrays;
     } fHWGeometryState;
 
     struct {
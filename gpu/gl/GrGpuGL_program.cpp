@@ -10,7 +10,7 @@
 #include "GrEffect.h"
 #include "GrGLEffect.h"
 #include "SkRTConf.h"
-#include "SkTSearch.h"
+#include "SkStats.h"
 
 #ifdef PROGRAM_CACHE_STATS
 SK_CONF_DECLARE(bool, c_DisplayCache, "gpu.displayCache", false,
@@ -21,187 +21,150 @@ typedef GrGLUniformManager::UniformHandle UniformHandle;
 
 struct GrGpuGL::ProgramCache::Entry {
     SK_DECLARE_INST_COUNT_ROOT(Entry);
-    Entry() : fProgram(NULL), fLRUStamp(0) {}
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Entry);
 
-    SkAutoTUnref<GrGLProgram>   fProgram;
-    unsigned int                fLRUStamp;
-};
+    explicit Entry(GrGLProgram* program) : fProgram(program) {}
 
-struct GrGpuGL::ProgramCache::ProgDescLess {
-    bool operator() (const GrGLProgramDesc& desc, const Entry* entry) {
-        SkASSERT(NULL != entry->fProgram.get());
-        return GrGLProgramDesc::Less(desc, entry->fProgram->getDesc());
+    static const GrGLProgramDesc& GetKey(const Entry& entry) {
+        return entry.fProgram->getDesc();
     }
+    static uint32_t Hash(const GrGLProgramDesc& desc) { return desc.getChecksum(); }
 
-    bool operator() (const Entry* entry, const GrGLProgramDesc& desc) {
-        SkASSERT(NULL != entry->fProgram.get());
-        return GrGLProgramDesc::Less(entry->fProgram->getDesc(), desc);
-    }
+    SkAutoTUnref<GrGLProgram>   fProgram;
 };
 
 GrGpuGL::ProgramCache::ProgramCache(GrGpuGL* gpu)
-    : fCount(0)
-    , fCurrLRUStamp(0)
-    , fGpu(gpu)
-#ifdef PROGRAM_CACHE_STATS
-    , fTotalRequests(0)
-    , fCacheMisses(0)
-    , fHashMisses(0)
-#endif
-{
-    for (int i = 0; i < 1 << kHashBits; ++i) {
-        fHashTable[i] = NULL;
-    }
+    : fCapacity(kDefaultCapacity)
+    , fHits(0)
+    , fMisses(0)
+    , fEvictions(0)
+    , fGpu(gpu) {
 }
 
 GrGpuGL::ProgramCache::~ProgramCache() {
-    for (int i = 0; i < fCount; ++i){
-        SkDELETE(fEntries[i]);
-    }
     // dump stats
 #ifdef PROGRAM_CACHE_STATS
     if (c_DisplayCache) {
+        unsigned long long requests = fHits + fMisses;
         SkDebugf("--- Program Cache ---\n");
-        SkDebugf("Total requests: %d\n", fTotalRequests);
-        SkDebugf("Cache misses: %d\n", fCacheMisses);
-        SkDebugf("Cache miss %%: %f\n", (fTotalRequests > 0) ?
-                                            100.f * fCacheMisses / fTotalRequests :
-                                            0.f);
-        int cacheHits = fTotalRequests - fCacheMisses;
-        SkDebugf("Hash miss %%: %f\n", (cacheHits > 0) ? 100.f * fHashMisses / cacheHits : 0.f);
+        SkDebugf("Total requests: %llu\n", requests);
+        SkDebugf("Cache misses: %llu\n", static_cast<unsigned long long>(fMisses));
+        SkDebugf("Cache miss %%: %f\n", (requests > 0) ? 100.f * fMisses / requests : 0.f);
+        SkDebugf("Evictions: %llu\n", static_cast<unsigned long long>(fEvictions));
         SkDebugf("---------------------\n");
     }
 #endif
+    this->removeAll();
+}
+
+void GrGpuGL::ProgramCache::removeAll() {
+    while (Entry* entry = fLRU.head()) {
+        fLRU.remove(entry);
+        fHash.remove(Entry::GetKey(*entry));
+        SkDELETE(entry);
+    }
 }
 
 void GrGpuGL::ProgramCache::abandon() {
-    for (int i = 0; i < fCount; ++i) {
-        SkASSERT(NULL != fEntries[i]->fProgram.get());
-        fEntries[i]->fProgram->abandon();
-        fEntries[i]->fProgram.reset(NULL);
+    for (SkTDynamicHash<Entry, GrGLProgramDesc>::Iter iter(&fHash); !iter.done(); ++iter) {
+        (*iter).fProgram->abandon();
     }
-    fCount = 0;
+    this->removeAll();
 }
 
-int GrGpuGL::ProgramCache::search(const GrGLProgramDesc& desc) const {
-    ProgDescLess less;
-    return SkTSearch(fEntries, fCount, desc, sizeof(Entry*), less);
+void GrGpuGL::ProgramCache::setCapacity(int capacity) {
+    fCapacity = SkTMax(capacity, 1);
+    this->purgeToCapacity();
+}
+
+void GrGpuGL::ProgramCache::getStats(GrGpu::ProgramCacheStats* stats) const {
+    stats->fCapacity = fCapacity;
+    stats->fCount = fHash.count();
+    stats->fHits = fHits;
+    stats->fMisses = fMisses;
+    stats->fEvictions = fEvictions;
+}
+
+void GrGpuGL::ProgramCache::purgeToCapacity() {
+    while (fHash.count() > fCapacity) {
+        Entry* entry = fLRU.tail();
+        SkASSERT(NULL != entry);
+        fLRU.remove(entry);
+        fHash.remove(Entry::GetKey(*entry));
+        SkDELETE(entry);
+        ++fEvictions;
+    }
 }
 
 GrGLProgram* GrGpuGL::ProgramCache::getProgram(const GrGLProgramDesc& desc,
                                                const GrEffectStage* colorStages[],
                                                const GrEffectStage* coverageStages[]) {
-#ifdef PROGRAM_CACHE_STATS
-    ++fTotalRequests;
-#endif
-
-    Entry* entry = NULL;
+    Entry* entry = fHash.find(desc);
+    if (NULL != entry) {
+        ++fHits;
+        // Keep the list in least recently used order, with the most recent at the head.
+        if (fLRU.head() != entry) {
+            fLRU.remove(entry);
+            fLRU.addToHead(entry);
+        }
+        return entry->fProgram;
+    }
 
-    uint32_t hashIdx = desc.getChecksum();
-    hashIdx ^= hashIdx >> 16;
-    if (kHashBits <= 8) {
-        hashIdx ^= hashIdx >> 8;
+    ++fMisses;
+    GrGLProgram* program = GrGLProgram::Create(fGpu, desc, colorStages, coverageStages);
+    if (NULL == program) {
+        return NULL;
     }
-    hashIdx &=((1 << kHashBits) - 1);
-    Entry* hashedEntry = fHashTable[hashIdx];
-    if (NULL != hashedEntry && hashedEntry->fProgram->getDesc() == desc) {
-        SkASSERT(NULL != hashedEntry->fProgram);
-        entry = hashedEntry;
+    if (NULL != fGpu->programManifest()) {
+        fGpu->programManifest()->add(desc);
     }
+    entry = SkNEW_ARGS(Entry, (program));
+    fHash.add(entry);
+    fLRU.addToHead(entry);
+    this->purgeToCapacity();
+    return program;
+}
 
-    int entryIdx;
-    if (NULL == entry) {
-        entryIdx = this->search(desc);
-        if (entryIdx >= 0) {
-            entry = fEntries[entryIdx];
-#ifdef PROGRAM_CACHE_STATS
-            ++fHashMisses;
-#endif
-        }
-    }
+bool GrGpuGL::getProgramCacheStats(ProgramCacheStats* stats) const {
+    fProgramCache->getStats(stats);
+    return true;
+}
 
-    if (NULL == entry) {
-        // We have a cache miss
-#ifdef PROGRAM_CACHE_STATS
-        ++fCacheMisses;
-#endif
-        GrGLProgram* program = GrGLProgram::Create(fGpu, desc, colorStages, coverageStages);
-        if (NULL == program) {
-            return NULL;
-        }
-        int purgeIdx = 0;
-        if (fCount < kMaxEntries) {
-            entry = SkNEW(Entry);
-            purgeIdx = fCount++;
-            fEntries[purgeIdx] = entry;
-        } else {
-            SkASSERT(fCount == kMaxEntries);
-            purgeIdx = 0;
-            for (int i = 1; i < kMaxEntries; ++i) {
-                if (fEntries[i]->fLRUStamp < fEntries[purgeIdx]->fLRUStamp) {
-                    purgeIdx = i;
-                }
-            }
-            entry = fEntries[purgeIdx];
-            int purgedHashIdx = entry->fProgram->getDesc().getChecksum() & ((1 << kHashBits) - 1);
-            if (fHashTable[purgedHashIdx] == entry) {
-                fHashTable[purgedHashIdx] = NULL;
-            }
-        }
-        SkASSERT(fEntries[purgeIdx] == entry);
-        entry->fProgram.reset(program);
-        // We need to shift fEntries around so that the entry currently at purgeIdx is placed
-        // just before the entry at ~entryIdx (in order to keep fEntries sorted by descriptor).
-        entryIdx = ~entryIdx;
-        if (entryIdx < purgeIdx) {
-            //  Let E and P be the entries at index entryIdx and purgeIdx, respectively.
-            //  If the entries array looks like this:
-            //       aaaaEbbbbbPccccc
-            //  we rearrange it to look like this:
-            //       aaaaPEbbbbbccccc
-            size_t copySize = (purgeIdx - entryIdx) * sizeof(Entry*);
-            memmove(fEntries + entryIdx + 1, fEntries + entryIdx, copySize);
-            fEntries[entryIdx] = entry;
-        } else if (purgeIdx < entryIdx) {
-            //  If the entries array looks like this:
-            //       aaaaPbbbbbEccccc
-            //  we rearrange it to look like this:
-            //       aaaabbbbbPEccccc
-            size_t copySize = (entryIdx - purgeIdx - 1) * sizeof(Entry*);
-            memmove(fEntries + purgeIdx, fEntries + purgeIdx + 1, copySize);
-            fEntries[entryIdx - 1] = entry;
-        }
-#ifdef SK_DEBUG
-        SkASSERT(NULL != fEntries[0]->fProgram.get());
-        for (int i = 0; i < fCount - 1; ++i) {
-            SkASSERT(NULL != fEntries[i + 1]->fProgram.get());
-            const GrGLProgramDesc& a = fEntries[i]->fProgram->getDesc();
-            const GrGLProgramDesc& b = fEntries[i + 1]->fProgram->getDesc();
-            SkASSERT(GrGLProgramDesc::Less(a, b));
-            SkASSERT(!GrGLProgramDesc::Less(b, a));
-        }
-#endif
-    }
+bool GrGpuGL::setProgramCacheCapacity(int capacity) {
+    fProgramCache->setCapacity(capacity);
+    return true;
+}
 
-    fHashTable[hashIdx] = entry;
-    entry->fLRUStamp = fCurrLRUStamp;
+////////////////////////////////////////////////////////////////////////////////
 
-    if (SK_MaxU32 == fCurrLRUStamp) {
-        // wrap around! just trash our LRU, one time hit.
-        for (int i = 0; i < fCount; ++i) {
-            fEntries[i]->fLRUStamp = 0;
-        }
+void GrGpuGL::adoptPrelinkedPrograms(SkTArray<GrGLProgramManifest::PrelinkedProgram>* programs) {
+    for (int i = 0; i < programs->count(); ++i) {
+        fPrelinkedPrograms.push_back((*programs)[i]);
     }
-    ++fCurrLRUStamp;
-    return entry->fProgram;
+    programs->reset();
 }
 
-////////////////////////////////////////////////////////////////////////////////
+GrGLuint GrGpuGL::takePrelinkedProgram(const GrGLProgramDesc& desc) {
+    for (int i = 0; i < fPrelinkedPrograms.count(); ++i) {
+        if (fPrelinkedPrograms[i].fDesc == desc) {
+            GrGLuint programID = fPrelinkedPrograms[i].fProgramID;
+            fPrelinkedPrograms.removeShuffle(i);
+            return programID;
+        }
+    }
+    return 0;
+}
 
 void GrGpuGL::abandonResources(){
     INHERITED::abandonResources();
     fProgramCache->abandon();
+    fPrelinkedPrograms.reset();
     fHWProgramID = 0;
+    fUnpackBufferID = 0;
+    fPendingTextureDeletes.rewind();
+    if (NULL != fGpuTimer.get()) {
+        fGpuTimer->abandon();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -258,6 +221,7 @@ bool GrGpuGL::flushGraphicsState(DrawType type, const GrDeviceCoordTexture* dstC
 
         GrGLuint programID = fCurrentProgram->programID();
         if (fHWProgramID != programID) {
+            SK_STATS_INC(kGrProgramSwitch_Counter);
             GL_CALL(UseProgram(programID));
             fHWProgramID = programID;
         }
@@ -216,6 +216,19 @@ static GrGLInterface* create_es_interface(GrGLVersion version,
         }
     }
 
+    if (extensions->has("GL_EXT_disjoint_timer_query")) {
+        functions->fGenQueries = (GrGLGenQueriesProc) eglGetProcAddress("glGenQueriesEXT");
+        functions->fDeleteQueries = (GrGLDeleteQueriesProc) eglGetProcAddress("glDeleteQueriesEXT");
+        functions->fBeginQuery = (GrGLBeginQueryProc) eglGetProcAddress("glBeginQueryEXT");
+        functions->fEndQuery = (GrGLEndQueryProc) eglGetProcAddress("glEndQueryEXT");
+        functions->fQueryCounter = (GrGLQueryCounterProc) eglGetProcAddress("glQueryCounterEXT");
+        functions->fGetQueryiv = (GrGLGetQueryivProc) eglGetProcAddress("glGetQueryivEXT");
+        functions->fGetQueryObjectiv = (GrGLGetQueryObjectivProc) eglGetProcAddress("glGetQueryObjectivEXT");
+        functions->fGetQueryObjectuiv = (GrGLGetQueryObjectuivProc) eglGetProcAddress("glGetQueryObjectuivEXT");
+        functions->fGetQueryObjecti64v = (GrGLGetQueryObjecti64vProc) eglGetProcAddress("glGetQueryObjecti64vEXT");
+        functions->fGetQueryObjectui64v = (GrGLGetQueryObjectui64vProc) eglGetProcAddress("glGetQueryObjectui64vEXT");
+    }
+
 #if GL_ES_VERSION_3_0
     functions->fInvalidateFramebuffer = glInvalidateFramebuffer;
     functions->fInvalidateSubFramebuffer = glInvalidateSubFramebuffer;
@@ -10,6 +10,10 @@
 #include "SkCanvas.h"
 #include "SkDevice.h"
 #include "SkMallocPixelRef.h"
+#include "SkMemoryBudget.h"
+#include "SkOnce.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
 
 static const size_t kIgnoreRowBytesValue = (size_t)~0;
 
@@ -137,6 +141,110 @@ void SkSurface_Raster::onCopyOnWrite(ContentChangeMode mode) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Surfaces made by NewRaster() are often short-lived scratch layers of a few fixed sizes, so
+// their pixels are kept in a pool when the surface (and any snapshot sharing them) goes away,
+// and handed to the next surface of the same byte size instead of going back to malloc.
+// Blocks are most-recently-used last; the oldest are freed first when the pool is over its
+// limit or the memory budget asks it to shrink.
+#ifndef SK_DEFAULT_RASTER_SURFACE_POOL_LIMIT
+    #define SK_DEFAULT_RASTER_SURFACE_POOL_LIMIT    (4 * 1024 * 1024)
+#endif
+
+// Bigger surfaces are rare enough that pooling them would mostly hoard memory.
+static const size_t kMaxPooledPixelsSize = 1024 * 1024;
+
+namespace {
+struct PooledPixels {
+    void*   fAddr;
+    size_t  fSize;
+};
+}
+
+SK_DECLARE_STATIC_MUTEX(gPixelPoolMutex);
+static SkTDArray<PooledPixels>* gPixelPool;
+static size_t gPixelPoolBytes;
+
+// Caller must hold gPixelPoolMutex.
+static void purge_pixel_pool(size_t targetBytes) {
+    int purged = 0;
+    while (gPixelPoolBytes > targetBytes) {
+        const PooledPixels& pixels = (*gPixelPool)[purged++];
+        sk_free(pixels.fAddr);
+        gPixelPoolBytes -= pixels.fSize;
+    }
+    gPixelPool->remove(0, purged);
+}
+
+static size_t pixel_pool_usage(void*) {
+    SkAutoMutexAcquire am(gPixelPoolMutex);
+    return gPixelPoolBytes;
+}
+
+static void pixel_pool_purge(void*, size_t targetBytes) {
+    SkAutoMutexAcquire am(gPixelPoolMutex);
+    if (NULL != gPixelPool) {
+        purge_pixel_pool(targetBytes);
+    }
+}
+
+static void register_pixel_pool(int) {
+    SkMemoryBudget::Register(pixel_pool_usage, pixel_pool_purge, &gPixelPoolBytes);
+}
+
+static void* pool_alloc_pixels(size_t size) {
+    {
+        SkAutoMutexAcquire am(gPixelPoolMutex);
+        if (NULL != gPixelPool) {
+            for (int i = gPixelPool->count() - 1; i >= 0; --i) {
+                if ((*gPixelPool)[i].fSize == size) {
+                    void* addr = (*gPixelPool)[i].fAddr;
+                    gPixelPool->remove(i);
+                    gPixelPoolBytes -= size;
+                    return addr;
+                }
+            }
+        }
+    }
+    return sk_malloc_flags(size, 0);
+}
+
+// The release proc of pooled pixel refs; context is the size of the block.
+static void pool_free_pixels(void* addr, void* context) {
+    size_t size = reinterpret_cast<size_t>(context);
+    SK_DECLARE_STATIC_ONCE(once);
+    SkOnce(&once, register_pixel_pool, 0);
+
+    SkAutoMutexAcquire am(gPixelPoolMutex);
+    if (NULL == gPixelPool) {
+        gPixelPool = SkNEW(SkTDArray<PooledPixels>);
+    }
+    PooledPixels* pixels = gPixelPool->append();
+    pixels->fAddr = addr;
+    pixels->fSize = size;
+    gPixelPoolBytes += size;
+    purge_pixel_pool(SK_DEFAULT_RASTER_SURFACE_POOL_LIMIT);
+}
+
+static SkPixelRef* new_pooled_pixel_ref(const SkImageInfo& info) {
+    size_t rowBytes = info.minRowBytes();
+    int64_t size64 = info.getSafeSize64(rowBytes);
+    if (size64 <= 0 || size64 > (int64_t)kMaxPooledPixelsSize) {
+        return SkMallocPixelRef::NewAllocate(info, rowBytes, NULL);
+    }
+    size_t size = (size_t)size64;
+
+    void* addr = pool_alloc_pixels(size);
+    if (NULL == addr) {
+        return NULL;
+    }
+    // A reused block holds whatever its last surface drew; the SkSurface_Raster constructor
+    // clears it for surfaces that aren't opaque, as it does fresh pixels.
+    return SkMallocPixelRef::NewWithProc(info, rowBytes, NULL, addr, pool_free_pixels,
+                                         reinterpret_cast<void*>(size));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SkSurface* SkSurface::NewRasterDirect(const SkImageInfo& info, void* pixels, size_t rowBytes) {
     if (!SkSurface_Raster::Valid(info, rowBytes)) {
         return NULL;
@@ -153,7 +261,7 @@ SkSurface* SkSurface::NewRaster(const SkImageInfo& info) {
         return NULL;
     }
 
-    SkAutoTUnref<SkPixelRef> pr(SkMallocPixelRef::NewAllocate(info, 0, NULL));
+    SkAutoTUnref<SkPixelRef> pr(new_pooled_pixel_ref(info));
     if (NULL == pr.get()) {
         return NULL;
     }
@@ -92,6 +92,25 @@ private:
     #define SkCheckResult(expr, value)  (void)(expr)
 #endif
 
+// Returns the sample size (a power of two, relative to original) that
+// reduces original to dimensions of reduced, or 0 if there is none.  Sizes
+// round down, as in SkScaledBitmapSampler, but never below one pixel.
+int reduced_sample_size(const SkImageInfo& original,
+                        const SkImageInfo& reduced) {
+    if (original.colorType() != reduced.colorType() ||
+        original.alphaType() != reduced.alphaType()) {
+        return 0;
+    }
+    for (int sampleSize = 2; sampleSize <= original.width() ||
+                             sampleSize <= original.height(); sampleSize <<= 1) {
+        if (SkMax32(original.width() / sampleSize, 1) == reduced.width() &&
+            SkMax32(original.height() / sampleSize, 1) == reduced.height()) {
+            return sampleSize;
+        }
+    }
+    return 0;
+}
+
 #ifdef SK_DEBUG
 inline bool check_alpha(SkAlphaType reported, SkAlphaType actual) {
     return ((reported == actual)
@@ -157,11 +176,18 @@ bool DecodingImageGenerator::getPixels(const SkImageInfo& info,
     if (NULL == pixels) {
         return false;
     }
+    int sampleSize = fSampleSize;
     if (fInfo != info) {
-        // The caller has specified a different info.  This is an
-        // error for this kind of SkImageGenerator.  Use the Options
-        // to change the settings.
-        return false;
+        // The caller may ask for a power-of-two reduction of fInfo,
+        // which we hand to the codec as a larger sample size (for JPEG
+        // that is libjpeg's DCT scaling).  Any other info is an error
+        // for this kind of SkImageGenerator.  Use the Options to change
+        // the settings.
+        int reduction = reduced_sample_size(fInfo, info);
+        if (0 == reduction) {
+            return false;
+        }
+        sampleSize *= reduction;
     }
     if (info.minRowBytes() > rowBytes) {
         // The caller has specified a bad rowBytes.
@@ -174,12 +200,12 @@ bool DecodingImageGenerator::getPixels(const SkImageInfo& info,
         return false;
     }
     decoder->setDitherImage(fDitherImage);
-    decoder->setSampleSize(fSampleSize);
+    decoder->setSampleSize(sampleSize);
     decoder->setRequireUnpremultipliedColors(
             info.fAlphaType == kUnpremul_SkAlphaType);
 
     SkBitmap bitmap;
-    TargetAllocator allocator(fInfo, pixels, rowBytes);
+    TargetAllocator allocator(info, pixels, rowBytes);
     decoder->setAllocator(&allocator);
     // TODO: need to be able to pass colortype directly to decoder
     SkBitmap::Config legacyConfig = SkColorTypeToBitmapConfig(info.colorType());
@@ -190,6 +216,17 @@ bool DecodingImageGenerator::getPixels(const SkImageInfo& info,
         return false;
     }
     if (allocator.isReady()) {  // Did not use pixels!
+        if (bitmap.width() != info.width() || bitmap.height() != info.height()) {
+            // Codecs that round sampled sizes up (libjpeg) can hand back
+            // a reduced decode a pixel larger than we asked for.
+            SkBitmap subset;
+            if (bitmap.width() < info.width() || bitmap.height() < info.height() ||
+                !bitmap.extractSubset(&subset, SkIRect::MakeWH(info.width(),
+                                                               info.height()))) {
+                return false;
+            }
+            bitmap.swap(subset);
+        }
         SkBitmap bm;
         SkASSERT(bitmap.canCopyTo(info.colorType()));
         bool copySuccess = bitmap.copyTo(&bm, info.colorType(), &allocator);
@@ -17,6 +17,11 @@ class SkStreamRewindable;
 /**
  *  An implementation of SkImageGenerator that calls into
  *  SkImageDecoder.
+ *
+ *  Besides the info it reports, getPixels() accepts an info whose
+ *  width and height are getInfo()'s divided (rounding down, but never
+ *  below 1) by a power of two, and decodes at that reduced size.  This
+ *  is how the lazy pixelrefs implement SkPixelRef::decodeInto().
  */
 namespace SkDecodingImageGenerator {
     /**
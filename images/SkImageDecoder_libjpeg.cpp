@@ -13,7 +13,10 @@
 #include "SkDither.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
+#include "SkThread.h"
+#include "SkThreadUtils.h"
 #include "SkTime.h"
 #include "SkUtils.h"
 #include "SkRTConf.h"
@@ -53,6 +56,11 @@ SK_CONF_DECLARE(bool, c_suppressJPEGImageDecoderErrors,
                 DEFAULT_FOR_SUPPRESS_JPEG_IMAGE_DECODER_ERRORS,
                 "Suppress most JPG error messages when decode "
                 "function fails.");
+SK_CONF_DECLARE(int, c_JPEGDecodeThreadCount,
+                "images.jpeg.decodeThreadCount",
+                1,
+                "Decode large JPEGs that have suitable restart markers on up "
+                "to this many threads.");
 
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -529,6 +537,350 @@ static bool get_src_config(const jpeg_decompress_struct& cinfo,
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Parallel decoding of baseline JPEGs with restart markers.
+//
+// Restart markers reset the entropy decoder and the DC predictions, so the
+// data between two of them can be decoded without anything that came before.
+// When restarts fall at the start of MCU rows, we cut the scan into stripes of
+// whole MCU rows. Each stripe becomes a small JPEG of its own: the original
+// headers with the frame height patched, the stripe's entropy-coded data with
+// its restart markers renumbered from RST0, and an EOI. Each is decoded on its
+// own thread straight into its rows of the bitmap. Fancy upsampling and block
+// smoothing are off, so no pixel depends on rows outside its own stripe.
+
+namespace {
+
+// Each stripe repeats the header parsing and table setup, so only images at
+// least this large are split.
+static const int kMinParallelPixels = 1024 * 1024;
+
+// A couple of stripes per thread evens out stripes that decode at different
+// speeds.
+static const int kStripesPerThread = 2;
+
+enum {
+    kMarker_SOF0 = 0xC0,
+    kMarker_SOF1 = 0xC1,
+    kMarker_SOF15 = 0xCF,
+    kMarker_DHT = 0xC4,
+    kMarker_JPG = 0xC8,
+    kMarker_DAC = 0xCC,
+    kMarker_RST0 = 0xD0,
+    kMarker_RST7 = 0xD7,
+    kMarker_SOI = 0xD8,
+    kMarker_EOI = 0xD9,
+    kMarker_SOS = 0xDA,
+};
+
+struct RestartStripe {
+    int     fFirstInterval;
+    int     fIntervalCount;
+    int     fTop;
+    int     fHeight;
+};
+
+/**
+ *  Where the restart intervals are in the encoded data, and what every stripe
+ *  shares. Stripes are handed out through an atomic counter, like the bands of
+ *  SkParallelPathFill.
+ */
+struct RestartDecode {
+    const uint8_t*          fData;
+    size_t                  fHeaderLength;      // up to the end of the SOS segment
+    size_t                  fHeightOffset;      // of the frame height in the SOF
+    SkTDArray<size_t>       fRestarts;          // offsets of the RSTn markers
+    size_t                  fEndOfScan;         // offset of the EOI marker
+
+    SkImageDecoder*         fDecoder;
+    const SkBitmap*         fBitmap;
+    J_COLOR_SPACE           fOutColorSpace;
+    J_DCT_METHOD            fDCTMethod;
+    J_DITHER_MODE           fDitherMode;
+    SkScaledBitmapSampler::SrcConfig fSrcConfig;
+    int                     fSrcBytesPerPixel;
+
+    SkTDArray<RestartStripe> fStripes;
+    int32_t                 fNextStripe;
+    int32_t                 fFailed;
+
+    size_t intervalStart(int interval) const {
+        return 0 == interval ? fHeaderLength : fRestarts[interval - 1] + 2;
+    }
+    size_t intervalEnd(int interval) const {
+        return interval == fRestarts.count() ? fEndOfScan : fRestarts[interval];
+    }
+};
+
+inline int read_be16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+/**
+ *  Finds the end of the headers and the frame height of a baseline, single
+ *  scan JPEG, and the offset of every restart marker in its scan. Returns
+ *  false for anything else, which is left to the serial decoder.
+ */
+bool find_restarts(const uint8_t* data, size_t length, RestartDecode* decode) {
+    if (length < 4 || 0xFF != data[0] || kMarker_SOI != data[1]) {
+        return false;
+    }
+    size_t heightOffset = 0;
+    size_t i = 2;
+    for (;;) {
+        if (i + 4 > length || 0xFF != data[i]) {
+            return false;
+        }
+        while (i + 4 <= length && 0xFF == data[i + 1]) {
+            i += 1;     // fill bytes
+        }
+        const int marker = data[i + 1];
+        const size_t segmentLength = read_be16(data + i + 2);
+        if (segmentLength < 2 || i + 2 + segmentLength > length) {
+            return false;
+        }
+        if (marker >= kMarker_SOF0 && marker <= kMarker_SOF15 &&
+            kMarker_DHT != marker && kMarker_JPG != marker && kMarker_DAC != marker) {
+            // Only baseline and extended sequential Huffman frames.
+            if (kMarker_SOF0 != marker && kMarker_SOF1 != marker) {
+                return false;
+            }
+            if (segmentLength < 8) {
+                return false;
+            }
+            // length(2), precision(1), then the height
+            heightOffset = i + 5;
+        }
+        i += 2 + segmentLength;
+        if (kMarker_SOS == marker) {
+            break;
+        }
+    }
+    if (0 == heightOffset) {
+        return false;
+    }
+    decode->fData = data;
+    decode->fHeaderLength = i;
+    decode->fHeightOffset = heightOffset;
+
+    // Walk the entropy-coded data. 0xFF00 is a stuffed 0xFF; anything but a
+    // restart or the EOI (e.g. a second scan) sends us back to serial.
+    while (i + 1 < length) {
+        if (0xFF != data[i]) {
+            i += 1;
+            continue;
+        }
+        const int next = data[i + 1];
+        if (0x00 == next) {
+            i += 2;
+        } else if (0xFF == next) {
+            i += 1;
+        } else if (next >= kMarker_RST0 && next <= kMarker_RST7) {
+            if (next - kMarker_RST0 != (decode->fRestarts.count() & 7)) {
+                return false;
+            }
+            *decode->fRestarts.append() = i;
+            i += 2;
+        } else if (kMarker_EOI == next) {
+            decode->fEndOfScan = i;
+            return true;
+        } else {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ *  Cuts the scan into stripes at restart intervals that begin an MCU row.
+ */
+bool make_stripes(const jpeg_decompress_struct& cinfo, int stripeCount,
+                  RestartDecode* decode) {
+    const int mcusPerRow = cinfo.MCUs_per_row;
+    const int mcuRows = cinfo.MCU_rows_in_scan;
+    const int interval = cinfo.restart_interval;
+    const int intervalCount = (mcusPerRow * mcuRows + interval - 1) / interval;
+    if (decode->fRestarts.count() != intervalCount - 1) {
+        return false;
+    }
+    int rowHeight = cinfo.max_v_samp_factor * DCTSIZE;
+    if (1 == cinfo.comps_in_scan) {
+        rowHeight /= cinfo.cur_comp_info[0]->v_samp_factor;
+    }
+
+    const int rowsPerStripe = (mcuRows + stripeCount - 1) / stripeCount;
+    int firstInterval = 0;
+    int firstRow = 0;
+    for (int k = 1; k <= intervalCount; ++k) {
+        int row;
+        if (k == intervalCount) {
+            row = mcuRows;
+        } else if (0 == (k * interval) % mcusPerRow) {
+            row = k * interval / mcusPerRow;
+            if (row - firstRow < rowsPerStripe) {
+                continue;
+            }
+        } else {
+            continue;
+        }
+        RestartStripe* stripe = decode->fStripes.append();
+        stripe->fFirstInterval = firstInterval;
+        stripe->fIntervalCount = k - firstInterval;
+        stripe->fTop = firstRow * rowHeight;
+        stripe->fHeight = SkMin32(row * rowHeight, cinfo.output_height) - stripe->fTop;
+        firstInterval = k;
+        firstRow = row;
+    }
+    return decode->fStripes.count() > 1;
+}
+
+/**
+ *  Builds the stand-alone JPEG for one stripe and decodes it into the
+ *  stripe's rows of the bitmap.
+ */
+bool decode_stripe(const RestartDecode& decode, const RestartStripe& stripe) {
+    const size_t dataStart = decode.intervalStart(stripe.fFirstInterval);
+    const size_t dataEnd = decode.intervalEnd(stripe.fFirstInterval + stripe.fIntervalCount - 1);
+    const size_t length = decode.fHeaderLength + (dataEnd - dataStart) + 2;
+
+    SkAutoMalloc storage(length);
+    uint8_t* jpeg = (uint8_t*)storage.get();
+    memcpy(jpeg, decode.fData, decode.fHeaderLength);
+    jpeg[decode.fHeightOffset] = (stripe.fHeight >> 8) & 0xFF;
+    jpeg[decode.fHeightOffset + 1] = stripe.fHeight & 0xFF;
+    uint8_t* scan = jpeg + decode.fHeaderLength;
+    memcpy(scan, decode.fData + dataStart, dataEnd - dataStart);
+    for (int i = 1; i < stripe.fIntervalCount; ++i) {
+        const size_t marker = decode.fRestarts[stripe.fFirstInterval + i - 1];
+        scan[marker - dataStart + 1] = kMarker_RST0 + ((i - 1) & 7);
+    }
+    jpeg[length - 2] = 0xFF;
+    jpeg[length - 1] = kMarker_EOI;
+
+    // The stripe's rows, sharing the bitmap's pixels.
+    const SkBitmap& bm = *decode.fBitmap;
+    SkImageInfo info = bm.info();
+    info.fHeight = stripe.fHeight;
+    SkBitmap rows;
+    rows.installPixels(info, bm.getAddr(0, stripe.fTop), bm.rowBytes(), NULL, NULL);
+
+    SkMemoryStream stream(jpeg, length, false);
+    JPEGAutoClean autoClean;
+    jpeg_decompress_struct cinfo;
+    skjpeg_source_mgr srcManager(&stream, decode.fDecoder);
+    skjpeg_error_mgr errorManager;
+    set_error_mgr(&cinfo, &errorManager);
+    SkScaledBitmapSampler sampler(info.fWidth, info.fHeight, 1);
+    SkAutoMalloc srcStorage(info.fWidth * decode.fSrcBytesPerPixel);
+    uint8_t* srcRow = (uint8_t*)srcStorage.get();
+
+    if (setjmp(errorManager.fJmpBuf)) {
+        return false;
+    }
+    initialize_info(&cinfo, &srcManager);
+    autoClean.set(&cinfo);
+    if (JPEG_HEADER_OK != jpeg_read_header(&cinfo, true)) {
+        return false;
+    }
+    cinfo.dct_method = decode.fDCTMethod;
+    cinfo.out_color_space = decode.fOutColorSpace;
+    cinfo.dither_mode = decode.fDitherMode;
+    turn_off_visual_optimizations(&cinfo);
+    if (!jpeg_start_decompress(&cinfo) ||
+        (int)cinfo.output_width != info.fWidth || (int)cinfo.output_height != info.fHeight) {
+        return false;
+    }
+    if (!sampler.begin(&rows, decode.fSrcConfig, *decode.fDecoder)) {
+        return false;
+    }
+    for (int y = 0; y < info.fHeight; ++y) {
+        JSAMPLE* rowptr = (JSAMPLE*)srcRow;
+        if (1 != jpeg_read_scanlines(&cinfo, &rowptr, 1)) {
+            return false;
+        }
+        if (JCS_CMYK == cinfo.out_color_space) {
+            convert_CMYK_to_RGB(srcRow, cinfo.output_width);
+        }
+        sampler.next(srcRow);
+    }
+    jpeg_finish_decompress(&cinfo);
+    return true;
+}
+
+void restart_worker_proc(void* data) {
+    RestartDecode* decode = static_cast<RestartDecode*>(data);
+    for (;;) {
+        int32_t index = sk_atomic_inc(&decode->fNextStripe);
+        if (index >= decode->fStripes.count()) {
+            return;
+        }
+        if (decode->fFailed || !decode_stripe(*decode, decode->fStripes[index])) {
+            sk_atomic_inc(&decode->fFailed);
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ *  Decodes the whole image into bm, which must be allocated and locked, on
+ *  up to threadCount threads. cinfo must have started decompressing data,
+ *  the complete encoded image, at full size and have read no scanlines.
+ *  Returns false (and bm's pixels are undefined) if the image has no
+ *  restart markers where we need them, in which case the caller goes on to
+ *  decode it serially with cinfo.
+ */
+static bool decode_restart_intervals(const jpeg_decompress_struct& cinfo,
+                                     const void* data, size_t length,
+                                     SkImageDecoder* decoder,
+                                     SkScaledBitmapSampler::SrcConfig sc,
+                                     int srcBytesPerPixel, int threadCount,
+                                     SkBitmap* bm) {
+    if (threadCount <= 1 || 0 == cinfo.restart_interval || cinfo.progressive_mode ||
+        cinfo.comps_in_scan != cinfo.num_components ||
+        cinfo.output_width != cinfo.image_width || cinfo.output_height != cinfo.image_height ||
+        (int)cinfo.output_width != bm->width() || (int)cinfo.output_height != bm->height() ||
+        bm->width() * bm->height() < kMinParallelPixels) {
+        return false;
+    }
+
+    RestartDecode decode;
+    if (!find_restarts((const uint8_t*)data, length, &decode) ||
+        !make_stripes(cinfo, threadCount * kStripesPerThread, &decode)) {
+        return false;
+    }
+    decode.fDecoder = decoder;
+    decode.fBitmap = bm;
+    decode.fOutColorSpace = cinfo.out_color_space;
+    decode.fDCTMethod = cinfo.dct_method;
+    decode.fDitherMode = cinfo.dither_mode;
+    decode.fSrcConfig = sc;
+    decode.fSrcBytesPerPixel = srcBytesPerPixel;
+    decode.fNextStripe = 0;
+    decode.fFailed = 0;
+
+    threadCount = SkMin32(threadCount, decode.fStripes.count());
+    // The calling thread decodes stripes too, so start one fewer worker.
+    SkTDArray<SkThread*> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        SkThread* thread = SkNEW_ARGS(SkThread, (restart_worker_proc, &decode));
+        if (!thread->start()) {
+            // Its stripes are picked up by the other threads.
+            SkDELETE(thread);
+            continue;
+        }
+        *threads.append() = thread;
+    }
+
+    restart_worker_proc(&decode);
+
+    for (int i = 0; i < threads.count(); ++i) {
+        threads[i]->join();
+        SkDELETE(threads[i]);
+    }
+    return 0 == decode.fFailed;
+}
+
 bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
 #ifdef TIME_DECODE
     SkAutoTime atm("JPEG Decode");
@@ -536,6 +888,16 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
 
     JPEGAutoClean autoClean;
 
+    // Decoding restart intervals in parallel needs the whole encoded image
+    // in memory.
+    const void* data = NULL;
+    size_t dataLength = 0;
+    if (c_JPEGDecodeThreadCount > 1 && stream->hasLength() &&
+        stream->hasPosition() && 0 == stream->getPosition()) {
+        data = stream->getMemoryBase();
+        dataLength = stream->getLength();
+    }
+
     jpeg_decompress_struct  cinfo;
     skjpeg_source_mgr       srcManager(stream, this);
 
@@ -636,6 +998,17 @@ bool SkJPEGImageDecoder::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
 
     SkAutoLockPixels alp(*bm);
 
+    if (1 == sampleSize && NULL != data) {
+        SkScaledBitmapSampler::SrcConfig sc;
+        int srcBytesPerPixel;
+        if (get_src_config(cinfo, &sc, &srcBytesPerPixel) &&
+            decode_restart_intervals(cinfo, data, dataLength, this, sc, srcBytesPerPixel,
+                                     c_JPEGDecodeThreadCount, bm)) {
+            return true;
+        }
+        // Otherwise cinfo has not read any scanlines yet; decode serially.
+    }
+
 #ifdef ANDROID_RGB
     /* short-circuit the SkScaledBitmapSampler when possible, as this gives
        a significant performance boost.
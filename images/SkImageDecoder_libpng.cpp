@@ -17,12 +17,22 @@
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
+#include "SkThread.h"
+#include "SkThreadUtils.h"
 #include "SkUtils.h"
 #include "transform_scanline.h"
 extern "C" {
 #include "png.h"
 }
 
+#ifdef SK_SYSTEM_ZLIB
+#include <zlib.h>
+#elif defined(SK_ZLIB_INCLUDE)
+#include SK_ZLIB_INCLUDE
+#else
+#include "zlib.h"
+#endif
+
 /* These were dropped in libpng >= 1.4 */
 #ifndef png_infopp_NULL
 #define png_infopp_NULL NULL
@@ -50,6 +60,21 @@ SK_CONF_DECLARE(bool, c_suppressPNGImageDecoderWarnings,
                 DEFAULT_FOR_SUPPRESS_PNG_IMAGE_DECODER_WARNINGS,
                 "Suppress most PNG warnings when calling image decode "
                 "functions.");
+SK_CONF_DECLARE(int, c_PNGEncodeCompressionLevel,
+                "images.png.encodeCompressionLevel",
+                -1,
+                "zlib compression level for PNG encoding, from 0 (store) to "
+                "9 (smallest). -1 uses zlib's default.");
+SK_CONF_DECLARE(int, c_PNGEncodeFilter,
+                "images.png.encodeFilter",
+                -1,
+                "PNG filter type every row is encoded with, from 0 (None) to "
+                "4 (Paeth). -1 picks one per row.");
+SK_CONF_DECLARE(int, c_PNGEncodeThreadCount,
+                "images.png.encodeThreadCount",
+                1,
+                "Filter and deflate large PNGs in independent stripes on up "
+                "to this many threads.");
 
 
 
@@ -59,7 +84,8 @@ public:
         : fStream(stream)
         , fPng_ptr(png_ptr)
         , fInfo_ptr(info_ptr)
-        , fConfig(SkBitmap::kNo_Config) {
+        , fConfig(SkBitmap::kNo_Config)
+        , fRowsConsumed(false) {
         SkASSERT(stream != NULL);
         stream->ref();
     }
@@ -73,6 +99,10 @@ public:
     png_structp                         fPng_ptr;
     png_infop                           fInfo_ptr;
     SkBitmap::Config                    fConfig;
+    // True once a subset has read image rows from fPng_ptr.  Without the
+    // Android libpng index we cannot seek back, so the next subset has to
+    // start over from the top of fStream.
+    bool                                fRowsConsumed;
 };
 
 class SkPNGImageDecoder : public SkImageDecoder {
@@ -89,10 +119,8 @@ public:
     }
 
 protected:
-#ifdef SK_BUILD_FOR_ANDROID
     virtual bool onBuildTileIndex(SkStreamRewindable *stream, int *width, int *height) SK_OVERRIDE;
     virtual bool onDecodeSubset(SkBitmap* bitmap, const SkIRect& region) SK_OVERRIDE;
-#endif
     virtual bool onDecode(SkStream* stream, SkBitmap* bm, Mode) SK_OVERRIDE;
 
 private:
@@ -164,6 +192,29 @@ static void skip_src_rows(png_structp png_ptr, uint8_t storage[], int count) {
     }
 }
 
+// Positions the decoder at the start of the given pass, at or above the row
+// *actualTop, and returns the row it actually starts from in *actualTop.  Only
+// Android's libpng can seek, using the index from png_build_index(); elsewhere
+// every pass is read in order from its first row.
+static void configure_decoder(png_structp png_ptr, int* actualTop, int pass) {
+#ifdef SK_BUILD_FOR_ANDROID
+    png_configure_decoder(png_ptr, actualTop, pass);
+#else
+    *actualTop = 0;
+#endif
+}
+
+// Reads the count rows of an interlace pass that follow a subset, so that the
+// next pass can begin.  Android's libpng seeks to the next pass instead, and
+// nothing needs to follow the last pass.
+static void finish_pass(png_structp png_ptr, uint8_t storage[], int count, bool lastPass) {
+#ifndef SK_BUILD_FOR_ANDROID
+    if (!lastPass) {
+        skip_src_rows(png_ptr, storage, count);
+    }
+#endif
+}
+
 static bool pos_le(int value, int max) {
     return value > 0 && value <= max;
 }
@@ -729,8 +780,6 @@ bool SkPNGImageDecoder::decodePalette(png_structp png_ptr, png_infop info_ptr,
     return true;
 }
 
-#ifdef SK_BUILD_FOR_ANDROID
-
 bool SkPNGImageDecoder::onBuildTileIndex(SkStreamRewindable* sk_stream, int *width, int *height) {
     png_structp png_ptr;
     png_infop   info_ptr;
@@ -752,7 +801,9 @@ bool SkPNGImageDecoder::onBuildTileIndex(SkStreamRewindable* sk_stream, int *wid
     *width = origWidth;
     *height = origHeight;
 
+#ifdef SK_BUILD_FOR_ANDROID
     png_build_index(png_ptr);
+#endif
 
     if (fImageIndex) {
         SkDELETE(fImageIndex);
@@ -767,6 +818,22 @@ bool SkPNGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
         return false;
     }
 
+#ifndef SK_BUILD_FOR_ANDROID
+    if (fImageIndex->fRowsConsumed) {
+        png_destroy_read_struct(&fImageIndex->fPng_ptr, &fImageIndex->fInfo_ptr,
+                                png_infopp_NULL);
+        png_structp png_ptr;
+        png_infop info_ptr;
+        if (!fImageIndex->fStream->rewind() ||
+            !this->onDecodeInit(fImageIndex->fStream, &png_ptr, &info_ptr)) {
+            return false;
+        }
+        fImageIndex->fPng_ptr = png_ptr;
+        fImageIndex->fInfo_ptr = info_ptr;
+    }
+#endif
+    fImageIndex->fRowsConsumed = true;
+
     png_structp png_ptr = fImageIndex->fPng_ptr;
     png_infop info_ptr = fImageIndex->fInfo_ptr;
     if (setjmp(png_jmpbuf(png_ptr))) {
@@ -845,16 +912,26 @@ bool SkPNGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
     * update the palette for you (ie you selected such a transform above).
     */
 
+#ifdef SK_BUILD_FOR_ANDROID
     // Direct access to png_ptr fields is deprecated in libpng > 1.2.
 #if defined(PNG_1_0_X) || defined (PNG_1_2_X)
     png_ptr->pass = 0;
 #else
     // FIXME: This sets pass as desired, but also sets iwidth. Is that ok?
     png_set_interlaced_pass(png_ptr, 0);
+#endif
 #endif
     png_read_update_info(png_ptr, info_ptr);
 
     int actualTop = rect.fTop;
+    const int rowsBelow = origHeight - rect.fBottom;
+
+    // Rows outside the subset are read into their own scratch row.  With
+    // interlacing libpng only writes the current pass's pixels into a row,
+    // so reading them into a row of the subset would clobber pixels an
+    // earlier pass left there.
+    SkAutoMalloc skipStorage(png_get_rowbytes(png_ptr, info_ptr));
+    uint8_t* skipRow = (uint8_t*)skipStorage.get();
 
     if ((SkBitmap::kA8_Config == config || SkBitmap::kIndex8_Config == config)
         && 1 == sampleSize) {
@@ -868,16 +945,14 @@ bool SkPNGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
         }
 
         for (int i = 0; i < number_passes; i++) {
-            png_configure_decoder(png_ptr, &actualTop, i);
-            for (int j = 0; j < rect.fTop - actualTop; j++) {
-                uint8_t* bmRow = decodedBitmap.getAddr8(0, 0);
-                png_read_rows(png_ptr, &bmRow, png_bytepp_NULL, 1);
-            }
+            configure_decoder(png_ptr, &actualTop, i);
+            skip_src_rows(png_ptr, skipRow, rect.fTop - actualTop);
             png_uint_32 bitmapHeight = (png_uint_32) decodedBitmap.height();
             for (png_uint_32 y = 0; y < bitmapHeight; y++) {
                 uint8_t* bmRow = decodedBitmap.getAddr8(0, y);
                 png_read_rows(png_ptr, &bmRow, png_bytepp_NULL, 1);
             }
+            finish_pass(png_ptr, skipRow, rowsBelow, i == number_passes - 1);
         }
     } else {
         SkScaledBitmapSampler::SrcConfig sc;
@@ -908,22 +983,21 @@ bool SkPNGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
         const int height = decodedBitmap.height();
 
         if (number_passes > 1) {
-            SkAutoMalloc storage(origWidth * origHeight * srcBytesPerPixel);
+            // Only the subset's rows have to be kept across passes.
+            SkAutoMalloc storage(origWidth * rect.height() * srcBytesPerPixel);
             uint8_t* base = (uint8_t*)storage.get();
             size_t rb = origWidth * srcBytesPerPixel;
 
             for (int i = 0; i < number_passes; i++) {
-                png_configure_decoder(png_ptr, &actualTop, i);
-                for (int j = 0; j < rect.fTop - actualTop; j++) {
-                    uint8_t* bmRow = (uint8_t*)decodedBitmap.getPixels();
-                    png_read_rows(png_ptr, &bmRow, png_bytepp_NULL, 1);
-                }
+                configure_decoder(png_ptr, &actualTop, i);
+                skip_src_rows(png_ptr, skipRow, rect.fTop - actualTop);
                 uint8_t* row = base;
                 for (int32_t y = 0; y < rect.height(); y++) {
                     uint8_t* bmRow = row;
                     png_read_rows(png_ptr, &bmRow, png_bytepp_NULL, 1);
                     row += rb;
                 }
+                finish_pass(png_ptr, skipRow, rowsBelow, i == number_passes - 1);
             }
             // now sample it
             base += sampler.srcY0() * rb;
@@ -935,13 +1009,9 @@ bool SkPNGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
             SkAutoMalloc storage(origWidth * srcBytesPerPixel);
             uint8_t* srcRow = (uint8_t*)storage.get();
 
-            png_configure_decoder(png_ptr, &actualTop, 0);
+            configure_decoder(png_ptr, &actualTop, 0);
             skip_src_rows(png_ptr, srcRow, sampler.srcY0());
-
-            for (int i = 0; i < rect.fTop - actualTop; i++) {
-                uint8_t* bmRow = (uint8_t*)decodedBitmap.getPixels();
-                png_read_rows(png_ptr, &bmRow, png_bytepp_NULL, 1);
-            }
+            skip_src_rows(png_ptr, skipRow, rect.fTop - actualTop);
             for (int y = 0; y < height; y++) {
                 uint8_t* tmp = srcRow;
                 png_read_rows(png_ptr, &tmp, png_bytepp_NULL, 1);
@@ -988,7 +1058,6 @@ bool SkPNGImageDecoder::onDecodeSubset(SkBitmap* bm, const SkIRect& region) {
     return this->cropBitmap(bm, &decodedBitmap, sampleSize, region.x(), region.y(),
                             region.width(), region.height(), 0, rect.y());
 }
-#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -1181,6 +1250,285 @@ bool SkPNGImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bitmap,
                     bitDepth, config, sig_bit);
 }
 
+namespace {
+
+// Each stripe restarts the deflate stream's history, which costs a little
+// compression, so only images at least this large are split.
+const int kMinParallelEncodePixels = 1024 * 1024;
+
+// More stripes than threads evens out stripes that compress at different
+// speeds.
+const int kEncodeStripesPerThread = 2;
+
+const size_t kDeflateBufferSize = 64 * 1024;
+
+// PNG filter types, as stored in the byte that starts each filtered row.
+enum {
+    kNone_PNGFilter,
+    kSub_PNGFilter,
+    kUp_PNGFilter,
+    kAverage_PNGFilter,
+    kPaeth_PNGFilter,
+
+    kPNGFilterCount
+};
+
+inline uint8_t paeth_predictor(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = SkAbs32(p - a);
+    const int pb = SkAbs32(p - b);
+    const int pc = SkAbs32(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+/**
+ *  Filters rowSize bytes of row, whose pixels take bpp bytes, into dst, which
+ *  starts with the filter type byte. prev is the row above, or NULL for the
+ *  first row of the image.
+ */
+void filter_row(int filter, const uint8_t* row, const uint8_t* prev, int rowSize, int bpp,
+                uint8_t* dst) {
+    *dst++ = filter;
+    for (int i = 0; i < rowSize; ++i) {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = NULL != prev ? prev[i] : 0;
+        const int c = NULL != prev && i >= bpp ? prev[i - bpp] : 0;
+        int predictor;
+        switch (filter) {
+            case kSub_PNGFilter:
+                predictor = a;
+                break;
+            case kUp_PNGFilter:
+                predictor = b;
+                break;
+            case kAverage_PNGFilter:
+                predictor = (a + b) >> 1;
+                break;
+            case kPaeth_PNGFilter:
+                predictor = paeth_predictor(a, b, c);
+                break;
+            default:
+                predictor = 0;
+                break;
+        }
+        dst[i] = row[i] - predictor;
+    }
+}
+
+// As libpng's heuristic: the filtered row whose bytes, taken as signed, have
+// the smallest sum of magnitudes tends to deflate best.
+unsigned filtered_row_cost(const uint8_t* filtered, int rowSize) {
+    unsigned cost = 0;
+    for (int i = 0; i < rowSize; ++i) {
+        cost += SkAbs32((int8_t)filtered[i]);
+    }
+    return cost;
+}
+
+struct EncodeStripe {
+    int                     fTop;
+    int                     fHeight;
+    SkDynamicMemoryWStream* fDeflated;
+    uLong                   fAdler;     // of the filtered rows
+};
+
+struct ParallelEncode {
+    const SkBitmap*         fBitmap;
+    transform_scanline_proc fProc;
+    int                     fRowSize;   // bytes in a transformed row
+    int                     fBpp;
+    int                     fFilter;    // -1 to choose per row
+    int                     fLevel;
+    SkTDArray<EncodeStripe> fStripes;
+    int32_t                 fNextStripe;
+    int32_t                 fFailed;
+};
+
+/**
+ *  Filters the stripe's rows and deflates them as a raw stream that ends
+ *  on a byte boundary, so the stripes can be concatenated. Only the last
+ *  stripe finishes the stream.
+ */
+bool encode_stripe(const ParallelEncode& encode, EncodeStripe* stripe) {
+    const SkBitmap& bm = *encode.fBitmap;
+    const int rowSize = encode.fRowSize;
+    const int filteredSize = rowSize + 1;
+    const int candidateCount = encode.fFilter < 0 ? kPNGFilterCount : 1;
+    SkAutoMalloc storage(2 * rowSize + (candidateCount + 1) * filteredSize + kDeflateBufferSize);
+    uint8_t* row = (uint8_t*)storage.get();
+    uint8_t* prev = row + rowSize;
+    uint8_t* candidates = prev + rowSize;
+    uint8_t* filtered = candidates + candidateCount * filteredSize;
+    uint8_t* out = filtered + filteredSize;
+
+    // The filters of the first row refer to the last row of the stripe above.
+    bool hasPrev = stripe->fTop > 0;
+    if (hasPrev) {
+        encode.fProc((const char*)bm.getAddr(0, stripe->fTop - 1), bm.width(), (char*)prev);
+    }
+
+    z_stream zstream;
+    memset(&zstream, 0, sizeof(zstream));
+    if (Z_OK != deflateInit2(&zstream, encode.fLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                             Z_DEFAULT_STRATEGY)) {
+        return false;
+    }
+    const bool isLast = stripe->fTop + stripe->fHeight == bm.height();
+    stripe->fAdler = adler32(0L, Z_NULL, 0);
+    bool ok = true;
+    for (int y = 0; y < stripe->fHeight && ok; ++y) {
+        encode.fProc((const char*)bm.getAddr(0, stripe->fTop + y), bm.width(), (char*)row);
+        const uint8_t* prevRow = hasPrev ? prev : NULL;
+        if (encode.fFilter >= 0) {
+            filter_row(encode.fFilter, row, prevRow, rowSize, encode.fBpp, filtered);
+        } else {
+            unsigned bestCost = ~0U;
+            for (int f = 0; f < kPNGFilterCount; ++f) {
+                uint8_t* candidate = candidates + f * filteredSize;
+                filter_row(f, row, prevRow, rowSize, encode.fBpp, candidate);
+                unsigned cost = filtered_row_cost(candidate + 1, rowSize);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    memcpy(filtered, candidate, filteredSize);
+                }
+            }
+        }
+        stripe->fAdler = adler32(stripe->fAdler, filtered, filteredSize);
+        SkTSwap(row, prev);
+        hasPrev = true;
+
+        const bool isLastRow = y == stripe->fHeight - 1;
+        const int flush = !isLastRow ? Z_NO_FLUSH : (isLast ? Z_FINISH : Z_SYNC_FLUSH);
+        zstream.next_in = filtered;
+        zstream.avail_in = filteredSize;
+        do {
+            zstream.next_out = out;
+            zstream.avail_out = kDeflateBufferSize;
+            int result = deflate(&zstream, flush);
+            if (Z_STREAM_ERROR == result ||
+                !stripe->fDeflated->write(out, kDeflateBufferSize - zstream.avail_out)) {
+                ok = false;
+                break;
+            }
+        } while (0 == zstream.avail_out);
+    }
+    deflateEnd(&zstream);
+    return ok;
+}
+
+void encode_worker_proc(void* data) {
+    ParallelEncode* encode = static_cast<ParallelEncode*>(data);
+    for (;;) {
+        int32_t index = sk_atomic_inc(&encode->fNextStripe);
+        if (index >= encode->fStripes.count()) {
+            return;
+        }
+        if (encode->fFailed || !encode_stripe(*encode, &encode->fStripes[index])) {
+            sk_atomic_inc(&encode->fFailed);
+        }
+    }
+}
+
+const png_byte gIDATChunkName[5] = { 'I', 'D', 'A', 'T', '\0' };
+const png_byte gIENDChunkName[5] = { 'I', 'E', 'N', 'D', '\0' };
+
+}  // namespace
+
+/**
+ *  Filters and deflates bitmap in stripes on up to threadCount threads, as
+ *  pigz does, and writes the concatenated stripes as the image data,
+ *  followed by the end of the PNG. The header chunks must have been
+ *  written. Returns false, having written nothing, if the stripes couldn't
+ *  be encoded; png_ptr is then still ready for the rows.
+ */
+static bool write_parallel_deflated_image(png_structp png_ptr, const SkBitmap& bitmap,
+                                          transform_scanline_proc proc, int bpp,
+                                          int filter, int level, int threadCount) {
+    ParallelEncode encode;
+    encode.fBitmap = &bitmap;
+    encode.fProc = proc;
+    encode.fRowSize = bitmap.width() * bpp;
+    encode.fBpp = bpp;
+    encode.fFilter = filter;
+    encode.fLevel = level;
+    encode.fNextStripe = 0;
+    encode.fFailed = 0;
+
+    const int stripeCount = SkMin32(threadCount * kEncodeStripesPerThread, bitmap.height());
+    int top = 0;
+    for (int i = 0; i < stripeCount; ++i) {
+        const int bottom = (int)((int64_t)bitmap.height() * (i + 1) / stripeCount);
+        EncodeStripe* stripe = encode.fStripes.append();
+        stripe->fTop = top;
+        stripe->fHeight = bottom - top;
+        stripe->fDeflated = SkNEW(SkDynamicMemoryWStream);
+        top = bottom;
+    }
+
+    threadCount = SkMin32(threadCount, stripeCount);
+    // The calling thread encodes stripes too, so start one fewer worker.
+    SkTDArray<SkThread*> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        SkThread* thread = SkNEW_ARGS(SkThread, (encode_worker_proc, &encode));
+        if (!thread->start()) {
+            // Its stripes are picked up by the other threads.
+            SkDELETE(thread);
+            continue;
+        }
+        *threads.append() = thread;
+    }
+
+    encode_worker_proc(&encode);
+
+    for (int i = 0; i < threads.count(); ++i) {
+        threads[i]->join();
+        SkDELETE(threads[i]);
+    }
+
+    // A zlib stream: a header, the deflated data and the Adler-32 of all of it.
+    size_t total = 2 + 4;
+    uLong adler = adler32(0L, Z_NULL, 0);
+    for (int i = 0; i < encode.fStripes.count(); ++i) {
+        const EncodeStripe& stripe = encode.fStripes[i];
+        const size_t filteredLength = (size_t)stripe.fHeight * (encode.fRowSize + 1);
+        adler = adler32_combine(adler, stripe.fAdler, filteredLength);
+        total += stripe.fDeflated->getOffset();
+    }
+    bool ok = 0 == encode.fFailed && total <= PNG_UINT_31_MAX;
+    if (ok) {
+        // The header's level bits are only a hint to recompressors.
+        const int levelBits = level < 0 ? 2 : (level < 2 ? 0 : (level < 6 ? 1 : 2 + (level > 6)));
+        png_byte header[2] = { 0x78, (png_byte)(levelBits << 6) };
+        header[1] += (31 - ((header[0] << 8) | header[1]) % 31) % 31;
+        png_byte trailer[4] = {
+            (png_byte)(adler >> 24), (png_byte)(adler >> 16), (png_byte)(adler >> 8),
+            (png_byte)adler
+        };
+        SkAutoMalloc data;
+        png_write_chunk_start(png_ptr, (png_bytep)gIDATChunkName, (png_uint_32)total);
+        png_write_chunk_data(png_ptr, header, sizeof(header));
+        for (int i = 0; i < encode.fStripes.count(); ++i) {
+            SkDynamicMemoryWStream* deflated = encode.fStripes[i].fDeflated;
+            data.reset(deflated->getOffset());
+            deflated->copyTo(data.get());
+            png_write_chunk_data(png_ptr, (png_bytep)data.get(), deflated->getOffset());
+            // Free what has been written as we go.
+            deflated->reset();
+        }
+        png_write_chunk_data(png_ptr, trailer, sizeof(trailer));
+        png_write_chunk_end(png_ptr);
+        png_write_chunk(png_ptr, (png_bytep)gIENDChunkName, NULL, 0);
+    }
+
+    for (int i = 0; i < encode.fStripes.count(); ++i) {
+        SkDELETE(encode.fStripes[i].fDeflated);
+    }
+    return ok;
+}
+
 bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
                   const bool& hasAlpha, int colorType,
                   int bitDepth, SkBitmap::Config config,
@@ -1238,12 +1586,37 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
     }
 
     png_set_sBIT(png_ptr, info_ptr, &sig_bit);
+
+    const int level = SkTPin<int>(c_PNGEncodeCompressionLevel, -1, 9);
+    const int filter = SkTPin<int>(c_PNGEncodeFilter, -1, kPNGFilterCount - 1);
+    if (level >= 0) {
+        png_set_compression_level(png_ptr, level);
+    }
+    if (filter >= 0) {
+        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE << filter);
+    }
     png_write_info(png_ptr, info_ptr);
 
+    transform_scanline_proc proc = choose_proc(config, hasAlpha);
+
+    // Stripes are filtered on their own, which needs whole bytes per pixel.
+    if (c_PNGEncodeThreadCount > 1 && 8 == bitDepth &&
+        bitmap.width() * bitmap.height() >= kMinParallelEncodePixels) {
+        int bpp = 1;
+        if (!(colorType & PNG_COLOR_MASK_PALETTE)) {
+            bpp = (colorType & PNG_COLOR_MASK_ALPHA) ? 4 : 3;
+        }
+        if (write_parallel_deflated_image(png_ptr, bitmap, proc, bpp, filter,
+                                          level, c_PNGEncodeThreadCount)) {
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+            return true;
+        }
+        // Otherwise nothing was written after the header; encode serially.
+    }
+
     const char* srcImage = (const char*)bitmap.getPixels();
     SkAutoSMalloc<1024> rowStorage(bitmap.width() << 2);
     char* storage = (char*)rowStorage.get();
-    transform_scanline_proc proc = choose_proc(config, hasAlpha);
 
     for (int y = 0; y < bitmap.height(); y++) {
         png_bytep row_ptr = (png_bytep)storage;
@@ -17,6 +17,8 @@
 #include "SkImageDecoder.h"
 #include "SkImageEncoder.h"
 #include "SkColorPriv.h"
+#include "SkConfig8888.h"
+#include "SkRTConf.h"
 #include "SkScaledBitmapSampler.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
@@ -475,27 +477,21 @@ static void ARGB_8888_To_RGB(const uint8_t* in, uint8_t* rgb, int width,
 
 static void ARGB_8888_To_RGBA(const uint8_t* in, uint8_t* rgb, int width,
                               const SkPMColor*) {
-  const uint32_t* SK_RESTRICT src = (const uint32_t*)in;
-  const SkUnPreMultiply::Scale* SK_RESTRICT table =
-      SkUnPreMultiply::GetScaleTable();
-  for (int i = 0; i < width; ++i) {
-      const uint32_t c = *src++;
-      uint8_t a = SkGetPackedA32(c);
-      uint8_t r = SkGetPackedR32(c);
-      uint8_t g = SkGetPackedG32(c);
-      uint8_t b = SkGetPackedB32(c);
-      if (0 != a && 255 != a) {
-        SkUnPreMultiply::Scale scale = table[a];
-        r = SkUnPreMultiply::ApplyScale(scale, r);
-        g = SkUnPreMultiply::ApplyScale(scale, g);
-        b = SkUnPreMultiply::ApplyScale(scale, b);
-      }
-      rgb[0] = r;
-      rgb[1] = g;
-      rgb[2] = b;
-      rgb[3] = a;
-      rgb += 4;
-  }
+  // rgb rows are four bytes per pixel from the start of a new[] buffer, so
+  // they can be written as 32 bit RGBA pixels.
+  SkDstPixelInfo dstPI;
+  dstPI.fColorType = kRGBA_8888_SkColorType;
+  dstPI.fAlphaType = kUnpremul_SkAlphaType;
+  dstPI.fPixels = rgb;
+  dstPI.fRowBytes = width * 4;
+
+  SkSrcPixelInfo srcPI;
+  srcPI.fColorType = kN32_SkColorType;
+  srcPI.fAlphaType = kPremul_SkAlphaType;
+  srcPI.fPixels = in;
+  srcPI.fRowBytes = width * 4;
+
+  srcPI.convertPixelsTo(&dstPI, width, 1);
 }
 
 static void RGB_565_To_RGB(const uint8_t* in, uint8_t* rgb, int width,
@@ -596,6 +592,28 @@ static int stream_writer(const uint8_t* data, size_t data_size,
   return stream->write(data, data_size) ? 1 : 0;
 }
 
+// SkImageEncoder only takes a quality, so the other libwebp settings are
+// runtime configs.
+SK_CONF_DECLARE(bool, c_WEBPEncodeLossless,
+                "images.webp.encodeLossless",
+                false,
+                "Encode WebP losslessly. The quality then trades encoding "
+                "speed for size rather than fidelity.");
+SK_CONF_DECLARE(int, c_WEBPEncodeMethod,
+                "images.webp.encodeMethod",
+                4,
+                "libwebp's compression method, from 0 (fastest) to 6 "
+                "(smallest).");
+SK_CONF_DECLARE(bool, c_WEBPEncodeThreaded,
+                "images.webp.encodeThreaded",
+                true,
+                "Let libwebp encode on more than one thread.");
+SK_CONF_DECLARE(int, c_WEBPEncodeAlphaFiltering,
+                "images.webp.encodeAlphaFiltering",
+                1,
+                "Filtering of lossy WebP alpha: 0 for none, 1 for fast, "
+                "2 for best.");
+
 class SkWEBPImageEncoder : public SkImageEncoder {
 protected:
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) SK_OVERRIDE;
@@ -628,9 +646,18 @@ bool SkWEBPImageEncoder::onEncode(SkWStream* stream, const SkBitmap& bm,
     if (!WebPConfigPreset(&webp_config, WEBP_PRESET_DEFAULT, (float) quality)) {
         return false;
     }
+    webp_config.lossless = c_WEBPEncodeLossless ? 1 : 0;
+    webp_config.method = SkPin32(c_WEBPEncodeMethod, 0, 6);
+    webp_config.thread_level = c_WEBPEncodeThreaded ? 1 : 0;
+    webp_config.alpha_filtering = SkPin32(c_WEBPEncodeAlphaFiltering, 0, 2);
+    if (!WebPValidateConfig(&webp_config)) {
+        return false;
+    }
 
     WebPPicture pic;
     WebPPictureInit(&pic);
+    // Lossless encoding works on ARGB; lossy converts to YUV on import.
+    pic.use_argb = webp_config.lossless;
     pic.width = bm.width();
     pic.height = bm.height();
     pic.writer = stream_writer;
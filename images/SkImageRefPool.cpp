@@ -12,12 +12,11 @@
 SkImageRefPool::SkImageRefPool() {
     fRAMBudget = 0; // means no explicit limit
     fRAMUsed = 0;
-    fCount = 0;
-    fHead = fTail = NULL;
+    fPurgeCount = 0;
 }
 
 SkImageRefPool::~SkImageRefPool() {
-    //    SkASSERT(NULL == fHead);
+    //    SkASSERT(NULL == fDecoded.fHead && NULL == fEmpty.fHead);
 }
 
 void SkImageRefPool::setRAMBudget(size_t size) {
@@ -35,15 +34,20 @@ void SkImageRefPool::justAddedPixels(SkImageRef* ref) {
              ref->fBitmap.bytesPerPixel(),
              ref->fBitmap.getSize(), (int)fRAMUsed);
 #endif
+    // ref had no pixels until now, so it moves to the decoded list.
+    Remove(&fEmpty, ref);
+    AddToHead(&fDecoded, ref);
     fRAMUsed += ref->ramUsed();
     this->purgeIfNeeded();
 }
 
 void SkImageRefPool::canLosePixels(SkImageRef* ref) {
-    // the refs near fHead have recently been released (used)
+    // the refs near the head have recently been released (used)
     // if we purge, we purge from the tail
-    this->detach(ref);
-    this->addToHead(ref);
+    if (NULL != ref->fBitmap.getPixels()) {
+        Remove(&fDecoded, ref);
+        AddToHead(&fDecoded, ref);
+    }
     this->purgeIfNeeded();
 }
 
@@ -55,14 +59,17 @@ void SkImageRefPool::purgeIfNeeded() {
 }
 
 void SkImageRefPool::setRAMUsed(size_t limit) {
-    SkImageRef* ref = fTail;
+    SkImageRef* ref = fDecoded.fTail;
 
     while (NULL != ref && fRAMUsed > limit) {
+        SkImageRef* prev = ref->fPrev;
+        SkASSERT(NULL != ref->fBitmap.getPixels());
         // only purge it if its pixels are unlocked
-        if (!ref->isLocked() && ref->fBitmap.getPixels()) {
+        if (!ref->isLocked()) {
             size_t size = ref->ramUsed();
             SkASSERT(size <= fRAMUsed);
             fRAMUsed -= size;
+            fPurgeCount += 1;
 
 #ifdef DUMP_IMAGEREF_LIFECYCLE
             SkDebugf("=== ImagePool: purge %s [%d %d %d] bytes=%d heap=%d\n",
@@ -76,59 +83,78 @@ void SkImageRefPool::setRAMUsed(size_t limit) {
             // just clear the pixel memory
             ref->fBitmap.setPixels(NULL);
             SkASSERT(NULL == ref->fBitmap.getPixels());
+            Remove(&fDecoded, ref);
+            AddToHead(&fEmpty, ref);
         }
-        ref = ref->fPrev;
+        ref = prev;
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
+SkImageRefPool::List& SkImageRefPool::listFor(SkImageRef* ref) {
+    return (NULL != ref->fBitmap.getPixels()) ? fDecoded : fEmpty;
+}
+
 void SkImageRefPool::addToHead(SkImageRef* ref) {
-    ref->fNext = fHead;
+    AddToHead(&this->listFor(ref), ref);
+    fRAMUsed += ref->ramUsed();
+}
+
+void SkImageRefPool::addToTail(SkImageRef* ref) {
+    AddToTail(&this->listFor(ref), ref);
+    fRAMUsed += ref->ramUsed();
+}
+
+void SkImageRefPool::detach(SkImageRef* ref) {
+    Remove(&this->listFor(ref), ref);
+
+    SkASSERT(fRAMUsed >= ref->ramUsed());
+    fRAMUsed -= ref->ramUsed();
+}
+
+void SkImageRefPool::AddToHead(List* list, SkImageRef* ref) {
+    ref->fNext = list->fHead;
     ref->fPrev = NULL;
 
-    if (fHead) {
-        SkASSERT(NULL == fHead->fPrev);
-        fHead->fPrev = ref;
+    if (list->fHead) {
+        SkASSERT(NULL == list->fHead->fPrev);
+        list->fHead->fPrev = ref;
     }
-    fHead = ref;
+    list->fHead = ref;
 
-    if (NULL == fTail) {
-        fTail = ref;
+    if (NULL == list->fTail) {
+        list->fTail = ref;
     }
-    fCount += 1;
-    SkASSERT(computeCount() == fCount);
-
-    fRAMUsed += ref->ramUsed();
+    list->fCount += 1;
+    SkASSERT(ComputeCount(*list) == list->fCount);
 }
 
-void SkImageRefPool::addToTail(SkImageRef* ref) {
+void SkImageRefPool::AddToTail(List* list, SkImageRef* ref) {
     ref->fNext = NULL;
-    ref->fPrev = fTail;
+    ref->fPrev = list->fTail;
 
-    if (fTail) {
-        SkASSERT(NULL == fTail->fNext);
-        fTail->fNext = ref;
+    if (list->fTail) {
+        SkASSERT(NULL == list->fTail->fNext);
+        list->fTail->fNext = ref;
     }
-    fTail = ref;
+    list->fTail = ref;
 
-    if (NULL == fHead) {
-        fHead = ref;
+    if (NULL == list->fHead) {
+        list->fHead = ref;
     }
-    fCount += 1;
-    SkASSERT(computeCount() == fCount);
-
-    fRAMUsed += ref->ramUsed();
+    list->fCount += 1;
+    SkASSERT(ComputeCount(*list) == list->fCount);
 }
 
-void SkImageRefPool::detach(SkImageRef* ref) {
-    SkASSERT(fCount > 0);
+void SkImageRefPool::Remove(List* list, SkImageRef* ref) {
+    SkASSERT(list->fCount > 0);
 
-    if (fHead == ref) {
-        fHead = ref->fNext;
+    if (list->fHead == ref) {
+        list->fHead = ref->fNext;
     }
-    if (fTail == ref) {
-        fTail = ref->fPrev;
+    if (list->fTail == ref) {
+        list->fTail = ref->fPrev;
     }
     if (ref->fPrev) {
         ref->fPrev->fNext = ref->fNext;
@@ -139,15 +165,12 @@ void SkImageRefPool::detach(SkImageRef* ref) {
 
     ref->fNext = ref->fPrev = NULL;
 
-    fCount -= 1;
-    SkASSERT(computeCount() == fCount);
-
-    SkASSERT(fRAMUsed >= ref->ramUsed());
-    fRAMUsed -= ref->ramUsed();
+    list->fCount -= 1;
+    SkASSERT(ComputeCount(*list) == list->fCount);
 }
 
-int SkImageRefPool::computeCount() const {
-    SkImageRef* ref = fHead;
+int SkImageRefPool::ComputeCount(const List& list) {
+    SkImageRef* ref = list.fHead;
     int count = 0;
 
     while (ref != NULL) {
@@ -156,7 +179,7 @@ int SkImageRefPool::computeCount() const {
     }
 
 #ifdef SK_DEBUG
-    ref = fTail;
+    ref = list.fTail;
     int count2 = 0;
 
     while (ref != NULL) {
@@ -175,18 +198,21 @@ int SkImageRefPool::computeCount() const {
 
 void SkImageRefPool::dump() const {
 #if defined(SK_DEBUG) || defined(DUMP_IMAGEREF_LIFECYCLE)
-    SkDebugf("ImagePool dump: bugdet: %d used: %d count: %d\n",
-             (int)fRAMBudget, (int)fRAMUsed, fCount);
+    SkDebugf("ImagePool dump: bugdet: %d used: %d decoded: %d empty: %d purged: %d\n",
+             (int)fRAMBudget, (int)fRAMUsed, fDecoded.fCount, fEmpty.fCount, fPurgeCount);
 
-    SkImageRef* ref = fHead;
+    const List* lists[] = { &fDecoded, &fEmpty };
+    for (size_t i = 0; i < SK_ARRAY_COUNT(lists); ++i) {
+        SkImageRef* ref = lists[i]->fHead;
 
-    while (ref != NULL) {
-        SkDebugf("  [%3d %3d %d] ram=%d data=%d locked=%d %s\n", ref->fBitmap.width(),
-                 ref->fBitmap.height(), ref->fBitmap.config(),
-                 ref->ramUsed(), (int)ref->fStream->getLength(),
-                 ref->isLocked(), ref->getURI());
+        while (ref != NULL) {
+            SkDebugf("  [%3d %3d %d] ram=%d data=%d locked=%d %s\n", ref->fBitmap.width(),
+                     ref->fBitmap.height(), ref->fBitmap.config(),
+                     ref->ramUsed(), (int)ref->fStream->getLength(),
+                     ref->isLocked(), ref->getURI());
 
-        ref = ref->fNext;
+            ref = ref->fNext;
+        }
     }
 #endif
 }
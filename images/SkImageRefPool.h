@@ -13,6 +13,15 @@
 class SkImageRef;
 class SkImageRef_GlobalPool;
 
+/**
+ *  Keeps the SkImageRefs that share a mutex in LRU order, and frees the
+ *  pixels of the least recently unlocked ones to stay under a RAM budget.
+ *
+ *  Refs whose pixels are decoded are on the LRU list; the others (not yet
+ *  decoded, purged, or failed to decode) are on a second list, so that a
+ *  purge only walks refs it could actually free. Every operation is O(1)
+ *  but the purge, which is linear in the locked refs it has to skip.
+ */
 class SkImageRefPool {
 public:
     SkImageRefPool();
@@ -28,16 +37,33 @@ public:
     void addToTail(SkImageRef*);
     void detach(SkImageRef*);
 
+    int getPurgeCount() const { return fPurgeCount; }
+
     void dump() const;
 
 private:
+    struct List {
+        SkImageRef* fHead;
+        SkImageRef* fTail;
+        int         fCount;
+
+        List() : fHead(NULL), fTail(NULL), fCount(0) {}
+    };
+
+    // Members rather than List methods, since only the pool is a friend of SkImageRef.
+    static void AddToHead(List*, SkImageRef*);
+    static void AddToTail(List*, SkImageRef*);
+    static void Remove(List*, SkImageRef*);
+    static int ComputeCount(const List&);
+
     size_t fRAMBudget;
     size_t fRAMUsed;
+    int    fPurgeCount;
 
-    int         fCount;
-    SkImageRef* fHead, *fTail;
+    List   fDecoded;    // refs holding pixels, most recently unlocked first
+    List   fEmpty;      // refs without pixels
 
-    int computeCount() const;
+    List& listFor(SkImageRef*);
 
     friend class SkImageRef_GlobalPool;
 
@@ -9,34 +9,75 @@
 #include "SkImageRefPool.h"
 #include "SkThread.h"
 
-SK_DECLARE_STATIC_MUTEX(gGlobalPoolMutex);
+/*
+ *  The global pool is split into shards, each with its own mutex and
+ *  SkImageRefPool, so that locking and unlocking refs in different shards
+ *  doesn't contend. The mutex is shared by all the refs of a shard (it is
+ *  their pixel ref mutex), since purging touches refs other than the one
+ *  being unlocked. Refs are dealt to the shards in turn, and each shard
+ *  gets an even share of the budget.
+ */
+#ifdef SK_USE_POSIX_THREADS
+
+    static SkBaseMutex gGlobalPoolMutexes[] = {
+        { PTHREAD_MUTEX_INITIALIZER }, { PTHREAD_MUTEX_INITIALIZER },
+        { PTHREAD_MUTEX_INITIALIZER }, { PTHREAD_MUTEX_INITIALIZER },
+        { PTHREAD_MUTEX_INITIALIZER }, { PTHREAD_MUTEX_INITIALIZER },
+        { PTHREAD_MUTEX_INITIALIZER }, { PTHREAD_MUTEX_INITIALIZER },
+    };
+
+    // must be a power-of-2
+    #define GLOBAL_POOL_SHARD_COUNT SK_ARRAY_COUNT(gGlobalPoolMutexes)
+
+#else // not pthreads
+
+    // must be a power-of-2
+    #define GLOBAL_POOL_SHARD_COUNT     8
+    static SkBaseMutex gGlobalPoolMutexes[GLOBAL_POOL_SHARD_COUNT];
+
+#endif
+
+static SkBaseMutex* next_shard_mutex() {
+    static int32_t gNextShard;
+    SkASSERT(SkIsPow2(GLOBAL_POOL_SHARD_COUNT));
+    int index = sk_atomic_inc(&gNextShard);
+    return &gGlobalPoolMutexes[index & (GLOBAL_POOL_SHARD_COUNT - 1)];
+}
+
+static int shard_index(SkBaseMutex* mutex) {
+    int index = SkToInt(mutex - gGlobalPoolMutexes);
+    SkASSERT(index >= 0 && index < (int)GLOBAL_POOL_SHARD_COUNT);
+    return index;
+}
 
 /*
- *  This returns the lazily-allocated global pool. It must be called
- *  from inside the guard mutex, so we safely only ever allocate 1.
+ *  This returns the lazily-allocated pool of a shard. It must be called
+ *  from inside the shard's mutex, so we safely only ever allocate 1.
  */
-static SkImageRefPool* GetGlobalPool() {
-    static SkImageRefPool* gPool;
-    if (NULL == gPool) {
-        gPool = SkNEW(SkImageRefPool);
+static SkImageRefPool* GetShardPool(int index) {
+    static SkImageRefPool* gPools[GLOBAL_POOL_SHARD_COUNT];
+    if (NULL == gPools[index]) {
+        gPools[index] = SkNEW(SkImageRefPool);
         // call sk_atexit(...) when we have that, to free the global pool
     }
-    return gPool;
+    return gPools[index];
+}
+
+static SkImageRefPool* GetPool(SkBaseMutex* mutex) {
+    return GetShardPool(shard_index(mutex));
 }
 
 SkImageRef_GlobalPool::SkImageRef_GlobalPool(const SkImageInfo& info,
                                              SkStreamRewindable* stream,
                                              int sampleSize)
-        : SkImageRef(info, stream, sampleSize, &gGlobalPoolMutex) {
-    SkASSERT(&gGlobalPoolMutex == this->mutex());
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    GetGlobalPool()->addToHead(this);
+        : SkImageRef(info, stream, sampleSize, next_shard_mutex()) {
+    SkAutoMutexAcquire ac(this->mutex());
+    GetPool(this->mutex())->addToHead(this);
 }
 
 SkImageRef_GlobalPool::~SkImageRef_GlobalPool() {
-    SkASSERT(&gGlobalPoolMutex == this->mutex());
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    GetGlobalPool()->detach(this);
+    SkAutoMutexAcquire ac(this->mutex());
+    GetPool(this->mutex())->detach(this);
 }
 
 /*  By design, onUnlockPixels() already is inside the mutex-lock,
@@ -52,7 +93,7 @@ bool SkImageRef_GlobalPool::onDecode(SkImageDecoder* codec, SkStreamRewindable*
     }
     if (mode == SkImageDecoder::kDecodePixels_Mode) {
         // no need to grab the mutex here, it has already been acquired.
-        GetGlobalPool()->justAddedPixels(this);
+        GetPool(this->mutex())->justAddedPixels(this);
     }
     return true;
 }
@@ -61,40 +102,59 @@ void SkImageRef_GlobalPool::onUnlockPixels() {
     this->INHERITED::onUnlockPixels();
 
     // by design, onUnlockPixels() already is inside the mutex-lock
-    GetGlobalPool()->canLosePixels(this);
+    GetPool(this->mutex())->canLosePixels(this);
 }
 
 SkImageRef_GlobalPool::SkImageRef_GlobalPool(SkReadBuffer& buffer)
-        : INHERITED(buffer, &gGlobalPoolMutex) {
-    SkASSERT(&gGlobalPoolMutex == this->mutex());
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    GetGlobalPool()->addToHead(this);
+        : INHERITED(buffer, next_shard_mutex()) {
+    SkAutoMutexAcquire ac(this->mutex());
+    GetPool(this->mutex())->addToHead(this);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // global imagerefpool wrappers
 
+// Each shard gets this share of a total.
+static size_t shard_share(size_t total) {
+    return (total + GLOBAL_POOL_SHARD_COUNT - 1) / GLOBAL_POOL_SHARD_COUNT;
+}
+
 size_t SkImageRef_GlobalPool::GetRAMBudget() {
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    return GetGlobalPool()->getRAMBudget();
+    size_t budget = 0;
+    for (int i = 0; i < (int)GLOBAL_POOL_SHARD_COUNT; ++i) {
+        SkAutoMutexAcquire ac(gGlobalPoolMutexes[i]);
+        budget += GetShardPool(i)->getRAMBudget();
+    }
+    return budget;
 }
 
 void SkImageRef_GlobalPool::SetRAMBudget(size_t size) {
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    GetGlobalPool()->setRAMBudget(size);
+    for (int i = 0; i < (int)GLOBAL_POOL_SHARD_COUNT; ++i) {
+        SkAutoMutexAcquire ac(gGlobalPoolMutexes[i]);
+        GetShardPool(i)->setRAMBudget(shard_share(size));
+    }
 }
 
 size_t SkImageRef_GlobalPool::GetRAMUsed() {
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    return GetGlobalPool()->getRAMUsed();
+    size_t used = 0;
+    for (int i = 0; i < (int)GLOBAL_POOL_SHARD_COUNT; ++i) {
+        SkAutoMutexAcquire ac(gGlobalPoolMutexes[i]);
+        used += GetShardPool(i)->getRAMUsed();
+    }
+    return used;
 }
 
 void SkImageRef_GlobalPool::SetRAMUsed(size_t usage) {
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    GetGlobalPool()->setRAMUsed(usage);
+    for (int i = 0; i < (int)GLOBAL_POOL_SHARD_COUNT; ++i) {
+        SkAutoMutexAcquire ac(gGlobalPoolMutexes[i]);
+        GetShardPool(i)->setRAMUsed(shard_share(usage));
+    }
 }
 
 void SkImageRef_GlobalPool::DumpPool() {
-    SkAutoMutexAcquire ac(gGlobalPoolMutex);
-    GetGlobalPool()->dump();
+    for (int i = 0; i < (int)GLOBAL_POOL_SHARD_COUNT; ++i) {
+        SkAutoMutexAcquire ac(gGlobalPoolMutexes[i]);
+        SkDebugf("ImagePool shard %d\n", i);
+        GetShardPool(i)->dump();
+    }
 }
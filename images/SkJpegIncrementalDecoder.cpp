@@ -0,0 +1,233 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkJpegIncrementalDecoder.h"
+
+#include "SkColorPriv.h"
+
+SkJpegIncrementalDecoder::SkJpegIncrementalDecoder()
+    : fState(kHeader_State)
+    , fProgressive(false)
+    , fCompleteScan(0)
+    , fPassCount(0)
+    , fDecodedRows(0) {
+    fCInfo.err = jpeg_std_error(&fErrorMgr);
+    fErrorMgr.error_exit = skjpeg_error_exit;
+    jpeg_create_decompress(&fCInfo);
+
+    fSource.init_source = InitSource;
+    fSource.fill_input_buffer = FillInputBuffer;
+    fSource.skip_input_data = SkipInputData;
+    fSource.resync_to_restart = jpeg_resync_to_restart;
+    fSource.term_source = TermSource;
+    fSource.next_input_byte = NULL;
+    fSource.bytes_in_buffer = 0;
+    fSource.fSkip = 0;
+    fSource.fComplete = false;
+    fCInfo.src = &fSource;
+}
+
+SkJpegIncrementalDecoder::~SkJpegIncrementalDecoder() {
+    jpeg_destroy_decompress(&fCInfo);
+}
+
+bool SkJpegIncrementalDecoder::appendData(const void* data, size_t length) {
+    if (kError_State == fState) {
+        return false;
+    }
+    if (kDone_State == fState || fSource.fComplete) {
+        return true;
+    }
+
+    // Keep only what libjpeg hasn't consumed. When it suspends it leaves next_input_byte at the
+    // start of the unit it couldn't finish, so that unit is decoded again from here.
+    size_t unread = fSource.bytes_in_buffer;
+    if (unread > 0 && fSource.next_input_byte != fSource.fData.begin()) {
+        memmove(fSource.fData.begin(), fSource.next_input_byte, unread);
+    }
+    fSource.fData.setCount(SkToInt(unread));
+
+    size_t skip = SkTMin(fSource.fSkip, length);
+    fSource.fSkip -= skip;
+    fSource.fData.append(SkToInt(length - skip), static_cast<const uint8_t*>(data) + skip);
+
+    fSource.next_input_byte = fSource.fData.begin();
+    fSource.bytes_in_buffer = fSource.fData.count();
+    return this->advance();
+}
+
+bool SkJpegIncrementalDecoder::finish() {
+    fSource.fComplete = true;
+    return this->advance();
+}
+
+bool SkJpegIncrementalDecoder::getInfo(SkImageInfo* info) const {
+    if (fBitmap.isNull()) {
+        return false;
+    }
+    *info = fBitmap.info();
+    return true;
+}
+
+bool SkJpegIncrementalDecoder::onHeader() {
+    // libjpeg converts grayscale to RGB itself; CMYK JPEGs would need the inversion the full
+    // decoder does.
+    if (JCS_GRAYSCALE != fCInfo.jpeg_color_space && JCS_YCbCr != fCInfo.jpeg_color_space &&
+        JCS_RGB != fCInfo.jpeg_color_space) {
+        return false;
+    }
+    fCInfo.out_color_space = JCS_RGB;
+
+    fProgressive = SkToBool(jpeg_has_multiple_scans(&fCInfo));
+    fCInfo.buffered_image = fProgressive;
+
+    SkImageInfo info = SkImageInfo::MakeN32Premul(fCInfo.image_width, fCInfo.image_height);
+    if (!fBitmap.allocPixels(info)) {
+        return false;
+    }
+    fBitmap.eraseColor(SK_ColorTRANSPARENT);
+    fRow.reset(fCInfo.image_width * 3);
+    return true;
+}
+
+bool SkJpegIncrementalDecoder::readScanlines() {
+    while (fCInfo.output_scanline < fCInfo.output_height) {
+        int y = fCInfo.output_scanline;
+        JSAMPLE* row = static_cast<JSAMPLE*>(fRow.get());
+        if (0 == jpeg_read_scanlines(&fCInfo, &row, 1)) {
+            return false;
+        }
+        SkPMColor* dst = fBitmap.getAddr32(0, y);
+        for (int x = 0; x < fBitmap.width(); ++x) {
+            dst[x] = SkPackARGB32(0xFF, row[0], row[1], row[2]);
+            row += 3;
+        }
+        fDecodedRows = SkMax32(fDecodedRows, y + 1);
+    }
+    return true;
+}
+
+bool SkJpegIncrementalDecoder::advance() {
+    // Nothing with a destructor may be live across a longjmp here.
+    if (setjmp(fErrorMgr.fJmpBuf)) {
+        fState = kError_State;
+        return false;
+    }
+
+    for (;;) {
+        switch (fState) {
+            case kHeader_State:
+                if (JPEG_SUSPENDED == jpeg_read_header(&fCInfo, TRUE)) {
+                    return true;
+                }
+                if (!this->onHeader()) {
+                    fState = kError_State;
+                    return false;
+                }
+                fState = kStartDecompress_State;
+                break;
+            case kStartDecompress_State:
+                if (!jpeg_start_decompress(&fCInfo)) {
+                    return true;
+                }
+                fState = fProgressive ? kConsumeInput_State : kScanlines_State;
+                break;
+            case kConsumeInput_State: {
+                int ret;
+                do {
+                    ret = jpeg_consume_input(&fCInfo);
+                    if (JPEG_SCAN_COMPLETED == ret || JPEG_REACHED_EOI == ret) {
+                        fCompleteScan = fCInfo.input_scan_number;
+                    }
+                } while (JPEG_SUSPENDED != ret && JPEG_REACHED_EOI != ret);
+
+                if (fCompleteScan > fCInfo.output_scan_number) {
+                    fState = kStartOutput_State;
+                } else if (jpeg_input_complete(&fCInfo)) {
+                    fState = kFinishDecompress_State;
+                } else {
+                    return true;
+                }
+                break;
+            }
+            case kStartOutput_State:
+                // Only complete scans are rendered, so the pass will not wait for input.
+                if (!jpeg_start_output(&fCInfo, fCompleteScan)) {
+                    return true;
+                }
+                fState = kScanlines_State;
+                break;
+            case kScanlines_State:
+                if (!this->readScanlines()) {
+                    return true;
+                }
+                if (fProgressive) {
+                    // The pass is all in bitmap() now, though finishing it waits for the
+                    // next scan to start.
+                    fPassCount += 1;
+                    fState = kFinishOutput_State;
+                } else {
+                    fState = kFinishDecompress_State;
+                }
+                break;
+            case kFinishOutput_State:
+                if (!jpeg_finish_output(&fCInfo)) {
+                    return true;
+                }
+                fState = kConsumeInput_State;
+                break;
+            case kFinishDecompress_State:
+                if (!jpeg_finish_decompress(&fCInfo)) {
+                    return true;
+                }
+                if (!fProgressive) {
+                    fPassCount = 1;
+                }
+                fState = kDone_State;
+                return true;
+            case kDone_State:
+                return true;
+            case kError_State:
+                return false;
+        }
+    }
+}
+
+void SkJpegIncrementalDecoder::InitSource(j_decompress_ptr) {}
+
+boolean SkJpegIncrementalDecoder::FillInputBuffer(j_decompress_ptr cinfo) {
+    Source* src = static_cast<Source*>(cinfo->src);
+    if (!src->fComplete) {
+        // Suspend until appendData().
+        return FALSE;
+    }
+    // The stream ended early: finish it with a fake EOI marker, as libjpeg's own sources do.
+    static const JOCTET kEOI[] = { 0xFF, JPEG_EOI };
+    WARNMS(cinfo, JWRN_JPEG_EOF);
+    src->next_input_byte = kEOI;
+    src->bytes_in_buffer = sizeof(kEOI);
+    return TRUE;
+}
+
+void SkJpegIncrementalDecoder::SkipInputData(j_decompress_ptr cinfo, long numBytes) {
+    if (numBytes <= 0) {
+        return;
+    }
+    Source* src = static_cast<Source*>(cinfo->src);
+    size_t bytes = (size_t)numBytes;
+    if (bytes <= src->bytes_in_buffer) {
+        src->next_input_byte += bytes;
+        src->bytes_in_buffer -= bytes;
+    } else {
+        // The rest is skipped as it arrives.
+        src->fSkip += bytes - src->bytes_in_buffer;
+        src->next_input_byte += src->bytes_in_buffer;
+        src->bytes_in_buffer = 0;
+    }
+}
+
+void SkJpegIncrementalDecoder::TermSource(j_decompress_ptr) {}
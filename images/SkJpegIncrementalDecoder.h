@@ -0,0 +1,105 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegIncrementalDecoder_DEFINED
+#define SkJpegIncrementalDecoder_DEFINED
+
+#include "SkBitmap.h"
+#include "SkJpegUtility.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+
+/**
+ *  Decodes a JPEG as its bytes arrive, so it can be drawn before the download finishes.
+ *
+ *  libjpeg is run with a suspending data source: each appendData() decodes as far as the bytes
+ *  so far allow and then returns. Baseline JPEGs fill in from the top, decodedRows() at a time.
+ *  Progressive JPEGs are decoded in buffered-image mode: every scan that has fully arrived is
+ *  rendered as a pass over the whole image, each sharper than the last.
+ *
+ *  bitmap() holds what is decoded so far, as N32 premul pixels; rows not decoded yet are
+ *  transparent. Only grayscale and YCbCr JPEGs are supported.
+ */
+class SkJpegIncrementalDecoder : SkNoncopyable {
+public:
+    SkJpegIncrementalDecoder();
+    ~SkJpegIncrementalDecoder();
+
+    /**
+     *  Appends the next bytes of the stream and decodes what they complete. Returns false if
+     *  the stream is not a JPEG we can decode, or is corrupt.
+     */
+    bool appendData(const void* data, size_t length);
+
+    /**
+     *  Tells the decoder no more bytes will come, and finishes a truncated stream as if it had
+     *  ended there. Returns false on a decoding error, as when the stream was cut off inside a
+     *  header; bitmap() keeps whatever was decoded before.
+     */
+    bool finish();
+
+    /** Returns false until the header has arrived. */
+    bool getInfo(SkImageInfo* info) const;
+
+    bool isProgressive() const { return fProgressive; }
+    bool isComplete() const { return kDone_State == fState; }
+    bool hasFailed() const { return kError_State == fState; }
+
+    /** The number of complete progressive passes rendered into bitmap(). */
+    int passCount() const { return fPassCount; }
+
+    /** The rows at the top of bitmap() that hold decoded pixels. */
+    int decodedRows() const { return fDecodedRows; }
+
+    const SkBitmap& bitmap() const { return fBitmap; }
+
+private:
+    enum State {
+        kHeader_State,
+        kStartDecompress_State,
+        kConsumeInput_State,        // progressive only: waiting for a scan to complete
+        kStartOutput_State,         // progressive only
+        kScanlines_State,
+        kFinishOutput_State,        // progressive only
+        kFinishDecompress_State,
+        kDone_State,
+        kError_State
+    };
+
+    // Where libjpeg reads from: the bytes it hasn't consumed yet.
+    struct Source : jpeg_source_mgr {
+        SkTDArray<uint8_t>  fData;
+        // Bytes libjpeg asked to skip past the end of fData.
+        size_t              fSkip;
+        bool                fComplete;
+    };
+
+    // Runs libjpeg until it suspends for more data. Returns false on error.
+    bool advance();
+    // Returns false if it suspended before the last row.
+    bool readScanlines();
+    bool onHeader();
+
+    static void InitSource(j_decompress_ptr);
+    static boolean FillInputBuffer(j_decompress_ptr);
+    static void SkipInputData(j_decompress_ptr, long numBytes);
+    static void TermSource(j_decompress_ptr);
+
+    jpeg_decompress_struct  fCInfo;
+    skjpeg_error_mgr        fErrorMgr;
+    Source                  fSource;
+    State                   fState;
+    bool                    fProgressive;
+    // The last scan that has fully arrived, and the last rendered.
+    int                     fCompleteScan;
+    int                     fPassCount;
+    int                     fDecodedRows;
+    SkAutoMalloc            fRow;
+    SkBitmap                fBitmap;
+};
+
+#endif
@@ -10,12 +10,31 @@
 #include "SkMovie.h"
 #include "SkColor.h"
 #include "SkColorPriv.h"
+#include "SkData.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 
 #include "gif_lib.h"
 
+// Only the encoded data is kept. Frames are found when the movie is created,
+// and their pixels decoded straight into the bitmap each time they are drawn.
+struct GIFFrame {
+    size_t  fOffset;        // of the image descriptor
+    SkMSec  fDuration;
+    GifWord fLeft;
+    GifWord fTop;
+    GifWord fWidth;
+    GifWord fHeight;
+    bool    fInterlace;
+    int     fTransparent;   // -1 if the frame is opaque
+    int     fDisposal;
+    // True if the bitmap after this frame doesn't depend on the frames before
+    // it, so drawing may start here.
+    bool    fIsKeyFrame;
+};
+
 class SkGIFMovie : public SkMovie {
 public:
     SkGIFMovie(SkStream* stream);
@@ -27,34 +46,69 @@ protected:
     virtual bool onGetBitmap(SkBitmap*);
 
 private:
+    struct Reader {
+        const uint8_t*  fData;
+        size_t          fSize;
+        size_t          fOffset;
+    };
+
+    static int Decode(GifFileType* fileType, GifByteType* out, int size);
+
+    bool indexFrames();
+    int keyFrameAtOrBefore(int index) const;
+    void drawFrame(SkBitmap* bm, int index);
+    void freeSavedImages();
+
+    SkAutoTUnref<SkData> fData;
+    Reader fReader;
     GifFileType* fGIF;
+    SkTDArray<GIFFrame> fFrames;
     int fCurrIndex;
     int fLastDrawIndex;
+    SkColor fPaintingColor;
     SkBitmap fBackup;
 };
 
-static int Decode(GifFileType* fileType, GifByteType* out, int size) {
-    SkStream* stream = (SkStream*) fileType->UserData;
-    return (int) stream->read(out, size);
+int SkGIFMovie::Decode(GifFileType* fileType, GifByteType* out, int size) {
+    Reader* reader = (Reader*) fileType->UserData;
+    size = (int) SkTMin<size_t>(size, reader->fSize - reader->fOffset);
+    memcpy(out, reader->fData + reader->fOffset, size);
+    reader->fOffset += size;
+    return size;
+}
+
+static SkData* copy_stream_to_data(SkStream* stream) {
+    SkDynamicMemoryWStream copy;
+    char buffer[4096];
+    size_t bytes;
+    while ((bytes = stream->read(buffer, sizeof(buffer))) > 0) {
+        copy.write(buffer, bytes);
+    }
+    return copy.copyToData();
 }
 
 SkGIFMovie::SkGIFMovie(SkStream* stream)
+    : fData(copy_stream_to_data(stream))
+    , fCurrIndex(-1)
+    , fLastDrawIndex(-1)
+    , fPaintingColor(SK_ColorTRANSPARENT)
 {
+    fReader.fData = (const uint8_t*) fData->data();
+    fReader.fSize = fData->size();
+    fReader.fOffset = 0;
 #if GIFLIB_MAJOR < 5
-    fGIF = DGifOpen( stream, Decode );
+    fGIF = DGifOpen( &fReader, Decode );
 #else
-    fGIF = DGifOpen( stream, Decode, NULL );
+    fGIF = DGifOpen( &fReader, Decode, NULL );
 #endif
     if (NULL == fGIF)
         return;
 
-    if (DGifSlurp(fGIF) != GIF_OK)
+    if (!this->indexFrames())
     {
         DGifCloseFile(fGIF);
         fGIF = NULL;
     }
-    fCurrIndex = -1;
-    fLastDrawIndex = -1;
 }
 
 SkGIFMovie::~SkGIFMovie()
@@ -63,18 +117,128 @@ SkGIFMovie::~SkGIFMovie()
         DGifCloseFile(fGIF);
 }
 
-static SkMSec savedimage_duration(const SavedImage* image)
-{
-    for (int j = 0; j < image->ExtensionBlockCount; j++)
-    {
-        if (image->ExtensionBlocks[j].Function == GRAPHICS_EXT_FUNC_CODE)
-        {
-            SkASSERT(image->ExtensionBlocks[j].ByteCount >= 4);
-            const uint8_t* b = (const uint8_t*)image->ExtensionBlocks[j].Bytes;
-            return ((b[2] << 8) | b[1]) * 10;
+// DGifGetImageDesc() adds each descriptor it reads to the SavedImages, which
+// would otherwise grow every time a frame is drawn.
+void SkGIFMovie::freeSavedImages() {
+#if GIFLIB_MAJOR < 5
+    FreeSavedImages(fGIF);
+#else
+    GifFreeSavedImages(fGIF);
+#endif
+    fGIF->SavedImages = NULL;
+    fGIF->ImageCount = 0;
+}
+
+bool SkGIFMovie::indexFrames() {
+    // The graphic control extension describes the image that follows it.
+    SkMSec duration = 0;
+    int transparent = -1;
+    int disposal = 0;
+
+    GifRecordType recordType;
+    do {
+        if (DGifGetRecordType(fGIF, &recordType) == GIF_ERROR) {
+            return false;
+        }
+        switch (recordType) {
+            case IMAGE_DESC_RECORD_TYPE: {
+                const size_t offset = fReader.fOffset;
+                if (DGifGetImageDesc(fGIF) == GIF_ERROR) {
+                    return false;
+                }
+                const GifImageDesc& desc = fGIF->Image;
+                GIFFrame* frame = fFrames.append();
+                frame->fOffset = offset;
+                frame->fDuration = duration;
+                frame->fLeft = desc.Left;
+                frame->fTop = desc.Top;
+                frame->fWidth = desc.Width;
+                frame->fHeight = desc.Height;
+                frame->fInterlace = desc.Interlace;
+                frame->fTransparent = transparent;
+                frame->fDisposal = disposal;
+                duration = 0;
+                transparent = -1;
+                disposal = 0;
+
+                // Skip the compressed pixels without decompressing them.
+                int codeSize;
+                GifByteType* codeBlock;
+                if (DGifGetCode(fGIF, &codeSize, &codeBlock) == GIF_ERROR) {
+                    return false;
+                }
+                while (NULL != codeBlock) {
+                    if (DGifGetCodeNext(fGIF, &codeBlock) == GIF_ERROR) {
+                        return false;
+                    }
+                }
+                break;
+            }
+            case EXTENSION_RECORD_TYPE: {
+                int code;
+                GifByteType* ext;
+                if (DGifGetExtension(fGIF, &code, &ext) == GIF_ERROR) {
+                    return false;
+                }
+                // ext[0] is the length of the block that follows it.
+                if (code == GRAPHICS_EXT_FUNC_CODE && NULL != ext && ext[0] >= 4) {
+                    duration = ((ext[3] << 8) | ext[2]) * 10;
+                    if (ext[0] == 4) {
+                        transparent = (ext[1] & 1) ? ext[4] : -1;
+                        disposal = (ext[1] >> 2) & 7;
+                    }
+                }
+                while (NULL != ext) {
+                    if (DGifGetExtensionNext(fGIF, &ext) == GIF_ERROR) {
+                        return false;
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    } while (recordType != TERMINATE_RECORD_TYPE);
+    this->freeSavedImages();
+
+    if (fFrames.count() > 0) {
+        const GIFFrame& first = fFrames[0];
+        if (first.fTransparent < 0 && fGIF->SColorMap != NULL) {
+            const GifColorType& col = fGIF->SColorMap->Colors[fGIF->SBackGroundColor];
+            fPaintingColor = SkColorSetARGB(0xFF, col.Red, col.Green, col.Blue);
         }
     }
-    return 0;
+
+    // Drawing a key frame starts from a bitmap of fPaintingColor, which is
+    // what the bitmap holds after a previous frame covering all of it is
+    // restored to the background, and which a frame that is opaque and
+    // covers everything overwrites anyway. Restoring a key frame to the
+    // previous image would bring back what was there before it, so those
+    // frames aren't key frames.
+    for (int i = 0; i < fFrames.count(); ++i) {
+        GIFFrame& frame = fFrames[i];
+        frame.fIsKeyFrame = 0 == i;
+        if (frame.fIsKeyFrame || frame.fDisposal == 3) {
+            continue;
+        }
+        const GIFFrame& prev = fFrames[i - 1];
+        const bool prevCoversAll = prev.fLeft <= 0 && prev.fTop <= 0 &&
+                                   prev.fLeft + prev.fWidth >= fGIF->SWidth &&
+                                   prev.fTop + prev.fHeight >= fGIF->SHeight;
+        const bool coversAll = frame.fLeft <= 0 && frame.fTop <= 0 &&
+                               frame.fLeft + frame.fWidth >= fGIF->SWidth &&
+                               frame.fTop + frame.fHeight >= fGIF->SHeight;
+        frame.fIsKeyFrame = (prev.fDisposal == 2 && prevCoversAll) ||
+                            (frame.fTransparent < 0 && coversAll);
+    }
+    return true;
+}
+
+int SkGIFMovie::keyFrameAtOrBefore(int index) const {
+    while (index > 0 && !fFrames[index].fIsKeyFrame) {
+        --index;
+    }
+    return index;
 }
 
 bool SkGIFMovie::onGetInfo(Info* info)
@@ -83,8 +247,8 @@ bool SkGIFMovie::onGetInfo(Info* info)
         return false;
 
     SkMSec dur = 0;
-    for (int i = 0; i < fGIF->ImageCount; i++)
-        dur += savedimage_duration(&fGIF->SavedImages[i]);
+    for (int i = 0; i < fFrames.count(); i++)
+        dur += fFrames[i].fDuration;
 
     info->fDuration = dur;
     info->fWidth = fGIF->SWidth;
@@ -99,16 +263,16 @@ bool SkGIFMovie::onSetTime(SkMSec time)
         return false;
 
     SkMSec dur = 0;
-    for (int i = 0; i < fGIF->ImageCount; i++)
+    for (int i = 0; i < fFrames.count(); i++)
     {
-        dur += savedimage_duration(&fGIF->SavedImages[i]);
+        dur += fFrames[i].fDuration;
         if (dur >= time)
         {
             fCurrIndex = i;
             return fLastDrawIndex != fCurrIndex;
         }
     }
-    fCurrIndex = fGIF->ImageCount - 1;
+    fCurrIndex = fFrames.count() - 1;
     return true;
 }
 
@@ -123,84 +287,14 @@ static void copyLine(uint32_t* dst, const unsigned char* src, const ColorMapObje
     }
 }
 
-#if GIFLIB_MAJOR < 5
-static void copyInterlaceGroup(SkBitmap* bm, const unsigned char*& src,
-                               const ColorMapObject* cmap, int transparent, int copyWidth,
-                               int copyHeight, const GifImageDesc& imageDesc, int rowStep,
-                               int startRow)
-{
-    int row;
-    // every 'rowStep'th row, starting with row 'startRow'
-    for (row = startRow; row < copyHeight; row += rowStep) {
-        uint32_t* dst = bm->getAddr32(imageDesc.Left, imageDesc.Top + row);
-        copyLine(dst, src, cmap, transparent, copyWidth);
-        src += imageDesc.Width;
-    }
-
-    // pad for rest height
-    src += imageDesc.Width * ((imageDesc.Height - row + rowStep - 1) / rowStep);
-}
-
-static void blitInterlace(SkBitmap* bm, const SavedImage* frame, const ColorMapObject* cmap,
-                          int transparent)
-{
-    int width = bm->width();
-    int height = bm->height();
-    GifWord copyWidth = frame->ImageDesc.Width;
-    if (frame->ImageDesc.Left + copyWidth > width) {
-        copyWidth = width - frame->ImageDesc.Left;
-    }
-
-    GifWord copyHeight = frame->ImageDesc.Height;
-    if (frame->ImageDesc.Top + copyHeight > height) {
-        copyHeight = height - frame->ImageDesc.Top;
-    }
-
-    // deinterlace
-    const unsigned char* src = (unsigned char*)frame->RasterBits;
-
-    // group 1 - every 8th row, starting with row 0
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 8, 0);
-
-    // group 2 - every 8th row, starting with row 4
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 8, 4);
-
-    // group 3 - every 4th row, starting with row 2
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 4, 2);
-
-    copyInterlaceGroup(bm, src, cmap, transparent, copyWidth, copyHeight, frame->ImageDesc, 2, 1);
-}
-#endif
-
-static void blitNormal(SkBitmap* bm, const SavedImage* frame, const ColorMapObject* cmap,
-                       int transparent)
-{
-    int width = bm->width();
-    int height = bm->height();
-    const unsigned char* src = (unsigned char*)frame->RasterBits;
-    uint32_t* dst = bm->getAddr32(frame->ImageDesc.Left, frame->ImageDesc.Top);
-    GifWord copyWidth = frame->ImageDesc.Width;
-    if (frame->ImageDesc.Left + copyWidth > width) {
-        copyWidth = width - frame->ImageDesc.Left;
-    }
-
-    GifWord copyHeight = frame->ImageDesc.Height;
-    if (frame->ImageDesc.Top + copyHeight > height) {
-        copyHeight = height - frame->ImageDesc.Top;
-    }
-
-    for (; copyHeight > 0; copyHeight--) {
-        copyLine(dst, src, cmap, transparent, copyWidth);
-        src += frame->ImageDesc.Width;
-        dst += width;
-    }
-}
-
 static void fillRect(SkBitmap* bm, GifWord left, GifWord top, GifWord width, GifWord height,
                      uint32_t col)
 {
     int bmWidth = bm->width();
     int bmHeight = bm->height();
+    if (left >= bmWidth || top >= bmHeight) {
+        return;
+    }
     uint32_t* dst = bm->getAddr32(left, top);
     GifWord copyWidth = width;
     if (left + copyWidth > bmWidth) {
@@ -218,106 +312,97 @@ static void fillRect(SkBitmap* bm, GifWord left, GifWord top, GifWord width, Gif
     }
 }
 
-static void drawFrame(SkBitmap* bm, const SavedImage* frame, const ColorMapObject* cmap)
+// Returns the row of an interlaced image that the line'th line read holds.
+static int interlacedRow(int line, int height)
 {
-    int transparent = -1;
-
-    for (int i = 0; i < frame->ExtensionBlockCount; ++i) {
-        ExtensionBlock* eb = frame->ExtensionBlocks + i;
-        if (eb->Function == GRAPHICS_EXT_FUNC_CODE &&
-            eb->ByteCount == 4) {
-            bool has_transparency = ((eb->Bytes[0] & 1) == 1);
-            if (has_transparency) {
-                transparent = (unsigned char)eb->Bytes[3];
-            }
+    // every 8th row from row 0, then every 8th from row 4, every 4th from
+    // row 2 and every 2nd from row 1
+    static const int kStart[] = { 0, 4, 2, 1 };
+    static const int kStep[] = { 8, 8, 4, 2 };
+    for (int pass = 0; pass < 4; ++pass) {
+        const int rows = (height - kStart[pass] + kStep[pass] - 1) / kStep[pass];
+        if (line < rows) {
+            return kStart[pass] + line * kStep[pass];
         }
+        line -= rows;
     }
+    return height;
+}
 
-    if (frame->ImageDesc.ColorMap != NULL) {
-        // use local color table
-        cmap = frame->ImageDesc.ColorMap;
+void SkGIFMovie::drawFrame(SkBitmap* bm, int index)
+{
+    const GIFFrame& frame = fFrames[index];
+    fReader.fOffset = frame.fOffset;
+    if (DGifGetImageDesc(fGIF) == GIF_ERROR) {
+        return;
     }
 
+    // use the local color table if there is one
+    const ColorMapObject* cmap = fGIF->Image.ColorMap;
+    if (NULL == cmap) {
+        cmap = fGIF->SColorMap;
+    }
     if (cmap == NULL || cmap->ColorCount != (1 << cmap->BitsPerPixel)) {
         SkDEBUGFAIL("bad colortable setup");
+        this->freeSavedImages();
         return;
     }
 
-#if GIFLIB_MAJOR < 5
-    // before GIFLIB 5, de-interlacing wasn't done by library at load time
-    if (frame->ImageDesc.Interlace) {
-        blitInterlace(bm, frame, cmap, transparent);
-        return;
+    const int width = bm->width();
+    const int height = bm->height();
+    GifWord copyWidth = frame.fWidth;
+    if (frame.fLeft + copyWidth > width) {
+        copyWidth = width - frame.fLeft;
+    }
+    GifWord copyHeight = frame.fHeight;
+    if (frame.fTop + copyHeight > height) {
+        copyHeight = height - frame.fTop;
     }
-#endif
-
-    blitNormal(bm, frame, cmap, transparent);
-}
 
-static bool checkIfWillBeCleared(const SavedImage* frame)
-{
-    for (int i = 0; i < frame->ExtensionBlockCount; ++i) {
-        ExtensionBlock* eb = frame->ExtensionBlocks + i;
-        if (eb->Function == GRAPHICS_EXT_FUNC_CODE &&
-            eb->ByteCount == 4) {
-            // check disposal method
-            int disposal = ((eb->Bytes[0] >> 2) & 7);
-            if (disposal == 2 || disposal == 3) {
-                return true;
-            }
+    SkAutoTMalloc<GifPixelType> line(frame.fWidth);
+    for (int i = 0; i < frame.fHeight; ++i) {
+        if (DGifGetLine(fGIF, line.get(), frame.fWidth) == GIF_ERROR) {
+            break;
+        }
+        const int row = frame.fInterlace ? interlacedRow(i, frame.fHeight) : i;
+        if (row < copyHeight && copyWidth > 0) {
+            uint32_t* dst = bm->getAddr32(frame.fLeft, frame.fTop + row);
+            copyLine(dst, line.get(), cmap, frame.fTransparent, copyWidth);
         }
     }
-    return false;
+    this->freeSavedImages();
 }
 
-static void getTransparencyAndDisposalMethod(const SavedImage* frame, bool* trans, int* disposal)
+static bool checkIfWillBeCleared(int disposal)
 {
-    *trans = false;
-    *disposal = 0;
-    for (int i = 0; i < frame->ExtensionBlockCount; ++i) {
-        ExtensionBlock* eb = frame->ExtensionBlocks + i;
-        if (eb->Function == GRAPHICS_EXT_FUNC_CODE &&
-            eb->ByteCount == 4) {
-            *trans = ((eb->Bytes[0] & 1) == 1);
-            *disposal = ((eb->Bytes[0] >> 2) & 7);
-        }
-    }
+    return disposal == 2 || disposal == 3;
 }
 
 // return true if area of 'target' is completely covers area of 'covered'
-static bool checkIfCover(const SavedImage* target, const SavedImage* covered)
+static bool checkIfCover(const GIFFrame& target, const GIFFrame& covered)
 {
-    if (target->ImageDesc.Left <= covered->ImageDesc.Left
-        && covered->ImageDesc.Left + covered->ImageDesc.Width <=
-               target->ImageDesc.Left + target->ImageDesc.Width
-        && target->ImageDesc.Top <= covered->ImageDesc.Top
-        && covered->ImageDesc.Top + covered->ImageDesc.Height <=
-               target->ImageDesc.Top + target->ImageDesc.Height) {
+    if (target.fLeft <= covered.fLeft
+        && covered.fLeft + covered.fWidth <= target.fLeft + target.fWidth
+        && target.fTop <= covered.fTop
+        && covered.fTop + covered.fHeight <= target.fTop + target.fHeight) {
         return true;
     }
     return false;
 }
 
-static void disposeFrameIfNeeded(SkBitmap* bm, const SavedImage* cur, const SavedImage* next,
+static void disposeFrameIfNeeded(SkBitmap* bm, const GIFFrame& cur, const GIFFrame& next,
                                  SkBitmap* backup, SkColor color)
 {
     // We can skip disposal process if next frame is not transparent
     // and completely covers current area
-    bool curTrans;
-    int curDisposal;
-    getTransparencyAndDisposalMethod(cur, &curTrans, &curDisposal);
-    bool nextTrans;
-    int nextDisposal;
-    getTransparencyAndDisposalMethod(next, &nextTrans, &nextDisposal);
-    if ((curDisposal == 2 || curDisposal == 3)
+    bool nextTrans = next.fTransparent >= 0;
+    if ((cur.fDisposal == 2 || cur.fDisposal == 3)
         && (nextTrans || !checkIfCover(next, cur))) {
-        switch (curDisposal) {
+        switch (cur.fDisposal) {
         // restore to background color
         // -> 'background' means background under this image.
         case 2:
-            fillRect(bm, cur->ImageDesc.Left, cur->ImageDesc.Top,
-                     cur->ImageDesc.Width, cur->ImageDesc.Height,
-                     color);
+            fillRect(bm, cur.fLeft, cur.fTop, cur.fWidth, cur.fHeight, color);
             break;
 
         // restore to previous
@@ -328,7 +413,7 @@ static void disposeFrameIfNeeded(SkBitmap* bm, const SavedImage* cur, const Save
     }
 
     // Save current image if next frame's disposal method == 3
-    if (nextDisposal == 3) {
+    if (next.fDisposal == 3) {
         const uint32_t* src = bm->getAddr32(0, 0);
         uint32_t* dst = backup->getAddr32(0, 0);
         int cnt = bm->width() * bm->height();
@@ -342,7 +427,7 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
     if (NULL == gif)
         return false;
 
-    if (gif->ImageCount < 1) {
+    if (fFrames.count() < 1) {
         return false;
     }
 
@@ -357,11 +442,20 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
         return true;
     }
 
-    int startIndex = fLastDrawIndex + 1;
-    if (fLastDrawIndex < 0 || !bm->readyToDraw()) {
+    int lastIndex = fCurrIndex;
+    if (lastIndex < 0) {
         // first time
+        lastIndex = 0;
+    } else if (lastIndex > fFrames.count() - 1) {
+        // this block must not be reached.
+        lastIndex = fFrames.count() - 1;
+    }
 
-        startIndex = 0;
+    // Frames before the last key frame don't show, so start there unless
+    // the frames since the last drawn one are fewer.
+    int startIndex = this->keyFrameAtOrBefore(lastIndex);
+    if (fLastDrawIndex < 0 || !bm->readyToDraw()) {
+        // first time
 
         // create bitmap
         if (!bm->allocPixels(SkImageInfo::MakeN32Premul(width, height))) {
@@ -371,53 +465,26 @@ bool SkGIFMovie::onGetBitmap(SkBitmap* bm)
         if (!fBackup.allocPixels(SkImageInfo::MakeN32Premul(width, height))) {
             return false;
         }
-    } else if (startIndex > fCurrIndex) {
-        // rewind to 1st frame for repeat
-        startIndex = 0;
-    }
-
-    int lastIndex = fCurrIndex;
-    if (lastIndex < 0) {
-        // first time
-        lastIndex = 0;
-    } else if (lastIndex > fGIF->ImageCount - 1) {
-        // this block must not be reached.
-        lastIndex = fGIF->ImageCount - 1;
-    }
-
-    SkColor bgColor = SkPackARGB32(0, 0, 0, 0);
-    if (gif->SColorMap != NULL) {
-        const GifColorType& col = gif->SColorMap->Colors[fGIF->SBackGroundColor];
-        bgColor = SkColorSetARGB(0xFF, col.Red, col.Green, col.Blue);
+    } else if (fLastDrawIndex < lastIndex) {
+        startIndex = SkMax32(startIndex, fLastDrawIndex + 1);
     }
 
-    static SkColor paintingColor = SkPackARGB32(0, 0, 0, 0);
     // draw each frames - not intelligent way
     for (int i = startIndex; i <= lastIndex; i++) {
-        const SavedImage* cur = &fGIF->SavedImages[i];
-        if (i == 0) {
-            bool trans;
-            int disposal;
-            getTransparencyAndDisposalMethod(cur, &trans, &disposal);
-            if (!trans && gif->SColorMap != NULL) {
-                paintingColor = bgColor;
-            } else {
-                paintingColor = SkColorSetARGB(0, 0, 0, 0);
-            }
-
-            bm->eraseColor(paintingColor);
-            fBackup.eraseColor(paintingColor);
+        const GIFFrame& cur = fFrames[i];
+        if (i == startIndex && cur.fIsKeyFrame) {
+            bm->eraseColor(fPaintingColor);
+            fBackup.eraseColor(fPaintingColor);
         } else {
             // Dispose previous frame before move to next frame.
-            const SavedImage* prev = &fGIF->SavedImages[i-1];
-            disposeFrameIfNeeded(bm, prev, cur, &fBackup, paintingColor);
+            disposeFrameIfNeeded(bm, fFrames[i-1], cur, &fBackup, fPaintingColor);
         }
 
         // Draw frame
         // We can skip this process if this index is not last and disposal
         // method == 2 or method == 3
-        if (i == lastIndex || !checkIfWillBeCleared(cur)) {
-            drawFrame(bm, cur, gif->SColorMap);
+        if (i == lastIndex || !checkIfWillBeCleared(cur.fDisposal)) {
+            this->drawFrame(bm, i);
         }
     }
 
@@ -10,6 +10,7 @@
 #include "SkBitmap.h"
 #include "SkColorPriv.h"
 #include "SkDither.h"
+#include "SkScaledBitmapSampler_opts.h"
 #include "SkTypes.h"
 
 // 8888
@@ -575,6 +576,7 @@ SkScaledBitmapSampler::SkScaledBitmapSampler(int width, int height,
     fCTable = NULL;
     fDstRow = NULL;
     fRowProc = NULL;
+    fPlatformRowProc = NULL;
 
     if (width <= 0 || height <= 0) {
         sk_throw();
@@ -710,6 +712,21 @@ bool SkScaledBitmapSampler::begin(SkBitmap* dst, SrcConfig sc,
     } else {
         fRowProc = chooser(decoder);
     }
+
+    // Full size rows to 8888 may have a faster platform version of the proc.
+    fPlatformRowProc = NULL;
+    if (1 == fDX && SkBitmap::kARGB_8888_Config == dst->config()) {
+        SkScaledBitmapSamplerProcs procs;
+        if (SkScaledBitmapSamplerGetPlatformProcs(&procs)) {
+            if (Sample_Gray_D8888 == fRowProc) {
+                fPlatformRowProc = procs.fGray_D8888;
+            } else if (Sample_RGBx_D8888 == fRowProc) {
+                fPlatformRowProc = 3 == fSrcPixelSize ? procs.fRGB_D8888 : procs.fRGBx_D8888;
+            } else if (Sample_RGBA_D8888 == fRowProc) {
+                fPlatformRowProc = procs.fRGBA_D8888;
+            }
+        }
+    }
     fDstRow = (char*)dst->getPixels();
     fDstRowBytes = dst->rowBytes();
     fCurrY = 0;
@@ -721,8 +738,8 @@ bool SkScaledBitmapSampler::next(const uint8_t* SK_RESTRICT src) {
     SkDEBUGCODE(fSampleMode = kConsecutive_SampleMode);
     SkASSERT((unsigned)fCurrY < (unsigned)fScaledHeight);
 
-    bool hadAlpha = fRowProc(fDstRow, src + fX0 * fSrcPixelSize, fScaledWidth,
-                             fDX * fSrcPixelSize, fCurrY, fCTable);
+    bool hadAlpha = this->rowProc()(fDstRow, src + fX0 * fSrcPixelSize, fScaledWidth,
+                                    fDX * fSrcPixelSize, fCurrY, fCTable);
     fDstRow += fDstRowBytes;
     fCurrY += 1;
     return hadAlpha;
@@ -747,8 +764,8 @@ bool SkScaledBitmapSampler::sampleInterlaced(const uint8_t* SK_RESTRICT src, int
     const int dstY = srcYMinusY0 / fDY;
     SkASSERT(dstY < fScaledHeight);
     char* dstRow = fDstRow + dstY * fDstRowBytes;
-    return fRowProc(dstRow, src + fX0 * fSrcPixelSize, fScaledWidth,
-                    fDX * fSrcPixelSize, dstY, fCTable);
+    return this->rowProc()(dstRow, src + fX0 * fSrcPixelSize, fScaledWidth,
+                           fDX * fSrcPixelSize, dstY, fCTable);
 }
 
 #ifdef SK_DEBUG
@@ -81,10 +81,16 @@ private:
     int     fCurrY; // used for dithering
     int     fSrcPixelSize;  // 1, 3, 4
     RowProc fRowProc;
+    // If not NULL, a SIMD version of fRowProc that is used in its place.
+    RowProc fPlatformRowProc;
 
     // optional reference to the src colors if the src is a palette model
     const SkPMColor* fCTable;
 
+    RowProc rowProc() const {
+        return NULL != fPlatformRowProc ? fPlatformRowProc : fRowProc;
+    }
+
 #ifdef SK_DEBUG
     // Helper class allowing a test to have access to fRowProc.
     friend class RowProcTester;
@@ -95,3 +95,23 @@ void SkCachingPixelRef::onUnlockPixels() {
     SkScaledImageCache::Unlock( static_cast<SkScaledImageCache::ID*>(fScaledCacheId));
     fScaledCacheId = NULL;
 }
+
+bool SkCachingPixelRef::onDecodeInto(int pow2, SkBitmap* bitmap) {
+    SkASSERT(pow2 >= 0);
+    if (fErrorInDecoding) {
+        return false;
+    }
+    SkImageInfo info = this->info();
+    info.fWidth = SkMax32(info.fWidth >> pow2, 1);
+    info.fHeight = SkMax32(info.fHeight >> pow2, 1);
+    // The caller caches the result, so allocate it from the cache.
+    if (!bitmap->setConfig(info) ||
+        !bitmap->allocPixels(SkScaledImageCache::GetAllocator(), NULL)) {
+        return false;
+    }
+    if (!fImageGenerator->getPixels(info, bitmap->getPixels(), bitmap->rowBytes())) {
+        bitmap->reset();
+        return false;
+    }
+    return true;
+}
@@ -45,6 +45,12 @@ protected:
     virtual void onUnlockPixels() SK_OVERRIDE;
     virtual bool onLockPixelsAreWritable() const SK_OVERRIDE { return false; }
 
+    // Asks the generator for a decode reduced by 2^pow2, for drawing the
+    // image much smaller than its full size.  We don't override
+    // onImplementsDecodeInto(), which would have SkBitmapProcState cache
+    // our full-size pixels; we already cache those ourselves.
+    virtual bool onDecodeInto(int pow2, SkBitmap*) SK_OVERRIDE;
+
     virtual SkData* onRefEncodedData() SK_OVERRIDE {
         return fImageGenerator->refEncodedData();
     }
@@ -7,6 +7,7 @@
 
 #include "SkDiscardableMemory.h"
 #include "SkDiscardableMemoryPool.h"
+#include "SkMemoryBudget.h"
 #include "SkOnce.h"
 #include "SkTInternalLList.h"
 #include "SkThread.h"
@@ -31,7 +32,11 @@ public:
     DiscardableMemoryPool(size_t budget, SkBaseMutex* mutex = NULL);
     virtual ~DiscardableMemoryPool();
 
-    virtual SkDiscardableMemory* create(size_t bytes) SK_OVERRIDE;
+    virtual SkDiscardableMemory* create(size_t bytes) SK_OVERRIDE {
+        return this->createWithCost(bytes, kDefault_RegenerationCost);
+    }
+    virtual SkDiscardableMemory* createWithCost(size_t bytes,
+                                                RegenerationCost) SK_OVERRIDE;
 
     virtual size_t getRAMUsed() SK_OVERRIDE;
     virtual void setRAMBudget(size_t budget) SK_OVERRIDE;
@@ -46,18 +51,44 @@ public:
     virtual void resetCacheHitsAndMisses() SK_OVERRIDE {
         fCacheHits = fCacheMisses = 0;
     }
-    int          fCacheHits;
-    int          fCacheMisses;
+    // Counted with atomics, since hits and misses happen under the
+    // shards' locks.
+    int32_t      fCacheHits;
+    int32_t      fCacheMisses;
     #endif  // SK_LAZY_CACHE_STATS
 
 private:
+    enum {
+        kShardCount = 8     // must be a power of two
+    };
+
+    /**
+     *  The DMs of one shard, most recently used at the head, with one
+     *  list per regeneration cost.  The shard's mutex guards its lists
+     *  and the fLocked and fPointer of its DMs.
+     */
+    struct Shard {
+        SkMutex                                 fMutexStorage;
+        SkBaseMutex*                            fMutex;
+        SkTInternalLList<PoolDiscardableMemory> fLists[kRegenerationCostCount];
+    };
+
+    // Guards fBudget and fUsed.  When both are held, a shard's mutex is
+    // always taken first.
     SkBaseMutex* fMutex;
     size_t       fBudget;
     size_t       fUsed;
-    SkTInternalLList<PoolDiscardableMemory> fList;
+    Shard        fShards[kShardCount];
+    int32_t      fNextShard;
 
     /** Function called to free memory if needed */
     void dumpDownTo(size_t budget);
+    /**
+     *  Purges unlocked DMs of the cost from the tail of the shard until
+     *  at least bytes are freed.  Returns the bytes freed.
+     */
+    size_t dumpShard(Shard* shard, int cost, size_t bytes);
+    void noteFreed(size_t bytes);
     /** called by DiscardableMemoryPool upon destruction */
     void free(PoolDiscardableMemory* dm);
     /** called by DiscardableMemoryPool::lock() */
@@ -77,7 +108,8 @@ private:
 class PoolDiscardableMemory : public SkDiscardableMemory {
 public:
     PoolDiscardableMemory(DiscardableMemoryPool* pool,
-                            void* pointer, size_t bytes);
+                          void* pointer, size_t bytes,
+                          int shard, int cost);
     virtual ~PoolDiscardableMemory();
     virtual bool lock() SK_OVERRIDE;
     virtual void* data() SK_OVERRIDE;
@@ -89,15 +121,21 @@ private:
     bool                         fLocked;
     void*                        fPointer;
     const size_t                 fBytes;
+    const int                    fShard;
+    const int                    fCost;
 };
 
 PoolDiscardableMemory::PoolDiscardableMemory(DiscardableMemoryPool* pool,
                                              void* pointer,
-                                             size_t bytes)
+                                             size_t bytes,
+                                             int shard,
+                                             int cost)
     : fPool(pool)
     , fLocked(true)
     , fPointer(pointer)
-    , fBytes(bytes) {
+    , fBytes(bytes)
+    , fShard(shard)
+    , fCost(cost) {
     SkASSERT(fPool != NULL);
     SkASSERT(fPointer != NULL);
     SkASSERT(fBytes > 0);
@@ -131,7 +169,12 @@ DiscardableMemoryPool::DiscardableMemoryPool(size_t budget,
                                              SkBaseMutex* mutex)
     : fMutex(mutex)
     , fBudget(budget)
-    , fUsed(0) {
+    , fUsed(0)
+    , fNextShard(0) {
+    // A pool without a mutex isn't thread safe, so neither are its shards.
+    for (int i = 0; i < kShardCount; ++i) {
+        fShards[i].fMutex = (NULL != mutex) ? &fShards[i].fMutexStorage : NULL;
+    }
     #if SK_LAZY_CACHE_STATS
     fCacheHits = 0;
     fCacheMisses = 0;
@@ -141,62 +184,113 @@ DiscardableMemoryPool::~DiscardableMemoryPool() {
     // PoolDiscardableMemory objects that belong to this pool are
     // always deleted before deleting this pool since each one has a
     // ref to the pool.
-    SkASSERT(fList.isEmpty());
+    for (int i = 0; i < kShardCount; ++i) {
+        for (int cost = 0; cost < kRegenerationCostCount; ++cost) {
+            SkASSERT(fShards[i].fLists[cost].isEmpty());
+        }
+    }
 }
 
-void DiscardableMemoryPool::dumpDownTo(size_t budget) {
-    // assert((NULL = fMutex) || fMutex->isLocked());
-    // TODO(halcanary) implement bool fMutex::isLocked().
-    // WARNING: only call this function after aquiring lock.
-    if (fUsed <= budget) {
-        return;
-    }
+void DiscardableMemoryPool::noteFreed(size_t bytes) {
+    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    SkASSERT(fUsed >= bytes);
+    fUsed -= bytes;
+}
+
+size_t DiscardableMemoryPool::dumpShard(Shard* shard, int cost, size_t bytes) {
+    SkAutoMutexAcquire autoMutexAcquire(shard->fMutex);
     typedef SkTInternalLList<PoolDiscardableMemory>::Iter Iter;
     Iter iter;
-    PoolDiscardableMemory* cur = iter.init(fList, Iter::kTail_IterStart);
-    while ((fUsed > budget) && (NULL != cur)) {
+    SkTInternalLList<PoolDiscardableMemory>& list = shard->fLists[cost];
+    PoolDiscardableMemory* cur = iter.init(list, Iter::kTail_IterStart);
+    size_t freed = 0;
+    while ((freed < bytes) && (NULL != cur)) {
         if (!cur->fLocked) {
             PoolDiscardableMemory* dm = cur;
             SkASSERT(dm->fPointer != NULL);
             sk_free(dm->fPointer);
             dm->fPointer = NULL;
-            SkASSERT(fUsed >= dm->fBytes);
-            fUsed -= dm->fBytes;
+            freed += dm->fBytes;
             cur = iter.prev();
             // Purged DMs are taken out of the list.  This saves times
             // looking them up.  Purged DMs are NOT deleted.
-            fList.remove(dm);
+            list.remove(dm);
         } else {
             cur = iter.prev();
         }
     }
+    if (freed > 0) {
+        this->noteFreed(freed);
+    }
+    return freed;
+}
+
+void DiscardableMemoryPool::dumpDownTo(size_t budget) {
+    // WARNING: only call this function without holding any of the locks.
+    // Cheap DMs go first whatever their age.  Within a cost, each pass
+    // takes an even share of the excess from the tail of every shard, so
+    // no shard's LRU order is ignored for long.
+    for (int cost = 0; cost < kRegenerationCostCount; ++cost) {
+        for (;;) {
+            size_t used = this->getRAMUsed();
+            if (used <= budget) {
+                return;
+            }
+            size_t share = (used - budget + kShardCount - 1) / kShardCount;
+            size_t freed = 0;
+            for (int i = 0; i < kShardCount; ++i) {
+                freed += this->dumpShard(&fShards[i], cost, share);
+            }
+            if (0 == freed) {
+                break;  // Everything left at this cost is locked.
+            }
+        }
+    }
 }
 
-SkDiscardableMemory* DiscardableMemoryPool::create(size_t bytes) {
+SkDiscardableMemory* DiscardableMemoryPool::createWithCost(size_t bytes,
+                                                           RegenerationCost cost) {
     void* addr = sk_malloc_flags(bytes, 0);
     if (NULL == addr) {
         return NULL;
     }
+    int index = sk_atomic_inc(&fNextShard) & (kShardCount - 1);
     PoolDiscardableMemory* dm = SkNEW_ARGS(PoolDiscardableMemory,
-                                             (this, addr, bytes));
-    SkAutoMutexAcquire autoMutexAcquire(fMutex);
-    fList.addToHead(dm);
-    fUsed += bytes;
-    this->dumpDownTo(fBudget);
+                                           (this, addr, bytes, index, cost));
+    Shard* shard = &fShards[index];
+    {
+        SkAutoMutexAcquire autoMutexAcquire(shard->fMutex);
+        shard->fLists[cost].addToHead(dm);
+    }
+    bool overBudget;
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        fUsed += bytes;
+        overBudget = fUsed > fBudget;
+    }
+    if (overBudget) {
+        this->dumpDownTo(fBudget);
+    }
     return dm;
 }
 
 void DiscardableMemoryPool::free(PoolDiscardableMemory* dm) {
     // This is called by dm's destructor.
     if (dm->fPointer != NULL) {
-        SkAutoMutexAcquire autoMutexAcquire(fMutex);
-        sk_free(dm->fPointer);
-        dm->fPointer = NULL;
-        SkASSERT(fUsed >= dm->fBytes);
-        fUsed -= dm->fBytes;
-        fList.remove(dm);
+        Shard* shard = &fShards[dm->fShard];
+        {
+            SkAutoMutexAcquire autoMutexAcquire(shard->fMutex);
+            if (NULL == dm->fPointer) {
+                // Purged while waiting for the lock.
+                return;
+            }
+            sk_free(dm->fPointer);
+            dm->fPointer = NULL;
+            shard->fLists[dm->fCost].remove(dm);
+        }
+        this->noteFreed(dm->fBytes);
     } else {
-        SkASSERT(!fList.isInList(dm));
+        SkASSERT(!fShards[dm->fShard].fLists[dm->fCost].isInList(dm));
     }
 }
 
@@ -204,57 +298,75 @@ bool DiscardableMemoryPool::lock(PoolDiscardableMemory* dm) {
     SkASSERT(dm != NULL);
     if (NULL == dm->fPointer) {
         #if SK_LAZY_CACHE_STATS
-        SkAutoMutexAcquire autoMutexAcquire(fMutex);
-        ++fCacheMisses;
+        sk_atomic_inc(&fCacheMisses);
         #endif  // SK_LAZY_CACHE_STATS
         return false;
     }
-    SkAutoMutexAcquire autoMutexAcquire(fMutex);
+    Shard* shard = &fShards[dm->fShard];
+    SkAutoMutexAcquire autoMutexAcquire(shard->fMutex);
     if (NULL == dm->fPointer) {
         // May have been purged while waiting for lock.
         #if SK_LAZY_CACHE_STATS
-        ++fCacheMisses;
+        sk_atomic_inc(&fCacheMisses);
         #endif  // SK_LAZY_CACHE_STATS
         return false;
     }
     dm->fLocked = true;
-    fList.remove(dm);
-    fList.addToHead(dm);
+    shard->fLists[dm->fCost].remove(dm);
+    shard->fLists[dm->fCost].addToHead(dm);
     #if SK_LAZY_CACHE_STATS
-    ++fCacheHits;
+    sk_atomic_inc(&fCacheHits);
     #endif  // SK_LAZY_CACHE_STATS
     return true;
 }
 
 void DiscardableMemoryPool::unlock(PoolDiscardableMemory* dm) {
     SkASSERT(dm != NULL);
-    SkAutoMutexAcquire autoMutexAcquire(fMutex);
-    dm->fLocked = false;
-    this->dumpDownTo(fBudget);
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fShards[dm->fShard].fMutex);
+        dm->fLocked = false;
+    }
+    if (this->getRAMUsed() > fBudget) {
+        this->dumpDownTo(fBudget);
+    }
 }
 
 size_t DiscardableMemoryPool::getRAMUsed() {
+    // Read without the lock, so that every unlock() can check the budget
+    // without contending on it.
     return fUsed;
 }
 void DiscardableMemoryPool::setRAMBudget(size_t budget) {
-    SkAutoMutexAcquire autoMutexAcquire(fMutex);
-    fBudget = budget;
-    this->dumpDownTo(fBudget);
+    {
+        SkAutoMutexAcquire autoMutexAcquire(fMutex);
+        fBudget = budget;
+    }
+    this->dumpDownTo(budget);
 }
 void DiscardableMemoryPool::dumpPool() {
-    SkAutoMutexAcquire autoMutexAcquire(fMutex);
     this->dumpDownTo(0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 SK_DECLARE_STATIC_MUTEX(gMutex);
 SkDiscardableMemoryPool* gPool = NULL;
+size_t global_pool_ram_used(void*) {
+    return gPool->getRAMUsed();
+}
+void purge_global_pool_down_to(void*, size_t targetBytes) {
+    // Lowering the budget purges; putting it back leaves the pool as it is.
+    size_t budget = gPool->getRAMBudget();
+    gPool->setRAMBudget(targetBytes);
+    gPool->setRAMBudget(budget);
+}
 void create_global_pool(int) {
     SkASSERT(NULL == gPool);
     gPool = SkDiscardableMemoryPool::Create(
             SK_DEFAULT_GLOBAL_DISCARDABLE_MEMORY_POOL_SIZE, &gMutex);
+    SkMemoryBudget::Register(global_pool_ram_used, purge_global_pool_down_to, gPool);
 }
 void cleanup_global_pool() {
+    SkMemoryBudget::Unregister(gPool);
     gPool->unref();
 }
 }  // namespace
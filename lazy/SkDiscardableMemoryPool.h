@@ -23,11 +23,32 @@
  *  budget of memory.  When the allocated memory exceeds this size,
  *  unlocked blocks of memory are purged.  If all memory is locked, it
  *  can exceed the memory-use budget.
+ *
+ *  Blocks are spread over shards, each with its own lock and LRU lists,
+ *  so that threads locking and unlocking different blocks rarely contend.
+ *  The budget is shared by all the shards.
  */
 class SkDiscardableMemoryPool : public SkDiscardableMemory::Factory {
 public:
     virtual ~SkDiscardableMemoryPool() { }
 
+    /**
+     *  How costly a block's contents are to make again once purged.
+     *  Unlocked blocks are purged cheapest first, and least recently
+     *  used first among blocks of the same cost.
+     */
+    enum RegenerationCost {
+        kCheap_RegenerationCost,
+        kDefault_RegenerationCost,
+        kExpensive_RegenerationCost,
+
+        kLast_RegenerationCost = kExpensive_RegenerationCost
+    };
+    static const int kRegenerationCostCount = kLast_RegenerationCost + 1;
+
+    /** As create(), which makes blocks of kDefault_RegenerationCost. */
+    virtual SkDiscardableMemory* createWithCost(size_t bytes, RegenerationCost) = 0;
+
     virtual size_t getRAMUsed() = 0;
     virtual void setRAMBudget(size_t budget) = 0;
     virtual size_t getRAMBudget() = 0;
@@ -8,14 +8,19 @@
 #include "SkDiscardablePixelRef.h"
 #include "SkDiscardableMemory.h"
 #include "SkImageGenerator.h"
+#include "SkScaledImageCache.h"
 
 SkDiscardablePixelRef::SkDiscardablePixelRef(const SkImageInfo& info,
                                              SkImageGenerator* generator,
                                              size_t rowBytes,
-                                             SkDiscardableMemory::Factory* fact)
+                                             SkDiscardableMemory::Factory* fact,
+                                             SkDiscardableMemoryPool* pool,
+                                             SkDiscardableMemoryPool::RegenerationCost cost)
     : INHERITED(info)
     , fGenerator(generator)
     , fDMFactory(fact)
+    , fDMPool(pool)
+    , fCost(cost)
     , fRowBytes(rowBytes)
     , fDiscardableMemory(NULL)
 {
@@ -24,7 +29,9 @@ SkDiscardablePixelRef::SkDiscardablePixelRef(const SkImageInfo& info,
     // The SkImageGenerator contract requires fGenerator to always
     // decode the same image on each call to getPixels().
     this->setImmutable();
+    SkASSERT(NULL == fDMFactory || NULL == fDMPool);
     SkSafeRef(fDMFactory);
+    SkSafeRef(fDMPool);
 }
 
 SkDiscardablePixelRef::~SkDiscardablePixelRef() {
@@ -33,6 +40,7 @@ SkDiscardablePixelRef::~SkDiscardablePixelRef() {
     }
     SkDELETE(fDiscardableMemory);
     SkSafeUnref(fDMFactory);
+    SkSafeUnref(fDMPool);
     SkDELETE(fGenerator);
 }
 
@@ -50,7 +58,9 @@ bool SkDiscardablePixelRef::onNewLockPixels(LockRec* rec) {
 
     const size_t size = this->info().getSafeSize(fRowBytes);
 
-    if (fDMFactory != NULL) {
+    if (fDMPool != NULL) {
+        fDiscardableMemory = fDMPool->createWithCost(size, fCost);
+    } else if (fDMFactory != NULL) {
         fDiscardableMemory = fDMFactory->create(size);
     } else {
         fDiscardableMemory = SkDiscardableMemory::Create(size);
@@ -77,9 +87,28 @@ void SkDiscardablePixelRef::onUnlockPixels() {
     fDiscardableMemory->unlock();
 }
 
-bool SkInstallDiscardablePixelRef(SkImageGenerator* generator,
-                                  SkBitmap* dst,
-                                  SkDiscardableMemory::Factory* factory) {
+bool SkDiscardablePixelRef::onDecodeInto(int pow2, SkBitmap* bitmap) {
+    SkASSERT(pow2 >= 0);
+    SkImageInfo info = this->info();
+    info.fWidth = SkMax32(info.fWidth >> pow2, 1);
+    info.fHeight = SkMax32(info.fHeight >> pow2, 1);
+    // The caller caches the result, so allocate it from the cache.
+    if (!bitmap->setConfig(info) ||
+        !bitmap->allocPixels(SkScaledImageCache::GetAllocator(), NULL)) {
+        return false;
+    }
+    if (!fGenerator->getPixels(info, bitmap->getPixels(), bitmap->rowBytes())) {
+        bitmap->reset();
+        return false;
+    }
+    return true;
+}
+
+static bool install_discardable_pixel_ref(SkImageGenerator* generator,
+                                         SkBitmap* dst,
+                                         SkDiscardableMemory::Factory* factory,
+                                         SkDiscardableMemoryPool* pool,
+                                         SkDiscardableMemoryPool::RegenerationCost cost) {
     SkImageInfo info;
     SkAutoTDelete<SkImageGenerator> autoGenerator(generator);
     if ((NULL == autoGenerator.get())
@@ -93,7 +122,24 @@ bool SkInstallDiscardablePixelRef(SkImageGenerator* generator,
     }
     SkAutoTUnref<SkDiscardablePixelRef> ref(
         SkNEW_ARGS(SkDiscardablePixelRef,
-                   (info, autoGenerator.detach(), dst->rowBytes(), factory)));
+                   (info, autoGenerator.detach(), dst->rowBytes(), factory, pool, cost)));
     dst->setPixelRef(ref);
     return true;
 }
+
+bool SkInstallDiscardablePixelRef(SkImageGenerator* generator,
+                                  SkBitmap* dst,
+                                  SkDiscardableMemory::Factory* factory) {
+    return install_discardable_pixel_ref(generator, dst, factory, NULL,
+                                         SkDiscardableMemoryPool::kDefault_RegenerationCost);
+}
+
+bool SkInstallDiscardablePixelRef(SkImageGenerator* generator,
+                                  SkBitmap* dst,
+                                  SkDiscardableMemoryPool* pool,
+                                  SkDiscardableMemoryPool::RegenerationCost cost) {
+    if (NULL == pool) {
+        pool = SkGetGlobalDiscardableMemoryPool();
+    }
+    return install_discardable_pixel_ref(generator, dst, NULL, pool, cost);
+}
@@ -9,6 +9,7 @@
 #define SkDiscardablePixelRef_DEFINED
 
 #include "SkDiscardableMemory.h"
+#include "SkDiscardableMemoryPool.h"
 #include "SkImageGenerator.h"
 #include "SkImageInfo.h"
 #include "SkPixelRef.h"
@@ -34,6 +35,11 @@ protected:
     virtual void onUnlockPixels() SK_OVERRIDE;
     virtual bool onLockPixelsAreWritable() const SK_OVERRIDE { return false; }
 
+    // Asks the generator for a decode reduced by 2^pow2, outside of our
+    // discardable memory.  As in SkCachingPixelRef, we leave
+    // onImplementsDecodeInto() alone so that full-size draws still lock us.
+    virtual bool onDecodeInto(int pow2, SkBitmap*) SK_OVERRIDE;
+
     virtual SkData* onRefEncodedData() SK_OVERRIDE {
         return fGenerator->refEncodedData();
     }
@@ -41,6 +47,10 @@ protected:
 private:
     SkImageGenerator* const fGenerator;
     SkDiscardableMemory::Factory* const fDMFactory;
+    // When set, fDMFactory is NULL and the memory is made by fDMPool
+    // with fCost.
+    SkDiscardableMemoryPool* const fDMPool;
+    const SkDiscardableMemoryPool::RegenerationCost fCost;
     const size_t fRowBytes;
     // These const members should not change over the life of the
     // PixelRef, since the SkBitmap doesn't expect them to change.
@@ -50,13 +60,29 @@ private:
     /* Takes ownership of SkImageGenerator. */
     SkDiscardablePixelRef(const SkImageInfo&, SkImageGenerator*,
                           size_t rowBytes,
-                          SkDiscardableMemory::Factory* factory);
+                          SkDiscardableMemory::Factory* factory,
+                          SkDiscardableMemoryPool* pool,
+                          SkDiscardableMemoryPool::RegenerationCost);
 
     friend bool SkInstallDiscardablePixelRef(SkImageGenerator*,
                                              SkBitmap*,
                                              SkDiscardableMemory::Factory*);
+    friend bool SkInstallDiscardablePixelRef(SkImageGenerator*,
+                                             SkBitmap*,
+                                             SkDiscardableMemoryPool*,
+                                             SkDiscardableMemoryPool::RegenerationCost);
 
     typedef SkPixelRef INHERITED;
 };
 
+/**
+ *  As SkInstallDiscardablePixelRef(), but the pixels are allocated from
+ *  pool, or the global pool if it is NULL, with a hint of how costly they
+ *  are to decode again.  The pool purges cheap pixels before expensive
+ *  ones.
+ */
+bool SkInstallDiscardablePixelRef(SkImageGenerator*, SkBitmap* dst,
+                                  SkDiscardableMemoryPool* pool,
+                                  SkDiscardableMemoryPool::RegenerationCost);
+
 #endif  // SkDiscardablePixelRef_DEFINED
@@ -9,6 +9,7 @@
 #include "SkBitmapProcState_opts_SSE2.h"
 #include "SkColorPriv.h"
 #include "SkPaint.h"
+#include "SkPerspIter.h"
 #include "SkUtils.h"
 
 void S32_opaque_D32_filter_DX_SSE2(const SkBitmapProcState& s,
@@ -633,6 +634,121 @@ void ClampX_ClampY_nofilter_affine_SSE2(const SkBitmapProcState& s,
     }
 }
 
+/*  SSE version of ClampX_ClampY_filter_persp()
+ *  portable version is in core/SkBitmapProcState_matrix.h
+ */
+void ClampX_ClampY_filter_persp_SSE2(const SkBitmapProcState& s,
+                                     uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kPerspective_Mask);
+
+    unsigned maxX = s.fBitmap->width() - 1;
+    unsigned maxY = s.fBitmap->height() - 1;
+    SkFixed oneX = s.fFilterOneX;
+    SkFixed oneY = s.fFilterOneY;
+
+    SkPerspIter iter(s.fInvMatrix,
+                     SkIntToScalar(x) + SK_ScalarHalf,
+                     SkIntToScalar(y) + SK_ScalarHalf, count);
+
+    // The clamps compare 16 bits signed, and f >> 16 always fits, so only the
+    // limits have to be checked.
+    const bool wide = (maxX | maxY) <= 0x7FFF;
+    __m128i wide_half = _mm_set_epi32(oneX >> 1, oneY >> 1, oneX >> 1, oneY >> 1);
+    __m128i wide_one  = _mm_set_epi32(oneX, oneY, oneX, oneY);
+    __m128i wide_max  = _mm_set_epi32(maxX, maxY, maxX, maxY);
+    __m128i wide_mask = _mm_set1_epi32(0xF);
+
+    while ((count = iter.next()) != 0) {
+        const SkFixed* SK_RESTRICT srcXY = iter.getXY();
+        if (wide) {
+            while (count >= 2) {
+                // The iterator gives x, y pairs; the packed pixels are y then x.
+                __m128i wide_f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcXY));
+                wide_f = _mm_shuffle_epi32(wide_f, _MM_SHUFFLE(2, 3, 0, 1));
+                wide_f = _mm_sub_epi32(wide_f, wide_half);
+
+                // i = SkClampMax(f>>16,max)
+                __m128i wide_i = _mm_max_epi16(_mm_srli_epi32(wide_f, 16),
+                                               _mm_setzero_si128());
+                wide_i = _mm_min_epi16(wide_i, wide_max);
+
+                // i<<4 | TILE_LOW_BITS(f)
+                __m128i wide_lo = _mm_srli_epi32(wide_f, 12);
+                wide_lo = _mm_and_si128(wide_lo, wide_mask);
+                wide_i  = _mm_slli_epi32(wide_i, 4);
+                wide_i  = _mm_or_si128(wide_i, wide_lo);
+
+                // i<<14
+                wide_i = _mm_slli_epi32(wide_i, 14);
+
+                // SkClampMax(((f+one))>>16,max)
+                __m128i wide_f1 = _mm_add_epi32(wide_f, wide_one);
+                wide_f1 = _mm_max_epi16(_mm_srli_epi32(wide_f1, 16),
+                                        _mm_setzero_si128());
+                wide_f1 = _mm_min_epi16(wide_f1, wide_max);
+
+                // final combination
+                wide_i = _mm_or_si128(wide_i, wide_f1);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(xy), wide_i);
+
+                srcXY += 4;
+                xy += 4;
+                count -= 2;
+            }
+        }
+        while (count-- > 0) {
+            *xy++ = ClampX_ClampY_pack_filter(srcXY[1] - (oneY >> 1), maxY, oneY);
+            *xy++ = ClampX_ClampY_pack_filter(srcXY[0] - (oneX >> 1), maxX, oneX);
+            srcXY += 2;
+        }
+    }
+}
+
+/*  SSE version of ClampX_ClampY_nofilter_persp()
+ *  portable version is in core/SkBitmapProcState_matrix_template.h
+ */
+void ClampX_ClampY_nofilter_persp_SSE2(const SkBitmapProcState& s,
+                                       uint32_t xy[], int count, int x, int y) {
+    SkASSERT(s.fInvType & SkMatrix::kPerspective_Mask);
+
+    int maxX = s.fBitmap->width() - 1;
+    int maxY = s.fBitmap->height() - 1;
+
+    SkPerspIter iter(s.fInvMatrix,
+                     SkIntToScalar(x) + SK_ScalarHalf,
+                     SkIntToScalar(y) + SK_ScalarHalf, count);
+
+    // Packing to 16 bits saturates, which the clamp would do anyway as long
+    // as the limits fit.
+    const bool wide = (maxX | maxY) <= 0x7FFF;
+    // x in the low half of each pixel, y in the high half.
+    __m128i wide_max = _mm_set1_epi32((maxY << 16) | maxX);
+
+    while ((count = iter.next()) != 0) {
+        const SkFixed* SK_RESTRICT srcXY = iter.getXY();
+        if (wide) {
+            while (count >= 4) {
+                __m128i wide_xy01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcXY));
+                __m128i wide_xy23 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcXY + 4));
+                __m128i wide_i = _mm_packs_epi32(_mm_srai_epi32(wide_xy01, 16),
+                                                 _mm_srai_epi32(wide_xy23, 16));
+                wide_i = _mm_max_epi16(wide_i, _mm_setzero_si128());
+                wide_i = _mm_min_epi16(wide_i, wide_max);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(xy), wide_i);
+
+                srcXY += 8;
+                xy += 4;
+                count -= 4;
+            }
+        }
+        while (count-- > 0) {
+            *xy++ = (SkClampMax(srcXY[1] >> 16, maxY) << 16) |
+                     SkClampMax(srcXY[0] >> 16, maxX);
+            srcXY += 2;
+        }
+    }
+}
+
 /*  SSE version of S32_D16_filter_DX_SSE2
  *  Definition is in section of "D16 functions for SRC == 8888" in SkBitmapProcState.cpp
  *  It combines S32_opaque_D32_filter_DX_SSE2 and SkPixel32ToPixel16
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBlitRow_opts_AVX2.h"
+#include "SkBitmapProcState_opts_SSE2.h"
+#include "SkBlitRow_opts_SSE2.h"
+#include "SkColorPriv.h"
+#include "SkUtils.h"
+
+/* As with the SSSE3 procs, we always build the AVX2 functions and let the caller
+ * determine AVX2 support at runtime, except for the Android framework where the
+ * compiler may not be given -mavx2. There we forward to the SSE2 versions, and
+ * the runtime check never selects these procs anyway.
+ */
+#if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || defined(__AVX2__)
+
+#include "SkColor_opts_AVX2.h"
+
+void S32A_Opaque_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src,
+                                int count, U8CPU alpha) {
+    SkASSERT(alpha == 255);
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        SkASSERT(((size_t)dst & 0x03) == 0);
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = SkPMSrcOver(*src, *dst);
+            src++;
+            dst++;
+            count--;
+        }
+
+        const __m256i* s = reinterpret_cast<const __m256i*>(src);
+        __m256i* d = reinterpret_cast<__m256i*>(dst);
+        while (count >= 8) {
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            _mm256_store_si256(d, SkPMSrcOver_AVX2(src_pixel, dst_pixel));
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    while (count > 0) {
+        *dst = SkPMSrcOver(*src, *dst);
+        src++;
+        dst++;
+        count--;
+    }
+}
+
+void S32A_Blend_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT src,
+                               int count, U8CPU alpha) {
+    SkASSERT(alpha <= 255);
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = SkBlendARGB32(*src, *dst, alpha);
+            src++;
+            dst++;
+            count--;
+        }
+
+        const __m256i* s = reinterpret_cast<const __m256i*>(src);
+        __m256i* d = reinterpret_cast<__m256i*>(dst);
+        const __m256i src_scale = _mm256_set1_epi32(SkAlpha255To256(alpha));
+        const __m256i c_256 = _mm256_set1_epi32(256);
+        while (count >= 8) {
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i dst_pixel = _mm256_load_si256(d);
+
+            // dst_scale = 256 - SkAlphaMul(srcA, src_scale)
+            __m256i dst_scale = _mm256_mullo_epi16(SkGetPackedA32_AVX2(src_pixel), src_scale);
+            dst_scale = _mm256_sub_epi32(c_256, _mm256_srli_epi32(dst_scale, 8));
+
+            __m256i result = _mm256_add_epi32(SkAlphaMulQ_AVX2(src_pixel, src_scale),
+                                              SkAlphaMulQ_AVX2(dst_pixel, dst_scale));
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    while (count > 0) {
+        *dst = SkBlendARGB32(*src, *dst, alpha);
+        src++;
+        dst++;
+        count--;
+    }
+}
+
+void Color32_AVX2(SkPMColor dst[], const SkPMColor src[], int count,
+                  SkPMColor color) {
+    if (count <= 0) {
+        return;
+    }
+
+    if (0 == color) {
+        if (src != dst) {
+            memcpy(dst, src, count * sizeof(SkPMColor));
+        }
+        return;
+    }
+
+    unsigned colorA = SkGetPackedA32(color);
+    if (255 == colorA) {
+        sk_memset32(dst, color, count);
+        return;
+    }
+
+    unsigned scale = 256 - SkAlpha255To256(colorA);
+
+    if (count >= 8) {
+        SkASSERT(((size_t)dst & 0x03) == 0);
+        while (((size_t)dst & 0x1F) != 0) {
+            *dst = color + SkAlphaMulQ(*src, scale);
+            src++;
+            dst++;
+            count--;
+        }
+
+        const __m256i* s = reinterpret_cast<const __m256i*>(src);
+        __m256i* d = reinterpret_cast<__m256i*>(dst);
+        const __m256i scale_wide = _mm256_set1_epi32(scale);
+        const __m256i color_wide = _mm256_set1_epi32(color);
+        while (count >= 8) {
+            __m256i src_pixel = _mm256_loadu_si256(s);
+            __m256i result = _mm256_add_epi8(color_wide, SkAlphaMulQ_AVX2(src_pixel, scale_wide));
+            _mm256_store_si256(d, result);
+            s++;
+            d++;
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<SkPMColor*>(d);
+    }
+
+    while (count > 0) {
+        *dst = color + SkAlphaMulQ(*src, scale);
+        src++;
+        dst++;
+        count--;
+    }
+}
+
+#else // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || defined(__AVX2__)
+
+void S32A_Opaque_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src,
+                                int count, U8CPU alpha) {
+    S32A_Opaque_BlitRow32_SSE2(dst, src, count, alpha);
+}
+
+void S32A_Blend_BlitRow32_AVX2(SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT src,
+                               int count, U8CPU alpha) {
+    S32A_Blend_BlitRow32_SSE2(dst, src, count, alpha);
+}
+
+void Color32_AVX2(SkPMColor dst[], const SkPMColor src[], int count,
+                  SkPMColor color) {
+    Color32_SSE2(dst, src, count, color);
+}
+
+#endif
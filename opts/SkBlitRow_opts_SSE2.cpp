@@ -851,6 +851,162 @@ void SkBlitLCD16OpaqueRow_SSE2(SkPMColor dst[], const uint16_t mask[],
     }
 }
 
+// Expands four 16-bit LCD masks, each zero-extended to 32 bits, into one
+// upscaled coverage value per color component: two pixels in 16-bit lanes in
+// lo and two in hi, laid out like the dst components. The alpha lanes are 0.
+// The 5-bit coverage is scaled up to 0..32 for the opaque row proc and to
+// 0..255 for the blending one, as the portable procs do.
+static void SkUnpackLCD16Mask_SSE2(const __m128i& mask, bool to255,
+                                   __m128i* lo, __m128i* hi) {
+    __m128i r = _mm_and_si128(SkPackedR16x5ToUnmaskedR32x5_SSE2(mask),
+                              _mm_set1_epi32(0x1F << SK_R32_SHIFT));
+    __m128i g = _mm_and_si128(SkPackedG16x5ToUnmaskedG32x5_SSE2(mask),
+                              _mm_set1_epi32(0x1F << SK_G32_SHIFT));
+    __m128i b = _mm_and_si128(SkPackedB16x5ToUnmaskedB32x5_SSE2(mask),
+                              _mm_set1_epi32(0x1F << SK_B32_SHIFT));
+    __m128i rgb = _mm_or_si128(_mm_or_si128(r, g), b);
+
+    __m128i mLo = _mm_unpacklo_epi8(rgb, _mm_setzero_si128());
+    __m128i mHi = _mm_unpackhi_epi8(rgb, _mm_setzero_si128());
+    if (to255) {
+        // (m << 3) | (m >> 2)
+        mLo = _mm_or_si128(_mm_slli_epi16(mLo, 3), _mm_srli_epi16(mLo, 2));
+        mHi = _mm_or_si128(_mm_slli_epi16(mHi, 3), _mm_srli_epi16(mHi, 2));
+    } else {
+        // m + (m >> 4)
+        mLo = _mm_add_epi16(mLo, _mm_srli_epi16(mLo, 4));
+        mHi = _mm_add_epi16(mHi, _mm_srli_epi16(mHi, 4));
+    }
+    *lo = mLo;
+    *hi = mHi;
+}
+
+// Loads four masks, or returns false if they are all 0.
+static bool SkLoadLCD16Mask_SSE2(const uint16_t mask[], __m128i* m) {
+    __m128i m16 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(mask));
+    if (0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi16(m16, _mm_setzero_si128()))) {
+        return false;
+    }
+    *m = _mm_unpacklo_epi16(m16, _mm_setzero_si128());
+    return true;
+}
+
+// Four pixels of LCD16_RowProc_Opaque():
+// dst = dst + ((src - dst) * mask >> 5), with mask in 0..32.
+static __m128i SkLCD16RowOpaque4_SSE2(__m128i src, __m128i dst, __m128i mask) {
+    __m128i maskLo, maskHi;
+    SkUnpackLCD16Mask_SSE2(mask, false, &maskLo, &maskHi);
+
+    __m128i srcLo = _mm_unpacklo_epi8(src, _mm_setzero_si128());
+    __m128i srcHi = _mm_unpackhi_epi8(src, _mm_setzero_si128());
+    __m128i dstLo = _mm_unpacklo_epi8(dst, _mm_setzero_si128());
+    __m128i dstHi = _mm_unpackhi_epi8(dst, _mm_setzero_si128());
+
+    // |src - dst| * 32 fits in 16 bits.
+    __m128i resultLo = _mm_add_epi16(dstLo,
+            _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(srcLo, dstLo), maskLo), 5));
+    __m128i resultHi = _mm_add_epi16(dstHi,
+            _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(srcHi, dstHi), maskHi), 5));
+
+    return _mm_or_si128(_mm_packus_epi16(resultLo, resultHi),
+                        _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT));
+}
+
+// (a * b) >> 8 for signed 16-bit a and b whose product may need 17 bits,
+// rounding down like the portable SkAlphaMul().
+static inline __m128i SkMulShift8_SSE2(__m128i a, __m128i b) {
+    __m128i lo = _mm_mullo_epi16(a, b);
+    __m128i hi = _mm_mulhi_epi16(a, b);
+    return _mm_or_si128(_mm_slli_epi16(hi, 8), _mm_srli_epi16(lo, 8));
+}
+
+#define SK_A32_LANE     (SK_A32_SHIFT / 8)
+
+// Four pixels of LCD16_RowProc_Blend():
+// dst = dst + ((src - (srcA * dst >> 8)) * mask >> 8), with mask in 0..255
+// and srcA in 0..256.
+static __m128i SkLCD16RowBlend4_SSE2(__m128i src, __m128i dst, __m128i mask) {
+    __m128i maskLo, maskHi;
+    SkUnpackLCD16Mask_SSE2(mask, true, &maskLo, &maskHi);
+
+    __m128i srcLo = _mm_unpacklo_epi8(src, _mm_setzero_si128());
+    __m128i srcHi = _mm_unpackhi_epi8(src, _mm_setzero_si128());
+    __m128i dstLo = _mm_unpacklo_epi8(dst, _mm_setzero_si128());
+    __m128i dstHi = _mm_unpackhi_epi8(dst, _mm_setzero_si128());
+
+    // Spread each pixel's alpha over its lanes, and scale it to 0..256.
+    const int alphaLanes = _MM_SHUFFLE(SK_A32_LANE, SK_A32_LANE, SK_A32_LANE, SK_A32_LANE);
+    __m128i srcALo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLo, alphaLanes), alphaLanes);
+    __m128i srcAHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHi, alphaLanes), alphaLanes);
+    srcALo = _mm_add_epi16(srcALo, _mm_srli_epi16(srcALo, 7));
+    srcAHi = _mm_add_epi16(srcAHi, _mm_srli_epi16(srcAHi, 7));
+
+    // srcA * dst is at most 256 * 255, which fits in an unsigned 16 bits.
+    __m128i diffLo = _mm_sub_epi16(srcLo, _mm_srli_epi16(_mm_mullo_epi16(srcALo, dstLo), 8));
+    __m128i diffHi = _mm_sub_epi16(srcHi, _mm_srli_epi16(_mm_mullo_epi16(srcAHi, dstHi), 8));
+
+    __m128i resultLo = _mm_add_epi16(dstLo, SkMulShift8_SSE2(diffLo, maskLo));
+    __m128i resultHi = _mm_add_epi16(dstHi, SkMulShift8_SSE2(diffHi, maskHi));
+
+    return _mm_or_si128(_mm_packus_epi16(resultLo, resultHi),
+                        _mm_set1_epi32(SK_A32_MASK << SK_A32_SHIFT));
+}
+
+#undef SK_A32_LANE
+
+template <bool kOpaque>
+static inline __m128i SkLCD16Row4_SSE2(__m128i src, __m128i dst, __m128i mask) {
+    return kOpaque ? SkLCD16RowOpaque4_SSE2(src, dst, mask)
+                   : SkLCD16RowBlend4_SSE2(src, dst, mask);
+}
+
+template <bool kOpaque>
+static void SkLCD16RowProc_SSE2(SkPMColor* SK_RESTRICT dst,
+                                const uint16_t* SK_RESTRICT mask,
+                                const SkPMColor* SK_RESTRICT src, int count) {
+    __m128i m;
+    while (count >= 4) {
+        if (SkLoadLCD16Mask_SSE2(mask, &m)) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), SkLCD16Row4_SSE2<kOpaque>(s, d, m));
+        }
+        dst += 4;
+        mask += 4;
+        src += 4;
+        count -= 4;
+    }
+
+    if (count > 0) {
+        // Run the last few pixels through the same math, padded with empty
+        // masks, so they match the rest of the row.
+        uint16_t tailMask[4] = { 0, 0, 0, 0 };
+        SkPMColor tailSrc[4] = { 0, 0, 0, 0 };
+        SkPMColor tailDst[4] = { 0, 0, 0, 0 };
+        memcpy(tailMask, mask, count * sizeof(uint16_t));
+        memcpy(tailSrc, src, count * sizeof(SkPMColor));
+        memcpy(tailDst, dst, count * sizeof(SkPMColor));
+        if (SkLoadLCD16Mask_SSE2(tailMask, &m)) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tailSrc));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(tailDst));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(tailDst), SkLCD16Row4_SSE2<kOpaque>(s, d, m));
+            memcpy(dst, tailDst, count * sizeof(SkPMColor));
+        }
+    }
+}
+
+void SkLCD16_RowProc_Blend_SSE2(SkPMColor* SK_RESTRICT dst,
+                                const uint16_t* SK_RESTRICT mask,
+                                const SkPMColor* SK_RESTRICT src, int count) {
+    SkLCD16RowProc_SSE2<false>(dst, mask, src, count);
+}
+
+void SkLCD16_RowProc_Opaque_SSE2(SkPMColor* SK_RESTRICT dst,
+                                 const uint16_t* SK_RESTRICT mask,
+                                 const SkPMColor* SK_RESTRICT src, int count) {
+    SkLCD16RowProc_SSE2<true>(dst, mask, src, count);
+}
+
 /* SSE2 version of S32_D565_Opaque()
  * portable version is in core/SkBlitRow_D16.cpp
  */
@@ -1359,3 +1515,394 @@ void S32A_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
         } while (--count != 0);
     }
 }
+
+// Returns the 8 bit component at shift of eight pixels, in 16 bit lanes.
+static inline __m128i SkUnpackComponent32_SSE2(const __m128i& src_pixel1,
+                                               const __m128i& src_pixel2,
+                                               int shift) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i c1 = _mm_and_si128(_mm_srli_epi32(src_pixel1, shift), mask);
+    __m128i c2 = _mm_and_si128(_mm_srli_epi32(src_pixel2, shift), mask);
+    return _mm_packs_epi32(c1, c2);
+}
+
+// The dither values of the eight pixels starting at x, as DITHER_VALUE().
+static inline __m128i SkDitherValues565_SSE2(int x, int y) {
+    unsigned short dither_value[8];
+#ifdef ENABLE_DITHER_MATRIX_4X4
+    const uint8_t* dither_scan = gDitherMatrix_3Bit_4X4[(y) & 3];
+    for (int i = 0; i < 4; ++i) {
+        dither_value[i] = dither_value[i + 4] = dither_scan[(x + i) & 3];
+    }
+#else
+    const uint16_t dither_scan = gDitherMatrix_3Bit_16[(y) & 3];
+    for (int i = 0; i < 4; ++i) {
+        dither_value[i] = dither_value[i + 4] = (dither_scan >> (((x + i) & 3) << 2)) & 0xF;
+    }
+#endif
+    return _mm_loadu_si128((__m128i*) dither_value);
+}
+
+// As SkAlphaBlend(), on eight 16 bit lanes.
+static inline __m128i SkAlphaBlend_SSE2(const __m128i& src, const __m128i& dst,
+                                        const __m128i& scale) {
+    __m128i diff = _mm_mullo_epi16(_mm_sub_epi16(src, dst), scale);
+    return _mm_add_epi16(dst, _mm_srai_epi16(diff, 8));
+}
+
+// As SkDiv255Round(), on eight 16 bit lanes.
+static inline __m128i SkDiv255Round_SSE2(const __m128i& x) {
+    __m128i prod = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+/* SSE2 version of S32_D565_Blend()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+static inline uint16_t S32_D565_Blend_Pixel(SkPMColor c, uint16_t d, int scale) {
+    return SkPackRGB16(SkAlphaBlend(SkPacked32ToR16(c), SkGetPackedR16(d), scale),
+                       SkAlphaBlend(SkPacked32ToG16(c), SkGetPackedG16(d), scale),
+                       SkAlphaBlend(SkPacked32ToB16(c), SkGetPackedB16(d), scale));
+}
+
+void S32_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                         const SkPMColor* SK_RESTRICT src, int count,
+                         U8CPU alpha, int /*x*/, int /*y*/) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    const int scale = SkAlpha255To256(alpha);
+    if (count >= 8) {
+        while (((size_t)dst & 0x0F) != 0) {
+            SkPMColorAssert(*src);
+            *dst = S32_D565_Blend_Pixel(*src++, *dst, scale);
+            dst++;
+            count--;
+        }
+
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        const __m128i scale_wide = _mm_set1_epi16(scale);
+
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_load_si128(d);
+
+            __m128i sr = _mm_srli_epi16(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                 SK_R32_SHIFT),
+                                        SK_R32_BITS - SK_R16_BITS);
+            __m128i sg = _mm_srli_epi16(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                 SK_G32_SHIFT),
+                                        SK_G32_BITS - SK_G16_BITS);
+            __m128i sb = _mm_srli_epi16(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                 SK_B32_SHIFT),
+                                        SK_B32_BITS - SK_B16_BITS);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT),
+                                       _mm_set1_epi16(SK_R16_MASK));
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT),
+                                       _mm_set1_epi16(SK_G16_MASK));
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT),
+                                       _mm_set1_epi16(SK_B16_MASK));
+
+            __m128i d_pixel = SkPackRGB16_SSE2(SkAlphaBlend_SSE2(sr, dr, scale_wide),
+                                               SkAlphaBlend_SSE2(sg, dg, scale_wide),
+                                               SkAlphaBlend_SSE2(sb, db, scale_wide));
+            _mm_store_si128(d++, d_pixel);
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    while (count > 0) {
+        SkPMColorAssert(*src);
+        *dst = S32_D565_Blend_Pixel(*src++, *dst, scale);
+        dst++;
+        count--;
+    }
+}
+
+/* SSE2 version of S32A_D565_Blend()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+static inline uint16_t S32A_D565_Blend_Pixel(SkPMColor sc, uint16_t dc, U8CPU alpha) {
+    unsigned dst_scale = 255 - SkMulDiv255Round(SkGetPackedA32(sc), alpha);
+    unsigned dr = SkMulS16(SkPacked32ToR16(sc), alpha) + SkMulS16(SkGetPackedR16(dc), dst_scale);
+    unsigned dg = SkMulS16(SkPacked32ToG16(sc), alpha) + SkMulS16(SkGetPackedG16(dc), dst_scale);
+    unsigned db = SkMulS16(SkPacked32ToB16(sc), alpha) + SkMulS16(SkGetPackedB16(dc), dst_scale);
+    return SkPackRGB16(SkDiv255Round(dr), SkDiv255Round(dg), SkDiv255Round(db));
+}
+
+void S32A_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                          const SkPMColor* SK_RESTRICT src, int count,
+                          U8CPU alpha, int /*x*/, int /*y*/) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    if (count >= 8) {
+        while (((size_t)dst & 0x0F) != 0) {
+            SkPMColor c = *src++;
+            SkPMColorAssert(c);
+            if (c) {
+                *dst = S32A_D565_Blend_Pixel(c, *dst, alpha);
+            }
+            dst++;
+            count--;
+        }
+
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        const __m128i alpha_wide = _mm_set1_epi16(alpha);
+
+        // A transparent source pixel leaves dst as it was, so it needs no special case.
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_load_si128(d);
+
+            // dst_scale = 255 - SkMulDiv255Round(sa, alpha)
+            __m128i sa = SkUnpackComponent32_SSE2(src_pixel1, src_pixel2, SK_A32_SHIFT);
+            __m128i dst_scale = _mm_sub_epi16(_mm_set1_epi16(255),
+                    SkDiv255Round_SSE2(_mm_mullo_epi16(sa, alpha_wide)));
+
+            __m128i sr = _mm_srli_epi16(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                 SK_R32_SHIFT),
+                                        SK_R32_BITS - SK_R16_BITS);
+            __m128i sg = _mm_srli_epi16(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                 SK_G32_SHIFT),
+                                        SK_G32_BITS - SK_G16_BITS);
+            __m128i sb = _mm_srli_epi16(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                 SK_B32_SHIFT),
+                                        SK_B32_BITS - SK_B16_BITS);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT),
+                                       _mm_set1_epi16(SK_R16_MASK));
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT),
+                                       _mm_set1_epi16(SK_G16_MASK));
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT),
+                                       _mm_set1_epi16(SK_B16_MASK));
+
+            dr = _mm_add_epi16(_mm_mullo_epi16(sr, alpha_wide), _mm_mullo_epi16(dr, dst_scale));
+            dg = _mm_add_epi16(_mm_mullo_epi16(sg, alpha_wide), _mm_mullo_epi16(dg, dst_scale));
+            db = _mm_add_epi16(_mm_mullo_epi16(sb, alpha_wide), _mm_mullo_epi16(db, dst_scale));
+
+            __m128i d_pixel = SkPackRGB16_SSE2(SkDiv255Round_SSE2(dr),
+                                               SkDiv255Round_SSE2(dg),
+                                               SkDiv255Round_SSE2(db));
+            _mm_store_si128(d++, d_pixel);
+            count -= 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    while (count > 0) {
+        SkPMColor c = *src++;
+        SkPMColorAssert(c);
+        if (c) {
+            *dst = S32A_D565_Blend_Pixel(c, *dst, alpha);
+        }
+        dst++;
+        count--;
+    }
+}
+
+// SkDITHER_R32To565() and friends, on eight 16 bit lanes.
+static inline __m128i SkDitherR32To565_SSE2(const __m128i& r, const __m128i& dither) {
+    __m128i c = _mm_sub_epi16(_mm_add_epi16(r, dither), _mm_srli_epi16(r, 5));
+    return _mm_srli_epi16(c, SK_R32_BITS - SK_R16_BITS);
+}
+
+static inline __m128i SkDitherG32To565_SSE2(const __m128i& g, const __m128i& dither) {
+    __m128i c = _mm_sub_epi16(_mm_add_epi16(g, _mm_srli_epi16(dither, 1)), _mm_srli_epi16(g, 6));
+    return _mm_srli_epi16(c, SK_G32_BITS - SK_G16_BITS);
+}
+
+static inline __m128i SkDitherB32To565_SSE2(const __m128i& b, const __m128i& dither) {
+    __m128i c = _mm_sub_epi16(_mm_add_epi16(b, dither), _mm_srli_epi16(b, 5));
+    return _mm_srli_epi16(c, SK_B32_BITS - SK_B16_BITS);
+}
+
+/* SSE2 version of S32_D565_Blend_Dither()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+static inline uint16_t S32_D565_Blend_Dither_Pixel(SkPMColor c, uint16_t d, int scale,
+                                                   int dither) {
+    int sr = SkDITHER_R32To565(SkGetPackedR32(c), dither);
+    int sg = SkDITHER_G32To565(SkGetPackedG32(c), dither);
+    int sb = SkDITHER_B32To565(SkGetPackedB32(c), dither);
+    return SkPackRGB16(SkAlphaBlend(sr, SkGetPackedR16(d), scale),
+                       SkAlphaBlend(sg, SkGetPackedG16(d), scale),
+                       SkAlphaBlend(sb, SkGetPackedB16(d), scale));
+}
+
+void S32_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src,
+                                int count, U8CPU alpha, int x, int y) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    const int scale = SkAlpha255To256(alpha);
+    DITHER_565_SCAN(y);
+    if (count >= 8) {
+        while (((size_t)dst & 0x0F) != 0) {
+            SkPMColorAssert(*src);
+            *dst = S32_D565_Blend_Dither_Pixel(*src++, *dst, scale, DITHER_VALUE(x));
+            dst++;
+            DITHER_INC_X(x);
+            count--;
+        }
+
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        const __m128i scale_wide = _mm_set1_epi16(scale);
+        // Eight pixels on, x has the same dither values.
+        const __m128i dither = SkDitherValues565_SSE2(x, y);
+
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_load_si128(d);
+
+            __m128i sr = SkDitherR32To565_SSE2(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                        SK_R32_SHIFT), dither);
+            __m128i sg = SkDitherG32To565_SSE2(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                        SK_G32_SHIFT), dither);
+            __m128i sb = SkDitherB32To565_SSE2(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                        SK_B32_SHIFT), dither);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT),
+                                       _mm_set1_epi16(SK_R16_MASK));
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT),
+                                       _mm_set1_epi16(SK_G16_MASK));
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT),
+                                       _mm_set1_epi16(SK_B16_MASK));
+
+            __m128i d_pixel = SkPackRGB16_SSE2(SkAlphaBlend_SSE2(sr, dr, scale_wide),
+                                               SkAlphaBlend_SSE2(sg, dg, scale_wide),
+                                               SkAlphaBlend_SSE2(sb, db, scale_wide));
+            _mm_store_si128(d++, d_pixel);
+            count -= 8;
+            x += 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    while (count > 0) {
+        SkPMColorAssert(*src);
+        *dst = S32_D565_Blend_Dither_Pixel(*src++, *dst, scale, DITHER_VALUE(x));
+        dst++;
+        DITHER_INC_X(x);
+        count--;
+    }
+}
+
+/* SSE2 version of S32A_D565_Blend_Dither()
+ * portable version is in core/SkBlitRow_D16.cpp
+ */
+static inline uint16_t S32A_D565_Blend_Dither_Pixel(SkPMColor c, uint16_t d, int src_scale,
+                                                    int dither) {
+    int sa = SkGetPackedA32(c);
+    int dst_scale = SkAlpha255To256(255 - SkAlphaMul(sa, src_scale));
+
+    int sr = SkDITHER_R32To565(SkGetPackedR32(c), dither);
+    int sg = SkDITHER_G32To565(SkGetPackedG32(c), dither);
+    int sb = SkDITHER_B32To565(SkGetPackedB32(c), dither);
+
+    int dr = (sr * src_scale + SkGetPackedR16(d) * dst_scale) >> 8;
+    int dg = (sg * src_scale + SkGetPackedG16(d) * dst_scale) >> 8;
+    int db = (sb * src_scale + SkGetPackedB16(d) * dst_scale) >> 8;
+    return SkPackRGB16(dr, dg, db);
+}
+
+void S32A_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                 const SkPMColor* SK_RESTRICT src,
+                                 int count, U8CPU alpha, int x, int y) {
+    SkASSERT(255 > alpha);
+
+    if (count <= 0) {
+        return;
+    }
+
+    const int src_scale = SkAlpha255To256(alpha);
+    DITHER_565_SCAN(y);
+    if (count >= 8) {
+        while (((size_t)dst & 0x0F) != 0) {
+            SkPMColor c = *src++;
+            SkPMColorAssert(c);
+            if (c) {
+                *dst = S32A_D565_Blend_Dither_Pixel(c, *dst, src_scale, DITHER_VALUE(x));
+            }
+            dst++;
+            DITHER_INC_X(x);
+            count--;
+        }
+
+        const __m128i* s = reinterpret_cast<const __m128i*>(src);
+        __m128i* d = reinterpret_cast<__m128i*>(dst);
+        const __m128i src_scale_wide = _mm_set1_epi16(src_scale);
+        const __m128i dither = SkDitherValues565_SSE2(x, y);
+
+        // A transparent source pixel leaves dst as it was, so it needs no special case.
+        while (count >= 8) {
+            __m128i src_pixel1 = _mm_loadu_si128(s++);
+            __m128i src_pixel2 = _mm_loadu_si128(s++);
+            __m128i dst_pixel = _mm_load_si128(d);
+
+            // dst_scale = SkAlpha255To256(255 - SkAlphaMul(sa, src_scale))
+            __m128i sa = SkUnpackComponent32_SSE2(src_pixel1, src_pixel2, SK_A32_SHIFT);
+            __m128i dst_scale = _mm_sub_epi16(_mm_set1_epi16(256),
+                    _mm_srli_epi16(_mm_mullo_epi16(sa, src_scale_wide), 8));
+
+            __m128i sr = SkDitherR32To565_SSE2(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                        SK_R32_SHIFT), dither);
+            __m128i sg = SkDitherG32To565_SSE2(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                        SK_G32_SHIFT), dither);
+            __m128i sb = SkDitherB32To565_SSE2(SkUnpackComponent32_SSE2(src_pixel1, src_pixel2,
+                                                                        SK_B32_SHIFT), dither);
+
+            __m128i dr = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_R16_SHIFT),
+                                       _mm_set1_epi16(SK_R16_MASK));
+            __m128i dg = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_G16_SHIFT),
+                                       _mm_set1_epi16(SK_G16_MASK));
+            __m128i db = _mm_and_si128(_mm_srli_epi16(dst_pixel, SK_B16_SHIFT),
+                                       _mm_set1_epi16(SK_B16_MASK));
+
+            dr = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(sr, src_scale_wide),
+                                              _mm_mullo_epi16(dr, dst_scale)), 8);
+            dg = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(sg, src_scale_wide),
+                                              _mm_mullo_epi16(dg, dst_scale)), 8);
+            db = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(sb, src_scale_wide),
+                                              _mm_mullo_epi16(db, dst_scale)), 8);
+
+            _mm_store_si128(d++, SkPackRGB16_SSE2(dr, dg, db));
+            count -= 8;
+            x += 8;
+        }
+        src = reinterpret_cast<const SkPMColor*>(s);
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+
+    while (count > 0) {
+        SkPMColor c = *src++;
+        SkPMColorAssert(c);
+        if (c) {
+            *dst = S32A_D565_Blend_Dither_Pixel(c, *dst, src_scale, DITHER_VALUE(x));
+        }
+        dst++;
+        DITHER_INC_X(x);
+        count--;
+    }
+}
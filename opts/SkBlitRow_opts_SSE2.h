@@ -30,6 +30,13 @@ void SkBlitLCD16Row_SSE2(SkPMColor dst[], const uint16_t src[],
 void SkBlitLCD16OpaqueRow_SSE2(SkPMColor dst[], const uint16_t src[],
                                SkColor color, int width, SkPMColor opaqueDst);
 
+void SkLCD16_RowProc_Blend_SSE2(SkPMColor* SK_RESTRICT dst,
+                                const uint16_t* SK_RESTRICT mask,
+                                const SkPMColor* SK_RESTRICT src, int count);
+void SkLCD16_RowProc_Opaque_SSE2(SkPMColor* SK_RESTRICT dst,
+                                 const uint16_t* SK_RESTRICT mask,
+                                 const SkPMColor* SK_RESTRICT src, int count);
+
 void S32_D565_Opaque_SSE2(uint16_t* SK_RESTRICT dst,
                           const SkPMColor* SK_RESTRICT src, int count,
                           U8CPU alpha, int /*x*/, int /*y*/);
@@ -42,5 +49,17 @@ void S32_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
 void S32A_D565_Opaque_Dither_SSE2(uint16_t* SK_RESTRICT dst,
                                   const SkPMColor* SK_RESTRICT src,
                                   int count, U8CPU alpha, int x, int y);
+void S32_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                         const SkPMColor* SK_RESTRICT src, int count,
+                         U8CPU alpha, int /*x*/, int /*y*/);
+void S32A_D565_Blend_SSE2(uint16_t* SK_RESTRICT dst,
+                          const SkPMColor* SK_RESTRICT src, int count,
+                          U8CPU alpha, int /*x*/, int /*y*/);
+void S32_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                const SkPMColor* SK_RESTRICT src,
+                                int count, U8CPU alpha, int x, int y);
+void S32A_D565_Blend_Dither_SSE2(uint16_t* SK_RESTRICT dst,
+                                 const SkPMColor* SK_RESTRICT src,
+                                 int count, U8CPU alpha, int x, int y);
 
 #endif
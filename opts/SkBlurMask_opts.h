@@ -0,0 +1,166 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlurMask_opts_DEFINED
+#define SkBlurMask_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Box blurs each of the width columns of an A8 image that is height rows
+ *  tall, with the kernel running down the columns. Each column produces
+ *  height + 2 * max(leftRadius, rightRadius) rows of output, laid out exactly
+ *  like one row of the scalar boxBlur() in SkBlurMask.cpp.
+ */
+typedef void (*SkBoxBlurA8Proc)(const uint8_t* src, int srcRowBytes,
+                                uint8_t* dst, int dstRowBytes,
+                                int leftRadius, int rightRadius,
+                                int width, int height);
+
+/**
+ *  As SkBoxBlurA8Proc, but for the non-integer radius kernel of
+ *  boxBlurInterp(). Each column produces height + 2 * radius rows.
+ */
+typedef void (*SkBoxBlurInterpA8Proc)(const uint8_t* src, int srcRowBytes,
+                                      uint8_t* dst, int dstRowBytes,
+                                      int radius, uint8_t outerWeight,
+                                      int width, int height);
+
+/**
+ *  Writes the transpose of the width x height A8 image src into dst, which
+ *  is height pixels wide and width rows tall.
+ */
+typedef void (*SkTransposeA8Proc)(const uint8_t* src, int srcRowBytes,
+                                  uint8_t* dst, int dstRowBytes,
+                                  int width, int height);
+
+struct SkBlurMaskProcs {
+    SkBoxBlurA8Proc       fBoxBlur;
+    SkBoxBlurInterpA8Proc fBoxBlurInterp;
+    SkTransposeA8Proc     fTranspose;
+};
+
+bool SkBlurMaskGetPlatformProcs(SkBlurMaskProcs* procs);
+
+///////////////////////////////////////////////////////////////////////////////
+// Single column versions of the procs above, for the columns the SIMD code
+// has left over. These do the same arithmetic as SkBlurMask.cpp.
+
+static inline void SkBoxBlurA8Column(const uint8_t* src, int srcRowBytes,
+                                     uint8_t* dst, int dstRowBytes,
+                                     int leftRadius, int rightRadius, int height) {
+    const int diameter = leftRadius + rightRadius;
+    const int border = SkMin32(height, diameter);
+    const uint32_t scale = (1 << 24) / (diameter + 1);
+    const uint32_t half = 1 << 23;
+    const uint8_t* right = src;
+    const uint8_t* left = src;
+    uint32_t sum = 0;
+
+    for (int i = 0; i < rightRadius - leftRadius; ++i) {
+        *dst = 0;
+        dst += dstRowBytes;
+    }
+    for (int y = 0; y < border; ++y) {
+        sum += *right;
+        right += srcRowBytes;
+        *dst = (sum * scale + half) >> 24;
+        dst += dstRowBytes;
+    }
+    for (int y = height; y < diameter; ++y) {
+        *dst = (sum * scale + half) >> 24;
+        dst += dstRowBytes;
+    }
+    for (int y = diameter; y < height; ++y) {
+        sum += *right;
+        right += srcRowBytes;
+        *dst = (sum * scale + half) >> 24;
+        dst += dstRowBytes;
+        sum -= *left;
+        left += srcRowBytes;
+    }
+    for (int y = 0; y < border; ++y) {
+        *dst = (sum * scale + half) >> 24;
+        dst += dstRowBytes;
+        sum -= *left;
+        left += srcRowBytes;
+    }
+    for (int i = 0; i < leftRadius - rightRadius; ++i) {
+        *dst = 0;
+        dst += dstRowBytes;
+    }
+    SkASSERT(sum == 0);
+}
+
+// The weights and scales for SkBoxBlurInterpA8Proc, as in boxBlurInterp().
+static inline void SkBoxBlurInterpScales(int radius, uint8_t outerWeight,
+                                         uint32_t* outerScale, uint32_t* innerScale) {
+    const int kernelSize = radius * 2 + 1;
+    uint8_t outer = outerWeight;  // Kept 8 bits wide, as in boxBlurInterp().
+    int inner = 255 - outer;
+    outer += outer >> 7;
+    inner += inner >> 7;
+    *outerScale = (outer << 16) / kernelSize;
+    *innerScale = (inner << 16) / (kernelSize - 2);
+}
+
+static inline void SkBoxBlurInterpA8Column(const uint8_t* src, int srcRowBytes,
+                                           uint8_t* dst, int dstRowBytes,
+                                           int radius, uint8_t outerWeight, int height) {
+    const int diameter = radius * 2;
+    const int border = SkMin32(height, diameter);
+    uint32_t outerScale, innerScale;
+    SkBoxBlurInterpScales(radius, outerWeight, &outerScale, &innerScale);
+    const uint32_t half = 1 << 23;
+    const uint8_t* right = src;
+    const uint8_t* left = src;
+    uint32_t outerSum = 0, innerSum = 0;
+
+    for (int y = 0; y < border; ++y) {
+        innerSum = outerSum;
+        outerSum += *right;
+        right += srcRowBytes;
+        *dst = (outerSum * outerScale + innerSum * innerScale + half) >> 24;
+        dst += dstRowBytes;
+    }
+    for (int y = height; y < diameter; ++y) {
+        *dst = (outerSum * outerScale + innerSum * innerScale + half) >> 24;
+        dst += dstRowBytes;
+    }
+    for (int y = diameter; y < height; ++y) {
+        innerSum = outerSum - *left;
+        outerSum += *right;
+        right += srcRowBytes;
+        *dst = (outerSum * outerScale + innerSum * innerScale + half) >> 24;
+        dst += dstRowBytes;
+        outerSum -= *left;
+        left += srcRowBytes;
+    }
+    for (int y = 0; y < border; ++y) {
+        innerSum = outerSum - *left;
+        left += srcRowBytes;
+        *dst = (outerSum * outerScale + innerSum * innerScale + half) >> 24;
+        dst += dstRowBytes;
+        outerSum = innerSum;
+    }
+    SkASSERT(outerSum == 0 && innerSum == 0);
+}
+
+static inline void SkTransposeA8Block(const uint8_t* src, int srcRowBytes,
+                                      uint8_t* dst, int dstRowBytes,
+                                      int width, int height) {
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* sptr = src + y * srcRowBytes;
+        uint8_t* dptr = dst + y;
+        for (int x = 0; x < width; ++x) {
+            *dptr = sptr[x];
+            dptr += dstRowBytes;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <emmintrin.h>
+#include "SkBlurMask_opts_SSE2.h"
+
+namespace {
+
+// Running sums for 16 columns, one 32-bit lane per column.
+struct Sum16 {
+    __m128i f[4];
+
+    void setZero() {
+        f[0] = f[1] = f[2] = f[3] = _mm_setzero_si128();
+    }
+
+    void load(const uint8_t* row) {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        f[0] = _mm_unpacklo_epi16(lo, zero);
+        f[1] = _mm_unpackhi_epi16(lo, zero);
+        f[2] = _mm_unpacklo_epi16(hi, zero);
+        f[3] = _mm_unpackhi_epi16(hi, zero);
+    }
+
+    void add(const Sum16& other) {
+        for (int i = 0; i < 4; ++i) {
+            f[i] = _mm_add_epi32(f[i], other.f[i]);
+        }
+    }
+
+    void sub(const Sum16& other) {
+        for (int i = 0; i < 4; ++i) {
+            f[i] = _mm_sub_epi32(f[i], other.f[i]);
+        }
+    }
+};
+
+// SSE2 has no 32-bit multiply, so the even and odd lanes are multiplied as
+// 64-bit products. The low 32 bits are kept before shifting so the result
+// wraps exactly like the scalar uint32_t math.
+inline __m128i mul_even(__m128i a, __m128i scale) {
+    return _mm_mul_epu32(a, scale);
+}
+
+inline __m128i mul_odd(__m128i a, __m128i scale) {
+    return _mm_mul_epu32(_mm_srli_epi64(a, 32), scale);
+}
+
+inline __m128i finish_lanes(__m128i even, __m128i odd, __m128i half, __m128i lo32) {
+    even = _mm_srli_epi64(_mm_and_si128(_mm_add_epi64(even, half), lo32), 24);
+    odd = _mm_srli_epi64(_mm_and_si128(_mm_add_epi64(odd, half), lo32), 24);
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+inline void store16(uint8_t* dst, const __m128i result[4]) {
+    __m128i lo = _mm_packs_epi32(result[0], result[1]);
+    __m128i hi = _mm_packs_epi32(result[2], result[3]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(lo, hi));
+}
+
+class BoxScaler {
+public:
+    BoxScaler(int kernelSize)
+        : fScale(_mm_set1_epi32((1 << 24) / kernelSize))
+        , fHalf(_mm_set_epi32(0, 1 << 23, 0, 1 << 23))
+        , fLo32(_mm_set_epi32(0, ~0, 0, ~0)) {
+    }
+
+    // *dst = (sum * scale + half) >> 24
+    void store(uint8_t* dst, const Sum16& sum) const {
+        __m128i result[4];
+        for (int i = 0; i < 4; ++i) {
+            result[i] = finish_lanes(mul_even(sum.f[i], fScale), mul_odd(sum.f[i], fScale),
+                                     fHalf, fLo32);
+        }
+        store16(dst, result);
+    }
+
+private:
+    const __m128i fScale;
+    const __m128i fHalf;
+    const __m128i fLo32;
+};
+
+class InterpScaler {
+public:
+    InterpScaler(int radius, uint8_t outerWeight)
+        : fHalf(_mm_set_epi32(0, 1 << 23, 0, 1 << 23))
+        , fLo32(_mm_set_epi32(0, ~0, 0, ~0)) {
+        uint32_t outerScale, innerScale;
+        SkBoxBlurInterpScales(radius, outerWeight, &outerScale, &innerScale);
+        fOuterScale = _mm_set1_epi32(outerScale);
+        fInnerScale = _mm_set1_epi32(innerScale);
+    }
+
+    // *dst = (outer * outerScale + inner * innerScale + half) >> 24
+    void store(uint8_t* dst, const Sum16& outer, const Sum16& inner) const {
+        __m128i result[4];
+        for (int i = 0; i < 4; ++i) {
+            __m128i even = _mm_add_epi64(mul_even(outer.f[i], fOuterScale),
+                                         mul_even(inner.f[i], fInnerScale));
+            __m128i odd = _mm_add_epi64(mul_odd(outer.f[i], fOuterScale),
+                                        mul_odd(inner.f[i], fInnerScale));
+            result[i] = finish_lanes(even, odd, fHalf, fLo32);
+        }
+        store16(dst, result);
+    }
+
+private:
+    __m128i fOuterScale;
+    __m128i fInnerScale;
+    const __m128i fHalf;
+    const __m128i fLo32;
+};
+
+void store_zeros(uint8_t* dst) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_setzero_si128());
+}
+
+}  // namespace
+
+void SkBoxBlurA8_SSE2(const uint8_t* src, int srcRowBytes,
+                      uint8_t* dst, int dstRowBytes,
+                      int leftRadius, int rightRadius,
+                      int width, int height) {
+    const int diameter = leftRadius + rightRadius;
+    const int border = SkMin32(height, diameter);
+    const BoxScaler scaler(diameter + 1);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t* right = src + x;
+        const uint8_t* left = right;
+        uint8_t* dptr = dst + x;
+        Sum16 sum, pixels;
+        sum.setZero();
+
+        for (int i = 0; i < rightRadius - leftRadius; ++i) {
+            store_zeros(dptr);
+            dptr += dstRowBytes;
+        }
+        for (int y = 0; y < border; ++y) {
+            pixels.load(right);
+            sum.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+        }
+        for (int y = height; y < diameter; ++y) {
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+        }
+        for (int y = diameter; y < height; ++y) {
+            pixels.load(right);
+            sum.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+            pixels.load(left);
+            sum.sub(pixels);
+            left += srcRowBytes;
+        }
+        for (int y = 0; y < border; ++y) {
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+            pixels.load(left);
+            sum.sub(pixels);
+            left += srcRowBytes;
+        }
+        for (int i = 0; i < leftRadius - rightRadius; ++i) {
+            store_zeros(dptr);
+            dptr += dstRowBytes;
+        }
+    }
+    for (; x < width; ++x) {
+        SkBoxBlurA8Column(src + x, srcRowBytes, dst + x, dstRowBytes,
+                          leftRadius, rightRadius, height);
+    }
+}
+
+void SkBoxBlurInterpA8_SSE2(const uint8_t* src, int srcRowBytes,
+                            uint8_t* dst, int dstRowBytes,
+                            int radius, uint8_t outerWeight,
+                            int width, int height) {
+    const int diameter = radius * 2;
+    const int border = SkMin32(height, diameter);
+    const InterpScaler scaler(radius, outerWeight);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t* right = src + x;
+        const uint8_t* left = right;
+        uint8_t* dptr = dst + x;
+        Sum16 outer, inner, pixels;
+        outer.setZero();
+        inner.setZero();
+
+        for (int y = 0; y < border; ++y) {
+            inner = outer;
+            pixels.load(right);
+            outer.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+        }
+        for (int y = height; y < diameter; ++y) {
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+        }
+        for (int y = diameter; y < height; ++y) {
+            Sum16 leftPixels;
+            leftPixels.load(left);
+            left += srcRowBytes;
+            inner = outer;
+            inner.sub(leftPixels);
+            pixels.load(right);
+            outer.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+            outer.sub(leftPixels);
+        }
+        for (int y = 0; y < border; ++y) {
+            pixels.load(left);
+            left += srcRowBytes;
+            inner = outer;
+            inner.sub(pixels);
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+            outer = inner;
+        }
+    }
+    for (; x < width; ++x) {
+        SkBoxBlurInterpA8Column(src + x, srcRowBytes, dst + x, dstRowBytes,
+                                radius, outerWeight, height);
+    }
+}
+
+void SkTransposeA8_SSE2(const uint8_t* src, int srcRowBytes,
+                        uint8_t* dst, int dstRowBytes,
+                        int width, int height) {
+    int y = 0;
+    for (; y + 16 <= height; y += 16) {
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            // Interleaving row i with row i + 8 four times over transposes
+            // a 16x16 block of bytes.
+            __m128i rows[16], tmp[16];
+            for (int i = 0; i < 16; ++i) {
+                rows[i] = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(src + (y + i) * srcRowBytes + x));
+            }
+            for (int pass = 0; pass < 4; ++pass) {
+                for (int i = 0; i < 8; ++i) {
+                    tmp[2 * i]     = _mm_unpacklo_epi8(rows[i], rows[i + 8]);
+                    tmp[2 * i + 1] = _mm_unpackhi_epi8(rows[i], rows[i + 8]);
+                }
+                for (int i = 0; i < 16; ++i) {
+                    rows[i] = tmp[i];
+                }
+            }
+            for (int i = 0; i < 16; ++i) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x + i) * dstRowBytes + y),
+                                 rows[i]);
+            }
+        }
+        SkTransposeA8Block(src + y * srcRowBytes + x, srcRowBytes,
+                           dst + x * dstRowBytes + y, dstRowBytes,
+                           width - x, 16);
+    }
+    SkTransposeA8Block(src + y * srcRowBytes, srcRowBytes, dst + y, dstRowBytes,
+                       width, height - y);
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBlurMask_opts_neon.h"
+#include "SkUtilsArm.h"
+
+bool SkBlurMaskGetPlatformProcs(SkBlurMaskProcs* procs) {
+#if SK_ARM_NEON_IS_NONE
+    return false;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return false;
+    }
+#endif
+    procs->fBoxBlur = SkBoxBlurA8_neon;
+    procs->fBoxBlurInterp = SkBoxBlurInterpA8_neon;
+    procs->fTranspose = SkTransposeA8_neon;
+    return true;
+#endif
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBlurMask_opts_neon.h"
+
+#include <arm_neon.h>
+
+namespace {
+
+// Running sums for 16 columns, one 32-bit lane per column. NEON multiplies
+// 32-bit lanes directly, and wraps just like the scalar uint32_t math.
+struct Sum16 {
+    uint32x4_t f[4];
+
+    void setZero() {
+        f[0] = f[1] = f[2] = f[3] = vdupq_n_u32(0);
+    }
+
+    void load(const uint8_t* row) {
+        uint8x16_t bytes = vld1q_u8(row);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+        f[0] = vmovl_u16(vget_low_u16(lo));
+        f[1] = vmovl_u16(vget_high_u16(lo));
+        f[2] = vmovl_u16(vget_low_u16(hi));
+        f[3] = vmovl_u16(vget_high_u16(hi));
+    }
+
+    void add(const Sum16& other) {
+        for (int i = 0; i < 4; ++i) {
+            f[i] = vaddq_u32(f[i], other.f[i]);
+        }
+    }
+
+    void sub(const Sum16& other) {
+        for (int i = 0; i < 4; ++i) {
+            f[i] = vsubq_u32(f[i], other.f[i]);
+        }
+    }
+};
+
+inline void store16(uint8_t* dst, const uint32x4_t result[4]) {
+    uint16x8_t lo = vcombine_u16(vmovn_u32(result[0]), vmovn_u32(result[1]));
+    uint16x8_t hi = vcombine_u16(vmovn_u32(result[2]), vmovn_u32(result[3]));
+    vst1q_u8(dst, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+}
+
+class BoxScaler {
+public:
+    BoxScaler(int kernelSize)
+        : fScale(vdupq_n_u32((1 << 24) / kernelSize))
+        , fHalf(vdupq_n_u32(1 << 23)) {
+    }
+
+    // *dst = (sum * scale + half) >> 24
+    void store(uint8_t* dst, const Sum16& sum) const {
+        uint32x4_t result[4];
+        for (int i = 0; i < 4; ++i) {
+            result[i] = vshrq_n_u32(vmlaq_u32(fHalf, sum.f[i], fScale), 24);
+        }
+        store16(dst, result);
+    }
+
+private:
+    const uint32x4_t fScale;
+    const uint32x4_t fHalf;
+};
+
+class InterpScaler {
+public:
+    InterpScaler(int radius, uint8_t outerWeight)
+        : fHalf(vdupq_n_u32(1 << 23)) {
+        uint32_t outerScale, innerScale;
+        SkBoxBlurInterpScales(radius, outerWeight, &outerScale, &innerScale);
+        fOuterScale = vdupq_n_u32(outerScale);
+        fInnerScale = vdupq_n_u32(innerScale);
+    }
+
+    // *dst = (outer * outerScale + inner * innerScale + half) >> 24
+    void store(uint8_t* dst, const Sum16& outer, const Sum16& inner) const {
+        uint32x4_t result[4];
+        for (int i = 0; i < 4; ++i) {
+            uint32x4_t acc = vmlaq_u32(fHalf, outer.f[i], fOuterScale);
+            result[i] = vshrq_n_u32(vmlaq_u32(acc, inner.f[i], fInnerScale), 24);
+        }
+        store16(dst, result);
+    }
+
+private:
+    uint32x4_t fOuterScale;
+    uint32x4_t fInnerScale;
+    const uint32x4_t fHalf;
+};
+
+void store_zeros(uint8_t* dst) {
+    vst1q_u8(dst, vdupq_n_u8(0));
+}
+
+}  // namespace
+
+void SkBoxBlurA8_neon(const uint8_t* src, int srcRowBytes,
+                      uint8_t* dst, int dstRowBytes,
+                      int leftRadius, int rightRadius,
+                      int width, int height) {
+    const int diameter = leftRadius + rightRadius;
+    const int border = SkMin32(height, diameter);
+    const BoxScaler scaler(diameter + 1);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t* right = src + x;
+        const uint8_t* left = right;
+        uint8_t* dptr = dst + x;
+        Sum16 sum, pixels;
+        sum.setZero();
+
+        for (int i = 0; i < rightRadius - leftRadius; ++i) {
+            store_zeros(dptr);
+            dptr += dstRowBytes;
+        }
+        for (int y = 0; y < border; ++y) {
+            pixels.load(right);
+            sum.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+        }
+        for (int y = height; y < diameter; ++y) {
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+        }
+        for (int y = diameter; y < height; ++y) {
+            pixels.load(right);
+            sum.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+            pixels.load(left);
+            sum.sub(pixels);
+            left += srcRowBytes;
+        }
+        for (int y = 0; y < border; ++y) {
+            scaler.store(dptr, sum);
+            dptr += dstRowBytes;
+            pixels.load(left);
+            sum.sub(pixels);
+            left += srcRowBytes;
+        }
+        for (int i = 0; i < leftRadius - rightRadius; ++i) {
+            store_zeros(dptr);
+            dptr += dstRowBytes;
+        }
+    }
+    for (; x < width; ++x) {
+        SkBoxBlurA8Column(src + x, srcRowBytes, dst + x, dstRowBytes,
+                          leftRadius, rightRadius, height);
+    }
+}
+
+void SkBoxBlurInterpA8_neon(const uint8_t* src, int srcRowBytes,
+                            uint8_t* dst, int dstRowBytes,
+                            int radius, uint8_t outerWeight,
+                            int width, int height) {
+    const int diameter = radius * 2;
+    const int border = SkMin32(height, diameter);
+    const InterpScaler scaler(radius, outerWeight);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t* right = src + x;
+        const uint8_t* left = right;
+        uint8_t* dptr = dst + x;
+        Sum16 outer, inner, pixels;
+        outer.setZero();
+        inner.setZero();
+
+        for (int y = 0; y < border; ++y) {
+            inner = outer;
+            pixels.load(right);
+            outer.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+        }
+        for (int y = height; y < diameter; ++y) {
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+        }
+        for (int y = diameter; y < height; ++y) {
+            Sum16 leftPixels;
+            leftPixels.load(left);
+            left += srcRowBytes;
+            inner = outer;
+            inner.sub(leftPixels);
+            pixels.load(right);
+            outer.add(pixels);
+            right += srcRowBytes;
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+            outer.sub(leftPixels);
+        }
+        for (int y = 0; y < border; ++y) {
+            pixels.load(left);
+            left += srcRowBytes;
+            inner = outer;
+            inner.sub(pixels);
+            scaler.store(dptr, outer, inner);
+            dptr += dstRowBytes;
+            outer = inner;
+        }
+    }
+    for (; x < width; ++x) {
+        SkBoxBlurInterpA8Column(src + x, srcRowBytes, dst + x, dstRowBytes,
+                                radius, outerWeight, height);
+    }
+}
+
+void SkTransposeA8_neon(const uint8_t* src, int srcRowBytes,
+                        uint8_t* dst, int dstRowBytes,
+                        int width, int height) {
+    int y = 0;
+    for (; y + 16 <= height; y += 16) {
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            // Interleaving row i with row i + 8 four times over transposes
+            // a 16x16 block of bytes.
+            uint8x16_t rows[16];
+            for (int i = 0; i < 16; ++i) {
+                rows[i] = vld1q_u8(src + (y + i) * srcRowBytes + x);
+            }
+            for (int pass = 0; pass < 4; ++pass) {
+                uint8x16_t tmp[16];
+                for (int i = 0; i < 8; ++i) {
+                    uint8x16x2_t zipped = vzipq_u8(rows[i], rows[i + 8]);
+                    tmp[2 * i]     = zipped.val[0];
+                    tmp[2 * i + 1] = zipped.val[1];
+                }
+                for (int i = 0; i < 16; ++i) {
+                    rows[i] = tmp[i];
+                }
+            }
+            for (int i = 0; i < 16; ++i) {
+                vst1q_u8(dst + (x + i) * dstRowBytes + y, rows[i]);
+            }
+        }
+        SkTransposeA8Block(src + y * srcRowBytes + x, srcRowBytes,
+                           dst + x * dstRowBytes + y, dstRowBytes,
+                           width - x, 16);
+    }
+    SkTransposeA8Block(src + y * srcRowBytes, srcRowBytes, dst + y, dstRowBytes,
+                       width, height - y);
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBlurMask_opts_neon_DEFINED
+#define SkBlurMask_opts_neon_DEFINED
+
+#include "SkBlurMask_opts.h"
+
+void SkBoxBlurA8_neon(const uint8_t* src, int srcRowBytes,
+                      uint8_t* dst, int dstRowBytes,
+                      int leftRadius, int rightRadius,
+                      int width, int height);
+void SkBoxBlurInterpA8_neon(const uint8_t* src, int srcRowBytes,
+                            uint8_t* dst, int dstRowBytes,
+                            int radius, uint8_t outerWeight,
+                            int width, int height);
+void SkTransposeA8_neon(const uint8_t* src, int srcRowBytes,
+                        uint8_t* dst, int dstRowBytes,
+                        int width, int height);
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkColorMatrixFilter_opts_DEFINED
+#define SkColorMatrixFilter_opts_DEFINED
+
+#include "SkColorPriv.h"
+#include "SkUnPreMultiply.h"
+
+/**
+ *  Applies SkColorMatrixFilter's fixed point matrix to a span, as its
+ *  General proc does: each unpremultiplied pixel is multiplied by the 4x5
+ *  array (whose translations are already prerounded), shifted down by shift,
+ *  pinned to [0, 255] and premultiplied again. Since the cheaper procs are
+ *  all special cases of the general one, this serves any non-identity
+ *  matrix. src and dst may be the same.
+ */
+typedef void (*SkColorMatrixSpanProc)(const int32_t array[20], int shift,
+                                      const SkPMColor src[], int count, SkPMColor dst[]);
+
+// Returns NULL if there is no faster proc than the filter's own loop.
+SkColorMatrixSpanProc SkColorMatrixGetPlatformSpanProc();
+
+/**
+ *  Returns c unpremultiplied, with its components in R, G, B, A byte order
+ *  from the least significant byte up, whatever the SkPMColor order.
+ */
+static inline uint32_t SkColorMatrixUnpremulRGBA(SkPMColor c,
+                                                 const SkUnPreMultiply::Scale* table) {
+    unsigned r = SkGetPackedR32(c);
+    unsigned g = SkGetPackedG32(c);
+    unsigned b = SkGetPackedB32(c);
+    unsigned a = SkGetPackedA32(c);
+    if (255 != a) {
+        SkUnPreMultiply::Scale scale = table[a];
+        r = SkUnPreMultiply::ApplyScale(scale, r);
+        g = SkUnPreMultiply::ApplyScale(scale, g);
+        b = SkUnPreMultiply::ApplyScale(scale, b);
+    }
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+// Premultiplies pinned components in the order SkColorMatrixUnpremulRGBA returns them.
+static inline SkPMColor SkColorMatrixPremulRGBA(uint32_t rgba) {
+    return SkPremultiplyARGBInline(rgba >> 24, rgba & 0xFF, (rgba >> 8) & 0xFF,
+                                   (rgba >> 16) & 0xFF);
+}
+
+#endif
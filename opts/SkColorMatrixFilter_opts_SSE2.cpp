@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorMatrixFilter_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+namespace {
+
+/**
+ *  SSE2 can only multiply 16 bit values (pmaddwd), so each matrix coefficient
+ *  is split into a signed high part and a 15 bit low part, high * 2^15 + low.
+ *  Recombining the two products wraps in 32 bits just as the scalar int32
+ *  arithmetic does, so the results are the same.
+ */
+struct Coefficients {
+    Coefficients(const int32_t array[20]) {
+        int16_t hi[16], lo[16];
+        for (int row = 0; row < 4; ++row) {
+            for (int col = 0; col < 4; ++col) {
+                const int32_t value = array[5 * row + col];
+                hi[4 * row + col] = static_cast<int16_t>(value >> 15);
+                lo[4 * row + col] = static_cast<int16_t>(value & 0x7FFF);
+            }
+        }
+        // Rows R and G, then rows B and A.
+        fHi[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi));
+        fHi[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hi + 8));
+        fLo[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo));
+        fLo[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lo + 8));
+        fTrans = _mm_setr_epi32(array[4], array[9], array[14], array[19]);
+    }
+
+    __m128i fHi[2];
+    __m128i fLo[2];
+    __m128i fTrans;
+};
+
+// For two rows of the matrix, the partial sums (r, g) and (b, a) of each.
+inline __m128i row_pair_sums(__m128i rgba, __m128i hi, __m128i lo) {
+    return _mm_add_epi32(_mm_slli_epi32(_mm_madd_epi16(rgba, hi), 15),
+                         _mm_madd_epi16(rgba, lo));
+}
+
+}  // namespace
+
+void SkColorMatrixSpan_SSE2(const int32_t array[20], int shift,
+                            const SkPMColor src[], int count, SkPMColor dst[]) {
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    const Coefficients coeffs(array);
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+    const __m128i zero = _mm_setzero_si128();
+
+    // Whole pages tend to be long runs of one color, so reuse the last result.
+    SkPMColor prevSrc = 0;
+    SkPMColor prevDst = 0;
+    bool havePrev = false;
+    for (int i = 0; i < count; ++i) {
+        const SkPMColor c = src[i];
+        if (havePrev && c == prevSrc) {
+            dst[i] = prevDst;
+            continue;
+        }
+
+        // r, g, b, a in 16 bits, twice.
+        __m128i rgba = _mm_cvtsi32_si128(SkColorMatrixUnpremulRGBA(c, table));
+        rgba = _mm_unpacklo_epi8(rgba, zero);
+        rgba = _mm_unpacklo_epi64(rgba, rgba);
+
+        const __m128i rg = row_pair_sums(rgba, coeffs.fHi[0], coeffs.fLo[0]);
+        const __m128i ba = row_pair_sums(rgba, coeffs.fHi[1], coeffs.fLo[1]);
+        // Gather the partial sums of each row into matching lanes and add them up.
+        const __m128i firstHalves = _mm_castps_si128(_mm_shuffle_ps(
+            _mm_castsi128_ps(rg), _mm_castsi128_ps(ba), _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i secondHalves = _mm_castps_si128(_mm_shuffle_ps(
+            _mm_castsi128_ps(rg), _mm_castsi128_ps(ba), _MM_SHUFFLE(3, 1, 3, 1)));
+        __m128i result = _mm_add_epi32(_mm_add_epi32(firstHalves, secondHalves), coeffs.fTrans);
+        result = _mm_sra_epi32(result, shiftCount);
+
+        // The saturating packs pin each component to [0, 255].
+        result = _mm_packs_epi32(result, result);
+        result = _mm_packus_epi16(result, result);
+
+        prevSrc = c;
+        prevDst = SkColorMatrixPremulRGBA(_mm_cvtsi128_si32(result));
+        havePrev = true;
+        dst[i] = prevDst;
+    }
+}
@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkColorMatrixFilter_opts_SSE2_DEFINED
+#define SkColorMatrixFilter_opts_SSE2_DEFINED
+
+#include "SkColorMatrixFilter_opts.h"
+
+void SkColorMatrixSpan_SSE2(const int32_t array[20], int shift,
+                            const SkPMColor src[], int count, SkPMColor dst[]);
+
+#endif
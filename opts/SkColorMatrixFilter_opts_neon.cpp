@@ -0,0 +1,55 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorMatrixFilter_opts_neon.h"
+
+#include <arm_neon.h>
+
+void SkColorMatrixSpan_neon(const int32_t array[20], int shift,
+                            const SkPMColor src[], int count, SkPMColor dst[]) {
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    // The matrix by columns, so each input component scales one vector.
+    int32x4_t columns[4];
+    for (int col = 0; col < 4; ++col) {
+        const int32_t column[4] = { array[col], array[5 + col], array[10 + col], array[15 + col] };
+        columns[col] = vld1q_s32(column);
+    }
+    const int32_t trans[4] = { array[4], array[9], array[14], array[19] };
+    const int32x4_t translate = vld1q_s32(trans);
+    const int32x4_t shiftCount = vdupq_n_s32(-shift);
+
+    // Whole pages tend to be long runs of one color, so reuse the last result.
+    SkPMColor prevSrc = 0;
+    SkPMColor prevDst = 0;
+    bool havePrev = false;
+    for (int i = 0; i < count; ++i) {
+        const SkPMColor c = src[i];
+        if (havePrev && c == prevSrc) {
+            dst[i] = prevDst;
+            continue;
+        }
+
+        const uint32_t unpremul = SkColorMatrixUnpremulRGBA(c, table);
+        const uint8x8_t bytes = vreinterpret_u8_u32(vdup_n_u32(unpremul));
+        const int32x4_t rgba = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes))));
+        int32x4_t result = translate;
+        result = vmlaq_lane_s32(result, columns[0], vget_low_s32(rgba), 0);
+        result = vmlaq_lane_s32(result, columns[1], vget_low_s32(rgba), 1);
+        result = vmlaq_lane_s32(result, columns[2], vget_high_s32(rgba), 0);
+        result = vmlaq_lane_s32(result, columns[3], vget_high_s32(rgba), 1);
+        result = vshlq_s32(result, shiftCount);
+
+        // The saturating narrows pin each component to [0, 255].
+        const uint8x8_t pinned = vqmovn_u16(vcombine_u16(vqmovun_s32(result),
+                                                         vdup_n_u16(0)));
+
+        prevSrc = c;
+        prevDst = SkColorMatrixPremulRGBA(vget_lane_u32(vreinterpret_u32_u8(pinned), 0));
+        havePrev = true;
+        dst[i] = prevDst;
+    }
+}
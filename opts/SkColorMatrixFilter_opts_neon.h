@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkColorMatrixFilter_opts_neon_DEFINED
+#define SkColorMatrixFilter_opts_neon_DEFINED
+
+#include "SkColorMatrixFilter_opts.h"
+
+void SkColorMatrixSpan_neon(const int32_t array[20], int shift,
+                            const SkPMColor src[], int count, SkPMColor dst[]);
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkColor_opts_AVX2_DEFINED
+#define SkColor_opts_AVX2_DEFINED
+
+#include <immintrin.h>
+
+// These are the 8 pixel wide counterparts of the helpers in SkColor_opts_SSE2.h.
+// Only translation units compiled with -mavx2 may include this header.
+
+static inline __m256i SkAlpha255To256_AVX2(const __m256i& alpha) {
+    return _mm256_add_epi32(alpha, _mm256_set1_epi32(1));
+}
+
+// See #define SkAlphaMulAlpha(a, b)  SkMulDiv255Round(a, b) in SkXfermode.cpp.
+static inline __m256i SkAlphaMulAlpha_AVX2(const __m256i& a,
+                                           const __m256i& b) {
+    __m256i prod = _mm256_mullo_epi16(a, b);
+    prod = _mm256_add_epi32(prod, _mm256_set1_epi32(128));
+    prod = _mm256_add_epi32(prod, _mm256_srli_epi32(prod, 8));
+    prod = _mm256_srli_epi32(prod, 8);
+
+    return prod;
+}
+
+// Portable version SkAlphaMulQ is in SkColorPriv.h.
+// scale holds one 0..256 value in each 32-bit lane.
+static inline __m256i SkAlphaMulQ_AVX2(const __m256i& c, const __m256i& scale) {
+    __m256i mask = _mm256_set1_epi32(gMask_00FF00FF);
+    __m256i s = _mm256_or_si256(_mm256_slli_epi32(scale, 16), scale);
+
+    // uint32_t rb = ((c & mask) * scale) >> 8
+    __m256i rb = _mm256_and_si256(mask, c);
+    rb = _mm256_mullo_epi16(rb, s);
+    rb = _mm256_srli_epi16(rb, 8);
+
+    // uint32_t ag = ((c >> 8) & mask) * scale
+    __m256i ag = _mm256_srli_epi16(c, 8);
+    ag = _mm256_and_si256(ag, mask);
+    ag = _mm256_mullo_epi16(ag, s);
+
+    // (rb & mask) | (ag & ~mask)
+    rb = _mm256_and_si256(mask, rb);
+    ag = _mm256_andnot_si256(mask, ag);
+    return _mm256_or_si256(rb, ag);
+}
+
+static inline __m256i SkGetPackedA32_AVX2(const __m256i& src) {
+    __m256i a = _mm256_slli_epi32(src, (24 - SK_A32_SHIFT));
+    return _mm256_srli_epi32(a, 24);
+}
+
+static inline __m256i SkGetPackedR32_AVX2(const __m256i& src) {
+    __m256i r = _mm256_slli_epi32(src, (24 - SK_R32_SHIFT));
+    return _mm256_srli_epi32(r, 24);
+}
+
+static inline __m256i SkGetPackedG32_AVX2(const __m256i& src) {
+    __m256i g = _mm256_slli_epi32(src, (24 - SK_G32_SHIFT));
+    return _mm256_srli_epi32(g, 24);
+}
+
+static inline __m256i SkGetPackedB32_AVX2(const __m256i& src) {
+    __m256i b = _mm256_slli_epi32(src, (24 - SK_B32_SHIFT));
+    return _mm256_srli_epi32(b, 24);
+}
+
+static inline __m256i SkPackARGB32_AVX2(const __m256i& a, const __m256i& r,
+                                        const __m256i& g, const __m256i& b) {
+    __m256i da = _mm256_slli_epi32(a, SK_A32_SHIFT);
+    __m256i dr = _mm256_slli_epi32(r, SK_R32_SHIFT);
+    __m256i dg = _mm256_slli_epi32(g, SK_G32_SHIFT);
+    __m256i db = _mm256_slli_epi32(b, SK_B32_SHIFT);
+
+    __m256i c = _mm256_or_si256(da, dr);
+    c = _mm256_or_si256(c, dg);
+    return _mm256_or_si256(c, db);
+}
+
+// Returns src + dst * (256 - srcA) >> 8, the same math as SkPMSrcOver.
+static inline __m256i SkPMSrcOver_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i isa = _mm256_sub_epi32(_mm256_set1_epi32(256), SkGetPackedA32_AVX2(src));
+    return _mm256_add_epi32(src, SkAlphaMulQ_AVX2(dst, isa));
+}
+
+#endif // SkColor_opts_AVX2_DEFINED
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkConfig8888_opts_DEFINED
+#define SkConfig8888_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Converts count 32 bit RGBA or BGRA pixels. Must work when dst == src (but
+ *  not with partial overlap).
+ */
+typedef void (*SkConvert32RowProc)(uint32_t* dst, const uint32_t* src, int count);
+
+/**
+ *  Row procs for SkSrcPixelInfo::convertPixelsTo(). Each gives exactly the
+ *  result of the scalar convert32_row in SkConfig8888.cpp it replaces. Any of
+ *  them may be NULL. Unpremultiplying still looks up each pixel's reciprocal
+ *  in SkUnPreMultiply's table, but scales its components together.
+ */
+struct SkConfig8888Procs {
+    SkConvert32RowProc fSwapRB;         // RGBA <-> BGRA
+    SkConvert32RowProc fPremul;         // unpremul -> premul, same order
+    SkConvert32RowProc fPremulSwapRB;   // unpremul -> premul, RGBA <-> BGRA
+    SkConvert32RowProc fUnpremul;       // premul -> unpremul, same order
+    SkConvert32RowProc fUnpremulSwapRB; // premul -> unpremul, RGBA <-> BGRA
+};
+
+bool SkConfig8888GetPlatformProcs(SkConfig8888Procs* procs);
+
+#endif
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkConfig8888_opts_SSSE3.h"
+
+/* As in SkBitmapProcState_opts_SSSE3.cpp, the Android framework may build this
+ * file without -mssse3, in which case only stubs are provided and
+ * SkConfig8888GetPlatformProcs() never hands them out.
+ */
+#if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+#include "SkColorPriv.h"
+#include "SkUnPreMultiply.h"
+
+#include <tmmintrin.h>  // SSSE3
+
+namespace {
+
+// Byte offsets of each component within a (little endian) pixel. RGBA and
+// BGRA keep alpha and green in the same place and trade R for B.
+enum {
+    kA = SK_A32_SHIFT / 8,
+    kR = SK_R32_SHIFT / 8,
+    kG = SK_G32_SHIFT / 8,
+    kB = SK_B32_SHIFT / 8,
+};
+
+/**
+ *  Returns the pshufb mask that reorders the four pixels of a register. If
+ *  spreadAlpha is set, every color byte instead gets its pixel's alpha and the
+ *  alpha bytes are zeroed, to be or-ed to 0xFF later.
+ */
+__m128i shuffle_mask(bool swapRB, bool spreadAlpha) {
+    char mask[16];
+    for (int i = 0; i < 4; ++i) {
+        char* pixel = mask + 4 * i;
+        const int s = 4 * i;
+        if (spreadAlpha) {
+            pixel[kR] = pixel[kG] = pixel[kB] = s + kA;
+            pixel[kA] = -1;
+        } else {
+            pixel[kR] = s + (swapRB ? kB : kR);
+            pixel[kG] = s + kG;
+            pixel[kB] = s + (swapRB ? kR : kB);
+            pixel[kA] = s + kA;
+        }
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+// As SkMulDiv255Round(), on eight 16 bit lanes.
+inline __m128i mul_div_255_round(__m128i c, __m128i a) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+inline uint32_t swap_rb(uint32_t c) {
+    const uint32_t rbMask = (0xFFU << SK_R32_SHIFT) | (0xFFU << SK_B32_SHIFT);
+    const uint32_t r = (c >> SK_R32_SHIFT) & 0xFF;
+    const uint32_t b = (c >> SK_B32_SHIFT) & 0xFF;
+    return (c & ~rbMask) | (r << SK_B32_SHIFT) | (b << SK_R32_SHIFT);
+}
+
+inline uint32_t premul(uint32_t c) {
+    return SkPreMultiplyARGB(SkGetPackedA32(c), SkGetPackedR32(c),
+                             SkGetPackedG32(c), SkGetPackedB32(c));
+}
+
+template <bool swapRB>
+void convert32_premul(uint32_t* dst, const uint32_t* src, int count) {
+    const __m128i colorMask = shuffle_mask(swapRB, false);
+    // The alpha lanes are multiplied by 255, which leaves alpha unchanged.
+    const __m128i alphaMask = shuffle_mask(false, true);
+    const __m128i alphaOne = _mm_set1_epi32(static_cast<int>(0xFFU << SK_A32_SHIFT));
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i color = _mm_shuffle_epi8(pixels, colorMask);
+        const __m128i alpha = _mm_or_si128(_mm_shuffle_epi8(pixels, alphaMask), alphaOne);
+        __m128i lo = mul_div_255_round(_mm_unpacklo_epi8(color, zero),
+                                       _mm_unpacklo_epi8(alpha, zero));
+        __m128i hi = mul_div_255_round(_mm_unpackhi_epi8(color, zero),
+                                       _mm_unpackhi_epi8(alpha, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    for (; i < count; ++i) {
+        dst[i] = premul(swapRB ? swap_rb(src[i]) : src[i]);
+    }
+}
+
+/**
+ *  Returns the component at srcShift of each pixel, unpremultiplied by its
+ *  scale and moved to dstShift. As in SkUnPreMultiply::ApplyScale(), the
+ *  product is rounded and keeps bits 24 to 31; _mm_mul_epu32 only multiplies
+ *  the even lanes, so the odd ones are multiplied a second time.
+ */
+inline __m128i unpremul_component(__m128i pixels, __m128i scale, int srcShift, int dstShift) {
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i round = _mm_set_epi32(0, 1 << 23, 0, 1 << 23);
+    const __m128i c = _mm_and_si128(_mm_srli_epi32(pixels, srcShift), byteMask);
+    __m128i even = _mm_add_epi64(_mm_mul_epu32(c, scale), round);
+    __m128i odd = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(c, 32), _mm_srli_epi64(scale, 32)),
+                                round);
+    even = _mm_srli_epi64(even, 24);
+    odd = _mm_slli_epi64(_mm_srli_epi64(odd, 24), 32);
+    const __m128i result = _mm_and_si128(_mm_or_si128(even, odd), byteMask);
+    return _mm_slli_epi32(result, dstShift);
+}
+
+template <bool swapRB>
+void convert32_unpremul(uint32_t* dst, const uint32_t* src, int count) {
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFFU << SK_A32_SHIFT));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // The reciprocals come from the same table as the scalar code.
+        const __m128i scale = _mm_set_epi32(table[SkGetPackedA32(src[i + 3])],
+                                            table[SkGetPackedA32(src[i + 2])],
+                                            table[SkGetPackedA32(src[i + 1])],
+                                            table[SkGetPackedA32(src[i + 0])]);
+        __m128i result = _mm_and_si128(pixels, alphaMask);
+        result = _mm_or_si128(result, unpremul_component(pixels, scale, SK_R32_SHIFT,
+                                                         swapRB ? SK_B32_SHIFT : SK_R32_SHIFT));
+        result = _mm_or_si128(result, unpremul_component(pixels, scale, SK_G32_SHIFT,
+                                                         SK_G32_SHIFT));
+        result = _mm_or_si128(result, unpremul_component(pixels, scale, SK_B32_SHIFT,
+                                                         swapRB ? SK_R32_SHIFT : SK_B32_SHIFT));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+    }
+    for (; i < count; ++i) {
+        const uint32_t c = SkUnPreMultiply::UnPreMultiplyPreservingByteOrder(src[i]);
+        dst[i] = swapRB ? swap_rb(c) : c;
+    }
+}
+
+}  // namespace
+
+void Convert32_SwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    const __m128i mask = shuffle_mask(true, false);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(pixels, mask));
+    }
+    for (; i < count; ++i) {
+        dst[i] = swap_rb(src[i]);
+    }
+}
+
+void Convert32_Premul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_premul<false>(dst, src, count);
+}
+
+void Convert32_PremulSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_premul<true>(dst, src, count);
+}
+
+void Convert32_Unpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_unpremul<false>(dst, src, count);
+}
+
+void Convert32_UnpremulSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_unpremul<true>(dst, src, count);
+}
+
+#else // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+void Convert32_SwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void Convert32_Premul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void Convert32_PremulSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void Convert32_Unpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+void Convert32_UnpremulSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count) {
+    sk_throw();
+}
+
+#endif
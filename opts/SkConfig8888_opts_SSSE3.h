@@ -0,0 +1,19 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkConfig8888_opts_SSSE3_DEFINED
+#define SkConfig8888_opts_SSSE3_DEFINED
+
+#include "SkConfig8888_opts.h"
+
+void Convert32_SwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void Convert32_Premul_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void Convert32_PremulSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void Convert32_Unpremul_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+void Convert32_UnpremulSwapRB_SSSE3(uint32_t* dst, const uint32_t* src, int count);
+
+#endif
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkConfig8888_opts_neon.h"
+#include "SkUtilsArm.h"
+
+bool SkConfig8888GetPlatformProcs(SkConfig8888Procs* procs) {
+#if SK_ARM_NEON_IS_NONE
+    return false;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return false;
+    }
+#endif
+    procs->fSwapRB = Convert32_SwapRB_neon;
+    procs->fPremul = Convert32_Premul_neon;
+    procs->fPremulSwapRB = Convert32_PremulSwapRB_neon;
+    procs->fUnpremul = Convert32_Unpremul_neon;
+    procs->fUnpremulSwapRB = Convert32_UnpremulSwapRB_neon;
+    return true;
+#endif
+}
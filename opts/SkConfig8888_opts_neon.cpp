@@ -0,0 +1,120 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkConfig8888_opts_neon.h"
+
+#include "SkColorPriv.h"
+#include "SkColor_opts_neon.h"
+#include "SkUnPreMultiply.h"
+
+namespace {
+
+// As SkMulDiv255Round(), on eight bytes.
+inline uint8x8_t mul_div_255_round(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t prod = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(prod, vshrq_n_u16(prod, 8)), 8);
+}
+
+inline uint32_t swap_rb(uint32_t c) {
+    const uint32_t rbMask = (0xFFU << SK_R32_SHIFT) | (0xFFU << SK_B32_SHIFT);
+    const uint32_t r = (c >> SK_R32_SHIFT) & 0xFF;
+    const uint32_t b = (c >> SK_B32_SHIFT) & 0xFF;
+    return (c & ~rbMask) | (r << SK_B32_SHIFT) | (b << SK_R32_SHIFT);
+}
+
+inline uint32_t premul(uint32_t c) {
+    return SkPreMultiplyARGB(SkGetPackedA32(c), SkGetPackedR32(c),
+                             SkGetPackedG32(c), SkGetPackedB32(c));
+}
+
+// vld4 splits the pixels into one register per byte, so RGBA and BGRA only
+// differ in which of the NEON_R and NEON_B registers holds red.
+template <bool swapRB, bool doPremul>
+void convert32_row(uint32_t* dst, const uint32_t* src, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t pixels = vld4_u8((const uint8_t*)(src + i));
+        if (swapRB) {
+            uint8x8_t tmp = pixels.val[NEON_R];
+            pixels.val[NEON_R] = pixels.val[NEON_B];
+            pixels.val[NEON_B] = tmp;
+        }
+        if (doPremul) {
+            const uint8x8_t alpha = pixels.val[NEON_A];
+            pixels.val[NEON_R] = mul_div_255_round(pixels.val[NEON_R], alpha);
+            pixels.val[NEON_G] = mul_div_255_round(pixels.val[NEON_G], alpha);
+            pixels.val[NEON_B] = mul_div_255_round(pixels.val[NEON_B], alpha);
+        }
+        vst4_u8((uint8_t*)(dst + i), pixels);
+    }
+    for (; i < count; ++i) {
+        uint32_t c = swapRB ? swap_rb(src[i]) : src[i];
+        dst[i] = doPremul ? premul(c) : c;
+    }
+}
+
+// As SkUnPreMultiply::ApplyScale(), on eight bytes with their pixels' scales.
+inline uint8x8_t apply_scale(uint8x8_t c, uint32x4_t scaleLo, uint32x4_t scaleHi) {
+    const uint32x4_t round = vdupq_n_u32(1 << 23);
+    const uint16x8_t c16 = vmovl_u8(c);
+    uint32x4_t lo = vmlaq_u32(round, vmovl_u16(vget_low_u16(c16)), scaleLo);
+    uint32x4_t hi = vmlaq_u32(round, vmovl_u16(vget_high_u16(c16)), scaleHi);
+    // Keep bits 24 to 31 of each product.
+    return vshrn_n_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)), 8);
+}
+
+template <bool swapRB>
+void convert32_unpremul(uint32_t* dst, const uint32_t* src, int count) {
+    const SkUnPreMultiply::Scale* table = SkUnPreMultiply::GetScaleTable();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // The reciprocals come from the same table as the scalar code.
+        uint32_t scales[8];
+        for (int j = 0; j < 8; ++j) {
+            scales[j] = table[SkGetPackedA32(src[i + j])];
+        }
+        const uint32x4_t scaleLo = vld1q_u32(scales);
+        const uint32x4_t scaleHi = vld1q_u32(scales + 4);
+
+        uint8x8x4_t pixels = vld4_u8((const uint8_t*)(src + i));
+        if (swapRB) {
+            uint8x8_t tmp = pixels.val[NEON_R];
+            pixels.val[NEON_R] = pixels.val[NEON_B];
+            pixels.val[NEON_B] = tmp;
+        }
+        pixels.val[NEON_R] = apply_scale(pixels.val[NEON_R], scaleLo, scaleHi);
+        pixels.val[NEON_G] = apply_scale(pixels.val[NEON_G], scaleLo, scaleHi);
+        pixels.val[NEON_B] = apply_scale(pixels.val[NEON_B], scaleLo, scaleHi);
+        vst4_u8((uint8_t*)(dst + i), pixels);
+    }
+    for (; i < count; ++i) {
+        const uint32_t c = SkUnPreMultiply::UnPreMultiplyPreservingByteOrder(src[i]);
+        dst[i] = swapRB ? swap_rb(c) : c;
+    }
+}
+
+}  // namespace
+
+void Convert32_SwapRB_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, false>(dst, src, count);
+}
+
+void Convert32_Premul_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<false, true>(dst, src, count);
+}
+
+void Convert32_PremulSwapRB_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_row<true, true>(dst, src, count);
+}
+
+void Convert32_Unpremul_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_unpremul<false>(dst, src, count);
+}
+
+void Convert32_UnpremulSwapRB_neon(uint32_t* dst, const uint32_t* src, int count) {
+    convert32_unpremul<true>(dst, src, count);
+}
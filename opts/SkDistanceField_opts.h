@@ -0,0 +1,69 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDistanceField_opts_DEFINED
+#define SkDistanceField_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  One row of the vertical steps of the Euclidean distance transform in
+ *  SkDistanceFieldGen.cpp. curr and other are rows of texels of four floats
+ *  each: alpha, squared distance, and the x and y of the vector to the nearest
+ *  edge found so far. Each of the count texels of curr whose edges byte is 0
+ *  is compared with the three nearest texels of other, the row above when dy
+ *  is -1 or below when it is 1, and takes the closest vector through them that
+ *  beats its own. other is read from one texel before the run to one after.
+ */
+typedef void (*SkDistanceFieldRowProc)(float* curr, const float* other, const uint8_t* edges,
+                                       int count, float dy);
+
+// Returns NULL if there is no faster proc than SkDistanceFieldRow.
+SkDistanceFieldRowProc SkDistanceFieldGetPlatformRowProc();
+
+// The scalar row, for the texels the SIMD code has left over.
+static inline void SkDistanceFieldRow(float* curr, const float* other, const uint8_t* edges,
+                                      int count, float dy) {
+    for (int i = 0; i < count; ++i, curr += 4, other += 4) {
+        if (edges[i]) {
+            continue;
+        }
+        float distSq = curr[1];
+        float vx = curr[2];
+        float vy = curr[3];
+
+        const float* check = other - 4;
+        float checkSq = check[1] - 2.0f*(check[2] - dy*check[3] - 1.0f);
+        if (checkSq < distSq) {
+            distSq = checkSq;
+            vx = check[2] - 1.0f;
+            vy = check[3] + dy;
+        }
+
+        check = other;
+        checkSq = check[1] + 2.0f*dy*check[3] + 1.0f;
+        if (checkSq < distSq) {
+            distSq = checkSq;
+            vx = check[2];
+            vy = check[3] + dy;
+        }
+
+        check = other + 4;
+        checkSq = check[1] + 2.0f*(check[2] + dy*check[3] + 1.0f);
+        if (checkSq < distSq) {
+            distSq = checkSq;
+            vx = check[2] + 1.0f;
+            vy = check[3] + dy;
+        }
+
+        curr[1] = distSq;
+        curr[2] = vx;
+        curr[3] = vy;
+    }
+}
+
+#endif
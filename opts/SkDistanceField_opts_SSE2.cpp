@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDistanceField_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+namespace {
+
+// Four texels, one component per register.
+struct Texels {
+    __m128 fAlpha, fDistSq, fX, fY;
+};
+
+inline Texels load_texels(const float* texels) {
+    Texels t;
+    t.fAlpha = _mm_loadu_ps(texels);
+    t.fDistSq = _mm_loadu_ps(texels + 4);
+    t.fX = _mm_loadu_ps(texels + 8);
+    t.fY = _mm_loadu_ps(texels + 12);
+    _MM_TRANSPOSE4_PS(t.fAlpha, t.fDistSq, t.fX, t.fY);
+    return t;
+}
+
+inline void store_texels(Texels t, float* texels) {
+    _MM_TRANSPOSE4_PS(t.fAlpha, t.fDistSq, t.fX, t.fY);
+    _mm_storeu_ps(texels, t.fAlpha);
+    _mm_storeu_ps(texels + 4, t.fDistSq);
+    _mm_storeu_ps(texels + 8, t.fX);
+    _mm_storeu_ps(texels + 12, t.fY);
+}
+
+inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Takes checkSq, and the vector through check offset by dx and dy, where it's closer.
+inline void take_closer(Texels* curr, __m128 update, __m128 checkSq, const Texels& check,
+                        __m128 dx, __m128 dy) {
+    const __m128 closer = _mm_and_ps(update, _mm_cmplt_ps(checkSq, curr->fDistSq));
+    curr->fDistSq = select(closer, checkSq, curr->fDistSq);
+    curr->fX = select(closer, _mm_add_ps(check.fX, dx), curr->fX);
+    curr->fY = select(closer, _mm_add_ps(check.fY, dy), curr->fY);
+}
+
+}  // namespace
+
+// The arithmetic matches SkDistanceFieldRow() operation for operation, so the results do too.
+void SkDistanceFieldRow_SSE2(float* curr, const float* other, const uint8_t* edges,
+                             int count, float dy) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 dyv = _mm_set1_ps(dy);
+    const __m128 twoDy = _mm_set1_ps(2.0f*dy);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4, curr += 16, other += 16) {
+        int edgeBytes;
+        memcpy(&edgeBytes, edges + i, sizeof(edgeBytes));
+        if (-1 == edgeBytes) {
+            continue;   // All four are edges (255), which are never updated.
+        }
+        const __m128i edge = _mm_unpacklo_epi16(
+                _mm_unpacklo_epi8(_mm_cvtsi32_si128(edgeBytes), _mm_setzero_si128()),
+                _mm_setzero_si128());
+        const __m128 update = _mm_castsi128_ps(_mm_cmpeq_epi32(edge, _mm_setzero_si128()));
+
+        Texels t = load_texels(curr);
+
+        Texels check = load_texels(other - 4);
+        __m128 offset = _mm_sub_ps(_mm_sub_ps(check.fX, _mm_mul_ps(dyv, check.fY)), one);
+        __m128 checkSq = _mm_sub_ps(check.fDistSq, _mm_mul_ps(two, offset));
+        take_closer(&t, update, checkSq, check, minusOne, dyv);
+
+        check = load_texels(other);
+        checkSq = _mm_add_ps(_mm_add_ps(check.fDistSq, _mm_mul_ps(twoDy, check.fY)), one);
+        take_closer(&t, update, checkSq, check, zero, dyv);
+
+        check = load_texels(other + 4);
+        offset = _mm_add_ps(_mm_add_ps(check.fX, _mm_mul_ps(dyv, check.fY)), one);
+        checkSq = _mm_add_ps(check.fDistSq, _mm_mul_ps(two, offset));
+        take_closer(&t, update, checkSq, check, one, dyv);
+
+        store_texels(t, curr);
+    }
+    SkDistanceFieldRow(curr, other, edges + i, count - i, dy);
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDistanceField_opts_neon.h"
+
+#include <arm_neon.h>
+
+namespace {
+
+// The lanes vld4q_f32() deinterleaves four texels into.
+enum {
+    kAlpha,
+    kDistSq,
+    kX,
+    kY
+};
+
+// Takes checkSq, and the vector through check offset by dx and dy, where it's closer.
+inline void take_closer(float32x4x4_t* curr, uint32x4_t update, float32x4_t checkSq,
+                        const float32x4x4_t& check, float32x4_t dx, float32x4_t dy) {
+    const uint32x4_t closer = vandq_u32(update, vcltq_f32(checkSq, curr->val[kDistSq]));
+    curr->val[kDistSq] = vbslq_f32(closer, checkSq, curr->val[kDistSq]);
+    curr->val[kX] = vbslq_f32(closer, vaddq_f32(check.val[kX], dx), curr->val[kX]);
+    curr->val[kY] = vbslq_f32(closer, vaddq_f32(check.val[kY], dy), curr->val[kY]);
+}
+
+}  // namespace
+
+void SkDistanceFieldRow_neon(float* curr, const float* other, const uint8_t* edges,
+                             int count, float dy) {
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t two = vdupq_n_f32(2.0f);
+    const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t dyv = vdupq_n_f32(dy);
+    const float32x4_t twoDy = vdupq_n_f32(2.0f*dy);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4, curr += 16, other += 16) {
+        const uint32_t edgeLanes[4] = { edges[i], edges[i + 1], edges[i + 2], edges[i + 3] };
+        const uint32x4_t update = vceqq_u32(vld1q_u32(edgeLanes), vdupq_n_u32(0));
+
+        float32x4x4_t t = vld4q_f32(curr);
+
+        float32x4x4_t check = vld4q_f32(other - 4);
+        float32x4_t offset = vsubq_f32(vsubq_f32(check.val[kX], vmulq_f32(dyv, check.val[kY])),
+                                       one);
+        float32x4_t checkSq = vsubq_f32(check.val[kDistSq], vmulq_f32(two, offset));
+        take_closer(&t, update, checkSq, check, minusOne, dyv);
+
+        check = vld4q_f32(other);
+        checkSq = vaddq_f32(vaddq_f32(check.val[kDistSq], vmulq_f32(twoDy, check.val[kY])), one);
+        take_closer(&t, update, checkSq, check, zero, dyv);
+
+        check = vld4q_f32(other + 4);
+        offset = vaddq_f32(vaddq_f32(check.val[kX], vmulq_f32(dyv, check.val[kY])), one);
+        checkSq = vaddq_f32(check.val[kDistSq], vmulq_f32(two, offset));
+        take_closer(&t, update, checkSq, check, one, dyv);
+
+        vst4q_f32(curr, t);
+    }
+    SkDistanceFieldRow(curr, other, edges + i, count - i, dy);
+}
@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDistanceField_opts_neon_DEFINED
+#define SkDistanceField_opts_neon_DEFINED
+
+#include "SkDistanceField_opts.h"
+
+void SkDistanceFieldRow_neon(float* curr, const float* other, const uint8_t* edges,
+                            int count, float dy);
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGradientShader_opts_DEFINED
+#define SkGradientShader_opts_DEFINED
+
+#include "SkColorPriv.h"
+#include "SkFixed.h"
+#include "SkMath.h"
+
+/**
+ *  Span procs that look up a run of pixels in a gradient's 32-bit cache, as
+ *  the scalar loops in SkLinearGradient.cpp and SkRadialGradient.cpp do, but
+ *  computing several indices at once. 'toggle' is the dither row offset of
+ *  the first pixel; each following pixel flips between it and the row
+ *  kGradientSpanDitherStride away.
+ */
+enum {
+    kGradientSpanCacheShift     = 8,    // SkGradientShaderBase::kCache32Shift
+    kGradientSpanDitherStride   = 256,  // SkGradientShaderBase::kDitherStride32
+    kGradientSpanSqrtTableBits  = 11,   // kSQRT_TABLE_BITS in SkRadialGradient.cpp
+};
+
+typedef void (*SkLinearGradientSpanProc)(SkFixed fx, SkFixed dx,
+                                         SkPMColor* SK_RESTRICT dst,
+                                         const SkPMColor* SK_RESTRICT cache,
+                                         int toggle, int count);
+
+typedef void (*SkRadialGradientSpanProc)(SkFixed fx, SkFixed dx, SkFixed fy, SkFixed dy,
+                                         SkPMColor* SK_RESTRICT dst,
+                                         const SkPMColor* SK_RESTRICT cache,
+                                         const uint8_t* SK_RESTRICT sqrtTable,
+                                         int toggle, int count);
+
+struct SkGradientSpanProcs {
+    SkLinearGradientSpanProc fLinear;       // every fx >> 8 is known to be in the cache
+    SkLinearGradientSpanProc fLinearRepeat;
+    SkLinearGradientSpanProc fLinearMirror;
+    // fx, fy are at half scale, as in shadeSpan_radial_clamp(), and are pinned
+    // to the unit square before the sqrt table lookup.
+    SkRadialGradientSpanProc fRadialClamp;
+};
+
+bool SkGradientGetPlatformSpanProcs(SkGradientSpanProcs* procs);
+
+// The scalar index computations, for the pixels the SIMD code has left over.
+static inline unsigned SkGradientSpanRepeatIndex(SkFixed fx) {
+    return (fx >> kGradientSpanCacheShift) & 0xFF;
+}
+
+static inline unsigned SkGradientSpanMirrorIndex(SkFixed fx) {
+    int x = fx >> kGradientSpanCacheShift;
+    if (x & 256) {
+        x = ~x;
+    }
+    return x & 0xFF;
+}
+
+static inline unsigned SkGradientSpanRadialIndex(SkFixed fx, SkFixed fy,
+                                                 const uint8_t* SK_RESTRICT sqrtTable) {
+    unsigned xx = SkPin32(fx, -0xFFFF >> 1, 0xFFFF >> 1);
+    unsigned yy = SkPin32(fy, -0xFFFF >> 1, 0xFFFF >> 1);
+    unsigned fi = (xx * xx + yy * yy) >> (14 + 16 - kGradientSpanSqrtTableBits);
+    return sqrtTable[SkFastMin32(fi, 0xFFFF >> (16 - kGradientSpanSqrtTableBits))];
+}
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGradientShader_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+namespace {
+
+// fx for four consecutive pixels.
+inline __m128i start_fx(SkFixed fx, SkFixed dx) {
+    return _mm_add_epi32(_mm_set1_epi32(fx), _mm_setr_epi32(0, dx, 2 * dx, 3 * dx));
+}
+
+// The dither row offsets of four consecutive pixels, the first at 'toggle'.
+inline __m128i toggles(int toggle) {
+    const int other = toggle ^ kGradientSpanDitherStride;
+    return _mm_setr_epi32(toggle, other, toggle, other);
+}
+
+// There is no gather in SSE2, so the indices go through memory.
+inline void gather(SkPMColor* SK_RESTRICT dst, const SkPMColor* SK_RESTRICT cache,
+                   __m128i indices) {
+    int32_t index[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(index), indices);
+    dst[0] = cache[index[0]];
+    dst[1] = cache[index[1]];
+    dst[2] = cache[index[2]];
+    dst[3] = cache[index[3]];
+}
+
+enum TileMode {
+    kNone_TileMode,
+    kRepeat_TileMode,
+    kMirror_TileMode,
+};
+
+template <TileMode tile>
+inline __m128i tile_indices(__m128i fx) {
+    __m128i x = _mm_srai_epi32(fx, kGradientSpanCacheShift);
+    if (kRepeat_TileMode == tile) {
+        x = _mm_and_si128(x, _mm_set1_epi32(0xFF));
+    } else if (kMirror_TileMode == tile) {
+        const __m128i bit = _mm_set1_epi32(256);
+        __m128i flip = _mm_cmpeq_epi32(_mm_and_si128(x, bit), bit);
+        x = _mm_and_si128(_mm_xor_si128(x, flip), _mm_set1_epi32(0xFF));
+    }
+    return x;
+}
+
+template <TileMode tile>
+inline unsigned tile_index(SkFixed fx) {
+    if (kRepeat_TileMode == tile) {
+        return SkGradientSpanRepeatIndex(fx);
+    } else if (kMirror_TileMode == tile) {
+        return SkGradientSpanMirrorIndex(fx);
+    }
+    return fx >> kGradientSpanCacheShift;
+}
+
+template <TileMode tile>
+void linear_span(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                 const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    // Four pixels are an even step, so every group starts on 'toggle'.
+    const __m128i toggle4 = toggles(toggle);
+    const __m128i dx4 = _mm_set1_epi32(4 * dx);
+    __m128i fx4 = start_fx(fx, dx);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        gather(dst + i, cache, _mm_add_epi32(tile_indices<tile>(fx4), toggle4));
+        fx4 = _mm_add_epi32(fx4, dx4);
+    }
+    fx += i * dx;
+    for (; i < count; ++i) {
+        dst[i] = cache[toggle + tile_index<tile>(fx)];
+        toggle ^= kGradientSpanDitherStride;
+        fx += dx;
+    }
+}
+
+}  // namespace
+
+void SkLinearGradientSpan_SSE2(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    linear_span<kNone_TileMode>(fx, dx, dst, cache, toggle, count);
+}
+
+void SkLinearGradientSpanRepeat_SSE2(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    linear_span<kRepeat_TileMode>(fx, dx, dst, cache, toggle, count);
+}
+
+void SkLinearGradientSpanMirror_SSE2(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    linear_span<kMirror_TileMode>(fx, dx, dst, cache, toggle, count);
+}
+
+void SkRadialGradientSpanClamp_SSE2(SkFixed fx, SkFixed dx, SkFixed fy, SkFixed dy,
+                                    SkPMColor* SK_RESTRICT dst,
+                                    const SkPMColor* SK_RESTRICT cache,
+                                    const uint8_t* SK_RESTRICT sqrtTable,
+                                    int toggle, int count) {
+    const __m128i toggle4 = toggles(toggle);
+    const __m128i dx4 = _mm_set1_epi32(4 * dx);
+    const __m128i dy4 = _mm_set1_epi32(4 * dy);
+    const __m128i maxIndex = _mm_set1_epi16(0xFFFF >> (16 - kGradientSpanSqrtTableBits));
+    __m128i fx4 = start_fx(fx, dx);
+    __m128i fy4 = start_fx(fy, dy);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // Saturating to 16 bits pins to exactly SkPin32(v, -0xFFFF >> 1, 0xFFFF >> 1).
+        __m128i xy = _mm_packs_epi32(fx4, fy4);
+        // Interleave to x0 y0 x1 y1 ..., so one multiply-add gives x*x + y*y.
+        xy = _mm_unpacklo_epi16(xy, _mm_srli_si128(xy, 8));
+        // The sum is unsigned, as in the scalar code: at most 0x80000000.
+        __m128i fi = _mm_srli_epi32(_mm_madd_epi16(xy, xy),
+                                    14 + 16 - kGradientSpanSqrtTableBits);
+        // That leaves fi in 16 bits, so a 16-bit min does.
+        fi = _mm_min_epi16(fi, maxIndex);
+
+        int32_t index[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(index), fi);
+        __m128i sqrt4 = _mm_setr_epi32(sqrtTable[index[0]], sqrtTable[index[1]],
+                                       sqrtTable[index[2]], sqrtTable[index[3]]);
+        gather(dst + i, cache, _mm_add_epi32(sqrt4, toggle4));
+
+        fx4 = _mm_add_epi32(fx4, dx4);
+        fy4 = _mm_add_epi32(fy4, dy4);
+    }
+    fx += i * dx;
+    fy += i * dy;
+    for (; i < count; ++i) {
+        dst[i] = cache[toggle + SkGradientSpanRadialIndex(fx, fy, sqrtTable)];
+        toggle ^= kGradientSpanDitherStride;
+        fx += dx;
+        fy += dy;
+    }
+}
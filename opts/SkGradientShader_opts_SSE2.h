@@ -0,0 +1,25 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGradientShader_opts_SSE2_DEFINED
+#define SkGradientShader_opts_SSE2_DEFINED
+
+#include "SkGradientShader_opts.h"
+
+void SkLinearGradientSpan_SSE2(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT cache, int toggle, int count);
+void SkLinearGradientSpanRepeat_SSE2(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count);
+void SkLinearGradientSpanMirror_SSE2(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count);
+void SkRadialGradientSpanClamp_SSE2(SkFixed fx, SkFixed dx, SkFixed fy, SkFixed dy,
+                                    SkPMColor* SK_RESTRICT dst,
+                                    const SkPMColor* SK_RESTRICT cache,
+                                    const uint8_t* SK_RESTRICT sqrtTable,
+                                    int toggle, int count);
+
+#endif
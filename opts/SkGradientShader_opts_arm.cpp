@@ -0,0 +1,26 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGradientShader_opts_neon.h"
+#include "SkUtilsArm.h"
+
+bool SkGradientGetPlatformSpanProcs(SkGradientSpanProcs* procs) {
+#if SK_ARM_NEON_IS_NONE
+    return false;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return false;
+    }
+#endif
+    procs->fLinear = SkLinearGradientSpan_neon;
+    procs->fLinearRepeat = SkLinearGradientSpanRepeat_neon;
+    procs->fLinearMirror = SkLinearGradientSpanMirror_neon;
+    procs->fRadialClamp = SkRadialGradientSpanClamp_neon;
+    return true;
+#endif
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGradientShader_opts_neon.h"
+
+#include <arm_neon.h>
+
+namespace {
+
+// fx for four consecutive pixels.
+inline int32x4_t start_fx(SkFixed fx, SkFixed dx) {
+    const int32_t steps[4] = { 0, dx, 2 * dx, 3 * dx };
+    return vaddq_s32(vdupq_n_s32(fx), vld1q_s32(steps));
+}
+
+// The dither row offsets of four consecutive pixels, the first at 'toggle'.
+inline int32x4_t toggles(int toggle) {
+    const int other = toggle ^ kGradientSpanDitherStride;
+    const int32_t t[4] = { toggle, other, toggle, other };
+    return vld1q_s32(t);
+}
+
+// NEON has no gather either, so the indices go through memory.
+inline void gather(SkPMColor* SK_RESTRICT dst, const SkPMColor* SK_RESTRICT cache,
+                   int32x4_t indices) {
+    int32_t index[4];
+    vst1q_s32(index, indices);
+    dst[0] = cache[index[0]];
+    dst[1] = cache[index[1]];
+    dst[2] = cache[index[2]];
+    dst[3] = cache[index[3]];
+}
+
+enum TileMode {
+    kNone_TileMode,
+    kRepeat_TileMode,
+    kMirror_TileMode,
+};
+
+template <TileMode tile>
+inline int32x4_t tile_indices(int32x4_t fx) {
+    int32x4_t x = vshrq_n_s32(fx, kGradientSpanCacheShift);
+    if (kRepeat_TileMode == tile) {
+        x = vandq_s32(x, vdupq_n_s32(0xFF));
+    } else if (kMirror_TileMode == tile) {
+        int32x4_t flip = vreinterpretq_s32_u32(vtstq_s32(x, vdupq_n_s32(256)));
+        x = vandq_s32(veorq_s32(x, flip), vdupq_n_s32(0xFF));
+    }
+    return x;
+}
+
+template <TileMode tile>
+inline unsigned tile_index(SkFixed fx) {
+    if (kRepeat_TileMode == tile) {
+        return SkGradientSpanRepeatIndex(fx);
+    } else if (kMirror_TileMode == tile) {
+        return SkGradientSpanMirrorIndex(fx);
+    }
+    return fx >> kGradientSpanCacheShift;
+}
+
+template <TileMode tile>
+void linear_span(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                 const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    // Four pixels are an even step, so every group starts on 'toggle'.
+    const int32x4_t toggle4 = toggles(toggle);
+    const int32x4_t dx4 = vdupq_n_s32(4 * dx);
+    int32x4_t fx4 = start_fx(fx, dx);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t next = vaddq_s32(fx4, dx4);
+        gather(dst + i, cache, vaddq_s32(tile_indices<tile>(fx4), toggle4));
+        gather(dst + i + 4, cache, vaddq_s32(tile_indices<tile>(next), toggle4));
+        fx4 = vaddq_s32(next, dx4);
+    }
+    fx += i * dx;
+    for (; i < count; ++i) {
+        dst[i] = cache[toggle + tile_index<tile>(fx)];
+        toggle ^= kGradientSpanDitherStride;
+        fx += dx;
+    }
+}
+
+}  // namespace
+
+void SkLinearGradientSpan_neon(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    linear_span<kNone_TileMode>(fx, dx, dst, cache, toggle, count);
+}
+
+void SkLinearGradientSpanRepeat_neon(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    linear_span<kRepeat_TileMode>(fx, dx, dst, cache, toggle, count);
+}
+
+void SkLinearGradientSpanMirror_neon(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count) {
+    linear_span<kMirror_TileMode>(fx, dx, dst, cache, toggle, count);
+}
+
+void SkRadialGradientSpanClamp_neon(SkFixed fx, SkFixed dx, SkFixed fy, SkFixed dy,
+                                    SkPMColor* SK_RESTRICT dst,
+                                    const SkPMColor* SK_RESTRICT cache,
+                                    const uint8_t* SK_RESTRICT sqrtTable,
+                                    int toggle, int count) {
+    const int32x4_t toggle4 = toggles(toggle);
+    const int32x4_t dx4 = vdupq_n_s32(4 * dx);
+    const int32x4_t dy4 = vdupq_n_s32(4 * dy);
+    const uint32x4_t maxIndex = vdupq_n_u32(0xFFFF >> (16 - kGradientSpanSqrtTableBits));
+    int32x4_t fx4 = start_fx(fx, dx);
+    int32x4_t fy4 = start_fx(fy, dy);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // Saturating to 16 bits pins to exactly SkPin32(v, -0xFFFF >> 1, 0xFFFF >> 1).
+        int16x4_t x = vqmovn_s32(fx4);
+        int16x4_t y = vqmovn_s32(fy4);
+        // The sum is unsigned, as in the scalar code: at most 0x80000000.
+        uint32x4_t fi = vreinterpretq_u32_s32(vmlal_s16(vmull_s16(x, x), y, y));
+        fi = vminq_u32(vshrq_n_u32(fi, 14 + 16 - kGradientSpanSqrtTableBits), maxIndex);
+
+        uint32_t index[4];
+        vst1q_u32(index, fi);
+        const int32_t sqrts[4] = { sqrtTable[index[0]], sqrtTable[index[1]],
+                                   sqrtTable[index[2]], sqrtTable[index[3]] };
+        gather(dst + i, cache, vaddq_s32(vld1q_s32(sqrts), toggle4));
+
+        fx4 = vaddq_s32(fx4, dx4);
+        fy4 = vaddq_s32(fy4, dy4);
+    }
+    fx += i * dx;
+    fy += i * dy;
+    for (; i < count; ++i) {
+        dst[i] = cache[toggle + SkGradientSpanRadialIndex(fx, fy, sqrtTable)];
+        toggle ^= kGradientSpanDitherStride;
+        fx += dx;
+        fy += dy;
+    }
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGradientShader_opts_neon_DEFINED
+#define SkGradientShader_opts_neon_DEFINED
+
+#include "SkGradientShader_opts.h"
+
+void SkLinearGradientSpan_neon(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                               const SkPMColor* SK_RESTRICT cache, int toggle, int count);
+void SkLinearGradientSpanRepeat_neon(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count);
+void SkLinearGradientSpanMirror_neon(SkFixed fx, SkFixed dx, SkPMColor* SK_RESTRICT dst,
+                                     const SkPMColor* SK_RESTRICT cache, int toggle, int count);
+void SkRadialGradientSpanClamp_neon(SkFixed fx, SkFixed dx, SkFixed fy, SkFixed dy,
+                                    SkPMColor* SK_RESTRICT dst,
+                                    const SkPMColor* SK_RESTRICT cache,
+                                    const uint8_t* SK_RESTRICT sqrtTable,
+                                    int toggle, int count);
+
+#endif
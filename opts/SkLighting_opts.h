@@ -0,0 +1,56 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLighting_opts_DEFINED
+#define SkLighting_opts_DEFINED
+
+#include "SkColorPriv.h"
+#include "SkScalar.h"
+
+/**
+ *  Computes the unit surface normals of count interior pixels of a lighting
+ *  filter's alpha height map with the Sobel kernel and pointToNormal() of
+ *  SkLightingImageFilter.cpp, but several pixels at a time. row0, row1 and
+ *  row2 are the rows above, at and below the pixels, and each starts one
+ *  pixel to the left of the first, so count + 2 pixels of each are read. The
+ *  normals are written as separate x, y and z runs.
+ */
+typedef void (*SkLightingInteriorNormalsProc)(const SkPMColor* row0, const SkPMColor* row1,
+                                              const SkPMColor* row2, SkScalar surfaceScale,
+                                              SkScalar* nx, SkScalar* ny, SkScalar* nz,
+                                              int count);
+
+// Returns NULL if there is no faster proc than SkLightingInteriorNormals.
+SkLightingInteriorNormalsProc SkLightingGetPlatformInteriorNormalsProc();
+
+// The scalar normals, for the pixels the SIMD code has left over.
+static inline void SkLightingInteriorNormals(const SkPMColor* row0, const SkPMColor* row1,
+                                             const SkPMColor* row2, SkScalar surfaceScale,
+                                             SkScalar* nx, SkScalar* ny, SkScalar* nz,
+                                             int count) {
+    const SkScalar scale = SkScalarMul(-surfaceScale, 0.25f);
+    for (int i = 0; i < count; ++i) {
+        const int m0 = SkGetPackedA32(row0[i]);
+        const int m1 = SkGetPackedA32(row0[i + 1]);
+        const int m2 = SkGetPackedA32(row0[i + 2]);
+        const int m3 = SkGetPackedA32(row1[i]);
+        const int m5 = SkGetPackedA32(row1[i + 2]);
+        const int m6 = SkGetPackedA32(row2[i]);
+        const int m7 = SkGetPackedA32(row2[i + 1]);
+        const int m8 = SkGetPackedA32(row2[i + 2]);
+        const SkScalar x = SkIntToScalar(-m0 + m2 - 2 * m3 + 2 * m5 - m6 + m8) * scale;
+        const SkScalar y = SkIntToScalar(-m0 + m6 - 2 * m1 + 2 * m7 - m2 + m8) * scale;
+        // As SkPoint3::normalize() on (x, y, 1).
+        const SkScalar invLength = SkScalarInvert(SkScalarSqrt(x * x + y * y + SK_Scalar1) +
+                                                  SK_ScalarNearlyZero);
+        nx[i] = x * invLength;
+        ny[i] = y * invLength;
+        nz[i] = invLength;
+    }
+}
+
+#endif
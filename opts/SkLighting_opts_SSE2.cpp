@@ -0,0 +1,62 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkLighting_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+namespace {
+
+// The alphas of four pixels, one per 32-bit lane.
+inline __m128i load_alphas(const SkPMColor* row) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+    return _mm_and_si128(_mm_srli_epi32(pixels, SK_A32_SHIFT), _mm_set1_epi32(0xFF));
+}
+
+}  // namespace
+
+void SkLightingInteriorNormals_SSE2(const SkPMColor* row0, const SkPMColor* row1,
+                                    const SkPMColor* row2, SkScalar surfaceScale,
+                                    SkScalar* nx, SkScalar* ny, SkScalar* nz, int count) {
+    const __m128 scale = _mm_set1_ps(SkScalarMul(-surfaceScale, 0.25f));
+    const __m128 one = _mm_set1_ps(SK_Scalar1);
+    const __m128 nearlyZero = _mm_set1_ps(SK_ScalarNearlyZero);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i m0 = load_alphas(row0 + i);
+        const __m128i m1 = load_alphas(row0 + i + 1);
+        const __m128i m2 = load_alphas(row0 + i + 2);
+        const __m128i m3 = load_alphas(row1 + i);
+        const __m128i m5 = load_alphas(row1 + i + 2);
+        const __m128i m6 = load_alphas(row2 + i);
+        const __m128i m7 = load_alphas(row2 + i + 1);
+        const __m128i m8 = load_alphas(row2 + i + 2);
+
+        // The Sobel sums, -m0 + m2 - 2 * m3 + 2 * m5 - m6 + m8 and
+        // -m0 + m6 - 2 * m1 + 2 * m7 - m2 + m8.
+        const __m128i corners = _mm_sub_epi32(m8, m0);
+        __m128i sx = _mm_add_epi32(corners, _mm_sub_epi32(m2, m6));
+        sx = _mm_add_epi32(sx, _mm_slli_epi32(_mm_sub_epi32(m5, m3), 1));
+        __m128i sy = _mm_add_epi32(corners, _mm_sub_epi32(m6, m2));
+        sy = _mm_add_epi32(sy, _mm_slli_epi32(_mm_sub_epi32(m7, m1), 1));
+
+        const __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(sx), scale);
+        const __m128 y = _mm_mul_ps(_mm_cvtepi32_ps(sy), scale);
+        // As SkLightingInteriorNormals: a full precision sqrt and divide, so
+        // the results match the scalar code exactly.
+        __m128 length = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), one);
+        length = _mm_add_ps(_mm_sqrt_ps(length), nearlyZero);
+        const __m128 invLength = _mm_div_ps(one, length);
+
+        _mm_storeu_ps(nx + i, _mm_mul_ps(x, invLength));
+        _mm_storeu_ps(ny + i, _mm_mul_ps(y, invLength));
+        _mm_storeu_ps(nz + i, invLength);
+    }
+    SkLightingInteriorNormals(row0 + i, row1 + i, row2 + i, surfaceScale,
+                              nx + i, ny + i, nz + i, count - i);
+}
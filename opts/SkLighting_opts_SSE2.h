@@ -0,0 +1,17 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkLighting_opts_SSE2_DEFINED
+#define SkLighting_opts_SSE2_DEFINED
+
+#include "SkLighting_opts.h"
+
+void SkLightingInteriorNormals_SSE2(const SkPMColor* row0, const SkPMColor* row1,
+                                    const SkPMColor* row2, SkScalar surfaceScale,
+                                    SkScalar* nx, SkScalar* ny, SkScalar* nz, int count);
+
+#endif
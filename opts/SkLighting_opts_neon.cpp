@@ -0,0 +1,68 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkLighting_opts_neon.h"
+
+#include "SkColor_opts_neon.h"
+
+namespace {
+
+// The alphas of eight pixels, widened to 16 bits.
+inline int16x8_t load_alphas(const SkPMColor* row) {
+    uint8x8x4_t pixels = vld4_u8(reinterpret_cast<const uint8_t*>(row));
+    return vreinterpretq_s16_u16(vmovl_u8(pixels.val[NEON_A]));
+}
+
+inline void store_scaled(int16x4_t sum, float32x4_t scale, SkScalar* dst) {
+    vst1q_f32(dst, vmulq_f32(vcvtq_f32_s32(vmovl_s16(sum)), scale));
+}
+
+}  // namespace
+
+void SkLightingInteriorNormals_neon(const SkPMColor* row0, const SkPMColor* row1,
+                                    const SkPMColor* row2, SkScalar surfaceScale,
+                                    SkScalar* nx, SkScalar* ny, SkScalar* nz, int count) {
+    const float32x4_t scale = vdupq_n_f32(SkScalarMul(-surfaceScale, 0.25f));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t m0 = load_alphas(row0 + i);
+        const int16x8_t m1 = load_alphas(row0 + i + 1);
+        const int16x8_t m2 = load_alphas(row0 + i + 2);
+        const int16x8_t m3 = load_alphas(row1 + i);
+        const int16x8_t m5 = load_alphas(row1 + i + 2);
+        const int16x8_t m6 = load_alphas(row2 + i);
+        const int16x8_t m7 = load_alphas(row2 + i + 1);
+        const int16x8_t m8 = load_alphas(row2 + i + 2);
+
+        // The Sobel sums are at most 4 * 255 in magnitude, so 16 bits do.
+        const int16x8_t corners = vsubq_s16(m8, m0);
+        int16x8_t sx = vaddq_s16(corners, vsubq_s16(m2, m6));
+        sx = vaddq_s16(sx, vshlq_n_s16(vsubq_s16(m5, m3), 1));
+        int16x8_t sy = vaddq_s16(corners, vsubq_s16(m6, m2));
+        sy = vaddq_s16(sy, vshlq_n_s16(vsubq_s16(m7, m1), 1));
+
+        store_scaled(vget_low_s16(sx), scale, nx + i);
+        store_scaled(vget_high_s16(sx), scale, nx + i + 4);
+        store_scaled(vget_low_s16(sy), scale, ny + i);
+        store_scaled(vget_high_s16(sy), scale, ny + i + 4);
+
+        // ARMv7 NEON has only reciprocal square root estimates, which would
+        // not match the scalar code, so normalize one lane at a time.
+        for (int j = i; j < i + 8; ++j) {
+            const SkScalar x = nx[j];
+            const SkScalar y = ny[j];
+            const SkScalar invLength = SkScalarInvert(SkScalarSqrt(x * x + y * y + SK_Scalar1) +
+                                                      SK_ScalarNearlyZero);
+            nx[j] = x * invLength;
+            ny[j] = y * invLength;
+            nz[j] = invLength;
+        }
+    }
+    SkLightingInteriorNormals(row0 + i, row1 + i, row2 + i, surfaceScale,
+                              nx + i, ny + i, nz + i, count - i);
+}
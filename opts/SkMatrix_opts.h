@@ -0,0 +1,30 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMatrix_opts_DEFINED
+#define SkMatrix_opts_DEFINED
+
+#include "SkMatrix.h"
+
+/**
+ *  Procs that map a run of points as SkMatrix's MapPtsProcs do, several at a
+ *  time, with the same operations in the same order so the results match the
+ *  scalar code. Each maps as many of the leading points as it can and returns
+ *  how many that was; the caller maps the rest. src and dst may be the same.
+ */
+typedef int (*SkMatrixMapPtsPlatformProc)(const SkMatrix& m, SkPoint dst[],
+                                          const SkPoint src[], int count);
+
+struct SkMatrixMapPtsProcs {
+    SkMatrixMapPtsPlatformProc fScaleTrans; // x * sx + tx, y * sy + ty
+    SkMatrixMapPtsPlatformProc fAffine;     // as SkMatrix::RotTrans_pts
+    SkMatrixMapPtsPlatformProc fPersp;      // as SkMatrix::Persp_pts; may be NULL
+};
+
+bool SkMatrixGetPlatformMapPtsProcs(SkMatrixMapPtsProcs* procs);
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMatrix_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+// Each register holds two points, x0 y0 x1 y1, and each loop maps four.
+
+int SkMatrixScaleTrans_pts_SSE2(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count) {
+    const __m128 scale = _mm_setr_ps(m.getScaleX(), m.getScaleY(), m.getScaleX(), m.getScaleY());
+    const __m128 trans = _mm_setr_ps(m.getTranslateX(), m.getTranslateY(),
+                                     m.getTranslateX(), m.getTranslateY());
+    const float* s = &src[0].fX;
+    float* d = &dst[0].fX;
+    const int n = count & ~3;
+    for (int i = 0; i < n; i += 4, s += 8, d += 8) {
+        __m128 p0 = _mm_loadu_ps(s);
+        __m128 p1 = _mm_loadu_ps(s + 4);
+        _mm_storeu_ps(d, _mm_add_ps(_mm_mul_ps(p0, scale), trans));
+        _mm_storeu_ps(d + 4, _mm_add_ps(_mm_mul_ps(p1, scale), trans));
+    }
+    return n;
+}
+
+namespace {
+
+// Splits x0 y0 x1 y1 into x0 x0 x1 x1 and y0 y0 y1 y1.
+inline void splat_xy(__m128 p, __m128* xx, __m128* yy) {
+    *xx = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0));
+    *yy = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+}  // namespace
+
+// x' = x * sx + (y * kx + tx), y' = x * ky + (y * sy + ty): the order of
+// RotTrans_pts under SK_LEGACY_MATRIX_MATH_ORDER.
+int SkMatrixAffine_pts_SSE2(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count) {
+    const __m128 xCoeffs = _mm_setr_ps(m.getScaleX(), m.getSkewY(), m.getScaleX(), m.getSkewY());
+    const __m128 yCoeffs = _mm_setr_ps(m.getSkewX(), m.getScaleY(), m.getSkewX(), m.getScaleY());
+    const __m128 trans = _mm_setr_ps(m.getTranslateX(), m.getTranslateY(),
+                                     m.getTranslateX(), m.getTranslateY());
+    const float* s = &src[0].fX;
+    float* d = &dst[0].fX;
+    const int n = count & ~3;
+    for (int i = 0; i < n; i += 4, s += 8, d += 8) {
+        __m128 xx0, yy0, xx1, yy1;
+        splat_xy(_mm_loadu_ps(s), &xx0, &yy0);
+        splat_xy(_mm_loadu_ps(s + 4), &xx1, &yy1);
+        __m128 r0 = _mm_add_ps(_mm_mul_ps(xx0, xCoeffs),
+                               _mm_add_ps(_mm_mul_ps(yy0, yCoeffs), trans));
+        __m128 r1 = _mm_add_ps(_mm_mul_ps(xx1, xCoeffs),
+                               _mm_add_ps(_mm_mul_ps(yy1, yCoeffs), trans));
+        _mm_storeu_ps(d, r0);
+        _mm_storeu_ps(d + 4, r1);
+    }
+    return n;
+}
+
+// x = (x * sx + y * kx) + tx, y = (x * ky + y * sy) + ty,
+// z = x * p0 + (y * p1 + p2), and then x / z, y / z, or 0 if z is 0: the
+// order of Persp_pts under SK_LEGACY_MATRIX_MATH_ORDER.
+int SkMatrixPersp_pts_SSE2(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count) {
+    const __m128 xCoeffs = _mm_setr_ps(m.getScaleX(), m.getSkewY(), m.getScaleX(), m.getSkewY());
+    const __m128 yCoeffs = _mm_setr_ps(m.getSkewX(), m.getScaleY(), m.getSkewX(), m.getScaleY());
+    const __m128 trans = _mm_setr_ps(m.getTranslateX(), m.getTranslateY(),
+                                     m.getTranslateX(), m.getTranslateY());
+    const __m128 p0 = _mm_set1_ps(m.getPerspX());
+    const __m128 p1 = _mm_set1_ps(m.getPerspY());
+    const __m128 p2 = _mm_set1_ps(m.get(SkMatrix::kMPersp2));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const float* s = &src[0].fX;
+    float* d = &dst[0].fX;
+    const int n = count & ~1;
+    for (int i = 0; i < n; i += 2, s += 4, d += 4) {
+        __m128 xx, yy;
+        splat_xy(_mm_loadu_ps(s), &xx, &yy);
+        __m128 xy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xx, xCoeffs), _mm_mul_ps(yy, yCoeffs)),
+                               trans);
+        __m128 z = _mm_add_ps(_mm_mul_ps(xx, p0), _mm_add_ps(_mm_mul_ps(yy, p1), p2));
+        __m128 invZ = _mm_and_ps(_mm_cmpneq_ps(z, zero), _mm_div_ps(one, z));
+        _mm_storeu_ps(d, _mm_mul_ps(xy, invZ));
+    }
+    return n;
+}
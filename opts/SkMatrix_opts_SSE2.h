@@ -0,0 +1,17 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMatrix_opts_SSE2_DEFINED
+#define SkMatrix_opts_SSE2_DEFINED
+
+#include "SkMatrix_opts.h"
+
+int SkMatrixScaleTrans_pts_SSE2(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count);
+int SkMatrixAffine_pts_SSE2(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count);
+int SkMatrixPersp_pts_SSE2(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count);
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMatrix_opts_neon.h"
+#include "SkUtilsArm.h"
+
+bool SkMatrixGetPlatformMapPtsProcs(SkMatrixMapPtsProcs* procs) {
+#if SK_ARM_NEON_IS_NONE
+    return false;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return false;
+    }
+#endif
+    procs->fScaleTrans = SkMatrixScaleTrans_pts_neon;
+    procs->fAffine = SkMatrixAffine_pts_neon;
+    // NEON has no exact divide, so perspective stays scalar.
+    procs->fPersp = NULL;
+    return true;
+#endif
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMatrix_opts_neon.h"
+
+#include <arm_neon.h>
+
+// vld2q_f32() deinterleaves four points into their xs and ys. Products and
+// sums are kept separate (no vmla) so the rounding matches the scalar code.
+
+int SkMatrixScaleTrans_pts_neon(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count) {
+    const float32x4_t sx = vdupq_n_f32(m.getScaleX());
+    const float32x4_t sy = vdupq_n_f32(m.getScaleY());
+    const float32x4_t tx = vdupq_n_f32(m.getTranslateX());
+    const float32x4_t ty = vdupq_n_f32(m.getTranslateY());
+    const float* s = &src[0].fX;
+    float* d = &dst[0].fX;
+    const int n = count & ~3;
+    for (int i = 0; i < n; i += 4, s += 8, d += 8) {
+        float32x4x2_t p = vld2q_f32(s);
+        p.val[0] = vaddq_f32(vmulq_f32(p.val[0], sx), tx);
+        p.val[1] = vaddq_f32(vmulq_f32(p.val[1], sy), ty);
+        vst2q_f32(d, p);
+    }
+    return n;
+}
+
+// x' = x * sx + (y * kx + tx), y' = x * ky + (y * sy + ty): the order of
+// RotTrans_pts under SK_LEGACY_MATRIX_MATH_ORDER.
+int SkMatrixAffine_pts_neon(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count) {
+    const float32x4_t sx = vdupq_n_f32(m.getScaleX());
+    const float32x4_t sy = vdupq_n_f32(m.getScaleY());
+    const float32x4_t kx = vdupq_n_f32(m.getSkewX());
+    const float32x4_t ky = vdupq_n_f32(m.getSkewY());
+    const float32x4_t tx = vdupq_n_f32(m.getTranslateX());
+    const float32x4_t ty = vdupq_n_f32(m.getTranslateY());
+    const float* s = &src[0].fX;
+    float* d = &dst[0].fX;
+    const int n = count & ~3;
+    for (int i = 0; i < n; i += 4, s += 8, d += 8) {
+        float32x4x2_t p = vld2q_f32(s);
+        float32x4x2_t r;
+        r.val[0] = vaddq_f32(vmulq_f32(p.val[0], sx), vaddq_f32(vmulq_f32(p.val[1], kx), tx));
+        r.val[1] = vaddq_f32(vmulq_f32(p.val[0], ky), vaddq_f32(vmulq_f32(p.val[1], sy), ty));
+        vst2q_f32(d, r);
+    }
+    return n;
+}
@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMatrix_opts_neon_DEFINED
+#define SkMatrix_opts_neon_DEFINED
+
+#include "SkMatrix_opts.h"
+
+int SkMatrixScaleTrans_pts_neon(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count);
+int SkMatrixAffine_pts_neon(const SkMatrix& m, SkPoint dst[], const SkPoint src[], int count);
+
+#endif
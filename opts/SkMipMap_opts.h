@@ -0,0 +1,27 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipMap_opts_DEFINED
+#define SkMipMap_opts_DEFINED
+
+#include "SkColor.h"
+#include "SkMipMap.h"
+
+// The scalar average of one 2x2 block, for the pixels the SIMD code has left over.
+static inline SkPMColor SkDownsample32Pixel(const SkPMColor* row0, const SkPMColor* row1) {
+    SkPMColor c;
+    uint32_t ag, rb;
+
+    c = row0[0]; ag  = (c >> 8) & 0xFF00FF; rb  = c & 0xFF00FF;
+    c = row0[1]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+    c = row1[0]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+    c = row1[1]; ag += (c >> 8) & 0xFF00FF; rb += c & 0xFF00FF;
+
+    return ((rb >> 2) & 0xFF00FF) | ((ag << 6) & 0xFF00FF00);
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMipMap_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+namespace {
+
+// Sums the four source pixels of each of two destination pixels, one per
+// 64-bit half of the result, in 16-bit channels.
+inline __m128i sum_2x2(const SkPMColor* row0, const SkPMColor* row1) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1));
+    // Columns 0 and 1 in lo, columns 2 and 3 in hi.
+    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+    lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+    hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+}  // namespace
+
+void SkDownsample32_SSE2(const SkPMColor* row0, const SkPMColor* row1,
+                         SkPMColor* dst, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i sum01 = _mm_srli_epi16(sum_2x2(row0, row1), 2);
+        __m128i sum23 = _mm_srli_epi16(sum_2x2(row0 + 4, row1 + 4), 2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(sum01, sum23));
+        row0 += 8;
+        row1 += 8;
+    }
+    for (; i < count; ++i) {
+        dst[i] = SkDownsample32Pixel(row0, row1);
+        row0 += 2;
+        row1 += 2;
+    }
+}
@@ -0,0 +1,16 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMipMap_opts_SSE2_DEFINED
+#define SkMipMap_opts_SSE2_DEFINED
+
+#include "SkMipMap_opts.h"
+
+void SkDownsample32_SSE2(const SkPMColor* row0, const SkPMColor* row1,
+                         SkPMColor* dst, int count);
+
+#endif
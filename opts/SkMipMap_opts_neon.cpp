@@ -0,0 +1,34 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkMipMap_opts_neon.h"
+
+#include <arm_neon.h>
+
+void SkDownsample32_neon(const SkPMColor* row0, const SkPMColor* row1,
+                         SkPMColor* dst, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // 16 source pixels from each row, split into channels, make 8
+        // destination pixels. Pairwise adds sum the columns, in 16 bits.
+        uint8x16x4_t a = vld4q_u8(reinterpret_cast<const uint8_t*>(row0));
+        uint8x16x4_t b = vld4q_u8(reinterpret_cast<const uint8_t*>(row1));
+        uint8x8x4_t result;
+        for (int c = 0; c < 4; ++c) {
+            uint16x8_t sum = vpadalq_u8(vpaddlq_u8(a.val[c]), b.val[c]);
+            result.val[c] = vshrn_n_u16(sum, 2);
+        }
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), result);
+        row0 += 16;
+        row1 += 16;
+    }
+    for (; i < count; ++i) {
+        dst[i] = SkDownsample32Pixel(row0, row1);
+        row0 += 2;
+        row1 += 2;
+    }
+}
@@ -9,6 +9,7 @@
 #define SkMorphology_opts_DEFINED
 
 #include <SkMorphologyImageFilter.h>
+#include "SkTemplates.h"
 
 enum SkMorphologyProcType {
     kDilateX_SkMorphologyProcType,
@@ -19,4 +20,74 @@ enum SkMorphologyProcType {
 
 SkMorphologyImageFilter::Proc SkMorphologyGetPlatformProc(SkMorphologyProcType type);
 
+// The procs hand radii from this one up to SkMorphLargeRadius(), rather than
+// taking the max (or min) of the whole window at every pixel.
+static const int kSkMorphologyLargeRadius = 8;
+
+/**
+ *  The van Herk/Gil-Werman dilate or erode, which costs three Op::Apply()s per
+ *  pixel whatever the radius. The padded line is cut into blocks the size of
+ *  the window; the window at each pixel spans at most two blocks, and so is
+ *  the suffix of one block combined with the prefix of the next.
+ *
+ *  Op::Apply(a, b) is the channel-wise max (or min) of two colors, and
+ *  Op::Identity() the color that leaves the other operand unchanged, standing
+ *  in for pixels past either end of the line. Arguments are as for the procs:
+ *  lines run along horizontal (or vertical) direction for width pixels, and
+ *  there are height of them.
+ */
+template <typename Op, bool horizontal>
+void SkMorphLargeRadius(const SkPMColor* src, SkPMColor* dst, int radius,
+                        int width, int height, int srcStride, int dstStride) {
+    const int srcStrideX = horizontal ? 1 : srcStride;
+    const int dstStrideX = horizontal ? 1 : dstStride;
+    const int srcStrideY = horizontal ? srcStride : 1;
+    const int dstStrideY = horizontal ? dstStride : 1;
+    radius = SkMin32(radius, width - 1);
+    const int window = 2 * radius + 1;
+    const int padded = width + 2 * radius;
+
+    // Vertical lines are done a strip of neighboring columns at a time, so
+    // that each step along them still reads a contiguous run of pixels.
+    const int kStrip = horizontal ? 1 : 64;
+    SkAutoTMalloc<SkPMColor> storage(2 * padded * kStrip);
+    SkPMColor* prefix = storage.get();
+    SkPMColor* suffix = prefix + padded * kStrip;
+    const SkPMColor identity = Op::Identity();
+
+    for (int y = 0; y < height; y += kStrip) {
+        const int lanes = SkMin32(kStrip, height - y);
+        const SkPMColor* lineSrc = src + y * srcStrideY;
+        SkPMColor* lineDst = dst + y * dstStrideY;
+
+        for (int j = 0; j < padded; ++j) {
+            const int x = j - radius;
+            const bool inside = x >= 0 && x < width;
+            const bool blockStart = 0 == j % window;
+            for (int l = 0; l < lanes; ++l) {
+                SkPMColor c = inside ? lineSrc[x * srcStrideX + l * srcStrideY] : identity;
+                prefix[j * kStrip + l] = blockStart ? c
+                                                    : Op::Apply(prefix[(j - 1) * kStrip + l], c);
+            }
+        }
+        for (int j = padded - 1; j >= 0; --j) {
+            const int x = j - radius;
+            const bool inside = x >= 0 && x < width;
+            const bool blockEnd = window - 1 == j % window || padded - 1 == j;
+            for (int l = 0; l < lanes; ++l) {
+                SkPMColor c = inside ? lineSrc[x * srcStrideX + l * srcStrideY] : identity;
+                suffix[j * kStrip + l] = blockEnd ? c
+                                                  : Op::Apply(suffix[(j + 1) * kStrip + l], c);
+            }
+        }
+        // The window at x covers padded [x, x + 2 * radius].
+        for (int x = 0; x < width; ++x) {
+            for (int l = 0; l < lanes; ++l) {
+                lineDst[x * dstStrideX + l * dstStrideY] =
+                        Op::Apply(suffix[x * kStrip + l], prefix[(x + 2 * radius) * kStrip + l]);
+            }
+        }
+    }
+}
+
 #endif
@@ -7,6 +7,7 @@
 
 #include <emmintrin.h>
 #include "SkColorPriv.h"
+#include "SkMorphology_opts.h"
 #include "SkMorphology_opts_SSE2.h"
 
 /* SSE2 version of dilateX, dilateY, erodeX, erodeY.
@@ -21,10 +22,26 @@ enum MorphDirection {
     kX, kY
 };
 
+// One pixel's four channels at a time, for SkMorphLargeRadius().
+template<MorphType type>
+struct SkMorphOp_SSE2 {
+    static SkPMColor Apply(SkPMColor a, SkPMColor b) {
+        __m128i pa = _mm_cvtsi32_si128(a);
+        __m128i pb = _mm_cvtsi32_si128(b);
+        return _mm_cvtsi128_si32(type == kDilate ? _mm_max_epu8(pa, pb) : _mm_min_epu8(pa, pb));
+    }
+    static SkPMColor Identity() { return type == kDilate ? 0 : 0xFFFFFFFF; }
+};
+
 template<MorphType type, MorphDirection direction>
 static void SkMorph_SSE2(const SkPMColor* src, SkPMColor* dst, int radius,
                          int width, int height, int srcStride, int dstStride)
 {
+    if (radius >= kSkMorphologyLargeRadius) {
+        SkMorphLargeRadius<SkMorphOp_SSE2<type>, direction == kX>(src, dst, radius, width,
+                                                                  height, srcStride, dstStride);
+        return;
+    }
     const int srcStrideX = direction == kX ? 1 : srcStride;
     const int dstStrideX = direction == kX ? 1 : dstStride;
     const int srcStrideY = direction == kX ? srcStride : 1;
@@ -24,10 +24,27 @@ enum MorphDirection {
     kX, kY
 };
 
+// One pixel's four channels at a time, for SkMorphLargeRadius().
+template<MorphType type>
+struct SkMorphOp_neon {
+    static SkPMColor Apply(SkPMColor a, SkPMColor b) {
+        uint8x8_t pa = vreinterpret_u8_u32(vdup_n_u32(a));
+        uint8x8_t pb = vreinterpret_u8_u32(vdup_n_u32(b));
+        uint8x8_t result = type == kDilate ? vmax_u8(pa, pb) : vmin_u8(pa, pb);
+        return vget_lane_u32(vreinterpret_u32_u8(result), 0);
+    }
+    static SkPMColor Identity() { return type == kDilate ? 0 : 0xFFFFFFFF; }
+};
+
 template<MorphType type, MorphDirection direction>
 static void SkMorph_neon(const SkPMColor* src, SkPMColor* dst, int radius,
                          int width, int height, int srcStride, int dstStride)
 {
+    if (radius >= kSkMorphologyLargeRadius) {
+        SkMorphLargeRadius<SkMorphOp_neon<type>, direction == kX>(src, dst, radius, width,
+                                                                  height, srcStride, dstStride);
+        return;
+    }
     const int srcStrideX = direction == kX ? 1 : srcStride;
     const int dstStrideX = direction == kX ? 1 : dstStride;
     const int srcStrideY = direction == kX ? srcStride : 1;
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkScaledBitmapSampler_opts_DEFINED
+#define SkScaledBitmapSampler_opts_DEFINED
+
+#include "SkColorPriv.h"
+
+/**
+ *  Same signature as SkScaledBitmapSampler::RowProc. The platform procs only
+ *  convert unsampled rows, where deltaSrc is the source pixel size, and
+ *  return true if the row had non-opaque alpha in it.
+ */
+typedef bool (*SkSampleRowProc)(void* SK_RESTRICT dstRow,
+                                const uint8_t* SK_RESTRICT src,
+                                int width, int deltaSrc, int y,
+                                const SkPMColor[]);
+
+/**
+ *  Row procs for decoding full size images to 8888. Each does exactly what
+ *  the scalar proc of the same name in SkScaledBitmapSampler.cpp does.
+ */
+struct SkScaledBitmapSamplerProcs {
+    SkSampleRowProc fGray_D8888;    // 1 byte per pixel
+    SkSampleRowProc fRGB_D8888;     // 3 bytes per pixel, opaque
+    SkSampleRowProc fRGBx_D8888;    // 4 bytes per pixel, opaque
+    SkSampleRowProc fRGBA_D8888;    // 4 bytes per pixel, premultiplied
+};
+
+bool SkScaledBitmapSamplerGetPlatformProcs(SkScaledBitmapSamplerProcs* procs);
+
+#endif
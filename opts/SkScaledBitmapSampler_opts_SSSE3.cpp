@@ -0,0 +1,189 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScaledBitmapSampler_opts_SSSE3.h"
+
+/* As in SkBitmapProcState_opts_SSSE3.cpp, the Android framework may build this
+ * file without -mssse3, in which case only stubs are provided and
+ * SkScaledBitmapSamplerGetPlatformProcs() never hands them out.
+ */
+#if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+#include <tmmintrin.h>  // SSSE3
+
+namespace {
+
+// Byte offsets of each component within a (little endian) SkPMColor.
+enum {
+    kA = SK_A32_SHIFT / 8,
+    kR = SK_R32_SHIFT / 8,
+    kG = SK_G32_SHIFT / 8,
+    kB = SK_B32_SHIFT / 8,
+};
+
+/**
+ *  Returns the pshufb mask that moves the four pixels of srcPixelSize bytes
+ *  (R, G, B and maybe A), starting at byte srcOffset, into SkPMColor order.
+ *  Without source alpha the alpha bytes are zeroed, to be or-ed in later. If
+ *  spreadAlpha is set, every color byte instead gets its pixel's alpha.
+ */
+__m128i shuffle_mask(int srcPixelSize, int srcOffset, bool srcHasAlpha, bool spreadAlpha) {
+    char mask[16];
+    for (int i = 0; i < 4; ++i) {
+        char* pixel = mask + 4 * i;
+        const int s = srcOffset + i * srcPixelSize;
+        if (spreadAlpha) {
+            pixel[kR] = pixel[kG] = pixel[kB] = s + 3;
+            pixel[kA] = -1;
+        } else {
+            pixel[kR] = s;
+            pixel[kG] = s + (srcPixelSize > 1 ? 1 : 0);
+            pixel[kB] = s + (srcPixelSize > 1 ? 2 : 0);
+            pixel[kA] = srcHasAlpha ? s + 3 : -1;
+        }
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+inline __m128i opaque_alpha() {
+    return _mm_set1_epi32(static_cast<int>(0xFFU << SK_A32_SHIFT));
+}
+
+// As SkMulDiv255Round(), on eight 16 bit lanes.
+inline __m128i mul_div_255_round(__m128i c, __m128i a) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+// Source pixels are R, G, B in the first three bytes, alpha is always 0xFF.
+bool sample_opaque(SkPMColor* SK_RESTRICT dst, const uint8_t* SK_RESTRICT src,
+                   int width, int srcPixelSize) {
+    const __m128i mask = shuffle_mask(srcPixelSize, 0, false, false);
+    const __m128i alpha = opaque_alpha();
+
+    // Each step loads 16 bytes, which is more than four RGB pixels, so stop
+    // while that load still lies within the row.
+    int x = 0;
+    for (; x * srcPixelSize + 16 <= width * srcPixelSize; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), pixels);
+        src += 4 * srcPixelSize;
+    }
+    for (; x < width; ++x) {
+        dst[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        src += srcPixelSize;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool Sample_Gray_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(1 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i masks[4] = {
+        shuffle_mask(1, 0, false, false),
+        shuffle_mask(1, 4, false, false),
+        shuffle_mask(1, 8, false, false),
+        shuffle_mask(1, 12, false, false),
+    };
+    const __m128i alpha = opaque_alpha();
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        for (int i = 0; i < 4; ++i) {
+            __m128i pixels = _mm_or_si128(_mm_shuffle_epi8(gray, masks[i]), alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 4 * i), pixels);
+        }
+    }
+    for (; x < width; ++x) {
+        dst[x] = SkPackARGB32(0xFF, src[x], src[x], src[x]);
+    }
+    return false;
+}
+
+bool Sample_RGB_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(3 == deltaSrc);
+    return sample_opaque((SkPMColor*)dstRow, src, width, 3);
+}
+
+bool Sample_RGBx_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    return sample_opaque((SkPMColor*)dstRow, src, width, 4);
+}
+
+bool Sample_RGBA_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    const __m128i colorMask = shuffle_mask(4, 0, true, false);
+    // The alpha lanes are multiplied by 255, which leaves alpha unchanged.
+    const __m128i alphaMask = shuffle_mask(4, 0, true, true);
+    const __m128i alphaOne = opaque_alpha();
+    const __m128i zero = _mm_setzero_si128();
+    __m128i alphaAnd = _mm_set1_epi8(-1);
+
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        alphaAnd = _mm_and_si128(alphaAnd, pixels);
+
+        const __m128i color = _mm_shuffle_epi8(pixels, colorMask);
+        const __m128i alpha = _mm_or_si128(_mm_shuffle_epi8(pixels, alphaMask), alphaOne);
+        __m128i lo = mul_div_255_round(_mm_unpacklo_epi8(color, zero),
+                                       _mm_unpacklo_epi8(alpha, zero));
+        __m128i hi = mul_div_255_round(_mm_unpackhi_epi8(color, zero),
+                                       _mm_unpackhi_epi8(alpha, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+        src += 16;
+    }
+
+    // The source alpha is the top byte of each 32 bit lane.
+    uint32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), alphaAnd);
+    unsigned alphaMaskBits = (lanes[0] & lanes[1] & lanes[2] & lanes[3]) >> 24;
+    for (; x < width; ++x) {
+        unsigned alpha = src[3];
+        dst[x] = SkPreMultiplyARGB(alpha, src[0], src[1], src[2]);
+        src += 4;
+        alphaMaskBits &= alpha;
+    }
+    return alphaMaskBits != 0xFF;
+}
+
+#else // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSSE3
+
+bool Sample_Gray_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    sk_throw();
+    return false;
+}
+
+bool Sample_RGB_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    sk_throw();
+    return false;
+}
+
+bool Sample_RGBx_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    sk_throw();
+    return false;
+}
+
+bool Sample_RGBA_D8888_SSSE3(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                             int width, int deltaSrc, int, const SkPMColor[]) {
+    sk_throw();
+    return false;
+}
+
+#endif
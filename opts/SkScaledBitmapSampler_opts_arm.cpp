@@ -0,0 +1,26 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScaledBitmapSampler_opts_neon.h"
+#include "SkUtilsArm.h"
+
+bool SkScaledBitmapSamplerGetPlatformProcs(SkScaledBitmapSamplerProcs* procs) {
+#if SK_ARM_NEON_IS_NONE
+    return false;
+#else
+#if SK_ARM_NEON_IS_DYNAMIC
+    if (!sk_cpu_arm_has_neon()) {
+        return false;
+    }
+#endif
+    procs->fGray_D8888 = Sample_Gray_D8888_neon;
+    procs->fRGB_D8888 = Sample_RGB_D8888_neon;
+    procs->fRGBx_D8888 = Sample_RGBx_D8888_neon;
+    procs->fRGBA_D8888 = Sample_RGBA_D8888_neon;
+    return true;
+#endif
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkScaledBitmapSampler_opts_neon.h"
+
+#include "SkColor_opts_neon.h"
+
+namespace {
+
+inline uint8x8_t opaque_alpha() {
+    return vdup_n_u8(0xFF);
+}
+
+// As SkMulDiv255Round(), on eight bytes.
+inline uint8x8_t mul_div_255_round(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t prod = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(prod, vshrq_n_u16(prod, 8)), 8);
+}
+
+}  // namespace
+
+bool Sample_Gray_D8888_neon(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(1 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8_t gray = vld1_u8(src + x);
+        uint8x8x4_t pixels;
+        pixels.val[NEON_A] = opaque_alpha();
+        pixels.val[NEON_R] = gray;
+        pixels.val[NEON_G] = gray;
+        pixels.val[NEON_B] = gray;
+        vst4_u8((uint8_t*)(dst + x), pixels);
+    }
+    for (; x < width; ++x) {
+        dst[x] = SkPackARGB32(0xFF, src[x], src[x], src[x]);
+    }
+    return false;
+}
+
+bool Sample_RGB_D8888_neon(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                           int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(3 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x3_t rgb = vld3_u8(src);
+        uint8x8x4_t pixels;
+        pixels.val[NEON_A] = opaque_alpha();
+        pixels.val[NEON_R] = rgb.val[0];
+        pixels.val[NEON_G] = rgb.val[1];
+        pixels.val[NEON_B] = rgb.val[2];
+        vst4_u8((uint8_t*)(dst + x), pixels);
+        src += 8 * 3;
+    }
+    for (; x < width; ++x) {
+        dst[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        src += 3;
+    }
+    return false;
+}
+
+bool Sample_RGBx_D8888_neon(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t rgbx = vld4_u8(src);
+        uint8x8x4_t pixels;
+        pixels.val[NEON_A] = opaque_alpha();
+        pixels.val[NEON_R] = rgbx.val[0];
+        pixels.val[NEON_G] = rgbx.val[1];
+        pixels.val[NEON_B] = rgbx.val[2];
+        vst4_u8((uint8_t*)(dst + x), pixels);
+        src += 8 * 4;
+    }
+    for (; x < width; ++x) {
+        dst[x] = SkPackARGB32(0xFF, src[0], src[1], src[2]);
+        src += 4;
+    }
+    return false;
+}
+
+bool Sample_RGBA_D8888_neon(void* SK_RESTRICT dstRow, const uint8_t* SK_RESTRICT src,
+                            int width, int deltaSrc, int, const SkPMColor[]) {
+    SkASSERT(4 == deltaSrc);
+    SkPMColor* SK_RESTRICT dst = (SkPMColor*)dstRow;
+    uint8x8_t alphaAnd = opaque_alpha();
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x4_t rgba = vld4_u8(src);
+        const uint8x8_t alpha = rgba.val[3];
+        alphaAnd = vand_u8(alphaAnd, alpha);
+
+        uint8x8x4_t pixels;
+        pixels.val[NEON_A] = alpha;
+        pixels.val[NEON_R] = mul_div_255_round(rgba.val[0], alpha);
+        pixels.val[NEON_G] = mul_div_255_round(rgba.val[1], alpha);
+        pixels.val[NEON_B] = mul_div_255_round(rgba.val[2], alpha);
+        vst4_u8((uint8_t*)(dst + x), pixels);
+        src += 8 * 4;
+    }
+
+    uint8_t lanes[8];
+    vst1_u8(lanes, alphaAnd);
+    unsigned alphaMask = 0xFF;
+    for (int i = 0; i < 8; ++i) {
+        alphaMask &= lanes[i];
+    }
+    for (; x < width; ++x) {
+        unsigned alpha = src[3];
+        dst[x] = SkPreMultiplyARGB(alpha, src[0], src[1], src[2]);
+        src += 4;
+        alphaMask &= alpha;
+    }
+    return alphaMask != 0xFF;
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSpriteBlitter_opts_DEFINED
+#define SkSpriteBlitter_opts_DEFINED
+
+#include "SkTypes.h"
+
+/**
+ *  Copies count 32-bit pixels from src to dst with non-temporal stores, which
+ *  write around the cache. Used by the opaque sprite blitters for blits much
+ *  larger than the cache, whose destination would only evict everything else
+ *  on its way out to memory.
+ */
+typedef void (*SkStreamingCopy32Proc)(uint32_t* dst, const uint32_t* src, int count);
+
+// Returns NULL if there are no non-temporal stores to use.
+SkStreamingCopy32Proc SkSpriteBlitterGetPlatformStreamingCopy32Proc();
+
+// Streaming stores only pay off once the destination no longer fits in the cache.
+#ifndef SK_SPRITE_STREAMING_COPY_BYTES
+    #define SK_SPRITE_STREAMING_COPY_BYTES (2 << 20)
+#endif
+
+#endif
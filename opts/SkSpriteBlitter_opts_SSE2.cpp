@@ -0,0 +1,48 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSpriteBlitter_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+void SkStreamingCopy32_SSE2(uint32_t* dst, const uint32_t* src, int count) {
+    // Streaming stores need an aligned destination; the source is read unaligned.
+    while (count > 0 && (((size_t)dst) & 0x0F)) {
+        *dst++ = *src++;
+        --count;
+    }
+
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    // A whole cache line per iteration, so each line is written out in one go.
+    while (count >= 16) {
+        __m128i p0 = _mm_loadu_si128(s + 0);
+        __m128i p1 = _mm_loadu_si128(s + 1);
+        __m128i p2 = _mm_loadu_si128(s + 2);
+        __m128i p3 = _mm_loadu_si128(s + 3);
+        _mm_stream_si128(d + 0, p0);
+        _mm_stream_si128(d + 1, p1);
+        _mm_stream_si128(d + 2, p2);
+        _mm_stream_si128(d + 3, p3);
+        s += 4;
+        d += 4;
+        count -= 16;
+    }
+    while (count >= 4) {
+        _mm_stream_si128(d++, _mm_loadu_si128(s++));
+        count -= 4;
+    }
+
+    dst = reinterpret_cast<uint32_t*>(d);
+    src = reinterpret_cast<const uint32_t*>(s);
+    while (count > 0) {
+        *dst++ = *src++;
+        --count;
+    }
+    // Streaming stores are weakly ordered; make them visible before anyone reads the pixels.
+    _mm_sfence();
+}
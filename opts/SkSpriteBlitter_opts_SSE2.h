@@ -0,0 +1,15 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSpriteBlitter_opts_SSE2_DEFINED
+#define SkSpriteBlitter_opts_SSE2_DEFINED
+
+#include "SkSpriteBlitter_opts.h"
+
+void SkStreamingCopy32_SSE2(uint32_t* dst, const uint32_t* src, int count);
+
+#endif
@@ -0,0 +1,13 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSpriteBlitter_opts.h"
+
+// 32-bit ARM has no non-temporal stores, so the sprite blitters stay with memcpy.
+SkStreamingCopy32Proc SkSpriteBlitterGetPlatformStreamingCopy32Proc() {
+    return NULL;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkUtils_opts_AVX2.h"
+#include "SkUtils_opts_SSE2.h"
+
+/* As with the other AVX2 procs, these are only built for real when the compiler
+ * is given -mavx2; otherwise (Android framework builds) they forward to SSE2 and
+ * the runtime check never selects them anyway.
+ */
+#if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || defined(__AVX2__)
+
+#include <immintrin.h>
+
+// Stores 128 bytes of value_wide at a time to the 32-byte aligned d, returning
+// where it stopped. bytes is rounded down to a multiple of 128.
+static inline __m256i* store_wide(__m256i* d, __m256i value_wide, size_t bytes) {
+    for (size_t n = bytes >> 7; n > 0; --n) {
+        _mm256_store_si256(d    , value_wide);
+        _mm256_store_si256(d + 1, value_wide);
+        _mm256_store_si256(d + 2, value_wide);
+        _mm256_store_si256(d + 3, value_wide);
+        d += 4;
+    }
+    return d;
+}
+
+void sk_memset16_AVX2(uint16_t* dst, uint16_t value, int count) {
+    SkASSERT(dst != NULL && count >= 0);
+
+    // dst must be 2-byte aligned.
+    SkASSERT((((size_t) dst) & 0x01) == 0);
+
+    if (count >= 64) {
+        while (((size_t)dst) & 0x1F) {
+            *dst++ = value;
+            --count;
+        }
+        __m256i* d = reinterpret_cast<__m256i*>(dst);
+        d = store_wide(d, _mm256_set1_epi16(value), count * sizeof(uint16_t));
+        count &= 63;
+        dst = reinterpret_cast<uint16_t*>(d);
+    }
+    while (count > 0) {
+        *dst++ = value;
+        --count;
+    }
+}
+
+void sk_memset32_AVX2(uint32_t* dst, uint32_t value, int count) {
+    SkASSERT(dst != NULL && count >= 0);
+
+    // dst must be 4-byte aligned.
+    SkASSERT((((size_t) dst) & 0x03) == 0);
+
+    if (count >= 32) {
+        while (((size_t)dst) & 0x1F) {
+            *dst++ = value;
+            --count;
+        }
+        __m256i* d = reinterpret_cast<__m256i*>(dst);
+        d = store_wide(d, _mm256_set1_epi32(value), count * sizeof(uint32_t));
+        count &= 31;
+        dst = reinterpret_cast<uint32_t*>(d);
+    }
+    while (count > 0) {
+        *dst++ = value;
+        --count;
+    }
+}
+
+#else // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || defined(__AVX2__)
+
+void sk_memset16_AVX2(uint16_t* dst, uint16_t value, int count) {
+    sk_memset16_SSE2(dst, value, count);
+}
+
+void sk_memset32_AVX2(uint32_t* dst, uint32_t value, int count) {
+    sk_memset32_SSE2(dst, value, count);
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkColorPriv.h"
+#include "SkXfermode.h"
+#include "SkXfermode_opts_AVX2.h"
+#include "SkXfermode_proccoeff.h"
+
+#include <emmintrin.h>
+
+// Defined in SkXfermode_opts_SSE2.cpp. We hand these to the SSE2 base class.
+typedef __m128i (*SkXfermodeProcSIMD)(const __m128i& src, const __m128i& dst);
+extern SkXfermodeProcSIMD gSSE2XfermodeProcs[];
+
+#if !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || defined(__AVX2__)
+
+#include "SkColor_opts_AVX2.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// 8 pixels AVX2 version functions
+////////////////////////////////////////////////////////////////////////////////
+
+static __m256i srcover_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    return SkPMSrcOver_AVX2(src, dst);
+}
+
+static __m256i modulate_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i a = SkAlphaMulAlpha_AVX2(SkGetPackedA32_AVX2(src),
+                                     SkGetPackedA32_AVX2(dst));
+    __m256i r = SkAlphaMulAlpha_AVX2(SkGetPackedR32_AVX2(src),
+                                     SkGetPackedR32_AVX2(dst));
+    __m256i g = SkAlphaMulAlpha_AVX2(SkGetPackedG32_AVX2(src),
+                                     SkGetPackedG32_AVX2(dst));
+    __m256i b = SkAlphaMulAlpha_AVX2(SkGetPackedB32_AVX2(src),
+                                     SkGetPackedB32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+static inline __m256i srcover_byte_AVX2(const __m256i& a, const __m256i& b) {
+    // a + b - SkAlphaMulAlpha(a, b);
+    return _mm256_sub_epi32(_mm256_add_epi32(a, b), SkAlphaMulAlpha_AVX2(a, b));
+}
+
+static __m256i screen_modeproc_AVX2(const __m256i& src, const __m256i& dst) {
+    __m256i a = srcover_byte_AVX2(SkGetPackedA32_AVX2(src),
+                                  SkGetPackedA32_AVX2(dst));
+    __m256i r = srcover_byte_AVX2(SkGetPackedR32_AVX2(src),
+                                  SkGetPackedR32_AVX2(dst));
+    __m256i g = srcover_byte_AVX2(SkGetPackedG32_AVX2(src),
+                                  SkGetPackedG32_AVX2(dst));
+    __m256i b = srcover_byte_AVX2(SkGetPackedB32_AVX2(src),
+                                  SkGetPackedB32_AVX2(dst));
+    return SkPackARGB32_AVX2(a, r, g, b);
+}
+
+typedef __m256i (*SkXfermodeProcAVX2)(const __m256i& src, const __m256i& dst);
+
+void SkAVX2ProcCoeffXfermode::xfer32(SkPMColor dst[], const SkPMColor src[],
+                                     int count, const SkAlpha aa[]) const {
+    SkASSERT(dst && src && count >= 0);
+
+    if (NULL != aa || count < 8) {
+        this->INHERITED::xfer32(dst, src, count, aa);
+        return;
+    }
+
+    SkXfermodeProc proc = this->getProc();
+    SkXfermodeProcAVX2 procAVX2 = reinterpret_cast<SkXfermodeProcAVX2>(fProcAVX2);
+    SkASSERT(procAVX2 != NULL);
+
+    while (((size_t)dst & 0x1F) != 0) {
+        *dst = proc(*src, *dst);
+        dst++;
+        src++;
+        count--;
+    }
+
+    const __m256i* s = reinterpret_cast<const __m256i*>(src);
+    __m256i* d = reinterpret_cast<__m256i*>(dst);
+
+    while (count >= 8) {
+        __m256i src_pixel = _mm256_loadu_si256(s++);
+        __m256i dst_pixel = _mm256_load_si256(d);
+
+        dst_pixel = procAVX2(src_pixel, dst_pixel);
+        _mm256_store_si256(d++, dst_pixel);
+        count -= 8;
+    }
+
+    src = reinterpret_cast<const SkPMColor*>(s);
+    dst = reinterpret_cast<SkPMColor*>(d);
+
+    // Let the SSE2 path take care of the last few pixels.
+    this->INHERITED::xfer32(dst, src, count, NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void* avx2_proc_for(SkXfermode::Mode mode) {
+    switch (mode) {
+        case SkXfermode::kSrcOver_Mode:
+            return reinterpret_cast<void*>(srcover_modeproc_AVX2);
+        case SkXfermode::kModulate_Mode:
+            return reinterpret_cast<void*>(modulate_modeproc_AVX2);
+        case SkXfermode::kScreen_Mode:
+            return reinterpret_cast<void*>(screen_modeproc_AVX2);
+        default:
+            return NULL;
+    }
+}
+
+SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                         SkXfermode::Mode mode) {
+    void* procSSE2 = reinterpret_cast<void*>(gSSE2XfermodeProcs[mode]);
+    void* procAVX2 = avx2_proc_for(mode);
+
+    if (procSSE2 != NULL && procAVX2 != NULL) {
+        return SkNEW_ARGS(SkAVX2ProcCoeffXfermode, (rec, mode, procSSE2, procAVX2));
+    }
+    return NULL;
+}
+
+#else // !defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) || defined(__AVX2__)
+
+void SkAVX2ProcCoeffXfermode::xfer32(SkPMColor dst[], const SkPMColor src[],
+                                     int count, const SkAlpha aa[]) const {
+    this->INHERITED::xfer32(dst, src, count, aa);
+}
+
+SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                         SkXfermode::Mode mode) {
+    return NULL;
+}
+
+#endif
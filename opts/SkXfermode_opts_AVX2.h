@@ -0,0 +1,38 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkXfermode_opts_AVX2_DEFINED
+#define SkXfermode_opts_AVX2_DEFINED
+
+#include "SkTypes.h"
+#include "SkXfermode_opts_SSE2.h"
+
+/**
+ *  Processes 8 pixels at a time for the modes that have an AVX2 proc, and
+ *  leaves the leftovers, coverage and 565 paths to the SSE2 implementation.
+ *  It deliberately keeps the SSE2 factory, so it flattens and unflattens as an
+ *  SkSSE2ProcCoeffXfermode.
+ */
+class SkAVX2ProcCoeffXfermode : public SkSSE2ProcCoeffXfermode {
+public:
+    SkAVX2ProcCoeffXfermode(const ProcCoeff& rec, SkXfermode::Mode mode,
+                            void* procSSE2, void* procAVX2)
+        : INHERITED(rec, mode, procSSE2), fProcAVX2(procAVX2) {}
+
+    virtual void xfer32(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) const SK_OVERRIDE;
+
+private:
+    void* fProcAVX2;
+    typedef SkSSE2ProcCoeffXfermode INHERITED;
+};
+
+// Returns NULL if there is no AVX2 proc for mode.
+SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                         SkXfermode::Mode mode);
+
+#endif // SkXfermode_opts_AVX2_DEFINED
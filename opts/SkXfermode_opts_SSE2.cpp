@@ -635,6 +635,197 @@ static __m128i exclusion_modeproc_SSE2(const __m128i& src, const __m128i& dst) {
     return SkPackARGB32_SSE2(a, r, g, b);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Non-separable modes. These follow the portable versions step for step, with
+// one color component of each of the four pixels in the 32-bit lanes. SkMulDiv()
+// is done in doubles: they hold the products exactly, and the quotients are
+// close enough to truncate to the same integers.
+////////////////////////////////////////////////////////////////////////////////
+
+static inline __m128i SkMax32_SSE2(const __m128i& a, const __m128i& b) {
+    __m128i cmp = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(cmp, a), _mm_andnot_si128(cmp, b));
+}
+
+// Returns cond ? a : b, where each lane of cond is all ones or all zeros.
+static inline __m128i select_SSE2(const __m128i& cond, const __m128i& a, const __m128i& b) {
+    return _mm_or_si128(_mm_and_si128(cond, a), _mm_andnot_si128(cond, b));
+}
+
+static inline __m128d muldiv_pd_SSE2(const __m128i& a, const __m128i& b, const __m128i& c) {
+    return _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(a), _mm_cvtepi32_pd(b)), _mm_cvtepi32_pd(c));
+}
+
+// Portable version SkMulDiv() is in SkMath.h. Lanes where c is 0 return garbage.
+static inline __m128i SkMulDiv_SSE2(const __m128i& a, const __m128i& b, const __m128i& c) {
+    // Keep the ignored lanes from dividing by 0.
+    __m128i safeC = _mm_or_si128(c, _mm_and_si128(_mm_cmpeq_epi32(c, _mm_setzero_si128()),
+                                                  _mm_set1_epi32(1)));
+    __m128i lo = _mm_cvttpd_epi32(muldiv_pd_SSE2(a, b, safeC));
+    __m128i hi = _mm_cvttpd_epi32(muldiv_pd_SSE2(_mm_srli_si128(a, 8), _mm_srli_si128(b, 8),
+                                                 _mm_srli_si128(safeC, 8)));
+    return _mm_unpacklo_epi64(lo, hi);
+}
+
+// Portable version Lum() is in SkXfermode.cpp.
+static inline __m128i Lum_SSE2(const __m128i& r, const __m128i& g, const __m128i& b) {
+    __m128i sum = _mm_add_epi32(Multiply32_SSE2(r, _mm_set1_epi32(77)),
+                                Multiply32_SSE2(g, _mm_set1_epi32(150)));
+    sum = _mm_add_epi32(sum, Multiply32_SSE2(b, _mm_set1_epi32(28)));
+    return SkDiv255Round_SSE2(sum);
+}
+
+static inline __m128i minimum_SSE2(const __m128i& a, const __m128i& b, const __m128i& c) {
+    return SkMin32_SSE2(SkMin32_SSE2(a, b), c);
+}
+
+static inline __m128i maximum_SSE2(const __m128i& a, const __m128i& b, const __m128i& c) {
+    return SkMax32_SSE2(SkMax32_SSE2(a, b), c);
+}
+
+// Portable version Sat() is in SkXfermode.cpp.
+static inline __m128i Sat_SSE2(const __m128i& r, const __m128i& g, const __m128i& b) {
+    return _mm_sub_epi32(maximum_SSE2(r, g, b), minimum_SSE2(r, g, b));
+}
+
+// Portable version SetSat() is in SkXfermode.cpp. It sorts the components to
+// scale the middle one, but the same scale takes the smallest to 0 and the
+// largest to s, so all three can go through it.
+static inline void SetSat_SSE2(__m128i* r, __m128i* g, __m128i* b, const __m128i& s) {
+    __m128i mn = minimum_SSE2(*r, *g, *b);
+    __m128i mx = maximum_SSE2(*r, *g, *b);
+    __m128i range = _mm_sub_epi32(mx, mn);
+    __m128i hasRange = _mm_cmpgt_epi32(mx, mn);
+
+    *r = _mm_and_si128(hasRange, SkMulDiv_SSE2(_mm_sub_epi32(*r, mn), s, range));
+    *g = _mm_and_si128(hasRange, SkMulDiv_SSE2(_mm_sub_epi32(*g, mn), s, range));
+    *b = _mm_and_si128(hasRange, SkMulDiv_SSE2(_mm_sub_epi32(*b, mn), s, range));
+}
+
+// Portable version clipColor() is in SkXfermode.cpp.
+static inline void clipColor_SSE2(__m128i* r, __m128i* g, __m128i* b, const __m128i& a) {
+    __m128i L = Lum_SSE2(*r, *g, *b);
+    __m128i n = minimum_SSE2(*r, *g, *b);
+    __m128i x = maximum_SSE2(*r, *g, *b);
+
+    __m128i denom = _mm_sub_epi32(L, n);
+    __m128i cond = _mm_andnot_si128(_mm_cmpeq_epi32(denom, _mm_setzero_si128()),
+                                    _mm_cmplt_epi32(n, _mm_setzero_si128()));
+    *r = select_SSE2(cond, _mm_add_epi32(L, SkMulDiv_SSE2(_mm_sub_epi32(*r, L), L, denom)), *r);
+    *g = select_SSE2(cond, _mm_add_epi32(L, SkMulDiv_SSE2(_mm_sub_epi32(*g, L), L, denom)), *g);
+    *b = select_SSE2(cond, _mm_add_epi32(L, SkMulDiv_SSE2(_mm_sub_epi32(*b, L), L, denom)), *b);
+
+    denom = _mm_sub_epi32(x, L);
+    cond = _mm_andnot_si128(_mm_cmpeq_epi32(denom, _mm_setzero_si128()),
+                            _mm_cmpgt_epi32(x, a));
+    __m128i numer = _mm_sub_epi32(a, L);
+    *r = select_SSE2(cond, _mm_add_epi32(L, SkMulDiv_SSE2(_mm_sub_epi32(*r, L), numer, denom)),
+                     *r);
+    *g = select_SSE2(cond, _mm_add_epi32(L, SkMulDiv_SSE2(_mm_sub_epi32(*g, L), numer, denom)),
+                     *g);
+    *b = select_SSE2(cond, _mm_add_epi32(L, SkMulDiv_SSE2(_mm_sub_epi32(*b, L), numer, denom)),
+                     *b);
+}
+
+// Portable version SetLum() is in SkXfermode.cpp.
+static inline void SetLum_SSE2(__m128i* r, __m128i* g, __m128i* b,
+                               const __m128i& a, const __m128i& l) {
+    __m128i d = _mm_sub_epi32(l, Lum_SSE2(*r, *g, *b));
+    *r = _mm_add_epi32(*r, d);
+    *g = _mm_add_epi32(*g, d);
+    *b = _mm_add_epi32(*b, d);
+
+    clipColor_SSE2(r, g, b, a);
+}
+
+// Portable version blendfunc_nonsep_byte() is in SkXfermode.cpp.
+static inline __m128i blendfunc_nonsep_byte_SSE2(const __m128i& sc, const __m128i& dc,
+                                                 const __m128i& sa, const __m128i& da,
+                                                 const __m128i& blendval) {
+    __m128i ida = _mm_sub_epi32(_mm_set1_epi32(255), da);
+    __m128i isa = _mm_sub_epi32(_mm_set1_epi32(255), sa);
+    __m128i prod = _mm_add_epi32(_mm_mullo_epi16(sc, ida), _mm_mullo_epi16(dc, isa));
+    return clamp_div255round_SSE2(_mm_add_epi32(prod, blendval));
+}
+
+// The non-separable modes only blend where both alphas are non-zero.
+static inline __m128i both_alphas_SSE2(const __m128i& sa, const __m128i& da) {
+    __m128i zero = _mm_setzero_si128();
+    return _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi32(sa, zero), _mm_cmpeq_epi32(da, zero)),
+                            _mm_set1_epi32(-1));
+}
+
+enum NonSeparableMode {
+    kHue_NonSeparableMode,
+    kSaturation_NonSeparableMode,
+    kColor_NonSeparableMode,
+    kLuminosity_NonSeparableMode
+};
+
+// The four modes differ only in which of src and dst give the hue, saturation
+// and luminosity, so they share one body that the compiler specializes.
+template <NonSeparableMode kMode>
+static __m128i nonseparable_modeproc_SSE2(const __m128i& src, const __m128i& dst) {
+    __m128i sr = SkGetPackedR32_SSE2(src);
+    __m128i sg = SkGetPackedG32_SSE2(src);
+    __m128i sb = SkGetPackedB32_SSE2(src);
+    __m128i sa = SkGetPackedA32_SSE2(src);
+
+    __m128i dr = SkGetPackedR32_SSE2(dst);
+    __m128i dg = SkGetPackedG32_SSE2(dst);
+    __m128i db = SkGetPackedB32_SSE2(dst);
+    __m128i da = SkGetPackedA32_SSE2(dst);
+
+    __m128i Br, Bg, Bb;
+    switch (kMode) {
+        case kHue_NonSeparableMode:
+            // SetLum(SetSat(S, Sat(D)), Lum(D))
+            Br = _mm_mullo_epi16(sr, sa);
+            Bg = _mm_mullo_epi16(sg, sa);
+            Bb = _mm_mullo_epi16(sb, sa);
+            SetSat_SSE2(&Br, &Bg, &Bb, _mm_mullo_epi16(Sat_SSE2(dr, dg, db), sa));
+            SetLum_SSE2(&Br, &Bg, &Bb, _mm_mullo_epi16(sa, da),
+                        _mm_mullo_epi16(Lum_SSE2(dr, dg, db), sa));
+            break;
+        case kSaturation_NonSeparableMode:
+            // SetLum(SetSat(D, Sat(S)), Lum(D))
+            Br = _mm_mullo_epi16(dr, sa);
+            Bg = _mm_mullo_epi16(dg, sa);
+            Bb = _mm_mullo_epi16(db, sa);
+            SetSat_SSE2(&Br, &Bg, &Bb, _mm_mullo_epi16(Sat_SSE2(sr, sg, sb), da));
+            SetLum_SSE2(&Br, &Bg, &Bb, _mm_mullo_epi16(sa, da),
+                        _mm_mullo_epi16(Lum_SSE2(dr, dg, db), sa));
+            break;
+        case kColor_NonSeparableMode:
+            // SetLum(S, Lum(D))
+            Br = _mm_mullo_epi16(sr, da);
+            Bg = _mm_mullo_epi16(sg, da);
+            Bb = _mm_mullo_epi16(sb, da);
+            SetLum_SSE2(&Br, &Bg, &Bb, _mm_mullo_epi16(sa, da),
+                        _mm_mullo_epi16(Lum_SSE2(dr, dg, db), sa));
+            break;
+        case kLuminosity_NonSeparableMode:
+            // SetLum(D, Lum(S))
+            Br = _mm_mullo_epi16(dr, sa);
+            Bg = _mm_mullo_epi16(dg, sa);
+            Bb = _mm_mullo_epi16(db, sa);
+            SetLum_SSE2(&Br, &Bg, &Bb, _mm_mullo_epi16(sa, da),
+                        _mm_mullo_epi16(Lum_SSE2(sr, sg, sb), da));
+            break;
+    }
+
+    __m128i blend = both_alphas_SSE2(sa, da);
+    Br = _mm_and_si128(blend, Br);
+    Bg = _mm_and_si128(blend, Bg);
+    Bb = _mm_and_si128(blend, Bb);
+
+    __m128i a = srcover_byte_SSE2(sa, da);
+    __m128i r = blendfunc_nonsep_byte_SSE2(sr, dr, sa, da, Br);
+    __m128i g = blendfunc_nonsep_byte_SSE2(sg, dg, sa, da, Bg);
+    __m128i b = blendfunc_nonsep_byte_SSE2(sb, db, sa, da, Bb);
+    return SkPackARGB32_SSE2(a, r, g, b);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 typedef __m128i (*SkXfermodeProcSIMD)(const __m128i& src, const __m128i& dst);
@@ -801,10 +992,10 @@ SkXfermodeProcSIMD gSSE2XfermodeProcs[] = {
     exclusion_modeproc_SSE2,
     multiply_modeproc_SSE2,
 
-    NULL, // kHue_Mode
-    NULL, // kSaturation_Mode
-    NULL, // kColor_Mode
-    NULL, // kLuminosity_Mode
+    nonseparable_modeproc_SSE2<kHue_NonSeparableMode>,
+    nonseparable_modeproc_SSE2<kSaturation_NonSeparableMode>,
+    nonseparable_modeproc_SSE2<kColor_NonSeparableMode>,
+    nonseparable_modeproc_SSE2<kLuminosity_NonSeparableMode>,
 };
 
 SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_SSE2(const ProcCoeff& rec,
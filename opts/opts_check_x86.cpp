@@ -11,24 +11,40 @@
 #include "SkBlitMask.h"
 #include "SkBlitRect_opts_SSE2.h"
 #include "SkBlitRow.h"
+#include "SkBlitRow_opts_AVX2.h"
 #include "SkBlitRow_opts_SSE2.h"
 #include "SkBlurImage_opts_SSE2.h"
+#include "SkBlurMask_opts_SSE2.h"
+#include "SkColorMatrixFilter_opts_SSE2.h"
+#include "SkConfig8888_opts_SSSE3.h"
+#include "SkDistanceField_opts_SSE2.h"
+#include "SkGradientShader_opts_SSE2.h"
+#include "SkLighting_opts_SSE2.h"
+#include "SkMatrix_opts_SSE2.h"
+#include "SkMipMap_opts_SSE2.h"
 #include "SkMorphology_opts.h"
 #include "SkMorphology_opts_SSE2.h"
 #include "SkRTConf.h"
+#include "SkScaledBitmapSampler_opts_SSSE3.h"
+#include "SkSpriteBlitter_opts_SSE2.h"
 #include "SkUtils.h"
+#include "SkUtils_opts_AVX2.h"
 #include "SkUtils_opts_SSE2.h"
 #include "SkXfermode.h"
 #include "SkXfermode_proccoeff.h"
 
-#if defined(_MSC_VER) && defined(_WIN64)
+#if defined(_MSC_VER) && (defined(_WIN64) || _MSC_VER >= 1600)
 #include <intrin.h>
 #endif
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219
+#include <immintrin.h>  // _xgetbv
+#endif
 
 /* This file must *not* be compiled with -msse or -msse2, otherwise
    gcc may generate sse2 even for scalar ops (and thus give an invalid
    instruction on Pentium3 on the code below).  Only files named *_SSE2.cpp
-   in this directory should be compiled with -msse2. */
+   in this directory should be compiled with -msse2 (and likewise *_SSSE3.cpp
+   with -mssse3 and *_AVX2.cpp with -mavx2). */
 
 
 /* Function to get the CPU SSE-level in runtime, for different compilers. */
@@ -72,6 +88,63 @@ static inline void getcpuid(int info_type, int info[4]) {
 #endif
 #endif
 
+/* Like getcpuid(), but for the leaves (such as 7) that take a sub-leaf in ecx. */
+#ifdef _MSC_VER
+static inline void getcpuid_count(int info_type, int sub_type, int info[4]) {
+#if defined(_WIN64) || _MSC_VER >= 1600
+    __cpuidex(info, info_type, sub_type);
+#else
+    __asm {
+        mov    eax, [info_type]
+        mov    ecx, [sub_type]
+        cpuid
+        mov    edi, [info]
+        mov    [edi], eax
+        mov    [edi+4], ebx
+        mov    [edi+8], ecx
+        mov    [edi+12], edx
+    }
+#endif
+}
+
+static inline uint64_t getxcr0() {
+#if _MSC_FULL_VER >= 160040219
+    return _xgetbv(0);
+#else
+    return 0;
+#endif
+}
+#else
+#if defined(__x86_64__)
+static inline void getcpuid_count(int info_type, int sub_type, int info[4]) {
+    asm volatile (
+        "cpuid \n\t"
+        : "=a"(info[0]), "=b"(info[1]), "=c"(info[2]), "=d"(info[3])
+        : "a"(info_type), "c"(sub_type)
+    );
+}
+#else
+static inline void getcpuid_count(int info_type, int sub_type, int info[4]) {
+    // We save and restore ebx, so this code can be compatible with -fPIC
+    asm volatile (
+        "pushl %%ebx      \n\t"
+        "cpuid            \n\t"
+        "movl %%ebx, %1   \n\t"
+        "popl %%ebx       \n\t"
+        : "=a"(info[0]), "=r"(info[1]), "=c"(info[2]), "=d"(info[3])
+        : "a"(info_type), "c"(sub_type)
+    );
+}
+#endif
+
+static inline uint64_t getxcr0() {
+    uint32_t eax, edx;
+    // xgetbv, spelled out for assemblers that don't know the mnemonic.
+    asm volatile (".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #if defined(__x86_64__) || defined(_WIN64) || SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
@@ -112,14 +185,65 @@ static inline bool hasSSSE3() {
 }
 #endif
 
+#if defined(SK_BUILD_FOR_ANDROID_FRAMEWORK) && !defined(__AVX2__)
+/* As with SSSE3, the Android framework may build the AVX2 files without -mavx2,
+ * in which case they only contain stubs.
+ */
+static inline bool hasAVX2() {
+    return false;
+}
+#else
+
+static inline bool hasAVX2() {
+    int cpu_info[4] = { 0 };
+    getcpuid(0, cpu_info);
+    if (cpu_info[0] < 7) {
+        return false;
+    }
+
+    // The OS has to save and restore the ymm registers (OSXSAVE, and XCR0 bits 1 and 2),
+    // and the cpu has to support AVX as well as AVX2.
+    getcpuid(1, cpu_info);
+    const int kOSXSAVE = 1 << 27;
+    const int kAVX = 1 << 28;
+    if ((cpu_info[2] & (kOSXSAVE | kAVX)) != (kOSXSAVE | kAVX)) {
+        return false;
+    }
+    if ((getxcr0() & 0x6) != 0x6) {
+        return false;
+    }
+
+    getcpuid_count(7, 0, cpu_info);
+    return (cpu_info[1] & (1 << 5)) != 0;
+}
+#endif
+
+/* Lets a benchmark or test compare each instruction set's version of a proc against the
+   portable one in the same binary: procs asked for while the level is capped come from the
+   capped set. In builds without SK_DEVELOPER the cap is a constant and costs nothing. Callers
+   that keep a proc for the life of the process (such as the memset procs) only see the level
+   in force when they first asked. */
+enum {
+    kPortable_OptsLevel,
+    kSSE2_OptsLevel,
+    kSSSE3_OptsLevel,
+    kAVX2_OptsLevel,
+};
+SK_CONF_DECLARE( int, c_opts_max_level, "opts.x86.maxLevel", kAVX2_OptsLevel, "Highest x86 instruction set opts procs may use: 0 portable, 1 SSE2, 2 SSSE3, 3 AVX2");
+
 static bool cachedHasSSE2() {
     static bool gHasSSE2 = hasSSE2();
-    return gHasSSE2;
+    return gHasSSE2 && c_opts_max_level >= kSSE2_OptsLevel;
 }
 
 static bool cachedHasSSSE3() {
     static bool gHasSSSE3 = hasSSSE3();
-    return gHasSSSE3;
+    return gHasSSSE3 && c_opts_max_level >= kSSSE3_OptsLevel;
+}
+
+static bool cachedHasAVX2() {
+    static bool gHasAVX2 = hasAVX2();
+    return gHasAVX2 && c_opts_max_level >= kAVX2_OptsLevel;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -181,6 +305,10 @@ void SkBitmapProcState::platformProcs() {
         fMatrixProc = ClampX_ClampY_filter_affine_SSE2;
     } else if (fMatrixProc == ClampX_ClampY_nofilter_affine) {
         fMatrixProc = ClampX_ClampY_nofilter_affine_SSE2;
+    } else if (fMatrixProc == ClampX_ClampY_filter_persp) {
+        fMatrixProc = ClampX_ClampY_filter_persp_SSE2;
+    } else if (fMatrixProc == ClampX_ClampY_nofilter_persp) {
+        fMatrixProc = ClampX_ClampY_nofilter_persp_SSE2;
     }
 
     /* Check fShaderProc32 */
@@ -195,13 +323,13 @@ void SkBitmapProcState::platformProcs() {
 
 static SkBlitRow::Proc platform_16_procs[] = {
     S32_D565_Opaque_SSE2,               // S32_D565_Opaque
-    NULL,                               // S32_D565_Blend
+    S32_D565_Blend_SSE2,                // S32_D565_Blend
     S32A_D565_Opaque_SSE2,              // S32A_D565_Opaque
-    NULL,                               // S32A_D565_Blend
+    S32A_D565_Blend_SSE2,               // S32A_D565_Blend
     S32_D565_Opaque_Dither_SSE2,        // S32_D565_Opaque_Dither
-    NULL,                               // S32_D565_Blend_Dither
+    S32_D565_Blend_Dither_SSE2,         // S32_D565_Blend_Dither
     S32A_D565_Opaque_Dither_SSE2,       // S32A_D565_Opaque_Dither
-    NULL,                               // S32A_D565_Blend_Dither
+    S32A_D565_Blend_Dither_SSE2,        // S32A_D565_Blend_Dither
 };
 
 SkBlitRow::Proc SkBlitRow::PlatformProcs565(unsigned flags) {
@@ -219,8 +347,17 @@ static SkBlitRow::Proc32 platform_32_procs[] = {
     S32A_Blend_BlitRow32_SSE2,          // S32A_Blend,
 };
 
+static SkBlitRow::Proc32 platform_32_procs_AVX2[] = {
+    NULL,                               // S32_Opaque,
+    S32_Blend_BlitRow32_SSE2,           // S32_Blend,
+    S32A_Opaque_BlitRow32_AVX2,         // S32A_Opaque
+    S32A_Blend_BlitRow32_AVX2,          // S32A_Blend,
+};
+
 SkBlitRow::Proc32 SkBlitRow::PlatformProcs32(unsigned flags) {
-    if (cachedHasSSE2()) {
+    if (cachedHasAVX2()) {
+        return platform_32_procs_AVX2[flags];
+    } else if (cachedHasSSE2()) {
         return platform_32_procs[flags];
     } else {
         return NULL;
@@ -228,7 +365,9 @@ SkBlitRow::Proc32 SkBlitRow::PlatformProcs32(unsigned flags) {
 }
 
 SkBlitRow::ColorProc SkBlitRow::PlatformColorProc() {
-    if (cachedHasSSE2()) {
+    if (cachedHasAVX2()) {
+        return Color32_AVX2;
+    } else if (cachedHasSSE2()) {
         return Color32_SSE2;
     } else {
         return NULL;
@@ -290,13 +429,24 @@ SkBlitMask::BlitLCD16RowProc SkBlitMask::PlatformBlitRowProcs16(bool isOpaque) {
 SkBlitMask::RowProc SkBlitMask::PlatformRowProcs(SkBitmap::Config dstConfig,
                                                  SkMask::Format maskFormat,
                                                  RowFlags flags) {
+    // LCD16 masks under a shader, e.g. subpixel text drawn with a gradient.
+    if (cachedHasSSE2() && SkBitmap::kARGB_8888_Config == dstConfig &&
+            SkMask::kLCD16_Format == maskFormat) {
+        if (flags & kSrcIsOpaque_RowFlag) {
+            return (RowProc)SkLCD16_RowProc_Opaque_SSE2;
+        } else {
+            return (RowProc)SkLCD16_RowProc_Blend_SSE2;
+        }
+    }
     return NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 SkMemset16Proc SkMemset16GetPlatformProc() {
-    if (cachedHasSSE2()) {
+    if (cachedHasAVX2()) {
+        return sk_memset16_AVX2;
+    } else if (cachedHasSSE2()) {
         return sk_memset16_SSE2;
     } else {
         return NULL;
@@ -304,7 +454,9 @@ SkMemset16Proc SkMemset16GetPlatformProc() {
 }
 
 SkMemset32Proc SkMemset32GetPlatformProc() {
-    if (cachedHasSSE2()) {
+    if (cachedHasAVX2()) {
+        return sk_memset32_AVX2;
+    } else if (cachedHasSSE2()) {
         return sk_memset32_SSE2;
     } else {
         return NULL;
@@ -349,8 +501,119 @@ bool SkBoxBlurGetPlatformProcs(SkBoxBlurProc* boxBlurX,
 
 ////////////////////////////////////////////////////////////////////////////////
 
+bool SkBlurMaskGetPlatformProcs(SkBlurMaskProcs* procs) {
+    if (!cachedHasSSE2()) {
+        return false;
+    }
+    procs->fBoxBlur = SkBoxBlurA8_SSE2;
+    procs->fBoxBlurInterp = SkBoxBlurInterpA8_SSE2;
+    procs->fTranspose = SkTransposeA8_SSE2;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkMipMap::Downsample32Proc SkMipMap::PlatformDownsample32Proc() {
+    if (!cachedHasSSE2()) {
+        return NULL;
+    }
+    return SkDownsample32_SSE2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkColorMatrixSpanProc SkColorMatrixGetPlatformSpanProc() {
+    if (!cachedHasSSE2()) {
+        return NULL;
+    }
+    return SkColorMatrixSpan_SSE2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkLightingInteriorNormalsProc SkLightingGetPlatformInteriorNormalsProc() {
+    if (!cachedHasSSE2()) {
+        return NULL;
+    }
+    return SkLightingInteriorNormals_SSE2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkDistanceFieldRowProc SkDistanceFieldGetPlatformRowProc() {
+    if (!cachedHasSSE2()) {
+        return NULL;
+    }
+    return SkDistanceFieldRow_SSE2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SkStreamingCopy32Proc SkSpriteBlitterGetPlatformStreamingCopy32Proc() {
+    if (!cachedHasSSE2()) {
+        return NULL;
+    }
+    return SkStreamingCopy32_SSE2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SkMatrixGetPlatformMapPtsProcs(SkMatrixMapPtsProcs* procs) {
+    if (!cachedHasSSE2()) {
+        return false;
+    }
+    procs->fScaleTrans = SkMatrixScaleTrans_pts_SSE2;
+    procs->fAffine = SkMatrixAffine_pts_SSE2;
+    procs->fPersp = SkMatrixPersp_pts_SSE2;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SkGradientGetPlatformSpanProcs(SkGradientSpanProcs* procs) {
+    if (!cachedHasSSE2()) {
+        return false;
+    }
+    procs->fLinear = SkLinearGradientSpan_SSE2;
+    procs->fLinearRepeat = SkLinearGradientSpanRepeat_SSE2;
+    procs->fLinearMirror = SkLinearGradientSpanMirror_SSE2;
+    procs->fRadialClamp = SkRadialGradientSpanClamp_SSE2;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SkScaledBitmapSamplerGetPlatformProcs(SkScaledBitmapSamplerProcs* procs) {
+    if (!cachedHasSSSE3()) {
+        return false;
+    }
+    procs->fGray_D8888 = Sample_Gray_D8888_SSSE3;
+    procs->fRGB_D8888 = Sample_RGB_D8888_SSSE3;
+    procs->fRGBx_D8888 = Sample_RGBx_D8888_SSSE3;
+    procs->fRGBA_D8888 = Sample_RGBA_D8888_SSSE3;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SkConfig8888GetPlatformProcs(SkConfig8888Procs* procs) {
+    if (!cachedHasSSSE3()) {
+        return false;
+    }
+    procs->fSwapRB = Convert32_SwapRB_SSSE3;
+    procs->fPremul = Convert32_Premul_SSSE3;
+    procs->fPremulSwapRB = Convert32_PremulSwapRB_SSSE3;
+    procs->fUnpremul = Convert32_Unpremul_SSSE3;
+    procs->fUnpremulSwapRB = Convert32_UnpremulSwapRB_SSSE3;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 extern SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_SSE2(const ProcCoeff& rec,
                                                                 SkXfermode::Mode mode);
+extern SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl_AVX2(const ProcCoeff& rec,
+                                                                SkXfermode::Mode mode);
 
 SkProcCoeffXfermode* SkPlatformXfermodeFactory_impl(const ProcCoeff& rec,
                                                     SkXfermode::Mode mode);
@@ -365,6 +628,13 @@ SkProcCoeffXfermode* SkPlatformXfermodeFactory(const ProcCoeff& rec,
 
 SkProcCoeffXfermode* SkPlatformXfermodeFactory(const ProcCoeff& rec,
                                                SkXfermode::Mode mode) {
+    if (cachedHasAVX2()) {
+        // Modes without an AVX2 proc fall back to SSE2.
+        SkProcCoeffXfermode* xfermode = SkPlatformXfermodeFactory_impl_AVX2(rec, mode);
+        if (NULL != xfermode) {
+            return xfermode;
+        }
+    }
     if (cachedHasSSE2()) {
         return SkPlatformXfermodeFactory_impl_SSE2(rec, mode);
     } else {
@@ -6,6 +6,11 @@
  */
 #include "SkAddIntersections.h"
 #include "SkPathOpsBounds.h"
+#include "SkRTConf.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
+#include "SkThread.h"
+#include "SkThreadUtils.h"
 
 #if DEBUG_ADD_INTERSECTING_TS
 
@@ -174,236 +179,489 @@ static void debugShowCubicIntersection(int , const SkIntersectionHelper& ,
 }
 #endif
 
-bool AddIntersectTs(SkOpContour* test, SkOpContour* next) {
-    if (test != next) {
-        if (AlmostLessUlps(test->bounds().fBottom, next->bounds().fTop)) {
-            return false;
-        }
-        // OPTIMIZATION: outset contour bounds a smidgen instead?
-        if (!SkPathOpsBounds::Intersects(test->bounds(), next->bounds())) {
-            return true;
-        }
-    }
-    SkIntersectionHelper wt;
-    wt.init(test);
-    bool foundCommonContour = test == next;
-    do {
-        SkIntersectionHelper wn;
-        wn.init(next);
-        if (test == next && !wn.startAfter(wt)) {
-            continue;
-        }
-        do {
-            if (!SkPathOpsBounds::Intersects(wt.bounds(), wn.bounds())) {
-                continue;
+SK_CONF_DECLARE(int, c_pathOpsThreadCount, "pathops.threadCount", 1,
+                "Number of threads that look for the intersections of segment pairs.");
+
+// Finds where one pair of segments intersect. Only reads the segments, so
+// several pairs can be intersected at once.
+static int intersect_segments(const SkIntersectionHelper& wt, const SkIntersectionHelper& wn,
+                              SkIntersections* intersections, bool* swapPtr) {
+    SkIntersections& ts = *intersections;
+    int pts = 0;
+    bool swap = false;
+    switch (wt.segmentType()) {
+        case SkIntersectionHelper::kHorizontalLine_Segment:
+            swap = true;
+            switch (wn.segmentType()) {
+                case SkIntersectionHelper::kHorizontalLine_Segment:
+                case SkIntersectionHelper::kVerticalLine_Segment:
+                case SkIntersectionHelper::kLine_Segment: {
+                    pts = ts.lineHorizontal(wn.pts(), wt.left(),
+                            wt.right(), wt.y(), wt.xFlipped());
+                    debugShowLineIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kQuad_Segment: {
+                    pts = ts.quadHorizontal(wn.pts(), wt.left(),
+                            wt.right(), wt.y(), wt.xFlipped());
+                    debugShowQuadLineIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kCubic_Segment: {
+                    pts = ts.cubicHorizontal(wn.pts(), wt.left(),
+                            wt.right(), wt.y(), wt.xFlipped());
+                    debugShowCubicLineIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                default:
+                    SkASSERT(0);
+            }
+            break;
+        case SkIntersectionHelper::kVerticalLine_Segment:
+            swap = true;
+            switch (wn.segmentType()) {
+                case SkIntersectionHelper::kHorizontalLine_Segment:
+                case SkIntersectionHelper::kVerticalLine_Segment:
+                case SkIntersectionHelper::kLine_Segment: {
+                    pts = ts.lineVertical(wn.pts(), wt.top(),
+                            wt.bottom(), wt.x(), wt.yFlipped());
+                    debugShowLineIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kQuad_Segment: {
+                    pts = ts.quadVertical(wn.pts(), wt.top(),
+                            wt.bottom(), wt.x(), wt.yFlipped());
+                    debugShowQuadLineIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kCubic_Segment: {
+                    pts = ts.cubicVertical(wn.pts(), wt.top(),
+                            wt.bottom(), wt.x(), wt.yFlipped());
+                    debugShowCubicLineIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                default:
+                    SkASSERT(0);
             }
-            int pts = 0;
-            SkIntersections ts;
-            bool swap = false;
-            switch (wt.segmentType()) {
+            break;
+        case SkIntersectionHelper::kLine_Segment:
+            switch (wn.segmentType()) {
                 case SkIntersectionHelper::kHorizontalLine_Segment:
+                    pts = ts.lineHorizontal(wt.pts(), wn.left(),
+                            wn.right(), wn.y(), wn.xFlipped());
+                    debugShowLineIntersection(pts, wt, wn, ts);
+                    break;
+                case SkIntersectionHelper::kVerticalLine_Segment:
+                    pts = ts.lineVertical(wt.pts(), wn.top(),
+                            wn.bottom(), wn.x(), wn.yFlipped());
+                    debugShowLineIntersection(pts, wt, wn, ts);
+                    break;
+                case SkIntersectionHelper::kLine_Segment: {
+                    pts = ts.lineLine(wt.pts(), wn.pts());
+                    debugShowLineIntersection(pts, wt, wn, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kQuad_Segment: {
                     swap = true;
-                    switch (wn.segmentType()) {
-                        case SkIntersectionHelper::kHorizontalLine_Segment:
-                        case SkIntersectionHelper::kVerticalLine_Segment:
-                        case SkIntersectionHelper::kLine_Segment: {
-                            pts = ts.lineHorizontal(wn.pts(), wt.left(),
-                                    wt.right(), wt.y(), wt.xFlipped());
-                            debugShowLineIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kQuad_Segment: {
-                            pts = ts.quadHorizontal(wn.pts(), wt.left(),
-                                    wt.right(), wt.y(), wt.xFlipped());
-                            debugShowQuadLineIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kCubic_Segment: {
-                            pts = ts.cubicHorizontal(wn.pts(), wt.left(),
-                                    wt.right(), wt.y(), wt.xFlipped());
-                            debugShowCubicLineIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        default:
-                            SkASSERT(0);
-                    }
+                    pts = ts.quadLine(wn.pts(), wt.pts());
+                    debugShowQuadLineIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kCubic_Segment: {
+                    swap = true;
+                    pts = ts.cubicLine(wn.pts(), wt.pts());
+                    debugShowCubicLineIntersection(pts, wn, wt,  ts);
+                    break;
+                }
+                default:
+                    SkASSERT(0);
+            }
+            break;
+        case SkIntersectionHelper::kQuad_Segment:
+            switch (wn.segmentType()) {
+                case SkIntersectionHelper::kHorizontalLine_Segment:
+                    pts = ts.quadHorizontal(wt.pts(), wn.left(),
+                            wn.right(), wn.y(), wn.xFlipped());
+                    debugShowQuadLineIntersection(pts, wt, wn, ts);
                     break;
                 case SkIntersectionHelper::kVerticalLine_Segment:
+                    pts = ts.quadVertical(wt.pts(), wn.top(),
+                            wn.bottom(), wn.x(), wn.yFlipped());
+                    debugShowQuadLineIntersection(pts, wt, wn, ts);
+                    break;
+                case SkIntersectionHelper::kLine_Segment: {
+                    pts = ts.quadLine(wt.pts(), wn.pts());
+                    debugShowQuadLineIntersection(pts, wt, wn, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kQuad_Segment: {
+                    pts = ts.quadQuad(wt.pts(), wn.pts());
+                    debugShowQuadIntersection(pts, wt, wn, ts);
+                    break;
+                }
+                case SkIntersectionHelper::kCubic_Segment: {
                     swap = true;
-                    switch (wn.segmentType()) {
-                        case SkIntersectionHelper::kHorizontalLine_Segment:
-                        case SkIntersectionHelper::kVerticalLine_Segment:
-                        case SkIntersectionHelper::kLine_Segment: {
-                            pts = ts.lineVertical(wn.pts(), wt.top(),
-                                    wt.bottom(), wt.x(), wt.yFlipped());
-                            debugShowLineIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kQuad_Segment: {
-                            pts = ts.quadVertical(wn.pts(), wt.top(),
-                                    wt.bottom(), wt.x(), wt.yFlipped());
-                            debugShowQuadLineIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kCubic_Segment: {
-                            pts = ts.cubicVertical(wn.pts(), wt.top(),
-                                    wt.bottom(), wt.x(), wt.yFlipped());
-                            debugShowCubicLineIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        default:
-                            SkASSERT(0);
-                    }
+                    pts = ts.cubicQuad(wn.pts(), wt.pts());
+                    debugShowCubicQuadIntersection(pts, wn, wt, ts);
+                    break;
+                }
+                default:
+                    SkASSERT(0);
+            }
+            break;
+        case SkIntersectionHelper::kCubic_Segment:
+            switch (wn.segmentType()) {
+                case SkIntersectionHelper::kHorizontalLine_Segment:
+                    pts = ts.cubicHorizontal(wt.pts(), wn.left(),
+                            wn.right(), wn.y(), wn.xFlipped());
+                    debugShowCubicLineIntersection(pts, wt, wn, ts);
                     break;
-                case SkIntersectionHelper::kLine_Segment:
-                    switch (wn.segmentType()) {
-                        case SkIntersectionHelper::kHorizontalLine_Segment:
-                            pts = ts.lineHorizontal(wt.pts(), wn.left(),
-                                    wn.right(), wn.y(), wn.xFlipped());
-                            debugShowLineIntersection(pts, wt, wn, ts);
-                            break;
-                        case SkIntersectionHelper::kVerticalLine_Segment:
-                            pts = ts.lineVertical(wt.pts(), wn.top(),
-                                    wn.bottom(), wn.x(), wn.yFlipped());
-                            debugShowLineIntersection(pts, wt, wn, ts);
-                            break;
-                        case SkIntersectionHelper::kLine_Segment: {
-                            pts = ts.lineLine(wt.pts(), wn.pts());
-                            debugShowLineIntersection(pts, wt, wn, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kQuad_Segment: {
-                            swap = true;
-                            pts = ts.quadLine(wn.pts(), wt.pts());
-                            debugShowQuadLineIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kCubic_Segment: {
-                            swap = true;
-                            pts = ts.cubicLine(wn.pts(), wt.pts());
-                            debugShowCubicLineIntersection(pts, wn, wt,  ts);
-                            break;
-                        }
-                        default:
-                            SkASSERT(0);
-                    }
+                case SkIntersectionHelper::kVerticalLine_Segment:
+                    pts = ts.cubicVertical(wt.pts(), wn.top(),
+                            wn.bottom(), wn.x(), wn.yFlipped());
+                    debugShowCubicLineIntersection(pts, wt, wn, ts);
                     break;
-                case SkIntersectionHelper::kQuad_Segment:
-                    switch (wn.segmentType()) {
-                        case SkIntersectionHelper::kHorizontalLine_Segment:
-                            pts = ts.quadHorizontal(wt.pts(), wn.left(),
-                                    wn.right(), wn.y(), wn.xFlipped());
-                            debugShowQuadLineIntersection(pts, wt, wn, ts);
-                            break;
-                        case SkIntersectionHelper::kVerticalLine_Segment:
-                            pts = ts.quadVertical(wt.pts(), wn.top(),
-                                    wn.bottom(), wn.x(), wn.yFlipped());
-                            debugShowQuadLineIntersection(pts, wt, wn, ts);
-                            break;
-                        case SkIntersectionHelper::kLine_Segment: {
-                            pts = ts.quadLine(wt.pts(), wn.pts());
-                            debugShowQuadLineIntersection(pts, wt, wn, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kQuad_Segment: {
-                            pts = ts.quadQuad(wt.pts(), wn.pts());
-                            debugShowQuadIntersection(pts, wt, wn, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kCubic_Segment: {
-                            swap = true;
-                            pts = ts.cubicQuad(wn.pts(), wt.pts());
-                            debugShowCubicQuadIntersection(pts, wn, wt, ts);
-                            break;
-                        }
-                        default:
-                            SkASSERT(0);
-                    }
+                case SkIntersectionHelper::kLine_Segment: {
+                    pts = ts.cubicLine(wt.pts(), wn.pts());
+                    debugShowCubicLineIntersection(pts, wt, wn, ts);
                     break;
-                case SkIntersectionHelper::kCubic_Segment:
-                    switch (wn.segmentType()) {
-                        case SkIntersectionHelper::kHorizontalLine_Segment:
-                            pts = ts.cubicHorizontal(wt.pts(), wn.left(),
-                                    wn.right(), wn.y(), wn.xFlipped());
-                            debugShowCubicLineIntersection(pts, wt, wn, ts);
-                            break;
-                        case SkIntersectionHelper::kVerticalLine_Segment:
-                            pts = ts.cubicVertical(wt.pts(), wn.top(),
-                                    wn.bottom(), wn.x(), wn.yFlipped());
-                            debugShowCubicLineIntersection(pts, wt, wn, ts);
-                            break;
-                        case SkIntersectionHelper::kLine_Segment: {
-                            pts = ts.cubicLine(wt.pts(), wn.pts());
-                            debugShowCubicLineIntersection(pts, wt, wn, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kQuad_Segment: {
-                            pts = ts.cubicQuad(wt.pts(), wn.pts());
-                            debugShowCubicQuadIntersection(pts, wt, wn, ts);
-                            break;
-                        }
-                        case SkIntersectionHelper::kCubic_Segment: {
-                            pts = ts.cubicCubic(wt.pts(), wn.pts());
-                            debugShowCubicIntersection(pts, wt, wn, ts);
-                            break;
-                        }
-                        default:
-                            SkASSERT(0);
-                    }
+                }
+                case SkIntersectionHelper::kQuad_Segment: {
+                    pts = ts.cubicQuad(wt.pts(), wn.pts());
+                    debugShowCubicQuadIntersection(pts, wt, wn, ts);
                     break;
+                }
+                case SkIntersectionHelper::kCubic_Segment: {
+                    pts = ts.cubicCubic(wt.pts(), wn.pts());
+                    debugShowCubicIntersection(pts, wt, wn, ts);
+                    break;
+                }
                 default:
                     SkASSERT(0);
             }
-            if (!foundCommonContour && pts > 0) {
-                test->addCross(next);
-                next->addCross(test);
-                foundCommonContour = true;
+            break;
+        default:
+            SkASSERT(0);
+    }
+    *swapPtr = swap;
+    return pts;
+}
+
+// Records the intersections found by intersect_segments() in both segments.
+// This changes the contours, so pairs must be added one at a time, in order.
+static void add_intersections(SkIntersectionHelper& wt, SkIntersectionHelper& wn,
+                              SkIntersections& ts, int pts, bool swap,
+                              SkOpContour* test, SkOpContour* next, bool* foundCommonContour) {
+    if (!*foundCommonContour && pts > 0) {
+        test->addCross(next);
+        next->addCross(test);
+        *foundCommonContour = true;
+    }
+    // in addition to recording T values, record matching segment
+    if (pts == 2) {
+        if (wn.segmentType() <= SkIntersectionHelper::kLine_Segment
+                && wt.segmentType() <= SkIntersectionHelper::kLine_Segment) {
+            if (wt.addCoincident(wn, ts, swap)) {
+                return;
             }
-            // in addition to recording T values, record matching segment
-            if (pts == 2) {
-                if (wn.segmentType() <= SkIntersectionHelper::kLine_Segment
-                        && wt.segmentType() <= SkIntersectionHelper::kLine_Segment) {
-                    if (wt.addCoincident(wn, ts, swap)) {
-                        continue;
-                    }
-                    ts.cleanUpCoincidence();  // prefer (t == 0 or t == 1)
-                    pts = 1;
-                } else if (wn.segmentType() >= SkIntersectionHelper::kQuad_Segment
-                        && wt.segmentType() >= SkIntersectionHelper::kQuad_Segment
-                        && ts.isCoincident(0)) {
-                    SkASSERT(ts.coincidentUsed() == 2);
-                    if (wt.addCoincident(wn, ts, swap)) {
-                        continue;
-                    }
+            ts.cleanUpCoincidence();  // prefer (t == 0 or t == 1)
+            pts = 1;
+        } else if (wn.segmentType() >= SkIntersectionHelper::kQuad_Segment
+                && wt.segmentType() >= SkIntersectionHelper::kQuad_Segment
+                && ts.isCoincident(0)) {
+            SkASSERT(ts.coincidentUsed() == 2);
+            if (wt.addCoincident(wn, ts, swap)) {
+                return;
+            }
+            ts.cleanUpCoincidence();  // prefer (t == 0 or t == 1)
+            pts = 1;
+        }
+    }
+    if (pts >= 2) {
+        for (int pt = 0; pt < pts - 1; ++pt) {
+            const SkDPoint& point = ts.pt(pt);
+            const SkDPoint& next = ts.pt(pt + 1);
+            if (wt.isPartial(ts[swap][pt], ts[swap][pt + 1], point, next)
+                    && wn.isPartial(ts[!swap][pt], ts[!swap][pt + 1], point, next)) {
+                if (!wt.addPartialCoincident(wn, ts, pt, swap)) {
+                    // remove extra point if two map to same float values
                     ts.cleanUpCoincidence();  // prefer (t == 0 or t == 1)
                     pts = 1;
                 }
             }
-            if (pts >= 2) {
-                for (int pt = 0; pt < pts - 1; ++pt) {
-                    const SkDPoint& point = ts.pt(pt);
-                    const SkDPoint& next = ts.pt(pt + 1);
-                    if (wt.isPartial(ts[swap][pt], ts[swap][pt + 1], point, next)
-                            && wn.isPartial(ts[!swap][pt], ts[!swap][pt + 1], point, next)) {
-                        if (!wt.addPartialCoincident(wn, ts, pt, swap)) {
-                            // remove extra point if two map to same float values
-                            ts.cleanUpCoincidence();  // prefer (t == 0 or t == 1)
-                            pts = 1;
-                        }
-                    }
-                }
+        }
+    }
+    for (int pt = 0; pt < pts; ++pt) {
+        SkASSERT(ts[0][pt] >= 0 && ts[0][pt] <= 1);
+        SkASSERT(ts[1][pt] >= 0 && ts[1][pt] <= 1);
+        SkPoint point = ts.pt(pt).asSkPoint();
+        int testTAt = wt.addT(wn, point, ts[swap][pt]);
+        int nextTAt = wn.addT(wt, point, ts[!swap][pt]);
+        wt.addOtherT(testTAt, ts[!swap][pt], nextTAt);
+        wn.addOtherT(nextTAt, ts[swap][pt], testTAt);
+    }
+}
+
+namespace {
+
+// Contours with fewer segments than this just test every pair of bounds.
+static const int kMinBandedSegments = 64;
+// About this many segments are expected to cross each band.
+static const int kSegmentsPerBand = 4;
+static const int kMaxBands = 4096;
+// Bands are kept much taller than the ulps slop in SkPathOpsBounds::Intersects.
+static const SkScalar kMinRelativeBandHeight = 1.0f / 4096;
+
+/**
+ *  Buckets a contour's segments by the horizontal bands their bounds cross,
+ *  so the segments that may intersect a given one are found without testing
+ *  every pair. Large, thin polygons have only a few segments in each band.
+ */
+class SegmentBands {
+public:
+    explicit SegmentBands(SkOpContour* contour)
+        : fContour(contour)
+        , fStamp(0) {
+        const SkTArray<SkOpSegment>& segments = contour->segments();
+        const int count = segments.count();
+        const SkPathOpsBounds& bounds = contour->bounds();
+        const SkScalar height = bounds.fBottom - bounds.fTop;
+        const SkScalar minBandHeight = SkTMax(SkScalarAbs(bounds.fTop),
+                SkScalarAbs(bounds.fBottom)) * kMinRelativeBandHeight;
+
+        fTop = bounds.fTop;
+        fBandCount = SkTPin(count / kSegmentsPerBand, 1, kMaxBands);
+        if (!(height > 0)) {
+            fBandCount = 1;
+        } else if (minBandHeight > 0 && height / fBandCount < minBandHeight) {
+            fBandCount = SkTMax(1, (int) (height / minBandHeight));
+        }
+        fInvBandHeight = height > 0 ? fBandCount / height : 0;
+
+        // Count the segments in each band, then lay the bands out one after
+        // another in fIndices. Segment indices end up in increasing order.
+        fBandStarts.setCount(fBandCount + 1);
+        sk_bzero(fBandStarts.begin(), fBandStarts.count() * sizeof(int));
+        for (int i = 0; i < count; ++i) {
+            const SkPathOpsBounds& segBounds = segments[i].bounds();
+            for (int b = this->band(segBounds.fTop); b <= this->band(segBounds.fBottom); ++b) {
+                fBandStarts[b + 1]++;
+            }
+        }
+        for (int b = 0; b < fBandCount; ++b) {
+            fBandStarts[b + 1] += fBandStarts[b];
+        }
+        fIndices.setCount(fBandStarts[fBandCount]);
+        SkTDArray<int> fill;
+        fill.append(fBandCount, fBandStarts.begin());
+        for (int i = 0; i < count; ++i) {
+            const SkPathOpsBounds& segBounds = segments[i].bounds();
+            for (int b = this->band(segBounds.fTop); b <= this->band(segBounds.fBottom); ++b) {
+                fIndices[fill[b]++] = i;
+            }
+        }
+        fStamps.setCount(count);
+        sk_bzero(fStamps.begin(), count * sizeof(int));
+    }
+
+    // Appends, in increasing order, the indices (at least start) of the
+    // segments whose bounds intersect bounds.
+    void find(const SkPathOpsBounds& bounds, int start, SkTDArray<int>* found) {
+        const SkTArray<SkOpSegment>& segments = fContour->segments();
+        const int firstFound = found->count();
+        // One extra band each way covers the slop in Intersects().
+        const int first = SkTMax(this->band(bounds.fTop) - 1, 0);
+        const int last = SkTMin(this->band(bounds.fBottom) + 1, fBandCount - 1);
+        ++fStamp;
+        for (int i = fBandStarts[first]; i < fBandStarts[last + 1]; ++i) {
+            const int index = fIndices[i];
+            if (index < start || fStamps[index] == fStamp) {
+                continue;
+            }
+            fStamps[index] = fStamp;
+            if (SkPathOpsBounds::Intersects(bounds, segments[index].bounds())) {
+                *found->append() = index;
+            }
+        }
+        if (found->count() - firstFound > 1) {
+            SkTQSort<int>(found->begin() + firstFound, found->end() - 1);
+        }
+    }
+
+private:
+    int band(SkScalar y) const {
+        const SkScalar b = (y - fTop) * fInvBandHeight;
+        if (!(b > 0)) {
+            return 0;
+        }
+        if (b >= fBandCount) {
+            return fBandCount - 1;
+        }
+        return (int) b;
+    }
+
+    SkOpContour*    fContour;
+    SkScalar        fTop;
+    SkScalar        fInvBandHeight;
+    int             fBandCount;
+    SkTDArray<int>  fBandStarts;    // fBandCount + 1 offsets into fIndices
+    SkTDArray<int>  fIndices;       // segment indices, band by band
+    SkTDArray<int>  fStamps;        // the last find() that saw each segment
+    int             fStamp;
+};
+
+// Pairs are intersected this many at a time before they are added, which
+// bounds the memory held by the pending SkIntersections.
+static const int kPairsPerBatch = 4096;
+// Batches with fewer pairs than this are intersected on the calling thread.
+static const int kMinParallelPairs = 256;
+// Pairs handed to a thread at a time.
+static const int kPairsPerTask = 64;
+
+struct SegmentPair {
+    int fTest;
+    int fNext;
+};
+
+/**
+ *  Candidate pairs of segments, in the order the nested loops over both
+ *  contours would visit them. Their intersections can be found in any order,
+ *  even on several threads, but are then added strictly in that order so
+ *  the result does not depend on the thread count.
+ */
+class PairBatch {
+public:
+    PairBatch(SkOpContour* test, SkOpContour* next, bool* foundCommonContour)
+        : fTest(test)
+        , fNext(next)
+        , fFoundCommonContour(foundCommonContour) {
+    }
+
+    void add(int testIndex, const SkTDArray<int>& nextIndices) {
+        for (int i = 0; i < nextIndices.count(); ++i) {
+            SegmentPair* pair = fPairs.append();
+            pair->fTest = testIndex;
+            pair->fNext = nextIndices[i];
+        }
+        if (fPairs.count() >= kPairsPerBatch) {
+            this->flush();
+        }
+    }
+
+    void flush() {
+        const int count = fPairs.count();
+        if (0 == count) {
+            return;
+        }
+        fResults.reset(count);
+        fPts.setCount(count);
+        fSwaps.setCount(count);
+        fNextTask = 0;
+
+        int threadCount = SkTMin<int>(c_pathOpsThreadCount,
+                                      (count + kPairsPerTask - 1) / kPairsPerTask);
+        if (count < kMinParallelPairs) {
+            threadCount = 1;
+        }
+        // The calling thread takes pairs too, so start one fewer worker.
+        SkTDArray<SkThread*> threads;
+        for (int i = 1; i < threadCount; ++i) {
+            SkThread* thread = SkNEW_ARGS(SkThread, (WorkerProc, this));
+            if (!thread->start()) {
+                // Its pairs are picked up by the other threads.
+                SkDELETE(thread);
+                continue;
             }
-            for (int pt = 0; pt < pts; ++pt) {
-                SkASSERT(ts[0][pt] >= 0 && ts[0][pt] <= 1);
-                SkASSERT(ts[1][pt] >= 0 && ts[1][pt] <= 1);
-                SkPoint point = ts.pt(pt).asSkPoint();
-                int testTAt = wt.addT(wn, point, ts[swap][pt]);
-                int nextTAt = wn.addT(wt, point, ts[!swap][pt]);
-                wt.addOtherT(testTAt, ts[!swap][pt], nextTAt);
-                wn.addOtherT(nextTAt, ts[swap][pt], testTAt);
+            *threads.append() = thread;
+        }
+        WorkerProc(this);
+        for (int i = 0; i < threads.count(); ++i) {
+            threads[i]->join();
+            SkDELETE(threads[i]);
+        }
+
+        SkIntersectionHelper wt, wn;
+        wt.init(fTest);
+        wn.init(fNext);
+        for (int i = 0; i < count; ++i) {
+            wt.setIndex(fPairs[i].fTest);
+            wn.setIndex(fPairs[i].fNext);
+            add_intersections(wt, wn, fResults[i], fPts[i], SkToBool(fSwaps[i]),
+                              fTest, fNext, fFoundCommonContour);
+        }
+        fPairs.rewind();
+    }
+
+private:
+    static void WorkerProc(void* data) {
+        PairBatch* batch = static_cast<PairBatch*>(data);
+        const int count = batch->fPairs.count();
+        SkIntersectionHelper wt, wn;
+        wt.init(batch->fTest);
+        wn.init(batch->fNext);
+        for (;;) {
+            const int first = sk_atomic_inc(&batch->fNextTask) * kPairsPerTask;
+            if (first >= count) {
+                break;
+            }
+            const int stop = SkTMin(first + kPairsPerTask, count);
+            for (int i = first; i < stop; ++i) {
+                wt.setIndex(batch->fPairs[i].fTest);
+                wn.setIndex(batch->fPairs[i].fNext);
+                bool swap;
+                batch->fPts[i] = intersect_segments(wt, wn, &batch->fResults[i], &swap);
+                batch->fSwaps[i] = swap;
+            }
+        }
+    }
+
+    SkOpContour*                    fTest;
+    SkOpContour*                    fNext;
+    bool*                           fFoundCommonContour;
+    SkTDArray<SegmentPair>          fPairs;
+    SkAutoTArray<SkIntersections>   fResults;
+    SkTDArray<int>                  fPts;
+    SkTDArray<uint8_t>              fSwaps;
+    int32_t                         fNextTask;
+};
+
+}  // namespace
+
+bool AddIntersectTs(SkOpContour* test, SkOpContour* next) {
+    if (test != next) {
+        if (AlmostLessUlps(test->bounds().fBottom, next->bounds().fTop)) {
+            return false;
+        }
+        // OPTIMIZATION: outset contour bounds a smidgen instead?
+        if (!SkPathOpsBounds::Intersects(test->bounds(), next->bounds())) {
+            return true;
+        }
+    }
+    const SkTArray<SkOpSegment>& nextSegments = next->segments();
+    const int nextCount = nextSegments.count();
+    SkAutoTDelete<SegmentBands> bands(nextCount >= kMinBandedSegments
+                                      ? SkNEW_ARGS(SegmentBands, (next)) : NULL);
+    bool foundCommonContour = test == next;
+    PairBatch batch(test, next, &foundCommonContour);
+    SkTDArray<int> candidates;
+    SkIntersectionHelper wt;
+    wt.init(test);
+    do {
+        // A contour is only intersected with itself once per pair.
+        const int start = test == next ? wt.index() + 1 : 0;
+        candidates.rewind();
+        if (NULL != bands.get()) {
+            bands->find(wt.bounds(), start, &candidates);
+        } else {
+            for (int index = start; index < nextCount; ++index) {
+                if (SkPathOpsBounds::Intersects(wt.bounds(), nextSegments[index].bounds())) {
+                    *candidates.append() = index;
+                }
             }
-        } while (wn.advance());
+        }
+        batch.add(wt.index(), candidates);
     } while (wt.advance());
+    batch.flush();
     return true;
 }
 
@@ -439,6 +439,199 @@ tryNextHalfPlane:
     return false;
 }
 
+// Bezier clipping (Sederberg and Nishita) finds where two cubics cross without approximating
+// them by quads. Each cubic lies within a "fat line" band parallel to the line through its end
+// points. Clipping the other cubic to that band, using the convex hull of its control point
+// distances, trims its t range; the two clips alternate until the ranges converge. When a pair
+// of clips trims too little, as when the cubics cross more than once, the larger cubic is split
+// in two and each half is clipped in turn.
+//
+// Tangent and coincident cubics converge slowly, if at all. Rather than chase them, the clipper
+// gives up after kMaxCubicClipSteps and the caller falls back to the quad subdivision above.
+static const int kMaxCubicClipSteps = 256;
+
+// Splitting is cheaper than a clip that trims less than this much of the range.
+static const double kMinCubicClipShrink = 0.2;
+
+class SkDCubicClipper {
+public:
+    SkDCubicClipper(const SkDCubic& c1, const SkDCubic& c2, int maxIntersections,
+                    SkIntersections* i)
+        : fC1(c1)
+        , fC2(c2)
+        , fI(i)
+        , fMaxIntersections(maxIntersections)
+        , fSteps(0)
+        , fFailed(false) {
+        double largest = 1;
+        for (int index = 0; index < 4; ++index) {
+            largest = SkTMax(largest, SkTMax(fabs(c1[index].fX), fabs(c1[index].fY)));
+            largest = SkTMax(largest, SkTMax(fabs(c2[index].fX), fabs(c2[index].fY)));
+        }
+        fSlop = largest * FLT_EPSILON / 256;
+        fTolerance = largest * FLT_EPSILON / 16;
+    }
+
+    // Returns false if the cubics could not be clipped to their intersections.
+    bool intersect() {
+        this->clip(0, 1, 0, 1);
+        return !fFailed;
+    }
+
+private:
+    struct FatLine {
+        double fA, fB, fC;  // normalized, so a * x + b * y + c is the distance to the line
+        double fMin, fMax;
+    };
+
+    // Sets the band around c to clip other to. If c has shrunk to about a point, the band runs
+    // across other's end points instead: the line through c's end points would then have no
+    // direction, and any other line through the point would cross other everywhere it goes.
+    bool setFatLine(const SkDCubic& c, const SkDCubic& other, FatLine* line) const {
+        double dx = c[3].fX - c[0].fX;
+        double dy = c[3].fY - c[0].fY;
+        double len = sqrt(dx * dx + dy * dy);
+        bool across = len <= fTolerance;
+        if (across) {
+            dx = other[0].fY - other[3].fY;
+            dy = other[3].fX - other[0].fX;
+            len = sqrt(dx * dx + dy * dy);
+            if (len <= fTolerance) {
+                return false;
+            }
+        }
+        line->fA = -dy / len;
+        line->fB = dx / len;
+        line->fC = -(line->fA * c[0].fX + line->fB * c[0].fY);
+        double d1 = this->distance(*line, c[1]);
+        double d2 = this->distance(*line, c[2]);
+        if (across) {
+            double d3 = this->distance(*line, c[3]);
+            line->fMin = SkTMin(SkTMin(0., d1), SkTMin(d2, d3)) - fSlop;
+            line->fMax = SkTMax(SkTMax(0., d1), SkTMax(d2, d3)) + fSlop;
+            return true;
+        }
+        // the tightest band that holds the cubic, from the control point distances
+        double scale = d1 * d2 > 0 ? 3 / 4. : 4 / 9.;
+        line->fMin = scale * SkTMin(0., SkTMin(d1, d2)) - fSlop;
+        line->fMax = scale * SkTMax(0., SkTMax(d1, d2)) + fSlop;
+        return true;
+    }
+
+    double distance(const FatLine& line, const SkDPoint& pt) const {
+        return line.fA * pt.fX + line.fB * pt.fY + line.fC;
+    }
+
+    // Trims c to the range of t where the convex hull of its distances to the line, at t = 0,
+    // 1/3, 2/3 and 1, is inside the band. The hull is the union of the segments between every
+    // pair of control points, so it's enough to clip each of those.
+    bool clipToFatLine(const SkDCubic& c, const FatLine& line, double* tMin, double* tMax) const {
+        double d[4];
+        for (int index = 0; index < 4; ++index) {
+            d[index] = this->distance(line, c[index]);
+        }
+        *tMin = 1;
+        *tMax = 0;
+        for (int i1 = 0; i1 < 4; ++i1) {
+            if (line.fMin <= d[i1] && d[i1] <= line.fMax) {
+                *tMin = SkTMin(*tMin, i1 / 3.);
+                *tMax = SkTMax(*tMax, i1 / 3.);
+            }
+            for (int i2 = i1 + 1; i2 < 4; ++i2) {
+                for (int edge = 0; edge < 2; ++edge) {
+                    double bound = edge ? line.fMax : line.fMin;
+                    if ((d[i1] - bound) * (d[i2] - bound) >= 0) {
+                        continue;
+                    }
+                    double t = (i1 + (i2 - i1) * (bound - d[i1]) / (d[i2] - d[i1])) / 3;
+                    *tMin = SkTMin(*tMin, t);
+                    *tMax = SkTMax(*tMax, t);
+                }
+            }
+        }
+        return *tMin <= *tMax;
+    }
+
+    static double Extent(const SkDCubic& c) {
+        SkDRect bounds;
+        bounds.setRawBounds(c);
+        return SkTMax(bounds.fRight - bounds.fLeft, bounds.fBottom - bounds.fTop);
+    }
+
+    void addIntersection(double t1, double t2) {
+        SkDPoint pt1 = fC1.ptAtT(t1);
+        SkDPoint pt2 = fC2.ptAtT(t2);
+        if (!pt1.approximatelyEqual(pt2)) {
+            return;
+        }
+        if (fI->used() >= fMaxIntersections) {
+            fFailed = true;  // more crossings than cubics can have; they must be coincident
+            return;
+        }
+        fI->insert(t1, t2, pt1);
+    }
+
+    void clip(double t1s, double t1e, double t2s, double t2e) {
+        while (!fFailed) {
+            if (++fSteps > kMaxCubicClipSteps) {
+                fFailed = true;
+                return;
+            }
+            SkDCubic c1 = fC1.subDivide(t1s, t1e);
+            SkDCubic c2 = fC2.subDivide(t2s, t2e);
+            double extent1 = Extent(c1);
+            double extent2 = Extent(c2);
+            if ((extent1 <= fTolerance || t1e - t1s <= DBL_EPSILON_ERR)
+                    && (extent2 <= fTolerance || t2e - t2s <= DBL_EPSILON_ERR)) {
+                this->addIntersection((t1s + t1e) / 2, (t2s + t2e) / 2);
+                return;
+            }
+            double range1 = t1e - t1s;
+            double range2 = t2e - t2s;
+            FatLine line;
+            double tMin, tMax;
+            if (this->setFatLine(c2, c1, &line)) {
+                if (!this->clipToFatLine(c1, line, &tMin, &tMax)) {
+                    return;
+                }
+                t1e = t1s + range1 * tMax;
+                t1s = t1s + range1 * tMin;
+                c1 = fC1.subDivide(t1s, t1e);
+            }
+            if (this->setFatLine(c1, c2, &line)) {
+                if (!this->clipToFatLine(c2, line, &tMin, &tMax)) {
+                    return;
+                }
+                t2e = t2s + range2 * tMax;
+                t2s = t2s + range2 * tMin;
+            }
+            if (t1e - t1s < range1 * (1 - kMinCubicClipShrink)
+                    || t2e - t2s < range2 * (1 - kMinCubicClipShrink)) {
+                continue;
+            }
+            if (extent1 >= extent2) {
+                double t1m = (t1s + t1e) / 2;
+                this->clip(t1s, t1m, t2s, t2e);
+                this->clip(t1m, t1e, t2s, t2e);
+            } else {
+                double t2m = (t2s + t2e) / 2;
+                this->clip(t1s, t1e, t2s, t2m);
+                this->clip(t1s, t1e, t2m, t2e);
+            }
+            return;
+        }
+    }
+
+    const SkDCubic& fC1;
+    const SkDCubic& fC2;
+    SkIntersections* fI;
+    int fMaxIntersections;
+    double fSlop;  // rounding error allowed in distances
+    double fTolerance;  // size at which a piece of cubic is taken as a point
+    int fSteps;
+    bool fFailed;
+};
+
 int SkIntersections::intersect(const SkDCubic& c1, const SkDCubic& c2) {
     if (fMax == 0) {
         fMax = 9;
@@ -526,7 +719,11 @@ int SkIntersections::intersect(const SkDCubic& c1, const SkDCubic& c2) {
     SkIntersections i;
     i.fAllowNear = false;
     i.fMax = 9;
-    ::intersect(c1, 0, 1, c2, 0, 1, 1, i);
+    if (selfIntersect || !SkDCubicClipper(c1, c2, i.fMax, &i).intersect()) {
+        i.reset();
+        i.fAllowNear = false;
+        ::intersect(c1, 0, 1, c2, 0, 1, 1, i);
+    }
     int compCount = i.used();
     if (compCount) {
         int exactCount = used();
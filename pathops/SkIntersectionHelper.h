@@ -68,6 +68,10 @@ public:
         fLast = contour->segments().count();
     }
 
+    int index() const {
+        return fIndex;
+    }
+
     bool isAdjacent(const SkIntersectionHelper& next) {
         return fContour == next.fContour && fIndex + 1 == next.fIndex;
     }
@@ -112,6 +116,11 @@ public:
         return kLine_Segment;
     }
 
+    void setIndex(int index) {
+        SkASSERT(index >= 0 && index < fLast);
+        fIndex = index;
+    }
+
     bool startAfter(const SkIntersectionHelper& after) {
         fIndex = after.fIndex;
         return advance();
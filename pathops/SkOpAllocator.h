@@ -0,0 +1,142 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#ifndef SkOpAllocator_DEFINED
+#define SkOpAllocator_DEFINED
+
+#include "SkChunkAlloc.h"
+#include "SkTypes.h"
+
+/**
+ *  Bump allocator for the storage of one path op. Everything allocated from it is released
+ *  together when the op's contours go away, so a pass over many small segments doesn't make one
+ *  heap allocation per span array.
+ */
+class SkOpAllocator {
+public:
+    SkOpAllocator() : fChunks(kChunkSize) {}
+
+    /** Returns bytes of storage aligned for doubles. */
+    void* alloc(size_t bytes) {
+        // SkChunkAlloc only aligns to 4 bytes; spans hold doubles.
+        intptr_t storage = (intptr_t) fChunks.allocThrow(bytes + kAlign - 4);
+        return (void*) ((storage + kAlign - 1) & ~(intptr_t) (kAlign - 1));
+    }
+
+    /** Releases everything allocated so far. */
+    void rewind() {
+        fChunks.reset();
+    }
+
+private:
+    enum {
+        kAlign = 8,
+        kChunkSize = 16 * 1024
+    };
+
+    SkChunkAlloc fChunks;
+};
+
+/**
+ *  Growable array of POD elements, stored in an SkOpAllocator when one is set and on the heap
+ *  otherwise. Storage outgrown in the allocator isn't reclaimed until the allocator is rewound.
+ */
+template <typename T> class SkOpArray {
+public:
+    SkOpArray() : fArray(NULL), fAllocator(NULL), fCount(0), fReserve(0) {}
+
+    SkOpArray(const SkOpArray<T>& src)
+        : fArray(NULL), fAllocator(src.fAllocator), fCount(0), fReserve(0) {
+        *this = src;
+    }
+
+    ~SkOpArray() {
+        if (NULL == fAllocator) {
+            sk_free(fArray);
+        }
+    }
+
+    SkOpArray<T>& operator=(const SkOpArray<T>& src) {
+        if (this != &src) {
+            fCount = 0;
+            this->growBy(src.fCount);
+            memcpy(fArray, src.fArray, src.fCount * sizeof(T));
+        }
+        return *this;
+    }
+
+    /** Must be called while the array is empty and has no storage. */
+    void setAllocator(SkOpAllocator* allocator) {
+        SkASSERT(NULL == fArray);
+        fAllocator = allocator;
+    }
+
+    int count() const { return fCount; }
+
+    T* begin() { return fArray; }
+    const T* begin() const { return fArray; }
+    T* end() { return fArray + fCount; }
+    const T* end() const { return fArray + fCount; }
+
+    T& operator[](int index) {
+        SkASSERT((unsigned) index < (unsigned) fCount);
+        return fArray[index];
+    }
+
+    const T& operator[](int index) const {
+        SkASSERT((unsigned) index < (unsigned) fCount);
+        return fArray[index];
+    }
+
+    /** Returns a new, uninitialized element at the end of the array. */
+    T* append() {
+        int oldCount = fCount;
+        this->growBy(1);
+        return fArray + oldCount;
+    }
+
+    /** Returns a new, uninitialized element at index, moving the later elements up by one. */
+    T* insert(int index) {
+        SkASSERT((unsigned) index <= (unsigned) fCount);
+        int oldCount = fCount;
+        this->growBy(1);
+        T* dst = fArray + index;
+        memmove(dst + 1, dst, (oldCount - index) * sizeof(T));
+        return dst;
+    }
+
+    /** Empties the array, keeping its storage. */
+    void reset() {
+        fCount = 0;
+    }
+
+private:
+    void growBy(int extra) {
+        int count = fCount + extra;
+        if (count > fReserve) {
+            int reserve = count + 4;
+            reserve += reserve >> 1;
+            size_t bytes = reserve * sizeof(T);
+            T* array;
+            if (NULL != fAllocator) {
+                array = (T*) fAllocator->alloc(bytes);
+                memcpy(array, fArray, fCount * sizeof(T));
+            } else {
+                array = (T*) sk_realloc_throw(fArray, bytes);
+            }
+            fArray = array;
+            fReserve = reserve;
+        }
+        fCount = count;
+    }
+
+    T* fArray;
+    SkOpAllocator* fAllocator;
+    int fCount;
+    int fReserve;
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#include "SkOpBuilder.h"
+#include "SkGeometry.h"
+#include "SkOpAllocator.h"
+#include "SkPathOpsCommon.h"
+
+// Splits path into one path per contour, dropping contours without segments.
+static void split_contours(const SkPath& path, SkTArray<SkPath>* contours) {
+    SkPath::Iter iter(path, false);
+    SkPoint pts[4];
+    SkPath* contour = NULL;
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                contour = &contours->push_back();
+                contour->moveTo(pts[0]);
+                break;
+            case SkPath::kLine_Verb:
+                contour->lineTo(pts[1]);
+                break;
+            case SkPath::kQuad_Verb:
+                contour->quadTo(pts[1], pts[2]);
+                break;
+            case SkPath::kConic_Verb:
+                contour->conicTo(pts[1], pts[2], iter.conicWeight());
+                break;
+            case SkPath::kCubic_Verb:
+                contour->cubicTo(pts[1], pts[2], pts[3]);
+                break;
+            case SkPath::kClose_Verb:
+                contour->close();
+                break;
+            default:
+                SkDEBUGFAIL("bad verb");
+                break;
+        }
+    }
+}
+
+// Returns a point halfway along the contour's first segment.
+static SkPoint first_segment_midpoint(const SkPath& contour) {
+    SkPath::Iter iter(contour, true);
+    SkPoint pts[4];
+    SkPoint mid = { 0, 0 };
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kLine_Verb:
+                mid.set(SkScalarAve(pts[0].fX, pts[1].fX), SkScalarAve(pts[0].fY, pts[1].fY));
+                return mid;
+            case SkPath::kQuad_Verb:
+            case SkPath::kConic_Verb:
+                SkEvalQuadAt(pts, SK_ScalarHalf, &mid);
+                return mid;
+            case SkPath::kCubic_Verb:
+                SkEvalCubicAt(pts, SK_ScalarHalf, &mid, NULL, NULL);
+                return mid;
+            default:
+                break;
+        }
+    }
+    return mid;
+}
+
+/*  Simplify() leaves non-overlapping contours to be filled even-odd. Rewrite
+    them so that a winding fill gives the same area with a winding of exactly
+    one: a contour nested in an even number of others runs clockwise, one
+    nested in an odd number runs counterclockwise. Since the contours do not
+    cross, a single point on each one tells how deeply it is nested.
+ */
+static void fix_winding(const SkPath& simple, SkPath* result) {
+    SkASSERT(!simple.isInverseFillType());
+    SkTArray<SkPath> contours;
+    split_contours(simple, &contours);
+    for (int index = 0; index < contours.count(); ++index) {
+        const SkPath& contour = contours[index];
+        SkPath::Direction dir;
+        if (!contour.cheapComputeDirection(&dir)) {
+            continue;  // encloses no area
+        }
+        const SkPoint pt = first_segment_midpoint(contour);
+        int depth = 0;
+        for (int other = 0; other < contours.count(); ++other) {
+            if (other != index && contours[other].contains(pt.fX, pt.fY)) {
+                ++depth;
+            }
+        }
+        const SkPath::Direction wanted = depth & 1 ? SkPath::kCCW_Direction
+                : SkPath::kCW_Direction;
+        if (dir == wanted) {
+            result->addPath(contour);
+        } else {
+            result->reverseAddPath(contour);
+        }
+    }
+}
+
+// Unions paths[0..count) into result, which may be one of the paths.
+static bool union_all(const SkPath paths[], int count, SkPath* result,
+                      SkOpAllocator* allocator) {
+    for (int index = 0; index < count; ++index) {
+        if (paths[index].isInverseFillType()) {
+            // An inverse fill has no finite interior to orient; fall back to
+            // combining the paths one at a time.
+            SkPath sum(paths[0]);
+            for (int next = 1; next < count; ++next) {
+                if (!Op(sum, paths[next], kUnion_PathOp, &sum, allocator)) {
+                    return false;
+                }
+            }
+            return Simplify(sum, result, allocator);
+        }
+    }
+    SkPath combined;
+    combined.setFillType(SkPath::kWinding_FillType);
+    for (int index = 0; index < count; ++index) {
+        SkPath simple;
+        if (!Simplify(paths[index], &simple, allocator)) {
+            return false;
+        }
+        fix_winding(simple, &combined);
+    }
+    return Simplify(combined, result, allocator);
+}
+
+void SkOpBuilder::add(const SkPath& path, SkPathOp op) {
+    fPaths.push_back(path);
+    *fOps.append() = op;
+}
+
+void SkOpBuilder::reset() {
+    fPaths.reset();
+    fOps.reset();
+}
+
+bool SkOpBuilder::resolve(SkPath* result) {
+    // Every op below reuses the same span storage.
+    SkOpAllocator allocator;
+    SkPath sum;
+    const int count = fPaths.count();
+    int index = 0;
+    while (index < count) {
+        // Gather the run of unions starting here, including the result so far.
+        int end = index;
+        while (end < count && kUnion_PathOp == fOps[end]) {
+            ++end;
+        }
+        if (end > index) {
+            SkTArray<SkPath> run;
+            if (!sum.isEmpty() || sum.isInverseFillType()) {
+                run.push_back(sum);
+            }
+            for (int next = index; next < end; ++next) {
+                run.push_back(fPaths[next]);
+            }
+            if (!union_all(run.begin(), run.count(), &sum, &allocator)) {
+                this->reset();
+                return false;
+            }
+            index = end;
+            continue;
+        }
+        if (!Op(sum, fPaths[index], fOps[index], &sum, &allocator)) {
+            this->reset();
+            return false;
+        }
+        ++index;
+    }
+    this->reset();
+    result->swap(sum);
+    return true;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+#ifndef SkOpBuilder_DEFINED
+#define SkOpBuilder_DEFINED
+
+#include "SkPathOps.h"
+#include "SkTArray.h"
+
+/**
+ *  Combines any number of paths with a running list of SkPathOps. Each added
+ *  path is combined, by its op, with the result of all the paths before it;
+ *  the first path is combined with an empty path.
+ *
+ *  Unioning many paths with repeated calls to Op() intersects every path with
+ *  an ever growing result. Instead, consecutive unions are resolved together:
+ *  each path is simplified on its own, its contours are oriented so that its
+ *  interior has a winding of one, and all of them are simplified together as
+ *  a single winding path. Only paths with inverse fills fall back to Op().
+ */
+class SkOpBuilder {
+public:
+    void add(const SkPath& path, SkPathOp op);
+
+    /**
+     *  Computes the combination of every added path into result and empties
+     *  the builder. Returns false, leaving result unchanged, if some op
+     *  failed.
+     */
+    bool resolve(SkPath* result);
+
+private:
+    void reset();
+
+    SkTArray<SkPath> fPaths;
+    SkTDArray<SkPathOp> fOps;
+};
+
+#endif
@@ -27,7 +27,8 @@ struct SkCoincidence {
 
 class SkOpContour {
 public:
-    SkOpContour() {
+    SkOpContour()
+        : fAllocator(NULL) {
         reset();
 #if defined(SK_DEBUG) || !FORCE_RELEASE
         fID = sk_atomic_inc(&SkPathOpsDebug::gContourID);
@@ -54,12 +55,12 @@ public:
     }
 
     void addCubic(const SkPoint pts[4]) {
-        fSegments.push_back().addCubic(pts, fOperand, fXor);
+        this->appendSegment().addCubic(pts, fOperand, fXor);
         fContainsCurves = fContainsCubics = true;
     }
 
     int addLine(const SkPoint pts[2]) {
-        fSegments.push_back().addLine(pts, fOperand, fXor);
+        this->appendSegment().addLine(pts, fOperand, fXor);
         return fSegments.count();
     }
 
@@ -71,7 +72,7 @@ public:
                        const SkIntersections& ts, int ptIndex, bool swap);
 
     int addQuad(const SkPoint pts[3]) {
-        fSegments.push_back().addQuad(pts, fOperand, fXor);
+        this->appendSegment().addQuad(pts, fOperand, fXor);
         fContainsCurves = true;
         return fSegments.count();
     }
@@ -210,6 +211,10 @@ public:
         return fSegments;
     }
 
+    void setAllocator(SkOpAllocator* allocator) {
+        fAllocator = allocator;
+    }
+
     void setContainsIntercepts() {
         fContainsIntercepts = true;
     }
@@ -288,11 +293,18 @@ public:
     void dumpSpans() const;
 
 private:
+    SkOpSegment& appendSegment() {
+        SkOpSegment& segment = fSegments.push_back();
+        segment.setAllocator(fAllocator);
+        return segment;
+    }
+
     void calcCommonCoincidentWinding(const SkCoincidence& );
     void joinCoincidence(const SkTArray<SkCoincidence, true>& , bool partial);
     void setBounds();
 
     SkTArray<SkOpSegment> fSegments;
+    SkOpAllocator* fAllocator;
     SkTArray<SkOpSegment*, true> fSortedSegments;
     int fFirstSorted;
     SkTArray<SkCoincidence, true> fCoincidences;
@@ -16,13 +16,17 @@ public:
     SkOpEdgeBuilder(const SkPathWriter& path, SkTArray<SkOpContour>& contours)
         : fPath(path.nativePath())
         , fContours(contours)
+        , fAllocator(NULL)
         , fAllowOpenContours(true) {
         init();
     }
 
-    SkOpEdgeBuilder(const SkPath& path, SkTArray<SkOpContour>& contours)
+    // the contours' spans are allocated from allocator if it isn't NULL
+    SkOpEdgeBuilder(const SkPath& path, SkTArray<SkOpContour>& contours,
+                    SkOpAllocator* allocator = NULL)
         : fPath(&path)
         , fContours(contours)
+        , fAllocator(allocator)
         , fAllowOpenContours(false) {
         init();
     }
@@ -53,6 +57,7 @@ private:
     SkTArray<uint8_t, true> fPathVerbs;
     SkOpContour* fCurrentContour;
     SkTArray<SkOpContour>& fContours;
+    SkOpAllocator* fAllocator;
     SkPathOpsMask fXorMask[2];
     int fSecondHalf;
     bool fOperand;
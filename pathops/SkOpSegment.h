@@ -7,6 +7,7 @@
 #ifndef SkOpSegment_DEFINE
 #define SkOpSegment_DEFINE
 
+#include "SkOpAllocator.h"
 #include "SkOpAngle.h"
 #include "SkOpSpan.h"
 #include "SkPathOpsBounds.h"
@@ -168,6 +169,11 @@ public:
         fTs.reset();
     }
 
+    // spans are allocated from the op's allocator when there is one
+    void setAllocator(SkOpAllocator* allocator) {
+        fTs.setAllocator(allocator);
+    }
+
     void setOppXor(bool isOppXor) {
         fOppXor = isOppXor;
     }
@@ -355,7 +361,7 @@ public:
 #if DEBUG_SHOW_WINDING
     int debugShowWindingValues(int slotCount, int ofInterest) const;
 #endif
-    const SkTDArray<SkOpSpan>& debugSpans() const;
+    const SkOpArray<SkOpSpan>& debugSpans() const;
     void debugValidate() const;
     // available to testing only
     void dumpAngles() const;
@@ -507,8 +513,7 @@ private:
 
     const SkPoint* fPts;
     SkPathOpsBounds fBounds;
-    // FIXME: can't convert to SkTArray because it uses insert
-    SkTDArray<SkOpSpan> fTs;  // 2+ (always includes t=0 t=1) -- at least (number of spans) + 1
+    SkOpArray<SkOpSpan> fTs;  // 2+ (always includes t=0 t=1) -- at least (number of spans) + 1
 // FIXME: replace both with bucket storage that allows direct immovable pointers to angles
     SkTArray<SkOpAngle, true> fSingletonAngles;  // 0 or 2 -- allocated for singletons
     SkTArray<SkOpAngle, true> fAngles;  // 0 or 2+ -- (number of non-zero spans) * 2
@@ -11,6 +11,7 @@
 #include "SkOpContour.h"
 #include "SkTDArray.h"
 
+class SkOpAllocator;
 class SkPathWriter;
 
 void Assemble(const SkPathWriter& path, SkPathWriter* simple);
@@ -20,6 +21,11 @@ SkOpSegment* FindSortableTop(const SkTArray<SkOpContour*, true>& , SkOpAngle::In
                              bool* firstContour, int* index, int* endIndex, SkPoint* topLeft,
                              bool* unsortable, bool* done, bool firstPass);
 SkOpSegment* FindUndone(SkTArray<SkOpContour*, true>& contourList, int* start, int* end);
+// As the public Op() and Simplify(), but allocate their spans from allocator, which is rewound
+// first. Callers running many ops pass the same allocator to each to reuse its memory.
+bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+        SkOpAllocator* allocator);
+bool Simplify(const SkPath& path, SkPath* result, SkOpAllocator* allocator);
 void MakeContourList(SkTArray<SkOpContour>& contours, SkTArray<SkOpContour*, true>& list,
                      bool evenOdd, bool oppEvenOdd);
 bool HandleCoincidence(SkTArray<SkOpContour*, true>* , int );
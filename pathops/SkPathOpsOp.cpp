@@ -232,6 +232,12 @@ static const bool gOutInverse[kReverseDifference_PathOp + 1][2][2] = {
 };
 
 bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
+    SkOpAllocator allocator;
+    return Op(one, two, op, result, &allocator);
+}
+
+bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result,
+        SkOpAllocator* allocator) {
 #if DEBUG_SHOW_TEST_NAME
     char* debugName = DEBUG_FILENAME_STRING;
     if (debugName && debugName[0]) {
@@ -252,10 +258,11 @@ bool Op(const SkPath& one, const SkPath& two, SkPathOp op, SkPath* result) {
 #if DEBUG_SORT || DEBUG_SWAP_TOP
     SkPathOpsDebug::gSortCount = SkPathOpsDebug::gSortCountDefault;
 #endif
-    // turn path into list of segments
+    // turn path into list of segments; nothing from an earlier op is still using the allocator
+    allocator->rewind();
     SkTArray<SkOpContour> contours;
     // FIXME: add self-intersecting cubics' T values to segment
-    SkOpEdgeBuilder builder(*minuend, contours);
+    SkOpEdgeBuilder builder(*minuend, contours, allocator);
     const int xorMask = builder.xorMask();
     builder.addOperand(*subtrahend);
     if (!builder.finish()) {
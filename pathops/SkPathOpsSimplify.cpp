@@ -5,9 +5,12 @@
  * found in the LICENSE file.
  */
 #include "SkAddIntersections.h"
+#include "SkGeometry.h"
 #include "SkOpEdgeBuilder.h"
 #include "SkPathOpsCommon.h"
 #include "SkPathWriter.h"
+#include "SkReduceOrder.h"
+#include "SkTSort.h"
 
 static bool bridgeWinding(SkTArray<SkOpContour*, true>& contourList, SkPathWriter* simple) {
     bool firstContour = true;
@@ -150,8 +153,415 @@ static bool bridgeXor(SkTArray<SkOpContour*, true>& contourList, SkPathWriter* s
     return closable;
 }
 
+// Most paths handed to Simplify are already simple: their contours neither cross themselves nor
+// each other. SkSimpleChecker finds those cheaply, so they can be returned as they are instead of
+// going through the segment, angle and coincidence machinery. It breaks the path into pieces that
+// are monotonic in x and y, sweeps them left to right, and only looks closer at pieces whose
+// bounds overlap. Anything it can't prove simple goes down the full path.
+class SkSimpleChecker {
+public:
+    SkSimpleChecker()
+        : fClosed(0)
+        , fUnparseable(false) {
+    }
+
+    // Returns true if the path has no intersections, and its winding fill (if it has one)
+    // covers the same area as the even-odd fill Simplify returns.
+    bool isSimple(const SkPath& path) {
+        if (!path.isFinite() || !this->addPath(path) || !fContours.count()) {
+            return false;
+        }
+        if (this->mayIntersect()) {
+            return false;
+        }
+        return (path.getFillType() & 1) || this->windingMatchesEvenOdd();
+    }
+
+private:
+    struct Piece {
+        SkPoint fPts[4];
+        SkRect fBounds;
+        int fPtCount;  // 2 for a line, 3 for a quad, 4 for a cubic
+        int fContour;
+        int fIndex;  // in its contour
+
+        bool operator<(const Piece& rh) const {
+            return fBounds.fLeft < rh.fBounds.fLeft;
+        }
+    };
+
+    struct Contour {
+        SkPath fPath;  // only made by windingMatchesEvenOdd()
+        SkRect fBounds;
+        int fFirstPiece;
+        int fPieceCount;
+    };
+
+    bool addPath(const SkPath& path) {
+        SkAutoConicToQuads quadder;
+        const SkScalar quadderTol = SK_Scalar1 / 16;
+        SkPath::RawIter iter(path);
+        SkPoint pts[4];
+        SkPath::Verb verb;
+        while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+            switch (verb) {
+                case SkPath::kMove_Verb:
+                    if (!this->closeContour()) {
+                        return false;
+                    }
+                    fStart = fLast = pts[0];
+                    fContours.push_back().fPieceCount = 0;
+                    fContours.back().fFirstPiece = fPieces.count();
+                    break;
+                case SkPath::kLine_Verb:
+                    this->addLine(pts);
+                    break;
+                case SkPath::kQuad_Verb:
+                    this->addQuad(pts);
+                    break;
+                case SkPath::kConic_Verb: {
+                    const SkPoint* quadPts = quadder.computeQuads(pts, iter.conicWeight(),
+                            quadderTol);
+                    for (int i = 0; i < quadder.countQuads(); ++i) {
+                        this->addQuad(&quadPts[i * 2]);
+                    }
+                    break;
+                }
+                case SkPath::kCubic_Verb:
+                    this->addCubic(pts);
+                    break;
+                case SkPath::kClose_Verb:
+                    if (!this->closeContour()) {
+                        return false;
+                    }
+                    break;
+                default:
+                    SkDEBUGFAIL("bad verb");
+                    return false;
+            }
+            if (fUnparseable) {
+                return false;
+            }
+        }
+        return this->closeContour();
+    }
+
+    void addLine(const SkPoint pts[2]) {
+        if (pts[0] != pts[1]) {
+            this->addPiece(pts, 2);
+        }
+    }
+
+    // Adds what SkReduceOrder made of a curve from start to end: a line, or nothing at all.
+    void addReduced(SkPath::Verb verb, const SkPoint& start, const SkPoint& end,
+                    const SkPoint reduced[2]) {
+        if (SkPath::kLine_Verb == verb) {
+            this->addLine(reduced);
+        } else if (start != end) {
+            // A curve whose ends nearly meet was reduced to a point; leaving it out would leave
+            // a gap.
+            fUnparseable = true;
+        }
+    }
+
+    void addQuad(const SkPoint pts[3]) {
+        SkPoint reduced[3];
+        SkPath::Verb verb = SkReduceOrder::Quad(pts, reduced);
+        if (SkPath::kQuad_Verb != verb) {
+            this->addReduced(verb, pts[0], pts[2], reduced);
+            return;
+        }
+        SkPoint yChopped[5];
+        int yCount = SkChopQuadAtYExtrema(pts, yChopped) + 1;
+        for (int y = 0; y < yCount; ++y) {
+            SkPoint xChopped[5];
+            int xCount = SkChopQuadAtXExtrema(&yChopped[y * 2], xChopped) + 1;
+            for (int x = 0; x < xCount; ++x) {
+                this->addMonotonic(&xChopped[x * 2], 3);
+            }
+        }
+    }
+
+    void addCubic(const SkPoint pts[4]) {
+        SkPoint reduced[3];
+        SkPath::Verb verb = SkReduceOrder::Cubic(pts, reduced);
+        if (SkPath::kQuad_Verb == verb) {
+            this->addQuad(reduced);
+            return;
+        }
+        if (SkPath::kCubic_Verb != verb) {
+            this->addReduced(verb, pts[0], pts[3], reduced);
+            return;
+        }
+        SkPoint yChopped[10];
+        int yCount = SkChopCubicAtYExtrema(pts, yChopped) + 1;
+        for (int y = 0; y < yCount; ++y) {
+            SkPoint xChopped[10];
+            int xCount = SkChopCubicAtXExtrema(&yChopped[y * 3], xChopped) + 1;
+            for (int x = 0; x < xCount; ++x) {
+                this->addMonotonic(&xChopped[x * 3], 4);
+            }
+        }
+    }
+
+    // Chopping can leave pieces that are a single point; they add nothing.
+    void addMonotonic(const SkPoint pts[], int ptCount) {
+        for (int i = 1; i < ptCount; ++i) {
+            if (pts[i] != pts[0]) {
+                this->addPiece(pts, ptCount);
+                return;
+            }
+        }
+    }
+
+    void addPiece(const SkPoint pts[], int ptCount) {
+        if (!fContours.count() || pts[0] != fLast) {
+            fUnparseable = true;
+            return;
+        }
+        Contour& contour = fContours.back();
+        Piece& piece = fPieces.push_back();
+        memcpy(piece.fPts, pts, ptCount * sizeof(SkPoint));
+        piece.fPtCount = ptCount;
+        piece.fBounds.set(pts, ptCount);
+        piece.fContour = fContours.count() - 1;
+        piece.fIndex = contour.fPieceCount++;
+        if (0 == piece.fIndex) {
+            contour.fBounds = piece.fBounds;
+        } else {
+            contour.fBounds.join(piece.fBounds);
+        }
+        fLast = pts[ptCount - 1];
+    }
+
+    // Closes the current contour, as filling does. A contour of one piece either has no area or
+    // is a loop, so it isn't considered simple, and one of none is left to the full path to drop.
+    bool closeContour() {
+        if (!fContours.count() || fClosed == fContours.count()) {
+            return true;
+        }
+        if (fLast != fStart) {
+            SkPoint closing[2] = { fLast, fStart };
+            this->addPiece(closing, 2);
+        }
+        fClosed = fContours.count();
+        return !fUnparseable && fContours.back().fPieceCount > 1;
+    }
+
+    static bool BoundsTouch(const SkRect& a, const SkRect& b) {
+        return a.fLeft <= b.fRight && b.fLeft <= a.fRight
+                && a.fTop <= b.fBottom && b.fTop <= a.fBottom;
+    }
+
+    static double Cross(const SkPoint& o, const SkPoint& a, const SkPoint& b) {
+        return ((double) a.fX - o.fX) * ((double) b.fY - o.fY)
+                - ((double) a.fY - o.fY) * ((double) b.fX - o.fX);
+    }
+
+    // Returns true if p, known to be on the line through a and b, lies between them.
+    static bool OnSegment(const SkPoint& a, const SkPoint& b, const SkPoint& p) {
+        return SkTMin(a.fX, b.fX) <= p.fX && p.fX <= SkTMax(a.fX, b.fX)
+                && SkTMin(a.fY, b.fY) <= p.fY && p.fY <= SkTMax(a.fY, b.fY);
+    }
+
+    // Returns true if the lines cross or touch. Products of floats are exact in doubles, so the
+    // signs are too.
+    static bool LinesTouch(const SkPoint a[2], const SkPoint b[2]) {
+        double a0 = Cross(b[0], b[1], a[0]);
+        double a1 = Cross(b[0], b[1], a[1]);
+        double b0 = Cross(a[0], a[1], b[0]);
+        double b1 = Cross(a[0], a[1], b[1]);
+        if (((a0 > 0 && a1 < 0) || (a0 < 0 && a1 > 0))
+                && ((b0 > 0 && b1 < 0) || (b0 < 0 && b1 > 0))) {
+            return true;
+        }
+        return (0 == a0 && OnSegment(b[0], b[1], a[0])) || (0 == a1 && OnSegment(b[0], b[1], a[1]))
+                || (0 == b0 && OnSegment(a[0], a[1], b[0]))
+                || (0 == b1 && OnSegment(a[0], a[1], b[1]));
+    }
+
+    // Returns true if lines that share an end meet anywhere else; they can only do so by
+    // doubling back over each other.
+    static bool JoinedLinesOverlap(const SkPoint a[2], const SkPoint b[2]) {
+        const SkPoint* shared;
+        const SkPoint* aOther;
+        const SkPoint* bOther;
+        if (a[1] == b[0]) {
+            shared = &a[1], aOther = &a[0], bOther = &b[1];
+        } else if (a[0] == b[1]) {
+            shared = &a[0], aOther = &a[1], bOther = &b[0];
+        } else {
+            return true;
+        }
+        if (a[0] == b[1] && a[1] == b[0]) {
+            return true;
+        }
+        if (0 != Cross(*shared, *aOther, *bOther)) {
+            return false;
+        }
+        double dot = ((double) aOther->fX - shared->fX) * ((double) bOther->fX - shared->fX)
+                + ((double) aOther->fY - shared->fY) * ((double) bOther->fY - shared->fY);
+        return dot > 0;
+    }
+
+    static void ChopAtHalf(const Piece& piece, Piece halves[2]) {
+        SkPoint chopped[7];
+        int ptCount = piece.fPtCount;
+        if (2 == ptCount) {
+            chopped[0] = piece.fPts[0];
+            chopped[1].set(SkScalarAve(piece.fPts[0].fX, piece.fPts[1].fX),
+                           SkScalarAve(piece.fPts[0].fY, piece.fPts[1].fY));
+            chopped[2] = piece.fPts[1];
+        } else if (3 == ptCount) {
+            SkChopQuadAtHalf(piece.fPts, chopped);
+        } else {
+            SkChopCubicAtHalf(piece.fPts, chopped);
+        }
+        for (int i = 0; i < 2; ++i) {
+            halves[i] = piece;
+            memcpy(halves[i].fPts, &chopped[i * (ptCount - 1)], ptCount * sizeof(SkPoint));
+            halves[i].fBounds.set(halves[i].fPts, ptCount);
+        }
+    }
+
+    // Returns true unless the pieces are shown not to meet. Bounds that still overlap after
+    // kMaxDepth halvings are taken as a meeting.
+    static bool PiecesMayTouch(const Piece& a, const Piece& b, int depth) {
+        if (!BoundsTouch(a.fBounds, b.fBounds)) {
+            return false;
+        }
+        if (2 == a.fPtCount && 2 == b.fPtCount) {
+            return LinesTouch(a.fPts, b.fPts);
+        }
+        if (depth >= kMaxDepth) {
+            return true;
+        }
+        const Piece& larger = a.fBounds.width() + a.fBounds.height()
+                >= b.fBounds.width() + b.fBounds.height() ? a : b;
+        const Piece& smaller = &larger == &a ? b : a;
+        Piece halves[2];
+        ChopAtHalf(larger, halves);
+        return PiecesMayTouch(halves[0], smaller, depth + 1)
+                || PiecesMayTouch(halves[1], smaller, depth + 1);
+    }
+
+    // Monotonic pieces that follow one another meet where they join. They meet nowhere else if
+    // their bounds only share an edge: a monotonic curve touches the edges of its bounds only at
+    // its ends.
+    static bool JoinedPiecesOverlap(const Piece& a, const Piece& b) {
+        if (2 == a.fPtCount && 2 == b.fPtCount) {
+            return JoinedLinesOverlap(a.fPts, b.fPts);
+        }
+        // A curve with no area in its bounds is a line SkReduceOrder didn't catch.
+        if ((2 != a.fPtCount && a.fBounds.isEmpty()) || (2 != b.fPtCount && b.fBounds.isEmpty())) {
+            return true;
+        }
+        SkRect common = a.fBounds;
+        return common.intersect(b.fBounds);
+    }
+
+    bool joined(const Piece& a, const Piece& b) const {
+        if (a.fContour != b.fContour) {
+            return false;
+        }
+        int last = fContours[a.fContour].fPieceCount - 1;
+        int delta = SkAbs32(a.fIndex - b.fIndex);
+        return 1 == delta || last == delta;
+    }
+
+    bool mayIntersect() {
+        SkTDArray<Piece*> sorted;
+        sorted.setCount(fPieces.count());
+        for (int i = 0; i < fPieces.count(); ++i) {
+            sorted[i] = &fPieces[i];
+        }
+        SkTQSort<Piece>(sorted.begin(), sorted.end() - 1);
+        for (int i = 0; i < sorted.count(); ++i) {
+            const Piece& a = *sorted[i];
+            for (int j = i + 1; j < sorted.count() && sorted[j]->fBounds.fLeft <= a.fBounds.fRight;
+                    ++j) {
+                const Piece& b = *sorted[j];
+                if (this->joined(a, b) ? JoinedPiecesOverlap(a, b) : PiecesMayTouch(a, b, 0)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // With no intersections, each contour is either inside another or outside it. Every region
+    // is then filled by the even-odd rule if it is inside an odd number of contours; for the
+    // winding rule to agree, the winding inside each contour must be zero exactly when it is
+    // nested inside an odd number of others.
+    bool windingMatchesEvenOdd() {
+        int count = fContours.count();
+        SkAutoSTMalloc<32, int> directions(count);
+        for (int i = 0; i < count; ++i) {
+            this->makePath(&fContours[i]);
+            SkPath::Direction dir;
+            if (!fContours[i].fPath.cheapComputeDirection(&dir)) {
+                return false;
+            }
+            directions[i] = SkPath::kCW_Direction == dir ? 1 : -1;
+        }
+        for (int i = 0; i < count; ++i) {
+            const Contour& inner = fContours[i];
+            const SkPoint& pt = fPieces[inner.fFirstPiece].fPts[0];
+            int depth = 0;
+            int winding = directions[i];
+            for (int j = 0; j < count; ++j) {
+                const Contour& outer = fContours[j];
+                if (i != j && outer.fBounds.contains(inner.fBounds)
+                        && outer.fPath.contains(pt.fX, pt.fY)) {
+                    ++depth;
+                    winding += directions[j];
+                }
+            }
+            if ((0 != winding) != !(depth & 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void makePath(Contour* contour) const {
+        for (int i = 0; i < contour->fPieceCount; ++i) {
+            const SkPoint* pts = fPieces[contour->fFirstPiece + i].fPts;
+            if (0 == i) {
+                contour->fPath.moveTo(pts[0]);
+            }
+            switch (fPieces[contour->fFirstPiece + i].fPtCount) {
+                case 2:
+                    contour->fPath.lineTo(pts[1]);
+                    break;
+                case 3:
+                    contour->fPath.quadTo(pts[1], pts[2]);
+                    break;
+                default:
+                    contour->fPath.cubicTo(pts[1], pts[2], pts[3]);
+                    break;
+            }
+        }
+        contour->fPath.close();
+    }
+
+    static const int kMaxDepth = 8;
+
+    SkTArray<Piece, true> fPieces;
+    SkTArray<Contour> fContours;
+    SkPoint fStart;
+    SkPoint fLast;
+    int fClosed;
+    bool fUnparseable;
+};
+
 // FIXME : add this as a member of SkPath
 bool Simplify(const SkPath& path, SkPath* result) {
+    SkOpAllocator allocator;
+    return Simplify(path, result, &allocator);
+}
+
+bool Simplify(const SkPath& path, SkPath* result, SkOpAllocator* allocator) {
 #if DEBUG_SORT || DEBUG_SWAP_TOP
     SkPathOpsDebug::gSortCount = SkPathOpsDebug::gSortCountDefault;
 #endif
@@ -159,9 +569,17 @@ bool Simplify(const SkPath& path, SkPath* result) {
     SkPath::FillType fillType = path.isInverseFillType() ? SkPath::kInverseEvenOdd_FillType
             : SkPath::kEvenOdd_FillType;
 
-    // turn path into list of segments
+    SkSimpleChecker checker;
+    if (checker.isSimple(path)) {
+        *result = path;
+        result->setFillType(fillType);
+        return true;
+    }
+
+    // turn path into list of segments; nothing from an earlier op is still using the allocator
+    allocator->rewind();
     SkTArray<SkOpContour> contours;
-    SkOpEdgeBuilder builder(path, contours);
+    SkOpEdgeBuilder builder(path, contours, allocator);
     if (!builder.finish()) {
         return false;
     }
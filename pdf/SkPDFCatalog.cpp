@@ -12,11 +12,15 @@
 #include "SkStream.h"
 #include "SkTypes.h"
 
-SkPDFCatalog::SkPDFCatalog(SkPDFDocument::Flags flags)
+SkPDFCatalog::SkPDFCatalog(SkPDFDocument::Flags flags, bool streaming)
     : fFirstPageCount(0),
       fNextObjNum(1),
       fNextFirstPageObjNum(0),
-      fDocumentFlags(flags) {
+      fDocumentFlags(flags),
+      fStreaming(streaming) {
+    if (SK_PDF_FLATE_THREAD_COUNT > 0) {
+        fFlateQueue.reset(SkNEW_ARGS(SkPDFFlateQueue, (SK_PDF_FLATE_THREAD_COUNT)));
+    }
 }
 
 SkPDFCatalog::~SkPDFCatalog() {
@@ -28,7 +32,10 @@ SkPDFObject* SkPDFCatalog::addObject(SkPDFObject* obj, bool onFirstPage) {
     if (findObjectIndex(obj) != -1) {  // object already added
         return obj;
     }
-    SkASSERT(fNextFirstPageObjNum == 0);
+    // A streaming catalog keeps growing after numbers have been handed out.
+    // That works because every object is numbered in order of first use.
+    SkASSERT(fNextFirstPageObjNum == 0 || fStreaming);
+    SkASSERT(!onFirstPage || !fStreaming);
     if (onFirstPage) {
         fFirstPageCount++;
     }
@@ -209,6 +216,51 @@ void SkPDFCatalog::emitSubstituteResources(SkWStream *stream, bool firstPage) {
     }
 }
 
+void SkPDFCatalog::startCompression() {
+    if (NULL == fFlateQueue.get()) {
+        return;
+    }
+    for (int i = 0; i < fCatalog.count(); i++) {
+        if (NULL != fCatalog[i].fObject) {
+            getSubstituteObject(fCatalog[i].fObject)->startCompression(this);
+        }
+    }
+    for (int i = 0; i < fSubstituteResourcesFirstPage.count(); ++i) {
+        fSubstituteResourcesFirstPage[i]->startCompression(this);
+    }
+    for (int i = 0; i < fSubstituteResourcesRemaining.count(); ++i) {
+        fSubstituteResourcesRemaining[i]->startCompression(this);
+    }
+}
+
+void SkPDFCatalog::emitStreamedObject(SkWStream* stream, size_t streamStart,
+                                      SkPDFObject* obj) {
+    SkASSERT(fStreaming);
+    int objIndex = assignObjNum(obj) - 1;
+    SkASSERT(fCatalog[objIndex].fObjNumAssigned);
+    SkASSERT(fCatalog[objIndex].fFileOffset == 0);
+    fCatalog[objIndex].fFileOffset = stream->bytesWritten() - streamStart;
+    obj->emit(stream, this, true);
+}
+
+void SkPDFCatalog::emitStreamedSubstituteResources(SkWStream* stream,
+                                                   size_t streamStart) {
+    SkASSERT(fSubstituteResourcesFirstPage.count() == 0);
+    SkTSet<SkPDFObject*>* targetSet = getSubstituteList(false);
+    for (int i = 0; i < targetSet->count(); ++i) {
+        emitStreamedObject(stream, streamStart, (*targetSet)[i]);
+    }
+}
+
+void SkPDFCatalog::releaseObject(SkPDFObject* obj) {
+    SkASSERT(fStreaming);
+    int objIndex = findObjectIndex(obj);
+    SkASSERT(objIndex >= 0);
+    SkASSERT(fCatalog[objIndex].fObjNumAssigned);
+    SkASSERT(fCatalog[objIndex].fFileOffset > 0);
+    fCatalog[objIndex].fObject = NULL;
+}
+
 SkTSet<SkPDFObject*>* SkPDFCatalog::getSubstituteList(bool firstPage) {
     return firstPage ? &fSubstituteResourcesFirstPage :
                        &fSubstituteResourcesRemaining;
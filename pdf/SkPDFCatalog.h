@@ -13,9 +13,17 @@
 #include <sys/types.h>
 
 #include "SkPDFDocument.h"
+#include "SkPDFFlateQueue.h"
 #include "SkPDFTypes.h"
 #include "SkRefCnt.h"
 #include "SkTDArray.h"
+#include "SkTemplates.h"
+
+// Number of threads used to deflate PDF streams in the background. Zero
+// compresses every stream on the thread that emits it.
+#ifndef SK_PDF_FLATE_THREAD_COUNT
+    #define SK_PDF_FLATE_THREAD_COUNT 4
+#endif
 
 /** \class SkPDFCatalog
 
@@ -25,8 +33,12 @@
 class SkPDFCatalog {
 public:
     /** Create a PDF catalog.
+     *  @param streaming   If true, objects are numbered in the order they are
+     *                     first referenced and are emitted one at a time with
+     *                     emitStreamedObject(), rather than being sized and
+     *                     placed up front.  There is no first page section.
      */
-    explicit SkPDFCatalog(SkPDFDocument::Flags flags);
+    explicit SkPDFCatalog(SkPDFDocument::Flags flags, bool streaming = false);
     ~SkPDFCatalog();
 
     /** Add the passed object to the catalog.  Refs obj.
@@ -60,6 +72,17 @@ public:
      */
     SkPDFDocument::Flags getDocumentFlags() const { return fDocumentFlags; }
 
+    /** Return the queue that streams compress their data on, or NULL if
+     *  streams should be compressed inline.
+     */
+    SkPDFFlateQueue* getFlateQueue() { return fFlateQueue.get(); }
+
+    /** Let every object in the catalog start compressing its data in the
+     *  background.  Documents call this once the objects are final and
+     *  before they are sized or emitted.
+     */
+    void startCompression();
+
     /** Output the cross reference table for objects in the catalog.
      *  Returns the total number of objects.
      *  @param stream      The writable output stream to send the output to.
@@ -88,6 +111,27 @@ public:
      */
     void emitSubstituteResources(SkWStream* stream, bool firstPage);
 
+    /** Streaming only: record the object's file offset as the current
+     *  position of the stream and emit it.
+     *  @param stream      The writable output stream to send the output to.
+     *  @param streamStart The value of stream->bytesWritten() at the start
+     *                     of the document.
+     *  @param obj         The object to emit, already added to the catalog.
+     */
+    void emitStreamedObject(SkWStream* stream, size_t streamStart,
+                            SkPDFObject* obj);
+
+    /** Streaming only: emit the resources of substitute objects.
+     */
+    void emitStreamedSubstituteResources(SkWStream* stream,
+                                         size_t streamStart);
+
+    /** Streaming only: forget the address of an object that has already been
+     *  emitted and is about to be freed.  Its xref entry is kept, but a new
+     *  object allocated at the same address will not be mistaken for it.
+     */
+    void releaseObject(SkPDFObject* obj);
+
 private:
     struct Rec {
         Rec(SkPDFObject* object, bool onFirstPage)
@@ -126,6 +170,8 @@ private:
     uint32_t fNextFirstPageObjNum;
 
     SkPDFDocument::Flags fDocumentFlags;
+    bool fStreaming;
+    SkAutoTDelete<SkPDFFlateQueue> fFlateQueue;
 
     int findObjectIndex(SkPDFObject* obj) const;
 
@@ -21,6 +21,7 @@
 #include "SkPDFFormXObject.h"
 #include "SkPDFGraphicState.h"
 #include "SkPDFImage.h"
+#include "SkPDFRasterReport.h"
 #include "SkPDFResourceDict.h"
 #include "SkPDFShader.h"
 #include "SkPDFStream.h"
@@ -31,6 +32,7 @@
 #include "SkString.h"
 #include "SkTextFormatParams.h"
 #include "SkTemplates.h"
+#include "SkThread.h"
 #include "SkTypefacePriv.h"
 #include "SkTSet.h"
 
@@ -2201,9 +2203,14 @@ void SkPDFDevice::internalDrawBitmap(const SkMatrix& origMatrix,
                                SkIntToScalar(subsetBitmap->height())));
         perspectiveOutline.transform(origMatrix);
 
-        // TODO(edisonn): perf - use current clip too.
-        // Retrieve the bounds of the new shape.
+        // Retrieve the bounds of the new shape. Only the part inside the clip
+        // can show, so that is all that needs to be rasterized.
         SkRect bounds = perspectiveOutline.getBounds();
+        SkRect clippedBounds;
+        if (!clippedBounds.intersect(bounds,
+                                     SkRect::Make(origClipRegion.getBounds()))) {
+            return;
+        }
 
         // Transform the bitmap in the new space, taking into
         // account the initial transform.
@@ -2231,9 +2238,11 @@ void SkPDFDevice::internalDrawBitmap(const SkMatrix& origMatrix,
         // the image.  Avoiding alpha will reduce the pdf size and generation
         // CPU time some.
 
-        const int w = SkScalarCeilToInt(physicalPerspectiveOutline.getBounds().width());
-        const int h = SkScalarCeilToInt(physicalPerspectiveOutline.getBounds().height());
-        if (!perspectiveBitmap.allocPixels(SkImageInfo::MakeN32Premul(w, h))) {
+        bounds = clippedBounds;
+        const int w = SkScalarCeilToInt(bounds.width() * scaleX);
+        const int h = SkScalarCeilToInt(bounds.height() * scaleY);
+        if (w <= 0 || h <= 0 ||
+            !perspectiveBitmap.allocPixels(SkImageInfo::MakeN32Premul(w, h))) {
             return;
         }
         perspectiveBitmap.eraseColor(SK_ColorTRANSPARENT);
@@ -2270,6 +2279,8 @@ void SkPDFDevice::internalDrawBitmap(const SkMatrix& origMatrix,
         clipRegion = &perspectiveBounds;
         srcRect = NULL;
         bitmap = &perspectiveBitmap;
+
+        SkPDFRasterReport::Report(this, perspectiveBounds.getBounds(), w, h);
     }
 
     SkMatrix scaled;
@@ -2309,3 +2320,29 @@ void SkPDFDevice::internalDrawBitmap(const SkMatrix& origMatrix,
 bool SkPDFDevice::allowImageFilter(const SkImageFilter*) {
     return false;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+SK_DECLARE_STATIC_MUTEX(gRasterReportMutex);
+static SkPDFRasterReport::Proc gRasterReportProc;
+static void* gRasterReportContext;
+
+void SkPDFRasterReport::SetProc(Proc proc, void* context) {
+    SkAutoMutexAcquire lock(gRasterReportMutex);
+    gRasterReportProc = proc;
+    gRasterReportContext = context;
+}
+
+void SkPDFRasterReport::Report(const SkPDFDevice* device,
+                               const SkIRect& bounds, int width, int height) {
+    Proc proc;
+    void* context;
+    {
+        SkAutoMutexAcquire lock(gRasterReportMutex);
+        proc = gRasterReportProc;
+        context = gRasterReportContext;
+    }
+    if (NULL != proc) {
+        proc(device, bounds, width, height, context);
+    }
+}
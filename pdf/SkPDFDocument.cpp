@@ -159,6 +159,10 @@ bool SkPDFDocument::emitPDF(SkWStream* stream) {
         // Build font subsetting info before proceeding.
         perform_font_subsetting(fCatalog.get(), fPages, &fSubstitutes);
 
+        // Everything is final now; let the streams deflate in the background
+        // while the xref offsets are worked out.
+        fCatalog->startCompression();
+
         // Figure out the size of things and inform the catalog of file offsets.
         off_t fileOffset = headerSize();
         fileOffset += fCatalog->setFileOffset(fDocCatalog, fileOffset);
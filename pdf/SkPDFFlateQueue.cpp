@@ -0,0 +1,126 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPDFFlateQueue.h"
+
+#include "SkFlate.h"
+#include "SkThread.h"
+#include "SkThreadUtils.h"
+
+SkPDFFlateQueue::Job::Job(SkPDFFlateQueue* queue, SkStream* input)
+    : fQueue(queue)
+    , fInput(SkRef(input))
+    , fStatus(kPending_Status) {
+}
+
+bool SkPDFFlateQueue::Job::claim() {
+    return sk_atomic_cas(&fStatus, kPending_Status, kRunning_Status);
+}
+
+void SkPDFFlateQueue::Job::run() {
+    SkDynamicMemoryWStream compressed;
+    if (SkFlate::Deflate(fInput.get(), &compressed)) {
+        fOutput.reset(compressed.copyToData());
+    }
+    fInput->rewind();
+}
+
+SkData* SkPDFFlateQueue::Job::finish() {
+    if (this->claim()) {
+        // Nobody else can touch the job any more, so there's nobody to tell.
+        this->run();
+        fStatus = kDone_Status;
+    } else if (!sk_atomic_cas(&fStatus, kDone_Status, kDone_Status)) {
+        // A worker is running it. Workers are joined before the queue goes
+        // away, so the queue is still alive.
+        fQueue->fCondVar.lock();
+        while (kDone_Status != fStatus) {
+            fQueue->fCondVar.wait();
+        }
+        fQueue->fCondVar.unlock();
+    }
+    return SkSafeRef(fOutput.get());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkPDFFlateQueue::SkPDFFlateQueue(int threadCount)
+    : fThreadCount(threadCount)
+    , fNextPending(0)
+    , fDone(false) {
+}
+
+SkPDFFlateQueue::~SkPDFFlateQueue() {
+    fCondVar.lock();
+    fDone = true;
+    fCondVar.broadcast();
+    fCondVar.unlock();
+
+    for (int i = 0; i < fThreads.count(); ++i) {
+        fThreads[i]->join();
+        SkDELETE(fThreads[i]);
+    }
+    for (int i = fNextPending; i < fPending.count(); ++i) {
+        fPending[i]->unref();
+    }
+}
+
+SkPDFFlateQueue::Job* SkPDFFlateQueue::deflate(SkStream* input) {
+    Job* job = SkNEW_ARGS(Job, (this, input));
+    if (fThreadCount <= 0) {
+        return job;  // finish() will run it.
+    }
+
+    if (fThreads.isEmpty()) {
+        for (int i = 0; i < fThreadCount; ++i) {
+            SkThread* thread = SkNEW_ARGS(SkThread, (SkPDFFlateQueue::WorkerMain, this));
+            if (!thread->start()) {
+                SkDELETE(thread);
+                break;
+            }
+            *fThreads.append() = thread;
+        }
+    }
+
+    fCondVar.lock();
+    *fPending.append() = SkRef(job);
+    fCondVar.broadcast();
+    fCondVar.unlock();
+    return job;
+}
+
+void SkPDFFlateQueue::WorkerMain(void* queue) {
+    static_cast<SkPDFFlateQueue*>(queue)->work();
+}
+
+void SkPDFFlateQueue::work() {
+    for (;;) {
+        fCondVar.lock();
+        while (!fDone && fNextPending == fPending.count()) {
+            fCondVar.wait();
+        }
+        if (fDone) {
+            fCondVar.unlock();
+            return;
+        }
+        Job* job = fPending[fNextPending++];
+        if (fNextPending == fPending.count()) {
+            fPending.rewind();
+            fNextPending = 0;
+        }
+        fCondVar.unlock();
+
+        if (job->claim()) {
+            job->run();
+            fCondVar.lock();
+            job->fStatus = Job::kDone_Status;
+            fCondVar.broadcast();
+            fCondVar.unlock();
+        }
+        job->unref();
+    }
+}
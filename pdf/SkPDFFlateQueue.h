@@ -0,0 +1,92 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPDFFlateQueue_DEFINED
+#define SkPDFFlateQueue_DEFINED
+
+#include "SkCondVar.h"
+#include "SkData.h"
+#include "SkRefCnt.h"
+#include "SkStream.h"
+#include "SkTDArray.h"
+
+class SkThread;
+
+/** \class SkPDFFlateQueue
+
+    A small pool of threads that deflates PDF stream data in the background.
+    Streams hand their data to deflate() as soon as it is final and collect
+    the result with Job::finish() when they are populated for output.  If a
+    job hasn't been picked up by then, finish() runs it on the calling thread,
+    so nothing ever waits on a job that hasn't started.
+*/
+class SkPDFFlateQueue : SkNoncopyable {
+public:
+    class Job : public SkRefCnt {
+    public:
+        SK_DECLARE_INST_COUNT(Job)
+
+        /** Returns the deflated data (reffed), or NULL if compression
+         *  failed.  Blocks if a worker is compressing it right now.  The
+         *  input stream may be used again once this returns.
+         */
+        SkData* finish();
+
+    private:
+        friend class SkPDFFlateQueue;
+
+        enum Status {
+            kPending_Status,
+            kRunning_Status,
+            kDone_Status,
+        };
+
+        Job(SkPDFFlateQueue* queue, SkStream* input);
+
+        // Returns true if the caller now owns the job and must run() it.
+        bool claim();
+        void run();
+
+        SkPDFFlateQueue* fQueue;
+        SkAutoTUnref<SkStream> fInput;
+        SkAutoTUnref<SkData> fOutput;
+        int32_t fStatus;
+
+        typedef SkRefCnt INHERITED;
+    };
+
+    /** Create a queue that uses up to threadCount worker threads, which are
+     *  started when the first job is queued.
+     */
+    explicit SkPDFFlateQueue(int threadCount);
+
+    /** Stops the workers.  Jobs that haven't started stay pending, and
+     *  finish() will run them inline.
+     */
+    ~SkPDFFlateQueue();
+
+    /** Queue input for compression.  Input must be at its start and must
+     *  not be read until the job is finished.  Returns a reffed job.
+     */
+    Job* deflate(SkStream* input);
+
+private:
+    static void WorkerMain(void* queue);
+    void work();
+
+    const int fThreadCount;
+    SkTDArray<SkThread*> fThreads;
+
+    // Guards fPending, fNextPending and fDone, and is broadcast when a job
+    // is queued or a worker finishes one.
+    SkCondVar fCondVar;
+    SkTDArray<Job*> fPending;
+    int fNextPending;
+    bool fDone;
+};
+
+#endif
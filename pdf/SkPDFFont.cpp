@@ -7,9 +7,11 @@
 
 #include <ctype.h>
 
+#include "SkChecksum.h"
 #include "SkData.h"
 #include "SkFontHost.h"
 #include "SkGlyphCache.h"
+#include "SkOTUtils.h"
 #include "SkPaint.h"
 #include "SkPDFCatalog.h"
 #include "SkPDFDevice.h"
@@ -610,7 +612,20 @@ static size_t get_subset_font_stream(const char* fontName,
     fontData->rewind();
 #else
     sk_ignore_unused_variable(fontName);
-    sk_ignore_unused_variable(subset);
+
+    // Keep only the outlines of the glyphs in use. Glyph IDs don't change,
+    // so the CIDToGIDMap can stay Identity.
+    if (subset.count() > 0) {
+        SkAutoTUnref<SkData> subsetFont(
+            SkOTUtils::SubsetFont(fontData.get(), subset.begin(), subset.count()));
+        if (subsetFont.get()) {
+            *fontStream = new SkPDFStream(subsetFont.get());
+            return subsetFont->size();
+        }
+        if (!fontData->rewind()) {
+            fontData.reset(typeface->openStream(&ttcIndex));
+        }
+    }
 #endif
 
     // Fail over: just embed the whole font.
@@ -728,23 +743,20 @@ SkPDFGlyphSet* SkPDFGlyphSetMap::getGlyphSetForFont(SkPDFFont* font) {
  */
 
 SkPDFFont::~SkPDFFont() {
-    SkAutoMutexAcquire lock(CanonicalFontsMutex());
-    int index = -1;
-    for (int i = 0 ; i < CanonicalFonts().count() ; i++) {
-        if (CanonicalFonts()[i].fFont == this) {
-            index = i;
+    {
+        SkAutoMutexAcquire lock(CanonicalFontsMutex());
+        uint32_t fontID = fTypeface->uniqueID();
+        TypefaceFonts* typefaceFonts = CanonicalFonts().find(fontID);
+        // Subset fonts aren't listed.
+        int index = typefaceFonts ? typefaceFonts->fFonts.find(this) : -1;
+        if (index >= 0) {
+            typefaceFonts->fFonts.removeShuffle(index);
+            if (typefaceFonts->fFonts.isEmpty()) {
+                CanonicalFonts().remove(fontID);
+                SkDELETE(typefaceFonts);
+            }
         }
     }
-
-    SkDEBUGCODE(int indexFound;)
-    SkASSERT(index == -1 ||
-             (Find(fTypeface->uniqueID(),
-                   fFirstGlyphID,
-                   &indexFound) &&
-             index == indexFound));
-    if (index >= 0) {
-        CanonicalFonts().removeShuffle(index);
-    }
     fResources.unrefAll();
 }
 
@@ -786,22 +798,59 @@ int SkPDFFont::glyphsToPDFFontEncoding(uint16_t* glyphIDs, int numGlyphs) {
 
 // static
 SkPDFFont* SkPDFFont::GetFontResource(SkTypeface* typeface, uint16_t glyphID) {
-    SkAutoMutexAcquire lock(CanonicalFontsMutex());
-
     SkAutoResolveDefaultTypeface autoResolve(typeface);
     typeface = autoResolve.get();
 
+    {
+        SkAutoMutexAcquire lock(CanonicalFontsMutex());
+        SkPDFFont* font = FindOrCreate(typeface, glyphID, false, NULL);
+        if (NULL != font) {
+            return font;
+        }
+    }
+
+    // The first font of a typeface needs its metrics, and getting them parses
+    // the font. Do that without holding the lock so that other documents can
+    // go on with their fonts meanwhile; if another thread adds a font for the
+    // typeface in the meantime, FindOrCreate() uses that one instead.
+
+    // TrueType fonts become Type0 fonts whose widths and ToUnicode entries
+    // are only looked up for the glyphs each subset uses (see
+    // SkPDFType0Font::populate()), so don't ask for them for every glyph in
+    // the font here. That can be tens of thousands of glyphs for CJK.
+    SkAutoTUnref<SkAdvancedTypefaceMetrics> fontMetrics(
+            typeface->getAdvancedTypefaceMetrics(
+                    SkAdvancedTypefaceMetrics::kNo_PerGlyphInfo, NULL, 0));
+    if (fontMetrics.get() &&
+        (fontMetrics->fType != SkAdvancedTypefaceMetrics::kTrueType_Font ||
+         fontMetrics->fMultiMaster)) {
+        SkAdvancedTypefaceMetrics::PerGlyphInfo info;
+        info = SkAdvancedTypefaceMetrics::kGlyphNames_PerGlyphInfo;
+        info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
+                  info, SkAdvancedTypefaceMetrics::kToUnicode_PerGlyphInfo);
+        info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
+                  info, SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo);
+        fontMetrics.reset(typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
+    }
+
+    SkAutoMutexAcquire lock(CanonicalFontsMutex());
+    return FindOrCreate(typeface, glyphID, true, fontMetrics.get());
+}
+
+// static
+SkPDFFont* SkPDFFont::FindOrCreate(SkTypeface* typeface, uint16_t glyphID,
+                                   bool haveMetrics,
+                                   SkAdvancedTypefaceMetrics* typefaceMetrics) {
     const uint32_t fontID = typeface->uniqueID();
-    int relatedFontIndex;
-    if (Find(fontID, glyphID, &relatedFontIndex)) {
-        CanonicalFonts()[relatedFontIndex].fFont->ref();
-        return CanonicalFonts()[relatedFontIndex].fFont;
+    SkPDFFont* relatedFont;
+    if (Find(fontID, glyphID, &relatedFont)) {
+        relatedFont->ref();
+        return relatedFont;
     }
 
     SkAutoTUnref<SkAdvancedTypefaceMetrics> fontMetrics;
     SkPDFDict* relatedFontDescriptor = NULL;
-    if (relatedFontIndex >= 0) {
-        SkPDFFont* relatedFont = CanonicalFonts()[relatedFontIndex].fFont;
+    if (NULL != relatedFont) {
         fontMetrics.reset(relatedFont->fontInfo());
         SkSafeRef(fontMetrics.get());
         relatedFontDescriptor = relatedFont->getFontDescriptor();
@@ -815,36 +864,23 @@ SkPDFFont* SkPDFFont::GetFontResource(SkTypeface* typeface, uint16_t glyphID) {
 
         if (fontType == SkAdvancedTypefaceMetrics::kType1CID_Font ||
             fontType == SkAdvancedTypefaceMetrics::kTrueType_Font) {
-            CanonicalFonts()[relatedFontIndex].fFont->ref();
-            return CanonicalFonts()[relatedFontIndex].fFont;
+            relatedFont->ref();
+            return relatedFont;
         }
+    } else if (haveMetrics) {
+        fontMetrics.reset(SkSafeRef(typefaceMetrics));
     } else {
-        SkAdvancedTypefaceMetrics::PerGlyphInfo info;
-        info = SkAdvancedTypefaceMetrics::kGlyphNames_PerGlyphInfo;
-        info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
-                  info, SkAdvancedTypefaceMetrics::kToUnicode_PerGlyphInfo);
-#if !defined (SK_SFNTLY_SUBSETTER)
-        info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
-                  info, SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo);
-#endif
-        fontMetrics.reset(
-            typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
-#if defined (SK_SFNTLY_SUBSETTER)
-        if (fontMetrics.get() &&
-            fontMetrics->fType != SkAdvancedTypefaceMetrics::kTrueType_Font) {
-            // Font does not support subsetting, get new info with advance.
-            info = SkTBitOr<SkAdvancedTypefaceMetrics::PerGlyphInfo>(
-                      info, SkAdvancedTypefaceMetrics::kHAdvance_PerGlyphInfo);
-            fontMetrics.reset(
-                typeface->getAdvancedTypefaceMetrics(info, NULL, 0));
-        }
-#endif
+        return NULL;
     }
 
     SkPDFFont* font = Create(fontMetrics.get(), typeface, glyphID,
                              relatedFontDescriptor);
-    FontRec newEntry(font, fontID, font->fFirstGlyphID);
-    CanonicalFonts().push(newEntry);
+    TypefaceFonts* typefaceFonts = CanonicalFonts().find(fontID);
+    if (NULL == typefaceFonts) {
+        typefaceFonts = SkNEW_ARGS(TypefaceFonts, (fontID));
+        CanonicalFonts().add(typefaceFonts);
+    }
+    typefaceFonts->fFonts.push(font);
     return font;  // Return the reference new SkPDFFont() created.
 }
 
@@ -853,9 +889,9 @@ SkPDFFont* SkPDFFont::getFontSubset(const SkPDFGlyphSet*) {
 }
 
 // static
-SkTDArray<SkPDFFont::FontRec>& SkPDFFont::CanonicalFonts() {
+SkPDFFont::FontHash& SkPDFFont::CanonicalFonts() {
     // This initialization is only thread safe with gcc.
-    static SkTDArray<FontRec> gCanonicalFonts;
+    static FontHash gCanonicalFonts;
     return gCanonicalFonts;
 }
 
@@ -868,18 +904,30 @@ SkBaseMutex& SkPDFFont::CanonicalFontsMutex() {
 }
 
 // static
-bool SkPDFFont::Find(uint32_t fontID, uint16_t glyphID, int* index) {
-    // TODO(vandebo): Optimize this, do only one search?
-    FontRec search(NULL, fontID, glyphID);
-    *index = CanonicalFonts().find(search);
-    if (*index >= 0) {
-        return true;
+bool SkPDFFont::Find(uint32_t fontID, uint16_t glyphID, SkPDFFont** font) {
+    *font = NULL;
+    TypefaceFonts* typefaceFonts = CanonicalFonts().find(fontID);
+    if (NULL == typefaceFonts) {
+        return false;
+    }
+    const SkTDArray<SkPDFFont*>& fonts = typefaceFonts->fFonts;
+    SkASSERT(!fonts.isEmpty());
+    for (int i = 0; i < fonts.count(); i++) {
+        if (glyphID == 0 || (fonts[i]->fFirstGlyphID <= glyphID &&
+                             glyphID <= fonts[i]->fLastGlyphID)) {
+            *font = fonts[i];
+            return true;
+        }
     }
-    search.fGlyphID = 0;
-    *index = CanonicalFonts().find(search);
+    *font = fonts[0];
     return false;
 }
 
+// static
+uint32_t SkPDFFont::TypefaceFonts::Hash(const uint32_t& fontID) {
+    return SkChecksum::Murmur3(&fontID, sizeof(fontID));
+}
+
 SkPDFFont::SkPDFFont(SkAdvancedTypefaceMetrics* info, SkTypeface* typeface,
                      SkPDFDict* relatedFontDescriptor)
         : SkPDFDict("Font"),
@@ -1004,34 +1052,6 @@ void SkPDFFont::adjustGlyphRangeForSingleByteEncoding(int16_t glyphID) {
     }
 }
 
-bool SkPDFFont::FontRec::operator==(const SkPDFFont::FontRec& b) const {
-    if (fFontID != b.fFontID) {
-        return false;
-    }
-    if (fFont != NULL && b.fFont != NULL) {
-        return fFont->fFirstGlyphID == b.fFont->fFirstGlyphID &&
-            fFont->fLastGlyphID == b.fFont->fLastGlyphID;
-    }
-    if (fGlyphID == 0 || b.fGlyphID == 0) {
-        return true;
-    }
-
-    if (fFont != NULL) {
-        return fFont->fFirstGlyphID <= b.fGlyphID &&
-            b.fGlyphID <= fFont->fLastGlyphID;
-    } else if (b.fFont != NULL) {
-        return b.fFont->fFirstGlyphID <= fGlyphID &&
-            fGlyphID <= b.fFont->fLastGlyphID;
-    }
-    return fGlyphID == b.fGlyphID;
-}
-
-SkPDFFont::FontRec::FontRec(SkPDFFont* font, uint32_t fontID, uint16_t glyphID)
-    : fFont(font),
-      fFontID(fontID),
-      fGlyphID(glyphID) {
-}
-
 void SkPDFFont::populateToUnicodeTable(const SkPDFGlyphSet* subset) {
     if (fFontInfo == NULL || fFontInfo->fGlyphToUnicode.begin() == NULL) {
         return;
@@ -1082,6 +1102,19 @@ bool SkPDFType0Font::populate(const SkPDFGlyphSet* subset) {
     descendantFonts->append(new SkPDFObjRef(newCIDFont.get()))->unref();
     insert("DescendantFonts", descendantFonts.get());
 
+    // TrueType fonts are created without a ToUnicode table (see
+    // GetFontResource()), so get one that only covers this subset.
+    if (fontInfo()->fGlyphToUnicode.isEmpty() && subset) {
+        SkTDArray<uint32_t> glyphIDs;
+        subset->exportTo(&glyphIDs);
+        if (glyphIDs.count()) {
+            SkAutoTUnref<SkAdvancedTypefaceMetrics> fontMetrics(
+                typeface()->getAdvancedTypefaceMetrics(
+                        SkAdvancedTypefaceMetrics::kToUnicode_PerGlyphInfo,
+                        glyphIDs.begin(), glyphIDs.count()));
+            setFontInfo(fontMetrics.get());
+        }
+    }
     populateToUnicodeTable(subset);
 
     SkDEBUGCODE(fPopulated = true);
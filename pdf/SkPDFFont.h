@@ -14,6 +14,7 @@
 #include "SkBitSet.h"
 #include "SkPDFTypes.h"
 #include "SkTDArray.h"
+#include "SkTDynamicHash.h"
 #include "SkThread.h"
 #include "SkTypeface.h"
 
@@ -168,19 +169,39 @@ protected:
                              SkTypeface* typeface, uint16_t glyphID,
                              SkPDFDict* relatedFontDescriptor);
 
-    static bool Find(uint32_t fontID, uint16_t glyphID, int* index);
+    /** Looks for the font of the typeface fontID that covers glyphID (any
+     *  font of the typeface if glyphID is 0). Returns true if there is one,
+     *  and stores it in font. Otherwise returns false and stores another font
+     *  of the typeface, or NULL if there is none, in font.
+     *  CanonicalFontsMutex() should already be acquired.
+     */
+    static bool Find(uint32_t fontID, uint16_t glyphID, SkPDFFont** font);
 
 private:
-    class FontRec {
+    // The fonts made for one typeface: more than one for large Type1 fonts.
+    class TypefaceFonts {
     public:
-        SkPDFFont* fFont;
-        uint32_t fFontID;
-        uint16_t fGlyphID;
+        explicit TypefaceFonts(uint32_t fontID) : fFontID(fontID) {}
+
+        static const uint32_t& GetKey(const TypefaceFonts& fonts) {
+            return fonts.fFontID;
+        }
+        static uint32_t Hash(const uint32_t& fontID);
 
-        // A fGlyphID of 0 with no fFont always matches.
-        bool operator==(const FontRec& b) const;
-        FontRec(SkPDFFont* font, uint32_t fontID, uint16_t fGlyphID);
+        uint32_t fFontID;
+        SkTDArray<SkPDFFont*> fFonts;
     };
+    typedef SkTDynamicHash<TypefaceFonts, uint32_t> FontHash;
+
+    /** Returns a ref on the canonical font for the glyph. If there is none,
+     *  makes it when it can take its metrics from another font of the
+     *  typeface, or when haveMetrics is set, from typefaceMetrics. Returns
+     *  NULL when the typeface's metrics are needed first.
+     *  CanonicalFontsMutex() should already be acquired.
+     */
+    static SkPDFFont* FindOrCreate(SkTypeface* typeface, uint16_t glyphID,
+                                   bool haveMetrics,
+                                   SkAdvancedTypefaceMetrics* typefaceMetrics);
 
     SkAutoTUnref<SkTypeface> fTypeface;
 
@@ -196,8 +217,7 @@ private:
 
     SkAdvancedTypefaceMetrics::FontType fFontType;
 
-    // This should be made a hash table if performance is a problem.
-    static SkTDArray<FontRec>& CanonicalFonts();
+    static FontHash& CanonicalFonts();
     static SkBaseMutex& CanonicalFontsMutex();
     typedef SkPDFDict INHERITED;
 };
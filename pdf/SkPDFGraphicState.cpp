@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkChecksum.h"
 #include "SkPDFFormXObject.h"
 #include "SkPDFGraphicState.h"
 #include "SkPDFUtils.h"
@@ -52,13 +53,16 @@ static const char* blend_mode_from_xfermode(SkXfermode::Mode mode) {
     return NULL;
 }
 
+// The soft mask graphic states aren't canonicalized, so they only share these
+// with each other and keep out of the way of GetGraphicStateForPaint().
+SK_DECLARE_STATIC_MUTEX(gInvertFunctionMutex);
+SK_DECLARE_STATIC_MUTEX(gNoSMaskGraphicStateMutex);
+
 SkPDFGraphicState::~SkPDFGraphicState() {
-    SkAutoMutexAcquire lock(CanonicalPaintsMutex());
     if (!fSMask) {
-        int index = Find(fPaint);
-        SkASSERT(index >= 0);
-        SkASSERT(CanonicalPaints()[index].fGraphicState == this);
-        CanonicalPaints().removeShuffle(index);
+        SkAutoMutexAcquire lock(CanonicalPaintsMutex());
+        SkASSERT(CanonicalPaints().find(fKey) == this);
+        CanonicalPaints().remove(fKey);
     }
     fResources.unrefAll();
 }
@@ -82,10 +86,9 @@ size_t SkPDFGraphicState::getOutputSize(SkPDFCatalog* catalog, bool indirect) {
 }
 
 // static
-SkTDArray<SkPDFGraphicState::GSCanonicalEntry>&
-SkPDFGraphicState::CanonicalPaints() {
+SkPDFGraphicState::GSHash& SkPDFGraphicState::CanonicalPaints() {
     // This initialization is only thread safe with gcc.
-    static SkTDArray<SkPDFGraphicState::GSCanonicalEntry> gCanonicalPaints;
+    static GSHash gCanonicalPaints;
     return gCanonicalPaints;
 }
 
@@ -100,20 +103,21 @@ SkBaseMutex& SkPDFGraphicState::CanonicalPaintsMutex() {
 // static
 SkPDFGraphicState* SkPDFGraphicState::GetGraphicStateForPaint(
         const SkPaint& paint) {
+    GSKey key(paint);
     SkAutoMutexAcquire lock(CanonicalPaintsMutex());
-    int index = Find(paint);
-    if (index >= 0) {
-        CanonicalPaints()[index].fGraphicState->ref();
-        return CanonicalPaints()[index].fGraphicState;
+    SkPDFGraphicState* result = CanonicalPaints().find(key);
+    if (NULL != result) {
+        result->ref();
+        return result;
     }
-    GSCanonicalEntry newEntry(new SkPDFGraphicState(paint));
-    CanonicalPaints().push(newEntry);
-    return newEntry.fGraphicState;
+    result = new SkPDFGraphicState(paint);
+    CanonicalPaints().add(result);
+    return result;
 }
 
 // static
 SkPDFObject* SkPDFGraphicState::GetInvertFunction() {
-    // This assumes that canonicalPaintsMutex is held.
+    SkAutoMutexAcquire lock(gInvertFunctionMutex);
     static SkPDFStream* invertFunction = NULL;
     if (!invertFunction) {
         // Acrobat crashes if we use a type 0 function, kpdf crashes if we use
@@ -140,8 +144,6 @@ SkPDFGraphicState* SkPDFGraphicState::GetSMaskGraphicState(
         SkPDFFormXObject* sMask, bool invert, SkPDFSMaskMode sMaskMode) {
     // The practical chances of using the same mask more than once are unlikely
     // enough that it's not worth canonicalizing.
-    SkAutoMutexAcquire lock(CanonicalPaintsMutex());
-
     SkAutoTUnref<SkPDFDict> sMaskDict(new SkPDFDict("Mask"));
     if (sMaskMode == kAlpha_SMaskMode) {
         sMaskDict->insertName("S", "Alpha");
@@ -170,7 +172,7 @@ SkPDFGraphicState* SkPDFGraphicState::GetSMaskGraphicState(
 
 // static
 SkPDFGraphicState* SkPDFGraphicState::GetNoSMaskGraphicState() {
-    SkAutoMutexAcquire lock(CanonicalPaintsMutex());
+    SkAutoMutexAcquire lock(gNoSMaskGraphicStateMutex);
     static SkPDFGraphicState* noSMaskGS = NULL;
     if (!noSMaskGS) {
         noSMaskGS = new SkPDFGraphicState;
@@ -183,24 +185,20 @@ SkPDFGraphicState* SkPDFGraphicState::GetNoSMaskGraphicState() {
     return noSMaskGS;
 }
 
-// static
-int SkPDFGraphicState::Find(const SkPaint& paint) {
-    GSCanonicalEntry search(&paint);
-    return CanonicalPaints().find(search);
-}
-
 SkPDFGraphicState::SkPDFGraphicState()
     : fPopulated(false),
-      fSMask(false) {
+      fSMask(false),
+      fKey(fPaint) {
 }
 
 SkPDFGraphicState::SkPDFGraphicState(const SkPaint& paint)
     : fPaint(paint),
       fPopulated(false),
-      fSMask(false) {
+      fSMask(false),
+      fKey(fPaint) {
 }
 
-// populateDict and operator== have to stay in sync with each other.
+// populateDict and GSKey have to stay in sync with each other.
 void SkPDFGraphicState::populateDict() {
     if (!fPopulated) {
         fPopulated = true;
@@ -243,46 +241,42 @@ void SkPDFGraphicState::populateDict() {
     }
 }
 
-// We're only interested in some fields of the SkPaint, so we have a custom
-// operator== function.
-bool SkPDFGraphicState::GSCanonicalEntry::operator==(
-        const SkPDFGraphicState::GSCanonicalEntry& gs) const {
-    const SkPaint* a = fPaint;
-    const SkPaint* b = gs.fPaint;
-    SkASSERT(a != NULL);
-    SkASSERT(b != NULL);
-
-    if (SkColorGetA(a->getColor()) != SkColorGetA(b->getColor()) ||
-           a->getStrokeCap() != b->getStrokeCap() ||
-           a->getStrokeJoin() != b->getStrokeJoin() ||
-           a->getStrokeWidth() != b->getStrokeWidth() ||
-           a->getStrokeMiter() != b->getStrokeMiter()) {
-        return false;
+// We're only interested in some fields of the SkPaint, so the canonical key
+// only holds those.
+SkPDFGraphicState::GSKey::GSKey(const SkPaint& paint)
+    : fAlpha(SkColorGetA(paint.getColor())),
+      fStrokeCap(paint.getStrokeCap()),
+      fStrokeJoin(paint.getStrokeJoin()),
+      fStrokeWidth(paint.getStrokeWidth()),
+      fStrokeMiter(paint.getStrokeMiter()) {
+    SkXfermode::Mode xfermode = SkXfermode::kSrcOver_Mode;
+    if (paint.getXfermode()) {
+        paint.getXfermode()->asMode(&xfermode);
     }
-
-    SkXfermode::Mode aXfermodeName = SkXfermode::kSrcOver_Mode;
-    SkXfermode* aXfermode = a->getXfermode();
-    if (aXfermode) {
-        aXfermode->asMode(&aXfermodeName);
+    const char* blendMode = NULL;
+    if (xfermode >= 0 && xfermode <= SkXfermode::kLastMode) {
+        blendMode = blend_mode_from_xfermode(xfermode);
     }
-    if (aXfermodeName < 0 || aXfermodeName > SkXfermode::kLastMode ||
-            blend_mode_from_xfermode(aXfermodeName) == NULL) {
-        aXfermodeName = SkXfermode::kSrcOver_Mode;
+    // Modes written as the same blend mode (or not written at all) are the
+    // same to the graphic state.
+    if (blendMode == NULL || strcmp(blendMode, "Normal") == 0) {
+        xfermode = SkXfermode::kSrcOver_Mode;
     }
-    const char* aXfermodeString = blend_mode_from_xfermode(aXfermodeName);
-    SkASSERT(aXfermodeString != NULL);
+    fBlendMode = xfermode;
+}
 
-    SkXfermode::Mode bXfermodeName = SkXfermode::kSrcOver_Mode;
-    SkXfermode* bXfermode = b->getXfermode();
-    if (bXfermode) {
-        bXfermode->asMode(&bXfermodeName);
-    }
-    if (bXfermodeName < 0 || bXfermodeName > SkXfermode::kLastMode ||
-            blend_mode_from_xfermode(bXfermodeName) == NULL) {
-        bXfermodeName = SkXfermode::kSrcOver_Mode;
-    }
-    const char* bXfermodeString = blend_mode_from_xfermode(bXfermodeName);
-    SkASSERT(bXfermodeString != NULL);
+bool SkPDFGraphicState::GSKey::operator==(const GSKey& b) const {
+    return fAlpha == b.fAlpha &&
+           fStrokeCap == b.fStrokeCap &&
+           fStrokeJoin == b.fStrokeJoin &&
+           fBlendMode == b.fBlendMode &&
+           fStrokeWidth == b.fStrokeWidth &&
+           fStrokeMiter == b.fStrokeMiter;
+}
 
-    return strcmp(aXfermodeString, bXfermodeString) == 0;
+// static
+uint32_t SkPDFGraphicState::Hash(const GSKey& key) {
+    SK_COMPILE_ASSERT(sizeof(GSKey) == 6 * sizeof(uint32_t), GSKey_has_padding);
+    return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(&key),
+                               sizeof(key));
 }
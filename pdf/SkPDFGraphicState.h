@@ -12,6 +12,7 @@
 
 #include "SkPaint.h"
 #include "SkPDFTypes.h"
+#include "SkTDynamicHash.h"
 #include "SkTemplates.h"
 #include "SkThread.h"
 
@@ -79,22 +80,29 @@ private:
     bool fPopulated;
     bool fSMask;
 
-    class GSCanonicalEntry {
-    public:
-        SkPDFGraphicState* fGraphicState;
-        const SkPaint* fPaint;
-
-        bool operator==(const GSCanonicalEntry& b) const;
-        explicit GSCanonicalEntry(SkPDFGraphicState* gs)
-            : fGraphicState(gs),
-              fPaint(&gs->fPaint) {}
-        explicit GSCanonicalEntry(const SkPaint* paint)
-            : fGraphicState(NULL),
-              fPaint(paint) {}
+    // The parts of the paint the graphic state uses, with the xfermode
+    // reduced to the blend mode it is written as.
+    struct GSKey {
+        uint32_t fAlpha;
+        uint32_t fStrokeCap;
+        uint32_t fStrokeJoin;
+        uint32_t fBlendMode;
+        SkScalar fStrokeWidth;
+        SkScalar fStrokeMiter;
+
+        explicit GSKey(const SkPaint& paint);
+        bool operator==(const GSKey& b) const;
     };
+    const GSKey fKey;
 
-    // This should be made a hash table if performance is a problem.
-    static SkTDArray<GSCanonicalEntry>& CanonicalPaints();
+    static const GSKey& GetKey(const SkPDFGraphicState& gs) {
+        return gs.fKey;
+    }
+    static uint32_t Hash(const GSKey& key);
+
+    typedef SkTDynamicHash<SkPDFGraphicState, GSKey> GSHash;
+    friend class SkTDynamicHash<SkPDFGraphicState, GSKey>;
+    static GSHash& CanonicalPaints();
     static SkBaseMutex& CanonicalPaintsMutex();
 
     SkPDFGraphicState();
@@ -104,7 +112,6 @@ private:
 
     static SkPDFObject* GetInvertFunction();
 
-    static int Find(const SkPaint& paint);
     typedef SkPDFDict INHERITED;
 };
 
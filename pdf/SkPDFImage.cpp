@@ -13,6 +13,7 @@
 #include "SkData.h"
 #include "SkFlate.h"
 #include "SkPDFCatalog.h"
+#include "SkPixelRef.h"
 #include "SkRect.h"
 #include "SkStream.h"
 #include "SkString.h"
@@ -436,6 +437,119 @@ static SkBitmap unpremultiply_bitmap(const SkBitmap& bitmap,
     return outBitmap;
 }
 
+/**
+ *  Reads the dimensions and component count of a baseline or progressive
+ *  Huffman coded JPEG, the kinds every DCTDecode filter reads. Returns false
+ *  for anything else.
+ */
+static bool get_jpeg_info(const SkData* data, int* width, int* height, int* components) {
+    const uint8_t* bytes = data->bytes();
+    const size_t size = data->size();
+    if (size < 4 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+        return false;
+    }
+    size_t offset = 2;
+    while (offset + 4 <= size) {
+        if (bytes[offset] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = bytes[offset + 1];
+        if (marker == 0xFF) {
+            // Fill byte before the marker.
+            ++offset;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            // No segment follows these.
+            offset += 2;
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA) {
+            // The end of the image or the first scan, before any frame header.
+            return false;
+        }
+        const size_t length = (bytes[offset + 2] << 8) | bytes[offset + 3];
+        if (length < 2 || offset + 2 + length > size) {
+            return false;
+        }
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 &&
+                marker != 0xCC) {
+            // Only the Huffman coded, non-differential frames can be embedded.
+            const uint8_t* frame = bytes + offset + 4;
+            if ((marker != 0xC0 && marker != 0xC1 && marker != 0xC2) || length < 8 ||
+                    frame[0] != 8) {
+                return false;
+            }
+            *height = (frame[1] << 8) | frame[2];
+            *width = (frame[3] << 8) | frame[4];
+            *components = frame[5];
+            return true;
+        }
+        offset += 2 + length;
+    }
+    return false;
+}
+
+/**
+ *  Returns the encoded JPEG behind the bitmap if it can be embedded in place
+ *  of the pixels: the bitmap must show all of it, unchanged, and the JPEG must
+ *  be gray or RGB (Adobe's CMYK JPEGs store inverted values).
+ */
+static SkData* ref_embeddable_jpeg(const SkBitmap& bitmap, const SkIRect& srcRect,
+                                   int* components) {
+    SkPixelRef* pixelRef = bitmap.pixelRef();
+    if (NULL == pixelRef || !bitmap.isOpaque() ||
+            bitmap.config() == SkBitmap::kA8_Config ||
+            srcRect != SkIRect::MakeWH(bitmap.width(), bitmap.height()) ||
+            bitmap.pixelRefOrigin() != SkIPoint::Make(0, 0) ||
+            pixelRef->info().fWidth != bitmap.width() ||
+            pixelRef->info().fHeight != bitmap.height()) {
+        return NULL;
+    }
+    SkAutoTUnref<SkData> data(pixelRef->refEncodedData());
+    int width, height;
+    if (NULL == data.get() || !get_jpeg_info(data, &width, &height, components) ||
+            width != bitmap.width() || height != bitmap.height() ||
+            (*components != 1 && *components != 3)) {
+        return NULL;
+    }
+    return data.detach();
+}
+
+SkPDFImage::ImageCanonicalEntry::ImageCanonicalEntry(const SkBitmap& bitmap,
+                                                     const SkIRect& srcRect,
+                                                     SkPicture::EncodeBitmap encoder)
+    : fImage(NULL),
+      fGenerationID(bitmap.getGenerationID()),
+      fPixelRefOrigin(bitmap.pixelRefOrigin()),
+      fSize(SkISize::Make(bitmap.width(), bitmap.height())),
+      fSrcRect(srcRect),
+      fEncoder(encoder) {
+}
+
+bool SkPDFImage::ImageCanonicalEntry::operator==(const ImageCanonicalEntry& b) const {
+    return fGenerationID == b.fGenerationID &&
+           fPixelRefOrigin == b.fPixelRefOrigin &&
+           fSize == b.fSize &&
+           fSrcRect == b.fSrcRect &&
+           fEncoder == b.fEncoder;
+}
+
+// static
+SkTDArray<SkPDFImage::ImageCanonicalEntry>& SkPDFImage::CanonicalImages() {
+    // This initialization is only thread safe with gcc.
+    static SkTDArray<ImageCanonicalEntry> gCanonicalImages;
+    return gCanonicalImages;
+}
+
+// static
+SkBaseMutex& SkPDFImage::CanonicalImagesMutex() {
+    // This initialization is only thread safe with gcc or when
+    // POD-style mutex initialization is used.
+    SK_DECLARE_STATIC_MUTEX(gCanonicalImagesMutex);
+    return gCanonicalImagesMutex;
+}
+
 // static
 SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
                                     const SkIRect& srcRect,
@@ -444,6 +558,31 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
         return NULL;
     }
 
+    // Bitmaps without pixels have no generation ID to canonicalize on.
+    ImageCanonicalEntry entry(bitmap, srcRect, encoder);
+    bool canonicalize = entry.fGenerationID != 0;
+    SkAutoMutexAcquire lock(CanonicalImagesMutex());
+    if (canonicalize) {
+        int index = CanonicalImages().find(entry);
+        if (index >= 0) {
+            CanonicalImages()[index].fImage->ref();
+            return CanonicalImages()[index].fImage;
+        }
+    }
+
+    SkPDFImage* image;
+    int jpegComponents;
+    SkAutoTUnref<SkData> jpegData(ref_embeddable_jpeg(bitmap, srcRect, &jpegComponents));
+    if (NULL != jpegData.get()) {
+        image = SkNEW_ARGS(SkPDFImage, (jpegData, bitmap, jpegComponents));
+        if (canonicalize) {
+            image->fCanonical = true;
+            entry.fImage = image;
+            CanonicalImages().push(entry);
+        }
+        return image;
+    }
+
     bool isTransparent = false;
     SkAutoTUnref<SkStream> alphaData;
     if (!bitmap.isOpaque()) {
@@ -458,7 +597,6 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
         return NULL;
     }
 
-    SkPDFImage* image;
     SkBitmap::Config config = bitmap.config();
     if (alphaData.get() != NULL && (config == SkBitmap::kARGB_8888_Config ||
             config == SkBitmap::kARGB_4444_Config)) {
@@ -476,10 +614,25 @@ SkPDFImage* SkPDFImage::CreateImage(const SkBitmap& bitmap,
         image->addSMask(mask);
     }
 
+    if (canonicalize) {
+        image->fCanonical = true;
+        entry.fImage = image;
+        CanonicalImages().push(entry);
+    }
     return image;
 }
 
 SkPDFImage::~SkPDFImage() {
+    if (fCanonical) {
+        SkAutoMutexAcquire lock(CanonicalImagesMutex());
+        int count = CanonicalImages().count();
+        for (int i = 0; i < count; ++i) {
+            if (CanonicalImages()[i].fImage == this) {
+                CanonicalImages().removeShuffle(i);
+                break;
+            }
+        }
+    }
     fResources.unrefAll();
 }
 
@@ -495,6 +648,21 @@ void SkPDFImage::getResources(const SkTSet<SkPDFObject*>& knownResourceObjects,
     GetResourcesHelper(&fResources, knownResourceObjects, newResourceObjects);
 }
 
+void SkPDFImage::startCompression(SkPDFCatalog* catalog) {
+    // DCT encoding calls back into the client's encoder, which need not be
+    // thread safe, so only images that will be flate compressed go async.
+    if (getState() != kUnused_State || (fEncoder && !skip_compression(catalog))) {
+        return;
+    }
+    if (!fStreamValid) {
+        SkAutoTUnref<SkStream> stream(
+                extract_image_data(fBitmap, fSrcRect, fIsAlpha, NULL));
+        setData(stream);
+        fStreamValid = true;
+    }
+    INHERITED::startCompression(catalog);
+}
+
 SkPDFImage::SkPDFImage(SkStream* stream,
                        const SkBitmap& bitmap,
                        bool isAlpha,
@@ -502,7 +670,8 @@ SkPDFImage::SkPDFImage(SkStream* stream,
                        SkPicture::EncodeBitmap encoder)
     : fIsAlpha(isAlpha),
       fSrcRect(srcRect),
-      fEncoder(encoder) {
+      fEncoder(encoder),
+      fCanonical(false) {
 
     if (bitmap.isImmutable()) {
         fBitmap = bitmap;
@@ -571,13 +740,36 @@ SkPDFImage::SkPDFImage(SkStream* stream,
     }
 }
 
+SkPDFImage::SkPDFImage(SkData* jpegData, const SkBitmap& bitmap, int components)
+    : fBitmap(bitmap),
+      fIsAlpha(false),
+      fSrcRect(SkIRect::MakeWH(bitmap.width(), bitmap.height())),
+      fEncoder(NULL),
+      fStreamValid(true),
+      fCanonical(false) {
+    // The pixels are never read, so there is no need to copy (or decode) them.
+    setData(jpegData);
+
+    insertName("Type", "XObject");
+    insertName("Subtype", "Image");
+    insertInt("Width", fSrcRect.width());
+    insertInt("Height", fSrcRect.height());
+    insertName("ColorSpace", 1 == components ? "DeviceGray" : "DeviceRGB");
+    insertInt("BitsPerComponent", 8);
+    // The JPEG's own markers say whether its colors need to be transformed.
+    insertName("Filter", "DCTDecode");
+    insertInt("Length", jpegData->size());
+    setState(kCompressed_State);
+}
+
 SkPDFImage::SkPDFImage(SkPDFImage& pdfImage)
     : SkPDFStream(pdfImage),
       fBitmap(pdfImage.fBitmap),
       fIsAlpha(pdfImage.fIsAlpha),
       fSrcRect(pdfImage.fSrcRect),
       fEncoder(pdfImage.fEncoder),
-      fStreamValid(pdfImage.fStreamValid) {
+      fStreamValid(pdfImage.fStreamValid),
+      fCanonical(false) {
     // Nothing to do here - the image params are already copied in SkPDFStream's
     // constructor, and the bitmap will be regenerated and encoded in
     // populate.
@@ -15,8 +15,10 @@
 #include "SkPDFStream.h"
 #include "SkPDFTypes.h"
 #include "SkRefCnt.h"
+#include "SkThread.h"
 
 class SkBitmap;
+class SkData;
 class SkPDFCatalog;
 struct SkIRect;
 
@@ -25,17 +27,18 @@ struct SkIRect;
     An image XObject.
 */
 
-// We could play the same trick here as is done in SkPDFGraphicState, storing
-// a copy of the Bitmap object (not the pixels), the pixel generation number,
-// and settings used from the paint to canonicalize image objects.
+// Like SkPDFGraphicState, image objects are canonicalized: drawing the same
+// pixels (by generation ID) with the same subset and encoder again reuses the
+// image, so it is only encoded and written once per document.
 class SkPDFImage : public SkPDFStream {
 public:
-    /** Create a new Image XObject to represent the passed bitmap.
+    /** Create a new Image XObject to represent the passed bitmap, or return
+     *  the existing one for the same pixels, subset and encoder.
      *  @param bitmap   The image to encode.
      *  @param srcRect  The rectangle to cut out of bitmap.
      *  @param paint    Used to calculate alpha, masks, etc.
      *  @return  The image XObject or NUll if there is nothing to draw for
-     *           the given parameters.
+     *           the given parameters. The caller owns a reference.
      */
     static SkPDFImage* CreateImage(const SkBitmap& bitmap,
                                    const SkIRect& srcRect,
@@ -56,6 +59,7 @@ public:
     // The SkPDFObject interface.
     virtual void getResources(const SkTSet<SkPDFObject*>& knownResourceObjects,
                               SkTSet<SkPDFObject*>* newResourceObjects);
+    virtual void startCompression(SkPDFCatalog* catalog);
 
 private:
     SkBitmap fBitmap;
@@ -63,9 +67,29 @@ private:
     SkIRect fSrcRect;
     SkPicture::EncodeBitmap fEncoder;
     bool fStreamValid;
+    bool fCanonical;
 
     SkTDArray<SkPDFObject*> fResources;
 
+    class ImageCanonicalEntry {
+    public:
+        SkPDFImage* fImage;
+        uint32_t fGenerationID;
+        SkIPoint fPixelRefOrigin;
+        SkISize fSize;
+        SkIRect fSrcRect;
+        SkPicture::EncodeBitmap fEncoder;
+
+        // Compares everything but fImage.
+        bool operator==(const ImageCanonicalEntry& b) const;
+        ImageCanonicalEntry(const SkBitmap& bitmap, const SkIRect& srcRect,
+                            SkPicture::EncodeBitmap encoder);
+    };
+
+    // This should be made a hash table if performance is a problem.
+    static SkTDArray<ImageCanonicalEntry>& CanonicalImages();
+    static SkBaseMutex& CanonicalImagesMutex();
+
     /** Create a PDF image XObject. Entries for the image properties are
      *  automatically added to the stream dictionary.
      *  @param stream     The image stream. May be NULL. Otherwise, this
@@ -83,6 +107,14 @@ private:
     SkPDFImage(SkStream* stream, const SkBitmap& bitmap, bool isAlpha,
                const SkIRect& srcRect, SkPicture::EncodeBitmap encoder);
 
+    /** Create a PDF image XObject that embeds the JPEG a bitmap was decoded
+     *  from, as it is, rather than the bitmap's pixels.
+     *  @param jpegData   The JPEG, which must be as large as bitmap.
+     *  @param bitmap     The image decoded from jpegData.
+     *  @param components The number of color components in the JPEG, 1 or 3.
+     */
+    SkPDFImage(SkData* jpegData, const SkBitmap& bitmap, int components);
+
     /** Copy constructor, used to generate substitutes.
      *  @param image      The SkPDFImage to copy.
      */
@@ -41,6 +41,7 @@ void SkPDFPage::finalizePage(SkPDFCatalog* catalog, bool firstPage,
         insert("Contents", new SkPDFObjRef(fContentStream.get()))->unref();
     }
     catalog->addObject(fContentStream.get(), firstPage);
+    fContentStream->startCompression(catalog);
     resourceDict->getReferencedResources(knownResourceObjects,
                                          newResourceObjects,
                                          true);
@@ -57,6 +58,19 @@ void SkPDFPage::emitPage(SkWStream* stream, SkPDFCatalog* catalog) {
     fContentStream->emitObject(stream, catalog, true);
 }
 
+void SkPDFPage::emitStreamedPage(SkWStream* stream, SkPDFCatalog* catalog,
+                                 size_t streamStart) {
+    SkASSERT(fContentStream.get() != NULL);
+    catalog->emitStreamedObject(stream, streamStart, this);
+    catalog->emitStreamedObject(stream, streamStart, fContentStream.get());
+    catalog->releaseObject(fContentStream.get());
+
+    // Clearing the dictionary drops the resource dict, contents and parent.
+    this->clear();
+    fContentStream.reset(NULL);
+    fDevice.reset(NULL);
+}
+
 // static
 void SkPDFPage::GeneratePageTree(const SkTDArray<SkPDFPage*>& pages,
                                  SkPDFCatalog* catalog,
@@ -71,6 +71,18 @@ public:
      */
     void emitPage(SkWStream* stream, SkPDFCatalog* catalog);
 
+    /** For streaming documents: emit the page and its content at the
+     *  current position of the stream, then drop the device and content.
+     *  The page itself stays valid as the target of references (page tree
+     *  kids, destinations), but must not be finalized or emitted again.
+     *  @param stream      The writable output stream to send the content to.
+     *  @param catalog     The active (streaming) object catalog.
+     *  @param streamStart The value of stream->bytesWritten() at the start
+     *                     of the document.
+     */
+    void emitStreamedPage(SkWStream* stream, SkPDFCatalog* catalog,
+                          size_t streamStart);
+
     /** Generate a page tree for the passed vector of pages.  New objects are
      *  added to the catalog.  The pageTree vector is populated with all of
      *  the 'Pages' dictionaries as well as the 'Page' objects.  Page trees
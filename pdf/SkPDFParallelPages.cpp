@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPDFParallelPages.h"
+
+#include "SkPDFDevice.h"
+#include "SkPDFDocument.h"
+#include "SkPDFStreamingDocument.h"
+#include "SkTaskPool.h"
+#include "SkTemplates.h"
+
+namespace {
+
+// Enough pages per batch that threads finishing early have another to take.
+const int kPagesPerThread = 2;
+
+struct PageTask {
+    SkPDFParallelPages::DrawPageProc fProc;
+    void*                            fContext;
+    int                              fPageIndex;
+    SkPDFDevice*                     fDevice;
+};
+
+void draw_page(void* data) {
+    PageTask* task = static_cast<PageTask*>(data);
+    task->fDevice = task->fProc(task->fPageIndex, task->fContext);
+}
+
+void queue_pages(SkTaskGroup* group, PageTask* tasks, int start, int end) {
+    for (int i = start; i < end; ++i) {
+        group->add(draw_page, &tasks[i]);
+    }
+}
+
+template <typename Document>
+bool append_pages(Document* doc, int pageCount,
+                  SkPDFParallelPages::DrawPageProc proc, void* context,
+                  SkTaskPool* pool) {
+    SkASSERT(NULL != doc);
+    SkASSERT(NULL != proc);
+    if (pageCount <= 0) {
+        return true;
+    }
+    if (NULL == pool) {
+        pool = SkTaskPool::Global();
+    }
+    const int batchSize = (pool->threadCount() + 1) * kPagesPerThread;
+
+    SkAutoTArray<PageTask> tasks(pageCount);
+    for (int i = 0; i < pageCount; ++i) {
+        tasks[i].fProc = proc;
+        tasks[i].fContext = context;
+        tasks[i].fPageIndex = i;
+        tasks[i].fDevice = NULL;
+    }
+
+    // Batches alternate between the two groups: one is drawn while the pages
+    // of the other are appended.
+    SkTaskGroup groupA(pool);
+    SkTaskGroup groupB(pool);
+    SkTaskGroup* groups[2] = { &groupA, &groupB };
+
+    bool success = true;
+    int batch = 0;
+    queue_pages(groups[0], tasks.get(), 0, SkMin32(batchSize, pageCount));
+    for (int start = 0; start < pageCount; start += batchSize, ++batch) {
+        const int end = SkMin32(start + batchSize, pageCount);
+        if (success) {
+            queue_pages(groups[(batch + 1) & 1], tasks.get(), end,
+                        SkMin32(end + batchSize, pageCount));
+        }
+        groups[batch & 1]->wait();
+        for (int i = start; i < end; ++i) {
+            if (success) {
+                success = NULL != tasks[i].fDevice &&
+                          doc->appendPage(tasks[i].fDevice);
+            }
+            SkSafeUnref(tasks[i].fDevice);
+        }
+    }
+    return success;
+}
+
+}  // namespace
+
+bool SkPDFParallelPages::AppendPages(SkPDFStreamingDocument* doc,
+                                     int pageCount, DrawPageProc proc,
+                                     void* context, SkTaskPool* pool) {
+    return append_pages(doc, pageCount, proc, context, pool);
+}
+
+bool SkPDFParallelPages::AppendPages(SkPDFDocument* doc, int pageCount,
+                                     DrawPageProc proc, void* context,
+                                     SkTaskPool* pool) {
+    return append_pages(doc, pageCount, proc, context, pool);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPDFParallelPages_DEFINED
+#define SkPDFParallelPages_DEFINED
+
+#include "SkTypes.h"
+
+class SkPDFDevice;
+class SkPDFDocument;
+class SkPDFStreamingDocument;
+class SkTaskPool;
+
+/** \class SkPDFParallelPages
+
+    Draws the pages of a document on a pool of worker threads and appends
+    them to the document in page order.
+
+    Each page gets an SkPDFDevice of its own, so pages only share the
+    resources that are canonicalized across devices (fonts, graphic states,
+    shaders and images), and those are looked up under locks.  Appending
+    stays on the calling thread: while it writes out one batch of pages, the
+    pool draws the next, so at most two batches of pages are in memory at
+    once.
+*/
+class SkPDFParallelPages : SkNoncopyable {
+public:
+    /** Creates the device for page pageIndex, draws the page into it and
+     *  returns it.  The caller owns the reference; returning NULL stops the
+     *  document at the pages before it.  Runs on the pool's threads, several
+     *  pages at a time, so anything it shares between pages must be thread
+     *  safe.  Any canvas drawing into the device must be gone when it returns.
+     */
+    typedef SkPDFDevice* (*DrawPageProc)(int pageIndex, void* context);
+
+    /** Appends pageCount pages drawn by proc to doc.  The work is run on
+     *  pool, or on SkTaskPool::Global() if pool is NULL.  Returns false if a
+     *  page couldn't be drawn or appended; the pages before it are still in
+     *  the document.
+     */
+    static bool AppendPages(SkPDFStreamingDocument* doc, int pageCount,
+                            DrawPageProc proc, void* context,
+                            SkTaskPool* pool = NULL);
+    static bool AppendPages(SkPDFDocument* doc, int pageCount,
+                            DrawPageProc proc, void* context,
+                            SkTaskPool* pool = NULL);
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPDFRasterReport_DEFINED
+#define SkPDFRasterReport_DEFINED
+
+#include "SkRect.h"
+
+class SkPDFDevice;
+
+/** \class SkPDFRasterReport
+
+    Reports the draws an SkPDFDevice can't express in PDF and rasterizes
+    instead (today, bitmaps drawn with perspective), so that the size and
+    time they add to a document can be attributed to the pages they came
+    from.
+*/
+class SkPDFRasterReport {
+public:
+    /** Called on the drawing thread for each rasterized draw.  device is the
+     *  page (or layer) drawn into, bounds the area the raster covers in its
+     *  coordinates, and width x height the size in pixels of the bitmap
+     *  embedded in its place, at the device's raster DPI.
+     */
+    typedef void (*Proc)(const SkPDFDevice* device, const SkIRect& bounds,
+                         int width, int height, void* context);
+
+    /** Install proc to be called for every device from now on; NULL stops
+     *  the reports.  Calls already under way may still use the old proc.
+     */
+    static void SetProc(Proc proc, void* context);
+
+private:
+    friend class SkPDFDevice;
+
+    static void Report(const SkPDFDevice* device, const SkIRect& bounds,
+                       int width, int height);
+};
+
+#endif
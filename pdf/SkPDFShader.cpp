@@ -9,7 +9,9 @@
 
 #include "SkPDFShader.h"
 
+#include "SkChecksum.h"
 #include "SkData.h"
+#include "SkFloatBits.h"
 #include "SkPDFCatalog.h"
 #include "SkPDFDevice.h"
 #include "SkPDFFormXObject.h"
@@ -482,6 +484,9 @@ public:
     uint32_t fPixelGeneration;
     SkShader::TileMode fImageTileModes[2];
 
+    // Hash of everything operator== compares.
+    uint32_t fHash;
+
     State(const SkShader& shader, const SkMatrix& canvasTransform,
           const SkIRect& bbox);
 
@@ -496,15 +501,129 @@ private:
     State(const State& other);
     State operator=(const State& rhs);
     void AllocateGradientInfoStorage();
+    void computeHash();
+};
+
+/**
+ * The PostScript function of a gradient. The function works on the unit
+ * gradient and doesn't depend on where the gradient is drawn, except through
+ * its domain, which is rounded out to a power of two square. So functions are
+ * canonicalized by their code and domain, and a gradient drawn with many
+ * transforms or into many bounding boxes shares one function.
+ */
+class SkPDFPSFunction : public SkPDFStream {
+public:
+    class Key {
+    public:
+        Key(const SkString& code, SkScalar extent)
+            : fCode(code),
+              fExtent(extent),
+              fHash(HashCode(code, extent)) {
+        }
+
+        bool operator==(const Key& b) const {
+            return fHash == b.fHash && fExtent == b.fExtent &&
+                   fCode.equals(b.fCode);
+        }
+
+        const SkString& fCode;
+        SkScalar fExtent;
+        uint32_t fHash;
+
+    private:
+        static uint32_t HashCode(const SkString& code, SkScalar extent) {
+            // Murmur3 takes whole words, so the last few bytes go into the
+            // seed.
+            size_t wordBytes = code.size() & ~3;
+            uint32_t seed = SkFloat2Bits(extent) ^ SkToU32(code.size());
+            for (size_t i = wordBytes; i < code.size(); ++i) {
+                seed = seed * 31 + static_cast<uint8_t>(code[i]);
+            }
+            return SkChecksum::Murmur3(
+                    reinterpret_cast<const uint32_t*>(code.c_str()), wordBytes,
+                    seed);
+        }
+    };
+
+    SkPDFPSFunction(const SkString& code, SkScalar extent, SkPDFObject* range);
+    virtual ~SkPDFPSFunction();
+
+    static const Key& GetKey(const SkPDFPSFunction& function) {
+        return function.fKey;
+    }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+
+private:
+    SkString fCode;
+    Key fKey;
+
+    typedef SkPDFStream INHERITED;
 };
 
+typedef SkTDynamicHash<SkPDFPSFunction, SkPDFPSFunction::Key> PSFunctionHash;
+
+// Functions are made while CanonicalShadersMutex() is held, but are destroyed
+// with the shaders that use them, so they have a mutex of their own.
+SK_DECLARE_STATIC_MUTEX(gPSFunctionsMutex);
+
+static PSFunctionHash& ps_functions() {
+    // This initialization is only thread safe with gcc.
+    static PSFunctionHash gPSFunctions;
+    return gPSFunctions;
+}
+
+SkPDFPSFunction::SkPDFPSFunction(const SkString& code, SkScalar extent,
+                                 SkPDFObject* range)
+        : fCode(code),
+          fKey(fCode, extent) {
+    SkAutoDataUnref data(SkData::NewWithCopy(fCode.c_str(), fCode.size()));
+    this->setData(data.get());
+    insertInt("FunctionType", 4);
+    SkAutoTUnref<SkPDFArray> domain(new SkPDFArray);
+    domain->reserve(4);
+    domain->appendScalar(-extent);
+    domain->appendScalar(extent);
+    domain->appendScalar(-extent);
+    domain->appendScalar(extent);
+    insert("Domain", domain.get());
+    insert("Range", range);
+}
+
+SkPDFPSFunction::~SkPDFPSFunction() {
+    SkAutoMutexAcquire lock(gPSFunctionsMutex);
+    SkASSERT(this == ps_functions().find(fKey));
+    ps_functions().remove(fKey);
+}
+
+// The domain of a function only has to contain the domain of the shading using
+// it (the shading never evaluates it outside of that), so it is rounded out to
+// [-extent, extent] in both directions.
+static SkScalar function_domain_extent(const SkRect& bbox) {
+    // Past this, powers of two would stop being shared, so keep the exact
+    // bound.
+    static const SkScalar kMaxRoundedExtent = SkIntToScalar(1 << 20);
+
+    SkScalar bound = SkTMax(SkTMax(SkScalarAbs(bbox.fLeft),
+                                   SkScalarAbs(bbox.fRight)),
+                            SkTMax(SkScalarAbs(bbox.fTop),
+                                   SkScalarAbs(bbox.fBottom)));
+    if (!(bound <= kMaxRoundedExtent)) {
+        return bound;
+    }
+    SkScalar extent = SK_Scalar1;
+    while (extent < bound) {
+        extent *= 2;
+    }
+    return extent;
+}
+
 class SkPDFFunctionShader : public SkPDFDict, public SkPDFShader {
     SK_DECLARE_INST_COUNT(SkPDFFunctionShader)
 public:
     explicit SkPDFFunctionShader(SkPDFShader::State* state);
     virtual ~SkPDFFunctionShader() {
         if (isValid()) {
-            RemoveShader(this);
+            RemoveShader(*fState.get());
         }
         fResources.unrefAll();
     }
@@ -524,7 +643,7 @@ private:
     SkTDArray<SkPDFObject*> fResources;
     SkAutoTDelete<const SkPDFShader::State> fState;
 
-    SkPDFStream* makePSFunction(const SkString& psCode, SkPDFArray* domain);
+    SkPDFStream* refPSFunction(const SkString& psCode, const SkRect& bbox);
     typedef SkPDFDict INHERITED;
 };
 
@@ -538,7 +657,7 @@ public:
     explicit SkPDFAlphaFunctionShader(SkPDFShader::State* state);
     virtual ~SkPDFAlphaFunctionShader() {
         if (isValid()) {
-            RemoveShader(this);
+            RemoveShader(*fState.get());
         }
     }
 
@@ -567,7 +686,7 @@ public:
     explicit SkPDFImageShader(SkPDFShader::State* state);
     virtual ~SkPDFImageShader() {
         if (isValid()) {
-            RemoveShader(this);
+            RemoveShader(*fState.get());
         }
         fResources.unrefAll();
     }
@@ -602,13 +721,13 @@ SkPDFObject* SkPDFShader::GetPDFShaderByState(State* inState) {
         return NULL;
     }
 
-    ShaderCanonicalEntry entry(NULL, shaderState.get());
-    int index = CanonicalShaders().find(entry);
-    if (index >= 0) {
-        result = CanonicalShaders()[index].fPDFShader;
+    ShaderCanonicalEntry* entry = CanonicalShaders().find(*shaderState.get());
+    if (NULL != entry) {
+        result = entry->fPDFShader;
         result->ref();
         return result;
     }
+    const State* state = shaderState.get();
 
     bool valid = false;
     // The PDFShader takes ownership of the shaderSate.
@@ -634,18 +753,17 @@ SkPDFObject* SkPDFShader::GetPDFShaderByState(State* inState) {
         delete result;
         return NULL;
     }
-    entry.fPDFShader = result;
-    CanonicalShaders().push(entry);
+    CanonicalShaders().add(SkNEW_ARGS(ShaderCanonicalEntry, (result, state)));
     return result;  // return the reference that came from new.
 }
 
 // static
-void SkPDFShader::RemoveShader(SkPDFObject* shader) {
+void SkPDFShader::RemoveShader(const State& state) {
     SkAutoMutexAcquire lock(CanonicalShadersMutex());
-    ShaderCanonicalEntry entry(shader, NULL);
-    int index = CanonicalShaders().find(entry);
-    SkASSERT(index >= 0);
-    CanonicalShaders().removeShuffle(index);
+    ShaderCanonicalEntry* entry = CanonicalShaders().find(state);
+    SkASSERT(NULL != entry);
+    CanonicalShaders().remove(state);
+    SkDELETE(entry);
 }
 
 // static
@@ -658,9 +776,9 @@ SkPDFObject* SkPDFShader::GetPDFShader(const SkShader& shader,
 }
 
 // static
-SkTDArray<SkPDFShader::ShaderCanonicalEntry>& SkPDFShader::CanonicalShaders() {
+SkPDFShader::ShaderCanonicalHash& SkPDFShader::CanonicalShaders() {
     // This initialization is only thread safe with gcc.
-    static SkTDArray<ShaderCanonicalEntry> gCanonicalShaders;
+    static ShaderCanonicalHash gCanonicalShaders;
     return gCanonicalShaders;
 }
 
@@ -943,7 +1061,7 @@ SkPDFFunctionShader::SkPDFFunctionShader(SkPDFShader::State* state)
     pdfShader->insertName("ColorSpace", "DeviceRGB");
     pdfShader->insert("Domain", domain.get());
 
-    SkPDFStream* function = makePSFunction(functionCode, domain.get());
+    SkPDFStream* function = refPSFunction(functionCode, bbox);
     pdfShader->insert("Function", new SkPDFObjRef(function))->unref();
     fResources.push(function);  // Pass ownership to resource list.
 
@@ -1162,14 +1280,19 @@ SkPDFImageShader::SkPDFImageShader(SkPDFShader::State* state) : fState(state) {
     fState.get()->fImage.unlockPixels();
 }
 
-SkPDFStream* SkPDFFunctionShader::makePSFunction(const SkString& psCode,
-                                                 SkPDFArray* domain) {
-    SkAutoDataUnref funcData(SkData::NewWithCopy(psCode.c_str(),
-                                                 psCode.size()));
-    SkPDFStream* result = new SkPDFStream(funcData.get());
-    result->insertInt("FunctionType", 4);
-    result->insert("Domain", domain);
-    result->insert("Range", RangeObject());
+SkPDFStream* SkPDFFunctionShader::refPSFunction(const SkString& psCode,
+                                                const SkRect& bbox) {
+    SkScalar extent = function_domain_extent(bbox);
+    SkPDFPSFunction::Key key(psCode, extent);
+
+    SkAutoMutexAcquire lock(gPSFunctionsMutex);
+    SkPDFPSFunction* result = ps_functions().find(key);
+    if (NULL != result) {
+        result->ref();
+        return result;
+    }
+    result = SkNEW_ARGS(SkPDFPSFunction, (psCode, extent, RangeObject()));
+    ps_functions().add(result);
     return result;
 }
 
@@ -1179,14 +1302,14 @@ SkPDFShader::ShaderCanonicalEntry::ShaderCanonicalEntry(SkPDFObject* pdfShader,
       fState(state) {
 }
 
-bool SkPDFShader::ShaderCanonicalEntry::operator==(
-        const ShaderCanonicalEntry& b) const {
-    return fPDFShader == b.fPDFShader ||
-           (fState != NULL && b.fState != NULL && *fState == *b.fState);
+// static
+uint32_t SkPDFShader::ShaderCanonicalEntry::Hash(const State& state) {
+    return state.fHash;
 }
 
 bool SkPDFShader::State::operator==(const SkPDFShader::State& b) const {
-    if (fType != b.fType ||
+    if (fHash != b.fHash ||
+            fType != b.fType ||
             fCanvasTransform != b.fCanvasTransform ||
             fShaderTransform != b.fShaderTransform ||
             fBBox != b.fBBox) {
@@ -1266,6 +1389,7 @@ SkPDFShader::State::State(const SkShader& shader,
         AllocateGradientInfoStorage();
         shader.asAGradient(&fInfo);
     }
+    this->computeHash();
 }
 
 SkPDFShader::State::State(const SkPDFShader::State& other)
@@ -1287,6 +1411,7 @@ SkPDFShader::State::State(const SkPDFShader::State& other)
             fInfo.fColorOffsets[i] = other.fInfo.fColorOffsets[i];
         }
     }
+    fHash = other.fHash;
 }
 
 /**
@@ -1302,6 +1427,7 @@ SkPDFShader::State* SkPDFShader::State::CreateAlphaToLuminosityState() const {
         SkAlpha alpha = SkColorGetA(fInfo.fColors[i]);
         newState->fInfo.fColors[i] = SkColorSetARGB(255, alpha, alpha, alpha);
     }
+    newState->computeHash();
 
     return newState;
 }
@@ -1318,6 +1444,7 @@ SkPDFShader::State* SkPDFShader::State::CreateOpaqueState() const {
         newState->fInfo.fColors[i] = SkColorSetA(fInfo.fColors[i],
                                                  SK_AlphaOPAQUE);
     }
+    newState->computeHash();
 
     return newState;
 }
@@ -1346,3 +1473,59 @@ void SkPDFShader::State::AllocateGradientInfoStorage() {
     fInfo.fColorOffsets =
             reinterpret_cast<SkScalar*>(fInfo.fColors + fInfo.fColorCount);
 }
+
+static void append_hash_data(const void* data, size_t bytes,
+                             SkTDArray<uint32_t>* hashData) {
+    SkASSERT(SkIsAlign4(bytes));
+    memcpy(hashData->append(SkToInt(bytes >> 2)), data, bytes);
+}
+
+static void append_hash_matrix(const SkMatrix& matrix,
+                               SkTDArray<uint32_t>* hashData) {
+    for (int i = 0; i < 9; ++i) {
+        SkScalar value = matrix[i];
+        append_hash_data(&value, sizeof(value), hashData);
+    }
+}
+
+void SkPDFShader::State::computeHash() {
+    // Only what operator== looks at goes in, so equal states hash the same.
+    SkTDArray<uint32_t> hashData;
+    *hashData.append() = fType;
+    append_hash_matrix(fCanvasTransform, &hashData);
+    append_hash_matrix(fShaderTransform, &hashData);
+    append_hash_data(&fBBox, sizeof(fBBox), &hashData);
+
+    if (fType == SkShader::kNone_GradientType) {
+        *hashData.append() = fPixelGeneration;
+        *hashData.append() = fImageTileModes[0];
+        *hashData.append() = fImageTileModes[1];
+    } else {
+        *hashData.append() = fInfo.fColorCount;
+        *hashData.append() = fInfo.fTileMode;
+        append_hash_data(fInfo.fColors, fInfo.fColorCount * sizeof(SkColor),
+                         &hashData);
+        append_hash_data(fInfo.fColorOffsets,
+                         fInfo.fColorCount * sizeof(SkScalar), &hashData);
+        append_hash_data(&fInfo.fPoint[0], sizeof(SkPoint), &hashData);
+        switch (fType) {
+            case SkShader::kLinear_GradientType:
+                append_hash_data(&fInfo.fPoint[1], sizeof(SkPoint), &hashData);
+                break;
+            case SkShader::kRadial_GradientType:
+                append_hash_data(&fInfo.fRadius[0], sizeof(SkScalar),
+                                 &hashData);
+                break;
+            case SkShader::kRadial2_GradientType:
+            case SkShader::kConical_GradientType:
+                append_hash_data(&fInfo.fPoint[1], sizeof(SkPoint), &hashData);
+                append_hash_data(fInfo.fRadius, 2 * sizeof(SkScalar),
+                                 &hashData);
+                break;
+            default:
+                break;
+        }
+    }
+    fHash = SkChecksum::Murmur3(hashData.begin(),
+                                hashData.count() * sizeof(uint32_t));
+}
@@ -15,6 +15,7 @@
 #include "SkMatrix.h"
 #include "SkRefCnt.h"
 #include "SkShader.h"
+#include "SkTDynamicHash.h"
 
 class SkObjRef;
 class SkPDFCatalog;
@@ -49,20 +50,25 @@ protected:
     class ShaderCanonicalEntry {
     public:
         ShaderCanonicalEntry(SkPDFObject* pdfShader, const State* state);
-        bool operator==(const ShaderCanonicalEntry& b) const;
+
+        static const State& GetKey(const ShaderCanonicalEntry& entry) {
+            return *entry.fState;
+        }
+        static uint32_t Hash(const State& state);
 
         SkPDFObject* fPDFShader;
         const State* fState;
     };
-    // This should be made a hash table if performance is a problem.
-    static SkTDArray<ShaderCanonicalEntry>& CanonicalShaders();
+    typedef SkTDynamicHash<ShaderCanonicalEntry, State> ShaderCanonicalHash;
+    static ShaderCanonicalHash& CanonicalShaders();
     static SkBaseMutex& CanonicalShadersMutex();
 
     // This is an internal method.
     // CanonicalShadersMutex() should already be acquired.
     // This also takes ownership of shaderState.
     static SkPDFObject* GetPDFShaderByState(State* shaderState);
-    static void RemoveShader(SkPDFObject* shader);
+    // Takes the shader created for state out of the canonical list.
+    static void RemoveShader(const State& state);
 
     SkPDFShader();
     virtual ~SkPDFShader() {};
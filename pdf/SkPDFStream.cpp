@@ -78,15 +78,26 @@ size_t SkPDFStream::getOutputSize(SkPDFCatalog* catalog, bool indirect) {
         strlen(" stream\n\nendstream") + fData->getLength();
 }
 
+void SkPDFStream::startCompression(SkPDFCatalog* catalog) {
+    SkPDFFlateQueue* queue = catalog->getFlateQueue();
+    if (fState != kUnused_State || NULL != fDeflateJob.get() || NULL == queue ||
+        NULL == fData.get() || skip_compression(catalog) || !SkFlate::HaveFlate()) {
+        return;
+    }
+    fDeflateJob.reset(queue->deflate(fData.get()));
+}
+
 SkPDFStream::SkPDFStream() : fState(kUnused_State) {}
 
 void SkPDFStream::setData(SkData* data) {
+    SkASSERT(NULL == fDeflateJob.get());
     SkMemoryStream* stream = new SkMemoryStream;
     stream->setData(data);
     fData.reset(stream);  // Transfer ownership.
 }
 
 void SkPDFStream::setData(SkStream* stream) {
+    SkASSERT(NULL == fDeflateJob.get());
     // Code assumes that the stream starts at the beginning and is rewindable.
     if (stream) {
         SkASSERT(stream->getPosition() == 0);
@@ -99,12 +110,22 @@ void SkPDFStream::setData(SkStream* stream) {
 bool SkPDFStream::populate(SkPDFCatalog* catalog) {
     if (fState == kUnused_State) {
         if (!skip_compression(catalog) && SkFlate::HaveFlate()) {
-            SkDynamicMemoryWStream compressedData;
-
-            SkAssertResult(SkFlate::Deflate(fData.get(), &compressedData));
-            if (compressedData.getOffset() < fData->getLength()) {
+            SkAutoTUnref<SkData> compressedData;
+            if (NULL != fDeflateJob.get()) {
+                compressedData.reset(fDeflateJob->finish());
+                fDeflateJob.reset(NULL);
+            } else {
+                SkDynamicMemoryWStream compressedStream;
+                if (SkFlate::Deflate(fData.get(), &compressedStream)) {
+                    compressedData.reset(compressedStream.copyToData());
+                }
+                fData->rewind();
+            }
+            SkASSERT(NULL != compressedData.get());
+            if (NULL != compressedData.get() &&
+                    compressedData->size() < fData->getLength()) {
                 SkMemoryStream* stream = new SkMemoryStream;
-                stream->setData(compressedData.copyToData())->unref();
+                stream->setData(compressedData.get());
                 fData.reset(stream);  // Transfer ownership.
                 insertName("Filter", "FlateDecode");
             }
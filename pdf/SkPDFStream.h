@@ -10,6 +10,7 @@
 #ifndef SkPDFStream_DEFINED
 #define SkPDFStream_DEFINED
 
+#include "SkPDFFlateQueue.h"
 #include "SkPDFTypes.h"
 #include "SkRefCnt.h"
 #include "SkStream.h"
@@ -45,6 +46,7 @@ public:
     virtual void emitObject(SkWStream* stream, SkPDFCatalog* catalog,
                             bool indirect);
     virtual size_t getOutputSize(SkPDFCatalog* catalog, bool indirect);
+    virtual void startCompression(SkPDFCatalog* catalog);
 
 protected:
     enum State {
@@ -93,6 +95,8 @@ private:
     // TODO(vandebo): Use SkData (after removing deprecated constructor).
     SkAutoTUnref<SkStream> fData;
     SkAutoTUnref<SkPDFStream> fSubstitute;
+    // Compression of fData started by startCompression(), if any.
+    SkAutoTUnref<SkPDFFlateQueue::Job> fDeflateJob;
 
     typedef SkPDFDict INHERITED;
 };
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPDFStreamingDocument.h"
+
+#include "SkPDFCatalog.h"
+#include "SkPDFDevice.h"
+#include "SkPDFPage.h"
+#include "SkPDFTypes.h"
+#include "SkStream.h"
+
+static void emit_header(SkWStream* stream) {
+    // Same header as SkPDFDocument.
+    stream->writeText("%PDF-1.4\n%");
+    stream->write32(0xD3EBE9E1);
+    stream->writeText("\n");
+}
+
+SkPDFStreamingDocument::SkPDFStreamingDocument(SkWStream* stream,
+                                               SkPDFDocument::Flags flags)
+        : fStream(stream),
+          fStreamStart(0),
+          fCatalog(SkNEW_ARGS(SkPDFCatalog, (flags, true))),
+          fClosed(false) {
+    SkASSERT(NULL != stream);
+    fDocCatalog = SkNEW_ARGS(SkPDFDict, ("Catalog"));
+    fPageTreeRoot = SkNEW_ARGS(SkPDFDict, ("Pages"));
+    fPageTreeKids = SkNEW(SkPDFArray);
+    fDests = SkNEW(SkPDFDict);
+    fCatalog->addObject(fDocCatalog, false);
+    fCatalog->addObject(fPageTreeRoot, false);
+    fDocCatalog->insert("Pages", SkNEW_ARGS(SkPDFObjRef, (fPageTreeRoot)))->unref();
+}
+
+SkPDFStreamingDocument::~SkPDFStreamingDocument() {
+    // Emitted pages are already cleared, so the only cycle left is a page
+    // still referring to the root.  Clearing the root is enough either way.
+    fPageTreeRoot->clear();
+    fPages.unrefAll();
+
+    fKnownResources.rewind();
+    fEmittedResources.unrefAll();
+    fDeferredResources.unrefAll();
+    fSubstitutes.unrefAll();
+
+    fDests->unref();
+    fPageTreeKids->unref();
+    fPageTreeRoot->unref();
+    fDocCatalog->unref();
+}
+
+void SkPDFStreamingDocument::emitObject(SkPDFObject* obj) {
+    fCatalog->emitStreamedObject(fStream, fStreamStart, obj);
+}
+
+void SkPDFStreamingDocument::releaseUnreferenced(SkTDArray<SkPDFObject*>* emitted) {
+    // Freeing one resource may leave another it referred to unreferenced, so
+    // repeat until nothing changes.  Whatever survives is still held by
+    // something (a canonical cache, another live object) and may be
+    // referenced again, so it has to keep its catalog entry.
+    bool released;
+    do {
+        released = false;
+        for (int i = emitted->count() - 1; i >= 0; --i) {
+            SkPDFObject* obj = (*emitted)[i];
+            if (obj->unique()) {
+                fCatalog->releaseObject(obj);
+                obj->unref();
+                emitted->removeShuffle(i);
+                released = true;
+            }
+        }
+    } while (released);
+
+    for (int i = 0; i < emitted->count(); ++i) {
+        fEmittedResources.add((*emitted)[i]);  // Transfer reference.
+        fKnownResources.add((*emitted)[i]);
+    }
+    emitted->rewind();
+}
+
+bool SkPDFStreamingDocument::appendPage(SkPDFDevice* pdfDevice) {
+    if (fClosed) {
+        return false;
+    }
+    if (fPages.isEmpty()) {
+        fStreamStart = fStream->bytesWritten();
+        emit_header(fStream);
+    }
+
+    SkPDFPage* page = SkNEW_ARGS(SkPDFPage, (pdfDevice));
+    fPages.push(page);  // Reference from new passed to fPages.
+
+    SkTSet<SkPDFObject*> newResources;
+    page->finalizePage(fCatalog.get(), false, fKnownResources, &newResources);
+    for (int i = 0; i < newResources.count(); ++i) {
+        fCatalog->addObject(newResources[i], false);
+    }
+    page->appendDestinations(fDests);
+    fGlyphUsage.merge(page->getFontGlyphUsage());
+
+    page->insert("Parent", SkNEW_ARGS(SkPDFObjRef, (fPageTreeRoot)))->unref();
+    fPageTreeKids->append(SkNEW_ARGS(SkPDFObjRef, (page)))->unref();
+    fCatalog->addObject(page, false);
+
+    // Fonts (and everything under them) can't be written until all the glyph
+    // usage is known.
+    SkTSet<SkPDFObject*> fontResources;
+    const SkTDArray<SkPDFFont*>& fonts = page->getFontResources();
+    for (int i = 0; i < fonts.count(); ++i) {
+        SkPDFFont* font = fonts[i];
+        if (!fKnownResources.contains(font) && !fontResources.contains(font)) {
+            fontResources.add(font);
+            font->ref();
+            font->getResources(fKnownResources, &fontResources);
+        }
+    }
+
+    // The page content is already compressing; get the rest going too so it
+    // overlaps with writing the page out.
+    for (int i = 0; i < newResources.count(); ++i) {
+        if (!fontResources.contains(newResources[i])) {
+            newResources[i]->startCompression(fCatalog.get());
+        }
+    }
+
+    page->emitStreamedPage(fStream, fCatalog.get(), fStreamStart);
+
+    SkTDArray<SkPDFObject*> emitted;
+    for (int i = 0; i < newResources.count(); ++i) {
+        SkPDFObject* obj = newResources[i];
+        if (fontResources.contains(obj)) {
+            fDeferredResources.add(obj);  // Transfer reference.
+            fKnownResources.add(obj);
+        } else {
+            this->emitObject(obj);
+            emitted.push(obj);  // Transfer reference.
+        }
+    }
+    fontResources.unrefAll();
+    this->releaseUnreferenced(&emitted);
+    return true;
+}
+
+bool SkPDFStreamingDocument::close() {
+    if (fClosed || fPages.isEmpty()) {
+        return false;
+    }
+    fClosed = true;
+
+    SkPDFGlyphSetMap::F2BIter iterator(fGlyphUsage);
+    const SkPDFGlyphSetMap::FontGlyphSetPair* entry = iterator.next();
+    while (entry) {
+        SkPDFFont* subsetFont = entry->fFont->getFontSubset(entry->fGlyphSet);
+        if (subsetFont) {
+            fCatalog->setSubstitute(entry->fFont, subsetFont);
+            fSubstitutes.push(subsetFont);  // Transfer ownership to substitutes
+        }
+        entry = iterator.next();
+    }
+
+    fCatalog->startCompression();
+    for (int i = 0; i < fDeferredResources.count(); ++i) {
+        this->emitObject(fDeferredResources[i]);
+    }
+    fCatalog->emitStreamedSubstituteResources(fStream, fStreamStart);
+
+    if (fDests->size() > 0) {
+        fCatalog->addObject(fDests, false);
+        this->emitObject(fDests);
+        fDocCatalog->insert("Dests", SkNEW_ARGS(SkPDFObjRef, (fDests)))->unref();
+    }
+
+    fPageTreeRoot->insertInt("Count", fPages.count());
+    fPageTreeRoot->insert("Kids", fPageTreeKids);
+    this->emitObject(fPageTreeRoot);
+    this->emitObject(fDocCatalog);
+
+    size_t xrefOffset = fStream->bytesWritten() - fStreamStart;
+    int64_t objCount = fCatalog->emitXrefTable(fStream, false);
+
+    SkAutoTUnref<SkPDFDict> trailer(SkNEW(SkPDFDict));
+    trailer->insertInt("Size", int(objCount));
+    trailer->insert("Root", SkNEW_ARGS(SkPDFObjRef, (fDocCatalog)))->unref();
+    fStream->writeText("trailer\n");
+    trailer->emitObject(fStream, fCatalog.get(), false);
+    fStream->writeText("\nstartxref\n");
+    fStream->writeBigDecAsText(xrefOffset);
+    fStream->writeText("\n%%EOF");
+    return true;
+}
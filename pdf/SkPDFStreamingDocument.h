@@ -0,0 +1,83 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPDFStreamingDocument_DEFINED
+#define SkPDFStreamingDocument_DEFINED
+
+#include "SkPDFDocument.h"
+#include "SkPDFFont.h"
+#include "SkRefCnt.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+#include "SkTSet.h"
+
+class SkPDFArray;
+class SkPDFCatalog;
+class SkPDFDevice;
+class SkPDFDict;
+class SkPDFObject;
+class SkPDFPage;
+class SkWStream;
+
+/** \class SkPDFStreamingDocument
+
+    A PDF document that writes each page to the output stream as soon as the
+    page is appended, instead of holding every page until the end like
+    SkPDFDocument.  Once a page is written, its content and any resources
+    nobody else refers to are freed.  Peak memory is then about one page plus
+    the resources shared between pages.
+
+    Fonts are the exception: they stay in memory until close(), because
+    subsetting needs the glyph usage of the whole document.  The page tree is
+    flat, and there is no first page section.
+*/
+class SkPDFStreamingDocument : SkNoncopyable {
+public:
+    /** Create a document that writes to stream, which must outlive it.
+     */
+    SkPDFStreamingDocument(SkWStream* stream, SkPDFDocument::Flags flags);
+    ~SkPDFStreamingDocument();
+
+    /** Finalize the passed device and write it out as the next page.  The
+     *  device must not be drawn to afterwards.  Returns false once the
+     *  document has been closed.
+     */
+    bool appendPage(SkPDFDevice* pdfDevice);
+
+    /** Write the fonts, page tree, document catalog, cross reference table
+     *  and trailer.  Returns false if no pages were appended (in which case
+     *  nothing has been written) or if already closed.
+     */
+    bool close();
+
+private:
+    void emitObject(SkPDFObject* obj);
+    void releaseUnreferenced(SkTDArray<SkPDFObject*>* emitted);
+
+    SkWStream* fStream;
+    size_t fStreamStart;
+    SkAutoTDelete<SkPDFCatalog> fCatalog;
+    bool fClosed;
+
+    SkPDFDict* fDocCatalog;
+    SkPDFDict* fPageTreeRoot;
+    SkPDFArray* fPageTreeKids;
+    SkPDFDict* fDests;
+
+    // Emitted pages; kept only as (empty) targets for references.
+    SkTDArray<SkPDFPage*> fPages;
+    // Everything later pages mustn't list again: the union of the two below.
+    SkTSet<SkPDFObject*> fKnownResources;
+    // Resources already written that other objects still hold on to.
+    SkTSet<SkPDFObject*> fEmittedResources;
+    // Fonts and their resources, written at close().
+    SkTSet<SkPDFObject*> fDeferredResources;
+    SkTDArray<SkPDFObject*> fSubstitutes;
+    SkPDFGlyphSetMap fGlyphUsage;
+};
+
+#endif
@@ -50,6 +50,14 @@ public:
     virtual void getResources(const SkTSet<SkPDFObject*>& knownResourceObjects,
                               SkTSet<SkPDFObject*>* newResourceObjects);
 
+    /** Objects whose output is expensive to produce (e.g. compressed streams)
+     *  can override this to start that work on the catalog's flate queue.
+     *  It is only a hint; the result is collected when the object is sized
+     *  or emitted.  The default does nothing.
+     *  @param catalog  The object catalog that will be used for output.
+     */
+    virtual void startCompression(SkPDFCatalog* catalog) {}
+
     /** Emit this object unless the catalog has a substitute object, in which
      *  case emit that.
      *  @see emitObject
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGPipeSharedMemory.h"
+
+#include "SkMath.h"
+#include "SkThread.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_ANDROID)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <time.h>
+    #include <unistd.h>
+    #define SK_GPIPE_USE_FUTEX
+#elif defined(SK_BUILD_FOR_WIN32)
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+/**
+ *  The header at the start of the shared memory, followed by fCapacity bytes
+ *  of ring. Positions count every byte ever written or read, modulo 2^32, so
+ *  the ring is empty when they are equal and full when they are fCapacity
+ *  apart. Each side only ever changes its own cache line.
+ */
+struct SkGPipeSharedMemoryRing {
+    enum {
+        kMagic = 0x67706970,  // 'gpip'
+        kCacheLineSize = 64,
+    };
+
+    // Set up by the controller.
+    uint32_t fMagic;
+    uint32_t fCapacity;
+    char     fPad0[kCacheLineSize - 2 * sizeof(uint32_t)];
+
+    // Changed by the writer.
+    int32_t  fWritePos;
+    // Blocks must be contiguous, so when one doesn't fit before the end of
+    // the ring the writer skips ahead to the start. This is the position the
+    // skipped bytes start at.
+    int32_t  fPadPos;
+    int32_t  fClosed;
+    int32_t  fWriterWaiting;
+    char     fPad1[kCacheLineSize - 4 * sizeof(int32_t)];
+
+    // Changed by the reader.
+    int32_t  fReadPos;
+    int32_t  fReaderWaiting;
+    int32_t  fReaderGone;
+    char     fPad2[kCacheLineSize - 3 * sizeof(int32_t)];
+
+    char* data() { return reinterpret_cast<char*>(this + 1); }
+    uint32_t offset(uint32_t pos) const { return pos & (fCapacity - 1); }
+};
+
+namespace {
+
+// The atomics are full barriers, so adding 0 is a load that sees everything
+// the other side did before its last atomic store.
+inline uint32_t load(int32_t* addr) {
+    return (uint32_t)sk_atomic_add(addr, 0);
+}
+
+// Wait, but not for long, for *addr to stop being value.
+void wait_for_change(int32_t* addr, uint32_t value) {
+#if defined(SK_GPIPE_USE_FUTEX)
+    // Not FUTEX_PRIVATE, since the other side is in another process. The
+    // timeout lets callers notice a side that went away without waking us.
+    struct timespec timeout = { 0, 50 * 1000 * 1000 };
+    syscall(SYS_futex, addr, FUTEX_WAIT, (int32_t)value, &timeout, NULL, 0);
+#elif defined(SK_BUILD_FOR_WIN32)
+    if (load(addr) == value) {
+        Sleep(1);
+    }
+#else
+    if (load(addr) == value) {
+        usleep(1000);
+    }
+#endif
+}
+
+void wake(int32_t* addr) {
+#if defined(SK_GPIPE_USE_FUTEX)
+    syscall(SYS_futex, addr, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+// Moves *pos, which only the caller changes, forward by bytes, and wakes
+// the other side if it is waiting for that.
+void advance(int32_t* pos, uint32_t bytes, int32_t* otherWaiting) {
+    sk_atomic_add(pos, (int32_t)bytes);
+    if (0 != load(otherWaiting)) {
+        wake(pos);
+    }
+}
+
+/**
+ *  Marks the caller as waiting, and then waits for *pos to move from value
+ *  if done() is still false. Setting the flag before checking again means
+ *  the other side either sees the flag and wakes us, or moved *pos before
+ *  we checked.
+ */
+template <typename Done>
+void wait_for_other(int32_t* pos, uint32_t value, int32_t* waiting, Done done) {
+    sk_atomic_inc(waiting);
+    if (load(pos) == value && !done()) {
+        wait_for_change(pos, value);
+    }
+    sk_atomic_dec(waiting);
+}
+
+SkGPipeSharedMemoryRing* init_ring(void* memory, size_t size) {
+    SkASSERT(SkIsAlign4((intptr_t)memory));
+    if (size <= sizeof(SkGPipeSharedMemoryRing)) {
+        return NULL;
+    }
+    // Positions wrap at 2^32, so the capacity must divide that.
+    const size_t available = size - sizeof(SkGPipeSharedMemoryRing);
+    if (available < 4) {
+        return NULL;
+    }
+    uint32_t capacity = 4;
+    while (capacity <= (available >> 1) && capacity < (1U << 30)) {
+        capacity <<= 1;
+    }
+    SkGPipeSharedMemoryRing* ring = static_cast<SkGPipeSharedMemoryRing*>(memory);
+    sk_bzero(ring, sizeof(*ring));
+    ring->fCapacity = capacity;
+    // Publish the layout before the magic that tells the reader it's there.
+    sk_atomic_add((int32_t*)&ring->fMagic, SkGPipeSharedMemoryRing::kMagic);
+    return ring;
+}
+
+struct ReaderGone {
+    SkGPipeSharedMemoryRing* fRing;
+    bool operator()() const { return 0 != load(&fRing->fReaderGone); }
+};
+
+struct WriterClosed {
+    SkGPipeSharedMemoryRing* fRing;
+    bool operator()() const { return 0 != load(&fRing->fClosed); }
+};
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGPipeSharedMemoryController::SkGPipeSharedMemoryController(void* memory, size_t size)
+    : fRing(init_ring(memory, size)) {
+}
+
+SkGPipeSharedMemoryController::~SkGPipeSharedMemoryController() {
+    this->close();
+}
+
+size_t SkGPipeSharedMemoryController::ComputeSize(size_t capacity) {
+    SkASSERT(SkIsPow2(capacity));
+    return sizeof(SkGPipeSharedMemoryRing) + capacity;
+}
+
+void* SkGPipeSharedMemoryController::requestBlock(size_t minRequest, size_t* actual) {
+    if (NULL == fRing || minRequest > fRing->fCapacity) {
+        return NULL;
+    }
+    const uint32_t capacity = fRing->fCapacity;
+    const uint32_t request = SkToU32(minRequest);
+    ReaderGone readerGone = { fRing };
+    for (;;) {
+        if (readerGone()) {
+            return NULL;
+        }
+        // Only we change fWritePos, so it can be read directly.
+        const uint32_t write = (uint32_t)fRing->fWritePos;
+        const uint32_t read = load(&fRing->fReadPos);
+        const uint32_t room = capacity - (write - read);
+        const uint32_t offset = fRing->offset(write);
+        const uint32_t toEnd = capacity - offset;
+
+        if (toEnd < request) {
+            // Skip the rest of the ring, once the reader is done with it.
+            if (room >= toEnd) {
+                fRing->fPadPos = (int32_t)write;
+                advance(&fRing->fWritePos, toEnd, &fRing->fReaderWaiting);
+                continue;
+            }
+        } else if (room >= request) {
+            *actual = SkTMin(room, toEnd);
+            return fRing->data() + offset;
+        }
+        wait_for_other(&fRing->fReadPos, read, &fRing->fWriterWaiting, readerGone);
+    }
+}
+
+void SkGPipeSharedMemoryController::notifyWritten(size_t bytes) {
+    SkASSERT(NULL != fRing);
+    SkASSERT(SkIsAlign4(bytes));
+    advance(&fRing->fWritePos, SkToU32(bytes), &fRing->fReaderWaiting);
+}
+
+void SkGPipeSharedMemoryController::close() {
+    if (NULL != fRing && 0 == load(&fRing->fClosed)) {
+        sk_atomic_inc(&fRing->fClosed);
+        // The reader waits on fWritePos, whether or not it has moved.
+        wake(&fRing->fWritePos);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkGPipeSharedMemoryReader::SkGPipeSharedMemoryReader(void* memory, size_t size,
+                                                     SkCanvas* target)
+    : fRing(static_cast<SkGPipeSharedMemoryRing*>(memory))
+    , fReader(target) {
+    if (size <= sizeof(SkGPipeSharedMemoryRing) ||
+        SkGPipeSharedMemoryRing::kMagic != load((int32_t*)&fRing->fMagic) ||
+        sizeof(SkGPipeSharedMemoryRing) + fRing->fCapacity > size) {
+        fRing = NULL;
+    }
+}
+
+SkGPipeSharedMemoryReader::~SkGPipeSharedMemoryReader() {
+    if (NULL != fRing) {
+        sk_atomic_inc(&fRing->fReaderGone);
+        wake(&fRing->fReadPos);
+    }
+}
+
+SkGPipeReader::Status SkGPipeSharedMemoryReader::playback(bool wait) {
+    if (NULL == fRing) {
+        return SkGPipeReader::kError_Status;
+    }
+    const uint32_t capacity = fRing->fCapacity;
+    WriterClosed writerClosed = { fRing };
+    SkGPipeReader::Status status = SkGPipeReader::kEOF_Status;
+    for (;;) {
+        const uint32_t read = (uint32_t)fRing->fReadPos;
+        const uint32_t write = load(&fRing->fWritePos);
+        if (write == read) {
+            if (!wait) {
+                return status;
+            }
+            if (writerClosed()) {
+                // The writer closes after its last write, so if the ring is
+                // still empty nothing more is coming.
+                if (load(&fRing->fWritePos) == read) {
+                    return status;
+                }
+                continue;
+            }
+            wait_for_other(&fRing->fWritePos, write, &fRing->fReaderWaiting, writerClosed);
+            continue;
+        }
+
+        // Loaded after fWritePos, so it's at least as new as the data.
+        const uint32_t pad = load(&fRing->fPadPos);
+        const uint32_t offset = fRing->offset(read);
+        if (read == pad) {
+            advance(&fRing->fReadPos, capacity - offset, &fRing->fWriterWaiting);
+            continue;
+        }
+        uint32_t length = SkTMin(write - read, capacity - offset);
+        if (pad - read < length) {
+            length = pad - read;
+        }
+
+        // Blocks are only ever published whole commands at a time, so each
+        // stretch of the ring plays back on its own.
+        status = fReader.playback(fRing->data() + offset, length);
+        advance(&fRing->fReadPos, length, &fRing->fWriterWaiting);
+        if (SkGPipeReader::kDone_Status == status || SkGPipeReader::kError_Status == status) {
+            return status;
+        }
+    }
+}
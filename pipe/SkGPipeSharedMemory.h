@@ -0,0 +1,92 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGPipeSharedMemory_DEFINED
+#define SkGPipeSharedMemory_DEFINED
+
+#include "SkGPipe.h"
+
+class SkCanvas;
+struct SkGPipeSharedMemoryRing;
+
+/**
+ *  Streams an SkGPipe through a single-producer, single-consumer ring buffer
+ *  in memory shared between two processes, so that drawing commands reach
+ *  the reader without being copied or sent through a socket.
+ *
+ *  The caller maps the same memory into both processes (e.g. with mmap of a
+ *  shared file or CreateFileMapping) and hands it to one
+ *  SkGPipeSharedMemoryController on the writing side and one
+ *  SkGPipeSharedMemoryReader on the reading side. The controller lays out
+ *  the ring, so it must be created before the reader.
+ *
+ *  Since the processes don't share an address space, record with
+ *  SkGPipeWriter::kCrossProcess_Flag (and without kSharedAddressSpace_Flag),
+ *  which flattens bitmaps, typefaces and factories into the stream.
+ *
+ *  Each side only waits when the ring is full or empty, on a futex where one
+ *  is available and by sleeping briefly otherwise, and only wakes the other
+ *  side when it is actually waiting.
+ */
+class SkGPipeSharedMemoryController : public SkGPipeController {
+public:
+    /**
+     *  Lays out a ring in size bytes of shared memory, which must be 4 byte
+     *  aligned. The ring's capacity is the largest power of two that fits,
+     *  and should be several times the largest command (which, across
+     *  processes, includes any bitmap drawn).
+     */
+    SkGPipeSharedMemoryController(void* memory, size_t size);
+
+    /** Closes the pipe, if it isn't already. */
+    virtual ~SkGPipeSharedMemoryController();
+
+    /** Blocks until there is contiguous room for minRequest bytes. Returns
+     *  NULL if the ring is too small for that, or the reader has gone away.
+     */
+    virtual void* requestBlock(size_t minRequest, size_t* actual) SK_OVERRIDE;
+    virtual void notifyWritten(size_t bytes) SK_OVERRIDE;
+
+    /** Tell the reader that nothing more will be written. */
+    void close();
+
+    /** Returns the number of bytes of shared memory needed for a ring of
+     *  the given capacity, which must be a power of two.
+     */
+    static size_t ComputeSize(size_t capacity);
+
+private:
+    SkGPipeSharedMemoryRing* fRing;
+};
+
+/**
+ *  The reading end of an SkGPipeSharedMemoryController's ring.
+ */
+class SkGPipeSharedMemoryReader {
+public:
+    /** memory and size must match the controller's. */
+    SkGPipeSharedMemoryReader(void* memory, size_t size, SkCanvas* target);
+
+    /** Tells the writer the reader has gone away, so it stops waiting. */
+    ~SkGPipeSharedMemoryReader();
+
+    SkGPipeReader& reader() { return fReader; }
+
+    /**
+     *  Plays back everything written so far. If wait is true, keeps playing
+     *  until the writer closes the pipe or writes its done op. Returns the
+     *  last status from SkGPipeReader, or kError_Status if memory does not
+     *  hold a ring.
+     */
+    SkGPipeReader::Status playback(bool wait);
+
+private:
+    SkGPipeSharedMemoryRing* fRing;
+    SkGPipeReader            fReader;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkGPipeThreaded.h"
+
+#include "SkCanvas.h"
+
+SkGPipeThreadedController::SkGPipeThreadedController(size_t capacity,
+                                                     BeginProc beginProc,
+                                                     EndProc endProc,
+                                                     void* context)
+    : fSize(SkGPipeSharedMemoryController::ComputeSize(capacity))
+    , fMemory(fSize)
+    , fRing(fMemory.get(), fSize)
+    , fBeginProc(beginProc)
+    , fEndProc(endProc)
+    , fContext(context)
+    , fThread(DrawThreadMain, this)
+    , fStarted(false) {
+}
+
+SkGPipeThreadedController::~SkGPipeThreadedController() {
+    this->finish();
+}
+
+bool SkGPipeThreadedController::start() {
+    SkASSERT(!fStarted);
+    fStarted = fThread.start();
+    return fStarted;
+}
+
+void SkGPipeThreadedController::finish() {
+    fRing.close();
+    if (fStarted) {
+        fThread.join();
+        fStarted = false;
+    }
+}
+
+void* SkGPipeThreadedController::requestBlock(size_t minRequest, size_t* actual) {
+    // Without a drawing thread nothing would ever empty the ring.
+    if (!fStarted) {
+        return NULL;
+    }
+    return fRing.requestBlock(minRequest, actual);
+}
+
+void SkGPipeThreadedController::notifyWritten(size_t bytes) {
+    fRing.notifyWritten(bytes);
+}
+
+void SkGPipeThreadedController::DrawThreadMain(void* data) {
+    SkGPipeThreadedController* controller = static_cast<SkGPipeThreadedController*>(data);
+    SkCanvas* canvas = controller->fBeginProc(controller->fContext);
+    // The reader tells the writer it has gone away when it is destroyed, so even without a
+    // canvas the writer stops waiting for room.
+    SkGPipeSharedMemoryReader reader(controller->fMemory.get(), controller->fSize, canvas);
+    if (NULL != canvas) {
+        reader.playback(true);
+        controller->fEndProc(canvas, controller->fContext);
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkGPipeThreaded_DEFINED
+#define SkGPipeThreaded_DEFINED
+
+#include "SkGPipe.h"
+#include "SkGPipeSharedMemory.h"
+#include "SkThreadUtils.h"
+
+class SkCanvas;
+
+/**
+ *  Streams an SkGPipe to a drawing thread of its own, so that the thread recording the drawing
+ *  doesn't also pay for playing it back. The drawing thread owns the target canvas; for a GPU
+ *  canvas that means it owns the GL context too, and every GrContext flush and GL call happens
+ *  on it while the recording thread goes on to the next commands.
+ *
+ *  The commands go through an in-memory SkGPipeSharedMemoryController ring. The writer only stops
+ *  when the ring is full and the drawing thread only when it is empty, so recording and playback
+ *  overlap by up to the ring's capacity. Since both sides share an address space, record with
+ *  SkGPipeWriter::kSharedAddressSpace_Flag so bitmaps are passed by reference rather than copied;
+ *  the recording thread must then not change their pixels until they have been drawn.
+ *
+ *  Commands reach the drawing thread a block at a time. Call SkGPipeWriter::flushRecording(true)
+ *  at the end of each frame to hand over what is left of it.
+ */
+class SkGPipeThreadedController : public SkGPipeController {
+public:
+    /**
+     *  Called on the drawing thread before playback starts, to make the GL context current and
+     *  return the canvas to draw into. Returning NULL makes the writer stop.
+     */
+    typedef SkCanvas* (*BeginProc)(void* context);
+
+    /**
+     *  Called on the drawing thread once everything has been played back into the canvas
+     *  BeginProc returned, to flush it and release the context.
+     */
+    typedef void (*EndProc)(SkCanvas*, void* context);
+
+    /**
+     *  capacity is the size of the ring in bytes, and must be a power of two several times the
+     *  largest command.
+     */
+    SkGPipeThreadedController(size_t capacity, BeginProc, EndProc, void* context);
+
+    /** Calls finish(). */
+    virtual ~SkGPipeThreadedController();
+
+    /** Starts the drawing thread. Returns false if it couldn't be started. */
+    bool start();
+
+    /**
+     *  Waits for the drawing thread to play back everything written and run the EndProc. Nothing
+     *  may be written afterwards.
+     */
+    void finish();
+
+    virtual void* requestBlock(size_t minRequest, size_t* actual) SK_OVERRIDE;
+    virtual void notifyWritten(size_t bytes) SK_OVERRIDE;
+
+private:
+    static void DrawThreadMain(void*);
+
+    size_t                          fSize;
+    SkAutoMalloc                    fMemory;
+    SkGPipeSharedMemoryController   fRing;
+    BeginProc                       fBeginProc;
+    EndProc                         fEndProc;
+    void*                           fContext;
+    SkThread                        fThread;
+    bool                            fStarted;
+};
+
+#endif
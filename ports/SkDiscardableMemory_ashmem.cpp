@@ -8,6 +8,9 @@
 #include <unistd.h>
 #include <sys/mman.h>
 #include "SkDiscardableMemory.h"
+#include "SkDiscardableMemory_ashmem.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
 #include "SkTypes.h"
 #include "android/ashmem.h"
 
@@ -86,28 +89,282 @@ void SkAshmemDiscardableMemory::unlock() {
     }
     fLocked = false;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char kRegionName[] = "Skia_Ashmem_Discardable_Memory";
+
+static bool create_region(size_t size, int* fd, void** addr) {
+    *fd = ashmem_create_region(kRegionName, size);
+    if (*fd < 0) {
+        return false;
+    }
+    if (0 != ashmem_set_prot_region(*fd, PROT_READ | PROT_WRITE)) {
+        close(*fd);
+        return false;
+    }
+    *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, *fd, 0);
+    if ((MAP_FAILED == *addr) || (NULL == *addr)) {
+        close(*fd);
+        return false;
+    }
+    return true;
+}
+
+/**
+ *  Small allocations are packed into slabs: ashmem regions of kSlabPages
+ *  pages, of which each allocation takes a run of whole pages and pins and
+ *  unpins only that range.  That saves a file descriptor and a mapping per
+ *  allocation.
+ *
+ *  Unpins are also deferred: unlock() only queues the allocation, and a
+ *  lock() before the queue is flushed takes it back without a syscall.
+ *  Flushing unpins each run of adjacent queued allocations with a single
+ *  ioctl.  The queue is flushed when it gets long, and by
+ *  SkAshmemDiscardableMemoryFlushUnpins(), which embedders call once a
+ *  frame.
+ */
+static const int kSlabPages = 256;
+// Bigger allocations get a region of their own.
+static const int kMaxSlabAllocationPages = kSlabPages / 4;
+// Queued allocations can't be purged, so don't let them pile up.
+static const int kMaxQueuedUnpins = 64;
+static const int kMaxQueuedUnpinPages = 512;
+
+class SkAshmemSlabDiscardableMemory;
+
+struct AshmemSlab {
+    int                             fFd;
+    uint8_t*                        fBase;
+    int                             fUsedPages;
+    // The allocation using each page, or NULL.
+    SkAshmemSlabDiscardableMemory*  fOwners[kSlabPages];
+};
+
+SK_DECLARE_STATIC_MUTEX(gSlabMutex);
+// Guarded by gSlabMutex, as are the slabs and the state of their
+// allocations.
+static SkTDArray<AshmemSlab*> gSlabs;
+static SkTDArray<SkAshmemSlabDiscardableMemory*> gQueuedUnpins;
+static int gQueuedUnpinPages;
+
+class SkAshmemSlabDiscardableMemory : public SkDiscardableMemory {
+public:
+    SkAshmemSlabDiscardableMemory(AshmemSlab* slab, int firstPage, int pageCount);
+    virtual ~SkAshmemSlabDiscardableMemory();
+    virtual bool lock() SK_OVERRIDE;
+    virtual void* data() SK_OVERRIDE;
+    virtual void unlock() SK_OVERRIDE;
+
+    enum State {
+        kLocked_State,
+        kUnpinQueued_State,     // unlocked, but still pinned
+        kUnpinned_State,
+        kPurged_State,          // the pages have gone back to the slab
+    };
+
+    AshmemSlab* const   fSlab;
+    const int           fFirstPage;
+    const int           fPageCount;
+    State               fState;
+};
+
+// Caller must hold gSlabMutex.
+static void release_pages(AshmemSlab* slab, int firstPage, int pageCount) {
+    for (int i = 0; i < pageCount; ++i) {
+        slab->fOwners[firstPage + i] = NULL;
+    }
+    slab->fUsedPages -= pageCount;
+    if (0 == slab->fUsedPages) {
+        munmap(slab->fBase, kSlabPages * getpagesize());
+        close(slab->fFd);
+        gSlabs.remove(gSlabs.find(slab));
+        SkDELETE(slab);
+    }
+}
+
+// Caller must hold gSlabMutex.
+static void flush_queued_unpins() {
+    const size_t pageSize = getpagesize();
+    for (int i = 0; i < gQueuedUnpins.count(); ++i) {
+        SkAshmemSlabDiscardableMemory* dm = gQueuedUnpins[i];
+        if (SkAshmemSlabDiscardableMemory::kUnpinQueued_State != dm->fState) {
+            continue;   // already unpinned with a neighbor
+        }
+        // Grow the run over the queued neighbors on both sides.
+        AshmemSlab* slab = dm->fSlab;
+        int first = dm->fFirstPage;
+        int end = first + dm->fPageCount;
+        while (first > 0 && NULL != slab->fOwners[first - 1] &&
+               SkAshmemSlabDiscardableMemory::kUnpinQueued_State ==
+                   slab->fOwners[first - 1]->fState) {
+            first = slab->fOwners[first - 1]->fFirstPage;
+        }
+        while (end < kSlabPages && NULL != slab->fOwners[end] &&
+               SkAshmemSlabDiscardableMemory::kUnpinQueued_State == slab->fOwners[end]->fState) {
+            end += slab->fOwners[end]->fPageCount;
+        }
+        ashmem_unpin_region(slab->fFd, first * pageSize, (end - first) * pageSize);
+        for (int page = first; page < end; page += slab->fOwners[page]->fPageCount) {
+            slab->fOwners[page]->fState = SkAshmemSlabDiscardableMemory::kUnpinned_State;
+        }
+    }
+    gQueuedUnpins.rewind();
+    gQueuedUnpinPages = 0;
+}
+
+// Caller must hold gSlabMutex.
+static void dequeue_unpin(SkAshmemSlabDiscardableMemory* dm) {
+    int index = gQueuedUnpins.find(dm);
+    SkASSERT(index >= 0);
+    gQueuedUnpins.removeShuffle(index);
+    gQueuedUnpinPages -= dm->fPageCount;
+}
+
+SkAshmemSlabDiscardableMemory::SkAshmemSlabDiscardableMemory(AshmemSlab* slab,
+                                                             int firstPage,
+                                                             int pageCount)
+    : fSlab(slab)
+    , fFirstPage(firstPage)
+    , fPageCount(pageCount)
+    , fState(kLocked_State) {  // Free slab pages are always pinned.
+}
+
+SkAshmemSlabDiscardableMemory::~SkAshmemSlabDiscardableMemory() {
+    SkAutoMutexAcquire am(gSlabMutex);
+    SkASSERT(kLocked_State != fState);
+    switch (fState) {
+        case kUnpinQueued_State:
+            dequeue_unpin(this);
+            break;
+        case kUnpinned_State:
+            // Pin the pages again for the next allocation to use them.
+            ashmem_pin_region(fSlab->fFd, fFirstPage * getpagesize(),
+                              fPageCount * getpagesize());
+            break;
+        case kPurged_State:
+            return;
+        default:
+            break;
+    }
+    release_pages(fSlab, fFirstPage, fPageCount);
+}
+
+bool SkAshmemSlabDiscardableMemory::lock() {
+    SkAutoMutexAcquire am(gSlabMutex);
+    SkASSERT(kLocked_State != fState);
+    switch (fState) {
+        case kUnpinQueued_State:
+            // Never unpinned, so nothing can have been purged.
+            dequeue_unpin(this);
+            fState = kLocked_State;
+            return true;
+        case kUnpinned_State:
+            if (ASHMEM_NOT_PURGED == ashmem_pin_region(fSlab->fFd, fFirstPage * getpagesize(),
+                                                       fPageCount * getpagesize())) {
+                fState = kLocked_State;
+                return true;
+            }
+            // The pages are pinned again but their contents are gone, so
+            // they go back to the slab.
+            fState = kPurged_State;
+            release_pages(fSlab, fFirstPage, fPageCount);
+            return false;
+        default:
+            return false;
+    }
+}
+
+void* SkAshmemSlabDiscardableMemory::data() {
+    SkASSERT(kLocked_State == fState);
+    return fSlab->fBase + fFirstPage * getpagesize();
+}
+
+void SkAshmemSlabDiscardableMemory::unlock() {
+    SkAutoMutexAcquire am(gSlabMutex);
+    SkASSERT(kLocked_State == fState);
+    fState = kUnpinQueued_State;
+    *gQueuedUnpins.append() = this;
+    gQueuedUnpinPages += fPageCount;
+    if (gQueuedUnpins.count() >= kMaxQueuedUnpins ||
+        gQueuedUnpinPages >= kMaxQueuedUnpinPages) {
+        flush_queued_unpins();
+    }
+}
+
+// Caller must hold gSlabMutex. Returns the first of pageCount free pages
+// of slab, or -1.
+static int find_free_pages(const AshmemSlab* slab, int pageCount) {
+    if (kSlabPages - slab->fUsedPages < pageCount) {
+        return -1;
+    }
+    int run = 0;
+    for (int page = 0; page < kSlabPages; ++page) {
+        if (NULL != slab->fOwners[page]) {
+            run = 0;
+        } else if (++run == pageCount) {
+            return page - pageCount + 1;
+        }
+    }
+    return -1;
+}
+
+static SkDiscardableMemory* create_slab_allocation(int pageCount) {
+    SkAutoMutexAcquire am(gSlabMutex);
+    AshmemSlab* slab = NULL;
+    int firstPage = -1;
+    for (int i = 0; i < gSlabs.count() && firstPage < 0; ++i) {
+        slab = gSlabs[i];
+        firstPage = find_free_pages(slab, pageCount);
+    }
+    if (firstPage < 0) {
+        int fd;
+        void* addr;
+        if (!create_region(kSlabPages * getpagesize(), &fd, &addr)) {
+            return NULL;
+        }
+        slab = SkNEW(AshmemSlab);
+        slab->fFd = fd;
+        slab->fBase = static_cast<uint8_t*>(addr);
+        slab->fUsedPages = 0;
+        sk_bzero(slab->fOwners, sizeof(slab->fOwners));
+        *gSlabs.append() = slab;
+        firstPage = 0;
+    }
+
+    SkAshmemSlabDiscardableMemory* dm = SkNEW_ARGS(SkAshmemSlabDiscardableMemory,
+                                                   (slab, firstPage, pageCount));
+    for (int i = 0; i < pageCount; ++i) {
+        slab->fOwners[firstPage + i] = dm;
+    }
+    slab->fUsedPages += pageCount;
+    return dm;
+}
+
 }  // namespace
 ////////////////////////////////////////////////////////////////////////////////
 
+void SkAshmemDiscardableMemoryFlushUnpins() {
+    SkAutoMutexAcquire am(gSlabMutex);
+    flush_queued_unpins();
+}
+
 SkDiscardableMemory* SkDiscardableMemory::Create(size_t bytes) {
     // ashmem likes lengths on page boundaries.
     const size_t mask = getpagesize() - 1;
     size_t size = (bytes + mask) & ~mask;
-
-    static const char name[] = "Skia_Ashmem_Discardable_Memory";
-    int fd = ashmem_create_region(name, size);
-    if (fd < 0) {
+    if (0 == size) {
         return NULL;
     }
-    if (0 != ashmem_set_prot_region(fd, PROT_READ | PROT_WRITE)) {
-        close(fd);
-        return NULL;
+
+    if (size <= kMaxSlabAllocationPages * (mask + 1)) {
+        return create_slab_allocation(SkToInt(size / (mask + 1)));
     }
-    void* addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
-    if ((MAP_FAILED == addr) || (NULL == addr)) {
-        close(fd);
+
+    int fd;
+    void* addr;
+    if (!create_region(size, &fd, &addr)) {
         return NULL;
     }
-
     return SkNEW_ARGS(SkAshmemDiscardableMemory, (fd, addr, size));
 }
@@ -0,0 +1,19 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDiscardableMemory_ashmem_DEFINED
+#define SkDiscardableMemory_ashmem_DEFINED
+
+/**
+ *  With the ashmem SkDiscardableMemory, unlocking a small allocation only
+ *  queues it to be unpinned; until then it is kept and can't be purged.
+ *  This unpins everything queued, batching adjacent allocations into one
+ *  syscall. Call it once a frame, after drawing.
+ */
+void SkAshmemDiscardableMemoryFlushUnpins();
+
+#endif
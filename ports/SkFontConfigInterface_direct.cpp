@@ -17,6 +17,7 @@
 #include "SkFontConfigInterface.h"
 #include "SkOnce.h"
 #include "SkStream.h"
+#include "SkTInternalLList.h"
 
 size_t SkFontConfigInterface::FontIdentity::writeToMemory(void* addr) const {
     size_t size = sizeof(fID) + sizeof(fTTCIndex);
@@ -121,7 +122,35 @@ public:
                                 SkTArray<FontIdentity>*) SK_OVERRIDE;
 
 private:
+    // The result of one matchFamilyName() call, failed matches included: CSS
+    // fallback lists ask for the same missing families over and over.
+    struct CachedMatch {
+        SK_DECLARE_INTERNAL_LLIST_INTERFACE(CachedMatch);
+
+        bool                fHasRequestedFamily;
+        std::string         fRequestedFamily;
+        SkTypeface::Style   fRequestedStyle;
+
+        bool                fFound;
+        FontIdentity        fIdentity;
+        SkString            fFamilyName;
+        SkTypeface::Style   fStyle;
+    };
+
+    // Both must be called with mutex_ held.
+    bool matchFamilyNameLocked(const char familyName[],
+                               SkTypeface::Style requested,
+                               FontIdentity* outFontIdentifier,
+                               SkString* outFamilyName,
+                               SkTypeface::Style* outStyle);
+    CachedMatch* findCachedMatch(const char familyName[], SkTypeface::Style requested);
+
     SkMutex mutex_;
+
+    // Most recently used at the head.
+    typedef SkTInternalLList<CachedMatch> CachedMatchList;
+    CachedMatchList fMatchCache;
+    int fMatchCacheCount;
 };
 
 static void create_singleton_direct_interface(SkFontConfigInterface** singleton) {
@@ -426,7 +455,11 @@ SkTypeface::Style GetFontStyle(FcPattern* font) {
 
 #define kMaxFontFamilyLength    2048
 
-SkFontConfigInterfaceDirect::SkFontConfigInterfaceDirect() {
+// fontconfig's idea of the installed fonts doesn't change while we run, so
+// the only reason to forget a match is to bound the cache's size.
+#define kMaxCachedMatches       128
+
+SkFontConfigInterfaceDirect::SkFontConfigInterfaceDirect() : fMatchCacheCount(0) {
     SkAutoMutexAcquire ac(mutex_);
 
     FcInit();
@@ -435,6 +468,25 @@ SkFontConfigInterfaceDirect::SkFontConfigInterfaceDirect() {
 }
 
 SkFontConfigInterfaceDirect::~SkFontConfigInterfaceDirect() {
+    while (CachedMatch* match = fMatchCache.head()) {
+        fMatchCache.remove(match);
+        SkDELETE(match);
+    }
+}
+
+SkFontConfigInterfaceDirect::CachedMatch* SkFontConfigInterfaceDirect::findCachedMatch(
+                                                    const char familyName[],
+                                                    SkTypeface::Style requested) {
+    CachedMatchList::Iter iter;
+    CachedMatch* match = iter.init(fMatchCache, CachedMatchList::Iter::kHead_IterStart);
+    for (; NULL != match; match = iter.next()) {
+        if (match->fRequestedStyle == requested &&
+            match->fHasRequestedFamily == (NULL != familyName) &&
+            (NULL == familyName || match->fRequestedFamily == familyName)) {
+            return match;
+        }
+    }
+    return NULL;
 }
 
 bool SkFontConfigInterfaceDirect::matchFamilyName(const char familyName[],
@@ -442,13 +494,55 @@ bool SkFontConfigInterfaceDirect::matchFamilyName(const char familyName[],
                                                   FontIdentity* outIdentity,
                                                   SkString* outFamilyName,
                                                   SkTypeface::Style* outStyle) {
-    std::string familyStr(familyName ? familyName : "");
-    if (familyStr.length() > kMaxFontFamilyLength) {
+    if (familyName && strlen(familyName) > kMaxFontFamilyLength) {
         return false;
     }
 
     SkAutoMutexAcquire ac(mutex_);
 
+    CachedMatch* match = this->findCachedMatch(familyName, style);
+    if (NULL != match) {
+        fMatchCache.remove(match);
+        fMatchCache.addToHead(match);
+    } else {
+        if (fMatchCacheCount >= kMaxCachedMatches) {
+            match = fMatchCache.tail();
+            fMatchCache.remove(match);
+        } else {
+            match = SkNEW(CachedMatch);
+            ++fMatchCacheCount;
+        }
+        match->fHasRequestedFamily = NULL != familyName;
+        match->fRequestedFamily = familyName ? familyName : "";
+        match->fRequestedStyle = style;
+        match->fFound = this->matchFamilyNameLocked(familyName, style, &match->fIdentity,
+                                                    &match->fFamilyName, &match->fStyle);
+        fMatchCache.addToHead(match);
+    }
+
+    if (!match->fFound) {
+        return false;
+    }
+    if (outIdentity) {
+        outIdentity->fTTCIndex = match->fIdentity.fTTCIndex;
+        outIdentity->fString = match->fIdentity.fString;
+    }
+    if (outFamilyName) {
+        *outFamilyName = match->fFamilyName;
+    }
+    if (outStyle) {
+        *outStyle = match->fStyle;
+    }
+    return true;
+}
+
+bool SkFontConfigInterfaceDirect::matchFamilyNameLocked(const char familyName[],
+                                                        SkTypeface::Style style,
+                                                        FontIdentity* outIdentity,
+                                                        SkString* outFamilyName,
+                                                        SkTypeface::Style* outStyle) {
+    std::string familyStr(familyName ? familyName : "");
+
     FcPattern* pattern = FcPatternCreate();
 
     if (familyName) {
@@ -536,18 +630,13 @@ bool SkFontConfigInterfaceDirect::matchFamilyName(const char familyName[],
         return false;
     }
 
-    FcFontSetDestroy(font_set);
+    // 'match' and the strings we got from it belong to font_set.
+    outIdentity->fTTCIndex = face_index;
+    outIdentity->fString.set(c_filename);
+    outFamilyName->set(post_config_family);
+    *outStyle = GetFontStyle(match);
 
-    if (outIdentity) {
-        outIdentity->fTTCIndex = face_index;
-        outIdentity->fString.set(c_filename);
-    }
-    if (outFamilyName) {
-        outFamilyName->set(post_config_family);
-    }
-    if (outStyle) {
-        *outStyle = GetFontStyle(match);
-    }
+    FcFontSetDestroy(font_set);
     return true;
 }
 
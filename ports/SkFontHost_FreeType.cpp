@@ -98,7 +98,16 @@ static bool isLCD(const SkScalerContext::Rec& rec) {
 
 struct SkFaceRec;
 
+/*  gFTMutex guards the library (gFTCount, gFTLibrary) and the list of open
+    faces, so it is held to open or close a face. Work on one face, such as
+    loading glyphs or changing its sizes, is serialized by that face's
+    SkFaceRec::fMutex instead, so different faces run concurrently. The
+    rasterizer's memory pool belongs to the library though, so scan
+    conversion is serialized by gFTRasterMutex. The locks are taken in that
+    order, and gFTRasterMutex is never held while taking another.
+*/
 SK_DECLARE_STATIC_MUTEX(gFTMutex);
+SK_DECLARE_STATIC_MUTEX(gFTRasterMutex);
 static int          gFTCount;
 static FT_Library   gFTLibrary;
 static SkFaceRec*   gFaceRecHead;
@@ -223,9 +232,9 @@ private:
     void getBBoxForCurrentGlyph(SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceRec->fMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph);
 };
@@ -238,8 +247,9 @@ struct SkFaceRec {
     FT_Face         fFace;
     FT_StreamRec    fFTStream;
     SkStream*       fSkStream;
-    uint32_t        fRefCnt;
+    uint32_t        fRefCnt;           // guarded by gFTMutex
     uint32_t        fFontID;
+    SkMutex         fMutex;            // guards all use of fFace
 
     // assumes ownership of the stream, will call unref() when its done
     SkFaceRec(SkStream* strm, uint32_t fontID);
@@ -378,11 +388,13 @@ public:
         fRec = ref_ft_face(tf);
         if (fRec) {
             fFace = fRec->fFace;
+            fRec->fMutex.acquire();
         }
     }
 
     ~AutoFTAccess() {
         if (fFace) {
+            fRec->fMutex.release();
             unref_ft_face(fFace);
         }
         if (0 == --gFTCount) {
@@ -848,6 +860,7 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
         return;
     }
     fFace = fFaceRec->fFace;
+    SkAutoMutexAcquire faceLock(fFaceRec->fMutex);
 
     // A is the total matrix.
     SkMatrix A;
@@ -1023,6 +1036,7 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     SkAutoMutexAcquire  ac(gFTMutex);
 
     if (fFTSize != NULL) {
+        SkAutoMutexAcquire faceLock(fFaceRec->fMutex);
         FT_Done_Size(fFTSize);
     }
 
@@ -1058,10 +1072,13 @@ unsigned SkScalerContext_FreeType::generateGlyphCount() {
 }
 
 uint16_t SkScalerContext_FreeType::generateCharToGlyph(SkUnichar uni) {
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
     return SkToU16(FT_Get_Char_Index( fFace, uni ));
 }
 
 SkUnichar SkScalerContext_FreeType::generateGlyphToChar(uint16_t glyph) {
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
+
     // iterate through each cmap entry, looking for matching glyph indices
     FT_UInt glyphIndex;
     SkUnichar charCode = FT_Get_First_Char( fFace, &glyphIndex );
@@ -1082,7 +1099,7 @@ void SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
     * which are very cheap to compute with some font formats...
     */
     if (fDoLinearMetrics) {
-        SkAutoMutexAcquire  ac(gFTMutex);
+        SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
         if (this->setupSize()) {
             glyph->zeroMetrics();
@@ -1183,7 +1200,7 @@ inline void scaleGlyphMetrics(SkGlyph& glyph, SkScalar scale) {
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     glyph->fRsbDelta = 0;
     glyph->fLsbDelta = 0;
@@ -1288,7 +1305,7 @@ void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
 
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     FT_Error    err;
 
@@ -1306,13 +1323,14 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
     }
 
     emboldenIfNeeded(fFace, fFace->glyph);
+    SkAutoMutexAcquire  rasterLock(gFTRasterMutex);
     generateGlyphImage(fFace, glyph);
 }
 
 
 void SkScalerContext_FreeType::generatePath(const SkGlyph& glyph,
                                             SkPath* path) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     SkASSERT(&glyph && path);
 
@@ -1354,7 +1372,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkPaint::FontMetrics* mx,
         return;
     }
 
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceRec->fMutex);
 
     if (this->setupSize()) {
         ERROR:
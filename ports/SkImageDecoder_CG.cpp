@@ -7,13 +7,13 @@
 
 #include "SkCGUtils.h"
 #include "SkColorPriv.h"
+#include "SkConfig8888.h"
 #include "SkImageDecoder.h"
 #include "SkImageEncoder.h"
 #include "SkMovie.h"
 #include "SkStream.h"
 #include "SkStreamHelpers.h"
 #include "SkTemplates.h"
-#include "SkUnPreMultiply.h"
 
 #ifdef SK_BUILD_FOR_MAC
 #include <ApplicationServices/ApplicationServices.h>
@@ -101,13 +101,20 @@ bool SkImageDecoder_CG::onDecode(SkStream* stream, SkBitmap* bm, Mode mode) {
     }
     if (!bm->isOpaque() && this->getRequireUnpremultipliedColors()) {
         // CGBitmapContext does not support unpremultiplied, so the image has been premultiplied.
-        // Convert to unpremultiplied.
-        for (int i = 0; i < width; ++i) {
-            for (int j = 0; j < height; ++j) {
-                uint32_t* addr = bm->getAddr32(i, j);
-                *addr = SkUnPreMultiply::UnPreMultiplyPreservingByteOrder(*addr);
-            }
-        }
+        // Convert to unpremultiplied, in place.
+        SkDstPixelInfo dstPI;
+        dstPI.fColorType = kN32_SkColorType;
+        dstPI.fAlphaType = kUnpremul_SkAlphaType;
+        dstPI.fPixels = bm->getPixels();
+        dstPI.fRowBytes = bm->rowBytes();
+
+        SkSrcPixelInfo srcPI;
+        srcPI.fColorType = kN32_SkColorType;
+        srcPI.fAlphaType = kPremul_SkAlphaType;
+        srcPI.fPixels = bm->getPixels();
+        srcPI.fRowBytes = bm->rowBytes();
+
+        srcPI.convertPixelsTo(&dstPI, width, height);
         bm->setAlphaType(kUnpremul_SkAlphaType);
     }
     return true;
@@ -10,6 +10,7 @@
 
 #include "SkChunkAlloc.h"
 #include "SkRecords.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 
 // SkRecord (REC-ord) represents a sequence of SkCanvas calls, saved for future use.
@@ -34,6 +35,9 @@ public:
         for (unsigned i = 0; i < this->count(); i++) {
             this->mutate(i, destroyer);
         }
+        for (int i = 0; i < fPaints.count(); i++) {
+            fPaints[i]->~SkPaint();
+        }
     }
 
     // Returns the number of canvas commands in this SkRecord.
@@ -108,7 +112,25 @@ public:
         return fRecords[i].set(this->alloc<T>());
     }
 
+    // Return a read-only copy of paint, to be freed when the SkRecord is destroyed.  If one of the
+    // last few paints interned is identical to paint, we return that instead of making a new copy.
+    const SkPaint* internPaint(const SkPaint& paint) {
+        const int stop = SkTMax(0, fPaints.count() - kPaintInternWindow);
+        for (int i = fPaints.count() - 1; i >= stop; i--) {
+            if (*fPaints[i] == paint) {
+                return fPaints[i];
+            }
+        }
+        SkPaint* copy = SkNEW_PLACEMENT_ARGS(this->alloc<SkPaint>(), SkPaint, (paint));
+        fPaints.push(copy);
+        return copy;
+    }
+
 private:
+    // How many of the most recent interned paints internPaint() compares against.  Runs of draws
+    // tend to share a paint, so a short window catches most duplicates without going quadratic.
+    enum { kPaintInternWindow = 8 };
+
     // Implementation notes!
     //
     // Logically an SkRecord is structured as an array of pointers into a big chunk of memory where
@@ -208,6 +230,8 @@ private:
     SkChunkAlloc fAlloc;
     SkAutoTMalloc<Record> fRecords;
     SkAutoTMalloc<Type8> fTypes;
+    // Paints from internPaint().  The SkPaints themselves live in fAlloc.
+    SkTDArray<SkPaint*> fPaints;
     // fCount and fReserved measure both fRecords and fTypes, which always grow in lock step.
     unsigned fCount;
     unsigned fReserved;
@@ -7,18 +7,50 @@
 
 #include "SkRecordDraw.h"
 
+#include "SkBBoxHierarchy.h"
+#include "SkPaintPriv.h"
+#include "SkTSort.h"
+
 namespace {
 
+// Most commands draw something.  These instead change state that later draws depend on, so they
+// must always be played back, and are never put in an SkBBoxHierarchy.
+template <typename T> bool is_draw(const T&) { return true; }
+#define STATE(T) bool is_draw(const SkRecords::T&) { return false; }
+STATE(NoOp);
+STATE(Restore);
+STATE(Save);
+STATE(SaveLayer);
+STATE(Concat);
+STATE(SetMatrix);
+STATE(ClipPath);
+STATE(ClipRRect);
+STATE(ClipRect);
+STATE(ClipRegion);
+STATE(PushCull);
+STATE(PopCull);
+STATE(PairedPushCull);
+#undef STATE
+
 // This is an SkRecord visitor that will draw that SkRecord to an SkCanvas.
 class Draw : SkNoncopyable {
 public:
-    explicit Draw(SkCanvas* canvas) : fCanvas(canvas), fIndex(0) {}
+    explicit Draw(SkCanvas* canvas,
+                  unsigned firstDraw = 0,
+                  const SkTDArray<SkRect>* bounds = NULL,
+                  const SkTDArray<unsigned>* visible = NULL)
+        : fCanvas(canvas), fIndex(0), fFirstDraw(firstDraw)
+        , fBounds(bounds), fVisible(visible), fNextVisible(0) {
+        if (NULL != fBounds && !fCanvas->getClipBounds(&fQuery)) {
+            fQuery.setEmpty();
+        }
+    }
 
     unsigned index() const { return fIndex; }
     void next() { ++fIndex; }
 
     template <typename T> void operator()(const T& r) {
-        if (!this->skip(r)) {
+        if (!this->outsideQuery(r) && !this->skip(r)) {
             this->draw(r);
         }
     }
@@ -44,9 +76,44 @@ private:
     bool skip(const SkRecords::BoundedDrawPosTextH& r) {
         return fCanvas->quickRejectY(r.minY, r.maxY);
     }
+    bool skip(const SkRecords::DrawTextRun& r) {
+        const SkPaint& paint = r.run->paint();
+        if (!paint.canComputeFastBounds()) {
+            return false;
+        }
+        SkRect storage;
+        return fCanvas->quickReject(paint.computeFastBounds(r.run->bounds(), &storage));
+    }
+
+    // Commands that aren't draws are all bounded by SkRect::MakeLargest(), so this only ever skips
+    // draws.  The clip can only shrink during playback, so testing against its starting bounds is
+    // conservative.  With a list of visible draws from an SkBBoxHierarchy, we skip any draw not on
+    // it instead.  Draws before fFirstDraw are painted over by it, so we skip those too.
+    template <typename T> bool outsideQuery(const T& r) {
+        if (fIndex < fFirstDraw && is_draw(r)) {
+            return true;
+        }
+        if (NULL != fVisible) {
+            return is_draw(r) && !this->isVisible();
+        }
+        return NULL != fBounds && !SkRect::Intersects(fQuery, (*fBounds)[fIndex]);
+    }
+
+    // fVisible is sorted and fIndex only ever increases, so we can just walk along it.
+    bool isVisible() {
+        while (fNextVisible < fVisible->count() && (*fVisible)[fNextVisible] < fIndex) {
+            fNextVisible++;
+        }
+        return fNextVisible < fVisible->count() && (*fVisible)[fNextVisible] == fIndex;
+    }
 
     SkCanvas* fCanvas;
     unsigned fIndex;
+    unsigned fFirstDraw;
+    const SkTDArray<SkRect>* fBounds;
+    SkRect fQuery;
+    const SkTDArray<unsigned>* fVisible;
+    int fNextVisible;
 };
 
 // NoOps draw nothing.
@@ -89,11 +156,485 @@ DRAW(DrawVertices, drawVertices(r.vmode, r.vertexCount, r.vertices, r.texs, r.co
 
 template <> void Draw::draw(const SkRecords::PairedPushCull& r) { this->draw(*r.base); }
 template <> void Draw::draw(const SkRecords::BoundedDrawPosTextH& r) { this->draw(*r.base); }
+template <> void Draw::draw(const SkRecords::DrawTextRun& r) { r.run->draw(fCanvas); }
+
+// Compact points are decoded into temporary storage just for the draw.
+static const int kCompactStackPoints = 128;
+
+template <> void Draw::draw(const SkRecords::DrawCompactPoints& r) {
+    SkAutoSTMalloc<kCompactStackPoints, SkPoint> storage(r.pts.encoded() ? r.pts.count() : 0);
+    fCanvas->drawPoints(r.mode, r.pts.count(), r.pts.decode(storage.get()), r.paint);
+}
+template <> void Draw::draw(const SkRecords::DrawCompactPosText& r) {
+    SkAutoSTMalloc<kCompactStackPoints, SkPoint> storage(r.pos.encoded() ? r.pos.count() : 0);
+    fCanvas->drawPosText(r.text, r.byteLength, r.pos.decode(storage.get()), r.paint);
+}
+
+// Conservative bounds for a single command in its own local coordinates, before its matrix and
+// layer state are taken into account.  Used by Bounder below and by SkRecordLocalBounds().
+class LocalBounds {
+public:
+    static SkRect Unbounded() { return SkRect::MakeLargest(); }
+
+    // Returns rect adjusted by paint (stroke, path effects, mask filters, ...), or unbounded.
+    static SkRect AdjustForPaint(const SkPaint* paint, const SkRect& rect) {
+        if (NULL == paint) {
+            return rect;
+        }
+        if (!paint->canComputeFastBounds()) {
+            return Unbounded();
+        }
+        SkRect storage;
+        return paint->computeFastBounds(rect, &storage);
+    }
+
+    // Glyphs can stick out of their positions by roughly this much.  This is the same guess
+    // SkRecordBoundDrawPosTextH makes.
+    static SkRect AdjustForText(const SkPaint& paint, SkRect rect) {
+        if (paint.isVerticalText()) {
+            return Unbounded();
+        }
+        const SkScalar buffer = paint.getTextSize() * 1.5f;
+        rect.outset(buffer, buffer);
+        return AdjustForPaint(&paint, rect);
+    }
+
+    static SkRect BitmapBounds(const SkBitmap& bitmap) {
+        return SkRect::MakeWH(SkIntToScalar(bitmap.width()), SkIntToScalar(bitmap.height()));
+    }
+
+    // Anything we don't have a specific bound for is unbounded.  That includes all non-draws.
+    template <typename T> static SkRect Bounds(const T&) { return Unbounded(); }
+
+    static SkRect Bounds(const SkRecords::DrawRect& r) { return AdjustForPaint(&r.paint, r.rect); }
+    static SkRect Bounds(const SkRecords::DrawOval& r) { return AdjustForPaint(&r.paint, r.oval); }
+    static SkRect Bounds(const SkRecords::DrawRRect& r) {
+        return AdjustForPaint(&r.paint, r.rrect.rect());
+    }
+    static SkRect Bounds(const SkRecords::DrawDRRect& r) {
+        return AdjustForPaint(&r.paint, r.outer.rect());
+    }
+    static SkRect Bounds(const SkRecords::DrawPath& r) {
+        if (r.path.isInverseFillType()) {
+            return Unbounded();
+        }
+        return AdjustForPaint(&r.paint, r.path.getBounds());
+    }
+    static SkRect Bounds(const SkRecords::DrawPoints& r) {
+        SkRect rect;
+        rect.set(r.pts, SkToInt(r.count));
+        return AdjustForPaint(&r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::DrawBitmap& r) {
+        const SkBitmap& bitmap = r.bitmap;
+        SkRect rect = BitmapBounds(bitmap);
+        rect.offset(r.left, r.top);
+        return AdjustForPaint(r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::DrawBitmapMatrix& r) {
+        const SkBitmap& bitmap = r.bitmap;
+        SkRect rect = BitmapBounds(bitmap);
+        r.matrix.mapRect(&rect);
+        return AdjustForPaint(r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::DrawBitmapNine& r) {
+        return AdjustForPaint(r.paint, r.dst);
+    }
+    static SkRect Bounds(const SkRecords::DrawBitmapRectToRect& r) {
+        return AdjustForPaint(r.paint, r.dst);
+    }
+    static SkRect Bounds(const SkRecords::DrawPosText& r) {
+        const int count = r.paint.countText(r.text, r.byteLength);
+        if (count <= 0) {
+            return SkRect::MakeEmpty();
+        }
+        SkRect rect;
+        rect.set(r.pos, count);
+        return AdjustForText(r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::DrawPosTextH& r) {
+        const int count = r.paint.countText(r.text, r.byteLength);
+        if (count <= 0) {
+            return SkRect::MakeEmpty();
+        }
+        SkRect rect = SkRect::MakeLTRB(r.xpos[0], r.y, r.xpos[0], r.y);
+        for (int i = 1; i < count; i++) {
+            rect.fLeft  = SkMinScalar(rect.fLeft,  r.xpos[i]);
+            rect.fRight = SkMaxScalar(rect.fRight, r.xpos[i]);
+        }
+        return AdjustForText(r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::DrawText& r) {
+        if (r.paint.getTextAlign() != SkPaint::kLeft_Align) {
+            return Unbounded();
+        }
+        SkRect rect;
+        r.paint.measureText(r.text, r.byteLength, &rect);
+        rect.offset(r.x, r.y);
+        return AdjustForPaint(&r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::DrawTextOnPath& r) {
+        SkRect rect = r.path.getBounds();
+        if (r.matrix) {
+            r.matrix->mapRect(&rect);
+        }
+        return AdjustForText(r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::DrawTextRun& r) {
+        const SkRect& bounds = r.run->bounds();
+        if (bounds == Unbounded()) {
+            return Unbounded();
+        }
+        return AdjustForPaint(&r.run->paint(), bounds);
+    }
+    static SkRect Bounds(const SkRecords::DrawVertices& r) {
+        SkRect rect;
+        rect.set(r.vertices, r.vertexCount);
+        return AdjustForPaint(&r.paint, rect);
+    }
+    static SkRect Bounds(const SkRecords::BoundedDrawPosTextH& r) { return Bounds(*r.base); }
+    static SkRect Bounds(const SkRecords::DrawCompactPoints& r) {
+        const SkPaint& paint = r.paint;
+        return AdjustForPaint(&paint, r.pts.bounds());
+    }
+    static SkRect Bounds(const SkRecords::DrawCompactPosText& r) {
+        if (0 == r.pos.count()) {
+            return SkRect::MakeEmpty();
+        }
+        return AdjustForText(r.paint, r.pos.bounds());
+    }
+};
+
+// This is an SkRecord visitor that computes conservative bounds for each command, tracking the
+// matrix and layer state the command will be drawn with.
+class Bounder : SkNoncopyable {
+public:
+    explicit Bounder(SkTDArray<SkRect>* bounds)
+        : fBounds(bounds), fCTMKnown(true), fFilterLayerDepth(0) {
+        fCTM.reset();
+    }
+
+    template <typename T> void operator()(const T& r) {
+        *fBounds->append() = this->adjustAndMap(LocalBounds::Bounds(r));
+        this->updateState(r);
+    }
+
+private:
+    struct SaveState {
+        SkMatrix ctm;
+        bool ctmKnown;
+        int filterLayerDepth;
+    };
+
+    static SkRect Unbounded() { return LocalBounds::Unbounded(); }
+    static bool IsUnbounded(const SkRect& r) { return r == Unbounded(); }
+
+    // Most commands don't change any state we care about.
+    template <typename T> void updateState(const T&) {}
+
+    void updateState(const SkRecords::Save&) { this->pushState(); }
+    void updateState(const SkRecords::SaveLayer& r) {
+        this->pushState();
+        // An image filter can move pixels anywhere, so we can't bound anything drawn into it.
+        if (r.paint && NULL != r.paint->getImageFilter()) {
+            fFilterLayerDepth++;
+        }
+    }
+    void updateState(const SkRecords::Restore&) {
+        if (fSaveStack.isEmpty()) {
+            return;
+        }
+        const SaveState& state = fSaveStack.top();
+        fCTM = state.ctm;
+        fCTMKnown = state.ctmKnown;
+        fFilterLayerDepth = state.filterLayerDepth;
+        fSaveStack.pop();
+    }
+    void updateState(const SkRecords::Concat& r) { fCTM.preConcat(r.matrix); }
+    // SetMatrix replaces the canvas' whole matrix, which we don't know when bounding.
+    void updateState(const SkRecords::SetMatrix&) { fCTMKnown = false; }
+
+    void pushState() {
+        SaveState state = { fCTM, fCTMKnown, fFilterLayerDepth };
+        fSaveStack.push(state);
+    }
+
+    // Map local bounds into the space of the top of the SkRecord.
+    SkRect adjustAndMap(SkRect rect) const {
+        if (IsUnbounded(rect) || !fCTMKnown || fFilterLayerDepth > 0) {
+            return Unbounded();
+        }
+        fCTM.mapRect(&rect);
+        // Leave room for anti-aliasing and hairlines, which spill up to a pixel outside.
+        rect.outset(SK_Scalar1, SK_Scalar1);
+        return rect;
+    }
+
+    SkTDArray<SkRect>* fBounds;
+    SkTDArray<SaveState> fSaveStack;
+    SkMatrix fCTM;
+    bool fCTMKnown;
+    int fFilterLayerDepth;
+};
+
+// This is an SkRecord visitor that finds the last draw which paints opaque pixels over all of query,
+// the canvas' clip bounds at the start of playback in the SkRecord's coordinates.  Nothing drawn
+// before that draw can show through it.  Like SkDeferredCanvas::isFullFrame(), it only trusts
+// simple fills it can map exactly: rects and bitmaps under a known matrix that keeps rects rects,
+// drawPaint, and clear.
+class Occluder : SkNoncopyable {
+public:
+    explicit Occluder(const SkRect& query)
+        : fQuery(query), fIndex(0), fOccluder(0), fCTMKnown(true), fClipped(false)
+        , fLayerDepth(0), fClipMayGrow(false) {
+        fCTM.reset();
+    }
+
+    // The index of the occluding draw, or 0 if there isn't one.
+    unsigned occluder() const { return fOccluder; }
+
+    template <typename T> void operator()(const T& r) {
+        if (!fClipMayGrow && this->covers(r)) {
+            fOccluder = fIndex;
+        }
+        this->updateState(r);
+        fIndex++;
+    }
+
+private:
+    struct SaveState {
+        SkMatrix ctm;
+        bool ctmKnown;
+        bool clipped;
+        int layerDepth;
+    };
+
+    template <typename T> bool covers(const T&) const { return false; }
+
+    // clear() replaces the whole layer, whatever the matrix and clip.
+    bool covers(const SkRecords::Clear&) const { return 0 == fLayerDepth; }
+    bool covers(const SkRecords::DrawPaint& r) const {
+        return this->coversQuery(NULL, &r.paint, NULL);
+    }
+    bool covers(const SkRecords::DrawRect& r) const {
+        return this->coversQuery(&r.rect, &r.paint, NULL);
+    }
+    bool covers(const SkRecords::DrawBitmap& r) const {
+        SkRect rect = SkRect::MakeXYWH(r.left, r.top, SkIntToScalar(r.bitmap.width()),
+                                       SkIntToScalar(r.bitmap.height()));
+        return this->coversQuery(&rect, r.paint, &r.bitmap);
+    }
+    bool covers(const SkRecords::DrawBitmapRectToRect& r) const {
+        return this->coversQuery(&r.dst, r.paint, &r.bitmap);
+    }
+
+    // A NULL rect means the draw fills the whole clip.
+    bool coversQuery(const SkRect* rect, const SkPaint* paint, const SkBitmap* bitmap) const {
+        // Clips may cut into the draw, and layers are composited with who knows what.
+        if (fClipped || fLayerDepth > 0) {
+            return false;
+        }
+        if (NULL != paint) {
+            if (NULL == bitmap && SkPaint::kFill_Style != paint->getStyle()) {
+                return false;
+            }
+            if (NULL != paint->getMaskFilter() || NULL != paint->getLooper() ||
+                NULL != paint->getPathEffect() || NULL != paint->getRasterizer() ||
+                NULL != paint->getImageFilter()) {
+                return false;
+            }
+        }
+        if (!isPaintOpaque(paint, bitmap)) {
+            return false;
+        }
+        if (NULL == rect) {
+            return true;
+        }
+        if (!fCTMKnown || !fCTM.rectStaysRect()) {
+            return false;
+        }
+        SkRect mapped;
+        fCTM.mapRect(&mapped, *rect);
+        // query has already been outset for anti-aliasing by SkCanvas::getClipBounds().
+        return mapped.contains(fQuery);
+    }
+
+    template <typename T> void updateState(const T&) {}
+
+    void updateState(const SkRecords::Save&) { this->pushState(); }
+    void updateState(const SkRecords::SaveLayer&) {
+        this->pushState();
+        fLayerDepth++;
+    }
+    void updateState(const SkRecords::Restore&) {
+        if (fSaveStack.isEmpty()) {
+            return;
+        }
+        const SaveState& state = fSaveStack.top();
+        fCTM = state.ctm;
+        fCTMKnown = state.ctmKnown;
+        fClipped = state.clipped;
+        fLayerDepth = state.layerDepth;
+        fSaveStack.pop();
+    }
+    void updateState(const SkRecords::Concat& r) { fCTM.preConcat(r.matrix); }
+    void updateState(const SkRecords::SetMatrix&) { fCTMKnown = false; }
+
+    // An intersect clip that keeps all of query clips nothing we care about.
+    void updateState(const SkRecords::ClipRect& r) {
+        if (SkRegion::kIntersect_Op == r.op && fCTMKnown && fCTM.rectStaysRect()) {
+            SkRect mapped;
+            fCTM.mapRect(&mapped, r.rect);
+            if (mapped.contains(fQuery)) {
+                return;
+            }
+        }
+        this->clip(r.op);
+    }
+    void updateState(const SkRecords::ClipRRect& r) { this->clip(r.op); }
+    void updateState(const SkRecords::ClipPath& r) { this->clip(r.op); }
+    void updateState(const SkRecords::ClipRegion& r) { this->clip(r.op); }
+
+    void clip(SkRegion::Op op) {
+        fClipped = true;
+        // Any other op can let later draws out past query, where no occluder we find covers
+        // them, so we stop looking.
+        if (SkRegion::kIntersect_Op != op && SkRegion::kDifference_Op != op) {
+            fClipMayGrow = true;
+        }
+    }
+
+    void pushState() {
+        SaveState state = { fCTM, fCTMKnown, fClipped, fLayerDepth };
+        fSaveStack.push(state);
+    }
+
+    const SkRect fQuery;
+    unsigned fIndex;
+    unsigned fOccluder;
+    SkTDArray<SaveState> fSaveStack;
+    SkMatrix fCTM;
+    bool fCTMKnown;
+    bool fClipped;
+    int fLayerDepth;
+    bool fClipMayGrow;
+};
+
+// Visits one command to find whether it's a draw.
+struct DrawFinder {
+    template <typename T> void operator()(const T& r) { isDraw = is_draw(r); }
+    bool isDraw;
+};
+
+// Visits one command to find its LocalBounds.
+struct LocalBounder {
+    template <typename T> void operator()(const T& r) { bounds = LocalBounds::Bounds(r); }
+    SkRect bounds;
+};
+
+// Returns the index of the last draw that covers everything the canvas can draw during playback,
+// or 0 if there's none.
+unsigned find_occluder(const SkRecord& record, SkCanvas* canvas) {
+    SkRect query;
+    if (!canvas->getClipBounds(&query)) {
+        return 0;  // Nothing will draw anyway.
+    }
+    Occluder occluder(query);
+    for (unsigned i = 0; i < record.count(); i++) {
+        record.visit(i, occluder);
+    }
+    return occluder.occluder();
+}
 
 }  // namespace
 
 void SkRecordDraw(const SkRecord& record, SkCanvas* canvas) {
-    for (Draw draw(canvas); draw.index() < record.count(); draw.next()) {
+    for (Draw draw(canvas, find_occluder(record, canvas));
+         draw.index() < record.count();
+         draw.next()) {
+        record.visit(draw.index(), draw);
+    }
+}
+
+void SkRecordComputeBounds(const SkRecord& record, SkTDArray<SkRect>* bounds) {
+    SkASSERT(NULL != bounds);
+    bounds->rewind();
+    bounds->setReserve(record.count());
+
+    Bounder bounder(bounds);
+    for (unsigned i = 0; i < record.count(); i++) {
+        record.visit(i, bounder);
+    }
+    SkASSERT(bounds->count() == SkToInt(record.count()));
+}
+
+void SkRecordDraw(const SkRecord& record, SkCanvas* canvas, const SkTDArray<SkRect>& bounds) {
+    SkASSERT(bounds.count() == SkToInt(record.count()));
+    for (Draw draw(canvas, find_occluder(record, canvas), &bounds);
+         draw.index() < record.count();
+         draw.next()) {
+        record.visit(draw.index(), draw);
+    }
+}
+
+SkRect SkRecordLocalBounds(const SkRecord& record, unsigned i) {
+    LocalBounder bounder;
+    record.visit(i, bounder);
+    return bounder.bounds;
+}
+
+void SkRecordFillBounds(const SkRecord& record, const SkRect& cullRect, SkBBoxHierarchy* bbh) {
+    SkASSERT(NULL != bbh);
+    SkTDArray<SkRect> bounds;
+    SkRecordComputeBounds(record, &bounds);
+
+    for (unsigned i = 0; i < record.count(); i++) {
+        DrawFinder finder;
+        record.visit(i, finder);
+        if (!finder.isDraw) {
+            continue;
+        }
+        // Like SkPictureRecord, we assume nothing draws outside the cull rect.
+        SkRect rect = bounds[i];
+        if (rect == SkRect::MakeLargest()) {
+            rect = cullRect;
+        } else if (!rect.intersect(cullRect)) {
+            continue;
+        }
+        SkIRect irect;
+        rect.roundOut(&irect);
+        if (!irect.isEmpty()) {
+            bbh->insert(reinterpret_cast<void*>(static_cast<uintptr_t>(i)), irect, true/*defer*/);
+        }
+    }
+    // Build the whole hierarchy at once, which lets SkRTree bulk load.
+    bbh->flushDeferredInserts();
+}
+
+void SkRecordDraw(const SkRecord& record, SkCanvas* canvas, SkBBoxHierarchy* bbh) {
+    SkASSERT(NULL != bbh);
+    SkTDArray<unsigned> visible;
+
+    SkRect query;
+    if (canvas->getClipBounds(&query)) {
+        SkIRect iquery;
+        query.roundOut(&iquery);
+
+        SkTDArray<void*> results;
+        bbh->search(iquery, &results);
+        visible.setReserve(results.count());
+        for (int i = 0; i < results.count(); i++) {
+            *visible.append() = SkToU32(reinterpret_cast<uintptr_t>(results[i]));
+        }
+        if (visible.count() > 1) {
+            // Not all SkBBoxHierarchies return results in insertion order.
+            SkTQSort(visible.begin(), visible.end() - 1);
+        }
+    }
+
+    for (Draw draw(canvas, find_occluder(record, canvas), NULL, &visible);
+         draw.index() < record.count();
+         draw.next()) {
         record.visit(draw.index(), draw);
     }
 }
@@ -10,8 +10,37 @@
 
 #include "SkRecord.h"
 #include "SkCanvas.h"
+#include "SkTDArray.h"
 
-// Draw an SkRecord into an SkCanvas.
+class SkBBoxHierarchy;
+
+// Draw an SkRecord into an SkCanvas.  Draws that a later opaque draw paints over everywhere the
+// canvas' clip allows (a full-clip drawPaint, clear, or a rect or bitmap covering the clip) are
+// skipped.  All the SkRecordDraw variants below do this too.
 void SkRecordDraw(const SkRecord&, SkCanvas*);
 
+// Fill bounds with one conservative rectangle per command in the SkRecord, in the coordinate space
+// the SkRecord is drawn in (i.e. before any of its own matrix commands are applied).  Commands we
+// can't bound, and all commands that aren't draws, get SkRect::MakeLargest().
+void SkRecordComputeBounds(const SkRecord&, SkTDArray<SkRect>* bounds);
+
+// Returns a conservative rectangle for the i-th command in its own local coordinates, ignoring any
+// matrix or layer state it's drawn with, or SkRect::MakeLargest() if it can't be bounded.  Unlike
+// SkRecordComputeBounds, this leaves no room for anti-aliasing.
+SkRect SkRecordLocalBounds(const SkRecord&, unsigned i);
+
+// Like SkRecordDraw, but uses bounds from SkRecordComputeBounds to skip any draw that falls
+// entirely outside the canvas' clip at the start of playback, without dispatching it at all.
+void SkRecordDraw(const SkRecord&, SkCanvas*, const SkTDArray<SkRect>& bounds);
+
+// Insert the bounds from SkRecordComputeBounds of each draw in the SkRecord into bbh, clipped to
+// cullRect, keyed by the draw's index.  Draws we can't bound are inserted with cullRect.  All the
+// inserts are deferred and flushed at the end, so hierarchies like SkRTree are built in one batch.
+void SkRecordFillBounds(const SkRecord&, const SkRect& cullRect, SkBBoxHierarchy* bbh);
+
+// Like SkRecordDraw, but uses an SkBBoxHierarchy filled by SkRecordFillBounds to find the draws
+// that touch the canvas' clip at the start of playback and skips the rest.  Commands that aren't
+// draws are always played back.
+void SkRecordDraw(const SkRecord&, SkCanvas*, SkBBoxHierarchy* bbh);
+
 #endif//SkRecordDraw_DEFINED
@@ -7,15 +7,19 @@
 
 #include "SkRecordOpts.h"
 
+#include "SkRecordDraw.h"
 #include "SkRecordPattern.h"
 #include "SkRecords.h"
 #include "SkTDArray.h"
+#include "SkXfermode.h"
 
 using namespace SkRecords;
 
 void SkRecordOptimize(SkRecord* record) {
     // TODO(mtklein): fuse independent optimizations to reduce number of passes?
     SkRecordNoopSaveRestores(record);
+    SkRecordFoldSingleDrawLayers(record);
+    SkRecordNoopContainedClips(record);
     SkRecordAnnotateCullingPairs(record);
     SkRecordReduceDrawPosTextStrength(record);  // Helpful to run this before BoundDrawPosTextH.
     SkRecordBoundDrawPosTextH(record);
@@ -69,6 +73,174 @@ void SkRecordNoopSaveRestores(SkRecord* record) {
     while (apply(&pass, record));  // Run until it stops changing things.
 }
 
+// Like IsDraw, but stores itself so we can also ask if the draw touches each pixel at most once,
+// and give the draw a paint if it was recorded without one.  Unlike IsDraw, skips SaveLayer.
+class IsSimpleDraw {
+public:
+    IsSimpleDraw() : fPaint(NULL), fOptionalPaint(NULL), fSingleCoverage(false) {}
+
+    typedef IsSimpleDraw type;
+    type* get() { return this; }
+
+    template <typename T>
+    bool match(T* draw) {
+        IsDraw matcher;
+        if (!matcher.match(draw)) {
+            return false;
+        }
+        fPaint = matcher.get();
+        fOptionalPaint = OptionalPaint(draw);
+        fSingleCoverage = SingleCoverage(draw);
+        return true;
+    }
+    bool match(SaveLayer*) { return false; }
+
+    // The draw's paint, or NULL if it has none or we may not edit it.
+    SkPaint* paint() { return fPaint; }
+
+    // Draws that can take a paint but were recorded without one get a default paint here.
+    // Returns the draw's new paint, or NULL if it can't have one.
+    SkPaint* addPaint(SkRecord* record) {
+        if (NULL != fPaint || NULL == fOptionalPaint) {
+            return NULL;
+        }
+        fPaint = SkNEW_PLACEMENT(record->alloc<SkPaint>(), SkPaint);
+        fOptionalPaint->reset(fPaint);
+        return fPaint;
+    }
+
+    // True if the draw touches each pixel at most once, so that drawing it with alpha scaled is the
+    // same as drawing it into a layer and drawing that layer with the alpha.
+    bool singleCoverage() const { return fSingleCoverage; }
+
+private:
+    template <typename T> static Optional<SkPaint>* OptionalPaint(T*) { return NULL; }
+    static Optional<SkPaint>* OptionalPaint(DrawBitmap* d) { return &d->paint; }
+    static Optional<SkPaint>* OptionalPaint(DrawBitmapMatrix* d) { return &d->paint; }
+    static Optional<SkPaint>* OptionalPaint(DrawBitmapRectToRect* d) { return &d->paint; }
+
+    // Hairlines are drawn a segment at a time, which can touch pixels twice where segments meet.
+    static bool IsHairline(const SkPaint& paint) {
+        return SkPaint::kFill_Style != paint.getStyle() && 0 == paint.getStrokeWidth();
+    }
+
+    // Text, points and vertices can all overlap themselves, and nine patches blend at the seams.
+    template <typename T> static bool SingleCoverage(T*) { return false; }
+    static bool SingleCoverage(DrawPaint*) { return true; }
+    static bool SingleCoverage(DrawRect* d) { return !IsHairline(d->paint); }
+    static bool SingleCoverage(DrawOval* d) { return !IsHairline(d->paint); }
+    static bool SingleCoverage(DrawRRect* d) { return !IsHairline(d->paint); }
+    static bool SingleCoverage(DrawDRRect* d) { return !IsHairline(d->paint); }
+    static bool SingleCoverage(DrawPath* d) { return !IsHairline(d->paint); }
+    static bool SingleCoverage(DrawBitmap*) { return true; }
+    static bool SingleCoverage(DrawBitmapMatrix*) { return true; }
+    static bool SingleCoverage(DrawBitmapRectToRect*) { return true; }
+
+    SkPaint* fPaint;
+    Optional<SkPaint>* fOptionalPaint;
+    bool fSingleCoverage;
+};
+
+// Returns true if the draw at index i lies inside rect, leaving room for anti-aliasing.  Like
+// SkRecordComputeBounds, this assumes a local unit is at least about a pixel.
+static bool draw_inside(const SkRecord& record, unsigned i, const SkRect& rect) {
+    SkRect bounds = SkRecordLocalBounds(record, i);
+    if (bounds == SkRect::MakeLargest()) {
+        return false;
+    }
+    bounds.outset(SK_Scalar1, SK_Scalar1);
+    return rect.contains(bounds);
+}
+
+// Returns true if drawing a layer with paint does nothing but scale the layer by paint's alpha.
+static bool is_alpha_only(const SkPaint& paint) {
+    return SK_ColorTRANSPARENT == SkColorSetA(paint.getColor(), SK_AlphaTRANSPARENT) &&
+           SkXfermode::IsMode(paint.getXfermode(), SkXfermode::kSrcOver_Mode) &&
+           NULL == paint.getPathEffect() &&
+           NULL == paint.getShader() &&
+           NULL == paint.getMaskFilter() &&
+           NULL == paint.getColorFilter() &&
+           NULL == paint.getRasterizer() &&
+           NULL == paint.getLooper() &&
+           NULL == paint.getImageFilter();
+}
+
+// Returns true if scaling paint's alpha scales what it draws, as the layer would have.
+static bool can_scale_alpha(const SkPaint& paint) {
+    return SkXfermode::IsMode(paint.getXfermode(), SkXfermode::kSrcOver_Mode) &&
+           NULL == paint.getColorFilter() &&
+           NULL == paint.getLooper() &&
+           NULL == paint.getImageFilter();
+}
+
+// Turns SaveLayer-[draw]-Restore into just the draw when the layer only applies alpha, folding the
+// layer's alpha into the draw's paint.  This saves allocating, clearing and compositing a layer.
+struct SingleDrawLayerFolder {
+    typedef Pattern3<Is<SaveLayer>, IsSimpleDraw, Is<Restore> > Pattern;
+
+    bool onMatch(SkRecord* record, Pattern* pattern, unsigned begin, unsigned end) {
+        SkASSERT(end == begin + 3);
+        SaveLayer* saveLayer = pattern->first<SaveLayer>();
+        IsSimpleDraw* draw = pattern->second<IsSimpleDraw>();
+
+        // The layer clips to its bounds, so the draw must already fit inside them.
+        const SkRect* layerBounds = saveLayer->bounds;
+        if (NULL != layerBounds && !draw_inside(*record, begin + 1, *layerBounds)) {
+            return false;
+        }
+
+        const SkPaint* layerPaint = saveLayer->paint;
+        if (NULL != layerPaint) {
+            if (!is_alpha_only(*layerPaint) || !draw->singleCoverage()) {
+                return false;
+            }
+            SkPaint* paint = draw->paint();
+            if (NULL != paint && !can_scale_alpha(*paint)) {
+                return false;
+            }
+            if (NULL == paint && NULL == (paint = draw->addPaint(record))) {
+                return false;
+            }
+            paint->setAlpha(SkMulDiv255Round(paint->getAlpha(), layerPaint->getAlpha()));
+        }
+        // Otherwise the layer did nothing at all.
+
+        record->replace<NoOp>(begin);
+        record->replace<NoOp>(end - 1);
+        return true;
+    }
+};
+void SkRecordFoldSingleDrawLayers(SkRecord* record) {
+    SingleDrawLayerFolder pass;
+    apply(&pass, record);
+}
+
+// Turns Save-ClipRect-[draw]-Restore into just the draw when the clip doesn't cut into the draw.
+struct ContainedClipNooper {
+    typedef Pattern4<Is<Save>, Is<ClipRect>, IsSimpleDraw, Is<Restore> > Pattern;
+
+    bool onMatch(SkRecord* record, Pattern* pattern, unsigned begin, unsigned end) {
+        SkASSERT(end == begin + 4);
+        // Restore has to undo the clip, and the clip can't be anything but a plain intersect.
+        if (!(pattern->first<Save>()->flags & SkCanvas::kClip_SaveFlag)) {
+            return false;
+        }
+        const ClipRect* clip = pattern->second<ClipRect>();
+        if (SkRegion::kIntersect_Op != clip->op || !draw_inside(*record, begin + 2, clip->rect)) {
+            return false;
+        }
+
+        record->replace<NoOp>(begin);
+        record->replace<NoOp>(begin + 1);
+        record->replace<NoOp>(end - 1);
+        return true;
+    }
+};
+void SkRecordNoopContainedClips(SkRecord* record) {
+    ContainedClipNooper pass;
+    apply(&pass, record);
+}
+
 // Replaces DrawPosText with DrawPosTextH when all Y coordinates are equal.
 struct StrengthReducer {
     typedef Pattern1<Is<DrawPosText> > Pattern;
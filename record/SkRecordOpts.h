@@ -17,6 +17,13 @@ void SkRecordOptimize(SkRecord*);
 // Turns logical no-op Save-[non-drawing command]*-Restore patterns into actual no-ops.
 void SkRecordNoopSaveRestores(SkRecord*);
 
+// Turns SaveLayer-[single draw]-Restore into just the draw, with the layer's alpha folded into the
+// draw's paint, when the layer does nothing else.
+void SkRecordFoldSingleDrawLayers(SkRecord*);
+
+// Turns Save-ClipRect-[single draw]-Restore into just the draw when the clip contains the draw.
+void SkRecordNoopContainedClips(SkRecord*);
+
 // Annotates PushCull commands with the relative offset of their paired PopCull.
 void SkRecordAnnotateCullingPairs(SkRecord*);
 
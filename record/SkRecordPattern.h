@@ -53,10 +53,18 @@ public:
         return false;
     }
 
+    // Text runs keep their paint inside the shared run, so there's no paint to hand out.
+    bool match(SkRecords::DrawTextRun*) {
+        fPaint = NULL;
+        return true;
+    }
+
 private:
     // Abstracts away whether the paint is always part of the command or optional.
     template <typename T> static T* AsPtr(SkRecords::Optional<T>& x) { return x; }
     template <typename T> static T* AsPtr(T& x) { return &x; }
+    // Shared paints may be used by other commands too, so we don't hand them out for editing.
+    static SkPaint* AsPtr(SkRecords::SharedPaint&) { return NULL; }
 
     type* fPaint;
 };
@@ -214,6 +222,9 @@ struct Pattern2 : Cons<A, Pattern1<B> > {};
 template <typename A, typename B, typename C>
 struct Pattern3 : Cons<A, Pattern2<B, C> > {};
 
+template <typename A, typename B, typename C, typename D>
+struct Pattern4 : Cons<A, Pattern3<B, C, D> > {};
+
 }  // namespace SkRecords
 
 #endif//SkRecordPattern_DEFINED
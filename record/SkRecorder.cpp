@@ -9,8 +9,9 @@
 #include "SkPicture.h"
 
 // SkCanvas will fail in mysterious ways if it doesn't know the real width and height.
-SkRecorder::SkRecorder(SkRecorder::Mode mode, SkRecord* record, int width, int height)
-    : SkCanvas(width, height), fMode(mode), fRecord(record) {}
+SkRecorder::SkRecorder(SkRecorder::Mode mode, SkRecord* record, int width, int height,
+                       bool compact)
+    : SkCanvas(width, height), fMode(mode), fCompact(compact), fRecord(record) {}
 
 void SkRecorder::forgetRecord() {
     fRecord = NULL;
@@ -81,6 +82,62 @@ char* SkRecorder::copy(const char src[], unsigned count) {
     return dst;
 }
 
+// Points only encode if they're all exact multiples of 1/64, small enough that the floats we
+// decode them into hold them exactly, and each within an int16_t step of the one before.
+static bool quantize(SkScalar v, int32_t* q) {
+    const SkScalar scaled = v * (1 << SkRecords::CompactPoints::kShift);
+    if (!(SkScalarAbs(scaled) < (1 << 24))) {  // Also bails on NaN.
+        return false;
+    }
+    *q = (int32_t)scaled;
+    return (SkScalar)*q == scaled;
+}
+
+static bool fits_in_step(int32_t from, int32_t to) {
+    const int32_t step = to - from;
+    return step >= SK_MinS16 && step <= SK_MaxS16;
+}
+
+static bool can_encode(const SkPoint pts[], unsigned count) {
+    int32_t x, y;
+    if (count < 2 || !quantize(pts[0].fX, &x) || !quantize(pts[0].fY, &y)) {
+        return false;
+    }
+    for (unsigned i = 1; i < count; i++) {
+        int32_t nextX, nextY;
+        if (!quantize(pts[i].fX, &nextX) || !quantize(pts[i].fY, &nextY) ||
+            !fits_in_step(x, nextX) || !fits_in_step(y, nextY)) {
+            return false;
+        }
+        x = nextX;
+        y = nextY;
+    }
+    return true;
+}
+
+SkRecords::CompactPoints SkRecorder::compact(const SkPoint src[], unsigned count) {
+    SkRect bounds;
+    bounds.set(src, count);
+    if (!can_encode(src, count)) {
+        return SkRecords::CompactPoints(count, bounds, this->copy(src, count));
+    }
+
+    const int kShift = SkRecords::CompactPoints::kShift;
+    const int32_t x0 = (int32_t)(src[0].fX * (1 << kShift)),
+                  y0 = (int32_t)(src[0].fY * (1 << kShift));
+    int16_t* deltas = fRecord->alloc<int16_t>(2 * (count - 1));
+    int32_t x = x0, y = y0;
+    for (unsigned i = 1; i < count; i++) {
+        const int32_t nextX = (int32_t)(src[i].fX * (1 << kShift)),
+                      nextY = (int32_t)(src[i].fY * (1 << kShift));
+        deltas[2*i - 2] = SkToS16(nextX - x);
+        deltas[2*i - 1] = SkToS16(nextY - y);
+        x = nextX;
+        y = nextY;
+    }
+    return SkRecords::CompactPoints(count, bounds, x0, y0, deltas);
+}
+
 void SkRecorder::clear(SkColor color) {
     APPEND(Clear, color);
 }
@@ -93,6 +150,11 @@ void SkRecorder::drawPoints(PointMode mode,
                             size_t count,
                             const SkPoint pts[],
                             const SkPaint& paint) {
+    if (fCompact) {
+        APPEND(DrawCompactPoints,
+               mode, this->compact(pts, SkToU32(count)), fRecord->internPaint(paint));
+        return;
+    }
     APPEND(DrawPoints, mode, count, this->copy(pts, count), delay_copy(paint));
 }
 
@@ -158,6 +220,12 @@ void SkRecorder::onDrawText(const void* text, size_t byteLength,
 void SkRecorder::onDrawPosText(const void* text, size_t byteLength,
                                const SkPoint pos[], const SkPaint& paint) {
     const unsigned points = paint.countText(text, byteLength);
+    if (fCompact) {
+        APPEND(DrawCompactPosText,
+               this->copy((const char*)text, byteLength), byteLength,
+               this->compact(pos, points), fRecord->internPaint(paint));
+        return;
+    }
     APPEND(DrawPosText,
            this->copy((const char*)text, byteLength), byteLength,
            this->copy(pos, points), delay_copy(paint));
@@ -178,6 +246,10 @@ void SkRecorder::onDrawTextOnPath(const void* text, size_t byteLength, const SkP
            delay_copy(path), this->copy(matrix), delay_copy(paint));
 }
 
+void SkRecorder::drawTextRun(const SkTextRun* run) {
+    APPEND(DrawTextRun, run);
+}
+
 void SkRecorder::drawPicture(SkPicture& picture) {
     picture.draw(this);
 }
@@ -25,12 +25,21 @@ public:
     // Write-only averages 10-20% faster, but you can't sensibly inspect the canvas while recording.
     enum Mode { kWriteOnly_Mode, kReadWrite_Mode };
 
+    // In compact mode, SkRecorder trades a little record and playback time for memory:
+    // DrawPoints and DrawPosText are recorded as DrawCompactPoints and DrawCompactPosText, which
+    // share identical paints via SkRecord::internPaint() and delta-encode their points when that's
+    // exact.  SkRecordDraw decodes them transparently.
+    //
     // Does not take ownership of the SkRecord.
-    SkRecorder(Mode mode, SkRecord*, int width, int height);
+    SkRecorder(Mode mode, SkRecord*, int width, int height, bool compact = false);
 
     // Make SkRecorder forget entirely about its SkRecord*; all calls to SkRecorder will fail.
     void forgetRecord();
 
+    // Append to record from now on, e.g. once the previous SkRecord has been played back.  The
+    // canvas state (matrix, clip, saves) carries over.  Does not take ownership.
+    void setRecord(SkRecord* record) { fRecord = record; }
+
     void clear(SkColor) SK_OVERRIDE;
     void drawPaint(const SkPaint& paint) SK_OVERRIDE;
     void drawPoints(PointMode mode,
@@ -107,6 +116,10 @@ public:
     void onPushCull(const SkRect& cullRect) SK_OVERRIDE;
     void onPopCull() SK_OVERRIDE;
 
+    // Not part of SkCanvas: records the run by reference, rather than copying its glyphs,
+    // positions and paint as drawPosText() would.
+    void drawTextRun(const SkTextRun* run);
+
 private:
     template <typename T>
     T* copy(const T*);
@@ -114,7 +127,10 @@ private:
     template <typename T>
     T* copy(const T[], unsigned count);
 
+    SkRecords::CompactPoints compact(const SkPoint[], unsigned count);
+
     const Mode fMode;
+    const bool fCompact;
     SkRecord* fRecord;
 };
 
@@ -12,6 +12,11 @@
 #include "SkRecordDraw.h"
 #include "SkRecorder.h"
 
+// Record in SkRecorder's compact mode, trading a little speed for memory.
+#ifndef SK_RECORD_COMPACT
+    #define SK_RECORD_COMPACT 0
+#endif
+
 namespace EXPERIMENTAL {
 
 SkPlayback::SkPlayback(const SkRecord* record) : fRecord(record) {}
@@ -25,7 +30,8 @@ void SkPlayback::draw(SkCanvas* canvas) const {
 
 SkRecording::SkRecording(int width, int height)
     : fRecord(SkNEW(SkRecord))
-    , fRecorder(SkNEW_ARGS(SkRecorder, (SkRecorder::kReadWrite_Mode, fRecord.get(), width, height)))
+    , fRecorder(SkNEW_ARGS(SkRecorder, (SkRecorder::kReadWrite_Mode, fRecord.get(), width, height,
+                                          SkToBool(SK_RECORD_COMPACT))))
     {}
 
 SkPlayback* SkRecording::releasePlayback() {
@@ -9,6 +9,7 @@
 #define SkRecords_DEFINED
 
 #include "SkCanvas.h"
+#include "SkTextRun.h"
 
 namespace SkRecords {
 
@@ -47,11 +48,14 @@ namespace SkRecords {
     M(DrawSprite)                                                   \
     M(DrawText)                                                     \
     M(DrawTextOnPath)                                               \
+    M(DrawTextRun)                                                  \
     M(DrawVertices)                                                 \
     M(PushCull)                                                     \
     M(PopCull)                                                      \
     M(PairedPushCull)         /*From SkRecordAnnotateCullingPairs*/ \
-    M(BoundedDrawPosTextH)    /*From SkRecordBoundDrawPosTextH*/
+    M(BoundedDrawPosTextH)    /*From SkRecordBoundDrawPosTextH*/    \
+    M(DrawCompactPoints)      /*From SkRecorder's compact mode*/    \
+    M(DrawCompactPosText)     /*From SkRecorder's compact mode*/
 
 // Defines SkRecords::Type, an enum of all record types.
 #define ENUM(T) T##_Type,
@@ -123,6 +127,12 @@ public:
     Optional(T* ptr) : fPtr(ptr) {}
     ~Optional() { if (fPtr) fPtr->~T(); }
 
+    // Point to ptr instead, destroying whatever we pointed to before.
+    void reset(T* ptr) {
+        if (fPtr) fPtr->~T();
+        fPtr = ptr;
+    }
+
     ACT_AS_PTR(fPtr);
 private:
     T* fPtr;
@@ -157,8 +167,78 @@ private:
     T* fPtr;
 };
 
+// Shared holds a ref on a ref-counted object, which the record uses in place of a copy.
+template <typename T>
+class Shared : SkNoncopyable {
+public:
+    Shared(T* ptr) : fPtr(SkRef(ptr)) {}
+    ~Shared() { fPtr->unref(); }
+
+    ACT_AS_PTR(fPtr);
+private:
+    T* fPtr;
+};
+
 #undef ACT_AS_PTR
 
+// SharedPaint points to a paint owned by the SkRecord (see SkRecord::internPaint()), which other
+// commands may be using too.  So it's read-only, and destroying a SharedPaint does nothing.
+class SharedPaint {
+public:
+    SharedPaint(const SkPaint* paint) : fPaint(paint) { SkASSERT(fPaint); }
+    // Default copy and assign.
+
+    operator const SkPaint&() const { return *fPaint; }
+    const SkPaint* operator->() const { return fPaint; }
+private:
+    const SkPaint* fPaint;
+};
+
+// CompactPoints stores an array of points as int16_t steps of 1/64 pixel from the point before,
+// starting from an int32_t origin, when that reproduces every point exactly.  Otherwise it falls
+// back to a plain copy of the points.  Like PODArray, it doesn't own any of its memory.
+class CompactPoints {
+public:
+    // Encoded points.  deltas holds 2*(count-1) steps, x then y.
+    CompactPoints(unsigned count, const SkRect& bounds, int32_t x0, int32_t y0, int16_t* deltas)
+        : fCount(count), fBounds(bounds), fX0(x0), fY0(y0), fDeltas(deltas), fRaw(NULL) {}
+    // Points that couldn't be encoded.
+    CompactPoints(unsigned count, const SkRect& bounds, SkPoint* raw)
+        : fCount(count), fBounds(bounds), fX0(0), fY0(0), fDeltas(NULL), fRaw(raw) {}
+    // Default copy and assign.
+
+    static const int kShift = 6;  // Steps are 1/64 pixel.
+
+    unsigned count() const { return fCount; }
+    const SkRect& bounds() const { return fBounds; }
+    bool encoded() const { return NULL == fRaw; }
+
+    // Returns the points.  If encoded(), they're first decoded into storage, which must have room
+    // for count() points.  Otherwise storage is ignored and may be NULL.
+    const SkPoint* decode(SkPoint* storage) const {
+        if (!this->encoded()) {
+            return fRaw;
+        }
+        const SkScalar scale = SK_Scalar1 / (1 << kShift);
+        int32_t x = fX0, y = fY0;
+        for (unsigned i = 0; i < fCount; i++) {
+            if (i > 0) {
+                x += fDeltas[2*i - 2];
+                y += fDeltas[2*i - 1];
+            }
+            storage[i].set(x * scale, y * scale);
+        }
+        return storage;
+    }
+
+private:
+    unsigned fCount;
+    SkRect fBounds;
+    int32_t fX0, fY0;
+    int16_t* fDeltas;
+    SkPoint* fRaw;
+};
+
 // Like SkBitmap, but deep copies pixels if they're not immutable.
 // Using this, we guarantee the immutability of all bitmaps we record.
 class ImmutableBitmap {
@@ -237,6 +317,7 @@ RECORD5(DrawTextOnPath, PODArray<char>, text,
                         SkPath, path,
                         Optional<SkMatrix>, matrix,
                         SkPaint, paint);
+RECORD1(DrawTextRun, Shared<const SkTextRun>, run);
 
 // This guy is so ugly we just write it manually.
 struct DrawVertices {
@@ -276,6 +357,13 @@ struct DrawVertices {
 RECORD2(PairedPushCull, Adopted<PushCull>, base, unsigned, skip);
 RECORD3(BoundedDrawPosTextH, Adopted<DrawPosTextH>, base, SkScalar, minY, SkScalar, maxY);
 
+// Records added by SkRecorder's compact mode, in place of DrawPoints and DrawPosText.
+RECORD3(DrawCompactPoints, SkCanvas::PointMode, mode, CompactPoints, pts, SharedPaint, paint);
+RECORD4(DrawCompactPosText, PODArray<char>, text,
+                            size_t, byteLength,
+                            CompactPoints, pos,
+                            SharedPaint, paint);
+
 #undef RECORD0
 #undef RECORD1
 #undef RECORD2
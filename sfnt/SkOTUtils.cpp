@@ -9,7 +9,12 @@
 #include "SkEndian.h"
 #include "SkSFNTHeader.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+#include "SkOTTable_glyf.h"
 #include "SkOTTable_head.h"
+#include "SkOTTable_loca.h"
+#include "SkOTTable_maxp.h"
 #include "SkOTTable_name.h"
 #include "SkOTTableTypes.h"
 #include "SkOTUtils.h"
@@ -161,6 +166,268 @@ SkData* SkOTUtils::RenameFont(SkStream* fontData, const char* fontName, int font
 }
 
 
+namespace {
+
+typedef SkSFNTHeader::TableDirectoryEntry TableEntry;
+
+SK_OT_ULONG be_tag(char a, char b, char c, char d) {
+    return SkEndian_SwapBE32(SkSetFourByteTag(a, b, c, d));
+}
+
+// The tables a PDF viewer needs to render an embedded TrueType font.
+bool is_embedding_table(SK_OT_ULONG tag) {
+    return be_tag('c','v','t',' ') == tag || be_tag('f','p','g','m') == tag ||
+           SkOTTableGlyph::TAG == tag || SkOTTableHead::TAG == tag ||
+           be_tag('h','h','e','a') == tag || be_tag('h','m','t','x') == tag ||
+           SkOTTableIndexToLocation::TAG == tag || SkOTTableMaximumProfile::TAG == tag ||
+           be_tag('p','r','e','p') == tag;
+}
+
+// Reads a big endian value as is, for comparing with the byte swapped masks in SkOTTable_*.h.
+SK_OT_USHORT read_raw_u16(const SK_OT_BYTE* data) {
+    SK_OT_USHORT value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// Adds the glyphs that the composite glyph in [glyph, glyphEnd) is built from to keep and
+// pending, if they're not in keep already.
+void add_components(const SK_OT_BYTE* glyph, const SK_OT_BYTE* glyphEnd, int numGlyphs,
+                    bool keep[], SkTDArray<uint16_t>* pending) {
+    typedef SkOTTableGlyphData::Composite::Component::Flags::Raw Flags;
+    const SK_OT_BYTE* component = glyph + 5 * sizeof(SK_OT_SHORT);
+    while (component + 2 * sizeof(SK_OT_USHORT) <= glyphEnd) {
+        SK_OT_USHORT flags = read_raw_u16(component);
+        uint16_t glyphIndex = SkEndian_SwapBE16(read_raw_u16(component + sizeof(SK_OT_USHORT)));
+        if (glyphIndex < numGlyphs && !keep[glyphIndex]) {
+            keep[glyphIndex] = true;
+            *pending->append() = glyphIndex;
+        }
+
+        component += 2 * sizeof(SK_OT_USHORT);
+        component += (flags & Flags::ARG_1_AND_2_ARE_WORDS_Mask) ? 2 * sizeof(SK_OT_FWORD)
+                                                                 : 2 * sizeof(SK_OT_BYTE);
+        if (flags & Flags::WE_HAVE_A_SCALE_Mask) {
+            component += sizeof(SK_OT_F2DOT14);
+        } else if (flags & Flags::WE_HAVE_AN_X_AND_Y_SCALE_Mask) {
+            component += 2 * sizeof(SK_OT_F2DOT14);
+        } else if (flags & Flags::WE_HAVE_A_TWO_BY_TWO_Mask) {
+            component += 4 * sizeof(SK_OT_F2DOT14);
+        }
+        if (!(flags & Flags::MORE_COMPONENTS_Mask)) {
+            break;
+        }
+    }
+}
+
+}  // namespace
+
+SkData* SkOTUtils::SubsetFont(SkStream* fontData, const uint32_t glyphIDs[], int glyphCount) {
+    size_t fontSize = fontData->getLength();
+    if (fontSize < sizeof(SkSFNTHeader)) {
+        return NULL;
+    }
+    SkAutoTMalloc<SK_OT_BYTE> font(fontSize);
+    if (fontData->read(font.get(), fontSize) < fontSize) {
+        return NULL;
+    }
+
+    // Only single TrueType outline fonts; not collections or CFF.
+    const SkSFNTHeader* sfntHeader = reinterpret_cast<const SkSFNTHeader*>(font.get());
+    if (SkSFNTHeader::fontType_WindowsTrueType::TAG != sfntHeader->fontType &&
+        SkSFNTHeader::fontType_MacTrueType::TAG != sfntHeader->fontType) {
+        return NULL;
+    }
+    int numTables = SkEndian_SwapBE16(sfntHeader->numTables);
+    if (sizeof(SkSFNTHeader) + numTables * sizeof(TableEntry) > fontSize) {
+        return NULL;
+    }
+    const TableEntry* tableEntries =
+        reinterpret_cast<const TableEntry*>(font.get() + sizeof(SkSFNTHeader));
+
+    // Find the tables to keep, and the ones needed to subset.
+    SkTDArray<const TableEntry*> keptEntries;
+    const TableEntry* headEntry = NULL;
+    const TableEntry* maxpEntry = NULL;
+    const TableEntry* locaEntry = NULL;
+    const TableEntry* glyfEntry = NULL;
+    for (int i = 0; i < numTables; ++i) {
+        const TableEntry* entry = &tableEntries[i];
+        size_t offset = SkEndian_SwapBE32(entry->offset);
+        size_t length = SkEndian_SwapBE32(entry->logicalLength);
+        if (offset > fontSize || length > fontSize - offset) {
+            return NULL;
+        }
+        if (!is_embedding_table(entry->tag)) {
+            continue;
+        }
+        *keptEntries.append() = entry;
+        if (SkOTTableHead::TAG == entry->tag) {
+            headEntry = entry;
+        } else if (SkOTTableMaximumProfile::TAG == entry->tag) {
+            maxpEntry = entry;
+        } else if (SkOTTableIndexToLocation::TAG == entry->tag) {
+            locaEntry = entry;
+        } else if (SkOTTableGlyph::TAG == entry->tag) {
+            glyfEntry = entry;
+        }
+    }
+    if (NULL == headEntry || NULL == maxpEntry || NULL == locaEntry || NULL == glyfEntry ||
+        SkEndian_SwapBE32(headEntry->logicalLength) < sizeof(SkOTTableHead) ||
+        SkEndian_SwapBE32(maxpEntry->logicalLength) < sizeof(SkOTTableMaximumProfile_CFF)) {
+        return NULL;
+    }
+
+    const SkOTTableHead* head =
+        reinterpret_cast<const SkOTTableHead*>(font.get() + SkEndian_SwapBE32(headEntry->offset));
+    if (SkOTTableHead::magicNumberConst != head->magicNumber) {
+        return NULL;
+    }
+    const SkOTTableMaximumProfile* maxp = reinterpret_cast<const SkOTTableMaximumProfile*>(
+        font.get() + SkEndian_SwapBE32(maxpEntry->offset));
+    int numGlyphs = SkEndian_SwapBE16(maxp->version.tt.numGlyphs);
+
+    // Read the glyphs' offsets into 'glyf'.
+    bool longOffsets = SkOTTableHead::IndexToLocFormat::LongOffsets == head->indexToLocFormat.value;
+    size_t locaEntrySize = longOffsets ? sizeof(SK_OT_ULONG) : sizeof(SK_OT_USHORT);
+    if ((numGlyphs + 1) * locaEntrySize > SkEndian_SwapBE32(locaEntry->logicalLength)) {
+        return NULL;
+    }
+    const SkOTTableIndexToLocation* loca = reinterpret_cast<const SkOTTableIndexToLocation*>(
+        font.get() + SkEndian_SwapBE32(locaEntry->offset));
+    const SK_OT_BYTE* glyf = font.get() + SkEndian_SwapBE32(glyfEntry->offset);
+    size_t glyfLength = SkEndian_SwapBE32(glyfEntry->logicalLength);
+
+    SkAutoTMalloc<uint32_t> glyphOffsets(numGlyphs + 1);
+    for (int i = 0; i <= numGlyphs; ++i) {
+        SK_OT_ULONG offset;
+        if (longOffsets) {
+            memcpy(&offset, &loca->offsets.longOffset[i], sizeof(offset));
+            offset = SkEndian_SwapBE32(offset);
+        } else {
+            offset = SkEndian_SwapBE16(read_raw_u16(
+                reinterpret_cast<const SK_OT_BYTE*>(&loca->offsets.shortOffset[i]))) << 1;
+        }
+        if (offset > glyfLength || (i > 0 && offset < glyphOffsets[i - 1])) {
+            return NULL;
+        }
+        glyphOffsets[i] = offset;
+    }
+
+    // Glyph 0 (.notdef) is always kept, as are the components of kept composite glyphs.
+    SkAutoTMalloc<bool> keep(numGlyphs);
+    memset(keep.get(), 0, numGlyphs * sizeof(bool));
+    SkTDArray<uint16_t> pending;
+    keep[0] = true;
+    *pending.append() = 0;
+    for (int i = 0; i < glyphCount; ++i) {
+        if (glyphIDs[i] < static_cast<uint32_t>(numGlyphs) && !keep[glyphIDs[i]]) {
+            keep[glyphIDs[i]] = true;
+            *pending.append() = SkToU16(glyphIDs[i]);
+        }
+    }
+    while (!pending.isEmpty()) {
+        uint16_t glyphID;
+        pending.pop(&glyphID);
+        const SK_OT_BYTE* glyph = glyf + glyphOffsets[glyphID];
+        const SK_OT_BYTE* glyphEnd = glyf + glyphOffsets[glyphID + 1];
+        if (glyphEnd - glyph < static_cast<ptrdiff_t>(5 * sizeof(SK_OT_SHORT))) {
+            continue;
+        }
+        int16_t numberOfContours = SkEndian_SwapBE16(read_raw_u16(glyph));
+        if (numberOfContours < 0) {
+            add_components(glyph, glyphEnd, numGlyphs, keep.get(), &pending);
+        }
+    }
+
+    // Lay out the new 'glyf', with each kept glyph 4 byte aligned.
+    SkAutoTMalloc<uint32_t> newGlyphOffsets(numGlyphs + 1);
+    size_t newGlyfLength = 0;
+    for (int i = 0; i < numGlyphs; ++i) {
+        newGlyphOffsets[i] = SkToU32(newGlyfLength);
+        if (keep[i]) {
+            newGlyfLength += SkAlign4(glyphOffsets[i + 1] - glyphOffsets[i]);
+        }
+    }
+    newGlyphOffsets[numGlyphs] = SkToU32(newGlyfLength);
+    size_t newLocaLength = (numGlyphs + 1) * sizeof(SK_OT_ULONG);
+
+    int newNumTables = keptEntries.count();
+    size_t newDataSize = sizeof(SkSFNTHeader) + newNumTables * sizeof(TableEntry);
+    for (int i = 0; i < newNumTables; ++i) {
+        if (glyfEntry == keptEntries[i]) {
+            newDataSize += newGlyfLength;
+        } else if (locaEntry == keptEntries[i]) {
+            newDataSize += newLocaLength;
+        } else {
+            newDataSize += SkAlign4(SkEndian_SwapBE32(keptEntries[i]->logicalLength));
+        }
+    }
+
+    SK_OT_BYTE* data = static_cast<SK_OT_BYTE*>(sk_malloc_throw(newDataSize));
+    SkAutoTUnref<SkData> subsetFontData(SkData::NewFromMalloc(data, newDataSize));
+    sk_bzero(data, newDataSize);
+
+    // Write the header; the kept tables are still sorted by tag.
+    SkSFNTHeader* newHeader = reinterpret_cast<SkSFNTHeader*>(data);
+    int entrySelector = 31 - SkCLZ(newNumTables);
+    int searchRange = (1 << entrySelector) * sizeof(TableEntry);
+    newHeader->fontType = sfntHeader->fontType;
+    newHeader->numTables = SkEndian_SwapBE16(SkToU16(newNumTables));
+    newHeader->searchRange = SkEndian_SwapBE16(SkToU16(searchRange));
+    newHeader->entrySelector = SkEndian_SwapBE16(SkToU16(entrySelector));
+    newHeader->rangeShift =
+        SkEndian_SwapBE16(SkToU16(newNumTables * sizeof(TableEntry) - searchRange));
+
+    TableEntry* newEntries = reinterpret_cast<TableEntry*>(data + sizeof(SkSFNTHeader));
+    SkOTTableHead* newHead = NULL;
+    size_t offset = sizeof(SkSFNTHeader) + newNumTables * sizeof(TableEntry);
+    for (int i = 0; i < newNumTables; ++i) {
+        const TableEntry* entry = keptEntries[i];
+        SK_OT_BYTE* table = data + offset;
+        size_t length;
+        if (glyfEntry == entry) {
+            for (int g = 0; g < numGlyphs; ++g) {
+                if (keep[g]) {
+                    memcpy(table + newGlyphOffsets[g], glyf + glyphOffsets[g],
+                           glyphOffsets[g + 1] - glyphOffsets[g]);
+                }
+            }
+            length = newGlyfLength;
+        } else if (locaEntry == entry) {
+            SK_OT_ULONG* newLoca = reinterpret_cast<SK_OT_ULONG*>(table);
+            for (int g = 0; g <= numGlyphs; ++g) {
+                newLoca[g] = SkEndian_SwapBE32(newGlyphOffsets[g]);
+            }
+            length = newLocaLength;
+        } else {
+            length = SkEndian_SwapBE32(entry->logicalLength);
+            memcpy(table, font.get() + SkEndian_SwapBE32(entry->offset), length);
+            if (headEntry == entry) {
+                newHead = reinterpret_cast<SkOTTableHead*>(table);
+                newHead->checksumAdjustment = SkEndian_SwapBE32(0);
+                newHead->indexToLocFormat.value = SkOTTableHead::IndexToLocFormat::LongOffsets;
+            }
+        }
+
+        newEntries[i].tag = entry->tag;
+        newEntries[i].offset = SkEndian_SwapBE32(SkToU32(offset));
+        newEntries[i].logicalLength = SkEndian_SwapBE32(SkToU32(length));
+        newEntries[i].checksum = SkEndian_SwapBE32(
+            SkOTUtils::CalcTableChecksum(reinterpret_cast<SK_OT_ULONG*>(table), length));
+        offset += SkAlign4(length);
+    }
+    SkASSERT(offset == newDataSize);
+
+    uint32_t unadjustedFontChecksum =
+        SkOTUtils::CalcTableChecksum(reinterpret_cast<SK_OT_ULONG*>(data), newDataSize);
+    newHead->checksumAdjustment =
+        SkEndian_SwapBE32(SkOTTableHead::fontChecksum - unadjustedFontChecksum);
+
+    return subsetFontData.detach();
+}
+
+
 SkOTUtils::LocalizedStrings_NameTable*
 SkOTUtils::LocalizedStrings_NameTable::CreateForFamilyNames(const SkTypeface& typeface) {
     static const SkFontTableTag nameTag = SkSetFourByteTag('n','a','m','e');
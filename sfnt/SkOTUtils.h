@@ -36,6 +36,19 @@ struct SkOTUtils {
       */
     static SkData* RenameFont(SkStream* fontData, const char* fontName, int fontNameLen);
 
+    /**
+      *  Subsets a TrueType font down to the given glyphs, for embedding. On
+      *  failure (invalid data, or not a single TrueType outline font) returns
+      *  NULL.
+      *
+      *  Glyph IDs are left unchanged: the outlines of all other glyphs are
+      *  emptied, except for glyph 0 and the components of kept composite
+      *  glyphs. Only the tables that rendering an embedded font needs are
+      *  kept (see PDF 32000-1, 9.9): cvt, fpgm, glyf, head, hhea, hmtx, loca,
+      *  maxp and prep.
+      */
+    static SkData* SubsetFont(SkStream* fontData, const uint32_t glyphIDs[], int glyphCount);
+
     /** An implementation of LocalizedStrings which obtains it's data from a 'name' table. */
     class LocalizedStrings_NameTable : public SkTypeface::LocalizedStrings {
     public:
@@ -0,0 +1,1175 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSVGPicture.h"
+
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkDOM.h"
+#include "SkGradientShader.h"
+#include "SkParse.h"
+#include "SkParsePath.h"
+#include "SkPicture.h"
+#include "SkPictureRecorder.h"
+#include "SkStream.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
+#include "SkTDict.h"
+#include "SkTDynamicHash.h"
+#include "SkTInternalLList.h"
+#include "SkThread.h"
+#include "SkXMLParser.h"
+
+#ifndef SK_DEFAULT_SVG_PICTURE_CACHE_COUNT_LIMIT
+    #define SK_DEFAULT_SVG_PICTURE_CACHE_COUNT_LIMIT    256
+#endif
+
+namespace {
+
+// Deeper than any sane document nests use or gradient references, and keeps cycles finite.
+static const int kMaxReferenceDepth = 16;
+
+static bool is_ws(char c) {
+    return c > 0 && c <= ' ';
+}
+
+static const char* skip_ws(const char str[]) {
+    while (is_ws(*str)) {
+        ++str;
+    }
+    return str;
+}
+
+static const char* skip_sep(const char str[]) {
+    while (is_ws(*str) || ',' == *str) {
+        ++str;
+    }
+    return str;
+}
+
+// Lengths are taken in user units, ignoring any unit suffix. Percentages are returned as
+// fractions, which is right for the objectBoundingBox units gradients mostly use.
+static const char* find_length(const char str[], SkScalar* value) {
+    str = SkParse::FindScalar(str, value);
+    if (NULL != str && '%' == *str) {
+        *value = SkScalarMul(*value, SkFloatToScalar(0.01f));
+        ++str;
+    }
+    return str;
+}
+
+// An element's name and attributes, whether it's a node of an SkDOM or the tag a pull parser
+// is on. It only points at them, so mustn't outlive the node or the parser's next token.
+class Element {
+public:
+    Element(const SkDOM& dom, const SkDOM::Node* node) : fName(dom.getName(node)) {
+        SkDOM::AttrIter iter(dom, node);
+        const char* name;
+        const char* value;
+        while (NULL != (name = iter.next(&value))) {
+            *fAttrs.append() = name;
+            *fAttrs.append() = value;
+        }
+    }
+
+    explicit Element(SkXMLPullParser* parser) : fName(parser->getName()) {
+        int count = parser->getAttributeCount();
+        for (int i = 0; i < count; ++i) {
+            SkXMLPullParser::AttrInfo info;
+            parser->getAttributeInfo(i, &info);
+            *fAttrs.append() = info.fName;
+            *fAttrs.append() = info.fValue;
+        }
+    }
+
+    const char* name() const { return fName; }
+    bool is(const char name[]) const { return 0 == strcmp(fName, name); }
+
+    int attrCount() const { return fAttrs.count() >> 1; }
+    const char* attrName(int index) const { return fAttrs[2 * index]; }
+    const char* attrValue(int index) const { return fAttrs[2 * index + 1]; }
+
+    const char* findAttr(const char name[]) const {
+        for (int i = 0; i < fAttrs.count(); i += 2) {
+            if (0 == strcmp(fAttrs[i], name)) {
+                return fAttrs[i + 1];
+            }
+        }
+        return NULL;
+    }
+
+private:
+    const char*              fName;
+    SkTDArray<const char*>   fAttrs;     // name, value, name, value...
+};
+
+static SkScalar get_length(const Element& elem, const char name[], SkScalar defaultValue) {
+    const char* str = elem.findAttr(name);
+    SkScalar value;
+    if (NULL == str || NULL == find_length(str, &value)) {
+        return defaultValue;
+    }
+    return value;
+}
+
+static bool find_opacity(const char str[], SkScalar* opacity) {
+    SkScalar value;
+    if (NULL == find_length(str, &value)) {
+        return false;
+    }
+    *opacity = SkScalarPin(value, 0, SK_Scalar1);
+    return true;
+}
+
+static bool find_color(const char str[], SkColor* color) {
+    str = skip_ws(str);
+    if (0 == strncmp(str, "rgb(", 4)) {
+        SkScalar rgb[3];
+        str += 4;
+        for (int i = 0; i < 3; ++i) {
+            str = SkParse::FindScalar(skip_sep(str), &rgb[i]);
+            if (NULL == str) {
+                return false;
+            }
+            if ('%' == *str) {
+                rgb[i] = SkScalarMul(rgb[i], SkFloatToScalar(2.55f));
+                ++str;
+            }
+        }
+        *color = SkColorSetRGB(SkScalarRoundToInt(SkScalarPin(rgb[0], 0, 255)),
+                               SkScalarRoundToInt(SkScalarPin(rgb[1], 0, 255)),
+                               SkScalarRoundToInt(SkScalarPin(rgb[2], 0, 255)));
+        return true;
+    }
+    // FindColor keeps the alpha it's handed for colors that don't have one.
+    SkColor parsed = SK_ColorBLACK;
+    if (NULL == SkParse::FindColor(str, &parsed)) {
+        return false;
+    }
+    *color = parsed;
+    return true;
+}
+
+static bool find_transform(const char str[], SkMatrix* result) {
+    SkMatrix matrix;
+    matrix.reset();
+    for (;;) {
+        str = skip_sep(str);
+        if ('\0' == *str) {
+            break;
+        }
+        const char* name = str;
+        while (('a' <= *str && *str <= 'z') || ('A' <= *str && *str <= 'Z')) {
+            ++str;
+        }
+        size_t nameLen = str - name;
+        str = skip_ws(str);
+        if ('(' != *str) {
+            return false;
+        }
+        ++str;
+
+        SkScalar args[6];
+        int count = 0;
+        for (;;) {
+            str = skip_sep(str);
+            if (')' == *str) {
+                ++str;
+                break;
+            }
+            if (count == (int)SK_ARRAY_COUNT(args)) {
+                return false;
+            }
+            str = SkParse::FindScalar(str, &args[count++]);
+            if (NULL == str) {
+                return false;
+            }
+        }
+
+#define NAME_IS(literal) (nameLen == sizeof(literal) - 1 && 0 == strncmp(name, literal, nameLen))
+        SkMatrix m;
+        if (NAME_IS("matrix") && 6 == count) {
+            m.setAll(args[0], args[2], args[4],
+                     args[1], args[3], args[5],
+                     0, 0, SK_Scalar1);
+        } else if (NAME_IS("translate") && (1 == count || 2 == count)) {
+            m.setTranslate(args[0], 2 == count ? args[1] : 0);
+        } else if (NAME_IS("scale") && (1 == count || 2 == count)) {
+            m.setScale(args[0], 2 == count ? args[1] : args[0]);
+        } else if (NAME_IS("rotate") && 1 == count) {
+            m.setRotate(args[0]);
+        } else if (NAME_IS("rotate") && 3 == count) {
+            m.setRotate(args[0], args[1], args[2]);
+        } else if (NAME_IS("skewX") && 1 == count) {
+            m.setSkew(SkScalarTan(SkDegreesToRadians(args[0])), 0);
+        } else if (NAME_IS("skewY") && 1 == count) {
+            m.setSkew(0, SkScalarTan(SkDegreesToRadians(args[0])));
+        } else {
+            return false;
+        }
+#undef NAME_IS
+        matrix.preConcat(m);
+    }
+    *result = matrix;
+    return true;
+}
+
+// Maps a viewBox to a viewport of width x height, as preserveAspectRatio's default
+// (xMidYMid meet) does.
+static bool find_viewbox_matrix(const char viewBox[], SkScalar width, SkScalar height,
+                                SkMatrix* matrix) {
+    SkScalar box[4];
+    const char* str = viewBox;
+    for (int i = 0; i < 4; ++i) {
+        str = SkParse::FindScalar(skip_sep(str), &box[i]);
+        if (NULL == str) {
+            return false;
+        }
+    }
+    if (box[2] <= 0 || box[3] <= 0) {
+        return false;
+    }
+    SkRect src = SkRect::MakeXYWH(box[0], box[1], box[2], box[3]);
+    SkRect dst = SkRect::MakeWH(width, height);
+    return matrix->setRectToRect(src, dst, SkMatrix::kCenter_ScaleToFit);
+}
+
+// How a shape is filled or stroked.
+struct Paint {
+    enum Kind {
+        kNone_Kind,
+        kColor_Kind,
+        kCurrentColor_Kind,
+        kServer_Kind,       // a gradient, looked up by fServerID when drawing
+    };
+
+    Paint(Kind kind) : fKind(kind), fColor(SK_ColorBLACK) {}
+
+    Kind     fKind;
+    SkColor  fColor;
+    SkString fServerID;
+};
+
+// The inherited properties, plus the few that aren't, reset for each element.
+struct State {
+    State()
+        : fFill(Paint::kColor_Kind)
+        , fStroke(Paint::kNone_Kind)
+        , fCurrentColor(SK_ColorBLACK)
+        , fFillOpacity(SK_Scalar1)
+        , fStrokeOpacity(SK_Scalar1)
+        , fStrokeWidth(SK_Scalar1)
+        , fMiterLimit(SkIntToScalar(4))
+        , fCap(SkPaint::kButt_Cap)
+        , fJoin(SkPaint::kMiter_Join)
+        , fFillType(SkPath::kWinding_FillType)
+        , fVisible(true)
+        , fOpacity(SK_Scalar1)
+        , fDisplay(true)
+        , fStopColor(SK_ColorBLACK)
+        , fStopOpacity(SK_Scalar1) {}
+
+    Paint             fFill;
+    Paint             fStroke;
+    SkColor           fCurrentColor;
+    SkScalar          fFillOpacity;
+    SkScalar          fStrokeOpacity;
+    SkScalar          fStrokeWidth;
+    SkScalar          fMiterLimit;
+    SkPaint::Cap      fCap;
+    SkPaint::Join     fJoin;
+    SkPath::FillType  fFillType;
+    bool              fVisible;
+
+    // Not inherited.
+    SkScalar          fOpacity;
+    bool              fDisplay;
+    SkColor           fStopColor;
+    SkScalar          fStopOpacity;
+};
+
+static void set_paint(Paint* paint, const char value[]) {
+    value = skip_ws(value);
+    if (0 == strncmp(value, "none", 4)) {
+        paint->fKind = Paint::kNone_Kind;
+    } else if (0 == strncmp(value, "currentColor", 12)) {
+        paint->fKind = Paint::kCurrentColor_Kind;
+    } else if (0 == strncmp(value, "url(", 4)) {
+        const char* id = skip_ws(value + 4);
+        if ('#' == *id) {
+            ++id;
+        }
+        const char* end = strchr(id, ')');
+        if (NULL != end) {
+            paint->fKind = Paint::kServer_Kind;
+            paint->fServerID.set(id, end - id);
+        }
+    } else if (find_color(value, &paint->fColor)) {
+        paint->fKind = Paint::kColor_Kind;
+    }
+}
+
+// Applies one presentation property. Unknown properties and unparseable values are ignored,
+// leaving what was inherited.
+static void apply_property(State* state, const char name[], const char value[]) {
+    if (0 == strcmp(name, "fill")) {
+        set_paint(&state->fFill, value);
+    } else if (0 == strcmp(name, "stroke")) {
+        set_paint(&state->fStroke, value);
+    } else if (0 == strcmp(name, "color")) {
+        find_color(value, &state->fCurrentColor);
+    } else if (0 == strcmp(name, "fill-opacity")) {
+        find_opacity(value, &state->fFillOpacity);
+    } else if (0 == strcmp(name, "stroke-opacity")) {
+        find_opacity(value, &state->fStrokeOpacity);
+    } else if (0 == strcmp(name, "opacity")) {
+        find_opacity(value, &state->fOpacity);
+    } else if (0 == strcmp(name, "stroke-width")) {
+        SkScalar width;
+        if (NULL != find_length(value, &width) && width >= 0) {
+            state->fStrokeWidth = width;
+        }
+    } else if (0 == strcmp(name, "stroke-miterlimit")) {
+        SkScalar limit;
+        if (NULL != SkParse::FindScalar(value, &limit) && limit >= SK_Scalar1) {
+            state->fMiterLimit = limit;
+        }
+    } else if (0 == strcmp(name, "stroke-linecap")) {
+        int index = SkParse::FindList(skip_ws(value), "butt,round,square");
+        if (index >= 0) {
+            state->fCap = (SkPaint::Cap)index;
+        }
+    } else if (0 == strcmp(name, "stroke-linejoin")) {
+        int index = SkParse::FindList(skip_ws(value), "miter,round,bevel");
+        if (index >= 0) {
+            state->fJoin = (SkPaint::Join)index;
+        }
+    } else if (0 == strcmp(name, "fill-rule")) {
+        state->fFillType = 0 == strncmp(skip_ws(value), "evenodd", 7) ?
+                           SkPath::kEvenOdd_FillType : SkPath::kWinding_FillType;
+    } else if (0 == strcmp(name, "display")) {
+        state->fDisplay = 0 != strncmp(skip_ws(value), "none", 4);
+    } else if (0 == strcmp(name, "visibility")) {
+        state->fVisible = 0 == strncmp(skip_ws(value), "visible", 7);
+    } else if (0 == strcmp(name, "stop-color")) {
+        find_color(value, &state->fStopColor);
+    } else if (0 == strcmp(name, "stop-opacity")) {
+        find_opacity(value, &state->fStopOpacity);
+    }
+}
+
+// Applies the properties in a style attribute: "name: value; name: value".
+static void apply_style(State* state, const char style[]) {
+    SkString name, value;
+    for (;;) {
+        style = skip_ws(style);
+        const char* colon = strchr(style, ':');
+        if (NULL == colon) {
+            break;
+        }
+        const char* nameEnd = colon;
+        while (nameEnd > style && is_ws(nameEnd[-1])) {
+            --nameEnd;
+        }
+        name.set(style, nameEnd - style);
+
+        const char* valueStart = skip_ws(colon + 1);
+        const char* valueEnd = strchr(valueStart, ';');
+        if (NULL == valueEnd) {
+            valueEnd = valueStart + strlen(valueStart);
+        }
+        value.set(valueStart, valueEnd - valueStart);
+
+        apply_property(state, name.c_str(), value.c_str());
+        if ('\0' == *valueEnd) {
+            break;
+        }
+        style = valueEnd + 1;
+    }
+}
+
+static U8CPU opacity_to_alpha(SkScalar opacity) {
+    return SkScalarRoundToInt(opacity * 255);
+}
+
+static bool is_container(const Element& elem) {
+    return elem.is("g") || elem.is("svg");
+}
+
+// These are only drawn through a reference, so are kept aside rather than drawn in place.
+static bool is_referenced(const Element& elem) {
+    return elem.is("defs") || elem.is("symbol") ||
+           elem.is("linearGradient") || elem.is("radialGradient");
+}
+
+// Appends value to xml, escaped for use in a double quoted attribute.
+static void append_escaped(SkString* xml, const char value[]) {
+    for (; '\0' != *value; ++value) {
+        switch (*value) {
+            case '&': xml->append("&amp;"); break;
+            case '<': xml->append("&lt;"); break;
+            case '"': xml->append("&quot;"); break;
+            default:  xml->append(value, 1); break;
+        }
+    }
+}
+
+class Compiler {
+public:
+    // Compiles a whole document held in dom.
+    explicit Compiler(const SkDOM& dom) : fDOM(&dom), fIDs(64), fDepth(0), fRetainedDirty(false) {}
+
+    // Compiles a document read through a pull parser; see compileStream().
+    Compiler() : fDOM(&fRetained), fIDs(64), fDepth(0), fRetainedDirty(false) {
+        fRetainedXML.set("<svg xmlns:xlink=\"http://www.w3.org/1999/xlink\">");
+    }
+
+    SkPicture* compile(const SkDOM::Node* root);
+    SkPicture* compileStream(SkXMLPullParser*);
+
+private:
+    SkCanvas* beginRecording(SkPictureRecorder*, const Element& root, State*) const;
+
+    void collectIDs(const SkDOM::Node* node);
+    const SkDOM::Node* find(const char id[]) const;
+    const SkDOM::Node* findHref(const Element&) const;
+    void retainStartTag(const Element&);
+    void retainEndTag(const char name[]);
+    void updateRetained();
+
+    const char* applyProperties(const Element&, State*) const;
+    SkScalar beginElement(SkCanvas*, const Element&, const State&, const char transform[],
+                          bool fillAndStroke) const;
+
+    void drawNode(SkCanvas*, const SkDOM::Node*, const State& parent);
+    void drawChildren(SkCanvas*, const SkDOM::Node*, const State&);
+    void drawLeaf(SkCanvas*, const Element&, const State&, const char transform[]);
+    void drawUse(SkCanvas*, const Element&, const State&);
+    bool makeShape(const Element&, SkPath*) const;
+    void drawShape(SkCanvas*, SkPath*, const State&, SkScalar opacity);
+    bool setupPaint(SkPaint*, const Paint&, const State&, const SkPath&, SkScalar opacity);
+    const SkDOM::Node* findStops(const SkDOM::Node* gradient) const;
+    SkShader* createGradient(const SkDOM::Node*, const SkPath&, SkScalar opacity);
+
+    const SkDOM*                fDOM;
+    SkTDict<const SkDOM::Node*> fIDs;
+    int                         fDepth;     // of use and gradient references being followed
+
+    // When streaming, only the elements that can be referenced are kept, as XML that is
+    // parsed into fRetained when something is looked up after more was added.
+    SkDOM                       fRetained;
+    SkString                    fRetainedXML;
+    bool                        fRetainedDirty;
+};
+
+void Compiler::collectIDs(const SkDOM::Node* node) {
+    const char* id = fDOM->findAttr(node, "id");
+    if (NULL != id) {
+        fIDs.set(id, node);
+    }
+    for (const SkDOM::Node* child = fDOM->getFirstChild(node); NULL != child;
+         child = fDOM->getNextSibling(child)) {
+        this->collectIDs(child);
+    }
+}
+
+const SkDOM::Node* Compiler::find(const char href[]) const {
+    if (NULL == href) {
+        return NULL;
+    }
+    href = skip_ws(href);
+    if ('#' == *href) {
+        ++href;
+    }
+    const SkDOM::Node* node;
+    return fIDs.find(href, &node) ? node : NULL;
+}
+
+const SkDOM::Node* Compiler::findHref(const Element& elem) const {
+    const char* href = elem.findAttr("xlink:href");
+    return this->find(NULL != href ? href : elem.findAttr("href"));
+}
+
+void Compiler::retainStartTag(const Element& elem) {
+    fRetainedXML.appendf("<%s", elem.name());
+    for (int i = 0; i < elem.attrCount(); ++i) {
+        fRetainedXML.appendf(" %s=\"", elem.attrName(i));
+        append_escaped(&fRetainedXML, elem.attrValue(i));
+        fRetainedXML.append("\"");
+    }
+    fRetainedXML.append(">");
+    fRetainedDirty = true;
+}
+
+void Compiler::retainEndTag(const char name[]) {
+    fRetainedXML.appendf("</%s>", name);
+}
+
+// Reparses everything retained so far. Documents usually put their defs first, so this
+// typically happens once, before the first draw that needs them.
+void Compiler::updateRetained() {
+    if (!fRetainedDirty) {
+        return;
+    }
+    fRetainedDirty = false;
+    fIDs.reset();
+    SkString xml(fRetainedXML);
+    xml.append("</svg>");
+    const SkDOM::Node* root = fRetained.build(xml.c_str(), xml.size());
+    if (NULL != root) {
+        this->collectIDs(root);
+    }
+}
+
+// Applies the element's presentation attributes and then its style, which wins over them.
+// Returns the element's transform attribute, if it has one.
+const char* Compiler::applyProperties(const Element& elem, State* state) const {
+    state->fOpacity = SK_Scalar1;
+    state->fDisplay = true;
+
+    const char* style = NULL;
+    const char* transform = NULL;
+    for (int i = 0; i < elem.attrCount(); ++i) {
+        const char* name = elem.attrName(i);
+        if (0 == strcmp(name, "style")) {
+            style = elem.attrValue(i);
+        } else if (0 == strcmp(name, "transform")) {
+            transform = elem.attrValue(i);
+        } else {
+            apply_property(state, name, elem.attrValue(i));
+        }
+    }
+    if (NULL != style) {
+        apply_style(state, style);
+    }
+    return transform;
+}
+
+// Applies the element's transform, and a layer for its opacity unless that can be folded
+// into its paint: only for a shape that is just filled or just stroked. Returns the opacity
+// left for the paint.
+SkScalar Compiler::beginElement(SkCanvas* canvas, const Element& elem, const State& state,
+                                const char transform[], bool isShape) const {
+    SkMatrix matrix;
+    if (NULL != transform && find_transform(transform, &matrix)) {
+        canvas->concat(matrix);
+    }
+    if (elem.is("svg")) {
+        canvas->translate(get_length(elem, "x", 0), get_length(elem, "y", 0));
+    }
+    if (state.fOpacity < SK_Scalar1 &&
+        (!isShape || (Paint::kNone_Kind != state.fFill.fKind &&
+                      Paint::kNone_Kind != state.fStroke.fKind))) {
+        canvas->saveLayerAlpha(NULL, opacity_to_alpha(state.fOpacity));
+        return SK_Scalar1;
+    }
+    return state.fOpacity;
+}
+
+// Starts recording a picture the size of the root svg element, and sets up state with its
+// properties.
+SkCanvas* Compiler::beginRecording(SkPictureRecorder* recorder, const Element& root,
+                                   State* state) const {
+    const char* viewBox = root.findAttr("viewBox");
+    SkScalar box[4] = { 0, 0, 0, 0 };
+    if (NULL != viewBox) {
+        SkParse::FindScalars(viewBox, box, 4);
+    }
+    SkScalar width = get_length(root, "width", box[2]);
+    SkScalar height = get_length(root, "height", box[3]);
+    int pictureWidth = SkScalarCeilToInt(width);
+    int pictureHeight = SkScalarCeilToInt(height);
+    if (pictureWidth <= 0 || pictureHeight <= 0) {
+        return NULL;
+    }
+
+    SkCanvas* canvas = recorder->beginRecording(pictureWidth, pictureHeight, NULL, 0);
+    SkMatrix viewBoxMatrix;
+    if (NULL != viewBox && find_viewbox_matrix(viewBox, width, height, &viewBoxMatrix)) {
+        canvas->concat(viewBoxMatrix);
+    }
+    this->applyProperties(root, state);
+    if (state->fOpacity < SK_Scalar1) {
+        canvas->saveLayerAlpha(NULL, opacity_to_alpha(state->fOpacity));
+    }
+    return canvas;
+}
+
+SkPicture* Compiler::compile(const SkDOM::Node* root) {
+    if (0 != strcmp(fDOM->getName(root), "svg")) {
+        root = fDOM->getFirstChild(root, "svg");
+        if (NULL == root) {
+            return NULL;
+        }
+    }
+    this->collectIDs(root);
+
+    SkPictureRecorder recorder;
+    State state;
+    SkCanvas* canvas = this->beginRecording(&recorder, Element(*fDOM, root), &state);
+    if (NULL == canvas) {
+        return NULL;
+    }
+    if (state.fDisplay) {
+        this->drawChildren(canvas, root, state);
+    }
+    return recorder.endRecording();
+}
+
+// Draws each element as it is read, keeping only the state of the groups it is in and the
+// elements that can be referenced, so memory stays proportional to the document's depth and
+// its defs rather than its size. A use can only refer to what is in defs, a symbol or a
+// gradient; anything else has been drawn and forgotten by the time it'd be looked up.
+SkPicture* Compiler::compileStream(SkXMLPullParser* parser) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = NULL;
+
+    SkTArray<State> states;     // one per open group, starting with the root
+    SkTDArray<int> saveCounts;
+    int skipDepth = 0;          // of the element being skipped, and what's under it
+    int retainDepth = 0;        // likewise for the element being retained
+
+    for (;;) {
+        switch (parser->nextToken()) {
+            case SkXMLPullParser::ERROR:
+                return NULL;
+            case SkXMLPullParser::END_DOCUMENT:
+                return NULL == canvas ? NULL : recorder.endRecording();
+            case SkXMLPullParser::START_TAG: {
+                Element elem(parser);
+                if (retainDepth > 0) {
+                    this->retainStartTag(elem);
+                    ++retainDepth;
+                    break;
+                }
+                if (skipDepth > 0) {
+                    ++skipDepth;
+                    break;
+                }
+                if (NULL == canvas) {
+                    if (!elem.is("svg")) {
+                        break;
+                    }
+                    states.push_back();
+                    canvas = this->beginRecording(&recorder, elem, &states.back());
+                    if (NULL == canvas) {
+                        return NULL;
+                    }
+                    *saveCounts.append() = canvas->getSaveCount();
+                    if (!states.back().fDisplay) {
+                        skipDepth = 1;
+                    }
+                    break;
+                }
+                if (is_referenced(elem)) {
+                    this->retainStartTag(elem);
+                    retainDepth = 1;
+                    break;
+                }
+
+                State state = states.back();
+                const char* transform = this->applyProperties(elem, &state);
+                if (!state.fDisplay || !is_container(elem)) {
+                    if (state.fDisplay) {
+                        this->updateRetained();
+                        this->drawLeaf(canvas, elem, state, transform);
+                    }
+                    // Anything under a leaf, like a title or an animation, is left out.
+                    skipDepth = 1;
+                    break;
+                }
+                *saveCounts.append() = canvas->save();
+                this->beginElement(canvas, elem, state, transform, false);
+                states.push_back(state);
+                break;
+            }
+            case SkXMLPullParser::END_TAG:
+                if (retainDepth > 0) {
+                    this->retainEndTag(parser->getName());
+                    --retainDepth;
+                } else if (skipDepth > 0) {
+                    --skipDepth;
+                } else if (NULL != canvas) {
+                    canvas->restoreToCount(saveCounts.top());
+                    saveCounts.pop();
+                    states.pop_back();
+                    if (saveCounts.isEmpty()) {
+                        // That was the root; nothing after it is drawn.
+                        return recorder.endRecording();
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void Compiler::drawChildren(SkCanvas* canvas, const SkDOM::Node* node, const State& state) {
+    for (const SkDOM::Node* child = fDOM->getFirstChild(node); NULL != child;
+         child = fDOM->getNextSibling(child)) {
+        if (SkDOM::kElement_Type == fDOM->getType(child)) {
+            this->drawNode(canvas, child, state);
+        }
+    }
+}
+
+void Compiler::drawNode(SkCanvas* canvas, const SkDOM::Node* node, const State& parent) {
+    Element elem(*fDOM, node);
+    State state = parent;
+    const char* transform = this->applyProperties(elem, &state);
+    if (!state.fDisplay) {
+        return;
+    }
+    if (is_container(elem)) {
+        SkAutoCanvasRestore acr(canvas, true);
+        this->beginElement(canvas, elem, state, transform, false);
+        this->drawChildren(canvas, node, state);
+    } else {
+        this->drawLeaf(canvas, elem, state, transform);
+    }
+}
+
+// Draws a use or a shape. defs, symbols, gradients and unsupported elements aren't drawn.
+void Compiler::drawLeaf(SkCanvas* canvas, const Element& elem, const State& state,
+                        const char transform[]) {
+    bool isUse = elem.is("use");
+    SkPath path;
+    if (!isUse && (!state.fVisible || !this->makeShape(elem, &path))) {
+        return;
+    }
+    SkAutoCanvasRestore acr(canvas, true);
+    SkScalar opacity = this->beginElement(canvas, elem, state, transform, !isUse);
+    if (isUse) {
+        this->drawUse(canvas, elem, state);
+    } else {
+        this->drawShape(canvas, &path, state, opacity);
+    }
+}
+
+bool Compiler::makeShape(const Element& elem, SkPath* path) const {
+    if (elem.is("path")) {
+        const char* d = elem.findAttr("d");
+        return NULL != d && SkParsePath::FromSVGString(d, path);
+    }
+    if (elem.is("rect")) {
+        SkRect rect = SkRect::MakeXYWH(get_length(elem, "x", 0),
+                                       get_length(elem, "y", 0),
+                                       get_length(elem, "width", 0),
+                                       get_length(elem, "height", 0));
+        if (rect.isEmpty()) {
+            return false;
+        }
+        // A missing radius takes the other one's value.
+        SkScalar rx = get_length(elem, "rx", -1);
+        SkScalar ry = get_length(elem, "ry", -1);
+        if (rx < 0) {
+            rx = ry;
+        } else if (ry < 0) {
+            ry = rx;
+        }
+        if (rx > 0 && ry > 0) {
+            path->addRoundRect(rect, SkTMin(rx, SkScalarHalf(rect.width())),
+                               SkTMin(ry, SkScalarHalf(rect.height())));
+        } else {
+            path->addRect(rect);
+        }
+        return true;
+    }
+    if (elem.is("circle")) {
+        SkScalar r = get_length(elem, "r", 0);
+        if (r <= 0) {
+            return false;
+        }
+        path->addCircle(get_length(elem, "cx", 0), get_length(elem, "cy", 0), r);
+        return true;
+    }
+    if (elem.is("ellipse")) {
+        SkScalar cx = get_length(elem, "cx", 0);
+        SkScalar cy = get_length(elem, "cy", 0);
+        SkScalar rx = get_length(elem, "rx", 0);
+        SkScalar ry = get_length(elem, "ry", 0);
+        if (rx <= 0 || ry <= 0) {
+            return false;
+        }
+        path->addOval(SkRect::MakeLTRB(cx - rx, cy - ry, cx + rx, cy + ry));
+        return true;
+    }
+    if (elem.is("line")) {
+        path->moveTo(get_length(elem, "x1", 0), get_length(elem, "y1", 0));
+        path->lineTo(get_length(elem, "x2", 0), get_length(elem, "y2", 0));
+        return true;
+    }
+    bool polygon = elem.is("polygon");
+    if (polygon || elem.is("polyline")) {
+        const char* points = elem.findAttr("points");
+        if (NULL == points) {
+            return false;
+        }
+        SkPoint pt;
+        // An odd coordinate out is dropped, along with anything after it.
+        while (NULL != (points = SkParse::FindScalar(skip_sep(points), &pt.fX)) &&
+               NULL != (points = SkParse::FindScalar(skip_sep(points), &pt.fY))) {
+            if (path->isEmpty()) {
+                path->moveTo(pt);
+            } else {
+                path->lineTo(pt);
+            }
+        }
+        if (polygon) {
+            path->close();
+        }
+        return !path->isEmpty();
+    }
+    return false;
+}
+
+const SkDOM::Node* Compiler::findStops(const SkDOM::Node* gradient) const {
+    // Gradients may borrow their stops from the one they reference.
+    for (int depth = 0; NULL != gradient && depth < kMaxReferenceDepth; ++depth) {
+        if (NULL != fDOM->getFirstChild(gradient, "stop")) {
+            return gradient;
+        }
+        gradient = this->findHref(Element(*fDOM, gradient));
+    }
+    return NULL;
+}
+
+SkShader* Compiler::createGradient(const SkDOM::Node* node, const SkPath& path,
+                                   SkScalar opacity) {
+    Element elem(*fDOM, node);
+    bool linear = elem.is("linearGradient");
+    if (!linear && !elem.is("radialGradient")) {
+        return NULL;
+    }
+
+    const SkDOM::Node* stopsNode = this->findStops(node);
+    if (NULL == stopsNode) {
+        return NULL;
+    }
+    SkTDArray<SkColor> colors;
+    SkTDArray<SkScalar> positions;
+    for (const SkDOM::Node* stop = fDOM->getFirstChild(stopsNode, "stop"); NULL != stop;
+         stop = fDOM->getNextSibling(stop, "stop")) {
+        // The stop's color and opacity are properties, so may be set in its style too.
+        Element stopElem(*fDOM, stop);
+        State stopState;
+        this->applyProperties(stopElem, &stopState);
+        SkColor color = stopState.fStopColor;
+        U8CPU alpha = opacity_to_alpha(SkScalarMul(stopState.fStopOpacity, opacity));
+        *colors.append() = SkColorSetA(color, SkMulDiv255Round(SkColorGetA(color), alpha));
+
+        // Offsets are clamped to [0, 1] and to be no less than the one before.
+        SkScalar offset = SkScalarPin(get_length(stopElem, "offset", 0), 0, SK_Scalar1);
+        if (!positions.isEmpty()) {
+            offset = SkTMax(offset, positions.top());
+        }
+        *positions.append() = offset;
+    }
+    if (colors.isEmpty()) {
+        return NULL;
+    }
+    if (1 == colors.count()) {
+        *colors.append() = colors[0];
+        *positions.append() = positions[0];
+    }
+
+    SkShader::TileMode mode = SkShader::kClamp_TileMode;
+    const char* spread = elem.findAttr("spreadMethod");
+    if (NULL != spread) {
+        if (0 == strcmp(spread, "reflect")) {
+            mode = SkShader::kMirror_TileMode;
+        } else if (0 == strcmp(spread, "repeat")) {
+            mode = SkShader::kRepeat_TileMode;
+        }
+    }
+
+    // objectBoundingBox, the default, puts the gradient in the unit square of the shape's bounds.
+    SkMatrix localMatrix;
+    localMatrix.reset();
+    const char* units = elem.findAttr("gradientUnits");
+    if (NULL == units || 0 != strcmp(units, "userSpaceOnUse")) {
+        const SkRect& bounds = path.getBounds();
+        if (bounds.isEmpty()) {
+            return NULL;
+        }
+        localMatrix.setScale(bounds.width(), bounds.height());
+        localMatrix.postTranslate(bounds.fLeft, bounds.fTop);
+    }
+    SkMatrix gradientTransform;
+    const char* transform = elem.findAttr("gradientTransform");
+    if (NULL != transform && find_transform(transform, &gradientTransform)) {
+        localMatrix.preConcat(gradientTransform);
+    }
+
+    if (linear) {
+        SkPoint pts[2];
+        pts[0].set(get_length(elem, "x1", 0), get_length(elem, "y1", 0));
+        pts[1].set(get_length(elem, "x2", SK_Scalar1), get_length(elem, "y2", 0));
+        return SkGradientShader::CreateLinear(pts, colors.begin(), positions.begin(),
+                                              colors.count(), mode, NULL, 0, &localMatrix);
+    }
+    SkPoint center;
+    center.set(get_length(elem, "cx", SK_ScalarHalf), get_length(elem, "cy", SK_ScalarHalf));
+    SkScalar radius = get_length(elem, "r", SK_ScalarHalf);
+    if (radius <= 0) {
+        return NULL;
+    }
+    SkPoint focal;
+    focal.set(get_length(elem, "fx", center.fX), get_length(elem, "fy", center.fY));
+    if (focal == center) {
+        return SkGradientShader::CreateRadial(center, radius, colors.begin(), positions.begin(),
+                                              colors.count(), mode, NULL, 0, &localMatrix);
+    }
+    return SkGradientShader::CreateTwoPointConical(focal, 0, center, radius, colors.begin(),
+                                                   positions.begin(), colors.count(), mode,
+                                                   NULL, 0, &localMatrix);
+}
+
+bool Compiler::setupPaint(SkPaint* skPaint, const Paint& paint, const State& state,
+                          const SkPath& path, SkScalar opacity) {
+    switch (paint.fKind) {
+        case Paint::kNone_Kind:
+            return false;
+        case Paint::kColor_Kind:
+            skPaint->setColor(paint.fColor);
+            skPaint->setAlpha(opacity_to_alpha(opacity));
+            return true;
+        case Paint::kCurrentColor_Kind:
+            skPaint->setColor(state.fCurrentColor);
+            skPaint->setAlpha(opacity_to_alpha(opacity));
+            return true;
+        case Paint::kServer_Kind: {
+            const SkDOM::Node* server = this->find(paint.fServerID.c_str());
+            if (NULL == server) {
+                return false;
+            }
+            SkAutoTUnref<SkShader> shader(this->createGradient(server, path, opacity));
+            if (NULL == shader.get()) {
+                return false;
+            }
+            skPaint->setShader(shader);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Compiler::drawShape(SkCanvas* canvas, SkPath* path, const State& state, SkScalar opacity) {
+    path->setFillType(state.fFillType);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    if (this->setupPaint(&paint, state.fFill, state, *path,
+                         SkScalarMul(state.fFillOpacity, opacity))) {
+        canvas->drawPath(*path, paint);
+    }
+
+    paint.reset();
+    paint.setAntiAlias(true);
+    if (state.fStrokeWidth > 0 &&
+        this->setupPaint(&paint, state.fStroke, state, *path,
+                         SkScalarMul(state.fStrokeOpacity, opacity))) {
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(state.fStrokeWidth);
+        paint.setStrokeMiter(state.fMiterLimit);
+        paint.setStrokeCap(state.fCap);
+        paint.setStrokeJoin(state.fJoin);
+        canvas->drawPath(*path, paint);
+    }
+}
+
+void Compiler::drawUse(SkCanvas* canvas, const Element& use, const State& state) {
+    const SkDOM::Node* ref = this->findHref(use);
+    if (NULL == ref || fDepth >= kMaxReferenceDepth) {
+        return;
+    }
+    ++fDepth;
+    canvas->translate(get_length(use, "x", 0), get_length(use, "y", 0));
+    Element elem(*fDOM, ref);
+    if (elem.is("symbol")) {
+        // A symbol is only drawn through a use, into the use's width and height if it has them.
+        State symbolState = state;
+        const char* transform = this->applyProperties(elem, &symbolState);
+        if (symbolState.fDisplay) {
+            SkAutoCanvasRestore acr(canvas, true);
+            const char* viewBox = elem.findAttr("viewBox");
+            SkScalar width = get_length(use, "width", 0);
+            SkScalar height = get_length(use, "height", 0);
+            SkMatrix matrix;
+            if (NULL != viewBox && width > 0 && height > 0 &&
+                find_viewbox_matrix(viewBox, width, height, &matrix)) {
+                canvas->concat(matrix);
+            }
+            this->beginElement(canvas, elem, symbolState, transform, false);
+            this->drawChildren(canvas, ref, symbolState);
+        }
+    } else {
+        this->drawNode(canvas, ref, state);
+    }
+    --fDepth;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Documents are arbitrary bytes at arbitrary alignment, so this walks them a
+// byte at a time (FNV-1a) rather than going through SkChecksum's word hashes.
+static uint32_t hash_document(const char doc[], size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)doc[i]) * 16777619u;
+    }
+    return hash;
+}
+
+struct Key {
+    Key(const char doc[], size_t len) : fDoc(doc), fLength(len), fHash(hash_document(doc, len)) {}
+
+    bool operator==(const Key& other) const {
+        return fHash == other.fHash && fLength == other.fLength &&
+               0 == memcmp(fDoc, other.fDoc, fLength);
+    }
+
+    const char* fDoc;
+    size_t      fLength;
+    uint32_t    fHash;
+};
+
+// Keeps its own copy of the document, which its key points into.
+struct Rec {
+    Rec(const char doc[], size_t len, SkPicture* picture)
+        : fDoc(SkData::NewWithCopy(doc, len))
+        , fKey(static_cast<const char*>(fDoc->data()), len)
+        , fPicture(SkRef(picture)) {}
+
+    ~Rec() {
+        fPicture->unref();
+    }
+
+    static const Key& GetKey(const Rec& rec) { return rec.fKey; }
+    static uint32_t Hash(const Key& key) { return key.fHash; }
+
+    SkAutoTUnref<SkData> fDoc;
+    const Key            fKey;
+    SkPicture* const     fPicture;
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(Rec);
+};
+
+/**
+ *  The cache itself, which is only ever touched with gMutex held. fList is
+ *  in most recently used order.
+ */
+class Cache {
+public:
+    Cache() : fCount(0), fCountLimit(SK_DEFAULT_SVG_PICTURE_CACHE_COUNT_LIMIT) {}
+
+    SkPicture* findAndRef(const Key& key) {
+        Rec* rec = fHash.find(key);
+        if (NULL == rec) {
+            return NULL;
+        }
+        fList.remove(rec);
+        fList.addToHead(rec);
+        return SkRef(rec->fPicture);
+    }
+
+    void add(const char doc[], size_t len, SkPicture* picture) {
+        if (0 == fCountLimit || NULL != fHash.find(Key(doc, len))) {
+            return;
+        }
+        Rec* rec = SkNEW_ARGS(Rec, (doc, len, picture));
+        fHash.add(rec);
+        fList.addToHead(rec);
+        ++fCount;
+        this->purgeAsNeeded();
+    }
+
+    int countLimit() const { return fCountLimit; }
+
+    int setCountLimit(int newLimit) {
+        int prevLimit = fCountLimit;
+        fCountLimit = SkTMax(newLimit, 0);
+        this->purgeAsNeeded();
+        return prevLimit;
+    }
+
+private:
+    void purgeAsNeeded() {
+        while (fCount > fCountLimit) {
+            Rec* rec = fList.tail();
+            SkASSERT(NULL != rec);
+            fList.remove(rec);
+            fHash.remove(rec->fKey);
+            --fCount;
+            SkDELETE(rec);
+        }
+    }
+
+    SkTDynamicHash<Rec, Key> fHash;
+    SkTInternalLList<Rec> fList;
+    int fCount;
+    int fCountLimit;
+};
+
+SK_DECLARE_STATIC_MUTEX(gMutex);
+
+// Must be called with gMutex held. The cache lives for the life of the process.
+Cache* get_cache() {
+    static Cache* gCache;
+    if (NULL == gCache) {
+        gCache = SkNEW(Cache);
+    }
+    return gCache;
+}
+
+}  // namespace
+
+SkPicture* SkSVGPicture::Compile(const char doc[], size_t len) {
+    SkDOM dom;
+    const SkDOM::Node* root = dom.build(doc, len);
+    if (NULL == root) {
+        return NULL;
+    }
+    Compiler compiler(dom);
+    return compiler.compile(root);
+}
+
+SkPicture* SkSVGPicture::Compile(SkStream* stream) {
+    SkXMLPullParser parser(stream);
+    Compiler compiler;
+    return compiler.compileStream(&parser);
+}
+
+SkPicture* SkSVGPicture::FindOrCompile(const char doc[], size_t len) {
+    {
+        SkAutoMutexAcquire am(gMutex);
+        SkPicture* picture = get_cache()->findAndRef(Key(doc, len));
+        if (NULL != picture) {
+            return picture;
+        }
+    }
+
+    // Compile outside the lock; if two threads race on a document the first to add wins and
+    // the other's picture is simply not cached.
+    SkPicture* picture = Compile(doc, len);
+    if (NULL != picture) {
+        SkAutoMutexAcquire am(gMutex);
+        get_cache()->add(doc, len, picture);
+    }
+    return picture;
+}
+
+int SkSVGPicture::GetCacheCountLimit() {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->countLimit();
+}
+
+int SkSVGPicture::SetCacheCountLimit(int newLimit) {
+    SkAutoMutexAcquire am(gMutex);
+    return get_cache()->setCountLimit(newLimit);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSVGPicture_DEFINED
+#define SkSVGPicture_DEFINED
+
+#include "SkTypes.h"
+
+class SkPicture;
+class SkStream;
+
+/**
+ *  Compiles SVG documents straight to SkPictures, without going through
+ *  SkSVGParser's translation to the animator's XML and SkAnimateMaker, so a
+ *  document is parsed once and then plays back at picture speed.
+ *
+ *  Only the static subset is compiled: svg, g, path, rect, circle, ellipse,
+ *  line, polyline, polygon, use, symbol and defs, painted with colors or
+ *  linear and radial gradients, with transforms, opacity and the usual fill
+ *  and stroke properties as attributes or in style. Text, images, clipPath,
+ *  mask, filters and animation are left out, as is anything in them.
+ */
+class SkSVGPicture {
+public:
+    /**
+     *  Returns a new picture of the document, sized to its width and height
+     *  (or its viewBox if those are missing), or NULL if the document can't
+     *  be parsed or has no size. The caller owns the returned ref.
+     */
+    static SkPicture* Compile(const char doc[], size_t len);
+
+    /**
+     *  As Compile(), but reads the document incrementally through an
+     *  SkXMLPullParser, drawing each element as it is read instead of building
+     *  a DOM of the whole document first. Only defs, symbols and gradients are
+     *  kept for later references, so a use can't refer to anything else.
+     *  Memory stays proportional to those and to the depth of the document,
+     *  which suits very large documents.
+     */
+    static SkPicture* Compile(SkStream*);
+
+    /**
+     *  As Compile(), but first looks for the document in a global,
+     *  thread-safe cache keyed by its bytes, and adds the picture it compiles
+     *  to the cache. The caller owns the returned ref; the picture must not
+     *  be modified since other callers share it.
+     */
+    static SkPicture* FindOrCompile(const char doc[], size_t len);
+
+    /** The cache keeps at most this many pictures, least recently used first out. */
+    static int GetCacheCountLimit();
+    static int SetCacheCountLimit(int newLimit);
+};
+
+#endif
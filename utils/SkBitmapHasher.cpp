@@ -7,6 +7,7 @@
 
 #include "SkBitmap.h"
 #include "SkBitmapHasher.h"
+#include "SkColorTable.h"
 #include "SkEndian.h"
 #include "SkImageEncoder.h"
 
@@ -62,3 +63,145 @@ static inline uint64_t first_8_bytes_as_uint64(const uint8_t *bytearray) {
     }
     return ComputeDigestInternal(copyBitmap, result);
 }
+
+/**
+ * Streaming 64-bit hash of a run of bytes, after xxHash64. The four lanes are
+ * independent, so the loop over each 32-byte stripe keeps several multiplies
+ * in flight, and the whole bitmap goes through at close to memory speed.
+ */
+class SkHash64Stream {
+public:
+    SkHash64Stream() : fTotalLength(0), fBufferLength(0) {
+        fLanes[0] = kPrime1 + kPrime2;
+        fLanes[1] = kPrime2;
+        fLanes[2] = 0;
+        fLanes[3] = 0 - kPrime1;
+    }
+
+    void write(const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        fTotalLength += length;
+        if (fBufferLength > 0) {
+            size_t fill = SkTMin(length, kStripeSize - fBufferLength);
+            memcpy(fBuffer + fBufferLength, bytes, fill);
+            fBufferLength += fill;
+            bytes += fill;
+            length -= fill;
+            if (fBufferLength < kStripeSize) {
+                return;
+            }
+            this->consumeStripe(fBuffer);
+            fBufferLength = 0;
+        }
+        for (; length >= kStripeSize; length -= kStripeSize, bytes += kStripeSize) {
+            this->consumeStripe(bytes);
+        }
+        memcpy(fBuffer, bytes, length);
+        fBufferLength = length;
+    }
+
+    void write32(uint32_t value) {
+        value = SkEndian_SwapLE32(value);
+        this->write(&value, sizeof(value));
+    }
+
+    uint64_t finish() const {
+        uint64_t hash;
+        if (fTotalLength >= kStripeSize) {
+            hash = Rotate(fLanes[0], 1) + Rotate(fLanes[1], 7) +
+                   Rotate(fLanes[2], 12) + Rotate(fLanes[3], 18);
+            for (int i = 0; i < 4; ++i) {
+                hash = (hash ^ Round(0, fLanes[i])) * kPrime1 + kPrime4;
+            }
+        } else {
+            hash = kPrime5;
+        }
+        hash += fTotalLength;
+
+        const uint8_t* bytes = fBuffer;
+        size_t length = fBufferLength;
+        for (; length >= 8; length -= 8, bytes += 8) {
+            hash = Rotate(hash ^ Round(0, Read64(bytes)), 27) * kPrime1 + kPrime4;
+        }
+        if (length >= 4) {
+            uint32_t value;
+            memcpy(&value, bytes, sizeof(value));
+            hash = Rotate(hash ^ (SkEndian_SwapLE32(value) * kPrime1), 23) * kPrime2 + kPrime3;
+            length -= 4;
+            bytes += 4;
+        }
+        for (; length > 0; --length, ++bytes) {
+            hash = Rotate(hash ^ (*bytes * kPrime5), 11) * kPrime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= kPrime2;
+        hash ^= hash >> 29;
+        hash *= kPrime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+    static const uint64_t kPrime1 = 11400714785074694791ULL;
+    static const uint64_t kPrime2 = 14029467366897019727ULL;
+    static const uint64_t kPrime3 = 1609587929392839161ULL;
+    static const uint64_t kPrime4 = 9650029242287828579ULL;
+    static const uint64_t kPrime5 = 2870177450012600261ULL;
+    static const size_t kStripeSize = 32;
+
+    static uint64_t Rotate(uint64_t x, int bits) {
+        return (x << bits) | (x >> (64 - bits));
+    }
+
+    static uint64_t Round(uint64_t lane, uint64_t input) {
+        return Rotate(lane + input * kPrime2, 31) * kPrime1;
+    }
+
+    static uint64_t Read64(const uint8_t* bytes) {
+        uint64_t value;
+        memcpy(&value, bytes, sizeof(value));
+        return SkEndian_SwapLE64(value);
+    }
+
+    void consumeStripe(const uint8_t* bytes) {
+        for (int i = 0; i < 4; ++i) {
+            fLanes[i] = Round(fLanes[i], Read64(bytes + 8 * i));
+        }
+    }
+
+    uint64_t fLanes[4];
+    uint64_t fTotalLength;
+    uint8_t fBuffer[kStripeSize];
+    size_t fBufferLength;
+};
+
+/*static*/ bool SkBitmapHasher::ComputeFastDigest(const SkBitmap& bitmap, uint64_t *result) {
+    SkAutoLockPixels alp(bitmap);
+    const uint8_t* row = static_cast<const uint8_t*>(bitmap.getPixels());
+    const size_t rowLength = bitmap.width() * bitmap.bytesPerPixel();
+    if (NULL == row || 0 == rowLength) {
+        return false;
+    }
+
+    SkHash64Stream hash;
+    hash.write32(SkToU32(bitmap.width()));
+    hash.write32(SkToU32(bitmap.height()));
+    hash.write32(SkToU32(bitmap.colorType()));
+    hash.write32(SkToU32(bitmap.alphaType()));
+
+    SkColorTable* ctable = bitmap.getColorTable();
+    if (NULL != ctable) {
+        hash.write32(SkToU32(ctable->count()));
+        hash.write(ctable->lockColors(), ctable->count() * sizeof(SkPMColor));
+        ctable->unlockColors();
+    }
+
+    // Only the bytes of each row that hold pixels count; the padding after them doesn't.
+    for (int y = 0; y < bitmap.height(); ++y) {
+        hash.write(row, rowLength);
+        row += bitmap.rowBytes();
+    }
+    *result = hash.finish();
+    return true;
+}
@@ -11,6 +11,7 @@
 #include "SkCanvas.h"
 #include "SkCanvasStack.h"
 #include "SkErrorInternals.h"
+#include "SkThread.h"
 #include "SkWriter32.h"
 
 #define CANVAS_STATE_VERSION 1
@@ -255,6 +256,26 @@ SkCanvasState* SkCanvasStateUtils::CaptureCanvasState(SkCanvas* canvas) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/*
+ * Unions the rects in halves rather than one at a time, so that the complex clips of, say, a
+ * page with many overlapping plugins take O(n log n) rather than O(n^2) to rebuild.
+ */
+static void union_clip_rects(const ClipRect* rects, int count, SkRegion* region) {
+    if (count <= 0) {
+        region->setEmpty();
+        return;
+    }
+    if (1 == count) {
+        region->setRect(rects->left, rects->top, rects->right, rects->bottom);
+        return;
+    }
+    const int half = count >> 1;
+    SkRegion second;
+    union_clip_rects(rects, half, region);
+    union_clip_rects(rects + half, count - half, &second);
+    region->op(second, SkRegion::kUnion_Op);
+}
+
 static void setup_canvas_from_MC_state(const SkMCState& state, SkCanvas* canvas) {
     // reconstruct the matrix
     SkMatrix matrix;
@@ -264,13 +285,7 @@ static void setup_canvas_from_MC_state(const SkMCState& state, SkCanvas* canvas)
 
     // reconstruct the clip
     SkRegion clip;
-    for (int i = 0; i < state.clipRectCount; ++i) {
-        clip.op(SkIRect::MakeLTRB(state.clipRects[i].left,
-                                  state.clipRects[i].top,
-                                  state.clipRects[i].right,
-                                  state.clipRects[i].bottom),
-                SkRegion::kUnion_Op);
-    }
+    union_clip_rects(state.clipRects, state.clipRectCount, &clip);
 
     canvas->setMatrix(matrix);
     canvas->setClipRegion(clip);
@@ -297,12 +312,111 @@ static SkCanvas* create_canvas_from_canvas_layer(const SkCanvasLayerState& layer
     SkASSERT(!bitmap.empty());
     SkASSERT(!bitmap.isNull());
 
-    SkAutoTUnref<SkCanvas> canvas(SkNEW_ARGS(SkCanvas, (bitmap)));
+    return SkNEW_ARGS(SkCanvas, (bitmap));
+}
+
+static bool same_layer_pixels(const SkCanvasLayerState& a, const SkCanvasLayerState& b) {
+    return a.type == b.type &&
+           a.width == b.width &&
+           a.height == b.height &&
+           a.raster.config == b.raster.config &&
+           a.raster.rowBytes == b.raster.rowBytes &&
+           a.raster.pixels == b.raster.pixels;
+}
+
+/*
+ * Callers such as plugins recreate a canvas from the state of the same layers on every call, so
+ * the canvases made for them are kept and reused as long as the layers keep their pixels. An
+ * entry is only reused once its caller has unreffed the canvas it was given.
+ */
+namespace {
+
+struct CachedCanvasStack {
+    CachedCanvasStack() : fStack(NULL), fLastUse(0) {}
+
+    bool inUse() const { return NULL != fStack && !fStack->unique(); }
+
+    bool matches(const SkCanvasState& state) const {
+        if (NULL == fStack || fWidth != state.width || fHeight != state.height ||
+            fLayers.count() != state.layerCount) {
+            return false;
+        }
+        for (int i = 0; i < state.layerCount; ++i) {
+            if (!same_layer_pixels(fLayers[i], state.layers[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void reset() {
+        SkSafeSetNull(fStack);
+        fLayerCanvases.unrefAll();
+        fLayerCanvases.rewind();
+        fLayers.rewind();
+    }
+
+    SkCanvasStack*              fStack;
+    SkTDArray<SkCanvas*>        fLayerCanvases;  // refs, as fStack drops them between uses
+    SkTDArray<SkCanvasLayerState> fLayers;       // only their pixels are compared
+    int32_t                     fWidth;
+    int32_t                     fHeight;
+    uint32_t                    fLastUse;
+};
+
+const int kCanvasStackCacheCount = 4;
 
-    // setup the matrix and clip
-    setup_canvas_from_MC_state(layerState.mcState, canvas.get());
+SK_DECLARE_STATIC_MUTEX(gCanvasStackCacheMutex);
+CachedCanvasStack* gCanvasStackCache;  // made on first use, to need no static constructor
+uint32_t gCanvasStackCacheUse;
 
-    return canvas.detach();
+}  // namespace
+
+/*
+ * Fills the entry with a new stack and the canvases of the state's layers. Returns false,
+ * leaving the entry empty, if a layer can't be drawn to.
+ */
+static bool create_canvas_stack(const SkCanvasState& state, CachedCanvasStack* entry) {
+    entry->reset();
+    for (int i = 0; i < state.layerCount; ++i) {
+        SkCanvas* canvasLayer = create_canvas_from_canvas_layer(state.layers[i]);
+        if (NULL == canvasLayer) {
+            entry->reset();
+            return false;
+        }
+        *entry->fLayerCanvases.append() = canvasLayer;
+        SkCanvasLayerState* layer = entry->fLayers.append();
+        *layer = state.layers[i];
+        layer->mcState.clipRectCount = 0;
+        layer->mcState.clipRects = NULL;
+    }
+    entry->fStack = SkNEW_ARGS(SkCanvasStack, (state.width, state.height));
+    entry->fWidth = state.width;
+    entry->fHeight = state.height;
+    return true;
+}
+
+/*
+ * Puts the stack and its layers in the state's matrices and clips, whether they are new or were
+ * left in any state by an earlier caller.
+ */
+static void setup_canvas_stack(const SkCanvasState& state, const CachedCanvasStack& entry) {
+    SkCanvasStack* canvas = entry.fStack;
+    canvas->restoreToCount(1);
+    canvas->removeAll();
+    canvas->setDrawFilter(NULL);
+
+    // setup the matrix and clip on the n-way canvas
+    setup_canvas_from_MC_state(state.mcState, canvas);
+
+    // Iterate over the layers and add them to the n-way canvas
+    for (int i = state.layerCount - 1; i >= 0; --i) {
+        SkCanvas* canvasLayer = entry.fLayerCanvases[i];
+        canvasLayer->restoreToCount(1);
+        canvasLayer->setDrawFilter(NULL);
+        setup_canvas_from_MC_state(state.layers[i].mcState, canvasLayer);
+        canvas->pushCanvas(canvasLayer, SkIPoint::Make(state.layers[i].x, state.layers[i].y));
+    }
 }
 
 SkCanvas* SkCanvasStateUtils::CreateFromCanvasState(const SkCanvasState* state) {
@@ -318,22 +432,49 @@ SkCanvas* SkCanvasStateUtils::CreateFromCanvasState(const SkCanvasState* state)
         return NULL;
     }
 
-    SkAutoTUnref<SkCanvasStack> canvas(SkNEW_ARGS(SkCanvasStack, (state->width, state->height)));
+    SkAutoMutexAcquire lock(gCanvasStackCacheMutex);
+    if (NULL == gCanvasStackCache) {
+        gCanvasStackCache = SkNEW_ARRAY(CachedCanvasStack, kCanvasStackCacheCount);
+    }
 
-    // setup the matrix and clip on the n-way canvas
-    setup_canvas_from_MC_state(state->mcState, canvas);
+    CachedCanvasStack* entry = NULL;
+    CachedCanvasStack* oldest = NULL;
+    for (int i = 0; i < kCanvasStackCacheCount; ++i) {
+        CachedCanvasStack* candidate = &gCanvasStackCache[i];
+        if (candidate->inUse()) {
+            continue;
+        }
+        if (candidate->matches(*state)) {
+            entry = candidate;
+            break;
+        }
+        if (NULL == oldest || candidate->fLastUse < oldest->fLastUse) {
+            oldest = candidate;
+        }
+    }
 
-    // Iterate over the layers and add them to the n-way canvas
-    for (int i = state->layerCount - 1; i >= 0; --i) {
-        SkAutoTUnref<SkCanvas> canvasLayer(create_canvas_from_canvas_layer(state->layers[i]));
-        if (!canvasLayer.get()) {
-            return NULL;
+    if (NULL == entry) {
+        if (NULL != oldest) {
+            if (!create_canvas_stack(*state, oldest)) {
+                return NULL;
+            }
+            entry = oldest;
+        } else {
+            // Every entry is still held by a caller, so this canvas is not kept.
+            CachedCanvasStack uncached;
+            if (!create_canvas_stack(*state, &uncached)) {
+                return NULL;
+            }
+            setup_canvas_stack(*state, uncached);
+            SkCanvas* canvas = SkRef(uncached.fStack);
+            uncached.reset();
+            return canvas;
         }
-        canvas->pushCanvas(canvasLayer.get(), SkIPoint::Make(state->layers[i].x,
-                                                             state->layers[i].y));
     }
 
-    return canvas.detach();
+    entry->fLastUse = ++gCanvasStackCacheUse;
+    setup_canvas_stack(*state, *entry);
+    return SkRef(entry->fStack);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -11,18 +11,30 @@
 #include "SkBitmapDevice.h"
 #include "SkChunkAlloc.h"
 #include "SkColorFilter.h"
+#include "SkCondVar.h"
 #include "SkDrawFilter.h"
 #include "SkGPipe.h"
 #include "SkPaint.h"
 #include "SkPaintPriv.h"
+#include "SkRegion.h"
 #include "SkRRect.h"
 #include "SkShader.h"
 #include "SkSurface.h"
+#include "SkThreadUtils.h"
+
+// If set, recorded commands are played back on a dedicated thread as soon as
+// each pipe block fills up, rather than on the recording thread at flush.
+#ifndef SK_DEFERRED_CANVAS_USE_PLAYBACK_THREAD
+    #define SK_DEFERRED_CANVAS_USE_PLAYBACK_THREAD 0
+#endif
 
 enum {
     // Deferred canvas will auto-flush when recording reaches this limit
     kDefaultMaxRecordingStorageBytes = 64*1024*1024,
     kDeferredCanvasBitmapSizeThreshold = ~0U, // Disables this feature
+    // Opaque draws covering at least 1/kMinOccluderFraction of the canvas are tracked for
+    // skipping the commands they hide; smaller ones would only make the coverage complex.
+    kMinOccluderFraction = 16,
 };
 
 enum PlaybackMode {
@@ -58,16 +70,33 @@ static bool shouldDrawImmediately(const SkBitmap* bitmap, const SkPaint* paint,
 // DeferredPipeController
 //-----------------------------------------------------------------------------
 
+class SkDeferredDevice;
+
+/**
+ *  Collects the pipe's blocks until they are played back into the immediate
+ *  canvas. Normally that happens all at once in playback().
+ *
+ *  With a playback thread, each block is handed to the thread as soon as the
+ *  writer moves on to the next one, and playback() only hands over the last
+ *  block and waits for the thread to catch up. The thread owns the reader
+ *  and the immediate canvas whenever it has blocks to play, so the device
+ *  must call playback() before touching the immediate canvas itself.
+ */
 class DeferredPipeController : public SkGPipeController {
 public:
-    DeferredPipeController();
+    DeferredPipeController(SkDeferredDevice* device, bool usePlaybackThread);
     void setPlaybackCanvas(SkCanvas*);
     virtual ~DeferredPipeController();
     virtual void* requestBlock(size_t minRequest, size_t* actual) SK_OVERRIDE;
     virtual void notifyWritten(size_t bytes) SK_OVERRIDE;
     void playback(bool silent);
-    bool hasPendingCommands() const { return fAllocator.blockCount() != 0; }
-    size_t storageAllocatedForRecording() const { return fAllocator.totalCapacity(); }
+    // Without a playback thread, returns the number of blocks written so far, to be passed
+    // to skipTo(); with one, returns -1 as the blocks are already on their way.
+    int checkpoint() const;
+    // Plays the blocks before the checkpoint silently, keeping the rest pending.
+    void skipTo(int checkpoint);
+    bool hasPendingCommands() const;
+    size_t storageAllocatedForRecording() const;
 private:
     enum {
         kMinBlockSize = 4096
@@ -77,35 +106,118 @@ private:
         void* fBlock;
         size_t fSize;
     };
+
+    // Only used with a playback thread.
+    void queueBlock(const PipeBlock&, bool silent);
+    void waitForPlayback(bool silent);
+    static void PlaybackMain(void* controller);
+    void playbackLoop();
+
+    SkDeferredDevice* fDevice;
     void* fBlock;
     size_t fBytesWritten;
     SkChunkAlloc fAllocator;
     SkTDArray<PipeBlock> fBlockList;
     SkGPipeReader fReader;
+
+    // With a playback thread, blocks are malloced rather than taken from
+    // fAllocator, queued in fBlockList and freed once they are played.
+    // fCondVar guards fBlockList, fQueuedBytes, fSilent, fPlaying and fDone,
+    // and is broadcast whenever any of them changes.
+    const bool fUsePlaybackThread;
+    SkThread* fThread;
+    mutable SkCondVar fCondVar;
+    size_t fQueuedBytes;    // written to queued blocks, and not yet played
+    bool fSilent;
+    bool fPlaying;
+    bool fDone;
 };
 
-DeferredPipeController::DeferredPipeController() :
-    fAllocator(kMinBlockSize) {
+DeferredPipeController::DeferredPipeController(SkDeferredDevice* device,
+                                               bool usePlaybackThread) :
+    fAllocator(kMinBlockSize),
+    fUsePlaybackThread(usePlaybackThread) {
+    fDevice = device;
     fBlock = NULL;
     fBytesWritten = 0;
+    fThread = NULL;
+    fQueuedBytes = 0;
+    fSilent = false;
+    fPlaying = false;
+    fDone = false;
 }
 
 DeferredPipeController::~DeferredPipeController() {
+    if (fUsePlaybackThread) {
+        if (NULL != fThread) {
+            fCondVar.lock();
+            fDone = true;
+            fCondVar.broadcast();
+            fCondVar.unlock();
+            fThread->join();
+            SkDELETE(fThread);
+        }
+        // Whatever the thread didn't get to is dropped, as it would be
+        // without the thread.
+        for (int i = 0; i < fBlockList.count(); i++) {
+            sk_free(fBlockList[i].fBlock);
+        }
+        sk_free(fBlock);
+    }
     fAllocator.reset();
 }
 
 void DeferredPipeController::setPlaybackCanvas(SkCanvas* canvas) {
+    if (!fUsePlaybackThread) {
+        fReader.setCanvas(canvas);
+        return;
+    }
+    // Queued blocks play into the new canvas, as they would without the
+    // thread. Only the one being played has to finish first.
+    fCondVar.lock();
+    while (fPlaying) {
+        fCondVar.wait();
+    }
     fReader.setCanvas(canvas);
+    fCondVar.unlock();
+}
+
+bool DeferredPipeController::hasPendingCommands() const {
+    if (!fUsePlaybackThread) {
+        return fAllocator.blockCount() != 0;
+    }
+    fCondVar.lock();
+    bool pending = NULL != fBlock || fBlockList.count() != 0 || fPlaying;
+    fCondVar.unlock();
+    return pending;
+}
+
+size_t DeferredPipeController::storageAllocatedForRecording() const {
+    if (!fUsePlaybackThread) {
+        return fAllocator.totalCapacity();
+    }
+    fCondVar.lock();
+    size_t bytes = fQueuedBytes;
+    fCondVar.unlock();
+    return bytes + (NULL != fBlock ? fBytesWritten : 0);
 }
 
 void* DeferredPipeController::requestBlock(size_t minRequest, size_t *actual) {
     if (fBlock) {
         // Save the previous block for later
         PipeBlock previousBloc(fBlock, fBytesWritten);
-        fBlockList.push(previousBloc);
+        if (fUsePlaybackThread) {
+            this->queueBlock(previousBloc, false);
+        } else {
+            fBlockList.push(previousBloc);
+        }
     }
     size_t blockSize = SkTMax<size_t>(minRequest, kMinBlockSize);
-    fBlock = fAllocator.allocThrow(blockSize);
+    if (fUsePlaybackThread) {
+        fBlock = sk_malloc_throw(blockSize);
+    } else {
+        fBlock = fAllocator.allocThrow(blockSize);
+    }
     fBytesWritten = 0;
     *actual = blockSize;
     return fBlock;
@@ -116,6 +228,15 @@ void DeferredPipeController::notifyWritten(size_t bytes) {
 }
 
 void DeferredPipeController::playback(bool silent) {
+    if (fUsePlaybackThread) {
+        if (fBlock) {
+            this->queueBlock(PipeBlock(fBlock, fBytesWritten), silent);
+            fBlock = NULL;
+        }
+        this->waitForPlayback(silent);
+        return;
+    }
+
     uint32_t flags = silent ? SkGPipeReader::kSilent_PlaybackFlag : 0;
     for (int currentBlock = 0; currentBlock < fBlockList.count(); currentBlock++ ) {
         fReader.playback(fBlockList[currentBlock].fBlock, fBlockList[currentBlock].fSize,
@@ -132,6 +253,76 @@ void DeferredPipeController::playback(bool silent) {
     fAllocator.reset();
 }
 
+int DeferredPipeController::checkpoint() const {
+    if (fUsePlaybackThread) {
+        return -1;
+    }
+    return fBlockList.count() + (NULL != fBlock ? 1 : 0);
+}
+
+void DeferredPipeController::skipTo(int checkpoint) {
+    SkASSERT(!fUsePlaybackThread);
+    // The blocks stay allocated in fAllocator until the next full playback.
+    const int count = SkTMin(checkpoint, fBlockList.count());
+    for (int i = 0; i < count; i++) {
+        fReader.playback(fBlockList[i].fBlock, fBlockList[i].fSize,
+                         SkGPipeReader::kSilent_PlaybackFlag);
+    }
+    fBlockList.remove(0, count);
+}
+
+void DeferredPipeController::waitForPlayback(bool silent) {
+    const uint32_t silentFlags = silent ? SkGPipeReader::kSilent_PlaybackFlag : 0;
+    fCondVar.lock();
+    if (NULL == fThread) {
+        for (int i = 0; i < fBlockList.count(); i++) {
+            fReader.playback(fBlockList[i].fBlock, fBlockList[i].fSize, silentFlags);
+            sk_free(fBlockList[i].fBlock);
+        }
+        fBlockList.reset();
+        fQueuedBytes = 0;
+    } else {
+        // Blocks that haven't started yet are played silently too, but the
+        // one being played is finished normally.
+        fSilent = silent;
+        while (fPlaying || !fBlockList.isEmpty()) {
+            fCondVar.wait();
+        }
+        fSilent = false;
+    }
+    fCondVar.unlock();
+}
+
+void DeferredPipeController::PlaybackMain(void* controller) {
+    static_cast<DeferredPipeController*>(controller)->playbackLoop();
+}
+
+void DeferredPipeController::playbackLoop() {
+    fCondVar.lock();
+    for (;;) {
+        while (!fDone && fBlockList.isEmpty()) {
+            fCondVar.wait();
+        }
+        if (fDone) {
+            break;
+        }
+        PipeBlock block = fBlockList[0];
+        fBlockList.remove(0);
+        const uint32_t flags = fSilent ? SkGPipeReader::kSilent_PlaybackFlag : 0;
+        fPlaying = true;
+        fCondVar.unlock();
+
+        fReader.playback(block.fBlock, block.fSize, flags);
+        sk_free(block.fBlock);
+
+        fCondVar.lock();
+        fPlaying = false;
+        fQueuedBytes -= block.fSize;
+        fCondVar.broadcast();
+    }
+    fCondVar.unlock();
+}
+
 //-----------------------------------------------------------------------------
 // SkDeferredDevice
 //-----------------------------------------------------------------------------
@@ -157,6 +348,13 @@ public:
     void setMaxRecordingStorage(size_t);
     void recordedDrawCommand();
 
+    // Occlusion tracking: the opaque draws recorded since a checkpoint are unioned into
+    // fCoverage, and once that covers the whole device the commands recorded before the
+    // checkpoint can't show, so they are skipped. willDrawOpaque() goes before an opaque
+    // draw is recorded, and didDrawOpaque() after, with the device pixels it covered.
+    void willDrawOpaque();
+    void didDrawOpaque(const SkIRect& covered);
+
     virtual int width() const SK_OVERRIDE;
     virtual int height() const SK_OVERRIDE;
     virtual SkBitmap::Config config() const SK_OVERRIDE;
@@ -249,6 +447,8 @@ protected:
     }
 
 private:
+    friend class DeferredPipeController;  // for aboutToDraw()
+
     virtual void flush() SK_OVERRIDE;
     virtual void replaceBitmapBackendForRasterSurface(const SkBitmap&) SK_OVERRIDE {}
 
@@ -256,6 +456,7 @@ private:
     void init();
     void aboutToDraw();
     void prepareForImmediatePixelWrite();
+    void resetCoverage();
 
     DeferredPipeController fPipeController;
     SkGPipeWriter  fPipeWriter;
@@ -268,9 +469,43 @@ private:
     size_t fMaxRecordingStorageBytes;
     size_t fPreviousStorageAllocated;
     size_t fBitmapSizeThreshold;
+    int fCoverageCheckpoint;    // -1 if there isn't one
+    SkRegion fCoverage;
 };
 
-SkDeferredDevice::SkDeferredDevice(SkSurface* surface) {
+// Needs SkDeferredDevice::aboutToDraw(), so it lives down here.
+void DeferredPipeController::queueBlock(const PipeBlock& block, bool silent) {
+    fCondVar.lock();
+    const bool idle = !fPlaying && fBlockList.isEmpty();
+    fCondVar.unlock();
+    if (idle && !silent) {
+        // The thread isn't touching the immediate canvas, so prepare it for
+        // drawing now, as the device would before playing back at flush.
+        fDevice->aboutToDraw();
+    }
+
+    if (NULL == fThread) {
+        fThread = SkNEW_ARGS(SkThread, (DeferredPipeController::PlaybackMain, this));
+        if (!fThread->start()) {
+            SkDELETE(fThread);
+            fThread = NULL;
+        }
+    }
+
+    fCondVar.lock();
+    fBlockList.push(block);
+    fQueuedBytes += block.fSize;
+    fCondVar.broadcast();
+    fCondVar.unlock();
+
+    if (NULL == fThread) {
+        // Without a thread, play on the recording thread after all.
+        this->waitForPlayback(silent);
+    }
+}
+
+SkDeferredDevice::SkDeferredDevice(SkSurface* surface)
+    : fPipeController(this, SkToBool(SK_DEFERRED_CANVAS_USE_PLAYBACK_THREAD)) {
     fMaxRecordingStorageBytes = kDefaultMaxRecordingStorageBytes;
     fNotificationClient = NULL;
     fImmediateCanvas = NULL;
@@ -280,9 +515,11 @@ SkDeferredDevice::SkDeferredDevice(SkSurface* surface) {
 }
 
 void SkDeferredDevice::setSurface(SkSurface* surface) {
+    // Switch the playback over first, so that a playback thread is done
+    // with the old canvas before it is released.
+    fPipeController.setPlaybackCanvas(surface->getCanvas());
     SkRefCnt_SafeAssign(fImmediateCanvas, surface->getCanvas());
     SkRefCnt_SafeAssign(fSurface, surface);
-    fPipeController.setPlaybackCanvas(fImmediateCanvas);
 }
 
 void SkDeferredDevice::init() {
@@ -293,6 +530,7 @@ void SkDeferredDevice::init() {
     fBitmapSizeThreshold = kDeferredCanvasBitmapSizeThreshold;
     fMaxRecordingStorageBytes = kDefaultMaxRecordingStorageBytes;
     fNotificationClient = NULL;
+    fCoverageCheckpoint = -1;
     this->beginRecording();
 }
 
@@ -328,6 +566,37 @@ void SkDeferredDevice::skipPendingCommands() {
     }
 }
 
+void SkDeferredDevice::willDrawOpaque() {
+    if (fCoverageCheckpoint >= 0 || SK_DEFERRED_CANVAS_USE_PLAYBACK_THREAD) {
+        return;
+    }
+    // End the current pipe block, so that the draw starts a new one and everything before
+    // it can be played back on its own.
+    fPipeWriter.flushRecording(true);
+    fCoverageCheckpoint = fPipeController.checkpoint();
+    fCoverage.setEmpty();
+}
+
+void SkDeferredDevice::didDrawOpaque(const SkIRect& covered) {
+    if (fCoverageCheckpoint < 0) {
+        return;
+    }
+    fCoverage.op(covered, SkRegion::kUnion_Op);
+    if (fCoverage.contains(SkIRect::MakeWH(this->width(), this->height()))) {
+        // Every pixel is overwritten by an opaque draw after the checkpoint, so neither the
+        // commands before it nor the current contents can affect the result.
+        fPipeController.skipTo(fCoverageCheckpoint);
+        fCanDiscardCanvasContents = true;
+        fFreshFrame = true;
+        this->resetCoverage();
+    }
+}
+
+void SkDeferredDevice::resetCoverage() {
+    fCoverageCheckpoint = -1;
+    fCoverage.setEmpty();
+}
+
 bool SkDeferredDevice::isFreshFrame() {
     bool ret = fFreshFrame;
     fFreshFrame = false;
@@ -355,11 +624,14 @@ void SkDeferredDevice::flushPendingCommands(PlaybackMode playbackMode) {
     if (!fPipeController.hasPendingCommands()) {
         return;
     }
-    if (playbackMode == kNormal_PlaybackMode) {
+    // A playback thread may be drawing already, so the controller prepares
+    // the canvas itself whenever it hands a block to an idle thread.
+    if (playbackMode == kNormal_PlaybackMode && !SK_DEFERRED_CANVAS_USE_PLAYBACK_THREAD) {
         aboutToDraw();
     }
     fPipeWriter.flushRecording(true);
     fPipeController.playback(kSilent_PlaybackMode == playbackMode);
+    this->resetCoverage();
     if (fNotificationClient) {
         if (playbackMode == kSilent_PlaybackMode) {
             fNotificationClient->skippedPendingDrawCommands();
@@ -544,6 +816,71 @@ private:
     SkDeferredCanvas* fCanvas;
 };
 
+/*
+ *  Returns in covered the device pixels an opaque draw of rect with paint (and bitmap, if it
+ *  replaces the shader) is certain to overwrite, if it's large enough to be worth tracking.
+ */
+static bool get_opaque_coverage(const SkCanvas& canvas, const SkRect& rect,
+                                const SkPaint* paint, const SkBitmap* bitmap,
+                                SkIRect* covered) {
+    if (canvas.isDrawingToLayer() || !isPaintOpaque(paint, bitmap) ||
+        !canvas.getTotalMatrix().rectStaysRect()) {
+        return false;
+    }
+    if (paint) {
+        SkPaint::Style paintStyle = paint->getStyle();
+        if (!(paintStyle == SkPaint::kFill_Style ||
+              paintStyle == SkPaint::kStrokeAndFill_Style)) {
+            return false;
+        }
+        if (paint->getMaskFilter() || paint->getLooper()
+            || paint->getPathEffect() || paint->getImageFilter()) {
+            return false; // conservative
+        }
+    }
+
+    SkRect transformedRect;
+    canvas.getTotalMatrix().mapRect(&transformedRect, rect);
+    // Only count draws the clip leaves alone.
+    if (!canvas.getClipStack()->quickContains(transformedRect)) {
+        return false;
+    }
+    const SkISize size = canvas.getDeviceSize();
+    // Rounding in stays conservative with AA disabled too.
+    transformedRect.roundIn(covered);
+    if (!covered->intersect(SkIRect::MakeWH(size.width(), size.height()))) {
+        return false;
+    }
+    return (int64_t)covered->width() * covered->height() * kMinOccluderFraction >=
+           (int64_t)size.width() * size.height();
+}
+
+/*
+ *  Tells the device about an opaque draw that doesn't cover the whole frame, which can still
+ *  hide earlier commands together with other such draws.
+ */
+class AutoOpaqueCoverage {
+public:
+    AutoOpaqueCoverage(SkDeferredCanvas& canvas, const SkRect& rect, const SkPaint* paint,
+                       const SkBitmap* bitmap = NULL) : fDevice(NULL) {
+        if (canvas.isDeferredDrawing() &&
+            get_opaque_coverage(canvas, rect, paint, bitmap, &fCovered)) {
+            fDevice = static_cast<SkDeferredDevice*>(canvas.getDevice());
+            fDevice->willDrawOpaque();
+        }
+    }
+
+    ~AutoOpaqueCoverage() {
+        if (fDevice) {
+            fDevice->didDrawOpaque(fCovered);
+        }
+    }
+
+private:
+    SkDeferredDevice* fDevice;
+    SkIRect fCovered;
+};
+
 SkDeferredCanvas* SkDeferredCanvas::Create(SkSurface* surface) {
     SkAutoTUnref<SkDeferredDevice> deferredDevice(SkNEW_ARGS(SkDeferredDevice, (surface)));
     return SkNEW_ARGS(SkDeferredCanvas, (deferredDevice));
@@ -805,6 +1142,7 @@ void SkDeferredCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
     }
 
     AutoImmediateDrawIfNeeded autoDraw(*this, &paint);
+    AutoOpaqueCoverage coverage(*this, rect, &paint);
     this->drawingCanvas()->drawRect(rect, paint);
     this->recordedDrawCommand();
 }
@@ -845,6 +1183,7 @@ void SkDeferredCanvas::drawBitmap(const SkBitmap& bitmap, SkScalar left,
     }
 
     AutoImmediateDrawIfNeeded autoDraw(*this, &bitmap, paint);
+    AutoOpaqueCoverage coverage(*this, bitmapRect, paint, &bitmap);
     this->drawingCanvas()->drawBitmap(bitmap, left, top, paint);
     this->recordedDrawCommand();
 }
@@ -861,6 +1200,7 @@ void SkDeferredCanvas::drawBitmapRectToRect(const SkBitmap& bitmap,
     }
 
     AutoImmediateDrawIfNeeded autoDraw(*this, &bitmap, paint);
+    AutoOpaqueCoverage coverage(*this, dst, paint, &bitmap);
     this->drawingCanvas()->drawBitmapRectToRect(bitmap, src, dst, paint, flags);
     this->recordedDrawCommand();
 }
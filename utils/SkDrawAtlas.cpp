@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDrawAtlas.h"
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkMatrix.h"
+#include "SkPaint.h"
+#include "SkShader.h"
+#include "SkTemplates.h"
+
+// A small batch lives on the stack; the scratch arrays are sized for this many sprites.
+static const int kStackSprites = 64;
+
+// Writes the two triangles of each sprite: 0-1-2 and 0-2-3, going around its corners.
+static void fill_indices(uint16_t indices[], int spriteCount) {
+    for (int i = 0; i < spriteCount; ++i) {
+        const uint16_t v = SkToU16(4 * i);
+        *indices++ = v;
+        *indices++ = v + 1;
+        *indices++ = v + 2;
+        *indices++ = v;
+        *indices++ = v + 2;
+        *indices++ = v + 3;
+    }
+}
+
+void SkDrawAtlas::Draw(SkCanvas* canvas, const SkBitmap& atlas, const SkMatrix xform[],
+                       const SkRect tex[], const SkColor colors[], int count,
+                       SkXfermode::Mode mode, const SkPaint* paint) {
+    SkASSERT(NULL != canvas && NULL != xform && NULL != tex);
+    if (count <= 0 || atlas.empty()) {
+        return;
+    }
+
+    SkPaint p;
+    if (NULL != paint) {
+        p = *paint;
+    }
+    // The texture coordinates select each sprite, so the shader is the atlas as is.
+    p.setShader(SkShader::CreateBitmapShader(atlas, SkShader::kClamp_TileMode,
+                                             SkShader::kClamp_TileMode))->unref();
+    SkAutoTUnref<SkXfermode> xmode(NULL != colors ? SkXfermode::Create(mode) : NULL);
+
+    const int batchMax = SkMin32(count, kMaxSpritesPerBatch);
+    SkAutoSTMalloc<4 * kStackSprites, SkPoint> verts(4 * batchMax);
+    SkAutoSTMalloc<4 * kStackSprites, SkPoint> texs(4 * batchMax);
+    SkAutoSTMalloc<4 * kStackSprites, SkColor> vertColors(NULL != colors ? 4 * batchMax : 0);
+    SkAutoSTMalloc<6 * kStackSprites, uint16_t> indices(6 * batchMax);
+    fill_indices(indices.get(), batchMax);
+
+    for (int start = 0; start < count; start += batchMax) {
+        const int n = SkMin32(batchMax, count - start);
+        SkPoint* v = verts.get();
+        SkPoint* t = texs.get();
+        for (int i = start; i < start + n; ++i) {
+            const SkRect& r = tex[i];
+            t->set(r.fLeft, r.fTop);
+            t[1].set(r.fRight, r.fTop);
+            t[2].set(r.fRight, r.fBottom);
+            t[3].set(r.fLeft, r.fBottom);
+
+            v->set(0, 0);
+            v[1].set(r.width(), 0);
+            v[2].set(r.width(), r.height());
+            v[3].set(0, r.height());
+            xform[i].mapPoints(v, 4);
+
+            v += 4;
+            t += 4;
+        }
+        if (NULL != colors) {
+            SkColor* c = vertColors.get();
+            for (int i = start; i < start + n; ++i) {
+                c[0] = c[1] = c[2] = c[3] = colors[i];
+                c += 4;
+            }
+        }
+        canvas->drawVertices(SkCanvas::kTriangles_VertexMode, 4 * n,
+                             verts.get(), texs.get(), NULL != colors ? vertColors.get() : NULL,
+                             xmode.get(), indices.get(), 6 * n, p);
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkDrawAtlas_DEFINED
+#define SkDrawAtlas_DEFINED
+
+#include "SkColor.h"
+#include "SkXfermode.h"
+
+class SkBitmap;
+class SkCanvas;
+class SkMatrix;
+class SkPaint;
+struct SkRect;
+
+/**
+ *  Draws many sprites out of one atlas bitmap, as a game or an icon grid
+ *  would with a drawBitmapRect per sprite, but in one drawVertices call per
+ *  batch of sprites. Each sprite is a quad of two triangles textured by a
+ *  single bitmap shader on the atlas, so the raster backend sets up the
+ *  bitmap proc state once per distinct transform rather than once per draw,
+ *  and the GPU backend draws each batch from one vertex buffer with one
+ *  texture lookup.
+ *
+ *  As with drawBitmapRect without kBleed, filtering may sample the atlas
+ *  pixels just outside a sprite's texture rect, so atlases meant to be
+ *  filtered should pad their sprites.
+ */
+class SkDrawAtlas : SkNoncopyable {
+public:
+    /**
+     *  Draws count sprites. Sprite i is the tex[i] rect of the atlas, in
+     *  atlas pixels, with its top left corner at the origin, drawn through
+     *  xform[i] and then the canvas' matrix. If colors is not NULL, sprite i
+     *  is blended with colors[i] using mode (the color is the source); that
+     *  usually means kModulate to tint the sprites. The paint may be NULL,
+     *  otherwise its shader is replaced by the atlas.
+     */
+    static void Draw(SkCanvas*, const SkBitmap& atlas, const SkMatrix xform[],
+                     const SkRect tex[], const SkColor colors[], int count,
+                     SkXfermode::Mode mode, const SkPaint* paint);
+
+    enum {
+        // Each sprite takes four vertices, and the indices are 16 bits.
+        kMaxSpritesPerBatch = 1 << 14
+    };
+};
+
+#endif
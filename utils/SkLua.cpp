@@ -11,17 +11,28 @@
 #include "GrReducedClip.h"
 #endif
 
+#include "SkBBHFactory.h"
 #include "SkCanvas.h"
 #include "SkData.h"
 #include "SkDocument.h"
 #include "SkImage.h"
+#include "SkImageDecoder.h"
 #include "SkMatrix.h"
+#include "SkOSFile.h"
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkPathEffect.h"
+#include "SkPicture.h"
+#include "SkPictureRecorder.h"
 #include "SkPixelRef.h"
+#include "SkRecord.h"
+#include "SkRecordDraw.h"
+#include "SkRecorder.h"
 #include "SkRRect.h"
+#include "SkStream.h"
 #include "SkString.h"
+#include "SkSurface.h"
+#include "SkTimingCanvas.h"
 #include "SkTypeface.h"
 
 extern "C" {
@@ -45,6 +56,7 @@ DEF_MTNAME(SkRRect)
 DEF_MTNAME(SkPath)
 DEF_MTNAME(SkPaint)
 DEF_MTNAME(SkPathEffect)
+DEF_MTNAME(SkPicture)
 DEF_MTNAME(SkShader)
 DEF_MTNAME(SkTypeface)
 
@@ -1327,6 +1339,30 @@ static const struct luaL_Reg gSkTypeface_Methods[] = {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static int lpicture_width(lua_State* L) {
+    lua_pushinteger(L, get_ref<SkPicture>(L, 1)->width());
+    return 1;
+}
+
+static int lpicture_height(lua_State* L) {
+    lua_pushinteger(L, get_ref<SkPicture>(L, 1)->height());
+    return 1;
+}
+
+static int lpicture_gc(lua_State* L) {
+    get_ref<SkPicture>(L, 1)->unref();
+    return 0;
+}
+
+static const struct luaL_Reg gSkPicture_Methods[] = {
+    { "width", lpicture_width },
+    { "height", lpicture_height },
+    { "__gc", lpicture_gc },
+    { NULL, NULL }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class AutoCallLua {
 public:
     AutoCallLua(lua_State* L, const char func[], const char verb[]) : fL(L) {
@@ -1427,6 +1463,188 @@ static int lsk_loadImage(lua_State* L) {
     return 0;
 }
 
+static int lsk_loadPicture(lua_State* L) {
+    if (lua_gettop(L) > 0 && lua_isstring(L, 1)) {
+        const char* name = lua_tolstring(L, 1, NULL);
+        SkAutoTUnref<SkStream> stream(SkStream::NewFromFile(name));
+        if (stream.get()) {
+            SkPicture* pic = SkPicture::CreateFromStream(stream, &SkImageDecoder::DecodeMemory);
+            if (pic) {
+                push_ref(L, pic);
+                pic->unref();
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Returns an array of the paths of the files in a directory, optionally only those with a
+// suffix, e.g. Sk.listFiles("skps", ".skp").
+static int lsk_listFiles(lua_State* L) {
+    const char* dir = luaL_checkstring(L, 1);
+    const char* suffix = lua_isstring(L, 2) ? lua_tolstring(L, 2, NULL) : NULL;
+
+    lua_newtable(L);
+    SkOSFile::Iter iter(dir, suffix);
+    SkString name;
+    int index = 0;
+    while (iter.next(&name)) {
+        SkString path = SkOSPath::SkPathJoin(dir, name.c_str());
+        lua_pushstring(L, path.c_str());
+        lua_rawseti(L, -2, ++index);
+    }
+    return 1;
+}
+
+static void push_timings(lua_State* L, const SkTimingCanvas::Timing timings[],
+                         const SkTimingCanvas::Timing& flush, double total) {
+    lua_newtable(L);
+    setfield_number(L, "total", total);
+    lua_newtable(L);
+    for (int i = 0; i <= LAST_DRAWTYPE_ENUM; ++i) {
+        if (timings[i].fCount > 0) {
+            lua_newtable(L);
+            setfield_number(L, "count", timings[i].fCount);
+            setfield_number(L, "ms", timings[i].fMSecs);
+            lua_setfield(L, -2, SkTimingCanvas::TypeName((DrawType)i));
+        }
+    }
+    if (flush.fCount > 0) {
+        lua_newtable(L);
+        setfield_number(L, "count", flush.fCount);
+        setfield_number(L, "ms", flush.fMSecs);
+        lua_setfield(L, -2, "Flush");
+    }
+    lua_setfield(L, -2, "ops");
+}
+
+/**
+ *  Sk.benchPicture(picture, options, callback) plays the picture back a number of times through
+ *  an SkTimingCanvas and returns the times summed over all the loops, as a table
+ *      { loops = n, total = ms, ops = { ["Draw Rect"] = { count = c, ms = ms }, ... } }
+ *  with the op names SkDebugCanvas uses, and "Flush" for the time the target spent flushing at
+ *  the end of each loop. If a callback is given, it is called after each loop with a table of
+ *  that loop's times in the same form, and the loop's number, from 1, in "loop".
+ *
+ *  The options, all optional, are
+ *      loops       the number of times to play the picture back (1)
+ *      canvas      the canvas to draw to, e.g. one on a GPU surface that the host pushed with
+ *                  SkLua::pushCanvas(), instead of a new 8888 raster surface of the picture's size
+ *      playback    "picture" to play the picture back with SkPicturePlayback, or "record" to
+ *                  convert it to an SkRecord first and play that back with SkRecordDraw
+ *      bbh         true to cull the playback with an R-Tree; the picture is re-recorded with one
+ *                  ("picture"), or the SkRecord's bounds are put in one ("record")
+ *
+ *  Re-recording and converting happen once, before the first loop, and aren't timed.
+ */
+static int lsk_benchPicture(lua_State* L) {
+    SkPicture* pic = get_ref<SkPicture>(L, 1);
+    const bool hasOptions = lua_istable(L, 2);
+    const bool hasCallback = lua_isfunction(L, 3);
+
+    int loops = 1;
+    bool useRecord = false;
+    bool useBBH = false;
+    SkCanvas* canvas = NULL;
+    if (hasOptions) {
+        lua_getfield(L, 2, "loops");
+        if (lua_isnumber(L, -1)) {
+            loops = SkTMax(1, SkToInt(lua_tointeger(L, -1)));
+        }
+        lua_getfield(L, 2, "playback");
+        if (lua_isstring(L, -1)) {
+            const char* playback = lua_tostring(L, -1);
+            if (!strcmp(playback, "record")) {
+                useRecord = true;
+            } else if (strcmp(playback, "picture")) {
+                return luaL_error(L, "unknown playback %s", playback);
+            }
+        }
+        lua_getfield(L, 2, "bbh");
+        useBBH = lua2bool(L, -1);
+        lua_getfield(L, 2, "canvas");
+        if (!lua_isnil(L, -1)) {
+            canvas = get_ref<SkCanvas>(L, -1);
+        }
+        lua_pop(L, 4);
+    }
+
+    const int width = pic->width();
+    const int height = pic->height();
+    SkAutoTUnref<SkSurface> surface;
+    if (NULL == canvas) {
+        surface.reset(SkSurface::NewRaster(SkImageInfo::MakeN32Premul(width, height)));
+        if (NULL == surface.get()) {
+            return luaL_error(L, "can't make a %dx%d raster surface", width, height);
+        }
+        canvas = surface->getCanvas();
+    }
+
+    SkRTreeFactory factory;
+    SkAutoTUnref<SkPicture> played(SkRef(pic));
+    SkRecord record;
+    SkAutoTUnref<SkBBoxHierarchy> bbh;
+    if (useRecord) {
+        SkRecorder recorder(SkRecorder::kWriteOnly_Mode, &record, width, height);
+        pic->draw(&recorder);
+        if (useBBH) {
+            bbh.reset(factory(width, height));
+            SkRecordFillBounds(record, SkRect::MakeWH(SkIntToScalar(width),
+                                                      SkIntToScalar(height)), bbh);
+        }
+    } else if (useBBH) {
+        SkPictureRecorder recorder;
+        pic->draw(recorder.beginRecording(width, height, &factory, 0));
+        played.reset(recorder.endRecording());
+    }
+
+    SkTimingCanvas timer(canvas);
+    SkTimingCanvas::Timing sums[LAST_DRAWTYPE_ENUM + 1];
+    SkTimingCanvas::Timing flushSum;
+    memset(sums, 0, sizeof(sums));
+    memset(&flushSum, 0, sizeof(flushSum));
+    double total = 0;
+
+    for (int loop = 0; loop < loops; ++loop) {
+        timer.resetTimings();
+        int saveCount = timer.save();
+        if (!useRecord) {
+            played->draw(&timer);
+        } else if (NULL != bbh.get()) {
+            SkRecordDraw(record, &timer, bbh);
+        } else {
+            SkRecordDraw(record, &timer);
+        }
+        timer.restoreToCount(saveCount);
+        timer.timeFlush();
+
+        SkTimingCanvas::Timing timings[LAST_DRAWTYPE_ENUM + 1];
+        for (int i = 0; i <= LAST_DRAWTYPE_ENUM; ++i) {
+            timings[i] = timer.timing((DrawType)i);
+            sums[i].fCount += timings[i].fCount;
+            sums[i].fMSecs += timings[i].fMSecs;
+        }
+        flushSum.fCount += timer.flushTiming().fCount;
+        flushSum.fMSecs += timer.flushTiming().fMSecs;
+        total += timer.totalMSecs();
+
+        if (hasCallback) {
+            lua_pushvalue(L, 3);
+            push_timings(L, timings, timer.flushTiming(), timer.totalMSecs());
+            setfield_number(L, "loop", loop + 1);
+            if (lua_pcall(L, 1, 0, 0) != LUA_OK) {
+                SkDebugf("lua err: %s\n", lua_tostring(L, -1));
+                lua_pop(L, 1);
+            }
+        }
+    }
+
+    push_timings(L, sums, flushSum, total);
+    setfield_number(L, "loops", loops);
+    return 1;
+}
+
 static void register_Sk(lua_State* L) {
     lua_newtable(L);
     lua_pushvalue(L, -1);
@@ -1435,6 +1653,9 @@ static void register_Sk(lua_State* L) {
 
     setfield_function(L, "newDocumentPDF", lsk_newDocumentPDF);
     setfield_function(L, "loadImage", lsk_loadImage);
+    setfield_function(L, "loadPicture", lsk_loadPicture);
+    setfield_function(L, "listFiles", lsk_listFiles);
+    setfield_function(L, "benchPicture", lsk_benchPicture);
     setfield_function(L, "newPaint", lsk_newPaint);
     setfield_function(L, "newPath", lsk_newPath);
     setfield_function(L, "newRRect", lsk_newRRect);
@@ -1459,6 +1680,7 @@ void SkLua::Load(lua_State* L) {
     REG_CLASS(L, SkPaint);
     REG_CLASS(L, SkPath);
     REG_CLASS(L, SkPathEffect);
+    REG_CLASS(L, SkPicture);
     REG_CLASS(L, SkRRect);
     REG_CLASS(L, SkShader);
     REG_CLASS(L, SkTypeface);
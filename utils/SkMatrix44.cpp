@@ -6,6 +6,13 @@
  */
 
 #include "SkMatrix44.h"
+#include "SkMatrix44Utils.h"
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    #include <emmintrin.h>
+#elif SK_ARM_NEON_IS_ALWAYS
+    #include <arm_neon.h>
+#endif
 
 static inline bool eq4(const SkMScalar* SK_RESTRICT a,
                       const SkMScalar* SK_RESTRICT b) {
@@ -351,6 +358,47 @@ static bool bits_isonly(int value, int mask) {
     return 0 == (value & ~mask);
 }
 
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+// This keeps the double precision, and the order of operations, of the scalar concat, so it gives
+// the same results to the bit. Two doubles fit in a register, so the lanes hold neighbouring
+// elements of a column.
+
+static inline __m128d load2_pd(const SkMScalar src[2]) {
+#ifdef SK_MSCALAR_IS_DOUBLE
+    return _mm_loadu_pd(src);
+#else
+    return _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(src))));
+#endif
+}
+
+static inline void store4_pd(SkMScalar dst[4], __m128d lo, __m128d hi) {
+#ifdef SK_MSCALAR_IS_DOUBLE
+    _mm_storeu_pd(dst, lo);
+    _mm_storeu_pd(dst + 2, hi);
+#else
+    _mm_storeu_ps(dst, _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+#endif
+}
+
+static void concat_sse2(const SkMScalar a[][4], const SkMScalar b[][4], SkMScalar* result) {
+    __m128d aLo[4], aHi[4];
+    for (int k = 0; k < 4; ++k) {
+        aLo[k] = load2_pd(&a[k][0]);
+        aHi[k] = load2_pd(&a[k][2]);
+    }
+    for (int j = 0; j < 4; ++j) {
+        __m128d lo = _mm_setzero_pd();
+        __m128d hi = _mm_setzero_pd();
+        for (int k = 0; k < 4; ++k) {
+            __m128d bjk = _mm_set1_pd(b[j][k]);
+            lo = _mm_add_pd(lo, _mm_mul_pd(aLo[k], bjk));
+            hi = _mm_add_pd(hi, _mm_mul_pd(aHi[k], bjk));
+        }
+        store4_pd(result + 4 * j, lo, hi);
+    }
+}
+#endif
+
 void SkMatrix44::setConcat(const SkMatrix44& a, const SkMatrix44& b) {
     const SkMatrix44::TypeMask a_mask = a.getType();
     const SkMatrix44::TypeMask b_mask = b.getType();
@@ -381,6 +429,9 @@ void SkMatrix44::setConcat(const SkMatrix44& a, const SkMatrix44& b) {
         result[14] = a.fMat[2][2] * b.fMat[3][2] + a.fMat[3][2];
         result[15] = 1;
     } else {
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+        concat_sse2(a.fMat, b.fMat, result);
+#else
         for (int j = 0; j < 4; j++) {
             for (int i = 0; i < 4; i++) {
                 double value = 0;
@@ -390,6 +441,7 @@ void SkMatrix44::setConcat(const SkMatrix44& a, const SkMatrix44& b) {
                 *result++ = SkDoubleToMScalar(value);
             }
         }
+#endif
     }
 
     if (useStorage) {
@@ -857,6 +909,54 @@ void SkMatrix44::map2(const double src2[], int count, double dst4[]) const {
     proc(fMat, src2, count, dst4);
 }
 
+// Each point is col0 * x + col1 * y + col2 * z + col3, summed in that order by every version.
+void SkMatrix44MapPoints(const SkMatrix44& matrix, const float src3[], int count, SkPoint dst[]) {
+    SkASSERT(count >= 0);
+    float m[16];
+    matrix.asColMajorf(m);
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+    const __m128 col0 = _mm_loadu_ps(&m[0]);
+    const __m128 col1 = _mm_loadu_ps(&m[4]);
+    const __m128 col2 = _mm_loadu_ps(&m[8]);
+    const __m128 col3 = _mm_loadu_ps(&m[12]);
+    for (int i = 0; i < count; ++i) {
+        __m128 r = _mm_mul_ps(col0, _mm_set1_ps(src3[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(col1, _mm_set1_ps(src3[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(col2, _mm_set1_ps(src3[2])));
+        r = _mm_add_ps(r, col3);
+        r = _mm_div_ps(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+        _mm_storel_pi(reinterpret_cast<__m64*>(&dst[i]), r);
+        src3 += 3;
+    }
+#elif SK_ARM_NEON_IS_ALWAYS
+    const float32x4_t col0 = vld1q_f32(&m[0]);
+    const float32x4_t col1 = vld1q_f32(&m[4]);
+    const float32x4_t col2 = vld1q_f32(&m[8]);
+    const float32x4_t col3 = vld1q_f32(&m[12]);
+    for (int i = 0; i < count; ++i) {
+        // vmla rounds the product before adding it, as the scalar code does.
+        float32x4_t r = vmulq_n_f32(col0, src3[0]);
+        r = vmlaq_n_f32(r, col1, src3[1]);
+        r = vmlaq_n_f32(r, col2, src3[2]);
+        r = vaddq_f32(r, col3);
+        // NEON has no divide; its reciprocal estimate would not match the other versions.
+        const float w = vgetq_lane_f32(r, 3);
+        dst[i].set(vgetq_lane_f32(r, 0) / w, vgetq_lane_f32(r, 1) / w);
+        src3 += 3;
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        float r[4];
+        for (int j = 0; j < 4; ++j) {
+            r[j] = m[j] * src3[0] + m[4 + j] * src3[1] + m[8 + j] * src3[2] + m[12 + j];
+        }
+        dst[i].set(r[0] / r[3], r[1] / r[3]);
+        src3 += 3;
+    }
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkMatrix44::dump() const {
@@ -0,0 +1,24 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMatrix44Utils_DEFINED
+#define SkMatrix44Utils_DEFINED
+
+#include "SkMatrix44.h"
+#include "SkPoint.h"
+
+/**
+ *  Maps count points, given as x, y, z triples in src3 and taken to have w = 1, through the
+ *  matrix and writes each result, divided by its w, to dst. A result with w = 0 comes out
+ *  infinite or NaN; callers that can see points behind the eye should clip them first.
+ *
+ *  This is meant for mapping many points at once, e.g. the corners of every layer of a 3D scene,
+ *  so it uses SSE2 or NEON where available.
+ */
+void SkMatrix44MapPoints(const SkMatrix44&, const float src3[], int count, SkPoint dst[]);
+
+#endif
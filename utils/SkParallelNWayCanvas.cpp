@@ -0,0 +1,83 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkParallelNWayCanvas.h"
+
+#include "SkRecordDraw.h"
+#include "SkTaskPool.h"
+
+namespace {
+
+struct DrawTask {
+    const SkRecord* fRecord;
+    SkCanvas*       fCanvas;
+};
+
+}  // namespace
+
+SkParallelNWayCanvas::SkParallelNWayCanvas(int width, int height, SkTaskPool* pool)
+    // The record only exists once our members do.
+    : INHERITED(kReadWrite_Mode, NULL, width, height)
+    , fPool(pool)
+    , fRecord(SkNEW(SkRecord)) {
+    this->setRecord(fRecord.get());
+}
+
+SkParallelNWayCanvas::~SkParallelNWayCanvas() {
+    this->removeAll();
+}
+
+void SkParallelNWayCanvas::addCanvas(SkCanvas* canvas) {
+    if (canvas) {
+        // It shouldn't see what was drawn before it was added.
+        this->flushToCanvases();
+        canvas->ref();
+        *fList.append() = canvas;
+    }
+}
+
+void SkParallelNWayCanvas::removeCanvas(SkCanvas* canvas) {
+    int index = fList.find(canvas);
+    if (index >= 0) {
+        this->flushToCanvases();
+        canvas->unref();
+        fList.removeShuffle(index);
+    }
+}
+
+void SkParallelNWayCanvas::removeAll() {
+    this->flushToCanvases();
+    fList.unrefAll();
+    fList.reset();
+}
+
+void SkParallelNWayCanvas::DrawProc(void* data) {
+    const DrawTask* task = static_cast<const DrawTask*>(data);
+    SkRecordDraw(*task->fRecord, task->fCanvas);
+}
+
+void SkParallelNWayCanvas::flushToCanvases() {
+    if (0 == fRecord->count()) {
+        return;
+    }
+
+    if (1 == fList.count()) {
+        SkRecordDraw(*fRecord, fList[0]);
+    } else if (fList.count() > 1) {
+        SkAutoSTMalloc<4, DrawTask> tasks(fList.count());
+        SkTaskGroup group(fPool);
+        for (int i = 0; i < fList.count(); ++i) {
+            tasks[i].fRecord = fRecord.get();
+            tasks[i].fCanvas = fList[i];
+            group.add(DrawProc, &tasks[i]);
+        }
+        group.wait();
+    }
+
+    fRecord.reset(SkNEW(SkRecord));
+    this->setRecord(fRecord.get());
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkParallelNWayCanvas_DEFINED
+#define SkParallelNWayCanvas_DEFINED
+
+#include "SkRecorder.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+
+class SkTaskPool;
+
+/**
+ *  Like SkNWayCanvas, but the child canvases draw in parallel. Calls are recorded once into an
+ *  SkRecord, and flushToCanvases() plays the record into every child, each on a worker of an
+ *  SkTaskPool, and waits for them all. Drawing to a raster preview, a PDF and a hit-test canvas
+ *  then takes as long as the slowest of them rather than their sum.
+ *
+ *  Children see exactly the calls SkNWayCanvas would forward, only later. Anything the calls
+ *  reference (bitmaps' pixels, and so on) must stay unchanged until the next flush, and the
+ *  children may only be used from other threads between flushes.
+ */
+class SkParallelNWayCanvas : public SkRecorder {
+public:
+    /** The children draw on pool, or on SkTaskPool::Global() if it is NULL. */
+    SkParallelNWayCanvas(int width, int height, SkTaskPool* pool = NULL);
+
+    /** Flushes to the children before letting go of them. */
+    virtual ~SkParallelNWayCanvas();
+
+    void addCanvas(SkCanvas*);
+
+    /** Flushes first, so the canvas gets everything drawn while it was a child. */
+    void removeCanvas(SkCanvas*);
+    void removeAll();
+
+    /** Plays everything drawn since the last flush into every child and waits for them. */
+    void flushToCanvases();
+
+private:
+    static void DrawProc(void* data);
+
+    SkTaskPool*             fPool;
+    SkAutoTDelete<SkRecord> fRecord;
+    SkTDArray<SkCanvas*>    fList;
+
+    typedef SkRecorder INHERITED;
+};
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkParallelPathFill.h"
+
+#include "SkPath.h"
+#include "SkScan.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+#include "SkThreadUtils.h"
+
+namespace {
+
+// Each band rebuilds its edges from the whole path, so bands must be tall
+// enough for the scanning to outweigh that.
+static const int kMinBandHeight = 32;
+
+// A couple of bands per thread evens out paths whose complexity is not
+// spread evenly over their height.
+static const int kBandsPerThread = 2;
+
+/**
+ *  State shared by all the workers. Bands are handed out top to bottom
+ *  through an atomic counter, so faster threads simply pick up more bands.
+ */
+struct BandQueue {
+    const SkPath*   fPath;
+    const SkMask*   fMask;
+    int             fBandHeight;
+    int             fBandCount;
+    int32_t         fNextBand;
+
+    bool nextBand(SkIRect* band) {
+        int32_t index = sk_atomic_inc(&fNextBand);
+        if (index >= fBandCount) {
+            return false;
+        }
+        const SkIRect& bounds = fMask->fBounds;
+        band->set(bounds.fLeft, bounds.fTop + index * fBandHeight,
+                  bounds.fRight, bounds.fTop + (index + 1) * fBandHeight);
+        if (band->fBottom > bounds.fBottom) {
+            band->fBottom = bounds.fBottom;
+        }
+        return true;
+    }
+};
+
+void worker_proc(void* data) {
+    BandQueue* queue = static_cast<BandQueue*>(data);
+    SkIRect band;
+    while (queue->nextBand(&band)) {
+        SkScan::AntiFillPathBand(*queue->fPath, band, *queue->fMask);
+    }
+}
+
+}  // namespace
+
+bool SkParallelPathFill::AntiFillToMask(const SkPath& path, const SkIRect& clipBounds,
+                                        int threadCount, SkMask* mask) {
+    if (path.isInverseFillType()) {
+        return false;
+    }
+
+    SkIRect bounds;
+    path.getBounds().roundOut(&bounds);
+    if (!bounds.intersect(clipBounds)) {
+        return false;
+    }
+
+    mask->fBounds = bounds;
+    mask->fRowBytes = bounds.width();
+    mask->fFormat = SkMask::kA8_Format;
+    size_t size = mask->computeImageSize();
+    if (0 == size) {
+        return false;
+    }
+    mask->fImage = SkMask::AllocImage(size);
+
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    BandQueue queue;
+    queue.fPath = &path;
+    queue.fMask = mask;
+    queue.fBandHeight = SkMax32(kMinBandHeight,
+        (bounds.height() + threadCount * kBandsPerThread - 1) / (threadCount * kBandsPerThread));
+    queue.fBandCount = (bounds.height() + queue.fBandHeight - 1) / queue.fBandHeight;
+    queue.fNextBand = 0;
+
+    if (threadCount > queue.fBandCount) {
+        threadCount = queue.fBandCount;
+    }
+
+    // The path caches its bounds and convexity the first time they are asked
+    // for. getBounds() has been called already; call isConvex() too so the
+    // workers only ever read the path.
+    path.isConvex();
+
+    // The calling thread scans bands too, so start one fewer worker.
+    SkTDArray<SkThread*> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        SkThread* thread = SkNEW_ARGS(SkThread, (worker_proc, &queue));
+        if (!thread->start()) {
+            // Its bands are picked up by the other threads.
+            SkDELETE(thread);
+            continue;
+        }
+        *threads.append() = thread;
+    }
+
+    worker_proc(&queue);
+
+    for (int i = 0; i < threads.count(); ++i) {
+        threads[i]->join();
+        SkDELETE(threads[i]);
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkParallelPathFill_DEFINED
+#define SkParallelPathFill_DEFINED
+
+#include "SkMask.h"
+
+class SkPath;
+
+/**
+ *  Antialiases a very large path (e.g. a map polygon with 100k points) on a
+ *  pool of worker threads. The path's vertical extent is cut into bands;
+ *  each band builds its own edge list from just the edges that cross it and
+ *  is scanned into its own rows of a shared A8 mask.
+ *
+ *  The result is a coverage mask, so it can be drawn with any paint, e.g. by
+ *  wrapping it in an A8 SkBitmap and calling SkCanvas::drawBitmap(), which
+ *  fills it with the paint's color or shader.
+ *
+ *  Every band walks the whole path to find its edges, so this only pays off
+ *  for paths with a great many points. Small paths should just be drawn.
+ */
+class SkParallelPathFill : SkNoncopyable {
+public:
+    /**
+     *  Fills path, which is in device space and must not be inverse filled,
+     *  clipped to clipBounds. On success mask->fImage is allocated with
+     *  SkMask::AllocImage and the caller frees it with SkMask::FreeImage.
+     *  If threadCount is <= 1 the bands are scanned on the calling thread.
+     *  Returns false if the path is inverse filled or covers no pixels.
+     */
+    static bool AntiFillToMask(const SkPath& path, const SkIRect& clipBounds,
+                               int threadCount, SkMask* mask);
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkParallelResize.h"
+
+#include "SkTArray.h"
+#include "SkTaskPool.h"
+
+namespace {
+
+// Bands shorter than this spend too much of their time on the rows they share with their
+// neighbours.
+const int kMinBandRows = 32;
+// More bands than threads, so a thread that finishes early can take another.
+const int kBandsPerThread = 2;
+
+struct BandTask {
+    const SkBitmap*                 fSource;
+    SkBitmapScaler::ResizeMethod    fMethod;
+    int                             fDestWidth;
+    int                             fDestHeight;
+    SkIRect                         fBand;
+    const SkConvolutionProcs*       fProcs;
+    void*                           fPixels;
+    size_t                          fRowBytes;
+    bool                            fResult;
+};
+
+void resize_band(void* data) {
+    BandTask* task = static_cast<BandTask*>(data);
+    task->fResult = SkBitmapScaler::ResizeInto(task->fPixels, task->fRowBytes, *task->fSource,
+                                               task->fMethod, task->fDestWidth,
+                                               task->fDestHeight, task->fBand, *task->fProcs);
+}
+
+}  // namespace
+
+bool SkParallelResize::Resize(SkBitmap* resultPtr,
+                              const SkBitmap& source,
+                              SkBitmapScaler::ResizeMethod method,
+                              int destWidth, int destHeight,
+                              const SkConvolutionProcs& convolveProcs,
+                              SkTaskPool* pool,
+                              SkBitmap::Allocator* allocator) {
+    if (NULL == pool) {
+        pool = SkTaskPool::Global();
+    }
+    const int bandCount = SkMin32(destHeight / kMinBandRows,
+                                  (pool->threadCount() + 1) * kBandsPerThread);
+    if (bandCount < 2 || source.width() < 1 || source.height() < 1 || destWidth < 1) {
+        return SkBitmapScaler::Resize(resultPtr, source, method, destWidth, destHeight,
+                                      convolveProcs, allocator);
+    }
+
+    SkAutoLockPixels locker(source);
+    if (!source.readyToDraw() || source.colorType() != kN32_SkColorType) {
+        return false;
+    }
+
+    SkBitmap result;
+    result.setConfig(SkImageInfo::MakeN32(destWidth, destHeight, source.alphaType()));
+    result.allocPixels(allocator, NULL);
+    if (!result.readyToDraw()) {
+        return false;
+    }
+
+    SkTArray<BandTask> tasks(bandCount);
+    {
+        SkTaskGroup group(pool);
+        int top = 0;
+        for (int i = 0; i < bandCount; ++i) {
+            int bottom = (int)((int64_t)destHeight * (i + 1) / bandCount);
+            BandTask& task = tasks.push_back();
+            task.fSource = &source;
+            task.fMethod = method;
+            task.fDestWidth = destWidth;
+            task.fDestHeight = destHeight;
+            task.fBand = SkIRect::MakeLTRB(0, top, destWidth, bottom);
+            task.fProcs = &convolveProcs;
+            task.fPixels = result.getAddr32(0, top);
+            task.fRowBytes = result.rowBytes();
+            task.fResult = false;
+            group.add(resize_band, &task);
+            top = bottom;
+        }
+    }
+
+    for (int i = 0; i < tasks.count(); ++i) {
+        if (!tasks[i].fResult) {
+            return false;
+        }
+    }
+    *resultPtr = result;
+    resultPtr->lockPixels();
+    return true;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkParallelResize_DEFINED
+#define SkParallelResize_DEFINED
+
+#include "SkBitmap.h"
+#include "SkBitmapScaler.h"
+
+class SkTaskPool;
+
+/**
+ *  Resamples large bitmaps with SkBitmapScaler's filters on a pool of worker threads.
+ *
+ *  The destination is cut into bands of rows, and each band is resampled on its own with
+ *  SkBitmapScaler::ResizeInto(). A band convolves horizontally only the source rows its
+ *  vertical filters reach, so the bands overlap by no more than the filter's support and the
+ *  result is the same as SkBitmapScaler::Resize() gives.
+ */
+class SkParallelResize : SkNoncopyable {
+public:
+    /**
+     *  Resizes source to destWidth x destHeight, as SkBitmapScaler::Resize() would. The work is
+     *  run on pool, or on SkTaskPool::Global() if pool is NULL. Small destinations are simply
+     *  handed to SkBitmapScaler::Resize().
+     */
+    static bool Resize(SkBitmap* result,
+                       const SkBitmap& source,
+                       SkBitmapScaler::ResizeMethod method,
+                       int destWidth, int destHeight,
+                       const SkConvolutionProcs&,
+                       SkTaskPool* pool = NULL,
+                       SkBitmap::Allocator* allocator = NULL);
+};
+
+#endif
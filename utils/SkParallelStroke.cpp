@@ -0,0 +1,179 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkParallelStroke.h"
+
+#include "SkPath.h"
+#include "SkStroke.h"
+#include "SkTArray.h"
+#include "SkTaskPool.h"
+#include "SkTDArray.h"
+
+namespace {
+
+// Below this a piece isn't worth handing to another thread.
+static const int kMinPiecePoints = 4096;
+
+// A few pieces per thread evens out contours whose joins aren't spread evenly.
+static const int kPiecesPerThread = 2;
+
+struct Piece {
+    int     fStart;     // index into the shared points
+    int     fCount;
+    bool    fCapStart;
+    bool    fCapEnd;
+};
+
+struct PieceTask {
+    const SkStroke* fStroke;
+    const SkPoint*  fPts;
+    const Piece*    fPiece;
+    SkPath          fResult;
+};
+
+void stroke_piece(void* data) {
+    PieceTask* task = static_cast<PieceTask*>(data);
+    const Piece& piece = *task->fPiece;
+    task->fStroke->strokePolyline(task->fPts + piece.fStart, piece.fCount, piece.fCapStart,
+                                  piece.fCapEnd, &task->fResult);
+}
+
+void add_polyline(SkPath* path, const SkPoint pts[], int count, bool close) {
+    path->moveTo(pts[0]);
+    for (int i = 1; i < count; ++i) {
+        path->lineTo(pts[i]);
+    }
+    if (close) {
+        path->close();
+    }
+}
+
+/**
+ *  Cuts the contour pts[start..start+count) into pieceCount pieces. Every piece
+ *  but the first starts a segment early, so that it draws the join at its cut.
+ */
+void cut_contour(const SkPoint pts[], int start, int count, int pieceCount,
+                 SkTDArray<Piece>* pieces) {
+    int cutStart = start;
+    for (int i = 0; i < pieceCount; ++i) {
+        int cutEnd = start + (int)((int64_t)(count - 1) * (i + 1) / pieceCount);
+        // The stroker skips degenerate segments, so back up to a point that
+        // really makes a segment with the cut.
+        int first = cutStart;
+        if (i > 0) {
+            first = cutStart - 1;
+            while (first > start && SkPath::IsLineDegenerate(pts[first], pts[cutStart])) {
+                --first;
+            }
+        }
+        Piece* piece = pieces->append();
+        piece->fStart = first;
+        piece->fCount = cutEnd - first + 1;
+        piece->fCapStart = (0 == i);
+        piece->fCapEnd = (pieceCount - 1 == i);
+        cutStart = cutEnd;
+    }
+}
+
+}  // namespace
+
+void SkParallelStroke::StrokePath(const SkStroke& stroke, const SkPath& src, SkPath* dst,
+                                  SkTaskPool* pool) {
+    SkASSERT(dst != NULL);
+
+    if (stroke.getDoFill() || src.getSegmentMasks() != SkPath::kLine_SegmentMask ||
+        src.countPoints() < 2 * kMinPiecePoints) {
+        stroke.strokePath(src, dst);
+        return;
+    }
+
+    if (NULL == pool) {
+        pool = SkTaskPool::Global();
+    }
+    const int maxPieces = (pool->threadCount() + 1) * kPiecesPerThread;
+
+    // The long open contours' points are kept for the pieces; everything else
+    // is copied into rest, to be stroked as usual.
+    SkTDArray<SkPoint> points;
+    points.setReserve(src.countPoints());
+    SkTDArray<Piece> pieces;
+    SkPath rest;
+
+    SkPath::RawIter iter(src);
+    SkPoint pts[4];
+    int contourStart = 0;
+    for (;;) {
+        SkPath::Verb verb = iter.next(pts);
+        if (SkPath::kLine_Verb == verb) {
+            *points.append() = pts[1];
+            continue;
+        }
+
+        // Any other verb ends the current contour.
+        const int count = points.count() - contourStart;
+        if (count > 0) {
+            const bool closed = (SkPath::kClose_Verb == verb);
+            const int pieceCount = SkMin32(count / kMinPiecePoints, maxPieces);
+            if (!closed && pieceCount > 1) {
+                cut_contour(points.begin(), contourStart, count, pieceCount, &pieces);
+                contourStart = points.count();
+            } else {
+                add_polyline(&rest, points.begin() + contourStart, count, closed);
+                points.setCount(contourStart);
+            }
+        }
+
+        if (SkPath::kMove_Verb == verb) {
+            *points.append() = pts[0];
+        } else if (SkPath::kDone_Verb == verb) {
+            break;
+        }
+    }
+
+    if (pieces.isEmpty()) {
+        stroke.strokePath(src, dst);
+        return;
+    }
+
+    // points no longer changes, so the tasks can all read it.
+    SkTArray<PieceTask> tasks(pieces.count());
+    {
+        SkTaskGroup group(pool);
+        for (int i = 0; i < pieces.count(); ++i) {
+            PieceTask& task = tasks.push_back();
+            task.fStroke = &stroke;
+            task.fPts = points.begin();
+            task.fPiece = &pieces[i];
+            group.add(stroke_piece, &task);
+        }
+
+        // The calling thread strokes the rest while the pieces are stroked.
+        if (rest.countPoints() > 0) {
+            SkPath strokedRest;
+            stroke.strokePath(rest, &strokedRest);
+            rest.swap(strokedRest);
+        }
+    }
+
+    int resultPoints = rest.countPoints();
+    for (int i = 0; i < tasks.count(); ++i) {
+        resultPoints += tasks[i].fResult.countPoints();
+    }
+
+    SkPath result;
+    result.incReserve(resultPoints);
+    result.addPath(rest);
+    for (int i = 0; i < tasks.count(); ++i) {
+        result.addPath(tasks[i].fResult);
+    }
+
+    // our answer should preserve the inverseness of the src
+    if (src.isInverseFillType()) {
+        result.toggleInverseFillType();
+    }
+    dst->swap(result);
+}
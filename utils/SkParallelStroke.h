@@ -0,0 +1,41 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkParallelStroke_DEFINED
+#define SkParallelStroke_DEFINED
+
+#include "SkTypes.h"
+
+class SkPath;
+class SkStroke;
+class SkTaskPool;
+
+/**
+ *  Strokes paths made of very long open polylines (e.g. map roads with 100k
+ *  points) on a pool of worker threads.
+ *
+ *  Each long contour is cut into pieces that overlap by a segment. The pieces
+ *  are stroked concurrently with SkStroke::strokePolyline(), with butt caps
+ *  where they were cut, so each join is still drawn whole by the piece that
+ *  starts just before it. The stroked pieces wind the same way and are added
+ *  to the result as separate contours, so the result fills the same pixels as
+ *  SkStroke::strokePath() would under the winding fill rule.
+ *
+ *  Closed and shorter contours are stroked together on the calling thread.
+ */
+class SkParallelStroke : SkNoncopyable {
+public:
+    /**
+     *  Strokes src into dst, as stroke.strokePath(src, dst) would. The work is
+     *  run on pool, or on SkTaskPool::Global() if pool is NULL. Paths with
+     *  curves, and strokes that also fill, are simply handed to strokePath().
+     */
+    static void StrokePath(const SkStroke& stroke, const SkPath& src, SkPath* dst,
+                           SkTaskPool* pool = NULL);
+};
+
+#endif
@@ -46,9 +46,96 @@ static const char* skip_sep(const char str[]) {
     return str;
 }
 
+// Exactly representable as doubles, so a mantissa of up to kMaxFastDigits digits scaled by one
+// of them is rounded once, just as strtod() would round it.
+static const double gPow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int kMaxFastDigits = 15;  // 10^15 < 2^53
+static const int kMaxFastScale = (int) SK_ARRAY_COUNT(gPow10) - 1;
+
+/**
+ *  Parses the decimal numbers path data is made of without going through strtod(). Numbers it
+ *  can't parse exactly (too many digits, large exponents, or anything that isn't a plain decimal)
+ *  are left to SkParse::FindScalar(), so the result is the same either way.
+ */
+static const char* find_scalar_fast(const char str[], SkScalar* value) {
+    str = skip_ws(str);
+    const char* start = str;
+
+    bool negative = false;
+    if (*str == '-' || *str == '+') {
+        negative = *str == '-';
+        str++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;     // significant digits in mantissa
+    int scale = 0;
+    bool anyDigits = false;
+    for (; is_digit(*str); str++) {
+        mantissa = mantissa * 10 + (*str - '0');
+        digits += mantissa != 0;
+        anyDigits = true;
+    }
+    if (*str == 'x' || *str == 'X') {
+        return SkParse::FindScalar(start, value);  // strtod() takes hex
+    }
+    if (*str == '.') {
+        for (str++; is_digit(*str); str++) {
+            mantissa = mantissa * 10 + (*str - '0');
+            digits += mantissa != 0;
+            scale--;
+            anyDigits = true;
+        }
+    }
+    if (!anyDigits || digits > kMaxFastDigits) {
+        return SkParse::FindScalar(start, value);
+    }
+
+    if (*str == 'e' || *str == 'E') {
+        const char* exp = str + 1;
+        bool negativeExp = false;
+        if (*exp == '-' || *exp == '+') {
+            negativeExp = *exp == '-';
+            exp++;
+        }
+        // Otherwise the 'e' isn't part of the number, as with strtod().
+        if (is_digit(*exp)) {
+            int e = 0;
+            for (; is_digit(*exp); exp++) {
+                if (e > kMaxFastScale + kMaxFastDigits) {
+                    return SkParse::FindScalar(start, value);
+                }
+                e = e * 10 + (*exp - '0');
+            }
+            scale += negativeExp ? -e : e;
+            str = exp;
+        }
+    }
+    if (scale < -kMaxFastScale || scale > kMaxFastScale) {
+        return SkParse::FindScalar(start, value);
+    }
+
+    double v = (double) mantissa;
+    v = scale < 0 ? v / gPow10[-scale] : v * gPow10[scale];
+    *value = (float) (negative ? -v : v);
+    return str;
+}
+
 static const char* find_points(const char str[], SkPoint value[], int count,
                                bool isRelative, SkPoint* relative) {
-    str = SkParse::FindScalars(str, &value[0].fX, count * 2);
+    SkScalar* scalars = &value[0].fX;
+    for (int index = 0; index < count * 2; index++) {
+        if (index > 0) {
+            str = skip_sep(str);
+        }
+        str = find_scalar_fast(str, &scalars[index]);
+        if (NULL == str) {
+            return NULL;
+        }
+    }
     if (isRelative) {
         for (int index = 0; index < count; index++) {
             value[index].fX += relative->fX;
@@ -60,15 +147,47 @@ static const char* find_points(const char str[], SkPoint value[], int count,
 
 static const char* find_scalar(const char str[], SkScalar* value,
                                bool isRelative, SkScalar relative) {
-    str = SkParse::FindScalar(str, value);
-    if (isRelative) {
+    str = find_scalar_fast(str, value);
+    if (NULL != str && isRelative) {
         *value += relative;
     }
     return str;
 }
 
+static inline bool is_number_start(int c) {
+    return is_digit(c) || c == '-' || c == '+' || c == '.';
+}
+
+/**
+ *  A quick pass over the path data counting the numbers in it, to reserve storage in the path
+ *  before building it. Each segment takes at least two numbers per point it adds, or one for H
+ *  and V, which this splits the difference on. Signs and points within one run of characters
+ *  ("1-2", "1.5.5") count as one number, so this can come up short, but never by much.
+ */
+static int count_reserve(const char data[]) {
+    int numbers = 0;
+    int commands = 0;
+    bool inNumber = false;
+    for (; *data; data++) {
+        const char c = *data;
+        if (is_number_start(c)) {
+            numbers += !inNumber;
+            inNumber = true;
+        } else if (is_sep(c)) {
+            inNumber = false;
+        } else if (c == 'e' || c == 'E') {
+            // An exponent: stays within the number.
+        } else {
+            commands++;
+            inNumber = false;
+        }
+    }
+    return commands + (numbers + 1) / 2;
+}
+
 bool SkParsePath::FromSVGString(const char data[], SkPath* result) {
     SkPath path;
+    path.incReserve(count_reserve(data));
     SkPoint f = {0, 0};
     SkPoint c = {0, 0};
     SkPoint lastc = {0, 0};
@@ -82,7 +201,7 @@ bool SkParsePath::FromSVGString(const char data[], SkPath* result) {
             break;
         }
         char ch = data[0];
-        if (is_digit(ch) || ch == '-' || ch == '+') {
+        if (is_number_start(ch)) {
             if (op == '\0') {
                 return false;
             }
@@ -172,6 +291,9 @@ bool SkParsePath::FromSVGString(const char data[], SkPath* result) {
             default:
                 return false;
         }
+        if (NULL == data) {
+            return false;
+        }
         if (previousOp == 0) {
             f = c;
         }
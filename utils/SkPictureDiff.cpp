@@ -0,0 +1,424 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPictureDiff.h"
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkChecksum.h"
+#include "SkPicture.h"
+#include "SkPtrRecorder.h"
+#include "SkRRect.h"
+#include "SkRegion.h"
+#include "SkTemplates.h"
+#include "SkWriteBuffer.h"
+
+namespace {
+
+enum OpType {
+    kClear_OpType,
+    kDrawPaint_OpType,
+    kDrawPoints_OpType,
+    kDrawOval_OpType,
+    kDrawRect_OpType,
+    kDrawRRect_OpType,
+    kDrawDRRect_OpType,
+    kDrawPath_OpType,
+    kDrawBitmap_OpType,
+    kDrawBitmapRectToRect_OpType,
+    kDrawBitmapMatrix_OpType,
+    kDrawBitmapNine_OpType,
+    kDrawSprite_OpType,
+    kDrawText_OpType,
+    kDrawPosText_OpType,
+    kDrawPosTextH_OpType,
+    kDrawTextOnPath_OpType,
+    kDrawVertices_OpType,
+    kDrawData_OpType,
+    kSaveLayer_OpType,
+    kRestore_OpType,
+};
+
+/**
+ *  A canvas with no pixels that folds every op it is asked to draw into a
+ *  running hash. The clips are still applied so that ops falling entirely
+ *  outside the canvas can be left out of the hash.
+ */
+class HashCanvas : public SkCanvas {
+public:
+    HashCanvas(int width, int height, SkRefCntSet* typefaces, SkNamedFactorySet* factories)
+        : INHERITED(width, height)
+        , fTypefaces(typefaces)
+        , fFactories(factories)
+        , fHash(0) {
+    }
+
+    uint32_t hash() const { return fHash; }
+
+    virtual void clear(SkColor color) SK_OVERRIDE {
+        Op op(this, kClear_OpType);
+        op->writeColor(color);
+    }
+
+    virtual void drawPaint(const SkPaint& paint) SK_OVERRIDE {
+        Op op(this, kDrawPaint_OpType, &paint);
+    }
+
+    virtual void drawPoints(PointMode mode, size_t count, const SkPoint pts[],
+                            const SkPaint& paint) SK_OVERRIDE {
+        SkRect bounds;
+        bounds.set(pts, SkToInt(count));
+        if (count > 0 && this->rejectBounds(bounds, paint, true)) {
+            return;
+        }
+        Op op(this, kDrawPoints_OpType, &paint);
+        op->writeInt(mode);
+        op->writePointArray(pts, SkToU32(count));
+    }
+
+    virtual void drawOval(const SkRect& oval, const SkPaint& paint) SK_OVERRIDE {
+        if (this->rejectBounds(oval, paint)) {
+            return;
+        }
+        Op op(this, kDrawOval_OpType, &paint);
+        op->writeRect(oval);
+    }
+
+    virtual void drawRect(const SkRect& rect, const SkPaint& paint) SK_OVERRIDE {
+        SkRect sorted = rect;
+        sorted.sort();
+        if (this->rejectBounds(sorted, paint)) {
+            return;
+        }
+        Op op(this, kDrawRect_OpType, &paint);
+        op->writeRect(rect);
+    }
+
+    virtual void drawRRect(const SkRRect& rrect, const SkPaint& paint) SK_OVERRIDE {
+        if (this->rejectBounds(rrect.getBounds(), paint)) {
+            return;
+        }
+        Op op(this, kDrawRRect_OpType, &paint);
+        write_rrect(op.buffer(), rrect);
+    }
+
+    virtual void drawPath(const SkPath& path, const SkPaint& paint) SK_OVERRIDE {
+        if (!path.isInverseFillType() && this->rejectBounds(path.getBounds(), paint)) {
+            return;
+        }
+        Op op(this, kDrawPath_OpType, &paint);
+        op->writePath(path);
+    }
+
+    virtual void drawBitmap(const SkBitmap& bitmap, SkScalar left, SkScalar top,
+                            const SkPaint* paint) SK_OVERRIDE {
+        SkRect bounds = SkRect::MakeXYWH(left, top,
+                                         SkIntToScalar(bitmap.width()),
+                                         SkIntToScalar(bitmap.height()));
+        if (this->rejectBounds(bounds, paint)) {
+            return;
+        }
+        Op op(this, kDrawBitmap_OpType, paint);
+        write_bitmap(op.buffer(), bitmap);
+        op->writeScalar(left);
+        op->writeScalar(top);
+    }
+
+    virtual void drawBitmapRectToRect(const SkBitmap& bitmap, const SkRect* src,
+                                      const SkRect& dst, const SkPaint* paint,
+                                      DrawBitmapRectFlags flags) SK_OVERRIDE {
+        if (this->rejectBounds(dst, paint)) {
+            return;
+        }
+        Op op(this, kDrawBitmapRectToRect_OpType, paint);
+        write_bitmap(op.buffer(), bitmap);
+        op->writeBool(NULL != src);
+        if (NULL != src) {
+            op->writeRect(*src);
+        }
+        op->writeRect(dst);
+        op->writeUInt(flags);
+    }
+
+    virtual void drawBitmapMatrix(const SkBitmap& bitmap, const SkMatrix& matrix,
+                                  const SkPaint* paint) SK_OVERRIDE {
+        SkRect bounds = SkRect::MakeWH(SkIntToScalar(bitmap.width()),
+                                       SkIntToScalar(bitmap.height()));
+        matrix.mapRect(&bounds);
+        if (this->rejectBounds(bounds, paint)) {
+            return;
+        }
+        Op op(this, kDrawBitmapMatrix_OpType, paint);
+        write_bitmap(op.buffer(), bitmap);
+        op->writeMatrix(matrix);
+    }
+
+    virtual void drawBitmapNine(const SkBitmap& bitmap, const SkIRect& center,
+                                const SkRect& dst, const SkPaint* paint) SK_OVERRIDE {
+        if (this->rejectBounds(dst, paint)) {
+            return;
+        }
+        Op op(this, kDrawBitmapNine_OpType, paint);
+        write_bitmap(op.buffer(), bitmap);
+        op->writeIRect(center);
+        op->writeRect(dst);
+    }
+
+    virtual void drawSprite(const SkBitmap& bitmap, int left, int top,
+                            const SkPaint* paint) SK_OVERRIDE {
+        // Sprites ignore the matrix, so test against the device clip directly.
+        SkIRect devClip;
+        SkIRect bounds = SkIRect::MakeXYWH(left, top, bitmap.width(), bitmap.height());
+        if (!this->getClipDeviceBounds(&devClip) || !SkIRect::Intersects(devClip, bounds)) {
+            return;
+        }
+        Op op(this, kDrawSprite_OpType, paint);
+        write_bitmap(op.buffer(), bitmap);
+        op->writeInt(left);
+        op->writeInt(top);
+    }
+
+    virtual void drawVertices(VertexMode mode, int vertexCount,
+                              const SkPoint vertices[], const SkPoint texs[],
+                              const SkColor colors[], SkXfermode* xfer,
+                              const uint16_t indices[], int indexCount,
+                              const SkPaint& paint) SK_OVERRIDE {
+        SkRect bounds;
+        bounds.set(vertices, vertexCount);
+        if (vertexCount > 0 && this->rejectBounds(bounds, paint, true)) {
+            return;
+        }
+        Op op(this, kDrawVertices_OpType, &paint);
+        op->writeInt(mode);
+        op->writePointArray(vertices, vertexCount);
+        op->writeBool(NULL != texs);
+        if (NULL != texs) {
+            op->writePointArray(texs, vertexCount);
+        }
+        op->writeBool(NULL != colors);
+        if (NULL != colors) {
+            op->writeColorArray(colors, vertexCount);
+        }
+        op->writeFlattenable(xfer);
+        op->writeByteArray(indices, indexCount * sizeof(uint16_t));
+    }
+
+    virtual void drawData(const void* data, size_t length) SK_OVERRIDE {
+        Op op(this, kDrawData_OpType);
+        op->writeByteArray(data, length);
+    }
+
+protected:
+    virtual SaveLayerStrategy willSaveLayer(const SkRect* bounds, const SkPaint* paint,
+                                            SaveFlags flags) SK_OVERRIDE {
+        // Layers change how everything up to the matching restore lands, so
+        // they are always part of the hash.
+        Op op(this, kSaveLayer_OpType, paint);
+        op->writeBool(NULL != bounds);
+        if (NULL != bounds) {
+            op->writeRect(*bounds);
+        }
+        op->writeUInt(flags);
+        return INHERITED::willSaveLayer(bounds, paint, flags);
+    }
+
+    virtual void willRestore() SK_OVERRIDE {
+        Op op(this, kRestore_OpType);
+        this->INHERITED::willRestore();
+    }
+
+    virtual void onDrawDRRect(const SkRRect& outer, const SkRRect& inner,
+                              const SkPaint& paint) SK_OVERRIDE {
+        if (this->rejectBounds(outer.getBounds(), paint)) {
+            return;
+        }
+        Op op(this, kDrawDRRect_OpType, &paint);
+        write_rrect(op.buffer(), outer);
+        write_rrect(op.buffer(), inner);
+    }
+
+    // Text bounds depend on the font metrics, so text is always hashed.
+    virtual void onDrawText(const void* text, size_t byteLength, SkScalar x, SkScalar y,
+                            const SkPaint& paint) SK_OVERRIDE {
+        Op op(this, kDrawText_OpType, &paint);
+        op->writeByteArray(text, byteLength);
+        op->writeScalar(x);
+        op->writeScalar(y);
+    }
+
+    virtual void onDrawPosText(const void* text, size_t byteLength, const SkPoint pos[],
+                               const SkPaint& paint) SK_OVERRIDE {
+        Op op(this, kDrawPosText_OpType, &paint);
+        op->writeByteArray(text, byteLength);
+        op->writePointArray(pos, paint.countText(text, byteLength));
+    }
+
+    virtual void onDrawPosTextH(const void* text, size_t byteLength, const SkScalar xpos[],
+                                SkScalar constY, const SkPaint& paint) SK_OVERRIDE {
+        Op op(this, kDrawPosTextH_OpType, &paint);
+        op->writeByteArray(text, byteLength);
+        op->writeScalarArray(xpos, paint.countText(text, byteLength));
+        op->writeScalar(constY);
+    }
+
+    virtual void onDrawTextOnPath(const void* text, size_t byteLength, const SkPath& path,
+                                  const SkMatrix* matrix, const SkPaint& paint) SK_OVERRIDE {
+        Op op(this, kDrawTextOnPath_OpType, &paint);
+        op->writeByteArray(text, byteLength);
+        op->writePath(path);
+        op->writeMatrix(NULL != matrix ? *matrix : SkMatrix::I());
+    }
+
+private:
+    /**
+     *  Collects one op. The op type, the current matrix and device clip and
+     *  the paint go in first; the caller adds the arguments; the whole thing
+     *  is hashed into the canvas when the Op goes out of scope.
+     */
+    class Op : SkNoncopyable {
+    public:
+        Op(HashCanvas* canvas, OpType type, const SkPaint* paint = NULL)
+            : fCanvas(canvas)
+            , fBuffer(fStorage, sizeof(fStorage), SkWriteBuffer::kCrossProcess_Flag) {
+            fBuffer.setTypefaceRecorder(canvas->fTypefaces);
+            fBuffer.setNamedFactoryRecorder(canvas->fFactories);
+
+            SkIRect devClip;
+            if (!canvas->getClipDeviceBounds(&devClip)) {
+                devClip.setEmpty();
+            }
+            fBuffer.writeUInt(type);
+            fBuffer.writeMatrix(canvas->getTotalMatrix());
+            fBuffer.writeIRect(devClip);
+            fBuffer.writeBool(NULL != paint);
+            if (NULL != paint) {
+                paint->flatten(fBuffer);
+            }
+        }
+
+        ~Op() {
+            size_t size = fBuffer.bytesWritten();
+            SkAutoSMalloc<sizeof(fStorage)> flat(size);
+            fBuffer.writeToMemory(flat.get());
+            SkASSERT(SkIsAlign4(size));
+            uint32_t opHash = SkChecksum::Compute(static_cast<const uint32_t*>(flat.get()), size);
+            // Rotate before mixing so the order of the ops matters.
+            fCanvas->fHash = ((fCanvas->fHash << 7) | (fCanvas->fHash >> 25)) ^ opHash;
+        }
+
+        SkWriteBuffer* operator->() { return &fBuffer; }
+        SkWriteBuffer* buffer() { return &fBuffer; }
+
+    private:
+        HashCanvas* fCanvas;
+        uint32_t fStorage[64];
+        SkWriteBuffer fBuffer;
+    };
+
+    static void write_rrect(SkWriteBuffer* buffer, const SkRRect& rrect) {
+        char storage[SkRRect::kSizeInMemory];
+        SkDEBUGCODE(size_t size =) rrect.writeToMemory(storage);
+        SkASSERT(SkRRect::kSizeInMemory == size);
+        buffer->writeByteArray(storage, sizeof(storage));
+    }
+
+    // The pixels themselves are not looked at: a bitmap is the same if its
+    // pixel ref, the part of it being used and its generation ID are.
+    static void write_bitmap(SkWriteBuffer* buffer, const SkBitmap& bitmap) {
+        buffer->writeUInt(bitmap.getGenerationID());
+        buffer->writeInt(bitmap.width());
+        buffer->writeInt(bitmap.height());
+        buffer->writePoint(SkPoint::Make(SkIntToScalar(bitmap.pixelRefOrigin().fX),
+                                         SkIntToScalar(bitmap.pixelRefOrigin().fY)));
+    }
+
+    // Returns true if bounds (in local coordinates), outset for the paint,
+    // can't touch the clip. Ops whose paint can't compute fast bounds are
+    // never rejected.
+    bool rejectBounds(const SkRect& bounds, const SkPaint* paint, bool stroke = false) {
+        if (NULL == paint) {
+            return this->quickReject(bounds);
+        }
+        if (!paint->canComputeFastBounds()) {
+            return false;
+        }
+        SkRect storage;
+        const SkRect& fastBounds = stroke ? paint->computeFastStrokeBounds(bounds, &storage)
+                                          : paint->computeFastBounds(bounds, &storage);
+        return this->quickReject(fastBounds);
+    }
+
+    bool rejectBounds(const SkRect& bounds, const SkPaint& paint, bool stroke = false) {
+        return this->rejectBounds(bounds, &paint, stroke);
+    }
+
+    SkRefCntSet* fTypefaces;
+    SkNamedFactorySet* fFactories;
+    uint32_t fHash;
+
+    typedef SkCanvas INHERITED;
+};
+
+uint32_t hash_tile(SkPicture* picture, const SkIRect& tile,
+                   SkRefCntSet* typefaces, SkNamedFactorySet* factories) {
+    if (NULL == picture) {
+        return 0;
+    }
+    HashCanvas canvas(tile.width(), tile.height(), typefaces, factories);
+    canvas.translate(-SkIntToScalar(tile.fLeft), -SkIntToScalar(tile.fTop));
+    picture->draw(&canvas);
+    return canvas.hash();
+}
+
+}  // namespace
+
+void SkPictureDiff::ComputeDamage(SkPicture* before, SkPicture* after,
+                                  const SkTileGridFactory::TileGridInfo& info,
+                                  SkRegion* damage) {
+    SkASSERT(NULL != damage);
+    damage->setEmpty();
+
+    const int tileWidth = info.fTileInterval.width();
+    const int tileHeight = info.fTileInterval.height();
+    if (tileWidth <= 0 || tileHeight <= 0) {
+        return;
+    }
+
+    int width = 0, height = 0;
+    if (NULL != before) {
+        width = SkTMax(width, before->width());
+        height = SkTMax(height, before->height());
+    }
+    if (NULL != after) {
+        width = SkTMax(width, after->width());
+        height = SkTMax(height, after->height());
+    }
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Same cell count as SkTileGridPicture uses for these dimensions.
+    const int xTileCount = (width + tileWidth - 1) / tileWidth;
+    const int yTileCount = (height + tileHeight - 1) / tileHeight;
+
+    // Shared by both pictures so that a typeface or flattenable factory
+    // gets the same index whichever picture it is written from.
+    SkAutoTUnref<SkRefCntSet> typefaces(SkNEW(SkRefCntSet));
+    SkAutoTUnref<SkNamedFactorySet> factories(SkNEW(SkNamedFactorySet));
+
+    for (int y = 0; y < yTileCount; ++y) {
+        for (int x = 0; x < xTileCount; ++x) {
+            SkIRect tile = SkIRect::MakeXYWH(x * tileWidth - info.fOffset.fX,
+                                             y * tileHeight - info.fOffset.fY,
+                                             tileWidth, tileHeight);
+            if (hash_tile(before, tile, typefaces, factories) !=
+                hash_tile(after, tile, typefaces, factories)) {
+                damage->op(tile, SkRegion::kUnion_Op);
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureDiff_DEFINED
+#define SkPictureDiff_DEFINED
+
+#include "SkBBHFactory.h"
+
+class SkPicture;
+class SkRegion;
+
+/**
+ *  Works out which parts of a picture changed between two recordings of it,
+ *  so a compositor can re-rasterize only the damaged tiles of a layer.
+ *
+ *  Both pictures are cut into the cells of a tile grid. For every cell each
+ *  picture is played back into a canvas clipped to the cell which hashes the
+ *  flattened form of every op that survives the clip (the op, its arguments,
+ *  its paint and the matrix and clip it is drawn with). Cells whose hashes
+ *  differ are damaged. Pictures recorded with a matching SkTileGridFactory
+ *  (or any other bounding box hierarchy) only visit the ops near each cell.
+ *
+ *  Bitmaps are compared by generation ID rather than by their pixels.
+ */
+class SkPictureDiff : SkNoncopyable {
+public:
+    /**
+     *  Sets damage to the union of the grid cells, in picture coordinates,
+     *  whose contents differ between before and after. The grid follows
+     *  SkTileGrid: cell (x, y) covers [x * w, (x + 1) * w) x [y * h, (y + 1) * h)
+     *  shifted by -info.fOffset, where (w, h) is info.fTileInterval. The cells
+     *  covering the larger of the two pictures' dimensions are examined.
+     *  Either picture may be NULL, in which case it is treated as empty.
+     */
+    static void ComputeDamage(SkPicture* before, SkPicture* after,
+                              const SkTileGridFactory::TileGridInfo& info,
+                              SkRegion* damage);
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPictureLayer.h"
+
+#include "SkCanvas.h"
+#include "SkImage.h"
+#include "SkPicture.h"
+#include "SkSurface.h"
+
+SkPictureLayer::SkPictureLayer()
+    : fPicture(NULL)
+    , fCachedImage(NULL)
+    , fCachedScale(0)
+    , fCacheEnabled(true) {}
+
+SkPictureLayer::SkPictureLayer(const SkPictureLayer& src)
+    : INHERITED(src)
+    , fPicture(SkSafeRef(src.fPicture))
+    , fCachedImage(SkSafeRef(src.fCachedImage))
+    , fCachedScale(src.fCachedScale)
+    , fCacheEnabled(src.fCacheEnabled) {}
+
+SkPictureLayer::~SkPictureLayer() {
+    SkSafeUnref(fPicture);
+    SkSafeUnref(fCachedImage);
+}
+
+void SkPictureLayer::setPicture(SkPicture* picture) {
+    SkRefCnt_SafeAssign(fPicture, picture);
+    this->invalidate();
+}
+
+void SkPictureLayer::setCacheEnabled(bool enabled) {
+    fCacheEnabled = enabled;
+    if (!enabled) {
+        this->invalidate();
+    }
+}
+
+void SkPictureLayer::invalidate() {
+    SkSafeSetNull(fCachedImage);
+}
+
+bool SkPictureLayer::rasterize(SkCanvas* canvas, SkScalar scale) {
+    SkSize size = this->getSize();
+    if (size.isEmpty()) {
+        size.set(SkIntToScalar(fPicture->width()), SkIntToScalar(fPicture->height()));
+    }
+    const int width = SkScalarCeilToInt(SkScalarMul(size.width(), scale));
+    const int height = SkScalarCeilToInt(SkScalarMul(size.height(), scale));
+    if (width <= 0 || height <= 0 ||
+        width > kMaxCacheDimension || height > kMaxCacheDimension) {
+        return false;
+    }
+
+    // Made by the canvas, the raster lives where the canvas draws, e.g. in a texture on the GPU.
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(width, height);
+    SkAutoTUnref<SkSurface> surface(canvas->newSurface(info));
+    if (NULL == surface.get()) {
+        surface.reset(SkSurface::NewRaster(info));
+        if (NULL == surface.get()) {
+            return false;
+        }
+    }
+
+    SkCanvas* cacheCanvas = surface->getCanvas();
+    cacheCanvas->clear(SK_ColorTRANSPARENT);
+    cacheCanvas->scale(scale, scale);
+    cacheCanvas->clipRect(SkRect::MakeSize(size));
+    cacheCanvas->drawPicture(*fPicture);
+
+    SkASSERT(NULL == fCachedImage);
+    fCachedImage = surface->newImageSnapshot();
+    fCachedScale = scale;
+    return NULL != fCachedImage;
+}
+
+void SkPictureLayer::onDraw(SkCanvas* canvas, SkScalar opacity) {
+    if (NULL == fPicture) {
+        return;
+    }
+    const U8CPU alpha = SkScalarRoundToInt(SkScalarMul(SkMinScalar(opacity, SK_Scalar1), 255));
+
+    // Rasterized at the scale it's drawn at, the cache composites without resampling when this
+    // layer only moves or fades.
+    const SkScalar scale = canvas->getTotalMatrix().getMaxStretch();
+    if (fCacheEnabled && scale > 0) {
+        if (NULL == fCachedImage || fCachedScale != scale) {
+            this->invalidate();
+            this->rasterize(canvas, scale);
+        }
+        if (NULL != fCachedImage) {
+            SkPaint paint;
+            paint.setAlpha(alpha);
+            paint.setFilterLevel(SkPaint::kLow_FilterLevel);
+            SkAutoCanvasRestore acr(canvas, true);
+            const SkScalar invScale = SkScalarInvert(scale);
+            canvas->scale(invScale, invScale);
+            fCachedImage->draw(canvas, 0, 0, &paint);
+            return;
+        }
+    }
+
+    if (0xFF == alpha) {
+        canvas->drawPicture(*fPicture);
+    } else {
+        canvas->saveLayerAlpha(NULL, alpha);
+        canvas->drawPicture(*fPicture);
+        canvas->restore();
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPictureLayer_DEFINED
+#define SkPictureLayer_DEFINED
+
+#include "SkLayer.h"
+
+class SkImage;
+class SkPicture;
+
+/**
+ *  An SkLayer whose content is an SkPicture. With caching on, the picture is rasterized once
+ *  into a surface made by the destination canvas, and later draws composite that raster by the
+ *  layer's transform and opacity; it is only rasterized again after invalidate() or
+ *  setPicture(), or when the layer is drawn at a different scale.
+ *
+ *  Caching suits layers that change rarely but move or fade, as by animations. Layers drawn
+ *  under perspective, or so large the raster would exceed kMaxCacheDimension, draw their
+ *  picture every time.
+ */
+class SkPictureLayer : public SkLayer {
+public:
+    SkPictureLayer();
+    SkPictureLayer(const SkPictureLayer&);
+    virtual ~SkPictureLayer();
+
+    enum {
+        kMaxCacheDimension = 2048
+    };
+
+    SkPicture* getPicture() const { return fPicture; }
+
+    /** Refs the picture, which is drawn at the layer's origin, and invalidates the cache. */
+    void setPicture(SkPicture*);
+
+    bool isCacheEnabled() const { return fCacheEnabled; }
+
+    /** Turning caching off releases the cached raster. */
+    void setCacheEnabled(bool);
+
+    /** Marks the cached raster as stale, for when the picture was changed in place. */
+    void invalidate();
+
+    /** Returns true if the next draw at the same scale will use the cached raster. */
+    bool isCacheValid() const { return NULL != fCachedImage; }
+
+protected:
+    virtual void onDraw(SkCanvas*, SkScalar opacity) SK_OVERRIDE;
+
+private:
+    bool rasterize(SkCanvas*, SkScalar scale);
+
+    SkPicture*  fPicture;
+    SkImage*    fCachedImage;
+    SkScalar    fCachedScale;   // the device pixels per layer unit of fCachedImage
+    bool        fCacheEnabled;
+
+    typedef SkLayer INHERITED;
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkPicturePrefetcher.h"
+
+#include "SkGatherPixelRefsAndRects.h"
+#include "SkNoSaveLayerCanvas.h"
+#include "SkPicture.h"
+#include "SkPictureUtils.h"
+#include "SkPixelRef.h"
+#include "SkTSort.h"
+
+namespace {
+
+struct PrefetchEntry {
+    SkPixelRef* fPixelRef;
+    // Squared distance from the viewport; 0 for bitmaps drawn inside it.
+    SkScalar    fDistance;
+    // Draw order, to break ties.
+    int         fOrder;
+};
+
+struct PixelRefLessThan {
+    bool operator()(const PrefetchEntry& a, const PrefetchEntry& b) const {
+        if (a.fPixelRef != b.fPixelRef) {
+            return a.fPixelRef < b.fPixelRef;
+        }
+        return a.fDistance < b.fDistance || (a.fDistance == b.fDistance && a.fOrder < b.fOrder);
+    }
+};
+
+struct PriorityLessThan {
+    bool operator()(const PrefetchEntry& a, const PrefetchEntry& b) const {
+        return a.fDistance < b.fDistance || (a.fDistance == b.fDistance && a.fOrder < b.fOrder);
+    }
+};
+
+static SkScalar gap(SkScalar minA, SkScalar maxA, SkScalar minB, SkScalar maxB) {
+    if (maxA < minB) {
+        return minB - maxA;
+    }
+    if (maxB < minA) {
+        return minA - maxB;
+    }
+    return 0;
+}
+
+// Records every pixel ref with its distance from the viewport.
+class PrefetchList : public SkPictureUtils::SkPixelRefContainer {
+public:
+    explicit PrefetchList(const SkRect& viewport) : fViewport(viewport) {}
+
+    virtual void add(SkPixelRef* pr, const SkRect& rect) SK_OVERRIDE {
+        if (NULL == pr) {
+            return;
+        }
+        SkScalar dx = gap(rect.fLeft, rect.fRight, fViewport.fLeft, fViewport.fRight);
+        SkScalar dy = gap(rect.fTop, rect.fBottom, fViewport.fTop, fViewport.fBottom);
+        PrefetchEntry* entry = fEntries.append();
+        entry->fPixelRef = pr;
+        entry->fDistance = dx * dx + dy * dy;
+        entry->fOrder = fEntries.count();
+    }
+
+    virtual void query(const SkRect& queryRect, SkTDArray<SkPixelRef*>* result) SK_OVERRIDE {
+        SkDEBUGFAIL("the prefetcher reads the entries directly");
+    }
+
+    SkTDArray<PrefetchEntry>* entries() { return &fEntries; }
+
+private:
+    SkRect                      fViewport;
+    SkTDArray<PrefetchEntry>    fEntries;
+};
+
+} // namespace
+
+SkPicturePrefetcher::SkPicturePrefetcher(size_t byteLimit, SkTaskPool* pool)
+    : fByteLimit(byteLimit)
+    , fPool(NULL != pool ? pool : SkTaskPool::Global())
+    , fGroup(fPool)
+    , fNext(0) {
+}
+
+SkPicturePrefetcher::~SkPicturePrefetcher() {
+    this->cancel();
+}
+
+void SkPicturePrefetcher::prefetch(SkPicture* picture, const SkRect& viewport, SkScalar margin) {
+    if (0 == picture->width() || 0 == picture->height()) {
+        return;
+    }
+    SkRect area = viewport;
+    area.outset(margin, margin);
+    if (!area.intersect(SkRect::MakeWH(SkIntToScalar(picture->width()),
+                                       SkIntToScalar(picture->height())))) {
+        return;
+    }
+
+    // As in GatherPixelRefsAndRects(), but clipped to the area so that pictures with a bounding
+    // box hierarchy skip the ops outside it.
+    SkAutoTUnref<PrefetchList> list(SkNEW_ARGS(PrefetchList, (viewport)));
+    {
+        SkGatherPixelRefsAndRectsDevice device(picture->width(), picture->height(), list);
+        SkNoSaveLayerCanvas canvas(&device);
+        canvas.clipRect(area, SkRegion::kIntersect_Op, false);
+        canvas.drawPicture(*picture);
+    }
+
+    // Keep each pixel ref once, at its closest draw, then order them by that distance.
+    SkTDArray<PrefetchEntry>& entries = *list->entries();
+    if (entries.isEmpty()) {
+        return;
+    }
+    SkTQSort(entries.begin(), entries.end() - 1, PixelRefLessThan());
+    int unique = 0;
+    for (int i = 0; i < entries.count(); ++i) {
+        if (0 == unique || entries[i].fPixelRef != entries[unique - 1].fPixelRef) {
+            entries[unique++] = entries[i];
+        }
+    }
+    entries.setCount(unique);
+    SkTQSort(entries.begin(), entries.end() - 1, PriorityLessThan());
+
+    int queued;
+    {
+        SkAutoMutexAcquire am(fMutex);
+        this->clearQueue();
+        size_t bytes = 0;
+        for (int i = 0; i < entries.count(); ++i) {
+            SkPixelRef* pr = entries[i].fPixelRef;
+            const SkImageInfo& info = pr->info();
+            bytes += info.getSafeSize(info.minRowBytes());
+            if (0 != fByteLimit && bytes > fByteLimit && !fQueue.isEmpty()) {
+                break;
+            }
+            *fQueue.append() = SkRef(pr);
+        }
+        queued = fQueue.count();
+    }
+
+    // Each task decodes queued pixel refs until there are none left, so tasks still running from
+    // an earlier prefetch() go on with this queue.
+    int tasks = SkTMin(queued, SkTMax(fPool->threadCount(), 1));
+    for (int i = 0; i < tasks; ++i) {
+        fGroup.add(DecodeProc, this);
+    }
+}
+
+void SkPicturePrefetcher::cancel() {
+    {
+        SkAutoMutexAcquire am(fMutex);
+        this->clearQueue();
+    }
+    fGroup.wait();
+}
+
+void SkPicturePrefetcher::wait() {
+    fGroup.wait();
+}
+
+void SkPicturePrefetcher::clearQueue() {
+    for (int i = fNext; i < fQueue.count(); ++i) {
+        fQueue[i]->unref();
+    }
+    fQueue.rewind();
+    fNext = 0;
+}
+
+SkPixelRef* SkPicturePrefetcher::next() {
+    SkAutoMutexAcquire am(fMutex);
+    if (fNext >= fQueue.count()) {
+        return NULL;
+    }
+    return fQueue[fNext++];
+}
+
+void SkPicturePrefetcher::DecodeProc(void* data) {
+    SkPicturePrefetcher* prefetcher = static_cast<SkPicturePrefetcher*>(data);
+    while (SkPixelRef* pr = prefetcher->next()) {
+        // Locking decodes a lazy pixel ref; unlocking leaves the pixels in its discardable
+        // memory for playback to lock again. The lock count goes up even if the lock fails, so
+        // unlock either way.
+        pr->lockPixels();
+        pr->unlockPixels();
+        pr->unref();
+    }
+}
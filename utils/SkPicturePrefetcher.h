@@ -0,0 +1,73 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPicturePrefetcher_DEFINED
+#define SkPicturePrefetcher_DEFINED
+
+#include "SkRect.h"
+#include "SkTaskPool.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+
+class SkPicture;
+class SkPixelRef;
+
+/**
+ *  Decodes the lazily decoded bitmaps a picture draws in and around a viewport ahead of playback,
+ *  so that playback finds them resident instead of decoding them synchronously.
+ *
+ *  The pixel refs are found with the same device as SkPictureUtils::GatherPixelRefsAndRects(),
+ *  and are locked and unlocked on worker threads, closest to the viewport first. For an
+ *  SkDiscardablePixelRef that decodes the pixels into its discardable memory (e.g. the global
+ *  SkDiscardableMemoryPool), where they stay until the pool needs the room. Pixel refs that are
+ *  already resident cost no more than a lock.
+ */
+class SkPicturePrefetcher : SkNoncopyable {
+public:
+    /**
+     *  byteLimit caps the pixels decoded by one prefetch(); beyond it the farthest bitmaps would
+     *  only push the nearest ones out of the discardable pool. 0 means no limit. The decodes run
+     *  on pool, or on SkTaskPool::Global() if it is NULL.
+     */
+    explicit SkPicturePrefetcher(size_t byteLimit = 0, SkTaskPool* pool = NULL);
+
+    /** Calls cancel(). */
+    ~SkPicturePrefetcher();
+
+    /**
+     *  Queues the pixel refs picture draws within margin of viewport, which is in the picture's
+     *  coordinates, those that intersect it first. Replaces whatever an earlier prefetch() has
+     *  not started decoding yet, so it can be called again each time the viewport moves.
+     */
+    void prefetch(SkPicture* picture, const SkRect& viewport, SkScalar margin);
+
+    /** Drops the queued decodes and waits for those already started. */
+    void cancel();
+
+    /** Waits for every queued decode. */
+    void wait();
+
+private:
+    static void DecodeProc(void* prefetcher);
+
+    // Hands out the next pixel ref to decode, which the caller must unref, or returns NULL.
+    SkPixelRef* next();
+
+    // Unrefs the pixel refs not handed out yet. Caller must hold fMutex.
+    void clearQueue();
+
+    const size_t            fByteLimit;
+    SkTaskPool* const       fPool;
+    SkTaskGroup             fGroup;
+
+    SkMutex                 fMutex;
+    // Owns a ref on each of fQueue[fNext..count).
+    SkTDArray<SkPixelRef*>  fQueue;
+    int                     fNext;
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkReadAheadStream.h"
+#include "SkStream.h"
+#include "SkTaskPool.h"
+#include "SkTemplates.h"
+
+class ReadAheadStream : public SkStreamRewindable {
+public:
+    // Called by Create.
+    ReadAheadStream(SkStream*, size_t rewindSize, size_t blockSize, SkTaskPool*);
+
+    virtual ~ReadAheadStream();
+
+    virtual size_t read(void* buffer, size_t size) SK_OVERRIDE;
+
+    virtual bool isAtEnd() const SK_OVERRIDE;
+
+    virtual bool rewind() SK_OVERRIDE;
+
+    virtual bool hasPosition() const SK_OVERRIDE { return true; }
+
+    virtual size_t getPosition() const SK_OVERRIDE { return fOffset; }
+
+    virtual bool hasLength() const SK_OVERRIDE { return fHasLength; }
+
+    virtual size_t getLength() const SK_OVERRIDE { return fLength; }
+
+    virtual SkStreamRewindable* duplicate() const SK_OVERRIDE { return NULL; }
+
+private:
+    static void ReadAheadProc(void* stream);
+
+    char* block(int index) const { return fBlocks.get() + index * fBlockSize; }
+
+    // Reads the next block from fStream into the block after fCurrent. Runs in fGroup.
+    void readAhead();
+
+    // Queues readAhead(), unless fStream has ended.
+    void startReadAhead();
+
+    // Waits for the read ahead and makes its block the current one. Returns false at the end of
+    // fStream.
+    bool nextBlock() const;
+
+    SkAutoTUnref<SkStream>  fStream;
+    const bool              fHasLength;
+    const size_t            fLength;
+    const size_t            fRewindSize;
+    const size_t            fBlockSize;
+
+    // Current offset into the stream.
+    size_t                  fOffset;
+    // Bytes of fStream handed out by the blocks so far. Those below fRewindSize are in fFront,
+    // and are read from there again after a rewind until fOffset catches up.
+    size_t                  fConsumed;
+    SkAutoTMalloc<char>     fFront;
+
+    // Two blocks: the one being read from, block(fCurrent)[fBlockPos..fBlockLength), and the
+    // one being read ahead into, which only readAhead() touches while fReadingAhead.
+    SkAutoTMalloc<char>     fBlocks;
+    mutable int             fCurrent;
+    mutable size_t          fBlockPos;
+    mutable size_t          fBlockLength;
+    mutable size_t          fNextLength;
+    mutable bool            fReadingAhead;
+    bool                    fSourceAtEnd;   // set by readAhead()
+
+    mutable SkTaskGroup     fGroup;
+
+    typedef SkStreamRewindable INHERITED;
+};
+
+SkStreamRewindable* SkReadAheadStream::Create(SkStream* stream, size_t rewindSize,
+                                              size_t blockSize, SkTaskPool* pool) {
+    if (NULL == stream) {
+        return NULL;
+    }
+    return SkNEW_ARGS(ReadAheadStream, (stream, rewindSize, SkTMax<size_t>(blockSize, 1), pool));
+}
+
+ReadAheadStream::ReadAheadStream(SkStream* stream, size_t rewindSize, size_t blockSize,
+                                 SkTaskPool* pool)
+    : fStream(SkRef(stream))
+    , fHasLength(stream->hasPosition() && stream->hasLength())
+    , fLength(stream->getLength() - stream->getPosition())
+    , fRewindSize(rewindSize)
+    , fBlockSize(blockSize)
+    , fOffset(0)
+    , fConsumed(0)
+    , fFront(rewindSize)
+    , fBlocks(2 * blockSize)
+    , fCurrent(0)
+    , fBlockPos(0)
+    , fBlockLength(0)
+    , fNextLength(0)
+    , fReadingAhead(false)
+    , fSourceAtEnd(false)
+    , fGroup(pool) {
+    // Start on the first block right away; the decoder will want it.
+    this->startReadAhead();
+}
+
+ReadAheadStream::~ReadAheadStream() {
+    // fStream and the next block may still be in use.
+    fGroup.wait();
+}
+
+void ReadAheadStream::ReadAheadProc(void* stream) {
+    static_cast<ReadAheadStream*>(stream)->readAhead();
+}
+
+void ReadAheadStream::readAhead() {
+    fNextLength = fStream->read(this->block(1 - fCurrent), fBlockSize);
+    fSourceAtEnd = 0 == fNextLength || fStream->isAtEnd();
+}
+
+void ReadAheadStream::startReadAhead() {
+    SkASSERT(!fReadingAhead);
+    if (!fSourceAtEnd) {
+        fReadingAhead = true;
+        fGroup.add(ReadAheadProc, this);
+    }
+}
+
+bool ReadAheadStream::nextBlock() const {
+    SkASSERT(fBlockPos == fBlockLength);
+    if (!fReadingAhead) {
+        return false;
+    }
+    fGroup.wait();
+    fReadingAhead = false;
+
+    fCurrent = 1 - fCurrent;
+    fBlockPos = 0;
+    fBlockLength = fNextLength;
+    // Reading on while the caller takes this block is the point of this stream.
+    const_cast<ReadAheadStream*>(this)->startReadAhead();
+    return fBlockLength > 0;
+}
+
+bool ReadAheadStream::isAtEnd() const {
+    if (fOffset < fConsumed || fBlockPos < fBlockLength) {
+        return false;
+    }
+    // Whether there is more depends on what the read ahead finds.
+    return !this->nextBlock();
+}
+
+bool ReadAheadStream::rewind() {
+    // Only allow a rewind if everything handed out so far is in fFront.
+    if (fConsumed <= fRewindSize) {
+        fOffset = 0;
+        return true;
+    }
+    return false;
+}
+
+size_t ReadAheadStream::read(void* voidDst, size_t size) {
+    char* dst = reinterpret_cast<char*>(voidDst);
+    const size_t start = fOffset;
+
+    // First, read again whatever was handed out before a rewind.
+    if (fOffset < fConsumed && size > 0) {
+        SkASSERT(fConsumed <= fRewindSize);
+        const size_t bytesToCopy = SkTMin(size, fConsumed - fOffset);
+        if (NULL != dst) {
+            memcpy(dst, fFront + fOffset, bytesToCopy);
+            dst += bytesToCopy;
+        }
+        fOffset += bytesToCopy;
+        size -= bytesToCopy;
+    }
+
+    // Then take the rest from the blocks, keeping what falls within fRewindSize.
+    while (size > 0) {
+        if (fBlockPos == fBlockLength && !this->nextBlock()) {
+            break;
+        }
+        const size_t bytesToCopy = SkTMin(size, fBlockLength - fBlockPos);
+        const char* src = this->block(fCurrent) + fBlockPos;
+        if (fConsumed < fRewindSize) {
+            const size_t bytesToKeep = SkTMin(bytesToCopy, fRewindSize - fConsumed);
+            memcpy(fFront + fConsumed, src, bytesToKeep);
+        }
+        if (NULL != dst) {
+            memcpy(dst, src, bytesToCopy);
+            dst += bytesToCopy;
+        }
+        fBlockPos += bytesToCopy;
+        fConsumed += bytesToCopy;
+        fOffset += bytesToCopy;
+        size -= bytesToCopy;
+    }
+
+    // Past fRewindSize, rewinding is no longer supported, so free the memory.
+    if (fConsumed > fRewindSize && NULL != fFront.get()) {
+        fFront.reset(0);
+    }
+
+    return fOffset - start;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkReadAheadStream_DEFINED
+#define SkReadAheadStream_DEFINED
+
+#include "SkTypes.h"
+
+class SkStream;
+class SkStreamRewindable;
+class SkTaskPool;
+
+/**
+ *  Specialized stream that reads its source a block at a time ahead of its reader, for sources
+ *  such as network streams where each read is slow but many small reads (as decoders make) cost
+ *  no more than one large one. While the reader consumes one block, the next is read on a worker
+ *  thread.
+ *
+ *  Like SkFrontBufferedStream, it keeps the first rewindSize bytes, so it can be rewound until
+ *  more than that has been read, as SkImageDecoder::Factory needs to sniff the format.
+ */
+class SkReadAheadStream {
+public:
+    enum {
+        kDefaultBlockSize = 32 * 1024
+    };
+
+    /**
+     *  Creates a new stream that wraps and refs stream and reads it in blocks of blockSize
+     *  bytes. The reads run on pool, or on SkTaskPool::Global() if it is NULL; stream is only
+     *  read by one thread at a time, but not always the same one.
+     *
+     *  @param stream SkStream to buffer. If NULL, NULL is returned. After this call, unref
+     *      stream and do not refer to it; it is read ahead of what the new stream returns.
+     *  @param rewindSize Number of bytes at the start that can be read again after rewind().
+     *  @param blockSize Number of bytes to read from stream at once.
+     *  @return SkStreamRewindable that reads ahead of its reader.
+     */
+    static SkStreamRewindable* Create(SkStream* stream, size_t rewindSize,
+                                      size_t blockSize = kDefaultBlockSize,
+                                      SkTaskPool* pool = NULL);
+};
+
+#endif
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkRingBufferEventTracer.h"
+
+#include "SkMath.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTemplates.h"
+#include "SkTLS.h"
+#include "SkTraceEvent.h"
+
+#if defined(SK_BUILD_FOR_WIN32)
+    #include <windows.h>
+#elif defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    #include <mach/mach_time.h>
+#else
+    #include <time.h>
+#endif
+
+static uint64_t now_nanos() {
+#if defined(SK_BUILD_FOR_WIN32)
+    static LARGE_INTEGER gFrequency;
+    if (0 == gFrequency.QuadPart) {
+        QueryPerformanceFrequency(&gFrequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart * (1e9 / gFrequency.QuadPart));
+#elif defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    static mach_timebase_info_data_t gTimebase;
+    if (0 == gTimebase.denom) {
+        mach_timebase_info(&gTimebase);
+    }
+    return mach_absolute_time() * gTimebase.numer / gTimebase.denom;
+#else
+    // On Linux and Android this is a vDSO call, with no trip into the kernel.
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+struct SkRingBufferEventTracer::Event {
+    uint64_t        fStartNanos;
+    uint64_t        fDurationNanos;     // only for TRACE_EVENT_PHASE_COMPLETE
+    uint64_t        fID;
+    const char*     fName;
+    const uint8_t*  fCategoryEnabledFlag;
+    const char*     fArgNames[kMaxArgs];
+    uint64_t        fArgValues[kMaxArgs];
+    uint8_t         fArgTypes[kMaxArgs];
+    uint8_t         fNumArgs;
+    uint8_t         fFlags;
+    char            fPhase;
+};
+
+/**
+ *  Only its thread writes a buffer. An event is filled in before sk_atomic_inc, a full barrier
+ *  on every port, counts it in fWritten; a reader copies an event and then checks that the
+ *  writer has not come round to its slot again.
+ */
+struct SkRingBufferEventTracer::ThreadBuffer {
+    ThreadBuffer(int threadID, int capacity)
+        : fThreadID(threadID)
+        , fEvents(capacity)
+        , fWritten(0) {}
+
+    const int                  fThreadID;
+    SkAutoTMalloc<Event>       fEvents;
+    int32_t                    fWritten;   // events ever written; may wrap
+};
+
+namespace {
+
+// What each thread keeps in TLS: its buffer for the tracer with fGeneration. The buffer is
+// owned by the tracer, so a thread that exits leaves its last events to be dumped.
+struct ThreadSlot {
+    int32_t fGeneration;
+    void*   fBuffer;
+};
+
+void* create_thread_slot() {
+    ThreadSlot* slot = SkNEW(ThreadSlot);
+    slot->fGeneration = 0;
+    slot->fBuffer = NULL;
+    return slot;
+}
+
+void delete_thread_slot(void* slot) {
+    SkDELETE(static_cast<ThreadSlot*>(slot));
+}
+
+int32_t gTracerGeneration = 0;
+
+const char kDisabledByDefaultPrefix[] = "disabled-by-default-";
+
+void append_json_string(SkString* json, const char* str) {
+    json->append("\"");
+    for (; *str; ++str) {
+        const char c = *str;
+        if ('"' == c || '\\' == c) {
+            json->appendf("\\%c", c);
+        } else if ((unsigned char) c < 0x20) {
+            json->appendf("\\u%04x", c);
+        } else {
+            json->append(&c, 1);
+        }
+    }
+    json->append("\"");
+}
+
+void append_json_arg(SkString* json, uint8_t type, uint64_t value) {
+    union {
+        uint64_t    fUint;
+        int64_t     fInt;
+        double      fDouble;
+        const char* fString;
+    } arg;
+    arg.fUint = value;
+    switch (type) {
+        case TRACE_VALUE_TYPE_BOOL:
+            json->append(value ? "true" : "false");
+            break;
+        case TRACE_VALUE_TYPE_UINT:
+            json->appendU64(arg.fUint);
+            break;
+        case TRACE_VALUE_TYPE_INT:
+            json->appendS64(arg.fInt);
+            break;
+        case TRACE_VALUE_TYPE_DOUBLE:
+            json->appendf("%g", arg.fDouble);
+            break;
+        case TRACE_VALUE_TYPE_POINTER:
+            json->appendf("\"0x%llx\"", (unsigned long long) arg.fUint);
+            break;
+        case TRACE_VALUE_TYPE_STRING:
+            append_json_string(json, NULL != arg.fString ? arg.fString : "");
+            break;
+        default:
+            // Copied strings and convertables didn't outlive the call that recorded them.
+            json->append("null");
+            break;
+    }
+}
+
+}  // namespace
+
+SkRingBufferEventTracer::SkRingBufferEventTracer(int eventsPerThread)
+    : fGeneration(sk_atomic_inc(&gTracerGeneration) + 1)
+    , fMask(SkNextPow2(SkMax32(eventsPerThread, 2)) - 1)
+    , fStartNanos(now_nanos())
+    , fCategoryCount(0) {
+    fCategoryEnabled[kMaxCategories] = 0;
+    fCategoryNames[kMaxCategories] = "overflow";
+}
+
+SkRingBufferEventTracer::~SkRingBufferEventTracer() {
+    fBuffers.deleteAll();
+}
+
+SkRingBufferEventTracer::ThreadBuffer* SkRingBufferEventTracer::threadBuffer() {
+    ThreadSlot* slot = static_cast<ThreadSlot*>(SkTLS::Get(create_thread_slot,
+                                                           delete_thread_slot));
+    if (slot->fGeneration != fGeneration) {
+        SkAutoMutexAcquire ama(fMutex);
+        ThreadBuffer* buffer = SkNEW_ARGS(ThreadBuffer, (fBuffers.count(), fMask + 1));
+        *fBuffers.append() = buffer;
+        slot->fBuffer = buffer;
+        slot->fGeneration = fGeneration;
+    }
+    return static_cast<ThreadBuffer*>(slot->fBuffer);
+}
+
+SkEventTracer::Handle SkRingBufferEventTracer::addTraceEvent(char phase,
+                                                             const uint8_t* categoryEnabledFlag,
+                                                             const char* name,
+                                                             uint64_t id,
+                                                             int numArgs,
+                                                             const char** argNames,
+                                                             const uint8_t* argTypes,
+                                                             const uint64_t* argValues,
+                                                             uint8_t flags) {
+    ThreadBuffer* buffer = this->threadBuffer();
+    const int32_t index = buffer->fWritten;
+    Event& event = buffer->fEvents[index & fMask];
+    event.fStartNanos = now_nanos();
+    event.fDurationNanos = 0;
+    event.fID = id;
+    event.fName = name;
+    event.fCategoryEnabledFlag = categoryEnabledFlag;
+    event.fNumArgs = SkToU8(SkMin32(numArgs, kMaxArgs));
+    for (int i = 0; i < event.fNumArgs; ++i) {
+        event.fArgNames[i] = argNames[i];
+        event.fArgTypes[i] = argTypes[i];
+        event.fArgValues[i] = argValues[i];
+    }
+    event.fFlags = flags;
+    event.fPhase = phase;
+    sk_atomic_inc(&buffer->fWritten);
+    // 0 is no event.
+    return (uint32_t) index + 1;
+}
+
+void SkRingBufferEventTracer::updateTraceEventDuration(const uint8_t* categoryEnabledFlag,
+                                                       const char* name,
+                                                       SkEventTracer::Handle handle) {
+    if (0 == handle) {
+        return;
+    }
+    // The scoped event ends on the thread that began it.
+    ThreadBuffer* buffer = this->threadBuffer();
+    const uint32_t index = (uint32_t) (handle - 1);
+    if ((uint32_t) buffer->fWritten - index > fMask + 1) {
+        return;  // overwritten by later events
+    }
+    Event& event = buffer->fEvents[index & fMask];
+    event.fDurationNanos = now_nanos() - event.fStartNanos;
+}
+
+const uint8_t* SkRingBufferEventTracer::getCategoryGroupEnabled(const char* name) {
+    // The TRACE_EVENT macros cache the result, so this runs once per call site.
+    SkAutoMutexAcquire ama(fMutex);
+    for (int i = 0; i < fCategoryCount; ++i) {
+        if (0 == strcmp(fCategoryNames[i], name)) {
+            return &fCategoryEnabled[i];
+        }
+    }
+    if (fCategoryCount == kMaxCategories) {
+        return &fCategoryEnabled[kMaxCategories];
+    }
+    const int index = fCategoryCount;
+    fCategoryNames[index] = name;
+    fCategoryEnabled[index] =
+            0 == strncmp(name, kDisabledByDefaultPrefix, sizeof(kDisabledByDefaultPrefix) - 1)
+            ? 0 : kEnabledForRecording_CategoryGroupEnabledFlags;
+    ++fCategoryCount;
+    return &fCategoryEnabled[index];
+}
+
+const char* SkRingBufferEventTracer::getCategoryGroupName(const uint8_t* categoryEnabledFlag) {
+    const ptrdiff_t index = categoryEnabledFlag - fCategoryEnabled;
+    SkASSERT(index >= 0 && index <= kMaxCategories);
+    return fCategoryNames[index];
+}
+
+bool SkRingBufferEventTracer::writeJSON(SkWStream* stream) const {
+    // Only for the lists of buffers and categories; their threads record as usual.
+    SkAutoMutexAcquire ama(fMutex);
+    const uint32_t capacity = fMask + 1;
+
+    bool first = true;
+    if (!stream->writeText("{\"traceEvents\":[")) {
+        return false;
+    }
+    for (int b = 0; b < fBuffers.count(); ++b) {
+        ThreadBuffer* buffer = fBuffers[b];
+        const uint32_t written = sk_atomic_add(&buffer->fWritten, 0);
+        const uint32_t count = SkTMin(written, capacity);
+        for (uint32_t index = written - count; index != written; ++index) {
+            const Event event = buffer->fEvents[index & fMask];
+            if ((uint32_t) sk_atomic_add(&buffer->fWritten, 0) - index >= capacity) {
+                continue;  // the writer has come round to this slot again
+            }
+
+            SkString json;
+            json.append(first ? "\n" : ",\n");
+            json.append("{\"ph\":\"");
+            json.append(&event.fPhase, 1);
+            json.append("\",\"name\":");
+            append_json_string(&json, event.fName);
+            json.append(",\"cat\":");
+            append_json_string(&json,
+                               fCategoryNames[event.fCategoryEnabledFlag - fCategoryEnabled]);
+            json.appendf(",\"pid\":0,\"tid\":%d,\"ts\":%.3f", buffer->fThreadID,
+                         (event.fStartNanos - fStartNanos) * 1e-3);
+            if (TRACE_EVENT_PHASE_COMPLETE == event.fPhase) {
+                json.appendf(",\"dur\":%.3f", event.fDurationNanos * 1e-3);
+            }
+            if (event.fFlags & TRACE_EVENT_FLAG_HAS_ID) {
+                json.appendf(",\"id\":\"0x%llx\"", (unsigned long long) event.fID);
+            }
+            if (event.fNumArgs > 0) {
+                json.append(",\"args\":{");
+                for (int i = 0; i < event.fNumArgs; ++i) {
+                    if (i > 0) {
+                        json.append(",");
+                    }
+                    append_json_string(&json, event.fArgNames[i]);
+                    json.append(":");
+                    append_json_arg(&json, event.fArgTypes[i], event.fArgValues[i]);
+                }
+                json.append("}");
+            }
+            json.append("}");
+            if (!stream->write(json.c_str(), json.size())) {
+                return false;
+            }
+            first = false;
+        }
+    }
+    return stream->writeText("\n]}\n");
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRingBufferEventTracer_DEFINED
+#define SkRingBufferEventTracer_DEFINED
+
+#include "SkEventTracer.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+
+class SkWStream;
+
+/**
+ *  An SkEventTracer cheap enough to leave installed in production. Each thread records its
+ *  events into a ring buffer of its own, so recording takes no lock and only touches memory of
+ *  the recording thread; the ring keeps the most recent events and overwrites older ones.
+ *  Install it with SkEventTracer::SetInstance() before the first trace event.
+ *
+ *  Every category is enabled, except the "disabled-by-default-" ones. Names, categories and
+ *  string arguments are kept as pointers, as the TRACE_EVENT macros pass string literals;
+ *  TRACE_STR_COPY values are not kept.
+ */
+class SkRingBufferEventTracer : public SkEventTracer {
+public:
+    /** eventsPerThread is rounded up to a power of two. */
+    explicit SkRingBufferEventTracer(int eventsPerThread = 8192);
+    virtual ~SkRingBufferEventTracer();
+
+    /**
+     *  Writes the events still held in every thread's ring as Chrome trace JSON, which
+     *  about:tracing can load. Threads may go on recording while it runs; events overwritten
+     *  while they were being read are left out.
+     */
+    bool writeJSON(SkWStream*) const;
+
+    virtual SkEventTracer::Handle addTraceEvent(char phase,
+                                                const uint8_t* categoryEnabledFlag,
+                                                const char* name,
+                                                uint64_t id,
+                                                int numArgs,
+                                                const char** argNames,
+                                                const uint8_t* argTypes,
+                                                const uint64_t* argValues,
+                                                uint8_t flags) SK_OVERRIDE;
+
+    virtual void updateTraceEventDuration(const uint8_t* categoryEnabledFlag,
+                                          const char* name,
+                                          SkEventTracer::Handle) SK_OVERRIDE;
+
+    virtual const uint8_t* getCategoryGroupEnabled(const char* name) SK_OVERRIDE;
+    virtual const char* getCategoryGroupName(const uint8_t* categoryEnabledFlag) SK_OVERRIDE;
+
+private:
+    struct Event;
+    struct ThreadBuffer;
+
+    enum {
+        kMaxArgs = 2,
+        kMaxCategories = 64
+    };
+
+    ThreadBuffer* threadBuffer();
+
+    const int32_t fGeneration;
+    const uint32_t fMask;
+    const uint64_t fStartNanos;
+
+    mutable SkMutex fMutex;  // guards adding threads and categories, never recording
+    SkTDArray<ThreadBuffer*> fBuffers;
+
+    uint8_t fCategoryEnabled[kMaxCategories + 1];  // the last one is for any overflow
+    const char* fCategoryNames[kMaxCategories + 1];
+    int fCategoryCount;
+};
+
+#endif
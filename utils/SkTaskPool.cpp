@@ -0,0 +1,263 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTaskPool.h"
+
+#include "SkOnce.h"
+#include "SkTLS.h"
+#include "SkThreadUtils.h"
+
+#if defined(SK_BUILD_FOR_WIN32)
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace {
+
+// Which pool's worker, if any, is running on this thread.
+struct ThreadWorker {
+    const SkTaskPool* fPool;
+    int fIndex;
+};
+
+void* create_thread_worker() {
+    ThreadWorker* worker = SkNEW(ThreadWorker);
+    worker->fPool = NULL;
+    worker->fIndex = -1;
+    return worker;
+}
+
+void delete_thread_worker(void* worker) {
+    SkDELETE(static_cast<ThreadWorker*>(worker));
+}
+
+int num_cores() {
+#if defined(SK_BUILD_FOR_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    return (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    return 1;
+#endif
+}
+
+SkTaskPool* gGlobalPool = NULL;
+
+void create_global_pool(int) {
+    SkASSERT(NULL == gGlobalPool);
+    gGlobalPool = SkNEW_ARGS(SkTaskPool, (num_cores() - 1));
+}
+
+void run_runnable(void* runnable) {
+    static_cast<SkRunnable*>(runnable)->run();
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkTaskPool::Deque::pushBack(const Task& task) {
+    SkAutoMutexAcquire lock(fMutex);
+    *fTasks.append() = task;
+}
+
+bool SkTaskPool::Deque::popBack(Task* task) {
+    SkAutoMutexAcquire lock(fMutex);
+    if (fHead == fTasks.count()) {
+        return false;
+    }
+    fTasks.pop(task);
+    if (fHead == fTasks.count()) {
+        fTasks.rewind();
+        fHead = 0;
+    }
+    return true;
+}
+
+bool SkTaskPool::Deque::popFront(Task* task) {
+    SkAutoMutexAcquire lock(fMutex);
+    if (fHead == fTasks.count()) {
+        return false;
+    }
+    *task = fTasks[fHead++];
+    if (fHead == fTasks.count()) {
+        fTasks.rewind();
+        fHead = 0;
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkTaskPool::SkTaskPool(int threadCount)
+    : fPendingCount(0)
+    , fDone(false) {
+    threadCount = SkMax32(threadCount, 0);
+    fDequeCount = threadCount + 1;
+    fDeques = SkNEW_ARRAY(Deque, fDequeCount);
+
+    // fWorkers must not move once the threads have pointers into it.
+    fWorkers.setCount(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        fWorkers[i].fPool = this;
+        fWorkers[i].fIndex = i;
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        SkThread* thread = SkNEW_ARGS(SkThread, (SkTaskPool::WorkerMain, &fWorkers[i]));
+        if (!thread->start()) {
+            SkDELETE(thread);
+            break;
+        }
+        *fThreads.append() = thread;
+    }
+}
+
+SkTaskPool::~SkTaskPool() {
+    fCondVar.lock();
+    fDone = true;
+    fCondVar.broadcast();
+    fCondVar.unlock();
+
+    for (int i = 0; i < fThreads.count(); ++i) {
+        fThreads[i]->join();
+        SkDELETE(fThreads[i]);
+    }
+    // Without workers (or if none could start) nobody has run these yet.
+    Task task;
+    while (this->take(-1, &task)) {
+        this->run(task);
+    }
+    SkDELETE_ARRAY(fDeques);
+}
+
+SkTaskPool* SkTaskPool::Global() {
+    SK_DECLARE_STATIC_ONCE(once);
+    SkOnce(&once, create_global_pool, 0);
+    SkASSERT(NULL != gGlobalPool);
+    return gGlobalPool;
+}
+
+int SkTaskPool::currentWorker() const {
+    const ThreadWorker* worker = (const ThreadWorker*)SkTLS::Find(create_thread_worker);
+    return NULL != worker && this == worker->fPool ? worker->fIndex : -1;
+}
+
+void SkTaskPool::add(Proc proc, void* arg, SkTaskGroup* group) {
+    Task task = { proc, arg, group };
+    sk_atomic_inc(&group->fPendingCount);
+
+    // Only workers that started have a deque anyone looks at.
+    const int index = this->currentWorker();
+    if (index >= 0 && index < fThreads.count()) {
+        fDeques[index].pushBack(task);
+    } else {
+        fDeques[fDequeCount - 1].pushBack(task);
+    }
+
+    fCondVar.lock();
+    sk_atomic_inc(&fPendingCount);
+    fCondVar.broadcast();
+    fCondVar.unlock();
+}
+
+bool SkTaskPool::take(int index, Task* task) {
+    const int shared = fDequeCount - 1;
+    if (index >= 0 && fDeques[index].popBack(task)) {
+        sk_atomic_dec(&fPendingCount);
+        return true;
+    }
+    if (fDeques[shared].popFront(task)) {
+        sk_atomic_dec(&fPendingCount);
+        return true;
+    }
+    // Start stealing just past ourselves, so thieves spread out.
+    for (int i = 1; i <= shared; ++i) {
+        const int victim = (index + i + shared) % shared;
+        if (victim != index && fDeques[victim].popFront(task)) {
+            sk_atomic_dec(&fPendingCount);
+            return true;
+        }
+    }
+    return false;
+}
+
+void SkTaskPool::run(const Task& task) {
+    task.fProc(task.fArg);
+    SkTaskGroup* group = task.fGroup;
+    if (1 == sk_atomic_dec(&group->fPendingCount)) {
+        // The group may be destroyed as soon as a waiter sees it finish, so
+        // it must not be touched after this.
+        fCondVar.lock();
+        fCondVar.broadcast();
+        fCondVar.unlock();
+    }
+}
+
+void SkTaskPool::WorkerMain(void* data) {
+    Worker* worker = static_cast<Worker*>(data);
+    ThreadWorker* tls = (ThreadWorker*)SkTLS::Get(create_thread_worker, delete_thread_worker);
+    tls->fPool = worker->fPool;
+    tls->fIndex = worker->fIndex;
+    worker->fPool->work(worker->fIndex);
+    SkTLS::Delete(create_thread_worker);
+}
+
+void SkTaskPool::work(int index) {
+    for (;;) {
+        Task task;
+        if (this->take(index, &task)) {
+            this->run(task);
+            continue;
+        }
+        fCondVar.lock();
+        while (!fDone && 0 == fPendingCount) {
+            fCondVar.wait();
+        }
+        const bool done = fDone && 0 == fPendingCount;
+        fCondVar.unlock();
+        if (done) {
+            return;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkTaskGroup::SkTaskGroup(SkTaskPool* pool)
+    : fPool(NULL != pool ? pool : SkTaskPool::Global())
+    , fPendingCount(0) {
+}
+
+void SkTaskGroup::add(SkRunnable* runnable) {
+    fPool->add(run_runnable, runnable, this);
+}
+
+void SkTaskGroup::add(void (*proc)(void*), void* arg) {
+    fPool->add(proc, arg, this);
+}
+
+void SkTaskGroup::wait() {
+    const int index = fPool->currentWorker();
+    while (!sk_atomic_cas(&fPendingCount, 0, 0)) {
+        // Help rather than block, which also keeps a worker that waits on a
+        // nested group from deadlocking a small pool.
+        SkTaskPool::Task task;
+        if (fPool->take(index, &task)) {
+            fPool->run(task);
+            continue;
+        }
+        // Everything left is already running on other threads.
+        fPool->fCondVar.lock();
+        while (0 != fPendingCount && 0 == fPool->fPendingCount) {
+            fPool->fCondVar.wait();
+        }
+        fPool->fCondVar.unlock();
+    }
+}
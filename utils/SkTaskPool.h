@@ -0,0 +1,136 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTaskPool_DEFINED
+#define SkTaskPool_DEFINED
+
+#include "SkCondVar.h"
+#include "SkRunnable.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+
+class SkTaskGroup;
+class SkThread;
+
+/**
+ *  A pool of worker threads shared by everything that wants to run work in
+ *  parallel. Tasks are added through an SkTaskGroup.
+ *
+ *  Each worker has its own deque of tasks. A task added from a worker goes on
+ *  the back of that worker's deque and the worker takes its own tasks from the
+ *  back, so nested work stays on the thread that made it while its data is
+ *  still in cache. Tasks added from any other thread go on a shared deque.
+ *  An idle worker takes from the front of the shared deque and then steals
+ *  from the front of the other workers' deques before it sleeps.
+ */
+class SkTaskPool : SkNoncopyable {
+public:
+    /** Create a pool of threadCount workers. If threadCount is <= 0, tasks
+     *  are run by the threads that wait on their groups.
+     */
+    explicit SkTaskPool(int threadCount);
+
+    /** Runs every task still queued, then stops the workers. */
+    ~SkTaskPool();
+
+    int threadCount() const { return fThreads.count(); }
+
+    /** The pool used by SkTaskGroups that don't name one. It is created on
+     *  first use with one worker per core, less one for the calling thread.
+     */
+    static SkTaskPool* Global();
+
+private:
+    friend class SkTaskGroup;
+
+    typedef void (*Proc)(void*);
+
+    struct Task {
+        Proc         fProc;
+        void*        fArg;
+        SkTaskGroup* fGroup;
+    };
+
+    // A deque guarded by its own mutex, so the owner and thieves only
+    // contend when they hit the same deque at the same time.
+    class Deque {
+    public:
+        Deque() : fHead(0) {}
+
+        void pushBack(const Task&);
+        bool popBack(Task*);
+        bool popFront(Task*);
+
+    private:
+        SkMutex         fMutex;
+        SkTDArray<Task> fTasks;
+        int             fHead;  // fTasks[0..fHead) have been stolen
+    };
+
+    struct Worker {
+        SkTaskPool* fPool;
+        int         fIndex;
+    };
+
+    void add(Proc proc, void* arg, SkTaskGroup* group);
+
+    // Takes a task for the calling thread, which is worker index or, if
+    // index is negative, not one of our workers.
+    bool take(int index, Task* task);
+    void run(const Task& task);
+
+    // Index of the calling thread's worker, or -1.
+    int currentWorker() const;
+
+    static void WorkerMain(void* worker);
+    void work(int index);
+
+    SkTDArray<SkThread*> fThreads;
+    SkTDArray<Worker>    fWorkers;
+    // One deque per worker, then the shared deque.
+    Deque*               fDeques;
+    int                  fDequeCount;
+
+    // Tasks in any deque. Only incremented with fCondVar locked, so that a
+    // thread that saw none before waiting is always woken.
+    int32_t              fPendingCount;
+    // Broadcast when a task is added, when a group finishes and on shutdown.
+    SkCondVar            fCondVar;
+    bool                 fDone;
+};
+
+/**
+ *  A set of tasks to run on an SkTaskPool, which can be waited on together.
+ *  Tasks may add more tasks to their own group, or to others.
+ */
+class SkTaskGroup : SkNoncopyable {
+public:
+    /** Run tasks on pool, or on SkTaskPool::Global() if pool is NULL. */
+    explicit SkTaskGroup(SkTaskPool* pool = NULL);
+
+    /** Waits for every task in the group. */
+    ~SkTaskGroup() { this->wait(); }
+
+    /** Queue runnable, which is not owned and must outlive the task. */
+    void add(SkRunnable* runnable);
+
+    /** Queue a call to proc(arg). */
+    void add(void (*proc)(void*), void* arg);
+
+    /** Returns once every task added so far, and every task they added, has
+     *  run. While waiting, the calling thread runs queued tasks itself.
+     */
+    void wait();
+
+private:
+    friend class SkTaskPool;
+
+    SkTaskPool* fPool;
+    int32_t     fPendingCount;
+};
+
+#endif
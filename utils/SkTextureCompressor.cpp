@@ -0,0 +1,181 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTextureCompressor.h"
+
+#include "SkBitmap.h"
+#include "SkData.h"
+
+namespace {
+
+// LATC blocks hold two endpoints and a 3 bit index into an eight entry palette for each of the
+// 16 pixels. When the first endpoint is the larger, the palette is the endpoints and six values
+// spaced evenly between them. Otherwise it is the endpoints, four values between them, 0 and 255,
+// which suits the edges of masks, where fully covered and empty pixels meet partial ones.
+enum {
+    kLATCBlockDim = 4,
+    kLATCBlockPixels = kLATCBlockDim * kLATCBlockDim,
+    kLATCBlockSize = 8,
+};
+
+void make_latc_palette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        }
+    } else {
+        for (int i = 1; i < 5; ++i) {
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// Picks the nearest palette entry for each pixel. Returns the indices packed as they are stored,
+// the first pixel in the low bits, and the total error.
+uint64_t index_latc_block(const uint8_t pixels[kLATCBlockPixels], const int palette[8],
+                          int* error) {
+    uint64_t indices = 0;
+    int total = 0;
+    for (int p = 0; p < kLATCBlockPixels; ++p) {
+        int best = 0;
+        int bestError = SkAbs32(palette[0] - pixels[p]);
+        for (int i = 1; i < 8 && bestError > 0; ++i) {
+            int e = SkAbs32(palette[i] - pixels[p]);
+            if (e < bestError) {
+                best = i;
+                bestError = e;
+            }
+        }
+        indices |= (uint64_t)best << (3 * p);
+        total += bestError;
+    }
+    *error = total;
+    return indices;
+}
+
+uint64_t compress_latc_block(const uint8_t* src, size_t rowBytes) {
+    uint8_t pixels[kLATCBlockPixels];
+    int minValue = 255, maxValue = 0;
+    // The range of the values other than 0 and 255, for the second kind of palette.
+    int minInner = 255, maxInner = 0;
+    bool hasExtremes = false;
+    for (int y = 0; y < kLATCBlockDim; ++y) {
+        for (int x = 0; x < kLATCBlockDim; ++x) {
+            int value = src[y * rowBytes + x];
+            pixels[y * kLATCBlockDim + x] = value;
+            minValue = SkTMin(minValue, value);
+            maxValue = SkTMax(maxValue, value);
+            if (0 == value || 255 == value) {
+                hasExtremes = true;
+            } else {
+                minInner = SkTMin(minInner, value);
+                maxInner = SkTMax(maxInner, value);
+            }
+        }
+    }
+
+    // Most blocks of a mask are all empty or all covered. With equal endpoints every index of 0
+    // decodes to the endpoint.
+    if (minValue == maxValue) {
+        return (uint64_t)minValue | ((uint64_t)minValue << 8);
+    }
+
+    int palette[8];
+    int a0 = maxValue, a1 = minValue;
+    make_latc_palette(a0, a1, palette);
+    int error;
+    uint64_t indices = index_latc_block(pixels, palette, &error);
+
+    if (hasExtremes && error > 0) {
+        int b0 = minInner, b1 = maxInner;
+        if (b0 > b1) {
+            // Only 0s and 255s.
+            b0 = 0;
+            b1 = 255;
+        }
+        make_latc_palette(b0, b1, palette);
+        int innerError;
+        uint64_t innerIndices = index_latc_block(pixels, palette, &innerError);
+        if (innerError < error) {
+            a0 = b0;
+            a1 = b1;
+            indices = innerIndices;
+        }
+    }
+    return (uint64_t)a0 | ((uint64_t)a1 << 8) | (indices << 16);
+}
+
+bool compress_a8_to_latc(uint8_t* dst, const uint8_t* src,
+                         int width, int height, size_t rowBytes) {
+    if (0 != width % kLATCBlockDim || 0 != height % kLATCBlockDim) {
+        return false;
+    }
+    for (int y = 0; y < height; y += kLATCBlockDim) {
+        const uint8_t* row = src + y * rowBytes;
+        for (int x = 0; x < width; x += kLATCBlockDim) {
+            uint64_t block = compress_latc_block(row + x, rowBytes);
+            // Blocks are stored little endian.
+            for (int i = 0; i < kLATCBlockSize; ++i) {
+                *dst++ = (uint8_t)(block >> (8 * i));
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+namespace SkTextureCompressor {
+
+size_t GetCompressedDataSize(Format format, int width, int height) {
+    switch (format) {
+        case kLATC_Format:
+            if (width <= 0 || height <= 0 ||
+                0 != width % kLATCBlockDim || 0 != height % kLATCBlockDim) {
+                return 0;
+            }
+            return (width / kLATCBlockDim) * (height / kLATCBlockDim) * kLATCBlockSize;
+    }
+    return 0;
+}
+
+bool CompressBufferToFormat(uint8_t* dst, const uint8_t* src, SkColorType srcColorType,
+                            int width, int height, size_t rowBytes, Format format) {
+    switch (format) {
+        case kLATC_Format:
+            if (kAlpha_8_SkColorType != srcColorType) {
+                return false;
+            }
+            return compress_a8_to_latc(dst, src, width, height, rowBytes);
+    }
+    return false;
+}
+
+SkData* CompressBitmapToFormat(const SkBitmap& bitmap, Format format) {
+    size_t size = GetCompressedDataSize(format, bitmap.width(), bitmap.height());
+    if (0 == size) {
+        return NULL;
+    }
+    SkAutoLockPixels alp(bitmap);
+    if (NULL == bitmap.getPixels()) {
+        return NULL;
+    }
+    SkAutoMalloc storage(size);
+    if (!CompressBufferToFormat(static_cast<uint8_t*>(storage.get()),
+                                static_cast<const uint8_t*>(bitmap.getPixels()),
+                                bitmap.colorType(), bitmap.width(), bitmap.height(),
+                                bitmap.rowBytes(), format)) {
+        return NULL;
+    }
+    return SkData::NewFromMalloc(storage.detach(), size);
+}
+
+}  // namespace SkTextureCompressor
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextureCompressor_DEFINED
+#define SkTextureCompressor_DEFINED
+
+#include "SkImageInfo.h"
+
+class SkBitmap;
+class SkData;
+
+/**
+ *  Encoders from uncompressed pixels to the block compressed formats GPUs sample from directly.
+ *  They are meant to keep up with rasterization, so A8 masks can be compressed as they are made:
+ *  they favor speed over the last bit of quality.
+ */
+namespace SkTextureCompressor {
+    enum Format {
+        // Single channel, 4x4 blocks of 8 bytes (the same layout as BC4 / RGTC1). A quarter of
+        // the size of A8.
+        kLATC_Format,
+
+        kLast_Format = kLATC_Format
+    };
+
+    /**
+     *  Returns the number of bytes the compressed data takes, or 0 if the dimensions can't be
+     *  compressed to the format (LATC needs them to be multiples of 4).
+     */
+    size_t GetCompressedDataSize(Format, int width, int height);
+
+    /**
+     *  Compresses width x height pixels of src, of which each row takes rowBytes, into dst, which
+     *  must hold GetCompressedDataSize() bytes. Only kAlpha_8_SkColorType pixels can be
+     *  compressed to LATC. Returns false if the pixels can't be compressed to the format.
+     */
+    bool CompressBufferToFormat(uint8_t* dst, const uint8_t* src, SkColorType srcColorType,
+                                int width, int height, size_t rowBytes, Format);
+
+    /** Returns the compressed pixels of the bitmap, or NULL if they can't be compressed. */
+    SkData* CompressBitmapToFormat(const SkBitmap&, Format);
+}
+
+#endif
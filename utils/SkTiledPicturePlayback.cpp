@@ -0,0 +1,127 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTiledPicturePlayback.h"
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkTDArray.h"
+#include "SkThread.h"
+#include "SkThreadUtils.h"
+
+namespace {
+
+/**
+ *  State shared by all the workers. Tiles are handed out in raster order
+ *  through an atomic counter, so faster threads simply pick up more tiles.
+ */
+struct TileQueue {
+    const SkBitmap* fDst;
+    int             fTileWidth;
+    int             fTileHeight;
+    int             fTilesX;
+    int             fTileCount;
+    int32_t         fNextTile;
+
+    bool nextTile(SkIRect* tile) {
+        int32_t index = sk_atomic_inc(&fNextTile);
+        if (index >= fTileCount) {
+            return false;
+        }
+        int x = (index % fTilesX) * fTileWidth;
+        int y = (index / fTilesX) * fTileHeight;
+        tile->setXYWH(x, y, fTileWidth, fTileHeight);
+        SkAssertResult(tile->intersect(0, 0, fDst->width(), fDst->height()));
+        return true;
+    }
+};
+
+struct Worker {
+    TileQueue* fQueue;
+    SkPicture* fPicture;
+};
+
+void draw_tile(SkPicture* picture, const SkBitmap& dst, const SkIRect& tile) {
+    SkBitmap tileBitmap;
+    if (!dst.extractSubset(&tileBitmap, tile)) {
+        return;
+    }
+    SkCanvas canvas(tileBitmap);
+    canvas.clipRect(SkRect::MakeWH(SkIntToScalar(tile.width()),
+                                   SkIntToScalar(tile.height())));
+    canvas.translate(-SkIntToScalar(tile.fLeft), -SkIntToScalar(tile.fTop));
+    picture->draw(&canvas);
+    canvas.flush();
+}
+
+void worker_proc(void* data) {
+    Worker* worker = static_cast<Worker*>(data);
+    SkIRect tile;
+    while (worker->fQueue->nextTile(&tile)) {
+        draw_tile(worker->fPicture, *worker->fQueue->fDst, tile);
+    }
+}
+
+}  // namespace
+
+bool SkTiledPicturePlayback::Draw(SkPicture* picture, const SkBitmap& dst,
+                                  int tileWidth, int tileHeight, int threadCount) {
+    if (NULL == picture || NULL == dst.getPixels() || tileWidth <= 0 || tileHeight <= 0) {
+        return false;
+    }
+
+    TileQueue queue;
+    queue.fDst = &dst;
+    queue.fTileWidth = tileWidth;
+    queue.fTileHeight = tileHeight;
+    queue.fTilesX = (dst.width() + tileWidth - 1) / tileWidth;
+    queue.fTileCount = queue.fTilesX * ((dst.height() + tileHeight - 1) / tileHeight);
+    queue.fNextTile = 0;
+
+    if (threadCount > queue.fTileCount) {
+        threadCount = queue.fTileCount;
+    }
+
+    if (threadCount <= 1) {
+        Worker worker = { &queue, picture };
+        worker_proc(&worker);
+        return true;
+    }
+
+    // Playback keeps no shared state, so every thread draws the same picture.
+    // Finish the recording first; that is the one thing draw() may change.
+    picture->endRecording();
+
+    SkTDArray<Worker> workers;
+    workers.setCount(threadCount);
+    SkTDArray<SkThread*> threads;
+    threads.setCount(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        workers[i].fQueue = &queue;
+        workers[i].fPicture = picture;
+        threads[i] = SkNEW_ARGS(SkThread, (worker_proc, &workers[i]));
+        if (!threads[i]->start()) {
+            // Whatever tiles this thread would have drawn are picked up by the others,
+            // or by the calling thread below.
+            SkDELETE(threads[i]);
+            threads[i] = NULL;
+        }
+    }
+
+    // The calling thread helps out rather than just waiting.
+    Worker self = { &queue, picture };
+    worker_proc(&self);
+
+    for (int i = 0; i < threadCount; ++i) {
+        if (NULL != threads[i]) {
+            threads[i]->join();
+            SkDELETE(threads[i]);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTiledPicturePlayback_DEFINED
+#define SkTiledPicturePlayback_DEFINED
+
+#include "SkTypes.h"
+
+class SkBitmap;
+class SkPicture;
+
+/**
+ *  Rasterizes an SkPicture into a bitmap by splitting the bitmap into tiles and
+ *  drawing the tiles on a pool of worker threads.
+ *
+ *  All the workers play back the same picture (SkPicturePlayback keeps its
+ *  per-draw state on the stack, so it is safe to share), each into an
+ *  SkBitmapDevice that wraps the tile's pixels in the destination. Since every tile canvas is clipped to
+ *  its tile, pictures recorded with an SkTileGrid or SkRTree only visit the ops
+ *  that intersect that tile.
+ */
+class SkTiledPicturePlayback : SkNoncopyable {
+public:
+    /**
+     *  Draws picture into dst, which must already have its pixels allocated.
+     *  The bitmap is cut into tileWidth x tileHeight tiles (edge tiles may be
+     *  smaller). If threadCount is <= 1 the tiles are drawn on the calling
+     *  thread. Returns false if dst has no pixels or the tile size is invalid.
+     */
+    static bool Draw(SkPicture* picture, const SkBitmap& dst,
+                     int tileWidth, int tileHeight, int threadCount);
+};
+
+#endif
@@ -12,6 +12,8 @@
 #include "SkDrawCommand.h"
 #include "SkDrawFilter.h"
 #include "SkDevice.h"
+#include "SkTSort.h"
+#include "SkTimingCanvas.h"
 #include "SkXfermode.h"
 
 SkDebugCanvas::SkDebugCanvas(int width, int height)
@@ -342,6 +344,132 @@ void SkDebugCanvas::drawTo(SkCanvas* canvas, int index) {
     fIndex = index;
 }
 
+void SkDebugCanvas::profile(SkCanvas* canvas, int repeatCount, Profile* profile) {
+    SkASSERT(repeatCount > 0);
+    const int count = fCommandVector.count();
+
+    profile->fCommandMSecs.setCount(count);
+    sk_bzero(profile->fCommandMSecs.begin(), count * sizeof(double));
+
+    SkRect rect = SkRect::MakeWH(SkIntToScalar(fWidth), SkIntToScalar(fHeight));
+    for (int repeat = 0; repeat < repeatCount; ++repeat) {
+        const int saveCount = canvas->save();
+        canvas->clear(SK_ColorTRANSPARENT);
+        canvas->resetMatrix();
+        canvas->clipRect(rect, SkRegion::kReplace_Op);
+        this->applyUserTransform(canvas);
+        canvas->setDrawFilter(NULL);
+        canvas->flush();
+
+        for (int i = 0; i < count; ++i) {
+            if (!fCommandVector[i]->isVisible()) {
+                continue;
+            }
+            const double start = SkTimingCanvas::NowMSecs();
+            fCommandVector[i]->execute(canvas);
+            canvas->flush();
+            profile->fCommandMSecs[i] += SkTimingCanvas::NowMSecs() - start;
+        }
+
+        // Unbalanced saves are restored here, outside of the timings.
+        canvas->restoreToCount(saveCount);
+    }
+
+    sk_bzero(profile->fTypeMSecs, sizeof(profile->fTypeMSecs));
+    sk_bzero(profile->fTypeCounts, sizeof(profile->fTypeCounts));
+    profile->fTotalMSecs = 0;
+    profile->fSubtreeMSecs.setCount(count);
+    profile->fCommandTypes.setCount(count);
+
+    // Each open save is charged with the commands within it as they go by.
+    SkTDArray<int> saves;
+    for (int i = 0; i < count; ++i) {
+        const double msecs = profile->fCommandMSecs[i] / repeatCount;
+        profile->fCommandMSecs[i] = msecs;
+        profile->fSubtreeMSecs[i] = msecs;
+        profile->fTotalMSecs += msecs;
+
+        const DrawType type = fCommandVector[i]->getType();
+        profile->fCommandTypes[i] = type;
+        profile->fTypeMSecs[type] += msecs;
+        profile->fTypeCounts[type] += 1;
+
+        for (int j = 0; j < saves.count(); ++j) {
+            profile->fSubtreeMSecs[saves[j]] += msecs;
+        }
+        SkDrawCommand::Action action = fCommandVector[i]->action();
+        if (SkDrawCommand::kPushLayer_Action == action) {
+            *saves.push() = i;
+        } else if (SkDrawCommand::kPopLayer_Action == action && !saves.isEmpty()) {
+            saves.pop();
+        }
+    }
+}
+
+namespace {
+
+// Sorts indices of the commands by the times at them, slowest first.
+struct SlowerCommand {
+    explicit SlowerCommand(const double* msecs) : fMSecs(msecs) {}
+    bool operator()(int a, int b) const { return fMSecs[a] > fMSecs[b]; }
+    const double* fMSecs;
+};
+
+}  // namespace
+
+void SkDebugCanvas::Profile::toString(SkString* str, int maxCommands) const {
+    str->appendf("total: %.3f ms\n", fTotalMSecs);
+    if (fTotalMSecs <= 0) {
+        return;
+    }
+
+    SkTDArray<int> types;
+    for (int i = 0; i <= LAST_DRAWTYPE_ENUM; ++i) {
+        if (fTypeCounts[i] > 0) {
+            *types.push() = i;
+        }
+    }
+    SlowerCommand slowerType(fTypeMSecs);
+    SkTQSort(types.begin(), types.end() - 1, slowerType);
+    str->append("by type:\n");
+    for (int i = 0; i < types.count(); ++i) {
+        const int type = types[i];
+        str->appendf("  %-20s %6d  %10.3f ms  %5.1f%%\n",
+                     SkDrawCommand::GetCommandString((DrawType) type), fTypeCounts[type],
+                     fTypeMSecs[type], 100 * fTypeMSecs[type] / fTotalMSecs);
+    }
+
+    const int count = fCommandMSecs.count();
+    SkTDArray<int> commands;
+    commands.setCount(count);
+    for (int i = 0; i < count; ++i) {
+        commands[i] = i;
+    }
+    SlowerCommand slowerCommand(fCommandMSecs.begin());
+    SkTQSort(commands.begin(), commands.end() - 1, slowerCommand);
+    str->append("slowest commands:\n");
+    for (int i = 0; i < SkTMin(count, maxCommands); ++i) {
+        const int index = commands[i];
+        str->appendf("  %6d  %10.3f ms  %5.1f%%\n", index, fCommandMSecs[index],
+                     100 * fCommandMSecs[index] / fTotalMSecs);
+    }
+
+    commands.rewind();
+    for (int i = 0; i < count; ++i) {
+        if (SAVE_LAYER == fCommandTypes[i]) {
+            *commands.push() = i;
+        }
+    }
+    SlowerCommand slowerSubtree(fSubtreeMSecs.begin());
+    SkTQSort(commands.begin(), commands.end() - 1, slowerSubtree);
+    str->append("slowest saveLayer subtrees:\n");
+    for (int i = 0; i < SkTMin(commands.count(), maxCommands); ++i) {
+        const int index = commands[i];
+        str->appendf("  %6d  %10.3f ms  %5.1f%%\n", index, fSubtreeMSecs[index],
+                     100 * fSubtreeMSecs[index] / fTotalMSecs);
+    }
+}
+
 void SkDebugCanvas::deleteDrawCommandAt(int index) {
     SkASSERT(index < fCommandVector.count());
     delete fCommandVector[index];
@@ -57,6 +57,39 @@ public:
      */
     void drawTo(SkCanvas* canvas, int index);
 
+    /**
+        Times of the commands, from profile(). All times are in milliseconds
+        and are means over the replays.
+     */
+    struct Profile {
+        /** The time each command took, including flushing the canvas after it. */
+        SkTDArray<double> fCommandMSecs;
+        /** For a save or saveLayer, the time of it, the commands up to its
+            restore and the restore, which draws a layer back; for any other
+            command the same as fCommandMSecs. */
+        SkTDArray<double> fSubtreeMSecs;
+        /** The DrawType of each command. */
+        SkTDArray<DrawType> fCommandTypes;
+        /** The time and number of the commands of each DrawType. */
+        double fTypeMSecs[LAST_DRAWTYPE_ENUM + 1];
+        int fTypeCounts[LAST_DRAWTYPE_ENUM + 1];
+        double fTotalMSecs;
+
+        /** Appends a report of the DrawTypes by time, and of the slowest
+            commands and saveLayer subtrees, up to maxCommands of each. */
+        void toString(SkString* str, int maxCommands) const;
+    };
+
+    /**
+        Replays the visible commands into the canvas repeatCount times, timing
+        each of them, and fills out the profile. The canvas is flushed after
+        every command so a GPU canvas is charged for its draws as they are
+        made rather than at the end. No visualization is applied.
+        @param canvas  The canvas being drawn to
+        @param repeatCount  How many times to replay the commands
+     */
+    void profile(SkCanvas* canvas, int repeatCount, Profile* profile);
+
     /**
         Returns the most recently calculated transformation matrix
      */
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTimingCanvas.h"
+
+#include "SkDrawCommand.h"
+
+#if defined(SK_BUILD_FOR_WIN32)
+    #include <windows.h>
+#elif defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    #include <mach/mach_time.h>
+#else
+    #include <time.h>
+#endif
+
+double SkTimingCanvas::NowMSecs() {
+#if defined(SK_BUILD_FOR_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart * 1000.0 / frequency.QuadPart;
+#elif defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    static mach_timebase_info_data_t gTimebase;
+    if (0 == gTimebase.denom) {
+        mach_timebase_info(&gTimebase);
+    }
+    return mach_absolute_time() * 1e-6 * gTimebase.numer / gTimebase.denom;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec * 1e-6;
+#endif
+}
+
+class SkTimingCanvas::AutoTime : SkNoncopyable {
+public:
+    AutoTime(Timing* timing) : fTiming(timing), fStart(NowMSecs()) {}
+
+    ~AutoTime() {
+        fTiming->fCount += 1;
+        fTiming->fMSecs += NowMSecs() - fStart;
+    }
+
+private:
+    Timing* fTiming;
+    double  fStart;
+};
+
+#define TIME_OP(type)   AutoTime at(&fTimings[type])
+
+SkTimingCanvas::SkTimingCanvas(SkCanvas* target)
+    : INHERITED(target->getBaseLayerSize().width(), target->getBaseLayerSize().height())
+    , fTarget(target) {
+    this->addCanvas(target);
+    this->resetTimings();
+}
+
+void SkTimingCanvas::resetTimings() {
+    memset(fTimings, 0, sizeof(fTimings));
+    memset(&fFlushTiming, 0, sizeof(fFlushTiming));
+}
+
+double SkTimingCanvas::totalMSecs() const {
+    double total = fFlushTiming.fMSecs;
+    for (int i = 0; i <= LAST_DRAWTYPE_ENUM; ++i) {
+        total += fTimings[i].fMSecs;
+    }
+    return total;
+}
+
+void SkTimingCanvas::timeFlush() {
+    AutoTime at(&fFlushTiming);
+    fTarget->flush();
+}
+
+const char* SkTimingCanvas::TypeName(DrawType type) {
+    return UNUSED == type ? NULL : SkDrawCommand::GetCommandString(type);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void SkTimingCanvas::willSave(SaveFlags flags) {
+    TIME_OP(SAVE);
+    this->INHERITED::willSave(flags);
+}
+
+SkCanvas::SaveLayerStrategy SkTimingCanvas::willSaveLayer(const SkRect* bounds,
+                                                          const SkPaint* paint,
+                                                          SaveFlags flags) {
+    TIME_OP(SAVE_LAYER);
+    return this->INHERITED::willSaveLayer(bounds, paint, flags);
+}
+
+void SkTimingCanvas::willRestore() {
+    TIME_OP(RESTORE);
+    this->INHERITED::willRestore();
+}
+
+void SkTimingCanvas::didConcat(const SkMatrix& matrix) {
+    TIME_OP(CONCAT);
+    this->INHERITED::didConcat(matrix);
+}
+
+void SkTimingCanvas::didSetMatrix(const SkMatrix& matrix) {
+    TIME_OP(SET_MATRIX);
+    this->INHERITED::didSetMatrix(matrix);
+}
+
+void SkTimingCanvas::onClipRect(const SkRect& rect, SkRegion::Op op, ClipEdgeStyle edgeStyle) {
+    TIME_OP(CLIP_RECT);
+    this->INHERITED::onClipRect(rect, op, edgeStyle);
+}
+
+void SkTimingCanvas::onClipRRect(const SkRRect& rrect, SkRegion::Op op, ClipEdgeStyle edgeStyle) {
+    TIME_OP(CLIP_RRECT);
+    this->INHERITED::onClipRRect(rrect, op, edgeStyle);
+}
+
+void SkTimingCanvas::onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edgeStyle) {
+    TIME_OP(CLIP_PATH);
+    this->INHERITED::onClipPath(path, op, edgeStyle);
+}
+
+void SkTimingCanvas::onClipRegion(const SkRegion& deviceRgn, SkRegion::Op op) {
+    TIME_OP(CLIP_REGION);
+    this->INHERITED::onClipRegion(deviceRgn, op);
+}
+
+void SkTimingCanvas::clear(SkColor color) {
+    TIME_OP(DRAW_CLEAR);
+    this->INHERITED::clear(color);
+}
+
+void SkTimingCanvas::drawPaint(const SkPaint& paint) {
+    TIME_OP(DRAW_PAINT);
+    this->INHERITED::drawPaint(paint);
+}
+
+void SkTimingCanvas::drawPoints(PointMode mode, size_t count, const SkPoint pts[],
+                                const SkPaint& paint) {
+    TIME_OP(DRAW_POINTS);
+    this->INHERITED::drawPoints(mode, count, pts, paint);
+}
+
+void SkTimingCanvas::drawRect(const SkRect& rect, const SkPaint& paint) {
+    TIME_OP(DRAW_RECT);
+    this->INHERITED::drawRect(rect, paint);
+}
+
+void SkTimingCanvas::drawOval(const SkRect& rect, const SkPaint& paint) {
+    TIME_OP(DRAW_OVAL);
+    this->INHERITED::drawOval(rect, paint);
+}
+
+void SkTimingCanvas::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
+    TIME_OP(DRAW_RRECT);
+    this->INHERITED::drawRRect(rrect, paint);
+}
+
+void SkTimingCanvas::onDrawDRRect(const SkRRect& outer, const SkRRect& inner,
+                                  const SkPaint& paint) {
+    TIME_OP(DRAW_DRRECT);
+    this->INHERITED::onDrawDRRect(outer, inner, paint);
+}
+
+void SkTimingCanvas::drawPath(const SkPath& path, const SkPaint& paint) {
+    TIME_OP(DRAW_PATH);
+    this->INHERITED::drawPath(path, paint);
+}
+
+void SkTimingCanvas::drawBitmap(const SkBitmap& bitmap, SkScalar x, SkScalar y,
+                                const SkPaint* paint) {
+    TIME_OP(DRAW_BITMAP);
+    this->INHERITED::drawBitmap(bitmap, x, y, paint);
+}
+
+void SkTimingCanvas::drawBitmapRectToRect(const SkBitmap& bitmap, const SkRect* src,
+                                          const SkRect& dst, const SkPaint* paint,
+                                          DrawBitmapRectFlags flags) {
+    TIME_OP(DRAW_BITMAP_RECT_TO_RECT);
+    this->INHERITED::drawBitmapRectToRect(bitmap, src, dst, paint, flags);
+}
+
+void SkTimingCanvas::drawBitmapMatrix(const SkBitmap& bitmap, const SkMatrix& m,
+                                      const SkPaint* paint) {
+    TIME_OP(DRAW_BITMAP_MATRIX);
+    this->INHERITED::drawBitmapMatrix(bitmap, m, paint);
+}
+
+void SkTimingCanvas::drawBitmapNine(const SkBitmap& bitmap, const SkIRect& center,
+                                    const SkRect& dst, const SkPaint* paint) {
+    TIME_OP(DRAW_BITMAP_NINE);
+    this->INHERITED::drawBitmapNine(bitmap, center, dst, paint);
+}
+
+void SkTimingCanvas::drawSprite(const SkBitmap& bitmap, int x, int y, const SkPaint* paint) {
+    TIME_OP(DRAW_SPRITE);
+    this->INHERITED::drawSprite(bitmap, x, y, paint);
+}
+
+void SkTimingCanvas::onDrawText(const void* text, size_t byteLength, SkScalar x, SkScalar y,
+                                const SkPaint& paint) {
+    TIME_OP(DRAW_TEXT);
+    this->INHERITED::onDrawText(text, byteLength, x, y, paint);
+}
+
+void SkTimingCanvas::onDrawPosText(const void* text, size_t byteLength, const SkPoint pos[],
+                                   const SkPaint& paint) {
+    TIME_OP(DRAW_POS_TEXT);
+    this->INHERITED::onDrawPosText(text, byteLength, pos, paint);
+}
+
+void SkTimingCanvas::onDrawPosTextH(const void* text, size_t byteLength, const SkScalar xpos[],
+                                    SkScalar constY, const SkPaint& paint) {
+    TIME_OP(DRAW_POS_TEXT_H);
+    this->INHERITED::onDrawPosTextH(text, byteLength, xpos, constY, paint);
+}
+
+void SkTimingCanvas::onDrawTextOnPath(const void* text, size_t byteLength, const SkPath& path,
+                                      const SkMatrix* matrix, const SkPaint& paint) {
+    TIME_OP(DRAW_TEXT_ON_PATH);
+    this->INHERITED::onDrawTextOnPath(text, byteLength, path, matrix, paint);
+}
+
+void SkTimingCanvas::drawPicture(SkPicture& picture) {
+    // Count the call, but play the picture back here so its ops are timed one by one.
+    fTimings[DRAW_PICTURE].fCount += 1;
+    this->SkCanvas::drawPicture(picture);
+}
+
+void SkTimingCanvas::drawVertices(VertexMode vmode, int vertexCount,
+                                  const SkPoint vertices[], const SkPoint texs[],
+                                  const SkColor colors[], SkXfermode* xmode,
+                                  const uint16_t indices[], int indexCount,
+                                  const SkPaint& paint) {
+    TIME_OP(DRAW_VERTICES);
+    this->INHERITED::drawVertices(vmode, vertexCount, vertices, texs, colors, xmode,
+                                  indices, indexCount, paint);
+}
+
+void SkTimingCanvas::drawData(const void* data, size_t length) {
+    TIME_OP(DRAW_DATA);
+    this->INHERITED::drawData(data, length);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2014 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTimingCanvas_DEFINED
+#define SkTimingCanvas_DEFINED
+
+#include "SkNWayCanvas.h"
+#include "SkPictureFlat.h"
+
+/**
+ *  Forwards every call to a target canvas and accumulates, per kind of op, how many calls were
+ *  made and how long the target took to run them. The kinds are the DrawTypes of a picture, with
+ *  the names SkDebugCanvas shows for them, so the times of a picture played back into the canvas
+ *  can be read against its commands in the debugger.
+ *
+ *  Nested pictures are played back op by op into this canvas rather than forwarded whole, so
+ *  their ops are counted under their own kinds and DRAW_PICTURE only counts the calls. The clip
+ *  and matrix are tracked here as well, so playback with a bounding box hierarchy culls against
+ *  the same clip it would on the target.
+ *
+ *  Backends that defer work (the GPU backend batches draws until it flushes) are measured for
+ *  what they do when a call is made; timeFlush() attributes the rest to a separate counter.
+ */
+class SkTimingCanvas : public SkNWayCanvas {
+public:
+    explicit SkTimingCanvas(SkCanvas* target);
+
+    struct Timing {
+        int     fCount;
+        double  fMSecs;
+    };
+
+    /** Returns the times accumulated for the DrawType since the last resetTimings(). */
+    const Timing& timing(DrawType type) const {
+        SkASSERT(type >= 0 && type <= LAST_DRAWTYPE_ENUM);
+        return fTimings[type];
+    }
+
+    /** Returns the time spent in timeFlush() since the last resetTimings(). */
+    const Timing& flushTiming() const { return fFlushTiming; }
+
+    /** Returns the sum of the times of all the DrawTypes and of the flushes. */
+    double totalMSecs() const;
+
+    void resetTimings();
+
+    /** Flushes the target, adding the time it took to flushTiming(). */
+    void timeFlush();
+
+    /** Returns the name SkDebugCanvas gives the DrawType, or NULL for UNUSED. */
+    static const char* TypeName(DrawType);
+
+    /** Returns a timestamp in milliseconds, from a monotonic clock at the finest resolution the
+        platform has. */
+    static double NowMSecs();
+
+    virtual void clear(SkColor) SK_OVERRIDE;
+    virtual void drawPaint(const SkPaint&) SK_OVERRIDE;
+    virtual void drawPoints(PointMode, size_t count, const SkPoint pts[],
+                            const SkPaint&) SK_OVERRIDE;
+    virtual void drawRect(const SkRect&, const SkPaint&) SK_OVERRIDE;
+    virtual void drawOval(const SkRect&, const SkPaint&) SK_OVERRIDE;
+    virtual void drawRRect(const SkRRect&, const SkPaint&) SK_OVERRIDE;
+    virtual void drawPath(const SkPath&, const SkPaint&) SK_OVERRIDE;
+    virtual void drawBitmap(const SkBitmap&, SkScalar left, SkScalar top,
+                            const SkPaint*) SK_OVERRIDE;
+    virtual void drawBitmapRectToRect(const SkBitmap&, const SkRect* src,
+                                      const SkRect& dst, const SkPaint*,
+                                      DrawBitmapRectFlags flags) SK_OVERRIDE;
+    virtual void drawBitmapMatrix(const SkBitmap&, const SkMatrix&,
+                                  const SkPaint*) SK_OVERRIDE;
+    virtual void drawBitmapNine(const SkBitmap&, const SkIRect& center,
+                                const SkRect& dst, const SkPaint*) SK_OVERRIDE;
+    virtual void drawSprite(const SkBitmap&, int left, int top,
+                            const SkPaint*) SK_OVERRIDE;
+    virtual void drawPicture(SkPicture&) SK_OVERRIDE;
+    virtual void drawVertices(VertexMode, int vertexCount,
+                              const SkPoint vertices[], const SkPoint texs[],
+                              const SkColor colors[], SkXfermode*,
+                              const uint16_t indices[], int indexCount,
+                              const SkPaint&) SK_OVERRIDE;
+    virtual void drawData(const void*, size_t) SK_OVERRIDE;
+
+protected:
+    virtual void willSave(SaveFlags) SK_OVERRIDE;
+    virtual SaveLayerStrategy willSaveLayer(const SkRect*, const SkPaint*, SaveFlags) SK_OVERRIDE;
+    virtual void willRestore() SK_OVERRIDE;
+
+    virtual void didConcat(const SkMatrix&) SK_OVERRIDE;
+    virtual void didSetMatrix(const SkMatrix&) SK_OVERRIDE;
+
+    virtual void onDrawDRRect(const SkRRect&, const SkRRect&, const SkPaint&) SK_OVERRIDE;
+    virtual void onDrawText(const void* text, size_t byteLength, SkScalar x, SkScalar y,
+                            const SkPaint&) SK_OVERRIDE;
+    virtual void onDrawPosText(const void* text, size_t byteLength, const SkPoint pos[],
+                               const SkPaint&) SK_OVERRIDE;
+    virtual void onDrawPosTextH(const void* text, size_t byteLength, const SkScalar xpos[],
+                                SkScalar constY, const SkPaint&) SK_OVERRIDE;
+    virtual void onDrawTextOnPath(const void* text, size_t byteLength, const SkPath& path,
+                                  const SkMatrix* matrix, const SkPaint&) SK_OVERRIDE;
+
+    virtual void onClipRect(const SkRect&, SkRegion::Op, ClipEdgeStyle) SK_OVERRIDE;
+    virtual void onClipRRect(const SkRRect&, SkRegion::Op, ClipEdgeStyle) SK_OVERRIDE;
+    virtual void onClipPath(const SkPath&, SkRegion::Op, ClipEdgeStyle) SK_OVERRIDE;
+    virtual void onClipRegion(const SkRegion&, SkRegion::Op) SK_OVERRIDE;
+
+private:
+    class AutoTime;
+
+    SkCanvas*   fTarget;
+    Timing      fTimings[LAST_DRAWTYPE_ENUM + 1];
+    Timing      fFlushTiming;
+
+    typedef SkNWayCanvas INHERITED;
+};
+
+#endif
@@ -7,6 +7,9 @@
  */
 #include "SkView.h"
 #include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkPictureRecorder.h"
+#include "SkViewPriv.h"
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -22,6 +25,7 @@ SkView::SkView(uint32_t flags) : fFlags(SkToU8(flags))
 SkView::~SkView()
 {
     this->detachAllChildren();
+    SkViewPictureCache::Remove(this);
 }
 
 void SkView::setFlags(uint32_t flags)
@@ -124,7 +128,20 @@ void SkView::draw(SkCanvas* canvas)
         }
 
         int sc = canvas->save();
-        this->onDraw(canvas);
+        bool cached;
+        SkAutoTUnref<SkPicture> picture(SkViewPictureCache::RefPicture(this, &cached));
+        if (cached && NULL == picture.get()) {
+            SkPictureRecorder recorder;
+            this->onDraw(recorder.beginRecording(SkScalarCeilToInt(fWidth),
+                                                 SkScalarCeilToInt(fHeight), NULL, 0));
+            picture.reset(recorder.endRecording());
+            SkViewPictureCache::SetPicture(this, picture.get());
+        }
+        if (NULL != picture.get()) {
+            canvas->drawPicture(*picture.get());
+        } else {
+            this->onDraw(canvas);
+        }
         canvas->restoreToCount(sc);
 
         if (fParent) {
@@ -144,6 +161,10 @@ void SkView::draw(SkCanvas* canvas)
 }
 
 void SkView::inval(SkRect* rect) {
+    // Only this view's content changed; its ancestors just need to redraw over it, so they keep
+    // their pictures.
+    SkViewPictureCache::Inval(this);
+
     SkView*    view = this;
     SkRect storage;
 
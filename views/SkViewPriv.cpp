@@ -6,6 +6,10 @@
  * found in the LICENSE file.
  */
 #include "SkViewPriv.h"
+#include "SkChecksum.h"
+#include "SkPicture.h"
+#include "SkTDynamicHash.h"
+#include "SkThread.h"
 
 //////////////////////////////////////////////////////////////////////
 
@@ -49,6 +53,7 @@ SkView::Artist* SkView::setArtist(Artist* obj)
         else
             this->addTagList(new Artist_SkTagList(obj));
     }
+    SkViewPictureCache::Inval(this);
     return obj;
 }
 
@@ -101,3 +106,90 @@ SkView::Layout* SkView::setLayout(Layout* obj, bool invokeLayoutNow)
 
     return obj;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+struct CachedView {
+    explicit CachedView(const SkView* view) : fView(view), fPicture(NULL) {}
+    ~CachedView() { SkSafeUnref(fPicture); }
+
+    static const SkView* const& GetKey(const CachedView& rec) { return rec.fView; }
+    static uint32_t Hash(const SkView* const& view) {
+        return SkChecksum::Murmur3(reinterpret_cast<const uint32_t*>(&view), sizeof(view));
+    }
+
+    const SkView*   fView;
+    SkPicture*      fPicture;   // NULL until the view is drawn, and again after inval()
+};
+
+}  // namespace
+
+typedef SkTDynamicHash<CachedView, const SkView*> CachedViewHash;
+
+SK_DECLARE_STATIC_MUTEX(gCachedViewMutex);
+// Made on first use, to stay clear of static initializers.
+static CachedViewHash* gCachedViews;
+
+static CachedViewHash* cached_views() {
+    if (NULL == gCachedViews) {
+        gCachedViews = SkNEW(CachedViewHash);
+    }
+    return gCachedViews;
+}
+
+void SkViewPictureCache::SetEnabled(SkView* view, bool enabled) {
+    SkASSERT(view);
+    {
+        SkAutoMutexAcquire ac(gCachedViewMutex);
+        CachedView* rec = cached_views()->find(view);
+        if (enabled == (NULL != rec)) {
+            return;
+        }
+        if (enabled) {
+            cached_views()->add(SkNEW_ARGS(CachedView, (view)));
+        } else {
+            cached_views()->remove(view);
+            SkDELETE(rec);
+        }
+    }
+    view->inval(NULL);
+}
+
+bool SkViewPictureCache::IsEnabled(const SkView* view) {
+    SkAutoMutexAcquire ac(gCachedViewMutex);
+    return NULL != gCachedViews && NULL != gCachedViews->find(view);
+}
+
+SkPicture* SkViewPictureCache::RefPicture(const SkView* view, bool* enabled) {
+    SkAutoMutexAcquire ac(gCachedViewMutex);
+    CachedView* rec = NULL == gCachedViews ? NULL : gCachedViews->find(view);
+    *enabled = NULL != rec;
+    return rec ? SkSafeRef(rec->fPicture) : NULL;
+}
+
+void SkViewPictureCache::SetPicture(const SkView* view, SkPicture* picture) {
+    SkAutoMutexAcquire ac(gCachedViewMutex);
+    CachedView* rec = NULL == gCachedViews ? NULL : gCachedViews->find(view);
+    if (rec) {
+        SkRefCnt_SafeAssign(rec->fPicture, picture);
+    }
+}
+
+void SkViewPictureCache::Inval(const SkView* view) {
+    SkAutoMutexAcquire ac(gCachedViewMutex);
+    CachedView* rec = NULL == gCachedViews ? NULL : gCachedViews->find(view);
+    if (rec) {
+        SkSafeSetNull(rec->fPicture);
+    }
+}
+
+void SkViewPictureCache::Remove(const SkView* view) {
+    SkAutoMutexAcquire ac(gCachedViewMutex);
+    CachedView* rec = NULL == gCachedViews ? NULL : gCachedViews->find(view);
+    if (rec) {
+        gCachedViews->remove(view);
+        SkDELETE(rec);
+    }
+}
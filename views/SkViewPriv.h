@@ -11,6 +11,8 @@
 #include "SkView.h"
 #include "SkTagList.h"
 
+class SkPicture;
+
 struct Layout_SkTagList : SkTagList {
     SkView::Layout*    fLayout;
 
@@ -41,4 +43,34 @@ struct Artist_SkTagList : SkTagList {
     }
 };
 
+/*  Opt-in retained-mode drawing for SkView. A view that is enabled here
+    records its onDraw() into an SkPicture the first time it is drawn, and
+    from then on draw() plays that picture back instead, until the view's
+    inval() (or a change of size or flags, which call it) drops it. Children
+    are still drawn through their own draw(), so each enabled child replays
+    its own picture, and changing one doesn't re-record its parent.
+
+    Only enable views whose onDraw() depends on nothing but the view's own
+    state, and which call inval() whenever that state changes.
+*/
+class SkViewPictureCache {
+public:
+    static void SetEnabled(SkView*, bool enabled);
+    static bool IsEnabled(const SkView*);
+
+private:
+    /*  Returns the view's cached picture, reffed, or NULL. Sets *enabled to
+        whether the view is cached at all, so a NULL return on an enabled view
+        means it must be recorded with SetPicture().
+    */
+    static SkPicture* RefPicture(const SkView*, bool* enabled);
+    static void SetPicture(const SkView*, SkPicture*);
+    // Drops the view's picture, keeping it enabled.
+    static void Inval(const SkView*);
+    // Forgets the view entirely, as it's being deleted.
+    static void Remove(const SkView*);
+
+    friend class SkView;
+};
+
 #endif